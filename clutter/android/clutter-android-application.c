@@ -23,6 +23,7 @@
  */
 
 #include <stdlib.h>
+#include <dlfcn.h>
 
 #include <android_native_app_glue.h>
 #include <android/input.h>
@@ -32,7 +33,10 @@
 
 #include "clutter-main.h"
 #include "clutter-marshal.h"
+#include "clutter-master-clock.h"
 #include "clutter-private.h"
+#include "clutter-stage-manager.h"
+#include "clutter-stage-private.h"
 
 #include "clutter-android-application.h"
 
@@ -58,10 +62,34 @@ struct _ClutterAndroidApplicationPrivate
 {
   struct android_app* android_application;
 
+  /* the choreographer of the thread running the main loop, if the
+   * platform has one; see clutter_android_application_init_vsync()
+   */
+  struct AChoreographer *choreographer;
+
   gint have_window : 1;
+  guint paused : 1;
+  guint vsync_pending : 1;
   GMainLoop *wait_for_window;
 };
 
+/* AChoreographer is not available in all the versions of Android we
+ * run on, so its entry points are looked up at run time; without it
+ * the master clock paces the frames with its own timer
+ */
+typedef void (* ChoreographerFrameCallback)   (long     frame_time_nanos,
+                                               void    *data);
+typedef void (* ChoreographerFrameCallback64) (int64_t  frame_time_nanos,
+                                               void    *data);
+
+static struct AChoreographer *(* choreographer_get_instance) (void);
+static void (* choreographer_post_frame_callback)   (struct AChoreographer       *choreographer,
+                                                     ChoreographerFrameCallback   callback,
+                                                     void                        *data);
+static void (* choreographer_post_frame_callback64) (struct AChoreographer       *choreographer,
+                                                     ChoreographerFrameCallback64 callback,
+                                                     void                        *data);
+
 static gboolean
 clutter_android_application_ready (ClutterAndroidApplication *application)
 {
@@ -73,6 +101,145 @@ clutter_android_application_ready (ClutterAndroidApplication *application)
   return TRUE;
 }
 
+/* feeds the time of the vblank to the stages, which use it to
+ * schedule the next frames; the time is in the same clock as
+ * g_get_monotonic_time(), in nanoseconds
+ */
+static void
+clutter_android_application_vsync (ClutterAndroidApplication *application,
+                                   gint64                     frame_time_nanos)
+{
+  ClutterAndroidApplicationPrivate *priv = application->priv;
+  ClutterStageManager *stage_manager;
+  const GSList *l;
+
+  priv->vsync_pending = FALSE;
+
+  if (priv->paused)
+    return;
+
+  stage_manager = clutter_stage_manager_get_default ();
+
+  for (l = clutter_stage_manager_peek_stages (stage_manager);
+       l != NULL;
+       l = l->next)
+    _clutter_stage_presented (l->data, frame_time_nanos / 1000);
+}
+
+static void
+clutter_android_frame_callback (long  frame_time_nanos,
+                                void *data)
+{
+  clutter_android_application_vsync (data, frame_time_nanos);
+}
+
+static void
+clutter_android_frame_callback64 (int64_t  frame_time_nanos,
+                                  void    *data)
+{
+  clutter_android_application_vsync (data, frame_time_nanos);
+}
+
+/* runs after each frame of the master clock, and asks for the time of
+ * the next vblank; when the clock stops, no more vblanks are requested
+ * and the application does not wake up until there is something to
+ * draw again
+ */
+static gboolean
+clutter_android_application_request_vsync (gpointer data)
+{
+  ClutterAndroidApplication *application = data;
+  ClutterAndroidApplicationPrivate *priv = application->priv;
+
+  if (priv->vsync_pending || priv->paused)
+    return TRUE;
+
+  if (choreographer_post_frame_callback64 != NULL)
+    choreographer_post_frame_callback64 (priv->choreographer,
+                                         clutter_android_frame_callback64,
+                                         application);
+  else
+    choreographer_post_frame_callback (priv->choreographer,
+                                       clutter_android_frame_callback,
+                                       application);
+
+  priv->vsync_pending = TRUE;
+
+  return TRUE;
+}
+
+static void
+clutter_android_application_init_vsync (ClutterAndroidApplication *application)
+{
+  ClutterAndroidApplicationPrivate *priv = application->priv;
+  void *libandroid;
+
+  libandroid = dlopen ("libandroid.so", RTLD_NOW | RTLD_LOCAL);
+  if (libandroid == NULL)
+    return;
+
+  choreographer_get_instance =
+    dlsym (libandroid, "AChoreographer_getInstance");
+  choreographer_post_frame_callback64 =
+    dlsym (libandroid, "AChoreographer_postFrameCallback64");
+
+  /* the frame time does not fit in a long on 32 bit systems */
+  if (choreographer_post_frame_callback64 == NULL &&
+      sizeof (long) >= sizeof (gint64))
+    choreographer_post_frame_callback =
+      dlsym (libandroid, "AChoreographer_postFrameCallback");
+
+  if (choreographer_get_instance == NULL ||
+      (choreographer_post_frame_callback64 == NULL &&
+       choreographer_post_frame_callback == NULL))
+    {
+      g_message ("No choreographer, using the default frame pacing");
+      return;
+    }
+
+  /* the frame callbacks are dispatched by the looper of the thread
+   * calling this, which is the one running the main loop
+   */
+  priv->choreographer = choreographer_get_instance ();
+}
+
+/* suspends the master clock while the activity is paused, or while
+ * there is no window to draw on
+ */
+static void
+clutter_android_application_set_paused (ClutterAndroidApplication *application,
+                                        gboolean                   paused)
+{
+  ClutterAndroidApplicationPrivate *priv = application->priv;
+
+  priv->paused = paused;
+
+  /* the clock is only created once Clutter has been initialized */
+  if (!priv->have_window)
+    return;
+
+  _clutter_master_clock_set_paused (_clutter_master_clock_get_default (),
+                                    priv->paused);
+}
+
+/* frees the resources Clutter can create again when it needs them */
+static void
+clutter_android_application_trim_memory (ClutterAndroidApplication *application)
+{
+  ClutterStageManager *stage_manager;
+  const GSList *l;
+
+  if (!application->priv->have_window)
+    return;
+
+  stage_manager = clutter_stage_manager_get_default ();
+
+  for (l = clutter_stage_manager_peek_stages (stage_manager);
+       l != NULL;
+       l = l->next)
+    _clutter_stage_release_offscreen_pool (l->data);
+}
+
 static void
 clutter_android_application_finalize (GObject *object)
 {
@@ -137,7 +304,13 @@ clutter_android_handle_cmd (struct android_app *app,
           g_signal_emit (application, signals[READY], 0, &initialized);
 
           if (initialized)
-            priv->have_window = TRUE;
+            {
+              priv->have_window = TRUE;
+
+              /* the activity may have been paused before */
+              clutter_android_application_set_paused (application,
+                                                      priv->paused);
+            }
 
           if (priv->wait_for_window)
             {
@@ -150,6 +323,7 @@ clutter_android_handle_cmd (struct android_app *app,
     case APP_CMD_TERM_WINDOW:
       /* The window is being hidden or closed, clean it up */
       g_message ("command: TERM_WINDOW");
+      clutter_android_application_set_paused (application, TRUE);
       if (priv->wait_for_window)
         g_main_loop_quit (priv->wait_for_window);
       else
@@ -167,6 +341,21 @@ clutter_android_handle_cmd (struct android_app *app,
        * This is to avoid consuming battery while not being used. */
       g_message ("command: LOST_FOCUS");
       break;
+
+    case APP_CMD_PAUSE:
+      g_message ("command: PAUSE");
+      clutter_android_application_set_paused (application, TRUE);
+      break;
+
+    case APP_CMD_RESUME:
+      g_message ("command: RESUME");
+      clutter_android_application_set_paused (application, FALSE);
+      break;
+
+    case APP_CMD_LOW_MEMORY:
+      g_message ("command: LOW_MEMORY");
+      clutter_android_application_trim_memory (application);
+      break;
     }
 }
 
@@ -270,6 +459,11 @@ clutter_android_application_run (ClutterAndroidApplication *application)
       priv->wait_for_window = NULL;
     }
 
+  if (priv->choreographer != NULL)
+    clutter_threads_add_repaint_func (clutter_android_application_request_vsync,
+                                      application,
+                                      NULL);
+
   g_message ("entering main loop");
   clutter_main ();
 }
@@ -309,5 +503,7 @@ android_main (struct android_app* android_application)
 
   priv->android_application = android_application;
 
+  clutter_android_application_init_vsync (clutter_application);
+
   clutter_android_main (clutter_application);
 }
@@ -35,4 +35,6 @@
 #define CALLY_GET_CLUTTER_ACTOR(cally_object) \
   (CLUTTER_ACTOR (atk_gobject_accessible_get_object (ATK_GOBJECT_ACCESSIBLE (cally_object))))
 
+void _cally_actor_track_children (CallyActor *cally_actor);
+
 #endif /* __CALLY_ACTOR_PRIVATE_H__ */
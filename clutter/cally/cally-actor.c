@@ -70,6 +70,19 @@
  * This methods can be reimplemented, in concrete cases that we can get ways more
  * efficient to implement that. Take a look to #CallyGroup as a example of this.
  *
+ * The notifications of the actors are not forwarded to ATK as they happen:
+ * an animated actor notifies some of its properties at every frame, so the
+ * notified properties are collected for each actor and handed over to the
+ * notify_clutter() virtual function once per frame, after the paint, and at
+ * most every CALLY_NOTIFY_INTERVAL milliseconds (see
+ * cally_actor_queue_notify_flush()).
+ *
+ * The children are walked on demand, and the ::actor-added and ::actor-removed
+ * signals of the container are only connected the first time an ATK client
+ * asks for the children (see _cally_actor_track_children()): until then no
+ * client knows about them, so there is nothing to notify, and creating the
+ * accessible objects of every actor added to the scene would be a waste.
+ *
  * Anyway, there are several examples of behaviour changes depending of the current
  * type of the object you are granting access.
  *
@@ -241,9 +254,30 @@ struct _CallyActorPrivate
   guint   action_idle_handler;
   GList  *action_list;
 
+  /* the children known to the ATK clients, in the order of the
+   * container; only kept once the children are tracked, to find
+   * the index of a removed child */
   GList *children;
+
+  /* the properties of the actor notified since the last flush */
+  GSList *pending_notifies;
+
+  guint   children_tracked : 1;
+
+  /* the states last reported to ATK */
+  guint   notified_visible   : 1;
+  guint   notified_sensitive : 1;
 };
 
+/* the minimum interval between two flushes of the notifications,
+ * in milliseconds */
+#define CALLY_NOTIFY_INTERVAL   16
+
+/* the actors with pending notifications, each holding a reference */
+static GQueue  pending_notify_actors = G_QUEUE_INIT;
+static guint   notify_flush_id = 0;
+static GTimer *notify_flush_timer = NULL;
+
 /**
  * cally_actor_new:
  * @actor: a #ClutterActor
@@ -275,14 +309,11 @@ cally_actor_initialize (AtkObject *obj,
                         gpointer   data)
 {
   CallyActor        *self  = NULL;
-  CallyActorPrivate *priv  = NULL;
   ClutterActor     *actor = NULL;
-  guint             handler_id;
 
   ATK_OBJECT_CLASS (cally_actor_parent_class)->initialize (obj, data);
 
   self = CALLY_ACTOR(obj);
-  priv = self->priv;
   actor = CLUTTER_ACTOR (data);
 
   g_signal_connect_after (actor,
@@ -313,36 +344,112 @@ cally_actor_initialize (AtkObject *obj,
   cally_actor_add_action (self, "click", NULL, NULL,
                          _cally_actor_click_action);
 
-  /* Depends if the object implement ClutterContainer */
+  self->priv->notified_visible = CLUTTER_ACTOR_IS_VISIBLE (actor) != FALSE;
+  self->priv->notified_sensitive = CLUTTER_ACTOR_IS_REACTIVE (actor) != FALSE;
+
+  /* Depends if the object implement ClutterContainer; the children
+   * are only tracked once an ATK client asks for them */
   if (CLUTTER_IS_CONTAINER(actor))
+    obj->role = ATK_ROLE_PANEL; /* typically objects implementing ClutterContainer
+                                   interface would be a panel */
+  else
+    obj->role = ATK_ROLE_UNKNOWN;
+}
+
+/*< private >
+ * _cally_actor_track_children:
+ * @cally_actor: a #CallyActor
+ *
+ * Starts tracking the children of the container wrapped by @cally_actor,
+ * to notify the ATK clients when they are added or removed. It is
+ * called the first time a client walks into the children of
+ * @cally_actor, and does nothing after that.
+ */
+void
+_cally_actor_track_children (CallyActor *cally_actor)
+{
+  CallyActorPrivate *priv = cally_actor->priv;
+  ClutterActor      *actor;
+  guint              handler_id;
+
+  if (priv->children_tracked)
+    return;
+
+  actor = CALLY_GET_CLUTTER_ACTOR (cally_actor);
+  if (actor == NULL || !CLUTTER_IS_CONTAINER (actor))
+    return;
+
+  priv->children_tracked = TRUE;
+  priv->children = clutter_container_get_children (CLUTTER_CONTAINER (actor));
+
+  /*
+   * We store the handler ids for these signals in case some objects
+   * need to remove these handlers.
+   */
+  handler_id = g_signal_connect (actor,
+                                 "actor-added",
+                                 G_CALLBACK (cally_actor_add_actor),
+                                 cally_actor);
+  g_object_set_data (G_OBJECT (cally_actor), "cally-add-handler-id",
+                     GUINT_TO_POINTER (handler_id));
+  handler_id = g_signal_connect (actor,
+                                 "actor-removed",
+                                 G_CALLBACK (cally_actor_remove_actor),
+                                 cally_actor);
+  g_object_set_data (G_OBJECT (cally_actor), "cally-remove-handler-id",
+                     GUINT_TO_POINTER (handler_id));
+}
+
+/* the children are walked in place, instead of being copied in a list
+ * by clutter_container_get_children() */
+static gint
+cally_actor_get_child_index (ClutterContainer *container,
+                             ClutterActor     *child)
+{
+  ClutterContainerIter iter;
+  ClutterActor *iter_child;
+  gint index = 0;
+
+  clutter_container_iter_init (&iter, container);
+  while (clutter_container_iter_next (&iter, &iter_child))
     {
-      priv->children = clutter_container_get_children (CLUTTER_CONTAINER (actor));
-
-      /*
-       * We store the handler ids for these signals in case some objects
-       * need to remove these handlers.
-       */
-      handler_id = g_signal_connect (actor,
-                                     "actor-added",
-                                     G_CALLBACK (cally_actor_add_actor),
-                                     obj);
-      g_object_set_data (G_OBJECT (obj), "cally-add-handler-id",
-                         GUINT_TO_POINTER (handler_id));
-      handler_id = g_signal_connect (actor,
-                                     "actor-removed",
-                                     G_CALLBACK (cally_actor_remove_actor),
-                                     obj);
-      g_object_set_data (G_OBJECT (obj), "cally-remove-handler-id",
-                         GUINT_TO_POINTER (handler_id));
-
-      obj->role = ATK_ROLE_PANEL; /* typically objects implementing ClutterContainer
-                                     interface would be a panel */
+      if (iter_child == child)
+        return index;
+
+      index += 1;
     }
-  else
+
+  return -1;
+}
+
+static ClutterActor *
+cally_actor_get_nth_child (ClutterContainer *container,
+                           gint              index,
+                           gint             *n_children)
+{
+  ClutterContainerIter iter;
+  ClutterActor *iter_child, *child = NULL;
+  gint i = 0;
+
+  clutter_container_iter_init (&iter, container);
+  while (clutter_container_iter_next (&iter, &iter_child))
     {
-      priv->children = NULL;
-      obj->role = ATK_ROLE_UNKNOWN;
+      if (i == index)
+        {
+          child = iter_child;
+
+          /* the number of children is not needed */
+          if (n_children == NULL)
+            break;
+        }
+
+      i += 1;
     }
+
+  if (n_children != NULL)
+    *n_children = i;
+
+  return child;
 }
 
 static void
@@ -482,8 +589,6 @@ cally_actor_get_index_in_parent (AtkObject *obj)
   CallyActor    *cally_actor   = NULL;
   ClutterActor *actor        = NULL;
   ClutterActor *parent_actor = NULL;
-  GList        *children     = NULL;
-  gint          index        = -1;
 
   g_return_val_if_fail (CALLY_IS_ACTOR (obj), -1);
 
@@ -517,12 +622,7 @@ cally_actor_get_index_in_parent (AtkObject *obj)
   if ((parent_actor == NULL)||(!CLUTTER_IS_CONTAINER(parent_actor)))
     return -1;
 
-  children = clutter_container_get_children(CLUTTER_CONTAINER(parent_actor));
-
-  index = g_list_index (children, actor);
-  g_list_free (children);
-
-  return index;
+  return cally_actor_get_child_index (CLUTTER_CONTAINER (parent_actor), actor);
 }
 
 static AtkStateSet*
@@ -583,7 +683,6 @@ static gint
 cally_actor_get_n_children (AtkObject *obj)
 {
   ClutterActor     *actor    = NULL;
-  GList            *children = NULL;
   gint              num      = 0;
 
   g_return_val_if_fail (CALLY_IS_ACTOR (obj), 0);
@@ -597,10 +696,9 @@ cally_actor_get_n_children (AtkObject *obj)
 
   if (CLUTTER_IS_CONTAINER (actor))
     {
-      children = clutter_container_get_children (CLUTTER_CONTAINER (actor));
-      num = g_list_length (children);
+      _cally_actor_track_children (CALLY_ACTOR (obj));
 
-      g_list_free (children);
+      cally_actor_get_nth_child (CLUTTER_CONTAINER (actor), -1, &num);
     }
   else
     {
@@ -616,7 +714,6 @@ cally_actor_ref_child (AtkObject *obj,
 {
   ClutterActor     *actor    = NULL;
   ClutterActor     *child    = NULL;
-  GList            *children = NULL;
   AtkObject        *result   = NULL;
 
   g_return_val_if_fail (CALLY_IS_ACTOR (obj), NULL);
@@ -632,13 +729,15 @@ cally_actor_ref_child (AtkObject *obj,
 
   if (CLUTTER_IS_CONTAINER (actor))
     {
-      children = clutter_container_get_children (CLUTTER_CONTAINER (actor));
-      child = g_list_nth_data (children, i);
+      _cally_actor_track_children (CALLY_ACTOR (obj));
+
+      child = cally_actor_get_nth_child (CLUTTER_CONTAINER (actor), i, NULL);
+      if (child == NULL)
+        return NULL;
 
       result = clutter_actor_get_accessible (child);
 
       g_object_ref (result);
-      g_list_free (children);
     }
   else
     {
@@ -698,12 +797,9 @@ cally_actor_real_add_actor (ClutterActor *container,
 
   g_object_notify (G_OBJECT (atk_child), "accessible_parent");
 
-  g_list_free (priv->children);
-
-  priv->children =
-    clutter_container_get_children (CLUTTER_CONTAINER(container));
+  index = cally_actor_get_child_index (CLUTTER_CONTAINER (container), actor);
+  priv->children = g_list_insert (priv->children, actor, index);
 
-  index = g_list_index (priv->children, actor);
   g_signal_emit_by_name (atk_parent, "children_changed::add",
                          index, atk_child, NULL);
 
@@ -742,10 +838,9 @@ cally_actor_real_remove_actor (ClutterActor *container,
 
   priv = CALLY_ACTOR (atk_parent)->priv;
   index = g_list_index (priv->children, actor);
-  g_list_free (priv->children);
-  priv->children = clutter_container_get_children (CLUTTER_CONTAINER(container));
+  priv->children = g_list_remove (priv->children, actor);
 
-  if (index >= 0 && index <= g_list_length (priv->children))
+  if (index >= 0)
     g_signal_emit_by_name (atk_parent, "children_changed::remove",
                            index, atk_child, NULL);
 
@@ -1208,18 +1303,94 @@ cally_actor_real_focus_clutter (ClutterActor *actor,
  *
  * It calls a function for the CallyActor type
  */
+static gboolean
+cally_actor_flush_notifications (gpointer data)
+{
+  CallyActor *cally_actor;
+
+  notify_flush_id = 0;
+  g_timer_start (notify_flush_timer);
+
+  /* notify_clutter() might queue new notifications; they are flushed
+   * at the next frame */
+  while ((cally_actor = g_queue_pop_head (&pending_notify_actors)) != NULL)
+    {
+      CallyActorClass *klass = CALLY_ACTOR_GET_CLASS (cally_actor);
+      ClutterActor    *actor = CALLY_GET_CLUTTER_ACTOR (cally_actor);
+      GSList          *pspecs, *l;
+
+      pspecs = g_slist_reverse (cally_actor->priv->pending_notifies);
+      cally_actor->priv->pending_notifies = NULL;
+
+      /* the actor might have been destroyed in the meantime */
+      if (actor != NULL && klass->notify_clutter != NULL)
+        {
+          for (l = pspecs; l != NULL; l = l->next)
+            klass->notify_clutter (G_OBJECT (actor), l->data);
+        }
+
+      g_slist_free (pspecs);
+      g_object_unref (cally_actor);
+    }
+
+  return FALSE;
+}
+
+/* schedules the flush of the pending notifications after the current
+ * frame has been painted; the master clock dispatches the frames at a
+ * higher priority than the flush */
+static void
+cally_actor_queue_notify_flush (void)
+{
+  gdouble elapsed;
+
+  if (notify_flush_id != 0)
+    return;
+
+  if (G_UNLIKELY (notify_flush_timer == NULL))
+    {
+      notify_flush_timer = g_timer_new ();
+      elapsed = CALLY_NOTIFY_INTERVAL;
+    }
+  else
+    elapsed = g_timer_elapsed (notify_flush_timer, NULL) * 1000.0;
+
+  if (elapsed >= CALLY_NOTIFY_INTERVAL)
+    notify_flush_id =
+      clutter_threads_add_idle_full (G_PRIORITY_DEFAULT_IDLE,
+                                     cally_actor_flush_notifications,
+                                     NULL,
+                                     NULL);
+  else
+    notify_flush_id =
+      clutter_threads_add_timeout_full (G_PRIORITY_DEFAULT_IDLE,
+                                        CALLY_NOTIFY_INTERVAL - (guint) elapsed,
+                                        cally_actor_flush_notifications,
+                                        NULL,
+                                        NULL);
+}
+
 static void
 cally_actor_notify_clutter (GObject    *obj,
                             GParamSpec *pspec)
 {
-  CallyActor      *cally_actor = NULL;
-  CallyActorClass *klass      = NULL;
+  CallyActor        *cally_actor = NULL;
+  CallyActorPrivate *priv        = NULL;
 
   cally_actor = CALLY_ACTOR (clutter_actor_get_accessible (CLUTTER_ACTOR (obj)));
-  klass = CALLY_ACTOR_GET_CLASS (cally_actor);
+  priv = cally_actor->priv;
+
+  /* a property notified several times is only reported once */
+  if (g_slist_find (priv->pending_notifies, pspec) != NULL)
+    return;
 
-  if (klass->notify_clutter)
-    klass->notify_clutter (obj, pspec);
+  if (priv->pending_notifies == NULL)
+    {
+      g_queue_push_tail (&pending_notify_actors, g_object_ref (cally_actor));
+      cally_actor_queue_notify_flush ();
+    }
+
+  priv->pending_notifies = g_slist_prepend (priv->pending_notifies, pspec);
 }
 
 /*
@@ -1236,18 +1407,30 @@ cally_actor_real_notify_clutter (GObject    *obj,
 {
   ClutterActor* actor   = CLUTTER_ACTOR (obj);
   AtkObject*    atk_obj = clutter_actor_get_accessible (CLUTTER_ACTOR(obj));
+  CallyActorPrivate *priv = CALLY_ACTOR (atk_obj)->priv;
   AtkState      state;
   gboolean      value;
 
   if (g_strcmp0 (pspec->name, "visible") == 0)
     {
       state = ATK_STATE_VISIBLE;
-      value = CLUTTER_ACTOR_IS_VISIBLE (actor);
+      value = CLUTTER_ACTOR_IS_VISIBLE (actor) != FALSE;
+
+      /* the actor might have been shown and hidden again */
+      if (value == priv->notified_visible)
+        return;
+
+      priv->notified_visible = value;
     }
   else if (g_strcmp0 (pspec->name, "reactive") == 0)
     {
       state = ATK_STATE_SENSITIVE;
-      value = CLUTTER_ACTOR_IS_REACTIVE (actor);
+      value = CLUTTER_ACTOR_IS_REACTIVE (actor) != FALSE;
+
+      if (value == priv->notified_sensitive)
+        return;
+
+      priv->notified_sensitive = value;
     }
   else
     return;
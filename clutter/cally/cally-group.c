@@ -109,6 +109,8 @@ cally_group_get_n_children (AtkObject *obj)
 
   g_return_val_if_fail (CLUTTER_IS_GROUP(actor), count);
 
+  _cally_actor_track_children (CALLY_ACTOR (obj));
+
   count = clutter_group_get_n_children (CLUTTER_GROUP (actor));
 
   return count;
@@ -128,6 +130,9 @@ cally_group_ref_child (AtkObject *obj,
   actor = CALLY_GET_CLUTTER_ACTOR (obj);
 
   g_return_val_if_fail (CLUTTER_IS_GROUP(actor), NULL);
+
+  _cally_actor_track_children (CALLY_ACTOR (obj));
+
   child = clutter_group_get_nth_child (CLUTTER_GROUP(actor), i);
 
   if (!child)
@@ -72,6 +72,7 @@
 #include "cally-actor-private.h"
 
 #include "clutter-main.h"
+#include "clutter-private.h"
 
 static void cally_text_class_init (CallyTextClass *klass);
 static void cally_text_init       (CallyText *cally_text);
@@ -174,8 +175,8 @@ static AtkAttributeSet*     _cally_misc_add_attribute (AtkAttributeSet *attrib_s
                                                        gchar           *value);
 
 static AtkAttributeSet*     _cally_misc_layout_get_run_attributes (AtkAttributeSet *attrib_set,
+                                                                   ClutterText     *clutter_text,
                                                                    PangoLayout     *layout,
-                                                                   gchar           *text,
                                                                    gint            offset,
                                                                    gint            *start_offset,
                                                                    gint            *end_offset);
@@ -419,30 +420,26 @@ static gunichar
 cally_text_get_character_at_offset (AtkText *text,
                                     gint     offset)
 {
-  ClutterActor *actor      = NULL;
-  gchar        *string     = NULL;
-  gchar        *index      = NULL;
-  gunichar      unichar;
+  ClutterActor *actor        = NULL;
+  ClutterText  *clutter_text = NULL;
+  const gchar  *string       = NULL;
+  gint          index;
 
   actor = CALLY_GET_CLUTTER_ACTOR (text);
   if (actor == NULL) /* State is defunct */
     return '\0';
 
-  string = clutter_text_get_chars (CLUTTER_TEXT (actor), 0, -1);
-  if (offset >= g_utf8_strlen (string, -1))
-    {
-      unichar = '\0';
-    }
-  else
-    {
-      index = g_utf8_offset_to_pointer (string, offset);
+  clutter_text = CLUTTER_TEXT (actor);
 
-      unichar = g_utf8_get_char(index);
-    }
+  /* avoid copying the contents: screen readers query each character
+     while the user navigates the text */
+  if (offset < 0 || offset >= _clutter_text_get_n_chars (clutter_text))
+    return '\0';
 
-  g_free(string);
+  string = clutter_text_get_text (clutter_text);
+  index = _clutter_text_offset_to_index (clutter_text, offset);
 
-  return unichar;
+  return g_utf8_get_char (string + index);
 }
 
 static gchar*
@@ -581,7 +578,7 @@ cally_text_get_character_count (AtkText *text)
     return 0;
 
   clutter_text = CLUTTER_TEXT (actor);
-  return g_utf8_strlen (clutter_text_get_text (clutter_text), -1);
+  return _clutter_text_get_n_chars (clutter_text);
 }
 
 static gint
@@ -750,8 +747,8 @@ cally_text_get_run_attributes (AtkText *text,
   clutter_text = CLUTTER_TEXT (actor);
 
   at_set = _cally_misc_layout_get_run_attributes (at_set,
+                                                  clutter_text,
                                                   clutter_text_get_layout (clutter_text),
-                                                  (gchar*)clutter_text_get_text (clutter_text),
                                                   offset,
                                                   start_offset,
                                                   end_offset);
@@ -1105,14 +1102,16 @@ _cally_misc_add_attribute (AtkAttributeSet *attrib_set,
  * _cally_misc_layout_get_run_attributes:
  *
  * Reimplementation of gail_misc_layout_get_run_attributes (check this
- * function for more documentation).
+ * function for more documentation). The offsets are converted using
+ * the cached length and offsets of @clutter_text, instead of walking
+ * its contents.
  *
  * Returns: A pointer to the #AtkAttributeSet.
  **/
 static AtkAttributeSet*
 _cally_misc_layout_get_run_attributes (AtkAttributeSet *attrib_set,
+                                       ClutterText     *clutter_text,
                                        PangoLayout     *layout,
-                                       gchar           *text,
                                        gint            offset,
                                        gint            *start_offset,
                                        gint            *end_offset)
@@ -1129,7 +1128,7 @@ _cally_misc_layout_get_run_attributes (AtkAttributeSet *attrib_set,
   gchar *value = NULL;
   glong len;
 
-  len = g_utf8_strlen (text, -1);
+  len = _clutter_text_get_n_chars (clutter_text);
   /* Grab the attributes of the PangoLayout, if any */
   if ((attr = pango_layout_get_attributes (layout)) == NULL)
     {
@@ -1145,20 +1144,20 @@ _cally_misc_layout_get_run_attributes (AtkAttributeSet *attrib_set,
   else if (offset < 0)
     offset = 0;
 
-  index = g_utf8_offset_to_pointer (text, offset) - text;
+  index = _clutter_text_offset_to_index (clutter_text, offset);
   pango_attr_iterator_range (iter, &start_index, &end_index);
   while (is_next)
     {
       if (index >= start_index && index < end_index)
         {
-          *start_offset = g_utf8_pointer_to_offset (text,
-                                                    text + start_index);
+          *start_offset = _clutter_text_index_to_offset (clutter_text,
+                                                         start_index);
           if (end_index == G_MAXINT)
           /* Last iterator */
-            end_index = len;
-
-          *end_offset = g_utf8_pointer_to_offset (text,
-                                                  text + end_index);
+            *end_offset = len;
+          else
+            *end_offset = _clutter_text_index_to_offset (clutter_text,
+                                                         end_index);
           break;
         }
       is_next = pango_attr_iterator_next (iter);
@@ -45,6 +45,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <clutter/clutter.h>
+#include "clutter-actor-private.h"
 
 #include "cally-util.h"
 #include "cally-root.h"
@@ -71,6 +72,7 @@ static guint                 add_listener	                     (GSignalEmissionH
                                                                       const gchar         *object_type,
                                                                       const gchar         *signal,
                                                                       const gchar         *hook_data);
+static gboolean              is_actor_signal                         (guint                signal_id);
 static void                  cally_util_simulate_snooper_install     (void);
 static void                  cally_util_simulate_snooper_remove      (void);
 static gboolean              cally_key_snooper                       (ClutterActor *actor,
@@ -240,6 +242,9 @@ cally_util_remove_global_event_listener (guint remove_listener)
               g_signal_remove_emission_hook(listener_info->signal_id,
                                             listener_info->hook_id);
 
+              if (is_actor_signal (listener_info->signal_id))
+                _clutter_actor_remove_event_emission_hook ();
+
               /* Remove the element from the hash */
               g_hash_table_remove(listener_list, &tmp_idx);
             }
@@ -305,6 +310,16 @@ _listener_info_destroy (gpointer data)
   g_free(data);
 }
 
+static gboolean
+is_actor_signal (guint signal_id)
+{
+  GSignalQuery query;
+
+  g_signal_query (signal_id, &query);
+
+  return g_type_is_a (query.itype, CLUTTER_TYPE_ACTOR);
+}
+
 static guint
 add_listener (GSignalEmissionHook listener,
               const gchar         *object_type,
@@ -333,6 +348,11 @@ add_listener (GSignalEmissionHook listener,
                                         (GDestroyNotify) g_free);
           listener_info->signal_id = signal_id;
 
+          /* actors skip the emission of the event signals without
+           * handlers, unless we tell them about the hook */
+          if (is_actor_signal (signal_id))
+            _clutter_actor_add_event_emission_hook ();
+
 	  g_hash_table_insert(listener_list, &(listener_info->key), listener_info);
           listener_idx++;
         }
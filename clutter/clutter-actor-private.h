@@ -23,6 +23,7 @@
 #define __CLUTTER_ACTOR_PRIVATE_H__
 
 #include <clutter/clutter-actor.h>
+#include <clutter/clutter-stage.h>
 
 G_BEGIN_DECLS
 
@@ -153,6 +154,7 @@ void _clutter_actor_queue_redraw_full        (ClutterActor              *self,
                                               ClutterEffect             *effect);
 
 ClutterPaintVolume *_clutter_actor_get_queue_redraw_clip (ClutterActor *self);
+ClutterPaintVolume *_clutter_actor_get_last_paint_volume (ClutterActor *self);
 void _clutter_actor_set_queue_redraw_clip     (ClutterActor             *self,
                                                ClutterPaintVolume *clip_volume);
 void _clutter_actor_finish_queue_redraw       (ClutterActor             *self,
@@ -167,8 +169,89 @@ G_CONST_RETURN gchar *_clutter_actor_get_debug_name (ClutterActor *self);
 void _clutter_actor_push_clone_paint (void);
 void _clutter_actor_pop_clone_paint  (void);
 
+guint _clutter_actor_get_n_painted             (void);
+guint _clutter_actor_get_n_culled              (void);
+guint _clutter_actor_get_n_allocated           (void);
+guint _clutter_actor_get_n_size_requests       (void);
+guint _clutter_actor_get_n_cached_size_requests (void);
+
 guint32 _clutter_actor_get_pick_id (ClutterActor *self);
 
+void _clutter_actor_add_event_emission_hook    (void);
+void _clutter_actor_remove_event_emission_hook (void);
+
+/*< private >
+ * ClutterActorCanPickFunc:
+ * @actor: a #ClutterActor
+ *
+ * Checks whether the silhouette that @actor paints in pick mode is
+ * currently its allocation.
+ *
+ * Return value: %TRUE if @actor can be picked geometrically
+ */
+typedef gboolean (* ClutterActorCanPickFunc) (ClutterActor *actor);
+
+/*< private >
+ * ClutterActorHitTestFunc:
+ * @actor: a #ClutterActor
+ * @x: the X coordinate, relative to the allocation of @actor
+ * @y: the Y coordinate, relative to the allocation of @actor
+ *
+ * Checks whether the pick silhouette of @actor covers a point inside
+ * its allocation.
+ *
+ * Return value: %TRUE if the point is covered
+ */
+typedef gboolean (* ClutterActorHitTestFunc) (ClutterActor *actor,
+                                              gfloat        x,
+                                              gfloat        y);
+
+void     _clutter_actor_class_register_geometric_pick (ClutterActorClass       *klass,
+                                                       gboolean                 pick_children,
+                                                       ClutterActorCanPickFunc  can_pick,
+                                                       ClutterActorHitTestFunc  hit_test);
+gboolean _clutter_actor_geometric_pick                (ClutterActor            *self,
+                                                       ClutterPickMode          mode,
+                                                       gfloat                   x,
+                                                       gfloat                   y,
+                                                       guint                    index_stamp,
+                                                       ClutterActor           **actor_out);
+gboolean _clutter_actor_get_exclusive_pick_quad       (ClutterActor            *self,
+                                                       ClutterPickMode          mode,
+                                                       ClutterVertex            verts[]);
+gboolean _clutter_actor_point_in_quad                 (const ClutterVertex      verts[],
+                                                       gfloat                   x,
+                                                       gfloat                   y);
+
+void     _clutter_actor_compute_occlusion             (ClutterActor            *self);
+
+void     _clutter_actor_paint_opaque_pass             (ClutterActor            *self);
+void     _clutter_actor_finish_opaque_pass            (ClutterActor            *self);
+
+void     _clutter_actor_relayout_boundary             (ClutterActor            *self);
+guint    _clutter_actor_get_allocation_serial         (ClutterActor            *self);
+void     _clutter_actor_finish_geometry_change        (ClutterActor            *self,
+                                                       gboolean                 emit);
+void     _clutter_actor_set_layout_offset             (ClutterActor            *self,
+                                                       gfloat                   offset_x,
+                                                       gfloat                   offset_y);
+void     _clutter_actor_reapply_constraints           (ClutterActor            *self);
+
+ClutterActor *_clutter_actor_get_depth_changed_child  (ClutterActor            *self);
+
+gboolean _clutter_actor_get_visible_box               (ClutterActor            *self,
+                                                       ClutterActorBox         *box);
+
+void     _clutter_actor_begin_update                  (ClutterActor            *self);
+void     _clutter_actor_end_update                    (ClutterActor            *self);
+
+ClutterChildMeta * _clutter_actor_get_child_meta     (ClutterActor            *self);
+void               _clutter_actor_set_child_meta     (ClutterActor            *self,
+                                                      ClutterChildMeta        *meta);
+ClutterLayoutMeta *_clutter_actor_get_layout_meta    (ClutterActor            *self);
+void               _clutter_actor_set_layout_meta    (ClutterActor            *self,
+                                                      ClutterLayoutMeta       *meta);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_ACTOR_PRIVATE_H__ */
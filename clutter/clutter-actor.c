@@ -284,6 +284,9 @@
 #include "config.h"
 #endif
 
+#include <math.h>
+#include <string.h>
+
 #include "cogl/cogl.h"
 
 #include "clutter-actor-private.h"
@@ -295,11 +298,13 @@
 #include "clutter-constraint.h"
 #include "clutter-container.h"
 #include "clutter-debug.h"
+#include "clutter-display-list.h"
 #include "clutter-effect-private.h"
 #include "clutter-enum-types.h"
 #include "clutter-main.h"
 #include "clutter-marshal.h"
 #include "clutter-flatten-effect.h"
+#include "clutter-offscreen-effect-private.h"
 #include "clutter-paint-volume-private.h"
 #include "clutter-private.h"
 #include "clutter-profile.h"
@@ -337,9 +342,84 @@ struct _AnchorCoord
   } v;
 };
 
-/* 3 entries should be a good compromise, few layout managers
- * will ask for 3 different preferred size in each allocation cycle */
-#define N_CACHED_SIZE_REQUESTS 3
+/* the transformations that are rarely set on an actor; stored out of
+ * line so that they do not take space inside every ClutterActorPrivate
+ */
+typedef struct _TransformInfo TransformInfo;
+struct _TransformInfo
+{
+  /* Rotation angles */
+  gdouble rxang;
+  gdouble ryang;
+  gdouble rzang;
+
+  /* Rotation centers */
+  AnchorCoord rx_center;
+  AnchorCoord ry_center;
+  AnchorCoord rz_center;
+
+  gdouble scale_x;
+  gdouble scale_y;
+  AnchorCoord scale_center;
+
+  /* Anchor point coordinates */
+  AnchorCoord anchor;
+};
+
+/* the state that is not used when painting or picking, and that most
+ * actors never set */
+typedef struct _ExtraInfo ExtraInfo;
+struct _ExtraInfo
+{
+  gchar *name;
+
+  PangoContext *pango_context;
+
+  ClutterTextDirection text_direction;
+
+  ClutterOffscreenRedirect offscreen_redirect;
+
+  /* This is an internal effect used to implement the
+     offscreen-redirect property */
+  ClutterEffect *flatten_effect;
+
+  /* the size, in bytes, accounted to the flatten effect when it was
+   * added automatically to cache the image of a static subtree; 0
+   * if the effect is not there or if it was requested */
+  gsize subtree_cache_size;
+
+  /* the paint of the subtree recorded the last time the actor was
+   * painted, if it did not change in the previous frames */
+  ClutterDisplayList *display_list;
+
+  ClutterMetaGroup *actions;
+  ClutterMetaGroup *constraints;
+  ClutterMetaGroup *effects;
+
+  /* the allocation given by the parent before the constraints were
+   * applied, used by _clutter_actor_reapply_constraints() */
+  ClutterActorBox constraint_box;
+  ClutterAllocationFlags constraint_flags;
+  guint has_constraint_box : 1;
+
+  /* the mapping from the stage to the allocation of the actor used by
+   * clutter_actor_transform_stage_point(), with the allocation size
+   * and the projection serial of the stage it was computed for; it is
+   * only valid if stage_point_valid is set */
+  gfloat stage_point_inverse[3][3];
+  gfloat stage_point_width;
+  gfloat stage_point_height;
+  guint stage_point_serial;
+};
+
+/* height-for-width layout managers, like ClutterFlowLayout and
+ * ClutterTableLayout, probe their children for many different sizes
+ * in each allocation cycle, so each actor keeps a small hash table of
+ * size requests, indexed by the for_size. The number of entries is
+ * returned by _clutter_context_get_size_cache_size(); a cache miss
+ * replaces the oldest entry among the SIZE_REQUEST_N_PROBES slots
+ * following the hashed one */
+#define SIZE_REQUEST_N_PROBES   4
 typedef struct _SizeRequest SizeRequest;
 struct _SizeRequest
 {
@@ -349,6 +429,20 @@ struct _SizeRequest
   gfloat natural_size;
 };
 
+/* the inputs of the screen-space box of an actor besides the
+ * transformations: the paint volume of the actor, relative to itself,
+ * and the size of its allocation */
+typedef struct _PaintBoxKey PaintBoxKey;
+struct _PaintBoxKey
+{
+  ClutterVertex origin;
+  gfloat width;
+  gfloat height;
+  gfloat depth;
+  gfloat allocation_width;
+  gfloat allocation_height;
+};
+
 /* Internal enum used to control mapped state update.  This is a hint
  * which indicates when to do something other than just enforce
  * invariants.
@@ -368,30 +462,43 @@ typedef enum {
 
 struct _ClutterActorPrivate
 {
-  /* fixed_x, fixed_y, and the allocation box are all in parent
-   * coordinates.
+  /* the state used by each paint and pick traversal comes first, so
+   * that walking a large scene graph touches as few cache lines per
+   * actor as possible; the state that is rarely set is stored inside
+   * the lazily allocated TransformInfo and ExtraInfo structures
    */
-  gfloat fixed_x;
-  gfloat fixed_y;
+  ClutterActor   *parent_actor;
+  GList          *children;
+  gint            n_children;
 
-  /* request mode */
-  ClutterRequestMode request_mode;
+  ClutterActorBox allocation;
+  ClutterAllocationFlags allocation_flags;
 
-  /* our cached size requests for different width / height */
-  SizeRequest width_requests[N_CACHED_SIZE_REQUESTS];
-  SizeRequest height_requests[N_CACHED_SIZE_REQUESTS];
+  /* changes every time the allocation changes; see
+   * _clutter_actor_get_allocation_serial() */
+  guint allocation_serial;
 
-  /* An age of 0 means the entry is not set */
-  guint cached_height_age;
-  guint cached_width_age;
+  /* the allocation before the first change since the last time
+   * ::geometry-changed was emitted */
+  ClutterActorBox geometry_old_allocation;
 
-  gfloat request_min_width;
-  gfloat request_min_height;
-  gfloat request_natural_width;
-  gfloat request_natural_height;
+  /* depth */
+  gfloat z;
 
-  ClutterActorBox allocation;
-  ClutterAllocationFlags allocation_flags;
+  /* translation applied at paint time, on top of the allocation */
+  gfloat translation_x;
+  gfloat translation_y;
+
+  /* offset set by a layout manager animating its children, applied
+   * at paint time on top of the translation */
+  gfloat layout_offset_x;
+  gfloat layout_offset_y;
+
+  guint8 opacity;
+  gint   opacity_override;
+
+  guint32         id; /* Unique ID */
+  gint32 pick_id;
 
   guint position_set                : 1;
   guint min_width_set               : 1;
@@ -404,6 +511,8 @@ struct _ClutterActorPrivate
   guint needs_height_request        : 1;
   /* cached allocation is invalid (request has changed, probably) */
   guint needs_allocation            : 1;
+  /* the relayout being queued comes from a child */
+  guint relayout_from_child         : 1;
   guint show_on_set_parent          : 1;
   guint has_clip                    : 1;
   guint clip_to_allocation          : 1;
@@ -411,60 +520,147 @@ struct _ClutterActorPrivate
   guint enable_paint_unmapped       : 1;
   guint has_pointer                 : 1;
   guint propagated_one_redraw       : 1;
+  /* valid if opaque_pass_stamp is the one of the current pass */
+  guint opaque_pass_unordered       : 1;
+  guint opaque_pass_painted         : 1;
   guint paint_volume_valid          : 1;
   guint last_paint_volume_valid     : 1;
   guint in_clone_paint              : 1;
   guint transform_valid             : 1;
+  guint stage_transform_valid       : 1;
+  /* cleared together with stage_transform_valid */
+  guint stage_point_valid           : 1;
+  guint paint_box_key_valid         : 1;
+  guint paint_box_in_front          : 1;
+  /* a redraw or a relayout was deferred until the end of an update */
+  guint update_needs_redraw         : 1;
+  guint update_needs_relayout       : 1;
+  /* the stage-relative transformation was invalidated since the
+   * last paint */
+  guint stage_transform_changed     : 1;
+  /* the cached result of needs_flatten_effect(); it is valid only if
+   * both flatten_valid and paint_opacity_valid are set */
+  guint needs_flatten               : 1;
+  guint flatten_valid               : 1;
+  /* cleared together with the one of all the descendants when the
+   * paint opacity of the actor might have changed */
+  guint paint_opacity_valid         : 1;
+  /* whether paint_opacity holds the current paint opacity; cleared
+   * together with paint_opacity_valid */
+  guint paint_opacity_cached        : 1;
+
+  /* the number of frames painted since the actor, or one of its
+   * children, last queued a redraw, and since the actor last moved
+   * on the stage; both saturate at G_MAXUINT8 */
+  guint8 frames_since_redraw;
+  guint8 frames_since_move;
+
+  /* recording the subtree into a display list failed, and will not
+   * be attempted again until the actor queues a redraw */
+  guint display_list_failed         : 1;
+
+  /* whether the actor is accounted as reactive in the
+   * n_reactive_descendants of its ancestors */
+  guint counted_reactive            : 1;
+
+  /* ::geometry-changed will be emitted at the end of the relayout */
+  guint geometry_change_queued      : 1;
+
+  /* the number of reactive actors in the sub-tree of the actor, not
+   * counting the actor itself; sub-trees without any are not painted
+   * when picking only the reactive actors */
+  guint n_reactive_descendants;
+
+  /* the opacity of the actor composited with the one of its
+   * ancestors, see clutter_actor_get_paint_opacity_internal() */
+  guint8 paint_opacity;
 
   gfloat clip[4];
 
-  /* Rotation angles */
-  gdouble rxang;
-  gdouble ryang;
-  gdouble rzang;
+  /* used when painting, to update the paint volume */
+  ClutterEffect *current_effect;
 
-  /* Rotation center: X axis */
-  AnchorCoord rx_center;
+  /* This is used when painting effects to implement the
+     clutter_actor_continue_paint() function. It points to the node in
+     the list of effects that is next in the chain */
+  const GList *next_effect_to_paint;
 
-  /* Rotation center: Y axis */
-  AnchorCoord ry_center;
+  /* the rotation, scale and anchor point; NULL if none of them
+   * has ever been set */
+  TransformInfo *transform_info;
 
-  /* Rotation center: Z axis */
-  AnchorCoord rz_center;
+  /* the name, the meta groups and the other rarely used state */
+  ExtraInfo *extra_info;
 
-  /* Anchor point coordinates */
-  AnchorCoord anchor;
+  CoglMatrix transform;
 
-  /* depth */
-  gfloat z;
+  /* the transformation of the actor relative to the stage, built
+   * from the transformations of all the ancestors; it is only valid
+   * if stage_transform_valid is set */
+  CoglMatrix stage_transform;
 
-  CoglMatrix transform;
+  ClutterPaintVolume paint_volume;
 
-  guint8 opacity;
-  gint   opacity_override;
+  /* NB: This volume isn't relative to this actor, it is in eye
+   * coordinates so that it can remain valid after the actor changes.
+   */
+  ClutterPaintVolume last_paint_volume;
 
-  ClutterOffscreenRedirect offscreen_redirect;
+  /* the layout state follows */
 
-  /* This is an internal effect used to implement the
-     offscreen-redirect property */
-  ClutterEffect  *flatten_effect;
+  /* fixed_x, fixed_y, and the allocation box are all in parent
+   * coordinates.
+   */
+  gfloat fixed_x;
+  gfloat fixed_y;
 
-  ClutterActor   *parent_actor;
-  GList          *children;
-  gint            n_children;
+  /* request mode */
+  ClutterRequestMode request_mode;
 
-  gchar          *name;
-  guint32         id; /* Unique ID */
+  /* our cached size requests for different width / height; both
+   * tables are allocated lazily, in a single block */
+  SizeRequest *width_requests;
+  SizeRequest *height_requests;
+  guint n_cached_requests;
 
-  gint32 pick_id;
+  /* An age of 0 means the entry is not set */
+  guint cached_height_age;
+  guint cached_width_age;
+
+  gfloat request_min_width;
+  gfloat request_min_height;
+  gfloat request_natural_width;
+  gfloat request_natural_height;
 
-  gdouble         scale_x;
-  gdouble         scale_y;
-  AnchorCoord     scale_center;
+  /* the meta data that the parent container and its layout manager
+   * attach to the actor; both are owned by the actor, and they are
+   * stored here instead of as qdata because layout managers look them
+   * up for every child on each size request and allocation */
+  ClutterChildMeta *child_meta;
+  ClutterLayoutMeta *layout_meta;
 
-  PangoContext   *pango_context;
+  /* the nesting level of _clutter_actor_begin_update() */
+  guint update_depth;
 
-  ClutterTextDirection text_direction;
+  /* the stamp of the occlusion pass that found the actor to be
+   * hidden behind opaque actors painted after it */
+  guint occlusion_stamp;
+
+  /* the stamp of the opaque pass that ordered the actor, and the
+   * positions of the actor and of what it paints after its children
+   * in the painting order of the stage */
+  guint opaque_pass_stamp;
+  guint opaque_pass_order;
+  guint opaque_pass_end_order;
+
+  /* the screen-space box covered by the actor when it was last
+   * painted, in the spatial index of the stage */
+  ClutterStageIndexNode index_node;
+
+  /* the local paint volume and the allocation size that the box in
+   * index_node was computed from; only valid if paint_box_key_valid
+   * is set */
+  PaintBoxKey paint_box_key;
 
   gint internal_child;
 
@@ -474,13 +670,6 @@ struct _ClutterActorPrivate
    */
   ClutterPaintVolume *oob_queue_redraw_clip;
 
-  ClutterMetaGroup *actions;
-  ClutterMetaGroup *constraints;
-  ClutterMetaGroup *effects;
-
-  /* used when painting, to update the paint volume */
-  ClutterEffect *current_effect;
-
   /* This is used to store an effect which needs to be redrawn. A
      redraw can be queued to start from a particular effect. This is
      used by parametrised effects that can cache an image of the
@@ -488,21 +677,88 @@ struct _ClutterActorPrivate
      redraw the cached image, not the actual actor */
   ClutterEffect *effect_to_redraw;
 
-  ClutterPaintVolume paint_volume;
+  ClutterStageQueueRedrawEntry *queue_redraw_entry;
 
-  /* This is used when painting effects to implement the
-     clutter_actor_continue_paint() function. It points to the node in
-     the list of effects that is next in the chain */
-  const GList *next_effect_to_paint;
+  /* the stamp of the queued redraws the stage was finishing when an
+   * unclipped redraw of the actor was last propagated */
+  guint propagated_redraw_stamp;
+};
 
-  /* NB: This volume isn't relative to this actor, it is in eye
-   * coordinates so that it can remain valid after the actor changes.
-   */
-  ClutterPaintVolume last_paint_volume;
+static const TransformInfo default_transform_info = {
+  0.0, 0.0, 0.0,                /* rotation angles */
+  { FALSE, },                   /* rotation centers */
+  { FALSE, },
+  { FALSE, },
+  1.0, 1.0,                     /* scale factors */
+  { FALSE, },                   /* scale center */
+  { FALSE, },                   /* anchor point */
+};
 
-  ClutterStageQueueRedrawEntry *queue_redraw_entry;
+static const ExtraInfo default_extra_info = {
+  NULL,                         /* name */
+  NULL,                         /* pango context */
+  CLUTTER_TEXT_DIRECTION_DEFAULT,
+  CLUTTER_OFFSCREEN_REDIRECT_AUTOMATIC_FOR_OPACITY,
+  NULL,                         /* flatten effect */
+  0,                            /* subtree cache size */
+  NULL,                         /* display list */
+  NULL, NULL, NULL,             /* actions, constraints, effects */
+  { 0, },                       /* constraint box */
+  CLUTTER_ALLOCATION_NONE,      /* constraint flags */
+  FALSE,                        /* has constraint box */
 };
 
+/* returns the TransformInfo of @self, or the default values if none
+ * of the transformations has been set; since the defaults are shared,
+ * the returned pointer should not be kept around across a call that
+ * might set a transformation
+ */
+static inline const TransformInfo *
+clutter_actor_get_transform_info_or_defaults (ClutterActor *self)
+{
+  if (self->priv->transform_info != NULL)
+    return self->priv->transform_info;
+
+  return &default_transform_info;
+}
+
+static TransformInfo *
+clutter_actor_get_transform_info (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  if (priv->transform_info == NULL)
+    {
+      priv->transform_info = g_slice_new (TransformInfo);
+      *priv->transform_info = default_transform_info;
+    }
+
+  return priv->transform_info;
+}
+
+static inline const ExtraInfo *
+clutter_actor_get_extra_info_or_defaults (ClutterActor *self)
+{
+  if (self->priv->extra_info != NULL)
+    return self->priv->extra_info;
+
+  return &default_extra_info;
+}
+
+static ExtraInfo *
+clutter_actor_get_extra_info (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  if (priv->extra_info == NULL)
+    {
+      priv->extra_info = g_slice_new (ExtraInfo);
+      *priv->extra_info = default_extra_info;
+    }
+
+  return priv->extra_info;
+}
+
 enum
 {
   PROP_0,
@@ -546,6 +802,9 @@ enum
 
   PROP_DEPTH,
 
+  PROP_TRANSLATION_X,
+  PROP_TRANSLATION_Y,
+
   PROP_CLIP,
   PROP_HAS_CLIP,
   PROP_CLIP_TO_ALLOCATION,
@@ -619,12 +878,22 @@ enum
   ENTER_EVENT,
   LEAVE_EVENT,
   ALLOCATION_CHANGED,
+  GEOMETRY_CHANGED,
 
   LAST_SIGNAL
 };
 
 static guint actor_signals[LAST_SIGNAL] = { 0, };
 
+/* the id of GObject::notify and the details for the geometry
+ * properties, to check for handlers before notifying */
+static guint notify_signal_id = 0;
+static GQuark quark_notify_x = 0;
+static GQuark quark_notify_y = 0;
+static GQuark quark_notify_width = 0;
+static GQuark quark_notify_height = 0;
+static GQuark quark_notify_allocation = 0;
+
 static void clutter_scriptable_iface_init (ClutterScriptableIface *iface);
 static void clutter_animatable_iface_init (ClutterAnimatableIface *iface);
 static void atk_implementor_iface_init    (AtkImplementorIface    *iface);
@@ -680,6 +949,12 @@ static void _clutter_actor_get_relative_modelview (ClutterActor *self,
                                                    ClutterActor *ancestor,
                                                    CoglMatrix *matrix);
 
+static void clutter_actor_invalidate_transform (ClutterActor *self);
+static void clutter_actor_invalidate_stage_transform (ClutterActor *self);
+static void clutter_actor_drop_subtree_cache (ClutterActor *self);
+static void clutter_actor_drop_display_list (ClutterActor *self);
+static void clutter_actor_invalidate_paint_opacity (ClutterActor *self);
+
 static ClutterPaintVolume *_clutter_actor_get_paint_volume_mutable (ClutterActor *self);
 
 /* Helper macro which translates by the anchor coord, applies the
@@ -706,8 +981,9 @@ G_DEFINE_ABSTRACT_TYPE_WITH_CODE (ClutterActor,
 G_CONST_RETURN gchar *
 _clutter_actor_get_debug_name (ClutterActor *actor)
 {
-  return actor->priv->name != NULL ? actor->priv->name
-                                   : G_OBJECT_TYPE_NAME (actor);
+  const ExtraInfo *extra = clutter_actor_get_extra_info_or_defaults (actor);
+
+  return extra->name != NULL ? extra->name : G_OBJECT_TYPE_NAME (actor);
 }
 
 #ifdef CLUTTER_ENABLE_DEBUG
@@ -1052,6 +1328,46 @@ clutter_actor_update_map_state (ClutterActor  *self,
 #endif
 }
 
+/* adds @delta to the number of reactive descendants of all the
+ * ancestors of @self */
+static void
+clutter_actor_add_reactive_descendants (ClutterActor *self,
+                                        gint          delta)
+{
+  ClutterActor *iter;
+
+  if (delta == 0)
+    return;
+
+  for (iter = self->priv->parent_actor;
+       iter != NULL;
+       iter = iter->priv->parent_actor)
+    iter->priv->n_reactive_descendants += delta;
+}
+
+/* the reactive flag can also be set directly with the
+ * CLUTTER_ACTOR_SET_FLAGS() macro, so the accounting is checked
+ * again whenever the actor is mapped or added to a parent */
+static void
+clutter_actor_sync_reactive (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  gboolean reactive = CLUTTER_ACTOR_IS_REACTIVE (self);
+  ClutterActor *stage;
+
+  if (reactive == priv->counted_reactive)
+    return;
+
+  priv->counted_reactive = reactive;
+
+  clutter_actor_add_reactive_descendants (self, reactive ? 1 : -1);
+
+  /* changing the reactive flag does not queue a redraw */
+  stage = _clutter_actor_get_stage_internal (self);
+  if (stage != NULL)
+    _clutter_stage_invalidate_pick (CLUTTER_STAGE (stage));
+}
+
 static void
 clutter_actor_real_map (ClutterActor *self)
 {
@@ -1066,6 +1382,8 @@ clutter_actor_real_map (ClutterActor *self)
 
   CLUTTER_ACTOR_SET_FLAGS (self, CLUTTER_ACTOR_MAPPED);
 
+  clutter_actor_sync_reactive (self);
+
   stage = _clutter_actor_get_stage_internal (self);
   priv->pick_id = _clutter_stage_acquire_pick_id (CLUTTER_STAGE (stage), self);
   CLUTTER_NOTE (ACTOR, "Pick id '%d' for actor '%s'",
@@ -1142,6 +1460,13 @@ clutter_actor_real_unmap (ClutterActor *self)
   _clutter_paint_volume_init_static (&priv->last_paint_volume, NULL);
   priv->last_paint_volume_valid = TRUE;
 
+  /* the box in the spatial index was computed with the old volume */
+  _clutter_stage_index_node_remove (&priv->index_node);
+
+  /* an actor that is not painted should not use the cache budget */
+  clutter_actor_drop_subtree_cache (self);
+  clutter_actor_drop_display_list (self);
+
   /* notify on parent mapped after potentially unmapping
    * children, so apps see a bottom-up notification.
    */
@@ -1765,12 +2090,40 @@ clutter_actor_store_old_geometry (ClutterActor    *self,
   *box = self->priv->allocation;
 }
 
+/* GObject queues and dispatches a notification even if nobody is
+ * listening to it; during a relayout most actors have no handler at
+ * all, so we check before notifying the geometry properties, unless
+ * a sub-class intercepts the notifications itself
+ */
+static inline gboolean
+clutter_actor_has_notify_handler (ClutterActor *self,
+                                  GQuark        detail)
+{
+  GObjectClass *klass = G_OBJECT_GET_CLASS (self);
+
+  if (G_UNLIKELY (klass->notify != NULL ||
+                  klass->dispatch_properties_changed !=
+                  G_OBJECT_CLASS (clutter_actor_parent_class)->dispatch_properties_changed))
+    return TRUE;
+
+  return g_signal_has_handler_pending (self, notify_signal_id, detail, FALSE);
+}
+
 static inline void
 clutter_actor_notify_if_geometry_changed (ClutterActor          *self,
                                           const ClutterActorBox *old)
 {
   ClutterActorPrivate *priv = self->priv;
   GObject *obj = G_OBJECT (self);
+  gboolean notify_x, notify_y, notify_width, notify_height;
+
+  notify_x = clutter_actor_has_notify_handler (self, quark_notify_x);
+  notify_y = clutter_actor_has_notify_handler (self, quark_notify_y);
+  notify_width = clutter_actor_has_notify_handler (self, quark_notify_width);
+  notify_height = clutter_actor_has_notify_handler (self, quark_notify_height);
+
+  if (!notify_x && !notify_y && !notify_width && !notify_height)
+    return;
 
   g_object_freeze_notify (obj);
 
@@ -1787,15 +2140,21 @@ clutter_actor_notify_if_geometry_changed (ClutterActor          *self,
    */
   if (priv->needs_allocation)
     {
-      g_object_notify_by_pspec (obj, obj_props[PROP_X]);
-      g_object_notify_by_pspec (obj, obj_props[PROP_Y]);
-      g_object_notify_by_pspec (obj, obj_props[PROP_WIDTH]);
-      g_object_notify_by_pspec (obj, obj_props[PROP_HEIGHT]);
+      if (notify_x)
+        g_object_notify_by_pspec (obj, obj_props[PROP_X]);
+      if (notify_y)
+        g_object_notify_by_pspec (obj, obj_props[PROP_Y]);
+      if (notify_width)
+        g_object_notify_by_pspec (obj, obj_props[PROP_WIDTH]);
+      if (notify_height)
+        g_object_notify_by_pspec (obj, obj_props[PROP_HEIGHT]);
     }
   else if (priv->needs_width_request || priv->needs_height_request)
     {
-      g_object_notify_by_pspec (obj, obj_props[PROP_WIDTH]);
-      g_object_notify_by_pspec (obj, obj_props[PROP_HEIGHT]);
+      if (notify_width)
+        g_object_notify_by_pspec (obj, obj_props[PROP_WIDTH]);
+      if (notify_height)
+        g_object_notify_by_pspec (obj, obj_props[PROP_HEIGHT]);
     }
   else
     {
@@ -1807,22 +2166,27 @@ clutter_actor_notify_if_geometry_changed (ClutterActor          *self,
       widthu = priv->allocation.x2 - priv->allocation.x1;
       heightu = priv->allocation.y2 - priv->allocation.y1;
 
-      if (xu != old->x1)
+      if (notify_x && xu != old->x1)
         g_object_notify_by_pspec (obj, obj_props[PROP_X]);
 
-      if (yu != old->y1)
+      if (notify_y && yu != old->y1)
         g_object_notify_by_pspec (obj, obj_props[PROP_Y]);
 
-      if (widthu != (old->x2 - old->x1))
+      if (notify_width && widthu != (old->x2 - old->x1))
         g_object_notify_by_pspec (obj, obj_props[PROP_WIDTH]);
 
-      if (heightu != (old->y2 - old->y1))
+      if (notify_height && heightu != (old->y2 - old->y1))
         g_object_notify_by_pspec (obj, obj_props[PROP_HEIGHT]);
     }
 
   g_object_thaw_notify (obj);
 }
 
+/* the last serial given to an allocation; the serials are unique
+ * across all the actors, so that a cache keyed by serial does not
+ * need to store which actor it refers to */
+static guint allocation_generation = 0;
+
 static void
 clutter_actor_real_allocate (ClutterActor           *self,
                              const ClutterActorBox  *box,
@@ -1853,9 +2217,30 @@ clutter_actor_real_allocate (ClutterActor           *self,
       CLUTTER_NOTE (LAYOUT, "Allocation for '%s' changed",
                     _clutter_actor_get_debug_name (self));
 
-      priv->transform_valid = FALSE;
+      priv->allocation_serial = ++allocation_generation;
+
+      clutter_actor_invalidate_transform (self);
+
+      if (clutter_actor_has_notify_handler (self, quark_notify_allocation))
+        g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_ALLOCATION]);
+
+      if ((x1_changed || y1_changed || x2_changed || y2_changed) &&
+          !priv->geometry_change_queued &&
+          g_signal_has_handler_pending (self,
+                                        actor_signals[GEOMETRY_CHANGED],
+                                        0, FALSE))
+        {
+          ClutterActor *stage = _clutter_actor_get_stage_internal (self);
+
+          if (stage != NULL)
+            {
+              priv->geometry_old_allocation = old_alloc;
+              priv->geometry_change_queued = TRUE;
 
-      g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_ALLOCATION]);
+              _clutter_stage_queue_geometry_change (CLUTTER_STAGE (stage),
+                                                    self);
+            }
+        }
 
       /* we also emit the ::allocation-changed signal for people
        * that wish to track the allocation flags
@@ -1945,39 +2330,118 @@ clutter_actor_real_queue_redraw (ClutterActor *self,
     }
 }
 
+/* A relayout boundary is an actor whose preferred size does not depend
+ * on its children, and whose allocation is only decided by its parent:
+ * a relayout queued by one of its children cannot change the layout of
+ * its parent, so it is enough to allocate the boundary again, with its
+ * current allocation, instead of relayouting the whole stage
+ */
+static gboolean
+clutter_actor_is_relayout_boundary (ClutterActor *self)
+{
+  const ExtraInfo *extra;
+  ClutterActorPrivate *priv = self->priv;
+
+  extra = clutter_actor_get_extra_info_or_defaults (self);
+
+  if (CLUTTER_ACTOR_IS_TOPLEVEL (self) || priv->parent_actor == NULL)
+    return FALSE;
+
+  /* the boundary must have been allocated already */
+  if (!CLUTTER_ACTOR_IS_MAPPED (self) || priv->needs_allocation)
+    return FALSE;
+
+  if (!(priv->min_width_set && priv->natural_width_set &&
+        priv->min_height_set && priv->natural_height_set))
+    return FALSE;
+
+  /* constraints can change the allocation depending on other actors */
+  if (extra->constraints != NULL &&
+      _clutter_meta_group_peek_metas (extra->constraints) != NULL)
+    return FALSE;
+
+  return TRUE;
+}
+
 void
 clutter_actor_real_queue_relayout (ClutterActor *self)
 {
   ClutterActorPrivate *priv = self->priv;
+  gboolean is_boundary;
 
   /* no point in queueing a redraw on a destroyed actor */
   if (CLUTTER_ACTOR_IN_DESTRUCTION (self))
     return;
 
+  /* a relayout queued on the boundary itself, e.g. because its size
+   * changed, still has to reach the parent */
+  is_boundary = priv->relayout_from_child &&
+                clutter_actor_is_relayout_boundary (self);
+
   priv->needs_width_request  = TRUE;
   priv->needs_height_request = TRUE;
   priv->needs_allocation     = TRUE;
 
   /* reset the cached size requests */
-  memset (priv->width_requests, 0,
-          N_CACHED_SIZE_REQUESTS * sizeof (SizeRequest));
-  memset (priv->height_requests, 0,
-          N_CACHED_SIZE_REQUESTS * sizeof (SizeRequest));
+  if (priv->width_requests != NULL)
+    memset (priv->width_requests, 0,
+            2 * priv->n_cached_requests * sizeof (SizeRequest));
+
+  if (is_boundary)
+    {
+      ClutterActor *stage = _clutter_actor_get_stage_internal (self);
+
+      CLUTTER_NOTE (LAYOUT, "Relayout stopped at the boundary '%s'",
+                    _clutter_actor_get_debug_name (self));
+
+      _clutter_stage_queue_boundary_relayout (CLUTTER_STAGE (stage), self);
+      return;
+    }
 
   /* We need to go all the way up the hierarchy */
   if (priv->parent_actor != NULL)
-    _clutter_actor_queue_only_relayout (priv->parent_actor);
+    {
+      ClutterActorPrivate *parent_priv = priv->parent_actor->priv;
+
+      parent_priv->relayout_from_child = TRUE;
+      _clutter_actor_queue_only_relayout (priv->parent_actor);
+      parent_priv->relayout_from_child = FALSE;
+    }
 }
 
-/**
- * clutter_actor_apply_relative_transform_to_point:
- * @self: A #ClutterActor
- * @ancestor: (allow-none): A #ClutterActor ancestor, or %NULL to use the
- *   default #ClutterStage
- * @point: A point as #ClutterVertex
- * @vertex: The translated #ClutterVertex
+/*< private >
+ * _clutter_actor_relayout_boundary:
+ * @self: a #ClutterActor
  *
- * Transforms @point in coordinates relative to the actor into
+ * Allocates a relayout boundary again, using its current allocation,
+ * if a relayout was queued on it since it was last allocated.
+ */
+void
+_clutter_actor_relayout_boundary (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActorBox box;
+
+  /* the actor might have been allocated by its parent in the meantime */
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (self) || !priv->needs_allocation)
+    return;
+
+  box = priv->allocation;
+
+  clutter_actor_allocate (self, &box,
+                          priv->allocation_flags
+                          & ~CLUTTER_ABSOLUTE_ORIGIN_CHANGED);
+}
+
+/**
+ * clutter_actor_apply_relative_transform_to_point:
+ * @self: A #ClutterActor
+ * @ancestor: (allow-none): A #ClutterActor ancestor, or %NULL to use the
+ *   default #ClutterStage
+ * @point: A point as #ClutterVertex
+ * @vertex: The translated #ClutterVertex
+ *
+ * Transforms @point in coordinates relative to the actor into
  * ancestor-relative coordinates using the relevant transform
  * stack (i.e. scale, rotation, etc).
  *
@@ -2106,8 +2570,6 @@ clutter_actor_apply_transform_to_point (ClutterActor        *self,
  *   stage = _clutter_actor_get_stage_internal (self);
  *   _clutter_actor_apply_modelview_transform (stage, &mtx);
  */
-/* FIXME: We should be caching the stage relative modelview along with the
- * actor itself */
 static void
 _clutter_actor_get_relative_modelview (ClutterActor *self,
                                        ClutterActor *ancestor,
@@ -2303,57 +2765,69 @@ clutter_actor_real_apply_transform (ClutterActor *self,
       cogl_matrix_init_identity (transform);
 
       cogl_matrix_translate (transform,
-                             priv->allocation.x1,
-                             priv->allocation.y1,
+                             priv->allocation.x1
+                             + priv->translation_x
+                             + priv->layout_offset_x,
+                             priv->allocation.y1
+                             + priv->translation_y
+                             + priv->layout_offset_y,
                              0.0);
 
       if (priv->z)
         cogl_matrix_translate (transform, 0, 0, priv->z);
 
-      /*
-       * because the rotation involves translations, we must scale
-       * before applying the rotations (if we apply the scale after
-       * the rotations, the translations included in the rotation are
-       * not scaled and so the entire object will move on the screen
-       * as a result of rotating it).
-       */
-      if (priv->scale_x != 1.0 || priv->scale_y != 1.0)
+      /* most actors are never scaled, rotated or anchored, so they
+       * do not have a TransformInfo at all */
+      if (priv->transform_info != NULL)
         {
-          TRANSFORM_ABOUT_ANCHOR_COORD (self, transform,
-                                        &priv->scale_center,
-                                        cogl_matrix_scale (transform,
-                                                           priv->scale_x,
-                                                           priv->scale_y,
-                                                           1.0));
-        }
+          const TransformInfo *info = priv->transform_info;
+
+          /*
+           * because the rotation involves translations, we must scale
+           * before applying the rotations (if we apply the scale after
+           * the rotations, the translations included in the rotation are
+           * not scaled and so the entire object will move on the screen
+           * as a result of rotating it).
+           */
+          if (info->scale_x != 1.0 || info->scale_y != 1.0)
+            {
+              TRANSFORM_ABOUT_ANCHOR_COORD (self, transform,
+                                            &info->scale_center,
+                                            cogl_matrix_scale (transform,
+                                                               info->scale_x,
+                                                               info->scale_y,
+                                                               1.0));
+            }
 
-      if (priv->rzang)
-        TRANSFORM_ABOUT_ANCHOR_COORD (self, transform,
-                                      &priv->rz_center,
-                                      cogl_matrix_rotate (transform,
-                                                          priv->rzang,
-                                                          0, 0, 1.0));
-
-      if (priv->ryang)
-        TRANSFORM_ABOUT_ANCHOR_COORD (self, transform,
-                                      &priv->ry_center,
-                                      cogl_matrix_rotate (transform,
-                                                          priv->ryang,
-                                                          0, 1.0, 0));
-
-      if (priv->rxang)
-        TRANSFORM_ABOUT_ANCHOR_COORD (self, transform,
-                                      &priv->rx_center,
-                                      cogl_matrix_rotate (transform,
-                                                          priv->rxang,
-                                                          1.0, 0, 0));
-
-      if (!clutter_anchor_coord_is_zero (&priv->anchor))
-        {
-          gfloat x, y, z;
+          if (info->rzang)
+            TRANSFORM_ABOUT_ANCHOR_COORD (self, transform,
+                                          &info->rz_center,
+                                          cogl_matrix_rotate (transform,
+                                                              info->rzang,
+                                                              0, 0, 1.0));
+
+          if (info->ryang)
+            TRANSFORM_ABOUT_ANCHOR_COORD (self, transform,
+                                          &info->ry_center,
+                                          cogl_matrix_rotate (transform,
+                                                              info->ryang,
+                                                              0, 1.0, 0));
+
+          if (info->rxang)
+            TRANSFORM_ABOUT_ANCHOR_COORD (self, transform,
+                                          &info->rx_center,
+                                          cogl_matrix_rotate (transform,
+                                                              info->rxang,
+                                                              1.0, 0, 0));
+
+          if (!clutter_anchor_coord_is_zero (&info->anchor))
+            {
+              gfloat x, y, z;
 
-          clutter_anchor_coord_get_units (self, &priv->anchor, &x, &y, &z);
-          cogl_matrix_translate (transform, -x, -y, -z);
+              clutter_anchor_coord_get_units (self, &info->anchor,
+                                              &x, &y, &z);
+              cogl_matrix_translate (transform, -x, -y, -z);
+            }
         }
 
       priv->transform_valid = TRUE;
@@ -2371,6 +2845,114 @@ _clutter_actor_apply_modelview_transform (ClutterActor *self,
   CLUTTER_ACTOR_GET_CLASS (self)->apply_transform (self, matrix);
 }
 
+/* Invalidates the cached stage-relative transformation of @self and
+ * of all its descendants */
+static void
+clutter_actor_invalidate_stage_transform (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  GList *l;
+
+  priv->stage_transform_changed = TRUE;
+
+  /* the stage-relative transformation of an actor is built from the
+   * one of its parent, so if the cache of @self is not valid then
+   * none of the descendants can have a valid cache either and we can
+   * stop here */
+  if (!priv->stage_transform_valid)
+    return;
+
+  priv->stage_transform_valid = FALSE;
+  priv->stage_point_valid = FALSE;
+
+  /* the box in the spatial index of the stage was computed using the
+   * old transformation; only actors with a valid cache are indexed */
+  _clutter_stage_index_node_remove (&priv->index_node);
+
+  for (l = priv->children; l != NULL; l = l->next)
+    clutter_actor_invalidate_stage_transform (l->data);
+}
+
+/* Invalidates the cached paint opacity and flatten decision of @self
+ * and of all its descendants, since the paint opacity of an actor
+ * depends on the opacity of its ancestors */
+static void
+clutter_actor_invalidate_paint_opacity (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  GList *l;
+
+  /* a descendant is never valid when its ancestors are not; the
+   * paint opacity of a descendant is only cached without the one of
+   * its ancestors if it does not depend on them */
+  if (!priv->paint_opacity_valid && !priv->paint_opacity_cached)
+    return;
+
+  priv->paint_opacity_valid = FALSE;
+  priv->paint_opacity_cached = FALSE;
+
+  for (l = priv->children; l != NULL; l = l->next)
+    clutter_actor_invalidate_paint_opacity (l->data);
+}
+
+/* Invalidates the transformation of @self; this function should be
+ * called every time one of the properties used by the default
+ * implementation of ClutterActor::apply_transform changes */
+static void
+clutter_actor_invalidate_transform (ClutterActor *self)
+{
+  self->priv->transform_valid = FALSE;
+
+  clutter_actor_invalidate_stage_transform (self);
+}
+
+/* Retrieves the transformation of @self relative to the stage, that
+ * is the transformations of @self and its ancestors, excluding the
+ * stage itself. The result is cached with the actor and only built
+ * again when the transformation of @self or of one of its ancestors
+ * changes.
+ *
+ * The cache can only be used if @self and all its ancestors use the
+ * default implementation of ClutterActor::apply_transform, since we
+ * have no way to know when an overridden implementation is going to
+ * return a different matrix; in that case, or if @self is not inside
+ * a stage, this function returns %NULL.
+ */
+static const CoglMatrix *
+_clutter_actor_get_stage_transform (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  const CoglMatrix *parent_transform;
+
+  if (priv->stage_transform_valid)
+    return &priv->stage_transform;
+
+  if (CLUTTER_ACTOR_IS_TOPLEVEL (self))
+    {
+      cogl_matrix_init_identity (&priv->stage_transform);
+      priv->stage_transform_valid = TRUE;
+
+      return &priv->stage_transform;
+    }
+
+  if (priv->parent_actor == NULL)
+    return NULL;
+
+  if (CLUTTER_ACTOR_GET_CLASS (self)->apply_transform !=
+      clutter_actor_real_apply_transform)
+    return NULL;
+
+  parent_transform = _clutter_actor_get_stage_transform (priv->parent_actor);
+  if (parent_transform == NULL)
+    return NULL;
+
+  priv->stage_transform = *parent_transform;
+  clutter_actor_real_apply_transform (self, &priv->stage_transform);
+  priv->stage_transform_valid = TRUE;
+
+  return &priv->stage_transform;
+}
+
 /* Recursively applies the transforms associated with this actor and
  * its ancestors to the given matrix. Use NULL if you want this
  * to go all the way down to the stage.
@@ -2389,6 +2971,21 @@ _clutter_actor_apply_modelview_transform_recursive (ClutterActor *self,
   if (self == ancestor)
     return;
 
+  /* if we are transforming relative to our stage we can use the
+   * cached transformation instead of walking up the hierarchy */
+  if (ancestor != NULL && CLUTTER_ACTOR_IS_TOPLEVEL (ancestor))
+    {
+      const CoglMatrix *stage_transform;
+
+      stage_transform = _clutter_actor_get_stage_transform (self);
+      if (stage_transform != NULL &&
+          _clutter_actor_get_stage_internal (self) == ancestor)
+        {
+          cogl_matrix_multiply (matrix, matrix, stage_transform);
+          return;
+        }
+    }
+
   parent = clutter_actor_get_parent (self);
 
   if (parent != NULL)
@@ -2547,6 +3144,45 @@ _clutter_actor_paint_cull_result (ClutterActor *self,
 
 static int clone_paint_level = 0;
 
+/* the number of actors painted, of actors allocated, and of size
+ * requests, since the start of the process; the stage accounts the
+ * difference to each of its frames */
+static guint n_painted_actors = 0;
+static guint n_culled_actors = 0;
+static guint n_allocated_actors = 0;
+static guint n_size_requests = 0;
+static guint n_cached_size_requests = 0;
+
+guint
+_clutter_actor_get_n_painted (void)
+{
+  return n_painted_actors;
+}
+
+guint
+_clutter_actor_get_n_culled (void)
+{
+  return n_culled_actors;
+}
+
+guint
+_clutter_actor_get_n_allocated (void)
+{
+  return n_allocated_actors;
+}
+
+guint
+_clutter_actor_get_n_size_requests (void)
+{
+  return n_size_requests;
+}
+
+guint
+_clutter_actor_get_n_cached_size_requests (void)
+{
+  return n_cached_size_requests;
+}
+
 void
 _clutter_actor_push_clone_paint (void)
 {
@@ -2565,6 +3201,57 @@ in_clone_paint (void)
   return clone_paint_level > 0;
 }
 
+/* Records the screen-space box of @self for the overdraw heatmap of
+ * its stage; the box is a conservative estimate of the pixels written
+ * by @self, which is good enough to find where the stage is painted
+ * many times over */
+static void
+_clutter_actor_record_overdraw (ClutterActor *self)
+{
+  ClutterActor *stage;
+  ClutterActorBox box;
+
+  /* the stage accounts for its own clear, and containers are assumed
+   * to only paint their children */
+  if (CLUTTER_ACTOR_IS_TOPLEVEL (self) || CLUTTER_IS_CONTAINER (self))
+    return;
+
+  /* the paint box of the source of a clone is not where the clone
+   * paints it; the box of the clone is recorded instead */
+  if (in_clone_paint ())
+    return;
+
+  stage = _clutter_actor_get_stage_internal (self);
+  if (stage == NULL || !clutter_actor_get_paint_box (self, &box))
+    return;
+
+  _clutter_stage_add_overdraw_box (CLUTTER_STAGE (stage), &box);
+}
+
+/* Culls the box of @self in the spatial index of the stage against
+ * the clip of the stage; unlike _clutter_paint_volume_cull() this does
+ * not need any matrix math, since the box is already in window
+ * coordinates */
+static ClutterCullResult
+clutter_actor_cull_paint_box (ClutterActor *self,
+                              ClutterStage *stage)
+{
+  const ClutterActorBox *box = &self->priv->index_node.box;
+  ClutterGeometry clip;
+
+  _clutter_stage_get_clip_geometry (stage, &clip);
+
+  if (box->x2 <= clip.x || box->x1 >= clip.x + (gint) clip.width ||
+      box->y2 <= clip.y || box->y1 >= clip.y + (gint) clip.height)
+    return CLUTTER_CULL_RESULT_OUT;
+
+  if (box->x1 >= clip.x && box->x2 <= clip.x + (gint) clip.width &&
+      box->y1 >= clip.y && box->y2 <= clip.y + (gint) clip.height)
+    return CLUTTER_CULL_RESULT_IN;
+
+  return CLUTTER_CULL_RESULT_PARTIAL;
+}
+
 /* Returns TRUE if the actor can be ignored */
 /* FIXME: we should return a ClutterCullResult, and
  * clutter_actor_paint should understand that a CLUTTER_CULL_RESULT_IN
@@ -2607,22 +3294,115 @@ cull_actor (ClutterActor *self, ClutterCullResult *result_out)
       return FALSE;
     }
 
+  /* the box in the spatial index covers the paint volume, and it is
+   * kept in sync with the last paint volume; we can only use it if
+   * the whole volume is in front of the eye, otherwise the projection
+   * of the vertices behind it would be meaningless */
+  if (priv->index_node.stage == (ClutterStage *) stage &&
+      priv->paint_box_in_front)
+    {
+      *result_out = clutter_actor_cull_paint_box (self, CLUTTER_STAGE (stage));
+      return TRUE;
+    }
+
   *result_out =
     _clutter_paint_volume_cull (&priv->last_paint_volume, stage_clip);
   return TRUE;
 }
 
+/* Fills @key with the inputs of the screen-space box of @self, using
+ * @pv, the paint volume of @self relative to itself. Returns FALSE if
+ * the volume is not axis aligned, in which case the box is always
+ * computed again */
+static gboolean
+clutter_actor_get_paint_box_key (ClutterActor             *self,
+                                 const ClutterPaintVolume *pv,
+                                 PaintBoxKey              *key)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  if (!pv->is_axis_aligned)
+    return FALSE;
+
+  memset (key, 0, sizeof (PaintBoxKey));
+
+  key->origin = pv->vertices[0];
+
+  if (!pv->is_empty)
+    {
+      key->width = pv->vertices[1].x - pv->vertices[0].x;
+      key->height = pv->vertices[3].y - pv->vertices[0].y;
+      key->depth = pv->vertices[4].z - pv->vertices[0].z;
+    }
+
+  key->allocation_width = priv->allocation.x2 - priv->allocation.x1;
+  key->allocation_height = priv->allocation.y2 - priv->allocation.y1;
+
+  return TRUE;
+}
+
+/* Updates the box of @self inside the spatial index of the stage
+ * using @pv, the paint volume of @self relative to itself */
 static void
-_clutter_actor_update_last_paint_volume (ClutterActor *self)
+clutter_actor_update_index_node (ClutterActor             *self,
+                                 const ClutterPaintVolume *pv)
 {
   ClutterActorPrivate *priv = self->priv;
-  const ClutterPaintVolume *pv;
+  ClutterPaintVolume index_pv;
+  ClutterActorBox box;
+  ClutterActor *stage;
+  gint i, n_vertices;
 
-  if (priv->last_paint_volume_valid)
+  /* a change in the transformation of an ancestor only invalidates
+   * the cached stage-relative transformation, so that is the only
+   * case in which we know when the box becomes stale */
+  stage = _clutter_actor_get_stage_internal (self);
+  if (stage == NULL || !priv->stage_transform_valid)
     {
-      clutter_paint_volume_free (&priv->last_paint_volume);
-      priv->last_paint_volume_valid = FALSE;
+      _clutter_stage_index_node_remove (&priv->index_node);
+      return;
+    }
+
+  /* actors are picked using their allocation, which is not
+   * necessarily inside the paint volume */
+  _clutter_paint_volume_init_static (&index_pv, self);
+  clutter_paint_volume_set_width (&index_pv,
+                                  priv->allocation.x2 - priv->allocation.x1);
+  clutter_paint_volume_set_height (&index_pv,
+                                   priv->allocation.y2 - priv->allocation.y1);
+  clutter_paint_volume_union (&index_pv, pv);
+
+  _clutter_paint_volume_get_stage_paint_box (&index_pv,
+                                             CLUTTER_STAGE (stage),
+                                             &box);
+  clutter_paint_volume_free (&index_pv);
+
+  _clutter_stage_index_update (CLUTTER_STAGE (stage),
+                               &priv->index_node,
+                               &box);
+
+  priv->paint_box_key_valid =
+    clutter_actor_get_paint_box_key (self, pv, &priv->paint_box_key);
+
+  /* the eye looks down the negative Z axis */
+  priv->paint_box_in_front = TRUE;
+  n_vertices = priv->last_paint_volume.is_2d ? 4 : 8;
+  for (i = 0; i < n_vertices; i++)
+    {
+      if (priv->last_paint_volume.vertices[i].z >= 0)
+        {
+          priv->paint_box_in_front = FALSE;
+          break;
+        }
     }
+}
+
+static void
+_clutter_actor_update_last_paint_volume (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  const ClutterPaintVolume *pv;
+  PaintBoxKey key;
 
   pv = clutter_actor_get_paint_volume (self);
   if (!pv)
@@ -2630,15 +3410,74 @@ _clutter_actor_update_last_paint_volume (ClutterActor *self)
       CLUTTER_NOTE (CLIPPING, "Bail from update_last_paint_volume (%s): "
                     "Actor failed to report a paint volume",
                     _clutter_actor_get_debug_name (self));
+
+      if (priv->last_paint_volume_valid)
+        {
+          clutter_paint_volume_free (&priv->last_paint_volume);
+          priv->last_paint_volume_valid = FALSE;
+        }
+
+      _clutter_stage_index_node_remove (&priv->index_node);
       return;
     }
 
+  /* the box is removed from the spatial index whenever the
+   * transformation of @self or of one of its ancestors changes, and
+   * whenever the viewport or the projection of the stage change; if
+   * it is still there, and the paint volume did not change either,
+   * then both the last paint volume and the box are current, and we
+   * can skip transforming and projecting the volume again */
+  if (priv->last_paint_volume_valid &&
+      priv->index_node.stage != NULL &&
+      priv->paint_box_key_valid &&
+      clutter_actor_get_paint_box_key (self, pv, &key) &&
+      memcmp (&key, &priv->paint_box_key, sizeof (PaintBoxKey)) == 0)
+    return;
+
+  if (priv->last_paint_volume_valid)
+    {
+      clutter_paint_volume_free (&priv->last_paint_volume);
+      priv->last_paint_volume_valid = FALSE;
+    }
+
   _clutter_paint_volume_copy_static (pv, &priv->last_paint_volume);
 
   _clutter_paint_volume_transform_relative (&priv->last_paint_volume,
                                             NULL); /* eye coordinates */
 
   priv->last_paint_volume_valid = TRUE;
+
+  clutter_actor_update_index_node (self, pv);
+}
+
+/* Checks whether @self and its children can be left out of the pick
+ * identified by @index_stamp: that is the case if the box they covered
+ * when they were last painted does not contain the point, and nothing
+ * inside the sub-tree queued a redraw since then. We rely on paint
+ * volumes of containers including their children, as culling does */
+static inline gboolean
+clutter_actor_can_skip_pick (ClutterActor *self,
+                             guint         index_stamp)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  return !priv->propagated_one_redraw &&
+         !_clutter_stage_index_node_may_match (&priv->index_node,
+                                               index_stamp);
+}
+
+/* Checks whether neither @self nor any of its descendants can be
+ * picked when picking only the reactive actors; for those sub-trees
+ * we can avoid applying the transformations and visiting each actor */
+static inline gboolean
+clutter_actor_can_skip_reactive_pick (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  return !priv->counted_reactive &&
+         !CLUTTER_ACTOR_IS_REACTIVE (self) &&
+         priv->n_reactive_descendants == 0 &&
+         !CLUTTER_ACTOR_IS_TOPLEVEL (self);
 }
 
 static inline gboolean
@@ -2656,102 +3495,1690 @@ _clutter_actor_get_pick_id (ClutterActor *self)
   return self->priv->pick_id;
 }
 
-/* This is the same as clutter_actor_add_effect except that it doesn't
-   queue a redraw and it doesn't notify on the effect property */
-static void
-_clutter_actor_add_effect_internal (ClutterActor  *self,
-                                    ClutterEffect *effect)
+/* Geometric picking
+ *
+ * Instead of painting the scene in pick mode and reading back the
+ * pixel under the pointer, we can walk the scene graph in reverse
+ * painting order and check the position against the transformed
+ * allocation of each actor, as long as every actor we encounter
+ * paints its allocation as its pick silhouette. Classes that keep
+ * the default pick semantics register their implementation of
+ * ClutterActor::pick using _clutter_actor_class_register_geometric_pick();
+ * actors with any other implementation, or with a handler connected
+ * to the ::pick signal, make the geometric pick fail so that the
+ * caller can fall back to a pick render.
+ */
+typedef struct _GeometricPickInfo
 {
-  ClutterActorPrivate *priv = self->priv;
+  void (* pick) (ClutterActor       *actor,
+                 const ClutterColor *color);
 
-  if (priv->effects == NULL)
-    {
-      priv->effects = g_object_new (CLUTTER_TYPE_META_GROUP, NULL);
-      priv->effects->actor = self;
-    }
+  ClutterActorCanPickFunc can_pick;
+  ClutterActorHitTestFunc hit_test;
+
+  guint pick_children : 1;
+} GeometricPickInfo;
+
+typedef enum {
+  GEOMETRIC_PICK_MISS,
+  GEOMETRIC_PICK_HIT,
+  GEOMETRIC_PICK_FAILED
+} GeometricPickResult;
+
+static GArray *geometric_pick_infos = NULL;
+
+/*< private >
+ * _clutter_actor_class_register_geometric_pick:
+ * @klass: a #ClutterActorClass
+ * @pick_children: whether the implementation of ClutterActor::pick
+ *   of @klass paints the children of the actor as well, in the order
+ *   given by clutter_container_foreach()
+ * @can_pick: (allow-none): a function to check whether a specific
+ *   instance can be picked geometrically, or %NULL
+ * @hit_test: (allow-none): a function to check whether a point inside
+ *   the allocation is part of the pick silhouette, or %NULL
+ *
+ * Registers the implementation of ClutterActor::pick of @klass as
+ * painting the allocation of the actor, if it should be picked,
+ * followed by its children if @pick_children is %TRUE.
+ *
+ * If @hit_test is set, the silhouette is the part of the allocation
+ * for which @hit_test returns %TRUE instead.
+ */
+void
+_clutter_actor_class_register_geometric_pick (ClutterActorClass       *klass,
+                                              gboolean                 pick_children,
+                                              ClutterActorCanPickFunc  can_pick,
+                                              ClutterActorHitTestFunc  hit_test)
+{
+  GeometricPickInfo info;
+
+  g_return_if_fail (klass->pick != NULL);
 
-  _clutter_meta_group_add_meta (priv->effects, CLUTTER_ACTOR_META (effect));
+  if (G_UNLIKELY (geometric_pick_infos == NULL))
+    geometric_pick_infos = g_array_new (FALSE, FALSE,
+                                        sizeof (GeometricPickInfo));
+
+  info.pick = klass->pick;
+  info.can_pick = can_pick;
+  info.hit_test = hit_test;
+  info.pick_children = pick_children != FALSE;
+
+  g_array_append_val (geometric_pick_infos, info);
 }
 
-/* This is the same as clutter_actor_remove_effect except that it doesn't
-   queue a redraw and it doesn't notify on the effect property */
-static void
-_clutter_actor_remove_effect_internal (ClutterActor  *self,
-                                       ClutterEffect *effect)
+static const GeometricPickInfo *
+clutter_actor_get_geometric_pick_info (ClutterActor *self)
 {
-  ClutterActorPrivate *priv = self->priv;
+  ClutterActorClass *klass = CLUTTER_ACTOR_GET_CLASS (self);
+  guint i;
 
-  if (priv->effects == NULL)
-    return;
+  if (geometric_pick_infos == NULL)
+    return NULL;
+
+  for (i = 0; i < geometric_pick_infos->len; i++)
+    {
+      const GeometricPickInfo *info;
+
+      info = &g_array_index (geometric_pick_infos, GeometricPickInfo, i);
+      if (info->pick == klass->pick)
+        return info;
+    }
 
-  _clutter_meta_group_remove_meta (priv->effects, CLUTTER_ACTOR_META (effect));
+  return NULL;
 }
 
+/* Checks whether (@x, @y) is inside the quadrilateral defined by
+ * @verts, using the same ordering of the vertices as returned by
+ * clutter_actor_get_abs_allocation_vertices() */
 static gboolean
-needs_flatten_effect (ClutterActor *self)
+point_in_quad (const ClutterVertex verts[],
+               gfloat              x,
+               gfloat              y)
 {
-  ClutterActorPrivate *priv = self->priv;
+  static const int order[] = { 0, 1, 3, 2 };
+  gboolean positive = FALSE;
+  gboolean negative = FALSE;
+  int i;
 
-  switch (priv->offscreen_redirect)
+  for (i = 0; i < 4; i++)
     {
-    case CLUTTER_OFFSCREEN_REDIRECT_AUTOMATIC_FOR_OPACITY:
-      if (!clutter_actor_has_overlaps (self))
-        return FALSE;
-      /* flow through */
-    case CLUTTER_OFFSCREEN_REDIRECT_ALWAYS_FOR_OPACITY:
-      return clutter_actor_get_paint_opacity (self) < 255;
+      const ClutterVertex *a = &verts[order[i]];
+      const ClutterVertex *b = &verts[order[(i + 1) % 4]];
+      gfloat cross;
 
-    case CLUTTER_OFFSCREEN_REDIRECT_ALWAYS:
-      return TRUE;
+      cross = (b->x - a->x) * (y - a->y) - (b->y - a->y) * (x - a->x);
+
+      if (cross < 0)
+        negative = TRUE;
+      else if (cross > 0)
+        positive = TRUE;
+
+      if (positive && negative)
+        return FALSE;
     }
 
-  g_assert_not_reached ();
+  /* a degenerate quad does not cover anything */
+  return positive || negative;
 }
 
-static void
-add_or_remove_flatten_effect (ClutterActor *self)
+static GeometricPickResult
+clutter_actor_geometric_pick_internal (ClutterActor     *self,
+                                       ClutterPickMode   mode,
+                                       gfloat            x,
+                                       gfloat            y,
+                                       guint             index_stamp,
+                                       ClutterActor    **actor_out)
 {
   ClutterActorPrivate *priv = self->priv;
+  const GeometricPickInfo *info;
+  gboolean is_toplevel;
+  ClutterActorBox box;
+  ClutterVertex verts[4];
 
-  /* Add or remove the flatten effect depending on the
-     offscreen-redirect property. */
-  if (needs_flatten_effect (self))
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (self))
+    return GEOMETRIC_PICK_MISS;
+
+  /* unmapped actors are not painted at all, regardless of how they
+   * would pick themselves */
+  if (!CLUTTER_ACTOR_IS_MAPPED (self))
+    return GEOMETRIC_PICK_MISS;
+
+  if (clutter_actor_can_skip_pick (self, index_stamp))
+    return GEOMETRIC_PICK_MISS;
+
+  if (mode == CLUTTER_PICK_REACTIVE &&
+      clutter_actor_can_skip_reactive_pick (self))
+    return GEOMETRIC_PICK_MISS;
+
+  info = clutter_actor_get_geometric_pick_info (self);
+  if (info == NULL)
     {
-      if (priv->flatten_effect == NULL)
-        {
-          ClutterActorMeta *actor_meta;
-          gint priority;
-
-          priv->flatten_effect = _clutter_flatten_effect_new ();
-          /* Keep a reference to the effect so that we can queue
-             redraws from it */
-          g_object_ref_sink (priv->flatten_effect);
-
-          /* Set the priority of the effect to high so that it will
-             always be applied to the actor first. It uses an internal
-             priority so that it won't be visible to applications */
-          actor_meta = CLUTTER_ACTOR_META (priv->flatten_effect);
-          priority = CLUTTER_ACTOR_META_PRIORITY_INTERNAL_HIGH;
-          _clutter_actor_meta_set_priority (actor_meta, priority);
-
-          /* This will add the effect without queueing a redraw */
-          _clutter_actor_add_effect_internal (self, priv->flatten_effect);
-        }
+      CLUTTER_NOTE (PICK, "Geometric pick failed on '%s': "
+                    "the actor overrides ClutterActor::pick",
+                    _clutter_actor_get_debug_name (self));
+      return GEOMETRIC_PICK_FAILED;
     }
-  else
+
+  if (info->can_pick != NULL && !info->can_pick (self))
+    return GEOMETRIC_PICK_FAILED;
+
+  if (!priv->enable_model_view_transform ||
+      g_signal_has_handler_pending (self, actor_signals[PICK], 0, TRUE))
+    return GEOMETRIC_PICK_FAILED;
+
+  /* the stage does not paint itself in pick mode; the caller is
+   * responsible for returning the stage on a miss */
+  is_toplevel = CLUTTER_ACTOR_IS_TOPLEVEL (self);
+
+  if (!is_toplevel && (priv->has_clip || priv->clip_to_allocation))
     {
-      if (priv->flatten_effect != NULL)
+      if (priv->has_clip)
         {
-          /* Destroy the effect so that it will lose its fbo cache of
-             the actor */
-          _clutter_actor_remove_effect_internal (self, priv->flatten_effect);
-          g_object_unref (priv->flatten_effect);
-          priv->flatten_effect = NULL;
+          box.x1 = priv->clip[0];
+          box.y1 = priv->clip[1];
+          box.x2 = priv->clip[0] + priv->clip[2];
+          box.y2 = priv->clip[1] + priv->clip[3];
         }
-    }
-}
-
-/**
+      else
+        {
+          box.x1 = 0;
+          box.y1 = 0;
+          box.x2 = priv->allocation.x2 - priv->allocation.x1;
+          box.y2 = priv->allocation.y2 - priv->allocation.y1;
+        }
+
+      if (!_clutter_actor_transform_and_project_box (self, &box, verts))
+        return GEOMETRIC_PICK_FAILED;
+
+      /* the clip also applies to the children */
+      if (!point_in_quad (verts, x, y))
+        return GEOMETRIC_PICK_MISS;
+    }
+
+  /* children are painted on top of their parent, so we need to check
+   * them first, starting from the last one that was painted */
+  if (info->pick_children && CLUTTER_IS_CONTAINER (self))
+    {
+      GeometricPickResult res = GEOMETRIC_PICK_MISS;
+      ClutterContainerIter iter;
+      ClutterActor *child;
+
+      clutter_container_iter_init (&iter, CLUTTER_CONTAINER (self));
+      while (res == GEOMETRIC_PICK_MISS &&
+             clutter_container_iter_prev (&iter, &child))
+        {
+          res = clutter_actor_geometric_pick_internal (child,
+                                                       mode,
+                                                       x, y,
+                                                       index_stamp,
+                                                       actor_out);
+        }
+
+      if (res != GEOMETRIC_PICK_MISS)
+        return res;
+    }
+
+  if (is_toplevel)
+    return GEOMETRIC_PICK_MISS;
+
+  if (mode != CLUTTER_PICK_ALL && !CLUTTER_ACTOR_IS_REACTIVE (self))
+    return GEOMETRIC_PICK_MISS;
+
+  box.x1 = 0;
+  box.y1 = 0;
+  box.x2 = priv->allocation.x2 - priv->allocation.x1;
+  box.y2 = priv->allocation.y2 - priv->allocation.y1;
+
+  if (!_clutter_actor_transform_and_project_box (self, &box, verts))
+    return GEOMETRIC_PICK_FAILED;
+
+  if (!point_in_quad (verts, x, y))
+    return GEOMETRIC_PICK_MISS;
+
+  if (info->hit_test != NULL)
+    {
+      gfloat actor_x, actor_y;
+
+      if (!clutter_actor_transform_stage_point (self, x, y,
+                                                &actor_x, &actor_y))
+        return GEOMETRIC_PICK_FAILED;
+
+      if (!info->hit_test (self, actor_x, actor_y))
+        return GEOMETRIC_PICK_MISS;
+    }
+
+  *actor_out = self;
+
+  return GEOMETRIC_PICK_HIT;
+}
+
+/*< private >
+ * _clutter_actor_geometric_pick:
+ * @self: a #ClutterActor, usually a #ClutterStage
+ * @mode: the #ClutterPickMode
+ * @x: X coordinate, in window coordinates
+ * @y: Y coordinate, in window coordinates
+ * @index_stamp: the stamp returned by _clutter_stage_index_query_point()
+ *   for the given coordinates, or 0
+ * @actor_out: (out): return location for the picked actor, or %NULL
+ *   if no descendant of @self is at the given coordinates
+ *
+ * Picks the actor at the given coordinates by hit-testing the
+ * transformed allocations of @self and its descendants.
+ *
+ * Return value: %TRUE if the geometric pick was possible, and %FALSE
+ *   if the scene contains actors that need to be picked by rendering
+ *   them; in that case @actor_out is not set
+ */
+gboolean
+_clutter_actor_geometric_pick (ClutterActor     *self,
+                               ClutterPickMode   mode,
+                               gfloat            x,
+                               gfloat            y,
+                               guint             index_stamp,
+                               ClutterActor    **actor_out)
+{
+  ClutterActor *actor = NULL;
+  GeometricPickResult res;
+
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), FALSE);
+  g_return_val_if_fail (actor_out != NULL, FALSE);
+
+  res = clutter_actor_geometric_pick_internal (self, mode, x, y,
+                                               index_stamp,
+                                               &actor);
+  if (res == GEOMETRIC_PICK_FAILED)
+    return FALSE;
+
+  *actor_out = actor;
+
+  return TRUE;
+}
+
+/* Checks whether anything picked by @self or its children could be
+ * inside @bounds, using the box they covered when they were last
+ * painted, like clutter_actor_can_skip_pick() does */
+static gboolean
+clutter_actor_may_pick_in_box (ClutterActor          *self,
+                               const ClutterActorBox *bounds)
+{
+  ClutterActorPrivate *priv = self->priv;
+  const ClutterActorBox *box;
+
+  if (!CLUTTER_ACTOR_IS_MAPPED (self))
+    return FALSE;
+
+  if (priv->propagated_one_redraw || priv->index_node.stage == NULL)
+    return TRUE;
+
+  box = &priv->index_node.box;
+
+  return box->x1 < bounds->x2 && box->x2 > bounds->x1 &&
+         box->y1 < bounds->y2 && box->y2 > bounds->y1;
+}
+
+/* Checks whether any of the children of @container painted after
+ * @child, or all of them if @child is %NULL, could be picked inside
+ * @bounds */
+static gboolean
+clutter_actor_children_may_pick_in_box (ClutterActor          *container,
+                                        ClutterActor          *child,
+                                        const ClutterActorBox *bounds)
+{
+  ClutterContainerIter iter;
+  ClutterActor *iter_child;
+  gboolean res = FALSE;
+
+  if (!CLUTTER_IS_CONTAINER (container))
+    return FALSE;
+
+  clutter_container_iter_init (&iter, CLUTTER_CONTAINER (container));
+
+  /* skip the children up to @child */
+  if (child != NULL)
+    {
+      while (clutter_container_iter_next (&iter, &iter_child))
+        {
+          if (iter_child == child)
+            break;
+        }
+    }
+
+  while (!res && clutter_container_iter_next (&iter, &iter_child))
+    res = clutter_actor_may_pick_in_box (iter_child, bounds);
+
+  return res;
+}
+
+/*< private >
+ * _clutter_actor_get_exclusive_pick_quad:
+ * @self: a #ClutterActor
+ * @mode: the #ClutterPickMode
+ * @verts: (out) (array fixed-size=4): return location for the vertices
+ *   of the quad, in window coordinates
+ *
+ * Retrieves the transformed allocation of @self if a pick using @mode
+ * is guaranteed to return @self anywhere inside it, that is if @self
+ * picks its allocation and nothing painted on top of it overlaps the
+ * quad. The result holds for as long as the scene does not change; see
+ * _clutter_stage_get_scene_serial().
+ *
+ * Return value: %TRUE if the quad was computed
+ */
+gboolean
+_clutter_actor_get_exclusive_pick_quad (ClutterActor    *self,
+                                        ClutterPickMode  mode,
+                                        ClutterVertex    verts[])
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActorBox box, bounds;
+  ClutterActor *iter;
+  gint i;
+
+  if (CLUTTER_ACTOR_IS_TOPLEVEL (self) ||
+      !CLUTTER_ACTOR_IS_MAPPED (self) ||
+      CLUTTER_ACTOR_IN_DESTRUCTION (self))
+    return FALSE;
+
+  if (mode != CLUTTER_PICK_ALL && !CLUTTER_ACTOR_IS_REACTIVE (self))
+    return FALSE;
+
+  /* @self and its ancestors have to pick their allocation, without
+   * any clip, and below their children */
+  for (iter = self; iter != NULL; iter = iter->priv->parent_actor)
+    {
+      ClutterActorPrivate *iter_priv = iter->priv;
+      const GeometricPickInfo *info;
+
+      info = clutter_actor_get_geometric_pick_info (iter);
+      if (info == NULL)
+        return FALSE;
+
+      if (info->can_pick != NULL && !info->can_pick (iter))
+        return FALSE;
+
+      if (!iter_priv->enable_model_view_transform ||
+          g_signal_has_handler_pending (iter, actor_signals[PICK], 0, TRUE))
+        return FALSE;
+
+      if (CLUTTER_ACTOR_IS_TOPLEVEL (iter))
+        break;
+
+      if (iter_priv->has_clip || iter_priv->clip_to_allocation)
+        return FALSE;
+
+      if (iter != self && !info->pick_children)
+        return FALSE;
+    }
+
+  if (iter == NULL)
+    return FALSE;
+
+  box.x1 = 0;
+  box.y1 = 0;
+  box.x2 = priv->allocation.x2 - priv->allocation.x1;
+  box.y2 = priv->allocation.y2 - priv->allocation.y1;
+
+  if (!_clutter_actor_transform_and_project_box (self, &box, verts))
+    return FALSE;
+
+  bounds.x1 = bounds.x2 = verts[0].x;
+  bounds.y1 = bounds.y2 = verts[0].y;
+  for (i = 1; i < 4; i++)
+    {
+      bounds.x1 = MIN (bounds.x1, verts[i].x);
+      bounds.y1 = MIN (bounds.y1, verts[i].y);
+      bounds.x2 = MAX (bounds.x2, verts[i].x);
+      bounds.y2 = MAX (bounds.y2, verts[i].y);
+    }
+
+  /* the children of @self are painted on top of it, and so are the
+   * siblings that follow @self and each of its ancestors */
+  if (clutter_actor_children_may_pick_in_box (self, NULL, &bounds))
+    return FALSE;
+
+  for (iter = self;
+       !CLUTTER_ACTOR_IS_TOPLEVEL (iter);
+       iter = iter->priv->parent_actor)
+    {
+      if (clutter_actor_children_may_pick_in_box (iter->priv->parent_actor,
+                                                  iter,
+                                                  &bounds))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/*< private >
+ * _clutter_actor_point_in_quad:
+ * @verts: (array fixed-size=4): the vertices of a quad, in the order
+ *   returned by clutter_actor_get_abs_allocation_vertices()
+ * @x: X coordinate of the point
+ * @y: Y coordinate of the point
+ *
+ * Checks whether (@x, @y) is inside the quad defined by @verts
+ *
+ * Return value: %TRUE if the point is inside the quad
+ */
+gboolean
+_clutter_actor_point_in_quad (const ClutterVertex verts[],
+                              gfloat              x,
+                              gfloat              y)
+{
+  return point_in_quad (verts, x, y);
+}
+
+/* Occlusion culling
+ *
+ * Before painting the stage we walk the scene graph in reverse
+ * painting order, like the geometric pick does, and we collect the
+ * window-space rectangles covered by the actors that paint their
+ * whole allocation with opaque pixels. An actor whose paint box is
+ * contained in one of the rectangles collected so far is completely
+ * hidden by something painted on top of it, so clutter_actor_paint()
+ * can skip it together with its children.
+ *
+ * We only keep a handful of occluders, and we only use rectangles
+ * that are aligned to the window: this is enough for the common case
+ * of full-screen backgrounds and windows covering each other.
+ */
+#define MAX_OCCLUDERS   16
+
+typedef struct _OcclusionState
+{
+  ClutterStage *stage;
+
+  ClutterActorBox occluders[MAX_OCCLUDERS];
+  guint n_occluders;
+
+  /* the area of the window being painted */
+  ClutterActorBox clip;
+
+  /* the number of actors found so far that are painted on top of
+   * everything we visit next */
+  guint n_painted;
+
+  /* the first occluder hiding the whole clip, and whether anything
+   * is painted on top of it */
+  ClutterActor *covering_actor;
+  gboolean covering_actor_is_topmost;
+} OcclusionState;
+
+/* the stamp of the last occlusion pass; 0 means no pass ran */
+static guint occlusion_stamp = 0;
+
+static inline gboolean
+clutter_actor_is_occluded (ClutterActor *self)
+{
+  return occlusion_stamp != 0 &&
+         self->priv->occlusion_stamp == occlusion_stamp;
+}
+
+static gboolean
+occlusion_state_covers (const OcclusionState  *state,
+                        const ClutterActorBox *box)
+{
+  guint i;
+
+  for (i = 0; i < state->n_occluders; i++)
+    {
+      const ClutterActorBox *occluder = &state->occluders[i];
+
+      if (box->x1 >= occluder->x1 && box->x2 <= occluder->x2 &&
+          box->y1 >= occluder->y1 && box->y2 <= occluder->y2)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+/* Checks whether painting @self fills its whole allocation with
+ * opaque pixels */
+static gboolean
+clutter_actor_paints_opaque (ClutterActor *self)
+{
+  const ExtraInfo *extra;
+  ClutterActorPrivate *priv = self->priv;
+
+  extra = clutter_actor_get_extra_info_or_defaults (self);
+
+  /* clipped actors, and actors whose painting can be modified by an
+   * effect or a shader, do not cover their allocation */
+  if (priv->has_clip || extra->effects != NULL || actor_has_shader_data (self))
+    return FALSE;
+
+  if (!clutter_actor_is_opaque (self))
+    return FALSE;
+
+  return clutter_actor_get_paint_opacity (self) == 255;
+}
+
+/* Adds the window-space box covered by @self to the occluders, if
+ * the actor is opaque and its allocation is transformed into a
+ * rectangle aligned to the window */
+static void
+occlusion_state_add_actor (OcclusionState *state,
+                           ClutterActor   *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActorBox box, *occluder;
+  ClutterVertex verts[4];
+
+  if (state->n_occluders == MAX_OCCLUDERS)
+    return;
+
+  if (!clutter_actor_paints_opaque (self))
+    return;
+
+  box.x1 = 0;
+  box.y1 = 0;
+  box.x2 = priv->allocation.x2 - priv->allocation.x1;
+  box.y2 = priv->allocation.y2 - priv->allocation.y1;
+
+  if (!_clutter_actor_transform_and_project_box (self, &box, verts))
+    return;
+
+  if (fabsf (verts[0].y - verts[1].y) > 0.01f ||
+      fabsf (verts[2].y - verts[3].y) > 0.01f ||
+      fabsf (verts[0].x - verts[2].x) > 0.01f ||
+      fabsf (verts[1].x - verts[3].x) > 0.01f)
+    return;
+
+  /* only the pixels that are entirely inside the allocation are
+   * opaque, so we round the box inwards */
+  occluder = &state->occluders[state->n_occluders];
+  occluder->x1 = ceilf (MIN (verts[0].x, verts[1].x));
+  occluder->x2 = floorf (MAX (verts[0].x, verts[1].x));
+  occluder->y1 = ceilf (MIN (verts[0].y, verts[2].y));
+  occluder->y2 = floorf (MAX (verts[0].y, verts[2].y));
+
+  if (occluder->x2 <= occluder->x1 || occluder->y2 <= occluder->y1)
+    return;
+
+  CLUTTER_NOTE (CLIPPING, "Adding occluder '%s': %.0f, %.0f - %.0f, %.0f",
+                _clutter_actor_get_debug_name (self),
+                occluder->x1, occluder->y1,
+                occluder->x2, occluder->y2);
+
+  state->n_occluders += 1;
+
+  if (state->covering_actor == NULL &&
+      occlusion_state_covers (state, &state->clip))
+    {
+      state->covering_actor = self;
+      state->covering_actor_is_topmost = state->n_painted == 0;
+
+      CLUTTER_NOTE (CLIPPING, "Actor '%s' covers the stage%s",
+                    _clutter_actor_get_debug_name (self),
+                    state->covering_actor_is_topmost ? " on its own" : "");
+    }
+}
+
+/* Shrinks the clip to the bounding box of the part that is not hidden
+ * by the occluders, by cutting off the occluders spanning a whole
+ * side of it; the result is empty if the occluders cover the clip,
+ * even if none of them covers it on its own */
+static void
+occlusion_state_get_uncovered_box (const OcclusionState *state,
+                                   ClutterActorBox      *box)
+{
+  gboolean changed;
+  guint i;
+
+  *box = state->clip;
+
+  do
+    {
+      changed = FALSE;
+
+      for (i = 0; i < state->n_occluders; i++)
+        {
+          const ClutterActorBox *occluder = &state->occluders[i];
+
+          if (box->x2 <= box->x1 || box->y2 <= box->y1)
+            {
+              box->x2 = box->x1;
+              box->y2 = box->y1;
+              return;
+            }
+
+          if (occluder->x1 <= box->x1 && occluder->x2 >= box->x2)
+            {
+              if (occluder->y1 <= box->y1 && occluder->y2 > box->y1)
+                {
+                  box->y1 = occluder->y2;
+                  changed = TRUE;
+                }
+
+              if (occluder->y2 >= box->y2 && occluder->y1 < box->y2)
+                {
+                  box->y2 = occluder->y1;
+                  changed = TRUE;
+                }
+            }
+          else if (occluder->y1 <= box->y1 && occluder->y2 >= box->y2)
+            {
+              if (occluder->x1 <= box->x1 && occluder->x2 > box->x1)
+                {
+                  box->x1 = occluder->x2;
+                  changed = TRUE;
+                }
+
+              if (occluder->x2 >= box->x2 && occluder->x1 < box->x2)
+                {
+                  box->x2 = occluder->x1;
+                  changed = TRUE;
+                }
+            }
+        }
+    }
+  while (changed);
+
+  if (box->x2 <= box->x1 || box->y2 <= box->y1)
+    {
+      box->x2 = box->x1;
+      box->y2 = box->y1;
+    }
+}
+
+static void
+clutter_actor_compute_occlusion_internal (ClutterActor   *self,
+                                          OcclusionState *state,
+                                          gboolean        can_occlude)
+{
+  const ExtraInfo *extra;
+  ClutterActorPrivate *priv = self->priv;
+  const GeometricPickInfo *info;
+  gboolean is_toplevel;
+
+  extra = clutter_actor_get_extra_info_or_defaults (self);
+
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (self))
+    return;
+
+  if (!CLUTTER_ACTOR_IS_MAPPED (self))
+    return;
+
+  is_toplevel = CLUTTER_ACTOR_IS_TOPLEVEL (self);
+
+  /* actors with 0 opacity are not painted at all, so they do not
+   * hide anything; their children are not painted either */
+  if (!is_toplevel &&
+      ((priv->opacity_override >= 0) ?
+       priv->opacity_override : priv->opacity) == 0)
+    return;
+
+  /* nothing can be hidden until we have found an occluder, so we
+   * avoid computing the paint box of the front-most actors */
+  if (!is_toplevel && state->n_occluders > 0)
+    {
+      ClutterPaintVolume *pv;
+      ClutterActorBox box;
+
+      pv = _clutter_actor_get_paint_volume_mutable (self);
+      if (pv != NULL)
+        {
+          _clutter_paint_volume_get_stage_paint_box (pv, state->stage, &box);
+
+          if (occlusion_state_covers (state, &box))
+            {
+              CLUTTER_NOTE (CLIPPING, "Actor '%s' is occluded",
+                            _clutter_actor_get_debug_name (self));
+
+              priv->occlusion_stamp = occlusion_stamp;
+              return;
+            }
+        }
+    }
+
+  /* the children of actors painted through an effect might end up
+   * anywhere, or nowhere, on the stage */
+  if (extra->effects != NULL || !priv->enable_model_view_transform)
+    {
+      state->n_painted += 1;
+      return;
+    }
+
+  /* the children of clipped actors could still be occluded, but they
+   * do not cover their allocation */
+  if (priv->has_clip || priv->clip_to_allocation)
+    can_occlude = FALSE;
+
+  /* we can only rely on the painting order of the children of the
+   * containers that paint them in the order of the geometric pick */
+  info = clutter_actor_get_geometric_pick_info (self);
+  if (info != NULL && info->pick_children && CLUTTER_IS_CONTAINER (self))
+    {
+      ClutterContainerIter iter;
+      ClutterActor *child;
+
+      clutter_container_iter_init (&iter, CLUTTER_CONTAINER (self));
+      while (clutter_container_iter_prev (&iter, &child))
+        clutter_actor_compute_occlusion_internal (child, state, can_occlude);
+    }
+
+  /* the actor itself is painted below its children, but on top of
+   * everything we are going to visit next */
+  if (!is_toplevel)
+    {
+      if (can_occlude)
+        occlusion_state_add_actor (state, self);
+
+      state->n_painted += 1;
+    }
+}
+
+/*< private >
+ * _clutter_actor_compute_occlusion:
+ * @self: a #ClutterStage
+ *
+ * Walks the scene graph of @self in reverse painting order to find
+ * the actors that are hidden behind opaque actors painted after
+ * them; the actors found are skipped by clutter_actor_paint() until
+ * the next call to this function.
+ *
+ * The first opaque actor found to hide the whole area being painted
+ * is recorded using _clutter_stage_set_covering_actor(), and the part
+ * of the area left uncovered by all the opaque actors is recorded
+ * using _clutter_stage_set_clear_area().
+ */
+void
+_clutter_actor_compute_occlusion (ClutterActor *self)
+{
+  OcclusionState state;
+  ClutterGeometry clip;
+  ClutterActorBox uncovered;
+
+  g_return_if_fail (CLUTTER_IS_STAGE (self));
+
+  /* 0 is reserved to mark actors that were never occluded */
+  occlusion_stamp += 1;
+  if (G_UNLIKELY (occlusion_stamp == 0))
+    occlusion_stamp = 1;
+
+  _clutter_stage_set_covering_actor (CLUTTER_STAGE (self), NULL, FALSE);
+  _clutter_stage_set_clear_area (CLUTTER_STAGE (self), NULL);
+
+  if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_DISABLE_CULLING))
+    return;
+
+  state.stage = CLUTTER_STAGE (self);
+  state.n_occluders = 0;
+  state.n_painted = 0;
+  state.covering_actor = NULL;
+  state.covering_actor_is_topmost = FALSE;
+
+  _clutter_stage_get_clip_geometry (state.stage, &clip);
+  state.clip.x1 = clip.x;
+  state.clip.y1 = clip.y;
+  state.clip.x2 = clip.x + clip.width;
+  state.clip.y2 = clip.y + clip.height;
+
+  clutter_actor_compute_occlusion_internal (self, &state, TRUE);
+
+  if (state.covering_actor != NULL)
+    _clutter_stage_set_covering_actor (state.stage,
+                                       state.covering_actor,
+                                       state.covering_actor_is_topmost);
+
+  occlusion_state_get_uncovered_box (&state, &uncovered);
+  clip.x = uncovered.x1;
+  clip.y = uncovered.y1;
+  clip.width = uncovered.x2 - uncovered.x1;
+  clip.height = uncovered.y2 - uncovered.y1;
+
+  _clutter_stage_set_clear_area (state.stage, &clip);
+}
+
+/* This is the same as clutter_actor_add_effect except that it doesn't
+   queue a redraw and it doesn't notify on the effect property */
+static void
+_clutter_actor_add_effect_internal (ClutterActor  *self,
+                                    ClutterEffect *effect)
+{
+  ExtraInfo *extra = clutter_actor_get_extra_info (self);
+
+  if (extra->effects == NULL)
+    {
+      extra->effects = g_object_new (CLUTTER_TYPE_META_GROUP, NULL);
+      extra->effects->actor = self;
+    }
+
+  _clutter_meta_group_add_meta (extra->effects, CLUTTER_ACTOR_META (effect));
+}
+
+/* This is the same as clutter_actor_remove_effect except that it doesn't
+   queue a redraw and it doesn't notify on the effect property */
+static void
+_clutter_actor_remove_effect_internal (ClutterActor  *self,
+                                       ClutterEffect *effect)
+{
+  const ExtraInfo *extra;
+
+  extra = clutter_actor_get_extra_info_or_defaults (self);
+
+  if (extra->effects == NULL)
+    return;
+
+  _clutter_meta_group_remove_meta (extra->effects, CLUTTER_ACTOR_META (effect));
+}
+
+/* the number of frames an actor has to stay unchanged, while being
+ * moved, before its image is cached */
+#define SUBTREE_CACHE_STATIC_FRAMES     4
+
+/* the size of the images cached by all the actors, in bytes */
+static gsize subtree_cache_total = 0;
+
+/* the number of automatically cached actors being painted into their
+ * offscreen buffer */
+static int subtree_cache_paint_level = 0;
+
+static gboolean
+needs_flatten_effect (ClutterActor *self)
+{
+  const ExtraInfo *extra;
+
+  extra = clutter_actor_get_extra_info_or_defaults (self);
+
+  switch (extra->offscreen_redirect)
+    {
+    case CLUTTER_OFFSCREEN_REDIRECT_AUTOMATIC_FOR_OPACITY:
+      if (!clutter_actor_has_overlaps (self))
+        return FALSE;
+      /* flow through */
+    case CLUTTER_OFFSCREEN_REDIRECT_ALWAYS_FOR_OPACITY:
+      return clutter_actor_get_paint_opacity (self) < 255;
+
+    case CLUTTER_OFFSCREEN_REDIRECT_ALWAYS:
+      return TRUE;
+    }
+
+  g_assert_not_reached ();
+}
+
+/* updates the number of frames since @self last changed or moved,
+ * which are used to decide whether its image should be cached */
+static void
+clutter_actor_update_static_frames (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  if (priv->propagated_one_redraw)
+    {
+      priv->frames_since_redraw = 0;
+      priv->display_list_failed = FALSE;
+    }
+  else if (priv->frames_since_redraw < G_MAXUINT8)
+    priv->frames_since_redraw += 1;
+
+  if (priv->stage_transform_changed)
+    {
+      priv->frames_since_move = 0;
+      priv->stage_transform_changed = FALSE;
+    }
+  else if (priv->frames_since_move < G_MAXUINT8)
+    priv->frames_since_move += 1;
+}
+
+/* Checks whether the image of @self should be cached in an offscreen
+ * buffer, even though the application did not ask for it: if neither
+ * @self nor its children changed in the last few frames, but @self
+ * is being moved on the stage by one of its ancestors, the image can
+ * be painted again at the new position instead of painting the whole
+ * subtree. The offscreen buffers used by all the actors cached this
+ * way must fit in the budget returned by
+ * _clutter_context_get_subtree_cache_budget(); @size is set to the
+ * number of bytes that the buffer of @self would use
+ */
+static gboolean
+clutter_actor_should_cache_subtree (ClutterActor *self,
+                                    gsize        *size)
+{
+  ClutterActorPrivate *priv = self->priv;
+  const ExtraInfo *extra;
+  ClutterActorBox box;
+  gfloat width, height;
+
+  extra = clutter_actor_get_extra_info_or_defaults (self);
+
+  *size = extra->subtree_cache_size;
+
+  /* the counters are not updated when painting inside a clone, so
+   * nothing changed since the last paint of the actor */
+  if (in_clone_paint ())
+    return extra->subtree_cache_size > 0;
+
+  if (G_UNLIKELY (clutter_paint_debug_flags &
+                  CLUTTER_DEBUG_DISABLE_SUBTREE_CACHE))
+    return FALSE;
+
+  /* painting a single actor is cheaper than going through an
+   * offscreen buffer */
+  if (priv->children == NULL)
+    return FALSE;
+
+  if (priv->frames_since_redraw < SUBTREE_CACHE_STATIC_FRAMES ||
+      priv->frames_since_move >= SUBTREE_CACHE_STATIC_FRAMES)
+    return FALSE;
+
+  /* one of our ancestors is being cached, and we are painted into
+   * its image */
+  if (subtree_cache_paint_level > 0)
+    return FALSE;
+
+  if (!clutter_actor_get_paint_box (self, &box))
+    return FALSE;
+
+  clutter_actor_box_get_size (&box, &width, &height);
+  *size = (gsize) ceilf (width) * (gsize) ceilf (height) * 4;
+
+  return subtree_cache_total - extra->subtree_cache_size + *size <=
+         _clutter_context_get_subtree_cache_budget ();
+}
+
+static void
+clutter_actor_remove_flatten_effect (ClutterActor *self)
+{
+  ExtraInfo *extra = self->priv->extra_info;
+  CLUTTER_STATIC_COUNTER (subtree_cache_eviction_counter,
+                          "Subtree cache evictions",
+                          "Increments each time the cached image of a "
+                          "static subtree is dropped",
+                          0 /* no application private data */);
+
+  if (extra == NULL || extra->flatten_effect == NULL)
+    return;
+
+  if (extra->subtree_cache_size > 0)
+    {
+      CLUTTER_COUNTER_INC (_clutter_uprof_context,
+                           subtree_cache_eviction_counter);
+      CLUTTER_NOTE (PAINT, "Dropping the cached image of actor '%s' "
+                    "(%" G_GSIZE_FORMAT " bytes)",
+                    _clutter_actor_get_debug_name (self),
+                    extra->subtree_cache_size);
+
+      subtree_cache_total -= extra->subtree_cache_size;
+      extra->subtree_cache_size = 0;
+    }
+
+  /* Destroy the effect so that it will lose its fbo cache of
+     the actor */
+  _clutter_actor_remove_effect_internal (self, extra->flatten_effect);
+  g_object_unref (extra->flatten_effect);
+  extra->flatten_effect = NULL;
+}
+
+/* drops the image of @self if it was cached automatically */
+static void
+clutter_actor_drop_subtree_cache (ClutterActor *self)
+{
+  const ExtraInfo *extra;
+
+  extra = clutter_actor_get_extra_info_or_defaults (self);
+
+  if (extra->subtree_cache_size > 0)
+    clutter_actor_remove_flatten_effect (self);
+}
+
+static void
+add_or_remove_flatten_effect (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ExtraInfo *extra;
+  gboolean needed, is_automatic = FALSE;
+  gsize cache_size = 0;
+  CLUTTER_STATIC_COUNTER (subtree_cache_counter,
+                          "Subtree cache insertions",
+                          "Increments each time the image of a static "
+                          "subtree is cached",
+                          0 /* no application private data */);
+
+  if (!in_clone_paint ())
+    clutter_actor_update_static_frames (self);
+
+  /* Add or remove the flatten effect depending on the
+     offscreen-redirect property, or on whether the actor is a
+     static subtree that is worth caching */
+  /* the decision only changes with the offscreen-redirect property,
+   * the has_overlaps() virtual and the paint opacity */
+  if (G_UNLIKELY (!priv->flatten_valid || !priv->paint_opacity_valid))
+    {
+      priv->needs_flatten = needs_flatten_effect (self);
+      priv->flatten_valid = TRUE;
+
+      /* painting an actor outside of its parent, like a clone does,
+       * should not break the invariant that all the descendants of
+       * an actor with an invalid paint opacity are invalid as well */
+      priv->paint_opacity_valid =
+        priv->parent_actor == NULL ||
+        priv->parent_actor->priv->paint_opacity_valid;
+    }
+
+  needed = priv->needs_flatten;
+  if (!needed)
+    needed = is_automatic =
+      clutter_actor_should_cache_subtree (self, &cache_size);
+
+  if (!needed)
+    {
+      clutter_actor_remove_flatten_effect (self);
+      return;
+    }
+
+  extra = clutter_actor_get_extra_info (self);
+
+  if (extra->flatten_effect == NULL)
+    {
+      ClutterActorMeta *actor_meta;
+      gint priority;
+
+      extra->flatten_effect = _clutter_flatten_effect_new ();
+      /* Keep a reference to the effect so that we can queue
+         redraws from it */
+      g_object_ref_sink (extra->flatten_effect);
+
+      /* Set the priority of the effect to high so that it will
+         always be applied to the actor first. It uses an internal
+         priority so that it won't be visible to applications */
+      actor_meta = CLUTTER_ACTOR_META (extra->flatten_effect);
+      priority = CLUTTER_ACTOR_META_PRIORITY_INTERNAL_HIGH;
+      _clutter_actor_meta_set_priority (actor_meta, priority);
+
+      /* This will add the effect without queueing a redraw */
+      _clutter_actor_add_effect_internal (self, extra->flatten_effect);
+
+      if (is_automatic)
+        {
+          CLUTTER_COUNTER_INC (_clutter_uprof_context,
+                               subtree_cache_counter);
+          CLUTTER_NOTE (PAINT, "Caching the image of actor '%s' "
+                        "(%" G_GSIZE_FORMAT " bytes)",
+                        _clutter_actor_get_debug_name (self),
+                        cache_size);
+        }
+    }
+
+  /* an image cached automatically follows the actor when one of
+   * its ancestors moves it */
+  _clutter_offscreen_effect_set_reuse_translated
+    (CLUTTER_OFFSCREEN_EFFECT (extra->flatten_effect), is_automatic);
+
+  subtree_cache_total -= extra->subtree_cache_size;
+  extra->subtree_cache_size = is_automatic ? cache_size : 0;
+  subtree_cache_total += extra->subtree_cache_size;
+}
+
+/* the number of frames an actor has to stay unchanged before the
+ * paint of its subtree is recorded */
+#define DISPLAY_LIST_STATIC_FRAMES      2
+
+static void
+clutter_actor_drop_display_list (ClutterActor *self)
+{
+  ExtraInfo *extra = self->priv->extra_info;
+
+  if (extra == NULL || extra->display_list == NULL)
+    return;
+
+  _clutter_display_list_free (extra->display_list);
+  extra->display_list = NULL;
+}
+
+/* checks whether the paint of @self can be part of a display list;
+ * the clip of the root of the list is set outside of it, so it is
+ * only checked for the other actors */
+static gboolean
+clutter_actor_can_be_recorded (ClutterActor *self)
+{
+  const ExtraInfo *extra;
+
+  extra = clutter_actor_get_extra_info_or_defaults (self);
+
+  return extra->effects == NULL &&
+         !actor_has_shader_data (self) &&
+         _clutter_display_list_is_recordable_type (G_OBJECT_TYPE (self)) &&
+         !g_signal_has_handler_pending (self, actor_signals[PAINT], 0, TRUE);
+}
+
+static gboolean
+clutter_actor_should_record (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  /* the counters are not updated when painting inside a clone */
+  if (in_clone_paint ())
+    return FALSE;
+
+  if (G_UNLIKELY (clutter_paint_debug_flags &
+                  CLUTTER_DEBUG_DISABLE_DISPLAY_LISTS))
+    return FALSE;
+
+  /* replaying the paint of a single actor saves nothing */
+  if (priv->children == NULL)
+    return FALSE;
+
+  if (priv->frames_since_redraw < DISPLAY_LIST_STATIC_FRAMES ||
+      priv->display_list_failed)
+    return FALSE;
+
+  return clutter_actor_can_be_recorded (self);
+}
+
+/* Paints @self like clutter_actor_continue_paint() does, but if
+ * neither @self nor its children changed in the last few frames the
+ * paint of the subtree is recorded into a display list, which is
+ * replayed in the next frames instead of running the paint function
+ * of each actor; a redraw queued inside the subtree drops the list */
+static void
+clutter_actor_paint_retained (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ExtraInfo *extra;
+  guint8 opacity;
+  CLUTTER_STATIC_COUNTER (display_list_replay_counter,
+                          "Display list replays",
+                          "Increments each time the paint of a static "
+                          "subtree is replayed",
+                          0 /* no application private data */);
+  CLUTTER_STATIC_COUNTER (display_list_record_counter,
+                          "Display list recordings",
+                          "Increments each time the paint of a static "
+                          "subtree is recorded",
+                          0 /* no application private data */);
+
+  if (_clutter_display_list_is_recording ())
+    {
+      if ((priv->has_clip || priv->clip_to_allocation) ||
+          !clutter_actor_can_be_recorded (self))
+        _clutter_display_list_abort_recording ();
+
+      /* the list of @self is superseded by the one of its ancestor */
+      clutter_actor_drop_display_list (self);
+      clutter_actor_continue_paint (self);
+      return;
+    }
+
+  if (!clutter_actor_should_record (self))
+    {
+      clutter_actor_drop_display_list (self);
+      clutter_actor_continue_paint (self);
+      return;
+    }
+
+  extra = clutter_actor_get_extra_info (self);
+
+  /* the colors in the list include the paint opacity, which changes
+   * without a redraw being queued on @self when an ancestor changes
+   * its opacity */
+  opacity = clutter_actor_get_paint_opacity (self);
+
+  if (extra->display_list != NULL &&
+      _clutter_display_list_get_opacity (extra->display_list) == opacity)
+    {
+      CLUTTER_COUNTER_INC (_clutter_uprof_context,
+                           display_list_replay_counter);
+
+      _clutter_display_list_replay (extra->display_list);
+      return;
+    }
+
+  clutter_actor_drop_display_list (self);
+
+  _clutter_display_list_begin_recording (opacity);
+  clutter_actor_continue_paint (self);
+  extra->display_list = _clutter_display_list_end_recording ();
+
+  if (extra->display_list != NULL)
+    {
+      CLUTTER_COUNTER_INC (_clutter_uprof_context,
+                           display_list_record_counter);
+      CLUTTER_NOTE (PAINT, "Recorded the paint of actor '%s'",
+                    _clutter_actor_get_debug_name (self));
+    }
+  else
+    priv->display_list_failed = TRUE;
+}
+
+/* Opaque pass
+ *
+ * When a stage sorts its paint by depth, the actors are painted with
+ * the depth test enabled, and the depth written for each actor is its
+ * position in the painting order of the stage instead of its distance
+ * from the eye: each actor is in front of the actors painted before
+ * it, so the result is the same as painting back to front, even for
+ * actors that intersect or lie on the same plane.
+ *
+ * Before painting the children of the stage we walk the scene graph
+ * in painting order, like the occlusion pass does, to assign the
+ * position of each actor, and we paint the opaque actors without
+ * children front to back; the depth test then discards every pixel
+ * painted, in the normal pass, below an opaque actor painted on top
+ * of it.
+ *
+ * The painting order of the descendants of an actor painted through
+ * an effect, of a container that does not paint its children in the
+ * order of the geometric pick, or of a subtree replayed from a cache
+ * is not known, so the whole subtree is painted without the depth
+ * test, and the opaque actors painted after it and overlapping its
+ * paint box are left to the normal pass.
+ */
+
+/* the distance between the depth of two actors consecutive in the
+ * painting order, in normalized device coordinates; it spans two
+ * values of a 16 bits depth buffer */
+#define OPAQUE_PASS_DEPTH_STEP  (1.0f / 16384.0f)
+
+/* the number of positions in the range of the depth buffer */
+#define OPAQUE_PASS_MAX_ORDER   32767
+
+typedef struct _OpaquePassState
+{
+  ClutterStage *stage;
+
+  guint n_ordered;
+
+  /* the opaque actors without children, in painting order */
+  GPtrArray *candidates;
+
+  /* the paint boxes of the subtrees painted without the depth test */
+  GArray *unordered_boxes;
+  gboolean unordered_everywhere;
+} OpaquePassState;
+
+/* the stamp of the last opaque pass; 0 means no pass ran */
+static guint opaque_pass_stamp = 0;
+
+/* set while the stage is painting with the depth test, after the
+ * opaque pass */
+static gboolean opaque_pass_active = FALSE;
+
+/* the number of subtrees painted without the depth test that are
+ * being painted */
+static guint opaque_pass_unordered_level = 0;
+
+/* the projection of the stage, without the depth of any actor */
+static CoglMatrix opaque_pass_projection;
+
+static gboolean
+clutter_actor_is_ordered (ClutterActor *self)
+{
+  return opaque_pass_stamp != 0 &&
+         self->priv->opaque_pass_stamp == opaque_pass_stamp;
+}
+
+/* sets up the projection so that everything painted is at the depth
+ * of @order in the painting order, whatever its distance from the eye */
+static void
+opaque_pass_set_order (guint order)
+{
+  CoglMatrix projection = opaque_pass_projection;
+  gfloat depth;
+
+  depth = 1.0f - (order + 1) * OPAQUE_PASS_DEPTH_STEP;
+
+  /* the clip-space Z is the clip-space W scaled by the depth, so the
+   * depth is the same after the perspective division */
+  projection.zx = depth * projection.wx;
+  projection.zy = depth * projection.wy;
+  projection.zz = depth * projection.wz;
+  projection.zw = depth * projection.ww;
+
+  cogl_set_projection_matrix (&projection);
+}
+
+static gboolean
+opaque_pass_state_is_unordered (const OpaquePassState *state,
+                                const ClutterActorBox *box)
+{
+  guint i;
+
+  if (state->unordered_everywhere)
+    return TRUE;
+
+  for (i = 0; i < state->unordered_boxes->len; i++)
+    {
+      const ClutterActorBox *unordered;
+
+      unordered = &g_array_index (state->unordered_boxes, ClutterActorBox, i);
+
+      if (box->x1 < unordered->x2 && box->x2 > unordered->x1 &&
+          box->y1 < unordered->y2 && box->y2 > unordered->y1)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static void
+opaque_pass_state_add_unordered (OpaquePassState *state,
+                                 ClutterActor    *self)
+{
+  ClutterPaintVolume *pv;
+  ClutterActorBox box;
+
+  pv = _clutter_actor_get_paint_volume_mutable (self);
+  if (pv == NULL)
+    {
+      state->unordered_everywhere = TRUE;
+      return;
+    }
+
+  _clutter_paint_volume_get_stage_paint_box (pv, state->stage, &box);
+  g_array_append_val (state->unordered_boxes, box);
+}
+
+/* checks whether the painting order of the descendants of @self is
+ * unknown, or whether @self is painted in a way that does not honour
+ * the depth we set up */
+static gboolean
+clutter_actor_paints_unordered (ClutterActor *self)
+{
+  const ExtraInfo *extra;
+  const GeometricPickInfo *info;
+  ClutterActorPrivate *priv = self->priv;
+
+  extra = clutter_actor_get_extra_info_or_defaults (self);
+
+  if (extra->effects != NULL || !priv->enable_model_view_transform)
+    return TRUE;
+
+  /* caches replay the paint of the whole subtree at once */
+  if (extra->subtree_cache_size > 0 ||
+      extra->display_list != NULL ||
+      clutter_actor_should_record (self))
+    return TRUE;
+
+  if (priv->children == NULL)
+    return FALSE;
+
+  info = clutter_actor_get_geometric_pick_info (self);
+
+  return info == NULL ||
+         !info->pick_children ||
+         !CLUTTER_IS_CONTAINER (self);
+}
+
+static void
+clutter_actor_order_for_opaque_pass (ClutterActor    *self,
+                                     OpaquePassState *state,
+                                     gboolean         can_be_opaque)
+{
+  ClutterActorPrivate *priv = self->priv;
+  gboolean is_toplevel;
+
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (self))
+    return;
+
+  if (!CLUTTER_ACTOR_IS_MAPPED (self))
+    return;
+
+  is_toplevel = CLUTTER_ACTOR_IS_TOPLEVEL (self);
+
+  /* actors with 0 opacity are not painted at all */
+  if (!is_toplevel &&
+      ((priv->opacity_override >= 0) ?
+       priv->opacity_override : priv->opacity) == 0)
+    return;
+
+  /* the actors that do not fit in the depth buffer, and everything
+   * painted after them, are painted without the depth test */
+  if (state->n_ordered == OPAQUE_PASS_MAX_ORDER)
+    return;
+
+  priv->opaque_pass_stamp = opaque_pass_stamp;
+  priv->opaque_pass_order = state->n_ordered++;
+  priv->opaque_pass_end_order = priv->opaque_pass_order;
+  priv->opaque_pass_unordered = FALSE;
+  priv->opaque_pass_painted = FALSE;
+
+  /* a flatten effect added when painting paints the subtree in an
+   * offscreen buffer, which does not use the order of the stage, and
+   * then paints it at the position of @self */
+  if (!is_toplevel)
+    {
+      if (clutter_actor_paints_unordered (self))
+        {
+          priv->opaque_pass_unordered = TRUE;
+          opaque_pass_state_add_unordered (state, self);
+          return;
+        }
+    }
+
+  /* we paint the candidates without pushing the clip of the ancestors */
+  if (priv->has_clip || priv->clip_to_allocation)
+    can_be_opaque = FALSE;
+
+  if (priv->children == NULL)
+    {
+      ClutterPaintVolume *pv;
+      ClutterActorBox box;
+
+      if (!can_be_opaque || is_toplevel)
+        return;
+
+      if (!priv->last_paint_volume_valid ||
+          _clutter_actor_get_stage_transform (self) == NULL ||
+          !clutter_actor_paints_opaque (self))
+        return;
+
+      pv = _clutter_actor_get_paint_volume_mutable (self);
+      if (pv == NULL)
+        return;
+
+      /* a subtree painted before @self without the depth test would
+       * be painted over it */
+      _clutter_paint_volume_get_stage_paint_box (pv, state->stage, &box);
+      if (opaque_pass_state_is_unordered (state, &box))
+        return;
+
+      g_ptr_array_add (state->candidates, self);
+    }
+  else
+    {
+      ClutterContainerIter iter;
+      ClutterActor *child;
+
+      clutter_container_iter_init (&iter, CLUTTER_CONTAINER (self));
+      while (clutter_container_iter_next (&iter, &child))
+        clutter_actor_order_for_opaque_pass (child, state, can_be_opaque);
+
+      /* what @self paints after its children goes on top of them */
+      if (state->n_ordered < OPAQUE_PASS_MAX_ORDER)
+        priv->opaque_pass_end_order = state->n_ordered++;
+      else
+        priv->opaque_pass_end_order = OPAQUE_PASS_MAX_ORDER - 1;
+    }
+}
+
+static void
+clutter_actor_paint_opaque (ClutterActor     *self,
+                            const CoglMatrix *stage_modelview)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterCullResult result = CLUTTER_CULL_RESULT_IN;
+  CoglMatrix matrix;
+
+  /* the normal pass culls the actor as well */
+  if ((cull_actor (self, &result) && result == CLUTTER_CULL_RESULT_OUT) ||
+      clutter_actor_is_occluded (self))
+    return;
+
+  CLUTTER_SET_PRIVATE_FLAGS (self, CLUTTER_IN_PAINT);
+
+  cogl_push_matrix ();
+
+  cogl_matrix_multiply (&matrix,
+                        stage_modelview,
+                        _clutter_actor_get_stage_transform (self));
+  cogl_set_modelview_matrix (&matrix);
+
+  opaque_pass_set_order (priv->opaque_pass_order);
+
+  n_painted_actors += 1;
+
+  if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_OVERDRAW))
+    _clutter_actor_record_overdraw (self);
+
+  priv->next_effect_to_paint = NULL;
+  clutter_actor_continue_paint (self);
+
+  cogl_pop_matrix ();
+
+  CLUTTER_UNSET_PRIVATE_FLAGS (self, CLUTTER_IN_PAINT);
+
+  priv->opaque_pass_painted = TRUE;
+}
+
+/*< private >
+ * _clutter_actor_paint_opaque_pass:
+ * @self: a #ClutterStage
+ *
+ * Assigns the position in the painting order to the actors of @self,
+ * and paints the opaque actors without children front to back, with
+ * the depth of their position.
+ *
+ * This function should be called by the stage before painting its
+ * children, with the depth test enabled; the following calls to
+ * clutter_actor_paint() skip the actors painted here, and paint the
+ * others with the depth of their position, until the call to
+ * _clutter_actor_finish_opaque_pass().
+ */
+void
+_clutter_actor_paint_opaque_pass (ClutterActor *self)
+{
+  OpaquePassState state;
+  CoglMatrix stage_modelview;
+  gint i;
+
+  g_return_if_fail (CLUTTER_IS_STAGE (self));
+
+  /* 0 is reserved to mark actors that were never ordered */
+  opaque_pass_stamp += 1;
+  if (G_UNLIKELY (opaque_pass_stamp == 0))
+    opaque_pass_stamp = 1;
+
+  state.stage = CLUTTER_STAGE (self);
+  state.n_ordered = 0;
+  state.candidates = g_ptr_array_new ();
+  state.unordered_boxes = g_array_new (FALSE, FALSE, sizeof (ClutterActorBox));
+  state.unordered_everywhere = FALSE;
+
+  clutter_actor_order_for_opaque_pass (self, &state, TRUE);
+
+  cogl_get_projection_matrix (&opaque_pass_projection);
+  cogl_get_modelview_matrix (&stage_modelview);
+
+  /* the actor painted last is the one in front */
+  for (i = state.candidates->len - 1; i >= 0; i--)
+    clutter_actor_paint_opaque (g_ptr_array_index (state.candidates, i),
+                                &stage_modelview);
+
+  CLUTTER_NOTE (PAINT, "Opaque pass: %u actors ordered, %u opaque",
+                state.n_ordered,
+                state.candidates->len);
+
+  g_ptr_array_free (state.candidates, TRUE);
+  g_array_free (state.unordered_boxes, TRUE);
+
+  opaque_pass_set_order (self->priv->opaque_pass_order);
+  opaque_pass_active = TRUE;
+}
+
+/*< private >
+ * _clutter_actor_finish_opaque_pass:
+ * @self: a #ClutterStage
+ *
+ * Ends the paint started by _clutter_actor_paint_opaque_pass(), and
+ * restores the projection of the stage.
+ */
+void
+_clutter_actor_finish_opaque_pass (ClutterActor *self)
+{
+  g_return_if_fail (CLUTTER_IS_STAGE (self));
+
+  if (!opaque_pass_active)
+    return;
+
+  cogl_set_projection_matrix (&opaque_pass_projection);
+  opaque_pass_active = FALSE;
+}
+
+typedef enum
+{
+  OPAQUE_PASS_PAINT_NONE,       /* not painted to the stage in order */
+  OPAQUE_PASS_PAINT_SKIP,       /* already painted by the opaque pass */
+  OPAQUE_PASS_PAINT_ORDERED,    /* painted at the depth of its order */
+  OPAQUE_PASS_PAINT_UNORDERED   /* painted without the depth test */
+} OpaquePassPaint;
+
+/* sets up the paint of @self after the opaque pass; the result must
+ * be passed to clutter_actor_end_ordered_paint() */
+static OpaquePassPaint
+clutter_actor_begin_ordered_paint (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActor *stage;
+
+  if (!opaque_pass_active ||
+      opaque_pass_unordered_level > 0 ||
+      in_clone_paint ())
+    return OPAQUE_PASS_PAINT_NONE;
+
+  stage = _clutter_actor_get_stage_internal (self);
+  if (stage == NULL ||
+      cogl_get_draw_framebuffer () !=
+        _clutter_stage_get_active_framebuffer (CLUTTER_STAGE (stage)))
+    return OPAQUE_PASS_PAINT_NONE;
+
+  /* actors mapped after the pass, or that did not fit in the depth
+   * buffer, are painted like the unordered ones */
+  if (clutter_actor_is_ordered (self) && !priv->opaque_pass_unordered)
+    {
+      if (priv->opaque_pass_painted)
+        return OPAQUE_PASS_PAINT_SKIP;
+
+      opaque_pass_set_order (priv->opaque_pass_order);
+
+      return OPAQUE_PASS_PAINT_ORDERED;
+    }
+
+  opaque_pass_unordered_level += 1;
+  cogl_set_depth_test_enabled (FALSE);
+
+  return OPAQUE_PASS_PAINT_UNORDERED;
+}
+
+static void
+clutter_actor_end_ordered_paint (ClutterActor    *self,
+                                 OpaquePassPaint  paint)
+{
+  switch (paint)
+    {
+    case OPAQUE_PASS_PAINT_NONE:
+    case OPAQUE_PASS_PAINT_SKIP:
+      break;
+
+    case OPAQUE_PASS_PAINT_ORDERED:
+      /* whatever the parent paints after @self is in front of the
+       * descendants of @self */
+      opaque_pass_set_order (self->priv->opaque_pass_end_order);
+      break;
+
+    case OPAQUE_PASS_PAINT_UNORDERED:
+      g_assert (opaque_pass_unordered_level > 0);
+
+      opaque_pass_unordered_level -= 1;
+      if (opaque_pass_unordered_level == 0)
+        cogl_set_depth_test_enabled (TRUE);
+      break;
+    }
+}
+
+/**
  * clutter_actor_paint:
  * @self: A #ClutterActor
  *
@@ -2772,8 +5199,11 @@ add_or_remove_flatten_effect (ClutterActor *self)
 void
 clutter_actor_paint (ClutterActor *self)
 {
+  const ExtraInfo *extra;
   ClutterActorPrivate *priv;
   ClutterPickMode pick_mode;
+  ClutterGpuTiming *gpu_timing = NULL;
+  OpaquePassPaint ordered_paint = OPAQUE_PASS_PAINT_NONE;
   gboolean clip_set = FALSE;
   CLUTTER_STATIC_COUNTER (actor_paint_counter,
                           "Actor real-paint counter",
@@ -2803,6 +5233,10 @@ clutter_actor_paint (ClutterActor *self)
       ((priv->opacity_override >= 0) ?
        priv->opacity_override : priv->opacity) == 0)
     {
+      /* we are not going to update the box of the actor, and it can
+       * still be picked */
+      _clutter_stage_index_node_remove (&priv->index_node);
+
       priv->propagated_one_redraw = FALSE;
       return;
     }
@@ -2813,6 +5247,18 @@ clutter_actor_paint (ClutterActor *self)
   if (!CLUTTER_ACTOR_IS_MAPPED (self))
     return;
 
+  /* when painting a clone the boxes in the spatial index do not
+   * represent the location of the actors on the screen */
+  if (pick_mode != CLUTTER_PICK_NONE &&
+      !in_clone_paint () &&
+      clutter_actor_can_skip_pick (self,
+                                   _clutter_context_get_pick_index_stamp ()))
+    return;
+
+  if (pick_mode == CLUTTER_PICK_REACTIVE &&
+      clutter_actor_can_skip_reactive_pick (self))
+    return;
+
   /* mark that we are in the paint process */
   CLUTTER_SET_PRIVATE_FLAGS (self, CLUTTER_IN_PAINT);
 
@@ -2821,9 +5267,12 @@ clutter_actor_paint (ClutterActor *self)
   if (priv->enable_model_view_transform)
     {
       CoglMatrix matrix;
-      /* XXX: It could be better to cache the modelview with the actor
-       * instead of progressively building up the transformations on
-       * the matrix stack every time we paint. */
+      /* NB: we cannot use the cached stage-relative transformation
+       * here, since the parent might have modified the modelview
+       * before painting us, or we might be painting into an offscreen
+       * buffer or inside a clone; the cached transformation is used
+       * when culling and when updating the paint volume instead, so
+       * building up the matrix here only costs one multiplication. */
       cogl_get_modelview_matrix (&matrix);
       _clutter_actor_apply_modelview_transform (self, &matrix);
       cogl_set_modelview_matrix (&matrix);
@@ -2852,10 +5301,10 @@ clutter_actor_paint (ClutterActor *self)
     {
       CLUTTER_COUNTER_INC (_clutter_uprof_context, actor_paint_counter);
 
-      /* We check whether we need to add the flatten effect before
-         each paint so that we can avoid having a mechanism for
-         applications to notify when the value of the
-         has_overlaps virtual changes. */
+      /* The flatten effect is added or removed depending on the
+         offscreen-redirect property, the paint opacity and the
+         has_overlaps virtual; the result is cached until one of
+         them changes, see clutter_actor_notify_overlaps_changed() */
       add_or_remove_flatten_effect (self);
 
       /* We save the current paint volume so that the next time the
@@ -2870,9 +5319,9 @@ clutter_actor_paint (ClutterActor *self)
        * box represents the location of the source actor on the
        * screen.
        *
-       * XXX: We are starting to do a lot of vertex transforms on
-       * the CPU in a typical paint, so at some point we should
-       * audit these and consider caching some things.
+       * Transforming the paint volume uses the stage-relative
+       * transformation cached with the actor, which avoids walking
+       * up the hierarchy for each actor we paint.
        */
       if (!in_clone_paint ())
         {
@@ -2888,15 +5337,42 @@ clutter_actor_paint (ClutterActor *self)
                          CLUTTER_DEBUG_DISABLE_CLIPPED_REDRAWS)))
             _clutter_actor_update_last_paint_volume (self);
 
-          success = cull_actor (self, &result);
+          /* a display list is replayed whatever the clip of the
+           * stage is, so nothing is culled while recording one */
+          if (G_UNLIKELY (_clutter_display_list_is_recording ()))
+            success = FALSE;
+          else
+            success = cull_actor (self, &result);
 
           if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_REDRAWS))
             _clutter_actor_paint_cull_result (self, success, result);
           else if (result == CLUTTER_CULL_RESULT_OUT && success)
-            goto done;
+            {
+              n_culled_actors += 1;
+              goto done;
+            }
+          else if (success && clutter_actor_is_occluded (self))
+            {
+              n_culled_actors += 1;
+              goto done;
+            }
         }
 
-      if (priv->effects == NULL)
+      /* after the opaque pass of a stage sorting its paint by depth
+       * the actor is painted at the depth of its painting order */
+      ordered_paint = clutter_actor_begin_ordered_paint (self);
+      if (ordered_paint == OPAQUE_PASS_PAINT_SKIP)
+        goto done;
+
+      n_painted_actors += 1;
+
+      if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_OVERDRAW))
+        _clutter_actor_record_overdraw (self);
+
+      /* the flatten effect might have created the ExtraInfo */
+      extra = clutter_actor_get_extra_info_or_defaults (self);
+
+      if (extra->effects == NULL)
         {
           if (actor_has_shader_data (self))
             clutter_actor_shader_pre_paint (self, FALSE);
@@ -2904,16 +5380,36 @@ clutter_actor_paint (ClutterActor *self)
         }
       else
         priv->next_effect_to_paint =
-          _clutter_meta_group_peek_metas (priv->effects);
+          _clutter_meta_group_peek_metas (extra->effects);
 
-      clutter_actor_continue_paint (self);
+      /* only the actors with a name are timed, to keep the report
+       * readable; the others are accounted to their parents */
+      if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_GPU_TIMINGS) &&
+          extra->name != NULL)
+        gpu_timing = _clutter_gpu_timing_begin (G_OBJECT_TYPE (self),
+                                                extra->name,
+                                                G_TYPE_INVALID);
+
+      if (extra->subtree_cache_size > 0)
+        {
+          subtree_cache_paint_level += 1;
+          clutter_actor_continue_paint (self);
+          subtree_cache_paint_level -= 1;
+        }
+      else
+        clutter_actor_paint_retained (self);
+
+      if (G_UNLIKELY (gpu_timing != NULL))
+        _clutter_gpu_timing_end (gpu_timing);
 
-      if (priv->effects == NULL &&
+      if (extra->effects == NULL &&
           actor_has_shader_data (self))
         clutter_actor_shader_post_paint (self);
 
       if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_PAINT_VOLUMES))
         _clutter_actor_draw_paint_volume (self);
+
+      clutter_actor_end_ordered_paint (self, ordered_paint);
     }
   else
     {
@@ -2975,12 +5471,26 @@ clutter_actor_continue_paint (ClutterActor *self)
     {
       priv->propagated_one_redraw = FALSE;
 
-      g_signal_emit (self, actor_signals[PAINT], 0);
+      /* Leaf actors usually draw a single quad, which Cogl adds to
+       * the batch of the current material in its journal; when
+       * painting thousands of them the cost of emitting ::paint
+       * becomes noticeable, so we call the class handler directly
+       * unless somebody is connected to the signal */
+      if (g_signal_has_handler_pending (self, actor_signals[PAINT], 0, TRUE))
+        g_signal_emit (self, actor_signals[PAINT], 0);
+      else
+        {
+          ClutterActorClass *klass = CLUTTER_ACTOR_GET_CLASS (self);
+
+          if (klass->paint != NULL)
+            klass->paint (self);
+        }
     }
   else
     {
       ClutterEffect *old_current_effect;
       ClutterEffectRunFlags run_flags = 0;
+      guint n_fused;
 
       /* Cache the current effect so that we can put it back before
          returning */
@@ -2989,6 +5499,14 @@ clutter_actor_continue_paint (ClutterActor *self)
       priv->current_effect = priv->next_effect_to_paint->data;
       priv->next_effect_to_paint = priv->next_effect_to_paint->next;
 
+      /* the color effects following the current one are applied in
+       * its own offscreen pass, so they must not be run again */
+      n_fused =
+        _clutter_offscreen_effect_fuse_color_stages (priv->current_effect,
+                                                     priv->next_effect_to_paint);
+      while (n_fused-- > 0)
+        priv->next_effect_to_paint = priv->next_effect_to_paint->next;
+
       if (priv->propagated_one_redraw)
         {
           /* If there's an effect queued with this redraw then all
@@ -3001,7 +5519,21 @@ clutter_actor_continue_paint (ClutterActor *self)
             run_flags |= CLUTTER_EFFECT_RUN_ACTOR_DIRTY;
         }
 
-      _clutter_effect_run (priv->current_effect, run_flags);
+      if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_GPU_TIMINGS))
+        {
+          ClutterGpuTiming *gpu_timing;
+
+          gpu_timing =
+            _clutter_gpu_timing_begin (G_OBJECT_TYPE (self),
+                                       clutter_actor_get_name (self),
+                                       G_OBJECT_TYPE (priv->current_effect));
+
+          _clutter_effect_run (priv->current_effect, run_flags);
+
+          _clutter_gpu_timing_end (gpu_timing);
+        }
+      else
+        _clutter_effect_run (priv->current_effect, run_flags);
 
       priv->current_effect = old_current_effect;
     }
@@ -3015,26 +5547,28 @@ clutter_actor_set_rotation_internal (ClutterActor      *self,
                                      ClutterRotateAxis  axis,
                                      gdouble            angle)
 {
-  ClutterActorPrivate *priv = self->priv;
+  TransformInfo *info;
+
+  info = clutter_actor_get_transform_info (self);
 
   g_object_freeze_notify (G_OBJECT (self));
 
-  priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
 
   switch (axis)
     {
     case CLUTTER_X_AXIS:
-      priv->rxang = angle;
+      info->rxang = angle;
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_ROTATION_ANGLE_X]);
       break;
 
     case CLUTTER_Y_AXIS:
-      priv->ryang = angle;
+      info->ryang = angle;
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_ROTATION_ANGLE_Y]);
       break;
 
     case CLUTTER_Z_AXIS:
-      priv->rzang = angle;
+      info->rzang = angle;
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_ROTATION_ANGLE_Z]);
       break;
     }
@@ -3050,9 +5584,12 @@ clutter_actor_set_property (GObject      *object,
 			    const GValue *value,
 			    GParamSpec   *pspec)
 {
+  const TransformInfo *info;
   ClutterActor *actor = CLUTTER_ACTOR (object);
   ClutterActorPrivate *priv = actor->priv;
 
+  info = clutter_actor_get_transform_info_or_defaults (actor);
+
   switch (prop_id)
     {
     case PROP_X:
@@ -3123,6 +5660,18 @@ clutter_actor_set_property (GObject      *object,
       clutter_actor_set_depth (actor, g_value_get_float (value));
       break;
 
+    case PROP_TRANSLATION_X:
+      clutter_actor_set_translation (actor,
+                                     g_value_get_float (value),
+                                     priv->translation_y);
+      break;
+
+    case PROP_TRANSLATION_Y:
+      clutter_actor_set_translation (actor,
+                                     priv->translation_x,
+                                     g_value_get_float (value));
+      break;
+
     case PROP_OPACITY:
       clutter_actor_set_opacity (actor, g_value_get_uint (value));
       break;
@@ -3145,12 +5694,12 @@ clutter_actor_set_property (GObject      *object,
     case PROP_SCALE_X:
       clutter_actor_set_scale (actor,
                                g_value_get_double (value),
-                               priv->scale_y);
+                               info->scale_y);
       break;
 
     case PROP_SCALE_Y:
       clutter_actor_set_scale (actor,
-                               priv->scale_x,
+                               info->scale_x,
                                g_value_get_double (value));
       break;
 
@@ -3159,13 +5708,13 @@ clutter_actor_set_property (GObject      *object,
 	gfloat center_x = g_value_get_float (value);
         gfloat center_y;
 
-        clutter_anchor_coord_get_units (actor, &priv->scale_center,
+        clutter_anchor_coord_get_units (actor, &info->scale_center,
                                         NULL,
                                         &center_y,
                                         NULL);
 	clutter_actor_set_scale_full (actor,
-                                      priv->scale_x,
-                                      priv->scale_y,
+                                      info->scale_x,
+                                      info->scale_y,
                                       center_x,
                                       center_y);
       }
@@ -3176,13 +5725,13 @@ clutter_actor_set_property (GObject      *object,
         gfloat center_y = g_value_get_float (value);
 	gfloat center_x;
 
-        clutter_anchor_coord_get_units (actor, &priv->scale_center,
+        clutter_anchor_coord_get_units (actor, &info->scale_center,
                                         &center_x,
                                         NULL,
                                         NULL);
 	clutter_actor_set_scale_full (actor,
-                                      priv->scale_x,
-                                      priv->scale_y,
+                                      info->scale_x,
+                                      info->scale_y,
                                       center_x,
                                       center_y);
       }
@@ -3190,8 +5739,8 @@ clutter_actor_set_property (GObject      *object,
 
     case PROP_SCALE_GRAVITY:
       clutter_actor_set_scale_with_gravity (actor,
-                                            priv->scale_x,
-                                            priv->scale_y,
+                                            info->scale_x,
+                                            info->scale_y,
                                             g_value_get_enum (value));
       break;
 
@@ -3238,7 +5787,7 @@ clutter_actor_set_property (GObject      *object,
         if ((center = g_value_get_boxed (value)))
           clutter_actor_set_rotation (actor,
                                       CLUTTER_X_AXIS,
-                                      priv->rxang,
+                                      info->rxang,
                                       center->x,
                                       center->y,
                                       center->z);
@@ -3252,7 +5801,7 @@ clutter_actor_set_property (GObject      *object,
         if ((center = g_value_get_boxed (value)))
           clutter_actor_set_rotation (actor,
                                       CLUTTER_Y_AXIS,
-                                      priv->ryang,
+                                      info->ryang,
                                       center->x,
                                       center->y,
                                       center->z);
@@ -3266,7 +5815,7 @@ clutter_actor_set_property (GObject      *object,
         if ((center = g_value_get_boxed (value)))
           clutter_actor_set_rotation (actor,
                                       CLUTTER_Z_AXIS,
-                                      priv->rzang,
+                                      info->rzang,
                                       center->x,
                                       center->y,
                                       center->z);
@@ -3274,7 +5823,7 @@ clutter_actor_set_property (GObject      *object,
       break;
 
     case PROP_ROTATION_CENTER_Z_GRAVITY:
-      clutter_actor_set_z_rotation_from_gravity (actor, priv->rzang,
+      clutter_actor_set_z_rotation_from_gravity (actor, info->rzang,
                                                  g_value_get_enum (value));
       break;
 
@@ -3283,7 +5832,7 @@ clutter_actor_set_property (GObject      *object,
         gfloat anchor_x = g_value_get_float (value);
         gfloat anchor_y;
 
-        clutter_anchor_coord_get_units (actor, &priv->anchor,
+        clutter_anchor_coord_get_units (actor, &info->anchor,
                                         NULL,
                                         &anchor_y,
                                         NULL);
@@ -3296,7 +5845,7 @@ clutter_actor_set_property (GObject      *object,
         gfloat anchor_y = g_value_get_float (value);
         gfloat anchor_x;
 
-        clutter_anchor_coord_get_units (actor, &priv->anchor,
+        clutter_anchor_coord_get_units (actor, &info->anchor,
                                         &anchor_x,
                                         NULL,
                                         NULL);
@@ -3341,9 +5890,14 @@ clutter_actor_get_property (GObject    *object,
 			    GValue     *value,
 			    GParamSpec *pspec)
 {
+  const ExtraInfo *extra;
+  const TransformInfo *info;
   ClutterActor *actor = CLUTTER_ACTOR (object);
   ClutterActorPrivate *priv = actor->priv;
 
+  extra = clutter_actor_get_extra_info_or_defaults (actor);
+  info = clutter_actor_get_transform_info_or_defaults (actor);
+
   switch (prop_id)
     {
     case PROP_X:
@@ -3418,16 +5972,24 @@ clutter_actor_get_property (GObject    *object,
       g_value_set_float (value, clutter_actor_get_depth (actor));
       break;
 
+    case PROP_TRANSLATION_X:
+      g_value_set_float (value, priv->translation_x);
+      break;
+
+    case PROP_TRANSLATION_Y:
+      g_value_set_float (value, priv->translation_y);
+      break;
+
     case PROP_OPACITY:
       g_value_set_uint (value, priv->opacity);
       break;
 
     case PROP_OFFSCREEN_REDIRECT:
-      g_value_set_enum (value, priv->offscreen_redirect);
+      g_value_set_enum (value, extra->offscreen_redirect);
       break;
 
     case PROP_NAME:
-      g_value_set_string (value, priv->name);
+      g_value_set_string (value, extra->name);
       break;
 
     case PROP_VISIBLE:
@@ -3464,11 +6026,11 @@ clutter_actor_get_property (GObject    *object,
       break;
 
     case PROP_SCALE_X:
-      g_value_set_double (value, priv->scale_x);
+      g_value_set_double (value, info->scale_x);
       break;
 
     case PROP_SCALE_Y:
-      g_value_set_double (value, priv->scale_y);
+      g_value_set_double (value, info->scale_y);
       break;
 
     case PROP_SCALE_CENTER_X:
@@ -3500,15 +6062,15 @@ clutter_actor_get_property (GObject    *object,
       break;
 
     case PROP_ROTATION_ANGLE_X:
-      g_value_set_double (value, priv->rxang);
+      g_value_set_double (value, info->rxang);
       break;
 
     case PROP_ROTATION_ANGLE_Y:
-      g_value_set_double (value, priv->ryang);
+      g_value_set_double (value, info->ryang);
       break;
 
     case PROP_ROTATION_ANGLE_Z:
-      g_value_set_double (value, priv->rzang);
+      g_value_set_double (value, info->rzang);
       break;
 
     case PROP_ROTATION_CENTER_X:
@@ -3558,7 +6120,7 @@ clutter_actor_get_property (GObject    *object,
       {
         gfloat anchor_x;
 
-        clutter_anchor_coord_get_units (actor, &priv->anchor,
+        clutter_anchor_coord_get_units (actor, &info->anchor,
                                         &anchor_x,
                                         NULL,
                                         NULL);
@@ -3570,7 +6132,7 @@ clutter_actor_get_property (GObject    *object,
       {
         gfloat anchor_y;
 
-        clutter_anchor_coord_get_units (actor, &priv->anchor,
+        clutter_anchor_coord_get_units (actor, &info->anchor,
                                         NULL,
                                         &anchor_y,
                                         NULL);
@@ -3587,7 +6149,7 @@ clutter_actor_get_property (GObject    *object,
       break;
 
     case PROP_TEXT_DIRECTION:
-      g_value_set_enum (value, priv->text_direction);
+      g_value_set_enum (value, extra->text_direction);
       break;
 
     case PROP_HAS_POINTER:
@@ -3600,6 +6162,27 @@ clutter_actor_get_property (GObject    *object,
     }
 }
 
+/* removes @self from its parent, going through the Container
+ * implementation unless @self is an internal child and has been
+ * marked as such
+ */
+static void
+clutter_actor_detach_from_parent (ClutterActor *self)
+{
+  ClutterActor *parent = self->priv->parent_actor;
+
+  if (parent == NULL)
+    return;
+
+  if (CLUTTER_IS_CONTAINER (parent) &&
+      !CLUTTER_ACTOR_IS_INTERNAL_CHILD (self))
+    {
+      clutter_container_remove_actor (CLUTTER_CONTAINER (parent), self);
+    }
+  else
+    clutter_actor_unparent (self);
+}
+
 static void
 clutter_actor_dispose (GObject *object)
 {
@@ -3612,21 +6195,7 @@ clutter_actor_dispose (GObject *object)
                 object->ref_count);
 
   /* avoid recursing when called from clutter_actor_destroy() */
-  if (priv->parent_actor != NULL)
-    {
-      ClutterActor *parent = priv->parent_actor;
-
-      /* go through the Container implementation unless this
-       * is an internal child and has been marked as such
-       */
-      if (CLUTTER_IS_CONTAINER (parent) &&
-          !CLUTTER_ACTOR_IS_INTERNAL_CHILD (self))
-        {
-          clutter_container_remove_actor (CLUTTER_CONTAINER (parent), self);
-        }
-      else
-        clutter_actor_unparent (self);
-    }
+  clutter_actor_detach_from_parent (self);
 
   /* parent should be gone */
   g_assert (priv->parent_actor == NULL);
@@ -3638,34 +6207,48 @@ clutter_actor_dispose (GObject *object)
       g_assert (!CLUTTER_ACTOR_IS_REALIZED (self));
     }
 
-  if (priv->pango_context)
+  if (priv->extra_info != NULL)
     {
-      g_object_unref (priv->pango_context);
-      priv->pango_context = NULL;
-    }
+      ExtraInfo *extra = priv->extra_info;
 
-  if (priv->actions != NULL)
-    {
-      g_object_unref (priv->actions);
-      priv->actions = NULL;
-    }
+      if (extra->pango_context)
+        {
+          g_object_unref (extra->pango_context);
+          extra->pango_context = NULL;
+        }
 
-  if (priv->constraints != NULL)
-    {
-      g_object_unref (priv->constraints);
-      priv->constraints = NULL;
-    }
+      if (extra->actions != NULL)
+        {
+          g_object_unref (extra->actions);
+          extra->actions = NULL;
+        }
 
-  if (priv->effects != NULL)
-    {
-      g_object_unref (priv->effects);
-      priv->effects = NULL;
-    }
+      if (extra->constraints != NULL)
+        {
+          g_object_unref (extra->constraints);
+          extra->constraints = NULL;
+        }
 
-  if (priv->flatten_effect != NULL)
-    {
-      g_object_unref (priv->flatten_effect);
-      priv->flatten_effect = NULL;
+      if (extra->effects != NULL)
+        {
+          g_object_unref (extra->effects);
+          extra->effects = NULL;
+        }
+
+      if (extra->flatten_effect != NULL)
+        {
+          subtree_cache_total -= extra->subtree_cache_size;
+          extra->subtree_cache_size = 0;
+
+          g_object_unref (extra->flatten_effect);
+          extra->flatten_effect = NULL;
+        }
+
+      if (extra->display_list != NULL)
+        {
+          _clutter_display_list_free (extra->display_list);
+          extra->display_list = NULL;
+        }
     }
 
   g_signal_emit (self, actor_signals[DESTROY], 0);
@@ -3679,13 +6262,31 @@ clutter_actor_finalize (GObject *object)
   ClutterActorPrivate *priv = CLUTTER_ACTOR (object)->priv;
 
   CLUTTER_NOTE (MISC, "Finalize actor (name='%s', id=%d) of type '%s'",
-                priv->name != NULL ? priv->name : "<none>",
+                _clutter_actor_get_debug_name (CLUTTER_ACTOR (object)),
 		priv->id,
 		g_type_name (G_OBJECT_TYPE (object)));
 
   _clutter_context_release_id (priv->id);
 
-  g_free (priv->name);
+  _clutter_stage_index_node_remove (&priv->index_node);
+
+  if (priv->extra_info != NULL)
+    {
+      g_free (priv->extra_info->name);
+      g_slice_free (ExtraInfo, priv->extra_info);
+    }
+
+  if (priv->transform_info != NULL)
+    g_slice_free (TransformInfo, priv->transform_info);
+
+  /* the height requests share the same allocation */
+  g_free (priv->width_requests);
+
+  if (priv->child_meta != NULL)
+    g_object_unref (priv->child_meta);
+
+  if (priv->layout_meta != NULL)
+    g_object_unref (priv->layout_meta);
 
   G_OBJECT_CLASS (clutter_actor_parent_class)->finalize (object);
 }
@@ -3760,6 +6361,14 @@ clutter_actor_real_has_overlaps (ClutterActor *self)
   return TRUE;
 }
 
+static gboolean
+clutter_actor_real_is_opaque (ClutterActor *self)
+{
+  /* We don't know what sub-classes paint, so we can't assume that
+     they hide what is below them. */
+  return FALSE;
+}
+
 static void
 clutter_actor_class_init (ClutterActorClass *klass)
 {
@@ -4136,6 +6745,48 @@ clutter_actor_class_init (ClutterActorClass *klass)
   obj_props[PROP_DEPTH] = pspec;
   g_object_class_install_property (object_class, PROP_DEPTH, pspec);
 
+  /**
+   * ClutterActor:translation-x:
+   *
+   * The translation of the actor on the X axis, applied when painting
+   * on top of its allocation.
+   *
+   * Unlike #ClutterActor:x, changing this property does not queue a
+   * relayout, which makes it suitable for animating the movement of
+   * actors inside a #ClutterLayoutManager
+   *
+   * Since: 1.8
+   */
+  pspec = g_param_spec_float ("translation-x",
+                              P_("Translation X"),
+                              P_("Translation on the X axis"),
+                              -G_MAXFLOAT, G_MAXFLOAT,
+                              0.0,
+                              CLUTTER_PARAM_READWRITE);
+  obj_props[PROP_TRANSLATION_X] = pspec;
+  g_object_class_install_property (object_class, PROP_TRANSLATION_X, pspec);
+
+  /**
+   * ClutterActor:translation-y:
+   *
+   * The translation of the actor on the Y axis, applied when painting
+   * on top of its allocation.
+   *
+   * Unlike #ClutterActor:y, changing this property does not queue a
+   * relayout, which makes it suitable for animating the movement of
+   * actors inside a #ClutterLayoutManager
+   *
+   * Since: 1.8
+   */
+  pspec = g_param_spec_float ("translation-y",
+                              P_("Translation Y"),
+                              P_("Translation on the Y axis"),
+                              -G_MAXFLOAT, G_MAXFLOAT,
+                              0.0,
+                              CLUTTER_PARAM_READWRITE);
+  obj_props[PROP_TRANSLATION_Y] = pspec;
+  g_object_class_install_property (object_class, PROP_TRANSLATION_Y, pspec);
+
   /**
    * ClutterActor:opacity:
    *
@@ -5188,6 +7839,41 @@ clutter_actor_class_init (ClutterActorClass *klass)
                   CLUTTER_TYPE_ACTOR_BOX,
                   CLUTTER_TYPE_ALLOCATION_FLAGS);
 
+  /**
+   * ClutterActor::geometry-changed:
+   * @actor: the #ClutterActor that emitted the signal
+   * @old_box: a #ClutterActorBox with the allocation of @actor before
+   *   the first change since the last emission
+   * @new_box: a #ClutterActorBox with the current allocation of @actor
+   *
+   * The ::geometry-changed signal is emitted at the end of a relayout
+   * cycle, once for each actor whose allocation changed during it.
+   * Unlike the notifications for the :allocation property and the
+   * #ClutterActor::allocation-changed signal, which are emitted every
+   * time the allocation is set, this signal coalesces all the changes
+   * happened during a frame, and it is only tracked for the actors that
+   * have a handler connected to it.
+   *
+   * Since: 1.8
+   */
+  actor_signals[GEOMETRY_CHANGED] =
+    g_signal_new (I_("geometry-changed"),
+                  G_TYPE_FROM_CLASS (object_class),
+                  G_SIGNAL_RUN_LAST,
+                  0,
+                  NULL, NULL,
+                  _clutter_marshal_VOID__BOXED_BOXED,
+                  G_TYPE_NONE, 2,
+                  CLUTTER_TYPE_ACTOR_BOX | G_SIGNAL_TYPE_STATIC_SCOPE,
+                  CLUTTER_TYPE_ACTOR_BOX | G_SIGNAL_TYPE_STATIC_SCOPE);
+
+  notify_signal_id = g_signal_lookup ("notify", G_TYPE_OBJECT);
+  quark_notify_x = g_quark_from_static_string ("x");
+  quark_notify_y = g_quark_from_static_string ("y");
+  quark_notify_width = g_quark_from_static_string ("width");
+  quark_notify_height = g_quark_from_static_string ("height");
+  quark_notify_allocation = g_quark_from_static_string ("allocation");
+
   klass->show = clutter_actor_real_show;
   klass->show_all = clutter_actor_show;
   klass->hide = clutter_actor_real_hide;
@@ -5205,6 +7891,10 @@ clutter_actor_class_init (ClutterActorClass *klass)
   klass->get_accessible = clutter_actor_real_get_accessible;
   klass->get_paint_volume = clutter_actor_real_get_paint_volume;
   klass->has_overlaps = clutter_actor_real_has_overlaps;
+  klass->is_opaque = clutter_actor_real_is_opaque;
+
+  /* the default pick implementation paints the allocation */
+  _clutter_actor_class_register_geometric_pick (klass, FALSE, NULL, NULL);
 }
 
 static void
@@ -5217,11 +7907,8 @@ clutter_actor_init (ClutterActor *self)
   priv->parent_actor = NULL;
   priv->has_clip = FALSE;
   priv->opacity = 0xff;
-  priv->offscreen_redirect = CLUTTER_OFFSCREEN_REDIRECT_AUTOMATIC_FOR_OPACITY;
   priv->id = _clutter_context_acquire_id (self);
   priv->pick_id = -1;
-  priv->scale_x = 1.0;
-  priv->scale_y = 1.0;
   priv->show_on_set_parent = TRUE;
 
   priv->needs_width_request = TRUE;
@@ -5239,10 +7926,45 @@ clutter_actor_init (ClutterActor *self)
   priv->last_paint_volume_valid = TRUE;
 
   priv->transform_valid = FALSE;
+  priv->stage_transform_valid = FALSE;
+
+  priv->frames_since_move = G_MAXUINT8;
 
   memset (priv->clip, 0, sizeof (gfloat) * 4);
 }
 
+/* whether @self is being removed as part of the destruction of one
+ * of its ancestors; the children of a stage are dissociated from it
+ * when they are destroyed, so they are not part of a teardown
+ */
+static inline gboolean
+clutter_actor_parent_in_teardown (ClutterActor *self)
+{
+  ClutterActor *parent = self->priv->parent_actor;
+
+  return parent != NULL &&
+         CLUTTER_ACTOR_IN_DESTRUCTION (parent) &&
+         !CLUTTER_ACTOR_IS_TOPLEVEL (parent);
+}
+
+static ClutterActorTraverseVisitFlags
+invalidate_queue_redraw_entry (ClutterActor *self,
+                               int           depth,
+                               gpointer      user_data)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  if (priv->queue_redraw_entry != NULL)
+    {
+      _clutter_stage_queue_redraw_entry_invalidate (priv->queue_redraw_entry);
+      priv->queue_redraw_entry = NULL;
+    }
+
+  _clutter_stage_index_node_remove (&priv->index_node);
+
+  return CLUTTER_ACTOR_TRAVERSE_VISIT_CONTINUE;
+}
+
 /**
  * clutter_actor_destroy:
  * @self: a #ClutterActor
@@ -5272,7 +7994,20 @@ clutter_actor_destroy (ClutterActor *self)
        * first before the dispose run removes the parent
        */
       if (!CLUTTER_ACTOR_IS_TOPLEVEL (self))
-        clutter_actor_update_map_state (self, MAP_STATE_MAKE_UNREALIZED);
+        {
+          clutter_actor_update_map_state (self, MAP_STATE_MAKE_UNREALIZED);
+
+          /* the root of a destroyed tree dissociates the whole tree
+           * from the stage at once, so that the descendants can skip
+           * it when they are unparented from their dying parent
+           */
+          if (!clutter_actor_parent_in_teardown (self))
+            _clutter_actor_traverse (self,
+                                     0,
+                                     invalidate_queue_redraw_entry,
+                                     NULL,
+                                     NULL);
+        }
 
       g_object_run_dispose (G_OBJECT (self));
 
@@ -5282,6 +8017,133 @@ clutter_actor_destroy (ClutterActor *self)
   g_object_unref (self);
 }
 
+#define DEFERRED_DESTROY_ACTORS_PER_IDLE        64
+
+/* the actors being destroyed by clutter_actor_destroy_deferred() */
+static GQueue deferred_destroy_queue = G_QUEUE_INIT;
+static guint deferred_destroy_id = 0;
+
+static void
+on_deferred_destroy (ClutterActor *self)
+{
+  if (g_queue_remove (&deferred_destroy_queue, self))
+    g_object_unref (self);
+}
+
+/* finds the first descendant of @self without children that can be
+ * destroyed on its own; internal children are left to their owner
+ */
+static ClutterActor *
+clutter_actor_get_deferred_leaf (ClutterActor *self)
+{
+  ClutterActor *iter = self;
+
+  while (CLUTTER_IS_CONTAINER (iter))
+    {
+      ClutterActor *child = NULL;
+      GList *l;
+
+      for (l = iter->priv->children; l != NULL; l = l->next)
+        {
+          if (!CLUTTER_ACTOR_IS_INTERNAL_CHILD (l->data))
+            {
+              child = l->data;
+              break;
+            }
+        }
+
+      if (child == NULL)
+        break;
+
+      iter = child;
+    }
+
+  return iter;
+}
+
+static gboolean
+clutter_actor_deferred_destroy_idle (gpointer data)
+{
+  guint n_destroyed = 0;
+
+  while (n_destroyed < DEFERRED_DESTROY_ACTORS_PER_IDLE &&
+         !g_queue_is_empty (&deferred_destroy_queue))
+    {
+      ClutterActor *root = g_queue_peek_head (&deferred_destroy_queue);
+      ClutterActor *leaf;
+
+      /* destroying from the leaves keeps each step cheap, since it
+       * only ever removes a single actor
+       */
+      leaf = g_object_ref (clutter_actor_get_deferred_leaf (root));
+
+      clutter_actor_destroy (leaf);
+
+      /* a container that keeps its destroyed children would make
+       * us loop forever, so we just destroy the rest at once
+       */
+      if (leaf != root && leaf->priv->parent_actor != NULL)
+        clutter_actor_destroy (root);
+
+      g_object_unref (leaf);
+
+      n_destroyed += 1;
+    }
+
+  if (g_queue_is_empty (&deferred_destroy_queue))
+    {
+      deferred_destroy_id = 0;
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/**
+ * clutter_actor_destroy_deferred:
+ * @self: a #ClutterActor
+ *
+ * Removes @self from its parent immediately and then destroys it,
+ * along with all its children, a few actors at a time when the main
+ * loop is idle, starting from the leaves.
+ *
+ * This function is useful to tear down large trees of actors without
+ * stalling the frame in which they are removed. The #ClutterActor::destroy
+ * signal is emitted on @self only once all its children have been
+ * destroyed; you should not use @self after calling this function.
+ *
+ * Since: 1.8
+ */
+void
+clutter_actor_destroy_deferred (ClutterActor *self)
+{
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (self) ||
+      g_queue_find (&deferred_destroy_queue, self) != NULL)
+    return;
+
+  /* there is nothing to spread over multiple iterations */
+  if (CLUTTER_ACTOR_IS_TOPLEVEL (self) || self->priv->children == NULL)
+    {
+      clutter_actor_destroy (self);
+      return;
+    }
+
+  /* the queue holds a reference until the actor is destroyed, since
+   * removing it from its parent may drop the last one
+   */
+  g_object_ref (self);
+  g_queue_push_tail (&deferred_destroy_queue, self);
+  g_signal_connect (self, "destroy", G_CALLBACK (on_deferred_destroy), NULL);
+
+  clutter_actor_detach_from_parent (self);
+
+  if (deferred_destroy_id == 0)
+    deferred_destroy_id =
+      clutter_threads_add_idle (clutter_actor_deferred_destroy_idle, NULL);
+}
+
 void
 _clutter_actor_finish_queue_redraw (ClutterActor *self,
                                     ClutterPaintVolume *clip)
@@ -5351,6 +8213,18 @@ _clutter_actor_finish_queue_redraw (ClutterActor *self,
     _clutter_actor_set_queue_redraw_clip (self, NULL);
 
   priv->queue_redraw_entry = NULL;
+
+  /* the redraw covered the whole actor, so the redraws queued again
+   * on it by its dependents until the stage is painted are redundant
+   */
+  if (clip == NULL)
+    {
+      ClutterActor *stage = _clutter_actor_get_stage_internal (self);
+
+      if (stage != NULL)
+        priv->propagated_redraw_stamp =
+          _clutter_stage_get_queue_redraw_stamp (CLUTTER_STAGE (stage));
+    }
 }
 
 static void
@@ -5379,6 +8253,81 @@ _clutter_actor_get_allocation_clip (ClutterActor *self,
   clip->y2 = allocation.y2 - allocation.y1;
 }
 
+/* the address the current function will return to, which identifies
+ * the code that queued a redraw or a relayout */
+#ifdef __GNUC__
+#define CLUTTER_CALLER_ADDRESS()        __builtin_return_address (0)
+#else
+#define CLUTTER_CALLER_ADDRESS()        NULL
+#endif
+
+static void
+clutter_actor_add_redraw_cause (ClutterActor *self,
+                                gpointer      caller,
+                                gboolean      relayout)
+{
+  ClutterActor *stage;
+
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (self))
+    return;
+
+  stage = _clutter_actor_get_stage_internal (self);
+  if (stage == NULL)
+    return;
+
+  _clutter_stage_add_redraw_cause (CLUTTER_STAGE (stage),
+                                   self,
+                                   caller,
+                                   relayout);
+}
+
+static void
+clutter_actor_merge_effect_to_redraw (ClutterActor  *self,
+                                      gboolean       was_dirty,
+                                      ClutterEffect *effect)
+{
+  ClutterActorPrivate *priv = self->priv;
+  const ExtraInfo *extra;
+
+  /* If this is the first redraw queued then we can directly use the
+     effect parameter */
+  if (!was_dirty)
+    priv->effect_to_redraw = effect;
+  /* Otherwise we need to merge it with the existing effect parameter */
+  else if (effect)
+    {
+      /* If there's already an effect then we need to use whichever is
+         later in the chain of actors. Otherwise a full redraw has
+         already been queued on the actor so we need to ignore the
+         effect parameter */
+      if (priv->effect_to_redraw)
+        {
+          extra = clutter_actor_get_extra_info_or_defaults (self);
+
+          if (extra->effects == NULL)
+            g_warning ("Redraw queued with an effect that is "
+                       "not applied to the actor");
+          else
+            {
+              const GList *l;
+
+              for (l = _clutter_meta_group_peek_metas (extra->effects);
+                   l != NULL;
+                   l = l->next)
+                {
+                  if (l->data == priv->effect_to_redraw ||
+                      l->data == effect)
+                    priv->effect_to_redraw = l->data;
+                }
+            }
+        }
+    }
+  else
+    /* If no effect is specified then we need to redraw the whole
+       actor */
+    priv->effect_to_redraw = NULL;
+}
+
 void
 _clutter_actor_queue_redraw_full (ClutterActor       *self,
                                   ClutterRedrawFlags  flags,
@@ -5396,6 +8345,16 @@ _clutter_actor_queue_redraw_full (ClutterActor       *self,
 
   priv = self->priv;
 
+  /* while updating multiple properties at once, a full redraw is
+   * only queued once, at the end of the update
+   */
+  if (priv->update_depth > 0 &&
+      flags == 0 && volume == NULL && effect == NULL)
+    {
+      priv->update_needs_redraw = TRUE;
+      return;
+    }
+
   /* Here's an outline of the actor queue redraw mechanism:
    *
    * The process starts in one of the following two functions which
@@ -5452,6 +8411,8 @@ _clutter_actor_queue_redraw_full (ClutterActor       *self,
    * process (considering clone actors or texture_new_from_actor which
    * respond to their source queueing a redraw by queuing a redraw
    * themselves). We repeat the process until the list is empty.
+   * Once an actor has propagated an unclipped redraw, the redraws
+   * queued on it again before the list is empty are dropped.
    *
    * This will result in the "queue-redraw" signal being fired for
    * each actor which will pass control to the default signal handler:
@@ -5471,6 +8432,26 @@ _clutter_actor_queue_redraw_full (ClutterActor       *self,
   if (stage == NULL)
     return;
 
+  /* Dependents of the actor, like clones of it or textures created
+   * from it, queue a redraw on themselves each time the actor emits
+   * the queue-redraw signal, which can happen many times while the
+   * stage finishes the queued redraws. Once an unclipped redraw of
+   * the actor has been propagated it covers any further redraw, so
+   * the actor and its dependents are only processed once per frame.
+   */
+  if (priv->propagated_redraw_stamp != 0 &&
+      priv->queue_redraw_entry == NULL &&
+      priv->propagated_redraw_stamp ==
+        _clutter_stage_get_queue_redraw_stamp (CLUTTER_STAGE (stage)))
+    {
+      CLUTTER_NOTE (CLIPPING, "Bail from queue_redraw (%s): "
+                    "unclipped redraw already propagated",
+                    _clutter_actor_get_debug_name (self));
+
+      clutter_actor_merge_effect_to_redraw (self, TRUE, effect);
+      return;
+    }
+
   if (flags & CLUTTER_REDRAW_CLIPPED_TO_ALLOCATION)
     {
       ClutterActorBox allocation_clip;
@@ -5520,41 +8501,7 @@ _clutter_actor_queue_redraw_full (ClutterActor       *self,
   if (should_free_pv)
     clutter_paint_volume_free (pv);
 
-  /* If this is the first redraw queued then we can directly use the
-     effect parameter */
-  if (!was_dirty)
-    priv->effect_to_redraw = effect;
-  /* Otherwise we need to merge it with the existing effect parameter */
-  else if (effect)
-    {
-      /* If there's already an effect then we need to use whichever is
-         later in the chain of actors. Otherwise a full redraw has
-         already been queued on the actor so we need to ignore the
-         effect parameter */
-      if (priv->effect_to_redraw)
-        {
-          if (priv->effects == NULL)
-            g_warning ("Redraw queued with an effect that is "
-                       "not applied to the actor");
-          else
-            {
-              const GList *l;
-
-              for (l = _clutter_meta_group_peek_metas (priv->effects);
-                   l != NULL;
-                   l = l->next)
-                {
-                  if (l->data == priv->effect_to_redraw ||
-                      l->data == effect)
-                    priv->effect_to_redraw = l->data;
-                }
-            }
-        }
-    }
-  else
-    /* If no effect is specified then we need to redraw the whole
-       actor */
-    priv->effect_to_redraw = NULL;
+  clutter_actor_merge_effect_to_redraw (self, was_dirty, effect);
 }
 
 /**
@@ -5581,6 +8528,9 @@ _clutter_actor_queue_redraw_full (ClutterActor       *self,
 void
 clutter_actor_queue_redraw (ClutterActor *self)
 {
+  if (G_UNLIKELY (_clutter_stage_tracks_redraw_causes ()))
+    clutter_actor_add_redraw_cause (self, CLUTTER_CALLER_ADDRESS (), FALSE);
+
   _clutter_actor_queue_redraw_full (self,
                                     0, /* flags */
                                     NULL, /* clip volume */
@@ -5629,6 +8579,9 @@ _clutter_actor_queue_redraw_with_clip (ClutterActor       *self,
                                        ClutterRedrawFlags  flags,
                                        ClutterPaintVolume *volume)
 {
+  if (G_UNLIKELY (_clutter_stage_tracks_redraw_causes ()))
+    clutter_actor_add_redraw_cause (self, CLUTTER_CALLER_ADDRESS (), FALSE);
+
   _clutter_actor_queue_redraw_full (self,
                                     flags, /* flags */
                                     volume, /* clip volume */
@@ -5678,8 +8631,76 @@ clutter_actor_queue_relayout (ClutterActor *self)
 {
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
+  if (G_UNLIKELY (_clutter_stage_tracks_redraw_causes ()))
+    clutter_actor_add_redraw_cause (self, CLUTTER_CALLER_ADDRESS (), TRUE);
+
+  if (self->priv->update_depth > 0)
+    {
+      self->priv->update_needs_relayout = TRUE;
+      return;
+    }
+
   _clutter_actor_queue_only_relayout (self);
-  clutter_actor_queue_redraw (self);
+
+  /* the redraw has the same cause as the relayout */
+  _clutter_actor_queue_redraw_full (self, 0, NULL, NULL);
+}
+
+/*< private >
+ * _clutter_actor_begin_update:
+ * @self: a #ClutterActor
+ *
+ * Starts updating multiple properties of @self at once.
+ *
+ * Until the matching call to _clutter_actor_end_update(), the
+ * notifications of property changes are frozen and the redraws and
+ * relayouts queued on @self are deferred, so that changing many
+ * properties at once, like an animation does on every frame, results
+ * in a single queued redraw or relayout.
+ *
+ * Calls to this function can be nested.
+ */
+void
+_clutter_actor_begin_update (ClutterActor *self)
+{
+  g_object_freeze_notify (G_OBJECT (self));
+
+  self->priv->update_depth += 1;
+}
+
+/*< private >
+ * _clutter_actor_end_update:
+ * @self: a #ClutterActor
+ *
+ * Ends an update started by _clutter_actor_begin_update(), queueing
+ * the redraw or relayout deferred during the update and emitting
+ * the pending notifications
+ */
+void
+_clutter_actor_end_update (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  g_assert (priv->update_depth > 0);
+
+  priv->update_depth -= 1;
+
+  if (priv->update_depth == 0)
+    {
+      gboolean needs_relayout = priv->update_needs_relayout;
+      gboolean needs_redraw = priv->update_needs_redraw;
+
+      priv->update_needs_relayout = FALSE;
+      priv->update_needs_redraw = FALSE;
+
+      /* queueing a relayout also queues a redraw */
+      if (needs_relayout)
+        clutter_actor_queue_relayout (self);
+      else if (needs_redraw)
+        clutter_actor_queue_redraw (self);
+    }
+
+  g_object_thaw_notify (G_OBJECT (self));
 }
 
 /**
@@ -5760,27 +8781,69 @@ clutter_actor_get_preferred_size (ClutterActor *self,
     *natural_height_p = natural_height;
 }
 
+static void
+clutter_actor_ensure_size_cache (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  if (G_LIKELY (priv->width_requests != NULL))
+    return;
+
+  priv->n_cached_requests = _clutter_context_get_size_cache_size ();
+  priv->width_requests = g_new0 (SizeRequest, 2 * priv->n_cached_requests);
+  priv->height_requests = priv->width_requests + priv->n_cached_requests;
+}
+
+static inline guint
+size_request_hash (gfloat for_size)
+{
+  union { gfloat f; guint32 i; } u;
+
+  /* -0.0 and 0.0 compare equal, so they must hash the same */
+  u.f = for_size != 0.0f ? for_size : 0.0f;
+
+  /* Fibonacci hashing; the low bits of a float are mostly zero */
+  return (u.i * 2654435769U) >> 16;
+}
+
 /* looks for a cached size request for this for_size. If not
- * found, returns the oldest entry so it can be overwritten */
+ * found, returns the oldest entry among the probed ones so it
+ * can be overwritten */
 static gboolean
 _clutter_actor_get_cached_size_request (gfloat         for_size,
                                         SizeRequest   *cached_size_requests,
+                                        guint          n_cached_requests,
                                         SizeRequest  **result)
 {
-  guint i;
+  CLUTTER_STATIC_COUNTER (size_cache_hit_counter,
+                          "Size cache hit counter",
+                          "Increments each time a preferred size is "
+                          "found in the size request cache",
+                          0 /* no application private data */);
+  CLUTTER_STATIC_COUNTER (size_cache_miss_counter,
+                          "Size cache miss counter",
+                          "Increments each time a preferred size has "
+                          "to be computed again",
+                          0 /* no application private data */);
+  guint mask = n_cached_requests - 1;
+  guint hash = size_request_hash (for_size);
+  guint i, n_probes;
 
-  *result = &cached_size_requests[0];
+  n_probes = MIN (n_cached_requests, SIZE_REQUEST_N_PROBES);
 
-  for (i = 0; i < N_CACHED_SIZE_REQUESTS; i++)
+  *result = &cached_size_requests[hash & mask];
+
+  for (i = 0; i < n_probes; i++)
     {
       SizeRequest *sr;
 
-      sr = &cached_size_requests[i];
+      sr = &cached_size_requests[(hash + i) & mask];
 
       if (sr->age > 0 &&
           sr->for_size == for_size)
         {
           CLUTTER_NOTE (LAYOUT, "Size cache hit for size: %.2f", for_size);
+          CLUTTER_COUNTER_INC (_clutter_uprof_context, size_cache_hit_counter);
           *result = sr;
           return TRUE;
         }
@@ -5791,6 +8854,7 @@ _clutter_actor_get_cached_size_request (gfloat         for_size,
     }
 
   CLUTTER_NOTE (LAYOUT, "Size cache miss for size: %.2f", for_size);
+  CLUTTER_COUNTER_INC (_clutter_uprof_context, size_cache_miss_counter);
 
   return FALSE;
 }
@@ -5833,13 +8897,25 @@ clutter_actor_get_preferred_width (ClutterActor *self,
   klass = CLUTTER_ACTOR_GET_CLASS (self);
   priv = self->priv;
 
+  clutter_actor_ensure_size_cache (self);
+
   found_in_cache = FALSE;
   cached_size_request = &priv->width_requests[0];
 
   if (!priv->needs_width_request)
     found_in_cache = _clutter_actor_get_cached_size_request (for_height,
                                                              priv->width_requests,
+                                                             priv->n_cached_requests,
                                                              &cached_size_request);
+  else
+    _clutter_actor_get_cached_size_request (for_height,
+                                            priv->width_requests,
+                                            priv->n_cached_requests,
+                                            &cached_size_request);
+
+  n_size_requests += 1;
+  if (found_in_cache)
+    n_cached_size_requests += 1;
 
   if (!found_in_cache)
     {
@@ -5918,13 +8994,25 @@ clutter_actor_get_preferred_height (ClutterActor *self,
   klass = CLUTTER_ACTOR_GET_CLASS (self);
   priv = self->priv;
 
+  clutter_actor_ensure_size_cache (self);
+
   found_in_cache = FALSE;
   cached_size_request = &priv->height_requests[0];
 
   if (!priv->needs_height_request)
     found_in_cache = _clutter_actor_get_cached_size_request (for_width,
                                                              priv->height_requests,
+                                                             priv->n_cached_requests,
                                                              &cached_size_request);
+  else
+    _clutter_actor_get_cached_size_request (for_width,
+                                            priv->height_requests,
+                                            priv->n_cached_requests,
+                                            &cached_size_request);
+
+  n_size_requests += 1;
+  if (found_in_cache)
+    n_cached_size_requests += 1;
 
   if (!found_in_cache)
     {
@@ -6085,6 +9173,7 @@ clutter_actor_allocate (ClutterActor           *self,
                         const ClutterActorBox  *box,
                         ClutterAllocationFlags  flags)
 {
+  const ExtraInfo *extra;
   ClutterActorPrivate *priv;
   ClutterActorClass *klass;
   ClutterActorBox alloc;
@@ -6092,6 +9181,9 @@ clutter_actor_allocate (ClutterActor           *self,
   gboolean stage_allocation_changed;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
+
+  extra = clutter_actor_get_extra_info_or_defaults (self);
+
   if (G_UNLIKELY (_clutter_actor_get_stage_internal (self) == NULL))
     {
       g_warning ("Spurious clutter_actor_allocate called for actor %p/%s "
@@ -6104,11 +9196,18 @@ clutter_actor_allocate (ClutterActor           *self,
 
   alloc = *box;
 
-  if (priv->constraints != NULL)
+  if (extra->constraints != NULL)
     {
+      ExtraInfo *info = clutter_actor_get_extra_info (self);
       const GList *constraints, *l;
 
-      constraints = _clutter_meta_group_peek_metas (priv->constraints);
+      /* the constraints depending on other actors are applied again
+       * by the stage once the whole scene has been allocated */
+      info->constraint_box = *box;
+      info->constraint_flags = flags & ~CLUTTER_ABSOLUTE_ORIGIN_CHANGED;
+      info->has_constraint_box = TRUE;
+
+      constraints = _clutter_meta_group_peek_metas (extra->constraints);
       for (l = constraints; l != NULL; l = l->next)
         {
           ClutterConstraint *constraint = l->data;
@@ -6160,6 +9259,8 @@ clutter_actor_allocate (ClutterActor           *self,
 
   CLUTTER_SET_PRIVATE_FLAGS (self, CLUTTER_IN_RELAYOUT);
 
+  n_allocated_actors += 1;
+
   klass = CLUTTER_ACTOR_GET_CLASS (self);
   klass->allocate (self, &alloc, flags);
 
@@ -6169,6 +9270,90 @@ clutter_actor_allocate (ClutterActor           *self,
     clutter_actor_queue_redraw (self);
 }
 
+/*< private >
+ * _clutter_actor_get_allocation_serial:
+ * @self: a #ClutterActor
+ *
+ * Retrieves a number that changes every time the allocation of @self
+ * changes, and that is unique across all the actors. Constraints can
+ * use it to skip their evaluation when their source did not move.
+ *
+ * Return value: the serial of the allocation, or 0 if @self does not
+ *   have a valid allocation, in which case its position and size are
+ *   the requested ones
+ */
+guint
+_clutter_actor_get_allocation_serial (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  if (priv->needs_allocation)
+    return 0;
+
+  return priv->allocation_serial;
+}
+
+/*< private >
+ * _clutter_actor_finish_geometry_change:
+ * @self: a #ClutterActor
+ * @emit: whether to emit the #ClutterActor::geometry-changed signal
+ *
+ * Clears the geometry change queued on the stage by @self, emitting
+ * the #ClutterActor::geometry-changed signal if @emit is %TRUE and
+ * the allocation of @self is different from the one it had when the
+ * change was queued.
+ */
+void
+_clutter_actor_finish_geometry_change (ClutterActor *self,
+                                       gboolean      emit)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActorBox old_box;
+
+  if (!priv->geometry_change_queued)
+    return;
+
+  priv->geometry_change_queued = FALSE;
+
+  if (!emit || CLUTTER_ACTOR_IN_DESTRUCTION (self))
+    return;
+
+  /* the allocation might have changed back to the old one */
+  old_box = priv->geometry_old_allocation;
+  if (clutter_actor_box_equal (&old_box, &priv->allocation))
+    return;
+
+  g_signal_emit (self, actor_signals[GEOMETRY_CHANGED], 0,
+                 &old_box,
+                 &priv->allocation);
+}
+
+/*< private >
+ * _clutter_actor_reapply_constraints:
+ * @self: a #ClutterActor
+ *
+ * Applies the constraints of @self again to the allocation it last
+ * received from its parent, and allocates @self again if the result
+ * changed; this is used by the stage to resolve the constraints that
+ * depend on actors allocated after @self.
+ */
+void
+_clutter_actor_reapply_constraints (ClutterActor *self)
+{
+  const ExtraInfo *extra = clutter_actor_get_extra_info_or_defaults (self);
+
+  if (extra->constraints == NULL || !extra->has_constraint_box)
+    return;
+
+  if (!CLUTTER_ACTOR_IS_VISIBLE (self) ||
+      _clutter_actor_get_stage_internal (self) == NULL)
+    return;
+
+  clutter_actor_allocate (self,
+                          &extra->constraint_box,
+                          extra->constraint_flags);
+}
+
 /**
  * clutter_actor_set_geometry:
  * @self: A #ClutterActor
@@ -7208,20 +10393,20 @@ clutter_actor_set_scale (ClutterActor *self,
                          gdouble       scale_x,
                          gdouble       scale_y)
 {
-  ClutterActorPrivate *priv;
+  TransformInfo *info;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  priv = self->priv;
+  info = clutter_actor_get_transform_info (self);
 
-  priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
 
   g_object_freeze_notify (G_OBJECT (self));
 
-  priv->scale_x = scale_x;
+  info->scale_x = scale_x;
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_SCALE_X]);
 
-  priv->scale_y = scale_y;
+  info->scale_y = scale_y;
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_SCALE_Y]);
 
   clutter_actor_queue_redraw (self);
@@ -7250,25 +10435,25 @@ clutter_actor_set_scale_full (ClutterActor *self,
                               gfloat        center_x,
                               gfloat        center_y)
 {
-  ClutterActorPrivate *priv;
+  TransformInfo *info;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  priv = self->priv;
+  info = clutter_actor_get_transform_info (self);
 
   g_object_freeze_notify (G_OBJECT (self));
 
   clutter_actor_set_scale (self, scale_x, scale_y);
 
-  priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
 
-  if (priv->scale_center.is_fractional)
+  if (info->scale_center.is_fractional)
     g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_SCALE_GRAVITY]);
 
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_SCALE_CENTER_X]);
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_SCALE_CENTER_Y]);
 
-  clutter_anchor_coord_set_units (&priv->scale_center, center_x, center_y, 0);
+  clutter_anchor_coord_set_units (&info->scale_center, center_x, center_y, 0);
 
   g_object_thaw_notify (G_OBJECT (self));
 }
@@ -7295,12 +10480,10 @@ clutter_actor_set_scale_with_gravity (ClutterActor   *self,
                                       gdouble         scale_y,
                                       ClutterGravity  gravity)
 {
-  ClutterActorPrivate *priv;
+  TransformInfo *info;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  priv = self->priv;
-
   if (gravity == CLUTTER_GRAVITY_NONE)
     clutter_actor_set_scale_full (self, scale_x, scale_y, 0, 0);
   else
@@ -7309,13 +10492,14 @@ clutter_actor_set_scale_with_gravity (ClutterActor   *self,
 
       clutter_actor_set_scale (self, scale_x, scale_y);
 
-      priv->transform_valid = FALSE;
+      clutter_actor_invalidate_transform (self);
 
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_SCALE_GRAVITY]);
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_SCALE_CENTER_X]);
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_SCALE_CENTER_Y]);
 
-      clutter_anchor_coord_set_gravity (&priv->scale_center, gravity);
+      info = clutter_actor_get_transform_info (self);
+      clutter_anchor_coord_set_gravity (&info->scale_center, gravity);
 
       g_object_thaw_notify (G_OBJECT (self));
     }
@@ -7338,13 +10522,16 @@ clutter_actor_get_scale (ClutterActor *self,
 			 gdouble      *scale_x,
 			 gdouble      *scale_y)
 {
+  const TransformInfo *info;
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
+  info = clutter_actor_get_transform_info_or_defaults (self);
+
   if (scale_x)
-    *scale_x = self->priv->scale_x;
+    *scale_x = info->scale_x;
 
   if (scale_y)
-    *scale_y = self->priv->scale_y;
+    *scale_y = info->scale_y;
 }
 
 /**
@@ -7367,9 +10554,12 @@ clutter_actor_get_scale_center (ClutterActor *self,
                                 gfloat       *center_x,
                                 gfloat       *center_y)
 {
+  const TransformInfo *info;
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  clutter_anchor_coord_get_units (self, &self->priv->scale_center,
+  info = clutter_actor_get_transform_info_or_defaults (self);
+
+  clutter_anchor_coord_get_units (self, &info->scale_center,
                                   center_x,
                                   center_y,
                                   NULL);
@@ -7390,9 +10580,12 @@ clutter_actor_get_scale_center (ClutterActor *self,
 ClutterGravity
 clutter_actor_get_scale_gravity (ClutterActor *self)
 {
+  const TransformInfo *info;
   g_return_val_if_fail (CLUTTER_IS_ACTOR (self), CLUTTER_GRAVITY_NONE);
 
-  return clutter_anchor_coord_get_gravity (&self->priv->scale_center);
+  info = clutter_actor_get_transform_info_or_defaults (self);
+
+  return clutter_anchor_coord_get_gravity (&info->scale_center);
 }
 
 /**
@@ -7407,16 +10600,21 @@ void
 clutter_actor_set_opacity (ClutterActor *self,
 			   guint8        opacity)
 {
+  const ExtraInfo *extra;
   ClutterActorPrivate *priv;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
   priv = self->priv;
 
+  extra = clutter_actor_get_extra_info_or_defaults (self);
+
   if (priv->opacity != opacity)
     {
       priv->opacity = opacity;
 
+      clutter_actor_invalidate_paint_opacity (self);
+
       /* Queue a redraw from the flatten effect so that it can use
          its cached image if available instead of having to redraw the
          actual actor. If it doesn't end up using the FBO then the
@@ -7426,7 +10624,7 @@ clutter_actor_set_opacity (ClutterActor *self,
       _clutter_actor_queue_redraw_full (self,
                                         0, /* flags */
                                         NULL, /* clip */
-                                        priv->flatten_effect);
+                                        extra->flatten_effect);
 
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_OPACITY]);
     }
@@ -7438,6 +10636,12 @@ clutter_actor_set_opacity (ClutterActor *self,
  *
  * Retrieves the absolute opacity of the actor, as it appears on the stage
  *
+ * The result is cached until the opacity of the actor or of one of its
+ * ancestors changes, so that the actors painted during a frame do not
+ * walk up to the stage each time: the walk stops at the first ancestor
+ * with a cached paint opacity, which is the parent for every actor but
+ * the first one painted inside a container.
+ *
  * This function does not do type checks
  *
  * Return value: the absolute opacity of the actor
@@ -7447,6 +10651,7 @@ clutter_actor_get_paint_opacity_internal (ClutterActor *self)
 {
   ClutterActorPrivate *priv = self->priv;
   ClutterActor *parent;
+  guint8 opacity;
 
   /* override the top-level opacity to always be 255; even in
    * case of ClutterStage:use-alpha being TRUE we want the rest
@@ -7455,22 +10660,30 @@ clutter_actor_get_paint_opacity_internal (ClutterActor *self)
   if (CLUTTER_ACTOR_IS_TOPLEVEL (self))
     return 255;
 
-  if (priv->opacity_override >= 0)
-    return priv->opacity_override;
+  if (priv->paint_opacity_cached)
+    return priv->paint_opacity;
 
   parent = priv->parent_actor;
 
-  /* Factor in the actual actors opacity with parents */
-  if (parent != NULL)
+  if (priv->opacity_override >= 0)
+    opacity = priv->opacity_override;
+  else if (parent != NULL)
     {
-      guint8 opacity = clutter_actor_get_paint_opacity_internal (parent);
+      /* Factor in the actual actors opacity with parents */
+      opacity = clutter_actor_get_paint_opacity_internal (parent);
 
       if (opacity != 0xff)
-        return (opacity * priv->opacity) / 0xff;
+        opacity = (opacity * priv->opacity) / 0xff;
+      else
+        opacity = priv->opacity;
     }
+  else
+    opacity = priv->opacity;
 
-  return priv->opacity;
+  priv->paint_opacity = opacity;
+  priv->paint_opacity_cached = TRUE;
 
+  return opacity;
 }
 
 /**
@@ -7577,21 +10790,30 @@ clutter_actor_get_opacity (ClutterActor *self)
  * recommended to override the has_overlaps() virtual to return %FALSE
  * for maximum efficiency.
  *
+ * Independently of this value, Clutter also redirects containers that
+ * did not change for a few frames while one of their ancestors moves
+ * them on the stage, and paints the cached image at the new position
+ * until a redraw is queued on them or on one of their children. The
+ * memory used by these images is limited by the
+ * CLUTTER_SUBTREE_CACHE_BUDGET environment variable, and the cache can
+ * be disabled with CLUTTER_PAINT=disable-subtree-cache.
+ *
  * Since: 1.8
  */
 void
 clutter_actor_set_offscreen_redirect (ClutterActor *self,
                                       ClutterOffscreenRedirect redirect)
 {
-  ClutterActorPrivate *priv;
+  ExtraInfo *extra;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  priv = self->priv;
-
-  if (priv->offscreen_redirect != redirect)
+  if (clutter_actor_get_offscreen_redirect (self) != redirect)
     {
-      priv->offscreen_redirect = redirect;
+      extra = clutter_actor_get_extra_info (self);
+      extra->offscreen_redirect = redirect;
+
+      self->priv->flatten_valid = FALSE;
 
       /* Queue a redraw from the effect so that it can use its cached
          image if available instead of having to redraw the actual
@@ -7601,7 +10823,7 @@ clutter_actor_set_offscreen_redirect (ClutterActor *self,
       _clutter_actor_queue_redraw_full (self,
                                         0, /* flags */
                                         NULL, /* clip */
-                                        priv->flatten_effect);
+                                        extra->flatten_effect);
 
       g_object_notify_by_pspec (G_OBJECT (self),
                                 obj_props[PROP_OFFSCREEN_REDIRECT]);
@@ -7622,9 +10844,13 @@ clutter_actor_set_offscreen_redirect (ClutterActor *self,
 ClutterOffscreenRedirect
 clutter_actor_get_offscreen_redirect (ClutterActor *self)
 {
+  const ExtraInfo *extra;
+
   g_return_val_if_fail (CLUTTER_IS_ACTOR (self), 0);
 
-  return self->priv->offscreen_redirect;
+  extra = clutter_actor_get_extra_info_or_defaults (self);
+
+  return extra->offscreen_redirect;
 }
 
 /**
@@ -7639,10 +10865,14 @@ void
 clutter_actor_set_name (ClutterActor *self,
 			const gchar  *name)
 {
+  ExtraInfo *extra;
+
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  g_free (self->priv->name);
-  self->priv->name = g_strdup (name);
+  extra = clutter_actor_get_extra_info (self);
+
+  g_free (extra->name);
+  extra->name = g_strdup (name);
 
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_NAME]);
 }
@@ -7659,9 +10889,13 @@ clutter_actor_set_name (ClutterActor *self,
 G_CONST_RETURN gchar *
 clutter_actor_get_name (ClutterActor *self)
 {
+  const ExtraInfo *extra;
+
   g_return_val_if_fail (CLUTTER_IS_ACTOR (self), NULL);
 
-  return self->priv->name;
+  extra = clutter_actor_get_extra_info_or_defaults (self);
+
+  return extra->name;
 }
 
 /**
@@ -7684,19 +10918,99 @@ clutter_actor_get_gid (ClutterActor *self)
   return self->priv->id;
 }
 
+/* the child whose depth is changing while its parent is asked to sort
+ * its children; see _clutter_actor_get_depth_changed_child() */
+static ClutterActor *depth_changed_child = NULL;
+
+/**
+ * clutter_actor_set_depth:
+ * @self: a #ClutterActor
+ * @depth: Z co-ord
+ *
+ * Sets the Z coordinate of @self to @depth.
+ *
+ * The unit used by @depth is dependant on the perspective setup. See
+ * also clutter_stage_set_perspective().
+ */
+void
+clutter_actor_set_depth (ClutterActor *self,
+                         gfloat        depth)
+{
+  ClutterActorPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+
+  priv = self->priv;
+
+  if (priv->z != depth)
+    {
+      /* Sets Z value - XXX 2.0: should we invert? */
+      priv->z = depth;
+
+      if (priv->parent_actor && CLUTTER_IS_CONTAINER (priv->parent_actor))
+        {
+          ClutterContainer *parent;
+          ClutterActor *old_child;
+
+          /* We need to resort the container stacking order as to
+           * correctly render alpha values; the containers that know
+           * which child changed only need to move that one
+           */
+          parent = CLUTTER_CONTAINER (priv->parent_actor);
+
+          old_child = depth_changed_child;
+          depth_changed_child = self;
+
+          clutter_container_sort_depth_order (parent);
+
+          depth_changed_child = old_child;
+        }
+
+      clutter_actor_invalidate_transform (self);
+
+      clutter_actor_queue_redraw (self);
+
+      g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_DEPTH]);
+    }
+}
+
+/**
+ * clutter_actor_get_depth:
+ * @self: a #ClutterActor
+ *
+ * Retrieves the depth of @self.
+ *
+ * Return value: the depth of the actor
+ */
+gfloat
+clutter_actor_get_depth (ClutterActor *self)
+{
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), -1);
+
+  return self->priv->z;
+}
+
 /**
- * clutter_actor_set_depth:
+ * clutter_actor_set_translation:
  * @self: a #ClutterActor
- * @depth: Z co-ord
+ * @translate_x: the translation on the X axis
+ * @translate_y: the translation on the Y axis
  *
- * Sets the Z coordinate of @self to @depth.
+ * Sets the translation of @self, relative to its allocation.
  *
- * The unit used by @depth is dependant on the perspective setup. See
- * also clutter_stage_set_perspective().
+ * The translation is only applied when painting and picking @self,
+ * and it does not change the allocation of the actor, so unlike
+ * clutter_actor_set_position() it never queues a relayout. This makes
+ * it suitable for moving actors managed by a #ClutterLayoutManager,
+ * or for animating the position of an actor without recomputing the
+ * layout of the scene on every frame.
+ *
+ * Since: 1.8
  */
 void
-clutter_actor_set_depth (ClutterActor *self,
-                         gfloat        depth)
+clutter_actor_set_translation (ClutterActor *self,
+                               gfloat        translate_x,
+                               gfloat        translate_y)
 {
   ClutterActorPrivate *priv;
 
@@ -7704,47 +11018,87 @@ clutter_actor_set_depth (ClutterActor *self,
 
   priv = self->priv;
 
-  if (priv->z != depth)
+  if (priv->translation_x == translate_x &&
+      priv->translation_y == translate_y)
+    return;
+
+  clutter_actor_invalidate_transform (self);
+
+  g_object_freeze_notify (G_OBJECT (self));
+
+  if (priv->translation_x != translate_x)
     {
-      /* Sets Z value - XXX 2.0: should we invert? */
-      priv->z = depth;
+      priv->translation_x = translate_x;
+      g_object_notify_by_pspec (G_OBJECT (self),
+                                obj_props[PROP_TRANSLATION_X]);
+    }
 
-      if (priv->parent_actor && CLUTTER_IS_CONTAINER (priv->parent_actor))
-        {
-          ClutterContainer *parent;
+  if (priv->translation_y != translate_y)
+    {
+      priv->translation_y = translate_y;
+      g_object_notify_by_pspec (G_OBJECT (self),
+                                obj_props[PROP_TRANSLATION_Y]);
+    }
 
-          /* We need to resort the container stacking order as to
-           * correctly render alpha values.
-           *
-           * FIXME: This is sub-optimal. maybe queue the sort
-           *        before stacking
-           */
-          parent = CLUTTER_CONTAINER (priv->parent_actor);
-          clutter_container_sort_depth_order (parent);
-        }
+  clutter_actor_queue_redraw (self);
 
-      priv->transform_valid = FALSE;
+  g_object_thaw_notify (G_OBJECT (self));
+}
 
-      clutter_actor_queue_redraw (self);
+/*< private >
+ * _clutter_actor_set_layout_offset:
+ * @self: a #ClutterActor
+ * @offset_x: the offset on the X axis
+ * @offset_y: the offset on the Y axis
+ *
+ * Sets an offset applied to @self when painting and picking, on top of
+ * the translation set with clutter_actor_set_translation(). Layout
+ * managers use it to animate the position of their children without
+ * allocating them again on every frame.
+ */
+void
+_clutter_actor_set_layout_offset (ClutterActor *self,
+                                  gfloat        offset_x,
+                                  gfloat        offset_y)
+{
+  ClutterActorPrivate *priv = self->priv;
 
-      g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_DEPTH]);
-    }
+  if (priv->layout_offset_x == offset_x &&
+      priv->layout_offset_y == offset_y)
+    return;
+
+  clutter_actor_invalidate_transform (self);
+
+  priv->layout_offset_x = offset_x;
+  priv->layout_offset_y = offset_y;
+
+  clutter_actor_queue_redraw (self);
 }
 
 /**
- * clutter_actor_get_depth:
+ * clutter_actor_get_translation:
  * @self: a #ClutterActor
+ * @translate_x: (out) (allow-none): return location for the translation
+ *   on the X axis, or %NULL
+ * @translate_y: (out) (allow-none): return location for the translation
+ *   on the Y axis, or %NULL
  *
- * Retrieves the depth of @self.
+ * Retrieves the translation set using clutter_actor_set_translation()
  *
- * Return value: the depth of the actor
+ * Since: 1.8
  */
-gfloat
-clutter_actor_get_depth (ClutterActor *self)
+void
+clutter_actor_get_translation (ClutterActor *self,
+                               gfloat       *translate_x,
+                               gfloat       *translate_y)
 {
-  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), -1);
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  return self->priv->z;
+  if (translate_x)
+    *translate_x = self->priv->translation_x;
+
+  if (translate_y)
+    *translate_y = self->priv->translation_y;
 }
 
 /**
@@ -7779,11 +11133,11 @@ clutter_actor_set_rotation (ClutterActor      *self,
                             gfloat             y,
                             gfloat             z)
 {
-  ClutterActorPrivate *priv;
+  TransformInfo *info;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  priv = self->priv;
+  info = clutter_actor_get_transform_info (self);
 
   g_object_freeze_notify (G_OBJECT (self));
 
@@ -7792,24 +11146,24 @@ clutter_actor_set_rotation (ClutterActor      *self,
   switch (axis)
     {
     case CLUTTER_X_AXIS:
-      clutter_anchor_coord_set_units (&priv->rx_center, x, y, z);
+      clutter_anchor_coord_set_units (&info->rx_center, x, y, z);
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_ROTATION_CENTER_X]);
       break;
 
     case CLUTTER_Y_AXIS:
-      clutter_anchor_coord_set_units (&priv->ry_center, x, y, z);
+      clutter_anchor_coord_set_units (&info->ry_center, x, y, z);
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_ROTATION_CENTER_Y]);
       break;
 
     case CLUTTER_Z_AXIS:
-      if (priv->rz_center.is_fractional)
+      if (info->rz_center.is_fractional)
         g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_ROTATION_CENTER_Z_GRAVITY]);
-      clutter_anchor_coord_set_units (&priv->rz_center, x, y, z);
+      clutter_anchor_coord_set_units (&info->rz_center, x, y, z);
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_ROTATION_CENTER_Z]);
       break;
     }
 
-  priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
 
   g_object_thaw_notify (G_OBJECT (self));
 }
@@ -7833,7 +11187,7 @@ clutter_actor_set_z_rotation_from_gravity (ClutterActor   *self,
                                            gdouble         angle,
                                            ClutterGravity  gravity)
 {
-  ClutterActorPrivate *priv;
+  TransformInfo *info;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
@@ -7841,13 +11195,13 @@ clutter_actor_set_z_rotation_from_gravity (ClutterActor   *self,
     clutter_actor_set_rotation (self, CLUTTER_Z_AXIS, angle, 0, 0, 0);
   else
     {
-      priv = self->priv;
+      info = clutter_actor_get_transform_info (self);
 
       g_object_freeze_notify (G_OBJECT (self));
 
       clutter_actor_set_rotation_internal (self, CLUTTER_Z_AXIS, angle);
 
-      clutter_anchor_coord_set_gravity (&priv->rz_center, gravity);
+      clutter_anchor_coord_set_gravity (&info->rz_center, gravity);
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_ROTATION_CENTER_Z_GRAVITY]);
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_ROTATION_CENTER_Z]);
 
@@ -7877,29 +11231,29 @@ clutter_actor_get_rotation (ClutterActor      *self,
                             gfloat            *y,
                             gfloat            *z)
 {
-  ClutterActorPrivate *priv;
+  const TransformInfo *info;
+  const AnchorCoord *anchor_coord = NULL;
   gdouble retval = 0;
-  AnchorCoord *anchor_coord = NULL;
 
   g_return_val_if_fail (CLUTTER_IS_ACTOR (self), 0);
 
-  priv = self->priv;
+  info = clutter_actor_get_transform_info_or_defaults (self);
 
   switch (axis)
     {
     case CLUTTER_X_AXIS:
-      anchor_coord = &priv->rx_center;
-      retval = priv->rxang;
+      anchor_coord = &info->rx_center;
+      retval = info->rxang;
       break;
 
     case CLUTTER_Y_AXIS:
-      anchor_coord = &priv->ry_center;
-      retval = priv->ryang;
+      anchor_coord = &info->ry_center;
+      retval = info->ryang;
       break;
 
     case CLUTTER_Z_AXIS:
-      anchor_coord = &priv->rz_center;
-      retval = priv->rzang;
+      anchor_coord = &info->rz_center;
+      retval = info->rzang;
       break;
     }
 
@@ -7923,9 +11277,12 @@ clutter_actor_get_rotation (ClutterActor      *self,
 ClutterGravity
 clutter_actor_get_z_rotation_gravity (ClutterActor *self)
 {
+  const TransformInfo *info;
   g_return_val_if_fail (CLUTTER_IS_ACTOR (self), 0.0);
 
-  return clutter_anchor_coord_get_gravity (&self->priv->rz_center);
+  info = clutter_actor_get_transform_info_or_defaults (self);
+
+  return clutter_anchor_coord_get_gravity (&info->rz_center);
 }
 
 /**
@@ -8104,8 +11461,21 @@ clutter_actor_set_parent (ClutterActor *self,
     }
 
   g_object_ref_sink (self);
+
+  /* without a parent, this only updates counted_reactive */
+  clutter_actor_sync_reactive (self);
+
   priv->parent_actor = parent;
 
+  clutter_actor_add_reactive_descendants (self,
+                                          priv->n_reactive_descendants +
+                                          (priv->counted_reactive ? 1 : 0));
+
+  /* the stage-relative transformation and the paint opacity depend
+   * on the new parent */
+  clutter_actor_invalidate_stage_transform (self);
+  clutter_actor_invalidate_paint_opacity (self);
+
   /* Maintain an explicit list of children for every actor... */
   parent_priv = parent->priv;
   parent_priv->children =
@@ -8194,22 +11564,6 @@ clutter_actor_get_paint_visibility (ClutterActor *actor)
   return CLUTTER_ACTOR_IS_MAPPED (actor);
 }
 
-static ClutterActorTraverseVisitFlags
-invalidate_queue_redraw_entry (ClutterActor *self,
-                               int           depth,
-                               gpointer      user_data)
-{
-  ClutterActorPrivate *priv = self->priv;
-
-  if (priv->queue_redraw_entry != NULL)
-    {
-      _clutter_stage_queue_redraw_entry_invalidate (priv->queue_redraw_entry);
-      priv->queue_redraw_entry = NULL;
-    }
-
-  return CLUTTER_ACTOR_TRAVERSE_VISIT_CONTINUE;
-}
-
 /**
  * clutter_actor_unparent:
  * @self: a #ClutterActor
@@ -8251,16 +11605,26 @@ clutter_actor_unparent (ClutterActor *self)
 
    /* We take this opportunity to invalidate any queue redraw entry
     * associated with the actor and descendants since we won't be able to
-    * determine the appropriate stage after this. */
-  _clutter_actor_traverse (self,
-                           0,
-                           invalidate_queue_redraw_entry,
-                           NULL,
-                           NULL);
+    * determine the appropriate stage after this. The root of a destroyed
+    * tree already did it for the whole tree in clutter_actor_destroy(). */
+  if (!CLUTTER_ACTOR_IN_DESTRUCTION (self) &&
+      !clutter_actor_parent_in_teardown (self))
+    _clutter_actor_traverse (self,
+                             0,
+                             invalidate_queue_redraw_entry,
+                             NULL,
+                             NULL);
+
+  clutter_actor_add_reactive_descendants (self,
+                                          -(gint) (priv->n_reactive_descendants +
+                                                   (priv->counted_reactive ? 1 : 0)));
 
   old_parent = priv->parent_actor;
   priv->parent_actor = NULL;
 
+  clutter_actor_invalidate_stage_transform (self);
+  clutter_actor_invalidate_paint_opacity (self);
+
   /* clutter_actor_reparent() will emit ::parent-set for us */
   if (!CLUTTER_ACTOR_IN_REPARENT (self))
     g_signal_emit (self, actor_signals[PARENT_SET], 0, old_parent);
@@ -8510,6 +11874,104 @@ clutter_actor_lower_bottom (ClutterActor *self)
  * Event handling
  */
 
+/* the number of emission hooks installed on the event signals */
+static guint event_emission_hooks = 0;
+
+/*< private >
+ * _clutter_actor_add_event_emission_hook:
+ *
+ * Tells ClutterActor that an emission hook has been installed on
+ * one of its event signals, so that clutter_actor_event() has to
+ * emit the signals even on actors that have no handlers for them
+ */
+void
+_clutter_actor_add_event_emission_hook (void)
+{
+  event_emission_hooks += 1;
+}
+
+/*< private >
+ * _clutter_actor_remove_event_emission_hook:
+ *
+ * Undoes the effect of _clutter_actor_add_event_emission_hook()
+ */
+void
+_clutter_actor_remove_event_emission_hook (void)
+{
+  g_return_if_fail (event_emission_hooks > 0);
+
+  event_emission_hooks -= 1;
+}
+
+/* Checks whether emitting the event signal @signal_num on @self can
+ * have any effect; if the class of @self does not implement the class
+ * handler and no handler is connected to it, which includes the ones
+ * of the actions, then the emission can be skipped */
+static gboolean
+clutter_actor_has_event_handler (ClutterActor *self,
+                                 gint          signal_num)
+{
+  ClutterActorClass *klass = CLUTTER_ACTOR_GET_CLASS (self);
+  gboolean has_class_handler;
+
+  if (event_emission_hooks > 0)
+    return TRUE;
+
+  switch (signal_num)
+    {
+    case EVENT:
+      has_class_handler = klass->event != NULL;
+      break;
+
+    case CAPTURED_EVENT:
+      has_class_handler = klass->captured_event != NULL;
+      break;
+
+    case BUTTON_PRESS_EVENT:
+      has_class_handler = klass->button_press_event != NULL;
+      break;
+
+    case BUTTON_RELEASE_EVENT:
+      has_class_handler = klass->button_release_event != NULL;
+      break;
+
+    case SCROLL_EVENT:
+      has_class_handler = klass->scroll_event != NULL;
+      break;
+
+    case KEY_PRESS_EVENT:
+      has_class_handler = klass->key_press_event != NULL;
+      break;
+
+    case KEY_RELEASE_EVENT:
+      has_class_handler = klass->key_release_event != NULL;
+      break;
+
+    case MOTION_EVENT:
+      has_class_handler = klass->motion_event != NULL;
+      break;
+
+    case ENTER_EVENT:
+      has_class_handler = klass->enter_event != NULL;
+      break;
+
+    case LEAVE_EVENT:
+      has_class_handler = klass->leave_event != NULL;
+      break;
+
+    default:
+      has_class_handler = TRUE;
+      break;
+    }
+
+  if (has_class_handler)
+    return TRUE;
+
+  return g_signal_has_handler_pending (self, actor_signals[signal_num],
+                                       0,
+                                       FALSE);
+}
+
 /**
  * clutter_actor_event:
  * @actor: a #ClutterActor
@@ -8541,13 +12003,15 @@ clutter_actor_event (ClutterActor *actor,
 
   if (capture)
     {
-      g_signal_emit (actor, actor_signals[CAPTURED_EVENT], 0,
-		     event,
-                     &retval);
+      if (clutter_actor_has_event_handler (actor, CAPTURED_EVENT))
+        g_signal_emit (actor, actor_signals[CAPTURED_EVENT], 0,
+                       event,
+                       &retval);
       goto out;
     }
 
-  g_signal_emit (actor, actor_signals[EVENT], 0, event, &retval);
+  if (clutter_actor_has_event_handler (actor, EVENT))
+    g_signal_emit (actor, actor_signals[EVENT], 0, event, &retval);
 
   if (!retval)
     {
@@ -8587,7 +12051,8 @@ clutter_actor_event (ClutterActor *actor,
 	  break;
 	}
 
-      if (signal_num != -1)
+      if (signal_num != -1 &&
+          clutter_actor_has_event_handler (actor, signal_num))
 	g_signal_emit (actor, actor_signals[signal_num], 0,
 		       event, &retval);
     }
@@ -8621,6 +12086,8 @@ clutter_actor_set_reactive (ClutterActor *actor,
   else
     CLUTTER_ACTOR_UNSET_FLAGS (actor, CLUTTER_ACTOR_REACTIVE);
 
+  clutter_actor_sync_reactive (actor);
+
   g_object_notify_by_pspec (G_OBJECT (actor), obj_props[PROP_REACTIVE]);
 }
 
@@ -8657,13 +12124,13 @@ clutter_actor_get_anchor_point (ClutterActor *self,
 				gfloat       *anchor_x,
                                 gfloat       *anchor_y)
 {
-  ClutterActorPrivate *priv;
+  const TransformInfo *info;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  priv = self->priv;
+  info = clutter_actor_get_transform_info_or_defaults (self);
 
-  clutter_anchor_coord_get_units (self, &priv->anchor,
+  clutter_anchor_coord_get_units (self, &info->anchor,
                                   anchor_x,
                                   anchor_y,
                                   NULL);
@@ -8687,22 +12154,22 @@ clutter_actor_set_anchor_point (ClutterActor *self,
                                 gfloat        anchor_x,
                                 gfloat        anchor_y)
 {
-  ClutterActorPrivate *priv;
+  TransformInfo *info;
   gboolean changed = FALSE;
   gfloat old_anchor_x, old_anchor_y;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  priv = self->priv;
+  info = clutter_actor_get_transform_info (self);
 
   g_object_freeze_notify (G_OBJECT (self));
 
-  clutter_anchor_coord_get_units (self, &priv->anchor,
+  clutter_anchor_coord_get_units (self, &info->anchor,
                                   &old_anchor_x,
                                   &old_anchor_y,
                                   NULL);
 
-  if (priv->anchor.is_fractional)
+  if (info->anchor.is_fractional)
     g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_ANCHOR_GRAVITY]);
 
   if (old_anchor_x != anchor_x)
@@ -8717,11 +12184,11 @@ clutter_actor_set_anchor_point (ClutterActor *self,
       changed = TRUE;
     }
 
-  clutter_anchor_coord_set_units (&priv->anchor, anchor_x, anchor_y, 0);
+  clutter_anchor_coord_set_units (&info->anchor, anchor_x, anchor_y, 0);
 
   if (changed)
     {
-      priv->transform_valid = FALSE;
+      clutter_actor_invalidate_transform (self);
       clutter_actor_queue_redraw (self);
     }
 
@@ -8743,13 +12210,13 @@ clutter_actor_set_anchor_point (ClutterActor *self,
 ClutterGravity
 clutter_actor_get_anchor_point_gravity (ClutterActor *self)
 {
-  ClutterActorPrivate *priv;
+  const TransformInfo *info;
 
   g_return_val_if_fail (CLUTTER_IS_ACTOR (self), CLUTTER_GRAVITY_NONE);
 
-  priv = self->priv;
+  info = clutter_actor_get_transform_info_or_defaults (self);
 
-  return clutter_anchor_coord_get_gravity (&priv->anchor);
+  return clutter_anchor_coord_get_gravity (&info->anchor);
 }
 
 /**
@@ -8768,6 +12235,7 @@ clutter_actor_move_anchor_point (ClutterActor *self,
                                  gfloat        anchor_x,
                                  gfloat        anchor_y)
 {
+  const TransformInfo *info;
   ClutterActorPrivate *priv;
   gfloat old_anchor_x, old_anchor_y;
 
@@ -8775,7 +12243,9 @@ clutter_actor_move_anchor_point (ClutterActor *self,
 
   priv = self->priv;
 
-  clutter_anchor_coord_get_units (self, &priv->anchor,
+  info = clutter_actor_get_transform_info_or_defaults (self);
+
+  clutter_anchor_coord_get_units (self, &info->anchor,
                                   &old_anchor_x,
                                   &old_anchor_y,
                                   NULL);
@@ -8822,15 +12292,11 @@ clutter_actor_move_anchor_point_from_gravity (ClutterActor   *self,
 
   g_object_freeze_notify (G_OBJECT (self));
 
-  clutter_anchor_coord_get_units (self, &priv->anchor,
-                                  &old_anchor_x,
-                                  &old_anchor_y,
-                                  NULL);
+  /* the anchor point may be moved out of the defaults by setting
+   * the gravity, so we cannot keep a pointer to it around */
+  clutter_actor_get_anchor_point (self, &old_anchor_x, &old_anchor_y);
   clutter_actor_set_anchor_point_from_gravity (self, gravity);
-  clutter_anchor_coord_get_units (self, &priv->anchor,
-                                  &new_anchor_x,
-                                  &new_anchor_y,
-                                  NULL);
+  clutter_actor_get_anchor_point (self, &new_anchor_x, &new_anchor_y);
 
   if (priv->position_set)
     clutter_actor_move_by (self,
@@ -8866,9 +12332,11 @@ clutter_actor_set_anchor_point_from_gravity (ClutterActor   *self,
     clutter_actor_set_anchor_point (self, 0, 0);
   else
     {
-      clutter_anchor_coord_set_gravity (&self->priv->anchor, gravity);
+      TransformInfo *info = clutter_actor_get_transform_info (self);
 
-      self->priv->transform_valid = FALSE;
+      clutter_anchor_coord_set_gravity (&info->anchor, gravity);
+
+      clutter_actor_invalidate_transform (self);
 
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_ANCHOR_GRAVITY]);
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_ANCHOR_X]);
@@ -9353,10 +12821,12 @@ get_meta_from_animation_property (ClutterActor  *actor,
                                   const gchar   *name,
                                   gchar        **name_p)
 {
-  ClutterActorPrivate *priv = actor->priv;
+  const ExtraInfo *extra;
   ClutterActorMeta *meta = NULL;
   gchar **tokens;
 
+  extra = clutter_actor_get_extra_info_or_defaults (actor);
+
   /* if this is not a special property, fall through */
   if (name[0] != '@')
     return NULL;
@@ -9384,13 +12854,13 @@ get_meta_from_animation_property (ClutterActor  *actor,
     }
 
   if (strcmp (tokens[0], "actions") == 0)
-    meta = _clutter_meta_group_get_meta (priv->actions, tokens[1]);
+    meta = _clutter_meta_group_get_meta (extra->actions, tokens[1]);
 
   if (strcmp (tokens[0], "constraints") == 0)
-    meta = _clutter_meta_group_get_meta (priv->constraints, tokens[1]);
+    meta = _clutter_meta_group_get_meta (extra->constraints, tokens[1]);
 
   if (strcmp (tokens[0], "effects") == 0)
-    meta = _clutter_meta_group_get_meta (priv->effects, tokens[1]);
+    meta = _clutter_meta_group_get_meta (extra->effects, tokens[1]);
 
   if (name_p != NULL)
     *name_p = g_strdup (tokens[2]);
@@ -9492,61 +12962,146 @@ clutter_actor_animate_property (ClutterAnimatable *animatable,
   return clutter_interval_compute_value (interval, progress, new_value);
 }
 
-static void
-clutter_animatable_iface_init (ClutterAnimatableIface *iface)
+static gboolean
+clutter_actor_set_double_property (ClutterAnimatable *animatable,
+                                   GParamSpec        *pspec,
+                                   gdouble            value)
 {
-  iface->animate_property = clutter_actor_animate_property;
-  iface->find_property = clutter_actor_find_property;
-  iface->get_initial_state = clutter_actor_get_initial_state;
-  iface->set_final_state = clutter_actor_set_final_state;
+  ClutterActor *self = CLUTTER_ACTOR (animatable);
+  ClutterActorPrivate *priv = self->priv;
+  ClutterAnimatableIface *iface;
+  TransformInfo *info;
+  gdouble *field;
+
+  /* properties installed by subclasses, or overridden by them, are
+   * set through the GValue based path
+   */
+  if (pspec->owner_type != CLUTTER_TYPE_ACTOR)
+    return FALSE;
+
+  /* subclasses are allowed to override the Animatable implementation */
+  iface = CLUTTER_ANIMATABLE_GET_IFACE (self);
+  if (iface->animate_property != clutter_actor_animate_property ||
+      iface->set_final_state != clutter_actor_set_final_state)
+    return FALSE;
+
+  switch (pspec->param_id)
+    {
+    case PROP_X:
+      clutter_actor_set_x (self, value);
+      return TRUE;
+
+    case PROP_Y:
+      clutter_actor_set_y (self, value);
+      return TRUE;
+
+    case PROP_WIDTH:
+      clutter_actor_set_width (self, value);
+      return TRUE;
+
+    case PROP_HEIGHT:
+      clutter_actor_set_height (self, value);
+      return TRUE;
+
+    case PROP_DEPTH:
+      clutter_actor_set_depth (self, value);
+      return TRUE;
+
+    case PROP_OPACITY:
+      clutter_actor_set_opacity (self, (guint) value);
+      return TRUE;
+
+    case PROP_TRANSLATION_X:
+      if (priv->translation_x == (gfloat) value)
+        return TRUE;
+
+      clutter_actor_invalidate_transform (self);
+      priv->translation_x = value;
+      break;
+
+    case PROP_TRANSLATION_Y:
+      if (priv->translation_y == (gfloat) value)
+        return TRUE;
+
+      clutter_actor_invalidate_transform (self);
+      priv->translation_y = value;
+      break;
+
+    case PROP_SCALE_X:
+    case PROP_SCALE_Y:
+    case PROP_ROTATION_ANGLE_X:
+    case PROP_ROTATION_ANGLE_Y:
+    case PROP_ROTATION_ANGLE_Z:
+      info = clutter_actor_get_transform_info (self);
+
+      switch (pspec->param_id)
+        {
+        case PROP_SCALE_X:
+          field = &info->scale_x;
+          break;
+
+        case PROP_SCALE_Y:
+          field = &info->scale_y;
+          break;
+
+        case PROP_ROTATION_ANGLE_X:
+          field = &info->rxang;
+          break;
+
+        case PROP_ROTATION_ANGLE_Y:
+          field = &info->ryang;
+          break;
+
+        default:
+          field = &info->rzang;
+          break;
+        }
+
+      if (*field == value)
+        return TRUE;
+
+      clutter_actor_invalidate_transform (self);
+      *field = value;
+      break;
+
+    default:
+      return FALSE;
+    }
+
+  /* the transformation properties only change the way the actor is
+   * painted; when called by the animation engine the redraw will be
+   * coalesced with the ones queued by the other animated properties
+   */
+  g_object_notify_by_pspec (G_OBJECT (self), pspec);
+
+  clutter_actor_queue_redraw (self);
+
+  return TRUE;
 }
 
-/**
- * clutter_actor_transform_stage_point:
- * @self: A #ClutterActor
- * @x: (in): x screen coordinate of the point to unproject
- * @y: (in): y screen coordinate of the point to unproject
- * @x_out: (out): return location for the unprojected x coordinance
- * @y_out: (out): return location for the unprojected y coordinance
- *
- * This function translates screen coordinates (@x, @y) to
- * coordinates relative to the actor. For example, it can be used to translate
- * screen events from global screen coordinates into actor-local coordinates.
- *
- * The conversion can fail, notably if the transform stack results in the
- * actor being projected on the screen as a mere line.
- *
- * The conversion should not be expected to be pixel-perfect due to the
- * nature of the operation. In general the error grows when the skewing
- * of the actor rectangle on screen increases.
- *
- * <note><para>This function can be computationally intensive.</para></note>
- *
- * <note><para>This function only works when the allocation is up-to-date,
- * i.e. inside of paint().</para></note>
- *
- * Return value: %TRUE if conversion was successful.
- *
- * Since: 0.6
- */
-gboolean
-clutter_actor_transform_stage_point (ClutterActor *self,
-				     gfloat        x,
-				     gfloat        y,
-				     gfloat       *x_out,
-				     gfloat       *y_out)
+static void
+clutter_animatable_iface_init (ClutterAnimatableIface *iface)
+{
+  iface->animate_property = clutter_actor_animate_property;
+  iface->find_property = clutter_actor_find_property;
+  iface->get_initial_state = clutter_actor_get_initial_state;
+  iface->set_final_state = clutter_actor_set_final_state;
+  iface->set_double_property = clutter_actor_set_double_property;
+}
+
+/* computes the mapping from the stage to the allocation of @self,
+ * the inverse of the projection of the allocation on the stage, in
+ * @ST; returns %FALSE if the allocation is projected as a line */
+static gboolean
+clutter_actor_compute_stage_point_inverse (ClutterActor *self,
+                                           float         ST[3][3])
 {
   ClutterVertex v[4];
-  float ST[3][3];
   float RQ[3][3];
-  int du, dv, xi, yi;
+  int du, dv;
   float px, py;
-  float xf, yf, wf, det;
-  ClutterActorPrivate *priv;
-
-  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), FALSE);
-
-  priv = self->priv;
+  float det;
+  ClutterActorPrivate *priv = self->priv;
 
   /* This implementation is based on the quad -> quad projection algorithm
    * described by Paul Heckbert in:
@@ -9662,6 +13217,95 @@ clutter_actor_transform_stage_point (ClutterActor *self,
   if (!det)
     return FALSE;
 
+#undef UX2FP
+#undef DET2FP
+
+  return TRUE;
+}
+
+/**
+ * clutter_actor_transform_stage_point:
+ * @self: A #ClutterActor
+ * @x: (in): x screen coordinate of the point to unproject
+ * @y: (in): y screen coordinate of the point to unproject
+ * @x_out: (out): return location for the unprojected x coordinance
+ * @y_out: (out): return location for the unprojected y coordinance
+ *
+ * This function translates screen coordinates (@x, @y) to
+ * coordinates relative to the actor. For example, it can be used to translate
+ * screen events from global screen coordinates into actor-local coordinates.
+ *
+ * The conversion can fail, notably if the transform stack results in the
+ * actor being projected on the screen as a mere line.
+ *
+ * The conversion should not be expected to be pixel-perfect due to the
+ * nature of the operation. In general the error grows when the skewing
+ * of the actor rectangle on screen increases.
+ *
+ * <note><para>This function can be computationally intensive the first
+ * time it is called for an actor; the result is then reused until the
+ * actor, one of its ancestors or the stage projection change.</para></note>
+ *
+ * <note><para>This function only works when the allocation is up-to-date,
+ * i.e. inside of paint().</para></note>
+ *
+ * Return value: %TRUE if conversion was successful.
+ *
+ * Since: 0.6
+ */
+gboolean
+clutter_actor_transform_stage_point (ClutterActor *self,
+				     gfloat        x,
+				     gfloat        y,
+				     gfloat       *x_out,
+				     gfloat       *y_out)
+{
+  float ST[3][3];
+  int xi, yi;
+  float xf, yf, wf;
+  ClutterActorPrivate *priv;
+  ClutterActor *stage;
+  ExtraInfo *info;
+
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), FALSE);
+
+  priv = self->priv;
+
+  /* the mapping only changes with the transformation of the actor
+   * relative to the stage, its allocation size and the projection of
+   * the stage, so the event handlers converting every motion event
+   * of a drag only compute it once */
+  stage = _clutter_actor_get_stage_internal (self);
+  info = clutter_actor_get_extra_info (self);
+
+  if (priv->stage_point_valid &&
+      !priv->needs_allocation &&
+      stage != NULL &&
+      info->stage_point_serial ==
+        _clutter_stage_get_projection_serial (CLUTTER_STAGE (stage)) &&
+      info->stage_point_width == priv->allocation.x2 - priv->allocation.x1 &&
+      info->stage_point_height == priv->allocation.y2 - priv->allocation.y1)
+    {
+      memcpy (ST, info->stage_point_inverse, sizeof (ST));
+    }
+  else
+    {
+      if (!clutter_actor_compute_stage_point_inverse (self, ST))
+        return FALSE;
+
+      /* the cache is cleared with the one of the stage-relative
+       * transformation, so it can only be kept if that is valid */
+      if (stage != NULL && _clutter_actor_get_stage_transform (self) != NULL)
+        {
+          memcpy (info->stage_point_inverse, ST, sizeof (ST));
+          info->stage_point_width = priv->allocation.x2 - priv->allocation.x1;
+          info->stage_point_height = priv->allocation.y2 - priv->allocation.y1;
+          info->stage_point_serial =
+            _clutter_stage_get_projection_serial (CLUTTER_STAGE (stage));
+          priv->stage_point_valid = TRUE;
+        }
+    }
+
   /*
    * Now transform our point with the ST matrix; the notional w
    * coordinate is 1, hence the last part is simply added.
@@ -9679,9 +13323,6 @@ clutter_actor_transform_stage_point (ClutterActor *self,
   if (y_out)
     *y_out = yf / wf;
 
-#undef UX2FP
-#undef DET2FP
-
   return TRUE;
 }
 
@@ -10205,13 +13846,13 @@ clutter_actor_set_shader_param_int (ClutterActor *self,
 gboolean
 clutter_actor_is_rotated (ClutterActor *self)
 {
-  ClutterActorPrivate *priv;
+  const TransformInfo *info;
 
   g_return_val_if_fail (CLUTTER_IS_ACTOR (self), FALSE);
 
-  priv = self->priv;
+  info = clutter_actor_get_transform_info_or_defaults (self);
 
-  if (priv->rxang || priv->ryang || priv->rzang)
+  if (info->rxang || info->ryang || info->rzang)
     return TRUE;
 
   return FALSE;
@@ -10230,13 +13871,13 @@ clutter_actor_is_rotated (ClutterActor *self)
 gboolean
 clutter_actor_is_scaled (ClutterActor *self)
 {
-  ClutterActorPrivate *priv;
+  const TransformInfo *info;
 
   g_return_val_if_fail (CLUTTER_IS_ACTOR (self), FALSE);
 
-  priv = self->priv;
+  info = clutter_actor_get_transform_info_or_defaults (self);
 
-  if (priv->scale_x != 1.0 || priv->scale_y != 1.0)
+  if (info->scale_x != 1.0 || info->scale_y != 1.0)
     return TRUE;
 
   return FALSE;
@@ -10463,6 +14104,7 @@ clutter_actor_allocate_align_fill (ClutterActor           *self,
                                    gboolean                y_fill,
                                    ClutterAllocationFlags  flags)
 {
+  const ExtraInfo *extra;
   ClutterActorPrivate *priv;
   ClutterActorBox allocation = { 0, };
   gfloat x_offset, y_offset;
@@ -10476,6 +14118,8 @@ clutter_actor_allocate_align_fill (ClutterActor           *self,
 
   priv = self->priv;
 
+  extra = clutter_actor_get_extra_info_or_defaults (self);
+
   clutter_actor_box_get_origin (box, &x_offset, &y_offset);
   clutter_actor_box_get_size (box, &available_width, &available_height);
 
@@ -10545,7 +14189,7 @@ clutter_actor_allocate_align_fill (ClutterActor           *self,
     }
 
   /* invert the horizontal alignment for RTL languages */
-  if (priv->text_direction == CLUTTER_TEXT_DIRECTION_RTL)
+  if (extra->text_direction == CLUTTER_TEXT_DIRECTION_RTL)
     x_align = 1.0 - x_align;
 
   if (!x_fill)
@@ -10613,19 +14257,19 @@ clutter_actor_grab_key_focus (ClutterActor *self)
 PangoContext *
 clutter_actor_get_pango_context (ClutterActor *self)
 {
-  ClutterActorPrivate *priv;
+  ExtraInfo *extra;
 
   g_return_val_if_fail (CLUTTER_IS_ACTOR (self), NULL);
 
-  priv = self->priv;
+  extra = clutter_actor_get_extra_info (self);
 
-  if (priv->pango_context != NULL)
-    return priv->pango_context;
+  if (extra->pango_context != NULL)
+    return extra->pango_context;
 
-  priv->pango_context = _clutter_context_get_pango_context ();
-  g_object_ref (priv->pango_context);
+  extra->pango_context = _clutter_context_get_pango_context ();
+  g_object_ref (extra->pango_context);
 
-  return priv->pango_context;
+  return extra->pango_context;
 }
 
 /**
@@ -10699,7 +14343,12 @@ _clutter_actor_set_opacity_override (ClutterActor *self,
 {
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
+  if (self->priv->opacity_override == opacity)
+    return;
+
   self->priv->opacity_override = opacity;
+
+  clutter_actor_invalidate_paint_opacity (self);
 }
 
 gint
@@ -10797,7 +14446,7 @@ clutter_anchor_coord_set_units (AnchorCoord *coord,
 }
 
 static ClutterGravity
-clutter_anchor_coord_get_gravity (AnchorCoord *coord)
+clutter_anchor_coord_get_gravity (const AnchorCoord *coord)
 {
   if (coord->is_fractional)
     {
@@ -10976,7 +14625,10 @@ clutter_actor_set_flags (ClutterActor      *self,
   visible_set  = ((self->flags & CLUTTER_ACTOR_VISIBLE)  != 0);
 
   if (reactive_set != was_reactive_set)
-    g_object_notify_by_pspec (obj, obj_props[PROP_REACTIVE]);
+    {
+      clutter_actor_sync_reactive (self);
+      g_object_notify_by_pspec (obj, obj_props[PROP_REACTIVE]);
+    }
 
   if (realized_set != was_realized_set)
     g_object_notify_by_pspec (obj, obj_props[PROP_REALIZED]);
@@ -11036,7 +14688,10 @@ clutter_actor_unset_flags (ClutterActor      *self,
   visible_set  = ((self->flags & CLUTTER_ACTOR_VISIBLE)  != 0);
 
   if (reactive_set != was_reactive_set)
-    g_object_notify_by_pspec (obj, obj_props[PROP_REACTIVE]);
+    {
+      clutter_actor_sync_reactive (self);
+      g_object_notify_by_pspec (obj, obj_props[PROP_REACTIVE]);
+    }
 
   if (realized_set != was_realized_set)
     g_object_notify_by_pspec (obj, obj_props[PROP_REALIZED]);
@@ -11135,16 +14790,16 @@ void
 clutter_actor_set_text_direction (ClutterActor         *self,
                                   ClutterTextDirection  text_dir)
 {
-  ClutterActorPrivate *priv;
+  ExtraInfo *extra;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
   g_return_if_fail (text_dir != CLUTTER_TEXT_DIRECTION_DEFAULT);
 
-  priv = self->priv;
+  extra = clutter_actor_get_extra_info (self);
 
-  if (priv->text_direction != text_dir)
+  if (extra->text_direction != text_dir)
     {
-      priv->text_direction = text_dir;
+      extra->text_direction = text_dir;
 
       /* we need to emit the notify::text-direction first, so that
        * the sub-classes can catch that and do specific handling of
@@ -11198,18 +14853,18 @@ _clutter_actor_set_has_pointer (ClutterActor *self,
 ClutterTextDirection
 clutter_actor_get_text_direction (ClutterActor *self)
 {
-  ClutterActorPrivate *priv;
+  const ExtraInfo *extra;
 
   g_return_val_if_fail (CLUTTER_IS_ACTOR (self),
                         CLUTTER_TEXT_DIRECTION_LTR);
 
-  priv = self->priv;
+  extra = clutter_actor_get_extra_info_or_defaults (self);
 
   /* if no direction has been set yet use the default */
-  if (priv->text_direction == CLUTTER_TEXT_DIRECTION_DEFAULT)
-    priv->text_direction = clutter_get_default_text_direction ();
+  if (extra->text_direction == CLUTTER_TEXT_DIRECTION_DEFAULT)
+    return clutter_get_default_text_direction ();
 
-  return priv->text_direction;
+  return extra->text_direction;
 }
 
 /**
@@ -11335,6 +14990,28 @@ _clutter_actor_set_queue_redraw_clip (ClutterActor *self,
   self->priv->oob_queue_redraw_clip = clip;
 }
 
+/*< private >
+ * _clutter_actor_get_last_paint_volume:
+ * @self: a #ClutterActor
+ *
+ * Retrieves the volume covered by @self the last time it was painted,
+ * in eye coordinates. When @self queues a redraw, this is the area
+ * that has to be redrawn to clear its previous contents.
+ *
+ * Return value: the last paint volume of @self, or %NULL if it is
+ *   not known
+ */
+ClutterPaintVolume *
+_clutter_actor_get_last_paint_volume (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  if (!priv->last_paint_volume_valid)
+    return NULL;
+
+  return &priv->last_paint_volume;
+}
+
 /**
  * clutter_actor_has_allocation:
  * @self: a #ClutterActor
@@ -11387,20 +15064,20 @@ void
 clutter_actor_add_action (ClutterActor  *self,
                           ClutterAction *action)
 {
-  ClutterActorPrivate *priv;
+  ExtraInfo *extra;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
   g_return_if_fail (CLUTTER_IS_ACTION (action));
 
-  priv = self->priv;
+  extra = clutter_actor_get_extra_info (self);
 
-  if (priv->actions == NULL)
+  if (extra->actions == NULL)
     {
-      priv->actions = g_object_new (CLUTTER_TYPE_META_GROUP, NULL);
-      priv->actions->actor = self;
+      extra->actions = g_object_new (CLUTTER_TYPE_META_GROUP, NULL);
+      extra->actions->actor = self;
     }
 
-  _clutter_meta_group_add_meta (priv->actions, CLUTTER_ACTOR_META (action));
+  _clutter_meta_group_add_meta (extra->actions, CLUTTER_ACTOR_META (action));
 
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_ACTIONS]);
 }
@@ -11451,17 +15128,17 @@ void
 clutter_actor_remove_action (ClutterActor  *self,
                              ClutterAction *action)
 {
-  ClutterActorPrivate *priv;
+  const ExtraInfo *extra;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
   g_return_if_fail (CLUTTER_IS_ACTION (action));
 
-  priv = self->priv;
+  extra = clutter_actor_get_extra_info_or_defaults (self);
 
-  if (priv->actions == NULL)
+  if (extra->actions == NULL)
     return;
 
-  _clutter_meta_group_remove_meta (priv->actions, CLUTTER_ACTOR_META (action));
+  _clutter_meta_group_remove_meta (extra->actions, CLUTTER_ACTOR_META (action));
 
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_ACTIONS]);
 }
@@ -11480,22 +15157,22 @@ void
 clutter_actor_remove_action_by_name (ClutterActor *self,
                                      const gchar  *name)
 {
-  ClutterActorPrivate *priv;
+  const ExtraInfo *extra;
   ClutterActorMeta *meta;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
   g_return_if_fail (name != NULL);
 
-  priv = self->priv;
+  extra = clutter_actor_get_extra_info_or_defaults (self);
 
-  if (priv->actions == NULL)
+  if (extra->actions == NULL)
     return;
 
-  meta = _clutter_meta_group_get_meta (priv->actions, name);
+  meta = _clutter_meta_group_get_meta (extra->actions, name);
   if (meta == NULL)
     return;
 
-  _clutter_meta_group_remove_meta (priv->actions, meta);
+  _clutter_meta_group_remove_meta (extra->actions, meta);
 
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_ACTIONS]);
 }
@@ -11516,12 +15193,16 @@ clutter_actor_remove_action_by_name (ClutterActor *self,
 GList *
 clutter_actor_get_actions (ClutterActor *self)
 {
+  const ExtraInfo *extra;
+
   g_return_val_if_fail (CLUTTER_IS_ACTOR (self), NULL);
 
-  if (self->priv->actions == NULL)
+  extra = clutter_actor_get_extra_info_or_defaults (self);
+
+  if (extra->actions == NULL)
     return NULL;
 
-  return _clutter_meta_group_get_metas_no_internal (self->priv->actions);
+  return _clutter_meta_group_get_metas_no_internal (extra->actions);
 }
 
 /**
@@ -11542,13 +15223,17 @@ ClutterAction *
 clutter_actor_get_action (ClutterActor *self,
                           const gchar  *name)
 {
+  const ExtraInfo *extra;
+
   g_return_val_if_fail (CLUTTER_IS_ACTOR (self), NULL);
   g_return_val_if_fail (name != NULL, NULL);
 
-  if (self->priv->actions == NULL)
+  extra = clutter_actor_get_extra_info_or_defaults (self);
+
+  if (extra->actions == NULL)
     return NULL;
 
-  return CLUTTER_ACTION (_clutter_meta_group_get_meta (self->priv->actions, name));
+  return CLUTTER_ACTION (_clutter_meta_group_get_meta (extra->actions, name));
 }
 
 /**
@@ -11562,12 +15247,16 @@ clutter_actor_get_action (ClutterActor *self,
 void
 clutter_actor_clear_actions (ClutterActor *self)
 {
+  const ExtraInfo *extra;
+
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  if (self->priv->actions == NULL)
+  extra = clutter_actor_get_extra_info_or_defaults (self);
+
+  if (extra->actions == NULL)
     return;
 
-  _clutter_meta_group_clear_metas_no_internal (self->priv->actions);
+  _clutter_meta_group_clear_metas_no_internal (extra->actions);
 }
 
 /**
@@ -11588,20 +15277,20 @@ void
 clutter_actor_add_constraint (ClutterActor      *self,
                               ClutterConstraint *constraint)
 {
-  ClutterActorPrivate *priv;
+  ExtraInfo *extra;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
   g_return_if_fail (CLUTTER_IS_CONSTRAINT (constraint));
 
-  priv = self->priv;
+  extra = clutter_actor_get_extra_info (self);
 
-  if (priv->constraints == NULL)
+  if (extra->constraints == NULL)
     {
-      priv->constraints = g_object_new (CLUTTER_TYPE_META_GROUP, NULL);
-      priv->constraints->actor = self;
+      extra->constraints = g_object_new (CLUTTER_TYPE_META_GROUP, NULL);
+      extra->constraints->actor = self;
     }
 
-  _clutter_meta_group_add_meta (priv->constraints,
+  _clutter_meta_group_add_meta (extra->constraints,
                                 CLUTTER_ACTOR_META (constraint));
   clutter_actor_queue_relayout (self);
 
@@ -11654,17 +15343,17 @@ void
 clutter_actor_remove_constraint (ClutterActor      *self,
                                  ClutterConstraint *constraint)
 {
-  ClutterActorPrivate *priv;
+  const ExtraInfo *extra;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
   g_return_if_fail (CLUTTER_IS_CONSTRAINT (constraint));
 
-  priv = self->priv;
+  extra = clutter_actor_get_extra_info_or_defaults (self);
 
-  if (priv->constraints == NULL)
+  if (extra->constraints == NULL)
     return;
 
-  _clutter_meta_group_remove_meta (priv->constraints,
+  _clutter_meta_group_remove_meta (extra->constraints,
                                    CLUTTER_ACTOR_META (constraint));
   clutter_actor_queue_relayout (self);
 
@@ -11685,22 +15374,22 @@ void
 clutter_actor_remove_constraint_by_name (ClutterActor *self,
                                          const gchar  *name)
 {
-  ClutterActorPrivate *priv;
+  const ExtraInfo *extra;
   ClutterActorMeta *meta;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
   g_return_if_fail (name != NULL);
 
-  priv = self->priv;
+  extra = clutter_actor_get_extra_info_or_defaults (self);
 
-  if (priv->constraints == NULL)
+  if (extra->constraints == NULL)
     return;
 
-  meta = _clutter_meta_group_get_meta (priv->constraints, name);
+  meta = _clutter_meta_group_get_meta (extra->constraints, name);
   if (meta == NULL)
     return;
 
-  _clutter_meta_group_remove_meta (priv->constraints, meta);
+  _clutter_meta_group_remove_meta (extra->constraints, meta);
   clutter_actor_queue_relayout (self);
 }
 
@@ -11720,12 +15409,16 @@ clutter_actor_remove_constraint_by_name (ClutterActor *self,
 GList *
 clutter_actor_get_constraints (ClutterActor *self)
 {
+  const ExtraInfo *extra;
+
   g_return_val_if_fail (CLUTTER_IS_ACTOR (self), NULL);
 
-  if (self->priv->constraints == NULL)
+  extra = clutter_actor_get_extra_info_or_defaults (self);
+
+  if (extra->constraints == NULL)
     return NULL;
 
-  return _clutter_meta_group_get_metas_no_internal (self->priv->constraints);
+  return _clutter_meta_group_get_metas_no_internal (extra->constraints);
 }
 
 /**
@@ -11746,13 +15439,17 @@ ClutterConstraint *
 clutter_actor_get_constraint (ClutterActor *self,
                               const gchar  *name)
 {
+  const ExtraInfo *extra;
+
   g_return_val_if_fail (CLUTTER_IS_ACTOR (self), NULL);
   g_return_val_if_fail (name != NULL, NULL);
 
-  if (self->priv->constraints == NULL)
+  extra = clutter_actor_get_extra_info_or_defaults (self);
+
+  if (extra->constraints == NULL)
     return NULL;
 
-  return CLUTTER_CONSTRAINT (_clutter_meta_group_get_meta (self->priv->constraints, name));
+  return CLUTTER_CONSTRAINT (_clutter_meta_group_get_meta (extra->constraints, name));
 }
 
 /**
@@ -11766,12 +15463,16 @@ clutter_actor_get_constraint (ClutterActor *self,
 void
 clutter_actor_clear_constraints (ClutterActor *self)
 {
+  const ExtraInfo *extra;
+
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  if (self->priv->constraints == NULL)
+  extra = clutter_actor_get_extra_info_or_defaults (self);
+
+  if (extra->constraints == NULL)
     return;
 
-  _clutter_meta_group_clear_metas_no_internal (self->priv->constraints);
+  _clutter_meta_group_clear_metas_no_internal (extra->constraints);
 
   clutter_actor_queue_relayout (self);
 }
@@ -11923,22 +15624,22 @@ void
 clutter_actor_remove_effect_by_name (ClutterActor *self,
                                      const gchar  *name)
 {
-  ClutterActorPrivate *priv;
+  const ExtraInfo *extra;
   ClutterActorMeta *meta;
 
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
   g_return_if_fail (name != NULL);
 
-  priv = self->priv;
+  extra = clutter_actor_get_extra_info_or_defaults (self);
 
-  if (priv->effects == NULL)
+  if (extra->effects == NULL)
     return;
 
-  meta = _clutter_meta_group_get_meta (priv->effects, name);
+  meta = _clutter_meta_group_get_meta (extra->effects, name);
   if (meta == NULL)
     return;
 
-  _clutter_meta_group_remove_meta (priv->effects, meta);
+  _clutter_meta_group_remove_meta (extra->effects, meta);
 }
 
 /**
@@ -11957,16 +15658,16 @@ clutter_actor_remove_effect_by_name (ClutterActor *self,
 GList *
 clutter_actor_get_effects (ClutterActor *self)
 {
-  ClutterActorPrivate *priv;
+  const ExtraInfo *extra;
 
   g_return_val_if_fail (CLUTTER_IS_ACTOR (self), NULL);
 
-  priv = self->priv;
+  extra = clutter_actor_get_extra_info_or_defaults (self);
 
-  if (priv->effects == NULL)
+  if (extra->effects == NULL)
     return NULL;
 
-  return _clutter_meta_group_get_metas_no_internal (priv->effects);
+  return _clutter_meta_group_get_metas_no_internal (extra->effects);
 }
 
 /**
@@ -11987,13 +15688,17 @@ ClutterEffect *
 clutter_actor_get_effect (ClutterActor *self,
                           const gchar  *name)
 {
+  const ExtraInfo *extra;
+
   g_return_val_if_fail (CLUTTER_IS_ACTOR (self), NULL);
   g_return_val_if_fail (name != NULL, NULL);
 
-  if (self->priv->effects == NULL)
+  extra = clutter_actor_get_extra_info_or_defaults (self);
+
+  if (extra->effects == NULL)
     return NULL;
 
-  return CLUTTER_EFFECT (_clutter_meta_group_get_meta (self->priv->effects, name));
+  return CLUTTER_EFFECT (_clutter_meta_group_get_meta (extra->effects, name));
 }
 
 /**
@@ -12007,12 +15712,16 @@ clutter_actor_get_effect (ClutterActor *self,
 void
 clutter_actor_clear_effects (ClutterActor *self)
 {
+  const ExtraInfo *extra;
+
   g_return_if_fail (CLUTTER_IS_ACTOR (self));
 
-  if (self->priv->effects == NULL)
+  extra = clutter_actor_get_extra_info_or_defaults (self);
+
+  if (extra->effects == NULL)
     return;
 
-  _clutter_meta_group_clear_metas_no_internal (self->priv->effects);
+  _clutter_meta_group_clear_metas_no_internal (extra->effects);
 
   clutter_actor_queue_redraw (self);
 }
@@ -12045,8 +15754,11 @@ static gboolean
 _clutter_actor_get_paint_volume_real (ClutterActor *self,
                                       ClutterPaintVolume *pv)
 {
+  const ExtraInfo *extra;
   ClutterActorPrivate *priv = self->priv;
 
+  extra = clutter_actor_get_extra_info_or_defaults (self);
+
   /* Actors are only expected to report a valid paint volume
    * while they have a valid allocation. */
   if (G_UNLIKELY (priv->needs_allocation))
@@ -12109,7 +15821,7 @@ _clutter_actor_get_paint_volume_real (ClutterActor *self,
   /* since effects can modify the paint volume, we allow them to actually
    * do this by making get_paint_volume() "context sensitive"
    */
-  if (priv->effects != NULL)
+  if (extra->effects != NULL)
     {
       if (priv->current_effect != NULL)
         {
@@ -12118,7 +15830,7 @@ _clutter_actor_get_paint_volume_real (ClutterActor *self,
           /* if we are being called from within the paint sequence of
            * an actor, get the paint volume up to the current effect
            */
-          effects = _clutter_meta_group_peek_metas (priv->effects);
+          effects = _clutter_meta_group_peek_metas (extra->effects);
           for (l = effects;
                l != NULL || (l != NULL && l->data != priv->current_effect);
                l = l->next)
@@ -12139,7 +15851,7 @@ _clutter_actor_get_paint_volume_real (ClutterActor *self,
           const GList *effects, *l;
 
           /* otherwise, get the cumulative volume */
-          effects = _clutter_meta_group_peek_metas (priv->effects);
+          effects = _clutter_meta_group_peek_metas (extra->effects);
           for (l = effects; l != NULL; l = l->next)
             if (!_clutter_effect_get_paint_volume (l->data, pv))
               {
@@ -12261,8 +15973,9 @@ clutter_actor_get_transformed_paint_volume (ClutterActor *self,
   if (volume == NULL)
     return NULL;
 
+  /* the transformed volume is valid until the next frame */
   transformed_volume =
-    _clutter_stage_paint_volume_stack_allocate (CLUTTER_STAGE (stage));
+    _clutter_stage_frame_new (CLUTTER_STAGE (stage), ClutterPaintVolume, 1);
 
   _clutter_paint_volume_copy_static (volume, transformed_volume);
 
@@ -12339,6 +16052,55 @@ clutter_actor_has_overlaps (ClutterActor *self)
   return CLUTTER_ACTOR_GET_CLASS (self)->has_overlaps (self);
 }
 
+/**
+ * clutter_actor_notify_overlaps_changed:
+ * @self: A #ClutterActor
+ *
+ * Notifies Clutter that the value returned by the has_overlaps()
+ * virtual function of @self might have changed.
+ *
+ * Clutter only calls clutter_actor_has_overlaps() again, to decide
+ * whether @self should be redirected offscreen, after this function
+ * has been called or after the opacity or the offscreen redirect of
+ * the actor changed; sub-classes of #ClutterActor whose has_overlaps()
+ * implementation depends on their state should call this function
+ * every time that state changes.
+ *
+ * Since: 1.8
+ */
+void
+clutter_actor_notify_overlaps_changed (ClutterActor *self)
+{
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+
+  self->priv->flatten_valid = FALSE;
+
+  /* the actor might look different if it is semi-transparent */
+  clutter_actor_queue_redraw (self);
+}
+
+/**
+ * clutter_actor_is_opaque:
+ * @self: A #ClutterActor
+ *
+ * Checks whether the actor fills its whole allocation with opaque
+ * pixels when it is painted with full opacity. Clutter uses this to
+ * skip painting the actors that are completely hidden behind opaque
+ * actors. Custom actors can override this by implementing the
+ * is_opaque virtual; the default implementation returns %FALSE.
+ *
+ * Return value: %TRUE if the actor is opaque
+ *
+ * Since: 1.8
+ */
+gboolean
+clutter_actor_is_opaque (ClutterActor *self)
+{
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), FALSE);
+
+  return CLUTTER_ACTOR_GET_CLASS (self)->is_opaque (self);
+}
+
 gint
 _clutter_actor_get_n_children (ClutterActor *self)
 {
@@ -12503,3 +16265,202 @@ _clutter_actor_traverse (ClutterActor              *actor,
                                    0, /* start depth */
                                    user_data);
 }
+
+/*< private >
+ * _clutter_actor_get_visible_box:
+ * @self: a #ClutterActor
+ * @box: (out): return location for the visible box of @self
+ *
+ * Computes the bounding box, in the coordinates of @self, of the area
+ * of @self that can end up on the stage, given the clip of @self, the
+ * clips of its ancestors and the size of the stage.
+ *
+ * Return value: %TRUE if the visible box could be computed, and %FALSE
+ *   if @self is not on a stage or cannot be projected back from it
+ */
+gboolean
+_clutter_actor_get_visible_box (ClutterActor    *self,
+                                ClutterActorBox *box)
+{
+  ClutterActor *stage, *iter;
+
+  stage = _clutter_actor_get_stage_internal (self);
+  if (stage == NULL)
+    return FALSE;
+
+  box->x1 = box->y1 = 0;
+  box->x2 = self->priv->allocation.x2 - self->priv->allocation.x1;
+  box->y2 = self->priv->allocation.y2 - self->priv->allocation.y1;
+
+  for (iter = self; iter != NULL; iter = iter->priv->parent_actor)
+    {
+      ClutterActorPrivate *iter_priv = iter->priv;
+      ClutterVertex corners[4];
+      ClutterActorBox clip;
+      gint i;
+
+      if (iter != stage && iter_priv->has_clip)
+        {
+          clip.x1 = iter_priv->clip[0];
+          clip.y1 = iter_priv->clip[1];
+          clip.x2 = iter_priv->clip[0] + iter_priv->clip[2];
+          clip.y2 = iter_priv->clip[1] + iter_priv->clip[3];
+        }
+      else if (iter == stage || iter_priv->clip_to_allocation)
+        {
+          clip.x1 = clip.y1 = 0;
+          clip.x2 = iter_priv->allocation.x2 - iter_priv->allocation.x1;
+          clip.y2 = iter_priv->allocation.y2 - iter_priv->allocation.y1;
+        }
+      else
+        continue;
+
+      if (iter != self)
+        {
+          gfloat x_1 = 0, y_1 = 0, x_2 = 0, y_2 = 0;
+
+          corners[0].x = clip.x1; corners[0].y = clip.y1;
+          corners[1].x = clip.x2; corners[1].y = clip.y1;
+          corners[2].x = clip.x1; corners[2].y = clip.y2;
+          corners[3].x = clip.x2; corners[3].y = clip.y2;
+
+          for (i = 0; i < 4; i++)
+            {
+              ClutterVertex stage_pos;
+              gfloat x, y;
+
+              corners[i].z = 0;
+
+              clutter_actor_apply_transform_to_point (iter,
+                                                      &corners[i],
+                                                      &stage_pos);
+
+              if (!clutter_actor_transform_stage_point (self,
+                                                        stage_pos.x,
+                                                        stage_pos.y,
+                                                        &x, &y))
+                return FALSE;
+
+              if (i == 0 || x < x_1) x_1 = x;
+              if (i == 0 || x > x_2) x_2 = x;
+              if (i == 0 || y < y_1) y_1 = y;
+              if (i == 0 || y > y_2) y_2 = y;
+            }
+
+          clip.x1 = x_1;
+          clip.y1 = y_1;
+          clip.x2 = x_2;
+          clip.y2 = y_2;
+        }
+
+      box->x1 = MAX (box->x1, clip.x1);
+      box->y1 = MAX (box->y1, clip.y1);
+      box->x2 = MIN (box->x2, clip.x2);
+      box->y2 = MIN (box->y2, clip.y2);
+    }
+
+  /* an empty intersection is still a valid result */
+  if (box->x2 < box->x1)
+    box->x2 = box->x1;
+
+  if (box->y2 < box->y1)
+    box->y2 = box->y1;
+
+  return TRUE;
+}
+
+/*< private >
+ * _clutter_actor_get_child_meta:
+ * @self: a #ClutterActor
+ *
+ * Retrieves the #ClutterChildMeta set using _clutter_actor_set_child_meta()
+ *
+ * Return value: (transfer none): the #ClutterChildMeta, or %NULL
+ */
+ClutterChildMeta *
+_clutter_actor_get_child_meta (ClutterActor *self)
+{
+  return self->priv->child_meta;
+}
+
+/*< private >
+ * _clutter_actor_set_child_meta:
+ * @self: a #ClutterActor
+ * @meta: (transfer full) (allow-none): a #ClutterChildMeta, or %NULL
+ *
+ * Stores the #ClutterChildMeta that the parent container of @self
+ * attaches to it, releasing the previous one. The actor takes
+ * ownership of @meta
+ */
+void
+_clutter_actor_set_child_meta (ClutterActor     *self,
+                               ClutterChildMeta *meta)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterChildMeta *old_meta = priv->child_meta;
+
+  priv->child_meta = meta;
+
+  if (old_meta != NULL)
+    g_object_unref (old_meta);
+}
+
+/*< private >
+ * _clutter_actor_get_layout_meta:
+ * @self: a #ClutterActor
+ *
+ * Retrieves the #ClutterLayoutMeta set using _clutter_actor_set_layout_meta()
+ *
+ * Return value: (transfer none): the #ClutterLayoutMeta, or %NULL
+ */
+ClutterLayoutMeta *
+_clutter_actor_get_layout_meta (ClutterActor *self)
+{
+  return self->priv->layout_meta;
+}
+
+/*< private >
+ * _clutter_actor_set_layout_meta:
+ * @self: a #ClutterActor
+ * @meta: (transfer full) (allow-none): a #ClutterLayoutMeta, or %NULL
+ *
+ * Stores the #ClutterLayoutMeta that the layout manager of the parent
+ * container of @self attaches to it, releasing the previous one. The
+ * actor takes ownership of @meta
+ */
+void
+_clutter_actor_set_layout_meta (ClutterActor      *self,
+                                ClutterLayoutMeta *meta)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterLayoutMeta *old_meta = priv->layout_meta;
+
+  priv->layout_meta = meta;
+
+  if (old_meta != NULL)
+    g_object_unref (old_meta);
+}
+
+/*< private >
+ * _clutter_actor_get_depth_changed_child:
+ * @self: a #ClutterActor
+ *
+ * Retrieves the child of @self whose depth changed, if called from
+ * the #ClutterContainerIface.sort_depth_order() implementation of
+ * @self while clutter_actor_set_depth() is sorting the children.
+ *
+ * Containers that keep their children sorted can use it to restack
+ * a single child instead of sorting all of them.
+ *
+ * Return value: (transfer none): the child, or %NULL if the reason
+ *   for sorting the children is not known
+ */
+ClutterActor *
+_clutter_actor_get_depth_changed_child (ClutterActor *self)
+{
+  if (depth_changed_child != NULL &&
+      depth_changed_child->priv->parent_actor == self)
+    return depth_changed_child;
+
+  return NULL;
+}
@@ -240,7 +240,13 @@ struct _ClutterActor
  * @has_overlaps: virtual function for
  *   sub-classes to advertise whether they need an offscreen redirect
  *   to get the correct opacity. See
- *   clutter_actor_set_offscreen_redirect() for details.
+ *   clutter_actor_set_offscreen_redirect() for details. Sub-classes
+ *   must call clutter_actor_notify_overlaps_changed() when the
+ *   returned value changes.
+ * @is_opaque: virtual function for sub-classes to advertise whether
+ *   they fill their whole allocation with opaque pixels when painted
+ *   with full opacity. See clutter_actor_is_opaque() for details.
+ *   Since 1.8
  *
  * Base class for actors.
  */
@@ -320,9 +326,11 @@ struct _ClutterActorClass
 
   gboolean (* has_overlaps)         (ClutterActor         *self);
 
+  gboolean (* is_opaque)            (ClutterActor         *self);
+
   /*< private >*/
   /* padding for future expansion */
-  gpointer _padding_dummy[28];
+  gpointer _padding_dummy[27];
 };
 
 GType                 clutter_actor_get_type                  (void) G_GNUC_CONST;
@@ -347,6 +355,7 @@ void                  clutter_actor_queue_redraw              (ClutterActor
 
 void                  clutter_actor_queue_relayout            (ClutterActor          *self);
 void                  clutter_actor_destroy                   (ClutterActor          *self);
+void                  clutter_actor_destroy_deferred          (ClutterActor          *self);
 
 /* size negotiation */
 void                  clutter_actor_set_request_mode          (ClutterActor          *self,
@@ -500,6 +509,12 @@ void                  clutter_actor_lower_bottom              (ClutterActor
 void                  clutter_actor_set_depth                 (ClutterActor          *self,
                                                                gfloat                 depth);
 gfloat                clutter_actor_get_depth                 (ClutterActor          *self);
+void                  clutter_actor_set_translation           (ClutterActor          *self,
+                                                               gfloat                 translate_x,
+                                                               gfloat                 translate_y);
+void                  clutter_actor_get_translation           (ClutterActor          *self,
+                                                               gfloat                *translate_x,
+                                                               gfloat                *translate_y);
 
 void                  clutter_actor_set_scale                 (ClutterActor          *self,
                                                                gdouble                scale_x,
@@ -619,6 +634,8 @@ gboolean             clutter_actor_get_paint_box      (ClutterActor         *sel
                                                        ClutterActorBox      *box);
 
 gboolean             clutter_actor_has_overlaps       (ClutterActor         *self);
+void                 clutter_actor_notify_overlaps_changed (ClutterActor    *self);
+gboolean             clutter_actor_is_opaque          (ClutterActor         *self);
 
 G_END_DECLS
 
@@ -40,6 +40,7 @@
 
 #include "clutter-align-constraint.h"
 
+#include "clutter-actor-private.h"
 #include "clutter-constraint.h"
 #include "clutter-debug.h"
 #include "clutter-enum-types.h"
@@ -59,6 +60,13 @@ struct _ClutterAlignConstraint
   ClutterActor *source;
   ClutterAlignAxis align_axis;
   gfloat factor;
+
+  /* the result of the last evaluation, valid while the allocation of
+   * the source has the same serial and the constrained actor gets the
+   * same allocation */
+  guint source_serial;
+  ClutterActorBox last_box;
+  ClutterActorBox last_result;
 };
 
 struct _ClutterAlignConstraintClass
@@ -89,8 +97,18 @@ source_position_changed (ClutterActor           *actor,
                          ClutterAllocationFlags  flags,
                          ClutterAlignConstraint *align)
 {
-  if (align->actor != NULL)
-    clutter_actor_queue_relayout (align->actor);
+  ClutterActor *stage;
+
+  if (align->actor == NULL)
+    return;
+
+  /* the stage applies the constraint again once the source has been
+   * allocated, so there is no need for another relayout */
+  stage = clutter_actor_get_stage (align->actor);
+  if (stage != NULL && CLUTTER_ACTOR_IN_RELAYOUT (stage))
+    return;
+
+  clutter_actor_queue_relayout (align->actor);
 }
 
 static void
@@ -123,10 +141,23 @@ clutter_align_constraint_update_allocation (ClutterConstraint *constraint,
   gfloat source_width, source_height;
   gfloat actor_width, actor_height;
   gfloat source_x, source_y;
+  ClutterActorBox box;
+  guint serial;
 
   if (align->source == NULL)
     return;
 
+  serial = _clutter_actor_get_allocation_serial (align->source);
+  if (serial != 0 &&
+      serial == align->source_serial &&
+      clutter_actor_box_equal (allocation, &align->last_box))
+    {
+      *allocation = align->last_result;
+      return;
+    }
+
+  box = *allocation;
+
   clutter_actor_get_position (align->source, &source_x, &source_y);
   clutter_actor_get_size (align->source, &source_width, &source_height);
 
@@ -152,6 +183,10 @@ clutter_align_constraint_update_allocation (ClutterConstraint *constraint,
       g_assert_not_reached ();
       break;
     }
+
+  align->source_serial = serial;
+  align->last_box = box;
+  align->last_result = *allocation;
 }
 
 static void
@@ -366,6 +401,8 @@ clutter_align_constraint_set_source (ClutterAlignConstraint *align,
     }
 
   align->source = source;
+  align->source_serial = 0;
+
   if (align->source != NULL)
     {
       g_signal_connect (align->source, "allocation-changed",
@@ -420,6 +457,7 @@ clutter_align_constraint_set_align_axis (ClutterAlignConstraint *align,
     return;
 
   align->align_axis = axis;
+  align->source_serial = 0;
 
   if (align->actor != NULL)
     clutter_actor_queue_relayout (align->actor);
@@ -472,6 +510,7 @@ clutter_align_constraint_set_factor (ClutterAlignConstraint *align,
   g_return_if_fail (CLUTTER_IS_ALIGN_CONSTRAINT (align));
 
   align->factor = CLAMP (factor, 0.0, 1.0);
+  align->source_serial = 0;
 
   if (align->actor != NULL)
     clutter_actor_queue_relayout (align->actor);
@@ -116,6 +116,9 @@
 
 static void clutter_scriptable_iface_init (ClutterScriptableIface *iface);
 
+static inline gdouble clutter_alpha_compute_mode (gulong  mode,
+                                                  gdouble progress);
+
 G_DEFINE_TYPE_WITH_CODE (ClutterAlpha,
                          clutter_alpha,
                          G_TYPE_INITIALLY_UNOWNED,
@@ -415,7 +418,16 @@ clutter_alpha_get_alpha (ClutterAlpha *alpha)
 
   priv = alpha->priv;
 
-  if (G_LIKELY (priv->closure))
+  if (priv->mode > CLUTTER_CUSTOM_MODE && priv->mode < CLUTTER_ANIMATION_LAST)
+    {
+      if (priv->timeline != NULL)
+        {
+          gdouble progress = clutter_timeline_get_progress (priv->timeline);
+
+          retval = clutter_alpha_compute_mode (priv->mode, progress);
+        }
+    }
+  else if (G_LIKELY (priv->closure))
     {
       GValue params = { 0, };
       GValue result_value = { 0, };
@@ -700,42 +712,27 @@ clutter_alpha_get_mode (ClutterAlpha *alpha)
 }
 
 static gdouble
-clutter_linear (ClutterAlpha *alpha,
-                gpointer      dummy G_GNUC_UNUSED)
+clutter_linear (gdouble p)
 {
-  ClutterTimeline *timeline = alpha->priv->timeline;
-
-  return clutter_timeline_get_progress (timeline);
+  return p;
 }
 
 static gdouble
-clutter_ease_in_quad (ClutterAlpha *alpha,
-                      gpointer      dummy G_GNUC_UNUSED)
+clutter_ease_in_quad (gdouble p)
 {
-  ClutterTimeline *timeline = alpha->priv->timeline;
-  gdouble progress = clutter_timeline_get_progress (timeline);
-
-  return progress * progress;
+  return p * p;
 }
 
 static gdouble
-clutter_ease_out_quad (ClutterAlpha *alpha,
-                       gpointer      dummy G_GNUC_UNUSED)
+clutter_ease_out_quad (gdouble p)
 {
-  ClutterTimeline *timeline = alpha->priv->timeline;
-  gdouble p = clutter_timeline_get_progress (timeline);
-
   return -1.0 * p * (p - 2);
 }
 
 static gdouble
-clutter_ease_in_out_quad (ClutterAlpha *alpha,
-                          gpointer      dummy G_GNUC_UNUSED)
+clutter_ease_in_out_quad (gdouble p)
 {
-  ClutterTimeline *timeline = alpha->priv->timeline;
-  gdouble t = clutter_timeline_get_elapsed_time (timeline);
-  gdouble d = clutter_timeline_get_duration (timeline);
-  gdouble p = t / (d / 2);
+  p *= 2;
 
   if (p < 1)
     return 0.5 * p * p;
@@ -746,35 +743,23 @@ clutter_ease_in_out_quad (ClutterAlpha *alpha,
 }
 
 static gdouble
-clutter_ease_in_cubic (ClutterAlpha *alpha,
-                       gpointer      dummy G_GNUC_UNUSED)
+clutter_ease_in_cubic (gdouble p)
 {
-  ClutterTimeline *timeline = alpha->priv->timeline;
-  gdouble p = clutter_timeline_get_progress (timeline);
-
   return p * p * p;
 }
 
 static gdouble
-clutter_ease_out_cubic (ClutterAlpha *alpha,
-                        gpointer      dummy G_GNUC_UNUSED)
+clutter_ease_out_cubic (gdouble p)
 {
-  ClutterTimeline *timeline = alpha->priv->timeline;
-  gdouble t = clutter_timeline_get_elapsed_time (timeline);
-  gdouble d = clutter_timeline_get_duration (timeline);
-  gdouble p = t / d - 1;
+  p -= 1;
 
   return p * p * p + 1;
 }
 
 static gdouble
-clutter_ease_in_out_cubic (ClutterAlpha *alpha,
-                           gpointer      dummy G_GNUC_UNUSED)
+clutter_ease_in_out_cubic (gdouble p)
 {
-  ClutterTimeline *timeline = alpha->priv->timeline;
-  gdouble t = clutter_timeline_get_elapsed_time (timeline);
-  gdouble d = clutter_timeline_get_duration (timeline);
-  gdouble p = t / (d / 2);
+  p *= 2;
 
   if (p < 1)
     return 0.5 * p * p * p;
@@ -785,35 +770,23 @@ clutter_ease_in_out_cubic (ClutterAlpha *alpha,
 }
 
 static gdouble
-clutter_ease_in_quart (ClutterAlpha *alpha,
-                       gpointer      dummy G_GNUC_UNUSED)
+clutter_ease_in_quart (gdouble p)
 {
-  ClutterTimeline *timeline = alpha->priv->timeline;
-  gdouble p = clutter_timeline_get_progress (timeline);
-
   return p * p * p * p;
 }
 
 static gdouble
-clutter_ease_out_quart (ClutterAlpha *alpha,
-                        gpointer      dummy G_GNUC_UNUSED)
+clutter_ease_out_quart (gdouble p)
 {
-  ClutterTimeline *timeline = alpha->priv->timeline;
-  gdouble t = clutter_timeline_get_elapsed_time (timeline);
-  gdouble d = clutter_timeline_get_duration (timeline);
-  gdouble p = t / d - 1;
+  p -= 1;
 
   return -1.0 * (p * p * p * p - 1);
 }
 
 static gdouble
-clutter_ease_in_out_quart (ClutterAlpha *alpha,
-                           gpointer      dummy G_GNUC_UNUSED)
+clutter_ease_in_out_quart (gdouble p)
 {
-  ClutterTimeline *timeline = alpha->priv->timeline;
-  gdouble t = clutter_timeline_get_elapsed_time (timeline);
-  gdouble d = clutter_timeline_get_duration (timeline);
-  gdouble p = t / (d / 2);
+  p *= 2;
 
   if (p < 1)
     return 0.5 * p * p * p * p;
@@ -824,35 +797,23 @@ clutter_ease_in_out_quart (ClutterAlpha *alpha,
 }
 
 static gdouble
-clutter_ease_in_quint (ClutterAlpha *alpha,
-                       gpointer      dummy G_GNUC_UNUSED)
- {
-  ClutterTimeline *timeline = alpha->priv->timeline;
-  gdouble p = clutter_timeline_get_progress (timeline);
-
+clutter_ease_in_quint (gdouble p)
+{
   return p * p * p * p * p;
 }
 
 static gdouble
-clutter_ease_out_quint (ClutterAlpha *alpha,
-                        gpointer      dummy G_GNUC_UNUSED)
+clutter_ease_out_quint (gdouble p)
 {
-  ClutterTimeline *timeline = alpha->priv->timeline;
-  gdouble t = clutter_timeline_get_elapsed_time (timeline);
-  gdouble d = clutter_timeline_get_duration (timeline);
-  gdouble p = t / d - 1;
+  p -= 1;
 
   return p * p * p * p * p + 1;
 }
 
 static gdouble
-clutter_ease_in_out_quint (ClutterAlpha *alpha,
-                           gpointer      dummy G_GNUC_UNUSED)
+clutter_ease_in_out_quint (gdouble p)
 {
-  ClutterTimeline *timeline = alpha->priv->timeline;
-  gdouble t = clutter_timeline_get_elapsed_time (timeline);
-  gdouble d = clutter_timeline_get_duration (timeline);
-  gdouble p = t / (d / 2);
+  p *= 2;
 
   if (p < 1)
     return 0.5 * p * p * p * p * p;
@@ -863,76 +824,45 @@ clutter_ease_in_out_quint (ClutterAlpha *alpha,
 }
 
 static gdouble
-clutter_ease_in_sine (ClutterAlpha *alpha,
-                      gpointer      dummy G_GNUC_UNUSED)
+clutter_ease_in_sine (gdouble p)
 {
-  ClutterTimeline *timeline = alpha->priv->timeline;
-  gdouble t = clutter_timeline_get_elapsed_time (timeline);
-  gdouble d = clutter_timeline_get_duration (timeline);
-
-  return -1.0 * cos (t / d * G_PI_2) + 1.0;
+  return -1.0 * cos (p * G_PI_2) + 1.0;
 }
 
 static gdouble
-clutter_ease_out_sine (ClutterAlpha *alpha,
-                       gpointer      dummy G_GNUC_UNUSED)
+clutter_ease_out_sine (gdouble p)
 {
-  ClutterTimeline *timeline = alpha->priv->timeline;
-  gdouble t = clutter_timeline_get_elapsed_time (timeline);
-  gdouble d = clutter_timeline_get_duration (timeline);
-
-  return sin (t / d * G_PI_2);
+  return sin (p * G_PI_2);
 }
 
 static gdouble
-clutter_ease_in_out_sine (ClutterAlpha *alpha,
-                          gpointer      dummy G_GNUC_UNUSED)
+clutter_ease_in_out_sine (gdouble p)
 {
-  ClutterTimeline *timeline = alpha->priv->timeline;
-  gdouble t = clutter_timeline_get_elapsed_time (timeline);
-  gdouble d = clutter_timeline_get_duration (timeline);
-
-  return -0.5 * (cos (G_PI * t / d) - 1);
+  return -0.5 * (cos (G_PI * p) - 1);
 }
 
 static gdouble
-clutter_ease_in_expo (ClutterAlpha *alpha,
-                      gpointer      dummy G_GNUC_UNUSED)
+clutter_ease_in_expo (gdouble p)
 {
-  ClutterTimeline *timeline = alpha->priv->timeline;
-  gdouble t = clutter_timeline_get_elapsed_time (timeline);
-  gdouble d = clutter_timeline_get_duration (timeline);
-
-  return (t == 0) ? 0.0 : pow (2, 10 * (t / d - 1));
+  return (p == 0) ? 0.0 : pow (2, 10 * (p - 1));
 }
 
 static gdouble
-clutter_ease_out_expo (ClutterAlpha *alpha,
-                       gpointer      dummy G_GNUC_UNUSED)
+clutter_ease_out_expo (gdouble p)
 {
-  ClutterTimeline *timeline = alpha->priv->timeline;
-  gdouble t = clutter_timeline_get_elapsed_time (timeline);
-  gdouble d = clutter_timeline_get_duration (timeline);
-
-  return (t == d) ? 1.0 : -pow (2, -10 * t / d) + 1;
+  return (p == 1) ? 1.0 : -pow (2, -10 * p) + 1;
 }
 
 static gdouble
-clutter_ease_in_out_expo (ClutterAlpha *alpha,
-                          gpointer      dummy G_GNUC_UNUSED)
+clutter_ease_in_out_expo (gdouble p)
 {
-  ClutterTimeline *timeline = alpha->priv->timeline;
-  gdouble t = clutter_timeline_get_elapsed_time (timeline);
-  gdouble d = clutter_timeline_get_duration (timeline);
-  gdouble p;
-
-  if (t == 0)
+  if (p == 0)
     return 0.0;
 
-  if (t == d)
+  if (p == 1)
     return 1.0;
 
-  p = t / (d / 2);
+  p *= 2;
 
   if (p < 1)
     return 0.5 * pow (2, 10 * (p - 1));
@@ -943,35 +873,23 @@ clutter_ease_in_out_expo (ClutterAlpha *alpha,
 }
 
 static gdouble
-clutter_ease_in_circ (ClutterAlpha *alpha,
-                      gpointer      dummy G_GNUC_UNUSED)
+clutter_ease_in_circ (gdouble p)
 {
-  ClutterTimeline *timeline = alpha->priv->timeline;
-  gdouble p = clutter_timeline_get_progress (timeline);
-
   return -1.0 * (sqrt (1 - p * p) - 1);
 }
 
 static gdouble
-clutter_ease_out_circ (ClutterAlpha *alpha,
-                       gpointer      dummy G_GNUC_UNUSED)
+clutter_ease_out_circ (gdouble p)
 {
-  ClutterTimeline *timeline = alpha->priv->timeline;
-  gdouble t = clutter_timeline_get_elapsed_time (timeline);
-  gdouble d = clutter_timeline_get_duration (timeline);
-  gdouble p = t / d - 1;
+  p -= 1;
 
   return sqrt (1 - p * p);
 }
 
 static gdouble
-clutter_ease_in_out_circ (ClutterAlpha *alpha,
-                          gpointer      dummy G_GNUC_UNUSED)
+clutter_ease_in_out_circ (gdouble p)
 {
-  ClutterTimeline *timeline = alpha->priv->timeline;
-  gdouble t = clutter_timeline_get_elapsed_time (timeline);
-  gdouble d = clutter_timeline_get_duration (timeline);
-  gdouble p = t / (d / 2);
+  p *= 2;
 
   if (p < 1)
     return -0.5 * (sqrt (1 - p * p) - 1);
@@ -981,52 +899,42 @@ clutter_ease_in_out_circ (ClutterAlpha *alpha,
   return 0.5 * (sqrt (1 - p * p) + 1);
 }
 
+/* the period and the shift of the elastic modes are expressed as a
+ * fraction of the duration, which cancels out with the progress
+ */
 static gdouble
-clutter_ease_in_elastic (ClutterAlpha *alpha,
-                         gpointer      dummy G_GNUC_UNUSED)
+clutter_ease_in_elastic (gdouble q)
 {
-  ClutterTimeline *timeline = alpha->priv->timeline;
-  gdouble t = clutter_timeline_get_elapsed_time (timeline);
-  gdouble d = clutter_timeline_get_duration (timeline);
-  gdouble p = d * .3;
+  gdouble p = .3;
   gdouble s = p / 4;
-  gdouble q = t / d;
 
   if (q == 1)
     return 1.0;
 
   q -= 1;
 
-  return -(pow (2, 10 * q) * sin ((q * d - s) * (2 * G_PI) / p));
+  return -(pow (2, 10 * q) * sin ((q - s) * (2 * G_PI) / p));
 }
 
 static gdouble
-clutter_ease_out_elastic (ClutterAlpha *alpha,
-                          gpointer      dummy G_GNUC_UNUSED)
+clutter_ease_out_elastic (gdouble q)
 {
-  ClutterTimeline *timeline = alpha->priv->timeline;
-  gdouble t = clutter_timeline_get_elapsed_time (timeline);
-  gdouble d = clutter_timeline_get_duration (timeline);
-  gdouble p = d * .3;
+  gdouble p = .3;
   gdouble s = p / 4;
-  gdouble q = t / d;
 
   if (q == 1)
     return 1.0;
 
-  return pow (2, -10 * q) * sin ((q * d - s) * (2 * G_PI) / p) + 1.0;
+  return pow (2, -10 * q) * sin ((q - s) * (2 * G_PI) / p) + 1.0;
 }
 
 static gdouble
-clutter_ease_in_out_elastic (ClutterAlpha *alpha,
-                             gpointer      dummy G_GNUC_UNUSED)
+clutter_ease_in_out_elastic (gdouble q)
 {
-  ClutterTimeline *timeline = alpha->priv->timeline;
-  gdouble t = clutter_timeline_get_elapsed_time (timeline);
-  gdouble d = clutter_timeline_get_duration (timeline);
-  gdouble p = d * (.3 * 1.5);
+  gdouble p = .3 * 1.5;
   gdouble s = p / 4;
-  gdouble q = t / (d / 2);
+
+  q *= 2;
 
   if (q == 2)
     return 1.0;
@@ -1035,50 +943,39 @@ clutter_ease_in_out_elastic (ClutterAlpha *alpha,
     {
       q -= 1;
 
-      return -.5 * (pow (2, 10 * q) * sin ((q * d - s) * (2 * G_PI) / p));
+      return -.5 * (pow (2, 10 * q) * sin ((q - s) * (2 * G_PI) / p));
     }
   else
     {
       q -= 1;
 
       return pow (2, -10 * q)
-           * sin ((q * d - s) * (2 * G_PI) / p)
+           * sin ((q - s) * (2 * G_PI) / p)
            * .5 + 1.0;
     }
 }
 
 static gdouble
-clutter_ease_in_back (ClutterAlpha *alpha,
-                      gpointer      dummy G_GNUC_UNUSED)
+clutter_ease_in_back (gdouble p)
 {
-  ClutterTimeline *timeline = alpha->priv->timeline;
-  gdouble p = clutter_timeline_get_progress (timeline);
-
   return p * p * ((1.70158 + 1) * p - 1.70158);
 }
 
 static gdouble
-clutter_ease_out_back (ClutterAlpha *alpha,
-                       gpointer      dummy G_GNUC_UNUSED)
+clutter_ease_out_back (gdouble p)
 {
-  ClutterTimeline *timeline = alpha->priv->timeline;
-  gdouble t = clutter_timeline_get_elapsed_time (timeline);
-  gdouble d = clutter_timeline_get_duration (timeline);
-  gdouble p = t / d - 1;
+  p -= 1;
 
   return p * p * ((1.70158 + 1) * p + 1.70158) + 1;
 }
 
 static gdouble
-clutter_ease_in_out_back (ClutterAlpha *alpha,
-                          gpointer      dummy G_GNUC_UNUSED)
+clutter_ease_in_out_back (gdouble p)
 {
-  ClutterTimeline *timeline = alpha->priv->timeline;
-  gdouble t = clutter_timeline_get_elapsed_time (timeline);
-  gdouble d = clutter_timeline_get_duration (timeline);
-  gdouble p = t / (d / 2);
   gdouble s = 1.70158 * 1.525;
 
+  p *= 2;
+
   if (p < 1)
     return 0.5 * (p * p * ((s + 1) * p - s));
 
@@ -1088,11 +985,8 @@ clutter_ease_in_out_back (ClutterAlpha *alpha,
 }
 
 static gdouble
-ease_out_bounce_internal (gdouble t,
-                          gdouble d)
+clutter_ease_out_bounce (gdouble p)
 {
-  gdouble p = t / d;
-
   if (p < (1 / 2.75))
     return 7.5625 * p * p;
   else if (p < (2 / 2.75))
@@ -1116,94 +1010,148 @@ ease_out_bounce_internal (gdouble t,
 }
 
 static gdouble
-ease_in_bounce_internal (gdouble t,
-                         gdouble d)
-{
-  return 1.0 - ease_out_bounce_internal (d - t, d);
-}
-
-static gdouble
-clutter_ease_in_bounce (ClutterAlpha *alpha,
-                        gpointer      dummy G_GNUC_UNUSED)
-{
-  ClutterTimeline *timeline = alpha->priv->timeline;
-  gdouble t = clutter_timeline_get_elapsed_time (timeline);
-  gdouble d = clutter_timeline_get_duration (timeline);
-
-  return ease_in_bounce_internal (t, d);
-}
-
-static gdouble
-clutter_ease_out_bounce (ClutterAlpha *alpha,
-                         gpointer      dummy G_GNUC_UNUSED)
+clutter_ease_in_bounce (gdouble p)
 {
-  ClutterTimeline *timeline = alpha->priv->timeline;
-  gdouble t = clutter_timeline_get_elapsed_time (timeline);
-  gdouble d = clutter_timeline_get_duration (timeline);
-
-  return ease_out_bounce_internal (t, d);
+  return 1.0 - clutter_ease_out_bounce (1.0 - p);
 }
 
 static gdouble
-clutter_ease_in_out_bounce (ClutterAlpha *alpha,
-                            gpointer      dummy G_GNUC_UNUSED)
+clutter_ease_in_out_bounce (gdouble p)
 {
-  ClutterTimeline *timeline = alpha->priv->timeline;
-  gdouble t = clutter_timeline_get_elapsed_time (timeline);
-  gdouble d = clutter_timeline_get_duration (timeline);
-
-  if (t < d / 2)
-    return ease_in_bounce_internal (t * 2, d) * 0.5;
+  if (p < 0.5)
+    return clutter_ease_in_bounce (p * 2) * 0.5;
   else
-    return ease_out_bounce_internal (t * 2 - d, d) * 0.5 + 1.0 * 0.5;
+    return clutter_ease_out_bounce (p * 2 - 1) * 0.5 + 1.0 * 0.5;
 }
 
+typedef gdouble (* ClutterEasingFunc) (gdouble progress);
+
 /* static enum/function mapping table for the animation modes
- * we provide internally
+ * we provide internally; the modes using transcendental functions
+ * are tabulated on first use, and evaluated by interpolating
+ * linearly between the samples
  *
  * XXX - keep in sync with ClutterAnimationMode
  */
 static const struct {
   gulong mode;
-  ClutterAlphaFunc func;
+  ClutterEasingFunc func;
+  gboolean tabulate;
 } animation_modes[] = {
-  { CLUTTER_CUSTOM_MODE,         NULL },
-
-  { CLUTTER_LINEAR,              clutter_linear },
-  { CLUTTER_EASE_IN_QUAD,        clutter_ease_in_quad },
-  { CLUTTER_EASE_OUT_QUAD,       clutter_ease_out_quad },
-  { CLUTTER_EASE_IN_OUT_QUAD,    clutter_ease_in_out_quad },
-  { CLUTTER_EASE_IN_CUBIC,       clutter_ease_in_cubic },
-  { CLUTTER_EASE_OUT_CUBIC,      clutter_ease_out_cubic },
-  { CLUTTER_EASE_IN_OUT_CUBIC,   clutter_ease_in_out_cubic },
-  { CLUTTER_EASE_IN_QUART,       clutter_ease_in_quart },
-  { CLUTTER_EASE_OUT_QUART,      clutter_ease_out_quart },
-  { CLUTTER_EASE_IN_OUT_QUART,   clutter_ease_in_out_quart },
-  { CLUTTER_EASE_IN_QUINT,       clutter_ease_in_quint },
-  { CLUTTER_EASE_OUT_QUINT,      clutter_ease_out_quint },
-  { CLUTTER_EASE_IN_OUT_QUINT,   clutter_ease_in_out_quint },
-  { CLUTTER_EASE_IN_SINE,        clutter_ease_in_sine },
-  { CLUTTER_EASE_OUT_SINE,       clutter_ease_out_sine },
-  { CLUTTER_EASE_IN_OUT_SINE,    clutter_ease_in_out_sine },
-  { CLUTTER_EASE_IN_EXPO,        clutter_ease_in_expo },
-  { CLUTTER_EASE_OUT_EXPO,       clutter_ease_out_expo },
-  { CLUTTER_EASE_IN_OUT_EXPO,    clutter_ease_in_out_expo },
-  { CLUTTER_EASE_IN_CIRC,        clutter_ease_in_circ },
-  { CLUTTER_EASE_OUT_CIRC,       clutter_ease_out_circ },
-  { CLUTTER_EASE_IN_OUT_CIRC,    clutter_ease_in_out_circ },
-  { CLUTTER_EASE_IN_ELASTIC,     clutter_ease_in_elastic },
-  { CLUTTER_EASE_OUT_ELASTIC,    clutter_ease_out_elastic },
-  { CLUTTER_EASE_IN_OUT_ELASTIC, clutter_ease_in_out_elastic },
-  { CLUTTER_EASE_IN_BACK,        clutter_ease_in_back },
-  { CLUTTER_EASE_OUT_BACK,       clutter_ease_out_back },
-  { CLUTTER_EASE_IN_OUT_BACK,    clutter_ease_in_out_back },
-  { CLUTTER_EASE_IN_BOUNCE,      clutter_ease_in_bounce },
-  { CLUTTER_EASE_OUT_BOUNCE,     clutter_ease_out_bounce },
-  { CLUTTER_EASE_IN_OUT_BOUNCE,  clutter_ease_in_out_bounce },
-
-  { CLUTTER_ANIMATION_LAST,      NULL },
+  { CLUTTER_CUSTOM_MODE,         NULL, FALSE },
+
+  { CLUTTER_LINEAR,              clutter_linear, FALSE },
+  { CLUTTER_EASE_IN_QUAD,        clutter_ease_in_quad, FALSE },
+  { CLUTTER_EASE_OUT_QUAD,       clutter_ease_out_quad, FALSE },
+  { CLUTTER_EASE_IN_OUT_QUAD,    clutter_ease_in_out_quad, FALSE },
+  { CLUTTER_EASE_IN_CUBIC,       clutter_ease_in_cubic, FALSE },
+  { CLUTTER_EASE_OUT_CUBIC,      clutter_ease_out_cubic, FALSE },
+  { CLUTTER_EASE_IN_OUT_CUBIC,   clutter_ease_in_out_cubic, FALSE },
+  { CLUTTER_EASE_IN_QUART,       clutter_ease_in_quart, FALSE },
+  { CLUTTER_EASE_OUT_QUART,      clutter_ease_out_quart, FALSE },
+  { CLUTTER_EASE_IN_OUT_QUART,   clutter_ease_in_out_quart, FALSE },
+  { CLUTTER_EASE_IN_QUINT,       clutter_ease_in_quint, FALSE },
+  { CLUTTER_EASE_OUT_QUINT,      clutter_ease_out_quint, FALSE },
+  { CLUTTER_EASE_IN_OUT_QUINT,   clutter_ease_in_out_quint, FALSE },
+  { CLUTTER_EASE_IN_SINE,        clutter_ease_in_sine, TRUE },
+  { CLUTTER_EASE_OUT_SINE,       clutter_ease_out_sine, TRUE },
+  { CLUTTER_EASE_IN_OUT_SINE,    clutter_ease_in_out_sine, TRUE },
+  { CLUTTER_EASE_IN_EXPO,        clutter_ease_in_expo, TRUE },
+  { CLUTTER_EASE_OUT_EXPO,       clutter_ease_out_expo, TRUE },
+  { CLUTTER_EASE_IN_OUT_EXPO,    clutter_ease_in_out_expo, TRUE },
+  { CLUTTER_EASE_IN_CIRC,        clutter_ease_in_circ, TRUE },
+  { CLUTTER_EASE_OUT_CIRC,       clutter_ease_out_circ, TRUE },
+  { CLUTTER_EASE_IN_OUT_CIRC,    clutter_ease_in_out_circ, TRUE },
+  { CLUTTER_EASE_IN_ELASTIC,     clutter_ease_in_elastic, TRUE },
+  { CLUTTER_EASE_OUT_ELASTIC,    clutter_ease_out_elastic, TRUE },
+  { CLUTTER_EASE_IN_OUT_ELASTIC, clutter_ease_in_out_elastic, TRUE },
+  { CLUTTER_EASE_IN_BACK,        clutter_ease_in_back, FALSE },
+  { CLUTTER_EASE_OUT_BACK,       clutter_ease_out_back, FALSE },
+  { CLUTTER_EASE_IN_OUT_BACK,    clutter_ease_in_out_back, FALSE },
+  { CLUTTER_EASE_IN_BOUNCE,      clutter_ease_in_bounce, FALSE },
+  { CLUTTER_EASE_OUT_BOUNCE,     clutter_ease_out_bounce, FALSE },
+  { CLUTTER_EASE_IN_OUT_BOUNCE,  clutter_ease_in_out_bounce, FALSE },
+
+  { CLUTTER_ANIMATION_LAST,      NULL, FALSE },
 };
 
+/* the number of intervals of the tabulated modes */
+#define EASING_TABLE_SIZE       512
+
+static gfloat *easing_tables[CLUTTER_ANIMATION_LAST] = { NULL, };
+
+static inline gdouble
+clutter_alpha_compute_mode (gulong  mode,
+                            gdouble progress)
+{
+  const gfloat *table;
+  gdouble x, f;
+  guint i;
+
+  if (!animation_modes[mode].tabulate)
+    return animation_modes[mode].func (progress);
+
+  /* values outside of the [0, 1] range are not tabulated */
+  if (!(progress >= 0.0 && progress <= 1.0))
+    return animation_modes[mode].func (progress);
+
+  table = easing_tables[mode];
+  if (G_UNLIKELY (table == NULL))
+    {
+      gfloat *samples = g_new (gfloat, EASING_TABLE_SIZE + 1);
+
+      for (i = 0; i <= EASING_TABLE_SIZE; i++)
+        samples[i] = animation_modes[mode].func ((gdouble) i / EASING_TABLE_SIZE);
+
+      easing_tables[mode] = samples;
+      table = samples;
+    }
+
+  x = progress * EASING_TABLE_SIZE;
+  i = (guint) x;
+  if (i >= EASING_TABLE_SIZE)
+    return table[EASING_TABLE_SIZE];
+
+  f = x - i;
+
+  return table[i] + (table[i + 1] - table[i]) * f;
+}
+
+/**
+ * clutter_alpha_compute_mode_values:
+ * @mode: a #ClutterAnimationMode
+ * @progress: (array length=n_values): the progress values, usually
+ *   between 0.0 and 1.0
+ * @values: (array length=n_values) (out caller-allocates): return
+ *   location for the alpha values
+ * @n_values: the number of elements in @progress and @values
+ *
+ * Computes the alpha values of the animation @mode for each of the
+ * elements in @progress, without requiring a #ClutterAlpha or a
+ * #ClutterTimeline.
+ *
+ * The @mode must be one of the modes of the #ClutterAnimationMode
+ * enumeration; modes registered using clutter_alpha_register_func()
+ * or clutter_alpha_register_closure() are not supported.
+ *
+ * Since: 1.8
+ */
+void
+clutter_alpha_compute_mode_values (gulong         mode,
+                                   const gdouble *progress,
+                                   gdouble       *values,
+                                   guint          n_values)
+{
+  guint i;
+
+  g_return_if_fail (mode > CLUTTER_CUSTOM_MODE &&
+                    mode < CLUTTER_ANIMATION_LAST);
+  g_return_if_fail (n_values == 0 || (progress != NULL && values != NULL));
+
+  for (i = 0; i < n_values; i++)
+    values[i] = clutter_alpha_compute_mode (mode, progress[i]);
+}
+
 typedef struct _AlphaData {
   guint closure_set : 1;
 
@@ -1243,18 +1191,20 @@ clutter_alpha_set_mode (ClutterAlpha *alpha,
     }
   else if (mode < CLUTTER_ANIMATION_LAST)
     {
-      GClosure *closure;
-
       /* sanity check to avoid getting an out of sync
        * enum/function mapping
        */
       g_assert (animation_modes[mode].mode == mode);
       g_assert (animation_modes[mode].func != NULL);
 
-      closure = g_cclosure_new (G_CALLBACK (animation_modes[mode].func),
-                                NULL,
-                                NULL);
-      clutter_alpha_set_closure_internal (alpha, closure);
+      /* the built-in modes are evaluated directly by get_alpha(),
+       * without going through a closure
+       */
+      if (priv->closure != NULL)
+        {
+          g_closure_unref (priv->closure);
+          priv->closure = NULL;
+        }
 
       priv->mode = mode;
     }
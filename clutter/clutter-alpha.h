@@ -127,6 +127,11 @@ gulong           clutter_alpha_register_func    (ClutterAlphaFunc  func,
                                                  gpointer          data);
 gulong           clutter_alpha_register_closure (GClosure         *closure);
 
+void             clutter_alpha_compute_mode_values (gulong         mode,
+                                                    const gdouble *progress,
+                                                    gdouble       *values,
+                                                    guint          n_values);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_ALPHA_H__ */
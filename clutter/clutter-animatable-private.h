@@ -0,0 +1,16 @@
+#ifndef __CLUTTER_ANIMATABLE_PRIVATE_H__
+#define __CLUTTER_ANIMATABLE_PRIVATE_H__
+
+#include <clutter/clutter-animatable.h>
+#include <clutter/clutter-interval.h>
+
+G_BEGIN_DECLS
+
+gboolean _clutter_animatable_animate_unboxed (ClutterAnimatable *animatable,
+                                              GParamSpec        *pspec,
+                                              ClutterInterval   *interval,
+                                              gdouble            progress);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_ANIMATABLE_PRIVATE_H__ */
@@ -42,6 +42,11 @@
  * implementation should return the computed value for the animated
  * property.
  *
+ * A #ClutterAnimatable can also implement the set_double_property()
+ * virtual function, which allows the animation engine to set numeric
+ * properties, identified by their #GParamSpec, without boxing their
+ * value inside a #GValue on every frame.
+ *
  * #ClutterAnimatable is available since Clutter 1.0
  */
 
@@ -50,7 +55,9 @@
 #endif
 
 #include "clutter-animatable.h"
+#include "clutter-animatable-private.h"
 #include "clutter-debug.h"
+#include "clutter-interval-private.h"
 #include "clutter-private.h"
 
 typedef ClutterAnimatableIface  ClutterAnimatableInterface;
@@ -207,3 +214,37 @@ clutter_animatable_set_final_state (ClutterAnimatable *animatable,
   else
     g_object_set_property (G_OBJECT (animatable), property_name, value);
 }
+
+/*< private >
+ * _clutter_animatable_animate_unboxed:
+ * @animatable: a #ClutterAnimatable
+ * @pspec: the #GParamSpec of the animated property
+ * @interval: the #ClutterInterval for @pspec
+ * @progress: the progress of the animation
+ *
+ * Sets the value of the property described by @pspec, computed from
+ * @interval at the given @progress, through the
+ * #ClutterAnimatableIface.set_double_property() virtual function,
+ * without boxing the value inside a #GValue.
+ *
+ * Return value: %TRUE if the property was set, and %FALSE if the
+ *   caller should use the #GValue based path instead
+ */
+gboolean
+_clutter_animatable_animate_unboxed (ClutterAnimatable *animatable,
+                                     GParamSpec        *pspec,
+                                     ClutterInterval   *interval,
+                                     gdouble            progress)
+{
+  ClutterAnimatableIface *iface;
+  gdouble value;
+
+  iface = CLUTTER_ANIMATABLE_GET_IFACE (animatable);
+  if (iface->set_double_property == NULL)
+    return FALSE;
+
+  if (!_clutter_interval_compute_double (interval, progress, &value))
+    return FALSE;
+
+  return iface->set_double_property (animatable, pspec, value);
+}
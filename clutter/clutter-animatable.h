@@ -60,6 +60,11 @@ typedef struct _ClutterAnimatableIface          ClutterAnimatableIface;
  *   state of an animatable property
  * @set_final_state: virtual function for setting the state of an
  *   animatable property
+ * @set_double_property: optional virtual function for setting the
+ *   state of a numeric animatable property, identified by its
+ *   #GParamSpec, without boxing the value inside a #GValue; it should
+ *   return %FALSE if the property has to be set using @set_final_state
+ *   instead. Added in Clutter 1.8
  *
  * Base interface for #GObject<!-- -->s that can be animated by a
  * a #ClutterAnimation.
@@ -87,6 +92,9 @@ struct _ClutterAnimatableIface
   void        (* set_final_state)   (ClutterAnimatable *animatable,
                                      const gchar       *property_name,
                                      const GValue      *value);
+  gboolean    (* set_double_property) (ClutterAnimatable *animatable,
+                                       GParamSpec        *pspec,
+                                       gdouble            value);
 };
 
 GType clutter_animatable_get_type (void) G_GNUC_CONST;
@@ -0,0 +1,12 @@
+#ifndef __CLUTTER_ANIMATION_PRIVATE_H__
+#define __CLUTTER_ANIMATION_PRIVATE_H__
+
+#include <clutter/clutter-animation.h>
+
+G_BEGIN_DECLS
+
+void _clutter_animation_engine_advance (void);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_ANIMATION_PRIVATE_H__ */
@@ -139,9 +139,12 @@
 #include <glib-object.h>
 #include <gobject/gvaluecollector.h>
 
+#include "clutter-actor-private.h"
 #include "clutter-alpha.h"
 #include "clutter-animatable.h"
+#include "clutter-animatable-private.h"
 #include "clutter-animation.h"
+#include "clutter-animation-private.h"
 #include "clutter-debug.h"
 #include "clutter-enum-types.h"
 #include "clutter-interval.h"
@@ -182,19 +185,47 @@ struct _ClutterAnimationPrivate
 
   GHashTable *properties;
 
+  /* the GParamSpec of each animated property of the object, by
+   * name, resolved on the first frame that animates it
+   */
+  GHashTable *pspecs;
+
   ClutterAlpha *alpha;
 
+  /* the last alpha value used to update the properties */
+  gdouble last_alpha;
+
   guint timeline_started_id;
   guint timeline_completed_id;
-  guint alpha_notify_id;
+
+  /* the intervals of a completed implicit animation, kept to be
+   * updated in place when the animation is reused
+   */
+  GHashTable *spare_intervals;
+
+  /* the handlers connected using the "signal::" syntax */
+  GArray *signal_ids;
+
+  guint in_engine            : 1;
+  guint alpha_is_internal    : 1;
+  guint timeline_is_internal : 1;
+  guint emitting_completed   : 1;
+  guint release_pending      : 1;
 };
 
 static guint animation_signals[LAST_SIGNAL] = { 0, };
 
+/* the animations updated by the master clock at each tick */
+static GPtrArray *animation_engine = NULL;
+
 static GQuark quark_object_animation = 0;
+static GQuark quark_object_animation_pool = 0;
 
 static void clutter_scriptable_init (ClutterScriptableIface *iface);
 
+static void clutter_animation_engine_add    (ClutterAnimation *animation);
+static void clutter_animation_engine_remove (ClutterAnimation *animation);
+
 G_DEFINE_TYPE_WITH_CODE (ClutterAnimation, clutter_animation, G_TYPE_OBJECT,
                          G_IMPLEMENT_INTERFACE (CLUTTER_TYPE_SCRIPTABLE,
                                                 clutter_scriptable_init));
@@ -272,9 +303,201 @@ clutter_animation_real_completed (ClutterAnimation *self)
                                             G_CALLBACK (on_actor_destroy),
                                             animation);
 
+      /* the reference is released once the emission of ::completed
+       * is over, so that the animation can be kept for reuse
+       */
+      if (priv->emitting_completed)
+        priv->release_pending = TRUE;
+      else
+        {
+          CLUTTER_NOTE (ANIMATION, "Releasing the reference Animation [%p]",
+                        animation);
+          g_object_unref (animation);
+        }
+    }
+}
+
+/* checks whether the completed @animation can be kept for reuse: we
+ * need to be the only ones able to observe it, its alpha and its
+ * timeline, otherwise recycling it would leak state into the next
+ * implicit animation of the actor
+ */
+static gboolean
+clutter_animation_is_recyclable (ClutterAnimation *animation)
+{
+  ClutterAnimationPrivate *priv = animation->priv;
+  ClutterTimeline *timeline;
+  gchar **markers;
+  gint n_markers = 0;
+  gulong handler_id;
+  guint i;
+
+  if (G_OBJECT (animation)->ref_count != 1)
+    return FALSE;
+
+  if (!priv->alpha_is_internal || !priv->timeline_is_internal)
+    return FALSE;
+
+  if (G_OBJECT (priv->alpha)->ref_count != 1)
+    return FALSE;
+
+  timeline = clutter_alpha_get_timeline (priv->alpha);
+  if (timeline == NULL || G_OBJECT (timeline)->ref_count != 1)
+    return FALSE;
+
+  markers = clutter_timeline_list_markers (timeline, -1, &n_markers);
+  g_strfreev (markers);
+  if (n_markers != 0)
+    return FALSE;
+
+  if (g_signal_handler_find (priv->alpha, G_SIGNAL_MATCH_UNBLOCKED,
+                             0, 0, NULL, NULL, NULL) != 0)
+    return FALSE;
+
+  /* any handler we did not connect ourselves belongs to somebody else */
+  if (priv->signal_ids != NULL)
+    {
+      for (i = 0; i < priv->signal_ids->len; i++)
+        g_signal_handler_block (animation,
+                                g_array_index (priv->signal_ids, gulong, i));
+    }
+
+  handler_id = g_signal_handler_find (animation, G_SIGNAL_MATCH_UNBLOCKED,
+                                      0, 0, NULL, NULL, NULL);
+
+  if (priv->signal_ids != NULL)
+    {
+      for (i = 0; i < priv->signal_ids->len; i++)
+        g_signal_handler_unblock (animation,
+                                  g_array_index (priv->signal_ids, gulong, i));
+    }
+
+  if (handler_id != 0)
+    return FALSE;
+
+  g_signal_handler_block (timeline, priv->timeline_started_id);
+  g_signal_handler_block (timeline, priv->timeline_completed_id);
+  g_signal_handlers_block_matched (timeline, G_SIGNAL_MATCH_DATA,
+                                   0, 0, NULL, NULL,
+                                   priv->alpha);
+
+  handler_id = g_signal_handler_find (timeline, G_SIGNAL_MATCH_UNBLOCKED,
+                                      0, 0, NULL, NULL, NULL);
+
+  g_signal_handlers_unblock_matched (timeline, G_SIGNAL_MATCH_DATA,
+                                     0, 0, NULL, NULL,
+                                     priv->alpha);
+  g_signal_handler_unblock (timeline, priv->timeline_completed_id);
+  g_signal_handler_unblock (timeline, priv->timeline_started_id);
+
+  return handler_id == 0;
+}
+
+/* releases the reference held by the object animated by an implicit
+ * animation once it completed; if possible, the animation is kept by
+ * the object, with its alpha, timeline and intervals, and it will be
+ * reused by the next call to clutter_actor_animate()
+ */
+static void
+clutter_animation_release_implicit (ClutterAnimation *animation)
+{
+  ClutterAnimationPrivate *priv = animation->priv;
+  GObject *object = priv->object;
+  GHashTable *intervals;
+  guint i;
+
+  if (object == NULL ||
+      (CLUTTER_IS_ACTOR (object) && CLUTTER_ACTOR_IN_DESTRUCTION (object)) ||
+      g_object_get_qdata (object, quark_object_animation_pool) != NULL ||
+      !clutter_animation_is_recyclable (animation))
+    {
       CLUTTER_NOTE (ANIMATION, "Releasing the reference Animation [%p]",
                     animation);
       g_object_unref (animation);
+      return;
+    }
+
+  /* the handlers passed using the "signal::" syntax only apply to
+   * the animation that just completed
+   */
+  if (priv->signal_ids != NULL)
+    {
+      for (i = 0; i < priv->signal_ids->len; i++)
+        g_signal_handler_disconnect (animation,
+                                     g_array_index (priv->signal_ids,
+                                                    gulong, i));
+
+      g_array_set_size (priv->signal_ids, 0);
+    }
+
+  clutter_animation_engine_remove (animation);
+
+  /* the next animation only animates the properties it binds, but
+   * it can reuse the intervals of the ones we animated
+   */
+  if (priv->spare_intervals == NULL)
+    priv->spare_intervals =
+      g_hash_table_new_full (g_str_hash, g_str_equal,
+                             (GDestroyNotify) g_free,
+                             (GDestroyNotify) g_object_unref);
+  else
+    g_hash_table_remove_all (priv->spare_intervals);
+
+  intervals = priv->spare_intervals;
+  priv->spare_intervals = priv->properties;
+  priv->properties = intervals;
+
+  CLUTTER_NOTE (ANIMATION, "Keeping Animation [%p] for reuse on [%p]",
+                animation,
+                object);
+
+  /* the object owns our reference on the animation, so the animation
+   * cannot keep a reference on the object
+   */
+  priv->object = NULL;
+  g_object_set_qdata_full (object, quark_object_animation_pool,
+                           animation,
+                           (GDestroyNotify) g_object_unref);
+  g_object_unref (object);
+}
+
+/* prepares an animation kept by clutter_animation_release_implicit()
+ * to be used again
+ */
+static void
+clutter_animation_recycle (ClutterAnimation *animation)
+{
+  ClutterAnimationPrivate *priv = animation->priv;
+  ClutterTimeline *timeline;
+
+  timeline = clutter_alpha_get_timeline (priv->alpha);
+
+  clutter_timeline_set_loop (timeline, FALSE);
+  clutter_timeline_set_delay (timeline, 0);
+  clutter_timeline_set_auto_reverse (timeline, FALSE);
+  clutter_timeline_set_direction (timeline, CLUTTER_TIMELINE_FORWARD);
+  clutter_timeline_set_stage (timeline, NULL);
+  clutter_timeline_rewind (timeline);
+
+  clutter_animation_engine_add (animation);
+}
+
+static void
+clutter_animation_emit_completed (ClutterAnimation *animation)
+{
+  ClutterAnimationPrivate *priv = animation->priv;
+  gboolean was_emitting = priv->emitting_completed;
+
+  priv->emitting_completed = TRUE;
+
+  g_signal_emit (animation, animation_signals[COMPLETED], 0);
+
+  priv->emitting_completed = was_emitting;
+
+  if (!was_emitting && priv->release_pending)
+    {
+      priv->release_pending = FALSE;
+      clutter_animation_release_implicit (animation);
     }
 }
 
@@ -287,6 +510,13 @@ clutter_animation_finalize (GObject *gobject)
                 "Destroying properties table for Animation [%p]",
                 gobject);
   g_hash_table_destroy (priv->properties);
+  g_hash_table_destroy (priv->pspecs);
+
+  if (priv->spare_intervals != NULL)
+    g_hash_table_destroy (priv->spare_intervals);
+
+  if (priv->signal_ids != NULL)
+    g_array_free (priv->signal_ids, TRUE);
 
   G_OBJECT_CLASS (clutter_animation_parent_class)->finalize (gobject);
 }
@@ -311,15 +541,11 @@ clutter_animation_dispose (GObject *gobject)
   priv->timeline_started_id = 0;
   priv->timeline_completed_id = 0;
 
-  if (priv->alpha != NULL)
-    {
-      if (priv->alpha_notify_id != 0)
-        g_signal_handler_disconnect (priv->alpha, priv->alpha_notify_id);
+  clutter_animation_engine_remove (CLUTTER_ANIMATION (gobject));
 
-      g_object_unref (priv->alpha);
-    }
+  if (priv->alpha != NULL)
+    g_object_unref (priv->alpha);
 
-  priv->alpha_notify_id = 0;
   priv->alpha = NULL;
 
   if (priv->object != NULL)
@@ -446,6 +672,8 @@ clutter_animation_class_init (ClutterAnimationClass *klass)
 
   quark_object_animation =
     g_quark_from_static_string ("clutter-actor-animation");
+  quark_object_animation_pool =
+    g_quark_from_static_string ("clutter-actor-animation-pool");
 
   g_type_class_add_private (klass, sizeof (ClutterAnimationPrivate));
 
@@ -597,6 +825,10 @@ clutter_animation_init (ClutterAnimation *self)
     g_hash_table_new_full (g_str_hash, g_str_equal,
                            (GDestroyNotify) g_free,
                            (GDestroyNotify) g_object_unref);
+  self->priv->pspecs =
+    g_hash_table_new_full (g_str_hash, g_str_equal,
+                           (GDestroyNotify) g_free,
+                           NULL);
 }
 
 static inline void
@@ -1060,26 +1292,58 @@ on_timeline_completed (ClutterTimeline  *timeline,
   CLUTTER_NOTE (ANIMATION, "Timeline [%p] complete", timeline);
 
   if (!clutter_animation_get_loop (animation))
-    g_signal_emit (animation, animation_signals[COMPLETED], 0);
+    clutter_animation_emit_completed (animation);
+}
+
+/* retrieves the GParamSpec of @property_name, caching it so that
+ * the animatable does not have to look it up on every frame
+ */
+static GParamSpec *
+clutter_animation_get_pspec (ClutterAnimation  *animation,
+                             ClutterAnimatable *animatable,
+                             const gchar       *property_name)
+{
+  ClutterAnimationPrivate *priv = animation->priv;
+  GParamSpec *pspec;
+
+  pspec = g_hash_table_lookup (priv->pspecs, property_name);
+  if (pspec == NULL)
+    {
+      pspec = clutter_animatable_find_property (animatable, property_name);
+      if (pspec != NULL)
+        g_hash_table_insert (priv->pspecs, g_strdup (property_name), pspec);
+    }
+
+  return pspec;
 }
 
 static void
-on_alpha_notify (GObject          *gobject,
-                 GParamSpec       *pspec,
-                 ClutterAnimation *animation)
+clutter_animation_update (ClutterAnimation *animation)
 {
-  ClutterAnimationPrivate *priv;
-  GList *properties, *p;
+  ClutterAnimationPrivate *priv = animation->priv;
+  ClutterTimeline *timeline;
+  GHashTableIter iter;
+  gpointer key, value_p;
   gdouble alpha_value;
   gboolean is_animatable = FALSE;
+  gboolean is_actor;
   ClutterAnimatable *animatable = NULL;
 
-  /* make sure the animation survives the notification */
-  g_object_ref (animation);
+  if (priv->object == NULL)
+    return;
 
-  priv = animation->priv;
+  timeline = clutter_alpha_get_timeline (priv->alpha);
+  if (timeline == NULL || !clutter_timeline_is_playing (timeline))
+    return;
+
+  /* the alpha only depends on the progress of the timeline, so if
+   * it did not change since the last tick there is nothing to do
+   */
+  alpha_value = clutter_alpha_get_alpha (priv->alpha);
+  if (alpha_value == priv->last_alpha)
+    return;
 
-  alpha_value = clutter_alpha_get_alpha (CLUTTER_ALPHA (gobject));
+  priv->last_alpha = alpha_value;
 
   if (CLUTTER_IS_ANIMATABLE (priv->object))
     {
@@ -1087,18 +1351,36 @@ on_alpha_notify (GObject          *gobject,
       is_animatable = TRUE;
     }
 
-  g_object_freeze_notify (priv->object);
+  is_actor = CLUTTER_IS_ACTOR (priv->object);
+
+  /* coalesce the redraws and relayouts queued by each property */
+  if (is_actor)
+    _clutter_actor_begin_update (CLUTTER_ACTOR (priv->object));
+  else
+    g_object_freeze_notify (priv->object);
 
-  properties = g_hash_table_get_keys (priv->properties);
-  for (p = properties; p != NULL; p = p->next)
+  g_hash_table_iter_init (&iter, priv->properties);
+  while (g_hash_table_iter_next (&iter, &key, &value_p))
     {
-      const gchar *p_name = p->data;
-      ClutterInterval *interval;
+      const gchar *p_name = key;
+      ClutterInterval *interval = value_p;
       GValue value = { 0, };
       gboolean apply;
 
-      interval = g_hash_table_lookup (priv->properties, p_name);
-      g_assert (CLUTTER_IS_INTERVAL (interval));
+      /* numeric properties of an animatable object, like the ones
+       * of an actor, do not need to go through a GValue
+       */
+      if (is_animatable)
+        {
+          GParamSpec *pspec;
+
+          pspec = clutter_animation_get_pspec (animation, animatable, p_name);
+          if (pspec != NULL &&
+              _clutter_animatable_animate_unboxed (animatable, pspec,
+                                                   interval,
+                                                   alpha_value))
+            continue;
+        }
 
       g_value_init (&value, clutter_interval_get_value_type (interval));
 
@@ -1133,11 +1415,81 @@ on_alpha_notify (GObject          *gobject,
       g_value_unset (&value);
     }
 
-  g_list_free (properties);
+  if (is_actor)
+    _clutter_actor_end_update (CLUTTER_ACTOR (priv->object));
+  else
+    g_object_thaw_notify (priv->object);
+}
+
+static void
+clutter_animation_engine_add (ClutterAnimation *animation)
+{
+  ClutterAnimationPrivate *priv = animation->priv;
 
-  g_object_thaw_notify (priv->object);
+  if (priv->in_engine)
+    return;
 
-  g_object_unref (animation);
+  if (G_UNLIKELY (animation_engine == NULL))
+    animation_engine = g_ptr_array_new ();
+
+  g_ptr_array_add (animation_engine, animation);
+
+  priv->last_alpha = -G_MAXDOUBLE;
+  priv->in_engine = TRUE;
+}
+
+static void
+clutter_animation_engine_remove (ClutterAnimation *animation)
+{
+  ClutterAnimationPrivate *priv = animation->priv;
+
+  if (!priv->in_engine)
+    return;
+
+  g_ptr_array_remove (animation_engine, animation);
+
+  priv->in_engine = FALSE;
+}
+
+/*< private >
+ * _clutter_animation_engine_advance:
+ *
+ * Updates the properties of all the animations whose timeline is
+ * playing. This function is called by the master clock once per
+ * tick, after all the timelines have been advanced, instead of
+ * having every #ClutterAnimation listen to the notifications of
+ * its own #ClutterAlpha.
+ */
+void
+_clutter_animation_engine_advance (void)
+{
+  ClutterAnimation **animations;
+  guint i, n_animations;
+
+  if (animation_engine == NULL || animation_engine->len == 0)
+    return;
+
+  /* updating the properties might run arbitrary code that creates
+   * or destroys animations, so we iterate over a copy of the array
+   * while holding a reference on each animation; newly created
+   * animations will be updated at the next tick
+   */
+  n_animations = animation_engine->len;
+  animations = g_memdup (animation_engine->pdata,
+                         n_animations * sizeof (gpointer));
+
+  for (i = 0; i < n_animations; i++)
+    g_object_ref (animations[i]);
+
+  for (i = 0; i < n_animations; i++)
+    {
+      if (animations[i]->priv->in_engine)
+        clutter_animation_update (animations[i]);
+
+      g_object_unref (animations[i]);
+    }
+
+  g_free (animations);
 }
 
 static ClutterAlpha *
@@ -1152,12 +1504,10 @@ clutter_animation_get_alpha_internal (ClutterAnimation *animation)
       alpha = clutter_alpha_new ();
       clutter_alpha_set_mode (alpha, CLUTTER_LINEAR);
 
-      priv->alpha_notify_id =
-        g_signal_connect (alpha, "notify::alpha",
-                          G_CALLBACK (on_alpha_notify),
-                          animation);
-
       priv->alpha = g_object_ref_sink (alpha);
+      priv->alpha_is_internal = TRUE;
+
+      clutter_animation_engine_add (animation);
 
       g_object_notify_by_pspec (G_OBJECT (animation), obj_props[PROP_ALPHA]);
     }
@@ -1190,6 +1540,7 @@ clutter_animation_get_timeline_internal (ClutterAnimation *animation)
                       animation);
 
   clutter_alpha_set_timeline (alpha, timeline);
+  priv->timeline_is_internal = TRUE;
 
   /* the alpha owns the timeline now */
   g_object_unref (timeline);
@@ -1256,6 +1607,9 @@ clutter_animation_set_object (ClutterAnimation *animation,
       priv->object = NULL;
     }
 
+  /* the properties of the new object might be different ones */
+  g_hash_table_remove_all (priv->pspecs);
+
   if (object != NULL)
     priv->object = g_object_ref (object);
 
@@ -1490,6 +1844,7 @@ clutter_animation_set_timeline (ClutterAnimation *animation,
 
   alpha = clutter_animation_get_alpha_internal (animation);
   clutter_alpha_set_timeline (alpha, timeline);
+  priv->timeline_is_internal = FALSE;
   g_object_notify_by_pspec (G_OBJECT (animation), obj_props[PROP_TIMELINE]);
   g_object_notify_by_pspec (G_OBJECT (animation), obj_props[PROP_DURATION]);
   g_object_notify_by_pspec (G_OBJECT (animation), obj_props[PROP_LOOP]);
@@ -1574,12 +1929,11 @@ clutter_animation_set_alpha (ClutterAnimation *animation,
       priv->timeline_completed_id = 0;
     }
 
-  /* then we need to disconnect the signal handler from the old alpha */
-  if (priv->alpha_notify_id != 0)
-    {
-      g_signal_handler_disconnect (priv->alpha, priv->alpha_notify_id);
-      priv->alpha_notify_id = 0;
-    }
+  /* then we stop following the old alpha */
+  clutter_animation_engine_remove (animation);
+
+  priv->alpha_is_internal = FALSE;
+  priv->timeline_is_internal = FALSE;
 
   if (priv->alpha != NULL)
     {
@@ -1592,10 +1946,8 @@ clutter_animation_set_alpha (ClutterAnimation *animation,
     goto out;
 
   priv->alpha = g_object_ref_sink (alpha);
-  priv->alpha_notify_id =
-    g_signal_connect (priv->alpha, "notify::alpha",
-                      G_CALLBACK (on_alpha_notify),
-                      animation);
+
+  clutter_animation_engine_add (animation);
 
   /* if the alpha has a timeline then we use it, otherwise we create one */
   timeline = clutter_alpha_get_timeline (priv->alpha);
@@ -1667,7 +2019,7 @@ clutter_animation_completed (ClutterAnimation *animation)
 {
   g_return_if_fail (CLUTTER_IS_ANIMATION (animation));
 
-  g_signal_emit (animation, animation_signals[COMPLETED], 0);
+  clutter_animation_emit_completed (animation);
 }
 
 /*
@@ -1689,6 +2041,47 @@ clutter_animation_start (ClutterAnimation *animation)
     }
 }
 
+/* updates @interval in place, unless somebody else holds a reference
+ * on it; if the new values are not valid for @pspec the interval is
+ * left untouched
+ */
+static gboolean
+clutter_animation_retarget_interval (ClutterInterval *interval,
+                                     GParamSpec      *pspec,
+                                     const GValue    *initial,
+                                     const GValue    *final)
+{
+  GValue old_initial = { 0, };
+  GValue old_final = { 0, };
+  gboolean retval;
+
+  if (G_OBJECT (interval)->ref_count != 1)
+    return FALSE;
+
+  if (clutter_interval_get_value_type (interval) != G_PARAM_SPEC_VALUE_TYPE (pspec))
+    return FALSE;
+
+  g_value_init (&old_initial, G_PARAM_SPEC_VALUE_TYPE (pspec));
+  g_value_init (&old_final, G_PARAM_SPEC_VALUE_TYPE (pspec));
+  clutter_interval_get_initial_value (interval, &old_initial);
+  clutter_interval_get_final_value (interval, &old_final);
+
+  clutter_interval_set_initial_value (interval, initial);
+  clutter_interval_set_final_value (interval, final);
+
+  retval = clutter_interval_validate (interval, pspec);
+  if (!retval)
+    {
+      clutter_interval_set_initial_value (interval, &old_initial);
+      clutter_interval_set_final_value (interval, &old_final);
+    }
+
+  g_value_unset (&old_initial);
+  g_value_unset (&old_final);
+
+  return retval;
+}
+
 static void
 clutter_animation_setup_property (ClutterAnimation *animation,
                                   const gchar      *property_name,
@@ -1774,19 +2167,55 @@ done:
       else
         g_object_get_property (priv->object, property_name, &cur_value);
 
-      interval =
-        clutter_interval_new_with_values (G_PARAM_SPEC_VALUE_TYPE (pspec),
-                                          &cur_value,
-                                          &real_value);
-
-      if (!clutter_animation_has_property (animation, property_name))
-        clutter_animation_bind_property_internal (animation, property_name,
-                                                  pspec,
-                                                  interval);
+      /* retarget the interval of a property that is already being
+       * animated, or the one left by a recycled animation, in place
+       */
+      interval = g_hash_table_lookup (priv->properties, property_name);
+      if (interval != NULL)
+        {
+          if (!clutter_animation_retarget_interval (interval, pspec,
+                                                    &cur_value,
+                                                    &real_value))
+            {
+              interval =
+                clutter_interval_new_with_values (G_PARAM_SPEC_VALUE_TYPE (pspec),
+                                                  &cur_value,
+                                                  &real_value);
+
+              clutter_animation_update_property_internal (animation,
+                                                          property_name,
+                                                          pspec,
+                                                          interval);
+            }
+        }
       else
-        clutter_animation_update_property_internal (animation, property_name,
-                                                    pspec,
-                                                    interval);
+        {
+          gpointer key = NULL;
+
+          if (priv->spare_intervals != NULL &&
+              g_hash_table_lookup_extended (priv->spare_intervals,
+                                            property_name,
+                                            &key, (gpointer *) &interval) &&
+              clutter_animation_retarget_interval (interval, pspec,
+                                                   &cur_value,
+                                                   &real_value))
+            {
+              g_hash_table_steal (priv->spare_intervals, property_name);
+              g_hash_table_insert (priv->properties, key, interval);
+            }
+          else
+            {
+              interval =
+                clutter_interval_new_with_values (G_PARAM_SPEC_VALUE_TYPE (pspec),
+                                                  &cur_value,
+                                                  &real_value);
+
+              clutter_animation_bind_property_internal (animation,
+                                                        property_name,
+                                                        pspec,
+                                                        interval);
+            }
+        }
 
       g_value_unset (&cur_value);
     }
@@ -1918,9 +2347,16 @@ clutter_animation_setup_valist (ClutterAnimation *animation,
           GCallback callback = va_arg (var_args, GCallback);
           gpointer  userdata = va_arg (var_args, gpointer);
 
-          g_signal_connect_data (animation, signal_name,
-                                 callback, userdata,
-                                 NULL, flags);
+          gulong signal_id;
+
+          signal_id = g_signal_connect_data (animation, signal_name,
+                                             callback, userdata,
+                                             NULL, flags);
+
+          if (priv->signal_ids == NULL)
+            priv->signal_ids = g_array_new (FALSE, FALSE, sizeof (gulong));
+
+          g_array_append_val (priv->signal_ids, signal_id);
         }
       else
         {
@@ -1975,7 +2411,22 @@ animation_create_for_actor (ClutterActor *actor)
   animation = g_object_get_qdata (object, quark_object_animation);
   if (animation == NULL)
     {
-      animation = clutter_animation_new ();
+      /* reuse the last implicit animation of the actor, if it
+       * was kept when it completed
+       */
+      animation = g_object_steal_qdata (object, quark_object_animation_pool);
+      if (animation != NULL)
+        {
+          clutter_animation_recycle (animation);
+
+          CLUTTER_NOTE (ANIMATION,
+                        "Recycling Animation [%p] for actor [%p]",
+                        animation,
+                        actor);
+        }
+      else
+        animation = clutter_animation_new ();
+
       clutter_animation_set_object (animation, object);
       g_object_set_qdata (object, quark_object_animation, animation);
 
@@ -2230,7 +2681,10 @@ clutter_actor_animate_with_timeline (ClutterActor    *actor,
  *
  * <note>Unless the animation is looping, the #ClutterAnimation created by
  * clutter_actor_animate() will become invalid as soon as it is
- * complete.</note>
+ * complete. The actor may keep the completed animation and return it
+ * again from a later call to clutter_actor_animate(), so you should not
+ * use a pointer to it after the #ClutterAnimation::completed signal
+ * has been emitted.</note>
  *
  * Since the created #ClutterAnimation instance attached to @actor
  * is guaranteed to be valid throughout the #ClutterAnimation::completed
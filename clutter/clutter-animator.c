@@ -132,6 +132,7 @@
 #include "clutter-animator.h"
 
 #include "clutter-alpha.h"
+#include "clutter-animatable-private.h"
 #include "clutter-debug.h"
 #include "clutter-enum-types.h"
 #include "clutter-interval.h"
@@ -231,13 +232,24 @@ typedef struct _PropertyIter {
   ClutterInterval     *interval;
   ClutterAlpha        *alpha;
 
+  /* the property of an animatable object, set without boxing the
+   * value inside a GValue when possible
+   */
+  GParamSpec          *pspec;
+
   GList               *current;
 
   gdouble              start;    /* the progress of current */
   gdouble              end;      /* until which progress it is valid */
   ClutterInterpolation interpolation;
 
+  /* the values of the keys around current used by the cubic
+   * interpolation; they only change together with current
+   */
+  gdouble              cubic[4];
+
   guint                ease_in : 1;
+  guint                cubic_valid : 1;
 } PropertyIter;
 
 static PropObjectKey *
@@ -289,12 +301,20 @@ property_iter_new (ClutterAnimator *animator,
 
   property_iter->interval = interval;
   property_iter->key = key;
+  property_iter->cubic_valid = FALSE;
   property_iter->alpha = clutter_alpha_new ();
   clutter_alpha_set_timeline (property_iter->alpha, priv->slave_timeline);
 
   /* as well as the alpha */
   g_object_ref_sink (property_iter->alpha);
 
+  if (CLUTTER_IS_ANIMATABLE (key->object))
+    property_iter->pspec =
+      clutter_animatable_find_property (CLUTTER_ANIMATABLE (key->object),
+                                        key->property_name);
+  else
+    property_iter->pspec = NULL;
+
   return property_iter;
 }
 
@@ -490,6 +510,7 @@ animation_animator_ensure_animator (ClutterAnimator *animator,
                                     PropObjectKey   *key,
                                     gdouble          progress)
 {
+  GList *old_current = property_iter->current;
 
   if (progress > property_iter->end)
     {
@@ -588,6 +609,9 @@ animation_animator_ensure_animator (ClutterAnimator *animator,
             break;
         }
     }
+
+  if (property_iter->current != old_current)
+    property_iter->cubic_valid = FALSE;
 }
 
 /* XXX - this might be useful as an internal function exposed somewhere */
@@ -645,6 +669,48 @@ list_try_get_rel (GList *list,
   return 0;
 }
 
+/* collects the values of the keys used by the cubic interpolation
+ * of the current segment of @property_iter
+ */
+static void
+property_iter_ensure_cubic (PropertyIter *property_iter)
+{
+  ClutterAnimatorKey *start_key;
+  gdouble prev, current;
+
+  if (property_iter->cubic_valid)
+    return;
+
+  start_key = property_iter->current->data;
+
+  if ((property_iter->ease_in == FALSE ||
+      (property_iter->ease_in &&
+       list_find_custom_reverse (property_iter->current->prev,
+                                 property_iter->current->data,
+                                 sort_actor_prop_func))))
+    {
+      current = g_value_get_float (&start_key->value);
+      prev = list_try_get_rel (property_iter->current, -1);
+    }
+  else
+    {
+      GValue tmp_value = { 0, };
+
+      /* interpolated and easing in */
+      g_value_init (&tmp_value, G_TYPE_FLOAT);
+      clutter_interval_get_initial_value (property_iter->interval,
+                                          &tmp_value);
+      prev = current = g_value_get_float (&tmp_value);
+      g_value_unset (&tmp_value);
+    }
+
+  property_iter->cubic[0] = prev;
+  property_iter->cubic[1] = current;
+  property_iter->cubic[2] = list_try_get_rel (property_iter->current, 1);
+  property_iter->cubic[3] = list_try_get_rel (property_iter->current, 2);
+  property_iter->cubic_valid = TRUE;
+}
+
 static void
 animation_animator_new_frame (ClutterTimeline  *timeline,
                               gint              msecs,
@@ -685,49 +751,58 @@ animation_animator_new_frame (ClutterTimeline  *timeline,
         {
           GValue tmp_value = { 0, };
           GType int_type;
+          gulong mode;
+
+          /* the built-in modes do not need to go through the slave
+           * timeline to compute the alpha value
+           */
+          mode = clutter_alpha_get_mode (property_iter->alpha);
+          if (mode > CLUTTER_CUSTOM_MODE && mode < CLUTTER_ANIMATION_LAST)
+            clutter_alpha_compute_mode_values (mode,
+                                               &sub_progress, &sub_progress,
+                                               1);
+          else
+            {
+              clutter_timeline_advance (animator->priv->slave_timeline,
+                                        sub_progress * 10000);
+              sub_progress = clutter_alpha_get_alpha (property_iter->alpha);
+            }
 
-          g_value_init (&tmp_value, G_VALUE_TYPE (&start_key->value));
-
-          clutter_timeline_advance (animator->priv->slave_timeline,
-                                    sub_progress * 10000);
-
-          sub_progress = clutter_alpha_get_alpha (property_iter->alpha);
           int_type = clutter_interval_get_value_type (property_iter->interval);
 
           if (property_iter->interpolation == CLUTTER_INTERPOLATION_CUBIC &&
               int_type == G_TYPE_FLOAT)
             {
-              gdouble prev, current, next, nextnext;
               gdouble res;
 
-              if ((property_iter->ease_in == FALSE ||
-                  (property_iter->ease_in &&
-                   list_find_custom_reverse (property_iter->current->prev,
-                                             property_iter->current->data,
-                                             sort_actor_prop_func))))
-                {
-                  current = g_value_get_float (&start_key->value);
-                  prev = list_try_get_rel (property_iter->current, -1);
-                }
-              else
-                {
-                  /* interpolated and easing in */
-                  clutter_interval_get_initial_value (property_iter->interval,
-                                                      &tmp_value);
-                  prev = current = g_value_get_float (&tmp_value);
-                }
+              property_iter_ensure_cubic (property_iter);
 
-               next = list_try_get_rel (property_iter->current, 1);
-               nextnext = list_try_get_rel (property_iter->current, 2);
-               res = cubic_interpolation (sub_progress, prev, current, next,
-                                          nextnext);
+              res = cubic_interpolation (sub_progress,
+                                         property_iter->cubic[0],
+                                         property_iter->cubic[1],
+                                         property_iter->cubic[2],
+                                         property_iter->cubic[3]);
 
-               g_value_set_float (&tmp_value, res);
+              g_value_init (&tmp_value, G_VALUE_TYPE (&start_key->value));
+              g_value_set_float (&tmp_value, res);
             }
           else
-            clutter_interval_compute_value (property_iter->interval,
-                                            sub_progress,
-                                            &tmp_value);
+            {
+              /* numeric properties of animatable objects are set
+               * without boxing the value inside a GValue
+               */
+              if (property_iter->pspec != NULL &&
+                  _clutter_animatable_animate_unboxed (CLUTTER_ANIMATABLE (prop_actor_key->object),
+                                                       property_iter->pspec,
+                                                       property_iter->interval,
+                                                       sub_progress))
+                continue;
+
+              g_value_init (&tmp_value, G_VALUE_TYPE (&start_key->value));
+              clutter_interval_compute_value (property_iter->interval,
+                                              sub_progress,
+                                              &tmp_value);
+            }
 
           g_object_set_property (prop_actor_key->object,
                                  prop_actor_key->property_name,
@@ -798,6 +873,7 @@ animation_animator_started (ClutterTimeline *timeline,
         property_iter->start         = initial_key->progress;
         property_iter->ease_in       = initial_key->ease_in;
         property_iter->interpolation = initial_key->interpolation;
+        property_iter->cubic_valid   = FALSE;
 
         if (property_iter->ease_in)
           {
@@ -1534,7 +1610,6 @@ parse_animator_property (JsonArray *array,
   JsonArray *keys;
   GObject *gobject;
   const gchar *id_, *pname;
-  GObjectClass *klass;
   GParamSpec *pspec;
   GSList *valid_keys = NULL;
   GList *array_keys, *k;
@@ -1572,8 +1647,7 @@ parse_animator_property (JsonArray *array,
     }
 
   pname = json_object_get_string_member (object, "name");
-  klass = G_OBJECT_GET_CLASS (gobject);
-  pspec = g_object_class_find_property (klass, pname);
+  pspec = _clutter_script_find_property (G_OBJECT_TYPE (gobject), pname);
   if (pspec == NULL)
     {
       g_warning ("The object of type '%s' and name '%s' has no "
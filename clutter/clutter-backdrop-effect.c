@@ -0,0 +1,454 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2011  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:clutter-backdrop-effect
+ * @short_description: An effect blurring what is behind an actor
+ * @see_also: #ClutterEffect, #ClutterBlurEffect
+ *
+ * #ClutterBackdropEffect is a sub-class of #ClutterEffect that paints a
+ * blurred copy of whatever was painted behind an actor underneath it,
+ * which gives the actor the look of frosted glass.
+ *
+ * Unlike #ClutterBlurEffect, which blurs the contents of the actor, the
+ * backdrop is read back from the framebuffer the stage is painting to,
+ * so the scene behind the actor is only painted once. Only the part of
+ * the backdrop being redrawn is read back and blurred, which keeps the
+ * cost of the effect in line with the size of the damaged area.
+ *
+ * The backdrop is only available when the actor is painted directly on
+ * the stage; for instance, an actor inside a #ClutterOffscreenEffect is
+ * painted without it.
+ *
+ * #ClutterBackdropEffect is available since Clutter 1.8
+ */
+
+#define CLUTTER_BACKDROP_EFFECT_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), CLUTTER_TYPE_BACKDROP_EFFECT, ClutterBackdropEffectClass))
+#define CLUTTER_IS_BACKDROP_EFFECT_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), CLUTTER_TYPE_BACKDROP_EFFECT))
+#define CLUTTER_BACKDROP_EFFECT_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), CLUTTER_TYPE_BACKDROP_EFFECT, ClutterBackdropEffectClass))
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <math.h>
+
+#include "clutter-backdrop-effect.h"
+
+#include "cogl/cogl.h"
+
+#include "clutter-actor-private.h"
+#include "clutter-blur-effect-private.h"
+#include "clutter-debug.h"
+#include "clutter-private.h"
+#include "clutter-stage-private.h"
+
+/* the default radius of the blur, in pixels */
+#define BACKDROP_DEFAULT_RADIUS 8.0f
+
+struct _ClutterBackdropEffect
+{
+  ClutterEffect parent_instance;
+
+  /* a back pointer to our actor, so that we can query it */
+  ClutterActor *actor;
+
+  gfloat radius;
+
+  /* the pixels read back from the framebuffer; kept around so that
+   * we do not allocate a new buffer at every frame
+   */
+  guint8 *pixels;
+  gsize pixels_size;
+};
+
+struct _ClutterBackdropEffectClass
+{
+  ClutterEffectClass parent_class;
+};
+
+enum
+{
+  PROP_0,
+
+  PROP_RADIUS,
+
+  PROP_LAST
+};
+
+static GParamSpec *obj_props[PROP_LAST];
+
+G_DEFINE_TYPE (ClutterBackdropEffect,
+               clutter_backdrop_effect,
+               CLUTTER_TYPE_EFFECT);
+
+/* intersects @a with @b, storing the result into @a; returns %FALSE
+ * if the result is empty
+ */
+static gboolean
+geometry_intersect (ClutterGeometry       *a,
+                    const ClutterGeometry *b)
+{
+  gint x_1, y_1, x_2, y_2;
+
+  x_1 = MAX (a->x, b->x);
+  y_1 = MAX (a->y, b->y);
+  x_2 = MIN (a->x + (gint) a->width, b->x + (gint) b->width);
+  y_2 = MIN (a->y + (gint) a->height, b->y + (gint) b->height);
+
+  if (x_2 <= x_1 || y_2 <= y_1)
+    return FALSE;
+
+  a->x = x_1;
+  a->y = y_1;
+  a->width = x_2 - x_1;
+  a->height = y_2 - y_1;
+
+  return TRUE;
+}
+
+/* copies the @area of the framebuffer, in window coordinates, into a
+ * target borrowed from @stage
+ */
+static ClutterStageOffscreen *
+clutter_backdrop_effect_read_area (ClutterBackdropEffect *self,
+                                   ClutterStage          *stage,
+                                   const ClutterGeometry *area)
+{
+  ClutterStageOffscreen *offscreen;
+  CoglColor transparent;
+  gsize size;
+
+  size = area->width * area->height * 4;
+  if (size > self->pixels_size)
+    {
+      g_free (self->pixels);
+      self->pixels = g_malloc (size);
+      self->pixels_size = size;
+    }
+
+  offscreen = _clutter_stage_acquire_offscreen (stage,
+                                                area->width,
+                                                area->height,
+                                                COGL_PIXEL_FORMAT_RGBA_8888_PRE);
+  if (offscreen == NULL)
+    return NULL;
+
+  /* the blur samples around the area as well, so the rest of the
+   * target must not have the contents of its previous user
+   */
+  cogl_push_framebuffer (offscreen->framebuffer);
+  cogl_color_init_from_4ub (&transparent, 0, 0, 0, 0);
+  cogl_clear (&transparent, COGL_BUFFER_BIT_COLOR);
+  cogl_pop_framebuffer ();
+
+  cogl_read_pixels (area->x, area->y,
+                    area->width, area->height,
+                    COGL_READ_PIXELS_COLOR_BUFFER,
+                    COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                    self->pixels);
+
+  cogl_texture_set_region (offscreen->texture,
+                           0, 0,
+                           0, 0,
+                           area->width, area->height,
+                           area->width, area->height,
+                           COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                           area->width * 4,
+                           self->pixels);
+
+  return offscreen;
+}
+
+static void
+clutter_backdrop_effect_paint_backdrop (ClutterBackdropEffect *self)
+{
+  ClutterStageOffscreen *backdrop, *blurred;
+  ClutterGeometry paint_area, read_area, clip;
+  ClutterActorBox box;
+  ClutterActor *stage;
+  CoglMatrix modelview;
+  gint blurred_width, blurred_height;
+  gint padding;
+
+  stage = clutter_actor_get_stage (self->actor);
+  if (stage == NULL)
+    return;
+
+  /* the backdrop is read in window coordinates, which only match the
+   * coordinates of the stage when painting on it directly
+   */
+  if (cogl_get_draw_framebuffer () !=
+      _clutter_stage_get_active_framebuffer (CLUTTER_STAGE (stage)))
+    return;
+
+  if (!clutter_actor_get_paint_box (self->actor, &box))
+    return;
+
+  /* we only need to paint the part of the backdrop being redrawn */
+  paint_area.x = floorf (box.x1);
+  paint_area.y = floorf (box.y1);
+  paint_area.width = ceilf (box.x2) - paint_area.x;
+  paint_area.height = ceilf (box.y2) - paint_area.y;
+
+  _clutter_stage_get_clip_geometry (CLUTTER_STAGE (stage), &clip);
+  if (!geometry_intersect (&paint_area, &clip))
+    return;
+
+  /* the blur spreads the pixels around the painted area inside it */
+  padding = ceilf (self->radius);
+
+  read_area.x = paint_area.x - padding;
+  read_area.y = paint_area.y - padding;
+  read_area.width = paint_area.width + 2 * padding;
+  read_area.height = paint_area.height + 2 * padding;
+
+  clip.x = clip.y = 0;
+  clip.width = clutter_actor_get_width (stage);
+  clip.height = clutter_actor_get_height (stage);
+  if (!geometry_intersect (&read_area, &clip))
+    return;
+
+  backdrop = clutter_backdrop_effect_read_area (self,
+                                                CLUTTER_STAGE (stage),
+                                                &read_area);
+  if (backdrop == NULL)
+    return;
+
+  blurred = _clutter_blur_texture (CLUTTER_STAGE (stage),
+                                   backdrop->texture,
+                                   read_area.width, read_area.height,
+                                   self->radius,
+                                   &blurred_width, &blurred_height);
+
+  _clutter_stage_release_offscreen (CLUTTER_STAGE (stage), backdrop, NULL);
+
+  if (blurred == NULL)
+    return;
+
+  /* paint the backdrop in stage coordinates, before the actor */
+  cogl_push_matrix ();
+
+  cogl_matrix_init_identity (&modelview);
+  _clutter_actor_apply_modelview_transform (stage, &modelview);
+  cogl_set_modelview_matrix (&modelview);
+
+  _clutter_blur_paint_result (CLUTTER_STAGE (stage), blurred,
+                              blurred_width, blurred_height,
+                              (paint_area.x - read_area.x)
+                                / (gfloat) read_area.width,
+                              (paint_area.y - read_area.y)
+                                / (gfloat) read_area.height,
+                              (paint_area.x + paint_area.width - read_area.x)
+                                / (gfloat) read_area.width,
+                              (paint_area.y + paint_area.height - read_area.y)
+                                / (gfloat) read_area.height,
+                              paint_area.x,
+                              paint_area.y,
+                              paint_area.x + paint_area.width,
+                              paint_area.y + paint_area.height,
+                              clutter_actor_get_paint_opacity (self->actor));
+
+  cogl_pop_matrix ();
+}
+
+static void
+clutter_backdrop_effect_run (ClutterEffect         *effect,
+                             ClutterEffectRunFlags  flags)
+{
+  ClutterBackdropEffect *self = CLUTTER_BACKDROP_EFFECT (effect);
+
+  self->actor = clutter_actor_meta_get_actor (CLUTTER_ACTOR_META (effect));
+  if (self->actor == NULL)
+    return;
+
+  if (clutter_actor_meta_get_enabled (CLUTTER_ACTOR_META (effect)) &&
+      self->radius > 0.f)
+    {
+      if (clutter_feature_available (CLUTTER_FEATURE_SHADERS_GLSL))
+        clutter_backdrop_effect_paint_backdrop (self);
+      else
+        {
+          /* if we don't have support for GLSL shaders then we
+           * forcibly disable the ActorMeta
+           */
+          g_warning ("Unable to use the BackdropEffect: the graphics "
+                     "hardware or the current GL driver does not implement "
+                     "support for the GLSL shading language.");
+          clutter_actor_meta_set_enabled (CLUTTER_ACTOR_META (effect), FALSE);
+        }
+    }
+
+  clutter_actor_continue_paint (self->actor);
+}
+
+static void
+clutter_backdrop_effect_finalize (GObject *gobject)
+{
+  ClutterBackdropEffect *self = CLUTTER_BACKDROP_EFFECT (gobject);
+
+  g_free (self->pixels);
+
+  G_OBJECT_CLASS (clutter_backdrop_effect_parent_class)->finalize (gobject);
+}
+
+static void
+clutter_backdrop_effect_set_property (GObject      *gobject,
+                                      guint         prop_id,
+                                      const GValue *value,
+                                      GParamSpec   *pspec)
+{
+  ClutterBackdropEffect *effect = CLUTTER_BACKDROP_EFFECT (gobject);
+
+  switch (prop_id)
+    {
+    case PROP_RADIUS:
+      clutter_backdrop_effect_set_radius (effect, g_value_get_float (value));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+clutter_backdrop_effect_get_property (GObject    *gobject,
+                                      guint       prop_id,
+                                      GValue     *value,
+                                      GParamSpec *pspec)
+{
+  ClutterBackdropEffect *effect = CLUTTER_BACKDROP_EFFECT (gobject);
+
+  switch (prop_id)
+    {
+    case PROP_RADIUS:
+      g_value_set_float (value, effect->radius);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+clutter_backdrop_effect_class_init (ClutterBackdropEffectClass *klass)
+{
+  ClutterEffectClass *effect_class = CLUTTER_EFFECT_CLASS (klass);
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->set_property = clutter_backdrop_effect_set_property;
+  gobject_class->get_property = clutter_backdrop_effect_get_property;
+  gobject_class->finalize = clutter_backdrop_effect_finalize;
+
+  effect_class->run = clutter_backdrop_effect_run;
+
+  /**
+   * ClutterBackdropEffect:radius:
+   *
+   * The radius of the blur applied to the backdrop, in pixels. A radius
+   * of 0.0 disables the backdrop
+   *
+   * Since: 1.8
+   */
+  obj_props[PROP_RADIUS] =
+    g_param_spec_float ("radius",
+                        P_("Radius"),
+                        P_("The radius of the blur, in pixels"),
+                        0.0f, G_MAXFLOAT,
+                        BACKDROP_DEFAULT_RADIUS,
+                        CLUTTER_PARAM_READWRITE);
+
+  g_object_class_install_properties (gobject_class,
+                                     PROP_LAST,
+                                     obj_props);
+}
+
+static void
+clutter_backdrop_effect_init (ClutterBackdropEffect *self)
+{
+  self->radius = BACKDROP_DEFAULT_RADIUS;
+}
+
+/**
+ * clutter_backdrop_effect_new:
+ * @radius: the radius of the blur, in pixels
+ *
+ * Creates a new #ClutterBackdropEffect to be used with
+ * clutter_actor_add_effect()
+ *
+ * Return value: the newly created #ClutterBackdropEffect or %NULL
+ *
+ * Since: 1.8
+ */
+ClutterEffect *
+clutter_backdrop_effect_new (gfloat radius)
+{
+  return g_object_new (CLUTTER_TYPE_BACKDROP_EFFECT,
+                       "radius", radius,
+                       NULL);
+}
+
+/**
+ * clutter_backdrop_effect_set_radius:
+ * @effect: a #ClutterBackdropEffect
+ * @radius: the radius of the blur, in pixels
+ *
+ * Sets the radius of the blur applied to the backdrop of @effect
+ *
+ * Since: 1.8
+ */
+void
+clutter_backdrop_effect_set_radius (ClutterBackdropEffect *effect,
+                                    gfloat                 radius)
+{
+  g_return_if_fail (CLUTTER_IS_BACKDROP_EFFECT (effect));
+  g_return_if_fail (radius >= 0.0f);
+
+  if (effect->radius == radius)
+    return;
+
+  effect->radius = radius;
+
+  if (effect->actor != NULL)
+    clutter_actor_queue_redraw (effect->actor);
+
+  g_object_notify_by_pspec (G_OBJECT (effect), obj_props[PROP_RADIUS]);
+}
+
+/**
+ * clutter_backdrop_effect_get_radius:
+ * @effect: a #ClutterBackdropEffect
+ *
+ * Retrieves the radius of the blur applied to the backdrop of @effect
+ *
+ * Return value: the radius of the blur, in pixels
+ *
+ * Since: 1.8
+ */
+gfloat
+clutter_backdrop_effect_get_radius (ClutterBackdropEffect *effect)
+{
+  g_return_val_if_fail (CLUTTER_IS_BACKDROP_EFFECT (effect), 0.0f);
+
+  return effect->radius;
+}
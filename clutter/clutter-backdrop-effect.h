@@ -0,0 +1,58 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2011  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined(__CLUTTER_H_INSIDE__) && !defined(CLUTTER_COMPILATION)
+#error "Only <clutter/clutter.h> can be included directly."
+#endif
+
+#ifndef __CLUTTER_BACKDROP_EFFECT_H__
+#define __CLUTTER_BACKDROP_EFFECT_H__
+
+#include <clutter/clutter-effect.h>
+
+G_BEGIN_DECLS
+
+#define CLUTTER_TYPE_BACKDROP_EFFECT    (clutter_backdrop_effect_get_type ())
+#define CLUTTER_BACKDROP_EFFECT(obj)    (G_TYPE_CHECK_INSTANCE_CAST ((obj), CLUTTER_TYPE_BACKDROP_EFFECT, ClutterBackdropEffect))
+#define CLUTTER_IS_BACKDROP_EFFECT(obj) (G_TYPE_CHECK_INSTANCE_TYPE ((obj), CLUTTER_TYPE_BACKDROP_EFFECT))
+
+/**
+ * ClutterBackdropEffect:
+ *
+ * <structname>ClutterBackdropEffect</structname> is an opaque structure
+ * whose members cannot be accessed directly
+ *
+ * Since: 1.8
+ */
+typedef struct _ClutterBackdropEffect           ClutterBackdropEffect;
+typedef struct _ClutterBackdropEffectClass      ClutterBackdropEffectClass;
+
+GType clutter_backdrop_effect_get_type (void) G_GNUC_CONST;
+
+ClutterEffect *clutter_backdrop_effect_new        (gfloat                 radius);
+
+void           clutter_backdrop_effect_set_radius (ClutterBackdropEffect *effect,
+                                                   gfloat                 radius);
+gfloat         clutter_backdrop_effect_get_radius (ClutterBackdropEffect *effect);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_BACKDROP_EFFECT_H__ */
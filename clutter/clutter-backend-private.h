@@ -121,6 +121,8 @@ ClutterFeatureFlags _clutter_backend_get_features (ClutterBackend *backend);
 
 gfloat        _clutter_backend_get_units_per_em   (ClutterBackend       *backend,
                                                    PangoFontDescription *font_desc);
+gfloat        _clutter_backend_get_units_per_em_for_font (ClutterBackend *backend,
+                                                          const gchar    *font_name);
 
 gint32 _clutter_backend_get_units_serial (ClutterBackend *backend);
 
@@ -58,6 +58,10 @@ G_DEFINE_ABSTRACT_TYPE (ClutterBackend, clutter_backend, G_TYPE_OBJECT);
 
 #define DEFAULT_FONT_NAME       "Sans 10"
 
+/* the number of font names whose size in pixels of an em is kept by
+ * _clutter_backend_get_units_per_em_for_font() */
+#define UNITS_CACHE_MAX_FONTS   64
+
 #define CLUTTER_BACKEND_GET_PRIVATE(obj) \
 (G_TYPE_INSTANCE_GET_PRIVATE ((obj), CLUTTER_TYPE_BACKEND, ClutterBackendPrivate))
 
@@ -70,6 +74,10 @@ struct _ClutterBackendPrivate
   gfloat units_per_em;
   gint32 units_serial;
 
+  /* font name -> size of an em in pixels, valid for units_cache_serial */
+  GHashTable *units_cache;
+  gint32 units_cache_serial;
+
   GList *event_translators;
 };
 
@@ -110,6 +118,9 @@ clutter_backend_finalize (GObject *gobject)
   g_free (backend->priv->font_name);
   clutter_backend_set_font_options (backend, NULL);
 
+  if (backend->priv->units_cache != NULL)
+    g_hash_table_destroy (backend->priv->units_cache);
+
   G_OBJECT_CLASS (clutter_backend_parent_class)->finalize (gobject);
 }
 
@@ -404,12 +415,17 @@ _clutter_backend_create_context (ClutterBackend  *backend,
                                  GError         **error)
 {
   ClutterBackendClass *klass;
+  gboolean res = TRUE;
+
+  _clutter_startup_phase_begin (CLUTTER_STARTUP_CONTEXT_CREATION);
 
   klass = CLUTTER_BACKEND_GET_CLASS (backend);
   if (klass->create_context)
-    return klass->create_context (backend, error);
+    res = klass->create_context (backend, error);
 
-  return TRUE;
+  _clutter_startup_phase_end (CLUTTER_STARTUP_CONTEXT_CREATION);
+
+  return res;
 }
 
 void
@@ -467,16 +483,12 @@ _clutter_backend_ensure_context (ClutterBackend *backend,
 
           cogl_onscreen_clutter_backend_set_size (width, height);
 
-          /* Eventually we will have a separate CoglFramebuffer for
-           * each stage and each one will track private projection
-           * matrix and viewport state, but until then we need to make
-           * sure we update the projection and viewport whenever we
-           * switch between stages.
-           *
-           * This dirty mechanism will ensure they are asserted before
-           * the next paint... */
-          _clutter_stage_dirty_viewport (stage);
-          _clutter_stage_dirty_projection (stage);
+          /* Each stage has its own CoglFramebuffer, which tracks its
+           * own projection matrix and viewport state; the stage only
+           * sets them again if it is drawing to a framebuffer that
+           * does not have them, so switching between stages does not
+           * need to recompute them. See
+           * _clutter_stage_maybe_setup_viewport() */
         }
 
       /* FIXME: With a NULL stage and thus no active context it may make more
@@ -561,6 +573,67 @@ _clutter_backend_get_units_per_em (ClutterBackend       *backend,
   return priv->units_per_em;
 }
 
+/*< private >
+ * _clutter_backend_get_units_per_em_for_font:
+ * @backend: a #ClutterBackend
+ * @font_name: a font name, as accepted by
+ *   pango_font_description_from_string()
+ *
+ * Retrieves the size of an em in pixels for @font_name, like
+ * _clutter_backend_get_units_per_em() does for a font description.
+ *
+ * The sizes are cached by font name until the units serial of
+ * @backend changes, that is until the resolution or the default font
+ * change, so that converting many values in em does not parse the
+ * same font names over and over.
+ *
+ * Return value: the size of an em in pixels, or -1 if @font_name
+ *   is not valid
+ */
+gfloat
+_clutter_backend_get_units_per_em_for_font (ClutterBackend *backend,
+                                            const gchar    *font_name)
+{
+  ClutterBackendPrivate *priv = backend->priv;
+  PangoFontDescription *font_desc;
+  gpointer cached;
+  gfloat res;
+
+  if (priv->units_cache == NULL)
+    priv->units_cache = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                               g_free,
+                                               g_free);
+
+  if (priv->units_cache_serial != priv->units_serial)
+    {
+      g_hash_table_remove_all (priv->units_cache);
+      priv->units_cache_serial = priv->units_serial;
+    }
+
+  cached = g_hash_table_lookup (priv->units_cache, font_name);
+  if (cached != NULL)
+    return *((gfloat *) cached);
+
+  font_desc = pango_font_description_from_string (font_name);
+  if (font_desc == NULL)
+    return -1.0f;
+
+  res = get_units_per_em (backend, font_desc);
+
+  pango_font_description_free (font_desc);
+
+  /* the font names come from scripts and style sheets, so there are
+   * few of them; start over if something keeps making up new ones */
+  if (g_hash_table_size (priv->units_cache) >= UNITS_CACHE_MAX_FONTS)
+    g_hash_table_remove_all (priv->units_cache);
+
+  g_hash_table_insert (priv->units_cache,
+                       g_strdup (font_name),
+                       g_memdup (&res, sizeof (gfloat)));
+
+  return res;
+}
+
 void
 _clutter_backend_copy_event_data (ClutterBackend     *backend,
                                   const ClutterEvent *src,
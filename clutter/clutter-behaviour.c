@@ -73,6 +73,7 @@
 
 #include "clutter-behaviour.h"
 
+#include "clutter-actor-private.h"
 #include "clutter-debug.h"
 #include "clutter-main.h"
 #include "clutter-marshal.h"
@@ -567,12 +568,41 @@ notify_cb (GObject          *object,
   if (klass->alpha_notify)
     {
       gdouble alpha_value = clutter_alpha_get_alpha (behave->priv->alpha);
+      GPtrArray *batch;
+      GSList *l;
+      guint i;
 
       CLUTTER_NOTE (BEHAVIOUR, "calling %s::alpha_notify (%p, %.4f)",
                     g_type_name (G_TYPE_FROM_CLASS (klass)),
                     behave, alpha_value);
 
+      /* the behaviour usually sets one or more properties on each of
+       * its actors; updating them in a batch coalesces the property
+       * notifications of each actor and queues a single redraw or
+       * relayout for it. The actors are referenced, as they might be
+       * removed from the behaviour by the notification handlers
+       */
+      batch = g_ptr_array_sized_new (g_slist_length (behave->priv->actors));
+
+      for (l = behave->priv->actors; l != NULL; l = l->next)
+        {
+          ClutterActor *actor = g_object_ref (l->data);
+
+          _clutter_actor_begin_update (actor);
+          g_ptr_array_add (batch, actor);
+        }
+
       klass->alpha_notify (behave, alpha_value);
+
+      for (i = 0; i < batch->len; i++)
+        {
+          ClutterActor *actor = g_ptr_array_index (batch, i);
+
+          _clutter_actor_end_update (actor);
+          g_object_unref (actor);
+        }
+
+      g_ptr_array_free (batch, TRUE);
     }
 }
 
@@ -335,15 +335,15 @@ clutter_bin_layout_get_preferred_width (ClutterLayoutManager *manager,
                                         gfloat               *min_width_p,
                                         gfloat               *nat_width_p)
 {
-  GList *children = clutter_container_get_children (container);
-  GList *l;
+  ClutterContainerIter iter;
+  ClutterActor *child;
   gfloat min_width, nat_width;
 
   min_width = nat_width = 0.0;
 
-  for (l = children; l != NULL; l = l->next)
+  clutter_container_iter_init (&iter, container);
+  while (clutter_container_iter_next (&iter, &child))
     {
-      ClutterActor *child = l->data;
       gfloat minimum, natural;
 
       clutter_actor_get_preferred_width (child, for_height,
@@ -368,15 +368,15 @@ clutter_bin_layout_get_preferred_height (ClutterLayoutManager *manager,
                                          gfloat               *min_height_p,
                                          gfloat               *nat_height_p)
 {
-  GList *children = clutter_container_get_children (container);
-  GList *l;
+  ClutterContainerIter iter;
+  ClutterActor *child;
   gfloat min_height, nat_height;
 
   min_height = nat_height = 0.0;
 
-  for (l = children; l != NULL; l = l->next)
+  clutter_container_iter_init (&iter, container);
+  while (clutter_container_iter_next (&iter, &child))
     {
-      ClutterActor *child = l->data;
       gfloat minimum, natural;
 
       clutter_actor_get_preferred_height (child, for_width,
@@ -422,16 +422,16 @@ clutter_bin_layout_allocate (ClutterLayoutManager   *manager,
                              const ClutterActorBox  *allocation,
                              ClutterAllocationFlags  flags)
 {
-  GList *children = clutter_container_get_children (container);
-  GList *l;
+  ClutterContainerIter iter;
+  ClutterActor *child;
   gfloat available_w, available_h;
 
   available_w = clutter_actor_box_get_width (allocation);
   available_h = clutter_actor_box_get_height (allocation);
 
-  for (l = children; l != NULL; l = l->next)
+  clutter_container_iter_init (&iter, container);
+  while (clutter_container_iter_next (&iter, &child))
     {
-      ClutterActor *child = l->data;
       ClutterLayoutMeta *meta;
       ClutterBinLayer *layer;
       ClutterActorBox child_alloc = { 0, };
@@ -466,8 +466,6 @@ clutter_bin_layout_allocate (ClutterLayoutManager   *manager,
                                          x_fill, y_fill,
                                          flags);
     }
-
-  g_list_free (children);
 }
 
 static GType
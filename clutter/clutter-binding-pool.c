@@ -116,6 +116,10 @@
                                   CLUTTER_HYPER_MASK   | \
                                   CLUTTER_META_MASK)   | CLUTTER_RELEASE_MASK)
 
+/* the key of the entries inside the hash table of a pool */
+#define BINDING_KEY(key_val,modifiers) \
+  (((guint64) (modifiers) << 32) | (guint64) (key_val))
+
 typedef struct _ClutterBindingEntry     ClutterBindingEntry;
 
 static GSList *clutter_binding_pools = NULL;
@@ -143,6 +147,9 @@ struct _ClutterBindingEntry
   guint key_val;
   ClutterModifierType modifiers;
 
+  /* key_val and modifiers, packed by BINDING_KEY() */
+  guint64 key;
+
   GClosure *closure;
 
   guint is_blocked  : 1;
@@ -162,25 +169,20 @@ static GParamSpec *obj_props[PROP_LAST];
 G_DEFINE_TYPE (ClutterBindingPool, clutter_binding_pool, G_TYPE_OBJECT);
 
 static guint
-binding_entry_hash (gconstpointer v)
+binding_key_hash (gconstpointer v)
 {
-  const ClutterBindingEntry *e = v;
-  guint h;
+  guint64 key = *((const guint64 *) v);
 
-  h = e->key_val;
-  h ^= e->modifiers;
-
-  return h;
+  /* key symbols use the low bits, while the modifiers are just a
+   * handful of bits, so we spread the latter on the whole hash */
+  return (guint) key ^ ((guint) (key >> 32) * 2654435761u);
 }
 
-static gint
-binding_entry_compare (gconstpointer v1,
-                       gconstpointer v2)
+static gboolean
+binding_key_equal (gconstpointer v1,
+                   gconstpointer v2)
 {
-  const ClutterBindingEntry *e1 = v1;
-  const ClutterBindingEntry *e2 = v2;
-
-  return (e1->key_val == e2->key_val && e1->modifiers == e2->modifiers);
+  return *((const guint64 *) v1) == *((const guint64 *) v2);
 }
 
 static ClutterBindingEntry *
@@ -195,6 +197,7 @@ binding_entry_new (const gchar         *name,
   entry = g_slice_new (ClutterBindingEntry);
   entry->key_val = key_val;
   entry->modifiers = modifiers;
+  entry->key = BINDING_KEY (key_val, modifiers);
   entry->name = (gchar *) g_intern_string (name);
   entry->closure = NULL;
   entry->is_blocked = FALSE;
@@ -207,12 +210,9 @@ binding_pool_lookup_entry (ClutterBindingPool  *pool,
                            guint                key_val,
                            ClutterModifierType  modifiers)
 {
-  ClutterBindingEntry lookup_entry = { 0, };
-
-  lookup_entry.key_val = key_val;
-  lookup_entry.modifiers = modifiers;
+  guint64 key = BINDING_KEY (key_val, modifiers);
 
-  return g_hash_table_lookup (pool->entries_hash, &lookup_entry);
+  return g_hash_table_lookup (pool->entries_hash, &key);
 }
 
 static void
@@ -332,8 +332,8 @@ clutter_binding_pool_init (ClutterBindingPool *pool)
 {
   pool->name = NULL;
   pool->entries = NULL;
-  pool->entries_hash = g_hash_table_new (binding_entry_hash,
-                                         binding_entry_compare);
+  pool->entries_hash = g_hash_table_new (binding_key_hash,
+                                         binding_key_equal);
 
   clutter_binding_pools = g_slist_prepend (clutter_binding_pools, pool);
 }
@@ -406,14 +406,16 @@ clutter_binding_pool_get_for_class (gpointer klass)
   if (G_UNLIKELY (key_class_bindings == 0))
     key_class_bindings = g_quark_from_static_string ("clutter-bindings-set");
 
-  pool = g_dataset_id_get_data (klass, key_class_bindings);
-  if (pool)
+  /* the pool is stored on the type of the class instead of using a
+   * dataset, so that the lookup does not need to take the global
+   * dataset lock; classes of static types are never finalized, so
+   * the pool lives for as long as the class does */
+  pool = g_type_get_qdata (G_TYPE_FROM_CLASS (klass), key_class_bindings);
+  if (G_LIKELY (pool != NULL))
     return pool;
 
   pool = clutter_binding_pool_new (G_OBJECT_CLASS_NAME (klass));
-  g_dataset_id_set_data_full (klass, key_class_bindings,
-                              pool,
-                              g_object_unref);
+  g_type_set_qdata (G_TYPE_FROM_CLASS (klass), key_class_bindings, pool);
 
   return pool;
 }
@@ -514,7 +516,7 @@ clutter_binding_pool_install_action (ClutterBindingPool  *pool,
     }
 
   pool->entries = g_slist_prepend (pool->entries, entry);
-  g_hash_table_insert (pool->entries_hash, entry, entry);
+  g_hash_table_insert (pool->entries_hash, &entry->key, entry);
 }
 
 /**
@@ -580,7 +582,7 @@ clutter_binding_pool_install_closure (ClutterBindingPool  *pool,
     }
 
   pool->entries = g_slist_prepend (pool->entries, entry);
-  g_hash_table_insert (pool->entries_hash, entry, entry);
+  g_hash_table_insert (pool->entries_hash, &entry->key, entry);
 }
 
 /**
@@ -756,7 +758,7 @@ clutter_binding_pool_remove_action (ClutterBindingPool  *pool,
                                     guint                key_val,
                                     ClutterModifierType  modifiers)
 {
-  ClutterBindingEntry remove_entry = { 0, };
+  guint64 key;
   GSList *l;
 
   g_return_if_fail (pool != NULL);
@@ -764,22 +766,20 @@ clutter_binding_pool_remove_action (ClutterBindingPool  *pool,
 
   modifiers = modifiers & BINDING_MOD_MASK;
 
-  remove_entry.key_val = key_val;
-  remove_entry.modifiers = modifiers;
+  key = BINDING_KEY (key_val, modifiers);
 
-  for (l = pool->entries; l != NULL; l = l->data)
+  for (l = pool->entries; l != NULL; l = l->next)
     {
       ClutterBindingEntry *e = l->data;
 
-      if (e->key_val == remove_entry.key_val &&
-          e->modifiers == remove_entry.modifiers)
+      if (e->key == key)
         {
           pool->entries = g_slist_remove_link (pool->entries, l);
           break;
         }
     }
 
-  g_hash_table_remove (pool->entries_hash, &remove_entry);
+  g_hash_table_remove (pool->entries_hash, &key);
 }
 
 static gboolean
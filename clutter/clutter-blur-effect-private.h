@@ -0,0 +1,53 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2011  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CLUTTER_BLUR_EFFECT_PRIVATE_H__
+#define __CLUTTER_BLUR_EFFECT_PRIVATE_H__
+
+#include <clutter/clutter-blur-effect.h>
+#include "clutter-stage-private.h"
+
+G_BEGIN_DECLS
+
+ClutterStageOffscreen * _clutter_blur_texture      (ClutterStage          *stage,
+                                                    CoglHandle             source,
+                                                    gfloat                 width,
+                                                    gfloat                 height,
+                                                    gfloat                 radius,
+                                                    gint                  *blurred_width,
+                                                    gint                  *blurred_height);
+void                    _clutter_blur_paint_result (ClutterStage          *stage,
+                                                    ClutterStageOffscreen *blurred,
+                                                    gint                   blurred_width,
+                                                    gint                   blurred_height,
+                                                    gfloat                 s_1,
+                                                    gfloat                 t_1,
+                                                    gfloat                 s_2,
+                                                    gfloat                 t_2,
+                                                    gfloat                 x_1,
+                                                    gfloat                 y_1,
+                                                    gfloat                 x_2,
+                                                    gfloat                 y_2,
+                                                    guint8                 opacity);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_BLUR_EFFECT_PRIVATE_H__ */
@@ -30,6 +30,12 @@
  * #ClutterBlurEffect is a sub-class of #ClutterEffect that allows blurring a
  * actor and its contents.
  *
+ * The blur is a gaussian blur applied in two separate passes, one
+ * horizontal and one vertical; for big radii the actor is downsampled
+ * first, so that the cost of the effect does not grow with the radius.
+ * The amount of blurring is controlled by the #ClutterBlurEffect:radius
+ * property.
+ *
  * #ClutterBlurEffect is available since Clutter 1.4
  */
 
@@ -41,41 +47,54 @@
 #include "config.h"
 #endif
 
+#include <math.h>
+
 #include "clutter-blur-effect.h"
+#include "clutter-blur-effect-private.h"
 
 #include "cogl/cogl.h"
 
 #include "clutter-debug.h"
 #include "clutter-offscreen-effect.h"
+#include "clutter-offscreen-effect-private.h"
 #include "clutter-private.h"
+#include "clutter-stage-private.h"
+
+/* the default radius of the blur, in pixels */
+#define BLUR_DEFAULT_RADIUS     2.0f
+
+/* the number of taps on each side of the center of the kernel */
+#define BLUR_KERNEL_TAPS        4
 
-#define BLUR_PADDING    2
+/* the maximum number of times the actor is halved in size */
+#define BLUR_MAX_LEVELS         6
 
-/* FIXME - lame shader; we should really have a decoupled
- * horizontal/vertical two pass shader for the gaussian blur
+/* a one dimensional gaussian kernel, with the taps spaced so that the
+ * standard deviation is always two taps; the weights are those of
+ * exp (-i² / 8), normalized. The pixel_step uniform is the distance
+ * between two taps, in texture coordinates, along the direction of the
+ * pass
  */
-static const gchar *box_blur_glsl_shader =
+static const gchar *gaussian_blur_glsl_shader =
 "uniform sampler2D tex;\n"
-"uniform float x_step, y_step;\n"
+"uniform vec2 pixel_step;\n"
 "\n"
-"vec4 get_rgba_rel (sampler2D source, float dx, float dy)\n"
+"vec4 get_rgba_rel (sampler2D source, float offset)\n"
 "{\n"
-"  return texture2D (tex, cogl_tex_coord_in[0].st + vec2 (dx, dy) * 2.0);\n"
+"  vec2 delta = pixel_step * offset;\n"
+"\n"
+"  return texture2D (source, cogl_tex_coord_in[0].st + delta)\n"
+"       + texture2D (source, cogl_tex_coord_in[0].st - delta);\n"
 "}\n"
 "\n"
 "void main ()\n"
 "{\n"
-"  vec4 color = cogl_color_in * texture2D (tex, vec2 (cogl_tex_coord_in[0].xy));\n"
-"  color += get_rgba_rel (tex, -x_step, -y_step);\n"
-"  color += get_rgba_rel (tex,  0.0,    -y_step);\n"
-"  color += get_rgba_rel (tex,  x_step, -y_step);\n"
-"  color += get_rgba_rel (tex, -x_step,  0.0);\n"
-"  color += get_rgba_rel (tex,  0.0,     0.0);\n"
-"  color += get_rgba_rel (tex,  x_step,  0.0);\n"
-"  color += get_rgba_rel (tex, -x_step,  y_step);\n"
-"  color += get_rgba_rel (tex,  0.0,     y_step);\n"
-"  color += get_rgba_rel (tex,  x_step,  y_step);\n"
-"  cogl_color_out = color / 9.0;\n"
+"  vec4 color = texture2D (tex, cogl_tex_coord_in[0].st) * 0.2042;\n"
+"  color += get_rgba_rel (tex, 1.0) * 0.1802;\n"
+"  color += get_rgba_rel (tex, 2.0) * 0.1238;\n"
+"  color += get_rgba_rel (tex, 3.0) * 0.0663;\n"
+"  color += get_rgba_rel (tex, 4.0) * 0.0276;\n"
+"  cogl_color_out = color;\n"
 "}";
 
 struct _ClutterBlurEffect
@@ -85,20 +104,7 @@ struct _ClutterBlurEffect
   /* a back pointer to our actor, so that we can query it */
   ClutterActor *actor;
 
-  /* the parameters; x_step and y_step depend on
-   * the actor's allocation
-   */
-  gfloat x_step;
-  gfloat y_step;
-
-  CoglHandle shader;
-  CoglHandle program;
-
-  gint tex_uniform;
-  gint x_step_uniform;
-  gint y_step_uniform;
-
-  guint is_compiled : 1;
+  gfloat radius;
 };
 
 struct _ClutterBlurEffectClass
@@ -106,19 +112,110 @@ struct _ClutterBlurEffectClass
   ClutterOffscreenEffectClass parent_class;
 };
 
+enum
+{
+  PROP_0,
+
+  PROP_RADIUS,
+
+  PROP_LAST
+};
+
+static GParamSpec *obj_props[PROP_LAST];
+
 G_DEFINE_TYPE (ClutterBlurEffect,
                clutter_blur_effect,
                CLUTTER_TYPE_OFFSCREEN_EFFECT);
 
-static int
-next_p2 (int a)
+/* the passes are the same for every user of the blur, so the program
+ * and the materials running it are shared
+ */
+static CoglHandle blur_program = COGL_INVALID_HANDLE;
+static gint blur_pixel_step_location = -1;
+static gboolean blur_program_failed = FALSE;
+
+/* the blur passes, using the program above */
+static CoglHandle blur_material = COGL_INVALID_HANDLE;
+
+/* the downsampling and the final upscaling; a plain, linearly
+ * filtered texture
+ */
+static CoglHandle scale_material = COGL_INVALID_HANDLE;
+
+/* the number of pixels an actor grows by on each side when blurred */
+static inline gfloat
+blur_padding (ClutterBlurEffect *self)
+{
+  return ceilf (self->radius);
+}
+
+static CoglHandle
+create_pass_material (void)
+{
+  CoglHandle material = cogl_material_new ();
+
+  /* the downsampling relies on the linear filtering to average four
+   * texels at a time, and the taps of the kernel fall in between texels
+   */
+  cogl_material_set_layer_filters (material, 0,
+                                   COGL_MATERIAL_FILTER_LINEAR,
+                                   COGL_MATERIAL_FILTER_LINEAR);
+  cogl_material_set_layer_wrap_mode (material, 0,
+                                     COGL_MATERIAL_WRAP_MODE_CLAMP_TO_EDGE);
+
+  return material;
+}
+
+static gboolean
+blur_ensure_program (void)
 {
-  int rval = 1;
+  CoglHandle shader;
+  gint location;
+
+  if (blur_program != COGL_INVALID_HANDLE)
+    return TRUE;
+
+  /* only complain once */
+  if (blur_program_failed)
+    return FALSE;
+
+  shader = cogl_create_shader (COGL_SHADER_TYPE_FRAGMENT);
+  cogl_shader_source (shader, gaussian_blur_glsl_shader);
+  cogl_shader_compile (shader);
+
+  if (!cogl_shader_is_compiled (shader))
+    {
+      gchar *log_buf = cogl_shader_get_info_log (shader);
+
+      g_warning (G_STRLOC ": Unable to compile the gaussian blur shader: %s",
+                 log_buf);
+      g_free (log_buf);
+
+      cogl_handle_unref (shader);
+
+      blur_program_failed = TRUE;
+
+      return FALSE;
+    }
+
+  blur_program = cogl_create_program ();
+  cogl_program_attach_shader (blur_program, shader);
+  cogl_program_link (blur_program);
+  cogl_handle_unref (shader);
+
+  location = cogl_program_get_uniform_location (blur_program, "tex");
+  if (location > -1)
+    cogl_program_set_uniform_1i (blur_program, location, 0);
+
+  blur_pixel_step_location =
+    cogl_program_get_uniform_location (blur_program, "pixel_step");
 
-  while (rval < a)
-    rval <<= 1;
+  blur_material = create_pass_material ();
+  cogl_material_set_user_program (blur_material, blur_program);
 
-  return rval;
+  scale_material = create_pass_material ();
+
+  return TRUE;
 }
 
 static gboolean
@@ -126,8 +223,6 @@ clutter_blur_effect_pre_paint (ClutterEffect *effect)
 {
   ClutterBlurEffect *self = CLUTTER_BLUR_EFFECT (effect);
   ClutterEffectClass *parent_class;
-  ClutterActorBox allocation;
-  gfloat width, height;
 
   if (!clutter_actor_meta_get_enabled (CLUTTER_ACTOR_META (effect)))
     return FALSE;
@@ -148,77 +243,262 @@ clutter_blur_effect_pre_paint (ClutterEffect *effect)
       return FALSE;
     }
 
-  clutter_actor_get_allocation_box (self->actor, &allocation);
-  clutter_actor_box_get_size (&allocation, &width, &height);
+  parent_class = CLUTTER_EFFECT_CLASS (clutter_blur_effect_parent_class);
+  return parent_class->pre_paint (effect);
+}
+
+/* paints the top left @src_width by @src_height pixels of @source, a
+ * texture that is @source_width by @source_height pixels, over the top
+ * left @width by @height pixels of @dest, which are cleared first
+ */
+static void
+blur_run_pass (CoglHandle             material,
+               CoglHandle             source,
+               gfloat                 src_width,
+               gfloat                 src_height,
+               gfloat                 source_width,
+               gfloat                 source_height,
+               ClutterStageOffscreen *dest,
+               gint                   width,
+               gint                   height)
+{
+  CoglColor transparent;
+  CoglMatrix identity;
+
+  cogl_push_framebuffer (dest->framebuffer);
 
-  self->x_step = 1.0f / (float) next_p2 (width);
-  self->y_step = 1.0f / (float) next_p2 (height);
+  cogl_set_viewport (0, 0, width, height);
 
-  if (self->shader == COGL_INVALID_HANDLE)
-    {
-      self->shader = cogl_create_shader (COGL_SHADER_TYPE_FRAGMENT);
-      cogl_shader_source (self->shader, box_blur_glsl_shader);
+  cogl_matrix_init_identity (&identity);
+  cogl_set_projection_matrix (&identity);
+  cogl_set_modelview_matrix (&identity);
+
+  /* clearing the whole target also makes the pixels around the area we
+   * paint transparent, which is what the next pass needs to sample
+   */
+  cogl_color_init_from_4ub (&transparent, 0, 0, 0, 0);
+  cogl_clear (&transparent, COGL_BUFFER_BIT_COLOR);
+
+  cogl_material_set_layer (material, 0, source);
+  cogl_set_source (material);
+  cogl_rectangle_with_texture_coords (-1.0f, 1.0f, 1.0f, -1.0f,
+                                      0.0f, 0.0f,
+                                      src_width / source_width,
+                                      src_height / source_height);
+
+  cogl_pop_framebuffer ();
+
+  /* the uniforms of the program change between the passes, and the
+   * source of this pass might be reused as the target of the next one
+   */
+  cogl_flush ();
+
+  cogl_material_remove_layer (material, 0);
+}
+
+static void
+blur_set_pixel_step (gfloat x_step,
+                     gfloat y_step)
+{
+  gfloat pixel_step[2] = { x_step, y_step };
+
+  if (blur_pixel_step_location > -1)
+    cogl_program_set_uniform_float (blur_program, blur_pixel_step_location,
+                                    2, 1,
+                                    pixel_step);
+}
 
-      self->is_compiled = FALSE;
-      self->tex_uniform = -1;
-      self->x_step_uniform = -1;
-      self->y_step_uniform = -1;
+/*< private >
+ * _clutter_blur_texture:
+ * @stage: the #ClutterStage lending the intermediate targets
+ * @source: the texture to blur
+ * @width: the width of the area of @source to blur
+ * @height: the height of the area of @source to blur
+ * @radius: the radius of the blur, in pixels
+ * @blurred_width: (out): return location for the width of the result
+ * @blurred_height: (out): return location for the height of the result
+ *
+ * Blurs the top left @width by @height pixels of @source. The image is
+ * halved in size until the kernel covers @radius, each level having a
+ * quarter of the pixels of the previous one, which keeps the cost of
+ * the blur roughly constant as the radius grows.
+ *
+ * The result is in the top left @blurred_width by @blurred_height
+ * pixels of the returned target, which should be painted scaled back
+ * up using _clutter_blur_paint_result().
+ *
+ * Return value: a target borrowed from @stage, or %NULL if the blur
+ *   could not be applied
+ */
+ClutterStageOffscreen *
+_clutter_blur_texture (ClutterStage *stage,
+                       CoglHandle    source,
+                       gfloat        width,
+                       gfloat        height,
+                       gfloat        radius,
+                       gint         *blurred_width,
+                       gint         *blurred_height)
+{
+  ClutterStageOffscreen *scaled, *pass;
+  gfloat src_width, src_height;
+  gfloat source_width, source_height;
+  gint level_width, level_height;
+  gint n_levels, i;
+
+  if (radius <= 0.f || !blur_ensure_program ())
+    return NULL;
+
+  /* halve the size of the image until the kernel covers the radius */
+  n_levels = 0;
+  while (radius > BLUR_KERNEL_TAPS && n_levels < BLUR_MAX_LEVELS)
+    {
+      radius /= 2.0f;
+      n_levels += 1;
     }
 
-  if (self->program == COGL_INVALID_HANDLE)
-    self->program = cogl_create_program ();
+  src_width = width;
+  src_height = height;
+  source_width = cogl_texture_get_width (source);
+  source_height = cogl_texture_get_height (source);
 
-  if (!self->is_compiled)
+  level_width = MAX (ceilf (width), 1);
+  level_height = MAX (ceilf (height), 1);
+
+  scaled = NULL;
+  for (i = 0; i < n_levels; i++)
     {
-      g_assert (self->shader != COGL_INVALID_HANDLE);
-      g_assert (self->program != COGL_INVALID_HANDLE);
+      ClutterStageOffscreen *level;
+
+      level_width = MAX ((level_width + 1) / 2, 1);
+      level_height = MAX ((level_height + 1) / 2, 1);
+
+      level = _clutter_stage_acquire_offscreen (stage,
+                                                level_width,
+                                                level_height,
+                                                COGL_PIXEL_FORMAT_RGBA_8888_PRE);
+      if (level == NULL)
+        goto error;
+
+      blur_run_pass (scale_material, source,
+                     src_width, src_height,
+                     source_width, source_height,
+                     level, level_width, level_height);
+
+      if (scaled != NULL)
+        _clutter_stage_release_offscreen (stage, scaled, NULL);
+
+      scaled = level;
+      source = level->texture;
+      src_width = level_width;
+      src_height = level_height;
+      source_width = level->width;
+      source_height = level->height;
+    }
 
-      cogl_shader_compile (self->shader);
-      if (!cogl_shader_is_compiled (self->shader))
+  pass = _clutter_stage_acquire_offscreen (stage, level_width, level_height,
+                                           COGL_PIXEL_FORMAT_RGBA_8888_PRE);
+  if (pass == NULL)
+    goto error;
+
+  /* we cannot paint over the source, as its owner might use it again */
+  if (scaled == NULL)
+    {
+      scaled = _clutter_stage_acquire_offscreen (stage,
+                                                 level_width,
+                                                 level_height,
+                                                 COGL_PIXEL_FORMAT_RGBA_8888_PRE);
+      if (scaled == NULL)
         {
-          gchar *log_buf = cogl_shader_get_info_log (self->shader);
+          _clutter_stage_release_offscreen (stage, pass, NULL);
+          goto error;
+        }
+    }
 
-          g_warning (G_STRLOC ": Unable to compile the box blur shader: %s",
-                     log_buf);
-          g_free (log_buf);
+  /* the distance between the taps, so that the kernel covers the
+   * radius at the current level
+   */
+  blur_set_pixel_step (radius / BLUR_KERNEL_TAPS / source_width, 0.0f);
+  blur_run_pass (blur_material, source,
+                 src_width, src_height,
+                 source_width, source_height,
+                 pass, level_width, level_height);
 
-          cogl_handle_unref (self->shader);
-          cogl_handle_unref (self->program);
+  blur_set_pixel_step (0.0f, radius / BLUR_KERNEL_TAPS / pass->height);
+  blur_run_pass (blur_material, pass->texture,
+                 level_width, level_height,
+                 pass->width, pass->height,
+                 scaled, level_width, level_height);
 
-          self->shader = COGL_INVALID_HANDLE;
-          self->program = COGL_INVALID_HANDLE;
-        }
-      else
-        {
-          cogl_program_attach_shader (self->program, self->shader);
-          cogl_program_link (self->program);
+  _clutter_stage_release_offscreen (stage, pass, NULL);
 
-          cogl_handle_unref (self->shader);
+  if (blurred_width)
+    *blurred_width = level_width;
 
-          self->is_compiled = TRUE;
+  if (blurred_height)
+    *blurred_height = level_height;
 
-          self->tex_uniform =
-            cogl_program_get_uniform_location (self->program, "tex");
-          self->x_step_uniform =
-            cogl_program_get_uniform_location (self->program, "x_step");
-          self->y_step_uniform =
-            cogl_program_get_uniform_location (self->program, "y_step");
-        }
-    }
+  return scaled;
 
-  parent_class = CLUTTER_EFFECT_CLASS (clutter_blur_effect_parent_class);
-  return parent_class->pre_paint (effect);
+error:
+  if (scaled != NULL)
+    _clutter_stage_release_offscreen (stage, scaled, NULL);
+
+  return NULL;
 }
 
-static CoglHandle
-clutter_blur_effect_create_texture (ClutterOffscreenEffect *effect,
-                                    gfloat                  min_width,
-                                    gfloat                  min_height)
+/*< private >
+ * _clutter_blur_paint_result:
+ * @stage: the #ClutterStage that lent @blurred
+ * @blurred: a target returned by _clutter_blur_texture()
+ * @blurred_width: the width of the blurred image
+ * @blurred_height: the height of the blurred image
+ * @s_1: the horizontal texture coordinate of the left edge, between
+ *   0.0 and 1.0 of the blurred image
+ * @t_1: the vertical texture coordinate of the top edge
+ * @s_2: the horizontal texture coordinate of the right edge
+ * @t_2: the vertical texture coordinate of the bottom edge
+ * @x_1: the left edge of the rectangle to paint
+ * @y_1: the top edge of the rectangle to paint
+ * @x_2: the right edge of the rectangle to paint
+ * @y_2: the bottom edge of the rectangle to paint
+ * @opacity: the opacity to paint with
+ *
+ * Scales the blurred image up over the given rectangle, using the
+ * current modelview, and gives @blurred back to @stage.
+ */
+void
+_clutter_blur_paint_result (ClutterStage          *stage,
+                            ClutterStageOffscreen *blurred,
+                            gint                   blurred_width,
+                            gint                   blurred_height,
+                            gfloat                 s_1,
+                            gfloat                 t_1,
+                            gfloat                 s_2,
+                            gfloat                 t_2,
+                            gfloat                 x_1,
+                            gfloat                 y_1,
+                            gfloat                 x_2,
+                            gfloat                 y_2,
+                            guint8                 opacity)
 {
-  return cogl_texture_new_with_size (min_width + (2 * BLUR_PADDING),
-                                     min_height + (2 * BLUR_PADDING),
-                                     COGL_TEXTURE_NO_SLICING,
-                                     COGL_PIXEL_FORMAT_RGBA_8888_PRE);
+  gfloat s_scale = blurred_width / (gfloat) blurred->width;
+  gfloat t_scale = blurred_height / (gfloat) blurred->height;
+
+  cogl_material_set_color4ub (scale_material,
+                              opacity,
+                              opacity,
+                              opacity,
+                              opacity);
+  cogl_material_set_layer (scale_material, 0, blurred->texture);
+  cogl_set_source (scale_material);
+  cogl_rectangle_with_texture_coords (x_1, y_1, x_2, y_2,
+                                      s_1 * s_scale, t_1 * t_scale,
+                                      s_2 * s_scale, t_2 * t_scale);
+  cogl_material_remove_layer (scale_material, 0);
+  cogl_material_set_color4ub (scale_material, 255, 255, 255, 255);
+
+  /* the next user of the target flushes the rectangle we just queued */
+  _clutter_stage_release_offscreen (stage, blurred, NULL);
 }
 
 static void
@@ -226,26 +506,36 @@ clutter_blur_effect_paint_target (ClutterOffscreenEffect *effect)
 {
   ClutterBlurEffect *self = CLUTTER_BLUR_EFFECT (effect);
   ClutterOffscreenEffectClass *parent;
-  CoglHandle material;
-
-  if (self->program == COGL_INVALID_HANDLE)
+  ClutterStageOffscreen *blurred;
+  ClutterStage *stage;
+  CoglHandle source;
+  gfloat target_width, target_height;
+  gint blurred_width, blurred_height;
+
+  source = _clutter_offscreen_effect_get_texture (effect);
+  if (source == COGL_INVALID_HANDLE ||
+      !clutter_offscreen_effect_get_target_size (effect,
+                                                 &target_width,
+                                                 &target_height))
     goto out;
 
-  if (self->tex_uniform > -1)
-    cogl_program_set_uniform_1i (self->program, self->tex_uniform, 0);
+  stage = CLUTTER_STAGE (clutter_actor_get_stage (self->actor));
 
-  if (self->x_step_uniform > -1)
-    cogl_program_set_uniform_1f (self->program,
-                                 self->x_step_uniform,
-                                 self->x_step);
+  blurred = _clutter_blur_texture (stage, source,
+                                   target_width, target_height,
+                                   self->radius,
+                                   &blurred_width, &blurred_height);
+  if (blurred == NULL)
+    goto out;
 
-  if (self->y_step_uniform > -1)
-    cogl_program_set_uniform_1f (self->program,
-                                 self->y_step_uniform,
-                                 self->y_step);
+  /* scale the blurred image back up over the paint box of the actor */
+  _clutter_blur_paint_result (stage, blurred,
+                              blurred_width, blurred_height,
+                              0.0f, 0.0f, 1.0f, 1.0f,
+                              0.0f, 0.0f, target_width, target_height,
+                              clutter_actor_get_paint_opacity (self->actor));
 
-  material = clutter_offscreen_effect_get_target (effect);
-  cogl_material_set_user_program (material, self->program);
+  return;
 
 out:
   parent = CLUTTER_OFFSCREEN_EFFECT_CLASS (clutter_blur_effect_parent_class);
@@ -256,17 +546,21 @@ static gboolean
 clutter_blur_effect_get_paint_volume (ClutterEffect      *effect,
                                       ClutterPaintVolume *volume)
 {
+  ClutterBlurEffect *self = CLUTTER_BLUR_EFFECT (effect);
   gfloat cur_width, cur_height;
   ClutterVertex origin;
+  gfloat padding;
+
+  padding = blur_padding (self);
 
   clutter_paint_volume_get_origin (volume, &origin);
   cur_width = clutter_paint_volume_get_width (volume);
   cur_height = clutter_paint_volume_get_height (volume);
 
-  origin.x -= BLUR_PADDING;
-  origin.y -= BLUR_PADDING;
-  cur_width += 2 * BLUR_PADDING;
-  cur_height += 2 * BLUR_PADDING;
+  origin.x -= padding;
+  origin.y -= padding;
+  cur_width += 2 * padding;
+  cur_height += 2 * padding;
   clutter_paint_volume_set_origin (volume, &origin);
   clutter_paint_volume_set_width (volume, cur_width);
   clutter_paint_volume_set_height (volume, cur_height);
@@ -275,19 +569,43 @@ clutter_blur_effect_get_paint_volume (ClutterEffect      *effect,
 }
 
 static void
-clutter_blur_effect_dispose (GObject *gobject)
+clutter_blur_effect_set_property (GObject      *gobject,
+                                  guint         prop_id,
+                                  const GValue *value,
+                                  GParamSpec   *pspec)
 {
-  ClutterBlurEffect *self = CLUTTER_BLUR_EFFECT (gobject);
+  ClutterBlurEffect *effect = CLUTTER_BLUR_EFFECT (gobject);
 
-  if (self->program != COGL_INVALID_HANDLE)
+  switch (prop_id)
     {
-      cogl_handle_unref (self->program);
+    case PROP_RADIUS:
+      clutter_blur_effect_set_radius (effect, g_value_get_float (value));
+      break;
 
-      self->program = COGL_INVALID_HANDLE;
-      self->shader = COGL_INVALID_HANDLE;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
     }
+}
+
+static void
+clutter_blur_effect_get_property (GObject    *gobject,
+                                  guint       prop_id,
+                                  GValue     *value,
+                                  GParamSpec *pspec)
+{
+  ClutterBlurEffect *effect = CLUTTER_BLUR_EFFECT (gobject);
+
+  switch (prop_id)
+    {
+    case PROP_RADIUS:
+      g_value_set_float (value, effect->radius);
+      break;
 
-  G_OBJECT_CLASS (clutter_blur_effect_parent_class)->dispose (gobject);
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
 }
 
 static void
@@ -297,19 +615,40 @@ clutter_blur_effect_class_init (ClutterBlurEffectClass *klass)
   GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
   ClutterOffscreenEffectClass *offscreen_class;
 
-  gobject_class->dispose = clutter_blur_effect_dispose;
+  gobject_class->set_property = clutter_blur_effect_set_property;
+  gobject_class->get_property = clutter_blur_effect_get_property;
 
   effect_class->pre_paint = clutter_blur_effect_pre_paint;
   effect_class->get_paint_volume = clutter_blur_effect_get_paint_volume;
 
   offscreen_class = CLUTTER_OFFSCREEN_EFFECT_CLASS (klass);
-  offscreen_class->create_texture = clutter_blur_effect_create_texture;
   offscreen_class->paint_target = clutter_blur_effect_paint_target;
+
+  /**
+   * ClutterBlurEffect:radius:
+   *
+   * The radius of the blur, in pixels. A radius of 0.0 does not blur
+   * the actor at all
+   *
+   * Since: 1.8
+   */
+  obj_props[PROP_RADIUS] =
+    g_param_spec_float ("radius",
+                        P_("Radius"),
+                        P_("The radius of the blur, in pixels"),
+                        0.0f, G_MAXFLOAT,
+                        BLUR_DEFAULT_RADIUS,
+                        CLUTTER_PARAM_READWRITE);
+
+  g_object_class_install_properties (gobject_class,
+                                     PROP_LAST,
+                                     obj_props);
 }
 
 static void
 clutter_blur_effect_init (ClutterBlurEffect *self)
 {
+  self->radius = BLUR_DEFAULT_RADIUS;
 }
 
 /**
@@ -327,3 +666,48 @@ clutter_blur_effect_new (void)
 {
   return g_object_new (CLUTTER_TYPE_BLUR_EFFECT, NULL);
 }
+
+/**
+ * clutter_blur_effect_set_radius:
+ * @effect: a #ClutterBlurEffect
+ * @radius: the radius of the blur, in pixels
+ *
+ * Sets the radius of the blur applied by @effect
+ *
+ * Since: 1.8
+ */
+void
+clutter_blur_effect_set_radius (ClutterBlurEffect *effect,
+                                gfloat             radius)
+{
+  g_return_if_fail (CLUTTER_IS_BLUR_EFFECT (effect));
+  g_return_if_fail (radius >= 0.0f);
+
+  if (effect->radius == radius)
+    return;
+
+  effect->radius = radius;
+
+  if (effect->actor != NULL)
+    clutter_actor_queue_redraw (effect->actor);
+
+  g_object_notify_by_pspec (G_OBJECT (effect), obj_props[PROP_RADIUS]);
+}
+
+/**
+ * clutter_blur_effect_get_radius:
+ * @effect: a #ClutterBlurEffect
+ *
+ * Retrieves the radius of the blur applied by @effect
+ *
+ * Return value: the radius of the blur, in pixels
+ *
+ * Since: 1.8
+ */
+gfloat
+clutter_blur_effect_get_radius (ClutterBlurEffect *effect)
+{
+  g_return_val_if_fail (CLUTTER_IS_BLUR_EFFECT (effect), 0.0f);
+
+  return effect->radius;
+}
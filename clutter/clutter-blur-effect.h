@@ -50,7 +50,11 @@ typedef struct _ClutterBlurEffectClass  ClutterBlurEffectClass;
 
 GType clutter_blur_effect_get_type (void) G_GNUC_CONST;
 
-ClutterEffect *clutter_blur_effect_new (void);
+ClutterEffect *clutter_blur_effect_new        (void);
+
+void           clutter_blur_effect_set_radius (ClutterBlurEffect *effect,
+                                               gfloat             radius);
+gfloat         clutter_blur_effect_get_radius (ClutterBlurEffect *effect);
 
 G_END_DECLS
 
@@ -76,6 +76,8 @@
 #include <math.h>
 
 #include "clutter-box-layout.h"
+
+#include "clutter-actor-private.h"
 #include "clutter-debug.h"
 #include "clutter-enum-types.h"
 #include "clutter-layout-meta.h"
@@ -100,11 +102,16 @@ struct _ClutterBoxLayoutPrivate
   gulong easing_mode;
   guint easing_duration;
 
+  /* the timeline of the current animation */
+  ClutterTimeline *animation_timeline;
+
   guint is_vertical    : 1;
   guint is_pack_start  : 1;
   guint is_animating   : 1;
   guint use_animations : 1;
   guint is_homogeneous : 1;
+  guint is_virtualized : 1;
+  guint parallel_measure : 1;
 };
 
 struct _ClutterBoxChild
@@ -116,6 +123,11 @@ struct _ClutterBoxChild
 
   ClutterActorBox last_allocation;
 
+  /* the distance from the final position of the child to the one
+   * it had when the animation started */
+  gfloat animation_offset_x;
+  gfloat animation_offset_y;
+
   guint x_fill              : 1;
   guint y_fill              : 1;
   guint expand              : 1;
@@ -143,7 +155,9 @@ enum
   PROP_PACK_START,
   PROP_USE_ANIMATIONS,
   PROP_EASING_MODE,
-  PROP_EASING_DURATION
+  PROP_EASING_DURATION,
+  PROP_VIRTUALIZED,
+  PROP_PARALLEL_MEASURE
 };
 
 G_DEFINE_TYPE (ClutterBoxChild,
@@ -477,15 +491,15 @@ clutter_box_layout_set_container (ClutterLayoutManager *layout,
 static void
 get_preferred_width (ClutterBoxLayout *self,
                      ClutterContainer *container,
-                     GList            *children,
                      gfloat            for_height,
                      gfloat           *min_width_p,
                      gfloat           *natural_width_p)
 {
   ClutterBoxLayoutPrivate *priv = self->priv;
+  ClutterContainerIter iter;
+  ClutterActor *child;
   gint n_children = 0;
   gboolean is_rtl;
-  GList *l;
 
   if (min_width_p)
     *min_width_p = 0;
@@ -503,11 +517,10 @@ get_preferred_width (ClutterBoxLayout *self,
   else
     is_rtl = FALSE;
 
-  for (l = (is_rtl) ? g_list_last (children) : children;
-       l != NULL;
-       l = (is_rtl) ? l->prev : l->next)
+  clutter_container_iter_init (&iter, container);
+  while ((is_rtl) ? clutter_container_iter_prev (&iter, &child)
+                  : clutter_container_iter_next (&iter, &child))
     {
-      ClutterActor *child = l->data;
       gfloat child_min = 0, child_nat = 0;
 
       if (!CLUTTER_ACTOR_IS_VISIBLE (child))
@@ -554,15 +567,15 @@ get_preferred_width (ClutterBoxLayout *self,
 static void
 get_preferred_height (ClutterBoxLayout *self,
                       ClutterContainer *container,
-                      GList            *children,
                       gfloat            for_width,
                       gfloat           *min_height_p,
                       gfloat           *natural_height_p)
 {
   ClutterBoxLayoutPrivate *priv = self->priv;
+  ClutterContainerIter iter;
+  ClutterActor *child;
   gint n_children = 0;
   gboolean is_rtl;
-  GList *l;
 
   if (min_height_p)
     *min_height_p = 0;
@@ -580,11 +593,10 @@ get_preferred_height (ClutterBoxLayout *self,
   else
     is_rtl = FALSE;
 
-  for (l = (is_rtl) ? g_list_last (children) : children;
-       l != NULL;
-       l = (is_rtl) ? l->prev : l->next)
+  clutter_container_iter_init (&iter, container);
+  while ((is_rtl) ? clutter_container_iter_prev (&iter, &child)
+                  : clutter_container_iter_next (&iter, &child))
     {
-      ClutterActor *child = l->data;
       gfloat child_min = 0, child_nat = 0;
 
       if (!CLUTTER_ACTOR_IS_VISIBLE (child))
@@ -627,6 +639,14 @@ get_preferred_height (ClutterBoxLayout *self,
     }
 }
 
+static inline gboolean
+box_intersects (const ClutterActorBox *a,
+                const ClutterActorBox *b)
+{
+  return a->x1 < b->x2 && a->x2 > b->x1 &&
+         a->y1 < b->y2 && a->y2 > b->y1;
+}
+
 static void
 allocate_box_child (ClutterBoxLayout       *self,
                     ClutterContainer       *container,
@@ -635,6 +655,7 @@ allocate_box_child (ClutterBoxLayout       *self,
                     gfloat                  avail_width,
                     gfloat                  avail_height,
                     gfloat                  extra_space,
+                    const ClutterActorBox  *visible,
                     ClutterAllocationFlags  flags)
 {
   ClutterBoxLayoutPrivate *priv = self->priv;
@@ -651,10 +672,18 @@ allocate_box_child (ClutterBoxLayout       *self,
                                                 child);
   box_child = CLUTTER_BOX_CHILD (meta);
 
+  /* homogeneous children do not need to be measured to be placed */
+  if (visible != NULL && priv->is_homogeneous)
+    child_nat = 0;
+  else if (priv->is_vertical)
+    clutter_actor_get_preferred_height (child, avail_width,
+                                        NULL, &child_nat);
+  else
+    clutter_actor_get_preferred_width (child, avail_height,
+                                       NULL, &child_nat);
+
   if (priv->is_vertical)
     {
-      clutter_actor_get_preferred_height (child, avail_width,
-                                          NULL, &child_nat);
 
       child_nat = MIN (child_nat, avail_height);
 
@@ -672,9 +701,6 @@ allocate_box_child (ClutterBoxLayout       *self,
     }
   else
     {
-      clutter_actor_get_preferred_width (child, avail_height,
-                                         NULL, &child_nat);
-
       child_nat = MIN (child_nat, avail_width);
 
       child_box.x1 = floorf (*position + 0.5);
@@ -690,6 +716,18 @@ allocate_box_child (ClutterBoxLayout       *self,
       child_box.y2 = floorf (avail_height + 0.5);
     }
 
+  if (visible != NULL && !box_intersects (&child_box, visible))
+    {
+      ClutterActorBox last_box;
+
+      /* children outside of the visible area are not allocated; their
+       * current allocation has to be outside as well, otherwise they
+       * would be painted at a stale position */
+      clutter_actor_get_allocation_box (child, &last_box);
+      if (!box_intersects (&last_box, visible))
+        goto out;
+    }
+
   clutter_actor_allocate_align_fill (child, &child_box,
                                      get_box_alignment_factor (box_child->x_align),
                                      get_box_alignment_factor (box_child->y_align),
@@ -705,7 +743,7 @@ allocate_box_child (ClutterBoxLayout       *self,
   if (priv->use_animations && priv->is_animating)
     {
       ClutterLayoutManager *manager = CLUTTER_LAYOUT_MANAGER (self);
-      ClutterActorBox *start, end;
+      const ClutterActorBox *start;
       gdouble p;
 
       p = clutter_layout_manager_get_animation_progress (manager);
@@ -718,38 +756,38 @@ allocate_box_child (ClutterBoxLayout       *self,
            */
           box_child->last_allocation = child_box;
           box_child->has_last_allocation = TRUE;
-
-          goto do_allocate;
         }
 
+      /* the child keeps its final allocation for the whole animation,
+       * and it is moved from its initial position by an offset that
+       * box_layout_animation_new_frame() updates on every frame
+       */
       start = &box_child->last_allocation;
-      end = child_box;
+      box_child->animation_offset_x = start->x1 - child_box.x1;
+      box_child->animation_offset_y = start->y1 - child_box.y1;
 
-      /* interpolate between the initial and final values */
-      clutter_actor_box_interpolate (start, &end, p, &child_box);
+      _clutter_actor_set_layout_offset (child,
+                                        box_child->animation_offset_x * (1.0 - p),
+                                        box_child->animation_offset_y * (1.0 - p));
 
       CLUTTER_NOTE (ANIMATION,
-                    "Animate { %.1f, %.1f, %.1f, %.1f }\t"
-                     "%.3f * { %.1f, %.1f, %.1f, %.1f }\t"
-                         "-> { %.1f, %.1f, %.1f, %.1f }",
+                    "Animate { %.1f, %.1f } -> { %.1f, %.1f }",
                     start->x1, start->y1,
-                    start->x2, start->y2,
-                    p,
-                    child_box.x1, child_box.y1,
-                    child_box.x2, child_box.y2,
-                    end.x1, end.y1,
-                    end.x2, end.y2);
+                    child_box.x1, child_box.y1);
     }
   else
     {
       /* store the allocation for later animations */
       box_child->last_allocation = child_box;
       box_child->has_last_allocation = TRUE;
-    }
 
-do_allocate:
-  clutter_actor_allocate (child, &child_box, flags);
+      box_child->animation_offset_x = 0;
+      box_child->animation_offset_y = 0;
+
+      _clutter_actor_set_layout_offset (child, 0, 0);
+    }
 
+out:
   if (priv->is_homogeneous)
     *position += (priv->spacing + extra_space);
   else if (box_child->expand)
@@ -766,15 +804,13 @@ clutter_box_layout_get_preferred_width (ClutterLayoutManager *layout,
                                         gfloat               *natural_width_p)
 {
   ClutterBoxLayout *self = CLUTTER_BOX_LAYOUT (layout);
-  GList *children;
 
-  children = clutter_container_get_children (container);
+  if (self->priv->parallel_measure)
+    _clutter_text_prefetch_layouts (container, -1);
 
-  get_preferred_width (self, container, children, for_height,
+  get_preferred_width (self, container, for_height,
                        min_width_p,
                        natural_width_p);
-
-  g_list_free (children);
 }
 
 static void
@@ -785,15 +821,15 @@ clutter_box_layout_get_preferred_height (ClutterLayoutManager *layout,
                                          gfloat               *natural_height_p)
 {
   ClutterBoxLayout *self = CLUTTER_BOX_LAYOUT (layout);
-  GList *children;
 
-  children = clutter_container_get_children (container);
+  /* the children of a vertical box are measured for our width */
+  if (self->priv->parallel_measure)
+    _clutter_text_prefetch_layouts (container,
+                                    self->priv->is_vertical ? for_width : -1);
 
-  get_preferred_height (self, container, children, for_width,
+  get_preferred_height (self, container, for_width,
                         min_height_p,
                         natural_height_p);
-
-  g_list_free (children);
 }
 
 static void
@@ -805,12 +841,14 @@ clutter_box_layout_allocate (ClutterLayoutManager   *layout,
   ClutterBoxLayoutPrivate *priv = CLUTTER_BOX_LAYOUT (layout)->priv;
   gfloat avail_width, avail_height, pref_width, pref_height;
   gint n_expand_children, n_children, extra_space;
-  GList *children, *l;
+  ClutterActorBox visible_box, *visible;
+  ClutterContainerIter iter;
+  ClutterActor *child;
   gfloat position;
   gboolean is_rtl;
 
-  children = clutter_container_get_children (container);
-  if (children == NULL)
+  clutter_container_iter_init (&iter, container);
+  if (!clutter_container_iter_next (&iter, NULL))
     return;
 
   clutter_actor_box_get_size (box, &avail_width, &avail_height);
@@ -819,7 +857,7 @@ clutter_box_layout_allocate (ClutterLayoutManager   *layout,
     {
       get_preferred_height (CLUTTER_BOX_LAYOUT (layout),
                             container,
-                            children, avail_width,
+                            avail_width,
                             NULL,
                             &pref_height);
 
@@ -829,7 +867,7 @@ clutter_box_layout_allocate (ClutterLayoutManager   *layout,
     {
       get_preferred_width (CLUTTER_BOX_LAYOUT (layout),
                            container,
-                           children, avail_height,
+                           avail_height,
                            NULL,
                            &pref_width);
 
@@ -838,13 +876,14 @@ clutter_box_layout_allocate (ClutterLayoutManager   *layout,
 
   /* count the number of children with expand set to TRUE */
   n_children = n_expand_children = 0;
-  for (l = children; l; l = l->next)
+  clutter_container_iter_init (&iter, container);
+  while (clutter_container_iter_next (&iter, &child))
     {
       ClutterLayoutMeta *meta;
 
       meta = clutter_layout_manager_get_child_meta (layout,
                                                     container,
-                                                    l->data);
+                                                    child);
 
       if (CLUTTER_BOX_CHILD (meta)->expand)
         n_expand_children++;
@@ -889,38 +928,87 @@ clutter_box_layout_allocate (ClutterLayoutManager   *layout,
   else
     is_rtl = FALSE;
 
-  if (is_rtl)
+  /* animations interpolate from the last allocation of every child,
+   * so they cannot skip any of them */
+  visible = NULL;
+  if (priv->is_virtualized && !(priv->use_animations && priv->is_animating))
     {
-      for (l = (priv->is_pack_start) ? children : g_list_last (children);
-           l != NULL;
-           l = (priv->is_pack_start) ? l->next : l->prev)
+      if (_clutter_actor_get_visible_box (CLUTTER_ACTOR (container),
+                                          &visible_box))
         {
-          ClutterActor *child = l->data;
+          CLUTTER_NOTE (LAYOUT, "Visible box: { %.2f, %.2f, %.2f, %.2f }",
+                        visible_box.x1, visible_box.y1,
+                        visible_box.x2, visible_box.y2);
+
+          visible = &visible_box;
+        }
+    }
 
+  clutter_container_iter_init (&iter, container);
+
+  if (is_rtl)
+    {
+      while ((priv->is_pack_start)
+               ? clutter_container_iter_next (&iter, &child)
+               : clutter_container_iter_prev (&iter, &child))
+        {
           allocate_box_child (CLUTTER_BOX_LAYOUT (layout), container, child,
                               &position,
                               avail_width,
                               avail_height,
-                              extra_space, flags);
+                              extra_space,
+                              visible,
+                              flags);
         }
     }
   else
     {
-      for (l = (priv->is_pack_start) ? g_list_last (children) : children;
-           l != NULL;
-           l = (priv->is_pack_start) ? l->prev : l->next)
+      while ((priv->is_pack_start)
+               ? clutter_container_iter_prev (&iter, &child)
+               : clutter_container_iter_next (&iter, &child))
         {
-          ClutterActor *child = l->data;
-
           allocate_box_child (CLUTTER_BOX_LAYOUT (layout), container, child,
                               &position,
                               avail_width,
                               avail_height,
-                              extra_space, flags);
+                              extra_space,
+                              visible,
+                              flags);
         }
     }
+}
+
+static void
+box_layout_animation_new_frame (ClutterTimeline  *timeline,
+                                gint              msecs,
+                                ClutterBoxLayout *self)
+{
+  ClutterLayoutManager *manager = CLUTTER_LAYOUT_MANAGER (self);
+  ClutterBoxLayoutPrivate *priv = self->priv;
+  ClutterContainerIter iter;
+  ClutterActor *child;
+  gdouble p;
+
+  if (priv->container == NULL)
+    return;
+
+  p = clutter_layout_manager_get_animation_progress (manager);
+
+  clutter_container_iter_init (&iter, priv->container);
+  while (clutter_container_iter_next (&iter, &child))
+    {
+      ClutterLayoutMeta *meta;
+      ClutterBoxChild *box_child;
 
-  g_list_free (children);
+      meta = clutter_layout_manager_get_child_meta (manager,
+                                                    priv->container,
+                                                    child);
+      box_child = CLUTTER_BOX_CHILD (meta);
+
+      _clutter_actor_set_layout_offset (child,
+                                        box_child->animation_offset_x * (1.0 - p),
+                                        box_child->animation_offset_y * (1.0 - p));
+    }
 }
 
 static ClutterAlpha *
@@ -930,13 +1018,36 @@ clutter_box_layout_begin_animation (ClutterLayoutManager *manager,
 {
   ClutterBoxLayoutPrivate *priv = CLUTTER_BOX_LAYOUT (manager)->priv;
   ClutterLayoutManagerClass *parent_class;
+  ClutterTimeline *timeline;
+  ClutterAlpha *alpha;
 
   priv->is_animating = TRUE;
 
   /* we want the default implementation */
   parent_class = CLUTTER_LAYOUT_MANAGER_CLASS (clutter_box_layout_parent_class);
 
-  return parent_class->begin_animation (manager, duration, easing);
+  alpha = parent_class->begin_animation (manager, duration, easing);
+
+  /* the default implementation allocates the container again on every
+   * frame; we allocate the children in their final state only once,
+   * and then just update their offsets
+   */
+  timeline = clutter_alpha_get_timeline (alpha);
+  if (timeline != priv->animation_timeline)
+    {
+      g_signal_handlers_block_by_func (timeline,
+                                       clutter_layout_manager_layout_changed,
+                                       manager);
+      g_signal_connect (timeline, "new-frame",
+                        G_CALLBACK (box_layout_animation_new_frame),
+                        manager);
+
+      priv->animation_timeline = timeline;
+    }
+
+  clutter_layout_manager_layout_changed (manager);
+
+  return alpha;
 }
 
 static void
@@ -945,6 +1056,17 @@ clutter_box_layout_end_animation (ClutterLayoutManager *manager)
   ClutterBoxLayoutPrivate *priv = CLUTTER_BOX_LAYOUT (manager)->priv;
   ClutterLayoutManagerClass *parent_class;
 
+  if (priv->animation_timeline != NULL)
+    {
+      g_signal_handlers_disconnect_by_func (priv->animation_timeline,
+                                            box_layout_animation_new_frame,
+                                            manager);
+      priv->animation_timeline = NULL;
+    }
+
+  /* the allocation queued by the default implementation clears the
+   * offsets of the children
+   */
   priv->is_animating = FALSE;
 
   /* we want the default implementation */
@@ -990,6 +1112,14 @@ clutter_box_layout_set_property (GObject      *gobject,
       clutter_box_layout_set_easing_duration (self, g_value_get_uint (value));
       break;
 
+    case PROP_VIRTUALIZED:
+      clutter_box_layout_set_virtualized (self, g_value_get_boolean (value));
+      break;
+
+    case PROP_PARALLEL_MEASURE:
+      clutter_box_layout_set_parallel_measure (self, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -1034,6 +1164,14 @@ clutter_box_layout_get_property (GObject    *gobject,
       g_value_set_uint (value, priv->easing_duration);
       break;
 
+    case PROP_VIRTUALIZED:
+      g_value_set_boolean (value, priv->is_virtualized);
+      break;
+
+    case PROP_PARALLEL_MEASURE:
+      g_value_set_boolean (value, priv->parallel_measure);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -1181,6 +1319,45 @@ clutter_box_layout_class_init (ClutterBoxLayoutClass *klass)
                              500,
                              CLUTTER_PARAM_READWRITE);
   g_object_class_install_property (gobject_class, PROP_EASING_DURATION, pspec);
+
+  /**
+   * ClutterBoxLayout:virtualized:
+   *
+   * Whether the #ClutterBoxLayout should allocate only the children
+   * that intersect the visible area of the container, as defined by
+   * the clip of the container and the clips of its parents
+   *
+   * The visible area is computed when the container is allocated, so
+   * scrolling should be implemented by changing the allocation of the
+   * container, for instance by moving it inside a parent that clips to
+   * its allocation
+   *
+   * Since: 1.8
+   */
+  pspec = g_param_spec_boolean ("virtualized",
+                                P_("Virtualized"),
+                                P_("Whether only the visible children "
+                                   "should be allocated"),
+                                FALSE,
+                                CLUTTER_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_VIRTUALIZED, pspec);
+
+  /**
+   * ClutterBoxLayout:parallel-measure:
+   *
+   * Whether the #ClutterBoxLayout should shape the text of its
+   * #ClutterText children using a pool of worker threads before
+   * measuring them
+   *
+   * Since: 1.8
+   */
+  pspec = g_param_spec_boolean ("parallel-measure",
+                                P_("Parallel Measure"),
+                                P_("Whether the text children should be "
+                                   "measured in parallel"),
+                                FALSE,
+                                CLUTTER_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_PARALLEL_MEASURE, pspec);
 }
 
 static void
@@ -1394,6 +1571,58 @@ clutter_box_layout_get_homogeneous (ClutterBoxLayout *layout)
   return layout->priv->is_homogeneous;
 }
 
+/**
+ * clutter_box_layout_set_virtualized:
+ * @layout: a #ClutterBoxLayout
+ * @virtualized: %TRUE if only the visible children should be allocated
+ *
+ * Sets whether the @layout should allocate only the children that
+ * intersect the visible area of the container.
+ *
+ * Homogeneous children are placed without being measured; the other
+ * children still have their preferred size queried, which is usually
+ * answered from the size request cache of each child.
+ *
+ * Since: 1.8
+ */
+void
+clutter_box_layout_set_virtualized (ClutterBoxLayout *layout,
+                                    gboolean          virtualized)
+{
+  ClutterBoxLayoutPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_BOX_LAYOUT (layout));
+
+  priv = layout->priv;
+
+  if (priv->is_virtualized != virtualized)
+    {
+      priv->is_virtualized = !!virtualized;
+
+      clutter_layout_manager_layout_changed (CLUTTER_LAYOUT_MANAGER (layout));
+
+      g_object_notify (G_OBJECT (layout), "virtualized");
+    }
+}
+
+/**
+ * clutter_box_layout_get_virtualized:
+ * @layout: a #ClutterBoxLayout
+ *
+ * Retrieves whether the @layout allocates only the visible children.
+ *
+ * Return value: %TRUE if the #ClutterBoxLayout is virtualized
+ *
+ * Since: 1.8
+ */
+gboolean
+clutter_box_layout_get_virtualized (ClutterBoxLayout *layout)
+{
+  g_return_val_if_fail (CLUTTER_IS_BOX_LAYOUT (layout), FALSE);
+
+  return layout->priv->is_virtualized;
+}
+
 /**
  * clutter_box_layout_set_pack_start:
  * @layout: a #ClutterBoxLayout
@@ -1846,6 +2075,10 @@ clutter_box_layout_get_expand (ClutterBoxLayout *layout,
  * clutter_box_layout_set_easing_duration(); the easing mode to be used
  * by the animations is controlled by clutter_box_layout_set_easing_mode()
  *
+ * The children are allocated in their final size when the animation
+ * begins, and only their position is animated; the layout is not
+ * allocated again on every frame of the animation
+ *
  * Since: 1.2
  */
 void
@@ -1985,3 +2218,63 @@ clutter_box_layout_get_easing_duration (ClutterBoxLayout *layout)
 
   return layout->priv->easing_duration;
 }
+
+/**
+ * clutter_box_layout_set_parallel_measure:
+ * @layout: a #ClutterBoxLayout
+ * @parallel_measure: %TRUE if the text children should be measured
+ *   in parallel
+ *
+ * Sets whether the @layout should shape the text of its #ClutterText
+ * children concurrently, using a pool of worker threads, before
+ * querying their preferred size.
+ *
+ * Measuring a #ClutterText is dominated by the shaping of its text,
+ * which does not depend on the other children; with this mode set,
+ * the size negotiation of containers with many long text children
+ * can use more than one CPU core. Short texts, editable texts and
+ * the texts whose layout is already cached are still measured by
+ * the main thread.
+ *
+ * Each worker thread uses its own font map, but all of them share
+ * the font configuration of the system; this mode should only be
+ * enabled if the fontconfig library in use is thread-safe.
+ *
+ * Since: 1.8
+ */
+void
+clutter_box_layout_set_parallel_measure (ClutterBoxLayout *layout,
+                                         gboolean          parallel_measure)
+{
+  ClutterBoxLayoutPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_BOX_LAYOUT (layout));
+
+  priv = layout->priv;
+
+  if (priv->parallel_measure != parallel_measure)
+    {
+      priv->parallel_measure = !!parallel_measure;
+
+      g_object_notify (G_OBJECT (layout), "parallel-measure");
+    }
+}
+
+/**
+ * clutter_box_layout_get_parallel_measure:
+ * @layout: a #ClutterBoxLayout
+ *
+ * Retrieves whether the @layout measures its text children in
+ * parallel.
+ *
+ * Return value: %TRUE if the text children are measured in parallel
+ *
+ * Since: 1.8
+ */
+gboolean
+clutter_box_layout_get_parallel_measure (ClutterBoxLayout *layout)
+{
+  g_return_val_if_fail (CLUTTER_IS_BOX_LAYOUT (layout), FALSE);
+
+  return layout->priv->parallel_measure;
+}
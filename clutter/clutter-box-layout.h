@@ -108,6 +108,12 @@ gboolean              clutter_box_layout_get_vertical        (ClutterBoxLayout
 void                  clutter_box_layout_set_homogeneous     (ClutterBoxLayout    *layout,
                                                               gboolean             homogeneous);
 gboolean              clutter_box_layout_get_homogeneous     (ClutterBoxLayout    *layout);
+void                  clutter_box_layout_set_virtualized     (ClutterBoxLayout    *layout,
+                                                              gboolean             virtualized);
+gboolean              clutter_box_layout_get_virtualized     (ClutterBoxLayout    *layout);
+void                  clutter_box_layout_set_parallel_measure (ClutterBoxLayout    *layout,
+                                                               gboolean             parallel_measure);
+gboolean              clutter_box_layout_get_parallel_measure (ClutterBoxLayout    *layout);
 void                  clutter_box_layout_set_pack_start      (ClutterBoxLayout    *layout,
                                                               gboolean             pack_start);
 gboolean              clutter_box_layout_get_pack_start      (ClutterBoxLayout    *layout);
@@ -78,7 +78,9 @@
 #include "clutter-box.h"
 
 #include "clutter-actor-private.h"
+#include "clutter-child-array.h"
 #include "clutter-debug.h"
+#include "clutter-display-list.h"
 #include "clutter-enum-types.h"
 #include "clutter-marshal.h"
 #include "clutter-private.h"
@@ -89,7 +91,8 @@ struct _ClutterBoxPrivate
 {
   ClutterLayoutManager *manager;
 
-  GList *children;
+  /* sorted by depth, in paint order */
+  GPtrArray *children;
 
   guint changed_id;
 
@@ -118,60 +121,78 @@ G_DEFINE_TYPE_WITH_CODE (ClutterBox, clutter_box, CLUTTER_TYPE_ACTOR,
                          G_IMPLEMENT_INTERFACE (CLUTTER_TYPE_CONTAINER,
                                                 clutter_container_iface_init));
 
-static gint
-sort_by_depth (gconstpointer a,
-               gconstpointer b)
+static void
+clutter_box_real_add (ClutterContainer *container,
+                      ClutterActor     *actor)
 {
-  gfloat depth_a = clutter_actor_get_depth ((ClutterActor *) a);
-  gfloat depth_b = clutter_actor_get_depth ((ClutterActor *) b);
+  ClutterBoxPrivate *priv = CLUTTER_BOX (container)->priv;
 
-  if (depth_a < depth_b)
-    return -1;
+  g_object_ref (actor);
+
+  /* Insert the child so that the array will still be sorted and the
+     child will be after all of the actors at the same depth */
+  _clutter_child_array_insert_sorted (priv->children, actor);
 
-  if (depth_a > depth_b)
-    return 1;
+  clutter_actor_set_parent (actor, CLUTTER_ACTOR (container));
 
-  return 0;
+  clutter_actor_queue_relayout (actor);
+
+  g_signal_emit_by_name (container, "actor-added", actor);
+
+  g_object_unref (actor);
 }
 
 static void
-clutter_box_real_add (ClutterContainer *container,
-                      ClutterActor     *actor)
+clutter_box_real_add_actors (ClutterContainer    *container,
+                             ClutterActor *const *actors,
+                             guint                n_actors)
 {
   ClutterBoxPrivate *priv = CLUTTER_BOX (container)->priv;
-  GList *l, *prev = NULL;
-  gfloat actor_depth;
+  ClutterActor **added;
+  guint i, n_added;
 
-  g_object_ref (actor);
+  added = g_new (ClutterActor *, n_actors);
+  n_added = 0;
 
-  actor_depth = clutter_actor_get_depth (actor);
+  for (i = 0; i < n_actors; i++)
+    {
+      ClutterActor *actor = actors[i];
 
-  /* Find the right place to insert the child so that it will still be
-     sorted and the child will be after all of the actors at the same
-     depth */
-  for (l = priv->children;
-       l && (clutter_actor_get_depth (l->data) <= actor_depth);
-       l = l->next)
-    prev = l;
+      /* skip duplicates inside the batch */
+      if (clutter_actor_get_parent (actor) != NULL)
+        continue;
 
-  /* Insert the node before the found node */
-  l = g_list_prepend (l, actor);
-  /* Fixup the links */
-  if (prev)
-    {
-      prev->next = l;
-      l->prev = prev;
+      g_object_ref (actor);
+
+      _clutter_child_array_insert_sorted (priv->children, actor);
+      clutter_actor_set_parent (actor, CLUTTER_ACTOR (container));
+
+      added[n_added++] = actor;
     }
-  else
-    priv->children = l;
 
-  clutter_actor_set_parent (actor, CLUTTER_ACTOR (container));
+  /* a single relayout for the whole batch */
+  clutter_actor_queue_relayout (CLUTTER_ACTOR (container));
 
-  clutter_actor_queue_relayout (actor);
+  /* setting layout properties inside the ::actor-added handlers
+   * would queue a relayout for each child; we queue one at the
+   * end instead
+   */
+  if (priv->manager != NULL)
+    _clutter_layout_manager_freeze_layout_change (priv->manager);
 
-  g_signal_emit_by_name (container, "actor-added", actor);
+  for (i = 0; i < n_added; i++)
+    g_signal_emit_by_name (container, "actor-added", added[i]);
 
-  g_object_unref (actor);
+  if (priv->manager != NULL)
+    {
+      _clutter_layout_manager_thaw_layout_change (priv->manager);
+      clutter_actor_queue_relayout (CLUTTER_ACTOR (container));
+    }
+
+  for (i = 0; i < n_added; i++)
+    g_object_unref (added[i]);
+
+  g_free (added);
 }
 
 static void
@@ -182,7 +203,7 @@ clutter_box_real_remove (ClutterContainer *container,
 
   g_object_ref (actor);
 
-  priv->children = g_list_remove (priv->children, actor);
+  _clutter_child_array_remove (priv->children, actor);
   clutter_actor_unparent (actor);
 
   clutter_actor_queue_relayout (CLUTTER_ACTOR (container));
@@ -199,11 +220,11 @@ clutter_box_real_foreach (ClutterContainer *container,
 {
   ClutterBoxPrivate *priv = CLUTTER_BOX (container)->priv;
 
-  /* Using g_list_foreach instead of iterating the list manually
-     because it has better protection against the current node being
-     removed. This will happen for example if someone calls
-     clutter_container_foreach(container, clutter_actor_destroy) */
-  g_list_foreach (priv->children, (GFunc) callback, user_data);
+  /* Iterate over a copy of the array, to be protected against the
+     current child being removed. This will happen for example if
+     someone calls clutter_container_foreach(container,
+     clutter_actor_destroy) */
+  _clutter_child_array_foreach (priv->children, (GFunc) callback, user_data);
 }
 
 static void
@@ -213,15 +234,15 @@ clutter_box_real_raise (ClutterContainer *container,
 {
   ClutterBoxPrivate *priv = CLUTTER_BOX (container)->priv;
 
-  priv->children = g_list_remove (priv->children, actor);
+  _clutter_child_array_remove (priv->children, actor);
 
   if (sibling == NULL)
-    priv->children = g_list_append (priv->children, actor);
+    g_ptr_array_add (priv->children, actor);
   else
     {
-      gint index_ = g_list_index (priv->children, sibling) + 1;
+      gint index_ = _clutter_child_array_index (priv->children, sibling) + 1;
 
-      priv->children = g_list_insert (priv->children, actor, index_);
+      _clutter_child_array_insert (priv->children, index_, actor);
     }
 
   clutter_actor_queue_relayout (CLUTTER_ACTOR (container));
@@ -234,15 +255,15 @@ clutter_box_real_lower (ClutterContainer *container,
 {
   ClutterBoxPrivate *priv = CLUTTER_BOX (container)->priv;
 
-  priv->children = g_list_remove (priv->children, actor);
+  _clutter_child_array_remove (priv->children, actor);
 
   if (sibling == NULL)
-    priv->children = g_list_prepend (priv->children, actor);
+    _clutter_child_array_insert (priv->children, 0, actor);
   else
     {
-      gint index_ = g_list_index (priv->children, sibling);
+      gint index_ = _clutter_child_array_index (priv->children, sibling);
 
-      priv->children = g_list_insert (priv->children, actor, index_);
+      _clutter_child_array_insert (priv->children, index_, actor);
     }
 
   clutter_actor_queue_relayout (CLUTTER_ACTOR (container));
@@ -252,50 +273,78 @@ static void
 clutter_box_real_sort_depth_order (ClutterContainer *container)
 {
   ClutterBoxPrivate *priv = CLUTTER_BOX (container)->priv;
+  ClutterActor *child;
+  gboolean changed;
 
-  priv->children = g_list_sort (priv->children, sort_by_depth);
+  child = _clutter_actor_get_depth_changed_child (CLUTTER_ACTOR (container));
+  if (child != NULL)
+    changed = _clutter_child_array_restack (priv->children, child);
+  else
+    changed = _clutter_child_array_sort_depth (priv->children);
 
-  clutter_actor_queue_relayout (CLUTTER_ACTOR (container));
+  if (changed)
+    clutter_actor_queue_relayout (CLUTTER_ACTOR (container));
+}
+
+static ClutterActor *const *
+clutter_box_real_peek_children (ClutterContainer *container,
+                                guint            *n_children)
+{
+  ClutterBoxPrivate *priv = CLUTTER_BOX (container)->priv;
+
+  *n_children = priv->children->len;
+
+  return (ClutterActor *const *) priv->children->pdata;
 }
 
 static void
 clutter_container_iface_init (ClutterContainerIface *iface)
 {
   iface->add = clutter_box_real_add;
+  iface->add_actors = clutter_box_real_add_actors;
   iface->remove = clutter_box_real_remove;
   iface->foreach = clutter_box_real_foreach;
   iface->raise = clutter_box_real_raise;
   iface->lower = clutter_box_real_lower;
   iface->sort_depth_order = clutter_box_real_sort_depth_order;
+  iface->peek_children = clutter_box_real_peek_children;
 }
 
 static void
 clutter_box_real_paint (ClutterActor *actor)
 {
   ClutterBoxPrivate *priv = CLUTTER_BOX (actor)->priv;
+  guint i;
 
   if (priv->color_set)
     {
       ClutterActorBox box = { 0, };
-      gfloat width, height;
-      guint8 tmp_alpha;
+      ClutterColor color;
+      gfloat coords[4];
 
       clutter_actor_get_allocation_box (actor, &box);
-      clutter_actor_box_get_size (&box, &width, &height);
 
-      tmp_alpha = clutter_actor_get_paint_opacity (actor)
-                * priv->color.alpha
-                / 255;
+      color = priv->color;
+      color.alpha = clutter_actor_get_paint_opacity (actor)
+                  * priv->color.alpha
+                  / 255;
+
+      cogl_set_source_color4ub (color.red,
+                                color.green,
+                                color.blue,
+                                color.alpha);
+
+      coords[0] = 0;
+      coords[1] = 0;
+      clutter_actor_box_get_size (&box, &coords[2], &coords[3]);
 
-      cogl_set_source_color4ub (priv->color.red,
-                                priv->color.green,
-                                priv->color.blue,
-                                tmp_alpha);
+      cogl_rectangles (coords, 1);
 
-      cogl_rectangle (0, 0, width, height);
+      _clutter_display_list_record_color (&color, coords, 1);
     }
 
-  g_list_foreach (priv->children, (GFunc) clutter_actor_paint, NULL);
+  for (i = 0; i < priv->children->len; i++)
+    clutter_actor_paint (g_ptr_array_index (priv->children, i));
 }
 
 static gboolean
@@ -304,7 +353,7 @@ clutter_box_real_get_paint_volume (ClutterActor       *actor,
 {
   ClutterBoxPrivate *priv = CLUTTER_BOX (actor)->priv;
   gboolean retval = FALSE;
-  GList *l;
+  guint i;
 
   /* if we have a background color, and an allocation, then we need to
    * set it as the base of our paint volume
@@ -313,7 +362,7 @@ clutter_box_real_get_paint_volume (ClutterActor       *actor,
     retval = clutter_paint_volume_set_from_allocation (volume, actor);
 
   /* bail out early if we don't have any child */
-  if (priv->children == NULL)
+  if (priv->children->len == 0)
     return retval;
   else
     retval = TRUE;
@@ -321,9 +370,9 @@ clutter_box_real_get_paint_volume (ClutterActor       *actor,
   /* otherwise, union the paint volumes of our children, in case
    * any one of them decides to paint outside the parent's allocation
    */
-  for (l = priv->children; l != NULL; l = l->next)
+  for (i = 0; i < priv->children->len; i++)
     {
-      ClutterActor *child = l->data;
+      ClutterActor *child = g_ptr_array_index (priv->children, i);
       const ClutterPaintVolume *child_volume;
 
       /* This gets the paint volume of the child transformed into the
@@ -343,10 +392,12 @@ clutter_box_real_pick (ClutterActor       *actor,
                        const ClutterColor *pick)
 {
   ClutterBoxPrivate *priv = CLUTTER_BOX (actor)->priv;
+  guint i;
 
   CLUTTER_ACTOR_CLASS (clutter_box_parent_class)->pick (actor, pick);
 
-  g_list_foreach (priv->children, (GFunc) clutter_actor_paint, NULL);
+  for (i = 0; i < priv->children->len; i++)
+    clutter_actor_paint (g_ptr_array_index (priv->children, i));
 }
 
 static void
@@ -399,7 +450,9 @@ clutter_box_destroy (ClutterActor *actor)
   ClutterBoxPrivate *priv = CLUTTER_BOX (actor)->priv;
 
   /* destroy all our children */
-  g_list_foreach (priv->children, (GFunc) clutter_actor_destroy, NULL);
+  _clutter_child_array_foreach (priv->children,
+                                (GFunc) clutter_actor_destroy,
+                                NULL);
 
   if (CLUTTER_ACTOR_CLASS (clutter_box_parent_class)->destroy)
     CLUTTER_ACTOR_CLASS (clutter_box_parent_class)->destroy (actor);
@@ -453,6 +506,16 @@ clutter_box_dispose (GObject *gobject)
   G_OBJECT_CLASS (clutter_box_parent_class)->dispose (gobject);
 }
 
+static void
+clutter_box_finalize (GObject *gobject)
+{
+  ClutterBoxPrivate *priv = CLUTTER_BOX (gobject)->priv;
+
+  g_ptr_array_free (priv->children, TRUE);
+
+  G_OBJECT_CLASS (clutter_box_parent_class)->finalize (gobject);
+}
+
 static void
 clutter_box_set_property (GObject      *gobject,
                           guint         prop_id,
@@ -525,6 +588,11 @@ clutter_box_class_init (ClutterBoxClass *klass)
   gobject_class->set_property = clutter_box_set_property;
   gobject_class->get_property = clutter_box_get_property;
   gobject_class->dispose = clutter_box_dispose;
+  gobject_class->finalize = clutter_box_finalize;
+
+  _clutter_actor_class_register_geometric_pick (actor_class, TRUE,
+                                                NULL, NULL);
+  _clutter_display_list_add_recordable_type (CLUTTER_TYPE_BOX);
 
   /**
    * ClutterBox:layout-manager:
@@ -582,6 +650,8 @@ clutter_box_init (ClutterBox *self)
 {
   self->priv = CLUTTER_BOX_GET_PRIVATE (self);
 
+  self->priv->children = g_ptr_array_new ();
+
   self->priv->color = default_box_color;
 }
 
@@ -963,9 +1033,7 @@ clutter_box_pack_at (ClutterBox   *box,
   priv = box->priv;
 
   /* this is really clutter_box_add() with a different insert() */
-  priv->children = g_list_insert (priv->children,
-                                  actor,
-                                  position);
+  _clutter_child_array_insert (priv->children, position, actor);
 
   clutter_actor_set_parent (actor, CLUTTER_ACTOR (box));
   clutter_actor_queue_relayout (actor);
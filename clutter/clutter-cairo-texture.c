@@ -39,8 +39,9 @@
  * functions; you can use the Cairo API to draw on the context and then
  * call cairo_destroy() when done.
  *
- * As soon as the context is destroyed with cairo_destroy(), the contents
- * of the surface will be uploaded into the #ClutterCairoTexture actor:
+ * Once the context is destroyed with cairo_destroy(), the contents
+ * of the surface will be uploaded into the #ClutterCairoTexture actor
+ * before it is painted again:
  *
  * |[
  *   cairo_t *cr;
@@ -58,6 +59,17 @@
  * #cairo_surface_t each time. You can call
  * clutter_cairo_texture_clear() to erase the contents between calls.
  *
+ * Only the regions passed to clutter_cairo_texture_create_region() are
+ * uploaded to the texture; if many contexts are destroyed between two
+ * frames, their regions are merged and uploaded at once, so drawing a
+ * small part of the surface several times per frame is cheap.
+ *
+ * Expensive drawing can be moved out of the main thread by using
+ * clutter_cairo_texture_draw_in_thread(): the drawing function is
+ * called from a worker thread with a context for a new surface, which
+ * replaces the contents of the #ClutterCairoTexture before the first
+ * frame painted after the drawing has finished.
+ *
  * <warning><para>Note that you should never use the code above inside the
  * #ClutterActor::paint or #ClutterActor::pick virtual functions or
  * signal handlers because it will lead to performance
@@ -84,7 +96,9 @@
 
 #include "clutter-actor-private.h"
 #include "clutter-debug.h"
+#include "clutter-main.h"
 #include "clutter-marshal.h"
+#include "clutter-master-clock.h"
 #include "clutter-private.h"
 
 G_DEFINE_TYPE (ClutterCairoTexture,
@@ -123,6 +137,11 @@ static guint cairo_signals[LAST_SIGNAL] = { 0, };
 #define clutter_warn_if_paint_fail(obj)         /* void */
 #endif /* CLUTTER_ENABLE_DEBUG */
 
+/* the maximum number of rectangles of the dirty region that are
+ * uploaded separately; more complex regions are uploaded using
+ * their extents */
+#define MAX_DIRTY_RECTANGLES    8
+
 #define CLUTTER_CAIRO_TEXTURE_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), CLUTTER_TYPE_CAIRO_TEXTURE, ClutterCairoTexturePrivate))
 
 struct _ClutterCairoTexturePrivate
@@ -133,8 +152,29 @@ struct _ClutterCairoTexturePrivate
 
   guint width;
   guint height;
+
+  /* the area of the surface that has been drawn since the last upload */
+  cairo_region_t *dirty_region;
+
+  /* serial of the last drawing requested with draw_in_thread(), and
+   * of the last one that replaced the surface */
+  guint draw_serial;
+  guint committed_serial;
 };
 
+typedef struct {
+  ClutterCairoTexture *cairo;
+  guint serial;
+
+  cairo_surface_t *surface;
+  guint width;
+  guint height;
+
+  ClutterCairoTextureDrawFunc func;
+  gpointer data;
+  GDestroyNotify notify;
+} ClutterCairoTextureDrawJob;
+
 typedef struct {
   ClutterCairoTexture *cairo;
   cairo_rectangle_int_t rect;
@@ -142,6 +182,11 @@ typedef struct {
 
 static const cairo_user_data_key_t clutter_cairo_texture_context_key;
 
+static GThreadPool *draw_thread_pool = NULL;
+static guint        draw_repaint_func = 0;
+static GList       *draw_commit_list = NULL;
+static GStaticMutex draw_commit_mutex = G_STATIC_MUTEX_INIT;
+
 static void
 clutter_cairo_texture_set_property (GObject      *object,
                                     guint         prop_id,
@@ -199,6 +244,12 @@ clutter_cairo_texture_finalize (GObject *object)
 {
   ClutterCairoTexturePrivate *priv = CLUTTER_CAIRO_TEXTURE (object)->priv;
 
+  if (priv->dirty_region != NULL)
+    {
+      cairo_region_destroy (priv->dirty_region);
+      priv->dirty_region = NULL;
+    }
+
   if (priv->cr_surface != NULL)
     {
       cairo_surface_t *surface = priv->cr_surface;
@@ -255,6 +306,13 @@ clutter_cairo_texture_surface_resize_internal (ClutterCairoTexture *cairo)
       priv->cr_surface = NULL;
     }
 
+  /* the new surface will be uploaded in its entirety */
+  if (priv->dirty_region != NULL)
+    {
+      cairo_region_destroy (priv->dirty_region);
+      priv->dirty_region = NULL;
+    }
+
   if (priv->width == 0 || priv->height == 0)
     return;
 
@@ -315,6 +373,104 @@ clutter_cairo_texture_get_preferred_height (ClutterActor *actor,
     *natural_height = (gfloat) priv->height;
 }
 
+static void
+clutter_cairo_texture_upload_rectangle (ClutterCairoTexture         *self,
+                                        CoglHandle                   texture,
+                                        const cairo_rectangle_int_t *rect)
+{
+  ClutterCairoTexturePrivate *priv = self->priv;
+  guint8 *cairo_data;
+  gint cairo_stride;
+
+  cairo_stride = cairo_image_surface_get_stride (priv->cr_surface);
+  cairo_data = cairo_image_surface_get_data (priv->cr_surface);
+  cairo_data += cairo_stride * rect->y;
+  cairo_data += 4 * rect->x;
+
+  cogl_texture_set_region (texture,
+                           0, 0,
+                           rect->x, rect->y,
+                           rect->width, rect->height,
+                           rect->width, rect->height,
+                           CLUTTER_CAIRO_FORMAT_ARGB32,
+                           cairo_stride,
+                           cairo_data);
+}
+
+/* uploads the parts of the surface drawn since the last upload */
+static void
+clutter_cairo_texture_flush_dirty_region (ClutterCairoTexture *self)
+{
+  ClutterCairoTexturePrivate *priv = self->priv;
+  cairo_region_t *region = priv->dirty_region;
+  cairo_rectangle_int_t surface_rect;
+  CoglHandle cogl_texture;
+  gint n_rects, i;
+
+  if (region == NULL)
+    return;
+
+  priv->dirty_region = NULL;
+
+  cogl_texture = clutter_texture_get_cogl_texture (CLUTTER_TEXTURE (self));
+  if (priv->cr_surface == NULL || cogl_texture == COGL_INVALID_HANDLE)
+    goto out;
+
+  cairo_surface_flush (priv->cr_surface);
+
+  /* a surface returned by a ::create-surface handler might be
+   * smaller than the size of the texture */
+  surface_rect.x = 0;
+  surface_rect.y = 0;
+  surface_rect.width = cairo_image_surface_get_width (priv->cr_surface);
+  surface_rect.height = cairo_image_surface_get_height (priv->cr_surface);
+  cairo_region_intersect_rectangle (region, &surface_rect);
+
+  n_rects = cairo_region_num_rectangles (region);
+
+  CLUTTER_NOTE (TEXTURE, "Uploading %d dirty rectangles of the surface",
+                n_rects > MAX_DIRTY_RECTANGLES ? 1 : n_rects);
+
+  if (n_rects > MAX_DIRTY_RECTANGLES)
+    {
+      cairo_rectangle_int_t extents;
+
+      cairo_region_get_extents (region, &extents);
+      clutter_cairo_texture_upload_rectangle (self, cogl_texture, &extents);
+    }
+  else
+    {
+      for (i = 0; i < n_rects; i++)
+        {
+          cairo_rectangle_int_t rect;
+
+          cairo_region_get_rectangle (region, i, &rect);
+          clutter_cairo_texture_upload_rectangle (self, cogl_texture, &rect);
+        }
+    }
+
+out:
+  cairo_region_destroy (region);
+}
+
+static void
+clutter_cairo_texture_paint (ClutterActor *actor)
+{
+  clutter_cairo_texture_flush_dirty_region (CLUTTER_CAIRO_TEXTURE (actor));
+
+  CLUTTER_ACTOR_CLASS (clutter_cairo_texture_parent_class)->paint (actor);
+}
+
+static void
+clutter_cairo_texture_pick (ClutterActor       *actor,
+                            const ClutterColor *color)
+{
+  /* picking with alpha uses the contents of the texture */
+  clutter_cairo_texture_flush_dirty_region (CLUTTER_CAIRO_TEXTURE (actor));
+
+  CLUTTER_ACTOR_CLASS (clutter_cairo_texture_parent_class)->pick (actor, color);
+}
+
 static gboolean
 clutter_cairo_texture_get_paint_volume (ClutterActor       *self,
                                         ClutterPaintVolume *volume)
@@ -380,6 +536,8 @@ clutter_cairo_texture_class_init (ClutterCairoTextureClass *klass)
   gobject_class->get_property = clutter_cairo_texture_get_property;
   gobject_class->notify       = clutter_cairo_texture_notify;
 
+  actor_class->paint = clutter_cairo_texture_paint;
+  actor_class->pick = clutter_cairo_texture_pick;
   actor_class->get_paint_volume =
     clutter_cairo_texture_get_paint_volume;
   actor_class->get_preferred_width =
@@ -510,13 +668,12 @@ clutter_cairo_texture_context_destroy (void *data)
   ClutterCairoTextureContext *ctxt = data;
   ClutterCairoTexture *cairo = ctxt->cairo;
   ClutterCairoTexturePrivate *priv = cairo->priv;
-  guint8 *cairo_data;
-  gint cairo_width, cairo_height, cairo_stride;
-  gint surface_width, surface_height;
-  CoglHandle cogl_texture;
 
   if (priv->cr_surface == NULL)
-    return;
+    {
+      g_slice_free (ClutterCairoTextureContext, ctxt);
+      return;
+    }
 
   /* for any other surface type, we presume that there exists a native
    * communication between Cairo and GL that is triggered by cairo_destroy().
@@ -528,32 +685,19 @@ clutter_cairo_texture_context_destroy (void *data)
   if (cairo_surface_get_type (priv->cr_surface) != CAIRO_SURFACE_TYPE_IMAGE)
     goto out;
 
-  surface_width  = cairo_image_surface_get_width (priv->cr_surface);
-  surface_height = cairo_image_surface_get_height (priv->cr_surface);
-
-  cairo_width  = MIN (ctxt->rect.width, surface_width);
-  cairo_height = MIN (ctxt->rect.height, surface_height);
-
-  cogl_texture = clutter_texture_get_cogl_texture (CLUTTER_TEXTURE (cairo));
-  if (!cairo_width || !cairo_height || cogl_texture == COGL_INVALID_HANDLE)
+  if (ctxt->rect.width == 0 || ctxt->rect.height == 0 ||
+      clutter_texture_get_cogl_texture (CLUTTER_TEXTURE (cairo)) == COGL_INVALID_HANDLE)
     {
       g_slice_free (ClutterCairoTextureContext, ctxt);
       return;
     }
 
-  cairo_stride = cairo_image_surface_get_stride (priv->cr_surface);
-  cairo_data = cairo_image_surface_get_data (priv->cr_surface);
-  cairo_data += cairo_stride * ctxt->rect.y;
-  cairo_data += 4 * ctxt->rect.x;
-
-  cogl_texture_set_region (cogl_texture,
-                           0, 0,
-                           ctxt->rect.x, ctxt->rect.y,
-                           cairo_width, cairo_height,
-                           cairo_width, cairo_height,
-                           CLUTTER_CAIRO_FORMAT_ARGB32,
-                           cairo_stride,
-                           cairo_data);
+  /* the upload is deferred until the next paint, so that the regions
+   * of all the contexts destroyed in between are uploaded in one go */
+  if (priv->dirty_region == NULL)
+    priv->dirty_region = cairo_region_create_rectangle (&ctxt->rect);
+  else
+    cairo_region_union_rectangle (priv->dirty_region, &ctxt->rect);
 
 out:
   g_slice_free (ClutterCairoTextureContext, ctxt);
@@ -821,3 +965,205 @@ clutter_cairo_texture_clear (ClutterCairoTexture *self)
   cairo_paint (cr);
   cairo_destroy (cr);
 }
+
+static void
+clutter_cairo_texture_draw_job_free (ClutterCairoTextureDrawJob *job)
+{
+  if (job->notify != NULL)
+    job->notify (job->data);
+
+  if (job->surface != NULL)
+    cairo_surface_destroy (job->surface);
+
+  g_object_unref (job->cairo);
+
+  g_slice_free (ClutterCairoTextureDrawJob, job);
+}
+
+/* replaces the surface of the texture with the one drawn by @job;
+ * this is called from the main thread */
+static void
+clutter_cairo_texture_commit_draw_job (ClutterCairoTextureDrawJob *job)
+{
+  ClutterCairoTexture *self = job->cairo;
+  ClutterCairoTexturePrivate *priv = self->priv;
+  cairo_rectangle_int_t rect;
+
+  /* drop the surface if a more recent drawing has been committed in
+   * the meantime, or if the size of the texture has changed */
+  if (job->serial <= priv->committed_serial ||
+      job->width != priv->width ||
+      job->height != priv->height ||
+      CLUTTER_ACTOR_IN_DESTRUCTION (self))
+    {
+      CLUTTER_NOTE (TEXTURE, "Discarding the surface drawn in a thread");
+      return;
+    }
+
+  /* make sure that there is a Cogl texture of the right size */
+  if (get_surface (self) == NULL ||
+      clutter_texture_get_cogl_texture (CLUTTER_TEXTURE (self)) == COGL_INVALID_HANDLE)
+    return;
+
+  priv->committed_serial = job->serial;
+
+  cairo_surface_finish (priv->cr_surface);
+  cairo_surface_destroy (priv->cr_surface);
+
+  priv->cr_surface = job->surface;
+  job->surface = NULL;
+
+  rect.x = 0;
+  rect.y = 0;
+  rect.width = job->width;
+  rect.height = job->height;
+
+  if (priv->dirty_region != NULL)
+    cairo_region_destroy (priv->dirty_region);
+
+  priv->dirty_region = cairo_region_create_rectangle (&rect);
+
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (self));
+}
+
+static gboolean
+clutter_cairo_texture_draw_repaint_func (gpointer data)
+{
+  GList *jobs, *l;
+
+  g_static_mutex_lock (&draw_commit_mutex);
+  jobs = draw_commit_list;
+  draw_commit_list = NULL;
+  g_static_mutex_unlock (&draw_commit_mutex);
+
+  for (l = jobs; l != NULL; l = l->next)
+    {
+      ClutterCairoTextureDrawJob *job = l->data;
+
+      clutter_cairo_texture_commit_draw_job (job);
+      clutter_cairo_texture_draw_job_free (job);
+    }
+
+  g_list_free (jobs);
+
+  return TRUE;
+}
+
+static void
+clutter_cairo_texture_draw_job_run (ClutterCairoTextureDrawJob *job)
+{
+  cairo_t *cr;
+
+  cr = cairo_create (job->surface);
+  job->func (job->cairo, cr, job->data);
+  cairo_destroy (cr);
+
+  cairo_surface_flush (job->surface);
+}
+
+static void
+clutter_cairo_texture_draw_thread_func (gpointer data,
+                                        gpointer pool_data)
+{
+  ClutterCairoTextureDrawJob *job = data;
+  ClutterMasterClock *master_clock = _clutter_master_clock_get_default ();
+
+  clutter_cairo_texture_draw_job_run (job);
+
+  /* the surface is committed from the main thread, before the
+   * next frame is painted */
+  g_static_mutex_lock (&draw_commit_mutex);
+  draw_commit_list = g_list_append (draw_commit_list, job);
+  g_static_mutex_unlock (&draw_commit_mutex);
+
+  _clutter_master_clock_ensure_next_iteration (master_clock);
+}
+
+/**
+ * clutter_cairo_texture_draw_in_thread:
+ * @self: a #ClutterCairoTexture
+ * @func: the function drawing the contents of the texture
+ * @data: data to pass to @func
+ * @notify: (allow-none): function called to free @data, or %NULL
+ *
+ * Draws the whole contents of @self from a worker thread.
+ *
+ * A new image surface of the current size of @self is created, and
+ * @func is called from a worker thread with a Cairo context for it.
+ * Once @func returns, the new surface replaces the surface of @self
+ * before the next frame is painted, so that the contents of @self
+ * are updated atomically.
+ *
+ * The new surface is initially transparent. If the size of the surface
+ * of @self is changed, or if a later call to this function completes
+ * first, the result of @func is discarded.
+ *
+ * Since @func runs outside of the main thread, it must only use the
+ * Cairo context it is passed and its own @data; in particular, it must
+ * not call any Clutter function. @notify is called from the main thread.
+ *
+ * If threads have not been initialized, @func is called immediately
+ * from the calling thread.
+ *
+ * Since: 1.8
+ */
+void
+clutter_cairo_texture_draw_in_thread (ClutterCairoTexture         *self,
+                                      ClutterCairoTextureDrawFunc  func,
+                                      gpointer                     data,
+                                      GDestroyNotify               notify)
+{
+  ClutterCairoTexturePrivate *priv;
+  ClutterCairoTextureDrawJob *job;
+
+  g_return_if_fail (CLUTTER_IS_CAIRO_TEXTURE (self));
+  g_return_if_fail (func != NULL);
+
+  priv = self->priv;
+
+  if (priv->width == 0 || priv->height == 0)
+    {
+      g_warning ("Unable to draw on an image surface of width %d and "
+                 "height %d. Set the surface size to be at least 1 pixel "
+                 "by 1 pixel.",
+                 priv->width, priv->height);
+
+      if (notify != NULL)
+        notify (data);
+
+      return;
+    }
+
+  job = g_slice_new0 (ClutterCairoTextureDrawJob);
+  job->cairo = g_object_ref (self);
+  job->serial = ++priv->draw_serial;
+  job->width = priv->width;
+  job->height = priv->height;
+  job->surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                             job->width,
+                                             job->height);
+  job->func = func;
+  job->data = data;
+  job->notify = notify;
+
+  if (!g_thread_supported ())
+    {
+      clutter_cairo_texture_draw_job_run (job);
+      clutter_cairo_texture_commit_draw_job (job);
+      clutter_cairo_texture_draw_job_free (job);
+      return;
+    }
+
+  if (draw_repaint_func == 0)
+    draw_repaint_func =
+      clutter_threads_add_repaint_func (clutter_cairo_texture_draw_repaint_func,
+                                        NULL, NULL);
+
+  if (draw_thread_pool == NULL)
+    /* This apparently can't fail if exclusive == FALSE */
+    draw_thread_pool =
+      g_thread_pool_new (clutter_cairo_texture_draw_thread_func,
+                         NULL, 1, FALSE, NULL);
+
+  g_thread_pool_push (draw_thread_pool, job, NULL);
+}
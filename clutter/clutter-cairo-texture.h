@@ -68,6 +68,22 @@ typedef struct _ClutterCairoTexture             ClutterCairoTexture;
 typedef struct _ClutterCairoTextureClass        ClutterCairoTextureClass;
 typedef struct _ClutterCairoTexturePrivate      ClutterCairoTexturePrivate;
 
+/**
+ * ClutterCairoTextureDrawFunc:
+ * @texture: the #ClutterCairoTexture being drawn
+ * @cr: a Cairo context for the new surface of @texture
+ * @data: the data passed to clutter_cairo_texture_draw_in_thread()
+ *
+ * The function used by clutter_cairo_texture_draw_in_thread() to draw
+ * the contents of a #ClutterCairoTexture. This function is called from
+ * a worker thread, and must not call any Clutter function.
+ *
+ * Since: 1.8
+ */
+typedef void (* ClutterCairoTextureDrawFunc) (ClutterCairoTexture *texture,
+                                              cairo_t             *cr,
+                                              gpointer             data);
+
 /**
  * ClutterCairoTexture:
  *
@@ -126,6 +142,11 @@ void          clutter_cairo_texture_get_surface_size (ClutterCairoTexture *self,
 
 void          clutter_cairo_texture_clear            (ClutterCairoTexture *self);
 
+void          clutter_cairo_texture_draw_in_thread   (ClutterCairoTexture         *self,
+                                                      ClutterCairoTextureDrawFunc  func,
+                                                      gpointer                     data,
+                                                      GDestroyNotify               notify);
+
 void          clutter_cairo_set_source_color         (cairo_t             *cr,
 						      const ClutterColor  *color);
 
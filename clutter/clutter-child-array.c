@@ -0,0 +1,328 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2011 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Depth-ordered storage for the children of a container, backed
+ * by a GPtrArray.
+ *
+ * The array keeps the children in paint order, which is also the
+ * ascending depth order; indexed access and appending are O(1), and
+ * inserting a child at its depth costs a binary search plus a single
+ * memmove() of the tail of the array.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "clutter-child-array.h"
+
+/*< private >
+ * _clutter_child_array_insert:
+ * @array: a #GPtrArray of actors
+ * @index_: the position of the new element, or -1 to append
+ * @actor: a #ClutterActor
+ *
+ * Inserts @actor inside @array at @index_. If @index_ is negative
+ * or larger than the size of the array, @actor will be appended
+ */
+void
+_clutter_child_array_insert (GPtrArray    *array,
+                             gint          index_,
+                             ClutterActor *actor)
+{
+  guint pos;
+
+  if (index_ < 0 || index_ >= (gint) array->len)
+    {
+      g_ptr_array_add (array, actor);
+      return;
+    }
+
+  pos = index_;
+
+  /* grow the array by one, then shift the tail */
+  g_ptr_array_set_size (array, array->len + 1);
+  memmove (array->pdata + pos + 1,
+           array->pdata + pos,
+           (array->len - pos - 1) * sizeof (gpointer));
+
+  array->pdata[pos] = actor;
+}
+
+/*< private >
+ * _clutter_child_array_insert_sorted:
+ * @array: a #GPtrArray of actors, sorted by depth
+ * @actor: a #ClutterActor
+ *
+ * Inserts @actor inside @array, after all the actors with a depth
+ * lower or equal to the depth of @actor, so that the ordering of the
+ * array is stable. Appending an actor at the top of the stack does
+ * not require any search
+ *
+ * Return value: the position of @actor inside @array
+ */
+guint
+_clutter_child_array_insert_sorted (GPtrArray    *array,
+                                    ClutterActor *actor)
+{
+  gfloat depth = clutter_actor_get_depth (actor);
+  guint lo, hi;
+
+  /* fast path for the common case of actors added at the same depth
+   * as, or above, the topmost child
+   */
+  if (array->len == 0 ||
+      clutter_actor_get_depth (g_ptr_array_index (array, array->len - 1)) <= depth)
+    {
+      g_ptr_array_add (array, actor);
+      return array->len - 1;
+    }
+
+  /* upper bound: first element with a depth strictly bigger */
+  lo = 0;
+  hi = array->len - 1;
+  while (lo < hi)
+    {
+      guint mid = lo + (hi - lo) / 2;
+
+      if (clutter_actor_get_depth (g_ptr_array_index (array, mid)) <= depth)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  _clutter_child_array_insert (array, lo, actor);
+
+  return lo;
+}
+
+/*< private >
+ * _clutter_child_array_remove:
+ * @array: a #GPtrArray of actors
+ * @actor: a #ClutterActor
+ *
+ * Removes @actor from @array, preserving the order of the other
+ * actors.
+ *
+ * The search starts from the top of the stack, so that removing
+ * the children of a container in reverse paint order, or removing
+ * an actor that was just added, does not need to scan the array
+ *
+ * Return value: %TRUE if @actor was found
+ */
+gboolean
+_clutter_child_array_remove (GPtrArray    *array,
+                             ClutterActor *actor)
+{
+  guint i;
+
+  for (i = array->len; i > 0; i--)
+    {
+      if (g_ptr_array_index (array, i - 1) == actor)
+        {
+          g_ptr_array_remove_index (array, i - 1);
+          return TRUE;
+        }
+    }
+
+  return FALSE;
+}
+
+/*< private >
+ * _clutter_child_array_index:
+ * @array: a #GPtrArray of actors
+ * @actor: a #ClutterActor
+ *
+ * Retrieves the position of @actor inside @array
+ *
+ * Return value: the index of @actor, or -1
+ */
+gint
+_clutter_child_array_index (GPtrArray    *array,
+                            ClutterActor *actor)
+{
+  guint i;
+
+  for (i = 0; i < array->len; i++)
+    {
+      if (g_ptr_array_index (array, i) == actor)
+        return i;
+    }
+
+  return -1;
+}
+
+/*< private >
+ * _clutter_child_array_sort_depth:
+ * @array: a #GPtrArray of actors
+ *
+ * Restores the depth ordering of @array. Actors at the same depth
+ * keep their relative position.
+ *
+ * The array is usually already sorted, except for the one actor that
+ * changed depth, so we use an insertion sort: it's linear on a sorted
+ * array, and it only moves the elements that are out of place.
+ *
+ * Return value: %TRUE if the order of the array changed
+ */
+gboolean
+_clutter_child_array_sort_depth (GPtrArray *array)
+{
+  gboolean changed = FALSE;
+  guint i;
+
+  for (i = 1; i < array->len; i++)
+    {
+      gpointer actor = g_ptr_array_index (array, i);
+      gfloat depth = clutter_actor_get_depth (actor);
+      guint j = i;
+
+      while (j > 0 &&
+             clutter_actor_get_depth (array->pdata[j - 1]) > depth)
+        {
+          array->pdata[j] = array->pdata[j - 1];
+          j -= 1;
+        }
+
+      if (j != i)
+        {
+          array->pdata[j] = actor;
+          changed = TRUE;
+        }
+    }
+
+  return changed;
+}
+
+/*< private >
+ * _clutter_child_array_restack:
+ * @array: a #GPtrArray of actors, sorted by depth except for @actor
+ * @actor: a #ClutterActor that changed depth
+ *
+ * Restores the depth ordering of @array after the depth of @actor
+ * changed, with the same result as _clutter_child_array_sort_depth().
+ *
+ * Comparing @actor with its two neighbours is enough to know whether
+ * the order is still valid, which is the common case when animating
+ * the depth of a child; otherwise the new position is found with a
+ * binary search, and @actor is moved there with a single memmove()
+ *
+ * Return value: %TRUE if the order of the array changed
+ */
+gboolean
+_clutter_child_array_restack (GPtrArray    *array,
+                              ClutterActor *actor)
+{
+  gfloat depth = clutter_actor_get_depth (actor);
+  gint index_;
+  guint pos, lo, hi;
+
+  index_ = _clutter_child_array_index (array, actor);
+  if (index_ < 0)
+    return FALSE;
+
+  pos = index_;
+
+  if (pos > 0 &&
+      clutter_actor_get_depth (array->pdata[pos - 1]) > depth)
+    {
+      /* moving down: after the last actor below with a depth lower
+       * or equal to the new one */
+      lo = 0;
+      hi = pos - 1;
+      while (lo < hi)
+        {
+          guint mid = lo + (hi - lo) / 2;
+
+          if (clutter_actor_get_depth (array->pdata[mid]) <= depth)
+            lo = mid + 1;
+          else
+            hi = mid;
+        }
+
+      memmove (array->pdata + lo + 1,
+               array->pdata + lo,
+               (pos - lo) * sizeof (gpointer));
+      array->pdata[lo] = actor;
+
+      return TRUE;
+    }
+
+  if (pos + 1 < array->len &&
+      clutter_actor_get_depth (array->pdata[pos + 1]) < depth)
+    {
+      /* moving up: before the first actor above with a depth bigger
+       * or equal to the new one */
+      lo = pos + 1;
+      hi = array->len;
+      while (lo < hi)
+        {
+          guint mid = lo + (hi - lo) / 2;
+
+          if (clutter_actor_get_depth (array->pdata[mid]) < depth)
+            lo = mid + 1;
+          else
+            hi = mid;
+        }
+
+      memmove (array->pdata + pos,
+               array->pdata + pos + 1,
+               (lo - pos - 1) * sizeof (gpointer));
+      array->pdata[lo - 1] = actor;
+
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+/*< private >
+ * _clutter_child_array_foreach:
+ * @array: a #GPtrArray of actors
+ * @func: the function to call
+ * @user_data: data to pass to @func
+ *
+ * Calls @func for each actor inside @array.
+ *
+ * The iteration happens on a copy of the array, so it is safe for
+ * @func to remove the current actor from @array, for instance when
+ * calling clutter_container_foreach (container, clutter_actor_destroy)
+ */
+void
+_clutter_child_array_foreach (GPtrArray *array,
+                              GFunc      func,
+                              gpointer   user_data)
+{
+  gpointer *children;
+  guint i, n_children;
+
+  n_children = array->len;
+  if (n_children == 0)
+    return;
+
+  children = g_memdup (array->pdata, n_children * sizeof (gpointer));
+
+  for (i = 0; i < n_children; i++)
+    func (children[i], user_data);
+
+  g_free (children);
+}
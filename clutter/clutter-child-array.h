@@ -0,0 +1,50 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2011 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Depth-ordered storage for the children of a container, backed
+ * by a GPtrArray.
+ */
+
+#ifndef __CLUTTER_CHILD_ARRAY_H__
+#define __CLUTTER_CHILD_ARRAY_H__
+
+#include <clutter/clutter-actor.h>
+
+G_BEGIN_DECLS
+
+void     _clutter_child_array_insert        (GPtrArray    *array,
+                                             gint          index_,
+                                             ClutterActor *actor);
+guint    _clutter_child_array_insert_sorted (GPtrArray    *array,
+                                             ClutterActor *actor);
+gboolean _clutter_child_array_remove        (GPtrArray    *array,
+                                             ClutterActor *actor);
+gint     _clutter_child_array_index         (GPtrArray    *array,
+                                             ClutterActor *actor);
+gboolean _clutter_child_array_sort_depth    (GPtrArray    *array);
+gboolean _clutter_child_array_restack       (GPtrArray    *array,
+                                             ClutterActor *actor);
+void     _clutter_child_array_foreach       (GPtrArray    *array,
+                                             GFunc         func,
+                                             gpointer      user_data);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_CHILD_ARRAY_H__ */
@@ -34,6 +34,15 @@
  * which requires support for FBOs in the underlying GL
  * implementation.</para></note>
  *
+ * Each clone paints the whole source again, so many clones of a complex
+ * actor can be expensive. If #ClutterClone:cache-source is set, the
+ * source is instead painted once into an offscreen buffer, shared by
+ * all the clones of the same source using the cache, and each clone
+ * paints that buffer as a single textured rectangle. The buffer is only
+ * updated when the source queues a redraw. The cache requires support
+ * for FBOs, and it only holds what the source paints inside its
+ * allocation, without perspective.
+ *
  * #ClutterClone is available since Clutter 1.0
  */
 
@@ -41,12 +50,15 @@
 #include "config.h"
 #endif
 
+#include <math.h>
+
 #include "clutter-actor-private.h"
 #include "clutter-clone.h"
 #include "clutter-debug.h"
 #include "clutter-main.h"
 #include "clutter-paint-volume-private.h"
 #include "clutter-private.h"
+#include "clutter-stage-private.h"
 
 #include "cogl/cogl.h"
 
@@ -57,6 +69,7 @@ enum
   PROP_0,
 
   PROP_SOURCE,
+  PROP_CACHE_SOURCE,
 
   PROP_LAST
 };
@@ -65,11 +78,43 @@ static GParamSpec *obj_props[PROP_LAST];
 
 #define CLUTTER_CLONE_GET_PRIVATE(obj)  (G_TYPE_INSTANCE_GET_PRIVATE ((obj), CLUTTER_TYPE_CLONE, ClutterClonePrivate))
 
+/* the image of a source, shared by all the clones painting it from
+ * the cache; it is stored on the source actor */
+typedef struct _CloneCache
+{
+  ClutterActor *source;
+
+  /* the stage that holds the target with the image, if any; the
+   * target itself is kept in the pool of the stage between paints */
+  ClutterActor *stage;
+
+  CoglMaterial *material;
+
+  /* the size of the image */
+  gint width;
+  gint height;
+
+  /* the number of clones using the cache */
+  guint n_clones;
+
+  gulong redraw_id;
+
+  /* whether the image matches what the source would paint */
+  guint is_valid : 1;
+} CloneCache;
+
 struct _ClutterClonePrivate
 {
   ClutterActor *clone_source;
+
+  /* the cache of the image of the source, if cache_source is set */
+  CloneCache *cache;
+
+  guint cache_source : 1;
 };
 
+static GQuark quark_clone_cache = 0;
+
 static void clutter_clone_set_source_internal (ClutterClone *clone,
 					       ClutterActor *source);
 static void
@@ -153,21 +198,15 @@ clutter_clone_apply_transform (ClutterActor *self, CoglMatrix *matrix)
   cogl_matrix_scale (matrix, x_scale, y_scale, x_scale);
 }
 
+/* paints the source of @clone with @opacity, using the current
+ * modelview matrix for the transformation of the source */
 static void
-clutter_clone_paint (ClutterActor *self)
+clutter_clone_paint_source (ClutterClone *clone,
+                            guint8        opacity)
 {
-  ClutterClone *clone = CLUTTER_CLONE (self);
   ClutterClonePrivate *priv = clone->priv;
   gboolean was_unmapped = FALSE;
 
-  if (priv->clone_source == NULL)
-    return;
-
-  CLUTTER_NOTE (PAINT,
-                "painting clone actor '%s'",
-		clutter_actor_get_name (self) ? clutter_actor_get_name (self)
-                                              : "unknown");
-
   /* The final bits of magic:
    * - We need to override the paint opacity of the actor with our own
    *   opacity.
@@ -177,8 +216,7 @@ clutter_clone_paint (ClutterActor *self)
    *   the clone source actor.
    */
   _clutter_actor_set_in_clone_paint (priv->clone_source, TRUE);
-  _clutter_actor_set_opacity_override (priv->clone_source,
-                                       clutter_actor_get_paint_opacity (self));
+  _clutter_actor_set_opacity_override (priv->clone_source, opacity);
   _clutter_actor_set_enable_model_view_transform (priv->clone_source, FALSE);
 
   if (!CLUTTER_ACTOR_IS_MAPPED (priv->clone_source))
@@ -199,6 +237,227 @@ clutter_clone_paint (ClutterActor *self)
   _clutter_actor_set_in_clone_paint (priv->clone_source, FALSE);
 }
 
+static void
+clone_cache_source_queue_redraw_cb (ClutterActor *source,
+                                    ClutterActor *origin,
+                                    CloneCache   *cache)
+{
+  cache->is_valid = FALSE;
+}
+
+static void
+clone_cache_set_stage (CloneCache   *cache,
+                       ClutterActor *stage)
+{
+  ClutterStageOffscreen *target;
+
+  if (cache->stage == stage)
+    return;
+
+  /* drop the image we left in the pool of the old stage */
+  if (cache->stage != NULL)
+    {
+      target = _clutter_stage_reclaim_offscreen (CLUTTER_STAGE (cache->stage),
+                                                 cache,
+                                                 cache->width,
+                                                 cache->height,
+                                                 COGL_PIXEL_FORMAT_RGBA_8888_PRE);
+      if (target != NULL)
+        _clutter_stage_release_offscreen (CLUTTER_STAGE (cache->stage),
+                                          target,
+                                          NULL);
+
+      g_object_remove_weak_pointer (G_OBJECT (cache->stage),
+                                    (gpointer *) &cache->stage);
+    }
+
+  cache->stage = stage;
+  cache->is_valid = FALSE;
+
+  if (cache->stage != NULL)
+    g_object_add_weak_pointer (G_OBJECT (cache->stage),
+                               (gpointer *) &cache->stage);
+}
+
+static void
+clone_cache_free (gpointer data)
+{
+  CloneCache *cache = data;
+
+  clone_cache_set_stage (cache, NULL);
+
+  g_signal_handler_disconnect (cache->source, cache->redraw_id);
+
+  if (cache->material != NULL)
+    cogl_handle_unref (cache->material);
+
+  g_slice_free (CloneCache, cache);
+}
+
+static CloneCache *
+clone_cache_ref (ClutterActor *source)
+{
+  CloneCache *cache;
+
+  if (G_UNLIKELY (quark_clone_cache == 0))
+    quark_clone_cache = g_quark_from_static_string ("-clutter-clone-cache");
+
+  cache = g_object_get_qdata (G_OBJECT (source), quark_clone_cache);
+  if (cache == NULL)
+    {
+      cache = g_slice_new0 (CloneCache);
+      cache->source = source;
+      cache->redraw_id =
+        g_signal_connect (source, "queue-redraw",
+                          G_CALLBACK (clone_cache_source_queue_redraw_cb),
+                          cache);
+
+      g_object_set_qdata_full (G_OBJECT (source), quark_clone_cache,
+                               cache,
+                               clone_cache_free);
+    }
+
+  cache->n_clones += 1;
+
+  return cache;
+}
+
+static void
+clone_cache_unref (CloneCache *cache)
+{
+  cache->n_clones -= 1;
+
+  if (cache->n_clones == 0)
+    g_object_set_qdata (G_OBJECT (cache->source), quark_clone_cache, NULL);
+}
+
+/* paints the image of the source of @clone from the cache, updating
+ * it first if needed; returns FALSE if the cache cannot be used */
+static gboolean
+clutter_clone_paint_cached (ClutterClone *clone)
+{
+  ClutterClonePrivate *priv = clone->priv;
+  CloneCache *cache = priv->cache;
+  ClutterStageOffscreen *target;
+  ClutterActorBox box;
+  ClutterActor *stage;
+  guint8 paint_opacity;
+  gint width, height;
+
+  stage = _clutter_actor_get_stage_internal (CLUTTER_ACTOR (clone));
+  if (stage == NULL)
+    return FALSE;
+
+  clutter_actor_get_allocation_box (priv->clone_source, &box);
+  width = ceilf (box.x2 - box.x1);
+  height = ceilf (box.y2 - box.y1);
+  if (width <= 0 || height <= 0)
+    return TRUE;
+
+  clone_cache_set_stage (cache, stage);
+
+  /* the target is given back to the pool after each paint, so it
+   * can be lost if somebody else needed it while we did not paint */
+  target = _clutter_stage_reclaim_offscreen (CLUTTER_STAGE (stage),
+                                             cache,
+                                             width,
+                                             height,
+                                             COGL_PIXEL_FORMAT_RGBA_8888_PRE);
+  if (target == NULL)
+    {
+      target = _clutter_stage_acquire_offscreen (CLUTTER_STAGE (stage),
+                                                 width,
+                                                 height,
+                                                 COGL_PIXEL_FORMAT_RGBA_8888_PRE);
+      if (target == NULL)
+        return FALSE;
+
+      cache->is_valid = FALSE;
+    }
+
+  cache->width = width;
+  cache->height = height;
+
+  if (!cache->is_valid)
+    {
+      CoglMatrix modelview;
+      CoglColor transparent;
+
+      CLUTTER_NOTE (PAINT, "Updating the cached image of the clone source");
+
+      cogl_push_framebuffer (target->framebuffer);
+
+      /* paint the source in its own coordinates, one unit per pixel */
+      cogl_set_viewport (0, 0, target->width, target->height);
+      cogl_ortho (0, target->width, target->height, 0, -1.0f, 1.0f);
+
+      cogl_matrix_init_identity (&modelview);
+      cogl_set_modelview_matrix (&modelview);
+
+      cogl_color_init_from_4ub (&transparent, 0, 0, 0, 0);
+      cogl_clear (&transparent,
+                  COGL_BUFFER_BIT_COLOR |
+                  COGL_BUFFER_BIT_DEPTH);
+
+      /* the image is painted with the opacity of each clone */
+      clutter_clone_paint_source (clone, 0xff);
+
+      cogl_pop_framebuffer ();
+
+      cache->is_valid = TRUE;
+    }
+
+  if (cache->material == NULL)
+    cache->material = cogl_material_new ();
+
+  cogl_material_set_layer (cache->material, 0, target->texture);
+  cogl_material_set_layer_filters (cache->material, 0,
+                                   COGL_MATERIAL_FILTER_LINEAR,
+                                   COGL_MATERIAL_FILTER_LINEAR);
+
+  paint_opacity = clutter_actor_get_paint_opacity (CLUTTER_ACTOR (clone));
+  cogl_material_set_color4ub (cache->material,
+                              paint_opacity,
+                              paint_opacity,
+                              paint_opacity,
+                              paint_opacity);
+  cogl_set_source (cache->material);
+
+  /* the transformation of the clone scales the size of the source
+   * to the size of the clone */
+  cogl_rectangle_with_texture_coords (0, 0, width, height,
+                                      0.0f, 0.0f,
+                                      (gfloat) width / target->width,
+                                      (gfloat) height / target->height);
+
+  /* do not keep the texture alive through the material */
+  cogl_material_remove_layer (cache->material, 0);
+
+  _clutter_stage_release_offscreen (CLUTTER_STAGE (stage), target, cache);
+
+  return TRUE;
+}
+
+static void
+clutter_clone_paint (ClutterActor *self)
+{
+  ClutterClone *clone = CLUTTER_CLONE (self);
+  ClutterClonePrivate *priv = clone->priv;
+
+  if (priv->clone_source == NULL)
+    return;
+
+  CLUTTER_NOTE (PAINT,
+                "painting clone actor '%s'",
+		clutter_actor_get_name (self) ? clutter_actor_get_name (self)
+                                              : "unknown");
+
+  if (priv->cache != NULL && clutter_clone_paint_cached (clone))
+    return;
+
+  clutter_clone_paint_source (clone, clutter_actor_get_paint_opacity (self));
+}
+
 static gboolean
 clutter_clone_get_paint_volume (ClutterActor *self,
                                 ClutterPaintVolume *volume)
@@ -234,6 +493,20 @@ clutter_clone_has_overlaps (ClutterActor *self)
   return clutter_actor_has_overlaps (priv->clone_source);
 }
 
+static gboolean
+clutter_clone_is_opaque (ClutterActor *self)
+{
+  ClutterClonePrivate *priv = CLUTTER_CLONE (self)->priv;
+
+  /* The source is scaled to fill the allocation of the clone, so the
+     clone is opaque iff the source is opaque */
+
+  if (priv->clone_source == NULL)
+    return FALSE;
+
+  return clutter_actor_is_opaque (priv->clone_source);
+}
+
 static void
 clutter_clone_allocate (ClutterActor           *self,
                         const ClutterActorBox  *box,
@@ -274,6 +547,10 @@ clutter_clone_set_property (GObject      *gobject,
       clutter_clone_set_source (clone, g_value_get_object (value));
       break;
 
+    case PROP_CACHE_SOURCE:
+      clutter_clone_set_cache_source (clone, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -294,6 +571,10 @@ clutter_clone_get_property (GObject    *gobject,
       g_value_set_object (value, priv->clone_source);
       break;
 
+    case PROP_CACHE_SOURCE:
+      g_value_set_boolean (value, priv->cache_source);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -323,6 +604,7 @@ clutter_clone_class_init (ClutterCloneClass *klass)
   actor_class->get_preferred_height = clutter_clone_get_preferred_height;
   actor_class->allocate             = clutter_clone_allocate;
   actor_class->has_overlaps         = clutter_clone_has_overlaps;
+  actor_class->is_opaque            = clutter_clone_is_opaque;
 
   gobject_class->dispose      = clutter_clone_dispose;
   gobject_class->set_property = clutter_clone_set_property;
@@ -343,6 +625,22 @@ clutter_clone_class_init (ClutterCloneClass *klass)
                          G_PARAM_CONSTRUCT |
                          CLUTTER_PARAM_READWRITE);
 
+  /**
+   * ClutterClone:cache-source:
+   *
+   * Whether the source should be painted once into an offscreen
+   * buffer, shared with the other clones of the same source, instead
+   * of being painted again by each clone.
+   *
+   * Since: 1.8
+   */
+  obj_props[PROP_CACHE_SOURCE] =
+    g_param_spec_boolean ("cache-source",
+                          P_("Cache Source"),
+                          P_("Whether the clones share an image of the source"),
+                          FALSE,
+                          CLUTTER_PARAM_READWRITE);
+
   g_object_class_install_properties (gobject_class,
                                      PROP_LAST,
                                      obj_props);
@@ -379,7 +677,9 @@ clone_source_queue_redraw_cb (ClutterActor *source,
 			      ClutterActor *origin,
 			      ClutterClone *clone)
 {
-  clutter_actor_queue_redraw (CLUTTER_ACTOR (clone));
+  /* the clone has overlaps if the source has, and the source might
+   * have changed them; this also queues a redraw on the clone */
+  clutter_actor_notify_overlaps_changed (CLUTTER_ACTOR (clone));
 }
 
 static void
@@ -395,6 +695,12 @@ clutter_clone_set_source_internal (ClutterClone *clone,
 {
   ClutterClonePrivate *priv = clone->priv;
 
+  if (priv->cache != NULL)
+    {
+      clone_cache_unref (priv->cache);
+      priv->cache = NULL;
+    }
+
   if (priv->clone_source)
     {
       g_signal_handlers_disconnect_by_func (priv->clone_source,
@@ -414,10 +720,14 @@ clutter_clone_set_source_internal (ClutterClone *clone,
 			G_CALLBACK (clone_source_queue_redraw_cb), clone);
       g_signal_connect (priv->clone_source, "queue-relayout",
 			G_CALLBACK (clone_source_queue_relayout_cb), clone);
+
+      if (priv->cache_source)
+        priv->cache = clone_cache_ref (priv->clone_source);
     }
 
   g_object_notify_by_pspec (G_OBJECT (clone), obj_props[PROP_SOURCE]);
 
+  clutter_actor_notify_overlaps_changed (CLUTTER_ACTOR (clone));
   clutter_actor_queue_relayout (CLUTTER_ACTOR (clone));
 }
 
@@ -458,3 +768,67 @@ clutter_clone_get_source (ClutterClone *clone)
 
   return clone->priv->clone_source;
 }
+
+/**
+ * clutter_clone_set_cache_source:
+ * @clone: a #ClutterClone
+ * @cache_source: whether the image of the source should be cached
+ *
+ * Sets whether @clone should paint its source from an image in an
+ * offscreen buffer, shared with the other clones of the same source
+ * that cache it, instead of painting the source again.
+ *
+ * The image is updated when the source queues a redraw; it only holds
+ * what the source paints inside its allocation. If offscreen buffers
+ * are not available, the source is painted as usual.
+ *
+ * Since: 1.8
+ */
+void
+clutter_clone_set_cache_source (ClutterClone *clone,
+                                gboolean      cache_source)
+{
+  ClutterClonePrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_CLONE (clone));
+
+  priv = clone->priv;
+
+  cache_source = !!cache_source;
+
+  if (priv->cache_source == cache_source)
+    return;
+
+  priv->cache_source = cache_source;
+
+  if (priv->cache != NULL)
+    {
+      clone_cache_unref (priv->cache);
+      priv->cache = NULL;
+    }
+
+  if (priv->cache_source && priv->clone_source != NULL)
+    priv->cache = clone_cache_ref (priv->clone_source);
+
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (clone));
+
+  g_object_notify_by_pspec (G_OBJECT (clone), obj_props[PROP_CACHE_SOURCE]);
+}
+
+/**
+ * clutter_clone_get_cache_source:
+ * @clone: a #ClutterClone
+ *
+ * Retrieves whether @clone paints its source from a cached image.
+ *
+ * Return value: %TRUE if the image of the source is cached
+ *
+ * Since: 1.8
+ */
+gboolean
+clutter_clone_get_cache_source (ClutterClone *clone)
+{
+  g_return_val_if_fail (CLUTTER_IS_CLONE (clone), FALSE);
+
+  return clone->priv->cache_source;
+}
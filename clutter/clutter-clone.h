@@ -85,6 +85,10 @@ void          clutter_clone_set_source (ClutterClone *clone,
                                         ClutterActor *source);
 ClutterActor *clutter_clone_get_source (ClutterClone *clone);
 
+void          clutter_clone_set_cache_source (ClutterClone *clone,
+                                              gboolean      cache_source);
+gboolean      clutter_clone_get_cache_source (ClutterClone *clone);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_CLONE_H__ */
@@ -401,6 +401,49 @@ clutter_color_shade (const ClutterColor *color,
   result->alpha = color->alpha;
 }
 
+/**
+ * clutter_color_shade_array:
+ * @colors: (array length=n_colors): an array of #ClutterColor<!-- -->s
+ * @n_colors: the number of colors in @colors
+ * @factor: the shade factor to apply
+ * @results: (out caller-allocates) (array length=n_colors): return
+ *   location for the shaded colors
+ *
+ * Shades each color of @colors by @factor, storing the shaded colors
+ * into @results; this is equivalent to calling clutter_color_shade()
+ * on each color, but the HLS conversion is done only once for each
+ * run of equal colors.
+ *
+ * @results can be the same array as @colors.
+ *
+ * Since: 1.8
+ */
+void
+clutter_color_shade_array (const ClutterColor *colors,
+                           guint               n_colors,
+                           gdouble             factor,
+                           ClutterColor       *results)
+{
+  ClutterColor last_color = { 0, }, last_result = { 0, };
+  guint i;
+
+  g_return_if_fail (colors != NULL || n_colors == 0);
+  g_return_if_fail (results != NULL || n_colors == 0);
+
+  for (i = 0; i < n_colors; i++)
+    {
+      ClutterColor color = colors[i];
+
+      if (i == 0 || !clutter_color_equal (&color, &last_color))
+        {
+          clutter_color_shade (&color, factor, &last_result);
+          last_color = color;
+        }
+
+      results[i] = last_result;
+    }
+}
+
 /**
  * clutter_color_to_pixel:
  * @color: a #ClutterColor
@@ -903,6 +946,51 @@ clutter_color_interpolate (const ClutterColor *initial,
   result->alpha = initial->alpha + (final->alpha - initial->alpha) * progress;
 }
 
+/**
+ * clutter_color_interpolate_array:
+ * @initial: (array length=n_colors): the initial colors
+ * @final: (array length=n_colors): the final colors
+ * @n_colors: the number of colors in each array
+ * @progress: the interpolation progress, between 0.0 and 1.0
+ * @results: (out caller-allocates) (array length=n_colors): return
+ *   location for the interpolated colors
+ *
+ * Interpolates each color of @initial with the color at the same
+ * index of @final, storing the interpolated colors into @results;
+ * the result is the same as calling clutter_color_interpolate() on
+ * each pair of colors.
+ *
+ * @results can be the same array as @initial or @final.
+ *
+ * Since: 1.8
+ */
+void
+clutter_color_interpolate_array (const ClutterColor *initial,
+                                 const ClutterColor *final,
+                                 guint               n_colors,
+                                 gdouble             progress,
+                                 ClutterColor       *results)
+{
+  const guint8 *a, *b;
+  guint8 *res;
+  guint i, n_channels;
+
+  g_return_if_fail (initial != NULL || n_colors == 0);
+  g_return_if_fail (final != NULL || n_colors == 0);
+  g_return_if_fail (results != NULL || n_colors == 0);
+
+  /* ClutterColor is four packed bytes, so the arrays can be walked
+   * one channel at a time; a single loop over plain bytes, without
+   * branches, is something the compiler can turn into vector code */
+  a = (const guint8 *) initial;
+  b = (const guint8 *) final;
+  res = (guint8 *) results;
+  n_channels = n_colors * 4;
+
+  for (i = 0; i < n_channels; i++)
+    res[i] = a[i] + (b[i] - a[i]) * progress;
+}
+
 static gboolean
 clutter_color_progress (const GValue *a,
                         const GValue *b,
@@ -77,6 +77,10 @@ void          clutter_color_darken      (const ClutterColor *color,
 void          clutter_color_shade       (const ClutterColor *color,
                                          gdouble             factor,
                                          ClutterColor       *result);
+void          clutter_color_shade_array (const ClutterColor *colors,
+                                         guint               n_colors,
+                                         gdouble             factor,
+                                         ClutterColor       *results);
 
 gchar *       clutter_color_to_string   (const ClutterColor *color);
 gboolean      clutter_color_from_string (ClutterColor       *color,
@@ -103,6 +107,11 @@ void          clutter_color_interpolate (const ClutterColor *initial,
                                          const ClutterColor *final,
                                          gdouble             progress,
                                          ClutterColor       *result);
+void          clutter_color_interpolate_array (const ClutterColor *initial,
+                                               const ClutterColor *final,
+                                               guint               n_colors,
+                                               gdouble             progress,
+                                               ClutterColor       *results);
 
 #define CLUTTER_TYPE_PARAM_COLOR           (clutter_param_color_get_type ())
 #define CLUTTER_PARAM_SPEC_COLOR(pspec)    (G_TYPE_CHECK_INSTANCE_CAST ((pspec), CLUTTER_TYPE_PARAM_COLOR, ClutterParamSpecColor))
@@ -48,6 +48,7 @@
 #include "clutter-debug.h"
 #include "clutter-enum-types.h"
 #include "clutter-offscreen-effect.h"
+#include "clutter-offscreen-effect-private.h"
 #include "clutter-private.h"
 
 struct _ClutterColorizeEffect
@@ -222,6 +223,49 @@ out:
   parent->paint_target (effect);
 }
 
+/* the same conversion as colorize_glsl_shader, for the chains of
+ * color effects painted in a single pass */
+static void
+clutter_colorize_effect_stage_source (ClutterOffscreenEffect *effect,
+                                      GString                *source,
+                                      guint                   stage)
+{
+  g_string_append_printf (source,
+                          "uniform vec3 tint_%u;\n"
+                          "\n"
+                          "vec4 stage_%u (vec4 color)\n"
+                          "{\n"
+                          "  float gray = dot (color.rgb, vec3 (0.299, 0.587, 0.114));\n"
+                          "  return vec4 (gray * tint_%u, color.a);\n"
+                          "}\n"
+                          "\n",
+                          stage, stage, stage);
+}
+
+static void
+clutter_colorize_effect_stage_uniforms (ClutterOffscreenEffect *effect,
+                                        CoglHandle              program,
+                                        guint                   stage)
+{
+  ClutterColorizeEffect *self = CLUTTER_COLORIZE_EFFECT (effect);
+  gchar name[32];
+  gint uniform;
+
+  g_snprintf (name, sizeof (name), "tint_%u", stage);
+
+  uniform = cogl_program_get_uniform_location (program, name);
+  if (uniform > -1)
+    {
+      float tint[3] = {
+        self->tint.red / 255.0,
+        self->tint.green / 255.0,
+        self->tint.blue / 255.0
+      };
+
+      cogl_program_set_uniform_float (program, uniform, 3, 1, tint);
+    }
+}
+
 static void
 clutter_colorize_effect_dispose (GObject *gobject)
 {
@@ -289,6 +333,10 @@ clutter_colorize_effect_class_init (ClutterColorizeEffectClass *klass)
   offscreen_class = CLUTTER_OFFSCREEN_EFFECT_CLASS (klass);
   offscreen_class->paint_target = clutter_colorize_effect_paint_target;
 
+  _clutter_offscreen_effect_class_add_color_stage (offscreen_class,
+                                                   clutter_colorize_effect_stage_source,
+                                                   clutter_colorize_effect_stage_uniforms);
+
   effect_class->pre_paint = clutter_colorize_effect_pre_paint;
 
   gobject_class->set_property = clutter_colorize_effect_set_property;
@@ -352,12 +400,17 @@ void
 clutter_colorize_effect_set_tint (ClutterColorizeEffect *effect,
                                   const ClutterColor    *tint)
 {
+  ClutterActor *actor;
+
   g_return_if_fail (CLUTTER_IS_COLORIZE_EFFECT (effect));
 
   effect->tint = *tint;
 
-  if (effect->actor != NULL)
-    clutter_actor_queue_redraw (effect->actor);
+  /* the effect might be painted by the one before it, in which
+   * case it never runs and effect->actor is not set */
+  actor = clutter_actor_meta_get_actor (CLUTTER_ACTOR_META (effect));
+  if (actor != NULL)
+    clutter_actor_queue_redraw (actor);
 
   g_object_notify_by_pspec (G_OBJECT (effect), obj_props[PROP_TINT]);
 }
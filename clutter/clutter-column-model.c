@@ -0,0 +1,1569 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2011  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:clutter-column-model
+ * @short_description: Column based model implementation
+ *
+ * #ClutterColumnModel is a #ClutterModel implementation that stores
+ * the cells of each column inside a contiguous array of the column
+ * type, instead of storing each row as an array of #GValue<!-- -->s
+ * like #ClutterListModel does.
+ *
+ * Integer, boolean, enumeration and flags columns are stored as
+ * integers; float, double and pointer columns are stored natively,
+ * and strings are interned inside a string pool owned by the model.
+ * Columns of any other type fall back to a #GValue per cell.
+ *
+ * This layout makes #ClutterColumnModel well suited for large data
+ * sets that are scanned often, for instance by filtering or sorting
+ * functions. The typed accessors, like
+ * clutter_column_model_iter_get_int(), read the cells of a
+ * #ClutterColumnModel directly, without going through a #GValue.
+ *
+ * The result of the filtering function is cached for each row, and
+ * it is evaluated again only when the row changes or when a new filter
+ * is set using clutter_model_set_filter(). Likewise, when a single row
+ * is added or changed, it is moved to its sorted position using a
+ * binary search instead of sorting the whole model.
+ *
+ * Since the strings are interned, changing the value of a string
+ * cell does not release the memory used by the previous value until
+ * the model is destroyed.
+ *
+ * #ClutterColumnModel is available since Clutter 1.8
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <glib-object.h>
+
+#include "clutter-column-model.h"
+#include "clutter-model.h"
+#include "clutter-model-private.h"
+#include "clutter-private.h"
+#include "clutter-debug.h"
+
+#define CLUTTER_TYPE_COLUMN_MODEL_ITER                 \
+        (clutter_column_model_iter_get_type())
+#define CLUTTER_COLUMN_MODEL_ITER(obj)                 \
+        (G_TYPE_CHECK_INSTANCE_CAST((obj),             \
+         CLUTTER_TYPE_COLUMN_MODEL_ITER,               \
+         ClutterColumnModelIter))
+#define CLUTTER_IS_COLUMN_MODEL_ITER(obj)              \
+        (G_TYPE_CHECK_INSTANCE_TYPE((obj),             \
+         CLUTTER_TYPE_COLUMN_MODEL_ITER))
+
+typedef struct _ClutterColumnModelIter  ClutterColumnModelIter;
+typedef struct _ClutterModelIterClass   ClutterColumnModelIterClass;
+
+#define CLUTTER_COLUMN_MODEL_GET_PRIVATE(obj)   (G_TYPE_INSTANCE_GET_PRIVATE ((obj), CLUTTER_TYPE_COLUMN_MODEL, ClutterColumnModelPrivate))
+
+typedef enum {
+  COLUMN_STORAGE_INT,
+  COLUMN_STORAGE_FLOAT,
+  COLUMN_STORAGE_DOUBLE,
+  COLUMN_STORAGE_STRING,
+  COLUMN_STORAGE_POINTER,
+  COLUMN_STORAGE_VALUE
+} ColumnStorage;
+
+/* the cached result of the filter for each row */
+enum {
+  ROW_FILTER_UNKNOWN = 0,
+  ROW_FILTER_VISIBLE,
+  ROW_FILTER_HIDDEN
+};
+
+typedef struct _Column
+{
+  GType type;
+  ColumnStorage storage;
+  guint element_size;
+
+  GArray *cells;
+} Column;
+
+struct _ClutterColumnModelPrivate
+{
+  Column *columns;
+  guint n_columns;
+
+  guint n_rows;
+
+  /* one byte per row, holding the cached result of the filter */
+  GArray *filter_cache;
+  guint filter_stamp;
+
+  GStringChunk *strings;
+
+  ClutterModelIter *temp_iter;
+};
+
+struct _ClutterColumnModelIter
+{
+  ClutterModelIter parent_instance;
+
+  /* the position of the row inside the column arrays, regardless
+   * of the filter
+   */
+  guint index;
+};
+
+/*
+ * Column storage
+ */
+
+static ColumnStorage
+column_storage_for_type (GType gtype)
+{
+  switch (G_TYPE_FUNDAMENTAL (gtype))
+    {
+    case G_TYPE_BOOLEAN:
+    case G_TYPE_CHAR:
+    case G_TYPE_UCHAR:
+    case G_TYPE_INT:
+    case G_TYPE_UINT:
+    case G_TYPE_ENUM:
+    case G_TYPE_FLAGS:
+      return COLUMN_STORAGE_INT;
+
+    case G_TYPE_FLOAT:
+      return COLUMN_STORAGE_FLOAT;
+
+    case G_TYPE_DOUBLE:
+      return COLUMN_STORAGE_DOUBLE;
+
+    case G_TYPE_STRING:
+      return COLUMN_STORAGE_STRING;
+
+    case G_TYPE_POINTER:
+      return COLUMN_STORAGE_POINTER;
+
+    default:
+      return COLUMN_STORAGE_VALUE;
+    }
+}
+
+static guint
+column_storage_element_size (ColumnStorage storage)
+{
+  switch (storage)
+    {
+    case COLUMN_STORAGE_INT:
+      return sizeof (gint);
+
+    case COLUMN_STORAGE_FLOAT:
+      return sizeof (gfloat);
+
+    case COLUMN_STORAGE_DOUBLE:
+      return sizeof (gdouble);
+
+    case COLUMN_STORAGE_STRING:
+      return sizeof (const gchar *);
+
+    case COLUMN_STORAGE_POINTER:
+      return sizeof (gpointer);
+
+    case COLUMN_STORAGE_VALUE:
+      return sizeof (GValue);
+    }
+
+  g_assert_not_reached ();
+
+  return 0;
+}
+
+static void
+column_get_cell (const Column *column,
+                 guint         index_,
+                 GValue       *value)
+{
+  gint int_value;
+
+  switch (column->storage)
+    {
+    case COLUMN_STORAGE_INT:
+      int_value = g_array_index (column->cells, gint, index_);
+
+      switch (G_TYPE_FUNDAMENTAL (column->type))
+        {
+        case G_TYPE_BOOLEAN:
+          g_value_set_boolean (value, int_value);
+          break;
+
+        case G_TYPE_CHAR:
+          g_value_set_char (value, int_value);
+          break;
+
+        case G_TYPE_UCHAR:
+          g_value_set_uchar (value, int_value);
+          break;
+
+        case G_TYPE_INT:
+          g_value_set_int (value, int_value);
+          break;
+
+        case G_TYPE_UINT:
+          g_value_set_uint (value, (guint) int_value);
+          break;
+
+        case G_TYPE_ENUM:
+          g_value_set_enum (value, int_value);
+          break;
+
+        case G_TYPE_FLAGS:
+          g_value_set_flags (value, (guint) int_value);
+          break;
+
+        default:
+          g_assert_not_reached ();
+        }
+      break;
+
+    case COLUMN_STORAGE_FLOAT:
+      g_value_set_float (value, g_array_index (column->cells, gfloat, index_));
+      break;
+
+    case COLUMN_STORAGE_DOUBLE:
+      g_value_set_double (value, g_array_index (column->cells, gdouble, index_));
+      break;
+
+    case COLUMN_STORAGE_STRING:
+      g_value_set_string (value, g_array_index (column->cells, const gchar *, index_));
+      break;
+
+    case COLUMN_STORAGE_POINTER:
+      g_value_set_pointer (value, g_array_index (column->cells, gpointer, index_));
+      break;
+
+    case COLUMN_STORAGE_VALUE:
+      g_value_copy (&g_array_index (column->cells, GValue, index_), value);
+      break;
+    }
+}
+
+static void
+column_set_cell (ClutterColumnModel *model,
+                 Column             *column,
+                 guint               index_,
+                 const GValue       *value)
+{
+  const gchar *str;
+  gint int_value;
+
+  switch (column->storage)
+    {
+    case COLUMN_STORAGE_INT:
+      switch (G_TYPE_FUNDAMENTAL (column->type))
+        {
+        case G_TYPE_BOOLEAN:
+          int_value = g_value_get_boolean (value);
+          break;
+
+        case G_TYPE_CHAR:
+          int_value = g_value_get_char (value);
+          break;
+
+        case G_TYPE_UCHAR:
+          int_value = g_value_get_uchar (value);
+          break;
+
+        case G_TYPE_INT:
+          int_value = g_value_get_int (value);
+          break;
+
+        case G_TYPE_UINT:
+          int_value = (gint) g_value_get_uint (value);
+          break;
+
+        case G_TYPE_ENUM:
+          int_value = g_value_get_enum (value);
+          break;
+
+        case G_TYPE_FLAGS:
+          int_value = (gint) g_value_get_flags (value);
+          break;
+
+        default:
+          g_assert_not_reached ();
+          int_value = 0;
+        }
+
+      g_array_index (column->cells, gint, index_) = int_value;
+      break;
+
+    case COLUMN_STORAGE_FLOAT:
+      g_array_index (column->cells, gfloat, index_) = g_value_get_float (value);
+      break;
+
+    case COLUMN_STORAGE_DOUBLE:
+      g_array_index (column->cells, gdouble, index_) = g_value_get_double (value);
+      break;
+
+    case COLUMN_STORAGE_STRING:
+      str = g_value_get_string (value);
+      if (str != NULL)
+        str = g_string_chunk_insert_const (model->priv->strings, str);
+
+      g_array_index (column->cells, const gchar *, index_) = str;
+      break;
+
+    case COLUMN_STORAGE_POINTER:
+      g_array_index (column->cells, gpointer, index_) = g_value_get_pointer (value);
+      break;
+
+    case COLUMN_STORAGE_VALUE:
+      g_value_copy (value, &g_array_index (column->cells, GValue, index_));
+      break;
+    }
+}
+
+static void
+clutter_column_model_ensure_columns (ClutterColumnModel *model)
+{
+  ClutterColumnModelPrivate *priv = model->priv;
+  guint i;
+
+  if (priv->columns != NULL)
+    return;
+
+  /* the column types are only known after the construction, so we
+   * create the arrays when the first row is inserted
+   */
+  priv->n_columns = clutter_model_get_n_columns (CLUTTER_MODEL (model));
+  priv->columns = g_new0 (Column, priv->n_columns);
+
+  for (i = 0; i < priv->n_columns; i++)
+    {
+      Column *column = &priv->columns[i];
+
+      column->type = clutter_model_get_column_type (CLUTTER_MODEL (model), i);
+      column->storage = column_storage_for_type (column->type);
+      column->element_size = column_storage_element_size (column->storage);
+      column->cells = g_array_new (FALSE, TRUE, column->element_size);
+    }
+}
+
+static inline void
+clutter_column_model_invalidate_row (ClutterColumnModel *model,
+                                     guint               index_)
+{
+  g_array_index (model->priv->filter_cache, guint8, index_) =
+    ROW_FILTER_UNKNOWN;
+}
+
+static gboolean
+clutter_column_model_is_visible (ClutterColumnModel *model,
+                                 guint               index_)
+{
+  ClutterColumnModelPrivate *priv = model->priv;
+  guint8 *state;
+  guint stamp;
+
+  if (!clutter_model_get_filter_set (CLUTTER_MODEL (model)))
+    return TRUE;
+
+  /* a new filter was set, so every cached result is stale */
+  stamp = _clutter_model_get_filter_stamp (CLUTTER_MODEL (model));
+  if (stamp != priv->filter_stamp)
+    {
+      if (priv->n_rows > 0)
+        memset (priv->filter_cache->data, ROW_FILTER_UNKNOWN, priv->n_rows);
+
+      priv->filter_stamp = stamp;
+    }
+
+  state = &g_array_index (priv->filter_cache, guint8, index_);
+
+  if (*state == ROW_FILTER_UNKNOWN)
+    {
+      ClutterModelIter *temp_iter = priv->temp_iter;
+      gboolean res;
+
+      CLUTTER_COLUMN_MODEL_ITER (temp_iter)->index = index_;
+
+      res = clutter_model_filter_iter (CLUTTER_MODEL (model), temp_iter);
+
+      /* the filter function might have changed the model, so we
+       * cannot use the pointer we retrieved before calling it
+       */
+      g_array_index (priv->filter_cache, guint8, index_) =
+        res ? ROW_FILTER_VISIBLE : ROW_FILTER_HIDDEN;
+
+      return res;
+    }
+
+  return *state == ROW_FILTER_VISIBLE;
+}
+
+/* translates the position of a row in the filtered model into its
+ * position inside the column arrays
+ */
+static gboolean
+clutter_column_model_get_index_at_row (ClutterColumnModel *model,
+                                       guint               row,
+                                       guint              *index_)
+{
+  ClutterColumnModelPrivate *priv = model->priv;
+  guint i, count;
+
+  if (row >= priv->n_rows)
+    return FALSE;
+
+  /* short-circuit in case we don't have a filter in place */
+  if (!clutter_model_get_filter_set (CLUTTER_MODEL (model)))
+    {
+      *index_ = row;
+      return TRUE;
+    }
+
+  for (i = 0, count = 0; i < priv->n_rows; i++)
+    {
+      if (!clutter_column_model_is_visible (model, i))
+        continue;
+
+      if (count == row)
+        {
+          *index_ = i;
+          return TRUE;
+        }
+
+      count += 1;
+    }
+
+  return FALSE;
+}
+
+/*
+ * ClutterColumnModelIter
+ */
+
+G_DEFINE_TYPE (ClutterColumnModelIter,
+               clutter_column_model_iter,
+               CLUTTER_TYPE_MODEL_ITER);
+
+static void
+clutter_column_model_iter_get_value (ClutterModelIter *iter,
+                                     guint             column,
+                                     GValue           *value)
+{
+  ClutterColumnModelIter *iter_column = CLUTTER_COLUMN_MODEL_ITER (iter);
+  ClutterColumnModel *model;
+  GValue real_value = { 0, };
+  Column *cells;
+
+  model = CLUTTER_COLUMN_MODEL (clutter_model_iter_get_model (iter));
+  g_assert (iter_column->index < model->priv->n_rows);
+
+  cells = &model->priv->columns[column];
+
+  if (G_VALUE_TYPE (value) == cells->type)
+    {
+      column_get_cell (cells, iter_column->index, value);
+      return;
+    }
+
+  g_value_init (&real_value, cells->type);
+  column_get_cell (cells, iter_column->index, &real_value);
+
+  if (!g_value_transform (&real_value, value))
+    g_warning ("%s: Unable to make conversion from %s to %s",
+               G_STRLOC,
+               g_type_name (cells->type),
+               g_type_name (G_VALUE_TYPE (value)));
+
+  g_value_unset (&real_value);
+}
+
+static void
+clutter_column_model_iter_set_value (ClutterModelIter *iter,
+                                     guint             column,
+                                     const GValue     *value)
+{
+  ClutterColumnModelIter *iter_column = CLUTTER_COLUMN_MODEL_ITER (iter);
+  ClutterColumnModel *model;
+  GValue real_value = { 0, };
+  Column *cells;
+
+  model = CLUTTER_COLUMN_MODEL (clutter_model_iter_get_model (iter));
+  g_assert (iter_column->index < model->priv->n_rows);
+
+  cells = &model->priv->columns[column];
+
+  clutter_column_model_invalidate_row (model, iter_column->index);
+
+  if (G_VALUE_TYPE (value) == cells->type)
+    {
+      column_set_cell (model, cells, iter_column->index, value);
+      return;
+    }
+
+  g_value_init (&real_value, cells->type);
+
+  if (g_value_transform (value, &real_value))
+    column_set_cell (model, cells, iter_column->index, &real_value);
+  else
+    g_warning ("%s: Unable to make conversion from %s to %s",
+               G_STRLOC,
+               g_type_name (G_VALUE_TYPE (value)),
+               g_type_name (cells->type));
+
+  g_value_unset (&real_value);
+}
+
+static gboolean
+clutter_column_model_iter_is_first (ClutterModelIter *iter)
+{
+  ClutterColumnModelIter *iter_column = CLUTTER_COLUMN_MODEL_ITER (iter);
+  ClutterColumnModel *model;
+  guint i;
+
+  model = CLUTTER_COLUMN_MODEL (clutter_model_iter_get_model (iter));
+
+  for (i = 0; i < iter_column->index; i++)
+    {
+      if (clutter_column_model_is_visible (model, i))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+clutter_column_model_iter_is_last (ClutterModelIter *iter)
+{
+  ClutterColumnModelIter *iter_column = CLUTTER_COLUMN_MODEL_ITER (iter);
+  ClutterColumnModel *model;
+  guint i;
+
+  model = CLUTTER_COLUMN_MODEL (clutter_model_iter_get_model (iter));
+
+  /* like ClutterListModel, the last iterator is the one past the
+   * last visible row
+   */
+  for (i = iter_column->index; i < model->priv->n_rows; i++)
+    {
+      if (clutter_column_model_is_visible (model, i))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static ClutterModelIter *
+clutter_column_model_iter_next (ClutterModelIter *iter)
+{
+  ClutterColumnModelIter *iter_column = CLUTTER_COLUMN_MODEL_ITER (iter);
+  ClutterColumnModel *model;
+  guint i;
+
+  model = CLUTTER_COLUMN_MODEL (clutter_model_iter_get_model (iter));
+
+  i = iter_column->index + 1;
+  while (i < model->priv->n_rows &&
+         !clutter_column_model_is_visible (model, i))
+    i += 1;
+
+  /* update the iterator and return it */
+  clutter_model_iter_set_row (iter, clutter_model_iter_get_row (iter) + 1);
+  iter_column->index = MIN (i, model->priv->n_rows);
+
+  return iter;
+}
+
+static ClutterModelIter *
+clutter_column_model_iter_prev (ClutterModelIter *iter)
+{
+  ClutterColumnModelIter *iter_column = CLUTTER_COLUMN_MODEL_ITER (iter);
+  ClutterColumnModel *model;
+  guint i;
+
+  model = CLUTTER_COLUMN_MODEL (clutter_model_iter_get_model (iter));
+
+  /* if there is no visible row before this one we stop at the
+   * beginning of the model, like ClutterListModel does
+   */
+  i = iter_column->index;
+  while (i > 0)
+    {
+      i -= 1;
+
+      if (clutter_column_model_is_visible (model, i))
+        break;
+    }
+
+  /* update the iterator and return it */
+  clutter_model_iter_set_row (iter, clutter_model_iter_get_row (iter) - 1);
+  iter_column->index = i;
+
+  return iter;
+}
+
+static ClutterModelIter *
+clutter_column_model_iter_copy (ClutterModelIter *iter)
+{
+  ClutterColumnModelIter *iter_copy;
+
+  iter_copy = g_object_new (CLUTTER_TYPE_COLUMN_MODEL_ITER,
+                            "model", clutter_model_iter_get_model (iter),
+                            "row", clutter_model_iter_get_row (iter),
+                            NULL);
+  iter_copy->index = CLUTTER_COLUMN_MODEL_ITER (iter)->index;
+
+  return CLUTTER_MODEL_ITER (iter_copy);
+}
+
+static void
+clutter_column_model_iter_class_init (ClutterColumnModelIterClass *klass)
+{
+  ClutterModelIterClass *iter_class = CLUTTER_MODEL_ITER_CLASS (klass);
+
+  iter_class->get_value = clutter_column_model_iter_get_value;
+  iter_class->set_value = clutter_column_model_iter_set_value;
+  iter_class->is_first  = clutter_column_model_iter_is_first;
+  iter_class->is_last   = clutter_column_model_iter_is_last;
+  iter_class->next      = clutter_column_model_iter_next;
+  iter_class->prev      = clutter_column_model_iter_prev;
+  iter_class->copy      = clutter_column_model_iter_copy;
+}
+
+static void
+clutter_column_model_iter_init (ClutterColumnModelIter *iter)
+{
+  iter->index = 0;
+}
+
+/*
+ * ClutterColumnModel
+ */
+
+G_DEFINE_TYPE (ClutterColumnModel, clutter_column_model, CLUTTER_TYPE_MODEL);
+
+static ClutterModelIter *
+clutter_column_model_get_iter_at_row (ClutterModel *model,
+                                      guint         row)
+{
+  ClutterColumnModelIter *retval;
+  guint index_;
+
+  if (!clutter_column_model_get_index_at_row (CLUTTER_COLUMN_MODEL (model),
+                                              row,
+                                              &index_))
+    return NULL;
+
+  retval = g_object_new (CLUTTER_TYPE_COLUMN_MODEL_ITER,
+                         "model", model,
+                         "row", row,
+                         NULL);
+  retval->index = index_;
+
+  return CLUTTER_MODEL_ITER (retval);
+}
+
+static ClutterModelIter *
+clutter_column_model_insert_row (ClutterModel *model,
+                                 gint          index_)
+{
+  ClutterColumnModel *model_column = CLUTTER_COLUMN_MODEL (model);
+  ClutterColumnModelPrivate *priv = model_column->priv;
+  ClutterColumnModelIter *retval;
+  GValue empty_cell = { 0, };
+  guint i, pos;
+
+  clutter_column_model_ensure_columns (model_column);
+
+  if (index_ < 0 || (guint) index_ > priv->n_rows)
+    pos = priv->n_rows;
+  else
+    pos = index_;
+
+  /* a zeroed GValue is large enough to initialize a cell of any
+   * storage type
+   */
+  for (i = 0; i < priv->n_columns; i++)
+    {
+      Column *column = &priv->columns[i];
+
+      g_array_insert_vals (column->cells, pos, &empty_cell, 1);
+
+      if (column->storage == COLUMN_STORAGE_VALUE)
+        g_value_init (&g_array_index (column->cells, GValue, pos),
+                      column->type);
+    }
+
+  g_array_insert_vals (priv->filter_cache, pos, &empty_cell, 1);
+
+  priv->n_rows += 1;
+
+  retval = g_object_new (CLUTTER_TYPE_COLUMN_MODEL_ITER,
+                         "model", model,
+                         "row", pos,
+                         NULL);
+  retval->index = pos;
+
+  return CLUTTER_MODEL_ITER (retval);
+}
+
+static void
+clutter_column_model_remove_row (ClutterModel *model,
+                                 guint         row)
+{
+  ClutterColumnModelIter *iter;
+  guint index_;
+
+  if (!clutter_column_model_get_index_at_row (CLUTTER_COLUMN_MODEL (model),
+                                              row,
+                                              &index_))
+    return;
+
+  iter = g_object_new (CLUTTER_TYPE_COLUMN_MODEL_ITER,
+                       "model", model,
+                       "row", row,
+                       NULL);
+  iter->index = index_;
+
+  /* the actual row is removed from the columns inside the
+   * ::row-removed signal class handler, so that every handler
+   * connected to ::row-removed will still get a valid iterator,
+   * and every signal connected to ::row-removed with the AFTER
+   * flag will get an updated model
+   */
+  g_signal_emit_by_name (model, "row-removed", iter);
+
+  g_object_unref (iter);
+}
+
+typedef struct
+{
+  ClutterModel *model;
+  Column *column;
+  ClutterModelSortFunc func;
+  gpointer data;
+
+  GValue value_a;
+  GValue value_b;
+} SortClosure;
+
+static const GValue *
+sort_closure_get_value (SortClosure *clos,
+                        guint        index_,
+                        GValue      *value)
+{
+  Column *column = clos->column;
+
+  switch (column->storage)
+    {
+    case COLUMN_STORAGE_STRING:
+      /* the strings are owned by the model for its whole life time */
+      g_value_set_static_string (value,
+                                 g_array_index (column->cells,
+                                                const gchar *,
+                                                index_));
+      return value;
+
+    case COLUMN_STORAGE_VALUE:
+      return &g_array_index (column->cells, GValue, index_);
+
+    default:
+      column_get_cell (column, index_, value);
+      return value;
+    }
+}
+
+static void
+sort_closure_init (SortClosure          *clos,
+                   ClutterModel         *model,
+                   ClutterModelSortFunc  func,
+                   gpointer              data)
+{
+  ClutterColumnModelPrivate *priv = CLUTTER_COLUMN_MODEL (model)->priv;
+
+  clos->model  = model;
+  clos->column = &priv->columns[clutter_model_get_sorting_column (model)];
+  clos->func   = func;
+  clos->data   = data;
+
+  g_value_init (&clos->value_a, clos->column->type);
+  g_value_init (&clos->value_b, clos->column->type);
+}
+
+static void
+sort_closure_clear (SortClosure *clos)
+{
+  g_value_unset (&clos->value_a);
+  g_value_unset (&clos->value_b);
+}
+
+static inline gint
+sort_closure_compare (SortClosure *clos,
+                      guint        index_a,
+                      guint        index_b)
+{
+  return clos->func (clos->model,
+                     sort_closure_get_value (clos, index_a, &clos->value_a),
+                     sort_closure_get_value (clos, index_b, &clos->value_b),
+                     clos->data);
+}
+
+static gint
+sort_model_default (gconstpointer a,
+                    gconstpointer b,
+                    gpointer      data)
+{
+  return sort_closure_compare (data, *(guint *) a, *(guint *) b);
+}
+
+/* moves the element at @from to @to, shifting the ones in between */
+static void
+move_element (GArray *array,
+              guint   element_size,
+              guint   from,
+              guint   to)
+{
+  guint8 element[sizeof (GValue)];
+  guint8 *data = (guint8 *) array->data;
+
+  g_assert (element_size <= sizeof (element));
+
+  memcpy (element, data + from * element_size, element_size);
+
+  if (to < from)
+    memmove (data + (to + 1) * element_size,
+             data + to * element_size,
+             (from - to) * element_size);
+  else
+    memmove (data + from * element_size,
+             data + (from + 1) * element_size,
+             (to - from) * element_size);
+
+  memcpy (data + to * element_size, element, element_size);
+}
+
+static void
+clutter_column_model_resort (ClutterModel         *model,
+                             ClutterModelSortFunc  func,
+                             gpointer              data)
+{
+  ClutterColumnModelPrivate *priv = CLUTTER_COLUMN_MODEL (model)->priv;
+  SortClosure sort_closure = { NULL, NULL, NULL, NULL, { 0, }, { 0, } };
+  GArray *filter_cache;
+  gint sort_column;
+  guint *order;
+  guint i, j;
+
+  sort_column = clutter_model_get_sorting_column (model);
+  if (func == NULL || sort_column < 0 || priv->n_rows < 2)
+    return;
+
+  sort_closure_init (&sort_closure, model, func, data);
+
+  /* we sort the row positions, and then move the cells of every
+   * column in one pass; g_qsort_with_data() is stable, so the rows
+   * that compare equal will keep their relative order
+   */
+  order = g_new (guint, priv->n_rows);
+  for (i = 0; i < priv->n_rows; i++)
+    order[i] = i;
+
+  g_qsort_with_data (order, priv->n_rows, sizeof (guint),
+                     sort_model_default,
+                     &sort_closure);
+
+  sort_closure_clear (&sort_closure);
+
+  for (i = 0; i < priv->n_columns; i++)
+    {
+      Column *column = &priv->columns[i];
+      GArray *cells;
+
+      cells = g_array_sized_new (FALSE, FALSE,
+                                 column->element_size,
+                                 priv->n_rows);
+
+      for (j = 0; j < priv->n_rows; j++)
+        g_array_append_vals (cells,
+                             column->cells->data
+                             + order[j] * column->element_size,
+                             1);
+
+      /* the GValue cells have been moved, so they must not be unset */
+      g_array_free (column->cells, TRUE);
+      column->cells = cells;
+    }
+
+  /* the cached filter results are moved along with the rows */
+  filter_cache = g_array_sized_new (FALSE, FALSE,
+                                    sizeof (guint8),
+                                    priv->n_rows);
+
+  for (j = 0; j < priv->n_rows; j++)
+    g_array_append_vals (filter_cache,
+                         &g_array_index (priv->filter_cache, guint8, order[j]),
+                         1);
+
+  g_array_free (priv->filter_cache, TRUE);
+  priv->filter_cache = filter_cache;
+
+  g_free (order);
+}
+
+static void
+clutter_column_model_resort_row (ClutterModel         *model,
+                                 ClutterModelIter     *iter,
+                                 ClutterModelSortFunc  func,
+                                 gpointer              data)
+{
+  ClutterColumnModelPrivate *priv = CLUTTER_COLUMN_MODEL (model)->priv;
+  ClutterColumnModelIter *iter_column = CLUTTER_COLUMN_MODEL_ITER (iter);
+  SortClosure sort_closure = { NULL, NULL, NULL, NULL, { 0, }, { 0, } };
+  guint index_, low, high, i;
+
+  if (clutter_model_get_sorting_column (model) < 0 || priv->n_rows < 2)
+    return;
+
+  index_ = iter_column->index;
+
+  sort_closure_init (&sort_closure, model, func, data);
+
+  /* binary search for the position of the row among the other rows,
+   * which are already sorted; the row goes after the rows comparing
+   * equal to it, like it would with a stable sort
+   */
+  low = 0;
+  high = priv->n_rows - 1;
+  while (low < high)
+    {
+      guint middle = low + (high - low) / 2;
+      guint other = middle < index_ ? middle : middle + 1;
+
+      if (sort_closure_compare (&sort_closure, index_, other) < 0)
+        high = middle;
+      else
+        low = middle + 1;
+    }
+
+  sort_closure_clear (&sort_closure);
+
+  if (low == index_)
+    return;
+
+  for (i = 0; i < priv->n_columns; i++)
+    move_element (priv->columns[i].cells,
+                  priv->columns[i].element_size,
+                  index_, low);
+
+  move_element (priv->filter_cache, sizeof (guint8), index_, low);
+
+  iter_column->index = low;
+}
+
+static guint
+clutter_column_model_get_n_rows (ClutterModel *model)
+{
+  ClutterColumnModel *model_column = CLUTTER_COLUMN_MODEL (model);
+
+  /* short-circuit in case we don't have a filter in place */
+  if (!clutter_model_get_filter_set (model))
+    return model_column->priv->n_rows;
+
+  return CLUTTER_MODEL_CLASS (clutter_column_model_parent_class)->get_n_rows (model);
+}
+
+static void
+clutter_column_model_row_removed (ClutterModel     *model,
+                                  ClutterModelIter *iter)
+{
+  ClutterColumnModelPrivate *priv = CLUTTER_COLUMN_MODEL (model)->priv;
+  ClutterColumnModelIter *iter_column;
+  guint i;
+
+  iter_column = CLUTTER_COLUMN_MODEL_ITER (iter);
+  g_assert (iter_column->index < priv->n_rows);
+
+  for (i = 0; i < priv->n_columns; i++)
+    {
+      Column *column = &priv->columns[i];
+
+      if (column->storage == COLUMN_STORAGE_VALUE)
+        g_value_unset (&g_array_index (column->cells,
+                                       GValue,
+                                       iter_column->index));
+
+      g_array_remove_index (column->cells, iter_column->index);
+    }
+
+  g_array_remove_index (priv->filter_cache, iter_column->index);
+
+  priv->n_rows -= 1;
+}
+
+static void
+clutter_column_model_finalize (GObject *gobject)
+{
+  ClutterColumnModelPrivate *priv = CLUTTER_COLUMN_MODEL (gobject)->priv;
+  guint i, j;
+
+  for (i = 0; i < priv->n_columns; i++)
+    {
+      Column *column = &priv->columns[i];
+
+      if (column->storage == COLUMN_STORAGE_VALUE)
+        {
+          for (j = 0; j < priv->n_rows; j++)
+            g_value_unset (&g_array_index (column->cells, GValue, j));
+        }
+
+      g_array_free (column->cells, TRUE);
+    }
+
+  g_free (priv->columns);
+  g_array_free (priv->filter_cache, TRUE);
+  g_string_chunk_free (priv->strings);
+
+  G_OBJECT_CLASS (clutter_column_model_parent_class)->finalize (gobject);
+}
+
+static void
+clutter_column_model_dispose (GObject *gobject)
+{
+  ClutterColumnModel *model = CLUTTER_COLUMN_MODEL (gobject);
+
+  if (model->priv->temp_iter)
+    {
+      g_object_unref (model->priv->temp_iter);
+      model->priv->temp_iter = NULL;
+    }
+
+  G_OBJECT_CLASS (clutter_column_model_parent_class)->dispose (gobject);
+}
+
+static void
+clutter_column_model_class_init (ClutterColumnModelClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  ClutterModelClass *model_class = CLUTTER_MODEL_CLASS (klass);
+
+  g_type_class_add_private (klass, sizeof (ClutterColumnModelPrivate));
+
+  gobject_class->finalize = clutter_column_model_finalize;
+  gobject_class->dispose = clutter_column_model_dispose;
+
+  model_class->get_iter_at_row = clutter_column_model_get_iter_at_row;
+  model_class->insert_row      = clutter_column_model_insert_row;
+  model_class->remove_row      = clutter_column_model_remove_row;
+  model_class->resort          = clutter_column_model_resort;
+  model_class->resort_row      = clutter_column_model_resort_row;
+  model_class->get_n_rows      = clutter_column_model_get_n_rows;
+
+  model_class->row_removed     = clutter_column_model_row_removed;
+}
+
+static void
+clutter_column_model_init (ClutterColumnModel *model)
+{
+  model->priv = CLUTTER_COLUMN_MODEL_GET_PRIVATE (model);
+
+  model->priv->filter_cache = g_array_new (FALSE, TRUE, sizeof (guint8));
+  model->priv->strings = g_string_chunk_new (1024);
+  model->priv->temp_iter = g_object_new (CLUTTER_TYPE_COLUMN_MODEL_ITER,
+                                         "model",
+                                         model,
+                                         NULL);
+}
+
+/**
+ * clutter_column_model_new:
+ * @n_columns: number of columns in the model
+ * @Varargs: @n_columns number of #GType and string pairs
+ *
+ * Creates a new column model with @n_columns columns with the types
+ * and names passed in.
+ *
+ * For example:
+ *
+ * <informalexample><programlisting>
+ * model = clutter_column_model_new (3,
+ *                                   G_TYPE_INT,    "Score",
+ *                                   G_TYPE_FLOAT,  "Weight",
+ *                                   G_TYPE_STRING, "Team");
+ * </programlisting></informalexample>
+ *
+ * will create a new #ClutterModel with three columns of type int,
+ * float and string respectively.
+ *
+ * Note that the name of the column can be set to %NULL, in which case
+ * the canonical name of the type held by the column will be used as
+ * the title.
+ *
+ * Return value: a new #ClutterColumnModel
+ *
+ * Since: 1.8
+ */
+ClutterModel *
+clutter_column_model_new (guint n_columns,
+                          ...)
+{
+  ClutterModel *model;
+  va_list args;
+  gint i;
+
+  g_return_val_if_fail (n_columns > 0, NULL);
+
+  model = g_object_new (CLUTTER_TYPE_COLUMN_MODEL, NULL);
+  clutter_model_set_n_columns (model, n_columns, TRUE, TRUE);
+
+  va_start (args, n_columns);
+
+  for (i = 0; i < n_columns; i++)
+    {
+      GType type = va_arg (args, GType);
+      const gchar *name = va_arg (args, gchar*);
+
+      if (!clutter_model_check_type (type))
+        {
+          g_warning ("%s: Invalid type %s\n", G_STRLOC, g_type_name (type));
+          g_object_unref (model);
+          va_end (args);
+          return NULL;
+        }
+
+      clutter_model_set_column_type (model, i, type);
+      clutter_model_set_column_name (model, i, name);
+    }
+
+  va_end (args);
+
+  return model;
+}
+
+/**
+ * clutter_column_model_newv:
+ * @n_columns: number of columns in the model
+ * @types: (array length=n_columns): an array of #GType types for the
+ *   columns, from first to last
+ * @names: (array length=n_columns): an array of names for the columns,
+ *   from first to last
+ *
+ * Non-vararg version of clutter_column_model_new(). This function is
+ * useful for language bindings.
+ *
+ * Return value: (transfer full): a new #ClutterColumnModel
+ *
+ * Since: 1.8
+ */
+ClutterModel *
+clutter_column_model_newv (guint                n_columns,
+                           GType               *types,
+                           const gchar * const  names[])
+{
+  ClutterModel *model;
+  gint i;
+
+  g_return_val_if_fail (n_columns > 0, NULL);
+
+  model = g_object_new (CLUTTER_TYPE_COLUMN_MODEL, NULL);
+  clutter_model_set_n_columns (model, n_columns, TRUE, TRUE);
+
+  for (i = 0; i < n_columns; i++)
+    {
+      if (!clutter_model_check_type (types[i]))
+        {
+          g_warning ("%s: Invalid type %s\n", G_STRLOC, g_type_name (types[i]));
+          g_object_unref (model);
+          return NULL;
+        }
+
+      clutter_model_set_column_type (model, i, types[i]);
+      clutter_model_set_column_name (model, i, names[i]);
+    }
+
+  return model;
+}
+
+static Column *
+clutter_column_model_iter_get_column (ClutterModelIter *iter,
+                                      guint             column,
+                                      ColumnStorage     storage)
+{
+  ClutterColumnModelPrivate *priv;
+  Column *retval;
+
+  priv = CLUTTER_COLUMN_MODEL (clutter_model_iter_get_model (iter))->priv;
+
+  if (CLUTTER_COLUMN_MODEL_ITER (iter)->index >= priv->n_rows)
+    {
+      g_warning ("%s: The iterator does not point to a valid row",
+                 G_STRLOC);
+      return NULL;
+    }
+
+  if (column >= priv->n_columns)
+    {
+      g_warning ("%s: Invalid column number %u", G_STRLOC, column);
+      return NULL;
+    }
+
+  retval = &priv->columns[column];
+
+  if (retval->storage != storage)
+    {
+      g_warning ("%s: The column %u of type '%s' cannot be accessed "
+                 "with this function",
+                 G_STRLOC,
+                 column,
+                 g_type_name (retval->type));
+      return NULL;
+    }
+
+  return retval;
+}
+
+static void
+clutter_column_model_iter_invalidate (ClutterModelIter *iter)
+{
+  ClutterColumnModel *model;
+
+  model = CLUTTER_COLUMN_MODEL (clutter_model_iter_get_model (iter));
+
+  clutter_column_model_invalidate_row (model,
+                                       CLUTTER_COLUMN_MODEL_ITER (iter)->index);
+}
+
+#define ITER_CELL(c,ctype,i) \
+  g_array_index ((c)->cells, ctype, CLUTTER_COLUMN_MODEL_ITER (i)->index)
+
+/**
+ * clutter_column_model_iter_get_int:
+ * @iter: a #ClutterModelIter of a #ClutterColumnModel
+ * @column: the column of the cell
+ *
+ * Retrieves the value of an integer, boolean, enumeration or flags
+ * cell without going through a #GValue. Unsigned values are returned
+ * as their bit representation.
+ *
+ * Return value: the value of the cell
+ *
+ * Since: 1.8
+ */
+gint
+clutter_column_model_iter_get_int (ClutterModelIter *iter,
+                                   guint             column)
+{
+  Column *cells;
+
+  g_return_val_if_fail (CLUTTER_IS_COLUMN_MODEL_ITER (iter), 0);
+
+  cells = clutter_column_model_iter_get_column (iter, column,
+                                                COLUMN_STORAGE_INT);
+  if (cells == NULL)
+    return 0;
+
+  return ITER_CELL (cells, gint, iter);
+}
+
+/**
+ * clutter_column_model_iter_set_int:
+ * @iter: a #ClutterModelIter of a #ClutterColumnModel
+ * @column: the column of the cell
+ * @value: the new value of the cell
+ *
+ * Sets the value of an integer, boolean, enumeration or flags cell
+ * without going through a #GValue.
+ *
+ * Like clutter_model_iter_set_value(), this function does not emit
+ * the #ClutterModel::row-changed signal and does not resort the model.
+ *
+ * Since: 1.8
+ */
+void
+clutter_column_model_iter_set_int (ClutterModelIter *iter,
+                                   guint             column,
+                                   gint              value)
+{
+  Column *cells;
+
+  g_return_if_fail (CLUTTER_IS_COLUMN_MODEL_ITER (iter));
+
+  cells = clutter_column_model_iter_get_column (iter, column,
+                                                COLUMN_STORAGE_INT);
+  if (cells == NULL)
+    return;
+
+  if (G_TYPE_FUNDAMENTAL (cells->type) == G_TYPE_BOOLEAN)
+    value = value != FALSE;
+
+  clutter_column_model_iter_invalidate (iter);
+
+  ITER_CELL (cells, gint, iter) = value;
+}
+
+/**
+ * clutter_column_model_iter_get_float:
+ * @iter: a #ClutterModelIter of a #ClutterColumnModel
+ * @column: the column of the cell
+ *
+ * Retrieves the value of a float cell without going through
+ * a #GValue.
+ *
+ * Return value: the value of the cell
+ *
+ * Since: 1.8
+ */
+gfloat
+clutter_column_model_iter_get_float (ClutterModelIter *iter,
+                                     guint             column)
+{
+  Column *cells;
+
+  g_return_val_if_fail (CLUTTER_IS_COLUMN_MODEL_ITER (iter), 0);
+
+  cells = clutter_column_model_iter_get_column (iter, column,
+                                                COLUMN_STORAGE_FLOAT);
+  if (cells == NULL)
+    return 0;
+
+  return ITER_CELL (cells, gfloat, iter);
+}
+
+/**
+ * clutter_column_model_iter_set_float:
+ * @iter: a #ClutterModelIter of a #ClutterColumnModel
+ * @column: the column of the cell
+ * @value: the new value of the cell
+ *
+ * Sets the value of a float cell without going through a #GValue.
+ *
+ * Like clutter_model_iter_set_value(), this function does not emit
+ * the #ClutterModel::row-changed signal and does not resort the model.
+ *
+ * Since: 1.8
+ */
+void
+clutter_column_model_iter_set_float (ClutterModelIter *iter,
+                                     guint             column,
+                                     gfloat            value)
+{
+  Column *cells;
+
+  g_return_if_fail (CLUTTER_IS_COLUMN_MODEL_ITER (iter));
+
+  cells = clutter_column_model_iter_get_column (iter, column,
+                                                COLUMN_STORAGE_FLOAT);
+  if (cells == NULL)
+    return;
+
+  clutter_column_model_iter_invalidate (iter);
+
+  ITER_CELL (cells, gfloat, iter) = value;
+}
+
+/**
+ * clutter_column_model_iter_get_double:
+ * @iter: a #ClutterModelIter of a #ClutterColumnModel
+ * @column: the column of the cell
+ *
+ * Retrieves the value of a double cell without going through
+ * a #GValue.
+ *
+ * Return value: the value of the cell
+ *
+ * Since: 1.8
+ */
+gdouble
+clutter_column_model_iter_get_double (ClutterModelIter *iter,
+                                      guint             column)
+{
+  Column *cells;
+
+  g_return_val_if_fail (CLUTTER_IS_COLUMN_MODEL_ITER (iter), 0);
+
+  cells = clutter_column_model_iter_get_column (iter, column,
+                                                COLUMN_STORAGE_DOUBLE);
+  if (cells == NULL)
+    return 0;
+
+  return ITER_CELL (cells, gdouble, iter);
+}
+
+/**
+ * clutter_column_model_iter_set_double:
+ * @iter: a #ClutterModelIter of a #ClutterColumnModel
+ * @column: the column of the cell
+ * @value: the new value of the cell
+ *
+ * Sets the value of a double cell without going through a #GValue.
+ *
+ * Like clutter_model_iter_set_value(), this function does not emit
+ * the #ClutterModel::row-changed signal and does not resort the model.
+ *
+ * Since: 1.8
+ */
+void
+clutter_column_model_iter_set_double (ClutterModelIter *iter,
+                                      guint             column,
+                                      gdouble           value)
+{
+  Column *cells;
+
+  g_return_if_fail (CLUTTER_IS_COLUMN_MODEL_ITER (iter));
+
+  cells = clutter_column_model_iter_get_column (iter, column,
+                                                COLUMN_STORAGE_DOUBLE);
+  if (cells == NULL)
+    return;
+
+  clutter_column_model_iter_invalidate (iter);
+
+  ITER_CELL (cells, gdouble, iter) = value;
+}
+
+/**
+ * clutter_column_model_iter_get_string:
+ * @iter: a #ClutterModelIter of a #ClutterColumnModel
+ * @column: the column of the cell
+ *
+ * Retrieves the value of a string cell without copying it.
+ *
+ * Return value: the value of the cell. The returned string is owned
+ *   by the model and it is valid for as long as the model exists
+ *
+ * Since: 1.8
+ */
+const gchar *
+clutter_column_model_iter_get_string (ClutterModelIter *iter,
+                                      guint             column)
+{
+  Column *cells;
+
+  g_return_val_if_fail (CLUTTER_IS_COLUMN_MODEL_ITER (iter), NULL);
+
+  cells = clutter_column_model_iter_get_column (iter, column,
+                                                COLUMN_STORAGE_STRING);
+  if (cells == NULL)
+    return NULL;
+
+  return ITER_CELL (cells, const gchar *, iter);
+}
+
+/**
+ * clutter_column_model_iter_set_string:
+ * @iter: a #ClutterModelIter of a #ClutterColumnModel
+ * @column: the column of the cell
+ * @value: (allow-none): the new value of the cell
+ *
+ * Sets the value of a string cell without going through a #GValue.
+ * The string is interned inside the model, so setting the same
+ * string on multiple cells will store it only once.
+ *
+ * Like clutter_model_iter_set_value(), this function does not emit
+ * the #ClutterModel::row-changed signal and does not resort the model.
+ *
+ * Since: 1.8
+ */
+void
+clutter_column_model_iter_set_string (ClutterModelIter *iter,
+                                      guint             column,
+                                      const gchar      *value)
+{
+  ClutterColumnModel *model;
+  Column *cells;
+
+  g_return_if_fail (CLUTTER_IS_COLUMN_MODEL_ITER (iter));
+
+  cells = clutter_column_model_iter_get_column (iter, column,
+                                                COLUMN_STORAGE_STRING);
+  if (cells == NULL)
+    return;
+
+  model = CLUTTER_COLUMN_MODEL (clutter_model_iter_get_model (iter));
+
+  if (value != NULL)
+    value = g_string_chunk_insert_const (model->priv->strings, value);
+
+  clutter_column_model_iter_invalidate (iter);
+
+  ITER_CELL (cells, const gchar *, iter) = value;
+}
+
+/**
+ * clutter_column_model_iter_get_pointer:
+ * @iter: a #ClutterModelIter of a #ClutterColumnModel
+ * @column: the column of the cell
+ *
+ * Retrieves the value of a pointer cell without going through
+ * a #GValue.
+ *
+ * Return value: (transfer none): the value of the cell
+ *
+ * Since: 1.8
+ */
+gpointer
+clutter_column_model_iter_get_pointer (ClutterModelIter *iter,
+                                       guint             column)
+{
+  Column *cells;
+
+  g_return_val_if_fail (CLUTTER_IS_COLUMN_MODEL_ITER (iter), NULL);
+
+  cells = clutter_column_model_iter_get_column (iter, column,
+                                                COLUMN_STORAGE_POINTER);
+  if (cells == NULL)
+    return NULL;
+
+  return ITER_CELL (cells, gpointer, iter);
+}
+
+/**
+ * clutter_column_model_iter_set_pointer:
+ * @iter: a #ClutterModelIter of a #ClutterColumnModel
+ * @column: the column of the cell
+ * @value: the new value of the cell
+ *
+ * Sets the value of a pointer cell without going through a #GValue.
+ *
+ * Like clutter_model_iter_set_value(), this function does not emit
+ * the #ClutterModel::row-changed signal and does not resort the model.
+ *
+ * Since: 1.8
+ */
+void
+clutter_column_model_iter_set_pointer (ClutterModelIter *iter,
+                                       guint             column,
+                                       gpointer          value)
+{
+  Column *cells;
+
+  g_return_if_fail (CLUTTER_IS_COLUMN_MODEL_ITER (iter));
+
+  cells = clutter_column_model_iter_get_column (iter, column,
+                                                COLUMN_STORAGE_POINTER);
+  if (cells == NULL)
+    return;
+
+  clutter_column_model_iter_invalidate (iter);
+
+  ITER_CELL (cells, gpointer, iter) = value;
+}
@@ -0,0 +1,108 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2011  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined(__CLUTTER_H_INSIDE__) && !defined(CLUTTER_COMPILATION)
+#error "Only <clutter/clutter.h> can be included directly."
+#endif
+
+#ifndef __CLUTTER_COLUMN_MODEL_H__
+#define __CLUTTER_COLUMN_MODEL_H__
+
+#include <clutter/clutter-model.h>
+
+G_BEGIN_DECLS
+
+#define CLUTTER_TYPE_COLUMN_MODEL               (clutter_column_model_get_type ())
+#define CLUTTER_COLUMN_MODEL(obj)               (G_TYPE_CHECK_INSTANCE_CAST ((obj), CLUTTER_TYPE_COLUMN_MODEL, ClutterColumnModel))
+#define CLUTTER_IS_COLUMN_MODEL(obj)            (G_TYPE_CHECK_INSTANCE_TYPE ((obj), CLUTTER_TYPE_COLUMN_MODEL))
+#define CLUTTER_COLUMN_MODEL_CLASS(klass)       (G_TYPE_CHECK_CLASS_CAST ((klass), CLUTTER_TYPE_COLUMN_MODEL, ClutterColumnModelClass))
+#define CLUTTER_IS_COLUMN_MODEL_CLASS(klass)    (G_TYPE_CHECK_CLASS_TYPE ((klass), CLUTTER_TYPE_COLUMN_MODEL))
+#define CLUTTER_COLUMN_MODEL_GET_CLASS(obj)     (G_TYPE_INSTANCE_GET_CLASS ((obj), CLUTTER_TYPE_COLUMN_MODEL, ClutterColumnModelClass))
+
+typedef struct _ClutterColumnModel              ClutterColumnModel;
+typedef struct _ClutterColumnModelPrivate       ClutterColumnModelPrivate;
+typedef struct _ClutterColumnModelClass         ClutterColumnModelClass;
+
+/**
+ * ClutterColumnModel:
+ *
+ * The #ClutterColumnModel struct contains only private data.
+ *
+ * Since: 1.8
+ */
+struct _ClutterColumnModel
+{
+  /*< private >*/
+  ClutterModel parent_instance;
+
+  ClutterColumnModelPrivate *priv;
+};
+
+/**
+ * ClutterColumnModelClass:
+ *
+ * The #ClutterColumnModelClass struct contains only private data.
+ *
+ * Since: 1.8
+ */
+struct _ClutterColumnModelClass
+{
+  /*< private >*/
+  ClutterModelClass parent_class;
+};
+
+GType         clutter_column_model_get_type          (void) G_GNUC_CONST;
+
+ClutterModel *clutter_column_model_new               (guint                n_columns,
+                                                      ...);
+ClutterModel *clutter_column_model_newv              (guint                n_columns,
+                                                      GType               *types,
+                                                      const gchar * const  names[]);
+
+gint          clutter_column_model_iter_get_int      (ClutterModelIter    *iter,
+                                                      guint                column);
+void          clutter_column_model_iter_set_int      (ClutterModelIter    *iter,
+                                                      guint                column,
+                                                      gint                 value);
+gfloat        clutter_column_model_iter_get_float    (ClutterModelIter    *iter,
+                                                      guint                column);
+void          clutter_column_model_iter_set_float    (ClutterModelIter    *iter,
+                                                      guint                column,
+                                                      gfloat               value);
+gdouble       clutter_column_model_iter_get_double   (ClutterModelIter    *iter,
+                                                      guint                column);
+void          clutter_column_model_iter_set_double   (ClutterModelIter    *iter,
+                                                      guint                column,
+                                                      gdouble              value);
+const gchar * clutter_column_model_iter_get_string   (ClutterModelIter    *iter,
+                                                      guint                column);
+void          clutter_column_model_iter_set_string   (ClutterModelIter    *iter,
+                                                      guint                column,
+                                                      const gchar         *value);
+gpointer      clutter_column_model_iter_get_pointer  (ClutterModelIter    *iter,
+                                                      guint                column);
+void          clutter_column_model_iter_set_pointer  (ClutterModelIter    *iter,
+                                                      guint                column,
+                                                      gpointer             value);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_COLUMN_MODEL_H__ */
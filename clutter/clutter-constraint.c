@@ -143,11 +143,19 @@
 
 #include "clutter-actor.h"
 #include "clutter-actor-meta-private.h"
+#include "clutter-align-constraint.h"
+#include "clutter-bind-constraint.h"
+#include "clutter-private.h"
+#include "clutter-snap-constraint.h"
 
 G_DEFINE_ABSTRACT_TYPE (ClutterConstraint,
                         clutter_constraint,
                         CLUTTER_TYPE_ACTOR_META);
 
+/* all the existing constraints, so that the stage can find the ones
+ * depending on the allocation of other actors */
+static GList *all_constraints = NULL;
+
 static void
 constraint_update_allocation (ClutterConstraint *constraint,
                               ClutterActor      *actor,
@@ -172,12 +180,21 @@ clutter_constraint_notify (GObject    *gobject,
     G_OBJECT_CLASS (clutter_constraint_parent_class)->notify (gobject, pspec);
 }
 
+static void
+clutter_constraint_finalize (GObject *gobject)
+{
+  all_constraints = g_list_remove (all_constraints, gobject);
+
+  G_OBJECT_CLASS (clutter_constraint_parent_class)->finalize (gobject);
+}
+
 static void
 clutter_constraint_class_init (ClutterConstraintClass *klass)
 {
   GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
 
   gobject_class->notify = clutter_constraint_notify;
+  gobject_class->finalize = clutter_constraint_finalize;
 
   klass->update_allocation = constraint_update_allocation;
 }
@@ -185,6 +202,7 @@ clutter_constraint_class_init (ClutterConstraintClass *klass)
 static void
 clutter_constraint_init (ClutterConstraint *self)
 {
+  all_constraints = g_list_prepend (all_constraints, self);
 }
 
 void
@@ -200,3 +218,41 @@ _clutter_constraint_update_allocation (ClutterConstraint *constraint,
                                                                 actor,
                                                                 allocation);
 }
+
+/*< private >
+ * _clutter_constraint_peek_all:
+ *
+ * Retrieves all the existing constraints.
+ *
+ * Return value: (transfer none) (element-type Clutter.Constraint): the
+ *   list of constraints, owned by Clutter
+ */
+const GList *
+_clutter_constraint_peek_all (void)
+{
+  return all_constraints;
+}
+
+/*< private >
+ * _clutter_constraint_get_source:
+ * @constraint: a #ClutterConstraint
+ *
+ * Retrieves the actor whose allocation @constraint depends on, for
+ * the constraints provided by Clutter.
+ *
+ * Return value: (transfer none): the source actor, or %NULL
+ */
+ClutterActor *
+_clutter_constraint_get_source (ClutterConstraint *constraint)
+{
+  if (CLUTTER_IS_BIND_CONSTRAINT (constraint))
+    return clutter_bind_constraint_get_source (CLUTTER_BIND_CONSTRAINT (constraint));
+
+  if (CLUTTER_IS_ALIGN_CONSTRAINT (constraint))
+    return clutter_align_constraint_get_source (CLUTTER_ALIGN_CONSTRAINT (constraint));
+
+  if (CLUTTER_IS_SNAP_CONSTRAINT (constraint))
+    return clutter_snap_constraint_get_source (CLUTTER_SNAP_CONSTRAINT (constraint));
+
+  return NULL;
+}
@@ -37,6 +37,7 @@
 #include "clutter-container.h"
 #include "clutter-child-meta.h"
 
+#include "clutter-actor-private.h"
 #include "clutter-debug.h"
 #include "clutter-main.h"
 #include "clutter-marshal.h"
@@ -84,7 +85,6 @@ enum
 };
 
 static guint container_signals[LAST_SIGNAL] = { 0, };
-static GQuark quark_child_meta = 0;
 
 static ClutterChildMeta *get_child_meta     (ClutterContainer *container,
                                              ClutterActor     *actor);
@@ -105,9 +105,6 @@ clutter_container_default_init (ClutterContainerInterface *iface)
 {
   GType iface_type = G_TYPE_FROM_INTERFACE (iface);
 
-  quark_child_meta =
-    g_quark_from_static_string ("clutter-container-child-data");
-
   /**
    * ClutterContainer::actor-added:
    * @container: the actor which received the signal
@@ -280,6 +277,100 @@ clutter_container_add_valist (ClutterContainer *container,
     }
 }
 
+/**
+ * clutter_container_add_actors:
+ * @container: a #ClutterContainer
+ * @actors: (array length=n_actors): the actors to add
+ * @n_actors: the number of actors in @actors
+ *
+ * Adds a batch of actors to @container.
+ *
+ * This function is equivalent to calling clutter_container_add_actor()
+ * for each actor inside @actors, except that containers implementing
+ * the #ClutterContainerIface.add_actors() virtual function will defer
+ * the relayout, the depth sorting and the emission of the
+ * #ClutterContainer::actor-added signal until all the actors have
+ * been added. This makes adding a large number of children
+ * considerably cheaper.
+ *
+ * The #ClutterContainer::actor-added signal is still emitted once for
+ * each actor, in the same order as @actors.
+ *
+ * Since: 1.8
+ */
+void
+clutter_container_add_actors (ClutterContainer    *container,
+                              ClutterActor *const *actors,
+                              guint                n_actors)
+{
+  ClutterContainerIface *iface;
+  ClutterActor **valid;
+  guint i, n_valid;
+
+  g_return_if_fail (CLUTTER_IS_CONTAINER (container));
+  g_return_if_fail (actors != NULL || n_actors == 0);
+
+  if (n_actors == 0)
+    return;
+
+  iface = CLUTTER_CONTAINER_GET_IFACE (container);
+  if (!iface->add)
+    {
+      CLUTTER_CONTAINER_WARN_NOT_IMPLEMENTED (container, "add");
+      return;
+    }
+
+  if (iface->add_actors == NULL)
+    {
+      for (i = 0; i < n_actors; i++)
+        clutter_container_add_actor (container, actors[i]);
+
+      return;
+    }
+
+  /* filter out the actors that clutter_container_add_actor() would
+   * have refused, so that implementations only have to deal with
+   * unparented actors
+   */
+  valid = g_new (ClutterActor *, n_actors);
+  n_valid = 0;
+
+  for (i = 0; i < n_actors; i++)
+    {
+      ClutterActor *actor = actors[i];
+      ClutterActor *parent;
+
+      if (!CLUTTER_IS_ACTOR (actor))
+        {
+          g_critical ("%s: element %u of the actors array is not "
+                      "a ClutterActor",
+                      G_STRFUNC, i);
+          continue;
+        }
+
+      parent = clutter_actor_get_parent (actor);
+      if (parent)
+        {
+          g_warning ("Attempting to add actor of type '%s' to a "
+                     "container of type '%s', but the actor has "
+                     "already a parent of type '%s'.",
+                     g_type_name (G_OBJECT_TYPE (actor)),
+                     g_type_name (G_OBJECT_TYPE (container)),
+                     g_type_name (G_OBJECT_TYPE (parent)));
+          continue;
+        }
+
+      clutter_container_create_child_meta (container, actor);
+
+      valid[n_valid++] = actor;
+    }
+
+  if (n_valid > 0)
+    iface->add_actors (container, valid, n_valid);
+
+  g_free (valid);
+}
+
 /**
  * clutter_container_remove: (skip)
  * @container: a #ClutterContainer
@@ -636,21 +727,18 @@ ClutterActor *
 clutter_container_find_child_by_name (ClutterContainer *container,
                                       const gchar      *child_name)
 {
-  GList        *children;
-  GList        *iter;
+  ClutterContainerIter iter;
+  ClutterActor *a;
   ClutterActor *actor = NULL;
 
   g_return_val_if_fail (CLUTTER_IS_CONTAINER (container), NULL);
   g_return_val_if_fail (child_name != NULL, NULL);
 
-  children = clutter_container_get_children (container);
-
-  for (iter = children; iter; iter = g_list_next (iter))
+  clutter_container_iter_init (&iter, container);
+  while (clutter_container_iter_next (&iter, &a))
     {
-      ClutterActor *a;
       const gchar  *iter_name;
 
-      a = CLUTTER_ACTOR (iter->data);
       iter_name = clutter_actor_get_name (a);
 
       if (iter_name && !strcmp (iter_name, child_name))
@@ -669,11 +757,209 @@ clutter_container_find_child_by_name (ClutterContainer *container,
 	}
     }
 
-  g_list_free (children);
-
   return actor;
 }
 
+typedef struct _RealContainerIter
+{
+  ClutterContainer *container;
+
+  /* the index of the current child; -1 before the first call to
+   * clutter_container_iter_next() or clutter_container_iter_prev() */
+  gint index;
+
+  /* set once the iteration went past either end */
+  gint finished;
+} RealContainerIter;
+
+typedef struct
+{
+  gint index;
+  gint n_children;
+  ClutterActor *child;
+} NthChild;
+
+static void
+get_nth_child_cb (ClutterActor *child,
+                  gpointer      data)
+{
+  NthChild *nth = data;
+
+  if (nth->n_children == nth->index)
+    nth->child = child;
+
+  nth->n_children += 1;
+}
+
+/* retrieves the @index_-th child of @container, and the number of
+ * children; without the peek_children() implementation this has to
+ * go through all the children */
+static ClutterActor *
+get_nth_child (ClutterContainer *container,
+               gint              index_,
+               gint             *n_children)
+{
+  ClutterContainerIface *iface = CLUTTER_CONTAINER_GET_IFACE (container);
+  NthChild nth;
+
+  if (iface->peek_children != NULL)
+    {
+      ClutterActor *const *children;
+      guint n = 0;
+
+      children = iface->peek_children (container, &n);
+
+      *n_children = n;
+
+      if (index_ < 0 || index_ >= (gint) n)
+        return NULL;
+
+      return children[index_];
+    }
+
+  nth.index = index_;
+  nth.n_children = 0;
+  nth.child = NULL;
+
+  clutter_container_foreach (container, get_nth_child_cb, &nth);
+
+  *n_children = nth.n_children;
+
+  return nth.child;
+}
+
+/**
+ * clutter_container_iter_init:
+ * @iter: a #ClutterContainerIter
+ * @container: a #ClutterContainer
+ *
+ * Initializes a #ClutterContainerIter, which can then be used to
+ * iterate efficiently over the children of @container, in the same
+ * order used by clutter_container_foreach(), without copying them
+ * like clutter_container_get_children() does:
+ *
+ * |[
+ *   ClutterContainerIter iter;
+ *   ClutterActor *child;
+ *
+ *   clutter_container_iter_init (&iter, container);
+ *   while (clutter_container_iter_next (&iter, &child))
+ *     {
+ *       /&ast; do something with child &ast;/
+ *     }
+ * ]|
+ *
+ * The children of @container should not be added, removed or
+ * restacked while iterating.
+ *
+ * Since: 1.8
+ */
+void
+clutter_container_iter_init (ClutterContainerIter *iter,
+                             ClutterContainer     *container)
+{
+  RealContainerIter *ri = (RealContainerIter *) iter;
+
+  g_return_if_fail (iter != NULL);
+  g_return_if_fail (CLUTTER_IS_CONTAINER (container));
+
+  ri->container = container;
+  ri->index = -1;
+  ri->finished = FALSE;
+}
+
+/**
+ * clutter_container_iter_next:
+ * @iter: a #ClutterContainerIter
+ * @child: (out) (transfer none): return location for the child
+ *
+ * Advances @iter and retrieves the next child of the container.
+ *
+ * Return value: %FALSE if there are no more children, in which case
+ *   @child is not set
+ *
+ * Since: 1.8
+ */
+gboolean
+clutter_container_iter_next (ClutterContainerIter  *iter,
+                             ClutterActor         **child)
+{
+  RealContainerIter *ri = (RealContainerIter *) iter;
+  ClutterActor *retval;
+  gint n_children;
+
+  g_return_val_if_fail (iter != NULL, FALSE);
+  g_return_val_if_fail (CLUTTER_IS_CONTAINER (ri->container), FALSE);
+
+  if (ri->finished)
+    return FALSE;
+
+  retval = get_nth_child (ri->container, ri->index + 1, &n_children);
+  if (retval == NULL)
+    {
+      ri->finished = TRUE;
+      return FALSE;
+    }
+
+  ri->index += 1;
+
+  if (child != NULL)
+    *child = retval;
+
+  return TRUE;
+}
+
+/**
+ * clutter_container_iter_prev:
+ * @iter: a #ClutterContainerIter
+ * @child: (out) (transfer none): return location for the child
+ *
+ * Moves @iter back and retrieves the previous child of the container;
+ * on a newly initialized @iter, this retrieves the last child.
+ *
+ * Return value: %FALSE if there are no more children, in which case
+ *   @child is not set
+ *
+ * Since: 1.8
+ */
+gboolean
+clutter_container_iter_prev (ClutterContainerIter  *iter,
+                             ClutterActor         **child)
+{
+  RealContainerIter *ri = (RealContainerIter *) iter;
+  ClutterActor *retval;
+  gint index_, n_children;
+
+  g_return_val_if_fail (iter != NULL, FALSE);
+  g_return_val_if_fail (CLUTTER_IS_CONTAINER (ri->container), FALSE);
+
+  if (ri->finished)
+    return FALSE;
+
+  if (ri->index < 0)
+    {
+      /* find out the number of children first */
+      get_nth_child (ri->container, -1, &n_children);
+      index_ = n_children - 1;
+    }
+  else
+    index_ = ri->index - 1;
+
+  retval = get_nth_child (ri->container, index_, &n_children);
+  if (retval == NULL)
+    {
+      ri->finished = TRUE;
+      return FALSE;
+    }
+
+  ri->index = index_;
+
+  if (child != NULL)
+    *child = retval;
+
+  return TRUE;
+}
+
 static ClutterChildMeta *
 get_child_meta (ClutterContainer *container,
                 ClutterActor     *actor)
@@ -684,7 +970,7 @@ get_child_meta (ClutterContainer *container,
   if (iface->child_meta_type == G_TYPE_INVALID)
     return NULL;
 
-  meta = g_object_get_qdata (G_OBJECT (actor), quark_child_meta);
+  meta = _clutter_actor_get_child_meta (actor);
   if (meta != NULL && meta->actor == actor)
     return meta;
 
@@ -713,9 +999,7 @@ create_child_meta (ClutterContainer *container,
                              "actor", actor,
                              NULL);
 
-  g_object_set_qdata_full (G_OBJECT (actor), quark_child_meta,
-                           child_meta,
-                           (GDestroyNotify) g_object_unref);
+  _clutter_actor_set_child_meta (actor, child_meta);
 }
 
 static void
@@ -727,7 +1011,7 @@ destroy_child_meta (ClutterContainer *container,
   if (iface->child_meta_type == G_TYPE_INVALID)
     return;
 
-  g_object_set_qdata (G_OBJECT (actor), quark_child_meta, NULL);
+  _clutter_actor_set_child_meta (actor, NULL);
 }
 
 /**
@@ -43,6 +43,7 @@ G_BEGIN_DECLS
 #define CLUTTER_CONTAINER_GET_IFACE(obj)        (G_TYPE_INSTANCE_GET_INTERFACE ((obj), CLUTTER_TYPE_CONTAINER, ClutterContainerIface))
 
 typedef struct _ClutterContainerIface   ClutterContainerIface;
+typedef struct _ClutterContainerIter    ClutterContainerIter;
 
 /**
  * ClutterContainer:
@@ -83,6 +84,18 @@ typedef struct _ClutterContainerIface   ClutterContainerIface;
  * @actor_added: class handler for #ClutterContainer::actor-added
  * @actor_removed: class handler for #ClutterContainer::actor-removed
  * @child_notify: class handler for #ClutterContainer::child-notify
+ * @add_actors: virtual function for adding a batch of actors to the
+ *   container; the implementation should emit #ClutterContainer::actor-added
+ *   for each actor and queue a single relayout once all of them have been
+ *   added. If not implemented, @add will be called for each actor. Added
+ *   in Clutter 1.8
+ * @peek_children: virtual function returning the children of the
+ *   container, in the same order used by @foreach, as an array owned by
+ *   the container; it is used by #ClutterContainerIter to iterate over
+ *   the children without copying them. If not implemented, the iterator
+ *   will use @foreach to find each child; implementations overriding the
+ *   @foreach of a parent class should override this function as well.
+ *   Added in Clutter 1.8
  *
  * Base interface for container actors. The @add, @remove and @foreach
  * virtual functions must be provided by any implementation; the other
@@ -135,6 +148,30 @@ struct _ClutterContainerIface
   void (* child_notify)  (ClutterContainer *container,
                           ClutterActor     *child,
                           GParamSpec       *pspec);
+
+  void (* add_actors)    (ClutterContainer    *container,
+                          ClutterActor *const *actors,
+                          guint                n_actors);
+
+  ClutterActor *const *(* peek_children) (ClutterContainer *container,
+                                          guint            *n_children);
+};
+
+/**
+ * ClutterContainerIter:
+ *
+ * An iterator over the children of a #ClutterContainer, which can be
+ * allocated on the stack. The #ClutterContainerIter structure contains
+ * only private data and should be accessed using the provided API
+ *
+ * Since: 1.8
+ */
+struct _ClutterContainerIter
+{
+  /*< private >*/
+  gpointer dummy1;
+  gint     dummy2;
+  gint     dummy3;
 };
 
 GType         clutter_container_get_type         (void) G_GNUC_CONST;
@@ -147,6 +184,9 @@ void          clutter_container_add_actor        (ClutterContainer *container,
 void          clutter_container_add_valist       (ClutterContainer *container,
                                                   ClutterActor     *first_actor,
                                                   va_list           var_args);
+void          clutter_container_add_actors       (ClutterContainer    *container,
+                                                  ClutterActor *const *actors,
+                                                  guint                n_actors);
 void          clutter_container_remove           (ClutterContainer *container,
                                                   ClutterActor     *first_actor,
                                                   ...) G_GNUC_NULL_TERMINATED;
@@ -164,6 +204,13 @@ void          clutter_container_foreach_with_internals (ClutterContainer *contai
                                                         gpointer          user_data);
 ClutterActor *clutter_container_find_child_by_name     (ClutterContainer *container,
                                                         const gchar      *child_name);
+
+void          clutter_container_iter_init              (ClutterContainerIter *iter,
+                                                        ClutterContainer     *container);
+gboolean      clutter_container_iter_next              (ClutterContainerIter *iter,
+                                                        ClutterActor        **child);
+gboolean      clutter_container_iter_prev              (ClutterContainerIter *iter,
+                                                        ClutterActor        **child);
 void          clutter_container_raise_child            (ClutterContainer *container,
                                                         ClutterActor     *actor,
                                                         ClutterActor     *sibling);
@@ -39,7 +39,12 @@ typedef enum {
   CLUTTER_DEBUG_DISABLE_CLIPPED_REDRAWS = 1 << 1,
   CLUTTER_DEBUG_REDRAWS                 = 1 << 2,
   CLUTTER_DEBUG_PAINT_VOLUMES           = 1 << 3,
-  CLUTTER_DEBUG_DISABLE_CULLING         = 1 << 4
+  CLUTTER_DEBUG_DISABLE_CULLING         = 1 << 4,
+  CLUTTER_DEBUG_DISABLE_SUBTREE_CACHE   = 1 << 5,
+  CLUTTER_DEBUG_GPU_TIMINGS             = 1 << 6,
+  CLUTTER_DEBUG_REDRAW_CAUSES           = 1 << 7,
+  CLUTTER_DEBUG_OVERDRAW                = 1 << 8,
+  CLUTTER_DEBUG_DISABLE_DISPLAY_LISTS   = 1 << 9
 } ClutterDrawDebugFlag;
 
 #ifdef CLUTTER_ENABLE_DEBUG
@@ -47,6 +47,31 @@
  *   Each passed vertex is an in-out parameter that initially contains the
  *   position of the vertex and should be modified according to a specific
  *   deformation algorithm.</para>
+ *   <para>Sub-classes can also override the
+ *   <function>deform_vertices()</function> virtual function, which is
+ *   called on the whole array of vertices at once; this allows computing
+ *   what all the vertices have in common only once, and processing them
+ *   in a tight loop.</para>
+ *   <para>Calling <function>deform_vertex()</function> on every vertex
+ *   and submitting the whole geometry again at every change of the
+ *   deformation can be expensive with many tiles; sub-classes can also
+ *   implement the deformation as GLSL, by overriding the
+ *   <function>get_vertex_shader()</function> virtual function. The
+ *   returned source should declare the uniforms it needs and define the
+ *   following function:</para>
+ *   <programlisting>
+ * void clutter_deform_vertex (float width, float height,
+ *                             inout vec3 position,
+ *                             inout vec4 color);
+ *   </programlisting>
+ *   <para>where the position of the vertex, in pixels, and its color
+ *   should be modified in the same way <function>deform_vertex()</function>
+ *   would. The geometry is then submitted only when the number of tiles
+ *   changes, and each change of the deformation only updates the uniforms,
+ *   inside the <function>update_uniforms()</function> virtual function.
+ *   The source is compiled once for each sub-class. The
+ *   <function>deform_vertex()</function> virtual function is still used
+ *   when the GLSL shading language is not available.</para>
  * </refsect2>
  *
  * #ClutterDeformEffect is available since Clutter 1.4
@@ -84,9 +109,56 @@ struct _ClutterDeformEffectPrivate
 
   gulong allocation_id;
 
+  /* the copy of the back material running the deformation program */
+  CoglHandle gpu_back_material;
+
   guint is_dirty : 1;
+
+  /* whether the vbo holds the undeformed grid used by the program */
+  guint has_static_grid : 1;
 };
 
+/* the deformation running on the GPU, compiled once for each sub-class */
+typedef struct _DeformProgram
+{
+  /* COGL_INVALID_HANDLE if the program could not be built */
+  CoglHandle program;
+
+  gint width_location;
+  gint height_location;
+  gint opacity_location;
+} DeformProgram;
+
+static const gchar deform_vertex_shader_header[] =
+"uniform float clutter_deform_width;\n"
+"uniform float clutter_deform_height;\n"
+"uniform float clutter_deform_opacity;\n"
+"\n";
+
+/* the grid is made of the texture coordinates of the vertices, which
+ * are scaled to the size of the target before being deformed
+ */
+static const gchar deform_vertex_shader_footer[] =
+"\n"
+"void main ()\n"
+"{\n"
+"  vec3 position = vec3 (cogl_position_in.x * clutter_deform_width,\n"
+"                        cogl_position_in.y * clutter_deform_height,\n"
+"                        0.0);\n"
+"  vec4 color = vec4 (1.0, 1.0, 1.0, clutter_deform_opacity);\n"
+"\n"
+"  clutter_deform_vertex (clutter_deform_width, clutter_deform_height,\n"
+"                         position,\n"
+"                         color);\n"
+"\n"
+"  cogl_position_out = cogl_modelview_projection_matrix\n"
+"                    * vec4 (position, 1.0);\n"
+"  cogl_tex_coord_out[0] = cogl_tex_coord_in;\n"
+"  cogl_color_out = color;\n"
+"}\n";
+
+static GQuark quark_deform_program = 0;
+
 enum
 {
   PROP_0,
@@ -118,15 +190,19 @@ clutter_deform_effect_real_deform_vertex (ClutterDeformEffect *effect,
              G_OBJECT_TYPE_NAME (effect));
 }
 
-void
-_clutter_deform_effect_deform_vertex (ClutterDeformEffect *effect,
-                                      gfloat               width,
-                                      gfloat               height,
-                                      CoglTextureVertex   *vertex)
+/* the default implementation goes through the vertices one by one */
+static void
+clutter_deform_effect_real_deform_vertices (ClutterDeformEffect *effect,
+                                            gfloat               width,
+                                            gfloat               height,
+                                            CoglTextureVertex   *vertices,
+                                            guint                n_vertices)
 {
-  CLUTTER_DEFORM_EFFECT_GET_CLASS (effect)->deform_vertex (effect,
-                                                           width, height,
-                                                           vertex);
+  ClutterDeformEffectClass *klass = CLUTTER_DEFORM_EFFECT_GET_CLASS (effect);
+  guint i;
+
+  for (i = 0; i < n_vertices; i++)
+    klass->deform_vertex (effect, width, height, &vertices[i]);
 }
 
 static void
@@ -165,75 +241,275 @@ clutter_deform_effect_set_actor (ClutterActorMeta *meta,
   CLUTTER_ACTOR_META_CLASS (clutter_deform_effect_parent_class)->set_actor (meta, actor);
 }
 
+/* builds the program running the deformation of @self on the GPU */
+static DeformProgram *
+clutter_deform_effect_get_program (ClutterDeformEffect *self)
+{
+  ClutterDeformEffectClass *klass = CLUTTER_DEFORM_EFFECT_GET_CLASS (self);
+  GType gtype = G_OBJECT_TYPE (self);
+  DeformProgram *deform;
+  const gchar *source;
+  gchar *full_source;
+  CoglHandle shader;
+
+  if (klass->get_vertex_shader == NULL)
+    return NULL;
+
+  deform = g_type_get_qdata (gtype, quark_deform_program);
+  if (deform != NULL)
+    return deform->program != COGL_INVALID_HANDLE ? deform : NULL;
+
+  if (!clutter_feature_available (CLUTTER_FEATURE_SHADERS_GLSL))
+    return NULL;
+
+  /* the program is kept for as long as the type is around, which is
+   * the lifetime of the process; even if we fail, we do not want to
+   * try again at every paint
+   */
+  deform = g_new0 (DeformProgram, 1);
+  deform->program = COGL_INVALID_HANDLE;
+  deform->width_location = -1;
+  deform->height_location = -1;
+  deform->opacity_location = -1;
+  g_type_set_qdata (gtype, quark_deform_program, deform);
+
+  source = klass->get_vertex_shader (self);
+  if (source == NULL)
+    return NULL;
+
+  full_source = g_strconcat (deform_vertex_shader_header,
+                             source,
+                             deform_vertex_shader_footer,
+                             NULL);
+
+  shader = cogl_create_shader (COGL_SHADER_TYPE_VERTEX);
+  cogl_shader_source (shader, full_source);
+  cogl_shader_compile (shader);
+
+  g_free (full_source);
+
+  if (!cogl_shader_is_compiled (shader))
+    {
+      gchar *log_buf = cogl_shader_get_info_log (shader);
+
+      g_warning (G_STRLOC ": Unable to compile the deformation of '%s', "
+                 "falling back to deforming the vertices on the CPU: %s",
+                 G_OBJECT_TYPE_NAME (self),
+                 log_buf);
+      g_free (log_buf);
+
+      cogl_handle_unref (shader);
+
+      return NULL;
+    }
+
+  deform->program = cogl_create_program ();
+  cogl_program_attach_shader (deform->program, shader);
+  cogl_program_link (deform->program);
+  cogl_handle_unref (shader);
+
+  deform->width_location =
+    cogl_program_get_uniform_location (deform->program,
+                                       "clutter_deform_width");
+  deform->height_location =
+    cogl_program_get_uniform_location (deform->program,
+                                       "clutter_deform_height");
+  deform->opacity_location =
+    cogl_program_get_uniform_location (deform->program,
+                                       "clutter_deform_opacity");
+
+  return deform;
+}
+
+/* submits the undeformed grid, which the program scales and deforms */
 static void
-clutter_deform_effect_paint_target (ClutterOffscreenEffect *effect)
+clutter_deform_effect_upload_grid (ClutterDeformEffect *self)
 {
-  ClutterDeformEffect *self= CLUTTER_DEFORM_EFFECT (effect);
   ClutterDeformEffectPrivate *priv = self->priv;
-  gboolean is_depth_enabled, is_cull_enabled;
-  CoglHandle material;
-  gint n_tiles;
+  gint i, j;
 
-  if (priv->is_dirty)
+  for (i = 0; i < priv->y_tiles + 1; i++)
     {
-      ClutterActor *actor;
-      gfloat width, height;
-      guint opacity;
-      gint i, j;
+      for (j = 0; j < priv->x_tiles + 1; j++)
+        {
+          CoglTextureVertex *vertex;
 
-      actor = clutter_actor_meta_get_actor (CLUTTER_ACTOR_META (effect));
-      opacity = clutter_actor_get_paint_opacity (actor);
+          vertex = &priv->vertices[(i * (priv->x_tiles + 1)) + j];
 
-      /* if we don't have a target size, fall back to the actor's
-       * allocation, though wrong it might be
-       */
-      if (!clutter_offscreen_effect_get_target_size (effect, &width, &height))
-        clutter_actor_get_size (actor, &width, &height);
+          vertex->tx = (float) j / priv->x_tiles;
+          vertex->ty = (float) i / priv->y_tiles;
 
-      for (i = 0; i < priv->y_tiles + 1; i++)
-        {
-          for (j = 0; j < priv->x_tiles + 1; j++)
-            {
-              CoglTextureVertex *vertex;
+          vertex->x = vertex->tx;
+          vertex->y = vertex->ty;
+          vertex->z = 0.0f;
+        }
+    }
 
-              vertex = &priv->vertices[(i * (priv->x_tiles + 1)) + j];
+  cogl_vertex_buffer_add (priv->vbo, "gl_Vertex",
+                          3,
+                          COGL_ATTRIBUTE_TYPE_FLOAT,
+                          FALSE,
+                          sizeof (CoglTextureVertex),
+                          &priv->vertices->x);
+  cogl_vertex_buffer_add (priv->vbo, "gl_MultiTexCoord0",
+                          2,
+                          COGL_ATTRIBUTE_TYPE_FLOAT,
+                          FALSE,
+                          sizeof (CoglTextureVertex),
+                          &priv->vertices->tx);
+
+  priv->has_static_grid = TRUE;
+}
 
-              vertex->tx = (float) j / priv->x_tiles;
-              vertex->ty = (float) i / priv->y_tiles;
+/* deforms every vertex on the CPU and submits the whole geometry */
+static void
+clutter_deform_effect_update_vertices (ClutterDeformEffect *self,
+                                       gfloat               width,
+                                       gfloat               height,
+                                       guint                opacity)
+{
+  ClutterDeformEffectPrivate *priv = self->priv;
+  CoglTextureVertex *vertex;
+  gint i, j;
 
-              vertex->x = width * vertex->tx;
-              vertex->y = height * vertex->ty;
-              vertex->z = 0.0f;
+  vertex = priv->vertices;
+  for (i = 0; i < priv->y_tiles + 1; i++)
+    {
+      for (j = 0; j < priv->x_tiles + 1; j++)
+        {
+          vertex->tx = (float) j / priv->x_tiles;
+          vertex->ty = (float) i / priv->y_tiles;
 
-              cogl_color_init_from_4ub (&vertex->color, 255, 255, 255, opacity);
+          vertex->x = width * vertex->tx;
+          vertex->y = height * vertex->ty;
+          vertex->z = 0.0f;
 
-              _clutter_deform_effect_deform_vertex (self, width, height, vertex);
-            }
+          cogl_color_init_from_4ub (&vertex->color, 255, 255, 255, opacity);
+
+          vertex += 1;
         }
+    }
+
+  /* a single call for the whole grid lets sub-classes work out what
+   * all the vertices have in common only once
+   */
+  CLUTTER_DEFORM_EFFECT_GET_CLASS (self)->deform_vertices (self,
+                                                           width, height,
+                                                           priv->vertices,
+                                                           vertex - priv->vertices);
+
+  /* XXX in theory, the sub-classes should tell us what they changed
+   * in the texture vertices; we then would be able to avoid resubmitting
+   * the same data, if it did not change. for the time being, we resubmit
+   * everything
+   */
+  cogl_vertex_buffer_add (priv->vbo, "gl_Vertex",
+                          3,
+                          COGL_ATTRIBUTE_TYPE_FLOAT,
+                          FALSE,
+                          sizeof (CoglTextureVertex),
+                          &priv->vertices->x);
+  cogl_vertex_buffer_add (priv->vbo, "gl_MultiTexCoord0",
+                          2,
+                          COGL_ATTRIBUTE_TYPE_FLOAT,
+                          FALSE,
+                          sizeof (CoglTextureVertex),
+                          &priv->vertices->tx);
+  cogl_vertex_buffer_add (priv->vbo, "gl_Color",
+                          4,
+                          COGL_ATTRIBUTE_TYPE_UNSIGNED_BYTE,
+                          FALSE,
+                          sizeof (CoglTextureVertex),
+                          &priv->vertices->color);
+
+  priv->has_static_grid = FALSE;
+}
+
+/* draws the mesh with @material, running the deformation program on
+ * it if there is one; the material is left as we found it
+ */
+static void
+clutter_deform_effect_draw_mesh (ClutterDeformEffect *self,
+                                 CoglHandle           material,
+                                 CoglHandle           indices,
+                                 DeformProgram       *deform)
+{
+  ClutterDeformEffectPrivate *priv = self->priv;
+  CoglHandle old_program = COGL_INVALID_HANDLE;
+  gint n_tiles;
 
-      /* XXX in theory, the sub-classes should tell us what they changed
-       * in the texture vertices; we then would be able to avoid resubmitting
-       * the same data, if it did not change. for the time being, we resubmit
-       * everything
-       */
-      cogl_vertex_buffer_add (priv->vbo, "gl_Vertex",
-                              3,
-                              COGL_ATTRIBUTE_TYPE_FLOAT,
-                              FALSE,
-                              sizeof (CoglTextureVertex),
-                              &priv->vertices->x);
-      cogl_vertex_buffer_add (priv->vbo, "gl_MultiTexCoord0",
-                              2,
-                              COGL_ATTRIBUTE_TYPE_FLOAT,
-                              FALSE,
-                              sizeof (CoglTextureVertex),
-                              &priv->vertices->tx);
-      cogl_vertex_buffer_add (priv->vbo, "gl_Color",
-                              4,
-                              COGL_ATTRIBUTE_TYPE_UNSIGNED_BYTE,
-                              FALSE,
-                              sizeof (CoglTextureVertex),
-                              &priv->vertices->color);
+  n_tiles = (priv->x_tiles + 1) * (priv->y_tiles + 1);
+
+  if (deform != NULL)
+    {
+      old_program = cogl_material_get_user_program (material);
+      cogl_material_set_user_program (material, deform->program);
+    }
+
+  cogl_set_source (material);
+  cogl_vertex_buffer_draw_elements (priv->vbo,
+                                    COGL_VERTICES_MODE_TRIANGLE_STRIP,
+                                    indices,
+                                    0,
+                                    n_tiles,
+                                    0,
+                                    priv->n_indices);
+
+  if (deform != NULL)
+    cogl_material_set_user_program (material, old_program);
+}
+
+static void
+clutter_deform_effect_paint_target (ClutterOffscreenEffect *effect)
+{
+  ClutterDeformEffect *self= CLUTTER_DEFORM_EFFECT (effect);
+  ClutterDeformEffectPrivate *priv = self->priv;
+  gboolean is_depth_enabled, is_cull_enabled;
+  DeformProgram *deform;
+  CoglHandle material;
+  ClutterActor *actor;
+  gfloat width, height;
+  guint opacity;
+
+  actor = clutter_actor_meta_get_actor (CLUTTER_ACTOR_META (effect));
+  opacity = clutter_actor_get_paint_opacity (actor);
+
+  /* if we don't have a target size, fall back to the actor's
+   * allocation, though wrong it might be
+   */
+  if (!clutter_offscreen_effect_get_target_size (effect, &width, &height))
+    clutter_actor_get_size (actor, &width, &height);
+
+  deform = clutter_deform_effect_get_program (self);
+  if (deform != NULL)
+    {
+      ClutterDeformEffectClass *klass = CLUTTER_DEFORM_EFFECT_GET_CLASS (self);
+
+      /* the geometry only changes with the number of tiles */
+      if (!priv->has_static_grid)
+        clutter_deform_effect_upload_grid (self);
+
+      if (deform->width_location > -1)
+        cogl_program_set_uniform_1f (deform->program,
+                                     deform->width_location,
+                                     width);
+      if (deform->height_location > -1)
+        cogl_program_set_uniform_1f (deform->program,
+                                     deform->height_location,
+                                     height);
+      if (deform->opacity_location > -1)
+        cogl_program_set_uniform_1f (deform->program,
+                                     deform->opacity_location,
+                                     opacity / 255.0f);
+
+      if (klass->update_uniforms != NULL)
+        klass->update_uniforms (self, deform->program);
+
+      priv->is_dirty = FALSE;
+    }
+  else if (priv->is_dirty || priv->has_static_grid)
+    {
+      clutter_deform_effect_update_vertices (self, width, height, opacity);
 
       priv->is_dirty = FALSE;
     }
@@ -252,35 +528,16 @@ clutter_deform_effect_paint_target (ClutterOffscreenEffect *effect)
   else if (priv->back_material == COGL_INVALID_HANDLE && is_cull_enabled)
     cogl_set_backface_culling_enabled (FALSE);
 
-  n_tiles = (priv->x_tiles + 1) * (priv->y_tiles + 1);
-
   /* draw the front */
   material = clutter_offscreen_effect_get_target (effect);
   if (material != COGL_INVALID_HANDLE)
-    {
-      cogl_set_source (material);
-      cogl_vertex_buffer_draw_elements (priv->vbo,
-                                        COGL_VERTICES_MODE_TRIANGLE_STRIP,
-                                        priv->indices,
-                                        0,
-                                        n_tiles,
-                                        0,
-                                        priv->n_indices);
-    }
+    clutter_deform_effect_draw_mesh (self, material, priv->indices, deform);
 
   /* draw the back */
   material = priv->back_material;
   if (material != COGL_INVALID_HANDLE)
-    {
-      cogl_set_source (priv->back_material);
-      cogl_vertex_buffer_draw_elements (priv->vbo,
-                                        COGL_VERTICES_MODE_TRIANGLE_STRIP,
-                                        priv->back_indices,
-                                        0,
-                                        n_tiles,
-                                        0,
-                                        priv->n_indices);
-    }
+    clutter_deform_effect_draw_mesh (self, material, priv->back_indices,
+                                     deform);
 
   /* restore the previous state */
   if (!is_depth_enabled)
@@ -420,6 +677,7 @@ clutter_deform_effect_init_arrays (ClutterDeformEffect *self)
   priv->vbo = cogl_vertex_buffer_new (n_tiles);
 
   priv->is_dirty = TRUE;
+  priv->has_static_grid = FALSE;
 }
 
 static inline void
@@ -512,7 +770,11 @@ clutter_deform_effect_class_init (ClutterDeformEffectClass *klass)
 
   g_type_class_add_private (klass, sizeof (ClutterDeformEffectPrivate));
 
+  quark_deform_program =
+    g_quark_from_static_string ("clutter-deform-effect-program");
+
   klass->deform_vertex = clutter_deform_effect_real_deform_vertex;
+  klass->deform_vertices = clutter_deform_effect_real_deform_vertices;
 
   /**
    * ClutterDeformEffect:x-tiles:
@@ -584,6 +846,10 @@ clutter_deform_effect_init (ClutterDeformEffect *self)
   self->priv->x_tiles = self->priv->y_tiles = DEFAULT_N_TILES;
   self->priv->back_material = COGL_INVALID_HANDLE;
 
+  /* the mesh maps the whole target texture */
+  _clutter_offscreen_effect_set_use_pool (CLUTTER_OFFSCREEN_EFFECT (self),
+                                          FALSE);
+
   clutter_deform_effect_init_arrays (self);
 }
 
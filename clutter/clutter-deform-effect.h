@@ -65,6 +65,15 @@ struct _ClutterDeformEffect
  * ClutterDeformEffectClass:
  * @deform_vertex: virtual function; sub-classes should override this
  *   function to compute the deformation of each vertex
+ * @get_vertex_shader: virtual function; sub-classes can override this
+ *   function to return the GLSL source of the deformation, which is
+ *   then run on the GPU instead of @deform_vertex. Since: 1.8
+ * @update_uniforms: virtual function; sub-classes overriding
+ *   @get_vertex_shader should override this function to set the value
+ *   of the uniforms used by the deformation. Since: 1.8
+ * @deform_vertices: virtual function; sub-classes can override this
+ *   function to deform all the vertices at once, instead of calling
+ *   @deform_vertex on each of them. Since: 1.8
  *
  * The <structname>ClutterDeformEffectClass</structname> structure contains
  * only private data
@@ -82,10 +91,16 @@ struct _ClutterDeformEffectClass
                           gfloat               height,
                           CoglTextureVertex   *vertex);
 
+  const gchar *(* get_vertex_shader) (ClutterDeformEffect *effect);
+  void         (* update_uniforms)   (ClutterDeformEffect *effect,
+                                      CoglHandle           program);
+  void         (* deform_vertices)   (ClutterDeformEffect *effect,
+                                      gfloat               width,
+                                      gfloat               height,
+                                      CoglTextureVertex   *vertices,
+                                      guint                n_vertices);
+
   /*< private >*/
-  void (*_clutter_deform1) (void);
-  void (*_clutter_deform2) (void);
-  void (*_clutter_deform3) (void);
   void (*_clutter_deform4) (void);
   void (*_clutter_deform5) (void);
   void (*_clutter_deform6) (void);
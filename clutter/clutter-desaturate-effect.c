@@ -52,6 +52,7 @@
 #include "clutter-debug.h"
 #include "clutter-enum-types.h"
 #include "clutter-offscreen-effect.h"
+#include "clutter-offscreen-effect-private.h"
 #include "clutter-private.h"
 
 struct _ClutterDesaturateEffect
@@ -222,6 +223,42 @@ out:
   parent->paint_target (effect);
 }
 
+/* the same conversion as desaturate_glsl_shader, for the chains of
+ * color effects painted in a single pass */
+static void
+clutter_desaturate_effect_stage_source (ClutterOffscreenEffect *effect,
+                                        GString                *source,
+                                        guint                   stage)
+{
+  g_string_append_printf (source,
+                          "uniform float factor_%u;\n"
+                          "\n"
+                          "vec4 stage_%u (vec4 color)\n"
+                          "{\n"
+                          "  const vec3 gray_conv = vec3 (0.299, 0.587, 0.114);\n"
+                          "  vec3 gray = vec3 (dot (gray_conv, color.rgb));\n"
+                          "  return vec4 (mix (color.rgb, gray, factor_%u), color.a);\n"
+                          "}\n"
+                          "\n",
+                          stage, stage, stage);
+}
+
+static void
+clutter_desaturate_effect_stage_uniforms (ClutterOffscreenEffect *effect,
+                                          CoglHandle              program,
+                                          guint                   stage)
+{
+  ClutterDesaturateEffect *self = CLUTTER_DESATURATE_EFFECT (effect);
+  gchar name[32];
+  gint uniform;
+
+  g_snprintf (name, sizeof (name), "factor_%u", stage);
+
+  uniform = cogl_program_get_uniform_location (program, name);
+  if (uniform > -1)
+    cogl_program_set_uniform_1f (program, uniform, self->factor);
+}
+
 static void
 clutter_desaturate_effect_dispose (GObject *gobject)
 {
@@ -289,6 +326,10 @@ clutter_desaturate_effect_class_init (ClutterDesaturateEffectClass *klass)
   offscreen_class = CLUTTER_OFFSCREEN_EFFECT_CLASS (klass);
   offscreen_class->paint_target = clutter_desaturate_effect_paint_target;
 
+  _clutter_offscreen_effect_class_add_color_stage (offscreen_class,
+                                                   clutter_desaturate_effect_stage_source,
+                                                   clutter_desaturate_effect_stage_uniforms);
+
   effect_class->pre_paint = clutter_desaturate_effect_pre_paint;
 
   /**
@@ -362,10 +403,15 @@ clutter_desaturate_effect_set_factor (ClutterDesaturateEffect *effect,
 
   if (fabsf (effect->factor - factor) >= 0.00001)
     {
+      ClutterActor *actor;
+
       effect->factor = factor;
 
-      if (effect->actor != NULL)
-        clutter_actor_queue_redraw (effect->actor);
+      /* the effect might be painted by the one before it, in which
+       * case it never runs and effect->actor is not set */
+      actor = clutter_actor_meta_get_actor (CLUTTER_ACTOR_META (effect));
+      if (actor != NULL)
+        clutter_actor_queue_redraw (actor);
 
       g_object_notify_by_pspec (G_OBJECT (effect), obj_props[PROP_FACTOR]);
     }
@@ -73,6 +73,11 @@ struct _ClutterInputDevice
   /* the actor underneath the pointer */
   ClutterActor *cursor_actor;
 
+  /* the region of the stage in which a pick is known to return
+   * the cursor actor, for as long as the scene does not change */
+  ClutterVertex cursor_quad[4];
+  guint cursor_scene_serial;
+
   /* the actor that has a grab in place for the device */
   ClutterActor *pointer_grab_actor;
 
@@ -103,6 +108,7 @@ struct _ClutterInputDevice
 
   guint has_cursor : 1;
   guint is_enabled : 1;
+  guint cursor_quad_valid : 1;
 };
 
 struct _ClutterInputDeviceClass
@@ -0,0 +1,392 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2011  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* This file contains the display lists used by ClutterActor to paint
+ * the subtrees that did not change since the previous frames without
+ * running the paint functions of their actors. While a subtree is
+ * painted, the actors whose type was registered as recordable log the
+ * rectangles they draw, with their source and their modelview relative
+ * to the root of the subtree; replaying the list draws the same
+ * rectangles again, relative to the current modelview. Any actor that
+ * paints something the list cannot represent aborts the recording. */
+
+#include <string.h>
+
+#include "clutter-display-list.h"
+
+typedef struct _DisplayListOp   DisplayListOp;
+
+struct _DisplayListOp
+{
+  /* the modelview, relative to the one of the root of the list */
+  CoglMatrix modelview;
+
+  /* the source of the rectangles; if it is COGL_INVALID_HANDLE, the
+   * rectangles are drawn with @color and have no texture coordinates */
+  CoglHandle material;
+  ClutterColor color;
+
+  /* the offset of the first coordinate in the array of coordinates
+   * of the list, and the number of rectangles */
+  guint first_coord;
+  guint n_rects;
+};
+
+struct _ClutterDisplayList
+{
+  GArray *ops;
+  GArray *coords;
+
+  /* the paint opacity of the root of the list when it was recorded */
+  guint8 opacity;
+};
+
+/* the list being recorded, with the inverse of the modelview of its
+ * root; lists are not nested, so there is at most one of them */
+static ClutterDisplayList *recording = NULL;
+static CoglMatrix recording_inverse;
+static gboolean recording_failed = FALSE;
+
+static GQuark quark_recordable = 0;
+
+/*< private >
+ * _clutter_display_list_add_recordable_type:
+ * @type: the #GType of an actor
+ *
+ * Declares that the paint function of the actors of @type records
+ * everything it draws, and that it paints its children, if any, using
+ * clutter_actor_paint(). The subtypes of @type are not recordable
+ * unless they are declared as well, since they might override the
+ * paint function.
+ */
+void
+_clutter_display_list_add_recordable_type (GType type)
+{
+  if (G_UNLIKELY (quark_recordable == 0))
+    quark_recordable = g_quark_from_static_string ("clutter-display-list-recordable");
+
+  g_type_set_qdata (type, quark_recordable, GINT_TO_POINTER (TRUE));
+}
+
+/*< private >
+ * _clutter_display_list_is_recordable_type:
+ * @type: the #GType of an actor
+ *
+ * Checks whether @type was declared using
+ * _clutter_display_list_add_recordable_type().
+ *
+ * Return value: %TRUE if the actors of @type can be recorded
+ */
+gboolean
+_clutter_display_list_is_recordable_type (GType type)
+{
+  if (quark_recordable == 0)
+    return FALSE;
+
+  return g_type_get_qdata (type, quark_recordable) != NULL;
+}
+
+static void
+clutter_display_list_clear_ops (ClutterDisplayList *list)
+{
+  guint i;
+
+  for (i = 0; i < list->ops->len; i++)
+    {
+      DisplayListOp *op = &g_array_index (list->ops, DisplayListOp, i);
+
+      if (op->material != COGL_INVALID_HANDLE)
+        cogl_handle_unref (op->material);
+    }
+
+  g_array_set_size (list->ops, 0);
+  g_array_set_size (list->coords, 0);
+}
+
+/*< private >
+ * _clutter_display_list_begin_recording:
+ * @opacity: the paint opacity of the root of the list
+ *
+ * Starts recording a display list, relative to the current modelview.
+ * The recording ends with _clutter_display_list_end_recording().
+ */
+void
+_clutter_display_list_begin_recording (guint8 opacity)
+{
+  CoglMatrix modelview;
+
+  g_return_if_fail (recording == NULL);
+
+  recording = g_slice_new (ClutterDisplayList);
+  recording->ops = g_array_new (FALSE, FALSE, sizeof (DisplayListOp));
+  recording->coords = g_array_new (FALSE, FALSE, sizeof (gfloat));
+  recording->opacity = opacity;
+
+  cogl_get_modelview_matrix (&modelview);
+  recording_failed = !cogl_matrix_get_inverse (&modelview,
+                                               &recording_inverse);
+}
+
+/*< private >
+ * _clutter_display_list_end_recording:
+ *
+ * Ends the recording started by _clutter_display_list_begin_recording().
+ *
+ * Return value: the recorded display list, or %NULL if the recording
+ *   was aborted; use _clutter_display_list_free() to free it
+ */
+ClutterDisplayList *
+_clutter_display_list_end_recording (void)
+{
+  ClutterDisplayList *retval = recording;
+
+  g_return_val_if_fail (recording != NULL, NULL);
+
+  recording = NULL;
+
+  if (recording_failed)
+    {
+      _clutter_display_list_free (retval);
+      return NULL;
+    }
+
+  return retval;
+}
+
+/*< private >
+ * _clutter_display_list_is_recording:
+ *
+ * Checks whether a display list is being recorded.
+ *
+ * Return value: %TRUE if a display list is being recorded
+ */
+gboolean
+_clutter_display_list_is_recording (void)
+{
+  return recording != NULL;
+}
+
+/*< private >
+ * _clutter_display_list_abort_recording:
+ *
+ * Marks the display list being recorded as unusable, because something
+ * that it cannot represent was painted; the painting goes on, but
+ * _clutter_display_list_end_recording() will return %NULL.
+ */
+void
+_clutter_display_list_abort_recording (void)
+{
+  if (recording == NULL || recording_failed)
+    return;
+
+  recording_failed = TRUE;
+
+  /* the ops recorded so far are not going to be used */
+  clutter_display_list_clear_ops (recording);
+}
+
+static void
+clutter_display_list_add_op (CoglHandle          material,
+                             const ClutterColor *color,
+                             const gfloat       *coords,
+                             guint               n_coords,
+                             guint               n_rects)
+{
+  DisplayListOp *op;
+  CoglMatrix current, modelview;
+
+  if (recording == NULL || recording_failed || n_rects == 0)
+    return;
+
+  cogl_get_modelview_matrix (&current);
+  cogl_matrix_multiply (&modelview, &recording_inverse, &current);
+
+  /* the rectangles of the same actor and with the same source are
+   * replayed with a single call, like the actor drew them */
+  if (recording->ops->len > 0)
+    {
+      op = &g_array_index (recording->ops, DisplayListOp,
+                           recording->ops->len - 1);
+
+      if (material == COGL_INVALID_HANDLE &&
+          op->material == COGL_INVALID_HANDLE &&
+          clutter_color_equal (&op->color, color) &&
+          memcmp (&op->modelview, &modelview, sizeof (CoglMatrix)) == 0)
+        {
+          g_array_append_vals (recording->coords, coords, n_coords);
+          op->n_rects += n_rects;
+          return;
+        }
+    }
+
+  g_array_set_size (recording->ops, recording->ops->len + 1);
+  op = &g_array_index (recording->ops, DisplayListOp,
+                       recording->ops->len - 1);
+
+  op->modelview = modelview;
+  op->first_coord = recording->coords->len;
+  op->n_rects = n_rects;
+
+  if (material != COGL_INVALID_HANDLE)
+    {
+      /* the actors change the color of their material before each
+       * paint, so the list keeps its own copy */
+      op->material = cogl_material_copy (material);
+      memset (&op->color, 0, sizeof (ClutterColor));
+    }
+  else
+    {
+      op->material = COGL_INVALID_HANDLE;
+      op->color = *color;
+    }
+
+  g_array_append_vals (recording->coords, coords, n_coords);
+}
+
+/*< private >
+ * _clutter_display_list_record_color:
+ * @color: the color passed to cogl_set_source_color4ub()
+ * @coords: the coordinates passed to cogl_rectangles()
+ * @n_rects: the number of rectangles
+ *
+ * Records the rectangles drawn with cogl_rectangles() using a solid
+ * color, if a display list is being recorded.
+ */
+void
+_clutter_display_list_record_color (const ClutterColor *color,
+                                    const gfloat       *coords,
+                                    guint               n_rects)
+{
+  clutter_display_list_add_op (COGL_INVALID_HANDLE, color,
+                               coords, n_rects * 4,
+                               n_rects);
+}
+
+/*< private >
+ * _clutter_display_list_record_material:
+ * @material: the material passed to cogl_set_source()
+ * @coords: the coordinates passed to cogl_rectangles_with_texture_coords()
+ * @n_rects: the number of rectangles
+ *
+ * Records the rectangles drawn with cogl_rectangles_with_texture_coords()
+ * using @material, if a display list is being recorded.
+ */
+void
+_clutter_display_list_record_material (CoglHandle    material,
+                                       const gfloat *coords,
+                                       guint         n_rects)
+{
+  clutter_display_list_add_op (material, NULL,
+                               coords, n_rects * 8,
+                               n_rects);
+}
+
+/*< private >
+ * _clutter_display_list_get_opacity:
+ * @list: a #ClutterDisplayList
+ *
+ * Retrieves the paint opacity of the root of @list when it was
+ * recorded; the colors of the list are only valid for that opacity.
+ *
+ * Return value: the paint opacity
+ */
+guint8
+_clutter_display_list_get_opacity (const ClutterDisplayList *list)
+{
+  return list->opacity;
+}
+
+/*< private >
+ * _clutter_display_list_replay:
+ * @list: a #ClutterDisplayList
+ *
+ * Draws the rectangles recorded in @list, relative to the current
+ * modelview; if a display list is being recorded, the rectangles are
+ * recorded in it as well.
+ */
+void
+_clutter_display_list_replay (const ClutterDisplayList *list)
+{
+  CoglMatrix base, modelview;
+  guint i;
+
+  cogl_get_modelview_matrix (&base);
+
+  for (i = 0; i < list->ops->len; i++)
+    {
+      const DisplayListOp *op;
+      const gfloat *coords;
+
+      op = &g_array_index (list->ops, DisplayListOp, i);
+      coords = &g_array_index (list->coords, gfloat, op->first_coord);
+
+      cogl_matrix_multiply (&modelview, &base, &op->modelview);
+      cogl_set_modelview_matrix (&modelview);
+
+      if (op->material != COGL_INVALID_HANDLE)
+        {
+          cogl_set_source (op->material);
+          cogl_rectangles_with_texture_coords (coords, op->n_rects);
+
+          _clutter_display_list_record_material (op->material,
+                                                 coords,
+                                                 op->n_rects);
+        }
+      else
+        {
+          cogl_set_source_color4ub (op->color.red,
+                                    op->color.green,
+                                    op->color.blue,
+                                    op->color.alpha);
+          cogl_rectangles (coords, op->n_rects);
+
+          _clutter_display_list_record_color (&op->color,
+                                              coords,
+                                              op->n_rects);
+        }
+    }
+
+  cogl_set_modelview_matrix (&base);
+}
+
+/*< private >
+ * _clutter_display_list_free:
+ * @list: a #ClutterDisplayList
+ *
+ * Frees @list and the resources it holds.
+ */
+void
+_clutter_display_list_free (ClutterDisplayList *list)
+{
+  if (list == NULL)
+    return;
+
+  clutter_display_list_clear_ops (list);
+
+  g_array_free (list->ops, TRUE);
+  g_array_free (list->coords, TRUE);
+
+  g_slice_free (ClutterDisplayList, list);
+}
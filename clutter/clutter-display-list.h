@@ -0,0 +1,53 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2011  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CLUTTER_DISPLAY_LIST_H__
+#define __CLUTTER_DISPLAY_LIST_H__
+
+#include <cogl/cogl.h>
+#include <clutter/clutter-color.h>
+
+G_BEGIN_DECLS
+
+typedef struct _ClutterDisplayList ClutterDisplayList;
+
+void                _clutter_display_list_add_recordable_type (GType                     type);
+gboolean            _clutter_display_list_is_recordable_type  (GType                     type);
+
+void                _clutter_display_list_begin_recording     (guint8                    opacity);
+ClutterDisplayList *_clutter_display_list_end_recording       (void);
+gboolean            _clutter_display_list_is_recording        (void);
+void                _clutter_display_list_abort_recording     (void);
+
+void                _clutter_display_list_record_color        (const ClutterColor       *color,
+                                                               const gfloat             *coords,
+                                                               guint                     n_rects);
+void                _clutter_display_list_record_material     (CoglHandle                material,
+                                                               const gfloat             *coords,
+                                                               guint                     n_rects);
+
+guint8              _clutter_display_list_get_opacity         (const ClutterDisplayList *list);
+void                _clutter_display_list_replay              (const ClutterDisplayList *list);
+void                _clutter_display_list_free                (ClutterDisplayList       *list);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_DISPLAY_LIST_H__ */
@@ -66,6 +66,8 @@
 #include "clutter-debug.h"
 #include "clutter-enum-types.h"
 #include "clutter-marshal.h"
+#include "clutter-master-clock.h"
+#include "clutter-motion-predictor.h"
 #include "clutter-private.h"
 #include "clutter-stage-private.h"
 
@@ -91,9 +93,12 @@ struct _ClutterDragActionPrivate
   gfloat transformed_press_x;
   gfloat transformed_press_y;
 
+  ClutterMotionPredictor predictor;
+
   guint emit_delayed_press    : 1;
   guint in_drag               : 1;
   guint motion_events_enabled : 1;
+  guint motion_prediction     : 1;
 };
 
 enum
@@ -104,6 +109,7 @@ enum
   PROP_Y_DRAG_THRESHOLD,
   PROP_DRAG_HANDLE,
   PROP_DRAG_AXIS,
+  PROP_MOTION_PREDICTION,
 
   PROP_LAST
 };
@@ -181,9 +187,28 @@ emit_drag_motion (ClutterDragAction *action,
   ClutterActor *drag_handle = NULL;
   gfloat delta_x, delta_y;
   gfloat motion_x, motion_y;
+  gfloat event_x, event_y;
 
   clutter_event_get_coords (event, &priv->last_motion_x, &priv->last_motion_y);
 
+  event_x = priv->last_motion_x;
+  event_y = priv->last_motion_y;
+
+  /* move the actor to where the pointer is going to be when the frame
+   * is presented, instead of where it was when the event was sent */
+  if (priv->motion_prediction)
+    {
+      ClutterMasterClock *master_clock = _clutter_master_clock_get_default ();
+      gint64 target_time;
+
+      target_time =
+        _clutter_master_clock_get_next_presentation_time (master_clock);
+
+      _clutter_motion_predictor_add_event (&priv->predictor, event);
+      _clutter_motion_predictor_predict (&priv->predictor, target_time,
+                                         &event_x, &event_y);
+    }
+
   if (priv->drag_handle != NULL && !priv->emit_delayed_press)
     drag_handle = priv->drag_handle;
   else
@@ -191,8 +216,7 @@ emit_drag_motion (ClutterDragAction *action,
 
   motion_x = motion_y = 0.0f;
   clutter_actor_transform_stage_point (drag_handle,
-                                       priv->last_motion_x,
-                                       priv->last_motion_y,
+                                       event_x, event_y,
                                        &motion_x, &motion_y);
 
   delta_x = delta_y = 0.0f;
@@ -338,6 +362,10 @@ on_button_press (ClutterActor      *actor,
   priv->last_motion_x = priv->press_x;
   priv->last_motion_y = priv->press_y;
 
+  _clutter_motion_predictor_reset (&priv->predictor);
+  if (priv->motion_prediction)
+    _clutter_motion_predictor_add_event (&priv->predictor, event);
+
   priv->transformed_press_x = priv->press_x;
   priv->transformed_press_y = priv->press_y;
   clutter_actor_transform_stage_point (actor, priv->press_x, priv->press_y,
@@ -438,6 +466,11 @@ clutter_drag_action_set_property (GObject      *gobject,
       clutter_drag_action_set_drag_axis (action, g_value_get_enum (value));
       break;
 
+    case PROP_MOTION_PREDICTION:
+      clutter_drag_action_set_motion_prediction (action,
+                                                 g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
     }
@@ -479,6 +512,10 @@ clutter_drag_action_get_property (GObject    *gobject,
       g_value_set_enum (value, priv->drag_axis);
       break;
 
+    case PROP_MOTION_PREDICTION:
+      g_value_set_boolean (value, priv->motion_prediction);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
     }
@@ -614,6 +651,23 @@ clutter_drag_action_class_init (ClutterDragActionClass *klass)
                        CLUTTER_DRAG_AXIS_NONE,
                        CLUTTER_PARAM_READWRITE);
 
+  /**
+   * ClutterDragAction:motion-prediction:
+   *
+   * Whether the position of the pointer should be extrapolated to the
+   * time at which the next frame is going to be presented, using the
+   * latest motion events, to reduce the distance between the pointer
+   * and the dragged actor
+   *
+   * Since: 1.8
+   */
+  drag_props[PROP_MOTION_PREDICTION] =
+    g_param_spec_boolean ("motion-prediction",
+                          P_("Motion Prediction"),
+                          P_("Whether the motion of the pointer should be predicted"),
+                          FALSE,
+                          CLUTTER_PARAM_READWRITE);
+
   gobject_class->set_property = clutter_drag_action_set_property;
   gobject_class->get_property = clutter_drag_action_get_property;
   gobject_class->dispose = clutter_drag_action_dispose;
@@ -974,3 +1028,58 @@ clutter_drag_action_get_motion_coords (ClutterDragAction *action,
   if (motion_y)
     *motion_y = action->priv->last_motion_y;
 }
+
+/**
+ * clutter_drag_action_set_motion_prediction:
+ * @action: a #ClutterDragAction
+ * @predict: whether the motion of the pointer should be predicted
+ *
+ * Sets whether @action should move the dragged actor to the position
+ * where the pointer is expected to be when the next frame is presented,
+ * instead of the position of the latest motion event.
+ *
+ * The prediction extrapolates the velocity of the pointer, so it works
+ * best with steady motions, like the ones of a finger on a touch screen
+ *
+ * Since: 1.8
+ */
+void
+clutter_drag_action_set_motion_prediction (ClutterDragAction *action,
+                                           gboolean           predict)
+{
+  ClutterDragActionPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_DRAG_ACTION (action));
+
+  priv = action->priv;
+
+  predict = !!predict;
+
+  if (priv->motion_prediction == predict)
+    return;
+
+  priv->motion_prediction = predict;
+
+  _clutter_motion_predictor_reset (&priv->predictor);
+
+  g_object_notify_by_pspec (G_OBJECT (action),
+                            drag_props[PROP_MOTION_PREDICTION]);
+}
+
+/**
+ * clutter_drag_action_get_motion_prediction:
+ * @action: a #ClutterDragAction
+ *
+ * Retrieves the value set by clutter_drag_action_set_motion_prediction()
+ *
+ * Return value: %TRUE if the motion of the pointer is predicted
+ *
+ * Since: 1.8
+ */
+gboolean
+clutter_drag_action_get_motion_prediction (ClutterDragAction *action)
+{
+  g_return_val_if_fail (CLUTTER_IS_DRAG_ACTION (action), FALSE);
+
+  return action->priv->motion_prediction;
+}
@@ -143,6 +143,10 @@ void            clutter_drag_action_get_motion_coords  (ClutterDragAction *actio
                                                         gfloat            *motion_x,
                                                         gfloat            *motion_y);
 
+void            clutter_drag_action_set_motion_prediction (ClutterDragAction *action,
+                                                           gboolean           predict);
+gboolean        clutter_drag_action_get_motion_prediction (ClutterDragAction *action);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_DRAG_ACTION_H__ */
@@ -27,6 +27,8 @@
 #include "config.h"
 #endif
 
+#include <string.h>
+
 #include "clutter-backend-private.h"
 #include "clutter-debug.h"
 #include "clutter-event-private.h"
@@ -49,11 +51,24 @@ typedef struct _ClutterEventPrivate {
   ClutterInputDevice *device;
   ClutterInputDevice *source_device;
 
+  /* the positions of the motion events folded into this one,
+   * oldest first */
+  GArray *motion_history;
+
   gpointer platform_data;
 } ClutterEventPrivate;
 
 static GHashTable *all_events = NULL;
 
+/* the freed events kept around for reuse, so that handling a steady
+ * stream of input events does not allocate; devices like tablets and
+ * touch screens can easily send hundreds of events per frame
+ */
+#define EVENT_POOL_SIZE         64
+
+static ClutterEventPrivate *event_pool[EVENT_POOL_SIZE];
+static guint n_pooled_events = 0;
+
 G_DEFINE_BOXED_TYPE (ClutterEvent, clutter_event,
                      clutter_event_copy,
                      clutter_event_free);
@@ -928,7 +943,13 @@ clutter_event_new (ClutterEventType type)
   ClutterEvent *new_event;
   ClutterEventPrivate *priv;
 
-  priv = g_slice_new0 (ClutterEventPrivate);
+  if (n_pooled_events > 0)
+    {
+      priv = event_pool[--n_pooled_events];
+      memset (priv, 0, sizeof (ClutterEventPrivate));
+    }
+  else
+    priv = g_slice_new0 (ClutterEventPrivate);
 
   new_event = (ClutterEvent *) priv;
   new_event->type = new_event->any.type = type;
@@ -970,6 +991,18 @@ clutter_event_copy (const ClutterEvent *event)
 
       new_real_event->device = real_event->device;
       new_real_event->source_device = real_event->source_device;
+
+      if (real_event->motion_history != NULL)
+        {
+          GArray *history = real_event->motion_history;
+
+          new_real_event->motion_history =
+            g_array_sized_new (FALSE, FALSE, sizeof (ClutterMotionSample),
+                               history->len);
+          g_array_append_vals (new_real_event->motion_history,
+                               history->data,
+                               history->len);
+        }
     }
 
   device = clutter_event_get_device (event);
@@ -1041,8 +1074,20 @@ clutter_event_free (ClutterEvent *event)
           break;
         }
 
+      if (is_event_allocated (event))
+        {
+          ClutterEventPrivate *real_event = (ClutterEventPrivate *) event;
+
+          if (real_event->motion_history != NULL)
+            g_array_free (real_event->motion_history, TRUE);
+        }
+
       g_hash_table_remove (all_events, event);
-      g_slice_free (ClutterEventPrivate, (ClutterEventPrivate *) event);
+
+      if (n_pooled_events < EVENT_POOL_SIZE)
+        event_pool[n_pooled_events++] = (ClutterEventPrivate *) event;
+      else
+        g_slice_free (ClutterEventPrivate, (ClutterEventPrivate *) event);
     }
 }
 
@@ -1213,6 +1258,111 @@ clutter_get_current_event (void)
   return context->current_event;
 }
 
+/**
+ * clutter_event_get_motion_history:
+ * @event: a #ClutterEvent of type %CLUTTER_MOTION
+ * @n_samples: (out): return location for the number of samples
+ *
+ * Retrieves the positions of the pointer preceding @event.
+ *
+ * When the motion events are throttled, see
+ * clutter_stage_set_throttle_motion_events(), the consecutive motion
+ * events from the same device received during a frame are compressed
+ * into the last one, and only that event is delivered. The positions
+ * of the compressed events are kept in the motion history of the
+ * delivered event, so that applications drawing the path of the
+ * pointer, or recognising gestures, can use all the samples.
+ *
+ * The position of @event itself is not part of its history.
+ *
+ * Return value: (array length=n_samples) (transfer none): the samples,
+ *   oldest first, or %NULL if @event does not have a motion history.
+ *   The returned array is owned by @event
+ *
+ * Since: 1.8
+ */
+const ClutterMotionSample *
+clutter_event_get_motion_history (const ClutterEvent *event,
+                                  guint              *n_samples)
+{
+  ClutterEventPrivate *real_event;
+
+  g_return_val_if_fail (event != NULL, NULL);
+  g_return_val_if_fail (n_samples != NULL, NULL);
+
+  *n_samples = 0;
+
+  if (event->type != CLUTTER_MOTION || !is_event_allocated (event))
+    return NULL;
+
+  real_event = (ClutterEventPrivate *) event;
+  if (real_event->motion_history == NULL)
+    return NULL;
+
+  *n_samples = real_event->motion_history->len;
+
+  return (const ClutterMotionSample *) real_event->motion_history->data;
+}
+
+/*< private >
+ * _clutter_event_fold_motion:
+ * @event: a motion #ClutterEvent
+ * @older: a motion #ClutterEvent preceding @event
+ *
+ * Adds the motion history of @older, followed by the position of
+ * @older itself, at the beginning of the motion history of @event.
+ *
+ * This is used when compressing consecutive motion events, before
+ * discarding @older.
+ */
+void
+_clutter_event_fold_motion (ClutterEvent       *event,
+                            const ClutterEvent *older)
+{
+  ClutterEventPrivate *real_event, *real_older;
+  ClutterMotionSample sample;
+
+  g_return_if_fail (event->type == CLUTTER_MOTION);
+  g_return_if_fail (older->type == CLUTTER_MOTION);
+
+  if (!is_event_allocated (event))
+    return;
+
+  real_event = (ClutterEventPrivate *) event;
+  real_older = is_event_allocated (older)
+             ? (ClutterEventPrivate *) older
+             : NULL;
+
+  sample.time = older->motion.time;
+  sample.x = older->motion.x;
+  sample.y = older->motion.y;
+
+  /* the common case is a run of compressed events, where the history
+   * of the older event can simply be moved to the newer one */
+  if (real_event->motion_history == NULL &&
+      real_older != NULL &&
+      real_older->motion_history != NULL)
+    {
+      real_event->motion_history = real_older->motion_history;
+      real_older->motion_history = NULL;
+
+      g_array_append_val (real_event->motion_history, sample);
+
+      return;
+    }
+
+  if (real_event->motion_history == NULL)
+    real_event->motion_history =
+      g_array_new (FALSE, FALSE, sizeof (ClutterMotionSample));
+
+  g_array_prepend_val (real_event->motion_history, sample);
+
+  if (real_older != NULL && real_older->motion_history != NULL)
+    g_array_prepend_vals (real_event->motion_history,
+                          real_older->motion_history->data,
+                          real_older->motion_history->len);
+}
+
 /**
  * clutter_event_get_source_device:
  * @event: a #ClutterEvent
@@ -146,6 +146,8 @@ typedef struct _ClutterScrollEvent      ClutterScrollEvent;
 typedef struct _ClutterStageStateEvent  ClutterStageStateEvent;
 typedef struct _ClutterCrossingEvent    ClutterCrossingEvent;
 
+typedef struct _ClutterMotionSample     ClutterMotionSample;
+
 /**
  * ClutterAnyEvent:
  * @type: event type
@@ -301,6 +303,25 @@ struct _ClutterMotionEvent
   ClutterInputDevice *device;
 };
 
+/**
+ * ClutterMotionSample:
+ * @time: the time of the motion
+ * @x: the X coordinate of the pointer
+ * @y: the Y coordinate of the pointer
+ *
+ * A position of the pointer, part of the motion history of a
+ * #ClutterMotionEvent
+ *
+ * Since: 1.8
+ */
+struct _ClutterMotionSample
+{
+  guint32 time;
+
+  gfloat x;
+  gfloat y;
+};
+
 /**
  * ClutterScrollEvent:
  * @type: event type
@@ -428,6 +449,10 @@ void                    clutter_event_get_coords                (const ClutterEv
 gdouble *               clutter_event_get_axes                  (const ClutterEvent     *event,
                                                                  guint                  *n_axes);
 
+const ClutterMotionSample *
+                        clutter_event_get_motion_history        (const ClutterEvent     *event,
+                                                                 guint                  *n_samples);
+
 void                    clutter_event_set_key_symbol            (ClutterEvent           *event,
                                                                  guint                   key_sym);
 guint                   clutter_event_get_key_symbol            (const ClutterEvent     *event);
@@ -452,6 +477,7 @@ void                    clutter_event_set_scroll_direction      (ClutterEvent
 ClutterScrollDirection  clutter_event_get_scroll_direction      (const ClutterEvent     *event);
 
 guint32                 clutter_keysym_to_unicode               (guint                   keyval);
+guint                   clutter_unicode_to_keysym               (guint32                 wc);
 
 guint32                 clutter_get_current_event_time          (void);
 
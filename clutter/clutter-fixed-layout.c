@@ -53,18 +53,17 @@ clutter_fixed_layout_get_preferred_width (ClutterLayoutManager *manager,
                                           gfloat               *min_width_p,
                                           gfloat               *nat_width_p)
 {
-  GList *children, *l;
+  ClutterContainerIter iter;
+  ClutterActor *child;
   gdouble min_right;
   gdouble natural_right;
 
   min_right = 0;
   natural_right = 0;
 
-  children = clutter_container_get_children (container);
-
-  for (l = children; l != NULL; l = l->next)
+  clutter_container_iter_init (&iter, container);
+  while (clutter_container_iter_next (&iter, &child))
     {
-      ClutterActor *child = l->data;
       gfloat child_x, child_min, child_natural;
 
       child_x = clutter_actor_get_x (child);
@@ -80,8 +79,6 @@ clutter_fixed_layout_get_preferred_width (ClutterLayoutManager *manager,
         natural_right = child_x + child_natural;
     }
 
-  g_list_free (children);
-
   if (min_width_p)
     *min_width_p = min_right;
 
@@ -96,18 +93,17 @@ clutter_fixed_layout_get_preferred_height (ClutterLayoutManager *manager,
                                            gfloat               *min_height_p,
                                            gfloat               *nat_height_p)
 {
-  GList *children, *l;
+  ClutterContainerIter iter;
+  ClutterActor *child;
   gdouble min_bottom;
   gdouble natural_bottom;
 
   min_bottom = 0;
   natural_bottom = 0;
 
-  children = clutter_container_get_children (container);
-
-  for (l = children; l != NULL; l = l->next)
+  clutter_container_iter_init (&iter, container);
+  while (clutter_container_iter_next (&iter, &child))
     {
-      ClutterActor *child = l->data;
       gfloat child_y, child_min, child_natural;
 
       child_y = clutter_actor_get_y (child);
@@ -123,8 +119,6 @@ clutter_fixed_layout_get_preferred_height (ClutterLayoutManager *manager,
         natural_bottom = child_y + child_natural;
     }
 
-  g_list_free (children);
-
   if (min_height_p)
     *min_height_p = min_bottom;
 
@@ -138,18 +132,12 @@ clutter_fixed_layout_allocate (ClutterLayoutManager   *manager,
                                const ClutterActorBox  *allocation,
                                ClutterAllocationFlags  flags)
 {
-  GList *children, *l;
-
-  children = clutter_container_get_children (container);
-
-  for (l = children; l != NULL; l = l->next)
-    {
-      ClutterActor *child = l->data;
-
-      clutter_actor_allocate_preferred_size (child, flags);
-    }
+  ClutterContainerIter iter;
+  ClutterActor *child;
 
-  g_list_free (children);
+  clutter_container_iter_init (&iter, container);
+  while (clutter_container_iter_next (&iter, &child))
+    clutter_actor_allocate_preferred_size (child, flags);
 }
 
 void
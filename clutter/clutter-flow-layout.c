@@ -74,6 +74,7 @@
 #include <math.h>
 
 #include "clutter-actor.h"
+#include "clutter-actor-private.h"
 #include "clutter-animatable.h"
 #include "clutter-child-meta.h"
 #include "clutter-debug.h"
@@ -84,6 +85,30 @@
 
 #define CLUTTER_FLOW_LAYOUT_GET_PRIVATE(obj)    (G_TYPE_INSTANCE_GET_PRIVATE ((obj), CLUTTER_TYPE_FLOW_LAYOUT, ClutterFlowLayoutPrivate))
 
+/* the preferred size of a visible child */
+typedef struct _FlowItem
+{
+  ClutterActor *actor;
+
+  gfloat min_size;
+  gfloat natural_size;
+} FlowItem;
+
+/* the preferred sizes of the visible children, in the direction of
+ * a request, and the parameters they were requested with
+ */
+typedef struct _FlowItems
+{
+  GArray *sizes;
+
+  gfloat for_size;
+  gint n_per_line;
+  gfloat spacing;
+
+  /* the number of leading items that are still valid */
+  guint n_valid;
+} FlowItems;
+
 struct _ClutterFlowLayoutPrivate
 {
   ClutterContainer *container;
@@ -109,7 +134,12 @@ struct _ClutterFlowLayoutPrivate
 
   guint line_count;
 
+  /* cached preferred sizes of the children */
+  FlowItems widths;
+  FlowItems heights;
+
   guint is_homogeneous : 1;
+  guint is_virtualized : 1;
 };
 
 enum
@@ -128,6 +158,8 @@ enum
   PROP_MIN_ROW_HEGHT,
   PROP_MAX_ROW_HEIGHT,
 
+  PROP_VIRTUALIZED,
+
   N_PROPERTIES
 };
 
@@ -194,6 +226,167 @@ compute_lines (ClutterFlowLayout *self,
     return get_rows (self, avail_height);
 }
 
+/* the preferred sizes of the children are cached, so we only measure
+ * again the children that changed, and the ones following them; the
+ * children queue a relayout on themselves when their preferred size
+ * changes
+ */
+static void
+flow_layout_invalidate_from (ClutterFlowLayout *self,
+                             guint              index_)
+{
+  ClutterFlowLayoutPrivate *priv = self->priv;
+
+  priv->widths.n_valid = MIN (priv->widths.n_valid, index_);
+  priv->heights.n_valid = MIN (priv->heights.n_valid, index_);
+}
+
+static void
+flow_layout_invalidate (ClutterFlowLayout *self)
+{
+  flow_layout_invalidate_from (self, 0);
+}
+
+/* the index of @child among the items, that is the visible children */
+static guint
+flow_layout_get_item_index (ClutterFlowLayout *self,
+                            ClutterActor      *child)
+{
+  ClutterContainerIter iter;
+  ClutterActor *iter_child;
+  guint index_ = 0;
+
+  clutter_container_iter_init (&iter, self->priv->container);
+  while (clutter_container_iter_next (&iter, &iter_child))
+    {
+      if (iter_child == child)
+        break;
+
+      if (CLUTTER_ACTOR_IS_VISIBLE (iter_child))
+        index_ += 1;
+    }
+
+  return index_;
+}
+
+static void
+flow_layout_child_changed (ClutterActor      *child,
+                           ClutterFlowLayout *self)
+{
+  flow_layout_invalidate_from (self, flow_layout_get_item_index (self, child));
+}
+
+static void
+flow_layout_actor_added (ClutterContainer  *container,
+                         ClutterActor      *child,
+                         ClutterFlowLayout *self)
+{
+  g_signal_connect (child, "queue-relayout",
+                    G_CALLBACK (flow_layout_child_changed),
+                    self);
+
+  flow_layout_invalidate_from (self, flow_layout_get_item_index (self, child));
+}
+
+static void
+flow_layout_actor_removed (ClutterContainer  *container,
+                           ClutterActor      *child,
+                           ClutterFlowLayout *self)
+{
+  g_signal_handlers_disconnect_by_func (child,
+                                        flow_layout_child_changed,
+                                        self);
+}
+
+/*
+ * flow_layout_measure_items:
+ * @self: a #ClutterFlowLayout
+ * @items: the cached sizes to update
+ * @measure_width: whether to request the width or the height of the items
+ * @for_size: the size to request the items for
+ * @n_per_line: the number of items in each line when @for_size is divided
+ *   between them, or 0 if every item is requested for @for_size
+ * @spacing: the spacing between the items of a line
+ *
+ * Updates the preferred sizes of the visible children of the container
+ * of @self. Only the children following the first one that changed
+ * since the last update are measured; the items are also measured
+ * again if the children were reordered, shown or hidden.
+ */
+static void
+flow_layout_measure_items (ClutterFlowLayout *self,
+                           FlowItems         *items,
+                           gboolean           measure_width,
+                           gfloat             for_size,
+                           gint               n_per_line,
+                           gfloat             spacing)
+{
+  ClutterContainerIter iter;
+  ClutterActor *child;
+  guint n_items = 0;
+
+  if (items->for_size != for_size ||
+      items->n_per_line != n_per_line ||
+      items->spacing != spacing)
+    {
+      items->for_size = for_size;
+      items->n_per_line = n_per_line;
+      items->spacing = spacing;
+      items->n_valid = 0;
+    }
+
+  clutter_container_iter_init (&iter, self->priv->container);
+  while (clutter_container_iter_next (&iter, &child))
+    {
+      FlowItem *item;
+      gfloat item_for_size;
+
+      if (!CLUTTER_ACTOR_IS_VISIBLE (child))
+        continue;
+
+      n_items += 1;
+
+      if (n_items <= items->n_valid)
+        {
+          item = &g_array_index (items->sizes, FlowItem, n_items - 1);
+          if (item->actor == child)
+            continue;
+
+          /* the children were reordered, or one was shown or hidden */
+          items->n_valid = n_items - 1;
+        }
+
+      if (n_items > items->sizes->len)
+        g_array_set_size (items->sizes, n_items);
+
+      item = &g_array_index (items->sizes, FlowItem, n_items - 1);
+      item->actor = child;
+
+      item_for_size = for_size;
+      if (n_per_line > 0)
+        {
+          gint line_item = (n_items - 1) % n_per_line;
+          gfloat item_start, item_end;
+
+          item_start = (line_item * (for_size + spacing)) / n_per_line;
+          item_end = ((line_item + 1) * (for_size + spacing)) / n_per_line;
+          item_for_size = item_end - item_start - spacing;
+        }
+
+      if (measure_width)
+        clutter_actor_get_preferred_width (child, item_for_size,
+                                           &item->min_size,
+                                           &item->natural_size);
+      else
+        clutter_actor_get_preferred_height (child, item_for_size,
+                                            &item->min_size,
+                                            &item->natural_size);
+    }
+
+  g_array_set_size (items->sizes, n_items);
+  items->n_valid = n_items;
+}
+
 static void
 clutter_flow_layout_get_preferred_width (ClutterLayoutManager *manager,
                                          ClutterContainer     *container,
@@ -201,15 +394,17 @@ clutter_flow_layout_get_preferred_width (ClutterLayoutManager *manager,
                                          gfloat               *min_width_p,
                                          gfloat               *nat_width_p)
 {
-  ClutterFlowLayoutPrivate *priv = CLUTTER_FLOW_LAYOUT (manager)->priv;
-  GList *l, *children = clutter_container_get_children (container);
+  ClutterFlowLayout *self = CLUTTER_FLOW_LAYOUT (manager);
+  ClutterFlowLayoutPrivate *priv = self->priv;
+  ClutterContainerIter iter;
   gint n_rows, line_item_count, line_count;
   gfloat total_min_width, total_natural_width;
   gfloat line_min_width, line_natural_width;
   gfloat max_min_width, max_natural_width;
-  gfloat item_y;
+  gboolean is_flowing;
+  guint i;
 
-  n_rows = get_rows (CLUTTER_FLOW_LAYOUT (manager), for_height);
+  n_rows = get_rows (self, for_height);
 
   total_min_width = 0;
   total_natural_width = 0;
@@ -220,37 +415,28 @@ clutter_flow_layout_get_preferred_width (ClutterLayoutManager *manager,
   line_item_count = 0;
   line_count = 0;
 
-  item_y = 0;
-
   /* clear the line width arrays */
-  if (priv->line_min != NULL)
-    g_array_free (priv->line_min, TRUE);
-
-  if (priv->line_natural != NULL)
-    g_array_free (priv->line_natural, TRUE);
-
-  priv->line_min = g_array_sized_new (FALSE, FALSE,
-                                      sizeof (gfloat),
-                                      16);
-  priv->line_natural = g_array_sized_new (FALSE, FALSE,
-                                          sizeof (gfloat),
-                                          16);
+  g_array_set_size (priv->line_min, 0);
+  g_array_set_size (priv->line_natural, 0);
 
-  if (children)
+  clutter_container_iter_init (&iter, container);
+  if (clutter_container_iter_next (&iter, NULL))
     line_count = 1;
 
   max_min_width = max_natural_width = 0;
 
-  for (l = children; l != NULL; l = l->next)
-    {
-      ClutterActor *child = l->data;
-      gfloat child_min, child_natural;
-      gfloat new_y, item_height;
+  is_flowing = priv->orientation == CLUTTER_FLOW_VERTICAL && for_height > 0;
 
-      if (!CLUTTER_ACTOR_IS_VISIBLE (child))
-        continue;
+  flow_layout_measure_items (self, &priv->widths, TRUE,
+                             for_height,
+                             is_flowing ? n_rows : 0,
+                             is_flowing ? priv->row_spacing : 0);
+
+  for (i = 0; i < priv->widths.sizes->len; i++)
+    {
+      const FlowItem *item = &g_array_index (priv->widths.sizes, FlowItem, i);
 
-      if (priv->orientation == CLUTTER_FLOW_VERTICAL && for_height > 0)
+      if (is_flowing)
         {
           if (line_item_count == n_rows)
             {
@@ -266,21 +452,11 @@ clutter_flow_layout_get_preferred_width (ClutterLayoutManager *manager,
 
               line_item_count = 0;
               line_count += 1;
-              item_y = 0;
             }
 
-          new_y = ((line_item_count + 1) * (for_height + priv->row_spacing))
-                / n_rows;
-          item_height = new_y - item_y - priv->row_spacing;
-
-          clutter_actor_get_preferred_width (child, item_height,
-                                             &child_min,
-                                             &child_natural);
-
-          line_min_width = MAX (line_min_width, child_min);
-          line_natural_width = MAX (line_natural_width, child_natural);
+          line_min_width = MAX (line_min_width, item->min_size);
+          line_natural_width = MAX (line_natural_width, item->natural_size);
 
-          item_y = new_y;
           line_item_count += 1;
 
           max_min_width = MAX (max_min_width, line_min_width);
@@ -288,12 +464,8 @@ clutter_flow_layout_get_preferred_width (ClutterLayoutManager *manager,
         }
       else
         {
-          clutter_actor_get_preferred_width (child, for_height,
-                                             &child_min,
-                                             &child_natural);
-
-          max_min_width = MAX (max_min_width, child_min);
-          max_natural_width = MAX (max_natural_width, child_natural);
+          max_min_width = MAX (max_min_width, item->min_size);
+          max_natural_width = MAX (max_natural_width, item->natural_size);
 
           total_min_width += max_min_width;
           total_natural_width += max_natural_width;
@@ -301,8 +473,6 @@ clutter_flow_layout_get_preferred_width (ClutterLayoutManager *manager,
         }
     }
 
-  g_list_free (children);
-
   priv->col_width = max_natural_width;
 
   if (priv->max_col_width > 0 && priv->col_width > priv->max_col_width)
@@ -378,15 +548,17 @@ clutter_flow_layout_get_preferred_height (ClutterLayoutManager *manager,
                                           gfloat               *min_height_p,
                                           gfloat               *nat_height_p)
 {
-  ClutterFlowLayoutPrivate *priv = CLUTTER_FLOW_LAYOUT (manager)->priv;
-  GList *l, *children = clutter_container_get_children (container);
+  ClutterFlowLayout *self = CLUTTER_FLOW_LAYOUT (manager);
+  ClutterFlowLayoutPrivate *priv = self->priv;
+  ClutterContainerIter iter;
   gint n_columns, line_item_count, line_count;
   gfloat total_min_height, total_natural_height;
   gfloat line_min_height, line_natural_height;
   gfloat max_min_height, max_natural_height;
-  gfloat item_x;
+  gboolean is_flowing;
+  guint i;
 
-  n_columns = get_columns (CLUTTER_FLOW_LAYOUT (manager), for_width);
+  n_columns = get_columns (self, for_width);
 
   total_min_height = 0;
   total_natural_height = 0;
@@ -397,37 +569,28 @@ clutter_flow_layout_get_preferred_height (ClutterLayoutManager *manager,
   line_item_count = 0;
   line_count = 0;
 
-  item_x = 0;
-
   /* clear the line height arrays */
-  if (priv->line_min != NULL)
-    g_array_free (priv->line_min, TRUE);
-
-  if (priv->line_natural != NULL)
-    g_array_free (priv->line_natural, TRUE);
+  g_array_set_size (priv->line_min, 0);
+  g_array_set_size (priv->line_natural, 0);
 
-  priv->line_min = g_array_sized_new (FALSE, FALSE,
-                                      sizeof (gfloat),
-                                      16);
-  priv->line_natural = g_array_sized_new (FALSE, FALSE,
-                                          sizeof (gfloat),
-                                          16);
-
-  if (children)
+  clutter_container_iter_init (&iter, container);
+  if (clutter_container_iter_next (&iter, NULL))
     line_count = 1;
 
   max_min_height = max_natural_height = 0;
 
-  for (l = children; l != NULL; l = l->next)
-    {
-      ClutterActor *child = l->data;
-      gfloat child_min, child_natural;
-      gfloat new_x, item_width;
+  is_flowing = priv->orientation == CLUTTER_FLOW_HORIZONTAL && for_width > 0;
 
-      if (!CLUTTER_ACTOR_IS_VISIBLE (child))
-        continue;
+  flow_layout_measure_items (self, &priv->heights, FALSE,
+                             for_width,
+                             is_flowing ? n_columns : 0,
+                             is_flowing ? priv->col_spacing : 0);
 
-      if (priv->orientation == CLUTTER_FLOW_HORIZONTAL && for_width > 0)
+  for (i = 0; i < priv->heights.sizes->len; i++)
+    {
+      const FlowItem *item = &g_array_index (priv->heights.sizes, FlowItem, i);
+
+      if (is_flowing)
         {
           if (line_item_count == n_columns)
             {
@@ -443,21 +606,11 @@ clutter_flow_layout_get_preferred_height (ClutterLayoutManager *manager,
 
               line_item_count = 0;
               line_count += 1;
-              item_x = 0;
             }
 
-          new_x = ((line_item_count + 1) * (for_width + priv->col_spacing))
-                / n_columns;
-          item_width = new_x - item_x - priv->col_spacing;
-
-          clutter_actor_get_preferred_height (child, item_width,
-                                              &child_min,
-                                              &child_natural);
-
-          line_min_height = MAX (line_min_height, child_min);
-          line_natural_height = MAX (line_natural_height, child_natural);
+          line_min_height = MAX (line_min_height, item->min_size);
+          line_natural_height = MAX (line_natural_height, item->natural_size);
 
-          item_x = new_x;
           line_item_count += 1;
 
           max_min_height = MAX (max_min_height, line_min_height);
@@ -465,22 +618,15 @@ clutter_flow_layout_get_preferred_height (ClutterLayoutManager *manager,
         }
       else
         {
-          clutter_actor_get_preferred_height (child, for_width,
-                                              &child_min,
-                                              &child_natural);
-
-          max_min_height = MAX (max_min_height, child_min);
-          max_natural_height = MAX (max_natural_height, child_natural);
+          max_min_height = MAX (max_min_height, item->min_size);
+          max_natural_height = MAX (max_natural_height, item->natural_size);
 
           total_min_height += max_min_height;
           total_natural_height += max_natural_height;
-
           line_count += 1;
         }
     }
 
-  g_list_free (children);
-
   priv->row_height = max_natural_height;
 
   if (priv->max_row_height > 0 && priv->row_height > priv->max_row_height)
@@ -548,6 +694,14 @@ clutter_flow_layout_get_preferred_height (ClutterLayoutManager *manager,
     *nat_height_p = total_natural_height;
 }
 
+static inline gboolean
+box_intersects (const ClutterActorBox *a,
+                const ClutterActorBox *b)
+{
+  return a->x1 < b->x2 && a->x2 > b->x1 &&
+         a->y1 < b->y2 && a->y2 > b->y1;
+}
+
 static void
 clutter_flow_layout_allocate (ClutterLayoutManager   *manager,
                               ClutterContainer       *container,
@@ -555,14 +709,17 @@ clutter_flow_layout_allocate (ClutterLayoutManager   *manager,
                               ClutterAllocationFlags  flags)
 {
   ClutterFlowLayoutPrivate *priv = CLUTTER_FLOW_LAYOUT (manager)->priv;
-  GList *l, *children = clutter_container_get_children (container);
+  ClutterContainerIter iter;
+  ClutterActor *child;
+  ClutterActorBox visible_box, *visible;
   gfloat avail_width, avail_height;
   gfloat item_x, item_y;
   gint line_item_count;
   gint items_per_line;
   gint line_index;
 
-  if (children == NULL)
+  clutter_container_iter_init (&iter, container);
+  if (!clutter_container_iter_next (&iter, NULL))
     return;
 
   clutter_actor_box_get_size (allocation, &avail_width, &avail_height);
@@ -585,14 +742,25 @@ clutter_flow_layout_allocate (ClutterLayoutManager   *manager,
   items_per_line = compute_lines (CLUTTER_FLOW_LAYOUT (manager),
                                   avail_width, avail_height);
 
+  visible = NULL;
+  if (priv->is_virtualized &&
+      _clutter_actor_get_visible_box (CLUTTER_ACTOR (container), &visible_box))
+    {
+      CLUTTER_NOTE (LAYOUT, "Visible box: { %.2f, %.2f, %.2f, %.2f }",
+                    visible_box.x1, visible_box.y1,
+                    visible_box.x2, visible_box.y2);
+
+      visible = &visible_box;
+    }
+
   item_x = item_y = 0;
 
   line_item_count = 0;
   line_index = 0;
 
-  for (l = children; l != NULL; l = l->next)
+  clutter_container_iter_init (&iter, container);
+  while (clutter_container_iter_next (&iter, &child))
     {
-      ClutterActor *child = l->data;
       ClutterActorBox child_alloc;
       gfloat item_width, item_height;
       gfloat new_x, new_y;
@@ -625,21 +793,6 @@ clutter_flow_layout_allocate (ClutterLayoutManager   *manager,
           item_height = g_array_index (priv->line_natural,
                                        gfloat,
                                        line_index);
-
-          if (!priv->is_homogeneous)
-            {
-              gfloat child_min, child_natural;
-
-              clutter_actor_get_preferred_width (child, item_height,
-                                                 &child_min,
-                                                 &child_natural);
-              item_width = MIN (item_width, child_natural);
-
-              clutter_actor_get_preferred_height (child, item_width,
-                                                  &child_min,
-                                                  &child_natural);
-              item_height = MIN (item_height, child_natural);
-            }
         }
       else
         {
@@ -664,23 +817,44 @@ clutter_flow_layout_allocate (ClutterLayoutManager   *manager,
           item_width = g_array_index (priv->line_natural,
                                       gfloat,
                                       line_index);
+        }
 
-          if (!priv->is_homogeneous)
-            {
-              gfloat child_min, child_natural;
+      /* the cell of each child only depends on the size of the lines,
+       * so children outside of the visible area can be skipped without
+       * being measured, as long as their current allocation is outside
+       * of the visible area as well */
+      if (visible != NULL)
+        {
+          ClutterActorBox cell, last_alloc;
 
-              clutter_actor_get_preferred_width (child, item_height,
-                                                 &child_min,
-                                                 &child_natural);
-              item_width = MIN (item_width, child_natural);
+          cell.x1 = ceil (item_x);
+          cell.y1 = ceil (item_y);
+          cell.x2 = ceil (cell.x1 + item_width);
+          cell.y2 = ceil (cell.y1 + item_height);
 
-              clutter_actor_get_preferred_height (child, item_width,
-                                                  &child_min,
-                                                  &child_natural);
-              item_height = MIN (item_height, child_natural);
+          if (!box_intersects (&cell, visible))
+            {
+              clutter_actor_get_allocation_box (child, &last_alloc);
+              if (!box_intersects (&last_alloc, visible))
+                goto next;
             }
         }
 
+      if (!priv->is_homogeneous)
+        {
+          gfloat child_min, child_natural;
+
+          clutter_actor_get_preferred_width (child, item_height,
+                                             &child_min,
+                                             &child_natural);
+          item_width = MIN (item_width, child_natural);
+
+          clutter_actor_get_preferred_height (child, item_width,
+                                              &child_min,
+                                              &child_natural);
+          item_height = MIN (item_height, child_natural);
+        }
+
       CLUTTER_NOTE (LAYOUT,
                     "flow[line:%d, item:%d/%d] ="
                     "{ %.2f, %.2f, %.2f, %.2f }",
@@ -693,6 +867,7 @@ clutter_flow_layout_allocate (ClutterLayoutManager   *manager,
       child_alloc.y2 = ceil (child_alloc.y1 + item_height);
       clutter_actor_allocate (child, &child_alloc, flags);
 
+    next:
       if (priv->orientation == CLUTTER_FLOW_HORIZONTAL)
         item_x = new_x;
       else
@@ -700,22 +875,55 @@ clutter_flow_layout_allocate (ClutterLayoutManager   *manager,
 
       line_item_count += 1;
     }
-
-  g_list_free (children);
 }
 
 static void
 clutter_flow_layout_set_container (ClutterLayoutManager *manager,
                                    ClutterContainer     *container)
 {
-  ClutterFlowLayoutPrivate *priv = CLUTTER_FLOW_LAYOUT (manager)->priv;
+  ClutterFlowLayout *self = CLUTTER_FLOW_LAYOUT (manager);
+  ClutterFlowLayoutPrivate *priv = self->priv;
   ClutterLayoutManagerClass *parent_class;
 
+  if (priv->container != NULL)
+    {
+      ClutterContainerIter iter;
+      ClutterActor *child;
+
+      clutter_container_iter_init (&iter, priv->container);
+      while (clutter_container_iter_next (&iter, &child))
+        flow_layout_actor_removed (priv->container, child, self);
+
+      g_signal_handlers_disconnect_by_func (priv->container,
+                                            flow_layout_actor_added,
+                                            self);
+      g_signal_handlers_disconnect_by_func (priv->container,
+                                            flow_layout_actor_removed,
+                                            self);
+    }
+
   priv->container = container;
 
+  flow_layout_invalidate (self);
+
   if (priv->container != NULL)
     {
       ClutterRequestMode request_mode;
+      ClutterContainerIter iter;
+      ClutterActor *child;
+
+      clutter_container_iter_init (&iter, priv->container);
+      while (clutter_container_iter_next (&iter, &child))
+        g_signal_connect (child, "queue-relayout",
+                          G_CALLBACK (flow_layout_child_changed),
+                          self);
+
+      g_signal_connect (priv->container, "actor-added",
+                        G_CALLBACK (flow_layout_actor_added),
+                        self);
+      g_signal_connect (priv->container, "actor-removed",
+                        G_CALLBACK (flow_layout_actor_removed),
+                        self);
 
       /* we need to change the :request-mode of the container
        * to match the orientation
@@ -781,6 +989,10 @@ clutter_flow_layout_set_property (GObject      *gobject,
                                           g_value_get_float (value));
       break;
 
+    case PROP_VIRTUALIZED:
+      clutter_flow_layout_set_virtualized (self, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -829,6 +1041,10 @@ clutter_flow_layout_get_property (GObject    *gobject,
       g_value_set_float (value, priv->max_row_height);
       break;
 
+    case PROP_VIRTUALIZED:
+      g_value_set_boolean (value, priv->is_virtualized);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -846,6 +1062,9 @@ clutter_flow_layout_finalize (GObject *gobject)
   if (priv->line_natural != NULL)
     g_array_free (priv->line_natural, TRUE);
 
+  g_array_free (priv->widths.sizes, TRUE);
+  g_array_free (priv->heights.sizes, TRUE);
+
   G_OBJECT_CLASS (clutter_flow_layout_parent_class)->finalize (gobject);
 }
 
@@ -996,6 +1215,26 @@ clutter_flow_layout_class_init (ClutterFlowLayoutClass *klass)
                         -1.0,
                         CLUTTER_PARAM_READWRITE);
 
+  /**
+   * ClutterFlowLayout:virtualized:
+   *
+   * Whether the #ClutterFlowLayout should allocate only the children
+   * whose cell intersects the visible area of the container, as
+   * defined by the clip of the container and the clips of its parents
+   *
+   * The visible area is computed when the container is allocated, so
+   * scrolling should be implemented by changing the allocation of the
+   * container
+   *
+   * Since: 1.8
+   */
+  flow_properties[PROP_VIRTUALIZED] =
+    g_param_spec_boolean ("virtualized",
+                          P_("Virtualized"),
+                          P_("Whether only the visible children should be allocated"),
+                          FALSE,
+                          CLUTTER_PARAM_READWRITE);
+
   gobject_class->finalize = clutter_flow_layout_finalize;
   gobject_class->set_property = clutter_flow_layout_set_property;
   gobject_class->get_property = clutter_flow_layout_get_property;
@@ -1019,8 +1258,11 @@ clutter_flow_layout_init (ClutterFlowLayout *self)
   priv->min_col_width = priv->min_row_height = 0;
   priv->max_col_width = priv->max_row_height = -1;
 
-  priv->line_min = NULL;
-  priv->line_natural = NULL;
+  priv->line_min = g_array_sized_new (FALSE, FALSE, sizeof (gfloat), 16);
+  priv->line_natural = g_array_sized_new (FALSE, FALSE, sizeof (gfloat), 16);
+
+  priv->widths.sizes = g_array_new (FALSE, FALSE, sizeof (FlowItem));
+  priv->heights.sizes = g_array_new (FALSE, FALSE, sizeof (FlowItem));
 }
 
 /**
@@ -1163,6 +1405,62 @@ clutter_flow_layout_get_homogeneous (ClutterFlowLayout *layout)
   return layout->priv->is_homogeneous;
 }
 
+/**
+ * clutter_flow_layout_set_virtualized:
+ * @layout: a #ClutterFlowLayout
+ * @virtualized: %TRUE if only the visible children should be allocated
+ *
+ * Sets whether the @layout should allocate only the children whose
+ * cell intersects the visible area of the container.
+ *
+ * The children outside of the visible area are not measured either,
+ * which makes scrolling through large flows independent of the
+ * number of children.
+ *
+ * Since: 1.8
+ */
+void
+clutter_flow_layout_set_virtualized (ClutterFlowLayout *layout,
+                                     gboolean           virtualized)
+{
+  ClutterFlowLayoutPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_FLOW_LAYOUT (layout));
+
+  priv = layout->priv;
+
+  if (priv->is_virtualized != virtualized)
+    {
+      ClutterLayoutManager *manager;
+
+      priv->is_virtualized = !!virtualized;
+
+      manager = CLUTTER_LAYOUT_MANAGER (layout);
+      clutter_layout_manager_layout_changed (manager);
+
+      g_object_notify_by_pspec (G_OBJECT (layout),
+                                flow_properties[PROP_VIRTUALIZED]);
+    }
+}
+
+/**
+ * clutter_flow_layout_get_virtualized:
+ * @layout: a #ClutterFlowLayout
+ *
+ * Retrieves whether the @layout allocates only the visible children
+ *
+ * Return value: %TRUE if the #ClutterFlowLayout is virtualized
+ *
+ * Since: 1.8
+ */
+gboolean
+clutter_flow_layout_get_virtualized (ClutterFlowLayout *layout)
+{
+  g_return_val_if_fail (CLUTTER_IS_FLOW_LAYOUT (layout), FALSE);
+
+  return layout->priv->is_virtualized;
+}
+
 /**
  * clutter_flow_layout_set_column_spacing:
  * @layout: a #ClutterFlowLayout
@@ -101,6 +101,9 @@ ClutterFlowOrientation clutter_flow_layout_get_orientation    (ClutterFlowLayout
 void                   clutter_flow_layout_set_homogeneous    (ClutterFlowLayout      *layout,
                                                                gboolean                homogeneous);
 gboolean               clutter_flow_layout_get_homogeneous    (ClutterFlowLayout      *layout);
+void                   clutter_flow_layout_set_virtualized    (ClutterFlowLayout      *layout,
+                                                               gboolean                virtualized);
+gboolean               clutter_flow_layout_get_virtualized    (ClutterFlowLayout      *layout);
 
 void                   clutter_flow_layout_set_column_spacing (ClutterFlowLayout      *layout,
                                                                gfloat                  spacing);
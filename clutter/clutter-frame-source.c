@@ -28,6 +28,7 @@
 #endif
 
 #include "clutter-frame-source.h"
+#include "clutter-main.h"
 #include "clutter-timeout-interval.h"
 #include "clutter-private.h"
 
@@ -38,6 +39,17 @@ struct _ClutterFrameSource
   GSource source;
 
   ClutterTimeoutInterval timeout;
+
+  /* the function is called by the master clock, and not by the
+   * dispatch of the source; the source only provides the id used
+   * to remove the function
+   */
+  GSourceFunc func;
+  gpointer data;
+  GDestroyNotify notify;
+
+  /* whether the function should be called holding the Clutter lock */
+  guint with_lock : 1;
 };
 
 static gboolean clutter_frame_source_prepare  (GSource     *source,
@@ -46,15 +58,70 @@ static gboolean clutter_frame_source_check    (GSource     *source);
 static gboolean clutter_frame_source_dispatch (GSource     *source,
                                                GSourceFunc  callback,
                                                gpointer     user_data);
+static void     clutter_frame_source_finalize (GSource     *source);
 
 static GSourceFuncs clutter_frame_source_funcs =
 {
   clutter_frame_source_prepare,
   clutter_frame_source_check,
   clutter_frame_source_dispatch,
-  NULL
+  clutter_frame_source_finalize
 };
 
+/* the frame sources, sorted by priority; they can be added from any
+ * thread, and they are dispatched by the master clock
+ */
+G_LOCK_DEFINE_STATIC (frame_sources);
+static GList *frame_sources = NULL;
+
+static gint
+clutter_frame_source_compare (gconstpointer a,
+                              gconstpointer b)
+{
+  return g_source_get_priority ((GSource *) a)
+       - g_source_get_priority ((GSource *) b);
+}
+
+static guint
+clutter_frame_source_add_internal (gint           priority,
+                                   guint          fps,
+                                   GSourceFunc    func,
+                                   gpointer       data,
+                                   GDestroyNotify notify,
+                                   gboolean       with_lock)
+{
+  guint ret;
+  GSource *source = g_source_new (&clutter_frame_source_funcs,
+				  sizeof (ClutterFrameSource));
+  ClutterFrameSource *frame_source = (ClutterFrameSource *) source;
+
+  _clutter_timeout_interval_init (&frame_source->timeout, fps);
+
+  frame_source->func = func;
+  frame_source->data = data;
+  frame_source->notify = notify;
+  frame_source->with_lock = with_lock;
+
+  if (priority != G_PRIORITY_DEFAULT)
+    g_source_set_priority (source, priority);
+
+  g_source_set_name (source, "Clutter frame timeout");
+
+  G_LOCK (frame_sources);
+  frame_sources = g_list_insert_sorted (frame_sources, source,
+                                        clutter_frame_source_compare);
+  G_UNLOCK (frame_sources);
+
+  /* attaching the source also wakes up the main loop, so that the
+   * master clock starts running
+   */
+  ret = g_source_attach (source, NULL);
+
+  g_source_unref (source);
+
+  return ret;
+}
+
 /**
  * clutter_frame_source_add_full:
  * @priority: the priority of the frame source. Typically this will be in the
@@ -71,6 +138,11 @@ static GSourceFuncs clutter_frame_source_funcs =
  * called when the timeout is destroyed.  The first call to the
  * function will be at the end of the first @interval.
  *
+ * The function is called by the master clock, right before the
+ * timelines are advanced, so that it is called at most once for each
+ * frame and its changes are painted by the frame that follows; the
+ * frame sources are called in order of @priority.
+ *
  * This function is similar to g_timeout_add_full() except that it
  * will try to compensate for delays. For example, if @func takes half
  * the interval time to execute then the function will be called again
@@ -96,24 +168,9 @@ clutter_frame_source_add_full (gint           priority,
 			       gpointer       data,
 			       GDestroyNotify notify)
 {
-  guint ret;
-  GSource *source = g_source_new (&clutter_frame_source_funcs,
-				  sizeof (ClutterFrameSource));
-  ClutterFrameSource *frame_source = (ClutterFrameSource *) source;
-
-  _clutter_timeout_interval_init (&frame_source->timeout, fps);
-
-  if (priority != G_PRIORITY_DEFAULT)
-    g_source_set_priority (source, priority);
-
-  g_source_set_name (source, "Clutter frame timeout");
-  g_source_set_callback (source, func, data, notify);
-
-  ret = g_source_attach (source, NULL);
-
-  g_source_unref (source);
-
-  return ret;
+  return clutter_frame_source_add_internal (priority, fps,
+                                            func, data, notify,
+                                            FALSE);
 }
 
 /**
@@ -139,43 +196,116 @@ clutter_frame_source_add (guint          fps,
 					fps, func, data, NULL);
 }
 
+/* the source itself never becomes ready: the functions are called by
+ * the master clock, see _clutter_frame_sources_dispatch()
+ */
 static gboolean
 clutter_frame_source_prepare (GSource *source,
                               gint    *delay)
 {
-  ClutterFrameSource *frame_source = (ClutterFrameSource *) source;
-  gint64 current_time;
-
-#if GLIB_CHECK_VERSION (2, 27, 3)
-  current_time = g_source_get_time (source) / 1000;
-#else
-  {
-    GTimeVal source_time;
-    g_source_get_current_time (source, &source_time);
-    current_time = source_time.tv_sec * 1000 + source_time.tv_usec / 1000;
-  }
-#endif
+  *delay = -1;
 
-  return _clutter_timeout_interval_prepare (current_time,
-                                            &frame_source->timeout,
-                                            delay);
+  return FALSE;
 }
 
 static gboolean
 clutter_frame_source_check (GSource *source)
 {
-  return clutter_frame_source_prepare (source, NULL);
+  return FALSE;
 }
 
 static gboolean
 clutter_frame_source_dispatch (GSource     *source,
 			       GSourceFunc  callback,
 			       gpointer     user_data)
+{
+  return TRUE;
+}
+
+static void
+clutter_frame_source_finalize (GSource *source)
 {
   ClutterFrameSource *frame_source = (ClutterFrameSource *) source;
 
-  return _clutter_timeout_interval_dispatch (&frame_source->timeout,
-                                             callback, user_data);
+  G_LOCK (frame_sources);
+  frame_sources = g_list_remove (frame_sources, source);
+  G_UNLOCK (frame_sources);
+
+  if (frame_source->notify != NULL)
+    frame_source->notify (frame_source->data);
+}
+
+/*< private >
+ * _clutter_frame_sources_pending:
+ *
+ * Checks whether there are frame sources; the master clock keeps
+ * running while there are.
+ *
+ * Return value: %TRUE if there are frame sources
+ */
+gboolean
+_clutter_frame_sources_pending (void)
+{
+  gboolean retval;
+
+  G_LOCK (frame_sources);
+  retval = frame_sources != NULL;
+  G_UNLOCK (frame_sources);
+
+  return retval;
+}
+
+/*< private >
+ * _clutter_frame_sources_dispatch:
+ * @tick: the time of the current frame, in microseconds
+ *
+ * Calls the functions of the frame sources whose interval has elapsed
+ * at @tick. This function is called by the master clock, holding the
+ * Clutter lock, before advancing the timelines.
+ */
+void
+_clutter_frame_sources_dispatch (gint64 tick)
+{
+  GList *sources, *l;
+
+  /* the functions can add and remove frame sources; the new ones
+   * are dispatched at the next frame
+   */
+  G_LOCK (frame_sources);
+  sources = g_list_copy (frame_sources);
+  g_list_foreach (sources, (GFunc) g_source_ref, NULL);
+  G_UNLOCK (frame_sources);
+
+  for (l = sources; l != NULL; l = l->next)
+    {
+      GSource *source = l->data;
+      ClutterFrameSource *frame_source = l->data;
+      gboolean retval;
+
+      if (g_source_is_destroyed (source))
+        continue;
+
+      if (!_clutter_timeout_interval_prepare (tick / 1000,
+                                              &frame_source->timeout,
+                                              NULL))
+        continue;
+
+      if (!frame_source->with_lock)
+        clutter_threads_leave ();
+
+      retval = _clutter_timeout_interval_dispatch (&frame_source->timeout,
+                                                   frame_source->func,
+                                                   frame_source->data);
+
+      if (!frame_source->with_lock)
+        clutter_threads_enter ();
+
+      if (!retval)
+        g_source_destroy (source);
+    }
+
+  g_list_foreach (sources, (GFunc) g_source_unref, NULL);
+  g_list_free (sources);
 }
 
 /**
@@ -193,6 +323,10 @@ clutter_frame_source_dispatch (GSource     *source,
  * removed and the function will not be called again. The @notify function
  * is called when the timeout is removed.
  *
+ * The function is called by the master clock, right before the
+ * timelines are advanced, so that it is called at most once for each
+ * frame, using the same frame time as the timelines.
+ *
  * This function is similar to clutter_threads_add_timeout_full()
  * except that it will try to compensate for delays. For example, if
  * @func takes half the interval time to execute then the function
@@ -220,19 +354,12 @@ clutter_threads_add_frame_source_full (gint           priority,
                                        gpointer       data,
                                        GDestroyNotify notify)
 {
-  ClutterThreadsDispatch *dispatch;
-
   g_return_val_if_fail (func != NULL, 0);
 
-  dispatch = g_slice_new (ClutterThreadsDispatch);
-  dispatch->func = func;
-  dispatch->data = data;
-  dispatch->notify = notify;
-
-  return clutter_frame_source_add_full (priority,
-                                        fps,
-                                        _clutter_threads_dispatch, dispatch,
-                                        _clutter_threads_dispatch_free);
+  /* the master clock already holds the lock */
+  return clutter_frame_source_add_internal (priority, fps,
+                                            func, data, notify,
+                                            TRUE);
 }
 
 /**
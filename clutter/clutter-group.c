@@ -52,10 +52,13 @@
 
 #include "clutter-group.h"
 
+#include "clutter-actor-private.h"
+#include "clutter-child-array.h"
 #include "clutter-container.h"
 #include "clutter-fixed-layout.h"
 #include "clutter-main.h"
 #include "clutter-debug.h"
+#include "clutter-display-list.h"
 #include "clutter-enum-types.h"
 #include "clutter-marshal.h"
 #include "clutter-private.h"
@@ -67,7 +70,8 @@
 
 struct _ClutterGroupPrivate
 {
-  GList *children;
+  /* sorted by depth, in paint order */
+  GPtrArray *children;
 
   ClutterLayoutManager *layout;
 };
@@ -86,22 +90,6 @@ G_DEFINE_TYPE_WITH_CODE (ClutterGroup, clutter_group, CLUTTER_TYPE_ACTOR,
                          G_IMPLEMENT_INTERFACE (CLUTTER_TYPE_CONTAINER,
                                                 clutter_container_iface_init));
 
-static gint
-sort_by_depth (gconstpointer a,
-               gconstpointer b)
-{
-  gfloat depth_a = clutter_actor_get_depth (CLUTTER_ACTOR(a));
-  gfloat depth_b = clutter_actor_get_depth (CLUTTER_ACTOR(b));
-
-  if (depth_a < depth_b)
-    return -1;
-
-  if (depth_a > depth_b)
-    return 1;
-
-  return 0;
-}
-
 static void
 clutter_group_real_add (ClutterContainer *container,
                         ClutterActor     *actor)
@@ -110,7 +98,12 @@ clutter_group_real_add (ClutterContainer *container,
 
   g_object_ref (actor);
 
-  priv->children = g_list_append (priv->children, actor);
+  /* insert the child at its depth, instead of appending it and then
+   * sorting the whole list again; changing the depth of the child
+   * from inside an ::actor-added handler will still call
+   * sort_depth_order() through clutter_actor_set_depth()
+   */
+  _clutter_child_array_insert_sorted (priv->children, actor);
   clutter_actor_set_parent (actor, CLUTTER_ACTOR (container));
 
   /* queue a relayout, to get the correct positioning inside
@@ -120,11 +113,55 @@ clutter_group_real_add (ClutterContainer *container,
 
   g_signal_emit_by_name (container, "actor-added", actor);
 
-  clutter_container_sort_depth_order (container);
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (container));
 
   g_object_unref (actor);
 }
 
+static void
+clutter_group_real_add_actors (ClutterContainer    *container,
+                               ClutterActor *const *actors,
+                               guint                n_actors)
+{
+  ClutterGroupPrivate *priv = CLUTTER_GROUP (container)->priv;
+  ClutterActor **added;
+  guint i, n_added;
+
+  added = g_new (ClutterActor *, n_actors);
+  n_added = 0;
+
+  for (i = 0; i < n_actors; i++)
+    {
+      ClutterActor *actor = actors[i];
+
+      /* skip duplicates inside the batch */
+      if (clutter_actor_get_parent (actor) != NULL)
+        continue;
+
+      g_object_ref (actor);
+
+      _clutter_child_array_insert_sorted (priv->children, actor);
+      clutter_actor_set_parent (actor, CLUTTER_ACTOR (container));
+
+      added[n_added++] = actor;
+    }
+
+  /* queue a single relayout for the whole batch, to get the correct
+   * positioning inside the ::actor-added signal handlers
+   */
+  clutter_actor_queue_relayout (CLUTTER_ACTOR (container));
+
+  for (i = 0; i < n_added; i++)
+    g_signal_emit_by_name (container, "actor-added", added[i]);
+
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (container));
+
+  for (i = 0; i < n_added; i++)
+    g_object_unref (added[i]);
+
+  g_free (added);
+}
+
 static void
 clutter_group_real_remove (ClutterContainer *container,
                            ClutterActor     *actor)
@@ -133,7 +170,7 @@ clutter_group_real_remove (ClutterContainer *container,
 
   g_object_ref (actor);
 
-  priv->children = g_list_remove (priv->children, actor);
+  _clutter_child_array_remove (priv->children, actor);
   clutter_actor_unparent (actor);
 
   /* queue a relayout, to get the correct positioning inside
@@ -159,11 +196,11 @@ clutter_group_real_foreach (ClutterContainer *container,
 {
   ClutterGroupPrivate *priv = CLUTTER_GROUP (container)->priv;
 
-  /* Using g_list_foreach instead of iterating the list manually
-     because it has better protection against the current node being
-     removed. This will happen for example if someone calls
-     clutter_container_foreach(container, clutter_actor_destroy) */
-  g_list_foreach (priv->children, (GFunc) callback, user_data);
+  /* Iterate over a copy of the array, to be protected against the
+     current child being removed. This will happen for example if
+     someone calls clutter_container_foreach(container,
+     clutter_actor_destroy) */
+  _clutter_child_array_foreach (priv->children, (GFunc) callback, user_data);
 }
 
 static void
@@ -173,25 +210,22 @@ clutter_group_real_raise (ClutterContainer *container,
 {
   ClutterGroupPrivate *priv = CLUTTER_GROUP (container)->priv;
 
-  priv->children = g_list_remove (priv->children, actor);
+  _clutter_child_array_remove (priv->children, actor);
 
   /* Raise at the top */
   if (!sibling)
     {
-      GList *last_item;
-
-      last_item = g_list_last (priv->children);
-
-      if (last_item)
-	sibling = last_item->data;
+      if (priv->children->len > 0)
+        sibling = g_ptr_array_index (priv->children,
+                                     priv->children->len - 1);
 
-      priv->children = g_list_append (priv->children, actor);
+      g_ptr_array_add (priv->children, actor);
     }
   else
     {
-      gint index_ = g_list_index (priv->children, sibling) + 1;
+      gint index_ = _clutter_child_array_index (priv->children, sibling) + 1;
 
-      priv->children = g_list_insert (priv->children, actor, index_);
+      _clutter_child_array_insert (priv->children, index_, actor);
     }
 
   /* set Z ordering a value below, this will then call sort
@@ -217,25 +251,22 @@ clutter_group_real_lower (ClutterContainer *container,
   ClutterGroup *self = CLUTTER_GROUP (container);
   ClutterGroupPrivate *priv = self->priv;
 
-  priv->children = g_list_remove (priv->children, actor);
+  _clutter_child_array_remove (priv->children, actor);
 
   /* Push to bottom */
   if (!sibling)
     {
-      GList *last_item;
+      if (priv->children->len > 0)
+        sibling = g_ptr_array_index (priv->children, 0);
 
-      last_item = g_list_first (priv->children);
-
-      if (last_item)
-	sibling = last_item->data;
-
-      priv->children = g_list_prepend (priv->children, actor);
+      _clutter_child_array_insert (priv->children, 0, actor);
     }
   else
     {
-      gint index_ = g_list_index (priv->children, sibling);
+      gint index_ = _clutter_child_array_index (priv->children, sibling);
 
-      priv->children = g_list_insert (priv->children, actor, index_);
+      /* a missing sibling appends the child, like g_list_insert() */
+      _clutter_child_array_insert (priv->children, index_, actor);
     }
 
   /* See comment in group_raise for this */
@@ -252,33 +283,55 @@ static void
 clutter_group_real_sort_depth_order (ClutterContainer *container)
 {
   ClutterGroupPrivate *priv = CLUTTER_GROUP (container)->priv;
+  ClutterActor *child;
+  gboolean changed;
 
-  priv->children = g_list_sort (priv->children, sort_by_depth);
+  child = _clutter_actor_get_depth_changed_child (CLUTTER_ACTOR (container));
+  if (child != NULL)
+    changed = _clutter_child_array_restack (priv->children, child);
+  else
+    changed = _clutter_child_array_sort_depth (priv->children);
 
-  clutter_actor_queue_redraw (CLUTTER_ACTOR (container));
+  if (changed)
+    clutter_actor_queue_redraw (CLUTTER_ACTOR (container));
+}
+
+static ClutterActor *const *
+clutter_group_real_peek_children (ClutterContainer *container,
+                                  guint            *n_children)
+{
+  ClutterGroupPrivate *priv = CLUTTER_GROUP (container)->priv;
+
+  *n_children = priv->children->len;
+
+  return (ClutterActor *const *) priv->children->pdata;
 }
 
 static void
 clutter_container_iface_init (ClutterContainerIface *iface)
 {
   iface->add = clutter_group_real_add;
+  iface->add_actors = clutter_group_real_add_actors;
   iface->remove = clutter_group_real_remove;
   iface->foreach = clutter_group_real_foreach;
   iface->raise = clutter_group_real_raise;
   iface->lower = clutter_group_real_lower;
   iface->sort_depth_order = clutter_group_real_sort_depth_order;
+  iface->peek_children = clutter_group_real_peek_children;
 }
 
 static void
 clutter_group_real_paint (ClutterActor *actor)
 {
   ClutterGroupPrivate *priv = CLUTTER_GROUP (actor)->priv;
+  guint i;
 
   CLUTTER_NOTE (PAINT, "ClutterGroup paint enter '%s'",
                 clutter_actor_get_name (actor) ? clutter_actor_get_name (actor)
                                                : "unknown");
 
-  g_list_foreach (priv->children, (GFunc) clutter_actor_paint, NULL);
+  for (i = 0; i < priv->children->len; i++)
+    clutter_actor_paint (g_ptr_array_index (priv->children, i));
 
   CLUTTER_NOTE (PAINT, "ClutterGroup paint leave '%s'",
                 clutter_actor_get_name (actor) ? clutter_actor_get_name (actor)
@@ -290,11 +343,13 @@ clutter_group_real_pick (ClutterActor       *actor,
                          const ClutterColor *pick)
 {
   ClutterGroupPrivate *priv = CLUTTER_GROUP (actor)->priv;
+  guint i;
 
   /* Chain up so we get a bounding box pained (if we are reactive) */
   CLUTTER_ACTOR_CLASS (clutter_group_parent_class)->pick (actor, pick);
 
-  g_list_foreach (priv->children, (GFunc) clutter_actor_paint, NULL);
+  for (i = 0; i < priv->children->len; i++)
+    clutter_actor_paint (g_ptr_array_index (priv->children, i));
 }
 
 static void
@@ -336,7 +391,7 @@ clutter_group_real_allocate (ClutterActor           *actor,
   klass = CLUTTER_ACTOR_CLASS (clutter_group_parent_class);
   klass->allocate (actor, allocation, flags);
 
-  if (priv->children == NULL)
+  if (priv->children->len == 0)
     return;
 
   clutter_layout_manager_allocate (priv->layout,
@@ -350,12 +405,12 @@ clutter_group_dispose (GObject *object)
   ClutterGroup *self = CLUTTER_GROUP (object);
   ClutterGroupPrivate *priv = self->priv;
 
-  if (priv->children)
+  if (priv->children->len > 0)
     {
-      g_list_foreach (priv->children, (GFunc) clutter_actor_destroy, NULL);
-      g_list_free (priv->children);
-
-      priv->children = NULL;
+      _clutter_child_array_foreach (priv->children,
+                                    (GFunc) clutter_actor_destroy,
+                                    NULL);
+      g_ptr_array_set_size (priv->children, 0);
     }
 
   if (priv->layout)
@@ -368,6 +423,16 @@ clutter_group_dispose (GObject *object)
   G_OBJECT_CLASS (clutter_group_parent_class)->dispose (object);
 }
 
+static void
+clutter_group_finalize (GObject *object)
+{
+  ClutterGroupPrivate *priv = CLUTTER_GROUP (object)->priv;
+
+  g_ptr_array_free (priv->children, TRUE);
+
+  G_OBJECT_CLASS (clutter_group_parent_class)->finalize (object);
+}
+
 static void
 clutter_group_real_show_all (ClutterActor *actor)
 {
@@ -391,14 +456,11 @@ clutter_group_real_get_paint_volume (ClutterActor       *actor,
                                      ClutterPaintVolume *volume)
 {
   ClutterGroupPrivate *priv = CLUTTER_GROUP (actor)->priv;
-  GList *l;
-
-  if (priv->children == NULL)
-    return TRUE;
+  guint i;
 
-  for (l = priv->children; l != NULL; l = l->next)
+  for (i = 0; i < priv->children->len; i++)
     {
-      ClutterActor *child = l->data;
+      ClutterActor *child = g_ptr_array_index (priv->children, i);
       const ClutterPaintVolume *child_volume;
 
       /* This gets the paint volume of the child transformed into the
@@ -431,7 +493,11 @@ clutter_group_class_init (ClutterGroupClass *klass)
   actor_class->get_paint_volume = clutter_group_real_get_paint_volume;
 
   gobject_class->dispose = clutter_group_dispose;
+  gobject_class->finalize = clutter_group_finalize;
 
+  _clutter_actor_class_register_geometric_pick (actor_class, TRUE,
+                                                NULL, NULL);
+  _clutter_display_list_add_recordable_type (CLUTTER_TYPE_GROUP);
 }
 
 static void
@@ -439,6 +505,8 @@ clutter_group_init (ClutterGroup *self)
 {
   self->priv = CLUTTER_GROUP_GET_PRIVATE (self);
 
+  self->priv->children = g_ptr_array_new ();
+
   self->priv->layout = clutter_fixed_layout_new ();
   g_object_ref_sink (self->priv->layout);
 
@@ -468,15 +536,18 @@ clutter_group_new (void)
 void
 clutter_group_remove_all (ClutterGroup *group)
 {
-  GList *children;
+  ClutterGroupPrivate *priv;
 
   g_return_if_fail (CLUTTER_IS_GROUP (group));
 
-  children = group->priv->children;
-  while (children)
+  priv = group->priv;
+
+  /* remove from the top, so that we never have to shift the array */
+  while (priv->children->len > 0)
     {
-      ClutterActor *child = children->data;
-      children = children->next;
+      ClutterActor *child;
+
+      child = g_ptr_array_index (priv->children, priv->children->len - 1);
 
       clutter_container_remove_actor (CLUTTER_CONTAINER (group), child);
     }
@@ -497,7 +568,7 @@ clutter_group_get_n_children (ClutterGroup *self)
 {
   g_return_val_if_fail (CLUTTER_IS_GROUP (self), 0);
 
-  return g_list_length (self->priv->children);
+  return self->priv->children->len;
 }
 
 /**
@@ -518,5 +589,8 @@ clutter_group_get_nth_child (ClutterGroup *self,
 {
   g_return_val_if_fail (CLUTTER_IS_GROUP (self), NULL);
 
-  return g_list_nth_data (self->priv->children, index_);
+  if (index_ < 0 || index_ >= (gint) self->priv->children->len)
+    return NULL;
+
+  return g_ptr_array_index (self->priv->children, index_);
 }
@@ -35,10 +35,31 @@
 #include "clutter-debug.h"
 #include "clutter-id-pool.h"
 
+/* the end of the list of free slots */
+#define FREE_LIST_END   G_MAXUINT32
+
+typedef struct _ClutterIDPoolSlot
+{
+  /* the pointer associated with the id, or NULL if the slot is free */
+  gpointer ptr;
+
+  /* the index of the next free slot, if the slot is free */
+  guint32 next_free;
+
+  /* the generation of the pool when the slot was last assigned */
+  guint32 generation;
+} ClutterIDPoolSlot;
+
 struct _ClutterIDPool
 {
-  GArray *array;     /* Array of pointers    */
-  GSList *free_ids;  /* A stack of freed ids */
+  /* Array of ClutterIDPoolSlot; the freed slots are kept in a stack
+   * threaded through the array, so that adding and removing ids does
+   * not allocate unless the array has to grow */
+  GArray *array;
+  guint32 first_free;
+
+  /* incremented each time an id is released */
+  guint32 generation;
 };
 
 ClutterIDPool *
@@ -48,9 +69,12 @@ _clutter_id_pool_new  (guint initial_size)
 
   self = g_slice_new (ClutterIDPool);
 
-  self->array = g_array_sized_new (FALSE, FALSE, 
-                                   sizeof (gpointer), initial_size);
-  self->free_ids = NULL;
+  self->array = g_array_sized_new (FALSE, FALSE,
+                                   sizeof (ClutterIDPoolSlot),
+                                   initial_size);
+  self->first_free = FREE_LIST_END;
+  self->generation = 0;
+
   return self;
 }
 
@@ -60,7 +84,6 @@ _clutter_id_pool_free (ClutterIDPool *id_pool)
   g_return_if_fail (id_pool != NULL);
 
   g_array_free (id_pool->array, TRUE);
-  g_slist_free (id_pool->free_ids);
   g_slice_free (ClutterIDPool, id_pool);
 }
 
@@ -68,25 +91,29 @@ guint32
 _clutter_id_pool_add (ClutterIDPool *id_pool,
                       gpointer       ptr)
 {
-  gpointer *array;
+  ClutterIDPoolSlot *slot;
   guint32 retval;
 
   g_return_val_if_fail (id_pool != NULL, 0);
 
-  if (id_pool->free_ids) /* There are items on our freelist, reuse one */
+  if (id_pool->first_free != FREE_LIST_END) /* reuse a freed id */
+    {
+      retval = id_pool->first_free;
+      slot = &g_array_index (id_pool->array, ClutterIDPoolSlot, retval);
+
+      id_pool->first_free = slot->next_free;
+    }
+  else /* Allocate new id */
     {
-      array = (void*) id_pool->array->data;
-      retval = GPOINTER_TO_UINT (id_pool->free_ids->data);
+      retval = id_pool->array->len;
+      g_array_set_size (id_pool->array, retval + 1);
 
-      id_pool->free_ids = g_slist_remove (id_pool->free_ids,
-                                          id_pool->free_ids->data);
-      array[retval] = ptr;
-      return retval;
+      slot = &g_array_index (id_pool->array, ClutterIDPoolSlot, retval);
     }
 
-  /* Allocate new id */
-  retval = id_pool->array->len;
-  g_array_append_val (id_pool->array, ptr);
+  slot->ptr = ptr;
+  slot->next_free = FREE_LIST_END;
+  slot->generation = id_pool->generation;
 
   return retval;
 }
@@ -95,31 +122,36 @@ void
 _clutter_id_pool_remove (ClutterIDPool *id_pool,
                          guint32        id_)
 {
-  gpointer *array;
+  ClutterIDPoolSlot *slot;
 
   g_return_if_fail (id_pool != NULL);
+  g_return_if_fail (id_ < id_pool->array->len);
+
+  slot = &g_array_index (id_pool->array, ClutterIDPoolSlot, id_);
 
-  array = (void*) id_pool->array->data;
+  g_return_if_fail (slot->ptr != NULL);
 
-  /* set pointer to a recognizably voided value */
-  array[id_] = (void*)0xdecafbad;
+  slot->ptr = NULL;
+  slot->next_free = id_pool->first_free;
+  id_pool->first_free = id_;
 
-  id_pool->free_ids = g_slist_prepend (id_pool->free_ids,
-                                       GUINT_TO_POINTER (id_));
+  id_pool->generation += 1;
 }
 
 gpointer
 _clutter_id_pool_lookup (ClutterIDPool *id_pool,
                          guint32        id_)
 {
-  gpointer *array;
+  ClutterIDPoolSlot *slot;
 
   g_return_val_if_fail (id_pool != NULL, NULL);
   g_return_val_if_fail (id_pool->array != NULL, NULL);
 
-  array = (void*) id_pool->array->data;
+  slot = NULL;
+  if (id_ < id_pool->array->len)
+    slot = &g_array_index (id_pool->array, ClutterIDPoolSlot, id_);
 
-  if (id_ >= id_pool->array->len || array[id_] == NULL)
+  if (slot == NULL || slot->ptr == NULL)
     {
       g_warning ("The required ID of %u does not refer to an existing actor; "
                  "this usually implies that the pick() of an actor is not "
@@ -128,5 +160,57 @@ _clutter_id_pool_lookup (ClutterIDPool *id_pool,
       return NULL;
     }
 
-  return array[id_];
+  return slot->ptr;
+}
+
+/*< private >
+ * _clutter_id_pool_get_generation:
+ * @id_pool: a #ClutterIDPool
+ *
+ * Retrieves the current generation of @id_pool, which changes every
+ * time an id is released; pass it to _clutter_id_pool_lookup_generation()
+ * to resolve ids that were stored, for instance in a pick buffer, at
+ * this point.
+ *
+ * Return value: the generation of the pool
+ */
+guint32
+_clutter_id_pool_get_generation (ClutterIDPool *id_pool)
+{
+  g_return_val_if_fail (id_pool != NULL, 0);
+
+  return id_pool->generation;
+}
+
+/*< private >
+ * _clutter_id_pool_lookup_generation:
+ * @id_pool: a #ClutterIDPool
+ * @id_: the id to look up
+ * @generation: the generation of @id_pool at the time @id_ was stored
+ *
+ * Like _clutter_id_pool_lookup(), but returns %NULL without warning if
+ * @id_ was released after @generation, even if it has been assigned to
+ * a new pointer since then.
+ *
+ * Return value: the pointer associated with @id_, or %NULL
+ */
+gpointer
+_clutter_id_pool_lookup_generation (ClutterIDPool *id_pool,
+                                    guint32        id_,
+                                    guint32        generation)
+{
+  ClutterIDPoolSlot *slot;
+
+  g_return_val_if_fail (id_pool != NULL, NULL);
+
+  if (id_ >= id_pool->array->len)
+    return _clutter_id_pool_lookup (id_pool, id_);
+
+  slot = &g_array_index (id_pool->array, ClutterIDPoolSlot, id_);
+
+  /* the slot was freed, or reused, after the id was stored */
+  if (slot->ptr == NULL || slot->generation > generation)
+    return NULL;
+
+  return slot->ptr;
 }
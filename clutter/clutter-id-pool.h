@@ -44,6 +44,11 @@ void            _clutter_id_pool_remove (ClutterIDPool *id_pool,
 gpointer        _clutter_id_pool_lookup (ClutterIDPool *id_pool,
                                          guint32        id_);
 
+guint32         _clutter_id_pool_get_generation    (ClutterIDPool *id_pool);
+gpointer        _clutter_id_pool_lookup_generation (ClutterIDPool *id_pool,
+                                                    guint32        id_,
+                                                    guint32        generation);
+
 
 G_END_DECLS
 
@@ -450,6 +450,7 @@ _clutter_input_device_set_stage (ClutterInputDevice *device,
     return;
 
   device->stage = stage;
+  device->cursor_quad_valid = FALSE;
 
   /* we leave the ->cursor_actor in place in order to check
    * if we left the stage without crossing it again; this way
@@ -488,6 +489,7 @@ _clutter_input_device_set_actor (ClutterInputDevice *device,
     return;
 
   old_actor = device->cursor_actor;
+  device->cursor_quad_valid = FALSE;
 
   if (old_actor != NULL)
     {
@@ -680,6 +682,9 @@ clutter_input_device_get_device_coords (ClutterInputDevice *device,
  *
  * This function calls _clutter_input_device_set_actor() if needed.
  *
+ * The pick is skipped while the pointer stays inside the region of the
+ * current actor that nothing else can cover, and the scene is unchanged.
+ *
  * This function only works for #ClutterInputDevice of type
  * %CLUTTER_POINTER_DEVICE.
  *
@@ -692,7 +697,13 @@ _clutter_input_device_update (ClutterInputDevice *device,
   ClutterStage *stage;
   ClutterActor *new_cursor_actor;
   ClutterActor *old_cursor_actor;
+  guint scene_serial;
   gint x, y;
+  CLUTTER_STATIC_COUNTER (skipped_pick_counter,
+                          "Skipped pointer picks",
+                          "Increments for each pointer update that did not "
+                          "need a pick",
+                          0 /* no application private data */);
 
   if (device->device_type == CLUTTER_KEYBOARD_DEVICE)
     return NULL;
@@ -708,6 +719,23 @@ _clutter_input_device_update (ClutterInputDevice *device,
   clutter_input_device_get_device_coords (device, &x, &y);
 
   old_cursor_actor = device->cursor_actor;
+  scene_serial = _clutter_stage_get_scene_serial (stage);
+
+  /* as long as the scene does not change, the pointer moving inside
+   * the region in which nothing else can be picked is not going to
+   * find a different actor, so we can skip the pick entirely */
+  if (old_cursor_actor != NULL &&
+      device->cursor_quad_valid &&
+      device->cursor_scene_serial == scene_serial &&
+      CLUTTER_ACTOR_IS_MAPPED (old_cursor_actor) &&
+      CLUTTER_ACTOR_IS_REACTIVE (old_cursor_actor) &&
+      _clutter_actor_point_in_quad (device->cursor_quad, x, y))
+    {
+      CLUTTER_COUNTER_INC (_clutter_uprof_context, skipped_pick_counter);
+
+      return old_cursor_actor;
+    }
+
   new_cursor_actor =
     _clutter_stage_do_pick (stage, x, y, CLUTTER_PICK_REACTIVE);
 
@@ -728,10 +756,19 @@ _clutter_input_device_update (ClutterInputDevice *device,
                   : G_OBJECT_TYPE_NAME (new_cursor_actor));
 
   /* short-circuit here */
-  if (new_cursor_actor == old_cursor_actor)
-    return old_cursor_actor;
+  if (new_cursor_actor != old_cursor_actor)
+    _clutter_input_device_set_actor (device, new_cursor_actor, emit_crossing);
 
-  _clutter_input_device_set_actor (device, new_cursor_actor, emit_crossing);
+  /* emitting the crossing events might have changed the scene */
+  if (device->cursor_actor == new_cursor_actor &&
+      _clutter_stage_get_scene_serial (stage) == scene_serial)
+    {
+      device->cursor_quad_valid =
+        _clutter_actor_get_exclusive_pick_quad (new_cursor_actor,
+                                                CLUTTER_PICK_REACTIVE,
+                                                device->cursor_quad);
+      device->cursor_scene_serial = scene_serial;
+    }
 
   return device->cursor_actor;
 }
@@ -0,0 +1,14 @@
+#ifndef __CLUTTER_INTERVAL_PRIVATE_H__
+#define __CLUTTER_INTERVAL_PRIVATE_H__
+
+#include <clutter/clutter-interval.h>
+
+G_BEGIN_DECLS
+
+gboolean _clutter_interval_compute_double (ClutterInterval *interval,
+                                           gdouble          factor,
+                                           gdouble         *result);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_INTERVAL_PRIVATE_H__ */
@@ -60,6 +60,7 @@
 #include "clutter-color.h"
 #include "clutter-fixed.h"
 #include "clutter-interval.h"
+#include "clutter-interval-private.h"
 #include "clutter-private.h"
 #include "clutter-units.h"
 
@@ -942,6 +943,87 @@ clutter_interval_compute (ClutterInterval *interval,
   return NULL;
 }
 
+/*< private >
+ * _clutter_interval_compute_double:
+ * @interval: a #ClutterInterval
+ * @factor: the progress factor, between 0 and 1
+ * @result: (out): return location for the computed value
+ *
+ * Computes the value between the @interval boundaries without going
+ * through a #GValue, for intervals of numeric fundamental types.
+ *
+ * The value is truncated in the same way as the value computed by
+ * clutter_interval_compute_value() for the type of @interval.
+ *
+ * Return value: %TRUE if the value was computed, and %FALSE if the
+ *   interval has to be computed using clutter_interval_compute_value()
+ *   instead, for instance because its class overrides the
+ *   #ClutterIntervalClass.compute_value() virtual function or because
+ *   a progress function has been registered for its type
+ */
+gboolean
+_clutter_interval_compute_double (ClutterInterval *interval,
+                                  gdouble          factor,
+                                  gdouble         *result)
+{
+  ClutterIntervalPrivate *priv = interval->priv;
+  const GValue *initial, *final;
+  gdouble ia, ib;
+
+  if (CLUTTER_INTERVAL_GET_CLASS (interval)->compute_value !=
+      clutter_interval_real_compute_value)
+    return FALSE;
+
+  if (G_UNLIKELY (progress_funcs != NULL) &&
+      g_hash_table_lookup (progress_funcs,
+                           GUINT_TO_POINTER (priv->value_type)) != NULL)
+    return FALSE;
+
+  initial = &priv->values[INITIAL];
+  final = &priv->values[FINAL];
+
+  if (!G_IS_VALUE (initial) || !G_IS_VALUE (final))
+    return FALSE;
+
+  switch (G_TYPE_FUNDAMENTAL (priv->value_type))
+    {
+    case G_TYPE_INT:
+      ia = g_value_get_int (initial);
+      ib = g_value_get_int (final);
+      *result = (gint) ((factor * (ib - ia)) + ia);
+      return TRUE;
+
+    case G_TYPE_UINT:
+      ia = g_value_get_uint (initial);
+      ib = g_value_get_uint (final);
+      *result = (guint) ((factor * (ib - ia)) + ia);
+      return TRUE;
+
+    case G_TYPE_UCHAR:
+      ia = g_value_get_uchar (initial);
+      ib = g_value_get_uchar (final);
+      *result = (guchar) ((factor * (ib - ia)) + ia);
+      return TRUE;
+
+    case G_TYPE_FLOAT:
+      ia = g_value_get_float (initial);
+      ib = g_value_get_float (final);
+      *result = (gfloat) ((factor * (ib - ia)) + ia);
+      return TRUE;
+
+    case G_TYPE_DOUBLE:
+      ia = g_value_get_double (initial);
+      ib = g_value_get_double (final);
+      *result = (factor * (ib - ia)) + ia;
+      return TRUE;
+
+    default:
+      break;
+    }
+
+  return FALSE;
+}
+
 /**
  * clutter_interval_register_progress_func: (skip)
  * @value_type: a #GType
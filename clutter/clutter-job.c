@@ -0,0 +1,395 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2011  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:clutter-job
+ * @Title: Jobs
+ * @Short_Description: Running work in a shared pool of threads
+ *
+ * Clutter keeps a single pool of worker threads, sized after the
+ * number of processors, that both Clutter itself and applications can
+ * use to run work that would otherwise block the main loop, like
+ * decoding images or laying out large amounts of text.
+ *
+ * A job is added using clutter_job_add() or clutter_job_add_full();
+ * its function is called from one of the worker threads, and it must
+ * not call any Clutter or Cogl API. Once the function returns, the
+ * completion function of the job is called from the thread running
+ * the Clutter main loop, at the beginning of the next frame, before
+ * the timelines are advanced; the completion function can safely
+ * update the scene graph with the results of the job.
+ *
+ * Jobs with a lower priority value are run first; jobs with the same
+ * priority are run in the order they were added.
+ *
+ * A job can be cancelled using clutter_job_cancel(): if it did not
+ * start yet it will never run, and its completion function will not
+ * be called. Long running jobs should check clutter_job_is_cancelled()
+ * periodically and return early.
+ *
+ * If threads are not supported, the function of the job is called
+ * from the Clutter main loop instead.
+ *
+ * Jobs are available since Clutter 1.8
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include "clutter-job.h"
+
+#include "clutter-debug.h"
+#include "clutter-main.h"
+#include "clutter-private.h"
+
+struct _ClutterJob
+{
+  guint id;
+  gint priority;
+
+  /* used to keep the jobs with the same priority in order */
+  guint serial;
+
+  volatile gint cancelled;
+
+  ClutterJobFunc func;
+  ClutterJobFunc done_func;
+  gpointer data;
+  GDestroyNotify notify;
+};
+
+G_LOCK_DEFINE_STATIC (clutter_jobs);
+
+/* the pending jobs, indexed by id; protected by the lock above */
+static GHashTable *clutter_jobs = NULL;
+static guint clutter_job_last_id = 0;
+
+static GThreadPool *clutter_job_pool = NULL;
+static guint clutter_job_n_workers = 0;
+
+static gint
+clutter_job_sort (gconstpointer a,
+                  gconstpointer b,
+                  gpointer      user_data)
+{
+  const ClutterJob *job_a = a;
+  const ClutterJob *job_b = b;
+
+  if (job_a->priority != job_b->priority)
+    return job_a->priority < job_b->priority ? -1 : 1;
+
+  if (job_a->serial != job_b->serial)
+    return job_a->serial < job_b->serial ? -1 : 1;
+
+  return 0;
+}
+
+static guint
+clutter_job_count_processors (void)
+{
+  gint n_processors = 1;
+
+#if GLIB_CHECK_VERSION (2, 36, 0)
+  n_processors = g_get_num_processors ();
+#elif defined(HAVE_UNISTD_H) && defined(_SC_NPROCESSORS_ONLN)
+  n_processors = sysconf (_SC_NPROCESSORS_ONLN);
+#endif
+
+  return MAX (n_processors, 1);
+}
+
+/* called from the thread running the main loop, through the queue
+ * of updates, once the function of the job returned
+ */
+static void
+clutter_job_complete (gpointer data)
+{
+  ClutterJob *job = data;
+
+  G_LOCK (clutter_jobs);
+  g_hash_table_remove (clutter_jobs, GUINT_TO_POINTER (job->id));
+  G_UNLOCK (clutter_jobs);
+
+  CLUTTER_NOTE (SCHEDULER, "Job %u completed%s",
+                job->id,
+                g_atomic_int_get (&job->cancelled) ? " (cancelled)" : "");
+
+  if (job->done_func != NULL && !g_atomic_int_get (&job->cancelled))
+    job->done_func (job, job->data);
+
+  if (job->notify != NULL)
+    job->notify (job->data);
+
+  g_slice_free (ClutterJob, job);
+}
+
+static void
+clutter_job_run (ClutterJob *job)
+{
+  if (!g_atomic_int_get (&job->cancelled))
+    job->func (job, job->data);
+
+  clutter_threads_post_update (clutter_job_complete, job, NULL);
+}
+
+static void
+clutter_job_worker (gpointer data,
+                    gpointer pool_data)
+{
+  clutter_job_run (data);
+}
+
+/* fallback for when threads are not supported */
+static void
+clutter_job_run_in_main (gpointer data)
+{
+  clutter_job_run (data);
+}
+
+static GThreadPool *
+clutter_job_get_pool (void)
+{
+  static gsize pool_init = 0;
+
+  if (g_once_init_enter (&pool_init))
+    {
+      GError *error = NULL;
+
+      clutter_jobs = g_hash_table_new (NULL, NULL);
+      clutter_job_n_workers = clutter_job_count_processors ();
+
+      if (g_thread_supported ())
+        {
+          clutter_job_pool = g_thread_pool_new (clutter_job_worker, NULL,
+                                                clutter_job_n_workers,
+                                                FALSE,
+                                                &error);
+          if (error != NULL)
+            {
+              g_warning ("Unable to create the pool of worker threads: %s",
+                         error->message);
+              g_error_free (error);
+              clutter_job_pool = NULL;
+            }
+          else
+            g_thread_pool_set_sort_function (clutter_job_pool,
+                                             clutter_job_sort,
+                                             NULL);
+        }
+
+      if (clutter_job_pool == NULL)
+        clutter_job_n_workers = 0;
+
+      CLUTTER_NOTE (SCHEDULER, "Using %u worker threads for jobs",
+                    clutter_job_n_workers);
+
+      g_once_init_leave (&pool_init, 1);
+    }
+
+  return clutter_job_pool;
+}
+
+/**
+ * clutter_job_add_full:
+ * @priority: the priority of the job; lower values are run first
+ * @func: the function to call from a worker thread
+ * @done_func: (allow-none): the function to call from the Clutter
+ *   main loop once @func returned, or %NULL
+ * @data: data to pass to @func and @done_func
+ * @notify: (allow-none): function to call when the job is released,
+ *   or %NULL
+ *
+ * Adds a job to the shared pool of worker threads.
+ *
+ * @func is called from one of the worker threads, so it must not use
+ * any Clutter or Cogl API; @done_func is called from the thread
+ * running the Clutter main loop at the beginning of the next frame
+ * after @func returned, unless the job was cancelled in the meantime.
+ *
+ * @notify is always called from the thread running the Clutter main
+ * loop, after @done_func, even if the job was cancelled.
+ *
+ * Return value: the identifier of the job, which can be used with
+ *   clutter_job_cancel()
+ *
+ * Since: 1.8
+ */
+guint
+clutter_job_add_full (gint           priority,
+                      ClutterJobFunc func,
+                      ClutterJobFunc done_func,
+                      gpointer       data,
+                      GDestroyNotify notify)
+{
+  GThreadPool *pool;
+  ClutterJob *job;
+
+  g_return_val_if_fail (func != NULL, 0);
+
+  pool = clutter_job_get_pool ();
+
+  job = g_slice_new0 (ClutterJob);
+  job->priority = priority;
+  job->func = func;
+  job->done_func = done_func;
+  job->data = data;
+  job->notify = notify;
+
+  G_LOCK (clutter_jobs);
+
+  do
+    job->id = ++clutter_job_last_id;
+  while (job->id == 0 ||
+         g_hash_table_lookup (clutter_jobs, GUINT_TO_POINTER (job->id)));
+
+  job->serial = job->id;
+
+  g_hash_table_insert (clutter_jobs, GUINT_TO_POINTER (job->id), job);
+
+  G_UNLOCK (clutter_jobs);
+
+  if (pool != NULL)
+    g_thread_pool_push (pool, job, NULL);
+  else
+    clutter_threads_post_update (clutter_job_run_in_main, job, NULL);
+
+  return job->id;
+}
+
+/**
+ * clutter_job_add:
+ * @func: the function to call from a worker thread
+ * @done_func: (allow-none): the function to call from the Clutter
+ *   main loop once @func returned, or %NULL
+ * @data: data to pass to @func and @done_func
+ *
+ * Adds a job with the default priority to the shared pool of worker
+ * threads. See clutter_job_add_full().
+ *
+ * Return value: the identifier of the job
+ *
+ * Since: 1.8
+ */
+guint
+clutter_job_add (ClutterJobFunc func,
+                 ClutterJobFunc done_func,
+                 gpointer       data)
+{
+  return clutter_job_add_full (G_PRIORITY_DEFAULT,
+                               func, done_func,
+                               data, NULL);
+}
+
+/**
+ * clutter_job_cancel:
+ * @job_id: the identifier of a job, as returned by clutter_job_add()
+ *
+ * Cancels a job. If the job did not start running it will be skipped;
+ * if it is running, clutter_job_is_cancelled() will return %TRUE.
+ * In both cases the completion function of the job will not be
+ * called.
+ *
+ * Return value: %TRUE if the job was pending, and %FALSE if it
+ *   already completed or @job_id is not valid
+ *
+ * Since: 1.8
+ */
+gboolean
+clutter_job_cancel (guint job_id)
+{
+  ClutterJob *job;
+
+  g_return_val_if_fail (job_id != 0, FALSE);
+
+  if (clutter_jobs == NULL)
+    return FALSE;
+
+  G_LOCK (clutter_jobs);
+
+  job = g_hash_table_lookup (clutter_jobs, GUINT_TO_POINTER (job_id));
+  if (job != NULL)
+    g_atomic_int_set (&job->cancelled, TRUE);
+
+  G_UNLOCK (clutter_jobs);
+
+  return job != NULL;
+}
+
+/**
+ * clutter_job_is_cancelled:
+ * @job: a #ClutterJob
+ *
+ * Checks whether @job was cancelled using clutter_job_cancel(). This
+ * function can be called from the function of the job, to stop early.
+ *
+ * Return value: %TRUE if the job was cancelled
+ *
+ * Since: 1.8
+ */
+gboolean
+clutter_job_is_cancelled (ClutterJob *job)
+{
+  g_return_val_if_fail (job != NULL, TRUE);
+
+  return g_atomic_int_get (&job->cancelled);
+}
+
+/**
+ * clutter_job_get_id:
+ * @job: a #ClutterJob
+ *
+ * Retrieves the identifier of @job.
+ *
+ * Return value: the identifier returned by clutter_job_add()
+ *
+ * Since: 1.8
+ */
+guint
+clutter_job_get_id (ClutterJob *job)
+{
+  g_return_val_if_fail (job != NULL, 0);
+
+  return job->id;
+}
+
+/**
+ * clutter_job_get_n_workers:
+ *
+ * Retrieves the number of worker threads used to run jobs. The value
+ * is 0 if threads are not supported, in which case jobs are run from
+ * the Clutter main loop.
+ *
+ * Return value: the number of worker threads
+ *
+ * Since: 1.8
+ */
+guint
+clutter_job_get_n_workers (void)
+{
+  clutter_job_get_pool ();
+
+  return clutter_job_n_workers;
+}
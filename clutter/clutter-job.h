@@ -0,0 +1,73 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2011  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined(__CLUTTER_H_INSIDE__) && !defined(CLUTTER_COMPILATION)
+#error "Only <clutter/clutter.h> can be included directly."
+#endif
+
+#ifndef __CLUTTER_JOB_H__
+#define __CLUTTER_JOB_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/**
+ * ClutterJob:
+ *
+ * The <structname>ClutterJob</structname> structure is an opaque
+ * type whose members cannot be directly accessed.
+ *
+ * Since: 1.8
+ */
+typedef struct _ClutterJob      ClutterJob;
+
+/**
+ * ClutterJobFunc:
+ * @job: the #ClutterJob
+ * @data: the data passed to clutter_job_add()
+ *
+ * The prototype of the functions running a job in a worker thread,
+ * and of the functions notifying its completion in the thread running
+ * the Clutter main loop.
+ *
+ * Since: 1.8
+ */
+typedef void (* ClutterJobFunc) (ClutterJob *job,
+                                 gpointer    data);
+
+guint    clutter_job_add_full         (gint            priority,
+                                       ClutterJobFunc  func,
+                                       ClutterJobFunc  done_func,
+                                       gpointer        data,
+                                       GDestroyNotify  notify);
+guint    clutter_job_add              (ClutterJobFunc  func,
+                                       ClutterJobFunc  done_func,
+                                       gpointer        data);
+gboolean clutter_job_cancel           (guint           job_id);
+gboolean clutter_job_is_cancelled     (ClutterJob     *job);
+guint    clutter_job_get_id           (ClutterJob     *job);
+
+guint    clutter_job_get_n_workers    (void);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_JOB_H__ */
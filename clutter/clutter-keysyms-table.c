@@ -826,6 +826,74 @@ static const struct {
 static const int clutter_keysym_to_unicode_tab_size =
   G_N_ELEMENTS (clutter_keysym_to_unicode_tab);
 
+/* The pairs above are looked up through two-level tables indexed
+ * directly by the high and the low byte of the key symbol, or of the
+ * character for the reverse conversion; each table has a page of 256
+ * entries for each high byte found in the pairs, and 0 marks the
+ * entries without a mapping. The tables are generated from the pairs
+ * the first time they are needed.
+ */
+typedef guint16 *KeysymPages[256];
+
+static KeysymPages *
+clutter_keysym_pages_new (gboolean reverse)
+{
+  KeysymPages *pages = g_new0 (KeysymPages, 1);
+  int i;
+
+  /* going backwards, so that the first pair wins when the reverse
+   * table finds more than one key symbol for the same character */
+  for (i = clutter_keysym_to_unicode_tab_size - 1; i >= 0; i--)
+    {
+      guint16 key, value;
+
+      if (reverse)
+        {
+          key = clutter_keysym_to_unicode_tab[i].ucs;
+          value = clutter_keysym_to_unicode_tab[i].keysym;
+        }
+      else
+        {
+          key = clutter_keysym_to_unicode_tab[i].keysym;
+          value = clutter_keysym_to_unicode_tab[i].ucs;
+        }
+
+      if ((*pages)[key >> 8] == NULL)
+        (*pages)[key >> 8] = g_new0 (guint16, 256);
+
+      (*pages)[key >> 8][key & 0xff] = value;
+    }
+
+  return pages;
+}
+
+static inline guint16
+clutter_keysym_pages_lookup (KeysymPages *pages,
+                             guint32      key)
+{
+  const guint16 *page;
+
+  if (key > 0xffff)
+    return 0;
+
+  page = (*pages)[key >> 8];
+
+  return page != NULL ? page[key & 0xff] : 0;
+}
+
+static KeysymPages *
+clutter_keysym_get_pages (gboolean reverse)
+{
+  static volatile gsize keysym_pages = 0;
+  static volatile gsize unicode_pages = 0;
+  volatile gsize *pages = reverse ? &unicode_pages : &keysym_pages;
+
+  if (g_once_init_enter (pages))
+    g_once_init_leave (pages, (gsize) clutter_keysym_pages_new (reverse));
+
+  return (KeysymPages *) *pages;
+}
+
 /**
  * clutter_keysym_to_unicode:
  * @keyval: a key symbol
@@ -839,10 +907,6 @@ static const int clutter_keysym_to_unicode_tab_size =
 guint32
 clutter_keysym_to_unicode (guint keyval)
 {
-  int min = 0;
-  int max = clutter_keysym_to_unicode_tab_size - 1;
-  int mid;
-
   /* First check for Latin-1 characters (1:1 mapping) */
   if ((keyval >= 0x0020 && keyval <= 0x007e) ||
       (keyval >= 0x00a0 && keyval <= 0x00ff))
@@ -852,22 +916,39 @@ clutter_keysym_to_unicode (guint keyval)
   if ((keyval & 0xff000000) == 0x01000000)
     return keyval & 0x00ffffff;
 
-  /* binary search in table */
-  while (max >= min)
-    {
-      mid = (min + max) / 2;
+  /* the remaining key symbols are looked up in the table; a return
+   * value of 0 means no matching Unicode value was found */
+  return clutter_keysym_pages_lookup (clutter_keysym_get_pages (FALSE),
+                                      keyval);
+}
 
-      if (clutter_keysym_to_unicode_tab[mid].keysym < keyval)
-        min = mid + 1;
-      else if (clutter_keysym_to_unicode_tab[mid].keysym > keyval)
-        max = mid - 1;
-      else
-        {
-          /* found it */
-          return clutter_keysym_to_unicode_tab[mid].ucs;
-        }
-    }
+/**
+ * clutter_unicode_to_keysym:
+ * @wc: a ISO10646 (Unicode) character
+ *
+ * Converts @wc from a Unicode character to the corresponding Clutter
+ * key symbol.
+ *
+ * Return value: the key symbol; characters without a specific key
+ *   symbol are returned using the direct encoding of Unicode in key
+ *   symbols, that is @wc | 0x01000000
+ *
+ * Since: 1.8
+ */
+guint
+clutter_unicode_to_keysym (guint32 wc)
+{
+  guint keyval;
+
+  /* First check for Latin-1 characters (1:1 mapping) */
+  if ((wc >= 0x0020 && wc <= 0x007e) ||
+      (wc >= 0x00a0 && wc <= 0x00ff))
+    return wc;
+
+  keyval = clutter_keysym_pages_lookup (clutter_keysym_get_pages (TRUE), wc);
+  if (keyval != 0)
+    return keyval;
 
-  /* No matching Unicode value found */
-  return 0;
+  /* Use the directly encoded 24-bit UCS character */
+  return wc | 0x01000000;
 }
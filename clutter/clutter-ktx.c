@@ -0,0 +1,887 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2011 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * ClutterKtxImage: loader for KTX texture containers
+ *
+ * KTX files contain the pixel data of all the mipmap levels of a texture
+ * in the layout expected by glTexImage2D() and glCompressedTexImage2D(),
+ * which makes it possible to ship textures in the compressed formats
+ * supported by the GPU. The images are parsed without any GL call, so
+ * that they can be loaded from a thread; the upload is done by
+ * _clutter_ktx_image_upload(), which falls back to decoding the first
+ * level on the CPU if the driver does not support the format.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <stdio.h>
+
+#include <glib/gstdio.h>
+
+#include "clutter-ktx.h"
+
+#include "clutter-debug.h"
+#include "clutter-private.h"
+#include "clutter-texture.h"
+
+#define KTX_HEADER_SIZE         64
+#define KTX_ENDIANNESS          0x04030201
+#define KTX_MAX_LEVELS          32
+
+/* the values of the GL enumerations stored in the KTX header */
+#define KTX_GL_UNSIGNED_BYTE                    0x1401
+#define KTX_GL_RGB                              0x1907
+#define KTX_GL_RGBA                             0x1908
+#define KTX_GL_COMPRESSED_RGB_S3TC_DXT1         0x83F0
+#define KTX_GL_COMPRESSED_RGBA_S3TC_DXT1        0x83F1
+#define KTX_GL_COMPRESSED_RGBA_S3TC_DXT3        0x83F2
+#define KTX_GL_COMPRESSED_RGBA_S3TC_DXT5        0x83F3
+#define KTX_GL_ETC1_RGB8                        0x8D64
+
+static const guint8 ktx_identifier[12] = {
+  0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'
+};
+
+typedef struct _KtxHeader
+{
+  guint32 endianness;
+  guint32 gl_type;
+  guint32 gl_type_size;
+  guint32 gl_format;
+  guint32 gl_internal_format;
+  guint32 gl_base_internal_format;
+  guint32 pixel_width;
+  guint32 pixel_height;
+  guint32 pixel_depth;
+  guint32 n_array_elements;
+  guint32 n_faces;
+  guint32 n_mipmap_levels;
+  guint32 bytes_of_key_value_data;
+} KtxHeader;
+
+struct _ClutterKtxImage
+{
+  gchar *contents;
+
+  gboolean swap_bytes;
+
+  guint32 gl_type;
+  guint32 gl_format;
+  guint32 gl_internal_format;
+
+  gint width;
+  gint height;
+
+  guint n_levels;
+  const guint8 *level_data[KTX_MAX_LEVELS];
+  guint32 level_size[KTX_MAX_LEVELS];
+};
+
+static inline guint32
+ktx_read_uint32 (const guint8 *data,
+                 gboolean      swap_bytes)
+{
+  guint32 value;
+
+  memcpy (&value, data, sizeof (guint32));
+
+  return swap_bytes ? GUINT32_SWAP_LE_BE (value) : value;
+}
+
+/* parses the header in @data, which must be at least KTX_HEADER_SIZE
+ * bytes long; returns FALSE if the data is not a KTX file */
+static gboolean
+ktx_parse_header (const guint8 *data,
+                  KtxHeader    *header,
+                  gboolean     *swap_bytes)
+{
+  guint32 *fields = (guint32 *) header;
+  guint i;
+
+  if (memcmp (data, ktx_identifier, sizeof (ktx_identifier)) != 0)
+    return FALSE;
+
+  data += sizeof (ktx_identifier);
+
+  *swap_bytes = ktx_read_uint32 (data, FALSE) != KTX_ENDIANNESS;
+
+  for (i = 0; i < sizeof (KtxHeader) / sizeof (guint32); i++)
+    fields[i] = ktx_read_uint32 (data + i * sizeof (guint32), *swap_bytes);
+
+  return header->endianness == KTX_ENDIANNESS;
+}
+
+static gboolean
+ktx_read_header (const gchar *filename,
+                 KtxHeader   *header,
+                 gboolean    *swap_bytes)
+{
+  guint8 data[KTX_HEADER_SIZE];
+  gboolean res;
+  FILE *file;
+
+  file = g_fopen (filename, "rb");
+  if (file == NULL)
+    return FALSE;
+
+  res = fread (data, 1, KTX_HEADER_SIZE, file) == KTX_HEADER_SIZE &&
+        ktx_parse_header (data, header, swap_bytes);
+
+  fclose (file);
+
+  return res;
+}
+
+/* returns the size of a 4x4 block for the compressed formats, or 0 */
+static guint
+ktx_get_block_size (guint32 gl_internal_format)
+{
+  switch (gl_internal_format)
+    {
+    case KTX_GL_ETC1_RGB8:
+    case KTX_GL_COMPRESSED_RGB_S3TC_DXT1:
+    case KTX_GL_COMPRESSED_RGBA_S3TC_DXT1:
+      return 8;
+
+    case KTX_GL_COMPRESSED_RGBA_S3TC_DXT3:
+    case KTX_GL_COMPRESSED_RGBA_S3TC_DXT5:
+      return 16;
+
+    default:
+      return 0;
+    }
+}
+
+static gboolean
+ktx_format_has_alpha (guint32 gl_internal_format)
+{
+  return gl_internal_format == KTX_GL_COMPRESSED_RGBA_S3TC_DXT1 ||
+         gl_internal_format == KTX_GL_COMPRESSED_RGBA_S3TC_DXT3 ||
+         gl_internal_format == KTX_GL_COMPRESSED_RGBA_S3TC_DXT5 ||
+         gl_internal_format == KTX_GL_RGBA;
+}
+
+/* returns the minimum size of the data for the first level */
+static gsize
+ktx_image_get_level_0_size (ClutterKtxImage *image)
+{
+  guint block_size;
+
+  if (image->gl_type == 0)
+    {
+      block_size = ktx_get_block_size (image->gl_internal_format);
+
+      return (gsize) ((image->width + 3) / 4)
+           * ((image->height + 3) / 4)
+           * block_size;
+    }
+  else
+    {
+      guint bpp = image->gl_format == KTX_GL_RGBA ? 4 : 3;
+
+      /* rows are padded to 4 bytes */
+      return (gsize) ((image->width * bpp + 3) & ~3) * image->height;
+    }
+}
+
+/*< private >
+ * _clutter_ktx_get_size_from_file:
+ * @filename: the file to read
+ * @width: (out): return location for the width of the image
+ * @height: (out): return location for the height of the image
+ *
+ * Reads the size of the image stored in @filename, if it is a KTX
+ * file.
+ *
+ * Return value: %TRUE if @filename is a KTX file
+ */
+gboolean
+_clutter_ktx_get_size_from_file (const gchar *filename,
+                                 gint        *width,
+                                 gint        *height)
+{
+  KtxHeader header;
+  gboolean swap_bytes;
+
+  if (!ktx_read_header (filename, &header, &swap_bytes))
+    return FALSE;
+
+  *width = header.pixel_width;
+  *height = MAX (header.pixel_height, 1);
+
+  return TRUE;
+}
+
+/*< private >
+ * _clutter_ktx_image_new_from_file:
+ * @filename: the file to load
+ * @error: return location for a #GError, or %NULL
+ *
+ * Loads the KTX container stored in @filename. This function does not
+ * call into GL, so it is safe to call it from any thread.
+ *
+ * Return value: the newly loaded image, or %NULL. If @filename is not
+ *   a KTX file, %NULL is returned and @error is left unset
+ */
+ClutterKtxImage *
+_clutter_ktx_image_new_from_file (const gchar  *filename,
+                                  GError      **error)
+{
+  ClutterKtxImage *image;
+  KtxHeader header;
+  const guint8 *data, *end;
+  gboolean swap_bytes;
+  gchar *contents;
+  gsize length;
+  guint i;
+
+  if (!ktx_read_header (filename, &header, &swap_bytes))
+    return NULL;
+
+  if (header.pixel_depth > 1 ||
+      header.n_array_elements > 0 ||
+      header.n_faces != 1 ||
+      header.pixel_width == 0 ||
+      (header.gl_type == 0 &&
+       ktx_get_block_size (header.gl_internal_format) == 0) ||
+      (header.gl_type != 0 &&
+       (header.gl_type != KTX_GL_UNSIGNED_BYTE ||
+        (header.gl_format != KTX_GL_RGB &&
+         header.gl_format != KTX_GL_RGBA))))
+    {
+      g_set_error (error, CLUTTER_TEXTURE_ERROR,
+                   CLUTTER_TEXTURE_ERROR_BAD_FORMAT,
+                   "The KTX file '%s' uses an unsupported format",
+                   filename);
+      return NULL;
+    }
+
+  if (!g_file_get_contents (filename, &contents, &length, error))
+    return NULL;
+
+  image = g_slice_new0 (ClutterKtxImage);
+  image->contents = contents;
+  image->swap_bytes = swap_bytes;
+  image->gl_type = header.gl_type;
+  image->gl_format = header.gl_format;
+  image->gl_internal_format = header.gl_internal_format;
+  image->width = header.pixel_width;
+  image->height = MAX (header.pixel_height, 1);
+
+  /* the file might have changed after reading the header */
+  if (length < KTX_HEADER_SIZE)
+    goto truncated;
+
+  data = (const guint8 *) contents + KTX_HEADER_SIZE;
+  end = (const guint8 *) contents + length;
+
+  if (header.bytes_of_key_value_data > (gsize) (end - data))
+    goto truncated;
+
+  data += header.bytes_of_key_value_data;
+
+  for (i = 0; i < MAX (header.n_mipmap_levels, 1) && i < KTX_MAX_LEVELS; i++)
+    {
+      guint32 size;
+
+      if (end - data < 4)
+        goto truncated;
+
+      size = ktx_read_uint32 (data, swap_bytes);
+      data += 4;
+
+      if (size > (gsize) (end - data))
+        goto truncated;
+
+      image->level_data[i] = data;
+      image->level_size[i] = size;
+      image->n_levels += 1;
+
+      /* each level is padded to 4 bytes */
+      data += (size + 3) & ~3;
+
+      if (data > end)
+        data = end;
+    }
+
+  if (image->level_size[0] < ktx_image_get_level_0_size (image))
+    goto truncated;
+
+  CLUTTER_NOTE (TEXTURE, "Loaded the KTX file '%s' (%dx%d, 0x%x, %d levels)",
+                filename,
+                image->width,
+                image->height,
+                image->gl_type == 0 ? image->gl_internal_format
+                                    : image->gl_format,
+                image->n_levels);
+
+  return image;
+
+truncated:
+  g_set_error (error, CLUTTER_TEXTURE_ERROR,
+               CLUTTER_TEXTURE_ERROR_BAD_FORMAT,
+               "The KTX file '%s' is truncated",
+               filename);
+
+  _clutter_ktx_image_free (image);
+
+  return NULL;
+}
+
+void
+_clutter_ktx_image_free (ClutterKtxImage *image)
+{
+  if (image == NULL)
+    return;
+
+  g_free (image->contents);
+
+  g_slice_free (ClutterKtxImage, image);
+}
+
+/*< private >
+ * _clutter_ktx_image_get_data_size:
+ * @image: a #ClutterKtxImage
+ *
+ * Retrieves the number of bytes of pixel data of all the levels of
+ * @image.
+ *
+ * Return value: the size of the pixel data
+ */
+gsize
+_clutter_ktx_image_get_data_size (ClutterKtxImage *image)
+{
+  gsize size = 0;
+  guint i;
+
+  for (i = 0; i < image->n_levels; i++)
+    size += image->level_size[i];
+
+  return size;
+}
+
+/*
+ * Software decoding of the compressed formats
+ */
+
+static const gint etc1_modifiers[8][2] = {
+  {  2,   8 }, {  5,  17 }, {  9,  29 }, { 13,  42 },
+  { 18,  60 }, { 24,  80 }, { 33, 106 }, { 47, 183 }
+};
+
+static inline guint8
+clamp_to_byte (gint value)
+{
+  return CLAMP (value, 0, 255);
+}
+
+static void
+etc1_decode_block (const guint8 *block,
+                   guint8        pixels[16][4])
+{
+  guint32 high, low;
+  gint base[2][3];
+  guint tables[2];
+  gboolean flip;
+  gint x, y;
+
+  high = ((guint32) block[0] << 24) | (block[1] << 16) |
+         (block[2] << 8) | block[3];
+  low = ((guint32) block[4] << 24) | (block[5] << 16) |
+        (block[6] << 8) | block[7];
+
+  if (high & 2)
+    {
+      /* differential mode: 5 bit base colour and 3 bit signed delta */
+      for (x = 0; x < 3; x++)
+        {
+          gint c = (high >> (27 - x * 8)) & 0x1f;
+          gint d = (high >> (24 - x * 8)) & 0x7;
+
+          if (d >= 4)
+            d -= 8;
+
+          base[0][x] = (c << 3) | (c >> 2);
+          base[1][x] = (((c + d) & 0x1f) << 3) | (((c + d) & 0x1f) >> 2);
+        }
+    }
+  else
+    {
+      /* individual mode: two 4 bit colours */
+      for (x = 0; x < 3; x++)
+        {
+          base[0][x] = ((high >> (28 - x * 8)) & 0xf) * 17;
+          base[1][x] = ((high >> (24 - x * 8)) & 0xf) * 17;
+        }
+    }
+
+  tables[0] = (high >> 5) & 0x7;
+  tables[1] = (high >> 2) & 0x7;
+  flip = high & 1;
+
+  for (y = 0; y < 4; y++)
+    for (x = 0; x < 4; x++)
+      {
+        guint bit = x * 4 + y;
+        guint sub_block = flip ? (y >= 2) : (x >= 2);
+        guint msb = (low >> (bit + 16)) & 1;
+        guint lsb = (low >> bit) & 1;
+        gint modifier;
+        guint8 *pixel = pixels[y * 4 + x];
+
+        modifier = etc1_modifiers[tables[sub_block]][lsb];
+        if (msb)
+          modifier = -modifier;
+
+        pixel[0] = clamp_to_byte (base[sub_block][0] + modifier);
+        pixel[1] = clamp_to_byte (base[sub_block][1] + modifier);
+        pixel[2] = clamp_to_byte (base[sub_block][2] + modifier);
+        pixel[3] = 0xff;
+      }
+}
+
+static inline void
+rgb565_to_rgba (guint16 color,
+                guint8  rgba[4])
+{
+  guint r = (color >> 11) & 0x1f;
+  guint g = (color >> 5) & 0x3f;
+  guint b = color & 0x1f;
+
+  rgba[0] = (r << 3) | (r >> 2);
+  rgba[1] = (g << 2) | (g >> 4);
+  rgba[2] = (b << 3) | (b >> 2);
+  rgba[3] = 0xff;
+}
+
+static void
+dxt_decode_color_block (const guint8 *block,
+                        gboolean      allow_transparent,
+                        guint8        pixels[16][4])
+{
+  guint8 colors[4][4];
+  guint16 c0, c1;
+  guint32 indices;
+  guint i;
+
+  c0 = block[0] | (block[1] << 8);
+  c1 = block[2] | (block[3] << 8);
+  indices = block[4] | (block[5] << 8) | (block[6] << 16) |
+            ((guint32) block[7] << 24);
+
+  rgb565_to_rgba (c0, colors[0]);
+  rgb565_to_rgba (c1, colors[1]);
+
+  for (i = 0; i < 3; i++)
+    {
+      if (c0 > c1 || !allow_transparent)
+        {
+          colors[2][i] = (2 * colors[0][i] + colors[1][i]) / 3;
+          colors[3][i] = (colors[0][i] + 2 * colors[1][i]) / 3;
+        }
+      else
+        {
+          colors[2][i] = (colors[0][i] + colors[1][i]) / 2;
+          colors[3][i] = 0;
+        }
+    }
+
+  colors[2][3] = 0xff;
+  colors[3][3] = (c0 > c1 || !allow_transparent) ? 0xff : 0;
+
+  for (i = 0; i < 16; i++)
+    memcpy (pixels[i], colors[(indices >> (i * 2)) & 0x3], 4);
+}
+
+static void
+dxt3_decode_alpha_block (const guint8 *block,
+                         guint8        pixels[16][4])
+{
+  guint i;
+
+  for (i = 0; i < 16; i++)
+    {
+      guint a = (block[i / 2] >> ((i % 2) * 4)) & 0xf;
+
+      pixels[i][3] = a * 17;
+    }
+}
+
+static void
+dxt5_decode_alpha_block (const guint8 *block,
+                         guint8        pixels[16][4])
+{
+  guint8 alphas[8];
+  guint64 indices = 0;
+  guint i;
+
+  alphas[0] = block[0];
+  alphas[1] = block[1];
+
+  if (alphas[0] > alphas[1])
+    {
+      for (i = 1; i < 7; i++)
+        alphas[i + 1] = ((7 - i) * alphas[0] + i * alphas[1]) / 7;
+    }
+  else
+    {
+      for (i = 1; i < 5; i++)
+        alphas[i + 1] = ((5 - i) * alphas[0] + i * alphas[1]) / 5;
+
+      alphas[6] = 0;
+      alphas[7] = 0xff;
+    }
+
+  for (i = 0; i < 6; i++)
+    indices |= (guint64) block[2 + i] << (i * 8);
+
+  for (i = 0; i < 16; i++)
+    pixels[i][3] = alphas[(indices >> (i * 3)) & 0x7];
+}
+
+/* decodes the first level of a compressed image into RGBA pixels */
+static guint8 *
+ktx_image_decode (ClutterKtxImage *image)
+{
+  const guint8 *block = image->level_data[0];
+  guint block_size = ktx_get_block_size (image->gl_internal_format);
+  gint rowstride = image->width * 4;
+  guint8 *data;
+  gint bx, by;
+
+  data = g_malloc (rowstride * image->height);
+
+  for (by = 0; by < image->height; by += 4)
+    for (bx = 0; bx < image->width; bx += 4)
+      {
+        guint8 pixels[16][4];
+        gint x, y;
+
+        switch (image->gl_internal_format)
+          {
+          case KTX_GL_ETC1_RGB8:
+            etc1_decode_block (block, pixels);
+            break;
+
+          case KTX_GL_COMPRESSED_RGB_S3TC_DXT1:
+            dxt_decode_color_block (block, FALSE, pixels);
+            break;
+
+          case KTX_GL_COMPRESSED_RGBA_S3TC_DXT1:
+            dxt_decode_color_block (block, TRUE, pixels);
+            break;
+
+          case KTX_GL_COMPRESSED_RGBA_S3TC_DXT3:
+            dxt_decode_color_block (block + 8, FALSE, pixels);
+            dxt3_decode_alpha_block (block, pixels);
+            break;
+
+          case KTX_GL_COMPRESSED_RGBA_S3TC_DXT5:
+            dxt_decode_color_block (block + 8, FALSE, pixels);
+            dxt5_decode_alpha_block (block, pixels);
+            break;
+
+          default:
+            g_assert_not_reached ();
+          }
+
+        for (y = 0; y < 4 && by + y < image->height; y++)
+          for (x = 0; x < 4 && bx + x < image->width; x++)
+            memcpy (data + (by + y) * rowstride + (bx + x) * 4,
+                    pixels[y * 4 + x],
+                    4);
+
+        block += block_size;
+      }
+
+  return data;
+}
+
+/*
+ * Upload of the compressed levels
+ */
+
+#ifdef COGL_HAS_GL
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+#ifndef GL_TEXTURE_BINDING_2D
+#define GL_TEXTURE_BINDING_2D   0x8069
+#endif
+#ifndef GL_TEXTURE_MAX_LEVEL
+#define GL_TEXTURE_MAX_LEVEL    0x813D
+#endif
+
+typedef const GLubyte * (APIENTRY *GetStringFunc)          (GLenum        name);
+typedef void      (APIENTRY *GetIntegervFunc)              (GLenum        pname,
+                                                            GLint        *params);
+typedef void      (APIENTRY *GenTexturesFunc)              (GLsizei       n,
+                                                            GLuint       *textures);
+typedef void      (APIENTRY *DeleteTexturesFunc)           (GLsizei       n,
+                                                            const GLuint *textures);
+typedef void      (APIENTRY *BindTextureFunc)              (GLenum        target,
+                                                            GLuint        texture);
+typedef void      (APIENTRY *TexParameteriFunc)            (GLenum        target,
+                                                            GLenum        pname,
+                                                            GLint         param);
+typedef void      (APIENTRY *CompressedTexImage2DFunc)     (GLenum        target,
+                                                            GLint         level,
+                                                            GLenum        internal_format,
+                                                            GLsizei       width,
+                                                            GLsizei       height,
+                                                            GLint         border,
+                                                            GLsizei       image_size,
+                                                            const GLvoid *data);
+typedef GLenum    (APIENTRY *GetErrorFunc)                 (void);
+
+typedef struct _KtxUploadFuncs
+{
+  GetStringFunc get_string;
+  GetIntegervFunc get_integerv;
+  GenTexturesFunc gen_textures;
+  DeleteTexturesFunc delete_textures;
+  BindTextureFunc bind_texture;
+  TexParameteriFunc tex_parameteri;
+  CompressedTexImage2DFunc compressed_tex_image_2d;
+  GetErrorFunc get_error;
+
+  gboolean has_s3tc;
+  gboolean has_etc1;
+} KtxUploadFuncs;
+
+/* Returns the GL entry points needed to upload compressed textures,
+ * or %NULL if the driver does not support it */
+static const KtxUploadFuncs *
+get_ktx_upload_funcs (void)
+{
+  static KtxUploadFuncs funcs = { NULL, };
+  static gboolean initialized = FALSE;
+  static gboolean supported = FALSE;
+  const gchar *extensions;
+
+  if (G_LIKELY (initialized))
+    return supported ? &funcs : NULL;
+
+  initialized = TRUE;
+
+#define GET_FUNC(field,type,name) \
+  funcs.field = (type) cogl_get_proc_address (name); \
+  if (funcs.field == NULL) \
+    return NULL;
+
+  GET_FUNC (get_string, GetStringFunc, "glGetString");
+  GET_FUNC (get_integerv, GetIntegervFunc, "glGetIntegerv");
+  GET_FUNC (gen_textures, GenTexturesFunc, "glGenTextures");
+  GET_FUNC (delete_textures, DeleteTexturesFunc, "glDeleteTextures");
+  GET_FUNC (bind_texture, BindTextureFunc, "glBindTexture");
+  GET_FUNC (tex_parameteri, TexParameteriFunc, "glTexParameteri");
+  GET_FUNC (compressed_tex_image_2d, CompressedTexImage2DFunc,
+            "glCompressedTexImage2D");
+  GET_FUNC (get_error, GetErrorFunc, "glGetError");
+
+#undef GET_FUNC
+
+  extensions = (const gchar *) funcs.get_string (GL_EXTENSIONS);
+  if (extensions == NULL)
+    return NULL;
+
+  funcs.has_s3tc =
+    cogl_check_extension ("GL_EXT_texture_compression_s3tc", extensions);
+  funcs.has_etc1 =
+    cogl_check_extension ("GL_OES_compressed_ETC1_RGB8_texture", extensions);
+
+  supported = TRUE;
+
+  CLUTTER_NOTE (TEXTURE, "Compressed textures: S3TC %s, ETC1 %s",
+                funcs.has_s3tc ? "supported" : "not supported",
+                funcs.has_etc1 ? "supported" : "not supported");
+
+  return &funcs;
+}
+
+static CoglUserDataKey ktx_gl_texture_key;
+
+static void
+ktx_gl_texture_destroy (gpointer user_data)
+{
+  const KtxUploadFuncs *funcs = get_ktx_upload_funcs ();
+  GLuint gl_texture = GPOINTER_TO_UINT (user_data);
+
+  /* foreign textures are not deleted by Cogl */
+  funcs->delete_textures (1, &gl_texture);
+}
+
+static CoglHandle
+ktx_image_upload_compressed (ClutterKtxImage *image)
+{
+  const KtxUploadFuncs *funcs = get_ktx_upload_funcs ();
+  CoglHandle texture;
+  CoglPixelFormat format;
+  GLint old_binding = 0;
+  GLuint gl_texture;
+  gboolean failed = FALSE;
+  guint i;
+
+  if (funcs == NULL)
+    return COGL_INVALID_HANDLE;
+
+  if (image->gl_internal_format == KTX_GL_ETC1_RGB8)
+    {
+      if (!funcs->has_etc1)
+        return COGL_INVALID_HANDLE;
+    }
+  else if (!funcs->has_s3tc)
+    return COGL_INVALID_HANDLE;
+
+  /* clear any error left around, so that the check after the upload
+   * only catches the errors it caused */
+  while (funcs->get_error () != GL_NO_ERROR)
+    ;
+
+  /* Cogl caches the texture bound to each unit, so we restore the
+   * previous binding once we're done */
+  funcs->get_integerv (GL_TEXTURE_BINDING_2D, &old_binding);
+
+  funcs->gen_textures (1, &gl_texture);
+  funcs->bind_texture (GL_TEXTURE_2D, gl_texture);
+
+  for (i = 0; i < image->n_levels; i++)
+    {
+      gint width = MAX (image->width >> i, 1);
+      gint height = MAX (image->height >> i, 1);
+
+      funcs->compressed_tex_image_2d (GL_TEXTURE_2D, i,
+                                      image->gl_internal_format,
+                                      width, height,
+                                      0,
+                                      image->level_size[i],
+                                      image->level_data[i]);
+    }
+
+  /* only the levels in the file are available, so the texture must
+   * not sample the missing ones */
+  funcs->tex_parameteri (GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,
+                         image->n_levels - 1);
+
+  if (funcs->get_error () != GL_NO_ERROR)
+    failed = TRUE;
+
+  funcs->bind_texture (GL_TEXTURE_2D, old_binding);
+
+  if (failed)
+    {
+      funcs->delete_textures (1, &gl_texture);
+      return COGL_INVALID_HANDLE;
+    }
+
+  if (ktx_format_has_alpha (image->gl_internal_format))
+    format = COGL_PIXEL_FORMAT_RGBA_8888_PRE;
+  else
+    format = COGL_PIXEL_FORMAT_RGB_888;
+
+  texture = cogl_texture_new_from_foreign (gl_texture, GL_TEXTURE_2D,
+                                           image->width, image->height,
+                                           0, 0,
+                                           format);
+  if (texture == COGL_INVALID_HANDLE)
+    {
+      funcs->delete_textures (1, &gl_texture);
+      return COGL_INVALID_HANDLE;
+    }
+
+  cogl_object_set_user_data (texture, &ktx_gl_texture_key,
+                             GUINT_TO_POINTER (gl_texture),
+                             ktx_gl_texture_destroy);
+
+  return texture;
+}
+
+#endif /* COGL_HAS_GL */
+
+/*< private >
+ * _clutter_ktx_image_upload:
+ * @image: a #ClutterKtxImage
+ * @flags: the flags for the new texture
+ *
+ * Creates a Cogl texture from @image. Compressed images are uploaded
+ * as they are, together with all their levels, if the driver supports
+ * their format; otherwise, the first level is decoded and uploaded as
+ * an uncompressed image.
+ *
+ * Since the compressed formats are uploaded as they are, the colors of
+ * the formats with an alpha channel are expected to be premultiplied.
+ *
+ * This function must be called from the thread owning the GL context.
+ *
+ * Return value: a handle for the new texture, or %COGL_INVALID_HANDLE
+ */
+CoglHandle
+_clutter_ktx_image_upload (ClutterKtxImage  *image,
+                           CoglTextureFlags  flags)
+{
+  CoglHandle texture;
+  CoglPixelFormat internal_format;
+  guint8 *data;
+
+  if (image->gl_type != 0)
+    {
+      gint bpp = image->gl_format == KTX_GL_RGBA ? 4 : 3;
+
+      return cogl_texture_new_from_data (image->width, image->height,
+                                         flags,
+                                         bpp == 4 ? COGL_PIXEL_FORMAT_RGBA_8888
+                                                  : COGL_PIXEL_FORMAT_RGB_888,
+                                         COGL_PIXEL_FORMAT_ANY,
+                                         (image->width * bpp + 3) & ~3,
+                                         image->level_data[0]);
+    }
+
+#ifdef COGL_HAS_GL
+  texture = ktx_image_upload_compressed (image);
+  if (texture != COGL_INVALID_HANDLE)
+    return texture;
+#endif
+
+  CLUTTER_NOTE (TEXTURE, "Decoding the compressed format 0x%x on the CPU",
+                image->gl_internal_format);
+
+  if (ktx_format_has_alpha (image->gl_internal_format))
+    internal_format = COGL_PIXEL_FORMAT_RGBA_8888_PRE;
+  else
+    internal_format = COGL_PIXEL_FORMAT_RGB_888;
+
+  data = ktx_image_decode (image);
+
+  texture = cogl_texture_new_from_data (image->width, image->height,
+                                        flags,
+                                        COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                        internal_format,
+                                        image->width * 4,
+                                        data);
+
+  g_free (data);
+
+  return texture;
+}
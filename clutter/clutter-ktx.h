@@ -0,0 +1,48 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2011 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * ClutterKtxImage: loader for KTX texture containers
+ */
+
+#ifndef __CLUTTER_KTX_H__
+#define __CLUTTER_KTX_H__
+
+#include <glib.h>
+#include <cogl/cogl.h>
+
+G_BEGIN_DECLS
+
+typedef struct _ClutterKtxImage ClutterKtxImage;
+
+gboolean          _clutter_ktx_get_size_from_file (const gchar      *filename,
+                                                   gint             *width,
+                                                   gint             *height);
+
+ClutterKtxImage * _clutter_ktx_image_new_from_file (const gchar     *filename,
+                                                    GError         **error);
+void              _clutter_ktx_image_free          (ClutterKtxImage *image);
+
+gsize             _clutter_ktx_image_get_data_size (ClutterKtxImage *image);
+CoglHandle        _clutter_ktx_image_upload        (ClutterKtxImage *image,
+                                                    CoglTextureFlags flags);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_KTX_H__ */
@@ -289,6 +289,7 @@
 #include <glib-object.h>
 #include <gobject/gvaluecollector.h>
 
+#include "clutter-actor-private.h"
 #include "clutter-alpha.h"
 #include "clutter-debug.h"
 #include "clutter-layout-manager.h"
@@ -315,13 +316,20 @@ G_DEFINE_ABSTRACT_TYPE (ClutterLayoutManager,
                         clutter_layout_manager,
                         G_TYPE_INITIALLY_UNOWNED);
 
-static GQuark quark_layout_meta  = 0;
 static GQuark quark_layout_alpha = 0;
 
 static guint manager_signals[LAST_SIGNAL] = { 0, };
 
-static void
-layout_manager_freeze_layout_change (ClutterLayoutManager *manager)
+/*< private >
+ * _clutter_layout_manager_freeze_layout_change:
+ * @manager: a #ClutterLayoutManager
+ *
+ * Suppresses the emission of the #ClutterLayoutManager::layout-changed
+ * signal until _clutter_layout_manager_thaw_layout_change() is called.
+ * Freezing can be nested.
+ */
+void
+_clutter_layout_manager_freeze_layout_change (ClutterLayoutManager *manager)
 {
   gpointer is_frozen;
 
@@ -342,8 +350,17 @@ layout_manager_freeze_layout_change (ClutterLayoutManager *manager)
     }
 }
 
-static void
-layout_manager_thaw_layout_change (ClutterLayoutManager *manager)
+/*< private >
+ * _clutter_layout_manager_thaw_layout_change:
+ * @manager: a #ClutterLayoutManager
+ *
+ * Reverts the effect of a previous call to
+ * _clutter_layout_manager_freeze_layout_change(). The changes that
+ * happened while @manager was frozen are not replayed: the caller is
+ * responsible for queueing a relayout on the container
+ */
+void
+_clutter_layout_manager_thaw_layout_change (ClutterLayoutManager *manager)
 {
   gpointer is_frozen;
 
@@ -539,8 +556,6 @@ layout_manager_real_end_animation (ClutterLayoutManager *manager)
 static void
 clutter_layout_manager_class_init (ClutterLayoutManagerClass *klass)
 {
-  quark_layout_meta =
-    g_quark_from_static_string ("clutter-layout-manager-child-meta");
   quark_layout_alpha =
     g_quark_from_static_string ("clutter-layout-manager-alpha");
 
@@ -768,13 +783,13 @@ create_child_meta (ClutterLayoutManager *manager,
   ClutterLayoutManagerClass *klass;
   ClutterLayoutMeta *meta = NULL;
 
-  layout_manager_freeze_layout_change (manager);
+  _clutter_layout_manager_freeze_layout_change (manager);
 
   klass = CLUTTER_LAYOUT_MANAGER_GET_CLASS (manager);
   if (klass->get_child_meta_type (manager) != G_TYPE_INVALID)
     meta = klass->create_child_meta (manager, container, actor);
 
-  layout_manager_thaw_layout_change (manager);
+  _clutter_layout_manager_thaw_layout_change (manager);
 
   return meta;
 }
@@ -786,7 +801,7 @@ get_child_meta (ClutterLayoutManager *manager,
 {
   ClutterLayoutMeta *layout = NULL;
 
-  layout = g_object_get_qdata (G_OBJECT (actor), quark_layout_meta);
+  layout = _clutter_actor_get_layout_meta (actor);
   if (layout != NULL)
     {
       ClutterChildMeta *child = CLUTTER_CHILD_META (layout);
@@ -806,9 +821,7 @@ get_child_meta (ClutterLayoutManager *manager,
   if (layout != NULL)
     {
       g_assert (CLUTTER_IS_LAYOUT_META (layout));
-      g_object_set_qdata_full (G_OBJECT (actor), quark_layout_meta,
-                               layout,
-                               (GDestroyNotify) g_object_unref);
+      _clutter_actor_set_layout_meta (actor, layout);
       return layout;
     }
 
@@ -866,7 +879,38 @@ layout_set_property_internal (ClutterLayoutManager *manager,
       return FALSE;
     }
 
-  g_object_set_property (gobject, pspec->name, value);
+  /* the layout properties are usually defined by the final type of
+   * the meta; in that case we can skip the lookup of the property by
+   * name, and set it directly through the class that installed it
+   */
+  if (pspec->owner_type == G_OBJECT_TYPE (gobject) &&
+      G_VALUE_TYPE (value) == G_PARAM_SPEC_VALUE_TYPE (pspec))
+    {
+      GObjectClass *klass = G_OBJECT_GET_CLASS (gobject);
+      GValue tmp_value = { 0, };
+
+      g_value_init (&tmp_value, G_PARAM_SPEC_VALUE_TYPE (pspec));
+      g_value_copy (value, &tmp_value);
+
+      if (g_param_value_validate (pspec, &tmp_value) &&
+          !(pspec->flags & G_PARAM_LAX_VALIDATION))
+        {
+          g_warning ("%s: Value for the child property '%s' of the layout "
+                     "manager of type '%s' is out of range",
+                     G_STRLOC, pspec->name, G_OBJECT_TYPE_NAME (manager));
+          g_value_unset (&tmp_value);
+          return FALSE;
+        }
+
+      g_object_freeze_notify (gobject);
+      klass->set_property (gobject, pspec->param_id, &tmp_value, pspec);
+      g_object_notify_by_pspec (gobject, pspec);
+      g_object_thaw_notify (gobject);
+
+      g_value_unset (&tmp_value);
+    }
+  else
+    g_object_set_property (gobject, pspec->name, value);
 
   return TRUE;
 }
@@ -885,7 +929,17 @@ layout_get_property_internal (ClutterLayoutManager *manager,
       return FALSE;
     }
 
-  g_object_get_property (gobject, pspec->name, value);
+  /* see layout_set_property_internal() */
+  if (pspec->owner_type == G_OBJECT_TYPE (gobject) &&
+      G_VALUE_TYPE (value) == G_PARAM_SPEC_VALUE_TYPE (pspec))
+    {
+      GObjectClass *klass = G_OBJECT_GET_CLASS (gobject);
+
+      g_value_reset (value);
+      klass->get_property (gobject, pspec->param_id, value, pspec);
+    }
+  else
+    g_object_get_property (gobject, pspec->name, value);
 
   return TRUE;
 }
@@ -1178,6 +1232,115 @@ clutter_layout_manager_child_get_property (ClutterLayoutManager *manager,
   layout_get_property_internal (manager, G_OBJECT (meta), pspec, value);
 }
 
+/**
+ * clutter_layout_manager_child_set_pspec:
+ * @manager: a #ClutterLayoutManager
+ * @container: a #ClutterContainer using @manager
+ * @actor: a #ClutterActor child of @container
+ * @pspec: the #GParamSpec of a layout property, as returned by
+ *   clutter_layout_manager_find_child_property()
+ * @value: a #GValue with the value of the property to set
+ *
+ * Sets a property on the #ClutterLayoutMeta created by @manager and
+ * attached to a child of @container
+ *
+ * Unlike clutter_layout_manager_child_set_property(), the property
+ * is not looked up by name; when setting the same properties on many
+ * children, the #GParamSpec<!-- -->s should be retrieved only once.
+ * If the type of @value is the type of the property, the value is
+ * also not converted
+ *
+ * Since: 1.8
+ */
+void
+clutter_layout_manager_child_set_pspec (ClutterLayoutManager *manager,
+                                        ClutterContainer     *container,
+                                        ClutterActor         *actor,
+                                        GParamSpec           *pspec,
+                                        const GValue         *value)
+{
+  ClutterLayoutMeta *meta;
+
+  g_return_if_fail (CLUTTER_IS_LAYOUT_MANAGER (manager));
+  g_return_if_fail (CLUTTER_IS_CONTAINER (container));
+  g_return_if_fail (CLUTTER_IS_ACTOR (actor));
+  g_return_if_fail (G_IS_PARAM_SPEC (pspec));
+  g_return_if_fail (value != NULL);
+
+  meta = get_child_meta (manager, container, actor);
+  if (meta == NULL)
+    {
+      g_warning ("Layout managers of type '%s' do not support "
+                 "layout metadata",
+                 g_type_name (G_OBJECT_TYPE (manager)));
+      return;
+    }
+
+  if (!g_type_is_a (G_OBJECT_TYPE (meta), pspec->owner_type))
+    {
+      g_warning ("%s: Layout managers of type '%s' have no layout "
+                 "property named '%s'",
+                 G_STRLOC, G_OBJECT_TYPE_NAME (manager), pspec->name);
+      return;
+    }
+
+  layout_set_property_internal (manager, G_OBJECT (meta), pspec, value);
+}
+
+/**
+ * clutter_layout_manager_child_get_pspec:
+ * @manager: a #ClutterLayoutManager
+ * @container: a #ClutterContainer using @manager
+ * @actor: a #ClutterActor child of @container
+ * @pspec: the #GParamSpec of a layout property, as returned by
+ *   clutter_layout_manager_find_child_property()
+ * @value: a #GValue with the value of the property to get
+ *
+ * Gets a property on the #ClutterLayoutMeta created by @manager and
+ * attached to a child of @container, without looking it up by name;
+ * see clutter_layout_manager_child_set_pspec()
+ *
+ * The #GValue must already be initialized to the type of the property
+ * and has to be unset with g_value_unset() after extracting the real
+ * value out of it
+ *
+ * Since: 1.8
+ */
+void
+clutter_layout_manager_child_get_pspec (ClutterLayoutManager *manager,
+                                        ClutterContainer     *container,
+                                        ClutterActor         *actor,
+                                        GParamSpec           *pspec,
+                                        GValue               *value)
+{
+  ClutterLayoutMeta *meta;
+
+  g_return_if_fail (CLUTTER_IS_LAYOUT_MANAGER (manager));
+  g_return_if_fail (CLUTTER_IS_CONTAINER (container));
+  g_return_if_fail (CLUTTER_IS_ACTOR (actor));
+  g_return_if_fail (G_IS_PARAM_SPEC (pspec));
+  g_return_if_fail (value != NULL);
+
+  meta = get_child_meta (manager, container, actor);
+  if (meta == NULL)
+    {
+      g_warning ("Layout managers of type %s do not support "
+                 "layout metadata",
+                 g_type_name (G_OBJECT_TYPE (manager)));
+      return;
+    }
+
+  if (!g_type_is_a (G_OBJECT_TYPE (meta), pspec->owner_type))
+    {
+      g_warning ("%s: Layout managers of type '%s' have no layout "
+                 "property named '%s'",
+                 G_STRLOC, G_OBJECT_TYPE_NAME (manager), pspec->name);
+      return;
+    }
+
+  layout_get_property_internal (manager, G_OBJECT (meta), pspec, value);
+}
+
 /**
  * clutter_layout_manager_find_child_property:
  * @manager: a #ClutterLayoutManager
@@ -198,6 +198,16 @@ void               clutter_layout_manager_child_get_property    (ClutterLayoutMa
                                                                  ClutterActor           *actor,
                                                                  const gchar            *property_name,
                                                                  GValue                 *value);
+void               clutter_layout_manager_child_set_pspec       (ClutterLayoutManager   *manager,
+                                                                 ClutterContainer       *container,
+                                                                 ClutterActor           *actor,
+                                                                 GParamSpec             *pspec,
+                                                                 const GValue           *value);
+void               clutter_layout_manager_child_get_pspec       (ClutterLayoutManager   *manager,
+                                                                 ClutterContainer       *container,
+                                                                 ClutterActor           *actor,
+                                                                 GParamSpec             *pspec,
+                                                                 GValue                 *value);
 
 ClutterAlpha *     clutter_layout_manager_begin_animation       (ClutterLayoutManager   *manager,
                                                                  guint                   duration,
@@ -82,6 +82,18 @@ struct _ClutterListModelPrivate
 {
   GSequence *sequence;
 
+  /* the GSequenceIter of each row that passes the filter, in order;
+   * it is built the first time it's needed, and it is dropped each
+   * time the model or the filter change
+   */
+  GPtrArray *filter_index;
+  guint filter_stamp;
+
+  /* bumped each time the rows are added, removed or reordered, to
+   * tell whether the GSequenceIter kept by a cursor is still valid
+   */
+  guint stamp;
+
   ClutterModelIter *temp_iter;
 };
 
@@ -103,20 +115,66 @@ G_DEFINE_TYPE (ClutterListModelIter,
                CLUTTER_TYPE_MODEL_ITER);
 
 static void
-clutter_list_model_iter_get_value (ClutterModelIter *iter,
-                                   guint             column,
-                                   GValue           *value)
+clutter_list_model_invalidate_filter (ClutterListModel *model)
+{
+  ClutterListModelPrivate *priv = model->priv;
+
+  priv->stamp += 1;
+
+  if (priv->filter_index != NULL)
+    {
+      g_ptr_array_free (priv->filter_index, TRUE);
+      priv->filter_index = NULL;
+    }
+}
+
+static GPtrArray *
+clutter_list_model_get_filter_index (ClutterListModel *model)
+{
+  ClutterListModelPrivate *priv = model->priv;
+  GSequenceIter *seq_iter;
+  GPtrArray *filter_index;
+  guint stamp;
+
+  stamp = _clutter_model_get_filter_stamp (CLUTTER_MODEL (model));
+  if (stamp != priv->filter_stamp)
+    {
+      clutter_list_model_invalidate_filter (model);
+      priv->filter_stamp = stamp;
+    }
+
+  if (priv->filter_index != NULL)
+    return priv->filter_index;
+
+  filter_index = g_ptr_array_new ();
+
+  seq_iter = g_sequence_get_begin_iter (priv->sequence);
+  while (!g_sequence_iter_is_end (seq_iter))
+    {
+      CLUTTER_LIST_MODEL_ITER (priv->temp_iter)->seq_iter = seq_iter;
+
+      if (clutter_model_filter_iter (CLUTTER_MODEL (model), priv->temp_iter))
+        g_ptr_array_add (filter_index, seq_iter);
+
+      seq_iter = g_sequence_iter_next (seq_iter);
+    }
+
+  priv->filter_index = filter_index;
+
+  return priv->filter_index;
+}
+
+static void
+clutter_list_model_get_row_value (GSequenceIter *seq_iter,
+                                  guint          column,
+                                  GValue        *value)
 {
-  ClutterListModelIter *iter_default;
   GValueArray *value_array;
   GValue *iter_value;
   GValue real_value = { 0, };
   gboolean converted = FALSE;
 
-  iter_default = CLUTTER_LIST_MODEL_ITER (iter);
-  g_assert (iter_default->seq_iter != NULL);
-
-  value_array = g_sequence_get (iter_default->seq_iter);
+  value_array = g_sequence_get (seq_iter);
   iter_value = g_value_array_get_nth (value_array, column);
   g_assert (iter_value != NULL);
 
@@ -155,12 +213,26 @@ clutter_list_model_iter_get_value (ClutterModelIter *iter,
     g_value_copy (iter_value, value);
 }
 
+static void
+clutter_list_model_iter_get_value (ClutterModelIter *iter,
+                                   guint             column,
+                                   GValue           *value)
+{
+  ClutterListModelIter *iter_default;
+
+  iter_default = CLUTTER_LIST_MODEL_ITER (iter);
+  g_assert (iter_default->seq_iter != NULL);
+
+  clutter_list_model_get_row_value (iter_default->seq_iter, column, value);
+}
+
 static void
 clutter_list_model_iter_set_value (ClutterModelIter *iter,
                                    guint             column,
                                    const GValue     *value)
 {
   ClutterListModelIter *iter_default;
+  ClutterModel *model;
   GValueArray *value_array;
   GValue *iter_value;
   GValue real_value = { 0, };
@@ -206,6 +278,9 @@ clutter_list_model_iter_set_value (ClutterModelIter *iter,
     }
   else
     g_value_copy (value, iter_value);
+
+  model = clutter_model_iter_get_model (iter);
+  clutter_list_model_invalidate_filter (CLUTTER_LIST_MODEL (model));
 }
 
 static gboolean
@@ -440,51 +515,122 @@ clutter_list_model_get_iter_at_row (ClutterModel *model,
 {
   ClutterListModel *model_default = CLUTTER_LIST_MODEL (model);
   GSequence *sequence = model_default->priv->sequence;
-  GSequenceIter *filter_next;
-  gint seq_length = g_sequence_get_length (sequence);
   ClutterListModelIter *retval;
-  gint count = -1;
+  GSequenceIter *seq_iter;
+
+  /* short-circuit in case we don't have a filter in place */
+  if (!clutter_model_get_filter_set (model))
+    {
+      if (row >= g_sequence_get_length (sequence))
+        return NULL;
 
-  if (row >= seq_length)
-    return NULL;
+      seq_iter = g_sequence_get_iter_at_pos (sequence, row);
+    }
+  else
+    {
+      GPtrArray *filter_index;
+
+      filter_index = clutter_list_model_get_filter_index (model_default);
+      if (row >= filter_index->len)
+        return NULL;
+
+      seq_iter = g_ptr_array_index (filter_index, row);
+    }
 
   retval = g_object_new (CLUTTER_TYPE_LIST_MODEL_ITER,
                          "model", model,
                          "row", row,
                          NULL);
+  retval->seq_iter = seq_iter;
 
-  /* short-circuit in case we don't have a filter in place */
-  if (!clutter_model_get_filter_set (model))
-    {
-      retval->seq_iter = g_sequence_get_iter_at_pos (sequence, row);
+  return CLUTTER_MODEL_ITER (retval);
+}
 
-      return CLUTTER_MODEL_ITER (retval);
-    }
+/* the cursor keeps the GSequenceIter of its row in dummy1, the stamp
+ * of the rows in stamp and the stamp of the filter in dummy2
+ */
+static gboolean
+clutter_list_model_cursor_is_valid (ClutterModel       *model,
+                                    ClutterModelCursor *cursor)
+{
+  ClutterListModelPrivate *priv = CLUTTER_LIST_MODEL (model)->priv;
+  guint filter_stamp = _clutter_model_get_filter_stamp (model);
 
-  filter_next = g_sequence_get_begin_iter (sequence);
-  g_assert (filter_next != NULL);
+  return cursor->dummy1 != NULL &&
+         cursor->stamp == priv->stamp &&
+         GPOINTER_TO_UINT (cursor->dummy2) == filter_stamp;
+}
 
-  while (!g_sequence_iter_is_end (filter_next))
+static gboolean
+clutter_list_model_cursor_seek (ClutterModel       *model,
+                                ClutterModelCursor *cursor,
+                                guint               row)
+{
+  ClutterListModelPrivate *priv = CLUTTER_LIST_MODEL (model)->priv;
+  GSequenceIter *seq_iter;
+
+  if (!clutter_model_get_filter_set (model))
     {
-      retval->seq_iter = filter_next;
+      if (row >= g_sequence_get_length (priv->sequence))
+        return FALSE;
 
-      if (clutter_model_filter_iter (model, CLUTTER_MODEL_ITER (retval)))
+      /* stepping to an adjacent row does not need to walk the
+       * sequence from its root
+       */
+      if (clutter_list_model_cursor_is_valid (model, cursor))
         {
-          /* We've found a row that is valid under the filter */
-          count++;
-          if (count == row)
-            break;
+          seq_iter = cursor->dummy1;
+
+          if (row == cursor->row + 1)
+            seq_iter = g_sequence_iter_next (seq_iter);
+          else if (row + 1 == cursor->row)
+            seq_iter = g_sequence_iter_prev (seq_iter);
+          else if (row != cursor->row)
+            seq_iter = g_sequence_get_iter_at_pos (priv->sequence, row);
         }
+      else
+        seq_iter = g_sequence_get_iter_at_pos (priv->sequence, row);
+    }
+  else
+    {
+      GPtrArray *filter_index;
 
-      filter_next = g_sequence_iter_next (filter_next);
+      filter_index =
+        clutter_list_model_get_filter_index (CLUTTER_LIST_MODEL (model));
+      if (row >= filter_index->len)
+        return FALSE;
+
+      seq_iter = g_ptr_array_index (filter_index, row);
     }
 
-  if (count != row)
+  cursor->dummy1 = seq_iter;
+  cursor->dummy2 = GUINT_TO_POINTER (_clutter_model_get_filter_stamp (model));
+  cursor->stamp = priv->stamp;
+
+  return TRUE;
+}
+
+static void
+clutter_list_model_cursor_get_value (ClutterModel       *model,
+                                     ClutterModelCursor *cursor,
+                                     guint               column,
+                                     GValue             *value)
+{
+  /* the rows changed since the cursor was moved, so the cursor
+   * needs to find the row at its index again
+   */
+  if (!clutter_list_model_cursor_is_valid (model, cursor))
     {
-      g_object_unref (retval);
-      return NULL;
+      if (!clutter_list_model_cursor_seek (model, cursor, cursor->row))
+        {
+          g_warning ("%s: The row %u is not in the model anymore",
+                     G_STRLOC,
+                     cursor->row);
+          return;
+        }
     }
-  return CLUTTER_MODEL_ITER (retval);
+
+  clutter_list_model_get_row_value (cursor->dummy1, column, value);
 }
 
 static ClutterModelIter *
@@ -528,6 +674,8 @@ clutter_list_model_insert_row (ClutterModel *model,
       pos = index_;
     }
 
+  clutter_list_model_invalidate_filter (model_default);
+
   retval = g_object_new (CLUTTER_TYPE_LIST_MODEL_ITER,
                          "model", model,
                          "row", pos,
@@ -541,44 +689,22 @@ static void
 clutter_list_model_remove_row (ClutterModel *model,
                                guint         row)
 {
-  ClutterListModel *model_default = CLUTTER_LIST_MODEL (model);
-  GSequence *sequence = model_default->priv->sequence;
-  GSequenceIter *seq_iter;
-  guint pos = 0;
-
-  seq_iter = g_sequence_get_begin_iter (sequence);
-  while (!g_sequence_iter_is_end (seq_iter))
-    {
-      if (clutter_model_filter_row (model, pos))
-        {
-          if (pos == row)
-            {  
-              ClutterModelIter *iter;
-
-              iter = g_object_new (CLUTTER_TYPE_LIST_MODEL_ITER,
-                                   "model", model,
-                                   "row", pos,
-                                   NULL);
-              CLUTTER_LIST_MODEL_ITER (iter)->seq_iter = seq_iter;
-
-              /* the actual row is removed from the sequence inside
-               * the ::row-removed signal class handler, so that every
-               * handler connected to ::row-removed will still get
-               * a valid iterator, and every signal connected to
-               * ::row-removed with the AFTER flag will get an updated
-               * model
-               */
-              g_signal_emit_by_name (model, "row-removed", iter);
-
-              g_object_unref (iter);
-
-              break;
-            }
-        }
+  ClutterModelIter *iter;
+
+  iter = clutter_list_model_get_iter_at_row (model, row);
+  if (iter == NULL)
+    return;
+
+  /* the actual row is removed from the sequence inside
+   * the ::row-removed signal class handler, so that every
+   * handler connected to ::row-removed will still get
+   * a valid iterator, and every signal connected to
+   * ::row-removed with the AFTER flag will get an updated
+   * model
+   */
+  g_signal_emit_by_name (model, "row-removed", iter);
 
-      pos += 1;
-      seq_iter = g_sequence_iter_next (seq_iter);
-    }
+  g_object_unref (iter);
 }
 
 typedef struct
@@ -619,6 +745,139 @@ clutter_list_model_resort (ClutterModel         *model,
   g_sequence_sort (CLUTTER_LIST_MODEL (model)->priv->sequence,
                    sort_model_default,
                    &sort_closure);
+
+  clutter_list_model_invalidate_filter (CLUTTER_LIST_MODEL (model));
+}
+
+static void
+clutter_list_model_resort_row (ClutterModel         *model,
+                               ClutterModelIter     *iter,
+                               ClutterModelSortFunc  func,
+                               gpointer              data)
+{
+  SortClosure sort_closure = { NULL, 0, NULL, NULL };
+
+  sort_closure.model  = model;
+  sort_closure.column = clutter_model_get_sorting_column (model);
+  sort_closure.func   = func;
+  sort_closure.data   = data;
+
+  /* the sequence is a balanced tree, so this is a binary insertion */
+  g_sequence_sort_changed (CLUTTER_LIST_MODEL_ITER (iter)->seq_iter,
+                           sort_model_default,
+                           &sort_closure);
+
+  clutter_list_model_invalidate_filter (CLUTTER_LIST_MODEL (model));
+}
+
+static GValue *
+clutter_list_model_get_column_values (ClutterModel *model,
+                                      guint         column,
+                                      guint        *n_rows)
+{
+  GSequence *sequence = CLUTTER_LIST_MODEL (model)->priv->sequence;
+  GSequenceIter *seq_iter;
+  GValue *values;
+  guint i;
+
+  *n_rows = g_sequence_get_length (sequence);
+  values = g_new0 (GValue, *n_rows);
+
+  seq_iter = g_sequence_get_begin_iter (sequence);
+  for (i = 0; i < *n_rows; i++)
+    {
+      GValueArray *value_array = g_sequence_get (seq_iter);
+      GValue *value = g_value_array_get_nth (value_array, column);
+
+      g_value_init (&values[i], G_VALUE_TYPE (value));
+      g_value_copy (value, &values[i]);
+
+      seq_iter = g_sequence_iter_next (seq_iter);
+    }
+
+  return values;
+}
+
+static void
+clutter_list_model_reorder_rows (ClutterModel   *model,
+                                 guint           n_rows,
+                                 const guint    *new_order,
+                                 const gboolean *visible)
+{
+  ClutterListModel *list_model = CLUTTER_LIST_MODEL (model);
+  ClutterListModelPrivate *priv = list_model->priv;
+  GSequenceIter **rows;
+  GSequenceIter *seq_iter;
+  GHashTable *filtered = NULL;
+  GPtrArray *filter_index;
+  guint i;
+
+  g_assert (n_rows == g_sequence_get_length (priv->sequence));
+
+  rows = g_new (GSequenceIter *, n_rows);
+
+  seq_iter = g_sequence_get_begin_iter (priv->sequence);
+  for (i = 0; i < n_rows; i++)
+    {
+      rows[i] = seq_iter;
+      seq_iter = g_sequence_iter_next (seq_iter);
+    }
+
+  /* a new order does not change the rows passing the filter, so we
+   * can keep them instead of filtering every row again
+   */
+  if (visible == NULL &&
+      priv->filter_index != NULL &&
+      priv->filter_stamp == _clutter_model_get_filter_stamp (model))
+    {
+      filtered = g_hash_table_new (NULL, NULL);
+
+      for (i = 0; i < priv->filter_index->len; i++)
+        g_hash_table_insert (filtered,
+                             g_ptr_array_index (priv->filter_index, i),
+                             GINT_TO_POINTER (TRUE));
+    }
+
+  /* moving each row to the end, in the new order, sorts the sequence */
+  if (new_order != NULL)
+    {
+      seq_iter = g_sequence_get_end_iter (priv->sequence);
+
+      for (i = 0; i < n_rows; i++)
+        g_sequence_move (rows[new_order[i]], seq_iter);
+    }
+
+  clutter_list_model_invalidate_filter (list_model);
+
+  if (visible == NULL && filtered == NULL)
+    {
+      g_free (rows);
+      return;
+    }
+
+  filter_index = g_ptr_array_sized_new (n_rows);
+
+  for (i = 0; i < n_rows; i++)
+    {
+      guint old_pos = new_order != NULL ? new_order[i] : i;
+      gboolean is_visible;
+
+      if (visible != NULL)
+        is_visible = visible[old_pos];
+      else
+        is_visible = g_hash_table_lookup (filtered, rows[old_pos]) != NULL;
+
+      if (is_visible)
+        g_ptr_array_add (filter_index, rows[old_pos]);
+    }
+
+  priv->filter_index = filter_index;
+  priv->filter_stamp = _clutter_model_get_filter_stamp (model);
+
+  if (filtered != NULL)
+    g_hash_table_destroy (filtered);
+
+  g_free (rows);
 }
 
 static guint
@@ -630,7 +889,7 @@ clutter_list_model_get_n_rows (ClutterModel *model)
   if (!clutter_model_get_filter_set (model))
     return g_sequence_get_length (list_model->priv->sequence);
 
-  return CLUTTER_MODEL_CLASS (clutter_list_model_parent_class)->get_n_rows (model);
+  return clutter_list_model_get_filter_index (list_model)->len;
 }
 
 static void
@@ -647,6 +906,8 @@ clutter_list_model_row_removed (ClutterModel     *model,
 
   g_sequence_remove (iter_default->seq_iter);
   iter_default->seq_iter = NULL;
+
+  clutter_list_model_invalidate_filter (CLUTTER_LIST_MODEL (model));
 }
 
 static void
@@ -666,6 +927,8 @@ clutter_list_model_finalize (GObject *gobject)
     }
   g_sequence_free (sequence);
 
+  clutter_list_model_invalidate_filter (model);
+
   G_OBJECT_CLASS (clutter_list_model_parent_class)->finalize (gobject);
 }
 
@@ -698,8 +961,15 @@ clutter_list_model_class_init (ClutterListModelClass *klass)
   model_class->insert_row      = clutter_list_model_insert_row;
   model_class->remove_row      = clutter_list_model_remove_row;
   model_class->resort          = clutter_list_model_resort;
+  model_class->resort_row      = clutter_list_model_resort_row;
   model_class->get_n_rows      = clutter_list_model_get_n_rows;
 
+  model_class->cursor_seek      = clutter_list_model_cursor_seek;
+  model_class->cursor_get_value = clutter_list_model_cursor_get_value;
+
+  model_class->get_column_values = clutter_list_model_get_column_values;
+  model_class->reorder_rows      = clutter_list_model_reorder_rows;
+
   model_class->row_removed     = clutter_list_model_row_removed;
 }
 
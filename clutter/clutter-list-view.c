@@ -0,0 +1,929 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2011  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:clutter-list-view
+ * @short_description: An actor displaying the rows of a ClutterModel
+ *
+ * #ClutterListView is an actor that displays the rows of a #ClutterModel
+ * as a vertical list of items with the same height.
+ *
+ * Instead of creating an actor for each row, #ClutterListView keeps a
+ * small pool of item actors, large enough to cover its own height, and
+ * binds the visible rows to them as the #ClutterListView:scroll-offset
+ * changes. Item actors are created by a #ClutterListViewCreateFunc and
+ * updated by a #ClutterListViewBindFunc, both set using
+ * clutter_list_view_set_item_funcs(); the memory and painting costs of
+ * a #ClutterListView depend on its height, not on the size of the model.
+ *
+ * #ClutterListView tracks the changes of the model: adding or removing
+ * rows binds the visible items again, and changing a row binds only the
+ * item displaying it, if any.
+ *
+ * The items are bound before each frame is laid out, so the changes
+ * of the model and of the scroll offset are visible on the next frame.
+ *
+ * #ClutterListView is available since Clutter 1.8
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <math.h>
+
+#include "clutter-list-view.h"
+
+#include "clutter-debug.h"
+#include "clutter-main.h"
+#include "clutter-private.h"
+
+#include "cogl/cogl.h"
+
+G_DEFINE_TYPE (ClutterListView, clutter_list_view, CLUTTER_TYPE_ACTOR);
+
+#define CLUTTER_LIST_VIEW_GET_PRIVATE(obj)      (G_TYPE_INSTANCE_GET_PRIVATE ((obj), CLUTTER_TYPE_LIST_VIEW, ClutterListViewPrivate))
+
+struct _ClutterListViewPrivate
+{
+  ClutterModel *model;
+
+  gulong row_added_id;
+  gulong rows_added_id;
+  gulong row_removed_id;
+  gulong row_changed_id;
+  gulong sort_changed_id;
+  gulong filter_changed_id;
+
+  ClutterListViewCreateFunc create_func;
+  ClutterListViewBindFunc bind_func;
+  gpointer func_data;
+  GDestroyNotify func_notify;
+
+  gfloat item_height;
+  gfloat scroll_offset;
+
+  /* the height of the last allocation */
+  gfloat view_height;
+
+  /* the pool of item actors; the first n_bound items display the
+   * rows starting from first_row, the others are hidden */
+  GPtrArray *items;
+  guint first_row;
+  guint n_bound;
+
+  guint update_id;
+
+  guint rows_dirty : 1;
+};
+
+enum
+{
+  PROP_0,
+
+  PROP_MODEL,
+  PROP_ITEM_HEIGHT,
+  PROP_SCROLL_OFFSET,
+
+  PROP_LAST
+};
+
+static GParamSpec *obj_props[PROP_LAST];
+
+static void
+clutter_list_view_update_items (ClutterListView *view)
+{
+  ClutterListViewPrivate *priv = view->priv;
+  ClutterModelIter *iter;
+  GPtrArray *new_items;
+  gboolean *needs_bind;
+  GSList *spare;
+  guint n_rows, first, last, n_visible;
+  guint i, j;
+
+  n_rows = priv->model != NULL ? clutter_model_get_n_rows (priv->model) : 0;
+
+  if (priv->item_height <= 0 ||
+      priv->create_func == NULL ||
+      priv->bind_func == NULL)
+    {
+      first = last = 0;
+    }
+  else
+    {
+      first = floorf (priv->scroll_offset / priv->item_height);
+      last = ceilf ((priv->scroll_offset + priv->view_height)
+                    / priv->item_height);
+
+      first = MIN (first, n_rows);
+      last = MIN (last, n_rows);
+    }
+
+  /* grow the pool to cover the visible rows */
+  while (priv->items->len < last - first)
+    {
+      ClutterActor *item;
+
+      item = priv->create_func (view, priv->func_data);
+      if (item == NULL)
+        {
+          g_warning ("The item creation function of the ClutterListView "
+                     "did not return an actor");
+          break;
+        }
+
+      clutter_actor_push_internal (CLUTTER_ACTOR (view));
+      clutter_actor_set_parent (item, CLUTTER_ACTOR (view));
+      clutter_actor_pop_internal (CLUTTER_ACTOR (view));
+
+      g_ptr_array_add (priv->items, item);
+    }
+
+  n_visible = MIN (last - first, priv->items->len);
+  last = first + n_visible;
+
+  CLUTTER_NOTE (LAYOUT, "List view: rows [ %u, %u ) of %u, %u items",
+                first, last, n_rows,
+                priv->items->len);
+
+  /* keep the items that still display a visible row, so that
+   * scrolling only binds the rows that have just become visible */
+  new_items = g_ptr_array_sized_new (priv->items->len);
+  g_ptr_array_set_size (new_items, priv->items->len);
+  needs_bind = g_new0 (gboolean, MAX (n_visible, 1));
+  spare = NULL;
+
+  for (i = 0; i < priv->items->len; i++)
+    {
+      ClutterActor *item = g_ptr_array_index (priv->items, i);
+      guint row = priv->first_row + i;
+
+      if (!priv->rows_dirty &&
+          i < priv->n_bound &&
+          row >= first && row < last)
+        g_ptr_array_index (new_items, row - first) = item;
+      else
+        spare = g_slist_prepend (spare, item);
+    }
+
+  for (i = 0, j = 0; i < new_items->len; i++)
+    {
+      if (g_ptr_array_index (new_items, i) != NULL)
+        continue;
+
+      g_assert (spare != NULL);
+
+      g_ptr_array_index (new_items, i) = spare->data;
+      spare = g_slist_delete_link (spare, spare);
+
+      if (i < n_visible)
+        {
+          needs_bind[i] = TRUE;
+          j += 1;
+        }
+    }
+
+  g_ptr_array_free (priv->items, TRUE);
+  priv->items = new_items;
+  priv->first_row = first;
+  priv->n_bound = n_visible;
+  priv->rows_dirty = FALSE;
+
+  if (j > 0)
+    {
+      iter = clutter_model_get_iter_at_row (priv->model, first);
+
+      for (i = 0; i < n_visible; i++)
+        {
+          if (needs_bind[i])
+            priv->bind_func (view,
+                             g_ptr_array_index (priv->items, i),
+                             iter,
+                             priv->func_data);
+
+          clutter_model_iter_next (iter);
+        }
+
+      g_object_unref (iter);
+
+      CLUTTER_NOTE (LAYOUT, "List view: %u items bound", j);
+    }
+
+  for (i = 0; i < priv->items->len; i++)
+    {
+      ClutterActor *item = g_ptr_array_index (priv->items, i);
+
+      if (i < n_visible)
+        clutter_actor_show (item);
+      else
+        clutter_actor_hide (item);
+    }
+
+  g_free (needs_bind);
+
+  clutter_actor_queue_relayout (CLUTTER_ACTOR (view));
+}
+
+static gboolean
+clutter_list_view_update_func (gpointer data)
+{
+  ClutterListView *view = data;
+
+  view->priv->update_id = 0;
+
+  clutter_list_view_update_items (view);
+
+  return FALSE;
+}
+
+/* binds the items before the next frame is laid out, since binding
+ * can queue relayouts on the items, which is not allowed during an
+ * allocation */
+static void
+clutter_list_view_queue_update (ClutterListView *view)
+{
+  ClutterListViewPrivate *priv = view->priv;
+
+  if (priv->update_id == 0)
+    priv->update_id =
+      clutter_threads_add_repaint_func (clutter_list_view_update_func,
+                                        view,
+                                        NULL);
+
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (view));
+}
+
+static void
+clutter_list_view_rows_changed (ClutterListView *view)
+{
+  view->priv->rows_dirty = TRUE;
+
+  clutter_list_view_queue_update (view);
+
+  /* the preferred height depends on the number of rows */
+  clutter_actor_queue_relayout (CLUTTER_ACTOR (view));
+}
+
+static void
+on_row_added (ClutterModel     *model,
+              ClutterModelIter *iter,
+              ClutterListView  *view)
+{
+  clutter_list_view_rows_changed (view);
+}
+
+static void
+on_rows_added (ClutterModel    *model,
+               guint            first_row,
+               guint            n_rows,
+               ClutterListView *view)
+{
+  clutter_list_view_rows_changed (view);
+}
+
+static void
+on_row_removed (ClutterModel     *model,
+                ClutterModelIter *iter,
+                ClutterListView  *view)
+{
+  clutter_list_view_rows_changed (view);
+}
+
+static void
+on_row_changed (ClutterModel     *model,
+                ClutterModelIter *iter,
+                ClutterListView  *view)
+{
+  ClutterListViewPrivate *priv = view->priv;
+  guint row;
+
+  /* everything is going to be bound again anyway */
+  if (priv->rows_dirty)
+    return;
+
+  row = clutter_model_iter_get_row (iter);
+  if (row < priv->first_row || row >= priv->first_row + priv->n_bound)
+    return;
+
+  priv->bind_func (view,
+                   g_ptr_array_index (priv->items, row - priv->first_row),
+                   iter,
+                   priv->func_data);
+}
+
+static void
+on_model_changed (ClutterModel    *model,
+                  ClutterListView *view)
+{
+  clutter_list_view_rows_changed (view);
+}
+
+static void
+clutter_list_view_get_preferred_width (ClutterActor *actor,
+                                       gfloat        for_height,
+                                       gfloat       *min_width_p,
+                                       gfloat       *natural_width_p)
+{
+  ClutterListViewPrivate *priv = CLUTTER_LIST_VIEW (actor)->priv;
+  gfloat min_width, natural_width;
+  guint i;
+
+  min_width = natural_width = 0;
+
+  for (i = 0; i < priv->n_bound; i++)
+    {
+      ClutterActor *item = g_ptr_array_index (priv->items, i);
+      gfloat item_min, item_natural;
+
+      clutter_actor_get_preferred_width (item, priv->item_height,
+                                         &item_min,
+                                         &item_natural);
+
+      min_width = MAX (min_width, item_min);
+      natural_width = MAX (natural_width, item_natural);
+    }
+
+  if (min_width_p)
+    *min_width_p = min_width;
+
+  if (natural_width_p)
+    *natural_width_p = natural_width;
+}
+
+static void
+clutter_list_view_get_preferred_height (ClutterActor *actor,
+                                        gfloat        for_width,
+                                        gfloat       *min_height_p,
+                                        gfloat       *natural_height_p)
+{
+  ClutterListViewPrivate *priv = CLUTTER_LIST_VIEW (actor)->priv;
+  guint n_rows;
+
+  n_rows = priv->model != NULL ? clutter_model_get_n_rows (priv->model) : 0;
+
+  if (min_height_p)
+    *min_height_p = 0;
+
+  if (natural_height_p)
+    *natural_height_p = n_rows * priv->item_height;
+}
+
+static void
+clutter_list_view_allocate (ClutterActor           *actor,
+                            const ClutterActorBox  *box,
+                            ClutterAllocationFlags  flags)
+{
+  ClutterListView *view = CLUTTER_LIST_VIEW (actor);
+  ClutterListViewPrivate *priv = view->priv;
+  gfloat width, height;
+  guint i;
+
+  CLUTTER_ACTOR_CLASS (clutter_list_view_parent_class)->allocate (actor,
+                                                                  box,
+                                                                  flags);
+
+  clutter_actor_box_get_size (box, &width, &height);
+
+  /* a different height might need a different set of items */
+  if (height != priv->view_height)
+    {
+      priv->view_height = height;
+      clutter_list_view_queue_update (view);
+    }
+
+  for (i = 0; i < priv->n_bound; i++)
+    {
+      ClutterActor *item = g_ptr_array_index (priv->items, i);
+      ClutterActorBox item_box;
+
+      item_box.x1 = 0;
+      item_box.y1 = floorf ((priv->first_row + i) * priv->item_height
+                            - priv->scroll_offset + 0.5);
+      item_box.x2 = width;
+      item_box.y2 = item_box.y1 + priv->item_height;
+
+      clutter_actor_allocate (item, &item_box, flags);
+    }
+}
+
+static void
+clutter_list_view_paint_items (ClutterListView *view)
+{
+  ClutterListViewPrivate *priv = view->priv;
+  ClutterActorBox box;
+  guint i;
+
+  if (priv->n_bound == 0)
+    return;
+
+  /* the first and last items are usually only partially visible */
+  clutter_actor_get_allocation_box (CLUTTER_ACTOR (view), &box);
+  cogl_clip_push_rectangle (0, 0,
+                            clutter_actor_box_get_width (&box),
+                            clutter_actor_box_get_height (&box));
+
+  for (i = 0; i < priv->n_bound; i++)
+    clutter_actor_paint (g_ptr_array_index (priv->items, i));
+
+  cogl_clip_pop ();
+}
+
+static void
+clutter_list_view_paint (ClutterActor *actor)
+{
+  clutter_list_view_paint_items (CLUTTER_LIST_VIEW (actor));
+}
+
+static void
+clutter_list_view_pick (ClutterActor       *actor,
+                        const ClutterColor *color)
+{
+  /* paint our pick */
+  CLUTTER_ACTOR_CLASS (clutter_list_view_parent_class)->pick (actor, color);
+
+  clutter_list_view_paint_items (CLUTTER_LIST_VIEW (actor));
+}
+
+static gboolean
+clutter_list_view_get_paint_volume (ClutterActor       *actor,
+                                    ClutterPaintVolume *volume)
+{
+  /* the items are clipped to the allocation */
+  return clutter_paint_volume_set_from_allocation (volume, actor);
+}
+
+static void
+clutter_list_view_destroy (ClutterActor *actor)
+{
+  ClutterListViewPrivate *priv = CLUTTER_LIST_VIEW (actor)->priv;
+
+  if (priv->items != NULL)
+    {
+      GPtrArray *items = priv->items;
+
+      priv->items = NULL;
+      priv->n_bound = 0;
+
+      g_ptr_array_foreach (items, (GFunc) clutter_actor_destroy, NULL);
+      g_ptr_array_free (items, TRUE);
+    }
+
+  if (CLUTTER_ACTOR_CLASS (clutter_list_view_parent_class)->destroy)
+    CLUTTER_ACTOR_CLASS (clutter_list_view_parent_class)->destroy (actor);
+}
+
+static void
+clutter_list_view_dispose (GObject *gobject)
+{
+  ClutterListView *view = CLUTTER_LIST_VIEW (gobject);
+  ClutterListViewPrivate *priv = view->priv;
+
+  clutter_list_view_set_model (view, NULL);
+  clutter_list_view_set_item_funcs (view, NULL, NULL, NULL, NULL);
+
+  /* unsetting the model queues an update */
+  if (priv->update_id != 0)
+    {
+      clutter_threads_remove_repaint_func (priv->update_id);
+      priv->update_id = 0;
+    }
+
+  G_OBJECT_CLASS (clutter_list_view_parent_class)->dispose (gobject);
+}
+
+static void
+clutter_list_view_finalize (GObject *gobject)
+{
+  ClutterListViewPrivate *priv = CLUTTER_LIST_VIEW (gobject)->priv;
+
+  if (priv->items != NULL)
+    g_ptr_array_free (priv->items, TRUE);
+
+  G_OBJECT_CLASS (clutter_list_view_parent_class)->finalize (gobject);
+}
+
+static void
+clutter_list_view_set_property (GObject      *gobject,
+                                guint         prop_id,
+                                const GValue *value,
+                                GParamSpec   *pspec)
+{
+  ClutterListView *view = CLUTTER_LIST_VIEW (gobject);
+
+  switch (prop_id)
+    {
+    case PROP_MODEL:
+      clutter_list_view_set_model (view, g_value_get_object (value));
+      break;
+
+    case PROP_ITEM_HEIGHT:
+      clutter_list_view_set_item_height (view, g_value_get_float (value));
+      break;
+
+    case PROP_SCROLL_OFFSET:
+      clutter_list_view_set_scroll_offset (view, g_value_get_float (value));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+clutter_list_view_get_property (GObject    *gobject,
+                                guint       prop_id,
+                                GValue     *value,
+                                GParamSpec *pspec)
+{
+  ClutterListViewPrivate *priv = CLUTTER_LIST_VIEW (gobject)->priv;
+
+  switch (prop_id)
+    {
+    case PROP_MODEL:
+      g_value_set_object (value, priv->model);
+      break;
+
+    case PROP_ITEM_HEIGHT:
+      g_value_set_float (value, priv->item_height);
+      break;
+
+    case PROP_SCROLL_OFFSET:
+      g_value_set_float (value, priv->scroll_offset);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+clutter_list_view_class_init (ClutterListViewClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
+  GParamSpec *pspec;
+
+  g_type_class_add_private (klass, sizeof (ClutterListViewPrivate));
+
+  actor_class->get_preferred_width = clutter_list_view_get_preferred_width;
+  actor_class->get_preferred_height = clutter_list_view_get_preferred_height;
+  actor_class->allocate = clutter_list_view_allocate;
+  actor_class->paint = clutter_list_view_paint;
+  actor_class->pick = clutter_list_view_pick;
+  actor_class->get_paint_volume = clutter_list_view_get_paint_volume;
+  actor_class->destroy = clutter_list_view_destroy;
+
+  gobject_class->set_property = clutter_list_view_set_property;
+  gobject_class->get_property = clutter_list_view_get_property;
+  gobject_class->dispose = clutter_list_view_dispose;
+  gobject_class->finalize = clutter_list_view_finalize;
+
+  /**
+   * ClutterListView:model:
+   *
+   * The #ClutterModel displayed by the #ClutterListView
+   *
+   * Since: 1.8
+   */
+  pspec = g_param_spec_object ("model",
+                               P_("Model"),
+                               P_("The model displayed by the view"),
+                               CLUTTER_TYPE_MODEL,
+                               CLUTTER_PARAM_READWRITE);
+  obj_props[PROP_MODEL] = pspec;
+  g_object_class_install_property (gobject_class, PROP_MODEL, pspec);
+
+  /**
+   * ClutterListView:item-height:
+   *
+   * The height of each item, in pixels
+   *
+   * Since: 1.8
+   */
+  pspec = g_param_spec_float ("item-height",
+                              P_("Item Height"),
+                              P_("The height of each item"),
+                              0.0, G_MAXFLOAT,
+                              0.0,
+                              CLUTTER_PARAM_READWRITE);
+  obj_props[PROP_ITEM_HEIGHT] = pspec;
+  g_object_class_install_property (gobject_class, PROP_ITEM_HEIGHT, pspec);
+
+  /**
+   * ClutterListView:scroll-offset:
+   *
+   * The vertical offset of the first visible pixel of the list,
+   * in pixels
+   *
+   * Since: 1.8
+   */
+  pspec = g_param_spec_float ("scroll-offset",
+                              P_("Scroll Offset"),
+                              P_("The offset of the first visible pixel"),
+                              0.0, G_MAXFLOAT,
+                              0.0,
+                              CLUTTER_PARAM_READWRITE);
+  obj_props[PROP_SCROLL_OFFSET] = pspec;
+  g_object_class_install_property (gobject_class, PROP_SCROLL_OFFSET, pspec);
+}
+
+static void
+clutter_list_view_init (ClutterListView *self)
+{
+  ClutterListViewPrivate *priv;
+
+  self->priv = priv = CLUTTER_LIST_VIEW_GET_PRIVATE (self);
+
+  priv->items = g_ptr_array_new ();
+}
+
+/**
+ * clutter_list_view_new:
+ *
+ * Creates a new #ClutterListView. Use clutter_list_view_set_model()
+ * and clutter_list_view_set_item_funcs() to display something in it
+ *
+ * Return value: the newly created #ClutterListView
+ *
+ * Since: 1.8
+ */
+ClutterActor *
+clutter_list_view_new (void)
+{
+  return g_object_new (CLUTTER_TYPE_LIST_VIEW, NULL);
+}
+
+/**
+ * clutter_list_view_set_model:
+ * @view: a #ClutterListView
+ * @model: (allow-none): a #ClutterModel, or %NULL
+ *
+ * Sets the #ClutterModel whose rows should be displayed by @view.
+ * The @view acquires a reference on @model
+ *
+ * Since: 1.8
+ */
+void
+clutter_list_view_set_model (ClutterListView *view,
+                             ClutterModel    *model)
+{
+  ClutterListViewPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_LIST_VIEW (view));
+  g_return_if_fail (model == NULL || CLUTTER_IS_MODEL (model));
+
+  priv = view->priv;
+
+  if (priv->model == model)
+    return;
+
+  if (priv->model != NULL)
+    {
+      g_signal_handler_disconnect (priv->model, priv->row_added_id);
+      g_signal_handler_disconnect (priv->model, priv->rows_added_id);
+      g_signal_handler_disconnect (priv->model, priv->row_removed_id);
+      g_signal_handler_disconnect (priv->model, priv->row_changed_id);
+      g_signal_handler_disconnect (priv->model, priv->sort_changed_id);
+      g_signal_handler_disconnect (priv->model, priv->filter_changed_id);
+
+      g_object_unref (priv->model);
+      priv->model = NULL;
+    }
+
+  if (model != NULL)
+    {
+      priv->model = g_object_ref (model);
+
+      priv->row_added_id =
+        g_signal_connect (model, "row-added",
+                          G_CALLBACK (on_row_added),
+                          view);
+      priv->rows_added_id =
+        g_signal_connect (model, "rows-added",
+                          G_CALLBACK (on_rows_added),
+                          view);
+      priv->row_removed_id =
+        g_signal_connect (model, "row-removed",
+                          G_CALLBACK (on_row_removed),
+                          view);
+      priv->row_changed_id =
+        g_signal_connect (model, "row-changed",
+                          G_CALLBACK (on_row_changed),
+                          view);
+      priv->sort_changed_id =
+        g_signal_connect (model, "sort-changed",
+                          G_CALLBACK (on_model_changed),
+                          view);
+      priv->filter_changed_id =
+        g_signal_connect (model, "filter-changed",
+                          G_CALLBACK (on_model_changed),
+                          view);
+    }
+
+  clutter_list_view_rows_changed (view);
+
+  g_object_notify_by_pspec (G_OBJECT (view), obj_props[PROP_MODEL]);
+}
+
+/**
+ * clutter_list_view_get_model:
+ * @view: a #ClutterListView
+ *
+ * Retrieves the model set using clutter_list_view_set_model()
+ *
+ * Return value: (transfer none): the #ClutterModel displayed by @view
+ *
+ * Since: 1.8
+ */
+ClutterModel *
+clutter_list_view_get_model (ClutterListView *view)
+{
+  g_return_val_if_fail (CLUTTER_IS_LIST_VIEW (view), NULL);
+
+  return view->priv->model;
+}
+
+/**
+ * clutter_list_view_set_item_funcs:
+ * @view: a #ClutterListView
+ * @create_func: (allow-none): the function creating the item actors
+ * @bind_func: (allow-none): the function binding a row to an item
+ * @user_data: data to pass to @create_func and @bind_func
+ * @notify: (allow-none): function to call when @user_data is not
+ *   needed any more
+ *
+ * Sets the functions used by @view to create its item actors and to
+ * display the rows of the model in them.
+ *
+ * Changing the functions destroys all the existing item actors.
+ *
+ * Since: 1.8
+ */
+void
+clutter_list_view_set_item_funcs (ClutterListView           *view,
+                                  ClutterListViewCreateFunc  create_func,
+                                  ClutterListViewBindFunc    bind_func,
+                                  gpointer                   user_data,
+                                  GDestroyNotify             notify)
+{
+  ClutterListViewPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_LIST_VIEW (view));
+
+  priv = view->priv;
+
+  if (priv->func_notify != NULL)
+    priv->func_notify (priv->func_data);
+
+  priv->create_func = create_func;
+  priv->bind_func = bind_func;
+  priv->func_data = user_data;
+  priv->func_notify = notify;
+
+  /* items created by the old function cannot be reused */
+  if (priv->items != NULL && priv->items->len > 0)
+    {
+      g_ptr_array_foreach (priv->items, (GFunc) clutter_actor_destroy, NULL);
+      g_ptr_array_set_size (priv->items, 0);
+      priv->n_bound = 0;
+    }
+
+  clutter_list_view_rows_changed (view);
+}
+
+/**
+ * clutter_list_view_set_item_height:
+ * @view: a #ClutterListView
+ * @height: the height of each item, in pixels
+ *
+ * Sets the height of each item of @view
+ *
+ * Since: 1.8
+ */
+void
+clutter_list_view_set_item_height (ClutterListView *view,
+                                   gfloat           height)
+{
+  ClutterListViewPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_LIST_VIEW (view));
+  g_return_if_fail (height >= 0.0);
+
+  priv = view->priv;
+
+  if (priv->item_height == height)
+    return;
+
+  priv->item_height = height;
+
+  clutter_list_view_rows_changed (view);
+
+  g_object_notify_by_pspec (G_OBJECT (view), obj_props[PROP_ITEM_HEIGHT]);
+}
+
+/**
+ * clutter_list_view_get_item_height:
+ * @view: a #ClutterListView
+ *
+ * Retrieves the height set using clutter_list_view_set_item_height()
+ *
+ * Return value: the height of each item, in pixels
+ *
+ * Since: 1.8
+ */
+gfloat
+clutter_list_view_get_item_height (ClutterListView *view)
+{
+  g_return_val_if_fail (CLUTTER_IS_LIST_VIEW (view), 0.0);
+
+  return view->priv->item_height;
+}
+
+/**
+ * clutter_list_view_set_scroll_offset:
+ * @view: a #ClutterListView
+ * @offset: the offset of the first visible pixel, in pixels
+ *
+ * Scrolls @view so that the pixel at @offset from the top of the
+ * first item is displayed at the top of @view
+ *
+ * Since: 1.8
+ */
+void
+clutter_list_view_set_scroll_offset (ClutterListView *view,
+                                     gfloat           offset)
+{
+  ClutterListViewPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_LIST_VIEW (view));
+
+  priv = view->priv;
+
+  offset = MAX (offset, 0.0);
+
+  if (priv->scroll_offset == offset)
+    return;
+
+  priv->scroll_offset = offset;
+
+  clutter_list_view_queue_update (view);
+
+  g_object_notify_by_pspec (G_OBJECT (view), obj_props[PROP_SCROLL_OFFSET]);
+}
+
+/**
+ * clutter_list_view_get_scroll_offset:
+ * @view: a #ClutterListView
+ *
+ * Retrieves the offset set using clutter_list_view_set_scroll_offset()
+ *
+ * Return value: the offset of the first visible pixel, in pixels
+ *
+ * Since: 1.8
+ */
+gfloat
+clutter_list_view_get_scroll_offset (ClutterListView *view)
+{
+  g_return_val_if_fail (CLUTTER_IS_LIST_VIEW (view), 0.0);
+
+  return view->priv->scroll_offset;
+}
+
+/**
+ * clutter_list_view_get_n_items:
+ * @view: a #ClutterListView
+ *
+ * Retrieves the number of item actors created by @view, which
+ * depends on its height and not on the number of rows of the model
+ *
+ * Return value: the number of item actors
+ *
+ * Since: 1.8
+ */
+guint
+clutter_list_view_get_n_items (ClutterListView *view)
+{
+  g_return_val_if_fail (CLUTTER_IS_LIST_VIEW (view), 0);
+
+  return view->priv->items != NULL ? view->priv->items->len : 0;
+}
@@ -0,0 +1,134 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2011  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined(__CLUTTER_H_INSIDE__) && !defined(CLUTTER_COMPILATION)
+#error "Only <clutter/clutter.h> can be included directly."
+#endif
+
+#ifndef __CLUTTER_LIST_VIEW_H__
+#define __CLUTTER_LIST_VIEW_H__
+
+#include <clutter/clutter-actor.h>
+#include <clutter/clutter-model.h>
+
+G_BEGIN_DECLS
+
+#define CLUTTER_TYPE_LIST_VIEW                  (clutter_list_view_get_type ())
+#define CLUTTER_LIST_VIEW(obj)                  (G_TYPE_CHECK_INSTANCE_CAST ((obj), CLUTTER_TYPE_LIST_VIEW, ClutterListView))
+#define CLUTTER_IS_LIST_VIEW(obj)               (G_TYPE_CHECK_INSTANCE_TYPE ((obj), CLUTTER_TYPE_LIST_VIEW))
+#define CLUTTER_LIST_VIEW_CLASS(klass)          (G_TYPE_CHECK_CLASS_CAST ((klass), CLUTTER_TYPE_LIST_VIEW, ClutterListViewClass))
+#define CLUTTER_IS_LIST_VIEW_CLASS(klass)       (G_TYPE_CHECK_CLASS_TYPE ((klass), CLUTTER_TYPE_LIST_VIEW))
+#define CLUTTER_LIST_VIEW_GET_CLASS(obj)        (G_TYPE_INSTANCE_GET_CLASS ((obj), CLUTTER_TYPE_LIST_VIEW, ClutterListViewClass))
+
+typedef struct _ClutterListView                 ClutterListView;
+typedef struct _ClutterListViewClass            ClutterListViewClass;
+typedef struct _ClutterListViewPrivate          ClutterListViewPrivate;
+
+/**
+ * ClutterListViewCreateFunc:
+ * @view: the #ClutterListView that needs a new item
+ * @user_data: data passed to clutter_list_view_set_item_funcs()
+ *
+ * Creates a new, unparented actor that will be used by @view to
+ * display the rows of its model
+ *
+ * Return value: (transfer full): a newly created #ClutterActor
+ *
+ * Since: 1.8
+ */
+typedef ClutterActor *(* ClutterListViewCreateFunc) (ClutterListView *view,
+                                                     gpointer         user_data);
+
+/**
+ * ClutterListViewBindFunc:
+ * @view: the #ClutterListView binding a row
+ * @item: an item actor created by the #ClutterListViewCreateFunc
+ * @iter: a #ClutterModelIter pointing to the row to display
+ * @user_data: data passed to clutter_list_view_set_item_funcs()
+ *
+ * Updates @item so that it displays the row pointed by @iter
+ *
+ * Since: 1.8
+ */
+typedef void (* ClutterListViewBindFunc) (ClutterListView  *view,
+                                          ClutterActor     *item,
+                                          ClutterModelIter *iter,
+                                          gpointer          user_data);
+
+/**
+ * ClutterListView:
+ *
+ * The #ClutterListView structure contains only private data
+ * and should be accessed using the provided API
+ *
+ * Since: 1.8
+ */
+struct _ClutterListView
+{
+  /*< private >*/
+  ClutterActor parent_instance;
+
+  ClutterListViewPrivate *priv;
+};
+
+/**
+ * ClutterListViewClass:
+ *
+ * The #ClutterListViewClass structure contains only private data
+ *
+ * Since: 1.8
+ */
+struct _ClutterListViewClass
+{
+  /*< private >*/
+  ClutterActorClass parent_class;
+
+  /* padding for future expansion */
+  void (*_clutter_list_view1) (void);
+  void (*_clutter_list_view2) (void);
+  void (*_clutter_list_view3) (void);
+  void (*_clutter_list_view4) (void);
+};
+
+GType clutter_list_view_get_type (void) G_GNUC_CONST;
+
+ClutterActor * clutter_list_view_new               (void);
+
+void           clutter_list_view_set_model         (ClutterListView           *view,
+                                                    ClutterModel              *model);
+ClutterModel * clutter_list_view_get_model         (ClutterListView           *view);
+void           clutter_list_view_set_item_funcs    (ClutterListView           *view,
+                                                    ClutterListViewCreateFunc  create_func,
+                                                    ClutterListViewBindFunc    bind_func,
+                                                    gpointer                   user_data,
+                                                    GDestroyNotify             notify);
+void           clutter_list_view_set_item_height   (ClutterListView           *view,
+                                                    gfloat                     height);
+gfloat         clutter_list_view_get_item_height   (ClutterListView           *view);
+void           clutter_list_view_set_scroll_offset (ClutterListView           *view,
+                                                    gfloat                     offset);
+gfloat         clutter_list_view_get_scroll_offset (ClutterListView           *view);
+
+guint          clutter_list_view_get_n_items       (ClutterListView           *view);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_LIST_VIEW_H__ */
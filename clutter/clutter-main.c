@@ -127,10 +127,14 @@ static gboolean clutter_is_initialized       = FALSE;
 static gboolean clutter_show_fps             = FALSE;
 static gboolean clutter_fatal_warnings       = FALSE;
 static gboolean clutter_disable_mipmap_text  = FALSE;
+static gboolean clutter_disable_font_preload = FALSE;
 static gboolean clutter_use_fuzzy_picking    = FALSE;
 static gboolean clutter_enable_accessibility = TRUE;
 
 static guint clutter_default_fps             = 60;
+static guint clutter_size_cache_size         = 16;
+static guint clutter_subtree_cache_budget    = 16384;
+static guint clutter_fixed_frame_time        = 0;
 
 static ClutterTextDirection clutter_text_direction = CLUTTER_TEXT_DIRECTION_LTR;
 
@@ -180,13 +184,22 @@ static const GDebugKey clutter_paint_debug_keys[] = {
   { "disable-clipped-redraws", CLUTTER_DEBUG_DISABLE_CLIPPED_REDRAWS },
   { "redraws", CLUTTER_DEBUG_REDRAWS },
   { "paint-volumes", CLUTTER_DEBUG_PAINT_VOLUMES },
-  { "disable-culling", CLUTTER_DEBUG_DISABLE_CULLING }
+  { "disable-culling", CLUTTER_DEBUG_DISABLE_CULLING },
+  { "disable-subtree-cache", CLUTTER_DEBUG_DISABLE_SUBTREE_CACHE },
+  { "gpu-timings", CLUTTER_DEBUG_GPU_TIMINGS },
+  { "redraw-causes", CLUTTER_DEBUG_REDRAW_CAUSES },
+  { "overdraw", CLUTTER_DEBUG_OVERDRAW },
+  { "disable-display-lists", CLUTTER_DEBUG_DISABLE_DISPLAY_LISTS }
 };
 
 #ifdef CLUTTER_ENABLE_PROFILE
+static guint clutter_profile_alloc_frame = 0;
+
 static const GDebugKey clutter_profile_keys[] = {
   {"picking-only", CLUTTER_PROFILE_PICKING_ONLY },
-  {"disable-report", CLUTTER_PROFILE_DISABLE_REPORT }
+  {"disable-report", CLUTTER_PROFILE_DISABLE_REPORT },
+  {"startup", CLUTTER_PROFILE_STARTUP },
+  {"allocations", CLUTTER_PROFILE_ALLOCATIONS }
 };
 #endif /* CLUTTER_ENABLE_DEBUG */
 
@@ -436,6 +449,68 @@ _clutter_pixel_to_id (guchar pixel[4])
   return retval;
 }
 
+/* the first font lookup forces fontconfig to load its configuration
+ * and to scan the font caches, which can take a long time on a cold
+ * boot; we do it from a separate thread during clutter_init(), using
+ * a plain PangoCairo font map that does not touch Cogl, so that the
+ * main thread can connect to the windowing system and create the
+ * stage in the meantime
+ */
+static gpointer
+clutter_font_preload_thread_func (gpointer data)
+{
+  PangoFontDescription *font_desc = data;
+  PangoFontMap *font_map;
+  PangoContext *context;
+  PangoFont *font;
+
+  font_map = pango_cairo_font_map_new ();
+  context = pango_font_map_create_context (font_map);
+
+  font = pango_context_load_font (context, font_desc);
+  if (font != NULL)
+    g_object_unref (font);
+
+  g_object_unref (context);
+  g_object_unref (font_map);
+  pango_font_description_free (font_desc);
+
+  return NULL;
+}
+
+static void
+clutter_context_preload_fonts (ClutterMainContext *self)
+{
+  PangoFontDescription *font_desc;
+  GError *error = NULL;
+  gchar *font_name;
+
+  if (clutter_disable_font_preload || !g_thread_supported ())
+    return;
+
+  if (self->font_map != NULL || self->font_preload_thread != NULL)
+    return;
+
+  g_object_get (clutter_settings_get_default (),
+                "font-name", &font_name,
+                NULL);
+  font_desc = pango_font_description_from_string (font_name);
+  g_free (font_name);
+
+  self->font_preload_thread =
+    g_thread_create (clutter_font_preload_thread_func, font_desc,
+                     TRUE,
+                     &error);
+
+  if (self->font_preload_thread == NULL)
+    {
+      CLUTTER_NOTE (MISC, "Unable to preload the fonts: %s",
+                    error->message);
+      pango_font_description_free (font_desc);
+      g_error_free (error);
+    }
+}
+
 static CoglPangoFontMap *
 clutter_context_get_pango_fontmap (void)
 {
@@ -448,6 +523,17 @@ clutter_context_get_pango_fontmap (void)
   if (G_LIKELY (self->font_map != NULL))
     return self->font_map;
 
+  _clutter_startup_phase_begin (CLUTTER_STARTUP_FONT_MAP);
+
+  /* fontconfig is not safe to use while the preloading thread
+   * is still running, so we block until it has finished
+   */
+  if (self->font_preload_thread != NULL)
+    {
+      g_thread_join (self->font_preload_thread);
+      self->font_preload_thread = NULL;
+    }
+
   font_map = COGL_PANGO_FONT_MAP (cogl_pango_font_map_new ());
 
   resolution = clutter_backend_get_resolution (self->backend);
@@ -458,6 +544,8 @@ clutter_context_get_pango_fontmap (void)
 
   self->font_map = font_map;
 
+  _clutter_startup_phase_end (CLUTTER_STARTUP_FONT_MAP);
+
   return self->font_map;
 }
 
@@ -1223,8 +1311,17 @@ clutter_init_real (GError **error)
   /*
    * Call backend post parse hooks.
    */
+  _clutter_startup_phase_begin (CLUTTER_STARTUP_BACKEND_CONNECT);
+
+  clutter_context_preload_fonts (ctx);
+
   if (!_clutter_backend_post_parse (backend, error))
-    return CLUTTER_INIT_ERROR_BACKEND;
+    {
+      _clutter_startup_phase_end (CLUTTER_STARTUP_BACKEND_CONNECT);
+      return CLUTTER_INIT_ERROR_BACKEND;
+    }
+
+  _clutter_startup_phase_end (CLUTTER_STARTUP_BACKEND_CONNECT);
 
   /* If we are displaying the regions that would get redrawn with clipped
    * redraws enabled we actually have to disable the clipped redrawing
@@ -1237,6 +1334,11 @@ clutter_init_real (GError **error)
   if (clutter_paint_debug_flags & CLUTTER_DEBUG_PAINT_VOLUMES)
     clutter_paint_debug_flags |= CLUTTER_DEBUG_DISABLE_CLIPPED_REDRAWS;
 
+  /* ...and the overdraw heatmap, which is computed over the whole
+   * stage in each frame */
+  if (clutter_paint_debug_flags & CLUTTER_DEBUG_OVERDRAW)
+    clutter_paint_debug_flags |= CLUTTER_DEBUG_DISABLE_CLIPPED_REDRAWS;
+
   /* this will take care of initializing Cogl's state and
    * query the GL machinery for features
    */
@@ -1260,6 +1362,9 @@ clutter_init_real (GError **error)
 
   if (clutter_profile_flags & CLUTTER_PROFILE_PICKING_ONLY)
     _clutter_profile_suspend ();
+
+  if (clutter_profile_flags & CLUTTER_PROFILE_ALLOCATIONS)
+    _clutter_alloc_tracking_init (clutter_profile_alloc_frame);
 #endif
 
   clutter_text_direction = clutter_get_text_direction ();
@@ -1290,6 +1395,9 @@ static GOptionEntry clutter_args[] = {
   { "clutter-disable-mipmapped-text", 0, 0, G_OPTION_ARG_NONE,
     &clutter_disable_mipmap_text,
     N_("Disable mipmapping on text"), NULL },
+  { "clutter-disable-font-preload", 0, 0, G_OPTION_ARG_NONE,
+    &clutter_disable_font_preload,
+    N_("Do not load the fonts in a separate thread"), NULL },
   { "clutter-use-fuzzy-picking", 0, 0, G_OPTION_ARG_NONE,
     &clutter_use_fuzzy_picking,
     N_("Use 'fuzzy' picking"), NULL },
@@ -1327,6 +1435,8 @@ pre_parse_hook (GOptionContext  *context,
   if (clutter_is_initialized)
     return TRUE;
 
+  _clutter_startup_phase_begin (CLUTTER_STARTUP_OPTION_PARSING);
+
   if (setlocale (LC_ALL, "") == NULL)
     g_warning ("Locale not supported by C library.\n"
                "Using the fallback 'C' locale.");
@@ -1360,6 +1470,16 @@ pre_parse_hook (GOptionContext  *context,
                               G_N_ELEMENTS (clutter_profile_keys));
       env_string = NULL;
     }
+
+  /* the frame whose allocations are printed with their backtrace */
+  env_string = g_getenv ("CLUTTER_PROFILE_ALLOC_FRAME");
+  if (env_string != NULL)
+    {
+      gint frame = g_ascii_strtoll (env_string, NULL, 10);
+
+      clutter_profile_alloc_frame = MAX (frame, 0);
+      env_string = NULL;
+    }
 #endif /* CLUTTER_ENABLE_PROFILE */
 
   env_string = g_getenv ("CLUTTER_PICK");
@@ -1386,6 +1506,10 @@ pre_parse_hook (GOptionContext  *context,
   if (env_string)
     clutter_show_fps = TRUE;
 
+  env_string = g_getenv ("CLUTTER_SHOW_STARTUP");
+  if (env_string)
+    clutter_profile_flags |= CLUTTER_PROFILE_STARTUP;
+
   env_string = g_getenv ("CLUTTER_DEFAULT_FPS");
   if (env_string)
     {
@@ -1394,10 +1518,42 @@ pre_parse_hook (GOptionContext  *context,
       clutter_default_fps = CLAMP (default_fps, 1, 1000);
     }
 
+  env_string = g_getenv ("CLUTTER_SIZE_CACHE_SIZE");
+  if (env_string)
+    {
+      gint cache_size = g_ascii_strtoll (env_string, NULL, 10);
+
+      clutter_size_cache_size = CLAMP (cache_size, 1, 256);
+    }
+
+  env_string = g_getenv ("CLUTTER_SUBTREE_CACHE_BUDGET");
+  if (env_string)
+    {
+      gint budget = g_ascii_strtoll (env_string, NULL, 10);
+
+      clutter_subtree_cache_budget = CLAMP (budget, 0, G_MAXINT / 1024);
+    }
+
+  env_string = g_getenv ("CLUTTER_TRACE");
+  if (env_string != NULL && *env_string != '\0')
+    _clutter_trace_init (env_string);
+
+  env_string = g_getenv ("CLUTTER_FIXED_FRAME_TIME");
+  if (env_string)
+    {
+      gint frame_time = g_ascii_strtoll (env_string, NULL, 10);
+
+      clutter_fixed_frame_time = CLAMP (frame_time, 0, 1000);
+    }
+
   env_string = g_getenv ("CLUTTER_DISABLE_MIPMAPPED_TEXT");
   if (env_string)
     clutter_disable_mipmap_text = TRUE;
 
+  env_string = g_getenv ("CLUTTER_DISABLE_FONT_PRELOAD");
+  if (env_string)
+    clutter_disable_font_preload = TRUE;
+
   env_string = g_getenv ("CLUTTER_FUZZY_PICK");
   if (env_string)
     clutter_use_fuzzy_picking = TRUE;
@@ -1420,6 +1576,8 @@ post_parse_hook (GOptionContext  *context,
   if (clutter_is_initialized)
     return TRUE;
 
+  _clutter_startup_phase_end (CLUTTER_STARTUP_OPTION_PARSING);
+
   clutter_context = _clutter_context_get_default ();
   backend = clutter_context->backend;
   g_assert (CLUTTER_IS_BACKEND (backend));
@@ -2947,6 +3105,217 @@ _clutter_run_repaint_functions (void)
     context->repaint_funcs = reinvoke_list;
 }
 
+typedef struct _ClutterThreadsUpdate    ClutterThreadsUpdate;
+
+struct _ClutterThreadsUpdate
+{
+  ClutterThreadsUpdate *next;
+
+  ClutterUpdateFunc func;
+  gpointer data;
+  GDestroyNotify notify;
+};
+
+/* the updates posted by the threads and not applied yet, from the
+ * most recent to the oldest; the threads push updates with an atomic
+ * compare-and-exchange of the head, and the main loop takes the whole
+ * list at once, so no lock is needed and no node is ever popped alone
+ */
+static volatile gpointer pending_updates = NULL;
+
+/**
+ * ClutterUpdateFunc:
+ * @data: the data passed to clutter_threads_post_update()
+ *
+ * A function applying an update of the scene posted by a thread using
+ * clutter_threads_post_update(). The function is called from the
+ * thread running the Clutter main loop, with the Clutter lock held.
+ *
+ * Since: 1.8
+ */
+
+/**
+ * clutter_threads_post_update:
+ * @func: the function applying the update
+ * @data: data to pass to @func
+ * @notify: (allow-none): function to call on @data after @func has
+ *   been called, or %NULL
+ *
+ * Posts an update of the scene, like changing the properties of an
+ * actor, uploading the data of a texture or adding rows to a
+ * #ClutterModel, from any thread.
+ *
+ * The updates are applied by the master clock once per frame, from
+ * the thread running the Clutter main loop, before the timelines are
+ * advanced; the updates posted by the same thread are applied in the
+ * same order they were posted. Unlike clutter_threads_add_idle(),
+ * this function does not take the Clutter lock and does not create a
+ * #GSource for each update, so a thread producing many updates neither
+ * waits for the main loop nor floods it.
+ *
+ * Updates posted while the updates of a frame are being applied are
+ * applied in the next frame.
+ *
+ * Since: 1.8
+ */
+void
+clutter_threads_post_update (ClutterUpdateFunc func,
+                             gpointer          data,
+                             GDestroyNotify    notify)
+{
+  ClutterThreadsUpdate *update;
+  gpointer head;
+
+  g_return_if_fail (func != NULL);
+
+  update = g_slice_new (ClutterThreadsUpdate);
+  update->func = func;
+  update->data = data;
+  update->notify = notify;
+
+  do
+    {
+      head = g_atomic_pointer_get (&pending_updates);
+      update->next = head;
+    }
+  while (!g_atomic_pointer_compare_and_exchange (&pending_updates,
+                                                 head,
+                                                 update));
+
+  /* only the first update after the queue was drained needs to wake
+   * up the main loop, so that the master clock runs */
+  if (head == NULL)
+    g_main_context_wakeup (NULL);
+}
+
+typedef struct _ClutterPropertyUpdate
+{
+  GObject *object;
+  const gchar *property_name;
+  GValue value;
+} ClutterPropertyUpdate;
+
+static void
+clutter_property_update_apply (gpointer data)
+{
+  ClutterPropertyUpdate *update = data;
+
+  g_object_set_property (update->object,
+                         update->property_name,
+                         &update->value);
+}
+
+static void
+clutter_property_update_free (gpointer data)
+{
+  ClutterPropertyUpdate *update = data;
+
+  g_object_unref (update->object);
+  g_value_unset (&update->value);
+
+  g_slice_free (ClutterPropertyUpdate, update);
+}
+
+/**
+ * clutter_threads_post_set_property:
+ * @object: a #GObject
+ * @property_name: the name of the property to set
+ * @value: the value of the property
+ *
+ * Posts an update setting @property_name of @object to @value; see
+ * clutter_threads_post_update() for when the update is applied.
+ *
+ * A reference is taken on @object, and @value is copied, so they can
+ * be released by the calling thread as soon as this function returns.
+ *
+ * Since: 1.8
+ */
+void
+clutter_threads_post_set_property (GObject      *object,
+                                   const gchar  *property_name,
+                                   const GValue *value)
+{
+  ClutterPropertyUpdate *update;
+
+  g_return_if_fail (G_IS_OBJECT (object));
+  g_return_if_fail (property_name != NULL);
+  g_return_if_fail (G_IS_VALUE (value));
+
+  update = g_slice_new0 (ClutterPropertyUpdate);
+  update->object = g_object_ref (object);
+  update->property_name = g_intern_string (property_name);
+
+  g_value_init (&update->value, G_VALUE_TYPE (value));
+  g_value_copy (value, &update->value);
+
+  clutter_threads_post_update (clutter_property_update_apply,
+                               update,
+                               clutter_property_update_free);
+}
+
+/*
+ * _clutter_threads_has_pending_updates:
+ *
+ * Checks whether any update was posted using clutter_threads_post_update()
+ * since the last time the updates were applied.
+ *
+ * Return value: %TRUE if there are updates to apply
+ */
+gboolean
+_clutter_threads_has_pending_updates (void)
+{
+  return g_atomic_pointer_get (&pending_updates) != NULL;
+}
+
+/*
+ * _clutter_threads_dispatch_updates:
+ *
+ * Applies the updates posted using clutter_threads_post_update().
+ *
+ * Must be called from the thread running the main loop, with the
+ * Clutter thread lock held.
+ */
+void
+_clutter_threads_dispatch_updates (void)
+{
+  ClutterThreadsUpdate *head, *update, *next;
+
+  /* take the whole list, leaving an empty queue to the threads */
+  do
+    {
+      head = g_atomic_pointer_get (&pending_updates);
+      if (head == NULL)
+        return;
+    }
+  while (!g_atomic_pointer_compare_and_exchange (&pending_updates,
+                                                 head,
+                                                 NULL));
+
+  /* the list goes from the most recent update to the oldest */
+  update = NULL;
+  while (head != NULL)
+    {
+      next = head->next;
+      head->next = update;
+      update = head;
+      head = next;
+    }
+
+  while (update != NULL)
+    {
+      next = update->next;
+
+      update->func (update->data);
+
+      if (update->notify)
+        update->notify (update->data);
+
+      g_slice_free (ClutterThreadsUpdate, update);
+
+      update = next;
+    }
+}
+
 /**
  * clutter_check_version:
  * @major: major version, like 1 in 1.2.3
@@ -3065,6 +3434,75 @@ _clutter_context_get_pick_mode (void)
   return context->pick_mode;
 }
 
+/*< private >
+ * _clutter_context_get_size_cache_size:
+ *
+ * Retrieves the number of size requests that each actor should cache
+ * for each orientation. The value is always a power of two, and it
+ * can be changed using the CLUTTER_SIZE_CACHE_SIZE environment
+ * variable.
+ *
+ * Return value: the size of the per-actor size request cache
+ */
+guint
+_clutter_context_get_size_cache_size (void)
+{
+  static guint cache_size = 0;
+
+  if (G_UNLIKELY (cache_size == 0))
+    {
+      cache_size = 1;
+      while (cache_size < clutter_size_cache_size)
+        cache_size <<= 1;
+    }
+
+  return cache_size;
+}
+
+/*< private >
+ * _clutter_context_get_subtree_cache_budget:
+ *
+ * Retrieves the number of bytes that can be used by the offscreen
+ * buffers caching the image of actors that do not change while one
+ * of their ancestors moves. The value can be changed, in kilobytes,
+ * using the CLUTTER_SUBTREE_CACHE_BUDGET environment variable.
+ *
+ * Return value: the budget of the subtree cache, in bytes
+ */
+gsize
+_clutter_context_get_subtree_cache_budget (void)
+{
+  return (gsize) clutter_subtree_cache_budget * 1024;
+}
+
+/*< private >
+ * _clutter_context_get_fixed_frame_time:
+ *
+ * Retrieves the simulated duration of each frame, in milliseconds, set
+ * using the CLUTTER_FIXED_FRAME_TIME environment variable.
+ *
+ * When it is not 0 the master clock does not follow the wall clock: it
+ * advances the timelines by exactly this amount on each iteration and
+ * it starts the next frame as soon as the previous one is done, so
+ * that the same scene always goes through the same frames regardless
+ * of how long each of them takes to draw.
+ *
+ * Return value: the simulated frame time, or 0 to use the wall clock
+ */
+guint
+_clutter_context_get_fixed_frame_time (void)
+{
+  return clutter_fixed_frame_time;
+}
+
+guint
+_clutter_context_get_pick_index_stamp (void)
+{
+  ClutterMainContext *context = _clutter_context_get_default ();
+
+  return context->pick_index_stamp;
+}
+
 void
 _clutter_context_push_shader_stack (ClutterActor *actor)
 {
@@ -76,6 +76,8 @@ GQuark clutter_init_error_quark (void);
  */
 #define CLUTTER_PRIORITY_REDRAW         (G_PRIORITY_HIGH_IDLE + 50)
 
+typedef void (* ClutterUpdateFunc) (gpointer data);
+
 /* Initialisation */
 void             clutter_base_init        (void);
 ClutterInitError clutter_init             (int          *argc,
@@ -143,6 +145,13 @@ guint            clutter_threads_add_repaint_func      (GSourceFunc    func,
                                                         GDestroyNotify notify);
 void             clutter_threads_remove_repaint_func   (guint          handle_id);
 
+void             clutter_threads_post_update           (ClutterUpdateFunc func,
+                                                        gpointer          data,
+                                                        GDestroyNotify    notify);
+void             clutter_threads_post_set_property     (GObject          *object,
+                                                        const gchar      *property_name,
+                                                        const GValue     *value);
+
 void             clutter_set_motion_events_enabled   (gboolean enable);
 gboolean         clutter_get_motion_events_enabled   (void);
 
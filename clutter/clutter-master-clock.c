@@ -36,6 +36,7 @@
 #endif
 
 #include "clutter-master-clock.h"
+#include "clutter-animation-private.h"
 #include "clutter-debug.h"
 #include "clutter-private.h"
 #include "clutter-profile.h"
@@ -62,11 +63,34 @@ struct _ClutterMasterClock
   /* the previous state of the clock, in usecs, used to compute the delta */
   gint64 prev_tick;
 
+  /* the time at which the last frame was presented, in usecs, or 0 if
+   * the backend cannot tell
+   */
+  gint64 presentation_time;
+
+  /* the measured interval between two presented frames, in usecs */
+  gint64 refresh_interval;
+
+  /* the measured time we need to process events and update the stages
+   * for a frame, in usecs
+   */
+  gint64 render_budget;
+
   /* an idle source, used by the Master Clock to queue
    * a redraw on the stage and drive the animations
    */
   GSource *source;
 
+  /* the last stage redrawn by the clock; it is only compared with
+   * the other stages, and never dereferenced
+   */
+  gpointer last_updated_stage;
+
+  /* the stages updated by the current frame; it is kept across
+   * frames, so that the dispatch does not allocate
+   */
+  GPtrArray *due_stages;
+
   /* If the master clock is idle that means it has
    * fallen back to idle polling for timeline
    * progressions and it may have been some time since
@@ -74,6 +98,11 @@ struct _ClutterMasterClock
    */
   guint idle : 1;
   guint ensure_next_iteration : 1;
+
+  /* whether the backend suspended the clock, because nothing can
+   * be drawn
+   */
+  guint paused : 1;
 };
 
 struct _ClutterMasterClockClass
@@ -106,6 +135,14 @@ static GSourceFuncs clock_funcs = {
 
 G_DEFINE_TYPE (ClutterMasterClock, clutter_master_clock, G_TYPE_OBJECT);
 
+/* the time we leave between the end of a frame and the vblank, to
+ * absorb the variance of the frame times, in usecs */
+#define RENDER_BUDGET_MARGIN    2000
+
+/* presentation intervals longer than this are considered idle periods
+ * and are not used to measure the refresh rate, in usecs */
+#define MAX_REFRESH_INTERVAL    (G_USEC_PER_SEC / 10)
+
 /*
  * master_clock_is_running:
  * @master_clock: a #ClutterMasterClock
@@ -123,13 +160,16 @@ master_clock_is_running (ClutterMasterClock *master_clock)
   const GSList *stages, *l;
   gboolean stage_free = FALSE;
 
+  if (master_clock->paused)
+    return FALSE;
+
   stages = clutter_stage_manager_peek_stages (stage_manager);
 
   /* If all of the stages are busy waiting for a swap-buffers to complete
    * then we stop the master clock... */
   for (l = stages; l != NULL; l = l->next)
     {
-      if (_clutter_stage_get_pending_swaps (l->data) == 0)
+      if (_clutter_stage_has_free_back_buffer (l->data))
         {
           stage_free = TRUE;
           break;
@@ -142,6 +182,14 @@ master_clock_is_running (ClutterMasterClock *master_clock)
   if (master_clock->timelines)
     return TRUE;
 
+  /* the frame sources are dispatched on every frame */
+  if (_clutter_frame_sources_pending ())
+    return TRUE;
+
+  /* updates posted by other threads are applied at the next frame */
+  if (_clutter_threads_has_pending_updates ())
+    return TRUE;
+
   for (l = stages; l; l = l->next)
     {
       if (_clutter_stage_has_queued_events (l->data) ||
@@ -158,6 +206,258 @@ master_clock_is_running (ClutterMasterClock *master_clock)
   return FALSE;
 }
 
+/*
+ * master_clock_next_timelines_deadline:
+ * @master_clock: a #ClutterMasterClock
+ *
+ * Computes how long the master clock can sleep while it is idle,
+ * without delaying anything the running timelines would report.
+ *
+ * Return value: the number of milliseconds before one of the timelines
+ *   needs to be advanced, or 0 if they need to be advanced at each frame
+ */
+static guint
+master_clock_next_timelines_deadline (ClutterMasterClock *master_clock)
+{
+  ClutterStageManager *stage_manager = clutter_stage_manager_get_default ();
+  const GSList *l;
+  guint deadline = G_MAXUINT;
+
+  if (master_clock->ensure_next_iteration ||
+      _clutter_threads_has_pending_updates ())
+    return 0;
+
+  for (l = clutter_stage_manager_peek_stages (stage_manager);
+       l != NULL;
+       l = l->next)
+    {
+      if (_clutter_stage_has_queued_events (l->data) ||
+          _clutter_stage_needs_update (l->data))
+        return 0;
+    }
+
+  for (l = master_clock->timelines; l != NULL; l = l->next)
+    {
+      deadline = MIN (deadline, _clutter_timeline_get_next_deadline (l->data));
+      if (deadline == 0)
+        break;
+    }
+
+  return deadline == G_MAXUINT ? 0 : deadline;
+}
+
+/*
+ * master_clock_deadline_delay:
+ * @master_clock: a #ClutterMasterClock
+ * @presentation_time: the time at which the last frame was presented
+ * @refresh_interval: the interval between two presented frames
+ * @now: the current time, in usecs
+ *
+ * Computes how long we can wait before we need to start the next frame
+ * to have it ready for the next vblank, using the presentation times
+ * reported by the backend and the measured cost of a frame. Starting as
+ * late as possible reduces the latency between input and output.
+ *
+ * Return value: the number of microseconds to wait, or 0 if the next
+ *   frame should be started immediately
+ */
+static gint64
+master_clock_deadline_delay (ClutterMasterClock *master_clock,
+                             gint64              presentation_time,
+                             gint64              refresh_interval,
+                             gint64              now)
+{
+  gint64 next_presentation, start;
+
+  if (presentation_time == 0 || refresh_interval == 0)
+    return 0;
+
+  next_presentation = presentation_time + refresh_interval;
+
+  start = next_presentation
+        - master_clock->render_budget
+        - RENDER_BUDGET_MARGIN;
+
+  /* if we are already late for the next vblank we don't wait for the
+   * one after it, as that would halve the frame rate */
+  if (start <= now)
+    return 0;
+
+  return start - now;
+}
+
+/*
+ * master_clock_stage_deadline_delay:
+ * @master_clock: a #ClutterMasterClock
+ * @stage: a #ClutterStage
+ * @now: the current time, in usecs
+ *
+ * Computes how long we can wait before drawing the next frame of
+ * @stage, using the presentation times of the output it is shown on;
+ * each stage follows the refresh rate of its own output, and falls
+ * back to the presentation times of every stage if the backend did
+ * not report any for it.
+ *
+ * Return value: the number of microseconds to wait, or 0 if the next
+ *   frame of @stage should be started immediately
+ */
+static gint64
+master_clock_stage_deadline_delay (ClutterMasterClock *master_clock,
+                                   ClutterStage       *stage,
+                                   gint64              now)
+{
+  gint64 presentation_time, refresh_interval;
+
+  presentation_time = clutter_stage_get_presentation_time (stage);
+  refresh_interval = _clutter_stage_get_refresh_interval (stage);
+
+  if (presentation_time == 0 || refresh_interval == 0)
+    {
+      presentation_time = master_clock->presentation_time;
+      refresh_interval = master_clock->refresh_interval;
+    }
+
+  return master_clock_deadline_delay (master_clock,
+                                      presentation_time,
+                                      refresh_interval,
+                                      now);
+}
+
+/*
+ * master_clock_stage_wants_frame:
+ * @master_clock: a #ClutterMasterClock
+ * @stage: a #ClutterStage
+ *
+ * Checks whether @stage has anything to do in the next frame: events
+ * to process, a redraw or a relayout, or timelines that may queue one.
+ *
+ * Return value: %TRUE if the next frame of @stage should be scheduled
+ */
+static gboolean
+master_clock_stage_wants_frame (ClutterMasterClock *master_clock,
+                                ClutterStage       *stage)
+{
+  GSList *l;
+
+  if (_clutter_stage_has_queued_events (stage) ||
+      _clutter_stage_needs_update (stage))
+    return TRUE;
+
+  for (l = master_clock->timelines; l != NULL; l = l->next)
+    {
+      ClutterStage *timeline_stage = clutter_timeline_get_stage (l->data);
+
+      if (timeline_stage == NULL || timeline_stage == stage)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+/*
+ * master_clock_next_deadline_delay:
+ * @master_clock: a #ClutterMasterClock
+ * @now: the current time, in usecs
+ *
+ * Computes how long we can wait before the first of the stages that
+ * have something to draw needs to start its next frame.
+ *
+ * Return value: the number of microseconds to wait, or 0 if a frame
+ *   should be started immediately
+ */
+static gint64
+master_clock_next_deadline_delay (ClutterMasterClock *master_clock,
+                                  gint64              now)
+{
+  ClutterStageManager *stage_manager = clutter_stage_manager_get_default ();
+  const GSList *l;
+  gint64 delay = -1;
+
+  if (master_clock->ensure_next_iteration ||
+      _clutter_threads_has_pending_updates ())
+    return 0;
+
+  for (l = clutter_stage_manager_peek_stages (stage_manager);
+       l != NULL;
+       l = l->next)
+    {
+      gint64 stage_delay;
+
+      if (!_clutter_stage_has_free_back_buffer (l->data) ||
+          !master_clock_stage_wants_frame (master_clock, l->data))
+        continue;
+
+      stage_delay = master_clock_stage_deadline_delay (master_clock,
+                                                       l->data,
+                                                       now);
+      if (delay < 0 || stage_delay < delay)
+        delay = stage_delay;
+
+      if (delay == 0)
+        break;
+    }
+
+  return delay < 0 ? 0 : delay;
+}
+
+/*
+ * master_clock_stage_is_due:
+ * @master_clock: a #ClutterMasterClock
+ * @stage: a #ClutterStage
+ * @was_idle: whether the clock was idle when the frame was scheduled
+ * @now: the current time, in usecs
+ *
+ * Checks whether the frame of @stage should be drawn by the current
+ * iteration of the clock, or whether @stage should wait for the
+ * deadline of its own output.
+ *
+ * Return value: %TRUE if @stage should be updated now
+ */
+static gboolean
+master_clock_stage_is_due (ClutterMasterClock *master_clock,
+                           ClutterStage       *stage,
+                           gboolean            was_idle,
+                           gint64              now)
+{
+  if (!_clutter_stage_has_free_back_buffer (stage))
+    return FALSE;
+
+  if (!clutter_feature_available (CLUTTER_FEATURE_SYNC_TO_VBLANK) ||
+      was_idle)
+    return TRUE;
+
+  /* the main loop only has a resolution of milliseconds */
+  return master_clock_stage_deadline_delay (master_clock, stage, now) < 1000;
+}
+
+/*
+ * master_clock_predict_presentation:
+ * @presentation_time: the time at which the last frame was presented
+ * @refresh_interval: the interval between two presented frames
+ * @now: the current time, in usecs
+ *
+ * Return value: the first vblank after @now, or 0 if it is not known
+ */
+static gint64
+master_clock_predict_presentation (gint64 presentation_time,
+                                   gint64 refresh_interval,
+                                   gint64 now)
+{
+  gint64 next_presentation;
+
+  if (presentation_time == 0 || refresh_interval == 0)
+    return 0;
+
+  next_presentation = presentation_time + refresh_interval;
+
+  /* skip the vblanks we have already missed */
+  if (next_presentation <= now)
+    next_presentation += ((now - next_presentation) / refresh_interval + 1)
+                       * refresh_interval;
+
+  return next_presentation;
+}
+
 /*
  * master_clock_next_frame_delay:
  * @master_clock: a #ClutterMasterClock
@@ -175,6 +475,15 @@ master_clock_next_frame_delay (ClutterMasterClock *master_clock)
   if (!master_clock_is_running (master_clock))
     return -1;
 
+  /* With a simulated frame time the timelines do not follow the wall
+   * clock, so there is nothing to wait for
+   */
+  if (_clutter_context_get_fixed_frame_time () != 0)
+    {
+      CLUTTER_NOTE (SCHEDULER, "fixed frame time, no delay");
+      return 0;
+    }
+
   /* When we have sync-to-vblank, we count on swap-buffer requests (or
    * swap-buffer-complete events if supported in the backend) to throttle our
    * frame rate so no additional delay is needed to start the next frame.
@@ -190,6 +499,28 @@ master_clock_next_frame_delay (ClutterMasterClock *master_clock)
   if (clutter_feature_available (CLUTTER_FEATURE_SYNC_TO_VBLANK) &&
       !master_clock->idle)
     {
+      gint64 deadline_delay;
+
+      /* If the backend tells us when frames get presented we can wait
+       * until just enough time is left to draw the next frame before
+       * the vblank, instead of drawing it as soon as the last swap
+       * completed; with stages on outputs running at different rates
+       * we wake up for the first of their deadlines
+       */
+      deadline_delay =
+        master_clock_next_deadline_delay (master_clock,
+                                          _clutter_util_get_monotonic_time ());
+
+      /* the main loop only has a resolution of milliseconds */
+      if (deadline_delay >= 1000)
+        {
+          CLUTTER_NOTE (SCHEDULER, "Waiting %" G_GINT64_FORMAT " msecs "
+                        "for the next frame deadline",
+                        deadline_delay / 1000);
+
+          return deadline_delay / 1000;
+        }
+
       CLUTTER_NOTE (SCHEDULER, "vblank available and updated stages");
       return 0;
     }
@@ -229,6 +560,24 @@ master_clock_next_frame_delay (ClutterMasterClock *master_clock)
 
   next += (1000000L / clutter_get_default_frame_rate ());
 
+  /* If the last frame did not update any stage we can sleep until the
+   * first timeline has something to report, instead of polling at the
+   * default frame rate
+   */
+  if (master_clock->idle)
+    {
+      guint deadline = master_clock_next_timelines_deadline (master_clock);
+
+      if (deadline > 0)
+        {
+          CLUTTER_NOTE (SCHEDULER, "Idle until the next timeline deadline "
+                        "in %u msecs",
+                        deadline);
+
+          next = MAX (next, master_clock->prev_tick + (gint64) deadline * 1000);
+        }
+    }
+
   if (next <= now)
     {
       CLUTTER_NOTE (SCHEDULER, "Less than %lu microsecs",
@@ -299,6 +648,74 @@ clutter_clock_check (GSource *source)
   return delay == 0;
 }
 
+/* finds the position of the last stage updated in @stages, so that
+ * it can be updated first; the stages before it are updated last, in
+ * the same order
+ */
+static guint
+clutter_master_clock_get_first_stage (ClutterMasterClock *master_clock,
+                                      GPtrArray          *stages)
+{
+  guint i;
+
+  if (master_clock->last_updated_stage == NULL)
+    return 0;
+
+  for (i = 0; i < stages->len; i++)
+    {
+      if (g_ptr_array_index (stages, i) == master_clock->last_updated_stage)
+        return i;
+    }
+
+  return 0;
+}
+
+/*
+ * clutter_master_clock_advance_stage:
+ * @master_clock: a #ClutterMasterClock
+ * @stage: a #ClutterStage
+ *
+ * Advances the timelines bound to @stage, using the time at which the
+ * frame that is about to be drawn for @stage is going to be presented
+ * on its output, so that they move by a whole number of refresh cycles
+ * of that output at each frame.
+ */
+static void
+clutter_master_clock_advance_stage (ClutterMasterClock *master_clock,
+                                    ClutterStage       *stage)
+{
+  GSList *timelines = NULL, *l;
+  gint64 tick;
+
+  /* see _clutter_master_clock_advance() */
+  for (l = master_clock->timelines; l != NULL; l = l->next)
+    {
+      if (clutter_timeline_get_stage (l->data) == stage)
+        timelines = g_slist_prepend (timelines, g_object_ref (l->data));
+    }
+
+  if (timelines == NULL)
+    return;
+
+  if (_clutter_context_get_fixed_frame_time () != 0)
+    tick = 0;
+  else
+    tick =
+      master_clock_predict_presentation (clutter_stage_get_presentation_time (stage),
+                                         _clutter_stage_get_refresh_interval (stage),
+                                         master_clock->cur_tick);
+  if (tick == 0)
+    tick = master_clock->cur_tick;
+
+  for (l = timelines; l != NULL; l = l->next)
+    _clutter_timeline_do_tick (l->data, tick / 1000);
+
+  g_slist_foreach (timelines, (GFunc) g_object_unref, NULL);
+  g_slist_free (timelines);
+
+  _clutter_animation_engine_advance ();
+}
+
 static gboolean
 clutter_clock_dispatch (GSource     *source,
                         GSourceFunc  callback,
@@ -308,7 +725,14 @@ clutter_clock_dispatch (GSource     *source,
   ClutterMasterClock *master_clock = clock_source->master_clock;
   ClutterStageManager *stage_manager = clutter_stage_manager_get_default ();
   gboolean stages_updated = FALSE;
-  GSList *stages, *l;
+  gboolean stages_pending = FALSE;
+  gboolean was_idle;
+  ClutterAllocPhase old_phase;
+  ClutterStage * const *stages;
+  GPtrArray *due_stages = master_clock->due_stages;
+  guint n_stages, first_stage, i;
+  gint64 dispatch_start;
+  gint64 timeline_start, timeline_time;
 
   CLUTTER_STATIC_TIMER (master_dispatch_timer,
                         "Mainloop",
@@ -320,11 +744,18 @@ clutter_clock_dispatch (GSource     *source,
                         "Event Processing",
                         "The time spent processing events on all stages",
                         0);
+  CLUTTER_STATIC_COUNTER (master_idle_wakeup_counter,
+                          "Master clock idle wake-ups",
+                          "Increments each time the master clock runs "
+                          "without updating any stage",
+                          0 /* no application private data */);
 
   CLUTTER_TIMER_START (_clutter_uprof_context, master_dispatch_timer);
 
   CLUTTER_NOTE (SCHEDULER, "Master clock [tick]");
 
+  dispatch_start = _clutter_util_get_monotonic_time ();
+
   clutter_threads_enter ();
 
   /* Get the time to use for this frame */
@@ -339,58 +770,158 @@ clutter_clock_dispatch (GSource     *source,
   }
 #endif
 
-  /* We need to protect ourselves against stages being destroyed during
-   * event handling
+  /* A simulated frame time makes the sequence of ticks, and thus the
+   * state of every animation on each frame, independent from how long
+   * the frames take to draw
    */
-  stages = clutter_stage_manager_list_stages (stage_manager);
-  g_slist_foreach (stages, (GFunc) g_object_ref, NULL);
+  if (_clutter_context_get_fixed_frame_time () != 0 &&
+      master_clock->prev_tick != 0)
+    {
+      master_clock->cur_tick = master_clock->prev_tick
+                             + _clutter_context_get_fixed_frame_time () * 1000;
+    }
 
-  CLUTTER_TIMER_START (_clutter_uprof_context, master_event_process);
+  /* We need to protect ourselves against stages being destroyed during
+   * event handling; the snapshot of the stage manager keeps them alive
+   * until the end of the iteration
+   */
+  stages = _clutter_stage_manager_begin_iteration (stage_manager, &n_stages);
 
+  was_idle = master_clock->idle;
   master_clock->idle = FALSE;
 
-  /* Process queued events */
-  for (l = stages; l != NULL; l = l->next)
+  /* Each stage is drawn in time for the vblank of its own output, so
+   * we only update the stages whose deadline has been reached; the
+   * others are left for a later iteration of the clock.
+   *
+   * NB: If a stage is busy waiting for a swap-buffers completion then
+   * we don't process its events so we can maximize the benefits of
+   * motion compression, and avoid multiple picks per frame.
+   */
+  g_ptr_array_set_size (due_stages, 0);
+  for (i = 0; i < n_stages; i++)
     {
-      /* NB: If a stage is busy waiting for a swap-buffers completion then
-       * we don't process its events so we can maximize the benefits of
-       * motion compression, and avoid multiple picks per frame.
-       */
-      if (_clutter_stage_get_pending_swaps (l->data) == 0)
-        _clutter_stage_process_queued_events (l->data);
+      if (master_clock_stage_is_due (master_clock, stages[i],
+                                     was_idle,
+                                     dispatch_start))
+        g_ptr_array_add (due_stages, stages[i]);
+      else if (_clutter_stage_has_free_back_buffer (stages[i]) &&
+               master_clock_stage_wants_frame (master_clock, stages[i]))
+        stages_pending = TRUE;
     }
 
+  CLUTTER_TIMER_START (_clutter_uprof_context, master_event_process);
+
+  /* Process queued events */
+  old_phase = _clutter_alloc_phase_push (CLUTTER_ALLOC_PHASE_EVENTS);
+  for (i = 0; i < due_stages->len; i++)
+    _clutter_stage_process_queued_events (g_ptr_array_index (due_stages, i));
+  _clutter_alloc_phase_pop (old_phase);
+
   CLUTTER_TIMER_STOP (_clutter_uprof_context, master_event_process);
 
+  /* Apply the updates posted by other threads, so that the timelines
+   * and the stages see the new state of the scene
+   */
+  _clutter_threads_dispatch_updates ();
+
+  /* The frame sources are called right before the timelines, with the
+   * same frame time, so that what they change is painted by this frame
+   */
+  _clutter_frame_sources_dispatch (master_clock->cur_tick);
+
+  timeline_start = _clutter_util_get_monotonic_time ();
+  old_phase = _clutter_alloc_phase_push (CLUTTER_ALLOC_PHASE_TIMELINES);
   _clutter_master_clock_advance (master_clock);
+  _clutter_alloc_phase_pop (old_phase);
+  timeline_time = _clutter_util_get_monotonic_time () - timeline_start;
 
   _clutter_run_repaint_functions ();
 
+  /* The stages share the GL context, and making it current on the
+   * surface of another stage can be expensive; we start with the
+   * stage updated last in the previous frame, whose surface is still
+   * current, so that updating N stages only needs N - 1 switches.
+   */
+  first_stage = clutter_master_clock_get_first_stage (master_clock,
+                                                      due_stages);
+
   /* Update any stage that needs redraw/relayout after the clock
    * is advanced.
+   *
+   * If all the back buffers of a stage are waiting for a swap-buffers
+   * to complete we don't want to draw to it in case the driver may
+   * block the CPU while it waits for the next backbuffer to become
+   * available; such stages are never due.
+   *
+   * When running triple or N buffered we can still draw while up to
+   * N-1 swaps are pending, so we can hopefully always be ready to
+   * swap for the next vblank and really match the vsync frequency.
+   *
+   * The paint and the swap stay on this thread: Cogl is not thread
+   * safe, the paint functions of the actors call it directly, and
+   * only the subtrees made of recordable actors can be turned into a
+   * display list; the work that does not need GL can be moved to
+   * other threads and applied with clutter_threads_post_update()
+   * instead, so that it overlaps with the frame being drawn.
    */
-  for (l = stages; l != NULL; l = l->next)
+  for (i = 0; i < due_stages->len; i++)
     {
-      /* If a stage has a swap-buffers pending we don't want to draw to it
-       * in case the driver may block the CPU while it waits for the next
-       * backbuffer to become available.
-       *
-       * TODO: We should be able to identify if we are running triple or N
-       * buffered and in these cases we can still draw if there is 1 swap
-       * pending so we can hopefully always be ready to swap for the next
-       * vblank and really match the vsync frequency.
-       */
-      if (_clutter_stage_get_pending_swaps (l->data) == 0)
-        stages_updated |= _clutter_stage_do_update (l->data);
+      ClutterStage *stage;
+      gint64 stage_timeline_time;
+
+      stage = g_ptr_array_index (due_stages,
+                                 (first_stage + i) % due_stages->len);
+
+      /* the timelines bound to the stage follow its own frame clock */
+      timeline_start = _clutter_util_get_monotonic_time ();
+      old_phase = _clutter_alloc_phase_push (CLUTTER_ALLOC_PHASE_TIMELINES);
+      clutter_master_clock_advance_stage (master_clock, stage);
+      _clutter_alloc_phase_pop (old_phase);
+      stage_timeline_time = _clutter_util_get_monotonic_time ()
+                          - timeline_start;
+
+      _clutter_stage_add_timeline_time (stage,
+                                        timeline_time + stage_timeline_time);
+
+      _clutter_trace_set_stage (stage);
+
+      if (_clutter_stage_do_update (stage))
+        {
+          master_clock->last_updated_stage = stage;
+          stages_updated = TRUE;
+        }
     }
 
+  _clutter_trace_set_stage (NULL);
+
+  g_ptr_array_set_size (due_stages, 0);
+
   /* The master clock goes idle if no stages were updated and falls back
-   * to polling for timeline progressions... */
-  if (!stages_updated)
-    master_clock->idle = TRUE;
+   * to polling for timeline progressions; a stage waiting for the
+   * deadline of its own output will wake the clock up anyway... */
+  if (!stages_updated && !stages_pending)
+    {
+      CLUTTER_COUNTER_INC (_clutter_uprof_context, master_idle_wakeup_counter);
+      CLUTTER_NOTE (SCHEDULER, "No stage updated by this frame");
 
-  g_slist_foreach (stages, (GFunc) g_object_unref, NULL);
-  g_slist_free (stages);
+      master_clock->idle = TRUE;
+    }
+  else
+    {
+      gint64 frame_time = _clutter_util_get_monotonic_time () - dispatch_start;
+
+      if (stages_updated)
+        _clutter_alloc_tracking_frame_end ();
+
+      /* the budget follows the slowest recent frames closely, and
+       * decays slowly when frames get cheaper */
+      master_clock->render_budget -= master_clock->render_budget / 16;
+      if (frame_time > master_clock->render_budget)
+        master_clock->render_budget = frame_time;
+    }
+
+  _clutter_stage_manager_end_iteration (stage_manager);
 
   master_clock->prev_tick = master_clock->cur_tick;
 
@@ -407,6 +938,7 @@ clutter_master_clock_finalize (GObject *gobject)
   ClutterMasterClock *master_clock = CLUTTER_MASTER_CLOCK (gobject);
 
   g_slist_free (master_clock->timelines);
+  g_ptr_array_free (master_clock->due_stages, TRUE);
 
   G_OBJECT_CLASS (clutter_master_clock_parent_class)->finalize (gobject);
 }
@@ -430,6 +962,8 @@ clutter_master_clock_init (ClutterMasterClock *self)
   self->idle = FALSE;
   self->ensure_next_iteration = FALSE;
 
+  self->due_stages = g_ptr_array_new ();
+
   g_source_set_priority (source, CLUTTER_PRIORITY_REDRAW);
   g_source_set_can_recurse (source, FALSE);
   g_source_attach (source, NULL);
@@ -513,13 +1047,144 @@ _clutter_master_clock_start_running (ClutterMasterClock *master_clock)
   g_main_context_wakeup (NULL);
 }
 
+/*
+ * _clutter_master_clock_set_paused:
+ * @master_clock: a #ClutterMasterClock
+ * @paused: whether the clock should be suspended
+ *
+ * Suspends or resumes @master_clock. The backends suspend the clock
+ * while their surfaces cannot be drawn, for instance when the
+ * application is in the background; a suspended clock does not
+ * advance the timelines, nor update the stages, and does not wake
+ * up the main loop at all.
+ *
+ * Since the vblanks are not tracked while the clock is suspended,
+ * the last presentation time is discarded when it is resumed.
+ */
+void
+_clutter_master_clock_set_paused (ClutterMasterClock *master_clock,
+                                  gboolean            paused)
+{
+  g_return_if_fail (CLUTTER_IS_MASTER_CLOCK (master_clock));
+
+  paused = !!paused;
+
+  if (master_clock->paused == paused)
+    return;
+
+  master_clock->paused = paused;
+
+  CLUTTER_NOTE (SCHEDULER, "Master clock %s",
+                paused ? "suspended" : "resumed");
+
+  if (!paused)
+    {
+      master_clock->presentation_time = 0;
+      master_clock->prev_tick = 0;
+
+      _clutter_master_clock_start_running (master_clock);
+    }
+}
+
+/*
+ * _clutter_master_clock_update_refresh_interval:
+ * @refresh_interval: the current estimate of the refresh interval, or 0
+ * @last_presentation_time: the time at which the previous frame was
+ *   presented, or 0
+ * @presentation_time: the time at which the last frame was presented
+ *
+ * Updates the estimate of the interval between two vblanks of an
+ * output with the presentation time of a new frame.
+ *
+ * Return value: the new estimate of the refresh interval, in usecs
+ */
+gint64
+_clutter_master_clock_update_refresh_interval (gint64 refresh_interval,
+                                               gint64 last_presentation_time,
+                                               gint64 presentation_time)
+{
+  gint64 interval = presentation_time - last_presentation_time;
+
+  if (last_presentation_time == 0 ||
+      interval <= 0 ||
+      interval >= MAX_REFRESH_INTERVAL)
+    return refresh_interval;
+
+  /* frames that missed a vblank are presented two or more intervals
+   * apart, so we ignore them once we have an estimate */
+  if (refresh_interval == 0)
+    return interval;
+
+  if (interval < refresh_interval * 3 / 2)
+    return (refresh_interval * 7 + interval) / 8;
+
+  return refresh_interval;
+}
+
+/*
+ * _clutter_master_clock_presented:
+ * @master_clock: a #ClutterMasterClock
+ * @presentation_time: the time at which a frame was presented, in
+ *   microseconds, as returned by g_get_monotonic_time()
+ *
+ * Called by the stages when the backend notifies that a frame has
+ * been presented on the screen. The presentation times are used to
+ * schedule the next frames as close to the vblank as possible.
+ */
+void
+_clutter_master_clock_presented (ClutterMasterClock *master_clock,
+                                 gint64              presentation_time)
+{
+  master_clock->refresh_interval =
+    _clutter_master_clock_update_refresh_interval (master_clock->refresh_interval,
+                                                   master_clock->presentation_time,
+                                                   presentation_time);
+  master_clock->presentation_time = presentation_time;
+
+  CLUTTER_NOTE (SCHEDULER,
+                "Frame presented at %" G_GINT64_FORMAT " usecs "
+                "(refresh interval: %" G_GINT64_FORMAT " usecs, "
+                "render budget: %" G_GINT64_FORMAT " usecs)",
+                presentation_time,
+                master_clock->refresh_interval,
+                master_clock->render_budget);
+}
+
+/*
+ * _clutter_master_clock_get_next_presentation_time:
+ * @master_clock: a #ClutterMasterClock
+ *
+ * Estimates the time at which the next frame is going to be presented,
+ * using the presentation times reported by the backend or, if the
+ * backend does not report them, the default frame rate.
+ *
+ * Return value: the estimated presentation time of the next frame, in
+ *   microseconds, using the same clock as g_get_monotonic_time()
+ */
+gint64
+_clutter_master_clock_get_next_presentation_time (ClutterMasterClock *master_clock)
+{
+  gint64 now = g_get_monotonic_time ();
+  gint64 next_presentation;
+
+  next_presentation =
+    master_clock_predict_presentation (master_clock->presentation_time,
+                                       master_clock->refresh_interval,
+                                       now);
+  if (next_presentation == 0)
+    return now + G_USEC_PER_SEC / clutter_get_default_frame_rate ();
+
+  return next_presentation;
+}
+
 /*
  * _clutter_master_clock_advance:
  * @master_clock: a #ClutterMasterClock
  *
- * Advances all the timelines held by the master clock. This function
- * should be called before calling clutter_redraw() to make sure that
- * all the timelines are advanced and the scene is updated.
+ * Advances all the timelines held by the master clock that are not
+ * bound to a stage. This function should be called before calling
+ * clutter_redraw() to make sure that all the timelines are advanced
+ * and the scene is updated.
  */
 void
 _clutter_master_clock_advance (ClutterMasterClock *master_clock)
@@ -560,11 +1225,23 @@ _clutter_master_clock_advance (ClutterMasterClock *master_clock)
   g_slist_foreach (timelines, (GFunc) g_object_ref, NULL);
 
   for (l = timelines; l != NULL; l = l->next)
-    _clutter_timeline_do_tick (l->data, master_clock->cur_tick / 1000);
+    {
+      /* the timelines bound to a stage are advanced right before it
+       * is updated, by clutter_master_clock_advance_stage() */
+      if (clutter_timeline_get_stage (l->data) != NULL)
+        continue;
+
+      _clutter_timeline_do_tick (l->data, master_clock->cur_tick / 1000);
+    }
 
   g_slist_foreach (timelines, (GFunc) g_object_unref, NULL);
   g_slist_free (timelines);
 
+  /* once all the timelines have been advanced we can update all the
+   * properties animated by ClutterAnimation in a single pass
+   */
+  _clutter_animation_engine_advance ();
+
   CLUTTER_TIMER_STOP (_clutter_uprof_context, master_timeline_advance);
 }
 
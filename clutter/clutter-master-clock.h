@@ -44,6 +44,15 @@ void                _clutter_master_clock_remove_timeline       (ClutterMasterCl
 void                _clutter_master_clock_advance               (ClutterMasterClock *master_clock);
 void                _clutter_master_clock_start_running         (ClutterMasterClock *master_clock);
 void                _clutter_master_clock_ensure_next_iteration (ClutterMasterClock *master_clock);
+void                _clutter_master_clock_set_paused            (ClutterMasterClock *master_clock,
+                                                                 gboolean            paused);
+void                _clutter_master_clock_presented             (ClutterMasterClock *master_clock,
+                                                                 gint64              presentation_time);
+gint64              _clutter_master_clock_get_next_presentation_time (ClutterMasterClock *master_clock);
+
+gint64              _clutter_master_clock_update_refresh_interval (gint64 refresh_interval,
+                                                                   gint64 last_presentation_time,
+                                                                   gint64 presentation_time);
 
 
 G_END_DECLS
@@ -22,6 +22,8 @@ void     clutter_model_set_column_name (ClutterModel *model,
 void    clutter_model_iter_set_row (ClutterModelIter *iter,
                                     guint             row);
 
+guint   _clutter_model_get_filter_stamp (ClutterModel *model);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_MODEL_PRIVATE_H__ */
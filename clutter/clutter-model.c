@@ -164,6 +164,7 @@
 #include "clutter-model.h"
 #include "clutter-model-private.h"
 
+#include "clutter-job.h"
 #include "clutter-marshal.h"
 #include "clutter-private.h"
 #include "clutter-debug.h"
@@ -187,6 +188,7 @@ enum
 enum
 {
   ROW_ADDED,
+  ROWS_ADDED,
   ROW_REMOVED,
   ROW_CHANGED,
 
@@ -201,6 +203,8 @@ static guint model_signals[LAST_SIGNAL] = { 0, };
 #define CLUTTER_MODEL_GET_PRIVATE(obj) \
   (G_TYPE_INSTANCE_GET_PRIVATE ((obj), CLUTTER_TYPE_MODEL, ClutterModelPrivate))
 
+typedef struct _AsyncUpdate     AsyncUpdate;
+
 struct _ClutterModelPrivate
 {
   GType                  *column_types;
@@ -219,13 +223,48 @@ struct _ClutterModelPrivate
   ClutterModelFilterFunc  filter_func;
   gpointer                filter_data;
   GDestroyNotify          filter_notify;
+  guint                   filter_stamp;
 
   gint                    sort_column;
   ClutterModelSortFunc    sort_func;
   gpointer                sort_data;
   GDestroyNotify          sort_notify;
+
+  /* the sort or filter being computed by a worker thread */
+  AsyncUpdate            *async_update;
+  guint                   async_job_id;
 };
 
+/* the models that do not implement the cursor virtual functions are
+ * read through a #ClutterModelIter created for each access */
+static gboolean
+clutter_model_real_cursor_seek (ClutterModel       *model,
+                                ClutterModelCursor *cursor,
+                                guint               row)
+{
+  return row < clutter_model_get_n_rows (model);
+}
+
+static void
+clutter_model_real_cursor_get_value (ClutterModel       *model,
+                                     ClutterModelCursor *cursor,
+                                     guint               column,
+                                     GValue             *value)
+{
+  ClutterModelIterClass *klass;
+  ClutterModelIter *iter;
+
+  iter = clutter_model_get_iter_at_row (model, cursor->row);
+  if (iter == NULL)
+    return;
+
+  klass = CLUTTER_MODEL_ITER_GET_CLASS (iter);
+  if (klass->get_value)
+    klass->get_value (iter, column, value);
+
+  g_object_unref (iter);
+}
+
 static GType
 clutter_model_real_get_column_type (ClutterModel *model,
                                     guint         column)
@@ -353,6 +392,8 @@ clutter_model_class_init (ClutterModelClass *klass)
   klass->get_column_type  = clutter_model_real_get_column_type;
   klass->get_n_columns    = clutter_model_real_get_n_columns;
   klass->get_n_rows       = clutter_model_real_get_n_rows;
+  klass->cursor_seek      = clutter_model_real_cursor_seek;
+  klass->cursor_get_value = clutter_model_real_cursor_get_value;
 
   /**
    * ClutterModel:filter-set:
@@ -391,6 +432,33 @@ clutter_model_class_init (ClutterModelClass *klass)
                   _clutter_marshal_VOID__OBJECT,
                   G_TYPE_NONE, 1,
                   CLUTTER_TYPE_MODEL_ITER);
+  /**
+   * ClutterModel::rows-added:
+   * @model: the #ClutterModel on which the signal is emitted
+   * @first_row: the position of the first added row
+   * @n_rows: the number of added rows
+   *
+   * The ::rows-added signal is emitted once by clutter_model_append_rows()
+   * after all the rows have been appended, instead of emitting the
+   * #ClutterModel::row-added signal for each row.
+   *
+   * The rows were appended at the positions from @first_row to
+   * @first_row + @n_rows - 1, ignoring any filter; if the model is
+   * sorted, the rows have already been moved to their sorted positions
+   * when the signal is emitted.
+   *
+   * Since: 1.8
+   */
+  model_signals[ROWS_ADDED] =
+    g_signal_new ("rows-added",
+                  G_TYPE_FROM_CLASS (gobject_class),
+                  G_SIGNAL_RUN_LAST,
+                  G_STRUCT_OFFSET (ClutterModelClass, rows_added),
+                  NULL, NULL,
+                  _clutter_marshal_VOID__UINT_UINT,
+                  G_TYPE_NONE, 2,
+                  G_TYPE_UINT,
+                  G_TYPE_UINT);
    /**
    * ClutterModel::row-removed:
    * @model: the #ClutterModel on which the signal is emitted
@@ -778,6 +846,31 @@ clutter_model_resort (ClutterModel *model)
     klass->resort (model, priv->sort_func, priv->sort_data);
 }
 
+/*
+ * clutter_model_resort_row:
+ * @model: a #ClutterModel
+ * @iter: the row that was added, or whose sorting column changed
+ *
+ * Moves the row pointed by @iter to its sorted position. Since every
+ * other row is already sorted, sub-classes implementing the
+ * ClutterModelClass.resort_row() virtual function can do this without
+ * sorting the whole model; otherwise, we fall back to a full resort.
+ */
+static void
+clutter_model_resort_row (ClutterModel     *model,
+                          ClutterModelIter *iter)
+{
+  ClutterModelPrivate *priv = model->priv;
+  ClutterModelClass *klass;
+
+  klass = CLUTTER_MODEL_GET_CLASS (model);
+
+  if (klass->resort_row != NULL && priv->sort_func != NULL)
+    klass->resort_row (model, iter, priv->sort_func, priv->sort_data);
+  else
+    clutter_model_resort (model);
+}
+
 /**
  * clutter_model_filter_row:
  * @model: a #ClutterModel
@@ -1062,11 +1155,84 @@ clutter_model_appendv (ClutterModel *model,
   g_signal_emit (model, model_signals[ROW_ADDED], 0, iter);
 
   if (resort)
-    clutter_model_resort (model);
+    clutter_model_resort_row (model, iter);
 
   g_object_unref (iter);
 }
 
+/**
+ * clutter_model_append_rows:
+ * @model: a #ClutterModel
+ * @n_rows: the number of rows to append
+ * @n_columns: the number of columns to set on each row
+ * @columns: (array length=n_columns): a vector with the columns to set
+ * @values: (array): a vector with @n_rows times @n_columns values, with
+ *   the values of the first row followed by the values of the second
+ *   row, and so on
+ *
+ * Appends @n_rows new rows to @model, setting the values for the given
+ * @columns of each row upon creation.
+ *
+ * Unlike calling clutter_model_appendv() for each row, this function
+ * sorts @model only once, after all the rows have been appended, and
+ * it emits the #ClutterModel::rows-added signal once instead of
+ * emitting the #ClutterModel::row-added signal for each row.
+ *
+ * Since: 1.8
+ */
+void
+clutter_model_append_rows (ClutterModel *model,
+                           guint         n_rows,
+                           guint         n_columns,
+                           guint        *columns,
+                           GValue       *values)
+{
+  ClutterModelPrivate *priv;
+  ClutterModelClass *klass;
+  gboolean resort = FALSE;
+  guint first_row = 0;
+  guint row, i;
+
+  g_return_if_fail (CLUTTER_IS_MODEL (model));
+  g_return_if_fail (n_columns <= clutter_model_get_n_columns (model));
+  g_return_if_fail (n_columns == 0 || columns != NULL);
+  g_return_if_fail (n_rows == 0 || n_columns == 0 || values != NULL);
+
+  if (n_rows == 0)
+    return;
+
+  priv = model->priv;
+  klass = CLUTTER_MODEL_GET_CLASS (model);
+
+  for (i = 0; i < n_columns; i++)
+    {
+      if (priv->sort_column == columns[i])
+        resort = TRUE;
+    }
+
+  for (row = 0; row < n_rows; row++)
+    {
+      ClutterModelIter *iter;
+
+      iter = klass->insert_row (model, -1);
+      g_assert (CLUTTER_IS_MODEL_ITER (iter));
+
+      if (row == 0)
+        first_row = clutter_model_iter_get_row (iter);
+
+      for (i = 0; i < n_columns; i++)
+        clutter_model_iter_set_value (iter, columns[i],
+                                      &values[row * n_columns + i]);
+
+      g_object_unref (iter);
+    }
+
+  if (resort)
+    clutter_model_resort (model);
+
+  g_signal_emit (model, model_signals[ROWS_ADDED], 0, first_row, n_rows);
+}
+
 /* forward declaration */
 static void clutter_model_iter_set_internal_valist (ClutterModelIter *iter,
                                                     va_list           args);
@@ -1156,7 +1322,7 @@ clutter_model_prependv (ClutterModel *model,
   g_signal_emit (model, model_signals[ROW_ADDED], 0, iter);
 
   if (resort)
-    clutter_model_resort (model);
+    clutter_model_resort_row (model, iter);
 
   g_object_unref (iter);
 }
@@ -1294,7 +1460,7 @@ clutter_model_insertv (ClutterModel *model,
   g_signal_emit (model, model_signals[ROW_ADDED], 0, iter);
 
   if (resort)
-    clutter_model_resort (model);
+    clutter_model_resort_row (model, iter);
 
   g_object_unref (iter);
 }
@@ -1343,7 +1509,7 @@ clutter_model_insert_value (ClutterModel *model,
     g_signal_emit (model, model_signals[ROW_ADDED], 0, iter);
 
   if (priv->sort_column == column)
-    clutter_model_resort (model);
+    clutter_model_resort_row (model, iter);
 
   g_object_unref (iter);
 }
@@ -1635,6 +1801,553 @@ clutter_model_foreach (ClutterModel            *model,
   g_object_unref (iter);
 }
 
+/* a filter using the value of a single column, set using
+ * clutter_model_set_filter_async()
+ */
+typedef struct _ValueFilter
+{
+  guint column;
+  ClutterModelValueFilterFunc func;
+  gpointer data;
+  GDestroyNotify notify;
+} ValueFilter;
+
+/* the sort and the filter requested using the _async() variants, the
+ * copy of the columns they use, and the results computed by the worker
+ * thread; the functions of the requests are owned by the update until
+ * they are installed in the model
+ */
+struct _AsyncUpdate
+{
+  ClutterModel *model;
+
+  /* set when the rows change after the columns were copied */
+  guint is_stale : 1;
+
+  guint has_sort : 1;
+  guint has_filter : 1;
+
+  gint sort_column;
+  ClutterModelSortFunc sort_func;
+  gpointer sort_data;
+  GDestroyNotify sort_notify;
+
+  ValueFilter *filter;
+
+  guint n_rows;
+  GValue *sort_values;
+  GValue *filter_values;
+
+  guint *new_order;
+  gboolean *visible;
+};
+
+static void
+value_filter_free (ValueFilter *filter)
+{
+  if (filter->notify != NULL)
+    filter->notify (filter->data);
+
+  g_slice_free (ValueFilter, filter);
+}
+
+/* evaluates a filter set using clutter_model_set_filter_async() on a
+ * single row, once the filter has been installed
+ */
+static gboolean
+clutter_model_value_filter (ClutterModel     *model,
+                            ClutterModelIter *iter,
+                            gpointer          data)
+{
+  ValueFilter *filter = data;
+  GValue value = { 0, };
+  gboolean res;
+
+  clutter_model_iter_get_value (iter, filter->column, &value);
+  res = filter->func (&value, filter->data);
+  g_value_unset (&value);
+
+  return res;
+}
+
+static void
+async_update_free_values (GValue *values,
+                          guint   n_values)
+{
+  guint i;
+
+  if (values == NULL)
+    return;
+
+  for (i = 0; i < n_values; i++)
+    {
+      if (G_IS_VALUE (&values[i]))
+        g_value_unset (&values[i]);
+    }
+
+  g_free (values);
+}
+
+/* called from the main loop once the job of @update is over, even
+ * if it was cancelled
+ */
+static void
+async_update_free (gpointer data)
+{
+  AsyncUpdate *update = data;
+
+  if (update->has_sort && update->sort_notify != NULL)
+    update->sort_notify (update->sort_data);
+
+  if (update->filter != NULL)
+    value_filter_free (update->filter);
+
+  async_update_free_values (update->sort_values, update->n_rows);
+  async_update_free_values (update->filter_values, update->n_rows);
+
+  g_free (update->new_order);
+  g_free (update->visible);
+
+  g_object_unref (update->model);
+
+  g_slice_free (AsyncUpdate, update);
+}
+
+static void
+async_update_mark_stale (AsyncUpdate *update)
+{
+  update->is_stale = TRUE;
+}
+
+static const gchar *async_update_signals[] = {
+  "row-added",
+  "rows-added",
+  "row-removed",
+  "row-changed",
+  "sort-changed",
+};
+
+/* cancels the pending asynchronous update of @model, if any, and
+ * returns it; its requests are released once its worker thread is
+ * done with them, unless they are moved to another update first
+ */
+static AsyncUpdate *
+clutter_model_detach_async_update (ClutterModel *model)
+{
+  ClutterModelPrivate *priv = model->priv;
+  AsyncUpdate *update = priv->async_update;
+  guint i;
+
+  if (update == NULL)
+    return NULL;
+
+  clutter_job_cancel (priv->async_job_id);
+  priv->async_job_id = 0;
+  priv->async_update = NULL;
+
+  for (i = 0; i < G_N_ELEMENTS (async_update_signals); i++)
+    g_signal_handlers_disconnect_by_func (model,
+                                          async_update_mark_stale,
+                                          update);
+
+  return update;
+}
+
+/*
+ * clutter_model_take_async_update:
+ * @model: a #ClutterModel
+ * @keep_sort: whether the pending sort is still wanted
+ * @keep_filter: whether the pending filter is still wanted
+ *
+ * Cancels the pending asynchronous update of @model, if any, and
+ * returns a new update holding the requests that are still wanted.
+ *
+ * Return value: a new update, which can be empty
+ */
+static AsyncUpdate *
+clutter_model_take_async_update (ClutterModel *model,
+                                 gboolean      keep_sort,
+                                 gboolean      keep_filter)
+{
+  AsyncUpdate *old_update;
+  AsyncUpdate *update;
+
+  update = g_slice_new0 (AsyncUpdate);
+  update->model = g_object_ref (model);
+
+  old_update = clutter_model_detach_async_update (model);
+  if (old_update == NULL)
+    return update;
+
+  if (keep_sort && old_update->has_sort)
+    {
+      update->has_sort = TRUE;
+      update->sort_column = old_update->sort_column;
+      update->sort_func = old_update->sort_func;
+      update->sort_data = old_update->sort_data;
+      update->sort_notify = old_update->sort_notify;
+
+      old_update->has_sort = FALSE;
+    }
+
+  if (keep_filter && old_update->has_filter)
+    {
+      update->has_filter = TRUE;
+      update->filter = old_update->filter;
+
+      old_update->has_filter = FALSE;
+      old_update->filter = NULL;
+    }
+
+  return update;
+}
+
+static gint
+async_update_compare_rows (gconstpointer a,
+                           gconstpointer b,
+                           gpointer      data)
+{
+  AsyncUpdate *update = data;
+  guint row_a = *((const guint *) a);
+  guint row_b = *((const guint *) b);
+  gint res;
+
+  res = update->sort_func (update->model,
+                           &update->sort_values[row_a],
+                           &update->sort_values[row_b],
+                           update->sort_data);
+  if (res != 0)
+    return res;
+
+  /* keep the rows that compare equal in their current order */
+  return row_a < row_b ? -1 : 1;
+}
+
+/* runs in a worker thread, using only the copy of the columns */
+static void
+clutter_model_async_update_run (ClutterJob *job,
+                                gpointer    data)
+{
+  AsyncUpdate *update = data;
+  guint i;
+
+  if (update->has_filter)
+    {
+      ValueFilter *filter = update->filter;
+
+      update->visible = g_new (gboolean, update->n_rows);
+
+      for (i = 0; i < update->n_rows; i++)
+        {
+          if (clutter_job_is_cancelled (job))
+            return;
+
+          update->visible[i] = filter->func (&update->filter_values[i],
+                                             filter->data);
+        }
+    }
+
+  if (update->has_sort)
+    {
+      update->new_order = g_new (guint, update->n_rows);
+
+      for (i = 0; i < update->n_rows; i++)
+        update->new_order[i] = i;
+
+      g_qsort_with_data (update->new_order, update->n_rows, sizeof (guint),
+                         async_update_compare_rows,
+                         update);
+    }
+}
+
+static void clutter_model_start_async_update (ClutterModel *model,
+                                              AsyncUpdate  *update);
+
+/* runs in the main loop once the worker thread is done; installs the
+ * sort and the filter, and swaps in the new order of the rows in one
+ * go
+ */
+static void
+clutter_model_async_update_done (ClutterJob *job,
+                                 gpointer    data)
+{
+  AsyncUpdate *update = data;
+  ClutterModel *model = update->model;
+  ClutterModelPrivate *priv = model->priv;
+  gboolean sort_changed, filter_changed;
+
+  if (priv->async_update != update)
+    return;
+
+  /* the results do not match the rows anymore, so we start again
+   * with a new copy of the columns
+   */
+  if (update->is_stale)
+    {
+      CLUTTER_NOTE (MISC, "The model changed while sorting and filtering "
+                    "it, starting again");
+
+      clutter_model_start_async_update (model,
+                                        clutter_model_take_async_update (model,
+                                                                         TRUE,
+                                                                         TRUE));
+      return;
+    }
+
+  clutter_model_detach_async_update (model);
+
+  sort_changed = update->has_sort;
+  filter_changed = update->has_filter;
+
+  if (sort_changed)
+    {
+      if (priv->sort_notify != NULL)
+        priv->sort_notify (priv->sort_data);
+
+      priv->sort_column = update->sort_column;
+      priv->sort_func = update->sort_func;
+      priv->sort_data = update->sort_data;
+      priv->sort_notify = update->sort_notify;
+
+      update->has_sort = FALSE;
+    }
+
+  if (filter_changed)
+    {
+      if (priv->filter_notify != NULL)
+        priv->filter_notify (priv->filter_data);
+
+      priv->filter_func = clutter_model_value_filter;
+      priv->filter_data = update->filter;
+      priv->filter_notify = (GDestroyNotify) value_filter_free;
+      priv->filter_stamp += 1;
+
+      update->filter = NULL;
+    }
+
+  CLUTTER_MODEL_GET_CLASS (model)->reorder_rows (model,
+                                                 update->n_rows,
+                                                 update->new_order,
+                                                 update->visible);
+
+  if (sort_changed)
+    g_signal_emit (model, model_signals[SORT_CHANGED], 0);
+
+  if (filter_changed)
+    {
+      g_signal_emit (model, model_signals[FILTER_CHANGED], 0);
+      g_object_notify (G_OBJECT (model), "filter-set");
+    }
+}
+
+/* copies the columns used by the requests of @update, and hands them
+ * to a worker thread; @update becomes the pending update of @model
+ */
+static void
+clutter_model_start_async_update (ClutterModel *model,
+                                  AsyncUpdate  *update)
+{
+  ClutterModelClass *klass = CLUTTER_MODEL_GET_CLASS (model);
+  ClutterModelPrivate *priv = model->priv;
+  guint i;
+
+  if (!update->has_sort && !update->has_filter)
+    {
+      async_update_free (update);
+      return;
+    }
+
+  if (update->has_sort)
+    update->sort_values = klass->get_column_values (model,
+                                                    update->sort_column,
+                                                    &update->n_rows);
+
+  if (update->has_filter)
+    update->filter_values = klass->get_column_values (model,
+                                                      update->filter->column,
+                                                      &update->n_rows);
+
+  for (i = 0; i < G_N_ELEMENTS (async_update_signals); i++)
+    g_signal_connect_swapped (model, async_update_signals[i],
+                              G_CALLBACK (async_update_mark_stale),
+                              update);
+
+  priv->async_update = update;
+  priv->async_job_id = clutter_job_add_full (G_PRIORITY_DEFAULT,
+                                             clutter_model_async_update_run,
+                                             clutter_model_async_update_done,
+                                             update,
+                                             async_update_free);
+}
+
+/* drops the pending asynchronous sort or filter of @model, once a
+ * synchronous one replaces it
+ */
+static void
+clutter_model_drop_async_update (ClutterModel *model,
+                                 gboolean      drop_sort,
+                                 gboolean      drop_filter)
+{
+  AsyncUpdate *update = model->priv->async_update;
+
+  if (update == NULL)
+    return;
+
+  if (!(drop_sort && update->has_sort) &&
+      !(drop_filter && update->has_filter))
+    return;
+
+  clutter_model_start_async_update (model,
+                                    clutter_model_take_async_update (model,
+                                                                     !drop_sort,
+                                                                     !drop_filter));
+}
+
+static gboolean
+clutter_model_supports_async_update (ClutterModel *model)
+{
+  ClutterModelClass *klass = CLUTTER_MODEL_GET_CLASS (model);
+
+  return klass->get_column_values != NULL && klass->reorder_rows != NULL;
+}
+
+/**
+ * clutter_model_set_sort_async:
+ * @model: a #ClutterModel
+ * @column: the column to sort on
+ * @func: (allow-none): a #ClutterModelSortFunc, or #NULL
+ * @user_data: user data to pass to @func, or #NULL
+ * @notify: destroy notifier of @user_data, or #NULL
+ *
+ * Sorts @model using the given sorting function, like
+ * clutter_model_set_sort(), without blocking the main loop.
+ *
+ * The values of @column are copied, and sorted by a worker thread;
+ * @func is called from that thread, so it must not use @model, or any
+ * other Clutter API. Once they are sorted, the rows are moved to their
+ * new position at once, and the #ClutterModel::sort-changed signal is
+ * emitted; until then, @model keeps the previous sorting. If the rows
+ * change in the meantime, the values are copied and sorted again.
+ *
+ * Once the sort is installed, the rows added or changed afterwards
+ * are sorted from the main loop, like with clutter_model_set_sort().
+ *
+ * If the model does not implement the
+ * #ClutterModelClass.get_column_values() and
+ * #ClutterModelClass.reorder_rows() virtual functions, or if @func
+ * is %NULL, this function is equivalent to clutter_model_set_sort().
+ *
+ * Since: 1.8
+ */
+void
+clutter_model_set_sort_async (ClutterModel         *model,
+                              gint                  column,
+                              ClutterModelSortFunc  func,
+                              gpointer              user_data,
+                              GDestroyNotify        notify)
+{
+  AsyncUpdate *update;
+
+  g_return_if_fail (CLUTTER_IS_MODEL (model));
+  g_return_if_fail ((func != NULL && column >= 0) ||
+                    (func == NULL && column == -1));
+
+  if (func == NULL || !clutter_model_supports_async_update (model))
+    {
+      clutter_model_set_sort (model, column, func, user_data, notify);
+      return;
+    }
+
+  if (column >= clutter_model_get_n_columns (model))
+    {
+      g_warning ("%s: Invalid column id value %d\n", G_STRLOC, column);
+      return;
+    }
+
+  update = clutter_model_take_async_update (model, FALSE, TRUE);
+  update->has_sort = TRUE;
+  update->sort_column = column;
+  update->sort_func = func;
+  update->sort_data = user_data;
+  update->sort_notify = notify;
+
+  clutter_model_start_async_update (model, update);
+}
+
+/**
+ * clutter_model_set_filter_async:
+ * @model: a #ClutterModel
+ * @column: the column to filter on
+ * @func: (allow-none): a #ClutterModelValueFilterFunc, or #NULL
+ * @user_data: user data to pass to @func, or #NULL
+ * @notify: destroy notifier of @user_data, or #NULL
+ *
+ * Filters @model using the value of @column in each row, without
+ * blocking the main loop.
+ *
+ * The values of @column are copied, and filtered by a worker thread;
+ * @func is called from that thread, so it must not use any Clutter
+ * API. Once all the rows are filtered, the filter is installed at
+ * once, and the #ClutterModel::filter-changed signal is emitted; until
+ * then, @model keeps the previous filter. If the rows change in the
+ * meantime, the values are copied and filtered again.
+ *
+ * Once the filter is installed, the rows added or changed afterwards
+ * are filtered from the main loop, like with clutter_model_set_filter().
+ *
+ * If @func is %NULL, the filter is removed right away. If the model
+ * does not implement the #ClutterModelClass.get_column_values() and
+ * #ClutterModelClass.reorder_rows() virtual functions, the filter is
+ * installed right away, like with clutter_model_set_filter().
+ *
+ * Since: 1.8
+ */
+void
+clutter_model_set_filter_async (ClutterModel                *model,
+                                guint                        column,
+                                ClutterModelValueFilterFunc  func,
+                                gpointer                     user_data,
+                                GDestroyNotify               notify)
+{
+  AsyncUpdate *update;
+  ValueFilter *filter;
+
+  g_return_if_fail (CLUTTER_IS_MODEL (model));
+
+  if (func == NULL)
+    {
+      clutter_model_set_filter (model, NULL, NULL, NULL);
+      return;
+    }
+
+  if (column >= clutter_model_get_n_columns (model))
+    {
+      g_warning ("%s: Invalid column id value %u\n", G_STRLOC, column);
+      return;
+    }
+
+  filter = g_slice_new (ValueFilter);
+  filter->column = column;
+  filter->func = func;
+  filter->data = user_data;
+  filter->notify = notify;
+
+  if (!clutter_model_supports_async_update (model))
+    {
+      clutter_model_set_filter (model,
+                                clutter_model_value_filter,
+                                filter,
+                                (GDestroyNotify) value_filter_free);
+      return;
+    }
+
+  update = clutter_model_take_async_update (model, TRUE, FALSE);
+  update->has_filter = TRUE;
+  update->filter = filter;
+
+  clutter_model_start_async_update (model, update);
+}
+
 /**
  * clutter_model_set_sort:
  * @model: a #ClutterModel
@@ -1662,6 +2375,8 @@ clutter_model_set_sort (ClutterModel         *model,
 
   priv = model->priv;
 
+  clutter_model_drop_async_update (model, TRUE, FALSE);
+
   if (priv->sort_notify)
     priv->sort_notify (priv->sort_data);
 
@@ -1695,12 +2410,15 @@ clutter_model_set_filter (ClutterModel           *model,
   g_return_if_fail (CLUTTER_IS_MODEL (model));
   priv = model->priv;
 
+  clutter_model_drop_async_update (model, FALSE, TRUE);
+
   if (priv->filter_notify)
     priv->filter_notify (priv->filter_data);
 
   priv->filter_func = func;
   priv->filter_data = user_data;
   priv->filter_notify = notify;
+  priv->filter_stamp += 1;
 
   g_signal_emit (model, model_signals[FILTER_CHANGED], 0);
   g_object_notify (G_OBJECT (model), "filter-set");
@@ -1725,6 +2443,225 @@ clutter_model_get_filter_set (ClutterModel *model)
   return model->priv->filter_func != NULL;
 }
 
+/*< private >
+ * _clutter_model_get_filter_stamp:
+ * @model: a #ClutterModel
+ *
+ * Retrieves a counter that is increased each time the filter of
+ * @model changes. Sub-classes can use it to know when the results
+ * of the filter they cached are no longer valid.
+ *
+ * Return value: the filter stamp
+ */
+guint
+_clutter_model_get_filter_stamp (ClutterModel *model)
+{
+  return model->priv->filter_stamp;
+}
+
+static gboolean
+clutter_model_cursor_seek (ClutterModelCursor *cursor,
+                           guint               row)
+{
+  ClutterModelClass *klass = CLUTTER_MODEL_GET_CLASS (cursor->model);
+
+  if (!klass->cursor_seek (cursor->model, cursor, row))
+    return FALSE;
+
+  cursor->row = row;
+
+  return TRUE;
+}
+
+/**
+ * clutter_model_get_cursor_at_row:
+ * @model: a #ClutterModel
+ * @row: position of the row
+ * @cursor: (out caller-allocates): the #ClutterModelCursor to initialize
+ *
+ * Initializes @cursor to the row of @model at the given index; like
+ * clutter_model_get_iter_at_row(), the index takes into account the
+ * filter set using clutter_model_set_filter().
+ *
+ * The cursor does not need to be freed; it can be moved using
+ * clutter_model_cursor_next() and clutter_model_cursor_prev(). If
+ * the rows of @model change while the cursor is in use, the cursor
+ * keeps pointing at the same index.
+ *
+ * Return value: %TRUE if @cursor was initialized, and %FALSE if @row
+ *   was out of bounds
+ *
+ * Since: 1.8
+ */
+gboolean
+clutter_model_get_cursor_at_row (ClutterModel       *model,
+                                 guint               row,
+                                 ClutterModelCursor *cursor)
+{
+  g_return_val_if_fail (CLUTTER_IS_MODEL (model), FALSE);
+  g_return_val_if_fail (cursor != NULL, FALSE);
+
+  cursor->model = model;
+  cursor->row = 0;
+  cursor->stamp = 0;
+  cursor->dummy1 = NULL;
+  cursor->dummy2 = NULL;
+
+  return clutter_model_cursor_seek (cursor, row);
+}
+
+/**
+ * clutter_model_cursor_next:
+ * @cursor: a #ClutterModelCursor
+ *
+ * Moves @cursor to the next row of the model.
+ *
+ * Return value: %TRUE if @cursor was moved, and %FALSE if it was
+ *   already at the last row, in which case it is left unchanged
+ *
+ * Since: 1.8
+ */
+gboolean
+clutter_model_cursor_next (ClutterModelCursor *cursor)
+{
+  g_return_val_if_fail (cursor != NULL, FALSE);
+  g_return_val_if_fail (CLUTTER_IS_MODEL (cursor->model), FALSE);
+
+  return clutter_model_cursor_seek (cursor, cursor->row + 1);
+}
+
+/**
+ * clutter_model_cursor_prev:
+ * @cursor: a #ClutterModelCursor
+ *
+ * Moves @cursor to the previous row of the model.
+ *
+ * Return value: %TRUE if @cursor was moved, and %FALSE if it was
+ *   already at the first row, in which case it is left unchanged
+ *
+ * Since: 1.8
+ */
+gboolean
+clutter_model_cursor_prev (ClutterModelCursor *cursor)
+{
+  g_return_val_if_fail (cursor != NULL, FALSE);
+  g_return_val_if_fail (CLUTTER_IS_MODEL (cursor->model), FALSE);
+
+  if (cursor->row == 0)
+    return FALSE;
+
+  return clutter_model_cursor_seek (cursor, cursor->row - 1);
+}
+
+/**
+ * clutter_model_cursor_get_row:
+ * @cursor: a #ClutterModelCursor
+ *
+ * Retrieves the index of the row @cursor points to.
+ *
+ * Return value: the index of the row
+ *
+ * Since: 1.8
+ */
+guint
+clutter_model_cursor_get_row (const ClutterModelCursor *cursor)
+{
+  g_return_val_if_fail (cursor != NULL, 0);
+
+  return cursor->row;
+}
+
+/**
+ * clutter_model_cursor_get_value:
+ * @cursor: a #ClutterModelCursor
+ * @column: column number to retrieve the value from
+ * @value: (out): an empty #GValue to set
+ *
+ * Initializes @value to the type of @column and sets it to the value
+ * of @column in the row @cursor points to. When done with @value,
+ * g_value_unset() needs to be called to free any allocated memory.
+ *
+ * Since: 1.8
+ */
+void
+clutter_model_cursor_get_value (ClutterModelCursor *cursor,
+                                guint               column,
+                                GValue             *value)
+{
+  ClutterModel *model;
+
+  g_return_if_fail (cursor != NULL);
+  g_return_if_fail (CLUTTER_IS_MODEL (cursor->model));
+
+  model = cursor->model;
+
+  g_value_init (value, clutter_model_get_column_type (model, column));
+
+  CLUTTER_MODEL_GET_CLASS (model)->cursor_get_value (model, cursor,
+                                                     column,
+                                                     value);
+}
+
+/**
+ * clutter_model_cursor_get:
+ * @cursor: a #ClutterModelCursor
+ * @Varargs: a list of column/return location pairs, terminated by -1
+ *
+ * Gets the value of one or more cells in the row @cursor points to,
+ * like clutter_model_iter_get() does for a #ClutterModelIter.
+ *
+ * Since: 1.8
+ */
+void
+clutter_model_cursor_get (ClutterModelCursor *cursor,
+                          ...)
+{
+  ClutterModel *model;
+  va_list args;
+  gint column;
+
+  g_return_if_fail (cursor != NULL);
+  g_return_if_fail (CLUTTER_IS_MODEL (cursor->model));
+
+  model = cursor->model;
+
+  va_start (args, cursor);
+
+  column = va_arg (args, gint);
+
+  while (column != -1)
+    {
+      GValue value = { 0, };
+      gchar *error = NULL;
+
+      if (column < 0 || column >= clutter_model_get_n_columns (model))
+        {
+          g_warning ("%s: Invalid column number %d added to cursor "
+                     "(remember to end you list of columns with a -1)",
+                     G_STRLOC, column);
+          break;
+        }
+
+      clutter_model_cursor_get_value (cursor, column, &value);
+
+      G_VALUE_LCOPY (&value, args, 0, &error);
+      if (error)
+        {
+          g_warning ("%s: %s", G_STRLOC, error);
+          g_free (error);
+
+          /* Leak value as it might not be in a sane state */
+          break;
+        }
+
+      g_value_unset (&value);
+
+      column = va_arg (args, gint);
+    }
+
+  va_end (args);
+}
+
 /*
  * ClutterModelIter Object 
  */
@@ -2034,7 +2971,7 @@ clutter_model_iter_set_internal_valist (ClutterModelIter *iter,
 
   priv->ignore_sort = FALSE;
   if (sort)
-    clutter_model_resort (model);
+    clutter_model_resort_row (model, iter);
 }
 
 /**
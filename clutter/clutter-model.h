@@ -47,6 +47,7 @@ typedef struct _ClutterModelPrivate     ClutterModelPrivate;
 typedef struct _ClutterModelIter        ClutterModelIter;
 typedef struct _ClutterModelIterClass   ClutterModelIterClass;
 typedef struct _ClutterModelIterPrivate ClutterModelIterPrivate;
+typedef struct _ClutterModelCursor      ClutterModelCursor;
 
 
 /**
@@ -84,6 +85,22 @@ typedef gint (*ClutterModelSortFunc) (ClutterModel *model,
                                       const GValue *b,
                                       gpointer      user_data);
 
+/**
+ * ClutterModelValueFilterFunc:
+ * @value: the value of the filtered column in a row
+ * @user_data: data passed to clutter_model_set_filter_async()
+ *
+ * Filters a row of the model using the value of a single column. The
+ * function is called from a worker thread, so it must not use any
+ * Clutter API.
+ *
+ * Return value: If the row should be displayed, return %TRUE
+ *
+ * Since: 1.8
+ */
+typedef gboolean (*ClutterModelValueFilterFunc) (const GValue *value,
+                                                 gpointer      user_data);
+
 /**
  * ClutterModelForeachFunc:
  * @model: a #ClutterModel
@@ -117,6 +134,30 @@ struct _ClutterModel
   ClutterModelPrivate *priv;
 };
 
+/**
+ * ClutterModelCursor:
+ *
+ * A lightweight reference to a row of a #ClutterModel, in the style of
+ * #GtkTreeIter. Unlike #ClutterModelIter, a #ClutterModelCursor is not
+ * a #GObject: it can be allocated on the stack and it does not need to
+ * be freed, so that scanning a model does not allocate memory for each
+ * row.
+ *
+ * The #ClutterModelCursor structure contains only private data and
+ * should be initialized using clutter_model_get_cursor_at_row().
+ *
+ * Since: 1.8
+ */
+struct _ClutterModelCursor
+{
+  /*< private >*/
+  ClutterModel *model;
+  guint row;
+  guint stamp;
+  gpointer dummy1;
+  gpointer dummy2;
+};
+
 /**
  * ClutterModelClass:
  * @row_added: signal class handler for ClutterModel::row-added
@@ -124,6 +165,7 @@ struct _ClutterModel
  * @row_changed: signal class handler for ClutterModel::row-changed
  * @sort_changed: signal class handler for ClutterModel::sort-changed
  * @filter_changed: signal class handler for ClutterModel::filter-changed
+ * @rows_added: signal class handler for ClutterModel::rows-added. Since: 1.8
  * @get_column_name: virtual function for returning the name of a column
  * @get_column_type: virtual function for returning the type of a column
  * @get_iter_at_row: virtual function for returning an iterator for the
@@ -138,6 +180,30 @@ struct _ClutterModel
  *   and returning an iterator pointing to it; if the index is a negative
  *   integer, the row should be appended to the model
  * @remove_row: virtual function for removing a row at the given index
+ * @resort_row: virtual function for moving a single row to its position
+ *   inside a model that is otherwise sorted using the passed sorting
+ *   function; if not implemented, #ClutterModelClass.resort() will be
+ *   used instead. Since: 1.8
+ * @cursor_seek: virtual function for moving a #ClutterModelCursor to
+ *   the given row, returning %FALSE if the row is out of bounds; the
+ *   implementation can use the row the cursor was at before to find
+ *   the new one faster. Since: 1.8
+ * @cursor_get_value: virtual function for retrieving the value of a
+ *   column in the row of a #ClutterModelCursor; @value is already
+ *   initialized to the type of the column. Since: 1.8
+ * @get_column_values: virtual function returning a newly allocated
+ *   array with a copy of the value of a column for every row of the
+ *   model, including the rows hidden by the filter, in the order they
+ *   are stored; the number of rows is returned in @n_rows. Used by
+ *   clutter_model_set_sort_async() and clutter_model_set_filter_async().
+ *   Since: 1.8
+ * @reorder_rows: virtual function for applying the result of
+ *   clutter_model_set_sort_async() and clutter_model_set_filter_async();
+ *   the row that was stored at the position @new_order[i] when the
+ *   values were copied is moved to the position i, and @visible tells,
+ *   for each stored position, whether the row passes the new filter.
+ *   Either array can be %NULL, if the order or the filter did not
+ *   change. Since: 1.8
  *
  * Class for #ClutterModel instances.
  *
@@ -176,14 +242,35 @@ struct _ClutterModelClass
   void              (* sort_changed)    (ClutterModel     *model);
   void              (* filter_changed)  (ClutterModel     *model);
 
+  /* vtable */
+  void              (* resort_row)      (ClutterModel         *model,
+                                         ClutterModelIter     *iter,
+                                         ClutterModelSortFunc  func,
+                                         gpointer              data);
+
+  /* signals */
+  void              (* rows_added)      (ClutterModel     *model,
+                                         guint             first_row,
+                                         guint             n_rows);
+
+  /* vtable */
+  gboolean          (* cursor_seek)      (ClutterModel       *model,
+                                          ClutterModelCursor *cursor,
+                                          guint               row);
+  void              (* cursor_get_value) (ClutterModel       *model,
+                                          ClutterModelCursor *cursor,
+                                          guint               column,
+                                          GValue             *value);
+  GValue *          (* get_column_values) (ClutterModel     *model,
+                                           guint             column,
+                                           guint            *n_rows);
+  void              (* reorder_rows)      (ClutterModel     *model,
+                                           guint             n_rows,
+                                           const guint      *new_order,
+                                           const gboolean   *visible);
+
   /*< private >*/
   /* padding for future expansion */
-  void (*_clutter_model_1) (void);
-  void (*_clutter_model_2) (void);
-  void (*_clutter_model_3) (void);
-  void (*_clutter_model_4) (void);
-  void (*_clutter_model_5) (void);
-  void (*_clutter_model_6) (void);
   void (*_clutter_model_7) (void);
   void (*_clutter_model_8) (void);
 };
@@ -203,6 +290,11 @@ void                  clutter_model_appendv            (ClutterModel     *model,
                                                         guint             n_columns,
                                                         guint            *columns,
                                                         GValue           *values);
+void                  clutter_model_append_rows        (ClutterModel     *model,
+                                                        guint             n_rows,
+                                                        guint             n_columns,
+                                                        guint            *columns,
+                                                        GValue           *values);
 void                  clutter_model_prepend            (ClutterModel     *model,
                                                         ...);
 void                  clutter_model_prependv           (ClutterModel     *model,
@@ -253,6 +345,16 @@ void                  clutter_model_set_filter         (ClutterModel     *model,
                                                         gpointer          user_data,
                                                         GDestroyNotify    notify);
 gboolean              clutter_model_get_filter_set     (ClutterModel     *model);
+void                  clutter_model_set_sort_async     (ClutterModel     *model,
+                                                        gint              column,
+                                                        ClutterModelSortFunc func,
+                                                        gpointer          user_data,
+                                                        GDestroyNotify    notify);
+void                  clutter_model_set_filter_async   (ClutterModel     *model,
+                                                        guint             column,
+                                                        ClutterModelValueFilterFunc func,
+                                                        gpointer          user_data,
+                                                        GDestroyNotify    notify);
 
 void                  clutter_model_resort             (ClutterModel     *model);
 gboolean              clutter_model_filter_row         (ClutterModel     *model,
@@ -260,6 +362,18 @@ gboolean              clutter_model_filter_row         (ClutterModel     *model,
 gboolean              clutter_model_filter_iter        (ClutterModel     *model,
                                                         ClutterModelIter *iter);
 
+gboolean              clutter_model_get_cursor_at_row  (ClutterModel       *model,
+                                                        guint               row,
+                                                        ClutterModelCursor *cursor);
+gboolean              clutter_model_cursor_next        (ClutterModelCursor *cursor);
+gboolean              clutter_model_cursor_prev        (ClutterModelCursor *cursor);
+guint                 clutter_model_cursor_get_row     (const ClutterModelCursor *cursor);
+void                  clutter_model_cursor_get         (ClutterModelCursor *cursor,
+                                                        ...);
+void                  clutter_model_cursor_get_value   (ClutterModelCursor *cursor,
+                                                        guint               column,
+                                                        GValue             *value);
+
 /*
  * ClutterModelIter 
  */
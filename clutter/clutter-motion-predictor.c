@@ -0,0 +1,197 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2011  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* This file contains the code used by the actions to predict where
+ * the pointer is going to be when the next frame is presented, given
+ * the latest motion events. The velocity of the pointer is estimated
+ * with a least squares fit on the samples of a short time window, and
+ * the position is extrapolated linearly from the latest sample. */
+
+#include "clutter-motion-predictor.h"
+
+/* only the samples this recent, relative to the latest one, are used
+ * to estimate the velocity, in msecs */
+#define VELOCITY_WINDOW         50
+
+/* we never extrapolate further than this, to limit the overshoot when
+ * the pointer stops or changes direction, in msecs */
+#define MAX_PREDICTION          32
+
+/*< private >
+ * _clutter_motion_predictor_reset:
+ * @predictor: a #ClutterMotionPredictor
+ *
+ * Removes all the samples from @predictor
+ */
+void
+_clutter_motion_predictor_reset (ClutterMotionPredictor *predictor)
+{
+  predictor->n_samples = 0;
+  predictor->next_sample = 0;
+  predictor->last_sample_time = 0;
+}
+
+static void
+clutter_motion_predictor_add_sample (ClutterMotionPredictor *predictor,
+                                     guint32                 time_,
+                                     gfloat                  x,
+                                     gfloat                  y)
+{
+  ClutterMotionSample *sample;
+
+  sample = &predictor->samples[predictor->next_sample];
+  sample->time = time_;
+  sample->x = x;
+  sample->y = y;
+
+  predictor->next_sample =
+    (predictor->next_sample + 1) % CLUTTER_MOTION_PREDICTOR_N_SAMPLES;
+
+  if (predictor->n_samples < CLUTTER_MOTION_PREDICTOR_N_SAMPLES)
+    predictor->n_samples += 1;
+}
+
+/*< private >
+ * _clutter_motion_predictor_add_event:
+ * @predictor: a #ClutterMotionPredictor
+ * @event: a pointer event
+ *
+ * Adds the position of @event, and the motion history of @event if it
+ * is a motion event, to the samples of @predictor
+ */
+void
+_clutter_motion_predictor_add_event (ClutterMotionPredictor *predictor,
+                                     const ClutterEvent     *event)
+{
+  const ClutterMotionSample *history;
+  guint n_history, i;
+  gfloat x, y;
+
+  history = NULL;
+  n_history = 0;
+
+  if (clutter_event_type (event) == CLUTTER_MOTION)
+    history = clutter_event_get_motion_history (event, &n_history);
+
+  for (i = 0; i < n_history; i++)
+    clutter_motion_predictor_add_sample (predictor,
+                                         history[i].time,
+                                         history[i].x,
+                                         history[i].y);
+
+  clutter_event_get_coords (event, &x, &y);
+  clutter_motion_predictor_add_sample (predictor,
+                                       clutter_event_get_time (event),
+                                       x, y);
+
+  predictor->last_sample_time = g_get_monotonic_time ();
+}
+
+/*< private >
+ * _clutter_motion_predictor_predict:
+ * @predictor: a #ClutterMotionPredictor
+ * @target_time: the time for which the position should be predicted,
+ *   in microseconds, using the same clock as g_get_monotonic_time()
+ * @x: (out): return location for the X coordinate
+ * @y: (out): return location for the Y coordinate
+ *
+ * Extrapolates the position of the pointer at @target_time from the
+ * samples of @predictor. If the velocity of the pointer cannot be
+ * estimated, the position of the latest sample is returned.
+ *
+ * Return value: %TRUE if the position was computed, and %FALSE if
+ *   @predictor does not have any sample
+ */
+gboolean
+_clutter_motion_predictor_predict (ClutterMotionPredictor *predictor,
+                                   gint64                  target_time,
+                                   gfloat                 *x,
+                                   gfloat                 *y)
+{
+  const ClutterMotionSample *last;
+  gdouble sum_t, sum_x, sum_y, sum_tt, sum_tx, sum_ty;
+  gdouble horizon, denom;
+  guint i, n;
+
+  if (predictor->n_samples == 0)
+    return FALSE;
+
+  last = &predictor->samples[(predictor->next_sample +
+                              CLUTTER_MOTION_PREDICTOR_N_SAMPLES - 1) %
+                             CLUTTER_MOTION_PREDICTOR_N_SAMPLES];
+
+  *x = last->x;
+  *y = last->y;
+
+  horizon = (gdouble) (target_time - predictor->last_sample_time) / 1000.0;
+  if (horizon <= 0)
+    return TRUE;
+
+  horizon = MIN (horizon, MAX_PREDICTION);
+
+  /* the pointer has been still for a while */
+  if (target_time - predictor->last_sample_time > VELOCITY_WINDOW * 1000)
+    return TRUE;
+
+  sum_t = sum_x = sum_y = sum_tt = sum_tx = sum_ty = 0;
+  n = 0;
+
+  for (i = 0; i < predictor->n_samples; i++)
+    {
+      const ClutterMotionSample *sample;
+      gdouble t;
+
+      sample = &predictor->samples[(predictor->next_sample +
+                                    CLUTTER_MOTION_PREDICTOR_N_SAMPLES - 1 -
+                                    i) %
+                                   CLUTTER_MOTION_PREDICTOR_N_SAMPLES];
+
+      /* times are relative to the latest sample, and the difference is
+       * computed on signed integers to survive the wrap around */
+      t = (gint32) (sample->time - last->time);
+      if (t > 0 || t < -VELOCITY_WINDOW)
+        break;
+
+      sum_t += t;
+      sum_x += sample->x;
+      sum_y += sample->y;
+      sum_tt += t * t;
+      sum_tx += t * sample->x;
+      sum_ty += t * sample->y;
+      n += 1;
+    }
+
+  if (n < 2)
+    return TRUE;
+
+  denom = n * sum_tt - sum_t * sum_t;
+  if (denom < 1e-6)
+    return TRUE;
+
+  *x += (n * sum_tx - sum_t * sum_x) / denom * horizon;
+  *y += (n * sum_ty - sum_t * sum_y) / denom * horizon;
+
+  return TRUE;
+}
@@ -0,0 +1,54 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2011  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CLUTTER_MOTION_PREDICTOR_H__
+#define __CLUTTER_MOTION_PREDICTOR_H__
+
+#include <clutter/clutter-event.h>
+
+G_BEGIN_DECLS
+
+#define CLUTTER_MOTION_PREDICTOR_N_SAMPLES      8
+
+typedef struct _ClutterMotionPredictor ClutterMotionPredictor;
+
+struct _ClutterMotionPredictor
+{
+  /* ring buffer of the latest positions, in event time */
+  ClutterMotionSample samples[CLUTTER_MOTION_PREDICTOR_N_SAMPLES];
+  guint n_samples;
+  guint next_sample;
+
+  /* the monotonic time at which the latest sample was added, in usecs */
+  gint64 last_sample_time;
+};
+
+void     _clutter_motion_predictor_reset     (ClutterMotionPredictor *predictor);
+void     _clutter_motion_predictor_add_event (ClutterMotionPredictor *predictor,
+                                              const ClutterEvent     *event);
+gboolean _clutter_motion_predictor_predict   (ClutterMotionPredictor *predictor,
+                                              gint64                  target_time,
+                                              gfloat                 *x,
+                                              gfloat                 *y);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_MOTION_PREDICTOR_H__ */
@@ -5,6 +5,46 @@
 
 G_BEGIN_DECLS
 
+/*< private >
+ * ClutterColorStageSourceFunc:
+ * @effect: a #ClutterOffscreenEffect
+ * @source: the GLSL source being generated
+ * @stage: the index of the stage
+ *
+ * Appends to @source the uniforms used by @effect and a function
+ * called stage_@stage, taking and returning a vec4 color, that
+ * applies @effect to a pixel; every identifier at global scope
+ * must end with the index of the stage.
+ */
+typedef void (* ClutterColorStageSourceFunc)   (ClutterOffscreenEffect *effect,
+                                                GString                *source,
+                                                guint                   stage);
+
+/*< private >
+ * ClutterColorStageUniformsFunc:
+ * @effect: a #ClutterOffscreenEffect
+ * @program: the program generated from the stages
+ * @stage: the index of the stage
+ *
+ * Sets the uniforms appended by the #ClutterColorStageSourceFunc
+ * of @effect.
+ */
+typedef void (* ClutterColorStageUniformsFunc) (ClutterOffscreenEffect *effect,
+                                                CoglHandle              program,
+                                                guint                   stage);
+
+void       _clutter_offscreen_effect_class_add_color_stage (ClutterOffscreenEffectClass   *klass,
+                                                            ClutterColorStageSourceFunc    source_func,
+                                                            ClutterColorStageUniformsFunc  uniforms_func);
+guint      _clutter_offscreen_effect_fuse_color_stages     (ClutterEffect                 *effect,
+                                                            const GList                   *next_effects);
+
+void       _clutter_offscreen_effect_set_use_pool         (ClutterOffscreenEffect *effect,
+                                                           gboolean                use_pool);
+void       _clutter_offscreen_effect_set_reuse_translated (ClutterOffscreenEffect *effect,
+                                                           gboolean                reuse_translated);
+CoglHandle _clutter_offscreen_effect_get_texture          (ClutterOffscreenEffect *effect);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_OFFSCREEN_EFFECT_PRIVATE_H__ */
@@ -56,6 +56,15 @@
  *   <function>create_texture()</function> virtual function; no chain up
  *   to the #ClutterOffscreenEffect implementation is required in this
  *   case.</para>
+ *   <para>Unless the <function>create_texture()</function> virtual
+ *   function is overridden, the offscreen buffers are shared between the
+ *   effects painted by the same stage: an effect borrows a buffer while
+ *   painting and gives it back afterwards; if the actor did not change
+ *   by the next paint, and nobody else needed the buffer meanwhile, the
+ *   image in it is painted again without redrawing the actor. The
+ *   shared buffers can be
+ *   bigger than the target size, so sub-classes should not assume that
+ *   the texture coordinates of the target go from 0 to 1.</para>
  * </refsect2>
  *
  * #ClutterOffscreenEffect is available since Clutter 1.4
@@ -66,12 +75,16 @@
 #endif
 
 #include "clutter-offscreen-effect.h"
+#include "clutter-offscreen-effect-private.h"
+
+#include <math.h>
 
 #include "cogl/cogl.h"
 
 #include "clutter-actor-private.h"
 #include "clutter-debug.h"
 #include "clutter-private.h"
+#include "clutter-profile.h"
 #include "clutter-stage-private.h"
 
 struct _ClutterOffscreenEffectPrivate
@@ -79,6 +92,14 @@ struct _ClutterOffscreenEffectPrivate
   CoglHandle offscreen;
   CoglMaterial *target;
 
+  /* the texture of the target material; owned by the material */
+  CoglHandle texture;
+
+  /* the target borrowed from the stage while painting, if any; in
+   * that case the offscreen handle above is owned by it
+   */
+  ClutterStageOffscreen *pooled;
+
   ClutterActor *actor;
   ClutterActor *stage;
 
@@ -88,8 +109,20 @@ struct _ClutterOffscreenEffectPrivate
   gfloat target_width;
   gfloat target_height;
 
+  /* the size of the texture, which can be bigger than the target */
+  gfloat texture_width;
+  gfloat texture_height;
+
   gint old_opacity_override;
 
+  /* whether the target can be borrowed from the pool of the stage */
+  guint use_pool : 1;
+
+  /* whether the cached image can be painted again after the actor
+   * moved on the stage, see _clutter_offscreen_effect_set_reuse_translated()
+   */
+  guint reuse_translated : 1;
+
   /* The matrix that was current the last time the fbo was updated. We
      need to keep track of this to detect when we can reuse the
      contents of the fbo without redrawing the actor. We need the
@@ -99,12 +132,101 @@ struct _ClutterOffscreenEffectPrivate
      and it won't cause a redraw to be queued on the parent's
      children. */
   CoglMatrix last_matrix_drawn;
+
+  /* the effects painted by this one in the same pass, and the program
+   * applying all of them, see _clutter_offscreen_effect_fuse_color_stages()
+   */
+  GPtrArray *color_stages;
+  CoglHandle color_program;
+};
+
+typedef struct _ColorStage      ColorStage;
+
+struct _ColorStage
+{
+  ClutterColorStageSourceFunc source_func;
+  ClutterColorStageUniformsFunc uniforms_func;
 };
 
+static GQuark quark_color_stage = 0;
+
+/* the programs generated for the chains of color stages, indexed by
+ * their source; a chain that failed to compile maps to an invalid
+ * handle, so that it is not compiled again */
+static GHashTable *color_programs = NULL;
+
 G_DEFINE_ABSTRACT_TYPE (ClutterOffscreenEffect,
                         clutter_offscreen_effect,
                         CLUTTER_TYPE_EFFECT);
 
+static CoglHandle clutter_offscreen_effect_real_create_texture (ClutterOffscreenEffect *effect,
+                                                               gfloat                  width,
+                                                               gfloat                  height);
+
+/* gives the borrowed target back to the stage; if @keep_contents is
+ * set, the target remembers that it holds our image, and we can get
+ * it back on the next paint unless somebody else needed it
+ */
+static void
+clutter_offscreen_effect_release_target (ClutterOffscreenEffect *self,
+                                         gboolean                keep_contents)
+{
+  ClutterOffscreenEffectPrivate *priv = self->priv;
+
+  /* do not keep the texture alive through the material */
+  if (priv->target != COGL_INVALID_HANDLE)
+    cogl_material_remove_layer (priv->target, 0);
+
+  priv->texture = COGL_INVALID_HANDLE;
+
+  if (priv->stage != NULL)
+    _clutter_stage_release_offscreen (CLUTTER_STAGE (priv->stage),
+                                      priv->pooled,
+                                      keep_contents ? self : NULL);
+  else
+    _clutter_stage_offscreen_free (priv->pooled);
+
+  priv->pooled = NULL;
+  priv->offscreen = COGL_INVALID_HANDLE;
+}
+
+/* drops the image we left in the pool of the stage of our actor */
+static void
+clutter_offscreen_effect_forget_cached_target (ClutterOffscreenEffect *self)
+{
+  ClutterOffscreenEffectPrivate *priv = self->priv;
+  ClutterStageOffscreen *offscreen;
+  ClutterActor *stage;
+
+  if (!priv->use_pool || priv->actor == NULL)
+    return;
+
+  stage = clutter_actor_get_stage (priv->actor);
+  if (stage == NULL)
+    return;
+
+  offscreen = _clutter_stage_reclaim_offscreen (CLUTTER_STAGE (stage), self,
+                                                priv->target_width,
+                                                priv->target_height,
+                                                COGL_PIXEL_FORMAT_RGBA_8888_PRE);
+  if (offscreen != NULL)
+    _clutter_stage_release_offscreen (CLUTTER_STAGE (stage), offscreen, NULL);
+}
+
+static void
+clutter_offscreen_effect_clear_target (ClutterOffscreenEffect *self)
+{
+  ClutterOffscreenEffectPrivate *priv = self->priv;
+
+  if (priv->pooled != NULL)
+    clutter_offscreen_effect_release_target (self, FALSE);
+  else if (priv->offscreen != COGL_INVALID_HANDLE)
+    {
+      cogl_handle_unref (priv->offscreen);
+      priv->offscreen = COGL_INVALID_HANDLE;
+    }
+}
+
 static void
 clutter_offscreen_effect_set_actor (ClutterActorMeta *meta,
                                     ClutterActor     *actor)
@@ -116,12 +238,12 @@ clutter_offscreen_effect_set_actor (ClutterActorMeta *meta,
   meta_class = CLUTTER_ACTOR_META_CLASS (clutter_offscreen_effect_parent_class);
   meta_class->set_actor (meta, actor);
 
-  /* clear out the previous state */
-  if (priv->offscreen != COGL_INVALID_HANDLE)
-    {
-      cogl_handle_unref (priv->offscreen);
-      priv->offscreen = COGL_INVALID_HANDLE;
-    }
+  /* clear out the previous state; the stage we got the target from
+   * might not be around anymore, so we do not give it back
+   */
+  clutter_offscreen_effect_forget_cached_target (self);
+  priv->stage = NULL;
+  clutter_offscreen_effect_clear_target (self);
 
   /* we keep a back pointer here, to avoid going through the ActorMeta */
   priv->actor = clutter_actor_meta_get_actor (meta);
@@ -137,6 +259,111 @@ clutter_offscreen_effect_real_create_texture (ClutterOffscreenEffect *effect,
                                      COGL_PIXEL_FORMAT_RGBA_8888_PRE);
 }
 
+static void
+set_target_texture (ClutterOffscreenEffect *self,
+                    CoglHandle              texture)
+{
+  ClutterOffscreenEffectPrivate *priv = self->priv;
+
+  if (priv->target == COGL_INVALID_HANDLE)
+    priv->target = cogl_material_new ();
+
+  cogl_material_set_layer (priv->target, 0, texture);
+  priv->texture = texture;
+
+  /* We're always going to render the texture at a 1:1 texel:pixel
+     ratio so we can use 'nearest' filtering to decrease the
+     effects of rounding errors in the geometry calculation; the
+     filters are reset every time the layer is removed, so we set
+     them every time */
+  cogl_material_set_layer_filters (priv->target,
+                                   0, /* layer_index */
+                                   COGL_MATERIAL_FILTER_NEAREST,
+                                   COGL_MATERIAL_FILTER_NEAREST);
+}
+
+static void
+set_pooled_target (ClutterOffscreenEffect *self,
+                   ClutterStageOffscreen  *offscreen,
+                   int                     fbo_width,
+                   int                     fbo_height)
+{
+  ClutterOffscreenEffectPrivate *priv = self->priv;
+
+  priv->pooled = offscreen;
+
+  set_target_texture (self, priv->pooled->texture);
+
+  /* the pooled texture is usually bigger than what we asked for;
+   * we only draw, and paint, its top left corner
+   */
+  priv->offscreen = priv->pooled->framebuffer;
+  priv->target_width = fbo_width;
+  priv->target_height = fbo_height;
+  priv->texture_width = priv->pooled->width;
+  priv->texture_height = priv->pooled->height;
+}
+
+/* gets back the target holding the image we painted last time, if
+ * it is still around
+ */
+static gboolean
+reclaim_pooled_target (ClutterOffscreenEffect *self,
+                       int                     fbo_width,
+                       int                     fbo_height)
+{
+  ClutterOffscreenEffectPrivate *priv = self->priv;
+  ClutterStageOffscreen *offscreen;
+
+  offscreen = _clutter_stage_reclaim_offscreen (CLUTTER_STAGE (priv->stage),
+                                                self,
+                                                fbo_width,
+                                                fbo_height,
+                                                COGL_PIXEL_FORMAT_RGBA_8888_PRE);
+  if (offscreen == NULL)
+    return FALSE;
+
+  set_pooled_target (self, offscreen, fbo_width, fbo_height);
+
+  return TRUE;
+}
+
+static gboolean
+update_pooled_fbo (ClutterOffscreenEffect *self,
+                   int                     fbo_width,
+                   int                     fbo_height)
+{
+  ClutterOffscreenEffectPrivate *priv = self->priv;
+  ClutterStageOffscreen *offscreen;
+
+  fbo_width = MAX (fbo_width, 1);
+  fbo_height = MAX (fbo_height, 1);
+
+  clutter_offscreen_effect_clear_target (self);
+
+  /* try to repaint the same target as last time first */
+  if (reclaim_pooled_target (self, fbo_width, fbo_height))
+    return TRUE;
+
+  offscreen = _clutter_stage_acquire_offscreen (CLUTTER_STAGE (priv->stage),
+                                                fbo_width,
+                                                fbo_height,
+                                                COGL_PIXEL_FORMAT_RGBA_8888_PRE);
+  if (offscreen == NULL)
+    {
+      g_warning ("%s: Unable to create an Offscreen buffer", G_STRLOC);
+
+      priv->target_width = 0;
+      priv->target_height = 0;
+
+      return FALSE;
+    }
+
+  set_pooled_target (self, offscreen, fbo_width, fbo_height);
+
+  return TRUE;
+}
+
 static gboolean
 update_fbo (ClutterEffect *effect, int fbo_width, int fbo_height)
 {
@@ -154,30 +381,20 @@ update_fbo (ClutterEffect *effect, int fbo_width, int fbo_height)
       return FALSE;
     }
 
+  if (priv->use_pool)
+    return update_pooled_fbo (self, fbo_width, fbo_height);
+
   if (priv->target_width == fbo_width &&
       priv->target_height == fbo_height &&
       priv->offscreen != COGL_INVALID_HANDLE)
     return TRUE;
 
-  if (priv->target == COGL_INVALID_HANDLE)
-    {
-      priv->target = cogl_material_new ();
-
-      /* We're always going to render the texture at a 1:1 texel:pixel
-         ratio so we can use 'nearest' filtering to decrease the
-         effects of rounding errors in the geometry calculation */
-      cogl_material_set_layer_filters (priv->target,
-                                       0, /* layer_index */
-                                       COGL_MATERIAL_FILTER_NEAREST,
-                                       COGL_MATERIAL_FILTER_NEAREST);
-    }
-
   texture =
     clutter_offscreen_effect_create_texture (self, fbo_width, fbo_height);
   if (texture == COGL_INVALID_HANDLE)
      return FALSE;
 
-  cogl_material_set_layer (priv->target, 0, texture);
+  set_target_texture (self, texture);
   cogl_handle_unref (texture);
 
   /* we need to use the size of the texture target and not the minimum
@@ -186,6 +403,8 @@ update_fbo (ClutterEffect *effect, int fbo_width, int fbo_height)
    */
   priv->target_width = cogl_texture_get_width (texture);
   priv->target_height = cogl_texture_get_height (texture);
+  priv->texture_width = priv->target_width;
+  priv->texture_height = priv->target_height;
 
   if (priv->offscreen != COGL_INVALID_HANDLE)
     cogl_handle_unref (priv->offscreen);
@@ -197,6 +416,7 @@ update_fbo (ClutterEffect *effect, int fbo_width, int fbo_height)
 
       cogl_handle_unref (priv->target);
       priv->target = COGL_INVALID_HANDLE;
+      priv->texture = COGL_INVALID_HANDLE;
 
       priv->target_width = 0;
       priv->target_height = 0;
@@ -334,6 +554,42 @@ clutter_offscreen_effect_pre_paint (ClutterEffect *effect)
   return TRUE;
 }
 
+static const ColorStage *
+clutter_offscreen_effect_get_color_stage (GType type)
+{
+  if (quark_color_stage == 0)
+    return NULL;
+
+  return g_type_get_qdata (type, quark_color_stage);
+}
+
+static void
+clutter_offscreen_effect_apply_color_stages (ClutterOffscreenEffect *effect)
+{
+  ClutterOffscreenEffectPrivate *priv = effect->priv;
+  CoglHandle program = priv->color_program;
+  const ColorStage *stage;
+  gint tex_uniform;
+  guint i;
+
+  tex_uniform = cogl_program_get_uniform_location (program, "tex");
+  if (tex_uniform > -1)
+    cogl_program_set_uniform_1i (program, tex_uniform, 0);
+
+  stage = clutter_offscreen_effect_get_color_stage (G_OBJECT_TYPE (effect));
+  stage->uniforms_func (effect, program, 0);
+
+  for (i = 0; i < priv->color_stages->len; i++)
+    {
+      ClutterOffscreenEffect *next = g_ptr_array_index (priv->color_stages, i);
+
+      stage = clutter_offscreen_effect_get_color_stage (G_OBJECT_TYPE (next));
+      stage->uniforms_func (next, program, i + 1);
+    }
+
+  cogl_material_set_user_program (priv->target, program);
+}
+
 static void
 clutter_offscreen_effect_real_paint_target (ClutterOffscreenEffect *effect)
 {
@@ -347,6 +603,11 @@ clutter_offscreen_effect_real_paint_target (ClutterOffscreenEffect *effect)
                               paint_opacity,
                               paint_opacity,
                               paint_opacity);
+
+  /* the program set by the sub-class only applies this effect */
+  if (priv->color_program != COGL_INVALID_HANDLE)
+    clutter_offscreen_effect_apply_color_stages (effect);
+
   cogl_set_source (priv->target);
 
   /* At this point we are in stage coordinates translated so if
@@ -358,7 +619,8 @@ clutter_offscreen_effect_real_paint_target (ClutterOffscreenEffect *effect)
                                       priv->target_width,
                                       priv->target_height,
                                       0.0, 0.0,
-                                      1.0, 1.0);
+                                      priv->target_width / priv->texture_width,
+                                      priv->target_height / priv->texture_height);
 }
 
 static void
@@ -404,6 +666,60 @@ clutter_offscreen_effect_post_paint (ClutterEffect *effect)
   cogl_pop_framebuffer ();
 
   clutter_offscreen_effect_paint_texture (self);
+
+  /* the target can be used by the next effect painted on the stage;
+   * we can get it back, with the image we just painted, if nobody
+   * else needs it before our next paint
+   */
+  if (priv->pooled != NULL)
+    clutter_offscreen_effect_release_target (self, TRUE);
+}
+
+/* checks whether @matrix only differs from the modelview used to
+ * paint the cached image by a translation on the plane of the stage;
+ * in that case, the image looks the same and it can be painted again
+ * after moving it by (@dx, @dy) stage pixels. The depth of the
+ * children of the actor is ignored, as it is for any flattened image
+ */
+static gboolean
+get_stage_translation (ClutterOffscreenEffect *self,
+                       const CoglMatrix       *matrix,
+                       gfloat                 *dx,
+                       gfloat                 *dy)
+{
+  ClutterOffscreenEffectPrivate *priv = self->priv;
+  CoglMatrix view, inverse, current, last;
+  const float *a, *b;
+  int i;
+
+  cogl_matrix_init_identity (&view);
+  _clutter_actor_apply_modelview_transform (priv->stage, &view);
+  if (!cogl_matrix_get_inverse (&view, &inverse))
+    return FALSE;
+
+  /* remove the view transformation of the stage, which scales the
+   * stage coordinates to eye coordinates */
+  cogl_matrix_multiply (&current, &inverse, matrix);
+  cogl_matrix_multiply (&last, &inverse, &priv->last_matrix_drawn);
+
+  a = cogl_matrix_get_array (&current);
+  b = cogl_matrix_get_array (&last);
+
+  /* everything but the x and y translations, which are stored in
+   * the elements 12 and 13 of the array, has to match */
+  for (i = 0; i < 16; i++)
+    {
+      if (i == 12 || i == 13)
+        continue;
+
+      if (fabsf (a[i] - b[i]) > 1e-4f)
+        return FALSE;
+    }
+
+  *dx = a[12] - b[12];
+  *dy = a[13] - b[13];
+
+  return TRUE;
 }
 
 static void
@@ -413,23 +729,86 @@ clutter_offscreen_effect_run (ClutterEffect         *effect,
   ClutterOffscreenEffect *self = CLUTTER_OFFSCREEN_EFFECT (effect);
   ClutterOffscreenEffectPrivate *priv = self->priv;
   CoglMatrix matrix;
+  gboolean is_clean;
+  CLUTTER_STATIC_COUNTER (translated_hit_counter,
+                          "Offscreen effect translated image hits",
+                          "Increments each time a cached image is painted "
+                          "again after the actor moved",
+                          0 /* no application private data */);
+  CLUTTER_STATIC_COUNTER (translated_miss_counter,
+                          "Offscreen effect translated image misses",
+                          "Increments each time a cached image that could "
+                          "be moved has to be painted again",
+                          0 /* no application private data */);
 
   cogl_get_modelview_matrix (&matrix);
 
+  is_clean = !(flags & CLUTTER_EFFECT_RUN_ACTOR_DIRTY) &&
+             cogl_matrix_equal (&matrix, &priv->last_matrix_drawn);
+
+  /* If only the position of the actor on the stage changed then we
+     move the cached image along with it, as if it had been painted
+     with the new matrix */
+  if (priv->reuse_translated &&
+      !is_clean &&
+      !(flags & CLUTTER_EFFECT_RUN_ACTOR_DIRTY) &&
+      priv->target_width > 0)
+    {
+      gfloat dx, dy;
+
+      priv->stage = clutter_actor_get_stage (priv->actor);
+
+      if (priv->stage != NULL &&
+          get_stage_translation (self, &matrix, &dx, &dy))
+        {
+          priv->x_offset += dx;
+          priv->y_offset += dy;
+          priv->last_matrix_drawn = matrix;
+
+          is_clean = TRUE;
+        }
+    }
+
   /* If we've already got a cached image for the same matrix and the
      actor hasn't been redrawn then we can just use the cached image
      in the fbo */
-  if (priv->offscreen == NULL ||
-      (flags & CLUTTER_EFFECT_RUN_ACTOR_DIRTY) ||
-      !cogl_matrix_equal (&matrix, &priv->last_matrix_drawn))
+  if (priv->offscreen != NULL && is_clean)
     {
-      /* Chain up to the parent run method which will call the pre and
-         post paint functions to update the image */
-      CLUTTER_EFFECT_CLASS (clutter_offscreen_effect_parent_class)->
-        run (effect, flags);
+      if (priv->reuse_translated)
+        CLUTTER_COUNTER_INC (_clutter_uprof_context, translated_hit_counter);
+
+      clutter_offscreen_effect_paint_texture (self);
+      return;
     }
-  else
-    clutter_offscreen_effect_paint_texture (self);
+
+  /* A borrowed target goes back to the stage after each paint, so the
+     cached image is only still there if nobody else needed a target
+     in the meantime; as the actor did not change, neither did its
+     paint box nor the size of the target */
+  if (priv->use_pool && is_clean && priv->target_width > 0)
+    {
+      priv->stage = clutter_actor_get_stage (priv->actor);
+
+      if (priv->stage != NULL &&
+          reclaim_pooled_target (self, priv->target_width, priv->target_height))
+        {
+          if (priv->reuse_translated)
+            CLUTTER_COUNTER_INC (_clutter_uprof_context,
+                                 translated_hit_counter);
+
+          clutter_offscreen_effect_paint_texture (self);
+          clutter_offscreen_effect_release_target (self, TRUE);
+          return;
+        }
+    }
+
+  if (priv->reuse_translated)
+    CLUTTER_COUNTER_INC (_clutter_uprof_context, translated_miss_counter);
+
+  /* Chain up to the parent run method which will call the pre and
+     post paint functions to update the image */
+  CLUTTER_EFFECT_CLASS (clutter_offscreen_effect_parent_class)->
+    run (effect, flags);
 }
 
 static void
@@ -438,12 +817,15 @@ clutter_offscreen_effect_finalize (GObject *gobject)
   ClutterOffscreenEffect *self = CLUTTER_OFFSCREEN_EFFECT (gobject);
   ClutterOffscreenEffectPrivate *priv = self->priv;
 
-  if (priv->offscreen)
-    cogl_handle_unref (priv->offscreen);
+  priv->stage = NULL;
+  clutter_offscreen_effect_clear_target (self);
 
   if (priv->target)
     cogl_handle_unref (priv->target);
 
+  if (priv->color_stages != NULL)
+    g_ptr_array_free (priv->color_stages, TRUE);
+
   G_OBJECT_CLASS (clutter_offscreen_effect_parent_class)->finalize (gobject);
 }
 
@@ -471,9 +853,16 @@ clutter_offscreen_effect_class_init (ClutterOffscreenEffectClass *klass)
 static void
 clutter_offscreen_effect_init (ClutterOffscreenEffect *self)
 {
+  ClutterOffscreenEffectClass *klass;
+
   self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
                                             CLUTTER_TYPE_OFFSCREEN_EFFECT,
                                             ClutterOffscreenEffectPrivate);
+
+  /* sub-classes providing their own textures cannot share them */
+  klass = CLUTTER_OFFSCREEN_EFFECT_GET_CLASS (self);
+  self->priv->use_pool =
+    klass->create_texture == clutter_offscreen_effect_real_create_texture;
 }
 
 /**
@@ -584,3 +973,239 @@ clutter_offscreen_effect_get_target_size (ClutterOffscreenEffect *effect,
 
   return TRUE;
 }
+
+/*< private >
+ * _clutter_offscreen_effect_set_use_pool:
+ * @effect: a #ClutterOffscreenEffect
+ * @use_pool: whether the effect can borrow its target from the stage
+ *
+ * Controls whether @effect borrows its render target from the pool of
+ * the stage. A borrowed texture is usually bigger than the target size,
+ * and the texture coordinates of the target only cover part of it;
+ * effects that rely on the coordinates going from 0 to 1, like the ones
+ * running user provided shaders, should not use the pool.
+ */
+void
+_clutter_offscreen_effect_set_use_pool (ClutterOffscreenEffect *effect,
+                                        gboolean                use_pool)
+{
+  ClutterOffscreenEffectPrivate *priv = effect->priv;
+
+  use_pool = !!use_pool;
+
+  if (priv->use_pool == use_pool)
+    return;
+
+  clutter_offscreen_effect_forget_cached_target (effect);
+  priv->stage = NULL;
+  clutter_offscreen_effect_clear_target (effect);
+
+  priv->use_pool = use_pool;
+}
+
+/*< private >
+ * _clutter_offscreen_effect_set_reuse_translated:
+ * @effect: a #ClutterOffscreenEffect
+ * @reuse_translated: whether the cached image can be moved
+ *
+ * Controls whether @effect paints its cached image again when the
+ * actor did not change but it was moved on the plane of the stage,
+ * for instance by one of its ancestors; the image is moved along with
+ * the actor instead of being painted again. This is only correct for
+ * effects that paint the image of the actor unchanged.
+ */
+void
+_clutter_offscreen_effect_set_reuse_translated (ClutterOffscreenEffect *effect,
+                                                gboolean                reuse_translated)
+{
+  effect->priv->reuse_translated = !!reuse_translated;
+}
+
+/*< private >
+ * _clutter_offscreen_effect_get_texture:
+ * @effect: a #ClutterOffscreenEffect
+ *
+ * Retrieves the texture the actor was painted into. Like the target
+ * material, it should only be used from within paint_target(). The
+ * texture might be bigger than the target size: see
+ * clutter_offscreen_effect_get_target_size().
+ *
+ * Return value: (transfer none): a handle to a Cogl texture, or
+ *   %COGL_INVALID_HANDLE
+ */
+CoglHandle
+_clutter_offscreen_effect_get_texture (ClutterOffscreenEffect *effect)
+{
+  return effect->priv->texture;
+}
+
+/*< private >
+ * _clutter_offscreen_effect_class_add_color_stage:
+ * @klass: a #ClutterOffscreenEffectClass
+ * @source_func: the function generating the GLSL source of the effect
+ * @uniforms_func: the function setting the uniforms of the effect
+ *
+ * Declares that the effects of the class of @klass only change the
+ * color of each pixel of the image of the actor, and that they can be
+ * applied in the same pass as the effects that follow them, if those
+ * are color stages as well. The sub-classes of @klass are not color
+ * stages unless they are declared as well.
+ */
+void
+_clutter_offscreen_effect_class_add_color_stage (ClutterOffscreenEffectClass   *klass,
+                                                 ClutterColorStageSourceFunc    source_func,
+                                                 ClutterColorStageUniformsFunc  uniforms_func)
+{
+  ColorStage *stage;
+
+  if (G_UNLIKELY (quark_color_stage == 0))
+    quark_color_stage = g_quark_from_static_string ("clutter-color-stage");
+
+  stage = g_new (ColorStage, 1);
+  stage->source_func = source_func;
+  stage->uniforms_func = uniforms_func;
+
+  g_type_set_qdata (G_TYPE_FROM_CLASS (klass), quark_color_stage, stage);
+}
+
+static CoglHandle
+clutter_offscreen_effect_get_color_program (const gchar *source)
+{
+  CoglHandle shader, program;
+  gpointer value;
+
+  if (G_UNLIKELY (color_programs == NULL))
+    color_programs = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                            g_free,
+                                            NULL);
+
+  if (g_hash_table_lookup_extended (color_programs, source, NULL, &value))
+    return value;
+
+  shader = cogl_create_shader (COGL_SHADER_TYPE_FRAGMENT);
+  cogl_shader_source (shader, source);
+  cogl_shader_compile (shader);
+
+  if (!cogl_shader_is_compiled (shader))
+    {
+      gchar *log_buf = cogl_shader_get_info_log (shader);
+
+      g_warning (G_STRLOC ": Unable to compile the fused effects "
+                 "shader: %s",
+                 log_buf);
+      g_free (log_buf);
+
+      program = COGL_INVALID_HANDLE;
+    }
+  else
+    {
+      program = cogl_create_program ();
+      cogl_program_attach_shader (program, shader);
+      cogl_program_link (program);
+    }
+
+  cogl_handle_unref (shader);
+
+  g_hash_table_insert (color_programs, g_strdup (source), program);
+
+  return program;
+}
+
+/*< private >
+ * _clutter_offscreen_effect_fuse_color_stages:
+ * @effect: the #ClutterEffect about to be run
+ * @next_effects: the effects of the actor painted after @effect
+ *
+ * Each #ClutterOffscreenEffect paints the actor in its own offscreen
+ * buffer; when @effect and the enabled effects at the start of
+ * @next_effects are color stages, see
+ * _clutter_offscreen_effect_class_add_color_stage(), @effect applies
+ * all of them with a single program generated from their sources,
+ * in the same offscreen pass.
+ *
+ * Return value: the number of effects of @next_effects that @effect
+ *   applies, and that should not be run
+ */
+guint
+_clutter_offscreen_effect_fuse_color_stages (ClutterEffect *effect,
+                                             const GList   *next_effects)
+{
+  ClutterOffscreenEffectPrivate *priv;
+  const ColorStage *stage;
+  const GList *l;
+  GString *source;
+  guint n_effects, n_fused, i;
+
+  if (!CLUTTER_IS_OFFSCREEN_EFFECT (effect))
+    return 0;
+
+  priv = CLUTTER_OFFSCREEN_EFFECT (effect)->priv;
+
+  priv->color_program = COGL_INVALID_HANDLE;
+  if (priv->color_stages != NULL)
+    g_ptr_array_set_size (priv->color_stages, 0);
+
+  stage = clutter_offscreen_effect_get_color_stage (G_OBJECT_TYPE (effect));
+  if (stage == NULL || !clutter_feature_available (CLUTTER_FEATURE_SHADERS_GLSL))
+    return 0;
+
+  /* the disabled effects are skipped when painting anyway */
+  n_effects = n_fused = 0;
+  for (l = next_effects; l != NULL; l = l->next)
+    {
+      if (clutter_actor_meta_get_enabled (l->data))
+        {
+          if (clutter_offscreen_effect_get_color_stage (G_OBJECT_TYPE (l->data)) == NULL)
+            break;
+
+          if (priv->color_stages == NULL)
+            priv->color_stages = g_ptr_array_new ();
+
+          g_ptr_array_add (priv->color_stages, l->data);
+          n_fused = n_effects + 1;
+        }
+
+      n_effects += 1;
+    }
+
+  if (n_fused == 0)
+    return 0;
+
+  /* stage 0 is @effect; the effects closer to the actor come later
+   * in the list, and they are applied first */
+  source = g_string_new ("uniform sampler2D tex;\n\n");
+
+  stage->source_func (CLUTTER_OFFSCREEN_EFFECT (effect), source, 0);
+
+  for (i = 0; i < priv->color_stages->len; i++)
+    {
+      ClutterOffscreenEffect *next = g_ptr_array_index (priv->color_stages, i);
+
+      stage = clutter_offscreen_effect_get_color_stage (G_OBJECT_TYPE (next));
+      stage->source_func (next, source, i + 1);
+    }
+
+  g_string_append (source,
+                   "void main ()\n"
+                   "{\n"
+                   "  vec4 color = cogl_color_in * texture2D (tex, vec2 (cogl_tex_coord_in[0].xy));\n");
+
+  for (i = priv->color_stages->len + 1; i > 0; i--)
+    g_string_append_printf (source, "  color = stage_%u (color);\n", i - 1);
+
+  g_string_append (source,
+                   "  cogl_color_out = color;\n"
+                   "}\n");
+
+  priv->color_program = clutter_offscreen_effect_get_color_program (source->str);
+
+  g_string_free (source, TRUE);
+
+  if (priv->color_program == COGL_INVALID_HANDLE)
+    {
+      g_ptr_array_set_size (priv->color_stages, 0);
+      return 0;
+    }
+
+  return n_fused;
+}
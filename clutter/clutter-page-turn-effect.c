@@ -82,40 +82,56 @@ G_DEFINE_TYPE (ClutterPageTurnEffect,
                clutter_page_turn_effect,
                CLUTTER_TYPE_DEFORM_EFFECT);
 
-static void
-clutter_page_turn_effect_deform_vertex (ClutterDeformEffect *effect,
-                                        gfloat               width,
-                                        gfloat               height,
-                                        CoglTextureVertex   *vertex)
+/* the parts of the deformation that are the same for every vertex */
+typedef struct _PageTurnParams
 {
-  ClutterPageTurnEffect *self = CLUTTER_PAGE_TURN_EFFECT (effect);
-  gfloat cx, cy, rx, ry, radians, turn_angle;
-  guint shade;
-
-  if (self->period == 0.0)
-    return;
+  gfloat cx, cy;
+  gfloat cos_angle, sin_angle;
+  gfloat radius;
+} PageTurnParams;
 
-  radians = self->angle / (180.0f / G_PI);
+static inline void
+page_turn_params_init (ClutterPageTurnEffect *self,
+                       gfloat                 width,
+                       gfloat                 height,
+                       PageTurnParams        *params)
+{
+  gfloat radians = self->angle / (180.0f / G_PI);
 
   /* Rotate the point around the centre of the page-curl ray to align it with
    * the y-axis.
    */
-  cx = (1.f - self->period) * width;
-  cy = (1.f - self->period) * height;
+  params->cx = (1.f - self->period) * width;
+  params->cy = (1.f - self->period) * height;
+
+  params->cos_angle = cos (radians);
+  params->sin_angle = sin (radians);
 
-  rx = ((vertex->x - cx) * cos (- radians))
-     - ((vertex->y - cy) * sin (- radians))
-     - self->radius;
-  ry = ((vertex->x - cx) * sin (- radians))
-     + ((vertex->y - cy) * cos (- radians));
+  params->radius = self->radius;
+}
+
+static inline void
+page_turn_deform (const PageTurnParams *params,
+                  CoglTextureVertex    *vertex)
+{
+  gfloat rx, ry, turn_angle;
+  gfloat dx, dy;
+  guint shade;
+
+  dx = vertex->x - params->cx;
+  dy = vertex->y - params->cy;
+
+  /* cos (-a) = cos (a) and sin (-a) = -sin (a) */
+  rx = (dx * params->cos_angle) + (dy * params->sin_angle) - params->radius;
+  ry = (dy * params->cos_angle) - (dx * params->sin_angle);
 
   turn_angle = 0.f;
-  if (rx > self->radius * -2.0f)
+  if (rx > params->radius * -2.0f)
     {
       /* Calculate the curl angle as a function from the distance of the curl
        * ray (i.e. the page crease)
        */
-      turn_angle = (rx / self->radius * G_PI_2) - G_PI_2;
+      turn_angle = (rx / params->radius * G_PI_2) - G_PI_2;
       shade = (sin (turn_angle) * 96.0f) + 159.0f;
 
       /* Add a gradient that makes it look like lighting and hides the switch
@@ -132,21 +148,139 @@ clutter_page_turn_effect_deform_vertex (ClutterDeformEffect *effect,
        * between curled layers of the texture, in pixels.
        */
       gfloat small_radius;
-      
-      small_radius = self->radius
-                   - MIN (self->radius, (turn_angle * 10) / G_PI);
+
+      small_radius = params->radius
+                   - MIN (params->radius, (turn_angle * 10) / G_PI);
 
       /* Calculate a point on a cylinder (maybe make this a cone at some
        * point) and rotate it by the specified angle.
        */
-      rx = (small_radius * cos (turn_angle)) + self->radius;
+      rx = (small_radius * cos (turn_angle)) + params->radius;
 
-      vertex->x = (rx * cos (radians)) - (ry * sin (radians)) + cx;
-      vertex->y = (rx * sin (radians)) + (ry * cos (radians)) + cy;
-      vertex->z = (small_radius * sin (turn_angle)) + self->radius;
+      vertex->x = (rx * params->cos_angle) - (ry * params->sin_angle)
+                + params->cx;
+      vertex->y = (rx * params->sin_angle) + (ry * params->cos_angle)
+                + params->cy;
+      vertex->z = (small_radius * sin (turn_angle)) + params->radius;
     }
 }
 
+static void
+clutter_page_turn_effect_deform_vertex (ClutterDeformEffect *effect,
+                                        gfloat               width,
+                                        gfloat               height,
+                                        CoglTextureVertex   *vertex)
+{
+  ClutterPageTurnEffect *self = CLUTTER_PAGE_TURN_EFFECT (effect);
+  PageTurnParams params;
+
+  if (self->period == 0.0)
+    return;
+
+  page_turn_params_init (self, width, height, &params);
+  page_turn_deform (&params, vertex);
+}
+
+static void
+clutter_page_turn_effect_deform_vertices (ClutterDeformEffect *effect,
+                                          gfloat               width,
+                                          gfloat               height,
+                                          CoglTextureVertex   *vertices,
+                                          guint                n_vertices)
+{
+  ClutterPageTurnEffect *self = CLUTTER_PAGE_TURN_EFFECT (effect);
+  PageTurnParams params;
+  guint i;
+
+  if (self->period == 0.0)
+    return;
+
+  page_turn_params_init (self, width, height, &params);
+
+  for (i = 0; i < n_vertices; i++)
+    page_turn_deform (&params, &vertices[i]);
+}
+
+/* the same deformation as clutter_page_turn_effect_deform_vertex() */
+static const gchar page_turn_glsl_shader[] =
+"uniform float page_turn_period;\n"
+"uniform float page_turn_angle;\n"
+"uniform float page_turn_radius;\n"
+"\n"
+"void clutter_deform_vertex (float width, float height,\n"
+"                            inout vec3 position,\n"
+"                            inout vec4 color)\n"
+"{\n"
+"  float radius = page_turn_radius;\n"
+"  vec2 center, rotated;\n"
+"  float turn_angle, c, s;\n"
+"\n"
+"  if (page_turn_period == 0.0)\n"
+"    return;\n"
+"\n"
+"  c = cos (page_turn_angle);\n"
+"  s = sin (page_turn_angle);\n"
+"\n"
+"  center = (1.0 - page_turn_period) * vec2 (width, height);\n"
+"  rotated = vec2 (((position.x - center.x) * c)\n"
+"                  + ((position.y - center.y) * s)\n"
+"                  - radius,\n"
+"                  ((position.y - center.y) * c)\n"
+"                  - ((position.x - center.x) * s));\n"
+"\n"
+"  turn_angle = 0.0;\n"
+"  if (rotated.x > radius * -2.0)\n"
+"    {\n"
+"      float shade;\n"
+"\n"
+"      turn_angle = (rotated.x / radius * 1.5707963) - 1.5707963;\n"
+"      shade = floor ((sin (turn_angle) * 96.0) + 159.0) / 255.0;\n"
+"\n"
+"      color = vec4 (shade, shade, shade, 1.0);\n"
+"    }\n"
+"\n"
+"  if (rotated.x > 0.0)\n"
+"    {\n"
+"      float small_radius;\n"
+"\n"
+"      small_radius = radius\n"
+"                   - min (radius, (turn_angle * 10.0) / 3.1415927);\n"
+"\n"
+"      rotated.x = (small_radius * cos (turn_angle)) + radius;\n"
+"\n"
+"      position.x = (rotated.x * c) - (rotated.y * s) + center.x;\n"
+"      position.y = (rotated.x * s) + (rotated.y * c) + center.y;\n"
+"      position.z = (small_radius * sin (turn_angle)) + radius;\n"
+"    }\n"
+"}\n";
+
+static const gchar *
+clutter_page_turn_effect_get_vertex_shader (ClutterDeformEffect *effect)
+{
+  return page_turn_glsl_shader;
+}
+
+static void
+clutter_page_turn_effect_update_uniforms (ClutterDeformEffect *effect,
+                                          CoglHandle           program)
+{
+  ClutterPageTurnEffect *self = CLUTTER_PAGE_TURN_EFFECT (effect);
+  gint location;
+
+  location = cogl_program_get_uniform_location (program, "page_turn_period");
+  if (location > -1)
+    cogl_program_set_uniform_1f (program, location, self->period);
+
+  location = cogl_program_get_uniform_location (program, "page_turn_angle");
+  if (location > -1)
+    cogl_program_set_uniform_1f (program, location,
+                                 self->angle / (180.0f / G_PI));
+
+  location = cogl_program_get_uniform_location (program, "page_turn_radius");
+  if (location > -1)
+    cogl_program_set_uniform_1f (program, location, self->radius);
+}
+
 static void
 clutter_page_turn_effect_set_property (GObject      *gobject,
                                        guint         prop_id,
@@ -263,6 +397,9 @@ clutter_page_turn_effect_class_init (ClutterPageTurnEffectClass *klass)
   g_object_class_install_property (gobject_class, PROP_RADIUS, pspec);
 
   deform_class->deform_vertex = clutter_page_turn_effect_deform_vertex;
+  deform_class->deform_vertices = clutter_page_turn_effect_deform_vertices;
+  deform_class->get_vertex_shader = clutter_page_turn_effect_get_vertex_shader;
+  deform_class->update_uniforms = clutter_page_turn_effect_update_uniforms;
 }
 
 static void
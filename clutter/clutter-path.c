@@ -120,11 +120,27 @@ struct _ClutterPathNodeFull
   guint length;
 };
 
+/* the position of a node along the path, used to find the node
+ * covering a given length with a binary search
+ */
+typedef struct _ClutterPathNodeOffset
+{
+  ClutterPathNodeFull *node;
+
+  /* the length of the path up to the end of the node */
+  guint end;
+} ClutterPathNodeOffset;
+
 struct _ClutterPathPrivate
 {
   GSList *nodes, *nodes_tail;
   gboolean nodes_dirty;
 
+  /* the nodes, in order, with the length of the path at their end;
+   * rebuilt together with the node data
+   */
+  GArray *node_offsets;
+
   guint total_length;
 };
 
@@ -256,6 +272,9 @@ clutter_path_finalize (GObject *object)
 
   clutter_path_clear (self);
 
+  if (self->priv->node_offsets != NULL)
+    g_array_free (self->priv->node_offsets, TRUE);
+
   G_OBJECT_CLASS (clutter_path_parent_class)->finalize (object);
 }
 
@@ -1288,10 +1307,17 @@ clutter_path_ensure_node_data (ClutterPath *path)
 
       priv->total_length = 0;
 
+      if (priv->node_offsets == NULL)
+        priv->node_offsets = g_array_new (FALSE, FALSE,
+                                          sizeof (ClutterPathNodeOffset));
+      else
+        g_array_set_size (priv->node_offsets, 0);
+
       for (l = priv->nodes; l; l = l->next)
         {
           ClutterPathNodeFull *node = l->data;
           gboolean relative = (node->k.type & CLUTTER_PATH_RELATIVE) != 0;
+          ClutterPathNodeOffset offset;
 
           switch (node->k.type & ~CLUTTER_PATH_RELATIVE)
             {
@@ -1374,6 +1400,10 @@ clutter_path_ensure_node_data (ClutterPath *path)
             }
 
           priv->total_length += node->length;
+
+          offset.node = node;
+          offset.end = priv->total_length;
+          g_array_append_val (priv->node_offsets, offset);
         }
 
       priv->nodes_dirty = FALSE;
@@ -1400,8 +1430,8 @@ clutter_path_get_position (ClutterPath *path,
                            ClutterKnot *position)
 {
   ClutterPathPrivate *priv;
-  GSList *l;
-  guint point_distance, length = 0, node_num = 0;
+  const ClutterPathNodeOffset *offsets;
+  guint point_distance, length, node_num, lo, hi;
   ClutterPathNodeFull *node;
 
   g_return_val_if_fail (CLUTTER_IS_PATH (path), 0);
@@ -1422,17 +1452,25 @@ clutter_path_get_position (ClutterPath *path,
   /* Convert the progress to a length along the path */
   point_distance = progress * priv->total_length;
 
-  /* Find the node that covers this point */
-  for (l = priv->nodes;
-       l->next && point_distance >= (((ClutterPathNodeFull *) l->data)->length
-                                     + length);
-       l = l->next)
+  /* Find the first node that ends after this point, or the last
+     node, using a binary search on the offsets of the nodes */
+  offsets = (const ClutterPathNodeOffset *) priv->node_offsets->data;
+  lo = 0;
+  hi = priv->node_offsets->len - 1;
+
+  while (lo < hi)
     {
-      length += ((ClutterPathNodeFull *) l->data)->length;
-      node_num++;
+      guint mid = (lo + hi) / 2;
+
+      if (point_distance >= offsets[mid].end)
+        lo = mid + 1;
+      else
+        hi = mid;
     }
 
-  node = l->data;
+  node_num = lo;
+  node = offsets[node_num].node;
+  length = offsets[node_num].end - node->length;
 
   /* Convert the point distance to a distance along the node */
   point_distance -= length;
@@ -41,6 +41,7 @@
 #include "clutter-master-clock.h"
 #include "clutter-settings.h"
 #include "clutter-stage.h"
+#include "clutter-text.h"
 
 G_BEGIN_DECLS
 
@@ -125,6 +126,9 @@ struct _ClutterMainContext
 
   ClutterPickMode  pick_mode;
 
+  /* the stamp of the spatial index query for the current pick, or 0 */
+  guint pick_index_stamp;
+
   /* mapping between reused integer ids and actors */
   ClutterIDPool *id_pool;
 
@@ -148,6 +152,7 @@ struct _ClutterMainContext
 
   PangoContext *pango_context;  /* Global Pango context */
   CoglPangoFontMap *font_map;   /* Global font map */
+  GThread *font_preload_thread; /* Warms up fontconfig during init */
 
   ClutterEvent *current_event;
   guint32 last_event_time;
@@ -183,6 +188,10 @@ gboolean                _clutter_context_is_initialized         (void);
 PangoContext *          _clutter_context_create_pango_context   (void);
 PangoContext *          _clutter_context_get_pango_context      (void);
 ClutterPickMode         _clutter_context_get_pick_mode          (void);
+guint                   _clutter_context_get_pick_index_stamp   (void);
+guint                   _clutter_context_get_size_cache_size    (void);
+gsize                   _clutter_context_get_subtree_cache_budget (void);
+guint                   _clutter_context_get_fixed_frame_time   (void);
 void                    _clutter_context_push_shader_stack      (ClutterActor *actor);
 ClutterActor *          _clutter_context_pop_shader_stack       (ClutterActor *actor);
 ClutterActor *          _clutter_context_peek_shader_stack      (void);
@@ -211,11 +220,31 @@ gboolean _clutter_boolean_handled_accumulator (GSignalInvocationHint *ihint,
 
 void _clutter_run_repaint_functions (void);
 
+gboolean _clutter_threads_has_pending_updates (void);
+void     _clutter_threads_dispatch_updates    (void);
+
+gboolean _clutter_frame_sources_pending  (void);
+void     _clutter_frame_sources_dispatch (gint64 tick);
+
 void _clutter_constraint_update_allocation (ClutterConstraint *constraint,
                                             ClutterActor      *actor,
                                             ClutterActorBox   *allocation);
+const GList *  _clutter_constraint_peek_all   (void);
+ClutterActor * _clutter_constraint_get_source (ClutterConstraint *constraint);
 
 GType _clutter_layout_manager_get_child_meta_type (ClutterLayoutManager *manager);
+void  _clutter_layout_manager_freeze_layout_change (ClutterLayoutManager *manager);
+void  _clutter_layout_manager_thaw_layout_change   (ClutterLayoutManager *manager);
+
+void  _clutter_text_prefetch_layouts (ClutterContainer *container,
+                                      gfloat            for_width);
+void  _clutter_text_prefetch_mapped_layouts (GSList *texts);
+guint _clutter_text_get_n_cached_layouts (ClutterText *text);
+gint  _clutter_text_get_n_chars          (ClutterText *text);
+gint  _clutter_text_offset_to_index      (ClutterText *text,
+                                          gint         offset);
+gint  _clutter_text_index_to_offset      (ClutterText *text,
+                                          gint         index_);
 
 void  _clutter_util_fully_transform_vertices (const CoglMatrix    *modelview,
                                               const CoglMatrix    *projection,
@@ -224,6 +253,11 @@ void  _clutter_util_fully_transform_vertices (const CoglMatrix    *modelview,
                                               ClutterVertex       *vertices_out,
                                               int                  n_vertices);
 
+gboolean _clutter_util_has_extension (const gchar *extensions,
+                                      const gchar *name);
+
+gint64   _clutter_util_get_monotonic_time (void);
+
 typedef struct _ClutterPlane
 {
   CoglVector3 v0;
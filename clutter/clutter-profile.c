@@ -1,9 +1,28 @@
 
-#ifdef CLUTTER_ENABLE_PROFILE
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
 
 #include "clutter-profile.h"
+#include "clutter-debug.h"
+#include "clutter-private.h"
+
+#ifdef CLUTTER_ENABLE_PROFILE
 
 #include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_EXECINFO_H
+#include <execinfo.h>
+#endif
 
 UProfContext *_clutter_uprof_context;
 
@@ -295,3 +314,918 @@ _clutter_profile_trace_message (const char *format, ...)
 
 #endif
 
+typedef struct _ClutterStartupTiming
+{
+  /* offset of the first occurrence from the startup origin */
+  gint64 first_start;
+
+  gint64 start;
+  gint64 total;
+
+  guint n_runs;
+  guint depth;
+} ClutterStartupTiming;
+
+static const char *startup_phase_names[CLUTTER_STARTUP_N_PHASES] = {
+  "Option parsing",
+  "Backend connection",
+  "GL context creation",
+  "Stage realization",
+  "Font map creation",
+  "Script loading"
+};
+
+static ClutterStartupTiming startup_timings[CLUTTER_STARTUP_N_PHASES];
+static gint64 startup_origin = 0;
+static gint64 startup_first_frame = 0;
+
+static void
+clutter_startup_report (void)
+{
+  int i;
+
+  g_print ("*** Startup timings (msecs since clutter_init) ***\n");
+
+  for (i = 0; i < CLUTTER_STARTUP_N_PHASES; i++)
+    {
+      const ClutterStartupTiming *timing = &startup_timings[i];
+
+      if (timing->n_runs == 0)
+        continue;
+
+      g_print ("  %-20s at %8.2f, took %8.2f (%u run%s)\n",
+               startup_phase_names[i],
+               timing->first_start / 1000.0,
+               timing->total / 1000.0,
+               timing->n_runs,
+               timing->n_runs > 1 ? "s" : "");
+    }
+
+  g_print ("  %-20s at %8.2f\n",
+           "First frame",
+           (startup_first_frame - startup_origin) / 1000.0);
+}
+
+/* the first timed phase defines the startup origin, which is the
+ * option parsing done by clutter_init() for most applications
+ */
+void
+_clutter_startup_phase_begin (ClutterStartupPhase phase)
+{
+  ClutterStartupTiming *timing = &startup_timings[phase];
+  gint64 now;
+
+  /* only the outermost run of a phase is timed */
+  if (timing->depth++ > 0)
+    return;
+
+  now = _clutter_util_get_monotonic_time ();
+
+  if (startup_origin == 0)
+    startup_origin = now;
+
+  if (timing->n_runs == 0)
+    timing->first_start = now - startup_origin;
+
+  timing->start = now;
+}
+
+void
+_clutter_startup_phase_end (ClutterStartupPhase phase)
+{
+  ClutterStartupTiming *timing = &startup_timings[phase];
+
+  g_return_if_fail (timing->depth > 0);
+
+  if (--timing->depth > 0)
+    return;
+
+  timing->total += _clutter_util_get_monotonic_time () - timing->start;
+  timing->n_runs += 1;
+}
+
+/* called every time a stage has been drawn; only the first call
+ * is recorded, and reported if requested
+ */
+void
+_clutter_startup_first_frame (void)
+{
+  if (G_LIKELY (startup_first_frame != 0))
+    return;
+
+  startup_first_frame = _clutter_util_get_monotonic_time ();
+
+  if (startup_origin == 0)
+    startup_origin = startup_first_frame;
+
+  if (clutter_profile_flags & CLUTTER_PROFILE_STARTUP)
+    clutter_startup_report ();
+}
+
+/*
+ * Trace export
+ *
+ * When CLUTTER_TRACE is set to the name of a file, the start and the end
+ * of every profiling timer are written to it as "B" and "E" events in the
+ * JSON trace format read by chrome://tracing and by the Perfetto UI. The
+ * timestamps use the monotonic clock, and the thread ids are the ones of
+ * the kernel where available, so that the events can be correlated with
+ * a system trace.
+ *
+ * The events are kept in a fixed buffer and only formatted when it is
+ * full and at exit, so tracing does not allocate nor write on every
+ * event.
+ */
+
+/* the number of events buffered before they are written out */
+#define TRACE_BUFFER_SIZE       4096
+
+typedef struct _ClutterTraceEvent
+{
+  const char *name;
+  gpointer stage;
+  gint64 time;
+  guint64 thread_id;
+  char phase;
+} ClutterTraceEvent;
+
+gboolean _clutter_trace_enabled = FALSE;
+
+static FILE *trace_file = NULL;
+static ClutterTraceEvent trace_events[TRACE_BUFFER_SIZE];
+static guint trace_n_events = 0;
+static gboolean trace_first_event = TRUE;
+static gpointer trace_stage = NULL;
+static int trace_pid = 0;
+
+G_LOCK_DEFINE_STATIC (trace);
+
+static guint64
+trace_get_thread_id (void)
+{
+#if defined(__linux__) && defined(SYS_gettid)
+  return (guint64) syscall (SYS_gettid);
+#else
+  return (guint64) GPOINTER_TO_SIZE (g_thread_self ());
+#endif
+}
+
+/* called with the trace lock held */
+static void
+trace_flush (void)
+{
+  guint i;
+
+  for (i = 0; i < trace_n_events; i++)
+    {
+      const ClutterTraceEvent *event = &trace_events[i];
+
+      fprintf (trace_file,
+               "%s{\"name\":\"%s\",\"cat\":\"clutter\",\"ph\":\"%c\","
+               "\"ts\":%" G_GINT64_FORMAT ",\"pid\":%d,"
+               "\"tid\":%" G_GUINT64_FORMAT,
+               trace_first_event ? "" : ",\n",
+               event->name,
+               event->phase,
+               event->time,
+               trace_pid,
+               event->thread_id);
+
+      if (event->stage != NULL)
+        fprintf (trace_file, ",\"args\":{\"stage\":\"%p\"}", event->stage);
+
+      fputc ('}', trace_file);
+
+      trace_first_event = FALSE;
+    }
+
+  trace_n_events = 0;
+}
+
+static void
+trace_close (void)
+{
+  G_LOCK (trace);
+
+  if (trace_file != NULL)
+    {
+      trace_flush ();
+      fputs ("\n]\n", trace_file);
+      fclose (trace_file);
+      trace_file = NULL;
+    }
+
+  _clutter_trace_enabled = FALSE;
+
+  G_UNLOCK (trace);
+}
+
+static void
+trace_add_event (const char *name,
+                 char        phase)
+{
+  ClutterTraceEvent *event;
+  gint64 now = _clutter_util_get_monotonic_time ();
+  guint64 thread_id = trace_get_thread_id ();
+
+  G_LOCK (trace);
+
+  if (G_LIKELY (trace_file != NULL))
+    {
+      if (trace_n_events == TRACE_BUFFER_SIZE)
+        trace_flush ();
+
+      event = &trace_events[trace_n_events++];
+      event->name = name;
+      event->phase = phase;
+      event->time = now;
+      event->thread_id = thread_id;
+      event->stage = trace_stage;
+    }
+
+  G_UNLOCK (trace);
+}
+
+void
+_clutter_trace_init (const char *filename)
+{
+  if (trace_file != NULL)
+    return;
+
+  trace_file = fopen (filename, "w");
+  if (trace_file == NULL)
+    {
+      g_warning ("Unable to open the trace file '%s': %s",
+                 filename,
+                 g_strerror (errno));
+      return;
+    }
+
+  trace_pid = getpid ();
+
+  fputs ("[\n", trace_file);
+
+  g_atexit (trace_close);
+
+  _clutter_trace_enabled = TRUE;
+}
+
+void
+_clutter_trace_begin (const char *name)
+{
+  trace_add_event (name, 'B');
+}
+
+void
+_clutter_trace_end (const char *name)
+{
+  trace_add_event (name, 'E');
+}
+
+/* the events of the main thread are tagged with the stage being updated,
+ * if any */
+void
+_clutter_trace_set_stage (gpointer stage)
+{
+  trace_stage = stage;
+}
+
+/*
+ * GPU timings
+ *
+ * When CLUTTER_PAINT=gpu-timings is set, the paint of the named actors
+ * and the run of every effect are bracketed by GL timestamp queries; the
+ * results are collected once they are available, a few frames later, so
+ * that the CPU never waits for the GPU, and the time spent by the GPU on
+ * each actor and effect is reported periodically.
+ */
+
+/* the number of frames between two reports of the GPU timings */
+#define GPU_TIMINGS_REPORT_FRAMES       120
+
+struct _ClutterGpuTiming
+{
+#ifdef COGL_HAS_GL
+  GLuint queries[2];
+#endif
+
+  GType actor_type;
+  const gchar *actor_name;
+  GType effect_type;
+};
+
+typedef struct _ClutterGpuTimingTotal
+{
+  gchar *label;
+  guint64 total_nsecs;
+  guint n_samples;
+} ClutterGpuTimingTotal;
+
+#ifdef COGL_HAS_GL
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+#ifndef GL_TIMESTAMP
+#define GL_TIMESTAMP                    0x8E28
+#endif
+#ifndef GL_QUERY_RESULT
+#define GL_QUERY_RESULT                 0x8866
+#endif
+#ifndef GL_QUERY_RESULT_AVAILABLE
+#define GL_QUERY_RESULT_AVAILABLE       0x8867
+#endif
+
+typedef const GLubyte * (APIENTRY *GetStringFunc)         (GLenum        name);
+typedef void      (APIENTRY *GenQueriesFunc)              (GLsizei       n,
+                                                           GLuint       *ids);
+typedef void      (APIENTRY *DeleteQueriesFunc)           (GLsizei       n,
+                                                           const GLuint *ids);
+typedef void      (APIENTRY *QueryCounterFunc)            (GLuint        id,
+                                                           GLenum        target);
+typedef void      (APIENTRY *GetQueryObjectivFunc)        (GLuint        id,
+                                                           GLenum        pname,
+                                                           GLint        *params);
+typedef void      (APIENTRY *GetQueryObjectui64vFunc)     (GLuint        id,
+                                                           GLenum        pname,
+                                                           guint64      *params);
+
+typedef struct _GpuTimerFuncs
+{
+  GenQueriesFunc gen_queries;
+  DeleteQueriesFunc delete_queries;
+  QueryCounterFunc query_counter;
+  GetQueryObjectivFunc get_query_objectiv;
+  GetQueryObjectui64vFunc get_query_objectui64v;
+} GpuTimerFuncs;
+
+/* the queries whose result has not been collected yet, in the order
+ * in which they were issued */
+static GQueue gpu_timings_pending = G_QUEUE_INIT;
+
+/* the queries that can be reused */
+static GArray *gpu_timings_free_queries = NULL;
+
+/* the accumulated timings, indexed by label */
+static GHashTable *gpu_timings_totals = NULL;
+static guint gpu_timings_n_frames = 0;
+
+/* Returns the GL entry points needed to issue timestamp queries, or
+ * %NULL if the driver does not support them */
+static const GpuTimerFuncs *
+get_gpu_timer_funcs (void)
+{
+  static GpuTimerFuncs funcs = { NULL, };
+  static gboolean initialized = FALSE;
+  static gboolean supported = FALSE;
+  GetStringFunc get_string;
+  const gchar *extensions;
+
+  if (G_LIKELY (initialized))
+    return supported ? &funcs : NULL;
+
+  initialized = TRUE;
+
+  get_string = (GetStringFunc) cogl_get_proc_address ("glGetString");
+  if (get_string == NULL)
+    return NULL;
+
+  extensions = (const gchar *) get_string (GL_EXTENSIONS);
+  if (extensions == NULL ||
+      !cogl_check_extension ("GL_ARB_timer_query", extensions))
+    return NULL;
+
+  funcs.gen_queries =
+    (GenQueriesFunc) cogl_get_proc_address ("glGenQueries");
+  funcs.delete_queries =
+    (DeleteQueriesFunc) cogl_get_proc_address ("glDeleteQueries");
+  funcs.query_counter =
+    (QueryCounterFunc) cogl_get_proc_address ("glQueryCounter");
+  funcs.get_query_objectiv =
+    (GetQueryObjectivFunc) cogl_get_proc_address ("glGetQueryObjectiv");
+  funcs.get_query_objectui64v =
+    (GetQueryObjectui64vFunc) cogl_get_proc_address ("glGetQueryObjectui64v");
+
+  supported = funcs.gen_queries != NULL &&
+              funcs.delete_queries != NULL &&
+              funcs.query_counter != NULL &&
+              funcs.get_query_objectiv != NULL &&
+              funcs.get_query_objectui64v != NULL;
+
+  return supported ? &funcs : NULL;
+}
+
+static GLuint
+gpu_timer_query (const GpuTimerFuncs *funcs)
+{
+  GLuint query;
+
+  if (gpu_timings_free_queries != NULL &&
+      gpu_timings_free_queries->len > 0)
+    {
+      guint last = gpu_timings_free_queries->len - 1;
+
+      query = g_array_index (gpu_timings_free_queries, GLuint, last);
+      g_array_set_size (gpu_timings_free_queries, last);
+    }
+  else
+    funcs->gen_queries (1, &query);
+
+  /* the commands batched by Cogl so far must reach GL before the
+   * timestamp, or they would be timed with the next actor */
+  cogl_flush ();
+
+  funcs->query_counter (query, GL_TIMESTAMP);
+
+  return query;
+}
+
+static void
+gpu_timer_release_query (GLuint query)
+{
+  if (gpu_timings_free_queries == NULL)
+    gpu_timings_free_queries = g_array_new (FALSE, FALSE, sizeof (GLuint));
+
+  g_array_append_val (gpu_timings_free_queries, query);
+}
+
+#endif /* COGL_HAS_GL */
+
+static void
+clutter_gpu_timing_total_free (gpointer data)
+{
+  ClutterGpuTimingTotal *total = data;
+
+  g_free (total->label);
+  g_slice_free (ClutterGpuTimingTotal, total);
+}
+
+static gint
+clutter_gpu_timing_total_compare (gconstpointer a,
+                                  gconstpointer b)
+{
+  const ClutterGpuTimingTotal *total_a = *(ClutterGpuTimingTotal **) a;
+  const ClutterGpuTimingTotal *total_b = *(ClutterGpuTimingTotal **) b;
+
+  if (total_a->total_nsecs > total_b->total_nsecs)
+    return -1;
+
+  if (total_a->total_nsecs < total_b->total_nsecs)
+    return 1;
+
+  return 0;
+}
+
+static void
+clutter_gpu_timings_add (const ClutterGpuTiming *timing,
+                         guint64                 nsecs)
+{
+  ClutterGpuTimingTotal *total;
+  gchar *label;
+
+  if (timing->effect_type != G_TYPE_INVALID)
+    label = g_strdup_printf ("%s '%s' [%s]",
+                             g_type_name (timing->actor_type),
+                             timing->actor_name != NULL
+                               ? timing->actor_name
+                               : "",
+                             g_type_name (timing->effect_type));
+  else
+    label = g_strdup_printf ("%s '%s'",
+                             g_type_name (timing->actor_type),
+                             timing->actor_name != NULL
+                               ? timing->actor_name
+                               : "");
+
+  if (gpu_timings_totals == NULL)
+    gpu_timings_totals = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                NULL,
+                                                clutter_gpu_timing_total_free);
+
+  total = g_hash_table_lookup (gpu_timings_totals, label);
+  if (total == NULL)
+    {
+      total = g_slice_new0 (ClutterGpuTimingTotal);
+      total->label = label;
+
+      g_hash_table_insert (gpu_timings_totals, total->label, total);
+    }
+  else
+    g_free (label);
+
+  total->total_nsecs += nsecs;
+  total->n_samples += 1;
+}
+
+static void
+clutter_gpu_timings_report (void)
+{
+  GPtrArray *totals;
+  GHashTableIter iter;
+  gpointer value;
+  guint i;
+
+  g_print ("*** GPU timings (usecs per frame over %u frames) ***\n",
+           gpu_timings_n_frames);
+
+  if (gpu_timings_totals == NULL)
+    return;
+
+  totals = g_ptr_array_new ();
+
+  g_hash_table_iter_init (&iter, gpu_timings_totals);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    g_ptr_array_add (totals, value);
+
+  g_ptr_array_sort (totals, clutter_gpu_timing_total_compare);
+
+  for (i = 0; i < totals->len; i++)
+    {
+      const ClutterGpuTimingTotal *total = g_ptr_array_index (totals, i);
+
+      g_print ("  %-48s %10.2f (%u sample%s)\n",
+               total->label,
+               total->total_nsecs / 1000.0 / gpu_timings_n_frames,
+               total->n_samples,
+               total->n_samples > 1 ? "s" : "");
+    }
+
+  g_ptr_array_free (totals, TRUE);
+
+  g_hash_table_remove_all (gpu_timings_totals);
+}
+
+/*
+ * _clutter_gpu_timing_begin:
+ * @actor_type: the type of the actor being painted
+ * @actor_name: (allow-none): the name of the actor
+ * @effect_type: the type of the effect being run, or %G_TYPE_INVALID
+ *
+ * Starts timing the GL commands issued to paint an actor, or to run
+ * one of its effects.
+ *
+ * Return value: the timing to pass to _clutter_gpu_timing_end(), or
+ *   %NULL if the driver cannot time the GL commands
+ */
+ClutterGpuTiming *
+_clutter_gpu_timing_begin (GType        actor_type,
+                           const gchar *actor_name,
+                           GType        effect_type)
+{
+#ifdef COGL_HAS_GL
+  const GpuTimerFuncs *funcs = get_gpu_timer_funcs ();
+  ClutterGpuTiming *timing;
+
+  if (funcs == NULL)
+    {
+      g_warning ("The GL driver does not support timer queries; "
+                 "GPU timings are disabled");
+
+      clutter_paint_debug_flags &= ~CLUTTER_DEBUG_GPU_TIMINGS;
+
+      return NULL;
+    }
+
+  timing = g_slice_new (ClutterGpuTiming);
+  timing->actor_type = actor_type;
+  timing->actor_name = g_intern_string (actor_name);
+  timing->effect_type = effect_type;
+  timing->queries[0] = gpu_timer_query (funcs);
+  timing->queries[1] = 0;
+
+  return timing;
+#else
+  g_warning ("GPU timings are only supported with OpenGL");
+
+  clutter_paint_debug_flags &= ~CLUTTER_DEBUG_GPU_TIMINGS;
+
+  return NULL;
+#endif
+}
+
+/*
+ * _clutter_gpu_timing_end:
+ * @timing: (allow-none): the timing returned by _clutter_gpu_timing_begin()
+ *
+ * Stops timing the GL commands; the result is collected by
+ * _clutter_gpu_timings_frame_end() once the GPU has executed them.
+ */
+void
+_clutter_gpu_timing_end (ClutterGpuTiming *timing)
+{
+#ifdef COGL_HAS_GL
+  if (timing == NULL)
+    return;
+
+  timing->queries[1] = gpu_timer_query (get_gpu_timer_funcs ());
+
+  g_queue_push_tail (&gpu_timings_pending, timing);
+#endif
+}
+
+/*
+ * _clutter_gpu_timings_frame_end:
+ *
+ * Called each time a stage has been drawn with GPU timings enabled;
+ * collects the timings the GPU has completed, without waiting for the
+ * others, and reports them every GPU_TIMINGS_REPORT_FRAMES frames.
+ */
+void
+_clutter_gpu_timings_frame_end (void)
+{
+#ifdef COGL_HAS_GL
+  const GpuTimerFuncs *funcs = get_gpu_timer_funcs ();
+  ClutterGpuTiming *timing;
+
+  if (funcs == NULL)
+    return;
+
+  /* the queries complete in the order in which they were issued */
+  while ((timing = g_queue_peek_head (&gpu_timings_pending)) != NULL)
+    {
+      GLint available = 0;
+      guint64 start = 0, end = 0;
+
+      funcs->get_query_objectiv (timing->queries[1],
+                                 GL_QUERY_RESULT_AVAILABLE,
+                                 &available);
+      if (!available)
+        break;
+
+      g_queue_pop_head (&gpu_timings_pending);
+
+      funcs->get_query_objectui64v (timing->queries[0],
+                                    GL_QUERY_RESULT,
+                                    &start);
+      funcs->get_query_objectui64v (timing->queries[1],
+                                    GL_QUERY_RESULT,
+                                    &end);
+
+      if (end > start)
+        clutter_gpu_timings_add (timing, end - start);
+
+      gpu_timer_release_query (timing->queries[0]);
+      gpu_timer_release_query (timing->queries[1]);
+
+      g_slice_free (ClutterGpuTiming, timing);
+    }
+
+  if (++gpu_timings_n_frames < GPU_TIMINGS_REPORT_FRAMES)
+    return;
+
+  clutter_gpu_timings_report ();
+
+  gpu_timings_n_frames = 0;
+#endif
+}
+
+#ifdef CLUTTER_ENABLE_PROFILE
+
+/*
+ * Allocation tracking
+ *
+ * When CLUTTER_PROFILE=allocations is set, the GLib allocator is
+ * replaced by a thin wrapper around the C library one which counts the
+ * allocations done in each phase of a frame; a frame that does not
+ * change the scene should not allocate at all. The allocations done
+ * by other threads are counted as well.
+ *
+ * GSlice only falls back to g_malloc() when G_SLICE=always-malloc is
+ * set, so the GList nodes and the other slices are only accounted for
+ * in that case.
+ */
+
+/* the number of frames between two reports of the allocations */
+#define ALLOC_REPORT_FRAMES     120
+
+/* the number of frames in the backtrace of each allocation */
+#define ALLOC_BACKTRACE_DEPTH   16
+
+static const char *alloc_phase_names[CLUTTER_ALLOC_N_PHASES] = {
+  "Other",
+  "Events",
+  "Timelines",
+  "Relayout",
+  "Paint",
+  "Pick"
+};
+
+static ClutterAllocPhase alloc_phase = CLUTTER_ALLOC_PHASE_OTHER;
+static guint alloc_counts[CLUTTER_ALLOC_N_PHASES];
+static guint64 alloc_totals[CLUTTER_ALLOC_N_PHASES];
+static guint alloc_max[CLUTTER_ALLOC_N_PHASES];
+static guint alloc_n_frames = 0;
+
+/* the frames are counted from 1; 0 means that no frame is traced */
+static guint alloc_frame = 0;
+static guint alloc_backtrace_frame = 0;
+static gboolean alloc_in_backtrace = FALSE;
+
+static void
+alloc_tracking_count (void)
+{
+  alloc_counts[alloc_phase] += 1;
+
+#ifdef HAVE_EXECINFO_H
+  /* backtrace() might allocate the first time it is called */
+  if (G_UNLIKELY (alloc_frame == alloc_backtrace_frame) &&
+      !alloc_in_backtrace)
+    {
+      void *frames[ALLOC_BACKTRACE_DEPTH];
+      char header[128];
+      int n_frames, len;
+
+      alloc_in_backtrace = TRUE;
+
+      /* neither the header nor the symbols go through stdio, which
+       * would allocate its buffers */
+      len = snprintf (header, sizeof (header),
+                      "*** Allocation during %s in frame %u ***\n",
+                      alloc_phase_names[alloc_phase],
+                      alloc_frame);
+      if (len > 0)
+        write (STDERR_FILENO, header, MIN ((gsize) len, sizeof (header) - 1));
+
+      n_frames = backtrace (frames, G_N_ELEMENTS (frames));
+
+      /* skip the frames of the allocator */
+      if (n_frames > 2)
+        backtrace_symbols_fd (frames + 2, n_frames - 2, STDERR_FILENO);
+
+      alloc_in_backtrace = FALSE;
+    }
+#endif /* HAVE_EXECINFO_H */
+}
+
+static gpointer
+alloc_tracking_malloc (gsize n_bytes)
+{
+  alloc_tracking_count ();
+
+  return malloc (n_bytes);
+}
+
+static gpointer
+alloc_tracking_realloc (gpointer mem,
+                        gsize    n_bytes)
+{
+  alloc_tracking_count ();
+
+  return realloc (mem, n_bytes);
+}
+
+static gpointer
+alloc_tracking_calloc (gsize n_blocks,
+                       gsize n_block_bytes)
+{
+  alloc_tracking_count ();
+
+  return calloc (n_blocks, n_block_bytes);
+}
+
+static GMemVTable alloc_tracking_vtable = {
+  alloc_tracking_malloc,
+  alloc_tracking_realloc,
+  free,
+  alloc_tracking_calloc,
+  alloc_tracking_malloc,
+  alloc_tracking_realloc
+};
+
+/* the memory allocated before the vtable is installed comes from the
+ * same allocator, so it can still be released through the wrappers
+ */
+void
+_clutter_alloc_tracking_init (guint backtrace_frame)
+{
+  static gboolean initialized = FALSE;
+
+  if (initialized)
+    return;
+
+  initialized = TRUE;
+
+  alloc_backtrace_frame = backtrace_frame;
+  alloc_frame = 1;
+
+  if (!g_mem_is_system_malloc ())
+    {
+      g_warning ("The allocations cannot be tracked with a custom "
+                 "GLib allocator");
+      return;
+    }
+
+  if (g_strcmp0 (g_getenv ("G_SLICE"), "always-malloc") != 0)
+    g_message ("Set G_SLICE=always-malloc to track the slice "
+               "allocations as well");
+
+  g_mem_set_vtable (&alloc_tracking_vtable);
+}
+
+ClutterAllocPhase
+_clutter_alloc_phase_push (ClutterAllocPhase phase)
+{
+  ClutterAllocPhase old_phase = alloc_phase;
+
+  alloc_phase = phase;
+
+  return old_phase;
+}
+
+void
+_clutter_alloc_phase_pop (ClutterAllocPhase old_phase)
+{
+  alloc_phase = old_phase;
+}
+
+static void
+clutter_alloc_tracking_report (void)
+{
+  int i;
+
+  g_print ("*** Allocations per frame over %u frames ***\n",
+           alloc_n_frames);
+
+  for (i = 0; i < CLUTTER_ALLOC_N_PHASES; i++)
+    {
+      g_print ("  %-12s %10.1f avg %8u max\n",
+               alloc_phase_names[i],
+               (gdouble) alloc_totals[i] / alloc_n_frames,
+               alloc_max[i]);
+    }
+}
+
+/* called by the master clock after each iteration that drew at least
+ * one stage */
+void
+_clutter_alloc_tracking_frame_end (void)
+{
+  CLUTTER_STATIC_COUNTER (alloc_events_counter,
+                          "Frames allocating during events",
+                          "Increments for each frame that allocated "
+                          "memory while processing the events",
+                          0 /* no application private data */);
+  CLUTTER_STATIC_COUNTER (alloc_timelines_counter,
+                          "Frames allocating during timelines",
+                          "Increments for each frame that allocated "
+                          "memory while advancing the timelines",
+                          0 /* no application private data */);
+  CLUTTER_STATIC_COUNTER (alloc_relayout_counter,
+                          "Frames allocating during relayout",
+                          "Increments for each frame that allocated "
+                          "memory while allocating the actors",
+                          0 /* no application private data */);
+  CLUTTER_STATIC_COUNTER (alloc_paint_counter,
+                          "Frames allocating during paint",
+                          "Increments for each frame that allocated "
+                          "memory while painting the stages",
+                          0 /* no application private data */);
+  CLUTTER_STATIC_COUNTER (alloc_pick_counter,
+                          "Frames allocating during pick",
+                          "Increments for each frame that allocated "
+                          "memory while picking",
+                          0 /* no application private data */);
+  guint counts[CLUTTER_ALLOC_N_PHASES];
+  int i;
+
+  if (!(clutter_profile_flags & CLUTTER_PROFILE_ALLOCATIONS))
+    return;
+
+  /* take a copy first, since reporting allocates as well */
+  memcpy (counts, alloc_counts, sizeof (counts));
+  memset (alloc_counts, 0, sizeof (alloc_counts));
+
+  alloc_frame += 1;
+
+  if (counts[CLUTTER_ALLOC_PHASE_EVENTS] > 0)
+    CLUTTER_COUNTER_INC (_clutter_uprof_context, alloc_events_counter);
+  if (counts[CLUTTER_ALLOC_PHASE_TIMELINES] > 0)
+    CLUTTER_COUNTER_INC (_clutter_uprof_context, alloc_timelines_counter);
+  if (counts[CLUTTER_ALLOC_PHASE_RELAYOUT] > 0)
+    CLUTTER_COUNTER_INC (_clutter_uprof_context, alloc_relayout_counter);
+  if (counts[CLUTTER_ALLOC_PHASE_PAINT] > 0)
+    CLUTTER_COUNTER_INC (_clutter_uprof_context, alloc_paint_counter);
+  if (counts[CLUTTER_ALLOC_PHASE_PICK] > 0)
+    CLUTTER_COUNTER_INC (_clutter_uprof_context, alloc_pick_counter);
+
+  for (i = 0; i < CLUTTER_ALLOC_N_PHASES; i++)
+    {
+      alloc_totals[i] += counts[i];
+      alloc_max[i] = MAX (alloc_max[i], counts[i]);
+    }
+
+  if (++alloc_n_frames < ALLOC_REPORT_FRAMES)
+    return;
+
+  clutter_alloc_tracking_report ();
+
+  memset (alloc_totals, 0, sizeof (alloc_totals));
+  memset (alloc_max, 0, sizeof (alloc_max));
+  alloc_n_frames = 0;
+
+  /* the report allocated on behalf of no phase in particular */
+  memset (alloc_counts, 0, sizeof (alloc_counts));
+}
+
+#endif /* CLUTTER_ENABLE_PROFILE */
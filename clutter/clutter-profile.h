@@ -32,21 +32,93 @@ G_BEGIN_DECLS
 
 typedef enum {
   CLUTTER_PROFILE_PICKING_ONLY    = 1 << 0,
-  CLUTTER_PROFILE_DISABLE_REPORT  = 1 << 1
+  CLUTTER_PROFILE_DISABLE_REPORT  = 1 << 1,
+  CLUTTER_PROFILE_STARTUP         = 1 << 2,
+  CLUTTER_PROFILE_ALLOCATIONS     = 1 << 3
 } ClutterProfileFlag;
 
+/* the phases of the startup sequence timed in every build, and
+ * reported when CLUTTER_PROFILE_STARTUP is set
+ */
+typedef enum {
+  CLUTTER_STARTUP_OPTION_PARSING,
+  CLUTTER_STARTUP_BACKEND_CONNECT,
+  CLUTTER_STARTUP_CONTEXT_CREATION,
+  CLUTTER_STARTUP_STAGE_REALIZE,
+  CLUTTER_STARTUP_FONT_MAP,
+  CLUTTER_STARTUP_SCRIPT_LOADING,
+
+  CLUTTER_STARTUP_N_PHASES
+} ClutterStartupPhase;
+
+void _clutter_startup_phase_begin (ClutterStartupPhase phase);
+void _clutter_startup_phase_end   (ClutterStartupPhase phase);
+void _clutter_startup_first_frame (void);
+
+/* the GPU time spent painting the actors and running their effects,
+ * measured when CLUTTER_PAINT=gpu-timings is set
+ */
+typedef struct _ClutterGpuTiming ClutterGpuTiming;
+
+ClutterGpuTiming *_clutter_gpu_timing_begin      (GType             actor_type,
+                                                  const gchar      *actor_name,
+                                                  GType             effect_type);
+void              _clutter_gpu_timing_end        (ClutterGpuTiming *timing);
+void              _clutter_gpu_timings_frame_end (void);
+
+/* the begin and end events of the profiling timers, written to the
+ * file named by CLUTTER_TRACE in the Chrome trace format
+ */
+extern gboolean _clutter_trace_enabled;
+
+void _clutter_trace_init      (const char *filename);
+void _clutter_trace_begin     (const char *name);
+void _clutter_trace_end       (const char *name);
+void _clutter_trace_set_stage (gpointer    stage);
+
+#define CLUTTER_TRACE_BEGIN(N) G_STMT_START{            \
+  if (G_UNLIKELY (_clutter_trace_enabled))              \
+    _clutter_trace_begin (N);                           \
+}G_STMT_END
+#define CLUTTER_TRACE_END(N) G_STMT_START{              \
+  if (G_UNLIKELY (_clutter_trace_enabled))              \
+    _clutter_trace_end (N);                             \
+}G_STMT_END
+
+/* the phases of a frame to which the allocations are accounted when
+ * CLUTTER_PROFILE_ALLOCATIONS is set
+ */
+typedef enum {
+  CLUTTER_ALLOC_PHASE_OTHER,
+  CLUTTER_ALLOC_PHASE_EVENTS,
+  CLUTTER_ALLOC_PHASE_TIMELINES,
+  CLUTTER_ALLOC_PHASE_RELAYOUT,
+  CLUTTER_ALLOC_PHASE_PAINT,
+  CLUTTER_ALLOC_PHASE_PICK,
+
+  CLUTTER_ALLOC_N_PHASES
+} ClutterAllocPhase;
+
 #ifdef CLUTTER_ENABLE_PROFILE
 
 #include <uprof.h>
 
 extern UProfContext *_clutter_uprof_context;
 
-#define CLUTTER_STATIC_TIMER    UPROF_STATIC_TIMER
+#define CLUTTER_STATIC_TIMER(A,B,C,D,E) \
+  UPROF_STATIC_TIMER (A, B, C, D, E); \
+  static const char A##_trace_name[] G_GNUC_UNUSED = C
 #define CLUTTER_STATIC_COUNTER  UPROF_STATIC_COUNTER
 #define CLUTTER_COUNTER_INC     UPROF_COUNTER_INC
 #define CLUTTER_COUNTER_DEC     UPROF_COUNTER_DEC
-#define CLUTTER_TIMER_START     UPROF_TIMER_START
-#define CLUTTER_TIMER_STOP      UPROF_TIMER_STOP
+#define CLUTTER_TIMER_START(A,B) G_STMT_START{ \
+  UPROF_TIMER_START (A, B); \
+  CLUTTER_TRACE_BEGIN (B##_trace_name); \
+}G_STMT_END
+#define CLUTTER_TIMER_STOP(A,B) G_STMT_START{ \
+  CLUTTER_TRACE_END (B##_trace_name); \
+  UPROF_TIMER_STOP (A, B); \
+}G_STMT_END
 
 void
 _clutter_uprof_init (void);
@@ -59,20 +131,36 @@ _clutter_profile_resume (void);
 void
 _clutter_profile_trace_message (const char *format, ...);
 
+void
+_clutter_alloc_tracking_init (guint backtrace_frame);
+void
+_clutter_alloc_tracking_frame_end (void);
+
+ClutterAllocPhase
+_clutter_alloc_phase_push (ClutterAllocPhase phase);
+void
+_clutter_alloc_phase_pop (ClutterAllocPhase old_phase);
+
 #else /* CLUTTER_ENABLE_PROFILE */
 
-#define CLUTTER_STATIC_TIMER(A,B,C,D,E) extern void _clutter_dummy_decl (void)
+/* the timers are only traced, without UProf */
+#define CLUTTER_STATIC_TIMER(A,B,C,D,E) \
+  static const char A##_trace_name[] G_GNUC_UNUSED = C
 #define CLUTTER_STATIC_COUNTER(A,B,C,D) extern void _clutter_dummy_decl (void)
 #define CLUTTER_COUNTER_INC(A,B) G_STMT_START{ (void)0; }G_STMT_END
 #define CLUTTER_COUNTER_DEC(A,B) G_STMT_START{ (void)0; }G_STMT_END
-#define CLUTTER_TIMER_START(A,B) G_STMT_START{ (void)0; }G_STMT_END
-#define CLUTTER_TIMER_STOP(A,B) G_STMT_START{ (void)0; }G_STMT_END
+#define CLUTTER_TIMER_START(A,B) CLUTTER_TRACE_BEGIN (B##_trace_name)
+#define CLUTTER_TIMER_STOP(A,B) CLUTTER_TRACE_END (B##_trace_name)
 
 #define _clutter_profile_suspend() G_STMT_START {} G_STMT_END
 #define _clutter_profile_resume() G_STMT_START {} G_STMT_END
 
 #define _clutter_profile_trace_message g_message
 
+#define _clutter_alloc_tracking_frame_end() G_STMT_START {} G_STMT_END
+#define _clutter_alloc_phase_push(p) (CLUTTER_ALLOC_PHASE_OTHER)
+#define _clutter_alloc_phase_pop(p) G_STMT_START { (void) (p); } G_STMT_END
+
 #endif /* CLUTTER_ENABLE_PROFILE */
 
 extern guint clutter_profile_flags;
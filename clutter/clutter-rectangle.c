@@ -36,6 +36,7 @@
 #include "clutter-actor-private.h"
 #include "clutter-color.h"
 #include "clutter-debug.h"
+#include "clutter-display-list.h"
 #include "clutter-main.h"
 #include "clutter-private.h"
 #include "clutter-rectangle.h"
@@ -66,18 +67,108 @@ struct _ClutterRectanglePrivate
 
   guint border_width;
 
+  /* the four sides of the border followed by the fill, computed for
+   * the size and border width they were last painted with */
+  gfloat quads[20];
+  gfloat quads_width;
+  gfloat quads_height;
+  guint quads_border_width;
+
   guint has_border : 1;
+  guint quads_valid : 1;
 };
 
 static const ClutterColor default_color        = { 255, 255, 255, 255 };
 static const ClutterColor default_border_color = {   0,   0,   0, 255 };
 
+/* the quads only depend on the size of the rectangle and on the
+ * border width, so they are reused as long as neither changes */
+static const gfloat *
+clutter_rectangle_get_quads (ClutterRectangle *rectangle,
+                             gfloat            width,
+                             gfloat            height)
+{
+  ClutterRectanglePrivate *priv = rectangle->priv;
+  gfloat *quads = priv->quads;
+  gfloat border_width;
+
+  if (priv->quads_valid &&
+      priv->quads_width == width &&
+      priv->quads_height == height &&
+      priv->quads_border_width == priv->border_width)
+    return quads;
+
+  border_width = priv->border_width;
+
+  /* top */
+  quads[0] = border_width;
+  quads[1] = 0;
+  quads[2] = width;
+  quads[3] = border_width;
+
+  /* right */
+  quads[4] = width - border_width;
+  quads[5] = border_width;
+  quads[6] = width;
+  quads[7] = height;
+
+  /* bottom */
+  quads[8] = 0;
+  quads[9] = height - border_width;
+  quads[10] = width - border_width;
+  quads[11] = height;
+
+  /* left */
+  quads[12] = 0;
+  quads[13] = 0;
+  quads[14] = border_width;
+  quads[15] = height - border_width;
+
+  /* fill */
+  quads[16] = border_width;
+  quads[17] = border_width;
+  quads[18] = width - border_width;
+  quads[19] = height - border_width;
+
+  priv->quads_width = width;
+  priv->quads_height = height;
+  priv->quads_border_width = priv->border_width;
+  priv->quads_valid = TRUE;
+
+  return quads;
+}
+
+/* draws @n_rects rectangles with @color, composited with the paint
+ * opacity, and records them if a display list is being recorded */
+static void
+clutter_rectangle_draw (const ClutterColor *color,
+                        guint8              paint_opacity,
+                        const gfloat       *coords,
+                        guint               n_rects)
+{
+  ClutterColor source;
+
+  source = *color;
+  source.alpha = paint_opacity * color->alpha / 255;
+
+  cogl_set_source_color4ub (source.red,
+                            source.green,
+                            source.blue,
+                            source.alpha);
+  cogl_rectangles (coords, n_rects);
+
+  _clutter_display_list_record_color (&source, coords, n_rects);
+}
+
 static void
 clutter_rectangle_paint (ClutterActor *self)
 {
   ClutterRectanglePrivate *priv = CLUTTER_RECTANGLE (self)->priv;
+  const ClutterColor *fill_color = &priv->color;
+  const ClutterColor *border_color = &priv->border_color;
   ClutterGeometry geom;
-  guint8 tmp_alpha;
+  guint8 paint_opacity;
+  const gfloat *quads;
 
   CLUTTER_NOTE (PAINT,
                 "painting rect '%s'",
@@ -85,72 +176,48 @@ clutter_rectangle_paint (ClutterActor *self)
                                               : "unknown");
   clutter_actor_get_allocation_geometry (self, &geom);
 
-  /* parent paint call will have translated us into position so
-   * paint from 0, 0
-   */
-  if (priv->has_border)
-    {
-      /* compute the composited opacity of the actor taking into
-       * account the opacity of the color set by the user
-       */
-      tmp_alpha = clutter_actor_get_paint_opacity (self)
-                * priv->border_color.alpha
-                / 255;
-
-      /* paint the border */
-      cogl_set_source_color4ub (priv->border_color.red,
-                                priv->border_color.green,
-                                priv->border_color.blue,
-                                tmp_alpha);
-
-      /* this sucks, but it's the only way to make a border */
-      cogl_rectangle (priv->border_width, 0,
-                      geom.width,
-                      priv->border_width);
-
-      cogl_rectangle (geom.width - priv->border_width,
-                      priv->border_width,
-                      geom.width,
-                      geom.height);
-
-      cogl_rectangle (0, geom.height - priv->border_width,
-                      geom.width - priv->border_width,
-                      geom.height);
-
-      cogl_rectangle (0, 0,
-                      priv->border_width,
-                      geom.height - priv->border_width);
-
-      tmp_alpha = clutter_actor_get_paint_opacity (self)
-                * priv->color.alpha
-                / 255;
-
-      /* now paint the rectangle */
-      cogl_set_source_color4ub (priv->color.red,
-                                priv->color.green,
-                                priv->color.blue,
-                                tmp_alpha);
-
-      cogl_rectangle (priv->border_width, priv->border_width,
-                      geom.width - priv->border_width,
-                      geom.height - priv->border_width);
-    }
-  else
+  paint_opacity = clutter_actor_get_paint_opacity (self);
+
+  /* a border with the same color as the fill is painted together
+   * with it, as a single rectangle */
+  if (!priv->has_border ||
+      priv->border_width == 0 ||
+      clutter_color_equal (border_color, fill_color))
     {
-      /* compute the composited opacity of the actor taking into
-       * account the opacity of the color set by the user
+      gfloat coords[4];
+
+      if (fill_color->alpha == 0)
+        return;
+
+      /* parent paint call will have translated us into position so
+       * paint from 0, 0
        */
-      tmp_alpha = clutter_actor_get_paint_opacity (self)
-                * priv->color.alpha
-                / 255;
+      coords[0] = 0;
+      coords[1] = 0;
+      coords[2] = geom.width;
+      coords[3] = geom.height;
 
-      cogl_set_source_color4ub (priv->color.red,
-                                priv->color.green,
-                                priv->color.blue,
-                                tmp_alpha);
+      /* the composited opacity of the actor takes into account the
+       * opacity of the color set by the user
+       */
+      clutter_rectangle_draw (fill_color, paint_opacity, coords, 1);
 
-      cogl_rectangle (0, 0, geom.width, geom.height);
+      return;
     }
+
+  quads = clutter_rectangle_get_quads (CLUTTER_RECTANGLE (self),
+                                       geom.width,
+                                       geom.height);
+
+  /* the colors are logged per vertex in the Cogl journal, so the
+   * border and the fill end up in the same batch as long as changing
+   * the source color does not change the blending state; submitting
+   * all the sides at once keeps the number of journal entries low */
+  if (border_color->alpha > 0)
+    clutter_rectangle_draw (border_color, paint_opacity, quads, 4);
+
+  if (fill_color->alpha > 0)
+    clutter_rectangle_draw (fill_color, paint_opacity, quads + 16, 1);
 }
 
 static gboolean
@@ -170,6 +237,17 @@ clutter_rectangle_has_overlaps (ClutterActor *self)
   return FALSE;
 }
 
+static gboolean
+clutter_rectangle_is_opaque (ClutterActor *self)
+{
+  ClutterRectanglePrivate *priv = CLUTTER_RECTANGLE (self)->priv;
+
+  if (priv->has_border && priv->border_color.alpha != 255)
+    return FALSE;
+
+  return priv->color.alpha == 255;
+}
+
 static void
 clutter_rectangle_set_property (GObject      *object,
 				guint         prop_id,
@@ -252,12 +330,15 @@ clutter_rectangle_class_init (ClutterRectangleClass *klass)
   actor_class->paint            = clutter_rectangle_paint;
   actor_class->get_paint_volume = clutter_rectangle_get_paint_volume;
   actor_class->has_overlaps     = clutter_rectangle_has_overlaps;
+  actor_class->is_opaque        = clutter_rectangle_is_opaque;
 
   gobject_class->finalize     = clutter_rectangle_finalize;
   gobject_class->dispose      = clutter_rectangle_dispose;
   gobject_class->set_property = clutter_rectangle_set_property;
   gobject_class->get_property = clutter_rectangle_get_property;
 
+  _clutter_display_list_add_recordable_type (CLUTTER_TYPE_RECTANGLE);
+
   /**
    * ClutterRectangle:color:
    *
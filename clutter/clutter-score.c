@@ -115,6 +115,11 @@ struct _ClutterScorePrivate
 {
   GNode      *root;
 
+  /* the nodes of the tree, indexed by timeline and by id, so that
+   * the entries can be found without traversing the tree */
+  GHashTable *nodes_by_timeline;
+  GHashTable *nodes_by_id;
+
   GHashTable *running_timelines;
 
   gulong      last_id;
@@ -196,6 +201,9 @@ clutter_score_finalize (GObject *object)
   clutter_score_stop (score);
   clutter_score_clear (score);
 
+  g_hash_table_destroy (score->priv->nodes_by_timeline);
+  g_hash_table_destroy (score->priv->nodes_by_id);
+
   G_OBJECT_CLASS (clutter_score_parent_class)->finalize (object);
 }
 
@@ -324,6 +332,9 @@ clutter_score_init (ClutterScore *self)
   /* sentinel */
   priv->root = g_node_new (NULL);
 
+  priv->nodes_by_timeline = g_hash_table_new (NULL, NULL);
+  priv->nodes_by_id = g_hash_table_new (NULL, NULL);
+
   priv->running_timelines = NULL;
 
   priv->is_paused = FALSE;
@@ -426,6 +437,15 @@ destroy_entry (GNode                  *node,
 
   if (G_LIKELY (entry != NULL))
     {
+      ClutterScorePrivate *priv = entry->score->priv;
+
+      if (g_hash_table_lookup (priv->nodes_by_timeline,
+                               entry->timeline) == node)
+        g_hash_table_remove (priv->nodes_by_timeline, entry->timeline);
+
+      g_hash_table_remove (priv->nodes_by_id,
+                           GUINT_TO_POINTER (entry->id));
+
       if (entry->marker_id)
         {
           g_signal_handler_disconnect (entry->parent, entry->marker_id);
@@ -450,8 +470,6 @@ destroy_entry (GNode                  *node,
 }
 
 typedef enum {
-  FIND_BY_TIMELINE,
-  FIND_BY_ID,
   REMOVE_BY_ID,
   LIST_TIMELINES
 } TraverseAction;
@@ -463,7 +481,6 @@ typedef struct {
 
   /* parameters */
   union {
-    ClutterTimeline *timeline;
     gulong id;
     ClutterScoreEntry *entry;
   } d;
@@ -486,22 +503,6 @@ traverse_children (GNode    *node,
 
   switch (closure->action)
     {
-    case FIND_BY_TIMELINE:
-      if (closure->d.timeline == entry->timeline)
-        {
-          closure->result = node;
-          retval = TRUE;
-        }
-      break;
-
-    case FIND_BY_ID:
-      if (closure->d.id == entry->id)
-        {
-          closure->result = node;
-          retval = TRUE;
-        }
-      break;
-
     case REMOVE_BY_ID:
       if (closure->d.id == entry->id)
         {
@@ -533,48 +534,37 @@ static GNode *
 find_entry_by_timeline (ClutterScore    *score,
                         ClutterTimeline *timeline)
 {
-  ClutterScorePrivate *priv = score->priv;
-  TraverseClosure closure;
-
-  closure.action = FIND_BY_TIMELINE;
-  closure.score = score;
-  closure.d.timeline = timeline;
-  closure.result = NULL;
-
-  g_node_traverse (priv->root,
-                   G_POST_ORDER,
-                   G_TRAVERSE_ALL,
-                   -1,
-                   traverse_children, &closure);
-
-  if (closure.result)
-    return closure.result;
-
-  return NULL;
+  return g_hash_table_lookup (score->priv->nodes_by_timeline, timeline);
 }
 
 static GNode *
 find_entry_by_id (ClutterScore *score,
                   gulong        id_)
 {
-  ClutterScorePrivate *priv = score->priv;
-  TraverseClosure closure;
+  return g_hash_table_lookup (score->priv->nodes_by_id,
+                              GUINT_TO_POINTER (id_));
+}
 
-  closure.action = FIND_BY_ID;
-  closure.score = score;
-  closure.d.id = id_;
-  closure.result = NULL;
+/* adds @entry to the tree, under @parent */
+static void
+add_entry (ClutterScore      *score,
+           GNode             *parent,
+           ClutterScoreEntry *entry)
+{
+  ClutterScorePrivate *priv = score->priv;
 
-  g_node_traverse (priv->root,
-                   G_POST_ORDER,
-                   G_TRAVERSE_ALL,
-                   -1,
-                   traverse_children, &closure);
+  entry->node = g_node_append_data (parent, entry);
 
-  if (closure.result)
-    return closure.result;
+  /* a timeline is not supposed to be in the score more than once,
+   * but if it is, the first entry is the one used as parent */
+  if (g_hash_table_lookup (priv->nodes_by_timeline, entry->timeline) == NULL)
+    g_hash_table_insert (priv->nodes_by_timeline,
+                         entry->timeline,
+                         entry->node);
 
-  return NULL;
+  g_hash_table_insert (priv->nodes_by_id,
+                       GUINT_TO_POINTER (entry->id),
+                       entry->node);
 }
 
 /* forward declaration */
@@ -586,11 +576,9 @@ start_children_entries (GNode    *node,
 {
   ClutterScoreEntry *entry = node->data;
 
-  /* If data is NULL, start all entries that have no marker, otherwise
-     only start entries that have the same marker */
-  if (data == NULL
-      ? entry->marker == NULL
-      : (entry->marker && !strcmp (data, entry->marker)))
+  /* the entries attached to a marker are started by their own
+     handler of the ::marker-reached signal */
+  if (entry->marker == NULL)
     start_entry (entry);
 }
 
@@ -600,23 +588,13 @@ on_timeline_marker (ClutterTimeline   *timeline,
                     gint               frame_num,
                     ClutterScoreEntry *entry)
 {
-  GNode *parent;
   CLUTTER_NOTE (SCHEDULER, "timeline [%p] marker ('%s') reached",
 		entry->timeline,
                 entry->marker);
 
-  parent = find_entry_by_timeline (entry->score, timeline);
-  if (!parent)
-    return;
-
-  /* start every child */
-  if (parent->children)
-    {
-      g_node_children_foreach (parent,
-                               G_TRAVERSE_ALL,
-                               start_children_entries,
-                               (gpointer) marker_name);
-    }
+  /* every entry attached to the marker has its own handler, connected
+     to the detailed signal, so it is enough to start this one */
+  start_entry (entry);
 }
 
 static void
@@ -902,7 +880,7 @@ clutter_score_append (ClutterScore    *score,
       entry->complete_id = 0;
       entry->score = score;
 
-      entry->node = g_node_append_data (priv->root, entry);
+      add_entry (score, priv->root, entry);
     }
   else
     {
@@ -924,7 +902,7 @@ clutter_score_append (ClutterScore    *score,
       entry->complete_id = 0;
       entry->score = score;
 
-      entry->node = g_node_append_data (node, entry);
+      add_entry (score, node, entry);
     }
 
   priv->last_id += 1;
@@ -998,7 +976,7 @@ clutter_score_append_at_marker (ClutterScore    *score,
                                        G_CALLBACK (on_timeline_marker),
                                        entry);
 
-  entry->node = g_node_append_data (node, entry);
+  add_entry (score, node, entry);
 
   g_free (marker_reached_signal);
 
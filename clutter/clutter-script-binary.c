@@ -0,0 +1,960 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2011 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Compiled ClutterScript definitions
+ */
+
+/* A compiled UI definition stores the object graph that the
+ * ClutterScriptParser would extract from a JSON definition: one record
+ * per object definition, in the same leaf-first order used by the
+ * parser, with the "children" and "signals" members already split out
+ * and every other member stored as a typed value tree. Loading it does
+ * not need to tokenize any JSON, and every string is referenced by its
+ * offset inside a single string table.
+ *
+ * The layout is:
+ *
+ *   header    := ScriptBinaryHeader
+ *   strings   := (NUL-terminated string)*
+ *   objects   := object*
+ *
+ *   object    := id:str class:str type_func:str flags:u32
+ *                n_children:u32 (id:str)*
+ *                n_signals:u32 (name:str handler:str object:str flags:u32)*
+ *                n_properties:u32 (name:str value)*
+ *   value     := tag:u32 payload
+ *
+ * Every integer is stored in host byte order; a compiled file has to
+ * be regenerated when moving to an architecture with a different
+ * endianness. Objects without an "id" member get a placeholder id
+ * index, which is replaced by a fake id when loading, so that
+ * compiled definitions can be merged like JSON ones.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <glib.h>
+#include <json-glib/json-glib.h>
+
+#include "clutter-script.h"
+#include "clutter-script-private.h"
+
+#include "clutter-debug.h"
+#include "clutter-private.h"
+
+#define SCRIPT_BINARY_MAGIC             "CLTRSCPT"
+#define SCRIPT_BINARY_BYTE_ORDER        0x01020304
+#define SCRIPT_BINARY_VERSION           1
+
+/* string references with this bit set are indices inside the
+ * table of fake ids generated at load time
+ */
+#define SCRIPT_BINARY_FAKE_ID           0x80000000
+#define SCRIPT_BINARY_NO_STRING         0xffffffff
+
+#define SCRIPT_BINARY_MAX_DEPTH         256
+
+/* a placeholder that cannot come out of a sane UI definition */
+#define SCRIPT_BINARY_FAKE_ID_PREFIX    "\001clutter-script-compiled-"
+
+enum
+{
+  OBJECT_IS_STAGE_DEFAULT = 1 << 0,
+  OBJECT_HAS_IS_DEFAULT   = 1 << 1
+};
+
+enum
+{
+  VALUE_NULL,
+  VALUE_BOOLEAN,
+  VALUE_INT,
+  VALUE_DOUBLE,
+  VALUE_STRING,
+  VALUE_ARRAY,
+  VALUE_OBJECT
+};
+
+typedef struct {
+  gchar   magic[8];
+  guint32 byte_order;
+  guint32 version;
+  guint32 n_objects;
+  guint32 n_fake_ids;
+  guint32 strings_offset;
+  guint32 strings_size;
+  guint32 objects_offset;
+  guint32 objects_size;
+} ScriptBinaryHeader;
+
+typedef struct {
+  GByteArray *strings;
+  GByteArray *objects;
+
+  /* string -> offset + 1 */
+  GHashTable *string_offsets;
+
+  /* placeholder id -> index + 1 */
+  GHashTable *fake_ids;
+
+  guint n_objects;
+  guint n_fake_ids;
+} ScriptCompiler;
+
+typedef struct {
+  ClutterScript *script;
+
+  const guint8 *data;
+  gsize size;
+  gsize cursor;
+
+  const gchar *strings;
+  gsize strings_size;
+
+  gchar **fake_ids;
+  guint n_fake_ids;
+} ScriptReader;
+
+static inline void
+compiler_write_uint32 (GByteArray *buffer,
+                       guint32     value)
+{
+  g_byte_array_append (buffer, (const guint8 *) &value, sizeof (guint32));
+}
+
+static guint32
+compiler_add_string (ScriptCompiler *compiler,
+                     const gchar    *str)
+{
+  gpointer offset;
+
+  if (str == NULL)
+    return SCRIPT_BINARY_NO_STRING;
+
+  offset = g_hash_table_lookup (compiler->fake_ids, str);
+  if (offset != NULL)
+    return (GPOINTER_TO_UINT (offset) - 1) | SCRIPT_BINARY_FAKE_ID;
+
+  offset = g_hash_table_lookup (compiler->string_offsets, str);
+  if (offset == NULL)
+    {
+      guint32 pos = compiler->strings->len;
+
+      g_byte_array_append (compiler->strings,
+                           (const guint8 *) str,
+                           strlen (str) + 1);
+
+      offset = GUINT_TO_POINTER (pos + 1);
+      g_hash_table_insert (compiler->string_offsets, g_strdup (str), offset);
+    }
+
+  return GPOINTER_TO_UINT (offset) - 1;
+}
+
+static inline void
+compiler_write_string (ScriptCompiler *compiler,
+                       const gchar    *str)
+{
+  compiler_write_uint32 (compiler->objects,
+                         compiler_add_string (compiler, str));
+}
+
+static void
+compiler_write_value (ScriptCompiler *compiler,
+                      JsonNode       *node)
+{
+  GByteArray *buffer = compiler->objects;
+
+  switch (JSON_NODE_TYPE (node))
+    {
+    case JSON_NODE_OBJECT:
+      {
+        JsonObject *object = json_node_get_object (node);
+        GList *members, *l;
+
+        members = json_object_get_members (object);
+
+        compiler_write_uint32 (buffer, VALUE_OBJECT);
+        compiler_write_uint32 (buffer, g_list_length (members));
+
+        for (l = members; l != NULL; l = l->next)
+          {
+            compiler_write_string (compiler, l->data);
+            compiler_write_value (compiler,
+                                  json_object_get_member (object, l->data));
+          }
+
+        g_list_free (members);
+      }
+      break;
+
+    case JSON_NODE_ARRAY:
+      {
+        JsonArray *array = json_node_get_array (node);
+        guint i, len;
+
+        len = json_array_get_length (array);
+
+        compiler_write_uint32 (buffer, VALUE_ARRAY);
+        compiler_write_uint32 (buffer, len);
+
+        for (i = 0; i < len; i++)
+          compiler_write_value (compiler, json_array_get_element (array, i));
+      }
+      break;
+
+    case JSON_NODE_VALUE:
+      {
+        GType value_type = json_node_get_value_type (node);
+
+        if (value_type == G_TYPE_BOOLEAN)
+          {
+            compiler_write_uint32 (buffer, VALUE_BOOLEAN);
+            compiler_write_uint32 (buffer, json_node_get_boolean (node));
+          }
+        else if (value_type == G_TYPE_INT64)
+          {
+            gint64 v = json_node_get_int (node);
+
+            compiler_write_uint32 (buffer, VALUE_INT);
+            g_byte_array_append (buffer, (const guint8 *) &v, sizeof (gint64));
+          }
+        else if (value_type == G_TYPE_DOUBLE)
+          {
+            gdouble v = json_node_get_double (node);
+
+            compiler_write_uint32 (buffer, VALUE_DOUBLE);
+            g_byte_array_append (buffer, (const guint8 *) &v, sizeof (gdouble));
+          }
+        else
+          {
+            compiler_write_uint32 (buffer, VALUE_STRING);
+            compiler_write_string (compiler, json_node_get_string (node));
+          }
+      }
+      break;
+
+    case JSON_NODE_NULL:
+      compiler_write_uint32 (buffer, VALUE_NULL);
+      break;
+    }
+}
+
+static guint
+compiler_write_ids (ScriptCompiler *compiler,
+                    JsonNode       *node)
+{
+  JsonArray *array;
+  guint i, len, n_ids;
+  guint offset;
+
+  /* reserve the slot for the count */
+  offset = compiler->objects->len;
+  compiler_write_uint32 (compiler->objects, 0);
+
+  if (JSON_NODE_TYPE (node) != JSON_NODE_ARRAY)
+    return 0;
+
+  array = json_node_get_array (node);
+  len = json_array_get_length (array);
+
+  for (i = 0, n_ids = 0; i < len; i++)
+    {
+      const gchar *id_;
+
+      id_ = _clutter_script_get_id_from_node (json_array_get_element (array, i));
+      if (id_ == NULL)
+        continue;
+
+      compiler_write_string (compiler, id_);
+      n_ids += 1;
+    }
+
+  memcpy (compiler->objects->data + offset, &n_ids, sizeof (guint32));
+
+  return n_ids;
+}
+
+static void
+compiler_write_signals (ScriptCompiler *compiler,
+                        JsonNode       *node)
+{
+  JsonArray *array;
+  guint i, len, n_signals;
+  guint offset;
+
+  offset = compiler->objects->len;
+  compiler_write_uint32 (compiler->objects, 0);
+
+  if (JSON_NODE_TYPE (node) != JSON_NODE_ARRAY)
+    {
+      g_warning ("Invalid value of type '%s' for attribute 'signals': "
+                 "a value of type 'Array' is expected",
+                 json_node_type_name (node));
+      return;
+    }
+
+  array = json_node_get_array (node);
+  len = json_array_get_length (array);
+
+  for (i = 0, n_signals = 0; i < len; i++)
+    {
+      JsonNode *val = json_array_get_element (array, i);
+      JsonObject *object;
+      const gchar *name, *handler, *connect;
+      GConnectFlags flags = 0;
+
+      if (JSON_NODE_TYPE (val) != JSON_NODE_OBJECT)
+        continue;
+
+      object = json_node_get_object (val);
+
+      /* the same rules of parse_signals() apply here */
+      if (!json_object_has_member (object, "name") ||
+          !json_object_has_member (object, "handler"))
+        continue;
+
+      name = json_object_get_string_member (object, "name");
+      handler = json_object_get_string_member (object, "handler");
+      if (name == NULL || handler == NULL)
+        continue;
+
+      if (json_object_has_member (object, "object"))
+        connect = json_object_get_string_member (object, "object");
+      else
+        connect = NULL;
+
+      if (json_object_has_member (object, "after") &&
+          json_object_get_boolean_member (object, "after"))
+        flags |= G_CONNECT_AFTER;
+
+      if (json_object_has_member (object, "swapped") &&
+          json_object_get_boolean_member (object, "swapped"))
+        flags |= G_CONNECT_SWAPPED;
+
+      compiler_write_string (compiler, name);
+      compiler_write_string (compiler, handler);
+      compiler_write_string (compiler, connect);
+      compiler_write_uint32 (compiler->objects, flags);
+
+      n_signals += 1;
+    }
+
+  memcpy (compiler->objects->data + offset, &n_signals, sizeof (guint32));
+}
+
+/* mirrors clutter_script_parser_object_end() */
+static void
+compiler_write_object (ScriptCompiler *compiler,
+                       JsonObject     *object)
+{
+  GByteArray *buffer = compiler->objects;
+  const gchar *class_name;
+  GList *members, *l;
+  guint32 flags = 0;
+  guint n_properties, offset;
+
+  if (!json_object_has_member (object, "type"))
+    {
+      if (json_object_has_member (object, "id"))
+        g_warning ("Object '%s' has no 'type' attribute",
+                   json_object_get_string_member (object, "id"));
+
+      return;
+    }
+
+  if (!json_object_has_member (object, "id"))
+    {
+      gchar *fake;
+
+      fake = g_strdup_printf (SCRIPT_BINARY_FAKE_ID_PREFIX "%u",
+                              compiler->n_fake_ids);
+      json_object_set_string_member (object, "id", fake);
+
+      compiler->n_fake_ids += 1;
+      g_hash_table_insert (compiler->fake_ids,
+                           fake,
+                           GUINT_TO_POINTER (compiler->n_fake_ids));
+    }
+
+  class_name = json_object_get_string_member (object, "type");
+
+  compiler_write_string (compiler, json_object_get_string_member (object, "id"));
+  compiler_write_string (compiler, class_name);
+
+  if (json_object_has_member (object, "type_func"))
+    {
+      compiler_write_string (compiler,
+                             json_object_get_string_member (object, "type_func"));
+      json_object_remove_member (object, "type_func");
+    }
+  else
+    compiler_write_uint32 (buffer, SCRIPT_BINARY_NO_STRING);
+
+  if (class_name != NULL &&
+      strcmp (class_name, "ClutterStage") == 0 &&
+      json_object_has_member (object, "is-default"))
+    {
+      flags |= OBJECT_HAS_IS_DEFAULT;
+
+      if (json_object_get_boolean_member (object, "is-default"))
+        flags |= OBJECT_IS_STAGE_DEFAULT;
+
+      json_object_remove_member (object, "is-default");
+    }
+
+  compiler_write_uint32 (buffer, flags);
+
+  if (json_object_has_member (object, "children"))
+    {
+      compiler_write_ids (compiler,
+                          json_object_get_member (object, "children"));
+      json_object_remove_member (object, "children");
+    }
+  else
+    compiler_write_uint32 (buffer, 0);
+
+  if (json_object_has_member (object, "signals"))
+    {
+      compiler_write_signals (compiler,
+                              json_object_get_member (object, "signals"));
+      json_object_remove_member (object, "signals");
+    }
+  else
+    compiler_write_uint32 (buffer, 0);
+
+  offset = buffer->len;
+  compiler_write_uint32 (buffer, 0);
+
+  n_properties = 0;
+  members = json_object_get_members (object);
+  for (l = members; l != NULL; l = l->next)
+    {
+      const gchar *name = l->data;
+
+      if (strcmp (name, "id") == 0 || strcmp (name, "type") == 0)
+        continue;
+
+      compiler_write_string (compiler, name);
+      compiler_write_value (compiler, json_object_get_member (object, name));
+
+      n_properties += 1;
+    }
+
+  g_list_free (members);
+
+  memcpy (buffer->data + offset, &n_properties, sizeof (guint32));
+
+  compiler->n_objects += 1;
+}
+
+/* walks the tree leaf-first, like the JsonParser signals do */
+static void
+compiler_walk_node (ScriptCompiler *compiler,
+                    JsonNode       *node)
+{
+  switch (JSON_NODE_TYPE (node))
+    {
+    case JSON_NODE_OBJECT:
+      {
+        JsonObject *object = json_node_get_object (node);
+        GList *members, *l;
+
+        members = json_object_get_members (object);
+        for (l = members; l != NULL; l = l->next)
+          compiler_walk_node (compiler, json_object_get_member (object, l->data));
+
+        g_list_free (members);
+
+        compiler_write_object (compiler, object);
+      }
+      break;
+
+    case JSON_NODE_ARRAY:
+      {
+        JsonArray *array = json_node_get_array (node);
+        guint i, len;
+
+        len = json_array_get_length (array);
+        for (i = 0; i < len; i++)
+          compiler_walk_node (compiler, json_array_get_element (array, i));
+      }
+      break;
+
+    default:
+      break;
+    }
+}
+
+/*
+ * _clutter_script_compile_node:
+ * @root: the root of a UI definition
+ *
+ * Compiles the UI definition inside @root. The nodes of @root are
+ * modified in the process, the same way the #ClutterScriptParser
+ * modifies them.
+ *
+ * Return value: a newly allocated #GByteArray with the compiled data
+ */
+GByteArray *
+_clutter_script_compile_node (JsonNode *root)
+{
+  ScriptCompiler compiler;
+  ScriptBinaryHeader header;
+  GByteArray *retval;
+
+  compiler.strings = g_byte_array_new ();
+  compiler.objects = g_byte_array_new ();
+  compiler.string_offsets = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                   g_free,
+                                                   NULL);
+  compiler.fake_ids = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                             g_free,
+                                             NULL);
+  compiler.n_objects = 0;
+  compiler.n_fake_ids = 0;
+
+  compiler_walk_node (&compiler, root);
+
+  memset (&header, 0, sizeof (header));
+  memcpy (header.magic, SCRIPT_BINARY_MAGIC, sizeof (header.magic));
+  header.byte_order = SCRIPT_BINARY_BYTE_ORDER;
+  header.version = SCRIPT_BINARY_VERSION;
+  header.n_objects = compiler.n_objects;
+  header.n_fake_ids = compiler.n_fake_ids;
+  header.strings_offset = sizeof (header);
+  header.strings_size = compiler.strings->len;
+  header.objects_offset = header.strings_offset + header.strings_size;
+  header.objects_size = compiler.objects->len;
+
+  CLUTTER_NOTE (SCRIPT,
+                "Compiled %u objects (strings: %u bytes, objects: %u bytes)",
+                header.n_objects,
+                header.strings_size,
+                header.objects_size);
+
+  retval = g_byte_array_sized_new (header.objects_offset + header.objects_size);
+  g_byte_array_append (retval, (const guint8 *) &header, sizeof (header));
+  g_byte_array_append (retval, compiler.strings->data, compiler.strings->len);
+  g_byte_array_append (retval, compiler.objects->data, compiler.objects->len);
+
+  g_hash_table_destroy (compiler.fake_ids);
+  g_hash_table_destroy (compiler.string_offsets);
+  g_byte_array_free (compiler.objects, TRUE);
+  g_byte_array_free (compiler.strings, TRUE);
+
+  return retval;
+}
+
+static gboolean
+reader_read_uint32 (ScriptReader *reader,
+                    guint32      *value)
+{
+  if (reader->size - reader->cursor < sizeof (guint32))
+    return FALSE;
+
+  memcpy (value, reader->data + reader->cursor, sizeof (guint32));
+  reader->cursor += sizeof (guint32);
+
+  return TRUE;
+}
+
+static gboolean
+reader_read_string (ScriptReader  *reader,
+                    const gchar  **str)
+{
+  guint32 offset;
+
+  if (!reader_read_uint32 (reader, &offset))
+    return FALSE;
+
+  if (offset == SCRIPT_BINARY_NO_STRING)
+    {
+      *str = NULL;
+      return TRUE;
+    }
+
+  if (offset & SCRIPT_BINARY_FAKE_ID)
+    {
+      offset &= ~SCRIPT_BINARY_FAKE_ID;
+      if (offset >= reader->n_fake_ids)
+        return FALSE;
+
+      *str = reader->fake_ids[offset];
+      return TRUE;
+    }
+
+  if (offset >= reader->strings_size)
+    return FALSE;
+
+  *str = reader->strings + offset;
+
+  return TRUE;
+}
+
+static JsonNode *
+reader_read_value (ScriptReader *reader,
+                   guint         depth)
+{
+  JsonNode *retval = NULL;
+  guint32 tag, len, i;
+
+  if (depth > SCRIPT_BINARY_MAX_DEPTH)
+    return NULL;
+
+  if (!reader_read_uint32 (reader, &tag))
+    return NULL;
+
+  switch (tag)
+    {
+    case VALUE_NULL:
+      retval = json_node_new (JSON_NODE_NULL);
+      break;
+
+    case VALUE_BOOLEAN:
+      if (reader_read_uint32 (reader, &len))
+        {
+          retval = json_node_new (JSON_NODE_VALUE);
+          json_node_set_boolean (retval, len != 0);
+        }
+      break;
+
+    case VALUE_INT:
+    case VALUE_DOUBLE:
+      if (reader->size - reader->cursor >= 8)
+        {
+          const guint8 *p = reader->data + reader->cursor;
+
+          retval = json_node_new (JSON_NODE_VALUE);
+
+          if (tag == VALUE_INT)
+            {
+              gint64 v;
+
+              memcpy (&v, p, sizeof (gint64));
+              json_node_set_int (retval, v);
+            }
+          else
+            {
+              gdouble v;
+
+              memcpy (&v, p, sizeof (gdouble));
+              json_node_set_double (retval, v);
+            }
+
+          reader->cursor += 8;
+        }
+      break;
+
+    case VALUE_STRING:
+      {
+        const gchar *str;
+
+        if (reader_read_string (reader, &str) && str != NULL)
+          {
+            retval = json_node_new (JSON_NODE_VALUE);
+            json_node_set_string (retval, str);
+          }
+      }
+      break;
+
+    case VALUE_ARRAY:
+      if (reader_read_uint32 (reader, &len))
+        {
+          JsonArray *array = json_array_sized_new (MIN (len, 64));
+
+          for (i = 0; i < len; i++)
+            {
+              JsonNode *element = reader_read_value (reader, depth + 1);
+
+              if (element == NULL)
+                break;
+
+              json_array_add_element (array, element);
+            }
+
+          if (i == len)
+            {
+              retval = json_node_new (JSON_NODE_ARRAY);
+              json_node_take_array (retval, array);
+            }
+          else
+            json_array_unref (array);
+        }
+      break;
+
+    case VALUE_OBJECT:
+      if (reader_read_uint32 (reader, &len))
+        {
+          JsonObject *object = json_object_new ();
+
+          for (i = 0; i < len; i++)
+            {
+              const gchar *name;
+              JsonNode *member;
+
+              if (!reader_read_string (reader, &name) || name == NULL)
+                break;
+
+              member = reader_read_value (reader, depth + 1);
+              if (member == NULL)
+                break;
+
+              json_object_set_member (object, name, member);
+            }
+
+          if (i == len)
+            {
+              retval = json_node_new (JSON_NODE_OBJECT);
+              json_node_take_object (retval, object);
+            }
+          else
+            json_object_unref (object);
+        }
+      break;
+
+    default:
+      break;
+    }
+
+  return retval;
+}
+
+/* mirrors the second half of clutter_script_parser_object_end() */
+static gboolean
+reader_read_object (ScriptReader *reader)
+{
+  ClutterScript *script = reader->script;
+  const gchar *id_, *class_name, *type_func;
+  ObjectInfo *oinfo;
+  guint32 flags, n_items, i;
+  gboolean is_new = FALSE;
+
+  if (!reader_read_string (reader, &id_) || id_ == NULL ||
+      !reader_read_string (reader, &class_name) || class_name == NULL ||
+      !reader_read_string (reader, &type_func) ||
+      !reader_read_uint32 (reader, &flags))
+    return FALSE;
+
+  oinfo = _clutter_script_get_object_info (script, id_);
+  if (oinfo == NULL)
+    {
+      oinfo = g_slice_new0 (ObjectInfo);
+      oinfo->merge_id = _clutter_script_get_last_merge_id (script);
+      oinfo->id = g_strdup (id_);
+      oinfo->class_name = g_strdup (class_name);
+      oinfo->type_func = g_strdup (type_func);
+
+      is_new = TRUE;
+    }
+
+  /* children */
+  if (!reader_read_uint32 (reader, &n_items))
+    goto fail;
+
+  for (i = 0; i < n_items; i++)
+    {
+      const gchar *child_id;
+
+      if (!reader_read_string (reader, &child_id) || child_id == NULL)
+        goto fail;
+
+      oinfo->children = g_list_prepend (oinfo->children, g_strdup (child_id));
+    }
+
+  if (n_items > 0)
+    oinfo->children = g_list_reverse (oinfo->children);
+
+  /* signals */
+  if (!reader_read_uint32 (reader, &n_items))
+    goto fail;
+
+  for (i = 0; i < n_items; i++)
+    {
+      const gchar *name, *handler, *connect;
+      SignalInfo *sinfo;
+      guint32 connect_flags;
+
+      if (!reader_read_string (reader, &name) || name == NULL ||
+          !reader_read_string (reader, &handler) || handler == NULL ||
+          !reader_read_string (reader, &connect) ||
+          !reader_read_uint32 (reader, &connect_flags))
+        goto fail;
+
+      sinfo = g_slice_new0 (SignalInfo);
+      sinfo->name = g_strdup (name);
+      sinfo->handler = g_strdup (handler);
+      sinfo->object = g_strdup (connect);
+      sinfo->flags = connect_flags;
+
+      oinfo->signals = g_list_prepend (oinfo->signals, sinfo);
+    }
+
+  oinfo->is_actor = FALSE;
+
+  if (flags & OBJECT_HAS_IS_DEFAULT)
+    {
+      oinfo->is_actor = TRUE;
+      oinfo->is_stage = TRUE;
+      oinfo->is_stage_default = (flags & OBJECT_IS_STAGE_DEFAULT) != 0;
+    }
+  else
+    oinfo->is_stage_default = FALSE;
+
+  oinfo->is_unmerged = FALSE;
+  oinfo->has_unresolved = TRUE;
+
+  /* properties */
+  if (!reader_read_uint32 (reader, &n_items))
+    goto fail;
+
+  for (i = 0; i < n_items; i++)
+    {
+      const gchar *name;
+      PropertyInfo *pinfo;
+      JsonNode *node;
+
+      if (!reader_read_string (reader, &name) || name == NULL)
+        goto fail;
+
+      node = reader_read_value (reader, 0);
+      if (node == NULL)
+        goto fail;
+
+      pinfo = g_slice_new (PropertyInfo);
+      pinfo->name = g_strdup (name);
+      pinfo->node = node;
+      pinfo->pspec = NULL;
+      pinfo->is_child = g_str_has_prefix (name, "child::") ? TRUE : FALSE;
+      pinfo->is_layout = g_str_has_prefix (name, "layout::") ? TRUE : FALSE;
+
+      oinfo->properties = g_list_prepend (oinfo->properties, pinfo);
+    }
+
+  CLUTTER_NOTE (SCRIPT,
+                "Added compiled object '%s' (type:%s, id:%d, props:%d)",
+                oinfo->id,
+                oinfo->class_name,
+                oinfo->merge_id,
+                g_list_length (oinfo->properties));
+
+  _clutter_script_add_object_info (script, oinfo);
+
+  if (!_clutter_script_is_lazy (script))
+    _clutter_script_construct_object (script, oinfo);
+
+  return TRUE;
+
+fail:
+  if (is_new)
+    object_info_free (oinfo);
+
+  return FALSE;
+}
+
+/*
+ * _clutter_script_load_compiled_data:
+ * @script: a #ClutterScript
+ * @data: the compiled data
+ * @size: the size of @data
+ * @error: return location for a #GError, or %NULL
+ *
+ * Loads the compiled UI definition in @data, as created by
+ * _clutter_script_compile_node(), into @script using the current
+ * merge id.
+ *
+ * Return value: %TRUE on success
+ */
+gboolean
+_clutter_script_load_compiled_data (ClutterScript  *script,
+                                    const guint8   *data,
+                                    gsize           size,
+                                    GError        **error)
+{
+  ScriptBinaryHeader header;
+  ScriptReader reader;
+  gboolean res = TRUE;
+  guint i;
+
+  if (size < sizeof (header))
+    goto invalid;
+
+  memcpy (&header, data, sizeof (header));
+
+  if (memcmp (header.magic, SCRIPT_BINARY_MAGIC, sizeof (header.magic)) != 0 ||
+      header.byte_order != SCRIPT_BINARY_BYTE_ORDER ||
+      header.version != SCRIPT_BINARY_VERSION)
+    goto invalid;
+
+  if (header.strings_offset < sizeof (header) ||
+      header.strings_offset > size ||
+      header.strings_size > size - header.strings_offset ||
+      header.objects_offset > size ||
+      header.objects_size > size - header.objects_offset ||
+      header.n_fake_ids > SCRIPT_BINARY_FAKE_ID)
+    goto invalid;
+
+  /* every string must be terminated inside the table */
+  if (header.strings_size > 0 &&
+      data[header.strings_offset + header.strings_size - 1] != '\0')
+    goto invalid;
+
+  reader.script = script;
+  reader.data = data + header.objects_offset;
+  reader.size = header.objects_size;
+  reader.cursor = 0;
+  reader.strings = (const gchar *) data + header.strings_offset;
+  reader.strings_size = header.strings_size;
+  reader.n_fake_ids = header.n_fake_ids;
+  reader.fake_ids = g_new (gchar *, header.n_fake_ids + 1);
+
+  for (i = 0; i < header.n_fake_ids; i++)
+    reader.fake_ids[i] = _clutter_script_generate_fake_id (script);
+
+  reader.fake_ids[i] = NULL;
+
+  for (i = 0; i < header.n_objects; i++)
+    {
+      if (!reader_read_object (&reader))
+        {
+          res = FALSE;
+          break;
+        }
+    }
+
+  g_strfreev (reader.fake_ids);
+
+  if (!res)
+    goto invalid;
+
+  if (!_clutter_script_is_lazy (script))
+    clutter_script_ensure_objects (script);
+
+  return TRUE;
+
+invalid:
+  g_set_error_literal (error, CLUTTER_SCRIPT_ERROR,
+                       CLUTTER_SCRIPT_ERROR_INVALID_COMPILED_DATA,
+                       "Invalid or corrupt compiled UI definition");
+  return FALSE;
+}
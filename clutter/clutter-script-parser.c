@@ -65,22 +65,154 @@ clutter_script_parser_init (ClutterScriptParser *parser)
 {
 }
 
+/* the per-process caches of the resolved type names and of the
+ * property lookups; like the rest of ClutterScript, these are only
+ * meant to be used from the main thread
+ */
+static GHashTable *script_type_cache = NULL;
+static GHashTable *script_pspec_cache = NULL;
+
+static inline GType
+script_type_cache_lookup (const gchar *key)
+{
+  if (script_type_cache == NULL)
+    return G_TYPE_INVALID;
+
+  return (GType) g_hash_table_lookup (script_type_cache, key);
+}
+
+static inline void
+script_type_cache_insert (const gchar *key,
+                          GType        gtype)
+{
+  /* we only cache successful lookups: types can be registered at
+   * any point, for instance by loading a module
+   */
+  if (gtype == G_TYPE_INVALID)
+    return;
+
+  if (G_UNLIKELY (script_type_cache == NULL))
+    script_type_cache = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                               g_free,
+                                               NULL);
+
+  g_hash_table_insert (script_type_cache, g_strdup (key), (gpointer) gtype);
+}
+
+/*
+ * _clutter_script_lookup_type:
+ * @type_name: the name of a type
+ *
+ * Resolves @type_name using g_type_from_name() and, if that fails, by
+ * looking up the type function derived from the name; the result is
+ * cached, so that the symbol lookup happens once per type name
+ *
+ * Return value: the #GType for @type_name, or %G_TYPE_INVALID
+ */
+GType
+_clutter_script_lookup_type (const gchar *type_name)
+{
+  GType gtype;
+
+  gtype = script_type_cache_lookup (type_name);
+  if (gtype != G_TYPE_INVALID)
+    return gtype;
+
+  gtype = g_type_from_name (type_name);
+  if (gtype == G_TYPE_INVALID)
+    gtype = clutter_script_get_type_from_class (type_name);
+
+  script_type_cache_insert (type_name, gtype);
+
+  return gtype;
+}
+
 GType
 clutter_script_get_type_from_symbol (const gchar *symbol)
 {
   static GModule *module = NULL;
   GTypeGetFunc func;
   GType gtype = G_TYPE_INVALID;
+  gchar *key;
+
+  /* type functions and type names live in different namespaces */
+  key = g_strconcat ("()", symbol, NULL);
+  gtype = script_type_cache_lookup (key);
+  if (gtype != G_TYPE_INVALID)
+    {
+      g_free (key);
+      return gtype;
+    }
 
   if (!module)
     module = g_module_open (NULL, 0);
   
   if (g_module_symbol (module, symbol, (gpointer)&func))
     gtype = func ();
-  
+
+  script_type_cache_insert (key, gtype);
+  g_free (key);
+
   return gtype;
 }
 
+/*
+ * _clutter_script_find_property:
+ * @gtype: a #GObject type
+ * @name: the name of a property
+ *
+ * Looks up the property @name of the class for @gtype. Both found and
+ * missing properties are cached per type, since UI definitions set the
+ * same properties, and the same custom properties, over and over.
+ *
+ * Return value: (transfer none): the #GParamSpec of the property,
+ *   or %NULL if the class does not have a property called @name
+ */
+GParamSpec *
+_clutter_script_find_property (GType        gtype,
+                               const gchar *name)
+{
+  GHashTable *pspecs;
+  GParamSpec *pspec;
+  gpointer value;
+
+  if (G_UNLIKELY (script_pspec_cache == NULL))
+    script_pspec_cache =
+      g_hash_table_new_full (NULL, NULL,
+                             NULL,
+                             (GDestroyNotify) g_hash_table_destroy);
+
+  pspecs = g_hash_table_lookup (script_pspec_cache, (gpointer) gtype);
+  if (pspecs == NULL)
+    {
+      pspecs = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                      g_free,
+                                      NULL);
+      g_hash_table_insert (script_pspec_cache, (gpointer) gtype, pspecs);
+    }
+
+  if (g_hash_table_lookup_extended (pspecs, name, NULL, &value))
+    return value;
+
+  if (g_type_is_a (gtype, G_TYPE_OBJECT))
+    {
+      GObjectClass *klass = g_type_class_ref (gtype);
+
+      pspec = g_object_class_find_property (klass, name);
+
+      g_type_class_unref (klass);
+    }
+  else
+    pspec = NULL;
+
+  /* the pool owns the GParamSpec for as long as the type exists,
+   * and static types never go away
+   */
+  g_hash_table_insert (pspecs, g_strdup (name), pspec);
+
+  return pspec;
+}
+
 GType
 clutter_script_get_type_from_class (const gchar *name)
 {
@@ -1038,13 +1170,374 @@ clutter_script_parser_object_end (JsonParser *json_parser,
                 g_list_length (oinfo->signals));
 
   _clutter_script_add_object_info (script, oinfo);
-  _clutter_script_construct_object (script, oinfo);
+
+  if (!_clutter_script_is_lazy (script))
+    _clutter_script_construct_object (script, oinfo);
 }
 
 static void
 clutter_script_parser_parse_end (JsonParser *parser)
 {
-  clutter_script_ensure_objects (CLUTTER_SCRIPT_PARSER (parser)->script);
+  ClutterScriptParser *script_parser = CLUTTER_SCRIPT_PARSER (parser);
+  ClutterScript *script = script_parser->script;
+
+  /* when streaming, the objects are ensured once the whole
+   * file has been read
+   */
+  if (script_parser->is_streaming)
+    return;
+
+  if (!_clutter_script_is_lazy (script))
+    clutter_script_ensure_objects (script);
+}
+
+/* The streaming loader splits a top-level array of definitions into
+ * its elements while reading the file, and parses each element on its
+ * own as soon as it is complete. The JsonNode tree of an element is
+ * released when the next one is parsed, so the peak memory only
+ * includes the largest element instead of the whole document, and the
+ * objects of the first elements are constructed while the rest of the
+ * file is still being read. Any other document is parsed in one go.
+ */
+typedef enum {
+  STREAM_BEFORE_ROOT,
+  STREAM_BEFORE_ELEMENT,
+  STREAM_IN_ELEMENT,
+  STREAM_AFTER_ELEMENT,
+  STREAM_AFTER_ROOT,
+  STREAM_DOCUMENT
+} StreamState;
+
+typedef struct {
+  ClutterScriptParser *parser;
+
+  StreamState state;
+
+  GString *element;
+  gint depth;
+
+  guint allow_close      : 1;
+  guint is_container     : 1;
+  guint in_string        : 1;
+  guint in_escape        : 1;
+  guint in_line_comment  : 1;
+  guint in_block_comment : 1;
+  guint after_slash      : 1;
+  guint after_star       : 1;
+} ScriptStream;
+
+#define STREAM_CHUNK_SIZE       (16 * 1024)
+
+static gboolean
+script_stream_set_error (GError **error,
+                         gchar    c)
+{
+  if (c == '\0')
+    g_set_error_literal (error, JSON_PARSER_ERROR,
+                         JSON_PARSER_ERROR_PARSE,
+                         "Unexpected end of the UI definition");
+  else
+    g_set_error (error, JSON_PARSER_ERROR,
+                 JSON_PARSER_ERROR_PARSE,
+                 "Unexpected character '%c' in the UI definition",
+                 c);
+
+  return FALSE;
+}
+
+static gboolean
+script_stream_flush_element (ScriptStream  *stream,
+                             GError       **error)
+{
+  gboolean res = TRUE;
+
+  /* scalar values inside the top-level array do not define
+   * any object, so there is no point in parsing them
+   */
+  if (stream->is_container)
+    res = json_parser_load_from_data (JSON_PARSER (stream->parser),
+                                      stream->element->str,
+                                      stream->element->len,
+                                      error);
+
+  g_string_truncate (stream->element, 0);
+
+  return res;
+}
+
+/* returns TRUE if @c is part of a comment, and thus not significant */
+static gboolean
+script_stream_skip_comment (ScriptStream *stream,
+                            gchar         c)
+{
+  if (stream->in_line_comment)
+    {
+      if (c == '\n')
+        stream->in_line_comment = FALSE;
+
+      return TRUE;
+    }
+
+  if (stream->in_block_comment)
+    {
+      if (stream->after_star && c == '/')
+        stream->in_block_comment = FALSE;
+
+      stream->after_star = (c == '*');
+
+      return TRUE;
+    }
+
+  if (stream->after_slash)
+    {
+      stream->after_slash = FALSE;
+
+      if (c == '/')
+        {
+          stream->in_line_comment = TRUE;
+          return TRUE;
+        }
+
+      if (c == '*')
+        {
+          stream->in_block_comment = TRUE;
+          stream->after_star = FALSE;
+          return TRUE;
+        }
+    }
+
+  if (c == '/')
+    {
+      stream->after_slash = TRUE;
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+script_stream_feed (ScriptStream  *stream,
+                    const gchar   *data,
+                    gsize          len,
+                    GError       **error)
+{
+  gsize i;
+
+  for (i = 0; i < len; i++)
+    {
+      gchar c = data[i];
+
+      if (stream->state == STREAM_DOCUMENT)
+        {
+          g_string_append_len (stream->element, data + i, len - i);
+          return TRUE;
+        }
+
+      if (stream->state == STREAM_IN_ELEMENT)
+        {
+          if (stream->in_string)
+            {
+              if (stream->in_escape)
+                stream->in_escape = FALSE;
+              else if (c == '\\')
+                stream->in_escape = TRUE;
+              else if (c == '"')
+                stream->in_string = FALSE;
+
+              g_string_append_c (stream->element, c);
+              continue;
+            }
+
+          if (script_stream_skip_comment (stream, c))
+            {
+              g_string_append_c (stream->element, c);
+              continue;
+            }
+
+          if (stream->depth == 0 && (c == ',' || c == ']'))
+            {
+              if (!script_stream_flush_element (stream, error))
+                return FALSE;
+
+              stream->allow_close = FALSE;
+              stream->state = c == ',' ? STREAM_BEFORE_ELEMENT
+                                       : STREAM_AFTER_ROOT;
+              continue;
+            }
+
+          g_string_append_c (stream->element, c);
+
+          if (c == '"')
+            stream->in_string = TRUE;
+          else if (c == '{' || c == '[')
+            stream->depth += 1;
+          else if (c == '}' || c == ']')
+            {
+              stream->depth -= 1;
+
+              if (stream->depth < 0)
+                return script_stream_set_error (error, c);
+
+              if (stream->depth == 0)
+                {
+                  if (!script_stream_flush_element (stream, error))
+                    return FALSE;
+
+                  stream->state = STREAM_AFTER_ELEMENT;
+                }
+            }
+
+          continue;
+        }
+
+      if (script_stream_skip_comment (stream, c) || g_ascii_isspace (c))
+        continue;
+
+      switch (stream->state)
+        {
+        case STREAM_BEFORE_ROOT:
+          if (c == '[')
+            {
+              stream->state = STREAM_BEFORE_ELEMENT;
+              stream->allow_close = TRUE;
+            }
+          else
+            {
+              stream->state = STREAM_DOCUMENT;
+              g_string_append_len (stream->element, data + i, len - i);
+              return TRUE;
+            }
+          break;
+
+        case STREAM_BEFORE_ELEMENT:
+          if (c == ']' && stream->allow_close)
+            stream->state = STREAM_AFTER_ROOT;
+          else if (c == ',' || c == ']')
+            return script_stream_set_error (error, c);
+          else
+            {
+              stream->state = STREAM_IN_ELEMENT;
+              stream->is_container = (c == '{' || c == '[');
+              stream->depth = stream->is_container ? 1 : 0;
+              stream->in_string = (c == '"');
+
+              g_string_append_c (stream->element, c);
+            }
+          break;
+
+        case STREAM_AFTER_ELEMENT:
+          if (c == ',')
+            {
+              stream->state = STREAM_BEFORE_ELEMENT;
+              stream->allow_close = FALSE;
+            }
+          else if (c == ']')
+            stream->state = STREAM_AFTER_ROOT;
+          else
+            return script_stream_set_error (error, c);
+          break;
+
+        case STREAM_AFTER_ROOT:
+          return script_stream_set_error (error, c);
+
+        default:
+          g_assert_not_reached ();
+        }
+    }
+
+  return TRUE;
+}
+
+/*
+ * _clutter_script_parser_load_from_file:
+ * @parser: a #ClutterScriptParser
+ * @filename: the path of a UI definition file
+ * @error: return location for a #GError, or %NULL
+ *
+ * Loads @filename into the #ClutterScript of @parser, parsing the
+ * top-level object definitions while the file is being read
+ *
+ * Return value: %TRUE on success
+ */
+gboolean
+_clutter_script_parser_load_from_file (ClutterScriptParser  *parser,
+                                       const gchar          *filename,
+                                       GError              **error)
+{
+  ScriptStream stream = { NULL, };
+  GIOChannel *channel;
+  GIOStatus status;
+  gchar *buffer;
+  gboolean res = TRUE;
+
+  channel = g_io_channel_new_file (filename, "r", error);
+  if (channel == NULL)
+    return FALSE;
+
+  /* the parser deals with the encoding */
+  g_io_channel_set_encoding (channel, NULL, NULL);
+
+  stream.parser = parser;
+  stream.state = STREAM_BEFORE_ROOT;
+  stream.element = g_string_sized_new (STREAM_CHUNK_SIZE);
+
+  buffer = g_malloc (STREAM_CHUNK_SIZE);
+
+  parser->is_streaming = TRUE;
+
+  do
+    {
+      gsize n_read = 0;
+
+      status = g_io_channel_read_chars (channel,
+                                        buffer, STREAM_CHUNK_SIZE,
+                                        &n_read,
+                                        error);
+      if (status == G_IO_STATUS_ERROR)
+        {
+          res = FALSE;
+          break;
+        }
+
+      if (n_read > 0 && !script_stream_feed (&stream, buffer, n_read, error))
+        {
+          res = FALSE;
+          break;
+        }
+    }
+  while (status != G_IO_STATUS_EOF);
+
+  if (res)
+    {
+      switch (stream.state)
+        {
+        case STREAM_AFTER_ROOT:
+          break;
+
+        case STREAM_BEFORE_ROOT:
+        case STREAM_DOCUMENT:
+          res = json_parser_load_from_data (JSON_PARSER (parser),
+                                            stream.element->str,
+                                            stream.element->len,
+                                            error);
+          break;
+
+        default:
+          res = script_stream_set_error (error, '\0');
+          break;
+        }
+    }
+
+  parser->is_streaming = FALSE;
+
+  if (res && !_clutter_script_is_lazy (parser->script))
+    clutter_script_ensure_objects (parser->script);
+
+  g_free (buffer);
+  g_string_free (stream.element, TRUE);
+  g_io_channel_unref (channel);
+
+  return res;
 }
 
 gboolean
@@ -1097,7 +1590,16 @@ clutter_script_parse_node (ClutterScript *script,
                 return FALSE;
 
               oinfo = _clutter_script_get_object_info (script, id_);
-              if (oinfo == NULL || oinfo->gtype == G_TYPE_INVALID )
+              if (oinfo == NULL)
+                return FALSE;
+
+              /* lazily constructed objects are realized only
+               * when something references them
+               */
+              if (_clutter_script_is_lazy (script))
+                _clutter_script_realize_object (script, oinfo);
+
+              if (oinfo->gtype == G_TYPE_INVALID)
                 return FALSE;
 
               if (g_type_is_a (oinfo->gtype, p_type))
@@ -1460,12 +1962,8 @@ clutter_script_construct_parameters (ClutterScript  *script,
                                      GList          *properties,
                                      GArray        **construct_params)
 {
-  GObjectClass *klass;
   GList *l, *unparsed;
 
-  klass = g_type_class_ref (gtype);
-  g_assert (klass != NULL);
-
   *construct_params = g_array_new (FALSE, FALSE, sizeof (GParameter));
 
   unparsed = NULL;
@@ -1481,7 +1979,7 @@ clutter_script_construct_parameters (ClutterScript  *script,
        * class we just skip it and let the class itself deal
        * with it later on
        */
-      pspec = g_object_class_find_property (klass, pinfo->name);
+      pspec = _clutter_script_find_property (gtype, pinfo->name);
       if (pspec)
         pinfo->pspec = g_param_spec_ref (pspec);
       else
@@ -1515,8 +2013,6 @@ clutter_script_construct_parameters (ClutterScript  *script,
 
   g_list_free (properties);
 
-  g_type_class_unref (klass);
-
   return unparsed;
 }
 
@@ -1744,7 +2240,11 @@ add_children (ClutterScript *script,
       child_info = _clutter_script_get_object_info (script, name);
       if (child_info != NULL)
         {
-          _clutter_script_construct_object (script, child_info);
+          if (_clutter_script_is_lazy (script))
+            _clutter_script_realize_object (script, child_info);
+          else
+            _clutter_script_construct_object (script, child_info);
+
           object = child_info->object;
         }
 
@@ -1771,6 +2271,13 @@ add_children (ClutterScript *script,
                     g_type_name (G_OBJECT_TYPE (container)));
 
       clutter_container_add_actor (container, CLUTTER_ACTOR (object));
+
+      /* the child and layout properties can only be applied now
+       * that the child has a parent; when constructing eagerly,
+       * clutter_script_ensure_objects() takes care of this
+       */
+      if (_clutter_script_is_lazy (script) && child_info->has_unresolved)
+        _clutter_script_apply_properties (script, child_info);
     }
 
   g_list_foreach (oinfo->children, (GFunc) g_free, NULL);
@@ -48,6 +48,8 @@ struct _ClutterScriptParser
 
   /* back reference */
   ClutterScript *script;
+
+  guint is_streaming : 1;
 };
 
 typedef GType (* GTypeGetFunc) (void);
@@ -71,6 +73,7 @@ typedef struct {
   guint is_stage_default : 1;
   guint has_unresolved   : 1;
   guint is_unmerged      : 1;
+  guint is_realizing     : 1;
 } ObjectInfo;
 
 void object_info_free (gpointer data);
@@ -96,6 +99,10 @@ void property_info_free (gpointer data);
 
 GType clutter_script_parser_get_type (void) G_GNUC_CONST;
 
+gboolean _clutter_script_parser_load_from_file (ClutterScriptParser  *parser,
+                                                const gchar          *filename,
+                                                GError              **error);
+
 gboolean clutter_script_parse_node        (ClutterScript *script,
                                            GValue        *value,
                                            const gchar   *name,
@@ -105,6 +112,10 @@ gboolean clutter_script_parse_node        (ClutterScript *script,
 GType    clutter_script_get_type_from_symbol (const gchar *symbol);
 GType    clutter_script_get_type_from_class  (const gchar *name);
 
+GType       _clutter_script_lookup_type   (const gchar *type_name);
+GParamSpec *_clutter_script_find_property (GType        gtype,
+                                           const gchar *name);
+
 gulong   clutter_script_resolve_animation_mode (JsonNode *node);
 
 gboolean clutter_script_enum_from_string  (GType          gtype,
@@ -130,6 +141,10 @@ void _clutter_script_construct_object (ClutterScript *script,
                                        ObjectInfo    *oinfo);
 void _clutter_script_apply_properties (ClutterScript *script,
                                        ObjectInfo    *oinfo);
+void _clutter_script_realize_object   (ClutterScript *script,
+                                       ObjectInfo    *oinfo);
+
+gboolean _clutter_script_is_lazy (ClutterScript *script);
 
 gchar *_clutter_script_generate_fake_id (ClutterScript *script);
 
@@ -152,6 +167,12 @@ void _clutter_script_add_object_info (ClutterScript *script,
 
 const gchar *_clutter_script_get_id_from_node (JsonNode *node);
 
+GByteArray *_clutter_script_compile_node       (JsonNode       *root);
+gboolean    _clutter_script_load_compiled_data (ClutterScript  *script,
+                                                const guint8   *data,
+                                                gsize           size,
+                                                GError        **error);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_SCRIPT_PRIVATE_H__ */
@@ -158,6 +158,12 @@
  * respectively) and the "object" string member for calling
  * g_signal_connect_object() instead of g_signal_connect().
  *
+ * The handlers are looked up by name in the symbol table of the
+ * application; the functions registered using clutter_script_add_callback()
+ * or clutter_script_add_callbacks() are found without looking at the
+ * symbol table, which avoids the cost of resolving each handler name
+ * when connecting the signals of large UI definitions.
+ *
  * Clutter reserves the following names, so classes defining properties
  * through the usual GObject registration process should avoid using these
  * names to avoid collisions:
@@ -204,6 +210,7 @@
 
 #include "clutter-enum-types.h"
 #include "clutter-private.h"
+#include "clutter-profile.h"
 #include "clutter-debug.h"
 
 enum
@@ -212,6 +219,7 @@ enum
 
   PROP_FILENAME_SET,
   PROP_FILENAME,
+  PROP_LAZY_CONSTRUCTION,
 
   PROP_LAST
 };
@@ -233,7 +241,19 @@ struct _ClutterScriptPrivate
   gchar **search_paths;
 
   gchar *filename;
+
+  /* the signal connection function used for the objects
+   * constructed lazily
+   */
+  ClutterScriptConnectFunc connect_func;
+  gpointer connect_data;
+  GDestroyNotify connect_notify;
+
+  /* the signal handlers registered by the application */
+  GHashTable *callbacks;
+
   guint is_filename : 1;
+  guint is_lazy     : 1;
 };
 
 G_DEFINE_TYPE (ClutterScript, clutter_script, G_TYPE_OBJECT);
@@ -242,13 +262,7 @@ static GType
 clutter_script_real_get_type_from_name (ClutterScript *script,
                                         const gchar   *type_name)
 {
-  GType gtype;
-
-  gtype = g_type_from_name (type_name);
-  if (gtype != G_TYPE_INVALID)
-    return gtype;
-
-  return clutter_script_get_type_from_class (type_name);
+  return _clutter_script_lookup_type (type_name);
 }
 
 void
@@ -337,9 +351,34 @@ clutter_script_finalize (GObject *gobject)
   g_strfreev (priv->search_paths);
   g_free (priv->filename);
 
+  if (priv->connect_notify != NULL)
+    priv->connect_notify (priv->connect_data);
+
+  if (priv->callbacks != NULL)
+    g_hash_table_destroy (priv->callbacks);
+
   G_OBJECT_CLASS (clutter_script_parent_class)->finalize (gobject);
 }
 
+static void
+clutter_script_set_property (GObject      *gobject,
+                             guint         prop_id,
+                             const GValue *value,
+                             GParamSpec   *pspec)
+{
+  ClutterScript *script = CLUTTER_SCRIPT (gobject);
+
+  switch (prop_id)
+    {
+    case PROP_LAZY_CONSTRUCTION:
+      clutter_script_set_lazy_construction (script, g_value_get_boolean (value));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
 static void
 clutter_script_get_property (GObject    *gobject,
                              guint       prop_id,
@@ -356,6 +395,9 @@ clutter_script_get_property (GObject    *gobject,
     case PROP_FILENAME:
       g_value_set_string (value, script->priv->filename);
       break;
+    case PROP_LAZY_CONSTRUCTION:
+      g_value_set_boolean (value, script->priv->is_lazy);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -402,6 +444,24 @@ clutter_script_class_init (ClutterScriptClass *klass)
                          NULL,
                          CLUTTER_PARAM_READABLE);
 
+  /**
+   * ClutterScript:lazy-construction:
+   *
+   * Whether the objects defined inside the loaded UI definitions
+   * should be constructed only when they are needed.
+   *
+   * See clutter_script_set_lazy_construction().
+   *
+   * Since: 1.8
+   */
+  obj_props[PROP_LAZY_CONSTRUCTION] =
+    g_param_spec_boolean ("lazy-construction",
+                          P_("Lazy Construction"),
+                          P_("Whether objects are constructed only when needed"),
+                          FALSE,
+                          CLUTTER_PARAM_READWRITE);
+
+  gobject_class->set_property = clutter_script_set_property;
   gobject_class->get_property = clutter_script_get_property;
   gobject_class->finalize = clutter_script_finalize;
 
@@ -482,9 +542,13 @@ clutter_script_load_from_file (ClutterScript  *script,
   priv->last_merge_id += 1;
 
   internal_error = NULL;
-  json_parser_load_from_file (JSON_PARSER (priv->parser),
-                              filename,
-                              &internal_error);
+
+  _clutter_startup_phase_begin (CLUTTER_STARTUP_SCRIPT_LOADING);
+  _clutter_script_parser_load_from_file (priv->parser,
+                                         filename,
+                                         &internal_error);
+  _clutter_startup_phase_end (CLUTTER_STARTUP_SCRIPT_LOADING);
+
   if (internal_error)
     {
       g_propagate_error (error, internal_error);
@@ -535,9 +599,13 @@ clutter_script_load_from_data (ClutterScript  *script,
   priv->last_merge_id += 1;
 
   internal_error = NULL;
+
+  _clutter_startup_phase_begin (CLUTTER_STARTUP_SCRIPT_LOADING);
   json_parser_load_from_data (JSON_PARSER (priv->parser),
                               data, length,
                               &internal_error);
+  _clutter_startup_phase_end (CLUTTER_STARTUP_SCRIPT_LOADING);
+
   if (internal_error)
     {
       g_propagate_error (error, internal_error);
@@ -548,6 +616,112 @@ clutter_script_load_from_data (ClutterScript  *script,
   return priv->last_merge_id;
 }
 
+/**
+ * clutter_script_compile_file:
+ * @filename: the full path to the definition file
+ * @output_filename: the full path of the compiled file to write
+ * @error: return location for a #GError, or %NULL
+ *
+ * Compiles the UI definitions inside @filename into a binary file
+ * that can be loaded with clutter_script_load_from_compiled_file().
+ *
+ * A compiled file stores the object definitions already extracted
+ * from the JSON data, so loading it skips the JSON parsing entirely.
+ * Compiled files are tied to the version of Clutter and to the byte
+ * order of the machine that created them.
+ *
+ * Return value: %TRUE if the compiled file was written, and %FALSE
+ *   otherwise
+ *
+ * Since: 1.8
+ */
+gboolean
+clutter_script_compile_file (const gchar  *filename,
+                             const gchar  *output_filename,
+                             GError      **error)
+{
+  JsonParser *parser;
+  GByteArray *data;
+  gboolean res;
+
+  g_return_val_if_fail (filename != NULL, FALSE);
+  g_return_val_if_fail (output_filename != NULL, FALSE);
+
+  parser = json_parser_new ();
+  if (!json_parser_load_from_file (parser, filename, error))
+    {
+      g_object_unref (parser);
+      return FALSE;
+    }
+
+  data = _clutter_script_compile_node (json_parser_get_root (parser));
+  res = g_file_set_contents (output_filename,
+                             (const gchar *) data->data, data->len,
+                             error);
+
+  g_byte_array_free (data, TRUE);
+  g_object_unref (parser);
+
+  return res;
+}
+
+/**
+ * clutter_script_load_from_compiled_file:
+ * @script: a #ClutterScript
+ * @filename: the full path to a file created by clutter_script_compile_file()
+ * @error: return location for a #GError, or %NULL
+ *
+ * Loads the compiled definitions from @filename into @script and merges
+ * with the currently loaded ones, if any. The file is mapped in memory
+ * instead of being read.
+ *
+ * Return value: on error, zero is returned and @error is set
+ *   accordingly. On success, the merge id for the UI definitions is
+ *   returned. You can use the merge id with clutter_script_unmerge_objects().
+ *
+ * Since: 1.8
+ */
+guint
+clutter_script_load_from_compiled_file (ClutterScript  *script,
+                                        const gchar    *filename,
+                                        GError        **error)
+{
+  ClutterScriptPrivate *priv;
+  GMappedFile *mapped;
+  gboolean res;
+
+  g_return_val_if_fail (CLUTTER_IS_SCRIPT (script), 0);
+  g_return_val_if_fail (filename != NULL, 0);
+
+  mapped = g_mapped_file_new (filename, FALSE, error);
+  if (mapped == NULL)
+    return 0;
+
+  priv = script->priv;
+
+  g_free (priv->filename);
+  priv->filename = g_strdup (filename);
+  priv->is_filename = TRUE;
+  priv->last_merge_id += 1;
+
+  _clutter_startup_phase_begin (CLUTTER_STARTUP_SCRIPT_LOADING);
+  res = _clutter_script_load_compiled_data (script,
+                                            (const guint8 *) g_mapped_file_get_contents (mapped),
+                                            g_mapped_file_get_length (mapped),
+                                            error);
+  _clutter_startup_phase_end (CLUTTER_STARTUP_SCRIPT_LOADING);
+
+  g_mapped_file_unref (mapped);
+
+  if (!res)
+    {
+      priv->last_merge_id -= 1;
+      return 0;
+    }
+
+  return priv->last_merge_id;
+}
+
 /**
  * clutter_script_get_object:
  * @script: a #ClutterScript
@@ -574,8 +748,7 @@ clutter_script_get_object (ClutterScript *script,
   if (!oinfo)
     return NULL;
 
-  _clutter_script_construct_object (script, oinfo);
-  _clutter_script_apply_properties (script, oinfo);
+  _clutter_script_realize_object (script, oinfo);
 
   return oinfo->object;
 }
@@ -712,7 +885,11 @@ clutter_script_unmerge_objects (ClutterScript *script,
   g_slist_foreach (data.ids, (GFunc) g_free, NULL);
   g_slist_free (data.ids);
 
-  clutter_script_ensure_objects (script);
+  /* lazily constructed objects will resolve their references
+   * when they are needed
+   */
+  if (!priv->is_lazy)
+    clutter_script_ensure_objects (script);
 }
 
 static void
@@ -723,6 +900,12 @@ construct_each_objects (gpointer key,
   ClutterScript *script = user_data;
   ObjectInfo *oinfo = value;
 
+  if (script->priv->is_lazy)
+    {
+      _clutter_script_realize_object (script, oinfo);
+      return;
+    }
+
   /* we have unfinished business */
   if (oinfo->has_unresolved)
     {
@@ -759,6 +942,61 @@ clutter_script_ensure_objects (ClutterScript *script)
   g_hash_table_foreach (priv->objects, construct_each_objects, script);
 }
 
+/**
+ * clutter_script_set_lazy_construction:
+ * @script: a #ClutterScript
+ * @lazy: whether objects should be constructed lazily
+ *
+ * Sets whether the objects defined inside the UI definitions loaded
+ * after this call should be constructed only when needed.
+ *
+ * When lazy construction is enabled, loading a UI definition only
+ * parses it. An object is constructed, together with its children,
+ * the first time it is retrieved using clutter_script_get_object() or
+ * it is referenced by another object being constructed; its signal
+ * handlers are connected at that point, if clutter_script_connect_signals()
+ * or clutter_script_connect_signals_full() have been called before.
+ *
+ * Since: 1.8
+ */
+void
+clutter_script_set_lazy_construction (ClutterScript *script,
+                                      gboolean       lazy)
+{
+  ClutterScriptPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_SCRIPT (script));
+
+  priv = script->priv;
+
+  lazy = !!lazy;
+  if (priv->is_lazy == lazy)
+    return;
+
+  priv->is_lazy = lazy;
+
+  g_object_notify_by_pspec (G_OBJECT (script),
+                            obj_props[PROP_LAZY_CONSTRUCTION]);
+}
+
+/**
+ * clutter_script_get_lazy_construction:
+ * @script: a #ClutterScript
+ *
+ * Retrieves whether @script constructs the objects lazily.
+ *
+ * Return value: %TRUE if the objects are constructed only when needed
+ *
+ * Since: 1.8
+ */
+gboolean
+clutter_script_get_lazy_construction (ClutterScript *script)
+{
+  g_return_val_if_fail (CLUTTER_IS_SCRIPT (script), FALSE);
+
+  return script->priv->is_lazy;
+}
+
 /**
  * clutter_script_get_type_from_name:
  * @script: a #ClutterScript
@@ -809,8 +1047,79 @@ clutter_get_script_id (GObject *gobject)
 typedef struct {
   GModule *module;
   gpointer data;
+
+  /* the module is only opened if a handler was not registered */
+  guint module_opened : 1;
 } ConnectData;
 
+/* the handlers found in the symbol table of the application; the
+ * symbols cannot go away, so they are cached for all the scripts */
+static GHashTable *module_callbacks = NULL;
+
+static void
+connect_data_free (gpointer data)
+{
+  ConnectData *cd = data;
+
+  if (cd->module != NULL)
+    g_module_close (cd->module);
+
+  g_free (cd);
+}
+
+static GCallback
+clutter_script_lookup_callback (ClutterScript *script,
+                                ConnectData   *data,
+                                const gchar   *name)
+{
+  ClutterScriptPrivate *priv = script->priv;
+  GCallback function;
+
+  if (priv->callbacks != NULL)
+    {
+      function = g_hash_table_lookup (priv->callbacks, name);
+      if (function != NULL)
+        return function;
+    }
+
+  if (module_callbacks != NULL)
+    {
+      function = g_hash_table_lookup (module_callbacks, name);
+      if (function != NULL)
+        return function;
+    }
+
+  if (!data->module_opened)
+    {
+      data->module_opened = TRUE;
+
+      if (!g_module_supported ())
+        {
+          g_critical ("clutter_script_connect_signals() requires a working "
+                      "GModule support from GLib, or the signal handlers "
+                      "to be registered using clutter_script_add_callbacks()");
+          return NULL;
+        }
+
+      data->module = g_module_open (NULL, 0);
+    }
+
+  if (data->module == NULL)
+    return NULL;
+
+  if (!g_module_symbol (data->module, name, (gpointer) &function))
+    return NULL;
+
+  if (G_UNLIKELY (module_callbacks == NULL))
+    module_callbacks = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                              g_free,
+                                              NULL);
+
+  g_hash_table_insert (module_callbacks, g_strdup (name), function);
+
+  return function;
+}
+
 /* default signal connection code */
 static void
 clutter_script_default_connect (ClutterScript *script,
@@ -824,10 +1133,8 @@ clutter_script_default_connect (ClutterScript *script,
   ConnectData *data = user_data;
   GCallback function;
 
-  if (!data->module)
-    return;
-
-  if (!g_module_symbol (data->module, signal_handler, (gpointer) &function))
+  function = clutter_script_lookup_callback (script, data, signal_handler);
+  if (function == NULL)
     {
       g_warning ("Could not find a signal handler '%s' for signal '%s::%s'",
                  signal_handler,
@@ -869,12 +1176,15 @@ clutter_script_default_connect (ClutterScript *script,
  * Connects all the signals defined into a UI definition file to their
  * handlers.
  *
- * This method invokes clutter_script_connect_signals_full() internally
- * and uses  #GModule's introspective features (by opening the current
- * module's scope) to look at the application's symbol table.
- * 
+ * This method invokes clutter_script_connect_signals_full() internally;
+ * the handlers registered using clutter_script_add_callbacks() are used
+ * directly, while the other ones are looked up in the application's
+ * symbol table using #GModule's introspective features (by opening the
+ * current module's scope).
+ *
  * Note that this function will not work if #GModule is not supported by
- * the platform Clutter is running on.
+ * the platform Clutter is running on, unless all the handlers have been
+ * registered using clutter_script_add_callbacks().
  *
  * Since: 0.6
  */
@@ -886,24 +1196,21 @@ clutter_script_connect_signals (ClutterScript *script,
 
   g_return_if_fail (CLUTTER_IS_SCRIPT (script));
 
-  if (!g_module_supported ())
-    {
-      g_critical ("clutter_script_connect_signals() requires a working "
-                  "GModule support from GLib");
-      return;
-    }
-
-  cd = g_new (ConnectData, 1);
-  cd->module = g_module_open (NULL, 0);
+  cd = g_new0 (ConnectData, 1);
   cd->data = user_data;
 
   clutter_script_connect_signals_full (script,
                                        clutter_script_default_connect,
                                        cd);
 
-  g_module_close (cd->module);
+  /* objects constructed lazily will need the module later on */
+  if (script->priv->is_lazy)
+    {
+      script->priv->connect_notify = connect_data_free;
+      return;
+    }
 
-  g_free (cd);
+  connect_data_free (cd);
 }
 
 typedef struct {
@@ -913,18 +1220,14 @@ typedef struct {
 } SignalConnectData;
 
 static void
-connect_each_object (gpointer key,
-                     gpointer value,
-                     gpointer data)
+connect_object_signals (ClutterScript            *script,
+                        ObjectInfo               *oinfo,
+                        ClutterScriptConnectFunc  func,
+                        gpointer                  user_data)
 {
-  SignalConnectData *connect_data = data;
-  ClutterScript *script = connect_data->script;
-  ObjectInfo *oinfo = value;
   GObject *object = oinfo->object;
   GList *unresolved, *l;
 
-  _clutter_script_construct_object (script, oinfo);
-
   unresolved = NULL;
   for (l = oinfo->signals; l != NULL; l = l->next)
     {
@@ -938,12 +1241,12 @@ connect_each_object (gpointer key,
         unresolved = g_list_prepend (unresolved, sinfo);
       else
         {
-          connect_data->func (script, object,
-                              sinfo->name,
-                              sinfo->handler,
-                              connect_object,
-                              sinfo->flags,
-                              connect_data->user_data);
+          func (script, object,
+                sinfo->name,
+                sinfo->handler,
+                connect_object,
+                sinfo->flags,
+                user_data);
 
           signal_info_free (sinfo);
         }
@@ -957,6 +1260,28 @@ connect_each_object (gpointer key,
   oinfo->signals = unresolved;
 }
 
+static void
+connect_each_object (gpointer key,
+                     gpointer value,
+                     gpointer data)
+{
+  SignalConnectData *connect_data = data;
+  ClutterScript *script = connect_data->script;
+  ObjectInfo *oinfo = value;
+
+  /* the objects that have not been constructed yet will be
+   * connected by _clutter_script_realize_object()
+   */
+  if (script->priv->is_lazy && oinfo->object == NULL)
+    return;
+
+  _clutter_script_construct_object (script, oinfo);
+
+  connect_object_signals (script, oinfo,
+                          connect_data->func,
+                          connect_data->user_data);
+}
+
 /**
  * clutter_script_connect_signals_full: (skip)
  * @script: a #ClutterScript
@@ -990,9 +1315,104 @@ clutter_script_connect_signals_full (ClutterScript            *script,
   data.func = func;
   data.user_data = user_data;
 
+  if (script->priv->is_lazy)
+    {
+      ClutterScriptPrivate *priv = script->priv;
+
+      if (priv->connect_notify != NULL)
+        priv->connect_notify (priv->connect_data);
+
+      priv->connect_func = func;
+      priv->connect_data = user_data;
+      priv->connect_notify = NULL;
+    }
+
   g_hash_table_foreach (script->priv->objects, connect_each_object, &data);
 }
 
+/**
+ * clutter_script_add_callback:
+ * @script: a #ClutterScript
+ * @name: the name of a signal handler
+ * @callback: the function to call
+ *
+ * Registers @callback as the signal handler named @name in the UI
+ * definitions loaded by @script.
+ *
+ * The handlers registered using this function are used by
+ * clutter_script_connect_signals() instead of looking up their name
+ * in the symbol table of the application.
+ *
+ * Since: 1.8
+ */
+void
+clutter_script_add_callback (ClutterScript *script,
+                             const gchar   *name,
+                             GCallback      callback)
+{
+  ClutterScriptPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_SCRIPT (script));
+  g_return_if_fail (name != NULL);
+  g_return_if_fail (callback != NULL);
+
+  priv = script->priv;
+
+  if (priv->callbacks == NULL)
+    priv->callbacks = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                             g_free,
+                                             NULL);
+
+  g_hash_table_replace (priv->callbacks, g_strdup (name), callback);
+}
+
+/**
+ * clutter_script_add_callbacks:
+ * @script: a #ClutterScript
+ * @callbacks: (array length=n_callbacks): an array of #ClutterScriptCallback
+ * @n_callbacks: the length of @callbacks, or -1 if @callbacks is
+ *   terminated by an entry with a %NULL name
+ *
+ * Registers a table of signal handlers for the UI definitions loaded
+ * by @script, as if clutter_script_add_callback() was called for each
+ * entry of @callbacks.
+ *
+ * For instance:
+ *
+ * |[
+ *   static const ClutterScriptCallback callbacks[] = {
+ *     { "on_button_press", G_CALLBACK (on_button_press) },
+ *     { "after_foo", G_CALLBACK (after_foo) },
+ *     { NULL, NULL }
+ *   };
+ *
+ *   clutter_script_add_callbacks (script, callbacks, -1);
+ *   clutter_script_connect_signals (script, user_data);
+ * ]|
+ *
+ * Since: 1.8
+ */
+void
+clutter_script_add_callbacks (ClutterScript               *script,
+                              const ClutterScriptCallback *callbacks,
+                              gint                         n_callbacks)
+{
+  gint i;
+
+  g_return_if_fail (CLUTTER_IS_SCRIPT (script));
+  g_return_if_fail (callbacks != NULL || n_callbacks == 0);
+
+  for (i = 0; n_callbacks < 0 || i < n_callbacks; i++)
+    {
+      if (n_callbacks < 0 && callbacks[i].name == NULL)
+        break;
+
+      clutter_script_add_callback (script,
+                                   callbacks[i].name,
+                                   callbacks[i].callback);
+    }
+}
+
 GQuark
 clutter_script_error_quark (void)
 {
@@ -1319,3 +1739,54 @@ _clutter_script_add_object_info (ClutterScript *script,
   g_hash_table_steal (priv->objects, oinfo->id);
   g_hash_table_insert (priv->objects, oinfo->id, oinfo);
 }
+
+/*
+ * _clutter_script_is_lazy:
+ * @script: a #ClutterScript
+ *
+ * Checks whether @script constructs its objects only when needed
+ *
+ * Return value: %TRUE if lazy construction is enabled
+ */
+gboolean
+_clutter_script_is_lazy (ClutterScript *script)
+{
+  return script->priv->is_lazy;
+}
+
+/*
+ * _clutter_script_realize_object:
+ * @script: a #ClutterScript
+ * @oinfo: a #ObjectInfo
+ *
+ * Constructs the object for @oinfo, if needed, and applies its
+ * properties. If @script is constructing its objects lazily, the
+ * children of the object are realized as well, and the signal
+ * handlers are connected if a connection function is available
+ */
+void
+_clutter_script_realize_object (ClutterScript *script,
+                                ObjectInfo    *oinfo)
+{
+  ClutterScriptPrivate *priv = script->priv;
+
+  /* guard against definitions referencing each other */
+  if (oinfo->is_realizing)
+    return;
+
+  oinfo->is_realizing = TRUE;
+
+  _clutter_script_construct_object (script, oinfo);
+
+  if (oinfo->object != NULL)
+    {
+      _clutter_script_apply_properties (script, oinfo);
+
+      if (priv->is_lazy && priv->connect_func != NULL && oinfo->signals)
+        connect_object_signals (script, oinfo,
+                                priv->connect_func,
+                                priv->connect_data);
+    }
+
+  oinfo->is_realizing = FALSE;
+}
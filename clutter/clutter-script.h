@@ -68,12 +68,31 @@ typedef void (* ClutterScriptConnectFunc) (ClutterScript *script,
                                            GConnectFlags  flags,
                                            gpointer       user_data);
 
+/**
+ * ClutterScriptCallback:
+ * @name: the name of the signal handler, as used in the UI definition
+ * @callback: the function to call
+ *
+ * An entry of the table of signal handlers registered using
+ * clutter_script_add_callbacks().
+ *
+ * Since: 1.8
+ */
+typedef struct _ClutterScriptCallback
+{
+  const gchar *name;
+  GCallback    callback;
+} ClutterScriptCallback;
+
 /**
  * ClutterScriptError:
  * @CLUTTER_SCRIPT_ERROR_INVALID_TYPE_FUNCTION: Type function not found
  *   or invalid
  * @CLUTTER_SCRIPT_ERROR_INVALID_PROPERTY: Property not found or invalid
  * @CLUTTER_SCRIPT_ERROR_INVALID_VALUE: Invalid value
+ * @CLUTTER_SCRIPT_ERROR_INVALID_COMPILED_DATA: The compiled UI definition
+ *   is corrupt, or was compiled by an incompatible version of Clutter.
+ *   This value has been added in Clutter 1.8
  *
  * #ClutterScript error enumeration.
  *
@@ -82,7 +101,8 @@ typedef void (* ClutterScriptConnectFunc) (ClutterScript *script,
 typedef enum {
   CLUTTER_SCRIPT_ERROR_INVALID_TYPE_FUNCTION,
   CLUTTER_SCRIPT_ERROR_INVALID_PROPERTY,
-  CLUTTER_SCRIPT_ERROR_INVALID_VALUE
+  CLUTTER_SCRIPT_ERROR_INVALID_VALUE,
+  CLUTTER_SCRIPT_ERROR_INVALID_COMPILED_DATA
 } ClutterScriptError;
 
 /**
@@ -153,6 +173,12 @@ guint          clutter_script_load_from_data       (ClutterScript  *script,
                                                     const gchar    *data,
                                                     gssize          length,
                                                     GError        **error);
+guint          clutter_script_load_from_compiled_file (ClutterScript  *script,
+                                                       const gchar    *filename,
+                                                       GError        **error);
+gboolean       clutter_script_compile_file         (const gchar    *filename,
+                                                    const gchar    *output_filename,
+                                                    GError        **error);
 
 GObject *      clutter_script_get_object           (ClutterScript  *script,
                                                     const gchar    *name);
@@ -165,6 +191,10 @@ void           clutter_script_unmerge_objects      (ClutterScript  *script,
                                                     guint           merge_id);
 void           clutter_script_ensure_objects       (ClutterScript  *script);
 
+void           clutter_script_set_lazy_construction (ClutterScript *script,
+                                                     gboolean       lazy);
+gboolean       clutter_script_get_lazy_construction (ClutterScript *script);
+
 GType          clutter_script_get_type_from_name   (ClutterScript  *script,
                                                     const gchar    *type_name);
 
@@ -176,6 +206,13 @@ void           clutter_script_connect_signals_full (ClutterScript  *script,
                                                     ClutterScriptConnectFunc func,
                                                     gpointer        user_data);
 
+void           clutter_script_add_callback         (ClutterScript               *script,
+                                                    const gchar                 *name,
+                                                    GCallback                    callback);
+void           clutter_script_add_callbacks        (ClutterScript               *script,
+                                                    const ClutterScriptCallback *callbacks,
+                                                    gint                         n_callbacks);
+
 void           clutter_script_add_search_paths     (ClutterScript       *script,
                                                     const gchar * const  paths[],
                                                     gsize                n_paths);
@@ -0,0 +1,945 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2011  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:clutter-scroll-view
+ * @short_description: A container scrolling its child
+ *
+ * #ClutterScrollView is a container that displays a portion of its only
+ * child, clipped to its own allocation. The child is allocated once at
+ * its preferred size, at least as big as the view, and scrolling only
+ * changes the paint-time translation of the child, see
+ * clutter_actor_set_translation(), so it never queues a relayout.
+ *
+ * Dragging the child with the pointer scrolls it; if the
+ * #ClutterScrollView:kinetic property is set, releasing the pointer
+ * while it is moving makes the scrolling continue and slowly decelerate,
+ * following the frames of the master clock.
+ *
+ * The portion of the child that is visible can be retrieved using
+ * clutter_scroll_view_get_visible_area(); a child displaying many items
+ * can use it, together with the notifications of the
+ * #ClutterScrollView:scroll-x and #ClutterScrollView:scroll-y
+ * properties, to only create and allocate the visible items.
+ *
+ * #ClutterScrollView is available since Clutter 1.8
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <math.h>
+
+#include "clutter-scroll-view.h"
+
+#include "clutter-container.h"
+#include "clutter-debug.h"
+#include "clutter-main.h"
+#include "clutter-private.h"
+#include "clutter-timeline.h"
+
+/* the time it takes for the kinetic scrolling to lose 63% of its
+ * velocity, in msecs */
+#define DECELERATION_TIME       325.0
+
+/* a release this long after the last motion does not fling the
+ * child, in msecs */
+#define MAX_FLING_DELAY         100
+
+/* velocities below this stop the kinetic scrolling, in pixels
+ * per msec */
+#define MIN_VELOCITY            0.01
+
+struct _ClutterScrollViewPrivate
+{
+  ClutterActor *child;
+
+  /* the point of the child displayed at the origin of the view */
+  gfloat scroll_x;
+  gfloat scroll_y;
+
+  /* the size of the last allocation of the view and of the child */
+  gfloat view_width;
+  gfloat view_height;
+  gfloat child_width;
+  gfloat child_height;
+
+  ClutterStage *stage;
+  gulong capture_id;
+
+  /* the latest position of the pointer while dragging */
+  gfloat last_x;
+  gfloat last_y;
+  guint32 last_time;
+
+  /* in pixels per msec */
+  gdouble velocity_x;
+  gdouble velocity_y;
+
+  ClutterTimeline *deceleration;
+
+  guint kinetic : 1;
+};
+
+enum
+{
+  PROP_0,
+
+  PROP_CHILD,
+  PROP_SCROLL_X,
+  PROP_SCROLL_Y,
+  PROP_KINETIC,
+
+  PROP_LAST
+};
+
+static GParamSpec *obj_props[PROP_LAST];
+
+static void clutter_container_iface_init (ClutterContainerIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (ClutterScrollView, clutter_scroll_view,
+                         CLUTTER_TYPE_ACTOR,
+                         G_IMPLEMENT_INTERFACE (CLUTTER_TYPE_CONTAINER,
+                                                clutter_container_iface_init));
+
+#define CLUTTER_SCROLL_VIEW_GET_PRIVATE(obj)    (G_TYPE_INSTANCE_GET_PRIVATE ((obj), CLUTTER_TYPE_SCROLL_VIEW, ClutterScrollViewPrivate))
+
+/* Scrolls to (@x, @y), clamped to the size of the child; returns
+ * whether the point had to be clamped */
+static gboolean
+clutter_scroll_view_set_scroll_point_internal (ClutterScrollView *view,
+                                               gfloat             x,
+                                               gfloat             y)
+{
+  ClutterScrollViewPrivate *priv = view->priv;
+  gfloat max_x, max_y;
+  gboolean clamped = FALSE;
+
+  max_x = MAX (priv->child_width - priv->view_width, 0);
+  max_y = MAX (priv->child_height - priv->view_height, 0);
+
+  if (x < 0 || x > max_x)
+    {
+      x = CLAMP (x, 0, max_x);
+      clamped = TRUE;
+    }
+
+  if (y < 0 || y > max_y)
+    {
+      y = CLAMP (y, 0, max_y);
+      clamped = TRUE;
+    }
+
+  if (priv->scroll_x == x && priv->scroll_y == y)
+    return clamped;
+
+  g_object_freeze_notify (G_OBJECT (view));
+
+  if (priv->scroll_x != x)
+    {
+      priv->scroll_x = x;
+      g_object_notify_by_pspec (G_OBJECT (view), obj_props[PROP_SCROLL_X]);
+    }
+
+  if (priv->scroll_y != y)
+    {
+      priv->scroll_y = y;
+      g_object_notify_by_pspec (G_OBJECT (view), obj_props[PROP_SCROLL_Y]);
+    }
+
+  /* the translation is aligned to the pixel grid, to keep the
+   * contents of the child sharp */
+  if (priv->child != NULL)
+    clutter_actor_set_translation (priv->child,
+                                   -floorf (priv->scroll_x + 0.5f),
+                                   -floorf (priv->scroll_y + 0.5f));
+
+  g_object_thaw_notify (G_OBJECT (view));
+
+  return clamped;
+}
+
+static void
+on_deceleration_frame (ClutterTimeline   *timeline,
+                       gint               elapsed,
+                       ClutterScrollView *view)
+{
+  ClutterScrollViewPrivate *priv = view->priv;
+  gdouble delta, decay;
+  gfloat x, y;
+
+  delta = clutter_timeline_get_delta (timeline);
+  decay = exp (-delta / DECELERATION_TIME);
+
+  /* the integral of the velocity over the frame */
+  x = priv->scroll_x
+    + priv->velocity_x * DECELERATION_TIME * (1.0 - decay);
+  y = priv->scroll_y
+    + priv->velocity_y * DECELERATION_TIME * (1.0 - decay);
+
+  priv->velocity_x *= decay;
+  priv->velocity_y *= decay;
+
+  if (clutter_scroll_view_set_scroll_point_internal (view, x, y))
+    {
+      /* stop on the edges of the child */
+      if (priv->scroll_x != x)
+        priv->velocity_x = 0;
+
+      if (priv->scroll_y != y)
+        priv->velocity_y = 0;
+    }
+
+  if (fabs (priv->velocity_x) < MIN_VELOCITY &&
+      fabs (priv->velocity_y) < MIN_VELOCITY)
+    clutter_scroll_view_stop (view);
+}
+
+static void
+clutter_scroll_view_start_deceleration (ClutterScrollView *view)
+{
+  ClutterScrollViewPrivate *priv = view->priv;
+
+  if (priv->deceleration == NULL)
+    {
+      priv->deceleration = clutter_timeline_new (1000);
+      clutter_timeline_set_loop (priv->deceleration, TRUE);
+      g_signal_connect (priv->deceleration, "new-frame",
+                        G_CALLBACK (on_deceleration_frame),
+                        view);
+    }
+
+  clutter_timeline_rewind (priv->deceleration);
+  clutter_timeline_start (priv->deceleration);
+}
+
+static void
+clutter_scroll_view_end_drag (ClutterScrollView *view)
+{
+  ClutterScrollViewPrivate *priv = view->priv;
+
+  if (priv->capture_id != 0)
+    {
+      g_signal_handler_disconnect (priv->stage, priv->capture_id);
+      priv->capture_id = 0;
+    }
+
+  priv->stage = NULL;
+}
+
+static gboolean
+on_captured_event (ClutterActor      *stage,
+                   ClutterEvent      *event,
+                   ClutterScrollView *view)
+{
+  ClutterScrollViewPrivate *priv = view->priv;
+  gfloat x, y, dx, dy;
+  guint32 time_, dt;
+
+  switch (clutter_event_type (event))
+    {
+    case CLUTTER_MOTION:
+      clutter_event_get_coords (event, &x, &y);
+      time_ = clutter_event_get_time (event);
+
+      dx = x - priv->last_x;
+      dy = y - priv->last_y;
+      dt = time_ - priv->last_time;
+
+      clutter_scroll_view_set_scroll_point_internal (view,
+                                                     priv->scroll_x - dx,
+                                                     priv->scroll_y - dy);
+
+      /* smooth the velocity over the last few events */
+      if (dt > 0)
+        {
+          priv->velocity_x = 0.8 * (-dx / dt) + 0.2 * priv->velocity_x;
+          priv->velocity_y = 0.8 * (-dy / dt) + 0.2 * priv->velocity_y;
+        }
+
+      priv->last_x = x;
+      priv->last_y = y;
+      priv->last_time = time_;
+
+      return TRUE;
+
+    case CLUTTER_BUTTON_RELEASE:
+      clutter_scroll_view_end_drag (view);
+
+      if (priv->kinetic &&
+          clutter_event_get_time (event) - priv->last_time <= MAX_FLING_DELAY &&
+          (fabs (priv->velocity_x) >= MIN_VELOCITY ||
+           fabs (priv->velocity_y) >= MIN_VELOCITY))
+        clutter_scroll_view_start_deceleration (view);
+
+      return TRUE;
+
+    case CLUTTER_ENTER:
+    case CLUTTER_LEAVE:
+      return TRUE;
+
+    default:
+      break;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+clutter_scroll_view_button_press (ClutterActor       *actor,
+                                  ClutterButtonEvent *event)
+{
+  ClutterScrollView *view = CLUTTER_SCROLL_VIEW (actor);
+  ClutterScrollViewPrivate *priv = view->priv;
+
+  if (event->button != 1 || priv->capture_id != 0)
+    return FALSE;
+
+  clutter_scroll_view_stop (view);
+
+  priv->stage = CLUTTER_STAGE (clutter_actor_get_stage (actor));
+  if (priv->stage == NULL)
+    return FALSE;
+
+  priv->last_x = event->x;
+  priv->last_y = event->y;
+  priv->last_time = event->time;
+  priv->velocity_x = priv->velocity_y = 0;
+
+  priv->capture_id = g_signal_connect_after (priv->stage, "captured-event",
+                                             G_CALLBACK (on_captured_event),
+                                             view);
+
+  return TRUE;
+}
+
+static void
+clutter_scroll_view_get_preferred_width (ClutterActor *actor,
+                                         gfloat        for_height,
+                                         gfloat       *min_width_p,
+                                         gfloat       *natural_width_p)
+{
+  ClutterScrollViewPrivate *priv = CLUTTER_SCROLL_VIEW (actor)->priv;
+  gfloat natural_width = 0;
+
+  if (priv->child != NULL)
+    clutter_actor_get_preferred_width (priv->child, -1, NULL, &natural_width);
+
+  /* the view can be as small as needed */
+  if (min_width_p)
+    *min_width_p = 0;
+
+  if (natural_width_p)
+    *natural_width_p = natural_width;
+}
+
+static void
+clutter_scroll_view_get_preferred_height (ClutterActor *actor,
+                                          gfloat        for_width,
+                                          gfloat       *min_height_p,
+                                          gfloat       *natural_height_p)
+{
+  ClutterScrollViewPrivate *priv = CLUTTER_SCROLL_VIEW (actor)->priv;
+  gfloat natural_height = 0;
+
+  if (priv->child != NULL)
+    clutter_actor_get_preferred_height (priv->child, for_width,
+                                        NULL,
+                                        &natural_height);
+
+  if (min_height_p)
+    *min_height_p = 0;
+
+  if (natural_height_p)
+    *natural_height_p = natural_height;
+}
+
+static void
+clutter_scroll_view_allocate (ClutterActor           *actor,
+                              const ClutterActorBox  *box,
+                              ClutterAllocationFlags  flags)
+{
+  ClutterScrollView *view = CLUTTER_SCROLL_VIEW (actor);
+  ClutterScrollViewPrivate *priv = view->priv;
+
+  CLUTTER_ACTOR_CLASS (clutter_scroll_view_parent_class)->allocate (actor,
+                                                                    box,
+                                                                    flags);
+
+  clutter_actor_box_get_size (box, &priv->view_width, &priv->view_height);
+
+  if (priv->child != NULL)
+    {
+      ClutterActorBox child_box;
+      gfloat natural_width, natural_height;
+
+      /* the child fills at least the view */
+      clutter_actor_get_preferred_width (priv->child, -1,
+                                         NULL,
+                                         &natural_width);
+      priv->child_width = MAX (natural_width, priv->view_width);
+
+      clutter_actor_get_preferred_height (priv->child, priv->child_width,
+                                          NULL,
+                                          &natural_height);
+      priv->child_height = MAX (natural_height, priv->view_height);
+
+      child_box.x1 = 0;
+      child_box.y1 = 0;
+      child_box.x2 = priv->child_width;
+      child_box.y2 = priv->child_height;
+
+      clutter_actor_allocate (priv->child, &child_box, flags);
+    }
+  else
+    priv->child_width = priv->child_height = 0;
+
+  /* the scroll point might be out of the new bounds */
+  clutter_scroll_view_set_scroll_point_internal (view,
+                                                 priv->scroll_x,
+                                                 priv->scroll_y);
+}
+
+static void
+clutter_scroll_view_paint (ClutterActor *actor)
+{
+  ClutterScrollViewPrivate *priv = CLUTTER_SCROLL_VIEW (actor)->priv;
+
+  if (priv->child != NULL)
+    clutter_actor_paint (priv->child);
+}
+
+static void
+clutter_scroll_view_pick (ClutterActor       *actor,
+                          const ClutterColor *color)
+{
+  /* paint our pick */
+  CLUTTER_ACTOR_CLASS (clutter_scroll_view_parent_class)->pick (actor, color);
+
+  clutter_scroll_view_paint (actor);
+}
+
+static gboolean
+clutter_scroll_view_get_paint_volume (ClutterActor       *actor,
+                                      ClutterPaintVolume *volume)
+{
+  /* the child is clipped to the allocation */
+  return clutter_paint_volume_set_from_allocation (volume, actor);
+}
+
+static void
+clutter_scroll_view_destroy (ClutterActor *actor)
+{
+  ClutterScrollViewPrivate *priv = CLUTTER_SCROLL_VIEW (actor)->priv;
+
+  if (priv->child != NULL)
+    clutter_actor_destroy (priv->child);
+
+  if (CLUTTER_ACTOR_CLASS (clutter_scroll_view_parent_class)->destroy)
+    CLUTTER_ACTOR_CLASS (clutter_scroll_view_parent_class)->destroy (actor);
+}
+
+static void
+clutter_scroll_view_dispose (GObject *gobject)
+{
+  ClutterScrollView *view = CLUTTER_SCROLL_VIEW (gobject);
+  ClutterScrollViewPrivate *priv = view->priv;
+
+  clutter_scroll_view_end_drag (view);
+
+  if (priv->deceleration != NULL)
+    {
+      clutter_timeline_stop (priv->deceleration);
+      g_object_unref (priv->deceleration);
+      priv->deceleration = NULL;
+    }
+
+  G_OBJECT_CLASS (clutter_scroll_view_parent_class)->dispose (gobject);
+}
+
+static void
+clutter_scroll_view_set_property (GObject      *gobject,
+                                  guint         prop_id,
+                                  const GValue *value,
+                                  GParamSpec   *pspec)
+{
+  ClutterScrollView *view = CLUTTER_SCROLL_VIEW (gobject);
+  ClutterScrollViewPrivate *priv = view->priv;
+
+  switch (prop_id)
+    {
+    case PROP_CHILD:
+      clutter_scroll_view_set_child (view, g_value_get_object (value));
+      break;
+
+    case PROP_SCROLL_X:
+      clutter_scroll_view_scroll_to_point (view,
+                                           g_value_get_float (value),
+                                           priv->scroll_y);
+      break;
+
+    case PROP_SCROLL_Y:
+      clutter_scroll_view_scroll_to_point (view,
+                                           priv->scroll_x,
+                                           g_value_get_float (value));
+      break;
+
+    case PROP_KINETIC:
+      clutter_scroll_view_set_kinetic (view, g_value_get_boolean (value));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+clutter_scroll_view_get_property (GObject    *gobject,
+                                  guint       prop_id,
+                                  GValue     *value,
+                                  GParamSpec *pspec)
+{
+  ClutterScrollViewPrivate *priv = CLUTTER_SCROLL_VIEW (gobject)->priv;
+
+  switch (prop_id)
+    {
+    case PROP_CHILD:
+      g_value_set_object (value, priv->child);
+      break;
+
+    case PROP_SCROLL_X:
+      g_value_set_float (value, priv->scroll_x);
+      break;
+
+    case PROP_SCROLL_Y:
+      g_value_set_float (value, priv->scroll_y);
+      break;
+
+    case PROP_KINETIC:
+      g_value_set_boolean (value, priv->kinetic);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+clutter_scroll_view_real_add (ClutterContainer *container,
+                              ClutterActor     *actor)
+{
+  ClutterScrollView *view = CLUTTER_SCROLL_VIEW (container);
+
+  if (view->priv->child != NULL)
+    {
+      g_warning ("Attempting to add actor of type '%s' to a "
+                 "ClutterScrollView that already contains an "
+                 "actor of type '%s'",
+                 G_OBJECT_TYPE_NAME (actor),
+                 G_OBJECT_TYPE_NAME (view->priv->child));
+      return;
+    }
+
+  clutter_scroll_view_set_child (view, actor);
+}
+
+static void
+clutter_scroll_view_real_remove (ClutterContainer *container,
+                                 ClutterActor     *actor)
+{
+  ClutterScrollView *view = CLUTTER_SCROLL_VIEW (container);
+
+  if (view->priv->child == actor)
+    clutter_scroll_view_set_child (view, NULL);
+}
+
+static void
+clutter_scroll_view_real_foreach (ClutterContainer *container,
+                                  ClutterCallback   callback,
+                                  gpointer          user_data)
+{
+  ClutterScrollViewPrivate *priv = CLUTTER_SCROLL_VIEW (container)->priv;
+
+  if (priv->child != NULL)
+    callback (priv->child, user_data);
+}
+
+static ClutterActor *const *
+clutter_scroll_view_real_peek_children (ClutterContainer *container,
+                                        guint            *n_children)
+{
+  ClutterScrollViewPrivate *priv = CLUTTER_SCROLL_VIEW (container)->priv;
+
+  *n_children = priv->child != NULL ? 1 : 0;
+
+  return &priv->child;
+}
+
+static void
+clutter_container_iface_init (ClutterContainerIface *iface)
+{
+  iface->add = clutter_scroll_view_real_add;
+  iface->remove = clutter_scroll_view_real_remove;
+  iface->foreach = clutter_scroll_view_real_foreach;
+  iface->peek_children = clutter_scroll_view_real_peek_children;
+}
+
+static void
+clutter_scroll_view_class_init (ClutterScrollViewClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
+  GParamSpec *pspec;
+
+  g_type_class_add_private (klass, sizeof (ClutterScrollViewPrivate));
+
+  actor_class->get_preferred_width = clutter_scroll_view_get_preferred_width;
+  actor_class->get_preferred_height = clutter_scroll_view_get_preferred_height;
+  actor_class->allocate = clutter_scroll_view_allocate;
+  actor_class->paint = clutter_scroll_view_paint;
+  actor_class->pick = clutter_scroll_view_pick;
+  actor_class->get_paint_volume = clutter_scroll_view_get_paint_volume;
+  actor_class->destroy = clutter_scroll_view_destroy;
+  actor_class->button_press_event = clutter_scroll_view_button_press;
+
+  gobject_class->set_property = clutter_scroll_view_set_property;
+  gobject_class->get_property = clutter_scroll_view_get_property;
+  gobject_class->dispose = clutter_scroll_view_dispose;
+
+  /**
+   * ClutterScrollView:child:
+   *
+   * The #ClutterActor scrolled by the #ClutterScrollView
+   *
+   * Since: 1.8
+   */
+  pspec = g_param_spec_object ("child",
+                               P_("Child"),
+                               P_("The actor scrolled by the view"),
+                               CLUTTER_TYPE_ACTOR,
+                               CLUTTER_PARAM_READWRITE);
+  obj_props[PROP_CHILD] = pspec;
+  g_object_class_install_property (gobject_class, PROP_CHILD, pspec);
+
+  /**
+   * ClutterScrollView:scroll-x:
+   *
+   * The horizontal coordinate of the point of the child displayed
+   * at the origin of the view, in pixels
+   *
+   * Since: 1.8
+   */
+  pspec = g_param_spec_float ("scroll-x",
+                              P_("Scroll X"),
+                              P_("The horizontal scroll position"),
+                              0.0, G_MAXFLOAT,
+                              0.0,
+                              CLUTTER_PARAM_READWRITE);
+  obj_props[PROP_SCROLL_X] = pspec;
+  g_object_class_install_property (gobject_class, PROP_SCROLL_X, pspec);
+
+  /**
+   * ClutterScrollView:scroll-y:
+   *
+   * The vertical coordinate of the point of the child displayed
+   * at the origin of the view, in pixels
+   *
+   * Since: 1.8
+   */
+  pspec = g_param_spec_float ("scroll-y",
+                              P_("Scroll Y"),
+                              P_("The vertical scroll position"),
+                              0.0, G_MAXFLOAT,
+                              0.0,
+                              CLUTTER_PARAM_READWRITE);
+  obj_props[PROP_SCROLL_Y] = pspec;
+  g_object_class_install_property (gobject_class, PROP_SCROLL_Y, pspec);
+
+  /**
+   * ClutterScrollView:kinetic:
+   *
+   * Whether the scrolling should continue, and decelerate, after the
+   * pointer is released while dragging the child
+   *
+   * Since: 1.8
+   */
+  pspec = g_param_spec_boolean ("kinetic",
+                                P_("Kinetic"),
+                                P_("Whether the scrolling is kinetic"),
+                                TRUE,
+                                CLUTTER_PARAM_READWRITE);
+  obj_props[PROP_KINETIC] = pspec;
+  g_object_class_install_property (gobject_class, PROP_KINETIC, pspec);
+}
+
+static void
+clutter_scroll_view_init (ClutterScrollView *self)
+{
+  ClutterScrollViewPrivate *priv;
+
+  self->priv = priv = CLUTTER_SCROLL_VIEW_GET_PRIVATE (self);
+
+  priv->kinetic = TRUE;
+
+  clutter_actor_set_reactive (CLUTTER_ACTOR (self), TRUE);
+  clutter_actor_set_clip_to_allocation (CLUTTER_ACTOR (self), TRUE);
+}
+
+/**
+ * clutter_scroll_view_new:
+ *
+ * Creates a new #ClutterScrollView
+ *
+ * Return value: the newly created #ClutterScrollView
+ *
+ * Since: 1.8
+ */
+ClutterActor *
+clutter_scroll_view_new (void)
+{
+  return g_object_new (CLUTTER_TYPE_SCROLL_VIEW, NULL);
+}
+
+/**
+ * clutter_scroll_view_set_child:
+ * @view: a #ClutterScrollView
+ * @child: (allow-none): a #ClutterActor, or %NULL
+ *
+ * Sets @child as the actor scrolled by @view, replacing the current
+ * one, if any
+ *
+ * Since: 1.8
+ */
+void
+clutter_scroll_view_set_child (ClutterScrollView *view,
+                               ClutterActor      *child)
+{
+  ClutterScrollViewPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_SCROLL_VIEW (view));
+  g_return_if_fail (child == NULL || CLUTTER_IS_ACTOR (child));
+
+  priv = view->priv;
+
+  if (priv->child == child)
+    return;
+
+  if (priv->child != NULL)
+    {
+      ClutterActor *old_child = g_object_ref (priv->child);
+
+      priv->child = NULL;
+
+      clutter_actor_set_translation (old_child, 0, 0);
+      clutter_actor_unparent (old_child);
+
+      g_signal_emit_by_name (view, "actor-removed", old_child);
+
+      g_object_unref (old_child);
+    }
+
+  if (child != NULL)
+    {
+      priv->child = child;
+
+      clutter_actor_set_parent (child, CLUTTER_ACTOR (view));
+      clutter_actor_set_translation (child,
+                                     -floorf (priv->scroll_x + 0.5f),
+                                     -floorf (priv->scroll_y + 0.5f));
+
+      g_signal_emit_by_name (view, "actor-added", child);
+    }
+
+  clutter_actor_queue_relayout (CLUTTER_ACTOR (view));
+
+  g_object_notify_by_pspec (G_OBJECT (view), obj_props[PROP_CHILD]);
+}
+
+/**
+ * clutter_scroll_view_get_child:
+ * @view: a #ClutterScrollView
+ *
+ * Retrieves the actor scrolled by @view
+ *
+ * Return value: (transfer none): the child of @view, or %NULL
+ *
+ * Since: 1.8
+ */
+ClutterActor *
+clutter_scroll_view_get_child (ClutterScrollView *view)
+{
+  g_return_val_if_fail (CLUTTER_IS_SCROLL_VIEW (view), NULL);
+
+  return view->priv->child;
+}
+
+/**
+ * clutter_scroll_view_scroll_to_point:
+ * @view: a #ClutterScrollView
+ * @x: the X coordinate, in pixels
+ * @y: the Y coordinate, in pixels
+ *
+ * Scrolls the child of @view so that the point at the given coordinates,
+ * relative to the child, is displayed at the origin of @view. The point
+ * is clamped so that the child always covers @view.
+ *
+ * Any kinetic scrolling in progress is stopped.
+ *
+ * Since: 1.8
+ */
+void
+clutter_scroll_view_scroll_to_point (ClutterScrollView *view,
+                                     gfloat             x,
+                                     gfloat             y)
+{
+  g_return_if_fail (CLUTTER_IS_SCROLL_VIEW (view));
+
+  clutter_scroll_view_stop (view);
+  clutter_scroll_view_set_scroll_point_internal (view, x, y);
+}
+
+/**
+ * clutter_scroll_view_get_scroll_point:
+ * @view: a #ClutterScrollView
+ * @x: (out) (allow-none): return location for the X coordinate
+ * @y: (out) (allow-none): return location for the Y coordinate
+ *
+ * Retrieves the point of the child displayed at the origin of @view
+ *
+ * Since: 1.8
+ */
+void
+clutter_scroll_view_get_scroll_point (ClutterScrollView *view,
+                                      gfloat            *x,
+                                      gfloat            *y)
+{
+  g_return_if_fail (CLUTTER_IS_SCROLL_VIEW (view));
+
+  if (x)
+    *x = view->priv->scroll_x;
+
+  if (y)
+    *y = view->priv->scroll_y;
+}
+
+/**
+ * clutter_scroll_view_get_visible_area:
+ * @view: a #ClutterScrollView
+ * @box: (out): return location for the visible area
+ *
+ * Retrieves the area of the child of @view that is currently visible,
+ * in the coordinates of the child, as of the last allocation of @view
+ *
+ * Since: 1.8
+ */
+void
+clutter_scroll_view_get_visible_area (ClutterScrollView *view,
+                                      ClutterActorBox   *box)
+{
+  ClutterScrollViewPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_SCROLL_VIEW (view));
+  g_return_if_fail (box != NULL);
+
+  priv = view->priv;
+
+  box->x1 = priv->scroll_x;
+  box->y1 = priv->scroll_y;
+  box->x2 = priv->scroll_x + priv->view_width;
+  box->y2 = priv->scroll_y + priv->view_height;
+}
+
+/**
+ * clutter_scroll_view_set_kinetic:
+ * @view: a #ClutterScrollView
+ * @kinetic: whether the scrolling should be kinetic
+ *
+ * Sets whether the scrolling of @view should continue, and decelerate,
+ * when the pointer is released while dragging the child
+ *
+ * Since: 1.8
+ */
+void
+clutter_scroll_view_set_kinetic (ClutterScrollView *view,
+                                 gboolean           kinetic)
+{
+  ClutterScrollViewPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_SCROLL_VIEW (view));
+
+  priv = view->priv;
+
+  kinetic = !!kinetic;
+
+  if (priv->kinetic == kinetic)
+    return;
+
+  priv->kinetic = kinetic;
+
+  if (!kinetic)
+    clutter_scroll_view_stop (view);
+
+  g_object_notify_by_pspec (G_OBJECT (view), obj_props[PROP_KINETIC]);
+}
+
+/**
+ * clutter_scroll_view_get_kinetic:
+ * @view: a #ClutterScrollView
+ *
+ * Retrieves the value set by clutter_scroll_view_set_kinetic()
+ *
+ * Return value: %TRUE if the scrolling is kinetic
+ *
+ * Since: 1.8
+ */
+gboolean
+clutter_scroll_view_get_kinetic (ClutterScrollView *view)
+{
+  g_return_val_if_fail (CLUTTER_IS_SCROLL_VIEW (view), FALSE);
+
+  return view->priv->kinetic;
+}
+
+/**
+ * clutter_scroll_view_stop:
+ * @view: a #ClutterScrollView
+ *
+ * Stops the kinetic scrolling of @view, if any
+ *
+ * Since: 1.8
+ */
+void
+clutter_scroll_view_stop (ClutterScrollView *view)
+{
+  ClutterScrollViewPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_SCROLL_VIEW (view));
+
+  priv = view->priv;
+
+  if (priv->deceleration != NULL)
+    clutter_timeline_stop (priv->deceleration);
+
+  priv->velocity_x = priv->velocity_y = 0;
+}
@@ -0,0 +1,101 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2011  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined(__CLUTTER_H_INSIDE__) && !defined(CLUTTER_COMPILATION)
+#error "Only <clutter/clutter.h> can be included directly."
+#endif
+
+#ifndef __CLUTTER_SCROLL_VIEW_H__
+#define __CLUTTER_SCROLL_VIEW_H__
+
+#include <clutter/clutter-actor.h>
+
+G_BEGIN_DECLS
+
+#define CLUTTER_TYPE_SCROLL_VIEW                (clutter_scroll_view_get_type ())
+#define CLUTTER_SCROLL_VIEW(obj)                (G_TYPE_CHECK_INSTANCE_CAST ((obj), CLUTTER_TYPE_SCROLL_VIEW, ClutterScrollView))
+#define CLUTTER_IS_SCROLL_VIEW(obj)             (G_TYPE_CHECK_INSTANCE_TYPE ((obj), CLUTTER_TYPE_SCROLL_VIEW))
+#define CLUTTER_SCROLL_VIEW_CLASS(klass)        (G_TYPE_CHECK_CLASS_CAST ((klass), CLUTTER_TYPE_SCROLL_VIEW, ClutterScrollViewClass))
+#define CLUTTER_IS_SCROLL_VIEW_CLASS(klass)     (G_TYPE_CHECK_CLASS_TYPE ((klass), CLUTTER_TYPE_SCROLL_VIEW))
+#define CLUTTER_SCROLL_VIEW_GET_CLASS(obj)      (G_TYPE_INSTANCE_GET_CLASS ((obj), CLUTTER_TYPE_SCROLL_VIEW, ClutterScrollViewClass))
+
+typedef struct _ClutterScrollView               ClutterScrollView;
+typedef struct _ClutterScrollViewClass          ClutterScrollViewClass;
+typedef struct _ClutterScrollViewPrivate        ClutterScrollViewPrivate;
+
+/**
+ * ClutterScrollView:
+ *
+ * The #ClutterScrollView structure contains only private data
+ * and should be accessed using the provided API
+ *
+ * Since: 1.8
+ */
+struct _ClutterScrollView
+{
+  /*< private >*/
+  ClutterActor parent_instance;
+
+  ClutterScrollViewPrivate *priv;
+};
+
+/**
+ * ClutterScrollViewClass:
+ *
+ * The #ClutterScrollViewClass structure contains only private data
+ *
+ * Since: 1.8
+ */
+struct _ClutterScrollViewClass
+{
+  /*< private >*/
+  ClutterActorClass parent_class;
+
+  /* padding for future expansion */
+  void (*_clutter_scroll_view1) (void);
+  void (*_clutter_scroll_view2) (void);
+  void (*_clutter_scroll_view3) (void);
+  void (*_clutter_scroll_view4) (void);
+};
+
+GType clutter_scroll_view_get_type (void) G_GNUC_CONST;
+
+ClutterActor * clutter_scroll_view_new              (void);
+
+void           clutter_scroll_view_set_child        (ClutterScrollView *view,
+                                                     ClutterActor      *child);
+ClutterActor * clutter_scroll_view_get_child        (ClutterScrollView *view);
+void           clutter_scroll_view_scroll_to_point  (ClutterScrollView *view,
+                                                     gfloat             x,
+                                                     gfloat             y);
+void           clutter_scroll_view_get_scroll_point (ClutterScrollView *view,
+                                                     gfloat            *x,
+                                                     gfloat            *y);
+void           clutter_scroll_view_get_visible_area (ClutterScrollView *view,
+                                                     ClutterActorBox   *box);
+void           clutter_scroll_view_set_kinetic      (ClutterScrollView *view,
+                                                     gboolean           kinetic);
+gboolean       clutter_scroll_view_get_kinetic      (ClutterScrollView *view);
+void           clutter_scroll_view_stop             (ClutterScrollView *view);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_SCROLL_VIEW_H__ */
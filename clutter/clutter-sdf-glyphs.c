@@ -0,0 +1,794 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2011 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Signed distance field rendering of Pango layouts
+ *
+ * Each glyph is rasterized once, at SDF_GLYPH_SIZE pixels and without
+ * hinting, and converted into a map of the distance of each pixel from
+ * the outline of the glyph. The maps of all the glyphs are packed in a
+ * single alpha texture, and drawn at any size using a fragment shader
+ * that thresholds the interpolated distance, so that the outlines stay
+ * sharp regardless of the font size and of the scale of the actor.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <math.h>
+#include <string.h>
+
+#include <pango/pangocairo.h>
+
+#include "clutter-sdf-glyphs.h"
+
+#include "clutter-debug.h"
+#include "clutter-private.h"
+
+/* the size the glyphs are rasterized at */
+#define SDF_GLYPH_SIZE          48
+
+/* the distance from the outline, in pixels, covered by the map */
+#define SDF_SPREAD              6
+
+#define SDF_ATLAS_SIZE          1024
+
+typedef struct _SdfGlyphKey
+{
+  cairo_font_face_t *face;
+  PangoGlyph glyph;
+} SdfGlyphKey;
+
+typedef struct _SdfGlyph
+{
+  SdfGlyphKey key;
+
+  /* the position of the map relative to the origin of the glyph,
+   * and its size, in pixels at SDF_GLYPH_SIZE */
+  gint x, y;
+  gint width, height;
+
+  /* the texture coordinates of the map inside the atlas */
+  gfloat tx1, ty1, tx2, ty2;
+} SdfGlyph;
+
+/* a run of glyphs of a layout, drawn with the same smoothing */
+typedef struct _SdfLayoutRun
+{
+  /* the scale of the glyphs relative to SDF_GLYPH_SIZE */
+  gfloat glyph_scale;
+
+  /* the range of the rectangles of the run */
+  guint first_rect;
+  guint n_rects;
+} SdfLayoutRun;
+
+/* the rectangles of the glyphs of a layout, kept on the layout so that
+ * painting it again, for instance with a different color or opacity,
+ * only draws them without going through the runs and the glyphs */
+typedef struct _SdfLayoutCache
+{
+  /* the atlas the texture coordinates point into */
+  guint atlas_generation;
+
+  /* the settings of the layout that change the position of the glyphs
+   * without creating a new layout */
+  gint width;
+  gint height;
+  PangoEllipsizeMode ellipsize;
+
+  GArray *runs;
+
+  /* eight floats for each rectangle, as used by
+   * cogl_rectangles_with_texture_coords() */
+  GArray *rects;
+} SdfLayoutCache;
+
+static GHashTable *glyph_cache = NULL;
+
+static CoglHandle atlas_texture = COGL_INVALID_HANDLE;
+static gint atlas_x = 0;
+static gint atlas_y = 0;
+static gint atlas_row_height = 0;
+
+/* incremented each time the glyphs are evicted from the atlas */
+static guint atlas_generation = 0;
+
+static CoglHandle sdf_material = COGL_INVALID_HANDLE;
+static CoglHandle sdf_program = COGL_INVALID_HANDLE;
+static gint sdf_smoothing_location = -1;
+static gfloat sdf_smoothing = -1.f;
+
+static const gchar sdf_glsl_shader[] =
+"uniform sampler2D distance_field;\n"
+"uniform float smoothing;\n"
+"\n"
+"void main ()\n"
+"{\n"
+"  float distance = texture2D (distance_field, cogl_tex_coord_in[0].st).a;\n"
+"  float alpha = smoothstep (0.5 - smoothing, 0.5 + smoothing, distance);\n"
+"  cogl_color_out = cogl_color_in * alpha;\n"
+"}\n";
+
+static guint
+sdf_glyph_key_hash (gconstpointer data)
+{
+  const SdfGlyphKey *key = data;
+
+  return GPOINTER_TO_UINT (key->face) ^ key->glyph;
+}
+
+static gboolean
+sdf_glyph_key_equal (gconstpointer a,
+                     gconstpointer b)
+{
+  const SdfGlyphKey *key_a = a;
+  const SdfGlyphKey *key_b = b;
+
+  return key_a->face == key_b->face && key_a->glyph == key_b->glyph;
+}
+
+static void
+sdf_glyph_free (SdfGlyph *glyph)
+{
+  cairo_font_face_destroy (glyph->key.face);
+
+  g_slice_free (SdfGlyph, glyph);
+}
+
+static gboolean
+sdf_ensure_program (void)
+{
+  CoglHandle shader;
+  gint location;
+
+  if (sdf_material != COGL_INVALID_HANDLE)
+    return TRUE;
+
+  if (!cogl_features_available (COGL_FEATURE_SHADERS_GLSL))
+    return FALSE;
+
+  shader = cogl_create_shader (COGL_SHADER_TYPE_FRAGMENT);
+  cogl_shader_source (shader, sdf_glsl_shader);
+  cogl_shader_compile (shader);
+
+  if (!cogl_shader_is_compiled (shader))
+    {
+      gchar *log_buf = cogl_shader_get_info_log (shader);
+
+      g_warning ("Unable to compile the distance field shader: %s", log_buf);
+      g_free (log_buf);
+
+      cogl_handle_unref (shader);
+
+      return FALSE;
+    }
+
+  sdf_program = cogl_create_program ();
+  cogl_program_attach_shader (sdf_program, shader);
+  cogl_program_link (sdf_program);
+  cogl_handle_unref (shader);
+
+  location = cogl_program_get_uniform_location (sdf_program,
+                                                "distance_field");
+  if (location > -1)
+    cogl_program_set_uniform_1i (sdf_program, location, 0);
+
+  sdf_smoothing_location =
+    cogl_program_get_uniform_location (sdf_program, "smoothing");
+
+  atlas_texture = cogl_texture_new_with_size (SDF_ATLAS_SIZE,
+                                              SDF_ATLAS_SIZE,
+                                              COGL_TEXTURE_NO_SLICING,
+                                              COGL_PIXEL_FORMAT_A_8);
+
+  sdf_material = cogl_material_new ();
+  cogl_material_set_layer (sdf_material, 0, atlas_texture);
+  cogl_material_set_layer_filters (sdf_material, 0,
+                                   COGL_MATERIAL_FILTER_LINEAR,
+                                   COGL_MATERIAL_FILTER_LINEAR);
+  cogl_material_set_user_program (sdf_material, sdf_program);
+
+  glyph_cache = g_hash_table_new_full (sdf_glyph_key_hash,
+                                       sdf_glyph_key_equal,
+                                       NULL,
+                                       (GDestroyNotify) sdf_glyph_free);
+
+  return TRUE;
+}
+
+/*< private >
+ * _clutter_sdf_glyphs_supported:
+ *
+ * Checks whether layouts can be rendered using distance fields, which
+ * requires support for GLSL shaders.
+ *
+ * Return value: %TRUE if _clutter_sdf_glyphs_render_layout() can be used
+ */
+gboolean
+_clutter_sdf_glyphs_supported (void)
+{
+  return sdf_ensure_program ();
+}
+
+/* computes, for each pixel, the distance from the nearest pixel that
+ * does not belong to the same side of the outline, using a two pass
+ * chamfer transform */
+static void
+sdf_distance_transform (const guint8 *data,
+                        gint          stride,
+                        gint          width,
+                        gint          height,
+                        gboolean      inside,
+                        gfloat       *distances)
+{
+  const gfloat diagonal = G_SQRT2;
+  gint x, y;
+
+  for (y = 0; y < height; y++)
+    for (x = 0; x < width; x++)
+      {
+        gboolean is_inside = data[y * stride + x] >= 128;
+
+        distances[y * width + x] = (is_inside == inside) ? G_MAXFLOAT : 0.f;
+      }
+
+#define SDF_RELAX(dx,dy,cost) G_STMT_START {                            \
+  gint nx = x + (dx), ny = y + (dy);                                    \
+  if (nx >= 0 && nx < width && ny >= 0 && ny < height &&                \
+      distances[ny * width + nx] + (cost) < *d)                         \
+    *d = distances[ny * width + nx] + (cost);                           \
+} G_STMT_END
+
+  for (y = 0; y < height; y++)
+    for (x = 0; x < width; x++)
+      {
+        gfloat *d = distances + y * width + x;
+
+        SDF_RELAX (-1,  0, 1.f);
+        SDF_RELAX ( 0, -1, 1.f);
+        SDF_RELAX (-1, -1, diagonal);
+        SDF_RELAX ( 1, -1, diagonal);
+      }
+
+  for (y = height - 1; y >= 0; y--)
+    for (x = width - 1; x >= 0; x--)
+      {
+        gfloat *d = distances + y * width + x;
+
+        SDF_RELAX ( 1,  0, 1.f);
+        SDF_RELAX ( 0,  1, 1.f);
+        SDF_RELAX ( 1,  1, diagonal);
+        SDF_RELAX (-1,  1, diagonal);
+      }
+
+#undef SDF_RELAX
+}
+
+/* reserves a rectangle of the atlas; if the atlas is full, all the
+ * glyphs are evicted, after drawing the ones already in use */
+static void
+sdf_atlas_reserve (gint  width,
+                   gint  height,
+                   gint *x,
+                   gint *y)
+{
+  if (atlas_x + width > SDF_ATLAS_SIZE)
+    {
+      atlas_x = 0;
+      atlas_y += atlas_row_height;
+      atlas_row_height = 0;
+    }
+
+  if (atlas_y + height > SDF_ATLAS_SIZE)
+    {
+      CLUTTER_NOTE (PAINT, "Distance field atlas full, evicting %d glyphs",
+                    g_hash_table_size (glyph_cache));
+
+      cogl_flush ();
+      g_hash_table_remove_all (glyph_cache);
+
+      atlas_x = atlas_y = atlas_row_height = 0;
+      atlas_generation += 1;
+    }
+
+  *x = atlas_x;
+  *y = atlas_y;
+
+  atlas_x += width;
+  atlas_row_height = MAX (atlas_row_height, height);
+}
+
+static SdfGlyph *
+sdf_glyph_new (cairo_font_face_t *face,
+               PangoGlyph         index_)
+{
+  cairo_font_options_t *options;
+  cairo_scaled_font_t *scaled_font;
+  cairo_matrix_t font_matrix, ctm;
+  cairo_text_extents_t extents;
+  cairo_glyph_t cairo_glyph = { index_, 0, 0 };
+  cairo_surface_t *surface;
+  cairo_t *cr;
+  gfloat *inside, *outside;
+  guint8 *data, *field;
+  gint stride, i;
+  gint atlas_dest_x, atlas_dest_y;
+  SdfGlyph *glyph;
+
+  glyph = g_slice_new0 (SdfGlyph);
+  glyph->key.face = cairo_font_face_reference (face);
+  glyph->key.glyph = index_;
+
+  /* the outlines are rendered without hinting, since they are going
+   * to be scaled */
+  options = cairo_font_options_create ();
+  cairo_font_options_set_hint_style (options, CAIRO_HINT_STYLE_NONE);
+  cairo_font_options_set_hint_metrics (options, CAIRO_HINT_METRICS_OFF);
+  cairo_font_options_set_antialias (options, CAIRO_ANTIALIAS_GRAY);
+
+  cairo_matrix_init_scale (&font_matrix, SDF_GLYPH_SIZE, SDF_GLYPH_SIZE);
+  cairo_matrix_init_identity (&ctm);
+
+  scaled_font = cairo_scaled_font_create (face, &font_matrix, &ctm, options);
+  cairo_font_options_destroy (options);
+
+  cairo_scaled_font_glyph_extents (scaled_font, &cairo_glyph, 1, &extents);
+
+  /* empty glyphs, like spaces, are never drawn */
+  if (extents.width <= 0 || extents.height <= 0)
+    {
+      cairo_scaled_font_destroy (scaled_font);
+      return glyph;
+    }
+
+  glyph->x = floor (extents.x_bearing) - SDF_SPREAD;
+  glyph->y = floor (extents.y_bearing) - SDF_SPREAD;
+  glyph->width = ceil (extents.x_bearing + extents.width)
+               + SDF_SPREAD - glyph->x;
+  glyph->height = ceil (extents.y_bearing + extents.height)
+                + SDF_SPREAD - glyph->y;
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_A8,
+                                        glyph->width,
+                                        glyph->height);
+
+  cr = cairo_create (surface);
+  cairo_set_scaled_font (cr, scaled_font);
+  cairo_glyph.x = -glyph->x;
+  cairo_glyph.y = -glyph->y;
+  cairo_show_glyphs (cr, &cairo_glyph, 1);
+  cairo_destroy (cr);
+
+  cairo_scaled_font_destroy (scaled_font);
+
+  cairo_surface_flush (surface);
+  data = cairo_image_surface_get_data (surface);
+  stride = cairo_image_surface_get_stride (surface);
+
+  inside = g_new (gfloat, glyph->width * glyph->height);
+  outside = g_new (gfloat, glyph->width * glyph->height);
+
+  /* distance of the inner pixels from the outside, and vice versa */
+  sdf_distance_transform (data, stride, glyph->width, glyph->height,
+                          TRUE, inside);
+  sdf_distance_transform (data, stride, glyph->width, glyph->height,
+                          FALSE, outside);
+
+  /* the outline maps to 0.5; SDF_SPREAD pixels inside map to 1.0 */
+  field = g_malloc (glyph->width * glyph->height);
+  for (i = 0; i < glyph->width * glyph->height; i++)
+    {
+      gfloat distance;
+
+      if (inside[i] > 0.f)
+        distance = inside[i] - 0.5f;
+      else
+        distance = 0.5f - outside[i];
+
+      field[i] = CLAMP (0.5f + distance / (2.f * SDF_SPREAD), 0.f, 1.f)
+               * 255.f + 0.5f;
+    }
+
+  g_free (inside);
+  g_free (outside);
+  cairo_surface_destroy (surface);
+
+  sdf_atlas_reserve (glyph->width, glyph->height,
+                     &atlas_dest_x, &atlas_dest_y);
+
+  cogl_texture_set_region (atlas_texture,
+                           0, 0,
+                           atlas_dest_x, atlas_dest_y,
+                           glyph->width, glyph->height,
+                           glyph->width, glyph->height,
+                           COGL_PIXEL_FORMAT_A_8,
+                           glyph->width,
+                           field);
+  g_free (field);
+
+  glyph->tx1 = (gfloat) atlas_dest_x / SDF_ATLAS_SIZE;
+  glyph->ty1 = (gfloat) atlas_dest_y / SDF_ATLAS_SIZE;
+  glyph->tx2 = (gfloat) (atlas_dest_x + glyph->width) / SDF_ATLAS_SIZE;
+  glyph->ty2 = (gfloat) (atlas_dest_y + glyph->height) / SDF_ATLAS_SIZE;
+
+  return glyph;
+}
+
+static SdfGlyph *
+sdf_glyph_lookup (cairo_font_face_t *face,
+                  PangoGlyph         index_)
+{
+  SdfGlyphKey key = { face, index_ };
+  SdfGlyph *glyph;
+
+  glyph = g_hash_table_lookup (glyph_cache, &key);
+  if (glyph == NULL)
+    {
+      glyph = sdf_glyph_new (face, index_);
+      g_hash_table_insert (glyph_cache, &glyph->key, glyph);
+    }
+
+  return glyph;
+}
+
+static void
+sdf_set_smoothing (gfloat smoothing)
+{
+  if (fabsf (smoothing - sdf_smoothing) < 0.001f ||
+      sdf_smoothing_location < 0)
+    return;
+
+  /* the rectangles already in the journal use the previous value */
+  cogl_flush ();
+
+  cogl_program_set_uniform_1f (sdf_program, sdf_smoothing_location,
+                               smoothing);
+  sdf_smoothing = smoothing;
+}
+
+/* sets the smoothing for glyphs scaled by @glyph_scale in a layout
+ * scaled by @scale on the screen */
+static void
+sdf_set_glyph_smoothing (gfloat glyph_scale,
+                         gfloat scale)
+{
+  gfloat pixels_per_unit;
+
+  /* keep a transition band of about one pixel on the screen; a pixel
+   * of the map changes the distance by 1 / (2 * SDF_SPREAD) */
+  pixels_per_unit = MAX (glyph_scale * scale, 0.01f);
+  sdf_set_smoothing (MIN (0.5f, 1.f / (4.f * SDF_SPREAD * pixels_per_unit)));
+}
+
+static void
+sdf_render_glyph_item (PangoGlyphItem *run,
+                       gint            x,
+                       gint            y,
+                       gfloat          scale)
+{
+  PangoGlyphString *glyphs = run->glyphs;
+  cairo_scaled_font_t *scaled_font;
+  cairo_font_face_t *face;
+  cairo_matrix_t font_matrix;
+  gfloat glyph_scale;
+  gint i;
+
+  scaled_font =
+    pango_cairo_font_get_scaled_font (PANGO_CAIRO_FONT (run->item->analysis.font));
+  if (scaled_font == NULL)
+    return;
+
+  face = cairo_scaled_font_get_font_face (scaled_font);
+  cairo_scaled_font_get_font_matrix (scaled_font, &font_matrix);
+
+  glyph_scale = font_matrix.yy / SDF_GLYPH_SIZE;
+
+  sdf_set_glyph_smoothing (glyph_scale, scale);
+
+  for (i = 0; i < glyphs->num_glyphs; i++)
+    {
+      PangoGlyphInfo *gi = glyphs->glyphs + i;
+
+      if ((gi->glyph & PANGO_GLYPH_UNKNOWN_FLAG) == 0 &&
+          gi->glyph != PANGO_GLYPH_EMPTY)
+        {
+          SdfGlyph *glyph = sdf_glyph_lookup (face, gi->glyph);
+
+          if (glyph->width > 0)
+            {
+              gfloat gx = (gfloat) (x + gi->geometry.x_offset) / PANGO_SCALE
+                        + glyph->x * glyph_scale;
+              gfloat gy = (gfloat) (y + gi->geometry.y_offset) / PANGO_SCALE
+                        + glyph->y * glyph_scale;
+
+              cogl_rectangle_with_texture_coords (gx, gy,
+                                                  gx + glyph->width * glyph_scale,
+                                                  gy + glyph->height * glyph_scale,
+                                                  glyph->tx1, glyph->ty1,
+                                                  glyph->tx2, glyph->ty2);
+            }
+        }
+
+      x += gi->geometry.width;
+    }
+}
+
+/* draws the glyphs of @layout one run at a time, for the layouts with
+ * more glyphs than the atlas can hold */
+static void
+sdf_render_layout_immediate (PangoLayout *layout,
+                             gfloat       scale)
+{
+  PangoLayoutIter *iter;
+
+  iter = pango_layout_get_iter (layout);
+
+  do
+    {
+      PangoLayoutRun *run = pango_layout_iter_get_run_readonly (iter);
+      PangoRectangle logical_rect;
+
+      /* the end of each line */
+      if (run == NULL)
+        continue;
+
+      pango_layout_iter_get_run_extents (iter, NULL, &logical_rect);
+
+      sdf_render_glyph_item (run,
+                             logical_rect.x,
+                             pango_layout_iter_get_baseline (iter),
+                             scale);
+    }
+  while (pango_layout_iter_next_run (iter));
+
+  pango_layout_iter_free (iter);
+}
+
+static void
+sdf_layout_cache_free (gpointer data)
+{
+  SdfLayoutCache *cache = data;
+
+  g_array_free (cache->runs, TRUE);
+  g_array_free (cache->rects, TRUE);
+
+  g_slice_free (SdfLayoutCache, cache);
+}
+
+static GQuark
+sdf_layout_cache_quark (void)
+{
+  static GQuark quark = 0;
+
+  if (G_UNLIKELY (quark == 0))
+    quark = g_quark_from_static_string ("-clutter-sdf-layout-cache");
+
+  return quark;
+}
+
+/* appends the rectangles of the glyphs of @run, with the origin of its
+ * baseline at (@x, @y) in Pango units */
+static void
+sdf_layout_cache_add_glyph_item (SdfLayoutCache *cache,
+                                 PangoGlyphItem *run,
+                                 gint            x,
+                                 gint            y)
+{
+  PangoGlyphString *glyphs = run->glyphs;
+  cairo_scaled_font_t *scaled_font;
+  cairo_font_face_t *face;
+  cairo_matrix_t font_matrix;
+  SdfLayoutRun layout_run;
+  gint i;
+
+  scaled_font =
+    pango_cairo_font_get_scaled_font (PANGO_CAIRO_FONT (run->item->analysis.font));
+  if (scaled_font == NULL)
+    return;
+
+  face = cairo_scaled_font_get_font_face (scaled_font);
+  cairo_scaled_font_get_font_matrix (scaled_font, &font_matrix);
+
+  layout_run.glyph_scale = font_matrix.yy / SDF_GLYPH_SIZE;
+  layout_run.first_rect = cache->rects->len / 8;
+  layout_run.n_rects = 0;
+
+  for (i = 0; i < glyphs->num_glyphs; i++)
+    {
+      PangoGlyphInfo *gi = glyphs->glyphs + i;
+
+      if ((gi->glyph & PANGO_GLYPH_UNKNOWN_FLAG) == 0 &&
+          gi->glyph != PANGO_GLYPH_EMPTY)
+        {
+          SdfGlyph *glyph = sdf_glyph_lookup (face, gi->glyph);
+
+          if (glyph->width > 0)
+            {
+              gfloat rect[8];
+
+              rect[0] = (gfloat) (x + gi->geometry.x_offset) / PANGO_SCALE
+                      + glyph->x * layout_run.glyph_scale;
+              rect[1] = (gfloat) (y + gi->geometry.y_offset) / PANGO_SCALE
+                      + glyph->y * layout_run.glyph_scale;
+              rect[2] = rect[0] + glyph->width * layout_run.glyph_scale;
+              rect[3] = rect[1] + glyph->height * layout_run.glyph_scale;
+              rect[4] = glyph->tx1;
+              rect[5] = glyph->ty1;
+              rect[6] = glyph->tx2;
+              rect[7] = glyph->ty2;
+
+              g_array_append_vals (cache->rects, rect, 8);
+              layout_run.n_rects += 1;
+            }
+        }
+
+      x += gi->geometry.width;
+    }
+
+  if (layout_run.n_rects > 0)
+    g_array_append_val (cache->runs, layout_run);
+}
+
+static void
+sdf_layout_cache_build (SdfLayoutCache *cache,
+                        PangoLayout    *layout)
+{
+  PangoLayoutIter *iter;
+
+  g_array_set_size (cache->runs, 0);
+  g_array_set_size (cache->rects, 0);
+
+  cache->width = pango_layout_get_width (layout);
+  cache->height = pango_layout_get_height (layout);
+  cache->ellipsize = pango_layout_get_ellipsize (layout);
+  cache->atlas_generation = atlas_generation;
+
+  iter = pango_layout_get_iter (layout);
+
+  do
+    {
+      PangoLayoutRun *run = pango_layout_iter_get_run_readonly (iter);
+      PangoRectangle logical_rect;
+
+      /* the end of each line */
+      if (run == NULL)
+        continue;
+
+      pango_layout_iter_get_run_extents (iter, NULL, &logical_rect);
+
+      sdf_layout_cache_add_glyph_item (cache,
+                                       run,
+                                       logical_rect.x,
+                                       pango_layout_iter_get_baseline (iter));
+    }
+  while (pango_layout_iter_next_run (iter));
+
+  pango_layout_iter_free (iter);
+}
+
+/* returns the rectangles of the glyphs of @layout, building them if
+ * the layout changed or the glyphs were evicted from the atlas, or
+ * %NULL if the glyphs of the layout do not fit in the atlas */
+static SdfLayoutCache *
+sdf_layout_cache_get (PangoLayout *layout)
+{
+  GQuark quark = sdf_layout_cache_quark ();
+  SdfLayoutCache *cache;
+
+  cache = g_object_get_qdata (G_OBJECT (layout), quark);
+
+  if (cache == NULL)
+    {
+      cache = g_slice_new (SdfLayoutCache);
+      cache->runs = g_array_new (FALSE, FALSE, sizeof (SdfLayoutRun));
+      cache->rects = g_array_new (FALSE, FALSE, sizeof (gfloat));
+
+      g_object_set_qdata_full (G_OBJECT (layout), quark,
+                               cache,
+                               sdf_layout_cache_free);
+    }
+  else if (cache->atlas_generation == atlas_generation &&
+           cache->width == pango_layout_get_width (layout) &&
+           cache->height == pango_layout_get_height (layout) &&
+           cache->ellipsize == pango_layout_get_ellipsize (layout))
+    return cache;
+
+  sdf_layout_cache_build (cache, layout);
+
+  /* if the atlas was filled while looking up the glyphs, the first
+   * ones point into the evicted atlas; since the glyphs of the layout
+   * were the last ones added, building it again only evicts them if
+   * they do not fit in the atlas together */
+  if (cache->atlas_generation != atlas_generation)
+    sdf_layout_cache_build (cache, layout);
+
+  if (cache->atlas_generation != atlas_generation)
+    return NULL;
+
+  return cache;
+}
+
+/*< private >
+ * _clutter_sdf_glyphs_render_layout:
+ * @layout: a #PangoLayout created by a #CoglPangoFontMap
+ * @x: the X coordinate of the layout, in pixels
+ * @y: the Y coordinate of the layout, in pixels
+ * @color: the color of the text
+ * @scale: the number of pixels on the screen for each pixel of the
+ *   layout, used to keep the outlines sharp
+ *
+ * Draws @layout like cogl_pango_render_layout(), using the distance
+ * fields of the glyphs. Only the glyphs are drawn: underlines and
+ * other decorations are ignored.
+ *
+ * The rectangles of the glyphs are kept on @layout, so drawing it
+ * again with a different @color or @scale does not look up the glyphs
+ * again.
+ *
+ * This function must only be called if _clutter_sdf_glyphs_supported()
+ * returned %TRUE.
+ */
+void
+_clutter_sdf_glyphs_render_layout (PangoLayout     *layout,
+                                   gint             x,
+                                   gint             y,
+                                   const CoglColor *color,
+                                   gfloat           scale)
+{
+  SdfLayoutCache *cache;
+  guint i;
+
+  if (!sdf_ensure_program ())
+    return;
+
+  cache = sdf_layout_cache_get (layout);
+  if (cache != NULL && cache->runs->len == 0)
+    return;
+
+  cogl_material_set_color (sdf_material, color);
+  cogl_set_source (sdf_material);
+
+  if (x != 0 || y != 0)
+    {
+      cogl_push_matrix ();
+      cogl_translate (x, y, 0);
+    }
+
+  if (cache != NULL)
+    {
+      for (i = 0; i < cache->runs->len; i++)
+        {
+          const SdfLayoutRun *run;
+          const gfloat *rects;
+
+          run = &g_array_index (cache->runs, SdfLayoutRun, i);
+          rects = &g_array_index (cache->rects, gfloat, run->first_rect * 8);
+
+          sdf_set_glyph_smoothing (run->glyph_scale, scale);
+          cogl_rectangles_with_texture_coords (rects, run->n_rects);
+        }
+    }
+  else
+    sdf_render_layout_immediate (layout, scale);
+
+  if (x != 0 || y != 0)
+    cogl_pop_matrix ();
+}
@@ -0,0 +1,43 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2011 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Signed distance field rendering of Pango layouts
+ */
+
+#ifndef __CLUTTER_SDF_GLYPHS_H__
+#define __CLUTTER_SDF_GLYPHS_H__
+
+#include <glib.h>
+#include <cogl/cogl.h>
+#include <pango/pango.h>
+
+G_BEGIN_DECLS
+
+gboolean _clutter_sdf_glyphs_supported     (void);
+
+void     _clutter_sdf_glyphs_render_layout (PangoLayout     *layout,
+                                            gint             x,
+                                            gint             y,
+                                            const CoglColor *color,
+                                            gfloat           scale);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_SDF_GLYPHS_H__ */
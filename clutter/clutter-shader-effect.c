@@ -46,6 +46,11 @@
  *   clutter_shader_effect_set_uniform() to set the values of the shader
  *   uniforms, if any; the sub-class should then chain up to the
  *   #ClutterShaderEffect implementation.</para>
+ *   <para>Effects using the same source and the same shader type share
+ *   the same program, which is only compiled and linked once; the values
+ *   of the uniforms are kept by each effect, and set on the program
+ *   before painting. For this reason, an effect should set all the
+ *   uniforms used by its shader.</para>
  *   <example id="ClutterShaderEffect-example-uniforms">
  *     <title>Setting uniforms on a ClutterShaderEffect</title>
  *     <para>The example below shows a typical implementation of the
@@ -106,6 +111,8 @@
 #include "config.h"
 #endif
 
+#include <string.h>
+
 #include "clutter-shader-effect.h"
 
 #include "cogl/cogl.h"
@@ -113,7 +120,9 @@
 #include "clutter-debug.h"
 #include "clutter-enum-types.h"
 #include "clutter-feature.h"
+#include "clutter-offscreen-effect-private.h"
 #include "clutter-private.h"
+#include "clutter-shader-program.h"
 #include "clutter-shader-types.h"
 
 typedef struct _ShaderUniform
@@ -130,6 +139,8 @@ struct _ClutterShaderEffectPrivate
 
   ClutterShaderType shader_type;
 
+  ClutterShaderProgram *shared;
+
   CoglHandle program;
   CoglHandle shader;
 
@@ -160,13 +171,12 @@ clutter_shader_effect_clear (ClutterShaderEffect *self,
 {
   ClutterShaderEffectPrivate *priv = self->priv;
 
-  if (priv->shader != COGL_INVALID_HANDLE && !priv->is_compiled)
-    cogl_handle_unref (priv->shader);
-
-  if (priv->program != COGL_INVALID_HANDLE)
+  if (priv->shared != NULL)
     {
-      cogl_handle_unref (priv->program);
+      _clutter_shader_program_forget_user (priv->shared, self);
+      _clutter_shader_program_release (priv->shared);
 
+      priv->shared = NULL;
       priv->program = COGL_INVALID_HANDLE;
       priv->shader = COGL_INVALID_HANDLE;
     }
@@ -308,45 +318,36 @@ clutter_shader_effect_paint_target (ClutterOffscreenEffect *effect)
   /* we haven't been prepared or we don't have support for
    * GLSL shaders in Clutter
    */
-  if (priv->program == COGL_INVALID_HANDLE ||
-      priv->shader == COGL_INVALID_HANDLE)
-    goto out;
-
-  if (!priv->source_set)
+  if (priv->shared == NULL || !priv->source_set)
     goto out;
 
   if (!priv->is_compiled)
     {
-      CLUTTER_NOTE (SHADER, "Compiling shader effect");
-
-      cogl_shader_compile (priv->shader);
-      if (!cogl_shader_is_compiled (priv->shader))
-        {
-          gchar *log_buf = cogl_shader_get_info_log (priv->shader);
+      GError *error = NULL;
 
-          g_warning ("Unable to compile the GLSL shader: %s", log_buf);
-          g_free (log_buf);
-
-          cogl_handle_unref (priv->shader);
-          priv->shader = COGL_INVALID_HANDLE;
-
-          cogl_handle_unref (priv->program);
-          priv->shader = COGL_INVALID_HANDLE;
+      /* the failure was already reported by the first user */
+      if (priv->shared->is_failed)
+        goto out;
 
+      if (!_clutter_shader_program_ensure_compiled (priv->shared, &error))
+        {
+          g_warning ("Unable to compile the GLSL shader: %s", error->message);
+          g_error_free (error);
           goto out;
         }
 
-      cogl_program_attach_shader (priv->program, priv->shader);
-      cogl_handle_unref (priv->shader);
-
-      cogl_program_link (priv->program);
-
       priv->is_compiled = TRUE;
     }
 
   CLUTTER_NOTE (SHADER, "Applying the shader effect of type '%s'",
                 G_OBJECT_TYPE_NAME (effect));
 
+  /* the uniforms are stored in the program, which might be shared;
+   * anything still queued using the values of another effect must
+   * be painted before we overwrite them
+   */
+  _clutter_shader_program_set_last_user (priv->shared, effect);
+
   clutter_shader_effect_update_uniforms (CLUTTER_SHADER_EFFECT (effect));
 
   /* associate the program to the offscreen target material */
@@ -435,6 +436,12 @@ clutter_shader_effect_init (ClutterShaderEffect *effect)
   effect->priv = G_TYPE_INSTANCE_GET_PRIVATE (effect,
                                               CLUTTER_TYPE_SHADER_EFFECT,
                                               ClutterShaderEffectPrivate);
+
+  /* the shaders might depend on the texture coordinates covering
+   * the whole target texture
+   */
+  _clutter_offscreen_effect_set_use_pool (CLUTTER_OFFSCREEN_EFFECT (effect),
+                                          FALSE);
 }
 
 /**
@@ -463,6 +470,10 @@ clutter_shader_effect_get_shader (ClutterShaderEffect *effect)
  *
  * Retrieves a pointer to the program's handle
  *
+ * The program might be shared with other effects using the same
+ * shader source, so the uniforms should be set using the
+ * #ClutterShaderEffect API instead of directly on the program
+ *
  * Return value: (transfer none): a pointer to the program's handle,
  *   or %COGL_INVALID_HANDLE
  *
@@ -790,6 +801,8 @@ clutter_shader_effect_set_uniform (ClutterShaderEffect *effect,
  * This function can only be called once; subsequent calls will
  * yield no result.
  *
+ * Effects using the same @source share the same compiled program.
+ *
  * Return value: %TRUE if the source was set
  *
  * Since: 1.4
@@ -808,30 +821,19 @@ clutter_shader_effect_set_shader_source (ClutterShaderEffect *effect,
   if (priv->source_set)
     return TRUE;
 
-  if (priv->program == COGL_INVALID_HANDLE)
-    priv->program = cogl_create_program ();
-
-  if (priv->shader == COGL_INVALID_HANDLE)
+  if (priv->shader_type == CLUTTER_VERTEX_SHADER)
     {
-      switch (priv->shader_type)
-        {
-        case CLUTTER_FRAGMENT_SHADER:
-          priv->shader = cogl_create_shader (COGL_SHADER_TYPE_FRAGMENT);
-          break;
-
-        case CLUTTER_VERTEX_SHADER:
-          priv->shader = cogl_create_shader (COGL_SHADER_TYPE_VERTEX);
-          break;
-
-        default:
-          priv->shader = COGL_INVALID_HANDLE;
-          break;
-        }
+      priv->shared = _clutter_shader_program_acquire (source, NULL);
+      priv->shader = priv->shared->vertex_shader;
+    }
+  else
+    {
+      priv->shared = _clutter_shader_program_acquire (NULL, source);
+      priv->shader = priv->shared->fragment_shader;
     }
 
-  g_assert (priv->shader != COGL_INVALID_HANDLE);
-
-  cogl_shader_source (priv->shader, source);
+  priv->program = priv->shared->program;
+  priv->is_compiled = priv->shared->is_compiled;
 
   priv->source_set = TRUE;
 
@@ -0,0 +1,306 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2011  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* This file contains the cache of the GLSL programs used by
+ * ClutterShaderEffect and ClutterShader. The programs are looked up
+ * using their vertex and fragment sources, so all the users of the
+ * same sources share one program, which is only compiled and linked
+ * once, by the first user painting with it. The values of the
+ * uniforms are stored in the program, so each user keeps its own
+ * values and sets them again when it becomes the last user of the
+ * program. */
+
+#include <glib/gi18n-lib.h>
+
+#include "clutter-shader-program.h"
+
+#include "clutter-debug.h"
+#include "clutter-private.h"
+#include "clutter-shader.h"
+
+/* the cache of the programs, looked up using the sources */
+static GHashTable *shader_programs = NULL;
+
+static guint
+shader_program_hash (gconstpointer key)
+{
+  const ClutterShaderProgram *program = key;
+  guint hash = 0;
+
+  if (program->vertex_source != NULL)
+    hash = g_str_hash (program->vertex_source);
+
+  if (program->fragment_source != NULL)
+    hash = (hash * 31) ^ g_str_hash (program->fragment_source);
+
+  return hash;
+}
+
+static gboolean
+shader_program_equal (gconstpointer a,
+                      gconstpointer b)
+{
+  const ClutterShaderProgram *program_a = a;
+  const ClutterShaderProgram *program_b = b;
+
+  return g_strcmp0 (program_a->vertex_source, program_b->vertex_source) == 0 &&
+         g_strcmp0 (program_a->fragment_source, program_b->fragment_source) == 0;
+}
+
+static CoglHandle
+shader_program_create_shader (CoglShaderType  shader_type,
+                              const gchar    *source)
+{
+  CoglHandle shader;
+
+  if (source == NULL)
+    return COGL_INVALID_HANDLE;
+
+  shader = cogl_create_shader (shader_type);
+  cogl_shader_source (shader, source);
+
+  return shader;
+}
+
+/* compiles @shader and attaches it to the program; returns %FALSE
+ * and sets the error of @program if the compilation failed */
+static gboolean
+shader_program_attach (ClutterShaderProgram *program,
+                       CoglHandle            shader,
+                       ClutterShaderType     shader_type)
+{
+  gchar *log_buf;
+
+  if (shader == COGL_INVALID_HANDLE)
+    return TRUE;
+
+  cogl_shader_compile (shader);
+  if (cogl_shader_is_compiled (shader))
+    {
+      cogl_program_attach_shader (program->program, shader);
+      return TRUE;
+    }
+
+  log_buf = cogl_shader_get_info_log (shader);
+
+  /* translators: the first %s is the type of the shader, either
+   * Vertex shader or Fragment shader; the second %s is the actual
+   * error as reported by COGL
+   */
+  g_set_error (&program->error, CLUTTER_SHADER_ERROR,
+               CLUTTER_SHADER_ERROR_COMPILE,
+               _("%s compilation failed: %s"),
+               shader_type == CLUTTER_VERTEX_SHADER ? _("Vertex shader")
+                                                    : _("Fragment shader"),
+               log_buf);
+
+  g_free (log_buf);
+
+  return FALSE;
+}
+
+/*< private >
+ * _clutter_shader_program_acquire:
+ * @vertex_source: (allow-none): the source of the vertex shader, or %NULL
+ * @fragment_source: (allow-none): the source of the fragment shader, or %NULL
+ *
+ * Retrieves the program using @vertex_source and @fragment_source,
+ * creating it if no other user holds it. The program is not compiled
+ * until _clutter_shader_program_ensure_compiled() is called.
+ *
+ * Return value: the program; use _clutter_shader_program_release()
+ *   when done with it
+ */
+ClutterShaderProgram *
+_clutter_shader_program_acquire (const gchar *vertex_source,
+                                 const gchar *fragment_source)
+{
+  ClutterShaderProgram key, *program;
+
+  if (G_UNLIKELY (shader_programs == NULL))
+    shader_programs = g_hash_table_new (shader_program_hash,
+                                        shader_program_equal);
+
+  key.vertex_source = (gchar *) vertex_source;
+  key.fragment_source = (gchar *) fragment_source;
+
+  program = g_hash_table_lookup (shader_programs, &key);
+  if (program != NULL)
+    {
+      CLUTTER_NOTE (SHADER, "Sharing a program (vertex:%s, fragment:%s)",
+                    vertex_source != NULL ? "yes" : "no",
+                    fragment_source != NULL ? "yes" : "no");
+
+      program->ref_count += 1;
+
+      return program;
+    }
+
+  program = g_slice_new0 (ClutterShaderProgram);
+  program->vertex_source = g_strdup (vertex_source);
+  program->fragment_source = g_strdup (fragment_source);
+  program->ref_count = 1;
+
+  program->vertex_shader =
+    shader_program_create_shader (COGL_SHADER_TYPE_VERTEX, vertex_source);
+  program->fragment_shader =
+    shader_program_create_shader (COGL_SHADER_TYPE_FRAGMENT, fragment_source);
+
+  program->program = cogl_create_program ();
+
+  g_hash_table_insert (shader_programs, program, program);
+
+  return program;
+}
+
+/*< private >
+ * _clutter_shader_program_release:
+ * @program: a #ClutterShaderProgram
+ *
+ * Releases the reference acquired by _clutter_shader_program_acquire();
+ * the program is destroyed when its last user releases it.
+ */
+void
+_clutter_shader_program_release (ClutterShaderProgram *program)
+{
+  g_return_if_fail (program != NULL);
+  g_return_if_fail (program->ref_count > 0);
+
+  program->ref_count -= 1;
+  if (program->ref_count > 0)
+    return;
+
+  g_hash_table_remove (shader_programs, program);
+
+  if (program->vertex_shader != COGL_INVALID_HANDLE)
+    cogl_handle_unref (program->vertex_shader);
+
+  if (program->fragment_shader != COGL_INVALID_HANDLE)
+    cogl_handle_unref (program->fragment_shader);
+
+  if (program->program != COGL_INVALID_HANDLE)
+    cogl_handle_unref (program->program);
+
+  if (program->error != NULL)
+    g_error_free (program->error);
+
+  g_free (program->vertex_source);
+  g_free (program->fragment_source);
+
+  g_slice_free (ClutterShaderProgram, program);
+}
+
+/*< private >
+ * _clutter_shader_program_ensure_compiled:
+ * @program: a #ClutterShaderProgram
+ * @error: return location for a #GError, or %NULL
+ *
+ * Compiles and links @program, if this was not done by another of its
+ * users. If the compilation failed, @program is kept in the cache in
+ * its failed state, so that the other users of the same sources do not
+ * try to compile them again, and @error is set.
+ *
+ * Return value: %TRUE if the program can be used
+ */
+gboolean
+_clutter_shader_program_ensure_compiled (ClutterShaderProgram  *program,
+                                         GError               **error)
+{
+  g_return_val_if_fail (program != NULL, FALSE);
+
+  if (program->is_compiled)
+    return TRUE;
+
+  if (!program->is_failed)
+    {
+      CLUTTER_NOTE (SHADER, "Compiling shader program");
+
+      if (shader_program_attach (program,
+                                 program->vertex_shader,
+                                 CLUTTER_VERTEX_SHADER) &&
+          shader_program_attach (program,
+                                 program->fragment_shader,
+                                 CLUTTER_FRAGMENT_SHADER))
+        {
+          cogl_program_link (program->program);
+          program->is_compiled = TRUE;
+
+          return TRUE;
+        }
+
+      program->is_failed = TRUE;
+    }
+
+  g_propagate_error (error, g_error_copy (program->error));
+
+  return FALSE;
+}
+
+/*< private >
+ * _clutter_shader_program_set_last_user:
+ * @program: a #ClutterShaderProgram
+ * @user: the user about to set its uniforms on @program
+ *
+ * Records that @user is going to set its uniforms on @program. Anything
+ * still queued using the values of the previous user is painted first.
+ *
+ * Return value: %TRUE if the previous user was a different one, and
+ *   the values of the uniforms of @user have to be set again
+ */
+gboolean
+_clutter_shader_program_set_last_user (ClutterShaderProgram *program,
+                                       gconstpointer         user)
+{
+  g_return_val_if_fail (program != NULL, FALSE);
+
+  if (program->last_user == user)
+    return FALSE;
+
+  if (program->last_user != NULL)
+    cogl_flush ();
+
+  program->last_user = user;
+
+  return TRUE;
+}
+
+/*< private >
+ * _clutter_shader_program_forget_user:
+ * @program: a #ClutterShaderProgram
+ * @user: a user of @program
+ *
+ * Removes @user as the last user of @program, if it is; this should
+ * be called before releasing the program, since the address of @user
+ * could be reused by a new user.
+ */
+void
+_clutter_shader_program_forget_user (ClutterShaderProgram *program,
+                                     gconstpointer         user)
+{
+  g_return_if_fail (program != NULL);
+
+  if (program->last_user == user)
+    program->last_user = NULL;
+}
@@ -0,0 +1,67 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2011  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __CLUTTER_SHADER_PROGRAM_H__
+#define __CLUTTER_SHADER_PROGRAM_H__
+
+#include <cogl/cogl.h>
+
+G_BEGIN_DECLS
+
+typedef struct _ClutterShaderProgram    ClutterShaderProgram;
+
+/* a program shared by all the users of the same sources */
+struct _ClutterShaderProgram
+{
+  gchar *vertex_source;
+  gchar *fragment_source;
+
+  CoglHandle program;
+
+  /* owned by the program, COGL_INVALID_HANDLE if there is no source */
+  CoglHandle vertex_shader;
+  CoglHandle fragment_shader;
+
+  /* the last user that set its uniforms on the program */
+  gconstpointer last_user;
+
+  /* the reason of the failure, if the program could not be compiled */
+  GError *error;
+
+  guint ref_count;
+
+  guint is_compiled : 1;
+  guint is_failed   : 1;
+};
+
+ClutterShaderProgram *_clutter_shader_program_acquire          (const gchar          *vertex_source,
+                                                                const gchar          *fragment_source);
+void                  _clutter_shader_program_release          (ClutterShaderProgram *program);
+gboolean              _clutter_shader_program_ensure_compiled  (ClutterShaderProgram *program,
+                                                                GError              **error);
+gboolean              _clutter_shader_program_set_last_user    (ClutterShaderProgram *program,
+                                                                gconstpointer         user);
+void                  _clutter_shader_program_forget_user      (ClutterShaderProgram *program,
+                                                                gconstpointer         user);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_SHADER_PROGRAM_H__ */
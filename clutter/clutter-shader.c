@@ -35,6 +35,11 @@
  * possible to override the drawing pipeline by using small programs
  * also known as "shaders".
  *
+ * Shaders using the same vertex and fragment sources share the same
+ * program, which is only compiled and linked once; the values of the
+ * uniforms are kept by each #ClutterShader, and only the values that
+ * changed are set on the program.
+ *
  * #ClutterShader is available since Clutter 0.6
  */
 
@@ -57,6 +62,8 @@
 #include "clutter-debug.h"
 #include "clutter-private.h"
 #include "clutter-shader.h"
+#include "clutter-shader-program.h"
+#include "clutter-shader-types.h"
 
 /* global list of shaders */
 static GList *clutter_shaders_list = NULL;
@@ -73,12 +80,32 @@ struct _ClutterShaderPrivate
   gchar      *vertex_source;        /* GLSL source for vertex shader */
   gchar      *fragment_source;      /* GLSL source for fragment shader */
 
+  /* the program shared by the shaders using the same sources */
+  ClutterShaderProgram *shared;
+
+  /* owned by the shared program */
   CoglHandle  program;
 
   CoglHandle  vertex_shader;
   CoglHandle  fragment_shader;
+
+  /* the values of the uniforms, set on the program when the shader
+   * is enabled; a #GHashTable of ShaderUniform */
+  GHashTable *uniforms;
 };
 
+typedef struct _ShaderUniform
+{
+  gchar *name;
+  GValue value;
+
+  /* -1 until looked up in the program */
+  GLint location;
+
+  /* whether the value has to be set on the program */
+  guint is_dirty : 1;
+} ShaderUniform;
+
 enum
 {
   PROP_0,
@@ -95,6 +122,42 @@ static GParamSpec *obj_props[PROP_LAST];
 
 G_DEFINE_TYPE (ClutterShader, clutter_shader, G_TYPE_OBJECT);
 
+static void
+shader_uniform_free (gpointer data)
+{
+  ShaderUniform *uniform = data;
+
+  g_value_unset (&uniform->value);
+  g_free (uniform->name);
+
+  g_slice_free (ShaderUniform, uniform);
+}
+
+/* marks the uniforms of @shader as not set on the program; if
+ * @reset_locations is %TRUE the program is going away, and the
+ * locations have to be looked up again in the next one */
+static void
+clutter_shader_invalidate_uniforms (ClutterShader *shader,
+                                    gboolean       reset_locations)
+{
+  GHashTableIter iter;
+  gpointer value;
+
+  if (shader->priv->uniforms == NULL)
+    return;
+
+  g_hash_table_iter_init (&iter, shader->priv->uniforms);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      ShaderUniform *uniform = value;
+
+      uniform->is_dirty = TRUE;
+
+      if (reset_locations)
+        uniform->location = -1;
+    }
+}
+
 static inline void
 clutter_shader_release_internal (ClutterShader *shader)
 {
@@ -103,16 +166,13 @@ clutter_shader_release_internal (ClutterShader *shader)
   if (!priv->compiled)
     return;
 
-  g_assert (priv->program != COGL_INVALID_HANDLE);
-
-  if (priv->vertex_is_glsl && priv->vertex_shader != COGL_INVALID_HANDLE)
-    cogl_handle_unref (priv->vertex_shader);
+  g_assert (priv->shared != NULL);
 
-  if (priv->fragment_is_glsl && priv->fragment_shader != COGL_INVALID_HANDLE)
-    cogl_handle_unref (priv->fragment_shader);
+  _clutter_shader_program_forget_user (priv->shared, shader);
+  _clutter_shader_program_release (priv->shared);
+  priv->shared = NULL;
 
-  if (priv->program != COGL_INVALID_HANDLE)
-    cogl_handle_unref (priv->program);
+  clutter_shader_invalidate_uniforms (shader, TRUE);
 
   priv->vertex_shader = COGL_INVALID_HANDLE;
   priv->fragment_shader = COGL_INVALID_HANDLE;
@@ -134,6 +194,9 @@ clutter_shader_finalize (GObject *object)
   g_free (priv->fragment_source);
   g_free (priv->vertex_source);
 
+  if (priv->uniforms != NULL)
+    g_hash_table_destroy (priv->uniforms);
+
   G_OBJECT_CLASS (clutter_shader_parent_class)->finalize (object);
 }
 
@@ -144,7 +207,7 @@ clutter_shader_dispose (GObject *object)
 
   clutter_shader_release_internal (shader);
 
-  G_OBJECT_CLASS (clutter_shader_parent_class)->finalize (object);
+  G_OBJECT_CLASS (clutter_shader_parent_class)->dispose (object);
 }
 
 static void
@@ -458,98 +521,35 @@ clutter_shader_get_cogl_shader (ClutterShader     *shader,
   return COGL_INVALID_HANDLE;
 }
 
-static gboolean
-clutter_shader_glsl_bind (ClutterShader      *self,
-                          ClutterShaderType   shader_type,
-                          GError            **error)
-{
-  ClutterShaderPrivate *priv = self->priv;
-  CoglHandle shader = COGL_INVALID_HANDLE;
-
-  switch (shader_type)
-    {
-    case CLUTTER_VERTEX_SHADER:
-      shader = cogl_create_shader (COGL_SHADER_TYPE_VERTEX);
-      cogl_shader_source (shader, priv->vertex_source);
-
-      priv->vertex_shader = shader;
-      break;
-
-    case CLUTTER_FRAGMENT_SHADER:
-      shader = cogl_create_shader (COGL_SHADER_TYPE_FRAGMENT);
-      cogl_shader_source (shader, priv->fragment_source);
-
-      priv->fragment_shader = shader;
-      break;
-    }
-
-  g_assert (shader != COGL_INVALID_HANDLE);
-
-  cogl_shader_compile (shader);
-  if (!cogl_shader_is_compiled (shader))
-    {
-      gchar *log_buf;
-
-      log_buf = cogl_shader_get_info_log (shader);
-
-      /* translators: the first %s is the type of the shader, either
-       * Vertex shader or Fragment shader; the second %s is the actual
-       * error as reported by COGL
-       */
-      g_set_error (error, CLUTTER_SHADER_ERROR,
-                   CLUTTER_SHADER_ERROR_COMPILE,
-                   _("%s compilation failed: %s"),
-                   shader_type == CLUTTER_VERTEX_SHADER ? _("Vertex shader")
-                                                        : _("Fragment shader"),
-                   log_buf);
-
-      g_free (log_buf);
-
-      return FALSE;
-    }
-
-  cogl_program_attach_shader (priv->program, shader);
-
-  return TRUE;
-}
-
 static gboolean
 bind_glsl_shader (ClutterShader  *self,
                   GError        **error)
 {
   ClutterShaderPrivate *priv = self->priv;
-  GError *bind_error = NULL;
-  gboolean res;
-
-  priv->program = cogl_create_program ();
+  const gchar *vertex_source = NULL;
+  const gchar *fragment_source = NULL;
 
   if (priv->vertex_is_glsl && priv->vertex_source != COGL_INVALID_HANDLE)
-    {
-      res = clutter_shader_glsl_bind (self,
-                                      CLUTTER_VERTEX_SHADER,
-                                      &bind_error);
-
-      if (!res)
-        {
-          g_propagate_error (error, bind_error);
-          return FALSE;
-        }
-    }
+    vertex_source = priv->vertex_source;
 
   if (priv->fragment_is_glsl && priv->fragment_source != COGL_INVALID_HANDLE)
+    fragment_source = priv->fragment_source;
+
+  /* the shaders using the same sources share the compiled program */
+  priv->shared = _clutter_shader_program_acquire (vertex_source,
+                                                  fragment_source);
+
+  if (!_clutter_shader_program_ensure_compiled (priv->shared, error))
     {
-      res = clutter_shader_glsl_bind (self,
-                                      CLUTTER_FRAGMENT_SHADER,
-                                      &bind_error);
+      _clutter_shader_program_release (priv->shared);
+      priv->shared = NULL;
 
-      if (!res)
-        {
-          g_propagate_error (error, bind_error);
-          return FALSE;
-        }
+      return FALSE;
     }
 
-  cogl_program_link (priv->program);
+  priv->program = priv->shared->program;
+  priv->vertex_shader = priv->shared->vertex_shader;
+  priv->fragment_shader = priv->shared->fragment_shader;
 
   return TRUE;
 }
@@ -644,6 +644,133 @@ clutter_shader_is_compiled (ClutterShader *shader)
   return shader->priv->compiled;
 }
 
+static gboolean
+shader_uniform_value_equal (const GValue *a,
+                            const GValue *b)
+{
+  gsize size_a, size_b;
+
+  if (G_VALUE_TYPE (a) != G_VALUE_TYPE (b))
+    return FALSE;
+
+  if (CLUTTER_VALUE_HOLDS_SHADER_FLOAT (a))
+    {
+      const GLfloat *floats_a = clutter_value_get_shader_float (a, &size_a);
+      const GLfloat *floats_b = clutter_value_get_shader_float (b, &size_b);
+
+      return size_a == size_b &&
+             memcmp (floats_a, floats_b, size_a * sizeof (GLfloat)) == 0;
+    }
+  else if (CLUTTER_VALUE_HOLDS_SHADER_INT (a))
+    {
+      const int *ints_a = clutter_value_get_shader_int (a, &size_a);
+      const int *ints_b = clutter_value_get_shader_int (b, &size_b);
+
+      return size_a == size_b &&
+             memcmp (ints_a, ints_b, size_a * sizeof (int)) == 0;
+    }
+  else if (CLUTTER_VALUE_HOLDS_SHADER_MATRIX (a))
+    {
+      const GLfloat *matrix_a = clutter_value_get_shader_matrix (a, &size_a);
+      const GLfloat *matrix_b = clutter_value_get_shader_matrix (b, &size_b);
+
+      return size_a == size_b &&
+             memcmp (matrix_a, matrix_b,
+                     size_a * size_a * sizeof (GLfloat)) == 0;
+    }
+  else if (G_VALUE_HOLDS_FLOAT (a))
+    return g_value_get_float (a) == g_value_get_float (b);
+  else if (G_VALUE_HOLDS_INT (a))
+    return g_value_get_int (a) == g_value_get_int (b);
+
+  return FALSE;
+}
+
+static void
+clutter_shader_upload_uniform (ClutterShader *shader,
+                               ShaderUniform *uniform)
+{
+  ClutterShaderPrivate *priv = shader->priv;
+  const GValue *value = &uniform->value;
+  gsize size;
+
+  if (uniform->location == -1)
+    uniform->location = cogl_program_get_uniform_location (priv->program,
+                                                           uniform->name);
+
+  if (CLUTTER_VALUE_HOLDS_SHADER_FLOAT (value))
+    {
+      const GLfloat *floats;
+
+      floats = clutter_value_get_shader_float (value, &size);
+      cogl_program_set_uniform_float (priv->program,
+                                      uniform->location, size, 1, floats);
+    }
+  else if (CLUTTER_VALUE_HOLDS_SHADER_INT (value))
+    {
+      const int *ints;
+
+      ints = clutter_value_get_shader_int (value, &size);
+      cogl_program_set_uniform_int (priv->program,
+                                    uniform->location, size, 1, ints);
+    }
+  else if (CLUTTER_VALUE_HOLDS_SHADER_MATRIX (value))
+    {
+      const GLfloat *matrix;
+
+      matrix = clutter_value_get_shader_matrix (value, &size);
+      cogl_program_set_uniform_matrix (priv->program,
+                                       uniform->location, size, 1, FALSE,
+                                       matrix);
+    }
+  else if (G_VALUE_HOLDS_FLOAT (value))
+    {
+      GLfloat float_val = g_value_get_float (value);
+
+      cogl_program_set_uniform_float (priv->program,
+                                      uniform->location, 1, 1, &float_val);
+    }
+  else if (G_VALUE_HOLDS_INT (value))
+    {
+      int int_val = g_value_get_int (value);
+
+      cogl_program_set_uniform_int (priv->program,
+                                    uniform->location, 1, 1, &int_val);
+    }
+  else
+    g_assert_not_reached ();
+
+  uniform->is_dirty = FALSE;
+}
+
+/* sets the values of the uniforms of @shader that changed on the
+ * program; the program might be shared with other shaders, in which
+ * case all the values are set again if another shader used it last */
+static void
+clutter_shader_flush_uniforms (ClutterShader *shader)
+{
+  ClutterShaderPrivate *priv = shader->priv;
+  GHashTableIter iter;
+  gpointer value;
+
+  g_assert (priv->compiled);
+
+  if (_clutter_shader_program_set_last_user (priv->shared, shader))
+    clutter_shader_invalidate_uniforms (shader, FALSE);
+
+  if (priv->uniforms == NULL)
+    return;
+
+  g_hash_table_iter_init (&iter, priv->uniforms);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      ShaderUniform *uniform = value;
+
+      if (uniform->is_dirty)
+        clutter_shader_upload_uniform (shader, uniform);
+    }
+}
+
 /**
  * clutter_shader_set_is_enabled:
  * @shader: a #ClutterShader
@@ -686,7 +813,10 @@ clutter_shader_set_is_enabled (ClutterShader *shader,
       priv->is_enabled = enabled;
 
       if (priv->is_enabled)
-        cogl_program_use (priv->program);
+        {
+          clutter_shader_flush_uniforms (shader);
+          cogl_program_use (priv->program);
+        }
       else
         cogl_program_use (COGL_INVALID_HANDLE);
 
@@ -730,8 +860,7 @@ clutter_shader_set_uniform (ClutterShader *shader,
                             const GValue  *value)
 {
   ClutterShaderPrivate *priv;
-  GLint                 location = 0;
-  gsize                 size;
+  ShaderUniform *uniform;
 
   g_return_if_fail (CLUTTER_IS_SHADER (shader));
   g_return_if_fail (name != NULL);
@@ -745,48 +874,40 @@ clutter_shader_set_uniform (ClutterShader *shader,
   priv = shader->priv;
   g_return_if_fail (priv->program != COGL_INVALID_HANDLE);
 
-  location = cogl_program_get_uniform_location (priv->program, name);
+  if (priv->uniforms == NULL)
+    priv->uniforms = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                            NULL,
+                                            shader_uniform_free);
 
-  if (CLUTTER_VALUE_HOLDS_SHADER_FLOAT (value))
+  uniform = g_hash_table_lookup (priv->uniforms, name);
+  if (uniform == NULL)
     {
-      const GLfloat *floats;
+      uniform = g_slice_new0 (ShaderUniform);
+      uniform->name = g_strdup (name);
+      uniform->location = -1;
 
-      floats = clutter_value_get_shader_float (value, &size);
-      cogl_program_set_uniform_float (priv->program,
-                                      location, size, 1, floats);
+      g_hash_table_insert (priv->uniforms, uniform->name, uniform);
     }
-  else if (CLUTTER_VALUE_HOLDS_SHADER_INT (value))
+  else if (shader_uniform_value_equal (&uniform->value, value))
     {
-      const int *ints;
-
-      ints = clutter_value_get_shader_int (value, &size);
-      cogl_program_set_uniform_int (priv->program,
-                                    location, size, 1, ints);
+      /* actors sharing the shader set their parameters on each paint,
+       * but they usually do not change between paints */
+      if (!uniform->is_dirty &&
+          priv->shared->last_user == (gconstpointer) shader)
+        return;
     }
-  else if (CLUTTER_VALUE_HOLDS_SHADER_MATRIX (value))
-    {
-      const GLfloat *matrix;
+  else
+    g_value_unset (&uniform->value);
 
-      matrix = clutter_value_get_shader_matrix (value, &size);
-      cogl_program_set_uniform_matrix (priv->program,
-                                       location, size, 1, FALSE, matrix);
-    }
-  else if (G_VALUE_HOLDS_FLOAT (value))
+  if (!G_IS_VALUE (&uniform->value))
     {
-      GLfloat float_val = g_value_get_float (value);
-
-      cogl_program_set_uniform_float (priv->program,
-                                      location, 1, 1, &float_val);
+      g_value_init (&uniform->value, G_VALUE_TYPE (value));
+      g_value_copy (value, &uniform->value);
     }
-  else if (G_VALUE_HOLDS_INT (value))
-    {
-      int int_val = g_value_get_int (value);
 
-      cogl_program_set_uniform_int (priv->program,
-                                    location, 1, 1, &int_val);
-    }
-  else
-    g_assert_not_reached ();
+  uniform->is_dirty = TRUE;
+
+  clutter_shader_flush_uniforms (shader);
 }
 
 /*
@@ -64,6 +64,13 @@ struct _ClutterSnapConstraint
   ClutterSnapEdge to_edge;
 
   gfloat offset;
+
+  /* the result of the last evaluation, valid while the allocation of
+   * the source has the same serial and the constrained actor gets the
+   * same allocation */
+  guint source_serial;
+  ClutterActorBox last_box;
+  ClutterActorBox last_result;
 };
 
 struct _ClutterSnapConstraintClass
@@ -137,10 +144,23 @@ clutter_snap_constraint_update_allocation (ClutterConstraint *constraint,
   gfloat source_width, source_height;
   gfloat source_x, source_y;
   gfloat actor_width, actor_height;
+  ClutterActorBox box;
+  guint serial;
 
   if (self->source == NULL)
     return;
 
+  serial = _clutter_actor_get_allocation_serial (self->source);
+  if (serial != 0 &&
+      serial == self->source_serial &&
+      clutter_actor_box_equal (allocation, &self->last_box))
+    {
+      *allocation = self->last_result;
+      return;
+    }
+
+  box = *allocation;
+
   clutter_actor_get_position (self->source, &source_x, &source_y);
   clutter_actor_get_size (self->source, &source_width, &source_height);
 
@@ -196,6 +216,10 @@ clutter_snap_constraint_update_allocation (ClutterConstraint *constraint,
 
   if (allocation->y2 - allocation->y1 < 0)
     allocation->y2 = allocation->y1;
+
+  self->source_serial = serial;
+  self->last_box = box;
+  self->last_result = *allocation;
 }
 
 static void
@@ -451,6 +475,8 @@ clutter_snap_constraint_set_source (ClutterSnapConstraint *constraint,
     }
 
   constraint->source = source;
+  constraint->source_serial = 0;
+
   if (constraint->source != NULL)
     {
       g_signal_connect (constraint->source, "queue-relayout",
@@ -526,10 +552,12 @@ clutter_snap_constraint_set_edges (ClutterSnapConstraint *constraint,
       to_changed = TRUE;
     }
 
-  if ((from_changed || to_changed) &&
-      constraint->actor != NULL)
+  if (from_changed || to_changed)
     {
-      clutter_actor_queue_relayout (constraint->actor);
+      constraint->source_serial = 0;
+
+      if (constraint->actor != NULL)
+        clutter_actor_queue_relayout (constraint->actor);
     }
 
   g_object_thaw_notify (G_OBJECT (constraint));
@@ -578,6 +606,7 @@ clutter_snap_constraint_set_offset (ClutterSnapConstraint *constraint,
     return;
 
   constraint->offset = offset;
+  constraint->source_serial = 0;
 
   if (constraint->actor != NULL)
     clutter_actor_queue_relayout (constraint->actor);
@@ -34,6 +34,15 @@ struct _ClutterStageManager
   GObject parent_instance;
 
   GSList *stages;
+
+  /* a copy of @stages, holding a reference on each stage, which the
+   * master clock iterates on each frame; it is rebuilt only after
+   * the list of stages changes, and the stages removed while it is
+   * being iterated are released once the iteration ends
+   */
+  GPtrArray *snapshot;
+  guint snapshot_valid : 1;
+  guint n_iterations;
 };
 
 /* stage manager */
@@ -44,6 +53,10 @@ void _clutter_stage_manager_remove_stage      (ClutterStageManager *stage_manage
 void _clutter_stage_manager_set_default_stage (ClutterStageManager *stage_manager,
                                                ClutterStage        *stage);
 
+ClutterStage * const *_clutter_stage_manager_begin_iteration (ClutterStageManager *stage_manager,
+                                                              guint               *n_stages);
+void                  _clutter_stage_manager_end_iteration   (ClutterStageManager *stage_manager);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_STAGE_MANAGER_PRIVATE_H__ */
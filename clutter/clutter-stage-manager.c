@@ -66,6 +66,29 @@ static ClutterStage *default_stage = NULL;
 
 G_DEFINE_TYPE (ClutterStageManager, clutter_stage_manager, G_TYPE_OBJECT);
 
+/* releases the references held by the snapshot of the stages */
+static void
+clutter_stage_manager_clear_snapshot (ClutterStageManager *stage_manager)
+{
+  GPtrArray *snapshot = stage_manager->snapshot;
+  guint i;
+
+  for (i = 0; i < snapshot->len; i++)
+    g_object_unref (g_ptr_array_index (snapshot, i));
+
+  g_ptr_array_set_size (snapshot, 0);
+}
+
+static void
+clutter_stage_manager_invalidate_snapshot (ClutterStageManager *stage_manager)
+{
+  stage_manager->snapshot_valid = FALSE;
+
+  /* the stages are kept alive until the iteration is over */
+  if (stage_manager->n_iterations == 0)
+    clutter_stage_manager_clear_snapshot (stage_manager);
+}
+
 static void
 clutter_stage_manager_get_property (GObject    *gobject,
                                     guint       prop_id,
@@ -94,6 +117,13 @@ clutter_stage_manager_dispose (GObject *gobject)
   g_slist_free (stage_manager->stages);
   stage_manager->stages = NULL;
 
+  if (stage_manager->snapshot != NULL)
+    {
+      clutter_stage_manager_clear_snapshot (stage_manager);
+      g_ptr_array_free (stage_manager->snapshot, TRUE);
+      stage_manager->snapshot = NULL;
+    }
+
   G_OBJECT_CLASS (clutter_stage_manager_parent_class)->dispose (gobject);
 }
 
@@ -163,6 +193,7 @@ clutter_stage_manager_class_init (ClutterStageManagerClass *klass)
 static void
 clutter_stage_manager_init (ClutterStageManager *stage_manager)
 {
+  stage_manager->snapshot = g_ptr_array_new ();
 }
 
 /**
@@ -297,6 +328,8 @@ _clutter_stage_manager_add_stage (ClutterStageManager *stage_manager,
 
   stage_manager->stages = g_slist_append (stage_manager->stages, stage);
 
+  clutter_stage_manager_invalidate_snapshot (stage_manager);
+
   g_signal_emit (stage_manager, manager_signals[STAGE_ADDED], 0, stage);
 }
 
@@ -312,6 +345,8 @@ _clutter_stage_manager_remove_stage (ClutterStageManager *stage_manager,
 
   stage_manager->stages = g_slist_remove (stage_manager->stages, stage);
 
+  clutter_stage_manager_invalidate_snapshot (stage_manager);
+
   /* if it's the default stage, get the first available from the list */
   if (default_stage == stage)
     default_stage = stage_manager->stages ? stage_manager->stages->data
@@ -321,3 +356,61 @@ _clutter_stage_manager_remove_stage (ClutterStageManager *stage_manager,
 
   g_object_unref (stage);
 }
+
+/*< private >
+ * _clutter_stage_manager_begin_iteration:
+ * @stage_manager: a #ClutterStageManager
+ * @n_stages: (out): return location for the number of stages
+ *
+ * Retrieves a snapshot of the stages handled by @stage_manager, which
+ * stays valid, and keeps every stage in it alive, until the matching
+ * call to _clutter_stage_manager_end_iteration(), even if stages are
+ * added or destroyed in the meantime.
+ *
+ * The snapshot is only rebuilt after the list of stages changes, so
+ * iterating it on each frame does not copy or reference the stages.
+ *
+ * Return value: (transfer none): an array of @n_stages stages
+ */
+ClutterStage * const *
+_clutter_stage_manager_begin_iteration (ClutterStageManager *stage_manager,
+                                        guint               *n_stages)
+{
+  GPtrArray *snapshot = stage_manager->snapshot;
+
+  if (!stage_manager->snapshot_valid && stage_manager->n_iterations == 0)
+    {
+      GSList *l;
+
+      clutter_stage_manager_clear_snapshot (stage_manager);
+
+      for (l = stage_manager->stages; l != NULL; l = l->next)
+        g_ptr_array_add (snapshot, g_object_ref (l->data));
+
+      stage_manager->snapshot_valid = TRUE;
+    }
+
+  stage_manager->n_iterations += 1;
+
+  *n_stages = snapshot->len;
+
+  return (ClutterStage * const *) snapshot->pdata;
+}
+
+/*< private >
+ * _clutter_stage_manager_end_iteration:
+ * @stage_manager: a #ClutterStageManager
+ *
+ * Ends an iteration started with _clutter_stage_manager_begin_iteration(),
+ * releasing the stages that were removed while it was in progress.
+ */
+void
+_clutter_stage_manager_end_iteration (ClutterStageManager *stage_manager)
+{
+  g_return_if_fail (stage_manager->n_iterations > 0);
+
+  stage_manager->n_iterations -= 1;
+
+  if (stage_manager->n_iterations == 0 && !stage_manager->snapshot_valid)
+    clutter_stage_manager_clear_snapshot (stage_manager);
+}
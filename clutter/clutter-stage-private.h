@@ -32,6 +32,109 @@
 G_BEGIN_DECLS
 
 typedef struct _ClutterStageQueueRedrawEntry ClutterStageQueueRedrawEntry;
+typedef struct _ClutterStageIndexNode        ClutterStageIndexNode;
+
+/*< private >
+ * ClutterStageIndexNode:
+ * @stage: the stage the node is indexed in, or %NULL
+ * @box: the screen-space box of the node
+ * @query_stamp: the stamp of the last query that matched the node
+ *
+ * A node in the spatial index of a #ClutterStage; the storage is owned
+ * by the actor that is indexed.
+ */
+struct _ClutterStageIndexNode
+{
+  ClutterStage *stage;
+
+  ClutterActorBox box;
+
+  guint query_stamp;
+
+  /*< private >*/
+  gint x1, y1, x2, y2;
+};
+
+/* the maximum number of disjoint rectangles a stage window keeps
+ * track of before merging them */
+#define CLUTTER_STAGE_MAX_REDRAW_CLIPS  4
+
+typedef struct _ClutterStageRedrawClips ClutterStageRedrawClips;
+
+/*< private >
+ * ClutterStageRedrawClips:
+ * @rects: disjoint rectangles that need to be redrawn, in window
+ *   coordinates
+ * @n_rects: the number of rectangles in @rects
+ *
+ * A bounded list of damaged areas, used by the stage windows that
+ * support clipped redraws.
+ */
+struct _ClutterStageRedrawClips
+{
+  ClutterGeometry rects[CLUTTER_STAGE_MAX_REDRAW_CLIPS];
+  guint n_rects;
+};
+
+/* the number of past frames a stage window remembers the damage of;
+ * back buffers older than this are always fully redrawn */
+#define CLUTTER_STAGE_DAMAGE_HISTORY_LENGTH     4
+
+typedef struct _ClutterStageDamageHistory ClutterStageDamageHistory;
+
+/*< private >
+ * ClutterStageDamageHistory:
+ * @frames: ring buffer of the damage of the last frames; a frame with
+ *   no rectangles was a full stage redraw
+ * @head: the position of the most recent frame inside @frames
+ * @n_frames: the number of valid entries in @frames
+ *
+ * The damage of the last presented frames, used by the stage windows
+ * that can query the age of the back buffer to work out which areas
+ * of a recycled buffer are out of date.
+ */
+struct _ClutterStageDamageHistory
+{
+  ClutterStageRedrawClips frames[CLUTTER_STAGE_DAMAGE_HISTORY_LENGTH];
+  guint head;
+  guint n_frames;
+};
+
+typedef struct _ClutterStageOffscreen ClutterStageOffscreen;
+
+/*< private >
+ * ClutterStageOffscreen:
+ * @texture: the texture used as the render target
+ * @framebuffer: an offscreen framebuffer rendering to @texture
+ * @width: the width of @texture
+ * @height: the height of @texture
+ * @format: the pixel format of @texture
+ *
+ * An offscreen render target borrowed from the pool of a #ClutterStage.
+ * The size of the texture is rounded up, so that the same target can
+ * be reused for slightly different sizes.
+ */
+struct _ClutterStageOffscreen
+{
+  CoglHandle texture;
+  CoglHandle framebuffer;
+
+  gint width;
+  gint height;
+
+  CoglPixelFormat format;
+
+  /*< private >*/
+  guint release_serial;
+
+  /* the user whose image is still in the target, if any */
+  gpointer owner;
+};
+
+/* Checks whether the node could match the query identified by @stamp;
+ * nodes that are not indexed always could */
+#define _clutter_stage_index_node_may_match(node,stamp) \
+  ((stamp) == 0 || (node)->stage == NULL || (node)->query_stamp == (stamp))
 
 /* stage */
 ClutterStageWindow *_clutter_stage_get_default_window    (void);
@@ -56,6 +159,12 @@ void                _clutter_stage_get_viewport          (ClutterStage
 void                _clutter_stage_dirty_viewport        (ClutterStage          *stage);
 void                _clutter_stage_maybe_setup_viewport  (ClutterStage          *stage);
 void                _clutter_stage_maybe_relayout        (ClutterActor          *stage);
+void                _clutter_stage_queue_boundary_relayout (ClutterStage        *stage,
+                                                            ClutterActor        *actor);
+void                _clutter_stage_queue_text_prefetch   (ClutterStage          *stage,
+                                                          ClutterActor          *text);
+void                _clutter_stage_queue_geometry_change (ClutterStage          *stage,
+                                                          ClutterActor          *actor);
 gboolean            _clutter_stage_needs_update          (ClutterStage          *stage);
 gboolean            _clutter_stage_do_update             (ClutterStage          *stage);
 
@@ -65,17 +174,51 @@ gboolean _clutter_stage_has_queued_events                 (ClutterStage *stage);
 void     _clutter_stage_process_queued_events             (ClutterStage *stage);
 void     _clutter_stage_update_input_devices              (ClutterStage *stage);
 int      _clutter_stage_get_pending_swaps                 (ClutterStage *stage);
+gboolean _clutter_stage_has_free_back_buffer              (ClutterStage *stage);
+void     _clutter_stage_presented                         (ClutterStage *stage,
+                                                           gint64        presentation_time);
+gint64   _clutter_stage_get_refresh_interval              (ClutterStage *stage);
+void     _clutter_stage_add_timeline_time                 (ClutterStage *stage,
+                                                           gint64        timeline_time);
+void     _clutter_stage_add_swap_time                     (ClutterStage *stage,
+                                                           gint64        swap_time);
+
+gboolean _clutter_stage_tracks_redraw_causes              (void);
+void     _clutter_stage_add_redraw_cause                  (ClutterStage *stage,
+                                                           ClutterActor *actor,
+                                                           gpointer      caller,
+                                                           gboolean      relayout);
 gboolean _clutter_stage_has_full_redraw_queued            (ClutterStage *stage);
+guint    _clutter_stage_get_queue_redraw_stamp            (ClutterStage *stage);
+void     _clutter_stage_add_overdraw_box                  (ClutterStage          *stage,
+                                                           const ClutterActorBox *box);
 
 ClutterActor *_clutter_stage_do_pick (ClutterStage    *stage,
                                       gint             x,
                                       gint             y,
                                       ClutterPickMode  mode);
+guint         _clutter_stage_get_scene_serial (ClutterStage *stage);
+void          _clutter_stage_invalidate_pick (ClutterStage *stage);
+guint         _clutter_stage_get_projection_serial (ClutterStage *stage);
+
+gpointer _clutter_stage_frame_alloc (ClutterStage *stage,
+                                     gsize         size);
+void     _clutter_stage_frame_reset (ClutterStage *stage);
+
+#define _clutter_stage_frame_new(stage,struct_type,n_structs) \
+  ((struct_type *) _clutter_stage_frame_alloc ((stage), \
+                                               sizeof (struct_type) * (n_structs)))
 
-ClutterPaintVolume *_clutter_stage_paint_volume_stack_allocate (ClutterStage *stage);
-void                _clutter_stage_paint_volume_stack_free_all (ClutterStage *stage);
+void                _clutter_stage_set_covering_actor (ClutterStage   *stage,
+                                                       ClutterActor   *actor,
+                                                       gboolean        is_topmost);
+void                _clutter_stage_set_clear_area     (ClutterStage          *stage,
+                                                       const ClutterGeometry *area);
+ClutterActor *      _clutter_stage_get_scanout_actor  (ClutterStage   *stage);
 
-const ClutterPlane *_clutter_stage_get_clip (ClutterStage *stage);
+const ClutterPlane *_clutter_stage_get_clip          (ClutterStage    *stage);
+void                _clutter_stage_get_clip_geometry (ClutterStage    *stage,
+                                                      ClutterGeometry *clip);
 
 ClutterStageQueueRedrawEntry *_clutter_stage_queue_actor_redraw            (ClutterStage                 *stage,
                                                                             ClutterStageQueueRedrawEntry *entry,
@@ -96,6 +239,29 @@ gboolean _clutter_stage_get_motion_events_enabled (ClutterStage *stage);
 
 CoglFramebuffer *_clutter_stage_get_active_framebuffer (ClutterStage *stage);
 
+void            _clutter_stage_redraw_clips_add         (ClutterStageRedrawClips       *clips,
+                                                         const ClutterGeometry         *clip);
+void            _clutter_stage_redraw_clips_simplify    (ClutterStageRedrawClips       *clips,
+                                                         const ClutterGeometry         *bounding_clip);
+void            _clutter_stage_paint_redraw_clips       (ClutterStage                  *stage,
+                                                         const ClutterStageRedrawClips *clips);
+
+void            _clutter_stage_damage_history_reset     (ClutterStageDamageHistory       *history);
+void            _clutter_stage_damage_history_record    (ClutterStageDamageHistory       *history,
+                                                         const ClutterStageRedrawClips   *clips);
+gboolean        _clutter_stage_damage_history_accumulate (const ClutterStageDamageHistory *history,
+                                                          gint                             buffer_age,
+                                                          ClutterStageRedrawClips         *clips,
+                                                          ClutterGeometry                 *bounding_clip);
+
+void            _clutter_stage_index_update             (ClutterStage          *stage,
+                                                         ClutterStageIndexNode *node,
+                                                         const ClutterActorBox *box);
+void            _clutter_stage_index_node_remove        (ClutterStageIndexNode *node);
+guint           _clutter_stage_index_query_point        (ClutterStage          *stage,
+                                                         gfloat                 x,
+                                                         gfloat                 y);
+
 gint32          _clutter_stage_acquire_pick_id          (ClutterStage *stage,
                                                          ClutterActor *actor);
 void            _clutter_stage_release_pick_id          (ClutterStage *stage,
@@ -103,6 +269,21 @@ void            _clutter_stage_release_pick_id          (ClutterStage *stage,
 ClutterActor *  _clutter_stage_get_actor_by_pick_id     (ClutterStage *stage,
                                                          gint32        pick_id);
 
+ClutterStageOffscreen * _clutter_stage_acquire_offscreen (ClutterStage          *stage,
+                                                          gint                   width,
+                                                          gint                   height,
+                                                          CoglPixelFormat        format);
+void                    _clutter_stage_release_offscreen (ClutterStage          *stage,
+                                                          ClutterStageOffscreen *offscreen,
+                                                          gpointer               owner);
+ClutterStageOffscreen * _clutter_stage_reclaim_offscreen (ClutterStage          *stage,
+                                                          gpointer               owner,
+                                                          gint                   width,
+                                                          gint                   height,
+                                                          CoglPixelFormat        format);
+void                    _clutter_stage_offscreen_free    (ClutterStageOffscreen *offscreen);
+void                    _clutter_stage_release_offscreen_pool (ClutterStage *stage);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_STAGE_PRIVATE_H__ */
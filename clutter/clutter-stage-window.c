@@ -212,3 +212,41 @@ _clutter_stage_window_get_active_framebuffer (ClutterStageWindow *window)
   else
     return NULL;
 }
+
+/* Retrieves the age of the back buffer the next frame will be drawn
+ * into: 1 means it holds the previous frame, 2 the frame before that
+ * and so on. A return value of 0 means the contents of the back buffer
+ * are undefined, or that the window system cannot tell.
+ */
+int
+_clutter_stage_window_get_buffer_age (ClutterStageWindow *window)
+{
+  ClutterStageWindowIface *iface;
+
+  g_return_val_if_fail (CLUTTER_IS_STAGE_WINDOW (window), 0);
+
+  iface = CLUTTER_STAGE_WINDOW_GET_IFACE (window);
+  if (iface->get_buffer_age)
+    return iface->get_buffer_age (window);
+  else
+    return 0;
+}
+
+/* Retrieves the number of back buffers the window system cycles
+ * through, that is how many frames can be drawn before having to wait
+ * for a swap to complete. Backends that cannot tell are assumed to be
+ * double buffered.
+ */
+int
+_clutter_stage_window_get_swap_chain_depth (ClutterStageWindow *window)
+{
+  ClutterStageWindowIface *iface;
+
+  g_return_val_if_fail (CLUTTER_IS_STAGE_WINDOW (window), 1);
+
+  iface = CLUTTER_STAGE_WINDOW_GET_IFACE (window);
+  if (iface->get_swap_chain_depth)
+    return MAX (iface->get_swap_chain_depth (window), 1);
+  else
+    return 1;
+}
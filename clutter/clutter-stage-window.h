@@ -71,6 +71,9 @@ struct _ClutterStageWindowIface
   void              (* redraw)                  (ClutterStageWindow *stage_window);
 
   CoglFramebuffer  *(* get_active_framebuffer)  (ClutterStageWindow *stage_window);
+
+  int               (* get_buffer_age)          (ClutterStageWindow *stage_window);
+  int               (* get_swap_chain_depth)    (ClutterStageWindow *stage_window);
 };
 
 GType clutter_stage_window_get_type (void) G_GNUC_CONST;
@@ -112,6 +115,9 @@ void              _clutter_stage_window_redraw                  (ClutterStageWin
 
 CoglFramebuffer  *_clutter_stage_window_get_active_framebuffer  (ClutterStageWindow *window);
 
+int               _clutter_stage_window_get_buffer_age          (ClutterStageWindow *window);
+int               _clutter_stage_window_get_swap_chain_depth    (ClutterStageWindow *window);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_STAGE_WINDOW_H__ */
@@ -53,6 +53,14 @@
 #include "config.h"
 #endif
 
+/* dladdr() is a GNU extension */
+#ifdef HAVE_DLADDR
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#endif
+
+#include <string.h>
+
 #include <cairo/cairo.h>
 
 #include "clutter-stage.h"
@@ -70,11 +78,13 @@
 #include "clutter-main.h"
 #include "clutter-marshal.h"
 #include "clutter-master-clock.h"
+#include "clutter-offscreen-effect-private.h"
 #include "clutter-paint-volume-private.h"
 #include "clutter-private.h"
 #include "clutter-profile.h"
 #include "clutter-stage-manager-private.h"
 #include "clutter-stage-private.h"
+#include "clutter-texture.h"
 #include "clutter-util.h"
 #include "clutter-version.h" 	/* For flavour */
 #include "clutter-private.h"
@@ -119,6 +129,74 @@ struct _ClutterStageQueueRedrawEntry
   ClutterPaintVolume clip;
 };
 
+typedef struct _ClutterStagePickResult
+{
+  ClutterPickMode mode;
+  gint x;
+  gint y;
+
+  /* the scene serial of the stage at the time of the pick */
+  guint scene_serial;
+
+  /* the pick id of the actor, or -1 for the stage */
+  gint32 pick_id;
+
+  /* the generation of the pick id pool when the id was read */
+  guint32 pick_generation;
+} ClutterStagePickResult;
+
+typedef struct _ClutterStageAsyncPick
+{
+  ClutterStagePickResult result;
+
+  /* the update serial of the stage when the pick was requested */
+  guint update_serial;
+
+  /* the pixel buffer the pick is read back into, or 0 if the
+   * result is already known */
+  guint pbo;
+
+  ClutterStagePickFunc func;
+  gpointer user_data;
+  GDestroyNotify notify;
+} ClutterStageAsyncPick;
+
+/* a rectangle of a frame being read back for an asynchronous capture */
+typedef struct _ClutterStageCaptureRect
+{
+  ClutterGeometry area;
+
+  /* the pixel buffer the rectangle is read back into, or 0 if the
+   * pixels were read synchronously into @pixels */
+  guint pbo;
+  guchar *pixels;
+} ClutterStageCaptureRect;
+
+typedef struct _ClutterStageAsyncCapture
+{
+  /* the requested area, clamped to the stage */
+  ClutterGeometry area;
+
+  /* the rectangles read back so far, and the update serial of the
+   * stage when they were painted */
+  GArray *rects;
+  guint update_serial;
+
+  guint damage_only : 1;
+
+  ClutterStageCaptureFunc func;
+  gpointer user_data;
+  GDestroyNotify notify;
+} ClutterStageAsyncCapture;
+
+/* a block of memory of the per-frame arena; the data follows the
+ * header */
+typedef struct _ClutterStageArenaChunk
+{
+  struct _ClutterStageArenaChunk *next;
+  gsize size;
+} ClutterStageArenaChunk;
+
 struct _ClutterStagePrivate
 {
   /* the stage implementation */
@@ -141,23 +219,141 @@ struct _ClutterStagePrivate
 
   gint                picks_per_frame;
 
-  GArray             *paint_volume_stack;
+  /* the per-frame arena used for the temporary allocations made
+   * while painting; see _clutter_stage_frame_alloc() */
+  ClutterStageArenaChunk *frame_arena;
+  ClutterStageArenaChunk *frame_arena_chunk;
+  guint8             *frame_arena_pos;
+  guint8             *frame_arena_end;
 
   ClutterPlane        current_clip_planes[4];
+  ClutterGeometry     current_clip;
 
-  GList              *pending_queue_redraws;
+  /* the pending queue-redraw entries, stored in fixed size chunks so
+   * that they can be reused from frame to frame without moving */
+  GPtrArray          *queue_redraw_chunks;
+  guint               n_pending_queue_redraws;
 
   ClutterPickMode     pick_buffer_mode;
 
+  /* the generation of the pick id pool when the pick buffer was
+   * painted; ids released after that may have been reused */
+  guint32             pick_buffer_generation;
+
+  /* the areas of the stage that changed since the retained pick
+   * buffer was painted, see clutter_stage_read_retained_pick() */
+  ClutterStageRedrawClips pick_damage;
+  ClutterPickMode     retained_pick_mode;
+  guint32             retained_pick_generation;
+
   CoglFramebuffer    *active_framebuffer;
 
+  /* the framebuffer the viewport and the projection were last set on;
+   * Cogl keeps them for each framebuffer */
+  CoglFramebuffer    *viewport_framebuffer;
+
   GHashTable *devices;
 
   GTimer *fps_timer;
   gint32 timer_n_frames;
 
+  /* the time at which the last frame was presented, in usecs */
+  gint64 presentation_time;
+
+  /* the measured interval between two frames presented on the output
+   * of the stage, in usecs */
+  gint64 refresh_interval;
+
+  /* the timings of the frame being prepared, and a ring buffer of the
+   * timings of the last frames */
+  ClutterStageFrameTimings frame_timings;
+  ClutterStageFrameTimings *frame_timings_history;
+  guint frame_timings_head;
+  guint n_frame_timings;
+
+  /* the work done in the last frame, for clutter_stage_get_statistics() */
+  guint last_n_painted;
+  guint last_n_culled;
+  guint last_n_queued_redraws;
+
+  /* identifies the redraws being finished, so that an actor whose
+   * dependents queue redraws on it again only propagates a full
+   * redraw once per frame; 0 outside of the finishing */
+  guint queue_redraw_stamp;
+  guint last_queue_redraw_stamp;
+
+  /* the causes of the redraws queued for the frame being prepared,
+   * and the ones of the last frame */
+  GHashTable *pending_redraw_causes;
+  GArray *redraw_causes;
+
+  /* the screen-space boxes of the actors painted in the current frame,
+   * the coverage of each pixel computed from them, and the heatmap
+   * showing it, when CLUTTER_PAINT=overdraw is set */
+  GArray *overdraw_boxes;
+  guint8 *overdraw_counts;
+  guchar *overdraw_pixels;
+  gint overdraw_width;
+  gint overdraw_height;
+  CoglHandle overdraw_texture;
+  gdouble overdraw_factor;
+  gdouble overdraw_factor_sum;
+  guint overdraw_n_frames;
+
   ClutterIDPool *pick_id_pool;
 
+  /* uniform grid of the screen-space boxes of the painted actors;
+   * each cell is a GPtrArray of ClutterStageIndexNode */
+  GPtrArray **index_cells;
+  gint index_n_columns;
+  gint index_n_rows;
+  guint index_query_stamp;
+
+  /* incremented each time a redraw is queued */
+  guint scene_serial;
+
+  /* incremented each time the stage is updated by the master clock */
+  guint update_serial;
+
+  /* incremented each time the projection, the view or the viewport
+   * change, see _clutter_stage_get_projection_serial() */
+  guint projection_serial;
+
+  /* the relayout boundaries that need to be allocated again */
+  GSList *relayout_boundaries;
+
+  /* the ClutterText actors mapped since the last relayout */
+  GSList *prefetch_texts;
+
+  /* the actors that will emit ::geometry-changed after the relayout */
+  GSList *geometry_changes;
+
+  /* the ClutterStageAsyncPick requests waiting for a result */
+  GList *async_picks;
+
+  /* the ClutterStageAsyncCapture requests waiting for a frame, or
+   * for the read back of the frame to complete */
+  GList *async_captures;
+
+  /* pixel buffers that can be reused for asynchronous read backs */
+  GArray *pixel_buffers;
+
+  /* the last asynchronous pick result, valid if async_pick_result_valid
+   * is set and the scene serial did not change */
+  ClutterStagePickResult async_pick_result;
+
+  /* the offscreen targets that are not borrowed by any effect */
+  GSList *offscreen_pool;
+
+  /* the opaque actor hiding the whole area being painted, if any;
+   * see _clutter_stage_set_covering_actor() */
+  ClutterActor *covering_actor;
+
+  /* the part of the area being painted that the opaque actors leave
+   * uncovered, if clear_area_partial is set; see
+   * _clutter_stage_set_clear_area() */
+  ClutterGeometry clear_area;
+
 #ifdef CLUTTER_ENABLE_DEBUG
   gulong redraw_count;
 #endif /* CLUTTER_ENABLE_DEBUG */
@@ -174,8 +370,18 @@ struct _ClutterStagePrivate
   guint dirty_viewport         : 1;
   guint dirty_projection       : 1;
   guint have_valid_pick_buffer : 1;
+  guint have_retained_pick     : 1;
   guint accept_focus           : 1;
   guint motion_events_enabled  : 1;
+  guint use_geometric_picking  : 1;
+  guint use_depth_sorting      : 1;
+  guint async_pick_result_valid : 1;
+  guint covering_actor_is_topmost : 1;
+  guint clear_area_partial     : 1;
+  guint frame_redraw_clipped   : 1;
+  guint frame_redraw_full      : 1;
+  guint last_redraw_clipped    : 1;
+  guint constraint_cycle_warned : 1;
 };
 
 enum
@@ -213,6 +419,14 @@ static guint stage_signals[LAST_SIGNAL] = { 0, };
 static const ClutterColor default_stage_color = { 255, 255, 255, 255 };
 
 static void _clutter_stage_maybe_finish_queue_redraws (ClutterStage *stage);
+static void clutter_stage_index_clear (ClutterStage *stage);
+static void clutter_stage_complete_async_picks (ClutterStage *stage);
+static void clutter_stage_free_async_picks (ClutterStage *stage);
+static void clutter_stage_capture_frame (ClutterStage *stage);
+static void clutter_stage_complete_async_captures (ClutterStage *stage);
+static void clutter_stage_free_async_captures (ClutterStage *stage);
+static void clutter_stage_free_queue_redraw_entries (ClutterStage *stage);
+static void clutter_stage_trim_offscreen_pool (ClutterStage *stage);
 
 static void
 _clutter_stage_maybe_finish_queue_redraws (ClutterStage *stage);
@@ -527,10 +741,27 @@ void
 _clutter_stage_do_paint (ClutterStage *stage, const ClutterGeometry *clip)
 {
   ClutterStagePrivate *priv = stage->priv;
+  gboolean is_picking = _clutter_context_get_pick_mode () != CLUTTER_PICK_NONE;
   float clip_poly[8];
 
   if (clip)
     {
+      if (!is_picking)
+        {
+          ClutterGeometry geom;
+
+          _clutter_stage_window_get_geometry (priv->impl, &geom);
+
+          if (clip->x <= 0 && clip->y <= 0 &&
+              clip->x + (gint) clip->width >= (gint) geom.width &&
+              clip->y + (gint) clip->height >= (gint) geom.height)
+            priv->frame_redraw_full = TRUE;
+          else
+            priv->frame_redraw_clipped = TRUE;
+        }
+
+      priv->current_clip = *clip;
+
       clip_poly[0] = clip->x;
       clip_poly[1] = clip->y;
       clip_poly[2] = clip->x + clip->width;
@@ -544,8 +775,16 @@ _clutter_stage_do_paint (ClutterStage *stage, const ClutterGeometry *clip)
     {
       ClutterGeometry geom;
 
+      if (!is_picking)
+        priv->frame_redraw_full = TRUE;
+
       _clutter_stage_window_get_geometry (priv->impl, &geom);
 
+      priv->current_clip.x = 0;
+      priv->current_clip.y = 0;
+      priv->current_clip.width = geom.width;
+      priv->current_clip.height = geom.height;
+
       clip_poly[0] = 0;
       clip_poly[1] = 0;
       clip_poly[2] = geom.width;
@@ -569,9 +808,433 @@ _clutter_stage_do_paint (ClutterStage *stage, const ClutterGeometry *clip)
                                              &priv->inverse_projection,
                                              priv->current_clip_planes);
 
-  _clutter_stage_paint_volume_stack_free_all (stage);
+  _clutter_stage_frame_reset (stage);
   _clutter_stage_update_active_framebuffer (stage);
+  _clutter_actor_compute_occlusion (CLUTTER_ACTOR (stage));
   clutter_actor_paint (CLUTTER_ACTOR (stage));
+
+  if (!is_picking && priv->async_captures != NULL)
+    clutter_stage_capture_frame (stage);
+}
+
+static inline guint64
+geometry_area (const ClutterGeometry *geometry)
+{
+  return (guint64) geometry->width * geometry->height;
+}
+
+/*< private >
+ * _clutter_stage_redraw_clips_add:
+ * @clips: a #ClutterStageRedrawClips
+ * @clip: the rectangle to add
+ *
+ * Adds @clip to the damaged areas in @clips. Rectangles that overlap
+ * are merged into their bounding box, so that the list only contains
+ * disjoint rectangles; if the list is full, @clip is merged with the
+ * rectangle that grows the least.
+ */
+void
+_clutter_stage_redraw_clips_add (ClutterStageRedrawClips *clips,
+                                 const ClutterGeometry   *clip)
+{
+  ClutterGeometry rect = *clip;
+  guint64 best_growth;
+  guint i, best;
+
+  /* merging two rectangles can make the result overlap another one,
+   * so we start over after each merge */
+  i = 0;
+  while (i < clips->n_rects)
+    {
+      if (clutter_geometry_intersects (&clips->rects[i], &rect))
+        {
+          clutter_geometry_union (&clips->rects[i], &rect, &rect);
+
+          clips->n_rects -= 1;
+          clips->rects[i] = clips->rects[clips->n_rects];
+
+          i = 0;
+        }
+      else
+        i += 1;
+    }
+
+  if (clips->n_rects < CLUTTER_STAGE_MAX_REDRAW_CLIPS)
+    {
+      clips->rects[clips->n_rects] = rect;
+      clips->n_rects += 1;
+      return;
+    }
+
+  best = 0;
+  best_growth = G_MAXUINT64;
+
+  for (i = 0; i < clips->n_rects; i++)
+    {
+      ClutterGeometry merged;
+      guint64 growth;
+
+      clutter_geometry_union (&clips->rects[i], &rect, &merged);
+
+      growth = geometry_area (&merged)
+             - geometry_area (&clips->rects[i])
+             - geometry_area (&rect);
+
+      if (growth < best_growth)
+        {
+          best = i;
+          best_growth = growth;
+        }
+    }
+
+  clutter_geometry_union (&clips->rects[best], &rect, &rect);
+
+  clips->n_rects -= 1;
+  clips->rects[best] = clips->rects[clips->n_rects];
+
+  _clutter_stage_redraw_clips_add (clips, &rect);
+}
+
+/*< private >
+ * _clutter_stage_redraw_clips_simplify:
+ * @clips: a #ClutterStageRedrawClips
+ * @bounding_clip: the bounding box of all the rectangles in @clips
+ *
+ * Replaces the rectangles in @clips with @bounding_clip if they cover
+ * most of it anyway, since each rectangle costs a paint of the scene.
+ */
+void
+_clutter_stage_redraw_clips_simplify (ClutterStageRedrawClips *clips,
+                                      const ClutterGeometry   *bounding_clip)
+{
+  guint64 area = 0;
+  guint i;
+
+  if (clips->n_rects < 2)
+    return;
+
+  for (i = 0; i < clips->n_rects; i++)
+    area += geometry_area (&clips->rects[i]);
+
+  if (area * 2 >= geometry_area (bounding_clip))
+    {
+      clips->rects[0] = *bounding_clip;
+      clips->n_rects = 1;
+    }
+}
+
+/*< private >
+ * _clutter_stage_paint_redraw_clips:
+ * @stage: a #ClutterStage
+ * @clips: the areas of the stage to paint
+ *
+ * Paints the scene once for each rectangle in @clips, scissoring the
+ * paint to the rectangle and culling the actors outside of it.
+ */
+void
+_clutter_stage_paint_redraw_clips (ClutterStage                  *stage,
+                                   const ClutterStageRedrawClips *clips)
+{
+  guint i;
+
+  for (i = 0; i < clips->n_rects; i++)
+    {
+      const ClutterGeometry *clip = &clips->rects[i];
+
+      CLUTTER_NOTE (CLIPPING,
+                    "Stage clip pushed: x=%d, y=%d, width=%d, height=%d",
+                    clip->x, clip->y, clip->width, clip->height);
+
+      cogl_clip_push_window_rectangle (clip->x, clip->y,
+                                       clip->width, clip->height);
+      _clutter_stage_do_paint (stage, clip);
+      cogl_clip_pop ();
+    }
+}
+
+/*< private >
+ * _clutter_stage_damage_history_reset:
+ * @history: a #ClutterStageDamageHistory
+ *
+ * Forgets the damage of all the past frames, for instance after the
+ * stage window has been resized and none of the back buffers can be
+ * trusted any more
+ */
+void
+_clutter_stage_damage_history_reset (ClutterStageDamageHistory *history)
+{
+  history->head = 0;
+  history->n_frames = 0;
+}
+
+/*< private >
+ * _clutter_stage_damage_history_record:
+ * @history: a #ClutterStageDamageHistory
+ * @clips: (allow-none): the areas that changed in the frame being
+ *   presented, or %NULL if the whole stage changed
+ *
+ * Adds the damage of the frame about to be presented to @history
+ */
+void
+_clutter_stage_damage_history_record (ClutterStageDamageHistory     *history,
+                                      const ClutterStageRedrawClips *clips)
+{
+  ClutterStageRedrawClips *frame;
+
+  history->head = (history->head + 1) % CLUTTER_STAGE_DAMAGE_HISTORY_LENGTH;
+  if (history->n_frames < CLUTTER_STAGE_DAMAGE_HISTORY_LENGTH)
+    history->n_frames += 1;
+
+  frame = &history->frames[history->head];
+
+  if (clips != NULL)
+    *frame = *clips;
+  else
+    frame->n_rects = 0;
+}
+
+/*< private >
+ * _clutter_stage_damage_history_accumulate:
+ * @history: a #ClutterStageDamageHistory
+ * @buffer_age: the age of the back buffer, as reported by the window
+ *   system; 1 means the back buffer holds the contents of the last
+ *   frame, and 0 means it holds undefined contents
+ * @clips: the damage of the current frame, which will be extended with
+ *   the damage of the frames the back buffer has missed
+ * @bounding_clip: the bounding box of @clips, which will be updated
+ *   to match
+ *
+ * Works out which areas of a recycled back buffer need to be redrawn
+ * to bring it up to date with the current frame
+ *
+ * Return value: %TRUE if @clips now covers everything that needs to
+ *   be redrawn, and %FALSE if the whole stage must be redrawn instead
+ */
+gboolean
+_clutter_stage_damage_history_accumulate (const ClutterStageDamageHistory *history,
+                                          gint                             buffer_age,
+                                          ClutterStageRedrawClips         *clips,
+                                          ClutterGeometry                 *bounding_clip)
+{
+  guint n_missed, pos, i;
+
+  if (buffer_age <= 0)
+    return FALSE;
+
+  /* the back buffer is missing the damage of the frames presented
+   * since it was last shown */
+  n_missed = buffer_age - 1;
+  if (n_missed > history->n_frames)
+    return FALSE;
+
+  pos = history->head;
+
+  for (i = 0; i < n_missed; i++)
+    {
+      const ClutterStageRedrawClips *frame = &history->frames[pos];
+      guint j;
+
+      pos = (pos + CLUTTER_STAGE_DAMAGE_HISTORY_LENGTH - 1)
+          % CLUTTER_STAGE_DAMAGE_HISTORY_LENGTH;
+
+      if (frame->n_rects == 0)
+        return FALSE;
+
+      for (j = 0; j < frame->n_rects; j++)
+        {
+          _clutter_stage_redraw_clips_add (clips, &frame->rects[j]);
+          clutter_geometry_union (bounding_clip, &frame->rects[j],
+                                  bounding_clip);
+        }
+    }
+
+  return TRUE;
+}
+
+/* the number of frames between two reports of the overdraw factor */
+#define OVERDRAW_REPORT_FRAMES  120
+
+/* the colors of the heatmap, premultiplied, indexed by the number of
+ * times a pixel was written; the last one is used for anything above */
+static const guint8 overdraw_colors[][4] = {
+  { 0x00, 0x00, 0x00, 0x00 },
+  { 0x00, 0x00, 0x80, 0x80 },
+  { 0x00, 0x80, 0x00, 0x80 },
+  { 0x80, 0x80, 0x00, 0x80 },
+  { 0x80, 0x40, 0x00, 0x80 },
+  { 0xc0, 0x00, 0x00, 0xc0 },
+};
+
+void
+_clutter_stage_add_overdraw_box (ClutterStage          *stage,
+                                 const ClutterActorBox *box)
+{
+  ClutterStagePrivate *priv = stage->priv;
+
+  if (priv->overdraw_boxes == NULL)
+    priv->overdraw_boxes = g_array_new (FALSE, FALSE, sizeof (ClutterActorBox));
+
+  g_array_append_val (priv->overdraw_boxes, *box);
+}
+
+static void
+clutter_stage_overdraw_free (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+
+  if (priv->overdraw_boxes != NULL)
+    {
+      g_array_free (priv->overdraw_boxes, TRUE);
+      priv->overdraw_boxes = NULL;
+    }
+
+  if (priv->overdraw_texture != COGL_INVALID_HANDLE)
+    {
+      cogl_handle_unref (priv->overdraw_texture);
+      priv->overdraw_texture = COGL_INVALID_HANDLE;
+    }
+
+  g_free (priv->overdraw_counts);
+  priv->overdraw_counts = NULL;
+
+  g_free (priv->overdraw_pixels);
+  priv->overdraw_pixels = NULL;
+
+  priv->overdraw_width = priv->overdraw_height = 0;
+}
+
+/* Accumulates the boxes recorded while painting the stage into the
+ * number of times each pixel was written, and paints the result over
+ * the stage as a heatmap. The coverage is computed on the CPU from the
+ * paint boxes of the actors rather than by counting fragments on the
+ * GPU, so it works with any driver and it does not add to the fill
+ * rate it is trying to measure; boxes overestimate the coverage of
+ * actors that are not rectangular, though */
+static void
+clutter_stage_paint_overdraw (ClutterStage          *stage,
+                              const ClutterGeometry *cleared)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  ClutterActorBox allocation;
+  guint64 n_writes;
+  gint width, height, n_pixels, i;
+
+  clutter_actor_get_allocation_box (CLUTTER_ACTOR (stage), &allocation);
+  width = (gint) (allocation.x2 - allocation.x1);
+  height = (gint) (allocation.y2 - allocation.y1);
+  if (width <= 0 || height <= 0)
+    goto out;
+
+  n_pixels = width * height;
+
+  if (width != priv->overdraw_width || height != priv->overdraw_height)
+    {
+      GArray *boxes = priv->overdraw_boxes;
+
+      /* keep the boxes of this frame */
+      priv->overdraw_boxes = NULL;
+      clutter_stage_overdraw_free (stage);
+      priv->overdraw_boxes = boxes;
+
+      priv->overdraw_counts = g_new (guint8, n_pixels);
+      priv->overdraw_pixels = g_new (guchar, n_pixels * 4);
+      priv->overdraw_width = width;
+      priv->overdraw_height = height;
+    }
+
+  /* clearing the stage writes each cleared pixel once */
+  memset (priv->overdraw_counts, 0, n_pixels);
+  n_writes = 0;
+
+  if (cleared != NULL)
+    {
+      gint x1, y1, x2, y2, y;
+
+      x1 = CLAMP (cleared->x, 0, width);
+      y1 = CLAMP (cleared->y, 0, height);
+      x2 = CLAMP (cleared->x + (gint) cleared->width, 0, width);
+      y2 = CLAMP (cleared->y + (gint) cleared->height, 0, height);
+
+      for (y = y1; y < y2 && x2 > x1; y++)
+        memset (priv->overdraw_counts + y * width + x1, 1, x2 - x1);
+
+      n_writes += (x2 > x1 && y2 > y1) ? (x2 - x1) * (y2 - y1) : 0;
+    }
+
+  for (i = 0; priv->overdraw_boxes != NULL &&
+              i < priv->overdraw_boxes->len; i++)
+    {
+      const ClutterActorBox *box =
+        &g_array_index (priv->overdraw_boxes, ClutterActorBox, i);
+      gint x1, y1, x2, y2, x, y;
+
+      x1 = CLAMP (floorf (box->x1), 0, width);
+      y1 = CLAMP (floorf (box->y1), 0, height);
+      x2 = CLAMP (ceilf (box->x2), 0, width);
+      y2 = CLAMP (ceilf (box->y2), 0, height);
+
+      for (y = y1; y < y2; y++)
+        {
+          guint8 *row = priv->overdraw_counts + y * width;
+
+          for (x = x1; x < x2; x++)
+            if (row[x] < G_MAXUINT8)
+              row[x] += 1;
+        }
+
+      n_writes += (x2 > x1 && y2 > y1) ? (x2 - x1) * (y2 - y1) : 0;
+    }
+
+  priv->overdraw_factor = (gdouble) n_writes / n_pixels;
+
+  for (i = 0; i < n_pixels; i++)
+    {
+      guint count = MIN (priv->overdraw_counts[i],
+                         G_N_ELEMENTS (overdraw_colors) - 1);
+
+      memcpy (priv->overdraw_pixels + i * 4, overdraw_colors[count], 4);
+    }
+
+  if (priv->overdraw_texture == COGL_INVALID_HANDLE)
+    priv->overdraw_texture =
+      cogl_texture_new_from_data (width, height,
+                                  COGL_TEXTURE_NO_AUTO_MIPMAP,
+                                  COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                  COGL_PIXEL_FORMAT_ANY,
+                                  width * 4,
+                                  priv->overdraw_pixels);
+  else
+    cogl_texture_set_region (priv->overdraw_texture,
+                             0, 0,
+                             0, 0,
+                             width, height,
+                             width, height,
+                             COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                             width * 4,
+                             priv->overdraw_pixels);
+
+  if (priv->overdraw_texture != COGL_INVALID_HANDLE)
+    {
+      cogl_disable_fog ();
+      cogl_set_source_texture (priv->overdraw_texture);
+      cogl_rectangle (0, 0, width, height);
+    }
+
+  priv->overdraw_factor_sum += priv->overdraw_factor;
+  if (++priv->overdraw_n_frames == OVERDRAW_REPORT_FRAMES)
+    {
+      g_print ("Average overdraw of stage %p over %u frames: %.2f\n",
+               stage,
+               priv->overdraw_n_frames,
+               priv->overdraw_factor_sum / priv->overdraw_n_frames);
+
+      priv->overdraw_factor_sum = 0;
+      priv->overdraw_n_frames = 0;
+    }
+
+out:
+  if (priv->overdraw_boxes != NULL)
+    g_array_set_size (priv->overdraw_boxes, 0);
 }
 
 static void
@@ -579,6 +1242,8 @@ clutter_stage_paint (ClutterActor *self)
 {
   ClutterStagePrivate *priv = CLUTTER_STAGE (self)->priv;
   CoglBufferBit clear_flags;
+  gboolean clear_scissored;
+  gboolean depth_test_enabled = FALSE;
   CoglColor stage_color;
   guint8 real_alpha;
   CLUTTER_STATIC_TIMER (stage_clear_timer,
@@ -605,12 +1270,34 @@ clutter_stage_paint (ClutterActor *self)
                                            : 255);
   cogl_color_premultiply (&stage_color);
 
+  /* there is no need to clear the color buffer where opaque actors
+   * are going to paint over every pixel of it; if they leave only a
+   * part of the painted area uncovered, we scissor the clear to it.
+   * The depth buffer is still cleared over the whole painted area, as
+   * any actor can enable the depth test in its material */
   clear_flags = COGL_BUFFER_BIT_DEPTH;
+  clear_scissored = FALSE;
+
   if (!STAGE_NO_CLEAR_ON_PAINT (self))
-    clear_flags |= COGL_BUFFER_BIT_COLOR;
+    {
+      if (!priv->clear_area_partial)
+        clear_flags |= COGL_BUFFER_BIT_COLOR;
+      else if (priv->clear_area.width > 0 && priv->clear_area.height > 0)
+        clear_scissored = TRUE;
+    }
 
   CLUTTER_TIMER_START (_clutter_uprof_context, stage_clear_timer);
 
+  if (clear_scissored)
+    {
+      cogl_clip_push_window_rectangle (priv->clear_area.x,
+                                       priv->clear_area.y,
+                                       priv->clear_area.width,
+                                       priv->clear_area.height);
+      cogl_clear (&stage_color, COGL_BUFFER_BIT_COLOR);
+      cogl_clip_pop ();
+    }
+
   cogl_clear (&stage_color, clear_flags);
 
   CLUTTER_TIMER_STOP (_clutter_uprof_context, stage_clear_timer);
@@ -630,8 +1317,36 @@ clutter_stage_paint (ClutterActor *self)
   else
     cogl_disable_fog ();
 
+  if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_OVERDRAW) &&
+      priv->overdraw_boxes != NULL)
+    g_array_set_size (priv->overdraw_boxes, 0);
+
+  /* the opaque actors are painted first, front to back, so that the
+   * depth test discards what would be painted below them */
+  if (priv->use_depth_sorting)
+    {
+      depth_test_enabled = cogl_get_depth_test_enabled ();
+      cogl_set_depth_test_enabled (TRUE);
+
+      _clutter_actor_paint_opaque_pass (self);
+    }
+
   /* this will take care of painting every child */
   CLUTTER_ACTOR_CLASS (clutter_stage_parent_class)->paint (self);
+
+  if (priv->use_depth_sorting)
+    {
+      _clutter_actor_finish_opaque_pass (self);
+
+      cogl_set_depth_test_enabled (depth_test_enabled);
+    }
+
+  if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_OVERDRAW))
+    clutter_stage_paint_overdraw (CLUTTER_STAGE (self),
+                                  (clear_flags & COGL_BUFFER_BIT_COLOR) != 0
+                                    ? &priv->current_clip
+                                    : clear_scissored ? &priv->clear_area
+                                                      : NULL);
 }
 
 static void
@@ -670,7 +1385,10 @@ clutter_stage_realize (ClutterActor *self)
   priv->dirty_projection = TRUE;
 
   g_assert (priv->impl != NULL);
+
+  _clutter_startup_phase_begin (CLUTTER_STARTUP_STAGE_REALIZE);
   is_realized = _clutter_stage_window_realize (priv->impl);
+  _clutter_startup_phase_end (CLUTTER_STARTUP_STAGE_REALIZE);
 
   /* ensure that the stage is using the context if the
    * realization sequence was successful
@@ -841,6 +1559,7 @@ _clutter_stage_process_queued_events (ClutterStage *stage)
 {
   ClutterStagePrivate *priv;
   GList *events, *l;
+  gint64 start_time;
 
   g_return_if_fail (CLUTTER_IS_STAGE (stage));
 
@@ -849,6 +1568,8 @@ _clutter_stage_process_queued_events (ClutterStage *stage)
   if (priv->event_queue->length == 0)
     return;
 
+  start_time = _clutter_util_get_monotonic_time ();
+
   /* In case the stage gets destroyed during event processing */
   g_object_ref (stage);
 
@@ -892,6 +1613,12 @@ _clutter_stage_process_queued_events (ClutterStage *stage)
                         "Omitting motion event at %d, %d",
                         (int) event->motion.x,
                         (int) event->motion.y);
+
+          /* keep the position of the omitted event in the motion
+           * history of the event that will be delivered */
+          if (next_event->type == CLUTTER_MOTION)
+            _clutter_event_fold_motion (next_event, event);
+
           goto next_event;
 	}
 
@@ -903,6 +1630,9 @@ _clutter_stage_process_queued_events (ClutterStage *stage)
 
   g_list_free (events);
 
+  priv->frame_timings.event_time +=
+    _clutter_util_get_monotonic_time () - start_time;
+
   g_object_unref (stage);
 }
 
@@ -918,40 +1648,284 @@ gboolean
 _clutter_stage_needs_update (ClutterStage *stage)
 {
   ClutterStagePrivate *priv;
+  GList *l;
 
   g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
 
   priv = stage->priv;
 
-  return priv->relayout_pending || priv->redraw_pending;
+  if (priv->relayout_pending ||
+      priv->redraw_pending ||
+      priv->async_picks != NULL)
+    return TRUE;
+
+  /* the captured frames are delivered by the next updates */
+  for (l = priv->async_captures; l != NULL; l = l->next)
+    {
+      ClutterStageAsyncCapture *capture = l->data;
+
+      if (capture->rects->len > 0)
+        return TRUE;
+    }
+
+  return FALSE;
 }
 
-void
-_clutter_stage_maybe_relayout (ClutterActor *actor)
+/* a constrained actor in the dependency graph of the constraints */
+typedef struct _ConstraintNode
 {
-  ClutterStage *stage = CLUTTER_STAGE (actor);
-  ClutterStagePrivate *priv = stage->priv;
-  gfloat natural_width, natural_height;
-  ClutterActorBox box = { 0, };
-  CLUTTER_STATIC_TIMER (relayout_timer,
-                        "Mainloop", /* no parent */
-                        "Layouting",
-                        "The time spent reallocating the stage",
-                        0 /* no application private data */);
+  ClutterActor *actor;
 
-  if (!priv->relayout_pending)
-    return;
+  /* the nodes depending on this one */
+  GSList *dependents;
 
-  /* avoid reentrancy */
-  if (!CLUTTER_ACTOR_IN_RELAYOUT (stage))
-    {
-      priv->relayout_pending = FALSE;
+  /* the number of sources of this node not resolved yet */
+  guint n_pending_sources;
+} ConstraintNode;
 
-      CLUTTER_TIMER_START (_clutter_uprof_context, relayout_timer);
-      CLUTTER_NOTE (ACTOR, "Recomputing layout");
+static void
+constraint_node_free (gpointer data)
+{
+  ConstraintNode *node = data;
+
+  g_slist_free (node->dependents);
+  g_slice_free (ConstraintNode, node);
+}
+
+/* finds the node that the allocation of @source depends on: the one
+ * of @source itself, or the one of its closest constrained ancestor */
+static ConstraintNode *
+clutter_stage_find_constraint_node (ClutterStage *stage,
+                                    GHashTable   *nodes,
+                                    ClutterActor *source)
+{
+  ClutterActor *iter;
+
+  for (iter = source;
+       iter != NULL && iter != CLUTTER_ACTOR (stage);
+       iter = clutter_actor_get_parent (iter))
+    {
+      ConstraintNode *node = g_hash_table_lookup (nodes, iter);
+
+      if (node != NULL)
+        return node;
+    }
+
+  return NULL;
+}
+
+/* The constraints are applied by each actor in its allocate(), so a
+ * constraint whose source is allocated after the constrained actor
+ * would read the old allocation of the source, and a chain of
+ * constraints would need one more relayout for each link.
+ *
+ * Once the scene has been allocated the constraints depending on
+ * other actors are resolved again in the order given by their
+ * dependencies, so that each source is allocated before the actors
+ * depending on it, and the whole chain converges in one frame.
+ */
+static void
+clutter_stage_resolve_constraints (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  GHashTable *nodes;
+  GList *order = NULL, *l;
+  GQueue ready = G_QUEUE_INIT;
+  const GList *c;
+  guint n_nodes, n_resolved;
+
+  nodes = g_hash_table_new_full (NULL, NULL, NULL, constraint_node_free);
+
+  /* the nodes of the graph are the actors on this stage with at least
+   * one enabled constraint depending on another actor */
+  for (c = _clutter_constraint_peek_all (); c != NULL; c = c->next)
+    {
+      ClutterActorMeta *meta = c->data;
+      ClutterActor *actor, *source;
+      ConstraintNode *node;
+
+      actor = clutter_actor_meta_get_actor (meta);
+      source = _clutter_constraint_get_source (c->data);
+
+      if (actor == NULL || source == NULL ||
+          !clutter_actor_meta_get_enabled (meta) ||
+          _clutter_actor_get_stage_internal (actor) != CLUTTER_ACTOR (stage))
+        continue;
+
+      if (g_hash_table_lookup (nodes, actor) != NULL)
+        continue;
+
+      node = g_slice_new0 (ConstraintNode);
+      node->actor = actor;
+      g_hash_table_insert (nodes, actor, node);
+
+      order = g_list_prepend (order, node);
+    }
+
+  if (order == NULL)
+    {
+      g_hash_table_destroy (nodes);
+      priv->constraint_cycle_warned = FALSE;
+      return;
+    }
+
+  order = g_list_reverse (order);
+
+  /* the edges go from the node of each source to the nodes depending
+   * on it */
+  for (c = _clutter_constraint_peek_all (); c != NULL; c = c->next)
+    {
+      ClutterActorMeta *meta = c->data;
+      ConstraintNode *node, *source_node;
+      ClutterActor *actor, *source;
+
+      actor = clutter_actor_meta_get_actor (meta);
+      if (actor == NULL || !clutter_actor_meta_get_enabled (meta))
+        continue;
+
+      node = g_hash_table_lookup (nodes, actor);
+      if (node == NULL)
+        continue;
+
+      source = _clutter_constraint_get_source (c->data);
+      source_node = clutter_stage_find_constraint_node (stage, nodes, source);
+
+      /* an actor bound to one of its own children depends on itself */
+      if (source_node == NULL || source_node == node)
+        continue;
+
+      source_node->dependents = g_slist_prepend (source_node->dependents,
+                                                 node);
+      node->n_pending_sources += 1;
+    }
+
+  /* sort the nodes topologically, starting from the ones that do not
+   * depend on other constrained actors */
+  n_nodes = g_hash_table_size (nodes);
+  n_resolved = 0;
+
+  for (l = order; l != NULL; l = l->next)
+    {
+      ConstraintNode *node = l->data;
+
+      if (node->n_pending_sources == 0)
+        g_queue_push_tail (&ready, node);
+    }
+
+  while (!g_queue_is_empty (&ready))
+    {
+      ConstraintNode *node = g_queue_pop_head (&ready);
+      GSList *d;
+
+      _clutter_actor_reapply_constraints (node->actor);
+      n_resolved += 1;
+
+      for (d = node->dependents; d != NULL; d = d->next)
+        {
+          ConstraintNode *dependent = d->data;
+
+          dependent->n_pending_sources -= 1;
+          if (dependent->n_pending_sources == 0)
+            g_queue_push_tail (&ready, dependent);
+        }
+    }
+
+  /* the nodes left depend on each other; they are resolved once each,
+   * so the cycle does not converge, but it does not loop either */
+  if (n_resolved < n_nodes)
+    {
+      for (l = order; l != NULL; l = l->next)
+        {
+          ConstraintNode *node = l->data;
+
+          if (node->n_pending_sources == 0)
+            continue;
+
+          if (!priv->constraint_cycle_warned)
+            {
+              g_warning ("The constraints of %u actors, including '%s', "
+                         "form a cycle of dependencies that cannot be "
+                         "resolved",
+                         n_nodes - n_resolved,
+                         _clutter_actor_get_debug_name (node->actor));
+              priv->constraint_cycle_warned = TRUE;
+            }
+
+          _clutter_actor_reapply_constraints (node->actor);
+        }
+    }
+  else
+    priv->constraint_cycle_warned = FALSE;
+
+  CLUTTER_NOTE (LAYOUT, "Resolved the constraints of %u actors (%u in cycles)",
+                n_nodes,
+                n_nodes - n_resolved);
+
+  g_list_free (order);
+  g_hash_table_destroy (nodes);
+}
+
+static void
+clutter_stage_free_geometry_changes (ClutterStage *stage,
+                                     gboolean      emit)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  GSList *changes, *l;
+
+  /* the handlers might change the allocations again, and queue new
+   * geometry changes for the next relayout
+   */
+  changes = g_slist_reverse (priv->geometry_changes);
+  priv->geometry_changes = NULL;
+
+  for (l = changes; l != NULL; l = l->next)
+    {
+      _clutter_actor_finish_geometry_change (l->data, emit);
+      g_object_unref (l->data);
+    }
+
+  g_slist_free (changes);
+}
+
+void
+_clutter_stage_maybe_relayout (ClutterActor *actor)
+{
+  ClutterStage *stage = CLUTTER_STAGE (actor);
+  ClutterStagePrivate *priv = stage->priv;
+  gfloat natural_width, natural_height;
+  ClutterActorBox box = { 0, };
+  CLUTTER_STATIC_TIMER (relayout_timer,
+                        "Mainloop", /* no parent */
+                        "Layouting",
+                        "The time spent reallocating the stage",
+                        0 /* no application private data */);
+
+  /* avoid reentrancy */
+  if (priv->relayout_pending && !CLUTTER_ACTOR_IN_RELAYOUT (stage))
+    {
+      priv->relayout_pending = FALSE;
+
+      CLUTTER_TIMER_START (_clutter_uprof_context, relayout_timer);
+      CLUTTER_NOTE (ACTOR, "Recomputing layout");
 
       CLUTTER_SET_PRIVATE_FLAGS (stage, CLUTTER_IN_RELAYOUT);
 
+      /* the layouts of the texts mapped since the last relayout are
+       * shaped in parallel before the serial walk of the allocation
+       * asks them for their size one by one
+       */
+      if (priv->prefetch_texts != NULL)
+        {
+          GSList *texts = priv->prefetch_texts;
+
+          priv->prefetch_texts = NULL;
+
+          _clutter_text_prefetch_mapped_layouts (texts);
+
+          g_slist_foreach (texts, (GFunc) g_object_unref, NULL);
+          g_slist_free (texts);
+        }
+
       natural_width = natural_height = 0;
       clutter_actor_get_preferred_size (CLUTTER_ACTOR (stage),
                                         NULL, NULL,
@@ -969,9 +1943,97 @@ _clutter_stage_maybe_relayout (ClutterActor *actor)
       clutter_actor_allocate (CLUTTER_ACTOR (stage),
                               &box, CLUTTER_ALLOCATION_NONE);
 
+      /* the sub-trees below the relayout boundaries are not reached
+       * by the allocation of the stage, unless something else moved
+       * or resized the boundaries */
+      if (priv->relayout_boundaries != NULL)
+        {
+          GSList *boundaries, *l;
+
+          boundaries = g_slist_reverse (priv->relayout_boundaries);
+          priv->relayout_boundaries = NULL;
+
+          for (l = boundaries; l != NULL; l = l->next)
+            {
+              ClutterActor *boundary = l->data;
+
+              if (_clutter_actor_get_stage_internal (boundary) == actor)
+                _clutter_actor_relayout_boundary (boundary);
+
+              g_object_unref (boundary);
+            }
+
+          g_slist_free (boundaries);
+        }
+
+      clutter_stage_resolve_constraints (stage);
+
       CLUTTER_UNSET_PRIVATE_FLAGS (stage, CLUTTER_IN_RELAYOUT);
       CLUTTER_TIMER_STOP (_clutter_uprof_context, relayout_timer);
     }
+
+  /* the allocations might also have changed outside of the relayout,
+   * so the geometry changes are emitted even if there was none
+   */
+  if (priv->geometry_changes != NULL && !CLUTTER_ACTOR_IN_RELAYOUT (stage))
+    clutter_stage_free_geometry_changes (stage, TRUE);
+}
+
+/*< private >
+ * _clutter_stage_queue_boundary_relayout:
+ * @stage: a #ClutterStage
+ * @actor: a relayout boundary inside @stage
+ *
+ * Queues a relayout that only needs to allocate @actor again, instead
+ * of the whole stage.
+ */
+void
+_clutter_stage_queue_boundary_relayout (ClutterStage *stage,
+                                        ClutterActor *actor)
+{
+  ClutterStagePrivate *priv = stage->priv;
+
+  priv->relayout_boundaries = g_slist_prepend (priv->relayout_boundaries,
+                                               g_object_ref (actor));
+  priv->relayout_pending = TRUE;
+
+  _clutter_master_clock_start_running (_clutter_master_clock_get_default ());
+}
+
+/*< private >
+ * _clutter_stage_queue_geometry_change:
+ * @stage: a #ClutterStage
+ * @actor: an actor inside @stage whose allocation changed
+ *
+ * Queues the emission of the #ClutterActor::geometry-changed signal
+ * on @actor at the end of the next relayout of @stage.
+ */
+void
+_clutter_stage_queue_geometry_change (ClutterStage *stage,
+                                      ClutterActor *actor)
+{
+  ClutterStagePrivate *priv = stage->priv;
+
+  priv->geometry_changes = g_slist_prepend (priv->geometry_changes,
+                                            g_object_ref (actor));
+}
+
+/*< private >
+ * _clutter_stage_queue_text_prefetch:
+ * @stage: a #ClutterStage
+ * @text: a #ClutterText that has just been mapped inside @stage
+ *
+ * Queues the layout of @text to be shaped, together with the other
+ * texts mapped inside @stage, at the beginning of the next relayout.
+ */
+void
+_clutter_stage_queue_text_prefetch (ClutterStage *stage,
+                                    ClutterActor *text)
+{
+  ClutterStagePrivate *priv = stage->priv;
+
+  priv->prefetch_texts = g_slist_prepend (priv->prefetch_texts,
+                                          g_object_ref (text));
 }
 
 static gboolean
@@ -996,12 +2058,205 @@ _clutter_stage_set_pick_buffer_valid (ClutterStage   *stage,
   stage->priv->pick_buffer_mode = mode;
 }
 
+#define STAGE_FRAME_TIMINGS_HISTORY     64
+
+/* moves the timings of the frame that has just been completed to the
+ * history, and starts collecting the timings of the next frame */
+/* the redraws queued by the same function on the same actor are
+ * accounted together */
+typedef struct _PendingRedrawCause
+{
+  ClutterActor *actor;
+  gpointer caller;
+
+  ClutterStageRedrawCause cause;
+} PendingRedrawCause;
+
+/* the number of stages tracking the causes of their redraws, so that
+ * the actors can skip looking up their stage otherwise */
+static guint n_stages_tracking_redraws = 0;
+
+static guint
+pending_redraw_cause_hash (gconstpointer key)
+{
+  const PendingRedrawCause *pending = key;
+
+  return GPOINTER_TO_UINT (pending->actor) ^ GPOINTER_TO_UINT (pending->caller);
+}
+
+static gboolean
+pending_redraw_cause_equal (gconstpointer a,
+                            gconstpointer b)
+{
+  const PendingRedrawCause *pending_a = a;
+  const PendingRedrawCause *pending_b = b;
+
+  return pending_a->actor == pending_b->actor &&
+         pending_a->caller == pending_b->caller;
+}
+
+static void
+pending_redraw_cause_free (gpointer data)
+{
+  g_slice_free (PendingRedrawCause, data);
+}
+
+static const gchar *
+redraw_cause_get_name (gpointer caller)
+{
+  const gchar *name;
+  gchar *address;
+
+#ifdef HAVE_DLADDR
+  Dl_info info;
+
+  if (caller != NULL &&
+      dladdr (caller, &info) != 0 &&
+      info.dli_sname != NULL)
+    return g_intern_string (info.dli_sname);
+#endif /* HAVE_DLADDR */
+
+  if (caller == NULL)
+    return g_intern_static_string ("unknown");
+
+  address = g_strdup_printf ("%p", caller);
+  name = g_intern_string (address);
+  g_free (address);
+
+  return name;
+}
+
+/* the functions are only named once per frame, since looking up the
+ * symbols is much more expensive than recording the addresses */
+static void
+clutter_stage_push_redraw_causes (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  GHashTableIter iter;
+  gpointer key;
+
+  g_array_set_size (priv->redraw_causes, 0);
+
+  g_hash_table_iter_init (&iter, priv->pending_redraw_causes);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    {
+      PendingRedrawCause *pending = key;
+
+      pending->cause.cause = redraw_cause_get_name (pending->caller);
+      g_array_append_val (priv->redraw_causes, pending->cause);
+    }
+
+  g_hash_table_remove_all (priv->pending_redraw_causes);
+
+  if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_REDRAW_CAUSES) &&
+      priv->redraw_causes->len > 0)
+    {
+      guint i;
+
+      g_print ("*** Redraws queued for %s[%p] ***\n",
+               _clutter_actor_get_debug_name (CLUTTER_ACTOR (stage)),
+               stage);
+
+      for (i = 0; i < priv->redraw_causes->len; i++)
+        {
+          const ClutterStageRedrawCause *cause =
+            &g_array_index (priv->redraw_causes, ClutterStageRedrawCause, i);
+
+          g_print ("  %s '%s': %u redraws, %u relayouts by %s\n",
+                   cause->actor_type,
+                   cause->actor_name != NULL ? cause->actor_name : "",
+                   cause->n_redraws,
+                   cause->n_relayouts,
+                   cause->cause);
+        }
+    }
+}
+
+gboolean
+_clutter_stage_tracks_redraw_causes (void)
+{
+  return n_stages_tracking_redraws > 0;
+}
+
+/*< private >
+ * _clutter_stage_add_redraw_cause:
+ * @stage: a #ClutterStage
+ * @actor: the actor on which a redraw or a relayout was queued
+ * @caller: the address of the code that queued it
+ * @relayout: whether a relayout was queued
+ *
+ * Records the cause of a redraw or a relayout of @actor, if @stage is
+ * tracking the causes of its redraws.
+ */
+void
+_clutter_stage_add_redraw_cause (ClutterStage *stage,
+                                 ClutterActor *actor,
+                                 gpointer      caller,
+                                 gboolean      relayout)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  PendingRedrawCause key, *pending;
+
+  if (priv->pending_redraw_causes == NULL)
+    return;
+
+  key.actor = actor;
+  key.caller = caller;
+
+  pending = g_hash_table_lookup (priv->pending_redraw_causes, &key);
+  if (pending == NULL)
+    {
+      const gchar *name = clutter_actor_get_name (actor);
+
+      /* the actor might be gone by the time the frame is drawn, so
+       * everything we report about it is copied now */
+      pending = g_slice_new0 (PendingRedrawCause);
+      pending->actor = actor;
+      pending->caller = caller;
+      pending->cause.actor_type = g_type_name (G_OBJECT_TYPE (actor));
+      pending->cause.actor_name = name != NULL ? g_intern_string (name) : NULL;
+
+      g_hash_table_insert (priv->pending_redraw_causes, pending, pending);
+    }
+
+  if (relayout)
+    pending->cause.n_relayouts += 1;
+  else
+    pending->cause.n_redraws += 1;
+}
+
+static void
+clutter_stage_push_frame_timings (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+
+  if (priv->frame_timings_history == NULL)
+    priv->frame_timings_history = g_new0 (ClutterStageFrameTimings,
+                                          STAGE_FRAME_TIMINGS_HISTORY);
+
+  priv->frame_timings.frame_time = _clutter_util_get_monotonic_time ();
+
+  priv->frame_timings_head = (priv->frame_timings_head + 1)
+                           % STAGE_FRAME_TIMINGS_HISTORY;
+  priv->frame_timings_history[priv->frame_timings_head] = priv->frame_timings;
+
+  if (priv->n_frame_timings < STAGE_FRAME_TIMINGS_HISTORY)
+    priv->n_frame_timings += 1;
+
+  memset (&priv->frame_timings, 0, sizeof (ClutterStageFrameTimings));
+
+  if (priv->pending_redraw_causes != NULL)
+    clutter_stage_push_redraw_causes (stage);
+}
+
 static void
 clutter_stage_do_redraw (ClutterStage *stage)
 {
   ClutterBackend *backend = clutter_get_default_backend ();
   ClutterActor *actor = CLUTTER_ACTOR (stage);
   ClutterStagePrivate *priv = stage->priv;
+  gint64 start_time;
+  guint n_painted, n_culled;
 
   CLUTTER_TIMESTAMP (SCHEDULER, "Redraw started for %s[%p]",
                      _clutter_actor_get_debug_name (actor),
@@ -1020,8 +2275,25 @@ clutter_stage_do_redraw (ClutterStage *stage)
 
   _clutter_stage_maybe_setup_viewport (stage);
 
+  start_time = _clutter_util_get_monotonic_time ();
+  n_painted = _clutter_actor_get_n_painted ();
+  n_culled = _clutter_actor_get_n_culled ();
+  priv->frame_redraw_clipped = FALSE;
+  priv->frame_redraw_full = FALSE;
+
   _clutter_backend_redraw (backend, stage);
 
+  priv->last_n_painted = _clutter_actor_get_n_painted () - n_painted;
+  priv->last_n_culled = _clutter_actor_get_n_culled () - n_culled;
+  priv->last_redraw_clipped = priv->frame_redraw_clipped &&
+                              !priv->frame_redraw_full;
+  priv->frame_timings.n_painted_actors += priv->last_n_painted;
+
+  /* the backend reports the time it spent swapping while redrawing */
+  priv->frame_timings.paint_time += _clutter_util_get_monotonic_time ()
+                                  - start_time
+                                  - priv->frame_timings.swap_time;
+
   if (clutter_get_show_fps ())
     {
       priv->timer_n_frames += 1;
@@ -1054,6 +2326,9 @@ gboolean
 _clutter_stage_do_update (ClutterStage *stage)
 {
   ClutterStagePrivate *priv;
+  ClutterAllocPhase old_phase;
+  gint64 start_time;
+  guint n_allocated, n_size_requests, n_cached_size_requests;
 
   g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
 
@@ -1062,18 +2337,49 @@ _clutter_stage_do_update (ClutterStage *stage)
   if (CLUTTER_ACTOR_IN_DESTRUCTION (stage))
     return FALSE;
 
+  /* deliver the results of the asynchronous picks requested before
+   * the previous update, and of the frames captured before it; by now
+   * their read back should be complete */
+  clutter_stage_complete_async_picks (stage);
+  clutter_stage_complete_async_captures (stage);
+  priv->update_serial += 1;
+
+  clutter_stage_trim_offscreen_pool (stage);
+
   /* NB: We need to ensure we have an up to date layout *before* we
    * check or clear the pending redraws flag since a relayout may
    * queue a redraw.
    */
+  start_time = _clutter_util_get_monotonic_time ();
+  n_allocated = _clutter_actor_get_n_allocated ();
+  n_size_requests = _clutter_actor_get_n_size_requests ();
+  n_cached_size_requests = _clutter_actor_get_n_cached_size_requests ();
+  old_phase = _clutter_alloc_phase_push (CLUTTER_ALLOC_PHASE_RELAYOUT);
   _clutter_stage_maybe_relayout (CLUTTER_ACTOR (stage));
+  _clutter_alloc_phase_pop (old_phase);
+  priv->frame_timings.layout_time +=
+    _clutter_util_get_monotonic_time () - start_time;
+  priv->frame_timings.n_allocated_actors +=
+    _clutter_actor_get_n_allocated () - n_allocated;
+  priv->frame_timings.n_size_requests +=
+    _clutter_actor_get_n_size_requests () - n_size_requests;
+  priv->frame_timings.n_cached_size_requests +=
+    _clutter_actor_get_n_cached_size_requests () - n_cached_size_requests;
 
   if (!priv->redraw_pending)
     return FALSE;
 
   _clutter_stage_maybe_finish_queue_redraws (stage);
 
+  old_phase = _clutter_alloc_phase_push (CLUTTER_ALLOC_PHASE_PAINT);
   clutter_stage_do_redraw (stage);
+  _clutter_alloc_phase_pop (old_phase);
+
+  clutter_stage_push_frame_timings (stage);
+  _clutter_startup_first_frame ();
+
+  if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_GPU_TIMINGS))
+    _clutter_gpu_timings_frame_end ();
 
   /* reset the guard, so that new redraws are possible */
   priv->redraw_pending = FALSE;
@@ -1105,6 +2411,26 @@ clutter_stage_real_queue_relayout (ClutterActor *self)
   parent_class->queue_relayout (self);
 }
 
+/* Marks @clip, in window coordinates, as out of date in the retained
+ * pick buffer; a %NULL @clip discards the whole buffer */
+static void
+clutter_stage_add_pick_damage (ClutterStage          *stage,
+                               const ClutterGeometry *clip)
+{
+  ClutterStagePrivate *priv = stage->priv;
+
+  if (!priv->have_retained_pick)
+    return;
+
+  if (clip == NULL)
+    {
+      priv->have_retained_pick = FALSE;
+      return;
+    }
+
+  _clutter_stage_redraw_clips_add (&priv->pick_damage, clip);
+}
+
 static void
 clutter_stage_real_queue_redraw (ClutterActor *actor,
                                  ClutterActor *leaf)
@@ -1125,7 +2451,10 @@ clutter_stage_real_queue_redraw (ClutterActor *actor,
   if (stage_window == NULL)
     return;
 
-  if (_clutter_stage_window_ignoring_redraw_clips (stage_window))
+  /* the retained pick buffer needs the damaged areas even if the
+   * stage window does not */
+  if (_clutter_stage_window_ignoring_redraw_clips (stage_window) &&
+      !stage->priv->have_retained_pick)
     {
       _clutter_stage_window_add_redraw_clip (stage_window, NULL);
       return;
@@ -1137,6 +2466,7 @@ clutter_stage_real_queue_redraw (ClutterActor *actor,
 
   if (!_clutter_actor_get_queue_redraw_clip (leaf))
     {
+      clutter_stage_add_pick_damage (stage, NULL);
       _clutter_stage_window_add_redraw_clip (stage_window, NULL);
       return;
     }
@@ -1154,7 +2484,12 @@ clutter_stage_real_queue_redraw (ClutterActor *actor,
   stage_clip.width = bounding_box.x2 - stage_clip.x;
   stage_clip.height = bounding_box.y2 - stage_clip.y;
 
-  _clutter_stage_window_add_redraw_clip (stage_window, &stage_clip);
+  clutter_stage_add_pick_damage (stage, &stage_clip);
+
+  if (_clutter_stage_window_ignoring_redraw_clips (stage_window))
+    _clutter_stage_window_add_redraw_clip (stage_window, NULL);
+  else
+    _clutter_stage_window_add_redraw_clip (stage_window, &stage_clip);
 }
 
 gboolean
@@ -1205,93 +2540,140 @@ read_pixels_to_file (char *filename_stem,
   read_count++;
 }
 
-ClutterActor *
-_clutter_stage_do_pick (ClutterStage   *stage,
-                        gint            x,
-                        gint            y,
-                        ClutterPickMode mode)
+/* Retrieves the pick id of the actor painted with the color read back
+ * from the pick buffer; the stage itself is identified by -1 */
+static gint32
+clutter_stage_pixel_to_pick_id (const guchar *pixel)
 {
-  ClutterStagePrivate *priv;
-  ClutterMainContext *context;
-  guchar pixel[4] = { 0xff, 0xff, 0xff, 0xff };
-  CoglColor stage_pick_id;
-  guint32 id_;
-  GLboolean dither_was_on;
-  ClutterActor *actor;
-  gboolean is_clipped;
-  CLUTTER_STATIC_COUNTER (do_pick_counter,
-                          "_clutter_stage_do_pick counter",
-                          "Increments for each full pick run",
-                          0 /* no application private data */);
-  CLUTTER_STATIC_TIMER (pick_timer,
-                        "Mainloop", /* parent */
-                        "Picking",
-                        "The time spent picking",
-                        0 /* no application private data */);
-  CLUTTER_STATIC_TIMER (pick_clear,
-                        "Picking", /* parent */
-                        "Stage clear (pick)",
-                        "The time spent clearing stage for picking",
-                        0 /* no application private data */);
-  CLUTTER_STATIC_TIMER (pick_paint,
-                        "Picking", /* parent */
-                        "Painting actors (pick mode)",
-                        "The time spent painting actors in pick mode",
-                        0 /* no application private data */);
-  CLUTTER_STATIC_TIMER (pick_read,
-                        "Picking", /* parent */
-                        "Read Pixels",
-                        "The time spent issuing a read pixels",
-                        0 /* no application private data */);
-
-  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), NULL);
+  if (pixel[0] == 0xff && pixel[1] == 0xff && pixel[2] == 0xff)
+    return -1;
 
-  priv = stage->priv;
+  return _clutter_pixel_to_id ((guchar *) pixel);
+}
 
-  if (G_UNLIKELY (clutter_pick_debug_flags & CLUTTER_DEBUG_NOP_PICKING))
+/* Retrieves the actor with @pick_id; @generation is the generation of
+ * the pick id pool at the time the id was painted, so that an id that
+ * was recycled in the meantime does not resolve to a different actor */
+static ClutterActor *
+clutter_stage_pick_id_to_actor (ClutterStage *stage,
+                                gint32        pick_id,
+                                guint32       generation)
+{
+  if (pick_id < 0)
     return CLUTTER_ACTOR (stage);
 
-#ifdef CLUTTER_ENABLE_PROFILE
-  if (clutter_profile_flags & CLUTTER_PROFILE_PICKING_ONLY)
-    _clutter_profile_resume ();
-#endif /* CLUTTER_ENABLE_PROFILE */
+  return _clutter_id_pool_lookup_generation (stage->priv->pick_id_pool,
+                                             pick_id,
+                                             generation);
+}
 
-  CLUTTER_COUNTER_INC (_clutter_uprof_context, do_pick_counter);
-  CLUTTER_TIMER_START (_clutter_uprof_context, pick_timer);
+/* Tries to find the actor at the given coordinates without rendering
+ * the scene in pick mode; @index_stamp is set to the stamp of the
+ * spatial index query for the coordinates in any case */
+static gboolean
+clutter_stage_do_pick_without_render (ClutterStage     *stage,
+                                      gint              x,
+                                      gint              y,
+                                      ClutterPickMode   mode,
+                                      guint            *index_stamp,
+                                      ClutterActor    **actor_out)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  CLUTTER_STATIC_TIMER (pick_geometric,
+                        "Picking", /* parent */
+                        "Geometric pick",
+                        "The time spent hit-testing actors on the CPU",
+                        0 /* no application private data */);
 
-  context = _clutter_context_get_default ();
+  /* painting in pick mode would do this for us when querying the
+   * allocation of each actor, but the allocation changes have to be
+   * queued as redraws before we look at the spatial index */
+  _clutter_stage_maybe_relayout (CLUTTER_ACTOR (stage));
 
-  /* It's possible that we currently have a static scene and have renderered a
-   * full, unclipped pick buffer. If so we can simply continue to read from
-   * this cached buffer until the scene next changes. */
-  if (_clutter_stage_get_pick_buffer_valid (stage, mode))
+  /* find out which actors covered the point when they were last
+   * painted, so that we can skip the others while picking */
+  *index_stamp = _clutter_stage_index_query_point (stage, x + 0.5f, y + 0.5f);
+
+  /* If the whole scene uses the default pick silhouettes we can avoid
+   * rendering it altogether, and the pipeline stall caused by reading
+   * back the pick buffer, by hit-testing the transformed allocations
+   * of the actors instead; the coordinates are offset to the center
+   * of the pixel, to match what the rasterizer would do. */
+  if (priv->use_geometric_picking)
     {
-      CLUTTER_TIMER_START (_clutter_uprof_context, pick_read);
-      cogl_read_pixels (x, y, 1, 1,
-                        COGL_READ_PIXELS_COLOR_BUFFER,
-                        COGL_PIXEL_FORMAT_RGBA_8888_PRE,
-                        pixel);
-      CLUTTER_TIMER_STOP (_clutter_uprof_context, pick_read);
+      ClutterActor *actor = NULL;
+      gboolean res;
 
-      CLUTTER_NOTE (PICK, "Reusing pick buffer from previous render to fetch "
-                    "actor at %i,%i", x, y);
+      CLUTTER_TIMER_START (_clutter_uprof_context, pick_geometric);
+      res = _clutter_actor_geometric_pick (CLUTTER_ACTOR (stage), mode,
+                                           x + 0.5f, y + 0.5f,
+                                           *index_stamp,
+                                           &actor);
+      CLUTTER_TIMER_STOP (_clutter_uprof_context, pick_geometric);
 
-      /* FIXME: This is a lazy copy and paste of the logic at the end of this
-       * function used when we actually do a pick render. It should be
-       * consolidated somehow.
-       */
-      if (pixel[0] == 0xff && pixel[1] == 0xff && pixel[2] == 0xff)
+      if (res)
         {
-          actor = CLUTTER_ACTOR (stage);
-          goto result;
+          CLUTTER_NOTE (PICK, "Geometric pick at %i,%i", x, y);
+
+          *actor_out = actor != NULL ? actor : CLUTTER_ACTOR (stage);
+
+          return TRUE;
         }
 
-      id_ = _clutter_pixel_to_id (pixel);
-      actor = _clutter_get_actor_by_id (stage, id_);
-      goto result;
+      CLUTTER_NOTE (PICK, "Geometric pick at %i,%i failed, falling back "
+                    "to a pick render", x, y);
+    }
+
+  /* the result of an asynchronous pick is good for as long as the
+   * scene does not change */
+  if (priv->async_pick_result_valid &&
+      priv->async_pick_result.scene_serial == priv->scene_serial &&
+      priv->async_pick_result.mode == mode &&
+      priv->async_pick_result.x == x &&
+      priv->async_pick_result.y == y)
+    {
+      CLUTTER_NOTE (PICK, "Reusing asynchronous pick result at %i,%i", x, y);
+
+      *actor_out =
+        clutter_stage_pick_id_to_actor (stage,
+                                        priv->async_pick_result.pick_id,
+                                        priv->async_pick_result.pick_generation);
+
+      return TRUE;
     }
 
+  return FALSE;
+}
+
+/* Renders the scene in pick mode, so that the actor at the given
+ * coordinates can be read back from the color buffer */
+static void
+clutter_stage_do_pick_render (ClutterStage    *stage,
+                              gint             x,
+                              gint             y,
+                              ClutterPickMode  mode,
+                              guint            index_stamp)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  ClutterMainContext *context;
+  CoglColor stage_pick_id;
+  GLboolean dither_was_on;
+  gboolean is_clipped;
+  CLUTTER_STATIC_TIMER (pick_clear,
+                        "Picking", /* parent */
+                        "Stage clear (pick)",
+                        "The time spent clearing stage for picking",
+                        0 /* no application private data */);
+  CLUTTER_STATIC_TIMER (pick_paint,
+                        "Picking", /* parent */
+                        "Painting actors (pick mode)",
+                        "The time spent painting actors in pick mode",
+                        0 /* no application private data */);
+
+  context = _clutter_context_get_default ();
+
   priv->picks_per_frame++;
+  priv->frame_timings.n_pick_renders += 1;
 
   _clutter_backend_ensure_context (context->backend, stage);
 
@@ -1332,7 +2714,14 @@ _clutter_stage_do_pick (ClutterStage   *stage,
   */
   CLUTTER_TIMER_START (_clutter_uprof_context, pick_paint);
   context->pick_mode = mode;
+  /* a full pick buffer has to contain every actor */
+  if (is_clipped &&
+      G_LIKELY (!(clutter_pick_debug_flags & CLUTTER_DEBUG_DUMP_PICK_BUFFERS)))
+    context->pick_index_stamp = index_stamp;
   _clutter_stage_do_paint (stage, NULL);
+  context->pick_index_stamp = 0;
+  priv->pick_buffer_generation =
+    _clutter_id_pool_get_generation (priv->pick_id_pool);
   context->pick_mode = CLUTTER_PICK_NONE;
   CLUTTER_TIMER_STOP (_clutter_uprof_context, pick_paint);
 
@@ -1347,6 +2736,252 @@ _clutter_stage_do_pick (ClutterStage   *stage,
   else
     _clutter_stage_set_pick_buffer_valid (stage, TRUE, mode);
 
+  /* Restore whether GL_DITHER was enabled */
+  if (dither_was_on)
+    glEnable (GL_DITHER);
+}
+
+/* Paints the scene in pick mode into the area @clip, in window
+ * coordinates, of the current framebuffer, or into all of it if
+ * @clip is %NULL */
+static void
+clutter_stage_paint_retained_pick (ClutterStage          *stage,
+                                   ClutterPickMode        mode,
+                                   const ClutterGeometry *clip)
+{
+  ClutterMainContext *context = _clutter_context_get_default ();
+  CoglColor stage_pick_id;
+
+  if (clip != NULL)
+    cogl_clip_push_window_rectangle (clip->x, clip->y,
+                                     clip->width, clip->height);
+
+  cogl_color_init_from_4ub (&stage_pick_id, 255, 255, 255, 255);
+  cogl_clear (&stage_pick_id, COGL_BUFFER_BIT_COLOR);
+
+  context->pick_mode = mode;
+  _clutter_stage_do_paint (stage, NULL);
+  context->pick_mode = CLUTTER_PICK_NONE;
+
+  if (clip != NULL)
+    cogl_clip_pop ();
+}
+
+/* Painting the scene clears the pick render in the back buffer, so
+ * when picks keep coming over several frames the stage renders them
+ * into an offscreen target instead, which it keeps in its pool
+ * between picks. The redraws queued since then damage the areas they
+ * cover, which are only painted again when a pick falls inside them;
+ * the other picks are read from the target as it is.
+ *
+ * Returns %FALSE if the target cannot be used, in which case the
+ * caller should render the pick in the back buffer */
+static gboolean
+clutter_stage_read_retained_pick (ClutterStage     *stage,
+                                  gint              x,
+                                  gint              y,
+                                  ClutterPickMode   mode,
+                                  ClutterActor    **actor_out)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  ClutterMainContext *context;
+  ClutterStageOffscreen *offscreen;
+  guchar pixel[4] = { 0xff, 0xff, 0xff, 0xff };
+  gboolean full_repaint, damaged;
+  gint width, height;
+  guint i;
+
+  if (!cogl_features_available (COGL_FEATURE_OFFSCREEN) ||
+      G_UNLIKELY (clutter_pick_debug_flags & CLUTTER_DEBUG_DUMP_PICK_BUFFERS))
+    return FALSE;
+
+  /* the areas damaged by the queued redraws are only known once they
+   * have been processed by the next update */
+  if (priv->n_pending_queue_redraws > 0)
+    return FALSE;
+
+  width = priv->viewport[2];
+  height = priv->viewport[3];
+  if (width <= 0 || height <= 0)
+    return FALSE;
+
+  context = _clutter_context_get_default ();
+  _clutter_backend_ensure_context (context->backend, stage);
+
+  offscreen = _clutter_stage_reclaim_offscreen (stage, stage,
+                                                width, height,
+                                                COGL_PIXEL_FORMAT_RGBA_8888_PRE);
+
+  full_repaint = offscreen == NULL ||
+                 !priv->have_retained_pick ||
+                 priv->retained_pick_mode != mode;
+
+  if (full_repaint)
+    {
+      priv->have_retained_pick = FALSE;
+
+      /* the first pick of a frame is cheaper to render clipped to
+       * its pixel in the back buffer */
+      if (priv->picks_per_frame < 1)
+        {
+          if (offscreen != NULL)
+            _clutter_stage_release_offscreen (stage, offscreen, NULL);
+
+          return FALSE;
+        }
+
+      if (offscreen == NULL)
+        offscreen =
+          _clutter_stage_acquire_offscreen (stage, width, height,
+                                            COGL_PIXEL_FORMAT_RGBA_8888_PRE);
+
+      if (offscreen == NULL)
+        return FALSE;
+    }
+
+  damaged = FALSE;
+  for (i = 0; i < priv->pick_damage.n_rects && !full_repaint; i++)
+    {
+      const ClutterGeometry *rect = &priv->pick_damage.rects[i];
+
+      if (x >= rect->x && x < rect->x + (gint) rect->width &&
+          y >= rect->y && y < rect->y + (gint) rect->height)
+        damaged = TRUE;
+    }
+
+  cogl_push_framebuffer (offscreen->framebuffer);
+
+  if (full_repaint || damaged)
+    {
+      GLboolean dither_was_on;
+
+      priv->picks_per_frame++;
+      priv->frame_timings.n_pick_renders += 1;
+
+      CLUTTER_NOTE (PICK, "Painting %s of the retained pick buffer",
+                    full_repaint ? "all" : "the damaged areas");
+
+      _clutter_stage_maybe_setup_viewport (stage);
+
+      cogl_disable_fog ();
+
+      dither_was_on = glIsEnabled (GL_DITHER);
+      if (dither_was_on)
+        glDisable (GL_DITHER);
+
+      if (full_repaint)
+        clutter_stage_paint_retained_pick (stage, mode, NULL);
+      else
+        {
+          for (i = 0; i < priv->pick_damage.n_rects; i++)
+            clutter_stage_paint_retained_pick (stage, mode,
+                                               &priv->pick_damage.rects[i]);
+        }
+
+      if (dither_was_on)
+        glEnable (GL_DITHER);
+
+      /* the areas that were not painted again do not contain any
+       * actor that released its pick id, since releasing it queues
+       * a redraw */
+      priv->retained_pick_generation =
+        _clutter_id_pool_get_generation (priv->pick_id_pool);
+      priv->retained_pick_mode = mode;
+      priv->pick_damage.n_rects = 0;
+      priv->have_retained_pick = TRUE;
+    }
+  else
+    CLUTTER_NOTE (PICK, "Reusing the retained pick buffer to fetch the "
+                  "actor at %i,%i", x, y);
+
+  cogl_read_pixels (x, y, 1, 1,
+                    COGL_READ_PIXELS_COLOR_BUFFER,
+                    COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                    pixel);
+
+  cogl_pop_framebuffer ();
+
+  _clutter_stage_release_offscreen (stage, offscreen, stage);
+
+  *actor_out =
+    clutter_stage_pick_id_to_actor (stage,
+                                    clutter_stage_pixel_to_pick_id (pixel),
+                                    priv->retained_pick_generation);
+
+  return TRUE;
+}
+
+static ClutterActor *
+clutter_stage_do_pick_real (ClutterStage   *stage,
+                            gint            x,
+                            gint            y,
+                            ClutterPickMode mode)
+{
+  guchar pixel[4] = { 0xff, 0xff, 0xff, 0xff };
+  ClutterActor *actor;
+  guint index_stamp;
+  gint32 pick_id;
+  CLUTTER_STATIC_COUNTER (do_pick_counter,
+                          "_clutter_stage_do_pick counter",
+                          "Increments for each full pick run",
+                          0 /* no application private data */);
+  CLUTTER_STATIC_TIMER (pick_timer,
+                        "Mainloop", /* parent */
+                        "Picking",
+                        "The time spent picking",
+                        0 /* no application private data */);
+  CLUTTER_STATIC_TIMER (pick_read,
+                        "Picking", /* parent */
+                        "Read Pixels",
+                        "The time spent issuing a read pixels",
+                        0 /* no application private data */);
+
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), NULL);
+
+  if (G_UNLIKELY (clutter_pick_debug_flags & CLUTTER_DEBUG_NOP_PICKING))
+    return CLUTTER_ACTOR (stage);
+
+#ifdef CLUTTER_ENABLE_PROFILE
+  if (clutter_profile_flags & CLUTTER_PROFILE_PICKING_ONLY)
+    _clutter_profile_resume ();
+#endif /* CLUTTER_ENABLE_PROFILE */
+
+  CLUTTER_COUNTER_INC (_clutter_uprof_context, do_pick_counter);
+  CLUTTER_TIMER_START (_clutter_uprof_context, pick_timer);
+
+  stage->priv->frame_timings.n_picks += 1;
+
+  if (clutter_stage_do_pick_without_render (stage, x, y, mode,
+                                            &index_stamp,
+                                            &actor))
+    goto result;
+
+  if (clutter_stage_read_retained_pick (stage, x, y, mode, &actor))
+    goto result;
+
+  /* It's possible that we currently have a static scene and have renderered a
+   * full, unclipped pick buffer. If so we can simply continue to read from
+   * this cached buffer until the scene next changes. */
+  if (_clutter_stage_get_pick_buffer_valid (stage, mode))
+    {
+      CLUTTER_TIMER_START (_clutter_uprof_context, pick_read);
+      cogl_read_pixels (x, y, 1, 1,
+                        COGL_READ_PIXELS_COLOR_BUFFER,
+                        COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                        pixel);
+      CLUTTER_TIMER_STOP (_clutter_uprof_context, pick_read);
+
+      CLUTTER_NOTE (PICK, "Reusing pick buffer from previous render to fetch "
+                    "actor at %i,%i", x, y);
+
+      pick_id = clutter_stage_pixel_to_pick_id (pixel);
+      actor = clutter_stage_pick_id_to_actor (stage, pick_id,
+                                              stage->priv->pick_buffer_generation);
+      goto result;
+    }
+
+  clutter_stage_do_pick_render (stage, x, y, mode, index_stamp);
+
   /* Read the color of the screen co-ords pixel. RGBA_8888_PRE is used
      even though we don't care about the alpha component because under
      GLES this is the only format that is guaranteed to work so Cogl
@@ -1368,18 +3003,9 @@ _clutter_stage_do_pick (ClutterStage   *stage,
                            clutter_actor_get_height (CLUTTER_ACTOR (stage)));
     }
 
-  /* Restore whether GL_DITHER was enabled */
-  if (dither_was_on)
-    glEnable (GL_DITHER);
-
-  if (pixel[0] == 0xff && pixel[1] == 0xff && pixel[2] == 0xff)
-    {
-      actor = CLUTTER_ACTOR (stage);
-      goto result;
-    }
-
-  id_ = _clutter_pixel_to_id (pixel);
-  actor = _clutter_get_actor_by_id (stage, id_);
+  pick_id = clutter_stage_pixel_to_pick_id (pixel);
+  actor = clutter_stage_pick_id_to_actor (stage, pick_id,
+                                          stage->priv->pick_buffer_generation);
 
 result:
 
@@ -1393,262 +3019,972 @@ result:
   return actor;
 }
 
-
-
-static gboolean
-clutter_stage_real_delete_event (ClutterStage *stage,
-                                 ClutterEvent *event)
+ClutterActor *
+_clutter_stage_do_pick (ClutterStage   *stage,
+                        gint            x,
+                        gint            y,
+                        ClutterPickMode mode)
 {
-  if (clutter_stage_is_default (stage))
-    clutter_main_quit ();
-  else
-    clutter_actor_destroy (CLUTTER_ACTOR (stage));
+  ClutterAllocPhase old_phase;
+  ClutterActor *actor;
 
-  return TRUE;
+  old_phase = _clutter_alloc_phase_push (CLUTTER_ALLOC_PHASE_PICK);
+  actor = clutter_stage_do_pick_real (stage, x, y, mode);
+  _clutter_alloc_phase_pop (old_phase);
+
+  return actor;
 }
 
-static void
-clutter_stage_real_apply_transform (ClutterActor *stage,
-                                    CoglMatrix   *matrix)
+/*< private >
+ * _clutter_stage_get_scene_serial:
+ * @stage: a #ClutterStage
+ *
+ * Retrieves a serial number that changes every time a redraw is
+ * queued on @stage; while it stays the same, the results of a pick
+ * do not change either
+ *
+ * Return value: the serial number of the scene
+ */
+guint
+_clutter_stage_get_scene_serial (ClutterStage *stage)
 {
-  ClutterStagePrivate *priv = CLUTTER_STAGE (stage)->priv;
-
-  /* FIXME: we probably shouldn't be explicitly reseting the matrix
-   * here... */
-  cogl_matrix_init_identity (matrix);
-  cogl_matrix_multiply (matrix, matrix, &priv->view);
+  return stage->priv->scene_serial;
 }
 
-static void
-clutter_stage_set_property (GObject      *object,
-			    guint         prop_id,
-			    const GValue *value,
-			    GParamSpec   *pspec)
+/*< private >
+ * _clutter_stage_invalidate_pick:
+ * @stage: a #ClutterStage
+ *
+ * Discards the cached pick results of @stage, for the changes that
+ * affect picking without queueing a redraw, like the reactive flag
+ * of an actor
+ */
+void
+_clutter_stage_invalidate_pick (ClutterStage *stage)
 {
-  ClutterStage *stage = CLUTTER_STAGE (object);
+  ClutterStagePrivate *priv = stage->priv;
 
-  switch (prop_id)
-    {
-    case PROP_COLOR:
-      clutter_stage_set_color (stage, clutter_value_get_color (value));
-      break;
+  _clutter_stage_set_pick_buffer_valid (stage, FALSE, -1);
+  priv->have_retained_pick = FALSE;
+  priv->scene_serial += 1;
+}
 
-    case PROP_OFFSCREEN:
-      if (g_value_get_boolean (value))
-        g_warning ("Offscreen stages are currently not supported\n");
-      break;
+/*< private >
+ * _clutter_stage_get_projection_serial:
+ * @stage: a #ClutterStage
+ *
+ * Retrieves a serial number that changes every time the projection,
+ * the view or the viewport of @stage change; while it stays the same,
+ * the screen position of an actor only depends on its transformation
+ * relative to the stage
+ *
+ * Return value: the serial number of the projection
+ */
+guint
+_clutter_stage_get_projection_serial (ClutterStage *stage)
+{
+  return stage->priv->projection_serial;
+}
 
-    case PROP_CURSOR_VISIBLE:
-      if (g_value_get_boolean (value))
-        clutter_stage_show_cursor (stage);
-      else
-        clutter_stage_hide_cursor (stage);
-      break;
+/* Asynchronous picking
+ *
+ * Reading back the pick buffer with cogl_read_pixels() blocks until
+ * the GPU has finished rendering the pick, so when the driver allows
+ * it we read the pixel into a pixel buffer object instead, and only
+ * map the buffer when the master clock updates the stage again.
+ */
+#ifdef COGL_HAS_GL
 
-    case PROP_PERSPECTIVE:
-      clutter_stage_set_perspective (stage, g_value_get_boxed (value));
-      break;
+#ifndef APIENTRY
+#define APIENTRY
+#endif
 
-    case PROP_TITLE:
-      clutter_stage_set_title (stage, g_value_get_string (value));
-      break;
+#ifndef GL_PIXEL_PACK_BUFFER
+#define GL_PIXEL_PACK_BUFFER    0x88EB
+#endif
+#ifndef GL_STREAM_READ
+#define GL_STREAM_READ          0x88E1
+#endif
+#ifndef GL_READ_ONLY
+#define GL_READ_ONLY            0x88B8
+#endif
 
-    case PROP_USER_RESIZABLE:
-      clutter_stage_set_user_resizable (stage, g_value_get_boolean (value));
-      break;
+typedef void      (APIENTRY *GenBuffersFunc)    (GLsizei       n,
+                                                 GLuint       *buffers);
+typedef void      (APIENTRY *DeleteBuffersFunc) (GLsizei       n,
+                                                 const GLuint *buffers);
+typedef void      (APIENTRY *BindBufferFunc)    (GLenum        target,
+                                                 GLuint        buffer);
+typedef void      (APIENTRY *BufferDataFunc)    (GLenum        target,
+                                                 gssize        size,
+                                                 const GLvoid *data,
+                                                 GLenum        usage);
+typedef GLvoid *  (APIENTRY *MapBufferFunc)     (GLenum        target,
+                                                 GLenum        access);
+typedef GLboolean (APIENTRY *UnmapBufferFunc)   (GLenum        target);
+
+typedef struct _PickBufferFuncs
+{
+  GenBuffersFunc gen_buffers;
+  DeleteBuffersFunc delete_buffers;
+  BindBufferFunc bind_buffer;
+  BufferDataFunc buffer_data;
+  MapBufferFunc map_buffer;
+  UnmapBufferFunc unmap_buffer;
+} PickBufferFuncs;
+
+/* Returns the GL entry points needed to read back into a pixel
+ * buffer, or %NULL if the driver does not support it */
+static const PickBufferFuncs *
+get_pick_buffer_funcs (void)
+{
+  static PickBufferFuncs funcs = { NULL, };
+  static gboolean initialized = FALSE;
+  static gboolean supported = FALSE;
+
+  if (G_LIKELY (initialized))
+    return supported ? &funcs : NULL;
+
+  initialized = TRUE;
+
+  if (!cogl_features_available (COGL_FEATURE_PBOS))
+    return NULL;
+
+  funcs.gen_buffers =
+    (GenBuffersFunc) cogl_get_proc_address ("glGenBuffers");
+  funcs.delete_buffers =
+    (DeleteBuffersFunc) cogl_get_proc_address ("glDeleteBuffers");
+  funcs.bind_buffer =
+    (BindBufferFunc) cogl_get_proc_address ("glBindBuffer");
+  funcs.buffer_data =
+    (BufferDataFunc) cogl_get_proc_address ("glBufferData");
+  funcs.map_buffer =
+    (MapBufferFunc) cogl_get_proc_address ("glMapBuffer");
+  funcs.unmap_buffer =
+    (UnmapBufferFunc) cogl_get_proc_address ("glUnmapBuffer");
+
+  supported = funcs.gen_buffers != NULL &&
+              funcs.delete_buffers != NULL &&
+              funcs.bind_buffer != NULL &&
+              funcs.buffer_data != NULL &&
+              funcs.map_buffer != NULL &&
+              funcs.unmap_buffer != NULL;
+
+  CLUTTER_NOTE (PICK, "Asynchronous pick read back %s",
+                supported ? "supported" : "not supported");
+
+  return supported ? &funcs : NULL;
+}
 
-    case PROP_USE_FOG:
-      clutter_stage_set_use_fog (stage, g_value_get_boolean (value));
-      break;
+/* Returns a pixel buffer from the pool of @stage, or a new one */
+static GLuint
+clutter_stage_acquire_pixel_buffer (ClutterStage          *stage,
+                                    const PickBufferFuncs *funcs)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  GLuint pbo;
 
-    case PROP_FOG:
-      clutter_stage_set_fog (stage, g_value_get_boxed (value));
-      break;
+  if (priv->pixel_buffers != NULL && priv->pixel_buffers->len > 0)
+    {
+      guint last = priv->pixel_buffers->len - 1;
 
-    case PROP_USE_ALPHA:
-      clutter_stage_set_use_alpha (stage, g_value_get_boolean (value));
-      break;
+      pbo = g_array_index (priv->pixel_buffers, GLuint, last);
+      g_array_set_size (priv->pixel_buffers, last);
+    }
+  else
+    funcs->gen_buffers (1, &pbo);
 
-    case PROP_KEY_FOCUS:
-      clutter_stage_set_key_focus (stage, g_value_get_object (value));
-      break;
+  return pbo;
+}
 
-    case PROP_NO_CLEAR_HINT:
-      clutter_stage_set_no_clear_hint (stage, g_value_get_boolean (value));
-      break;
+/* Puts @pbo back into the pool of @stage, so that the next read backs
+ * do not need to allocate a new buffer */
+static void
+clutter_stage_release_pixel_buffer (ClutterStage          *stage,
+                                    const PickBufferFuncs *funcs,
+                                    GLuint                 pbo)
+{
+  ClutterStagePrivate *priv = stage->priv;
 
-    case PROP_ACCEPT_FOCUS:
-      clutter_stage_set_accept_focus (stage, g_value_get_boolean (value));
-      break;
+  /* the pool has already been released */
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (stage))
+    {
+      funcs->delete_buffers (1, &pbo);
+      return;
+    }
 
-    default:
-      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
-      break;
-  }
+  if (priv->pixel_buffers == NULL)
+    priv->pixel_buffers = g_array_new (FALSE, FALSE, sizeof (GLuint));
+
+  g_array_append_val (priv->pixel_buffers, pbo);
 }
 
+#endif /* COGL_HAS_GL */
+
+/* Starts reading back the pixel of @pick from the pick render */
 static void
-clutter_stage_get_property (GObject    *gobject,
-			    guint       prop_id,
-			    GValue     *value,
-			    GParamSpec *pspec)
+clutter_stage_begin_async_pick_read (ClutterStage          *stage,
+                                     ClutterStageAsyncPick *pick)
 {
-  ClutterStagePrivate *priv = CLUTTER_STAGE (gobject)->priv;
+  guchar pixel[4] = { 0xff, 0xff, 0xff, 0xff };
+#ifdef COGL_HAS_GL
+  const PickBufferFuncs *funcs = get_pick_buffer_funcs ();
 
-  switch (prop_id)
+  if (funcs != NULL)
     {
-    case PROP_COLOR:
-      clutter_value_set_color (value, &priv->color);
-      break;
+      ClutterStagePrivate *priv = stage->priv;
+      GLuint pbo = clutter_stage_acquire_pixel_buffer (stage, funcs);
 
-    case PROP_OFFSCREEN:
-      g_value_set_boolean (value, FALSE);
-      break;
+      /* this also flushes the pick render */
+      cogl_begin_gl ();
 
-    case PROP_FULLSCREEN_SET:
-      g_value_set_boolean (value, priv->is_fullscreen);
-      break;
+      funcs->bind_buffer (GL_PIXEL_PACK_BUFFER, pbo);
+      funcs->buffer_data (GL_PIXEL_PACK_BUFFER, 4, NULL, GL_STREAM_READ);
 
-    case PROP_CURSOR_VISIBLE:
-      g_value_set_boolean (value, priv->is_cursor_visible);
-      break;
+      /* unlike Cogl, GL puts the origin of the window in the bottom
+       * left corner */
+      glReadPixels (pick->result.x,
+                    (gint) priv->viewport[3] - pick->result.y - 1,
+                    1, 1,
+                    GL_RGBA, GL_UNSIGNED_BYTE,
+                    NULL);
 
-    case PROP_PERSPECTIVE:
-      g_value_set_boxed (value, &priv->perspective);
-      break;
+      funcs->bind_buffer (GL_PIXEL_PACK_BUFFER, 0);
 
-    case PROP_TITLE:
-      g_value_set_string (value, priv->title);
-      break;
+      cogl_end_gl ();
 
-    case PROP_USER_RESIZABLE:
-      g_value_set_boolean (value, priv->is_user_resizable);
-      break;
+      pick->pbo = pbo;
 
-    case PROP_USE_FOG:
-      g_value_set_boolean (value, priv->use_fog);
-      break;
+      return;
+    }
+#endif /* COGL_HAS_GL */
 
-    case PROP_FOG:
-      g_value_set_boxed (value, &priv->fog);
-      break;
+  /* without pixel buffers we have to block now, but the result is
+   * still delivered on the next update */
+  cogl_read_pixels (pick->result.x, pick->result.y, 1, 1,
+                    COGL_READ_PIXELS_COLOR_BUFFER,
+                    COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                    pixel);
 
-    case PROP_USE_ALPHA:
-      g_value_set_boolean (value, priv->use_alpha);
-      break;
+  pick->result.pick_id = clutter_stage_pixel_to_pick_id (pixel);
+}
 
-    case PROP_KEY_FOCUS:
-      g_value_set_object (value, priv->key_focused_actor);
-      break;
+/* Retrieves the pixel read back by clutter_stage_begin_async_pick_read()
+ * and releases the pixel buffer, if any */
+static void
+clutter_stage_end_async_pick_read (ClutterStage          *stage,
+                                   ClutterStageAsyncPick *pick,
+                                   gboolean               read_result)
+{
+#ifdef COGL_HAS_GL
+  const PickBufferFuncs *funcs;
+  const guchar *pixel;
 
-    case PROP_NO_CLEAR_HINT:
-      {
-        gboolean hint =
-          (priv->stage_hints & CLUTTER_STAGE_NO_CLEAR_ON_PAINT) != 0;
+  if (pick->pbo == 0)
+    return;
 
-        g_value_set_boolean (value, hint);
-      }
-      break;
+  funcs = get_pick_buffer_funcs ();
 
-    case PROP_ACCEPT_FOCUS:
-      g_value_set_boolean (value, priv->accept_focus);
-      break;
+  if (read_result)
+    {
+      funcs->bind_buffer (GL_PIXEL_PACK_BUFFER, pick->pbo);
 
-    default:
-      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
-      break;
+      pixel = funcs->map_buffer (GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+      if (pixel != NULL)
+        {
+          pick->result.pick_id = clutter_stage_pixel_to_pick_id (pixel);
+          funcs->unmap_buffer (GL_PIXEL_PACK_BUFFER);
+        }
+      else
+        pick->result.pick_id = -1;
+
+      funcs->bind_buffer (GL_PIXEL_PACK_BUFFER, 0);
+
+      clutter_stage_release_pixel_buffer (stage, funcs, pick->pbo);
     }
+  else
+    funcs->delete_buffers (1, &pick->pbo);
+
+  pick->pbo = 0;
+#endif /* COGL_HAS_GL */
 }
 
 static void
-clutter_stage_dispose (GObject *object)
+clutter_stage_async_pick_free (ClutterStageAsyncPick *pick)
+{
+  if (pick->notify != NULL)
+    pick->notify (pick->user_data);
+
+  g_slice_free (ClutterStageAsyncPick, pick);
+}
+
+/* Delivers the results of the asynchronous picks that were requested
+ * before the last update of @stage */
+static void
+clutter_stage_complete_async_picks (ClutterStage *stage)
 {
-  ClutterStage        *stage = CLUTTER_STAGE (object);
   ClutterStagePrivate *priv = stage->priv;
-  ClutterStageManager *stage_manager;
+  GList *ready = NULL;
+  GList *l, *next;
 
-  clutter_actor_hide (CLUTTER_ACTOR (object));
+  if (priv->async_picks == NULL)
+    return;
 
-  stage_manager = clutter_stage_manager_get_default ();
-  _clutter_stage_manager_remove_stage (stage_manager, stage);
+  for (l = priv->async_picks; l != NULL; l = next)
+    {
+      ClutterStageAsyncPick *pick = l->data;
 
-  _clutter_clear_events_queue_for_stage (stage);
+      next = l->next;
 
-  if (priv->impl != NULL)
+      if (pick->update_serial == priv->update_serial)
+        continue;
+
+      priv->async_picks = g_list_delete_link (priv->async_picks, l);
+
+      clutter_stage_end_async_pick_read (stage, pick, TRUE);
+
+      /* nothing changed since the pick render, so we can use the
+       * result for the synchronous picks as well */
+      if (pick->result.scene_serial == priv->scene_serial)
+        {
+          priv->async_pick_result = pick->result;
+          priv->async_pick_result_valid = TRUE;
+        }
+
+      ready = g_list_prepend (ready, pick);
+    }
+
+  ready = g_list_reverse (ready);
+
+  /* the callbacks might request new picks, or destroy the stage */
+  g_object_ref (stage);
+
+  for (l = ready; l != NULL; l = l->next)
     {
-      CLUTTER_NOTE (BACKEND, "Disposing of the stage implementation");
+      ClutterStageAsyncPick *pick = l->data;
+      ClutterActor *actor;
 
-      _clutter_stage_window_unrealize (priv->impl);
-      g_object_unref (priv->impl);
-      priv->impl = NULL;
+      actor = clutter_stage_pick_id_to_actor (stage,
+                                              pick->result.pick_id,
+                                              pick->result.pick_generation);
+
+      CLUTTER_NOTE (PICK, "Asynchronous pick at %i,%i: %s",
+                    pick->result.x, pick->result.y,
+                    actor != NULL ? _clutter_actor_get_debug_name (actor)
+                                  : "<none>");
+
+      pick->func (stage, actor, pick->user_data);
+
+      clutter_stage_async_pick_free (pick);
     }
 
-  G_OBJECT_CLASS (clutter_stage_parent_class)->dispose (object);
+  g_list_free (ready);
+
+  g_object_unref (stage);
 }
 
+/* Cancels the pending asynchronous picks and releases the pixel
+ * buffers used by them */
 static void
-clutter_stage_finalize (GObject *object)
+clutter_stage_free_async_picks (ClutterStage *stage)
 {
-  ClutterStage *stage = CLUTTER_STAGE (object);
   ClutterStagePrivate *priv = stage->priv;
+  GList *l;
 
-  g_queue_foreach (priv->event_queue, (GFunc) clutter_event_free, NULL);
-  g_queue_free (priv->event_queue);
+  for (l = priv->async_picks; l != NULL; l = l->next)
+    {
+      ClutterStageAsyncPick *pick = l->data;
 
-  g_free (priv->title);
+      clutter_stage_end_async_pick_read (stage, pick, FALSE);
+      clutter_stage_async_pick_free (pick);
+    }
 
-  g_array_free (priv->paint_volume_stack, TRUE);
+  g_list_free (priv->async_picks);
+  priv->async_picks = NULL;
+}
 
-  g_hash_table_destroy (priv->devices);
+/* Releases the pool of pixel buffers of @stage */
+static void
+clutter_stage_free_pixel_buffers (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
 
-  _clutter_id_pool_free (priv->pick_id_pool);
+  if (priv->pixel_buffers == NULL)
+    return;
 
-  if (priv->fps_timer != NULL)
-    g_timer_destroy (priv->fps_timer);
+#ifdef COGL_HAS_GL
+  {
+    const PickBufferFuncs *funcs = get_pick_buffer_funcs ();
 
-  G_OBJECT_CLASS (clutter_stage_parent_class)->finalize (object);
+    if (funcs != NULL && priv->pixel_buffers->len > 0)
+      funcs->delete_buffers (priv->pixel_buffers->len,
+                             (GLuint *) priv->pixel_buffers->data);
+  }
+#endif /* COGL_HAS_GL */
+
+  g_array_free (priv->pixel_buffers, TRUE);
+  priv->pixel_buffers = NULL;
 }
 
+/* Starts reading back the pixels of @rect from the frame being painted */
 static void
-clutter_stage_class_init (ClutterStageClass *klass)
+clutter_stage_begin_capture_read (ClutterStage            *stage,
+                                  ClutterStageCaptureRect *rect)
 {
-  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
-  ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
-  GParamSpec *pspec;
+  gsize size = (gsize) rect->area.width * rect->area.height * 4;
+#ifdef COGL_HAS_GL
+  const PickBufferFuncs *funcs = get_pick_buffer_funcs ();
 
-  gobject_class->set_property = clutter_stage_set_property;
-  gobject_class->get_property = clutter_stage_get_property;
-  gobject_class->dispose = clutter_stage_dispose;
-  gobject_class->finalize = clutter_stage_finalize;
+  if (funcs != NULL)
+    {
+      ClutterStagePrivate *priv = stage->priv;
+      GLuint pbo = clutter_stage_acquire_pixel_buffer (stage, funcs);
 
-  actor_class->allocate = clutter_stage_allocate;
-  actor_class->get_preferred_width = clutter_stage_get_preferred_width;
-  actor_class->get_preferred_height = clutter_stage_get_preferred_height;
-  actor_class->paint = clutter_stage_paint;
-  actor_class->pick = clutter_stage_pick;
-  actor_class->get_paint_volume = clutter_stage_get_paint_volume;
-  actor_class->realize = clutter_stage_realize;
-  actor_class->unrealize = clutter_stage_unrealize;
-  actor_class->show = clutter_stage_show;
-  actor_class->hide = clutter_stage_hide;
-  actor_class->queue_relayout = clutter_stage_real_queue_relayout;
-  actor_class->queue_redraw = clutter_stage_real_queue_redraw;
-  actor_class->apply_transform = clutter_stage_real_apply_transform;
+      /* this also flushes the frame */
+      cogl_begin_gl ();
 
-  /**
-   * ClutterStage:fullscreen:
-   *
-   * Whether the stage should be fullscreen or not.
-   *
-   * This property is set by calling clutter_stage_set_fullscreen()
-   * but since the actual implementation is delegated to the backend
-   * you should connect to the notify::fullscreen-set signal in order
-   * to get notification if the fullscreen state has been successfully
-   * achieved.
-   *
-   * Since: 1.0
-   */
-  pspec = g_param_spec_boolean ("fullscreen-set",
+      funcs->bind_buffer (GL_PIXEL_PACK_BUFFER, pbo);
+      funcs->buffer_data (GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+
+      glPixelStorei (GL_PACK_ALIGNMENT, 4);
+
+      /* the rows are stored bottom to top, the order is reversed
+       * using a negative rowstride when the pixels are delivered */
+      glReadPixels (rect->area.x,
+                    (gint) priv->viewport[3]
+                    - rect->area.y
+                    - (gint) rect->area.height,
+                    rect->area.width, rect->area.height,
+                    GL_RGBA, GL_UNSIGNED_BYTE,
+                    NULL);
+
+      funcs->bind_buffer (GL_PIXEL_PACK_BUFFER, 0);
+
+      cogl_end_gl ();
+
+      rect->pbo = pbo;
+
+      return;
+    }
+#endif /* COGL_HAS_GL */
+
+  /* without pixel buffers we have to block now, but the pixels are
+   * still delivered on the next updates */
+  rect->pixels = g_malloc (size);
+
+  cogl_read_pixels (rect->area.x, rect->area.y,
+                    rect->area.width, rect->area.height,
+                    COGL_READ_PIXELS_COLOR_BUFFER,
+                    COGL_PIXEL_FORMAT_RGBA_8888,
+                    rect->pixels);
+}
+
+/* Passes the pixels of @rect to the function of @capture, if
+ * @deliver is set, and releases the memory holding them */
+static void
+clutter_stage_end_capture_read (ClutterStage             *stage,
+                                ClutterStageAsyncCapture *capture,
+                                ClutterStageCaptureRect  *rect,
+                                gboolean                  deliver)
+{
+  gint rowstride = rect->area.width * 4;
+
+#ifdef COGL_HAS_GL
+  if (rect->pbo != 0)
+    {
+      const PickBufferFuncs *funcs = get_pick_buffer_funcs ();
+      const guchar *data = NULL;
+
+      if (deliver)
+        {
+          funcs->bind_buffer (GL_PIXEL_PACK_BUFFER, rect->pbo);
+          data = funcs->map_buffer (GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+
+          /* the function might read pixels itself, which must not end
+           * up in our buffer */
+          funcs->bind_buffer (GL_PIXEL_PACK_BUFFER, 0);
+        }
+
+      if (data != NULL)
+        {
+          capture->func (stage, &rect->area,
+                         data + (rect->area.height - 1) * rowstride,
+                         -rowstride,
+                         capture->user_data);
+
+          funcs->bind_buffer (GL_PIXEL_PACK_BUFFER, rect->pbo);
+          funcs->unmap_buffer (GL_PIXEL_PACK_BUFFER);
+          funcs->bind_buffer (GL_PIXEL_PACK_BUFFER, 0);
+        }
+
+      if (deliver)
+        clutter_stage_release_pixel_buffer (stage, funcs, rect->pbo);
+      else
+        funcs->delete_buffers (1, &rect->pbo);
+
+      rect->pbo = 0;
+
+      return;
+    }
+#endif /* COGL_HAS_GL */
+
+  if (deliver)
+    capture->func (stage, &rect->area,
+                   rect->pixels,
+                   rowstride,
+                   capture->user_data);
+
+  g_free (rect->pixels);
+  rect->pixels = NULL;
+}
+
+static void
+clutter_stage_async_capture_free (ClutterStageAsyncCapture *capture)
+{
+  if (capture->notify != NULL)
+    capture->notify (capture->user_data);
+
+  g_array_free (capture->rects, TRUE);
+
+  g_slice_free (ClutterStageAsyncCapture, capture);
+}
+
+/* Starts reading back the frame that was just painted for the
+ * asynchronous captures that are waiting for it */
+static void
+clutter_stage_capture_frame (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  const ClutterGeometry *clip = &priv->current_clip;
+  GList *l;
+
+  for (l = priv->async_captures; l != NULL; l = l->next)
+    {
+      ClutterStageAsyncCapture *capture = l->data;
+      ClutterStageCaptureRect rect = { { 0, }, 0, NULL };
+      gint x1, y1, x2, y2;
+
+      /* a frame is painted once for each of its redraw clips, but a
+       * capture does not span several frames */
+      if (capture->rects->len > 0 &&
+          capture->update_serial != priv->update_serial)
+        continue;
+
+      x1 = MAX (capture->area.x, clip->x);
+      y1 = MAX (capture->area.y, clip->y);
+      x2 = MIN (capture->area.x + (gint) capture->area.width,
+                clip->x + (gint) clip->width);
+      y2 = MIN (capture->area.y + (gint) capture->area.height,
+                clip->y + (gint) clip->height);
+
+      if (capture->damage_only)
+        {
+          if (x2 <= x1 || y2 <= y1)
+            continue;
+        }
+      else
+        {
+          /* the rest of the area might not have been painted */
+          if (x1 != capture->area.x ||
+              y1 != capture->area.y ||
+              x2 - x1 != (gint) capture->area.width ||
+              y2 - y1 != (gint) capture->area.height)
+            continue;
+        }
+
+      rect.area.x = x1;
+      rect.area.y = y1;
+      rect.area.width = x2 - x1;
+      rect.area.height = y2 - y1;
+
+      clutter_stage_begin_capture_read (stage, &rect);
+
+      g_array_append_val (capture->rects, rect);
+      capture->update_serial = priv->update_serial;
+    }
+}
+
+/* Delivers the frames captured before the last update of @stage */
+static void
+clutter_stage_complete_async_captures (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  GList *ready = NULL;
+  GList *l, *next;
+
+  if (priv->async_captures == NULL)
+    return;
+
+  for (l = priv->async_captures; l != NULL; l = next)
+    {
+      ClutterStageAsyncCapture *capture = l->data;
+
+      next = l->next;
+
+      if (capture->rects->len == 0 ||
+          capture->update_serial == priv->update_serial)
+        continue;
+
+      priv->async_captures = g_list_delete_link (priv->async_captures, l);
+      ready = g_list_prepend (ready, capture);
+    }
+
+  ready = g_list_reverse (ready);
+
+  /* the functions might request new captures, or destroy the stage */
+  g_object_ref (stage);
+
+  for (l = ready; l != NULL; l = l->next)
+    {
+      ClutterStageAsyncCapture *capture = l->data;
+      guint i;
+
+      for (i = 0; i < capture->rects->len; i++)
+        {
+          ClutterStageCaptureRect *rect;
+
+          rect = &g_array_index (capture->rects, ClutterStageCaptureRect, i);
+
+          CLUTTER_NOTE (PAINT, "Asynchronous capture of %d,%d (%ux%u)",
+                        rect->area.x, rect->area.y,
+                        rect->area.width, rect->area.height);
+
+          clutter_stage_end_capture_read (stage, capture, rect, TRUE);
+        }
+
+      clutter_stage_async_capture_free (capture);
+    }
+
+  g_list_free (ready);
+
+  g_object_unref (stage);
+}
+
+/* Cancels the pending asynchronous captures and releases the memory
+ * holding the pixels read back for them */
+static void
+clutter_stage_free_async_captures (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  GList *l;
+
+  for (l = priv->async_captures; l != NULL; l = l->next)
+    {
+      ClutterStageAsyncCapture *capture = l->data;
+      guint i;
+
+      for (i = 0; i < capture->rects->len; i++)
+        {
+          ClutterStageCaptureRect *rect;
+
+          rect = &g_array_index (capture->rects, ClutterStageCaptureRect, i);
+          clutter_stage_end_capture_read (stage, capture, rect, FALSE);
+        }
+
+      clutter_stage_async_capture_free (capture);
+    }
+
+  g_list_free (priv->async_captures);
+  priv->async_captures = NULL;
+}
+
+
+
+static gboolean
+clutter_stage_real_delete_event (ClutterStage *stage,
+                                 ClutterEvent *event)
+{
+  if (clutter_stage_is_default (stage))
+    clutter_main_quit ();
+  else
+    clutter_actor_destroy (CLUTTER_ACTOR (stage));
+
+  return TRUE;
+}
+
+static void
+clutter_stage_real_apply_transform (ClutterActor *stage,
+                                    CoglMatrix   *matrix)
+{
+  ClutterStagePrivate *priv = CLUTTER_STAGE (stage)->priv;
+
+  /* FIXME: we probably shouldn't be explicitly reseting the matrix
+   * here... */
+  cogl_matrix_init_identity (matrix);
+  cogl_matrix_multiply (matrix, matrix, &priv->view);
+}
+
+static void
+clutter_stage_set_property (GObject      *object,
+			    guint         prop_id,
+			    const GValue *value,
+			    GParamSpec   *pspec)
+{
+  ClutterStage *stage = CLUTTER_STAGE (object);
+
+  switch (prop_id)
+    {
+    case PROP_COLOR:
+      clutter_stage_set_color (stage, clutter_value_get_color (value));
+      break;
+
+    case PROP_OFFSCREEN:
+      if (g_value_get_boolean (value))
+        g_warning ("Offscreen stages are currently not supported\n");
+      break;
+
+    case PROP_CURSOR_VISIBLE:
+      if (g_value_get_boolean (value))
+        clutter_stage_show_cursor (stage);
+      else
+        clutter_stage_hide_cursor (stage);
+      break;
+
+    case PROP_PERSPECTIVE:
+      clutter_stage_set_perspective (stage, g_value_get_boxed (value));
+      break;
+
+    case PROP_TITLE:
+      clutter_stage_set_title (stage, g_value_get_string (value));
+      break;
+
+    case PROP_USER_RESIZABLE:
+      clutter_stage_set_user_resizable (stage, g_value_get_boolean (value));
+      break;
+
+    case PROP_USE_FOG:
+      clutter_stage_set_use_fog (stage, g_value_get_boolean (value));
+      break;
+
+    case PROP_FOG:
+      clutter_stage_set_fog (stage, g_value_get_boxed (value));
+      break;
+
+    case PROP_USE_ALPHA:
+      clutter_stage_set_use_alpha (stage, g_value_get_boolean (value));
+      break;
+
+    case PROP_KEY_FOCUS:
+      clutter_stage_set_key_focus (stage, g_value_get_object (value));
+      break;
+
+    case PROP_NO_CLEAR_HINT:
+      clutter_stage_set_no_clear_hint (stage, g_value_get_boolean (value));
+      break;
+
+    case PROP_ACCEPT_FOCUS:
+      clutter_stage_set_accept_focus (stage, g_value_get_boolean (value));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+clutter_stage_get_property (GObject    *gobject,
+			    guint       prop_id,
+			    GValue     *value,
+			    GParamSpec *pspec)
+{
+  ClutterStagePrivate *priv = CLUTTER_STAGE (gobject)->priv;
+
+  switch (prop_id)
+    {
+    case PROP_COLOR:
+      clutter_value_set_color (value, &priv->color);
+      break;
+
+    case PROP_OFFSCREEN:
+      g_value_set_boolean (value, FALSE);
+      break;
+
+    case PROP_FULLSCREEN_SET:
+      g_value_set_boolean (value, priv->is_fullscreen);
+      break;
+
+    case PROP_CURSOR_VISIBLE:
+      g_value_set_boolean (value, priv->is_cursor_visible);
+      break;
+
+    case PROP_PERSPECTIVE:
+      g_value_set_boxed (value, &priv->perspective);
+      break;
+
+    case PROP_TITLE:
+      g_value_set_string (value, priv->title);
+      break;
+
+    case PROP_USER_RESIZABLE:
+      g_value_set_boolean (value, priv->is_user_resizable);
+      break;
+
+    case PROP_USE_FOG:
+      g_value_set_boolean (value, priv->use_fog);
+      break;
+
+    case PROP_FOG:
+      g_value_set_boxed (value, &priv->fog);
+      break;
+
+    case PROP_USE_ALPHA:
+      g_value_set_boolean (value, priv->use_alpha);
+      break;
+
+    case PROP_KEY_FOCUS:
+      g_value_set_object (value, priv->key_focused_actor);
+      break;
+
+    case PROP_NO_CLEAR_HINT:
+      {
+        gboolean hint =
+          (priv->stage_hints & CLUTTER_STAGE_NO_CLEAR_ON_PAINT) != 0;
+
+        g_value_set_boolean (value, hint);
+      }
+      break;
+
+    case PROP_ACCEPT_FOCUS:
+      g_value_set_boolean (value, priv->accept_focus);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+clutter_stage_dispose (GObject *object)
+{
+  ClutterStage        *stage = CLUTTER_STAGE (object);
+  ClutterStagePrivate *priv = stage->priv;
+  ClutterStageManager *stage_manager;
+
+  clutter_actor_hide (CLUTTER_ACTOR (object));
+
+  stage_manager = clutter_stage_manager_get_default ();
+  _clutter_stage_manager_remove_stage (stage_manager, stage);
+
+  _clutter_clear_events_queue_for_stage (stage);
+
+  clutter_stage_free_async_picks (stage);
+  clutter_stage_free_async_captures (stage);
+  clutter_stage_free_pixel_buffers (stage);
+
+  _clutter_stage_release_offscreen_pool (stage);
+
+  if (priv->viewport_framebuffer != NULL)
+    {
+      cogl_object_unref (priv->viewport_framebuffer);
+      priv->viewport_framebuffer = NULL;
+    }
+
+  g_slist_foreach (priv->relayout_boundaries, (GFunc) g_object_unref, NULL);
+  g_slist_free (priv->relayout_boundaries);
+  priv->relayout_boundaries = NULL;
+
+  g_slist_foreach (priv->prefetch_texts, (GFunc) g_object_unref, NULL);
+  g_slist_free (priv->prefetch_texts);
+  priv->prefetch_texts = NULL;
+
+  clutter_stage_free_geometry_changes (stage, FALSE);
+
+  clutter_stage_overdraw_free (stage);
+
+  if (priv->impl != NULL)
+    {
+      CLUTTER_NOTE (BACKEND, "Disposing of the stage implementation");
+
+      _clutter_stage_window_unrealize (priv->impl);
+      g_object_unref (priv->impl);
+      priv->impl = NULL;
+    }
+
+  G_OBJECT_CLASS (clutter_stage_parent_class)->dispose (object);
+}
+
+static void
+clutter_stage_finalize (GObject *object)
+{
+  ClutterStage *stage = CLUTTER_STAGE (object);
+  ClutterStagePrivate *priv = stage->priv;
+
+  g_queue_foreach (priv->event_queue, (GFunc) clutter_event_free, NULL);
+  g_queue_free (priv->event_queue);
+
+  g_free (priv->title);
+
+  while (priv->frame_arena != NULL)
+    {
+      ClutterStageArenaChunk *next = priv->frame_arena->next;
+
+      g_free (priv->frame_arena);
+      priv->frame_arena = next;
+    }
+
+  g_hash_table_destroy (priv->devices);
+
+  _clutter_id_pool_free (priv->pick_id_pool);
+
+  clutter_stage_index_clear (stage);
+
+  clutter_stage_free_queue_redraw_entries (stage);
+
+  if (priv->fps_timer != NULL)
+    g_timer_destroy (priv->fps_timer);
+
+  g_free (priv->frame_timings_history);
+
+  clutter_stage_set_track_redraw_causes (stage, FALSE);
+
+  G_OBJECT_CLASS (clutter_stage_parent_class)->finalize (object);
+}
+
+static void
+clutter_stage_class_init (ClutterStageClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
+  GParamSpec *pspec;
+
+  gobject_class->set_property = clutter_stage_set_property;
+  gobject_class->get_property = clutter_stage_get_property;
+  gobject_class->dispose = clutter_stage_dispose;
+  gobject_class->finalize = clutter_stage_finalize;
+
+  actor_class->allocate = clutter_stage_allocate;
+  actor_class->get_preferred_width = clutter_stage_get_preferred_width;
+  actor_class->get_preferred_height = clutter_stage_get_preferred_height;
+  actor_class->paint = clutter_stage_paint;
+  actor_class->pick = clutter_stage_pick;
+  actor_class->get_paint_volume = clutter_stage_get_paint_volume;
+  actor_class->realize = clutter_stage_realize;
+  actor_class->unrealize = clutter_stage_unrealize;
+  actor_class->show = clutter_stage_show;
+  actor_class->hide = clutter_stage_hide;
+  actor_class->queue_relayout = clutter_stage_real_queue_relayout;
+  actor_class->queue_redraw = clutter_stage_real_queue_redraw;
+  actor_class->apply_transform = clutter_stage_real_apply_transform;
+
+  _clutter_actor_class_register_geometric_pick (actor_class, TRUE,
+                                                NULL, NULL);
+
+  /**
+   * ClutterStage:fullscreen:
+   *
+   * Whether the stage should be fullscreen or not.
+   *
+   * This property is set by calling clutter_stage_set_fullscreen()
+   * but since the actual implementation is delegated to the backend
+   * you should connect to the notify::fullscreen-set signal in order
+   * to get notification if the fullscreen state has been successfully
+   * achieved.
+   *
+   * Since: 1.0
+   */
+  pspec = g_param_spec_boolean ("fullscreen-set",
                                 P_("Fullscreen Set"),
                                 P_("Whether the main stage is fullscreen"),
                                 FALSE,
@@ -1657,702 +3993,1402 @@ clutter_stage_class_init (ClutterStageClass *klass)
                                    PROP_FULLSCREEN_SET,
                                    pspec);
   /**
-   * ClutterStage:offscreen:
+   * ClutterStage:offscreen:
+   *
+   * Whether the stage should be rendered in an offscreen buffer.
+   *
+   * <warning><para>Not every backend supports redirecting the
+   * stage to an offscreen buffer. This property might not work
+   * and it might be deprecated at any later date.</para></warning>
+   */
+  pspec = g_param_spec_boolean ("offscreen",
+                                P_("Offscreen"),
+                                P_("Whether the main stage should be rendered offscreen"),
+                                FALSE,
+                                CLUTTER_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class,
+                                   PROP_OFFSCREEN,
+                                   pspec);
+  /**
+   * ClutterStage:cursor-visible:
+   *
+   * Whether the mouse pointer should be visible
+   */
+  pspec = g_param_spec_boolean ("cursor-visible",
+                                P_("Cursor Visible"),
+                                P_("Whether the mouse pointer is visible on the main stage"),
+                                TRUE,
+                                CLUTTER_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class,
+                                   PROP_CURSOR_VISIBLE,
+                                   pspec);
+  /**
+   * ClutterStage:user-resizable:
+   *
+   * Whether the stage is resizable via user interaction.
+   *
+   * Since: 0.4
+   */
+  pspec = g_param_spec_boolean ("user-resizable",
+                                P_("User Resizable"),
+                                P_("Whether the stage is able to be resized via user interaction"),
+                                FALSE,
+                                CLUTTER_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class,
+                                   PROP_USER_RESIZABLE,
+                                   pspec);
+  /**
+   * ClutterStage:color:
+   *
+   * The color of the main stage.
+   */
+  pspec = clutter_param_spec_color ("color",
+                                    P_("Color"),
+                                    P_("The color of the stage"),
+                                    &default_stage_color,
+                                    CLUTTER_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_COLOR, pspec);
+
+  /**
+   * ClutterStage:perspective:
+   *
+   * The parameters used for the perspective projection from 3D
+   * coordinates to 2D
+   *
+   * Since: 0.8.2
+   */
+  pspec = g_param_spec_boxed ("perspective",
+                              P_("Perspective"),
+                              P_("Perspective projection parameters"),
+                              CLUTTER_TYPE_PERSPECTIVE,
+                              CLUTTER_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class,
+                                   PROP_PERSPECTIVE,
+                                   pspec);
+
+  /**
+   * ClutterStage:title:
+   *
+   * The stage's title - usually displayed in stage windows title decorations.
+   *
+   * Since: 0.4
+   */
+  pspec = g_param_spec_string ("title",
+                               P_("Title"),
+                               P_("Stage Title"),
+                               NULL,
+                               CLUTTER_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_TITLE, pspec);
+
+  /**
+   * ClutterStage:use-fog:
+   *
+   * Whether the stage should use a linear GL "fog" in creating the
+   * depth-cueing effect, to enhance the perception of depth by fading
+   * actors farther from the viewpoint.
+   *
+   * Since: 0.6
+   */
+  pspec = g_param_spec_boolean ("use-fog",
+                                P_("Use Fog"),
+                                P_("Whether to enable depth cueing"),
+                                FALSE,
+                                CLUTTER_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_USE_FOG, pspec);
+
+  /**
+   * ClutterStage:fog:
+   *
+   * The settings for the GL "fog", used only if #ClutterStage:use-fog
+   * is set to %TRUE
+   *
+   * Since: 1.0
+   */
+  pspec = g_param_spec_boxed ("fog",
+                              P_("Fog"),
+                              P_("Settings for the depth cueing"),
+                              CLUTTER_TYPE_FOG,
+                              CLUTTER_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_FOG, pspec);
+
+  /**
+   * ClutterStage:use-alpha:
+   *
+   * Whether the #ClutterStage should honour the alpha component of the
+   * #ClutterStage:color property when painting. If Clutter is run under
+   * a compositing manager this will result in the stage being blended
+   * with the underlying window(s)
+   *
+   * Since: 1.2
+   */
+  pspec = g_param_spec_boolean ("use-alpha",
+                                P_("Use Alpha"),
+                                P_("Whether to honour the alpha component of the stage color"),
+                                FALSE,
+                                CLUTTER_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_USE_ALPHA, pspec);
+
+  /**
+   * ClutterStage:key-focus:
+   *
+   * The #ClutterActor that will receive key events from the underlying
+   * windowing system.
+   *
+   * If %NULL, the #ClutterStage will receive the events.
+   *
+   * Since: 1.2
+   */
+  pspec = g_param_spec_object ("key-focus",
+                               P_("Key Focus"),
+                               P_("The currently key focused actor"),
+                               CLUTTER_TYPE_ACTOR,
+                               CLUTTER_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_KEY_FOCUS, pspec);
+
+  /**
+   * ClutterStage:no-clear-hint:
+   *
+   * Whether or not the #ClutterStage should clear its contents
+   * before each paint cycle.
+   *
+   * See clutter_stage_set_no_clear_hint() for further information.
+   *
+   * Since: 1.4
+   */
+  pspec = g_param_spec_boolean ("no-clear-hint",
+                                P_("No Clear Hint"),
+                                P_("Whether the stage should clear its contents"),
+                                FALSE,
+                                CLUTTER_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_NO_CLEAR_HINT, pspec);
+
+  /**
+   * ClutterStage:accept-focus:
+   *
+   * Whether the #ClutterStage should accept key focus when shown.
+   *
+   * Since: 1.6
+   */
+  pspec = g_param_spec_boolean ("accept-focus",
+                                P_("Accept Focus"),
+                                P_("Whether the stage should accept focus on show"),
+                                TRUE,
+                                CLUTTER_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_ACCEPT_FOCUS, pspec);
+
+  /**
+   * ClutterStage::fullscreen
+   * @stage: the stage which was fullscreened
+   *
+   * The ::fullscreen signal is emitted when the stage is made fullscreen.
+   *
+   * Since: 0.6
+   */
+  stage_signals[FULLSCREEN] =
+    g_signal_new (I_("fullscreen"),
+		  G_TYPE_FROM_CLASS (gobject_class),
+		  G_SIGNAL_RUN_FIRST,
+		  G_STRUCT_OFFSET (ClutterStageClass, fullscreen),
+		  NULL, NULL,
+		  _clutter_marshal_VOID__VOID,
+		  G_TYPE_NONE, 0);
+  /**
+   * ClutterStage::unfullscreen
+   * @stage: the stage which has left a fullscreen state.
+   *
+   * The ::unfullscreen signal is emitted when the stage leaves a fullscreen
+   * state.
+   *
+   * Since: 0.6
+   */
+  stage_signals[UNFULLSCREEN] =
+    g_signal_new (I_("unfullscreen"),
+		  G_TYPE_FROM_CLASS (gobject_class),
+		  G_SIGNAL_RUN_LAST,
+		  G_STRUCT_OFFSET (ClutterStageClass, unfullscreen),
+		  NULL, NULL,
+		  _clutter_marshal_VOID__VOID,
+		  G_TYPE_NONE, 0);
+  /**
+   * ClutterStage::activate
+   * @stage: the stage which was activated
    *
-   * Whether the stage should be rendered in an offscreen buffer.
+   * The ::activate signal is emitted when the stage receives key focus
+   * from the underlying window system.
    *
-   * <warning><para>Not every backend supports redirecting the
-   * stage to an offscreen buffer. This property might not work
-   * and it might be deprecated at any later date.</para></warning>
+   * Since: 0.6
    */
-  pspec = g_param_spec_boolean ("offscreen",
-                                P_("Offscreen"),
-                                P_("Whether the main stage should be rendered offscreen"),
-                                FALSE,
-                                CLUTTER_PARAM_READWRITE);
-  g_object_class_install_property (gobject_class,
-                                   PROP_OFFSCREEN,
-                                   pspec);
+  stage_signals[ACTIVATE] =
+    g_signal_new (I_("activate"),
+		  G_TYPE_FROM_CLASS (gobject_class),
+		  G_SIGNAL_RUN_LAST,
+		  G_STRUCT_OFFSET (ClutterStageClass, activate),
+		  NULL, NULL,
+		  _clutter_marshal_VOID__VOID,
+		  G_TYPE_NONE, 0);
   /**
-   * ClutterStage:cursor-visible:
+   * ClutterStage::deactivate
+   * @stage: the stage which was deactivated
    *
-   * Whether the mouse pointer should be visible
+   * The ::activate signal is emitted when the stage loses key focus
+   * from the underlying window system.
+   *
+   * Since: 0.6
    */
-  pspec = g_param_spec_boolean ("cursor-visible",
-                                P_("Cursor Visible"),
-                                P_("Whether the mouse pointer is visible on the main stage"),
-                                TRUE,
-                                CLUTTER_PARAM_READWRITE);
-  g_object_class_install_property (gobject_class,
-                                   PROP_CURSOR_VISIBLE,
-                                   pspec);
+  stage_signals[DEACTIVATE] =
+    g_signal_new (I_("deactivate"),
+		  G_TYPE_FROM_CLASS (gobject_class),
+		  G_SIGNAL_RUN_LAST,
+		  G_STRUCT_OFFSET (ClutterStageClass, deactivate),
+		  NULL, NULL,
+		  _clutter_marshal_VOID__VOID,
+		  G_TYPE_NONE, 0);
+
   /**
-   * ClutterStage:user-resizable:
+   * ClutterStage::delete-event:
+   * @stage: the stage that received the event
+   * @event: a #ClutterEvent of type %CLUTTER_DELETE
    *
-   * Whether the stage is resizable via user interaction.
+   * The ::delete-event signal is emitted when the user closes a
+   * #ClutterStage window using the window controls.
    *
-   * Since: 0.4
-   */
-  pspec = g_param_spec_boolean ("user-resizable",
-                                P_("User Resizable"),
-                                P_("Whether the stage is able to be resized via user interaction"),
-                                FALSE,
-                                CLUTTER_PARAM_READWRITE);
-  g_object_class_install_property (gobject_class,
-                                   PROP_USER_RESIZABLE,
-                                   pspec);
-  /**
-   * ClutterStage:color:
+   * Clutter by default will call clutter_main_quit() if @stage is
+   * the default stage, and clutter_actor_destroy() for any other
+   * stage.
    *
-   * The color of the main stage.
+   * It is possible to override the default behaviour by connecting
+   * a new handler and returning %TRUE there.
+   *
+   * <note>This signal is emitted only on Clutter backends that
+   * embed #ClutterStage in native windows. It is not emitted for
+   * backends that use a static frame buffer.</note>
+   *
+   * Since: 1.2
    */
-  pspec = clutter_param_spec_color ("color",
-                                    P_("Color"),
-                                    P_("The color of the stage"),
-                                    &default_stage_color,
-                                    CLUTTER_PARAM_READWRITE);
-  g_object_class_install_property (gobject_class, PROP_COLOR, pspec);
+  stage_signals[DELETE_EVENT] =
+    g_signal_new (I_("delete-event"),
+                  G_TYPE_FROM_CLASS (gobject_class),
+                  G_SIGNAL_RUN_LAST,
+                  G_STRUCT_OFFSET (ClutterStageClass, delete_event),
+                  _clutter_boolean_handled_accumulator, NULL,
+                  _clutter_marshal_BOOLEAN__BOXED,
+                  G_TYPE_BOOLEAN, 1,
+                  CLUTTER_TYPE_EVENT | G_SIGNAL_TYPE_STATIC_SCOPE);
+
+  klass->fullscreen = clutter_stage_real_fullscreen;
+  klass->activate = clutter_stage_real_activate;
+  klass->deactivate = clutter_stage_real_deactivate;
+  klass->delete_event = clutter_stage_real_delete_event;
+
+  g_type_class_add_private (gobject_class, sizeof (ClutterStagePrivate));
+}
+
+static void
+clutter_stage_notify_min_size (ClutterStage *self)
+{
+  self->priv->min_size_changed = TRUE;
+}
+
+static void
+clutter_stage_init (ClutterStage *self)
+{
+  ClutterStagePrivate *priv;
+  ClutterBackend *backend;
+  ClutterGeometry geom;
+
+  /* a stage is a top-level object */
+  CLUTTER_SET_PRIVATE_FLAGS (self, CLUTTER_IS_TOPLEVEL);
+
+  self->priv = priv = CLUTTER_STAGE_GET_PRIVATE (self);
+
+  CLUTTER_NOTE (BACKEND, "Creating stage from the default backend");
+  backend = clutter_get_default_backend ();
+  priv->impl = _clutter_backend_create_stage (backend, self, NULL);
+  if (!priv->impl)
+    {
+      g_warning ("Unable to create a new stage, falling back to the "
+                 "default stage.");
+      priv->impl = _clutter_stage_get_default_window ();
+
+      /* at this point we must have a default stage, or we're screwed */
+      g_assert (priv->impl != NULL);
+    }
+
+  priv->event_queue = g_queue_new ();
+
+  priv->is_fullscreen          = FALSE;
+  priv->is_user_resizable      = FALSE;
+  priv->is_cursor_visible      = TRUE;
+  priv->use_fog                = FALSE;
+  priv->throttle_motion_events = TRUE;
+  priv->min_size_changed       = FALSE;
+  priv->motion_events_enabled  = clutter_get_motion_events_enabled ();
+
+  priv->color = default_stage_color;
+
+  if (clutter_paint_debug_flags & CLUTTER_DEBUG_REDRAW_CAUSES)
+    clutter_stage_set_track_redraw_causes (self, TRUE);
+
+  _clutter_stage_window_get_geometry (priv->impl, &geom);
+
+  priv->perspective.fovy   = 60.0; /* 60 Degrees */
+  priv->perspective.aspect = (float)geom.width / (float)geom.height;
+  priv->perspective.z_near = 0.1;
+  priv->perspective.z_far  = 100.0;
+
+  cogl_matrix_init_identity (&priv->projection);
+  cogl_matrix_perspective (&priv->projection,
+                           priv->perspective.fovy,
+                           priv->perspective.aspect,
+                           priv->perspective.z_near,
+                           priv->perspective.z_far);
+  cogl_matrix_get_inverse (&priv->projection,
+                           &priv->inverse_projection);
+  cogl_matrix_init_identity (&priv->view);
+  cogl_matrix_view_2d_in_perspective (&priv->view,
+                                      priv->perspective.fovy,
+                                      priv->perspective.aspect,
+                                      priv->perspective.z_near,
+                                      50, /* distance to 2d plane */
+                                      geom.width,
+                                      geom.height);
+
+
+  /* depth cueing */
+  priv->fog.z_near = 1.0;
+  priv->fog.z_far  = 2.0;
+
+  priv->relayout_pending = TRUE;
+
+  clutter_actor_set_reactive (CLUTTER_ACTOR (self), TRUE);
+  clutter_stage_set_title (self, g_get_prgname ());
+  clutter_stage_set_key_focus (self, NULL);
+
+  g_signal_connect (self, "notify::min-width",
+                    G_CALLBACK (clutter_stage_notify_min_size), NULL);
+  g_signal_connect (self, "notify::min-height",
+                    G_CALLBACK (clutter_stage_notify_min_size), NULL);
+
+  _clutter_stage_set_viewport (self, 0, 0, geom.width, geom.height);
+
+  _clutter_stage_set_pick_buffer_valid (self, FALSE, CLUTTER_PICK_ALL);
+  priv->picks_per_frame = 0;
+
+  priv->devices = g_hash_table_new (NULL, NULL);
+
+  priv->pick_id_pool = _clutter_id_pool_new (256);
+}
+
+/**
+ * clutter_stage_get_default:
+ *
+ * Returns the main stage. The default #ClutterStage is a singleton,
+ * so the stage will be created the first time this function is
+ * called (typically, inside clutter_init()); all the subsequent
+ * calls to clutter_stage_get_default() will return the same instance.
+ *
+ * Clutter guarantess the existence of the default stage.
+ *
+ * Return value: (transfer none): the main #ClutterStage.  You should never
+ *   destroy or unref the returned actor.
+ */
+ClutterActor *
+clutter_stage_get_default (void)
+{
+  ClutterStageManager *stage_manager = clutter_stage_manager_get_default ();
+  ClutterStage *stage;
+
+  stage = clutter_stage_manager_get_default_stage (stage_manager);
+  if (G_UNLIKELY (stage == NULL))
+    {
+      /* This will take care of automatically adding the stage to the
+       * stage manager and setting it as the default. Its floating
+       * reference will be claimed by the stage manager.
+       */
+      stage = g_object_new (CLUTTER_TYPE_STAGE, NULL);
+      _clutter_stage_manager_set_default_stage (stage_manager, stage);
+
+      /* the default stage is realized by default */
+      clutter_actor_realize (CLUTTER_ACTOR (stage));
+    }
+
+  return CLUTTER_ACTOR (stage);
+}
+
+/**
+ * clutter_stage_set_color:
+ * @stage: A #ClutterStage
+ * @color: A #ClutterColor
+ *
+ * Sets the stage color.
+ */
+void
+clutter_stage_set_color (ClutterStage       *stage,
+			 const ClutterColor *color)
+{
+  ClutterStagePrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+  g_return_if_fail (color != NULL);
+
+  priv = stage->priv;
+
+  priv->color = *color;
+
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
+
+  g_object_notify (G_OBJECT (stage), "color");
+}
+
+/**
+ * clutter_stage_get_color:
+ * @stage: A #ClutterStage
+ * @color: (out caller-allocates): return location for a #ClutterColor
+ *
+ * Retrieves the stage color.
+ */
+void
+clutter_stage_get_color (ClutterStage *stage,
+			 ClutterColor *color)
+{
+  ClutterStagePrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+  g_return_if_fail (color != NULL);
+
+  priv = stage->priv;
+
+  *color = priv->color;
+}
+
+/**
+ * clutter_stage_set_perspective:
+ * @stage: A #ClutterStage
+ * @perspective: A #ClutterPerspective
+ *
+ * Sets the stage perspective.
+ */
+void
+clutter_stage_set_perspective (ClutterStage       *stage,
+                               ClutterPerspective *perspective)
+{
+  ClutterStagePrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+  g_return_if_fail (perspective != NULL);
+  g_return_if_fail (perspective->z_far - perspective->z_near != 0);
+
+  priv = stage->priv;
+
+  if (priv->perspective.fovy == perspective->fovy &&
+      priv->perspective.aspect == perspective->aspect &&
+      priv->perspective.z_near == perspective->z_near &&
+      priv->perspective.z_far == perspective->z_far)
+    return;
+
+  priv->perspective = *perspective;
+
+  cogl_matrix_init_identity (&priv->projection);
+  cogl_matrix_perspective (&priv->projection,
+                           priv->perspective.fovy,
+                           priv->perspective.aspect,
+                           priv->perspective.z_near,
+                           priv->perspective.z_far);
+  cogl_matrix_get_inverse (&priv->projection,
+                           &priv->inverse_projection);
+
+  priv->dirty_projection = TRUE;
+  priv->projection_serial += 1;
+
+  /* the screen-space boxes of the actors depend on the projection */
+  clutter_stage_index_clear (stage);
+
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
+}
+
+/**
+ * clutter_stage_get_perspective:
+ * @stage: A #ClutterStage
+ * @perspective: (out caller-allocates) (allow-none): return location for a
+ *   #ClutterPerspective
+ *
+ * Retrieves the stage perspective.
+ */
+void
+clutter_stage_get_perspective (ClutterStage       *stage,
+                               ClutterPerspective *perspective)
+{
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+  g_return_if_fail (perspective != NULL);
+
+  *perspective = stage->priv->perspective;
+}
+
+/*
+ * clutter_stage_get_projection_matrix:
+ * @stage: A #ClutterStage
+ * @projection: return location for a #CoglMatrix representing the
+ *              perspective projection applied to actors on the given
+ *              @stage.
+ *
+ * Retrieves the @stage's projection matrix. This is derived from the
+ * current perspective set using clutter_stage_set_perspective().
+ *
+ * Since: 1.6
+ */
+void
+_clutter_stage_get_projection_matrix (ClutterStage *stage,
+                                      CoglMatrix *projection)
+{
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+  g_return_if_fail (projection != NULL);
+
+  *projection = stage->priv->projection;
+}
+
+/* This simply provides a simple mechanism for us to ensure that
+ * the projection matrix gets re-asserted before painting.
+ *
+ * This is used when switching between multiple stages */
+void
+_clutter_stage_dirty_projection (ClutterStage *stage)
+{
+  stage->priv->dirty_projection = TRUE;
+}
+
+/*
+ * clutter_stage_set_viewport:
+ * @stage: A #ClutterStage
+ * @x: The X postition to render the stage at, in window coordinates
+ * @y: The Y position to render the stage at, in window coordinates
+ * @width: The width to render the stage at, in window coordinates
+ * @height: The height to render the stage at, in window coordinates
+ *
+ * Sets the stage viewport. The viewport defines a final scale and
+ * translation of your rendered stage and actors. This lets you render
+ * your stage into a subregion of the stage window or you could use it to
+ * pan a subregion of the stage if your stage window is smaller then
+ * the stage. (XXX: currently this isn't possible)
+ *
+ * Unlike a scale and translation done using the modelview matrix this
+ * is done after everything has had perspective projection applied, so
+ * for example if you were to pan across a subregion of the stage using
+ * the viewport then you would not see a change in perspective for the
+ * actors on the stage.
+ *
+ * Normally the stage viewport will automatically track the size of the
+ * stage window with no offset so the stage will fill your window. This
+ * behaviour can be changed with the "viewport-mimics-window" property
+ * which will automatically be set to FALSE if you use this API. If
+ * you want to revert to the original behaviour then you should set
+ * this property back to %TRUE using
+ * clutter_stage_set_viewport_mimics_window().
+ * (XXX: If we were to make this API public then we might want to do
+ *  add that property.)
+ *
+ * Note: currently this interface only support integer precision
+ * offsets and sizes for viewports but the interface takes floats because
+ * OpenGL 4.0 has introduced floating point viewports which we might
+ * want to expose via this API eventually.
+ *
+ * Since: 1.6
+ */
+void
+_clutter_stage_set_viewport (ClutterStage *stage,
+                             float         x,
+                             float         y,
+                             float         width,
+                             float         height)
+{
+  ClutterStagePrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+
+  priv = stage->priv;
+
+
+  if (x == priv->viewport[0] &&
+      y == priv->viewport[1] &&
+      width == priv->viewport[2] &&
+      height == priv->viewport[3])
+    return;
+
+  priv->viewport[0] = x;
+  priv->viewport[1] = y;
+  priv->viewport[2] = width;
+  priv->viewport[3] = height;
+
+  priv->dirty_viewport = TRUE;
+  priv->projection_serial += 1;
+
+  clutter_stage_index_clear (stage);
+
+  queue_full_redraw (stage);
+}
+
+/* This simply provides a simple mechanism for us to ensure that
+ * the viewport gets re-asserted before next painting.
+ *
+ * This is used when switching between multiple stages */
+void
+_clutter_stage_dirty_viewport (ClutterStage *stage)
+{
+  stage->priv->dirty_viewport = TRUE;
+}
+
+/*
+ * clutter_stage_get_viewport:
+ * @stage: A #ClutterStage
+ * @x: A location for the X position where the stage is rendered,
+ *     in window coordinates.
+ * @y: A location for the Y position where the stage is rendered,
+ *     in window coordinates.
+ * @width: A location for the width the stage is rendered at,
+ *         in window coordinates.
+ * @height: A location for the height the stage is rendered at,
+ *          in window coordinates.
+ *
+ * Returns the viewport offset and size set using
+ * clutter_stage_set_viewport() or if the "viewport-mimics-window" property
+ * is TRUE then @x and @y will be set to 0 and @width and @height will equal
+ * the width if the stage window.
+ *
+ * Since: 1.6
+ */
+void
+_clutter_stage_get_viewport (ClutterStage *stage,
+                             float        *x,
+                             float        *y,
+                             float        *width,
+                             float        *height)
+{
+  ClutterStagePrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+
+  priv = stage->priv;
+
+  *x = priv->viewport[0];
+  *y = priv->viewport[1];
+  *width = priv->viewport[2];
+  *height = priv->viewport[3];
+}
+
+/**
+ * clutter_stage_set_fullscreen:
+ * @stage: a #ClutterStage
+ * @fullscreen: %TRUE to to set the stage fullscreen
+ *
+ * Asks to place the stage window in the fullscreen or unfullscreen
+ * states.
+ *
+ ( Note that you shouldn't assume the window is definitely full screen
+ * afterward, because other entities (e.g. the user or window manager)
+ * could unfullscreen it again, and not all window managers honor
+ * requests to fullscreen windows.
+ *
+ * If you want to receive notification of the fullscreen state you
+ * should either use the #ClutterStage::fullscreen and
+ * #ClutterStage::unfullscreen signals, or use the notify signal
+ * for the #ClutterStage:fullscreen-set property
+ *
+ * Since: 1.0
+ */
+void
+clutter_stage_set_fullscreen (ClutterStage *stage,
+                              gboolean      fullscreen)
+{
+  ClutterStagePrivate *priv;
 
-  /**
-   * ClutterStage:perspective:
-   *
-   * The parameters used for the perspective projection from 3D
-   * coordinates to 2D
-   *
-   * Since: 0.8.2
-   */
-  pspec = g_param_spec_boxed ("perspective",
-                              P_("Perspective"),
-                              P_("Perspective projection parameters"),
-                              CLUTTER_TYPE_PERSPECTIVE,
-                              CLUTTER_PARAM_READWRITE);
-  g_object_class_install_property (gobject_class,
-                                   PROP_PERSPECTIVE,
-                                   pspec);
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
 
-  /**
-   * ClutterStage:title:
-   *
-   * The stage's title - usually displayed in stage windows title decorations.
-   *
-   * Since: 0.4
-   */
-  pspec = g_param_spec_string ("title",
-                               P_("Title"),
-                               P_("Stage Title"),
-                               NULL,
-                               CLUTTER_PARAM_READWRITE);
-  g_object_class_install_property (gobject_class, PROP_TITLE, pspec);
+  priv = stage->priv;
 
-  /**
-   * ClutterStage:use-fog:
-   *
-   * Whether the stage should use a linear GL "fog" in creating the
-   * depth-cueing effect, to enhance the perception of depth by fading
-   * actors farther from the viewpoint.
-   *
-   * Since: 0.6
-   */
-  pspec = g_param_spec_boolean ("use-fog",
-                                P_("Use Fog"),
-                                P_("Whether to enable depth cueing"),
-                                FALSE,
-                                CLUTTER_PARAM_READWRITE);
-  g_object_class_install_property (gobject_class, PROP_USE_FOG, pspec);
+  if (priv->is_fullscreen != fullscreen)
+    {
+      ClutterStageWindow *impl = CLUTTER_STAGE_WINDOW (priv->impl);
+      ClutterStageWindowIface *iface;
 
-  /**
-   * ClutterStage:fog:
-   *
-   * The settings for the GL "fog", used only if #ClutterStage:use-fog
-   * is set to %TRUE
-   *
-   * Since: 1.0
-   */
-  pspec = g_param_spec_boxed ("fog",
-                              P_("Fog"),
-                              P_("Settings for the depth cueing"),
-                              CLUTTER_TYPE_FOG,
-                              CLUTTER_PARAM_READWRITE);
-  g_object_class_install_property (gobject_class, PROP_FOG, pspec);
+      iface = CLUTTER_STAGE_WINDOW_GET_IFACE (impl);
 
-  /**
-   * ClutterStage:use-alpha:
-   *
-   * Whether the #ClutterStage should honour the alpha component of the
-   * #ClutterStage:color property when painting. If Clutter is run under
-   * a compositing manager this will result in the stage being blended
-   * with the underlying window(s)
-   *
-   * Since: 1.2
-   */
-  pspec = g_param_spec_boolean ("use-alpha",
-                                P_("Use Alpha"),
-                                P_("Whether to honour the alpha component of the stage color"),
-                                FALSE,
-                                CLUTTER_PARAM_READWRITE);
-  g_object_class_install_property (gobject_class, PROP_USE_ALPHA, pspec);
+      /* Only set if backend implements.
+       *
+       * Also see clutter_stage_event() for setting priv->is_fullscreen
+       * on state change event.
+       */
+      if (iface->set_fullscreen)
+	iface->set_fullscreen (impl, fullscreen);
+    }
 
-  /**
-   * ClutterStage:key-focus:
-   *
-   * The #ClutterActor that will receive key events from the underlying
-   * windowing system.
-   *
-   * If %NULL, the #ClutterStage will receive the events.
-   *
-   * Since: 1.2
+  /* If the backend did fullscreen the stage window then we need to resize
+   * the stage and update its viewport so we queue a relayout.  Note: if the
+   * fullscreen request is handled asynchronously we can't rely on this
+   * queue_relayout to update the viewport, but for example the X backend
+   * will recieve a ConfigureNotify after a successful resize which is how
+   * we ensure the viewport is updated on X.
    */
-  pspec = g_param_spec_object ("key-focus",
-                               P_("Key Focus"),
-                               P_("The currently key focused actor"),
-                               CLUTTER_TYPE_ACTOR,
-                               CLUTTER_PARAM_READWRITE);
-  g_object_class_install_property (gobject_class, PROP_KEY_FOCUS, pspec);
+  clutter_actor_queue_relayout (CLUTTER_ACTOR (stage));
+}
 
-  /**
-   * ClutterStage:no-clear-hint:
-   *
-   * Whether or not the #ClutterStage should clear its contents
-   * before each paint cycle.
-   *
-   * See clutter_stage_set_no_clear_hint() for further information.
-   *
-   * Since: 1.4
-   */
-  pspec = g_param_spec_boolean ("no-clear-hint",
-                                P_("No Clear Hint"),
-                                P_("Whether the stage should clear its contents"),
-                                FALSE,
-                                CLUTTER_PARAM_READWRITE);
-  g_object_class_install_property (gobject_class, PROP_NO_CLEAR_HINT, pspec);
+/**
+ * clutter_stage_get_fullscreen:
+ * @stage: a #ClutterStage
+ *
+ * Retrieves whether the stage is full screen or not
+ *
+ * Return value: %TRUE if the stage is full screen
+ *
+ * Since: 1.0
+ */
+gboolean
+clutter_stage_get_fullscreen (ClutterStage *stage)
+{
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
 
-  /**
-   * ClutterStage:accept-focus:
-   *
-   * Whether the #ClutterStage should accept key focus when shown.
-   *
-   * Since: 1.6
-   */
-  pspec = g_param_spec_boolean ("accept-focus",
-                                P_("Accept Focus"),
-                                P_("Whether the stage should accept focus on show"),
-                                TRUE,
-                                CLUTTER_PARAM_READWRITE);
-  g_object_class_install_property (gobject_class, PROP_ACCEPT_FOCUS, pspec);
+  return stage->priv->is_fullscreen;
+}
 
-  /**
-   * ClutterStage::fullscreen
-   * @stage: the stage which was fullscreened
-   *
-   * The ::fullscreen signal is emitted when the stage is made fullscreen.
-   *
-   * Since: 0.6
-   */
-  stage_signals[FULLSCREEN] =
-    g_signal_new (I_("fullscreen"),
-		  G_TYPE_FROM_CLASS (gobject_class),
-		  G_SIGNAL_RUN_FIRST,
-		  G_STRUCT_OFFSET (ClutterStageClass, fullscreen),
-		  NULL, NULL,
-		  _clutter_marshal_VOID__VOID,
-		  G_TYPE_NONE, 0);
-  /**
-   * ClutterStage::unfullscreen
-   * @stage: the stage which has left a fullscreen state.
-   *
-   * The ::unfullscreen signal is emitted when the stage leaves a fullscreen
-   * state.
-   *
-   * Since: 0.6
-   */
-  stage_signals[UNFULLSCREEN] =
-    g_signal_new (I_("unfullscreen"),
-		  G_TYPE_FROM_CLASS (gobject_class),
-		  G_SIGNAL_RUN_LAST,
-		  G_STRUCT_OFFSET (ClutterStageClass, unfullscreen),
-		  NULL, NULL,
-		  _clutter_marshal_VOID__VOID,
-		  G_TYPE_NONE, 0);
-  /**
-   * ClutterStage::activate
-   * @stage: the stage which was activated
-   *
-   * The ::activate signal is emitted when the stage receives key focus
-   * from the underlying window system.
-   *
-   * Since: 0.6
-   */
-  stage_signals[ACTIVATE] =
-    g_signal_new (I_("activate"),
-		  G_TYPE_FROM_CLASS (gobject_class),
-		  G_SIGNAL_RUN_LAST,
-		  G_STRUCT_OFFSET (ClutterStageClass, activate),
-		  NULL, NULL,
-		  _clutter_marshal_VOID__VOID,
-		  G_TYPE_NONE, 0);
-  /**
-   * ClutterStage::deactivate
-   * @stage: the stage which was deactivated
-   *
-   * The ::activate signal is emitted when the stage loses key focus
-   * from the underlying window system.
-   *
-   * Since: 0.6
-   */
-  stage_signals[DEACTIVATE] =
-    g_signal_new (I_("deactivate"),
-		  G_TYPE_FROM_CLASS (gobject_class),
-		  G_SIGNAL_RUN_LAST,
-		  G_STRUCT_OFFSET (ClutterStageClass, deactivate),
-		  NULL, NULL,
-		  _clutter_marshal_VOID__VOID,
-		  G_TYPE_NONE, 0);
+/**
+ * clutter_stage_set_user_resizable:
+ * @stage: a #ClutterStage
+ * @resizable: whether the stage should be user resizable.
+ *
+ * Sets if the stage is resizable by user interaction (e.g. via
+ * window manager controls)
+ *
+ * Since: 0.4
+ */
+void
+clutter_stage_set_user_resizable (ClutterStage *stage,
+                                  gboolean      resizable)
+{
+  ClutterStagePrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+
+  priv = stage->priv;
+
+  if (clutter_feature_available (CLUTTER_FEATURE_STAGE_USER_RESIZE)
+      && priv->is_user_resizable != resizable)
+    {
+      ClutterStageWindow *impl = CLUTTER_STAGE_WINDOW (priv->impl);
+      ClutterStageWindowIface *iface;
 
-  /**
-   * ClutterStage::delete-event:
-   * @stage: the stage that received the event
-   * @event: a #ClutterEvent of type %CLUTTER_DELETE
-   *
-   * The ::delete-event signal is emitted when the user closes a
-   * #ClutterStage window using the window controls.
-   *
-   * Clutter by default will call clutter_main_quit() if @stage is
-   * the default stage, and clutter_actor_destroy() for any other
-   * stage.
-   *
-   * It is possible to override the default behaviour by connecting
-   * a new handler and returning %TRUE there.
-   *
-   * <note>This signal is emitted only on Clutter backends that
-   * embed #ClutterStage in native windows. It is not emitted for
-   * backends that use a static frame buffer.</note>
-   *
-   * Since: 1.2
-   */
-  stage_signals[DELETE_EVENT] =
-    g_signal_new (I_("delete-event"),
-                  G_TYPE_FROM_CLASS (gobject_class),
-                  G_SIGNAL_RUN_LAST,
-                  G_STRUCT_OFFSET (ClutterStageClass, delete_event),
-                  _clutter_boolean_handled_accumulator, NULL,
-                  _clutter_marshal_BOOLEAN__BOXED,
-                  G_TYPE_BOOLEAN, 1,
-                  CLUTTER_TYPE_EVENT | G_SIGNAL_TYPE_STATIC_SCOPE);
+      iface = CLUTTER_STAGE_WINDOW_GET_IFACE (impl);
+      if (iface->set_user_resizable)
+        {
+          priv->is_user_resizable = resizable;
 
-  klass->fullscreen = clutter_stage_real_fullscreen;
-  klass->activate = clutter_stage_real_activate;
-  klass->deactivate = clutter_stage_real_deactivate;
-  klass->delete_event = clutter_stage_real_delete_event;
+          iface->set_user_resizable (impl, resizable);
 
-  g_type_class_add_private (gobject_class, sizeof (ClutterStagePrivate));
+          g_object_notify (G_OBJECT (stage), "user-resizable");
+        }
+    }
 }
 
-static void
-clutter_stage_notify_min_size (ClutterStage *self)
+/**
+ * clutter_stage_get_user_resizable:
+ * @stage: a #ClutterStage
+ *
+ * Retrieves the value set with clutter_stage_set_user_resizable().
+ *
+ * Return value: %TRUE if the stage is resizable by the user.
+ *
+ * Since: 0.4
+ */
+gboolean
+clutter_stage_get_user_resizable (ClutterStage *stage)
 {
-  self->priv->min_size_changed = TRUE;
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
+
+  return stage->priv->is_user_resizable;
 }
 
-static void
-clutter_stage_init (ClutterStage *self)
+/**
+ * clutter_stage_show_cursor:
+ * @stage: a #ClutterStage
+ *
+ * Shows the cursor on the stage window
+ */
+void
+clutter_stage_show_cursor (ClutterStage *stage)
 {
   ClutterStagePrivate *priv;
-  ClutterBackend *backend;
-  ClutterGeometry geom;
 
-  /* a stage is a top-level object */
-  CLUTTER_SET_PRIVATE_FLAGS (self, CLUTTER_IS_TOPLEVEL);
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
 
-  self->priv = priv = CLUTTER_STAGE_GET_PRIVATE (self);
+  priv = stage->priv;
+  if (!priv->is_cursor_visible)
+    {
+      ClutterStageWindow *impl = CLUTTER_STAGE_WINDOW (priv->impl);
+      ClutterStageWindowIface *iface;
 
-  CLUTTER_NOTE (BACKEND, "Creating stage from the default backend");
-  backend = clutter_get_default_backend ();
-  priv->impl = _clutter_backend_create_stage (backend, self, NULL);
-  if (!priv->impl)
+      iface = CLUTTER_STAGE_WINDOW_GET_IFACE (impl);
+      if (iface->set_cursor_visible)
+        {
+          priv->is_cursor_visible = TRUE;
+
+          iface->set_cursor_visible (impl, TRUE);
+
+          g_object_notify (G_OBJECT (stage), "cursor-visible");
+        }
+    }
+}
+
+/**
+ * clutter_stage_hide_cursor:
+ * @stage: a #ClutterStage
+ *
+ * Makes the cursor invisible on the stage window
+ *
+ * Since: 0.4
+ */
+void
+clutter_stage_hide_cursor (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+
+  priv = stage->priv;
+  if (priv->is_cursor_visible)
     {
-      g_warning ("Unable to create a new stage, falling back to the "
-                 "default stage.");
-      priv->impl = _clutter_stage_get_default_window ();
+      ClutterStageWindow *impl = CLUTTER_STAGE_WINDOW (priv->impl);
+      ClutterStageWindowIface *iface;
 
-      /* at this point we must have a default stage, or we're screwed */
-      g_assert (priv->impl != NULL);
+      iface = CLUTTER_STAGE_WINDOW_GET_IFACE (impl);
+      if (iface->set_cursor_visible)
+        {
+          priv->is_cursor_visible = FALSE;
+
+          iface->set_cursor_visible (impl, FALSE);
+
+          g_object_notify (G_OBJECT (stage), "cursor-visible");
+        }
     }
+}
 
-  priv->event_queue = g_queue_new ();
+/**
+ * clutter_stage_read_pixels:
+ * @stage: A #ClutterStage
+ * @x: x coordinate of the first pixel that is read from stage
+ * @y: y coordinate of the first pixel that is read from stage
+ * @width: Width dimention of pixels to be read, or -1 for the
+ *   entire stage width
+ * @height: Height dimention of pixels to be read, or -1 for the
+ *   entire stage height
+ *
+ * Makes a screenshot of the stage in RGBA 8bit data, returns a
+ * linear buffer with @width * 4 as rowstride.
+ *
+ * The alpha data contained in the returned buffer is driver-dependent,
+ * and not guaranteed to hold any sensible value.
+ *
+ * Return value: a pointer to newly allocated memory with the buffer
+ *   or %NULL if the read failed. Use g_free() on the returned data
+ *   to release the resources it has allocated.
+ */
+guchar *
+clutter_stage_read_pixels (ClutterStage *stage,
+                           gint          x,
+                           gint          y,
+                           gint          width,
+                           gint          height)
+{
+  ClutterGeometry geom;
+  guchar *pixels;
 
-  priv->is_fullscreen          = FALSE;
-  priv->is_user_resizable      = FALSE;
-  priv->is_cursor_visible      = TRUE;
-  priv->use_fog                = FALSE;
-  priv->throttle_motion_events = TRUE;
-  priv->min_size_changed       = FALSE;
-  priv->motion_events_enabled  = clutter_get_motion_events_enabled ();
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), NULL);
 
-  priv->color = default_stage_color;
+  /* Force a redraw of the stage before reading back pixels */
+  clutter_stage_ensure_current (stage);
+  clutter_actor_paint (CLUTTER_ACTOR (stage));
 
-  _clutter_stage_window_get_geometry (priv->impl, &geom);
+  clutter_actor_get_allocation_geometry (CLUTTER_ACTOR (stage), &geom);
 
-  priv->perspective.fovy   = 60.0; /* 60 Degrees */
-  priv->perspective.aspect = (float)geom.width / (float)geom.height;
-  priv->perspective.z_near = 0.1;
-  priv->perspective.z_far  = 100.0;
+  if (width < 0)
+    width = geom.width;
 
-  cogl_matrix_init_identity (&priv->projection);
-  cogl_matrix_perspective (&priv->projection,
-                           priv->perspective.fovy,
-                           priv->perspective.aspect,
-                           priv->perspective.z_near,
-                           priv->perspective.z_far);
-  cogl_matrix_get_inverse (&priv->projection,
-                           &priv->inverse_projection);
-  cogl_matrix_init_identity (&priv->view);
-  cogl_matrix_view_2d_in_perspective (&priv->view,
-                                      priv->perspective.fovy,
-                                      priv->perspective.aspect,
-                                      priv->perspective.z_near,
-                                      50, /* distance to 2d plane */
-                                      geom.width,
-                                      geom.height);
+  if (height < 0)
+    height = geom.height;
 
+  pixels = g_malloc (height * width * 4);
 
-  /* depth cueing */
-  priv->fog.z_near = 1.0;
-  priv->fog.z_far  = 2.0;
+  cogl_read_pixels (x, y, width, height,
+                    COGL_READ_PIXELS_COLOR_BUFFER,
+                    COGL_PIXEL_FORMAT_RGBA_8888,
+                    pixels);
 
-  priv->relayout_pending = TRUE;
+  return pixels;
+}
 
-  clutter_actor_set_reactive (CLUTTER_ACTOR (self), TRUE);
-  clutter_stage_set_title (self, g_get_prgname ());
-  clutter_stage_set_key_focus (self, NULL);
+/**
+ * clutter_stage_read_pixels_async:
+ * @stage: a #ClutterStage
+ * @x: x coordinate of the first pixel that is read from stage
+ * @y: y coordinate of the first pixel that is read from stage
+ * @width: Width dimention of pixels to be read, or -1 for the
+ *   entire stage width
+ * @height: Height dimention of pixels to be read, or -1 for the
+ *   entire stage height
+ * @damage_only: whether only the parts of the area that are painted
+ *   again should be captured
+ * @func: function to call with the captured pixels
+ * @user_data: data to pass to @func
+ * @notify: function to call on @user_data when done, or %NULL
+ *
+ * Asynchronous version of clutter_stage_read_pixels(), suitable for
+ * taking screenshots or streaming the contents of @stage.
+ *
+ * Instead of painting the stage and waiting for the GPU to finish,
+ * the area is copied from the next frame painted by @stage, and @func
+ * is called with the pixels when the stage is updated one or two
+ * frames later, once the copy is complete.
+ *
+ * If @damage_only is %FALSE, a redraw of the whole stage is queued and
+ * @func is called once, with the whole area. Otherwise, @func is called
+ * once for each rectangle of the area that is painted again by the
+ * next frame that changes it, and the rest of the area should be
+ * considered unchanged.
+ *
+ * If @stage is destroyed before the pixels are available, @func is
+ * not called.
+ *
+ * Since: 1.8
+ */
+void
+clutter_stage_read_pixels_async (ClutterStage            *stage,
+                                 gint                     x,
+                                 gint                     y,
+                                 gint                     width,
+                                 gint                     height,
+                                 gboolean                 damage_only,
+                                 ClutterStageCaptureFunc  func,
+                                 gpointer                 user_data,
+                                 GDestroyNotify           notify)
+{
+  ClutterStagePrivate *priv;
+  ClutterStageAsyncCapture *capture;
+  ClutterGeometry geom;
+  gint x2, y2;
 
-  g_signal_connect (self, "notify::min-width",
-                    G_CALLBACK (clutter_stage_notify_min_size), NULL);
-  g_signal_connect (self, "notify::min-height",
-                    G_CALLBACK (clutter_stage_notify_min_size), NULL);
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+  g_return_if_fail (func != NULL);
 
-  _clutter_stage_set_viewport (self, 0, 0, geom.width, geom.height);
+  priv = stage->priv;
 
-  _clutter_stage_set_pick_buffer_valid (self, FALSE, CLUTTER_PICK_ALL);
-  priv->picks_per_frame = 0;
+  clutter_actor_get_allocation_geometry (CLUTTER_ACTOR (stage), &geom);
 
-  priv->paint_volume_stack =
-    g_array_new (FALSE, FALSE, sizeof (ClutterPaintVolume));
+  x2 = width < 0 ? (gint) geom.width : MIN (x + width, (gint) geom.width);
+  y2 = height < 0 ? (gint) geom.height : MIN (y + height, (gint) geom.height);
+  x = MAX (x, 0);
+  y = MAX (y, 0);
 
-  priv->devices = g_hash_table_new (NULL, NULL);
+  /* nothing of the area can ever be painted */
+  if (x2 <= x || y2 <= y)
+    {
+      if (notify != NULL)
+        notify (user_data);
 
-  priv->pick_id_pool = _clutter_id_pool_new (256);
+      return;
+    }
+
+  capture = g_slice_new0 (ClutterStageAsyncCapture);
+  capture->area.x = x;
+  capture->area.y = y;
+  capture->area.width = x2 - x;
+  capture->area.height = y2 - y;
+  capture->rects = g_array_new (FALSE, FALSE,
+                                sizeof (ClutterStageCaptureRect));
+  capture->damage_only = damage_only != FALSE;
+  capture->func = func;
+  capture->user_data = user_data;
+  capture->notify = notify;
+
+  priv->async_captures = g_list_append (priv->async_captures, capture);
+
+  if (!damage_only)
+    clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
 }
 
 /**
- * clutter_stage_get_default:
+ * clutter_stage_get_actor_at_pos:
+ * @stage: a #ClutterStage
+ * @pick_mode: how the scene graph should be painted
+ * @x: X coordinate to check
+ * @y: Y coordinate to check
  *
- * Returns the main stage. The default #ClutterStage is a singleton,
- * so the stage will be created the first time this function is
- * called (typically, inside clutter_init()); all the subsequent
- * calls to clutter_stage_get_default() will return the same instance.
+ * Checks the scene at the coordinates @x and @y and returns a pointer
+ * to the #ClutterActor at those coordinates.
  *
- * Clutter guarantess the existence of the default stage.
+ * By using @pick_mode it is possible to control which actors will be
+ * painted and thus available.
  *
- * Return value: (transfer none): the main #ClutterStage.  You should never
- *   destroy or unref the returned actor.
+ * Return value: (transfer none): the actor at the specified coordinates,
+ *   if any
  */
 ClutterActor *
-clutter_stage_get_default (void)
+clutter_stage_get_actor_at_pos (ClutterStage    *stage,
+                                ClutterPickMode  pick_mode,
+                                gint             x,
+                                gint             y)
 {
-  ClutterStageManager *stage_manager = clutter_stage_manager_get_default ();
-  ClutterStage *stage;
-
-  stage = clutter_stage_manager_get_default_stage (stage_manager);
-  if (G_UNLIKELY (stage == NULL))
-    {
-      /* This will take care of automatically adding the stage to the
-       * stage manager and setting it as the default. Its floating
-       * reference will be claimed by the stage manager.
-       */
-      stage = g_object_new (CLUTTER_TYPE_STAGE, NULL);
-      _clutter_stage_manager_set_default_stage (stage_manager, stage);
-
-      /* the default stage is realized by default */
-      clutter_actor_realize (CLUTTER_ACTOR (stage));
-    }
-
-  return CLUTTER_ACTOR (stage);
+  return _clutter_stage_do_pick (stage, x, y, pick_mode);
 }
 
 /**
- * clutter_stage_set_color:
- * @stage: A #ClutterStage
- * @color: A #ClutterColor
+ * clutter_stage_get_actor_at_pos_async:
+ * @stage: a #ClutterStage
+ * @pick_mode: how the scene graph should be painted
+ * @x: X coordinate to check
+ * @y: Y coordinate to check
+ * @func: function to call with the actor at the given coordinates
+ * @user_data: data to pass to @func
+ * @notify: function to call on @user_data when done, or %NULL
  *
- * Sets the stage color.
+ * Asynchronous version of clutter_stage_get_actor_at_pos().
+ *
+ * The scene is painted in pick mode immediately, but the result is
+ * read back without waiting for the GPU to finish; @func is called
+ * when the stage is updated for the next frame. This allows to avoid
+ * stalling the rendering pipeline, at the price of one frame of
+ * latency.
+ *
+ * When the scene does not change, the result is also reused by
+ * clutter_stage_get_actor_at_pos() for the same coordinates.
+ *
+ * If @stage is destroyed before the result is available, @func is
+ * not called.
+ *
+ * Since: 1.8
  */
 void
-clutter_stage_set_color (ClutterStage       *stage,
-			 const ClutterColor *color)
+clutter_stage_get_actor_at_pos_async (ClutterStage         *stage,
+                                      ClutterPickMode       pick_mode,
+                                      gint                  x,
+                                      gint                  y,
+                                      ClutterStagePickFunc  func,
+                                      gpointer              user_data,
+                                      GDestroyNotify        notify)
 {
   ClutterStagePrivate *priv;
+  ClutterStageAsyncPick *pick;
+  ClutterActor *actor;
+  guint index_stamp;
 
   g_return_if_fail (CLUTTER_IS_STAGE (stage));
-  g_return_if_fail (color != NULL);
+  g_return_if_fail (func != NULL);
 
   priv = stage->priv;
 
-  priv->color = *color;
+  pick = g_slice_new0 (ClutterStageAsyncPick);
+  pick->result.mode = pick_mode;
+  pick->result.x = x;
+  pick->result.y = y;
+  pick->result.pick_id = -1;
+  pick->update_serial = priv->update_serial;
+  pick->func = func;
+  pick->user_data = user_data;
+  pick->notify = notify;
 
-  clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
+  if (G_UNLIKELY (clutter_pick_debug_flags & CLUTTER_DEBUG_NOP_PICKING))
+    actor = CLUTTER_ACTOR (stage);
+  else if (!clutter_stage_do_pick_without_render (stage, x, y, pick_mode,
+                                                  &index_stamp,
+                                                  &actor))
+    {
+      if (!_clutter_stage_get_pick_buffer_valid (stage, pick_mode))
+        clutter_stage_do_pick_render (stage, x, y, pick_mode, index_stamp);
 
-  g_object_notify (G_OBJECT (stage), "color");
+      clutter_stage_begin_async_pick_read (stage, pick);
+      pick->result.pick_generation = priv->pick_buffer_generation;
+
+      actor = NULL;
+    }
+
+  if (actor != NULL && actor != CLUTTER_ACTOR (stage))
+    {
+      pick->result.pick_id = _clutter_actor_get_pick_id (actor);
+      pick->result.pick_generation =
+        _clutter_id_pool_get_generation (priv->pick_id_pool);
+    }
+
+  /* the scene serial might have changed while relayouting */
+  pick->result.scene_serial = priv->scene_serial;
+
+  priv->async_picks = g_list_append (priv->async_picks, pick);
+
+  /* make sure that the stage is going to be updated */
+  _clutter_master_clock_start_running (_clutter_master_clock_get_default ());
 }
 
 /**
- * clutter_stage_get_color:
- * @stage: A #ClutterStage
- * @color: (out caller-allocates): return location for a #ClutterColor
+ * clutter_stage_event:
+ * @stage: a #ClutterStage
+ * @event: a #ClutterEvent
  *
- * Retrieves the stage color.
+ * This function is used to emit an event on the main stage.
+ *
+ * You should rarely need to use this function, except for
+ * synthetised events.
+ *
+ * Return value: the return value from the signal emission
+ *
+ * Since: 0.4
  */
-void
-clutter_stage_get_color (ClutterStage *stage,
-			 ClutterColor *color)
+gboolean
+clutter_stage_event (ClutterStage *stage,
+                     ClutterEvent *event)
 {
   ClutterStagePrivate *priv;
 
-  g_return_if_fail (CLUTTER_IS_STAGE (stage));
-  g_return_if_fail (color != NULL);
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
+  g_return_val_if_fail (event != NULL, FALSE);
 
   priv = stage->priv;
 
-  *color = priv->color;
+  if (event->type == CLUTTER_DELETE)
+    {
+      gboolean retval = FALSE;
+
+      g_signal_emit_by_name (stage, "event", event, &retval);
+
+      if (!retval)
+        g_signal_emit_by_name (stage, "delete-event", event, &retval);
+
+      return retval;
+    }
+
+  if (event->type != CLUTTER_STAGE_STATE)
+    return FALSE;
+
+  /* emit raw event */
+  if (clutter_actor_event (CLUTTER_ACTOR (stage), event, FALSE))
+    return TRUE;
+
+  if (event->stage_state.changed_mask & CLUTTER_STAGE_STATE_FULLSCREEN)
+    {
+      if (event->stage_state.new_state & CLUTTER_STAGE_STATE_FULLSCREEN)
+	{
+	  priv->is_fullscreen = TRUE;
+	  g_signal_emit (stage, stage_signals[FULLSCREEN], 0);
+
+          g_object_notify (G_OBJECT (stage), "fullscreen-set");
+	}
+      else
+	{
+	  priv->is_fullscreen = FALSE;
+	  g_signal_emit (stage, stage_signals[UNFULLSCREEN], 0);
+
+          g_object_notify (G_OBJECT (stage), "fullscreen-set");
+	}
+    }
+
+  if (event->stage_state.changed_mask & CLUTTER_STAGE_STATE_ACTIVATED)
+    {
+      if (event->stage_state.new_state & CLUTTER_STAGE_STATE_ACTIVATED)
+	g_signal_emit (stage, stage_signals[ACTIVATE], 0);
+      else
+	g_signal_emit (stage, stage_signals[DEACTIVATE], 0);
+    }
+
+  return TRUE;
 }
 
 /**
- * clutter_stage_set_perspective:
+ * clutter_stage_set_title
  * @stage: A #ClutterStage
- * @perspective: A #ClutterPerspective
+ * @title: A utf8 string for the stage windows title.
  *
- * Sets the stage perspective.
- */
+ * Sets the stage title.
+ *
+ * Since: 0.4
+ **/
 void
-clutter_stage_set_perspective (ClutterStage       *stage,
-                               ClutterPerspective *perspective)
+clutter_stage_set_title (ClutterStage       *stage,
+			 const gchar        *title)
 {
   ClutterStagePrivate *priv;
+  ClutterStageWindow *impl;
 
   g_return_if_fail (CLUTTER_IS_STAGE (stage));
-  g_return_if_fail (perspective != NULL);
-  g_return_if_fail (perspective->z_far - perspective->z_near != 0);
 
   priv = stage->priv;
 
-  if (priv->perspective.fovy == perspective->fovy &&
-      priv->perspective.aspect == perspective->aspect &&
-      priv->perspective.z_near == perspective->z_near &&
-      priv->perspective.z_far == perspective->z_far)
-    return;
-
-  priv->perspective = *perspective;
+  g_free (priv->title);
+  priv->title = g_strdup (title);
 
-  cogl_matrix_init_identity (&priv->projection);
-  cogl_matrix_perspective (&priv->projection,
-                           priv->perspective.fovy,
-                           priv->perspective.aspect,
-                           priv->perspective.z_near,
-                           priv->perspective.z_far);
-  cogl_matrix_get_inverse (&priv->projection,
-                           &priv->inverse_projection);
+  impl = CLUTTER_STAGE_WINDOW (priv->impl);
+  if (CLUTTER_STAGE_WINDOW_GET_IFACE(impl)->set_title != NULL)
+    CLUTTER_STAGE_WINDOW_GET_IFACE (impl)->set_title (impl, priv->title);
 
-  priv->dirty_projection = TRUE;
-  clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
+  g_object_notify (G_OBJECT (stage), "title");
 }
 
 /**
- * clutter_stage_get_perspective:
+ * clutter_stage_get_title
  * @stage: A #ClutterStage
- * @perspective: (out caller-allocates) (allow-none): return location for a
- *   #ClutterPerspective
  *
- * Retrieves the stage perspective.
- */
-void
-clutter_stage_get_perspective (ClutterStage       *stage,
-                               ClutterPerspective *perspective)
-{
-  g_return_if_fail (CLUTTER_IS_STAGE (stage));
-  g_return_if_fail (perspective != NULL);
-
-  *perspective = stage->priv->perspective;
-}
-
-/*
- * clutter_stage_get_projection_matrix:
- * @stage: A #ClutterStage
- * @projection: return location for a #CoglMatrix representing the
- *              perspective projection applied to actors on the given
- *              @stage.
+ * Gets the stage title.
  *
- * Retrieves the @stage's projection matrix. This is derived from the
- * current perspective set using clutter_stage_set_perspective().
+ * Return value: pointer to the title string for the stage. The
+ * returned string is owned by the actor and should not
+ * be modified or freed.
  *
- * Since: 1.6
- */
-void
-_clutter_stage_get_projection_matrix (ClutterStage *stage,
-                                      CoglMatrix *projection)
+ * Since: 0.4
+ **/
+G_CONST_RETURN gchar *
+clutter_stage_get_title (ClutterStage       *stage)
 {
-  g_return_if_fail (CLUTTER_IS_STAGE (stage));
-  g_return_if_fail (projection != NULL);
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), NULL);
 
-  *projection = stage->priv->projection;
+  return stage->priv->title;
 }
 
-/* This simply provides a simple mechanism for us to ensure that
- * the projection matrix gets re-asserted before painting.
- *
- * This is used when switching between multiple stages */
-void
-_clutter_stage_dirty_projection (ClutterStage *stage)
+static void
+on_key_focused_weak_notify (gpointer data,
+			    GObject *where_the_object_was)
 {
-  stage->priv->dirty_projection = TRUE;
-}
+  ClutterStagePrivate *priv;
+  ClutterStage        *stage = CLUTTER_STAGE (data);
 
-/*
- * clutter_stage_set_viewport:
- * @stage: A #ClutterStage
- * @x: The X postition to render the stage at, in window coordinates
- * @y: The Y position to render the stage at, in window coordinates
- * @width: The width to render the stage at, in window coordinates
- * @height: The height to render the stage at, in window coordinates
- *
- * Sets the stage viewport. The viewport defines a final scale and
- * translation of your rendered stage and actors. This lets you render
- * your stage into a subregion of the stage window or you could use it to
- * pan a subregion of the stage if your stage window is smaller then
- * the stage. (XXX: currently this isn't possible)
- *
- * Unlike a scale and translation done using the modelview matrix this
- * is done after everything has had perspective projection applied, so
- * for example if you were to pan across a subregion of the stage using
- * the viewport then you would not see a change in perspective for the
- * actors on the stage.
- *
- * Normally the stage viewport will automatically track the size of the
- * stage window with no offset so the stage will fill your window. This
- * behaviour can be changed with the "viewport-mimics-window" property
- * which will automatically be set to FALSE if you use this API. If
- * you want to revert to the original behaviour then you should set
- * this property back to %TRUE using
- * clutter_stage_set_viewport_mimics_window().
- * (XXX: If we were to make this API public then we might want to do
- *  add that property.)
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+
+  priv = stage->priv;
+  priv->key_focused_actor = NULL;
+
+  /* focused actor has dissapeared - fall back to stage
+   * FIXME: need some kind of signal dance/block here.
+  */
+  clutter_stage_set_key_focus (stage, NULL);
+}
+
+/**
+ * clutter_stage_set_key_focus:
+ * @stage: the #ClutterStage
+ * @actor: (allow-none): the actor to set key focus to, or %NULL
  *
- * Note: currently this interface only support integer precision
- * offsets and sizes for viewports but the interface takes floats because
- * OpenGL 4.0 has introduced floating point viewports which we might
- * want to expose via this API eventually.
+ * Sets the key focus on @actor. An actor with key focus will receive
+ * all the key events. If @actor is %NULL, the stage will receive
+ * focus.
  *
- * Since: 1.6
+ * Since: 0.6
  */
 void
-_clutter_stage_set_viewport (ClutterStage *stage,
-                             float         x,
-                             float         y,
-                             float         width,
-                             float         height)
+clutter_stage_set_key_focus (ClutterStage *stage,
+			     ClutterActor *actor)
 {
   ClutterStagePrivate *priv;
 
   g_return_if_fail (CLUTTER_IS_STAGE (stage));
+  g_return_if_fail (actor == NULL || CLUTTER_IS_ACTOR (actor));
 
   priv = stage->priv;
 
-
-  if (x == priv->viewport[0] &&
-      y == priv->viewport[1] &&
-      width == priv->viewport[2] &&
-      height == priv->viewport[3])
+  if (priv->key_focused_actor == actor)
     return;
 
-  priv->viewport[0] = x;
-  priv->viewport[1] = y;
-  priv->viewport[2] = width;
-  priv->viewport[3] = height;
+  if (priv->key_focused_actor)
+    {
+      ClutterActor *old_focused_actor;
 
-  priv->dirty_viewport = TRUE;
+      old_focused_actor = priv->key_focused_actor;
 
-  queue_full_redraw (stage);
+      /* set key_focused_actor to NULL before emitting the signal or someone
+       * might hide the previously focused actor in the signal handler and we'd
+       * get re-entrant call and get glib critical from g_object_weak_unref
+       */
+
+      g_object_weak_unref (G_OBJECT (priv->key_focused_actor),
+			   on_key_focused_weak_notify,
+			   stage);
+
+      priv->key_focused_actor = NULL;
+
+      g_signal_emit_by_name (old_focused_actor, "key-focus-out");
+    }
+  else
+    g_signal_emit_by_name (stage, "key-focus-out");
+
+  /* Note, if someone changes key focus in focus-out signal handler we'd be
+   * overriding the latter call below moving the focus where it was originally
+   * intended. The order of events would be:
+   *   1st focus-out, 2nd focus-out (on stage), 2nd focus-in, 1st focus-in
+   */
+
+  if (actor)
+    {
+      priv->key_focused_actor = actor;
+
+      g_object_weak_ref (G_OBJECT (actor),
+			 on_key_focused_weak_notify,
+			 stage);
+      g_signal_emit_by_name (priv->key_focused_actor, "key-focus-in");
+    }
+  else
+    g_signal_emit_by_name (stage, "key-focus-in");
+
+  g_object_notify (G_OBJECT (stage), "key-focus");
 }
 
-/* This simply provides a simple mechanism for us to ensure that
- * the viewport gets re-asserted before next painting.
+/**
+ * clutter_stage_get_key_focus:
+ * @stage: the #ClutterStage
  *
- * This is used when switching between multiple stages */
-void
-_clutter_stage_dirty_viewport (ClutterStage *stage)
+ * Retrieves the actor that is currently under key focus.
+ *
+ * Return value: (transfer none): the actor with key focus, or the stage
+ *
+ * Since: 0.6
+ */
+ClutterActor *
+clutter_stage_get_key_focus (ClutterStage *stage)
 {
-  stage->priv->dirty_viewport = TRUE;
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), NULL);
+
+  if (stage->priv->key_focused_actor)
+    return stage->priv->key_focused_actor;
+
+  return CLUTTER_ACTOR (stage);
 }
 
-/*
- * clutter_stage_get_viewport:
- * @stage: A #ClutterStage
- * @x: A location for the X position where the stage is rendered,
- *     in window coordinates.
- * @y: A location for the Y position where the stage is rendered,
- *     in window coordinates.
- * @width: A location for the width the stage is rendered at,
- *         in window coordinates.
- * @height: A location for the height the stage is rendered at,
- *          in window coordinates.
+/**
+ * clutter_stage_get_use_fog:
+ * @stage: the #ClutterStage
  *
- * Returns the viewport offset and size set using
- * clutter_stage_set_viewport() or if the "viewport-mimics-window" property
- * is TRUE then @x and @y will be set to 0 and @width and @height will equal
- * the width if the stage window.
+ * Gets whether the depth cueing effect is enabled on @stage.
  *
- * Since: 1.6
+ * Return value: %TRUE if the depth cueing effect is enabled
+ *
+ * Since: 0.6
  */
-void
-_clutter_stage_get_viewport (ClutterStage *stage,
-                             float        *x,
-                             float        *y,
-                             float        *width,
-                             float        *height)
+gboolean
+clutter_stage_get_use_fog (ClutterStage *stage)
 {
-  ClutterStagePrivate *priv;
-
-  g_return_if_fail (CLUTTER_IS_STAGE (stage));
-
-  priv = stage->priv;
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
 
-  *x = priv->viewport[0];
-  *y = priv->viewport[1];
-  *width = priv->viewport[2];
-  *height = priv->viewport[3];
+  return stage->priv->use_fog;
 }
 
 /**
- * clutter_stage_set_fullscreen:
- * @stage: a #ClutterStage
- * @fullscreen: %TRUE to to set the stage fullscreen
- *
- * Asks to place the stage window in the fullscreen or unfullscreen
- * states.
+ * clutter_stage_set_use_fog:
+ * @stage: the #ClutterStage
+ * @fog: %TRUE for enabling the depth cueing effect
  *
- ( Note that you shouldn't assume the window is definitely full screen
- * afterward, because other entities (e.g. the user or window manager)
- * could unfullscreen it again, and not all window managers honor
- * requests to fullscreen windows.
+ * Sets whether the depth cueing effect on the stage should be enabled
+ * or not.
  *
- * If you want to receive notification of the fullscreen state you
- * should either use the #ClutterStage::fullscreen and
- * #ClutterStage::unfullscreen signals, or use the notify signal
- * for the #ClutterStage:fullscreen-set property
+ * Depth cueing is a 3D effect that makes actors farther away from the
+ * viewing point less opaque, by fading them with the stage color.
+
+ * The parameters of the GL fog used can be changed using the
+ * clutter_stage_set_fog() function.
  *
- * Since: 1.0
+ * Since: 0.6
  */
 void
-clutter_stage_set_fullscreen (ClutterStage *stage,
-                              gboolean      fullscreen)
+clutter_stage_set_use_fog (ClutterStage *stage,
+                           gboolean      fog)
 {
   ClutterStagePrivate *priv;
 
@@ -2360,920 +5396,1078 @@ clutter_stage_set_fullscreen (ClutterStage *stage,
 
   priv = stage->priv;
 
-  if (priv->is_fullscreen != fullscreen)
+  if (priv->use_fog != fog)
     {
-      ClutterStageWindow *impl = CLUTTER_STAGE_WINDOW (priv->impl);
-      ClutterStageWindowIface *iface;
+      priv->use_fog = fog;
 
-      iface = CLUTTER_STAGE_WINDOW_GET_IFACE (impl);
+      CLUTTER_NOTE (MISC, "%s depth-cueing inside stage",
+                    priv->use_fog ? "enabling" : "disabling");
 
-      /* Only set if backend implements.
-       *
-       * Also see clutter_stage_event() for setting priv->is_fullscreen
-       * on state change event.
-       */
-      if (iface->set_fullscreen)
-	iface->set_fullscreen (impl, fullscreen);
-    }
+      clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
 
-  /* If the backend did fullscreen the stage window then we need to resize
-   * the stage and update its viewport so we queue a relayout.  Note: if the
-   * fullscreen request is handled asynchronously we can't rely on this
-   * queue_relayout to update the viewport, but for example the X backend
-   * will recieve a ConfigureNotify after a successful resize which is how
-   * we ensure the viewport is updated on X.
-   */
-  clutter_actor_queue_relayout (CLUTTER_ACTOR (stage));
+      g_object_notify (G_OBJECT (stage), "use-fog");
+    }
 }
 
 /**
- * clutter_stage_get_fullscreen:
- * @stage: a #ClutterStage
+ * clutter_stage_set_fog:
+ * @stage: the #ClutterStage
+ * @fog: a #ClutterFog structure
  *
- * Retrieves whether the stage is full screen or not
+ * Sets the fog (also known as "depth cueing") settings for the @stage.
  *
- * Return value: %TRUE if the stage is full screen
+ * A #ClutterStage will only use a linear fog progression, which
+ * depends solely on the distance from the viewer. The cogl_set_fog()
+ * function in COGL exposes more of the underlying implementation,
+ * and allows changing the for progression function. It can be directly
+ * used by disabling the #ClutterStage:use-fog property and connecting
+ * a signal handler to the #ClutterActor::paint signal on the @stage,
+ * like:
+ *
+ * |[
+ *   clutter_stage_set_use_fog (stage, FALSE);
+ *   g_signal_connect (stage, "paint", G_CALLBACK (on_stage_paint), NULL);
+ * ]|
+ *
+ * The paint signal handler will call cogl_set_fog() with the
+ * desired settings:
+ *
+ * |[
+ *   static void
+ *   on_stage_paint (ClutterActor *actor)
+ *   {
+ *     ClutterColor stage_color = { 0, };
+ *     CoglColor fog_color = { 0, };
+ *
+ *     /&ast; set the fog color to the stage background color &ast;/
+ *     clutter_stage_get_color (CLUTTER_STAGE (actor), &amp;stage_color);
+ *     cogl_color_init_from_4ub (&amp;fog_color,
+ *                               stage_color.red,
+ *                               stage_color.green,
+ *                               stage_color.blue,
+ *                               stage_color.alpha);
+ *
+ *     /&ast; enable fog &ast;/
+ *     cogl_set_fog (&amp;fog_color,
+ *                   COGL_FOG_MODE_EXPONENTIAL, /&ast; mode &ast;/
+ *                   0.5,                       /&ast; density &ast;/
+ *                   5.0, 30.0);                /&ast; z_near and z_far &ast;/
+ *   }
+ * ]|
+ *
+ * <note>The fogging functions only work correctly when the visible actors use
+ * unmultiplied alpha colors. By default Cogl will premultiply textures and
+ * cogl_set_source_color() will premultiply colors, so unless you explicitly
+ * load your textures requesting an unmultiplied internal format and use
+ * cogl_material_set_color() you can only use fogging with fully opaque actors.
+ * Support for premultiplied colors will improve in the future when we can
+ * depend on fragment shaders.</note>
  *
- * Since: 1.0
+ * Since: 0.6
  */
-gboolean
-clutter_stage_get_fullscreen (ClutterStage *stage)
+void
+clutter_stage_set_fog (ClutterStage *stage,
+                       ClutterFog   *fog)
 {
-  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
+  ClutterStagePrivate *priv;
 
-  return stage->priv->is_fullscreen;
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+  g_return_if_fail (fog != NULL);
+
+  priv = stage->priv;
+
+  priv->fog = *fog;
+
+  if (priv->use_fog)
+    clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
 }
 
 /**
- * clutter_stage_set_user_resizable:
- * @stage: a #ClutterStage
- * @resizable: whether the stage should be user resizable.
+ * clutter_stage_get_fog:
+ * @stage: the #ClutterStage
+ * @fog: return location for a #ClutterFog structure
  *
- * Sets if the stage is resizable by user interaction (e.g. via
- * window manager controls)
+ * Retrieves the current depth cueing settings from the stage.
  *
- * Since: 0.4
+ * Since: 0.6
  */
 void
-clutter_stage_set_user_resizable (ClutterStage *stage,
-                                  gboolean      resizable)
+clutter_stage_get_fog (ClutterStage *stage,
+                        ClutterFog   *fog)
 {
-  ClutterStagePrivate *priv;
-
   g_return_if_fail (CLUTTER_IS_STAGE (stage));
+  g_return_if_fail (fog != NULL);
 
-  priv = stage->priv;
+  *fog = stage->priv->fog;
+}
 
-  if (clutter_feature_available (CLUTTER_FEATURE_STAGE_USER_RESIZE)
-      && priv->is_user_resizable != resizable)
-    {
-      ClutterStageWindow *impl = CLUTTER_STAGE_WINDOW (priv->impl);
-      ClutterStageWindowIface *iface;
+/*** Perspective boxed type ******/
 
-      iface = CLUTTER_STAGE_WINDOW_GET_IFACE (impl);
-      if (iface->set_user_resizable)
-        {
-          priv->is_user_resizable = resizable;
+static gpointer
+clutter_perspective_copy (gpointer data)
+{
+  if (G_LIKELY (data))
+    return g_slice_dup (ClutterPerspective, data);
 
-          iface->set_user_resizable (impl, resizable);
+  return NULL;
+}
 
-          g_object_notify (G_OBJECT (stage), "user-resizable");
-        }
-    }
+static void
+clutter_perspective_free (gpointer data)
+{
+  if (G_LIKELY (data))
+    g_slice_free (ClutterPerspective, data);
+}
+
+G_DEFINE_BOXED_TYPE (ClutterPerspective, clutter_perspective,
+                     clutter_perspective_copy,
+                     clutter_perspective_free);
+
+static gpointer
+clutter_fog_copy (gpointer data)
+{
+  if (G_LIKELY (data))
+    return g_slice_dup (ClutterFog, data);
+
+  return NULL;
+}
+
+static void
+clutter_fog_free (gpointer data)
+{
+  if (G_LIKELY (data))
+    g_slice_free (ClutterFog, data);
 }
 
+G_DEFINE_BOXED_TYPE (ClutterFog, clutter_fog, clutter_fog_copy, clutter_fog_free);
+
 /**
- * clutter_stage_get_user_resizable:
- * @stage: a #ClutterStage
+ * clutter_stage_new:
  *
- * Retrieves the value set with clutter_stage_set_user_resizable().
+ * Creates a new, non-default stage. A non-default stage is a new
+ * top-level actor which can be used as another container. It works
+ * exactly like the default stage, but while clutter_stage_get_default()
+ * will always return the same instance, you will have to keep a pointer
+ * to any #ClutterStage returned by clutter_stage_new().
  *
- * Return value: %TRUE if the stage is resizable by the user.
+ * The ability to support multiple stages depends on the current
+ * backend. Use clutter_feature_available() and
+ * %CLUTTER_FEATURE_STAGE_MULTIPLE to check at runtime whether a
+ * backend supports multiple stages.
  *
- * Since: 0.4
+ * Return value: a new stage, or %NULL if the default backend does
+ *   not support multiple stages. Use clutter_actor_destroy() to
+ *   programmatically close the returned stage.
+ *
+ * Since: 0.8
  */
-gboolean
-clutter_stage_get_user_resizable (ClutterStage *stage)
+ClutterActor *
+clutter_stage_new (void)
 {
-  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
+  if (!clutter_feature_available (CLUTTER_FEATURE_STAGE_MULTIPLE))
+    {
+      g_warning ("Unable to create a new stage: the %s backend does not "
+                 "support multiple stages.",
+                 CLUTTER_FLAVOUR);
+      return NULL;
+    }
 
-  return stage->priv->is_user_resizable;
+  /* The stage manager will grab the floating reference when the stage
+     is added to it in the constructor */
+  return g_object_new (CLUTTER_TYPE_STAGE, NULL);
 }
 
 /**
- * clutter_stage_show_cursor:
- * @stage: a #ClutterStage
+ * clutter_stage_ensure_current:
+ * @stage: the #ClutterStage
  *
- * Shows the cursor on the stage window
+ * This function essentially makes sure the right GL context is
+ * current for the passed stage. It is not intended to
+ * be used by applications.
+ *
+ * Since: 0.8
  */
 void
-clutter_stage_show_cursor (ClutterStage *stage)
+clutter_stage_ensure_current (ClutterStage *stage)
 {
-  ClutterStagePrivate *priv;
+  ClutterBackend *backend;
 
   g_return_if_fail (CLUTTER_IS_STAGE (stage));
 
-  priv = stage->priv;
-  if (!priv->is_cursor_visible)
-    {
-      ClutterStageWindow *impl = CLUTTER_STAGE_WINDOW (priv->impl);
-      ClutterStageWindowIface *iface;
-
-      iface = CLUTTER_STAGE_WINDOW_GET_IFACE (impl);
-      if (iface->set_cursor_visible)
-        {
-          priv->is_cursor_visible = TRUE;
-
-          iface->set_cursor_visible (impl, TRUE);
-
-          g_object_notify (G_OBJECT (stage), "cursor-visible");
-        }
-    }
+  backend = clutter_get_default_backend ();
+  _clutter_backend_ensure_context (backend, stage);
 }
 
 /**
- * clutter_stage_hide_cursor:
+ * clutter_stage_ensure_viewport:
  * @stage: a #ClutterStage
  *
- * Makes the cursor invisible on the stage window
+ * Ensures that the GL viewport is updated with the current
+ * stage window size.
  *
- * Since: 0.4
+ * This function will queue a redraw of @stage.
+ *
+ * This function should not be called by applications; it is used
+ * when embedding a #ClutterStage into a toolkit with another
+ * windowing system, like GTK+.
+ *
+ * Since: 1.0
  */
 void
-clutter_stage_hide_cursor (ClutterStage *stage)
+clutter_stage_ensure_viewport (ClutterStage *stage)
 {
-  ClutterStagePrivate *priv;
-
   g_return_if_fail (CLUTTER_IS_STAGE (stage));
 
-  priv = stage->priv;
-  if (priv->is_cursor_visible)
+  _clutter_stage_dirty_viewport (stage);
+
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
+}
+
+void
+_clutter_stage_maybe_setup_viewport (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  CoglFramebuffer *framebuffer = cogl_get_draw_framebuffer ();
+
+  if (priv->dirty_viewport)
     {
-      ClutterStageWindow *impl = CLUTTER_STAGE_WINDOW (priv->impl);
-      ClutterStageWindowIface *iface;
+      ClutterPerspective perspective;
 
-      iface = CLUTTER_STAGE_WINDOW_GET_IFACE (impl);
-      if (iface->set_cursor_visible)
-        {
-          priv->is_cursor_visible = FALSE;
+      CLUTTER_NOTE (PAINT,
+                    "Setting up the viewport { w:%f, h:%f }",
+                    priv->viewport[2], priv->viewport[3]);
 
-          iface->set_cursor_visible (impl, FALSE);
+      cogl_set_viewport (priv->viewport[0],
+                         priv->viewport[1],
+                         priv->viewport[2],
+                         priv->viewport[3]);
 
-          g_object_notify (G_OBJECT (stage), "cursor-visible");
-        }
-    }
-}
+      perspective = priv->perspective;
+      perspective.aspect = priv->viewport[2] / priv->viewport[3];
+      clutter_stage_set_perspective (stage, &perspective);
 
-/**
- * clutter_stage_read_pixels:
- * @stage: A #ClutterStage
- * @x: x coordinate of the first pixel that is read from stage
- * @y: y coordinate of the first pixel that is read from stage
- * @width: Width dimention of pixels to be read, or -1 for the
- *   entire stage width
- * @height: Height dimention of pixels to be read, or -1 for the
- *   entire stage height
- *
- * Makes a screenshot of the stage in RGBA 8bit data, returns a
- * linear buffer with @width * 4 as rowstride.
- *
- * The alpha data contained in the returned buffer is driver-dependent,
- * and not guaranteed to hold any sensible value.
- *
- * Return value: a pointer to newly allocated memory with the buffer
- *   or %NULL if the read failed. Use g_free() on the returned data
- *   to release the resources it has allocated.
- */
-guchar *
-clutter_stage_read_pixels (ClutterStage *stage,
-                           gint          x,
-                           gint          y,
-                           gint          width,
-                           gint          height)
-{
-  ClutterGeometry geom;
-  guchar *pixels;
+      cogl_matrix_init_identity (&priv->view);
+      cogl_matrix_view_2d_in_perspective (&priv->view,
+                                          perspective.fovy,
+                                          perspective.aspect,
+                                          perspective.z_near,
+                                          50, /* depth of 2d plane */
+                                          priv->viewport[2],
+                                          priv->viewport[3]);
+      priv->projection_serial += 1;
+
+      priv->dirty_viewport = FALSE;
+    }
+  else if (framebuffer != priv->viewport_framebuffer)
+    {
+      /* the viewport did not change, but it was set on another
+       * framebuffer; we do not need to compute the perspective
+       * and the view again */
+      cogl_set_viewport (priv->viewport[0],
+                         priv->viewport[1],
+                         priv->viewport[2],
+                         priv->viewport[3]);
+    }
 
-  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), NULL);
+  if (priv->dirty_projection || framebuffer != priv->viewport_framebuffer)
+    {
+      cogl_set_projection_matrix (&priv->projection);
 
-  /* Force a redraw of the stage before reading back pixels */
-  clutter_stage_ensure_current (stage);
-  clutter_actor_paint (CLUTTER_ACTOR (stage));
+      priv->dirty_projection = FALSE;
+    }
 
-  clutter_actor_get_allocation_geometry (CLUTTER_ACTOR (stage), &geom);
+  /* we keep a reference on the framebuffer, so that a new one cannot
+   * be mistaken for it */
+  if (framebuffer != priv->viewport_framebuffer)
+    {
+      if (priv->viewport_framebuffer != NULL)
+        cogl_object_unref (priv->viewport_framebuffer);
 
-  if (width < 0)
-    width = geom.width;
+      priv->viewport_framebuffer = framebuffer != NULL
+                                 ? cogl_object_ref (framebuffer)
+                                 : NULL;
+    }
+}
 
-  if (height < 0)
-    height = geom.height;
+/**
+ * clutter_stage_ensure_redraw:
+ * @stage: a #ClutterStage
+ *
+ * Ensures that @stage is redrawn
+ *
+ * This function should not be called by applications: it is
+ * used when embedding a #ClutterStage into a toolkit with
+ * another windowing system, like GTK+.
+ *
+ * Since: 1.0
+ */
+void
+clutter_stage_ensure_redraw (ClutterStage *stage)
+{
+  ClutterMasterClock *master_clock;
+  ClutterStagePrivate *priv;
 
-  pixels = g_malloc (height * width * 4);
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
 
-  cogl_read_pixels (x, y, width, height,
-                    COGL_READ_PIXELS_COLOR_BUFFER,
-                    COGL_PIXEL_FORMAT_RGBA_8888,
-                    pixels);
+  priv = stage->priv;
+  priv->relayout_pending = TRUE;
+  priv->redraw_pending = TRUE;
 
-  return pixels;
+  master_clock = _clutter_master_clock_get_default ();
+  _clutter_master_clock_start_running (master_clock);
 }
 
 /**
- * clutter_stage_get_actor_at_pos:
- * @stage: a #ClutterStage
- * @pick_mode: how the scene graph should be painted
- * @x: X coordinate to check
- * @y: Y coordinate to check
+ * clutter_stage_queue_redraw:
+ * @stage: the #ClutterStage
  *
- * Checks the scene at the coordinates @x and @y and returns a pointer
- * to the #ClutterActor at those coordinates.
+ * Queues a redraw for the passed stage.
  *
- * By using @pick_mode it is possible to control which actors will be
- * painted and thus available.
+ * <note>Applications should call clutter_actor_queue_redraw() and not
+ * this function.</note>
  *
- * Return value: (transfer none): the actor at the specified coordinates,
- *   if any
+ * <note>This function is just a wrapper for clutter_actor_queue_redraw()
+ * and should probably go away.</note>
+ *
+ * Since: 0.8
  */
-ClutterActor *
-clutter_stage_get_actor_at_pos (ClutterStage    *stage,
-                                ClutterPickMode  pick_mode,
-                                gint             x,
-                                gint             y)
+void
+clutter_stage_queue_redraw (ClutterStage *stage)
 {
-  return _clutter_stage_do_pick (stage, x, y, pick_mode);
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
 }
 
 /**
- * clutter_stage_event:
+ * clutter_stage_is_default:
  * @stage: a #ClutterStage
- * @event: a #ClutterEvent
  *
- * This function is used to emit an event on the main stage.
- *
- * You should rarely need to use this function, except for
- * synthetised events.
+ * Checks if @stage is the default stage, or an instance created using
+ * clutter_stage_new() but internally using the same implementation.
  *
- * Return value: the return value from the signal emission
+ * Return value: %TRUE if the passed stage is the default one
  *
- * Since: 0.4
+ * Since: 0.8
  */
 gboolean
-clutter_stage_event (ClutterStage *stage,
-                     ClutterEvent *event)
+clutter_stage_is_default (ClutterStage *stage)
 {
-  ClutterStagePrivate *priv;
+  ClutterStageManager *stage_manager;
+  ClutterStageWindow *impl;
 
   g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
-  g_return_val_if_fail (event != NULL, FALSE);
-
-  priv = stage->priv;
-
-  if (event->type == CLUTTER_DELETE)
-    {
-      gboolean retval = FALSE;
 
-      g_signal_emit_by_name (stage, "event", event, &retval);
+  stage_manager = clutter_stage_manager_get_default ();
+  if (stage != clutter_stage_manager_get_default_stage (stage_manager))
+    return FALSE;
 
-      if (!retval)
-        g_signal_emit_by_name (stage, "delete-event", event, &retval);
+  impl = _clutter_stage_get_window (stage);
+  if (impl != _clutter_stage_get_default_window ())
+    return FALSE;
 
-      return retval;
-    }
+  return TRUE;
+}
 
-  if (event->type != CLUTTER_STAGE_STATE)
-    return FALSE;
+void
+_clutter_stage_set_window (ClutterStage       *stage,
+                           ClutterStageWindow *stage_window)
+{
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+  g_return_if_fail (CLUTTER_IS_STAGE_WINDOW (stage_window));
 
-  /* emit raw event */
-  if (clutter_actor_event (CLUTTER_ACTOR (stage), event, FALSE))
-    return TRUE;
+  if (stage->priv->impl)
+    g_object_unref (stage->priv->impl);
 
-  if (event->stage_state.changed_mask & CLUTTER_STAGE_STATE_FULLSCREEN)
-    {
-      if (event->stage_state.new_state & CLUTTER_STAGE_STATE_FULLSCREEN)
-	{
-	  priv->is_fullscreen = TRUE;
-	  g_signal_emit (stage, stage_signals[FULLSCREEN], 0);
+  stage->priv->impl = stage_window;
+}
 
-          g_object_notify (G_OBJECT (stage), "fullscreen-set");
-	}
-      else
-	{
-	  priv->is_fullscreen = FALSE;
-	  g_signal_emit (stage, stage_signals[UNFULLSCREEN], 0);
+ClutterStageWindow *
+_clutter_stage_get_window (ClutterStage *stage)
+{
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), NULL);
 
-          g_object_notify (G_OBJECT (stage), "fullscreen-set");
-	}
-    }
+  return CLUTTER_STAGE_WINDOW (stage->priv->impl);
+}
 
-  if (event->stage_state.changed_mask & CLUTTER_STAGE_STATE_ACTIVATED)
-    {
-      if (event->stage_state.new_state & CLUTTER_STAGE_STATE_ACTIVATED)
-	g_signal_emit (stage, stage_signals[ACTIVATE], 0);
-      else
-	g_signal_emit (stage, stage_signals[DEACTIVATE], 0);
-    }
+ClutterStageWindow *
+_clutter_stage_get_default_window (void)
+{
+  ClutterActor *stage = clutter_stage_get_default ();
 
-  return TRUE;
+  return _clutter_stage_get_window (CLUTTER_STAGE (stage));
 }
 
 /**
- * clutter_stage_set_title
- * @stage: A #ClutterStage
- * @title: A utf8 string for the stage windows title.
+ * clutter_stage_set_throttle_motion_events:
+ * @stage: a #ClutterStage
+ * @throttle: %TRUE to throttle motion events
  *
- * Sets the stage title.
+ * Sets whether motion events received between redraws should
+ * be throttled or not. If motion events are throttled, those
+ * events received by the windowing system between redraws will
+ * be compressed so that only the last event will be propagated
+ * to the @stage and its actors.
  *
- * Since: 0.4
- **/
+ * This function should only be used if you want to have all
+ * the motion events delivered to your application code.
+ *
+ * Since: 1.0
+ */
 void
-clutter_stage_set_title (ClutterStage       *stage,
-			 const gchar        *title)
+clutter_stage_set_throttle_motion_events (ClutterStage *stage,
+                                          gboolean      throttle)
 {
   ClutterStagePrivate *priv;
-  ClutterStageWindow *impl;
 
   g_return_if_fail (CLUTTER_IS_STAGE (stage));
 
   priv = stage->priv;
 
-  g_free (priv->title);
-  priv->title = g_strdup (title);
-
-  impl = CLUTTER_STAGE_WINDOW (priv->impl);
-  if (CLUTTER_STAGE_WINDOW_GET_IFACE(impl)->set_title != NULL)
-    CLUTTER_STAGE_WINDOW_GET_IFACE (impl)->set_title (impl, priv->title);
-
-  g_object_notify (G_OBJECT (stage), "title");
+  if (priv->throttle_motion_events != throttle)
+    priv->throttle_motion_events = throttle;
 }
 
 /**
- * clutter_stage_get_title
- * @stage: A #ClutterStage
+ * clutter_stage_get_throttle_motion_events:
+ * @stage: a #ClutterStage
  *
- * Gets the stage title.
+ * Retrieves the value set with clutter_stage_set_throttle_motion_events()
  *
- * Return value: pointer to the title string for the stage. The
- * returned string is owned by the actor and should not
- * be modified or freed.
+ * Return value: %TRUE if the motion events are being throttled,
+ *   and %FALSE otherwise
  *
- * Since: 0.4
- **/
-G_CONST_RETURN gchar *
-clutter_stage_get_title (ClutterStage       *stage)
-{
-  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), NULL);
-
-  return stage->priv->title;
-}
-
-static void
-on_key_focused_weak_notify (gpointer data,
-			    GObject *where_the_object_was)
+ * Since: 1.0
+ */
+gboolean
+clutter_stage_get_throttle_motion_events (ClutterStage *stage)
 {
-  ClutterStagePrivate *priv;
-  ClutterStage        *stage = CLUTTER_STAGE (data);
-
-  g_return_if_fail (CLUTTER_IS_STAGE (stage));
-
-  priv = stage->priv;
-  priv->key_focused_actor = NULL;
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
 
-  /* focused actor has dissapeared - fall back to stage
-   * FIXME: need some kind of signal dance/block here.
-  */
-  clutter_stage_set_key_focus (stage, NULL);
+  return stage->priv->throttle_motion_events;
 }
 
 /**
- * clutter_stage_set_key_focus:
- * @stage: the #ClutterStage
- * @actor: (allow-none): the actor to set key focus to, or %NULL
+ * clutter_stage_set_use_alpha:
+ * @stage: a #ClutterStage
+ * @use_alpha: whether the stage should honour the opacity or the
+ *   alpha channel of the stage color
  *
- * Sets the key focus on @actor. An actor with key focus will receive
- * all the key events. If @actor is %NULL, the stage will receive
- * focus.
+ * Sets whether the @stage should honour the #ClutterActor:opacity and
+ * the alpha channel of the #ClutterStage:color
  *
- * Since: 0.6
+ * Since: 1.2
  */
 void
-clutter_stage_set_key_focus (ClutterStage *stage,
-			     ClutterActor *actor)
+clutter_stage_set_use_alpha (ClutterStage *stage,
+                             gboolean      use_alpha)
 {
   ClutterStagePrivate *priv;
 
   g_return_if_fail (CLUTTER_IS_STAGE (stage));
-  g_return_if_fail (actor == NULL || CLUTTER_IS_ACTOR (actor));
 
   priv = stage->priv;
 
-  if (priv->key_focused_actor == actor)
-    return;
-
-  if (priv->key_focused_actor)
+  if (priv->use_alpha != use_alpha)
     {
-      ClutterActor *old_focused_actor;
-
-      old_focused_actor = priv->key_focused_actor;
-
-      /* set key_focused_actor to NULL before emitting the signal or someone
-       * might hide the previously focused actor in the signal handler and we'd
-       * get re-entrant call and get glib critical from g_object_weak_unref
-       */
-
-      g_object_weak_unref (G_OBJECT (priv->key_focused_actor),
-			   on_key_focused_weak_notify,
-			   stage);
-
-      priv->key_focused_actor = NULL;
-
-      g_signal_emit_by_name (old_focused_actor, "key-focus-out");
-    }
-  else
-    g_signal_emit_by_name (stage, "key-focus-out");
-
-  /* Note, if someone changes key focus in focus-out signal handler we'd be
-   * overriding the latter call below moving the focus where it was originally
-   * intended. The order of events would be:
-   *   1st focus-out, 2nd focus-out (on stage), 2nd focus-in, 1st focus-in
-   */
+      priv->use_alpha = use_alpha;
 
-  if (actor)
-    {
-      priv->key_focused_actor = actor;
+      clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
 
-      g_object_weak_ref (G_OBJECT (actor),
-			 on_key_focused_weak_notify,
-			 stage);
-      g_signal_emit_by_name (priv->key_focused_actor, "key-focus-in");
+      g_object_notify (G_OBJECT (stage), "use-alpha");
     }
-  else
-    g_signal_emit_by_name (stage, "key-focus-in");
-
-  g_object_notify (G_OBJECT (stage), "key-focus");
 }
 
 /**
- * clutter_stage_get_key_focus:
- * @stage: the #ClutterStage
+ * clutter_stage_get_use_alpha:
+ * @stage: a #ClutterStage
  *
- * Retrieves the actor that is currently under key focus.
+ * Retrieves the value set using clutter_stage_set_use_alpha()
  *
- * Return value: (transfer none): the actor with key focus, or the stage
+ * Return value: %TRUE if the stage should honour the opacity and the
+ *   alpha channel of the stage color
  *
- * Since: 0.6
+ * Since: 1.2
  */
-ClutterActor *
-clutter_stage_get_key_focus (ClutterStage *stage)
+gboolean
+clutter_stage_get_use_alpha (ClutterStage *stage)
 {
-  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), NULL);
-
-  if (stage->priv->key_focused_actor)
-    return stage->priv->key_focused_actor;
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
 
-  return CLUTTER_ACTOR (stage);
+  return stage->priv->use_alpha;
 }
 
 /**
- * clutter_stage_get_use_fog:
- * @stage: the #ClutterStage
+ * clutter_stage_set_minimum_size:
+ * @stage: a #ClutterStage
+ * @width: width, in pixels
+ * @height: height, in pixels
  *
- * Gets whether the depth cueing effect is enabled on @stage.
+ * Sets the minimum size for a stage window, if the default backend
+ * uses #ClutterStage inside a window
  *
- * Return value: %TRUE if the depth cueing effect is enabled
+ * This is a convenience function, and it is equivalent to setting the
+ * #ClutterActor:min-width and #ClutterActor:min-height on @stage
  *
- * Since: 0.6
+ * If the current size of @stage is smaller than the minimum size, the
+ * @stage will be resized to the new @width and @height
+ *
+ * This function has no effect if @stage is fullscreen
+ *
+ * Since: 1.2
  */
-gboolean
-clutter_stage_get_use_fog (ClutterStage *stage)
+void
+clutter_stage_set_minimum_size (ClutterStage *stage,
+                                guint         width,
+                                guint         height)
 {
-  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+  g_return_if_fail ((width > 0) && (height > 0));
 
-  return stage->priv->use_fog;
+  g_object_set (G_OBJECT (stage),
+                "min-width", (gfloat) width,
+                "min-height", (gfloat )height,
+                NULL);
 }
 
 /**
- * clutter_stage_set_use_fog:
- * @stage: the #ClutterStage
- * @fog: %TRUE for enabling the depth cueing effect
+ * clutter_stage_get_minimum_size:
+ * @stage: a #ClutterStage
+ * @width: (out): return location for the minimum width, in pixels,
+ *   or %NULL
+ * @height: (out): return location for the minimum height, in pixels,
+ *   or %NULL
  *
- * Sets whether the depth cueing effect on the stage should be enabled
- * or not.
+ * Retrieves the minimum size for a stage window as set using
+ * clutter_stage_set_minimum_size().
  *
- * Depth cueing is a 3D effect that makes actors farther away from the
- * viewing point less opaque, by fading them with the stage color.
-
- * The parameters of the GL fog used can be changed using the
- * clutter_stage_set_fog() function.
+ * The returned size may not correspond to the actual minimum size and
+ * it is specific to the #ClutterStage implementation inside the
+ * Clutter backend
  *
- * Since: 0.6
+ * Since: 1.2
  */
 void
-clutter_stage_set_use_fog (ClutterStage *stage,
-                           gboolean      fog)
+clutter_stage_get_minimum_size (ClutterStage *stage,
+                                guint        *width_p,
+                                guint        *height_p)
 {
-  ClutterStagePrivate *priv;
+  gfloat width, height;
+  gboolean width_set, height_set;
 
   g_return_if_fail (CLUTTER_IS_STAGE (stage));
 
-  priv = stage->priv;
+  g_object_get (G_OBJECT (stage),
+                "min-width", &width,
+                "min-width-set", &width_set,
+                "min-height", &height,
+                "min-height-set", &height_set,
+                NULL);
 
-  if (priv->use_fog != fog)
-    {
-      priv->use_fog = fog;
+  /* if not width or height have been set, then the Stage
+   * minimum size is defined to be 1x1
+   */
+  if (!width_set)
+    width = 1;
 
-      CLUTTER_NOTE (MISC, "%s depth-cueing inside stage",
-                    priv->use_fog ? "enabling" : "disabling");
+  if (!height_set)
+    height = 1;
 
-      clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
+  if (width_p)
+    *width_p = (guint) width;
 
-      g_object_notify (G_OBJECT (stage), "use-fog");
-    }
+  if (height_p)
+    *height_p = (guint) height;
+}
+
+/* Returns the number of swap buffers pending completion for the stage */
+int
+_clutter_stage_get_pending_swaps (ClutterStage *stage)
+{
+  ClutterStageWindow *stage_window;
+
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (stage))
+    return 0;
+
+  stage_window = _clutter_stage_get_window (stage);
+  if (stage_window == NULL)
+    return 0;
+
+  return _clutter_stage_window_get_pending_swaps (stage_window);
+}
+
+/* Checks whether the stage has a back buffer available to draw the
+ * next frame into, or whether it would have to wait for one of the
+ * pending swap buffers to complete */
+gboolean
+_clutter_stage_has_free_back_buffer (ClutterStage *stage)
+{
+  ClutterStageWindow *stage_window;
+  int pending_swaps;
+
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (stage))
+    return TRUE;
+
+  stage_window = _clutter_stage_get_window (stage);
+  if (stage_window == NULL)
+    return TRUE;
+
+  pending_swaps = _clutter_stage_window_get_pending_swaps (stage_window);
+  if (pending_swaps == 0)
+    return TRUE;
+
+  return pending_swaps <
+         _clutter_stage_window_get_swap_chain_depth (stage_window);
 }
 
 /**
- * clutter_stage_set_fog:
- * @stage: the #ClutterStage
- * @fog: a #ClutterFog structure
- *
- * Sets the fog (also known as "depth cueing") settings for the @stage.
- *
- * A #ClutterStage will only use a linear fog progression, which
- * depends solely on the distance from the viewer. The cogl_set_fog()
- * function in COGL exposes more of the underlying implementation,
- * and allows changing the for progression function. It can be directly
- * used by disabling the #ClutterStage:use-fog property and connecting
- * a signal handler to the #ClutterActor::paint signal on the @stage,
- * like:
- *
- * |[
- *   clutter_stage_set_use_fog (stage, FALSE);
- *   g_signal_connect (stage, "paint", G_CALLBACK (on_stage_paint), NULL);
- * ]|
- *
- * The paint signal handler will call cogl_set_fog() with the
- * desired settings:
+ * clutter_stage_set_no_clear_hint:
+ * @stage: a #ClutterStage
+ * @no_clear: %TRUE if the @stage should not clear itself on every
+ *   repaint cycle
  *
- * |[
- *   static void
- *   on_stage_paint (ClutterActor *actor)
- *   {
- *     ClutterColor stage_color = { 0, };
- *     CoglColor fog_color = { 0, };
+ * Sets whether the @stage should clear itself at the beginning
+ * of each paint cycle or not.
  *
- *     /&ast; set the fog color to the stage background color &ast;/
- *     clutter_stage_get_color (CLUTTER_STAGE (actor), &amp;stage_color);
- *     cogl_color_init_from_4ub (&amp;fog_color,
- *                               stage_color.red,
- *                               stage_color.green,
- *                               stage_color.blue,
- *                               stage_color.alpha);
+ * Clearing the #ClutterStage can be a costly operation, especially
+ * if the stage is always covered - for instance, in a full-screen
+ * video player or in a game with a background texture.
  *
- *     /&ast; enable fog &ast;/
- *     cogl_set_fog (&amp;fog_color,
- *                   COGL_FOG_MODE_EXPONENTIAL, /&ast; mode &ast;/
- *                   0.5,                       /&ast; density &ast;/
- *                   5.0, 30.0);                /&ast; z_near and z_far &ast;/
- *   }
- * ]|
+ * <note><para>This setting is a hint; Clutter might discard this
+ * hint depending on its internal state.</para></note>
  *
- * <note>The fogging functions only work correctly when the visible actors use
- * unmultiplied alpha colors. By default Cogl will premultiply textures and
- * cogl_set_source_color() will premultiply colors, so unless you explicitly
- * load your textures requesting an unmultiplied internal format and use
- * cogl_material_set_color() you can only use fogging with fully opaque actors.
- * Support for premultiplied colors will improve in the future when we can
- * depend on fragment shaders.</note>
+ * <warning><para>If parts of the stage are visible and you disable
+ * clearing you might end up with visual artifacts while painting the
+ * contents of the stage.</para></warning>
  *
- * Since: 0.6
+ * Since: 1.4
  */
 void
-clutter_stage_set_fog (ClutterStage *stage,
-                       ClutterFog   *fog)
+clutter_stage_set_no_clear_hint (ClutterStage *stage,
+                                 gboolean      no_clear)
 {
   ClutterStagePrivate *priv;
+  ClutterStageHint new_hints;
 
   g_return_if_fail (CLUTTER_IS_STAGE (stage));
-  g_return_if_fail (fog != NULL);
 
   priv = stage->priv;
+  new_hints = priv->stage_hints;
 
-  priv->fog = *fog;
+  if (no_clear)
+    new_hints |= CLUTTER_STAGE_NO_CLEAR_ON_PAINT;
+  else
+    new_hints &= ~CLUTTER_STAGE_NO_CLEAR_ON_PAINT;
 
-  if (priv->use_fog)
-    clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
+  if (priv->stage_hints == new_hints)
+    return;
+
+  priv->stage_hints = new_hints;
+
+  g_object_notify (G_OBJECT (stage), "no-clear-hint");
 }
 
 /**
- * clutter_stage_get_fog:
- * @stage: the #ClutterStage
- * @fog: return location for a #ClutterFog structure
+ * clutter_stage_get_no_clear_hint:
+ * @stage: a #ClutterStage
  *
- * Retrieves the current depth cueing settings from the stage.
+ * Retrieves the hint set with clutter_stage_set_no_clear_hint()
  *
- * Since: 0.6
+ * Return value: %TRUE if the stage should not clear itself on every paint
+ *   cycle, and %FALSE otherwise
+ *
+ * Since: 1.4
+ */
+gboolean
+clutter_stage_get_no_clear_hint (ClutterStage *stage)
+{
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
+
+  return (stage->priv->stage_hints & CLUTTER_STAGE_NO_CLEAR_ON_PAINT) != 0;
+}
+
+/**
+ * clutter_stage_set_geometric_picking:
+ * @stage: a #ClutterStage
+ * @enabled: %TRUE to enable geometric picking
+ *
+ * Sets whether @stage should try to pick actors by checking the
+ * coordinates against the transformed allocation of each actor
+ * on the CPU, instead of painting the scene using unique colors
+ * and reading back the color of the pixel at the given coordinates.
+ *
+ * Geometric picking avoids stalling the GPU pipeline when picking,
+ * which is especially useful on platforms where reading back from
+ * the framebuffer is expensive. It is only used when every mapped
+ * actor uses the default pick silhouette; if an actor overrides
+ * the #ClutterActor::pick virtual function, or if a handler is
+ * connected to its #ClutterActor::pick signal, @stage will fall
+ * back to painting the scene in pick mode.
+ *
+ * Since: 1.8
  */
 void
-clutter_stage_get_fog (ClutterStage *stage,
-                        ClutterFog   *fog)
+clutter_stage_set_geometric_picking (ClutterStage *stage,
+                                     gboolean      enabled)
 {
   g_return_if_fail (CLUTTER_IS_STAGE (stage));
-  g_return_if_fail (fog != NULL);
 
-  *fog = stage->priv->fog;
+  stage->priv->use_geometric_picking = enabled != FALSE;
 }
 
-/*** Perspective boxed type ******/
-
-static gpointer
-clutter_perspective_copy (gpointer data)
+/**
+ * clutter_stage_get_geometric_picking:
+ * @stage: a #ClutterStage
+ *
+ * Retrieves the value set with clutter_stage_set_geometric_picking()
+ *
+ * Return value: %TRUE if geometric picking is enabled on @stage
+ *
+ * Since: 1.8
+ */
+gboolean
+clutter_stage_get_geometric_picking (ClutterStage *stage)
 {
-  if (G_LIKELY (data))
-    return g_slice_dup (ClutterPerspective, data);
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
 
-  return NULL;
+  return stage->priv->use_geometric_picking;
 }
 
-static void
-clutter_perspective_free (gpointer data)
+/**
+ * clutter_stage_set_depth_sorting:
+ * @stage: a #ClutterStage
+ * @enabled: %TRUE to sort the paint of @stage by depth
+ *
+ * Sets whether @stage should use the depth buffer to avoid painting
+ * the pixels covered by opaque actors.
+ *
+ * When enabled, @stage paints the opaque actors without children
+ * first, from the topmost to the bottommost one, and then paints the
+ * scene as usual, with the depth test enabled: the pixels that would
+ * be painted below an opaque actor are discarded by the GPU before
+ * being shaded. The depth of each actor is its position in the
+ * painting order of the scene, so the result is the same as when
+ * painting back to front, even for intersecting actors.
+ *
+ * This is useful for 3D scenes with many overlapping opaque actors,
+ * especially on GPUs limited by their fill rate. Actors painted
+ * through a #ClutterEffect, cached in an offscreen buffer, or
+ * children of a container painting them in a different order than
+ * the one used for picking are painted without the depth test, and
+ * do not benefit from it.
+ *
+ * Since: 1.8
+ */
+void
+clutter_stage_set_depth_sorting (ClutterStage *stage,
+                                 gboolean      enabled)
 {
-  if (G_LIKELY (data))
-    g_slice_free (ClutterPerspective, data);
-}
+  ClutterStagePrivate *priv;
 
-G_DEFINE_BOXED_TYPE (ClutterPerspective, clutter_perspective,
-                     clutter_perspective_copy,
-                     clutter_perspective_free);
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
 
-static gpointer
-clutter_fog_copy (gpointer data)
-{
-  if (G_LIKELY (data))
-    return g_slice_dup (ClutterFog, data);
+  priv = stage->priv;
 
-  return NULL;
-}
+  enabled = enabled != FALSE;
 
-static void
-clutter_fog_free (gpointer data)
-{
-  if (G_LIKELY (data))
-    g_slice_free (ClutterFog, data);
-}
+  if (priv->use_depth_sorting == enabled)
+    return;
 
-G_DEFINE_BOXED_TYPE (ClutterFog, clutter_fog, clutter_fog_copy, clutter_fog_free);
+  priv->use_depth_sorting = enabled;
+
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
+}
 
 /**
- * clutter_stage_new:
- *
- * Creates a new, non-default stage. A non-default stage is a new
- * top-level actor which can be used as another container. It works
- * exactly like the default stage, but while clutter_stage_get_default()
- * will always return the same instance, you will have to keep a pointer
- * to any #ClutterStage returned by clutter_stage_new().
+ * clutter_stage_get_depth_sorting:
+ * @stage: a #ClutterStage
  *
- * The ability to support multiple stages depends on the current
- * backend. Use clutter_feature_available() and
- * %CLUTTER_FEATURE_STAGE_MULTIPLE to check at runtime whether a
- * backend supports multiple stages.
+ * Retrieves the value set with clutter_stage_set_depth_sorting()
  *
- * Return value: a new stage, or %NULL if the default backend does
- *   not support multiple stages. Use clutter_actor_destroy() to
- *   programmatically close the returned stage.
+ * Return value: %TRUE if @stage sorts its paint by depth
  *
- * Since: 0.8
+ * Since: 1.8
  */
-ClutterActor *
-clutter_stage_new (void)
+gboolean
+clutter_stage_get_depth_sorting (ClutterStage *stage)
 {
-  if (!clutter_feature_available (CLUTTER_FEATURE_STAGE_MULTIPLE))
-    {
-      g_warning ("Unable to create a new stage: the %s backend does not "
-                 "support multiple stages.",
-                 CLUTTER_FLAVOUR);
-      return NULL;
-    }
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
 
-  /* The stage manager will grab the floating reference when the stage
-     is added to it in the constructor */
-  return g_object_new (CLUTTER_TYPE_STAGE, NULL);
+  return stage->priv->use_depth_sorting;
 }
 
-/**
- * clutter_stage_ensure_current:
- * @stage: the #ClutterStage
- *
- * This function essentially makes sure the right GL context is
- * current for the passed stage. It is not intended to
- * be used by applications.
+/*< private >
+ * _clutter_stage_presented:
+ * @stage: a #ClutterStage
+ * @presentation_time: the time at which the frame was presented, in
+ *   microseconds, as returned by g_get_monotonic_time()
  *
- * Since: 0.8
+ * Called by the backends when a frame drawn for @stage has been
+ * presented on the screen, if the window system tells them
  */
 void
-clutter_stage_ensure_current (ClutterStage *stage)
+_clutter_stage_presented (ClutterStage *stage,
+                          gint64        presentation_time)
 {
-  ClutterBackend *backend;
+  ClutterStagePrivate *priv = stage->priv;
 
-  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+  /* each stage keeps track of the refresh rate of its own output */
+  priv->refresh_interval =
+    _clutter_master_clock_update_refresh_interval (priv->refresh_interval,
+                                                   priv->presentation_time,
+                                                   presentation_time);
+  priv->presentation_time = presentation_time;
 
-  backend = clutter_get_default_backend ();
-  _clutter_backend_ensure_context (backend, stage);
+  _clutter_master_clock_presented (_clutter_master_clock_get_default (),
+                                   presentation_time);
 }
 
-/**
- * clutter_stage_ensure_viewport:
+/*< private >
+ * _clutter_stage_get_refresh_interval:
  * @stage: a #ClutterStage
  *
- * Ensures that the GL viewport is updated with the current
- * stage window size.
- *
- * This function will queue a redraw of @stage.
+ * Retrieves the measured interval between two vblanks of the output
+ * @stage is presented on
  *
- * This function should not be called by applications; it is used
- * when embedding a #ClutterStage into a toolkit with another
- * windowing system, like GTK+.
+ * Return value: the refresh interval, in microseconds, or 0 if the
+ *   backend does not report the presentation of the frames
+ */
+gint64
+_clutter_stage_get_refresh_interval (ClutterStage *stage)
+{
+  return stage->priv->refresh_interval;
+}
+
+/*< private >
+ * _clutter_stage_add_timeline_time:
+ * @stage: a #ClutterStage
+ * @timeline_time: the time spent advancing the timelines, in
+ *   microseconds
  *
- * Since: 1.0
+ * Records the time the master clock spent advancing the timelines
+ * for the frame @stage is about to draw
  */
 void
-clutter_stage_ensure_viewport (ClutterStage *stage)
+_clutter_stage_add_timeline_time (ClutterStage *stage,
+                                  gint64        timeline_time)
 {
-  g_return_if_fail (CLUTTER_IS_STAGE (stage));
-
-  _clutter_stage_dirty_viewport (stage);
-
-  clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
+  stage->priv->frame_timings.timeline_time += timeline_time;
 }
 
+/*< private >
+ * _clutter_stage_add_swap_time:
+ * @stage: a #ClutterStage
+ * @swap_time: the time spent presenting the frame, in microseconds
+ *
+ * Records the time the backend spent swapping the buffers of @stage
+ * while redrawing it
+ */
 void
-_clutter_stage_maybe_setup_viewport (ClutterStage *stage)
+_clutter_stage_add_swap_time (ClutterStage *stage,
+                              gint64        swap_time)
 {
-  ClutterStagePrivate *priv = stage->priv;
-
-  if (priv->dirty_viewport)
-    {
-      ClutterPerspective perspective;
-
-      CLUTTER_NOTE (PAINT,
-                    "Setting up the viewport { w:%f, h:%f }",
-                    priv->viewport[2], priv->viewport[3]);
-
-      cogl_set_viewport (priv->viewport[0],
-                         priv->viewport[1],
-                         priv->viewport[2],
-                         priv->viewport[3]);
-
-      perspective = priv->perspective;
-      perspective.aspect = priv->viewport[2] / priv->viewport[3];
-      clutter_stage_set_perspective (stage, &perspective);
-
-      cogl_matrix_init_identity (&priv->view);
-      cogl_matrix_view_2d_in_perspective (&priv->view,
-                                          perspective.fovy,
-                                          perspective.aspect,
-                                          perspective.z_near,
-                                          50, /* depth of 2d plane */
-                                          priv->viewport[2],
-                                          priv->viewport[3]);
-
-      priv->dirty_viewport = FALSE;
-    }
-
-  if (priv->dirty_projection)
-    {
-      cogl_set_projection_matrix (&priv->projection);
-
-      priv->dirty_projection = FALSE;
-    }
+  stage->priv->frame_timings.swap_time += swap_time;
 }
 
 /**
- * clutter_stage_ensure_redraw:
+ * clutter_stage_get_frame_timings:
  * @stage: a #ClutterStage
+ * @timings: (out caller-allocates) (array length=n_timings) (allow-none):
+ *   return location for the frame timings, or %NULL
+ * @n_timings: the number of elements of @timings
  *
- * Ensures that @stage is redrawn
+ * Retrieves the timings of the last frames drawn by @stage, from the
+ * oldest to the most recent one.
  *
- * This function should not be called by applications: it is
- * used when embedding a #ClutterStage into a toolkit with
- * another windowing system, like GTK+.
+ * The stage keeps track of a limited number of frames; if @timings is
+ * %NULL, this function returns the number of frames that are currently
+ * available.
  *
- * Since: 1.0
+ * The timings are collected in every build of Clutter, and can be used
+ * to monitor the performance of an application.
+ *
+ * Return value: the number of #ClutterStageFrameTimings written to
+ *   @timings
+ *
+ * Since: 1.8
  */
-void
-clutter_stage_ensure_redraw (ClutterStage *stage)
+guint
+clutter_stage_get_frame_timings (ClutterStage             *stage,
+                                 ClutterStageFrameTimings *timings,
+                                 guint                     n_timings)
 {
-  ClutterMasterClock *master_clock;
   ClutterStagePrivate *priv;
+  guint n_frames, pos, i;
 
-  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), 0);
 
   priv = stage->priv;
-  priv->relayout_pending = TRUE;
-  priv->redraw_pending = TRUE;
 
-  master_clock = _clutter_master_clock_get_default ();
-  _clutter_master_clock_start_running (master_clock);
+  if (timings == NULL)
+    return priv->n_frame_timings;
+
+  n_frames = MIN (n_timings, priv->n_frame_timings);
+
+  /* start from the oldest of the frames we are going to return */
+  pos = (priv->frame_timings_head + STAGE_FRAME_TIMINGS_HISTORY
+         - n_frames + 1) % STAGE_FRAME_TIMINGS_HISTORY;
+
+  for (i = 0; i < n_frames; i++)
+    {
+      timings[i] = priv->frame_timings_history[pos];
+      pos = (pos + 1) % STAGE_FRAME_TIMINGS_HISTORY;
+    }
+
+  return n_frames;
 }
 
-/**
- * clutter_stage_queue_redraw:
- * @stage: the #ClutterStage
- *
- * Queues a redraw for the passed stage.
- *
- * <note>Applications should call clutter_actor_queue_redraw() and not
- * this function.</note>
- *
- * <note>This function is just a wrapper for clutter_actor_queue_redraw()
- * and should probably go away.</note>
- *
- * Since: 0.8
- */
-void
-clutter_stage_queue_redraw (ClutterStage *stage)
+typedef struct
 {
-  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+  ClutterStageStatistics *stats;
+
+  /* the textures shared by more than one actor are counted once */
+  GHashTable *textures;
+} StatisticsData;
+
+static ClutterActorTraverseVisitFlags
+collect_statistics_cb (ClutterActor *actor,
+                       gint          depth,
+                       gpointer      user_data)
+{
+  StatisticsData *data = user_data;
+  ClutterStageStatistics *stats = data->stats;
+  const GList *l;
+  GList *effects;
+
+  stats->n_actors += 1;
+
+  if (CLUTTER_ACTOR_IS_MAPPED (actor))
+    stats->n_mapped_actors += 1;
+
+  if (CLUTTER_ACTOR_IS_VISIBLE (actor))
+    stats->n_visible_actors += 1;
+
+  /* the internal effects, like the one flattening the actors with
+   * an offscreen redirect, are not returned */
+  effects = clutter_actor_get_effects (actor);
+  for (l = effects; l != NULL; l = l->next)
+    {
+      CoglHandle texture;
+
+      if (!CLUTTER_IS_OFFSCREEN_EFFECT (l->data))
+        continue;
+
+      texture = _clutter_offscreen_effect_get_texture (l->data);
+      if (texture == COGL_INVALID_HANDLE)
+        continue;
+
+      stats->n_offscreen_effects += 1;
+      stats->offscreen_memory += (gsize) cogl_texture_get_width (texture)
+                               * cogl_texture_get_height (texture)
+                               * 4;
+    }
+  g_list_free (effects);
+
+  if (CLUTTER_IS_TEXTURE (actor))
+    {
+      CoglHandle texture;
+
+      texture = clutter_texture_get_cogl_texture (CLUTTER_TEXTURE (actor));
+      if (texture != COGL_INVALID_HANDLE &&
+          g_hash_table_lookup (data->textures, texture) == NULL)
+        {
+          g_hash_table_insert (data->textures, texture, texture);
+
+          stats->n_textures += 1;
+          stats->texture_memory += (gsize) cogl_texture_get_width (texture)
+                                 * cogl_texture_get_height (texture)
+                                 * 4;
+        }
+    }
+  else if (CLUTTER_IS_TEXT (actor))
+    stats->n_text_layouts +=
+      _clutter_text_get_n_cached_layouts (CLUTTER_TEXT (actor));
 
-  clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
+  return CLUTTER_ACTOR_TRAVERSE_VISIT_CONTINUE;
 }
 
 /**
- * clutter_stage_is_default:
+ * clutter_stage_get_statistics:
  * @stage: a #ClutterStage
+ * @stats: (out caller-allocates): return location for the statistics
  *
- * Checks if @stage is the default stage, or an instance created using
- * clutter_stage_new() but internally using the same implementation.
+ * Retrieves a snapshot of the resources used by the actors of @stage,
+ * and of the work done to draw its last frame.
  *
- * Return value: %TRUE if the passed stage is the default one
+ * The actors are counted by walking the whole scene graph, so this
+ * function should not be called on every frame; it is meant to be
+ * used to check periodically that an application stays within its
+ * budget.
  *
- * Since: 0.8
+ * Since: 1.8
  */
-gboolean
-clutter_stage_is_default (ClutterStage *stage)
+void
+clutter_stage_get_statistics (ClutterStage           *stage,
+                              ClutterStageStatistics *stats)
 {
-  ClutterStageManager *stage_manager;
-  ClutterStageWindow *impl;
-
-  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
-
-  stage_manager = clutter_stage_manager_get_default ();
-  if (stage != clutter_stage_manager_get_default_stage (stage_manager))
-    return FALSE;
+  ClutterStagePrivate *priv;
+  StatisticsData data;
+  GSList *l;
 
-  impl = _clutter_stage_get_window (stage);
-  if (impl != _clutter_stage_get_default_window ())
-    return FALSE;
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+  g_return_if_fail (stats != NULL);
 
-  return TRUE;
-}
+  priv = stage->priv;
 
-void
-_clutter_stage_set_window (ClutterStage       *stage,
-                           ClutterStageWindow *stage_window)
-{
-  g_return_if_fail (CLUTTER_IS_STAGE (stage));
-  g_return_if_fail (CLUTTER_IS_STAGE_WINDOW (stage_window));
+  memset (stats, 0, sizeof (ClutterStageStatistics));
 
-  if (stage->priv->impl)
-    g_object_unref (stage->priv->impl);
+  stats->n_painted_actors = priv->last_n_painted;
+  stats->n_culled_actors = priv->last_n_culled;
+  stats->n_queued_redraws = priv->last_n_queued_redraws;
+  stats->overdraw_factor = priv->overdraw_factor;
+  stats->clipped_redraw = priv->last_redraw_clipped;
 
-  stage->priv->impl = stage_window;
-}
+  data.stats = stats;
+  data.textures = g_hash_table_new (NULL, NULL);
 
-ClutterStageWindow *
-_clutter_stage_get_window (ClutterStage *stage)
-{
-  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), NULL);
+  _clutter_actor_traverse (CLUTTER_ACTOR (stage),
+                           CLUTTER_ACTOR_TRAVERSE_DEPTH_FIRST,
+                           collect_statistics_cb,
+                           NULL,
+                           &data);
 
-  return CLUTTER_STAGE_WINDOW (stage->priv->impl);
-}
+  g_hash_table_destroy (data.textures);
 
-ClutterStageWindow *
-_clutter_stage_get_default_window (void)
-{
-  ClutterActor *stage = clutter_stage_get_default ();
+  for (l = priv->offscreen_pool; l != NULL; l = l->next)
+    {
+      ClutterStageOffscreen *offscreen = l->data;
 
-  return _clutter_stage_get_window (CLUTTER_STAGE (stage));
+      stats->offscreen_memory += (gsize) offscreen->width
+                               * offscreen->height
+                               * 4;
+    }
 }
 
 /**
- * clutter_stage_set_throttle_motion_events:
+ * clutter_stage_set_track_redraw_causes:
  * @stage: a #ClutterStage
- * @throttle: %TRUE to throttle motion events
+ * @track: whether to track the causes of the redraws
  *
- * Sets whether motion events received between redraws should
- * be throttled or not. If motion events are throttled, those
- * events received by the windowing system between redraws will
- * be compressed so that only the last event will be propagated
- * to the @stage and its actors.
+ * Sets whether @stage should record which functions queue redraws and
+ * relayouts on its actors, for instance to find out why a screen that
+ * should be static keeps being redrawn.
  *
- * This function should only be used if you want to have all
- * the motion events delivered to your application code.
+ * The causes of the redraws of the last frame can be retrieved using
+ * clutter_stage_get_redraw_causes(). Tracking the causes has a small
+ * cost for each queued redraw, so it is disabled by default; it is
+ * enabled on every stage when <literal>CLUTTER_PAINT=redraw-causes</literal>
+ * is set, which also prints the causes of each frame.
  *
- * Since: 1.0
+ * Since: 1.8
  */
 void
-clutter_stage_set_throttle_motion_events (ClutterStage *stage,
-                                          gboolean      throttle)
+clutter_stage_set_track_redraw_causes (ClutterStage *stage,
+                                       gboolean      track)
 {
   ClutterStagePrivate *priv;
 
@@ -3281,279 +6475,306 @@ clutter_stage_set_throttle_motion_events (ClutterStage *stage,
 
   priv = stage->priv;
 
-  if (priv->throttle_motion_events != throttle)
-    priv->throttle_motion_events = throttle;
+  if (track == (priv->pending_redraw_causes != NULL))
+    return;
+
+  if (track)
+    {
+      priv->pending_redraw_causes =
+        g_hash_table_new_full (pending_redraw_cause_hash,
+                               pending_redraw_cause_equal,
+                               pending_redraw_cause_free,
+                               NULL);
+      priv->redraw_causes =
+        g_array_new (FALSE, FALSE, sizeof (ClutterStageRedrawCause));
+
+      n_stages_tracking_redraws += 1;
+    }
+  else
+    {
+      g_hash_table_destroy (priv->pending_redraw_causes);
+      priv->pending_redraw_causes = NULL;
+
+      g_array_free (priv->redraw_causes, TRUE);
+      priv->redraw_causes = NULL;
+
+      n_stages_tracking_redraws -= 1;
+    }
 }
 
 /**
- * clutter_stage_get_throttle_motion_events:
+ * clutter_stage_get_track_redraw_causes:
  * @stage: a #ClutterStage
  *
- * Retrieves the value set with clutter_stage_set_throttle_motion_events()
+ * Retrieves whether @stage records the causes of its redraws.
  *
- * Return value: %TRUE if the motion events are being throttled,
- *   and %FALSE otherwise
+ * Return value: %TRUE if the causes of the redraws are tracked
  *
- * Since: 1.0
+ * Since: 1.8
  */
 gboolean
-clutter_stage_get_throttle_motion_events (ClutterStage *stage)
+clutter_stage_get_track_redraw_causes (ClutterStage *stage)
 {
   g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
 
-  return stage->priv->throttle_motion_events;
+  return stage->priv->pending_redraw_causes != NULL;
 }
 
 /**
- * clutter_stage_set_use_alpha:
+ * clutter_stage_get_redraw_causes:
  * @stage: a #ClutterStage
- * @use_alpha: whether the stage should honour the opacity or the
- *   alpha channel of the stage color
+ * @n_causes: (out): return location for the number of causes
  *
- * Sets whether the @stage should honour the #ClutterActor:opacity and
- * the alpha channel of the #ClutterStage:color
+ * Retrieves the causes of the redraws and of the relayouts queued
+ * for the last frame drawn by @stage, if
+ * clutter_stage_set_track_redraw_causes() was enabled.
  *
- * Since: 1.2
+ * Return value: (transfer none) (array length=n_causes): the causes of
+ *   the redraws of the last frame, or %NULL. The returned array is
+ *   owned by @stage and it is only valid until the next frame
+ *
+ * Since: 1.8
  */
-void
-clutter_stage_set_use_alpha (ClutterStage *stage,
-                             gboolean      use_alpha)
+G_CONST_RETURN ClutterStageRedrawCause *
+clutter_stage_get_redraw_causes (ClutterStage *stage,
+                                 guint        *n_causes)
 {
   ClutterStagePrivate *priv;
 
-  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), NULL);
+  g_return_val_if_fail (n_causes != NULL, NULL);
 
   priv = stage->priv;
 
-  if (priv->use_alpha != use_alpha)
+  if (priv->redraw_causes == NULL || priv->redraw_causes->len == 0)
     {
-      priv->use_alpha = use_alpha;
-
-      clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
-
-      g_object_notify (G_OBJECT (stage), "use-alpha");
+      *n_causes = 0;
+      return NULL;
     }
-}
 
-/**
- * clutter_stage_get_use_alpha:
- * @stage: a #ClutterStage
- *
- * Retrieves the value set using clutter_stage_set_use_alpha()
- *
- * Return value: %TRUE if the stage should honour the opacity and the
- *   alpha channel of the stage color
- *
- * Since: 1.2
- */
-gboolean
-clutter_stage_get_use_alpha (ClutterStage *stage)
-{
-  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
+  *n_causes = priv->redraw_causes->len;
 
-  return stage->priv->use_alpha;
+  return (ClutterStageRedrawCause *) priv->redraw_causes->data;
 }
 
 /**
- * clutter_stage_set_minimum_size:
+ * clutter_stage_get_presentation_time:
  * @stage: a #ClutterStage
- * @width: width, in pixels
- * @height: height, in pixels
  *
- * Sets the minimum size for a stage window, if the default backend
- * uses #ClutterStage inside a window
+ * Retrieves the time at which the last frame drawn for @stage was
+ * presented on the screen.
  *
- * This is a convenience function, and it is equivalent to setting the
- * #ClutterActor:min-width and #ClutterActor:min-height on @stage
+ * The time is expressed in microseconds, using the same clock as
+ * g_get_monotonic_time(), so it can be compared with the time at which
+ * an input event was received to measure the latency of the output.
  *
- * If the current size of @stage is smaller than the minimum size, the
- * @stage will be resized to the new @width and @height
+ * Not every backend is able to report the presentation of a frame.
  *
- * This function has no effect if @stage is fullscreen
+ * Return value: the presentation time of the last frame, or 0 if it
+ *   is not known
  *
- * Since: 1.2
+ * Since: 1.8
  */
-void
-clutter_stage_set_minimum_size (ClutterStage *stage,
-                                guint         width,
-                                guint         height)
+gint64
+clutter_stage_get_presentation_time (ClutterStage *stage)
 {
-  g_return_if_fail (CLUTTER_IS_STAGE (stage));
-  g_return_if_fail ((width > 0) && (height > 0));
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), 0);
 
-  g_object_set (G_OBJECT (stage),
-                "min-width", (gfloat) width,
-                "min-height", (gfloat )height,
-                NULL);
+  return stage->priv->presentation_time;
 }
 
-/**
- * clutter_stage_get_minimum_size:
+/* the data of each chunk is aligned so that it can hold any type */
+#define FRAME_ARENA_ALIGN(x)    (((x) + 15) & ~((gsize) 15))
+#define FRAME_ARENA_HEADER_SIZE FRAME_ARENA_ALIGN (sizeof (ClutterStageArenaChunk))
+#define FRAME_ARENA_CHUNK_SIZE  4096
+
+static void
+clutter_stage_frame_arena_use_chunk (ClutterStagePrivate    *priv,
+                                     ClutterStageArenaChunk *chunk)
+{
+  priv->frame_arena_chunk = chunk;
+  priv->frame_arena_pos = (guint8 *) chunk + FRAME_ARENA_HEADER_SIZE;
+  priv->frame_arena_end = priv->frame_arena_pos + chunk->size;
+}
+
+/*< private >
+ * _clutter_stage_frame_alloc:
  * @stage: a #ClutterStage
- * @width: (out): return location for the minimum width, in pixels,
- *   or %NULL
- * @height: (out): return location for the minimum height, in pixels,
- *   or %NULL
+ * @size: the number of bytes to allocate
  *
- * Retrieves the minimum size for a stage window as set using
- * clutter_stage_set_minimum_size().
+ * Allocates @size bytes that stay valid until the next frame of
+ * @stage is painted; this is meant for the temporary data needed
+ * while painting and culling, like transformed paint volumes or
+ * vertex arrays.
  *
- * The returned size may not correspond to the actual minimum size and
- * it is specific to the #ClutterStage implementation inside the
- * Clutter backend
+ * The memory is taken from a list of chunks owned by the stage with
+ * a simple bump allocator; it must not be freed, since all of it is
+ * reclaimed at once by _clutter_stage_frame_reset(). The chunks are
+ * kept across frames, so that once the peak size of a frame has
+ * been reached painting does not allocate any more memory.
  *
- * Since: 1.2
+ * Return value: a pointer to the allocated memory, aligned to 16 bytes
  */
-void
-clutter_stage_get_minimum_size (ClutterStage *stage,
-                                guint        *width_p,
-                                guint        *height_p)
+gpointer
+_clutter_stage_frame_alloc (ClutterStage *stage,
+                            gsize         size)
 {
-  gfloat width, height;
-  gboolean width_set, height_set;
-
-  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+  ClutterStagePrivate *priv = stage->priv;
+  ClutterStageArenaChunk *chunk;
+  gpointer retval;
 
-  g_object_get (G_OBJECT (stage),
-                "min-width", &width,
-                "min-width-set", &width_set,
-                "min-height", &height,
-                "min-height-set", &height_set,
-                NULL);
+  size = FRAME_ARENA_ALIGN (size);
 
-  /* if not width or height have been set, then the Stage
-   * minimum size is defined to be 1x1
-   */
-  if (!width_set)
-    width = 1;
+  while (priv->frame_arena_chunk == NULL ||
+         priv->frame_arena_pos + size > priv->frame_arena_end)
+    {
+      /* move to the next chunk, if it is big enough */
+      chunk = priv->frame_arena_chunk != NULL
+            ? priv->frame_arena_chunk->next
+            : priv->frame_arena;
 
-  if (!height_set)
-    height = 1;
+      if (chunk == NULL || chunk->size < size)
+        {
+          gsize chunk_size = MAX (size, FRAME_ARENA_CHUNK_SIZE);
+          ClutterStageArenaChunk *new_chunk;
 
-  if (width_p)
-    *width_p = (guint) width;
+          new_chunk = g_malloc (FRAME_ARENA_HEADER_SIZE + chunk_size);
+          new_chunk->size = chunk_size;
+          new_chunk->next = chunk;
 
-  if (height_p)
-    *height_p = (guint) height;
-}
+          if (priv->frame_arena_chunk != NULL)
+            priv->frame_arena_chunk->next = new_chunk;
+          else
+            priv->frame_arena = new_chunk;
 
-/* Returns the number of swap buffers pending completion for the stage */
-int
-_clutter_stage_get_pending_swaps (ClutterStage *stage)
-{
-  ClutterStageWindow *stage_window;
+          chunk = new_chunk;
+        }
 
-  if (CLUTTER_ACTOR_IN_DESTRUCTION (stage))
-    return 0;
+      clutter_stage_frame_arena_use_chunk (priv, chunk);
+    }
 
-  stage_window = _clutter_stage_get_window (stage);
-  if (stage_window == NULL)
-    return 0;
+  retval = priv->frame_arena_pos;
+  priv->frame_arena_pos += size;
 
-  return _clutter_stage_window_get_pending_swaps (stage_window);
+  return retval;
 }
 
-/**
- * clutter_stage_set_no_clear_hint:
+/*< private >
+ * _clutter_stage_frame_reset:
  * @stage: a #ClutterStage
- * @no_clear: %TRUE if the @stage should not clear itself on every
- *   repaint cycle
- *
- * Sets whether the @stage should clear itself at the beginning
- * of each paint cycle or not.
- *
- * Clearing the #ClutterStage can be a costly operation, especially
- * if the stage is always covered - for instance, in a full-screen
- * video player or in a game with a background texture.
- *
- * <note><para>This setting is a hint; Clutter might discard this
- * hint depending on its internal state.</para></note>
- *
- * <warning><para>If parts of the stage are visible and you disable
- * clearing you might end up with visual artifacts while painting the
- * contents of the stage.</para></warning>
  *
- * Since: 1.4
+ * Releases all the memory allocated using _clutter_stage_frame_alloc()
+ * since the last reset; this is called once per frame, before painting
+ * the stage.
  */
 void
-clutter_stage_set_no_clear_hint (ClutterStage *stage,
-                                 gboolean      no_clear)
+_clutter_stage_frame_reset (ClutterStage *stage)
 {
-  ClutterStagePrivate *priv;
-  ClutterStageHint new_hints;
-
-  g_return_if_fail (CLUTTER_IS_STAGE (stage));
-
-  priv = stage->priv;
-  new_hints = priv->stage_hints;
-
-  if (no_clear)
-    new_hints |= CLUTTER_STAGE_NO_CLEAR_ON_PAINT;
-  else
-    new_hints &= ~CLUTTER_STAGE_NO_CLEAR_ON_PAINT;
+  ClutterStagePrivate *priv = stage->priv;
 
-  if (priv->stage_hints == new_hints)
+  if (priv->frame_arena == NULL)
     return;
 
-  priv->stage_hints = new_hints;
+  clutter_stage_frame_arena_use_chunk (priv, priv->frame_arena);
+}
 
-  g_object_notify (G_OBJECT (stage), "no-clear-hint");
+/* The is an out-of-band paramater available while painting that
+ * can be used to cull actors. */
+const ClutterPlane *
+_clutter_stage_get_clip (ClutterStage *stage)
+{
+  return stage->priv->current_clip_planes;
 }
 
-/**
- * clutter_stage_get_no_clear_hint:
+/*< private >
+ * _clutter_stage_set_covering_actor:
  * @stage: a #ClutterStage
+ * @actor: (allow-none): an opaque actor hiding the whole area being
+ *   painted, or %NULL
+ * @is_topmost: whether nothing is painted on top of @actor
  *
- * Retrieves the hint set with clutter_stage_set_no_clear_hint()
- *
- * Return value: %TRUE if the stage should not clear itself on every paint
- *   cycle, and %FALSE otherwise
+ * Records the actor found by the occlusion pass to cover the area of
+ * the window that the current paint of @stage is clipped to. The
+ * stage does not clear its color buffer while such an actor exists.
  *
- * Since: 1.4
+ * The actor is not referenced, and it is only valid until the next
+ * paint of @stage.
  */
-gboolean
-clutter_stage_get_no_clear_hint (ClutterStage *stage)
+void
+_clutter_stage_set_covering_actor (ClutterStage *stage,
+                                   ClutterActor *actor,
+                                   gboolean      is_topmost)
 {
-  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
+  ClutterStagePrivate *priv = stage->priv;
 
-  return (stage->priv->stage_hints & CLUTTER_STAGE_NO_CLEAR_ON_PAINT) != 0;
+  priv->covering_actor = actor;
+  priv->covering_actor_is_topmost = actor != NULL && is_topmost;
 }
 
-ClutterPaintVolume *
-_clutter_stage_paint_volume_stack_allocate (ClutterStage *stage)
+/*< private >
+ * _clutter_stage_set_clear_area:
+ * @stage: a #ClutterStage
+ * @area: (allow-none): the part of the area being painted that is not
+ *   hidden by opaque actors, in window coordinates, or %NULL for the
+ *   whole area being painted
+ *
+ * Records the area that the occlusion pass found to be left uncovered
+ * by the opaque actors; the stage only clears the color buffer inside
+ * of it. An empty @area skips the color clear entirely.
+ *
+ * The area is only valid until the next paint of @stage.
+ */
+void
+_clutter_stage_set_clear_area (ClutterStage          *stage,
+                               const ClutterGeometry *area)
 {
-  GArray *paint_volume_stack = stage->priv->paint_volume_stack;
+  ClutterStagePrivate *priv = stage->priv;
+  const ClutterGeometry *clip = &priv->current_clip;
 
-  g_array_set_size (paint_volume_stack,
-                    paint_volume_stack->len+1);
+  priv->clear_area_partial = area != NULL &&
+                             (area->x != clip->x ||
+                              area->y != clip->y ||
+                              area->width != clip->width ||
+                              area->height != clip->height);
 
-  return &g_array_index (paint_volume_stack,
-                         ClutterPaintVolume,
-                         paint_volume_stack->len - 1);
+  if (priv->clear_area_partial)
+    priv->clear_area = *area;
 }
 
-void
-_clutter_stage_paint_volume_stack_free_all (ClutterStage *stage)
+/*< private >
+ * _clutter_stage_get_scanout_actor:
+ * @stage: a #ClutterStage
+ *
+ * Retrieves the actor that was the only one visible in the last paint
+ * of @stage: it is opaque, it covers the whole painted area with a
+ * rectangle aligned to the window, and nothing is painted on top of
+ * it. A backend able to show the contents of such an actor directly
+ * on a display plane can skip the composition of the frame.
+ *
+ * Return value: (transfer none): the actor, or %NULL
+ */
+ClutterActor *
+_clutter_stage_get_scanout_actor (ClutterStage *stage)
 {
-  GArray *paint_volume_stack = stage->priv->paint_volume_stack;
-  int i;
-
-  for (i = 0; i < paint_volume_stack->len; i++)
-    {
-      ClutterPaintVolume *pv =
-        &g_array_index (paint_volume_stack, ClutterPaintVolume, i);
-      clutter_paint_volume_free (pv);
-    }
+  ClutterStagePrivate *priv = stage->priv;
 
-  g_array_set_size (paint_volume_stack, 0);
+  return priv->covering_actor_is_topmost ? priv->covering_actor : NULL;
 }
 
-/* The is an out-of-band paramater available while painting that
- * can be used to cull actors. */
-const ClutterPlane *
-_clutter_stage_get_clip (ClutterStage *stage)
+/*< private >
+ * _clutter_stage_get_clip_geometry:
+ * @stage: a #ClutterStage
+ * @clip: (out): return location for the area being painted
+ *
+ * Retrieves the area of the window, in window coordinates, that the
+ * current paint of @stage is clipped to; this is the whole window
+ * unless the stage is doing a clipped redraw.
+ */
+void
+_clutter_stage_get_clip_geometry (ClutterStage    *stage,
+                                  ClutterGeometry *clip)
 {
-  return stage->priv->current_clip_planes;
+  *clip = stage->priv->current_clip;
 }
 
 /* When an actor queues a redraw we add it to a list on the stage that
@@ -3567,6 +6788,43 @@ _clutter_stage_get_clip (ClutterStage *stage)
  * paint volume so we can clip the redraw request even if the user
  * didn't explicitly do so.
  */
+#define STAGE_QUEUE_REDRAW_CHUNK_SIZE   64
+
+static inline ClutterStageQueueRedrawEntry *
+clutter_stage_get_queue_redraw_entry (ClutterStage *stage,
+                                      guint         index_)
+{
+  ClutterStageQueueRedrawEntry *chunk;
+
+  chunk = g_ptr_array_index (stage->priv->queue_redraw_chunks,
+                             index_ / STAGE_QUEUE_REDRAW_CHUNK_SIZE);
+
+  return &chunk[index_ % STAGE_QUEUE_REDRAW_CHUNK_SIZE];
+}
+
+/* Returns an unused entry; the chunks are only ever allocated when the
+ * number of redraws queued in a frame grows past what was needed by the
+ * previous frames, and never move, so the actors can keep a pointer to
+ * their entry */
+static ClutterStageQueueRedrawEntry *
+clutter_stage_alloc_queue_redraw_entry (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  guint index_ = priv->n_pending_queue_redraws;
+
+  if (priv->queue_redraw_chunks == NULL)
+    priv->queue_redraw_chunks = g_ptr_array_new ();
+
+  if (index_ / STAGE_QUEUE_REDRAW_CHUNK_SIZE >= priv->queue_redraw_chunks->len)
+    g_ptr_array_add (priv->queue_redraw_chunks,
+                     g_new (ClutterStageQueueRedrawEntry,
+                            STAGE_QUEUE_REDRAW_CHUNK_SIZE));
+
+  priv->n_pending_queue_redraws += 1;
+
+  return clutter_stage_get_queue_redraw_entry (stage, index_);
+}
+
 ClutterStageQueueRedrawEntry *
 _clutter_stage_queue_actor_redraw (ClutterStage *stage,
                                    ClutterStageQueueRedrawEntry *entry,
@@ -3608,6 +6866,7 @@ _clutter_stage_queue_actor_redraw (ClutterStage *stage,
    * this point to invalidate any currently cached pick buffer.
    */
   _clutter_stage_set_pick_buffer_valid (stage, FALSE, -1);
+  priv->scene_serial += 1;
 
   if (entry)
     {
@@ -3635,7 +6894,7 @@ _clutter_stage_queue_actor_redraw (ClutterStage *stage,
     }
   else
     {
-      entry = g_slice_new (ClutterStageQueueRedrawEntry);
+      entry = clutter_stage_alloc_queue_redraw_entry (stage);
       entry->actor = g_object_ref (actor);
 
       if (clip)
@@ -3647,21 +6906,36 @@ _clutter_stage_queue_actor_redraw (ClutterStage *stage,
       else
         entry->has_clip = FALSE;
 
-      stage->priv->pending_queue_redraws =
-        g_list_prepend (stage->priv->pending_queue_redraws, entry);
-
       return entry;
     }
 }
 
 static void
-free_queue_redraw_entry (ClutterStageQueueRedrawEntry *entry)
+clear_queue_redraw_entry (ClutterStageQueueRedrawEntry *entry)
 {
   if (entry->actor)
     g_object_unref (entry->actor);
   if (entry->has_clip)
     clutter_paint_volume_free (&entry->clip);
-  g_slice_free (ClutterStageQueueRedrawEntry, entry);
+}
+
+static void
+clutter_stage_free_queue_redraw_entries (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  guint i;
+
+  if (priv->queue_redraw_chunks == NULL)
+    return;
+
+  for (i = 0; i < priv->n_pending_queue_redraws; i++)
+    clear_queue_redraw_entry (clutter_stage_get_queue_redraw_entry (stage, i));
+
+  priv->n_pending_queue_redraws = 0;
+
+  g_ptr_array_foreach (priv->queue_redraw_chunks, (GFunc) g_free, NULL);
+  g_ptr_array_free (priv->queue_redraw_chunks, TRUE);
+  priv->queue_redraw_chunks = NULL;
 }
 
 void
@@ -3686,39 +6960,60 @@ _clutter_stage_queue_redraw_entry_invalidate (ClutterStageQueueRedrawEntry *entr
 static void
 _clutter_stage_maybe_finish_queue_redraws (ClutterStage *stage)
 {
-  /* Note: we have to repeat until the pending_queue_redraws list is
-   * empty because actors are allowed to queue redraws in response to
-   * the queue-redraw signal. For example Clone actors or
+  ClutterStagePrivate *priv = stage->priv;
+  guint i;
+
+  priv->last_queue_redraw_stamp += 1;
+  if (priv->last_queue_redraw_stamp == 0)
+    priv->last_queue_redraw_stamp = 1;
+
+  priv->queue_redraw_stamp = priv->last_queue_redraw_stamp;
+
+  /* Note: the number of pending entries can grow while we process them
+   * because actors are allowed to queue redraws in response to the
+   * queue-redraw signal. For example Clone actors or
    * texture_new_from_actor actors will have to queue a redraw if
-   * their source queues a redraw.
+   * their source queues a redraw. The new entries are appended after
+   * the ones we are processing and the existing entries never move,
+   * so we simply keep going until we reach the end.
    */
-  while (stage->priv->pending_queue_redraws)
+  for (i = 0; i < priv->n_pending_queue_redraws; i++)
     {
-      GList *l;
-      /* XXX: we need to allow stage->priv->pending_queue_redraws to
-       * be updated while we process the current entries in the list
-       * so we steal the list pointer and then reset it to an empty
-       * list before processing... */
-      GList *stolen_list = stage->priv->pending_queue_redraws;
-      stage->priv->pending_queue_redraws = NULL;
+      ClutterStageQueueRedrawEntry *entry;
+      ClutterPaintVolume *clip;
 
-      for (l = stolen_list; l; l = l->next)
-        {
-          ClutterStageQueueRedrawEntry *entry = l->data;
-          ClutterPaintVolume *clip;
-
-          /* NB: Entries may be invalidated if the actor gets destroyed */
-          if (G_LIKELY (entry->actor != NULL))
-	    {
-	      clip = entry->has_clip ? &entry->clip : NULL;
+      entry = clutter_stage_get_queue_redraw_entry (stage, i);
 
-	      _clutter_actor_finish_queue_redraw (entry->actor, clip);
-	    }
+      /* NB: Entries may be invalidated if the actor gets destroyed */
+      if (G_LIKELY (entry->actor != NULL))
+        {
+          clip = entry->has_clip ? &entry->clip : NULL;
 
-          free_queue_redraw_entry (entry);
+          _clutter_actor_finish_queue_redraw (entry->actor, clip);
         }
-      g_list_free (stolen_list);
+
+      clear_queue_redraw_entry (entry);
     }
+
+  priv->last_n_queued_redraws = priv->n_pending_queue_redraws;
+  priv->n_pending_queue_redraws = 0;
+  priv->queue_redraw_stamp = 0;
+}
+
+/*< private >
+ * _clutter_stage_get_queue_redraw_stamp:
+ * @stage: a #ClutterStage
+ *
+ * Retrieves the stamp of the queued redraws that @stage is currently
+ * finishing, before painting a frame.
+ *
+ * Return value: the stamp, or 0 if @stage is not finishing the
+ *   queued redraws
+ */
+guint
+_clutter_stage_get_queue_redraw_stamp (ClutterStage *stage)
+{
+  return stage->priv->queue_redraw_stamp;
 }
 
 /**
@@ -3867,3 +7162,472 @@ _clutter_stage_get_actor_by_pick_id (ClutterStage *stage,
 
   return _clutter_id_pool_lookup (priv->pick_id_pool, pick_id);
 }
+
+/* the granularity of the size of the pooled offscreen targets */
+#define STAGE_OFFSCREEN_BUCKET_SIZE     32
+
+/* the number of updates an unused pooled target is kept around for */
+#define STAGE_OFFSCREEN_MAX_AGE         16
+
+/* rounds the size of a pooled offscreen target up to a multiple of
+ * STAGE_OFFSCREEN_BUCKET_SIZE; being a power of two, the maximum texture
+ * size is never exceeded unless the requested size already did
+ */
+static inline gint
+offscreen_pool_bucket (gint size)
+{
+  size = MAX (size, 1);
+
+  return (size + STAGE_OFFSCREEN_BUCKET_SIZE - 1)
+       & ~(STAGE_OFFSCREEN_BUCKET_SIZE - 1);
+}
+
+/*< private >
+ * _clutter_stage_acquire_offscreen:
+ * @stage: a #ClutterStage
+ * @width: the minimum width of the target
+ * @height: the minimum height of the target
+ * @format: the pixel format of the target
+ *
+ * Borrows an offscreen render target from the pool of @stage, creating
+ * a new one if no target of the right size and format is available.
+ *
+ * Targets still holding the image of their previous user are only
+ * handed out if that user did not paint for more than one update.
+ *
+ * The target should be given back using _clutter_stage_release_offscreen()
+ * as soon as it is not needed anymore, or freed using
+ * _clutter_stage_offscreen_free() if @stage went away in the meantime.
+ *
+ * Return value: an offscreen target, or %NULL
+ */
+ClutterStageOffscreen *
+_clutter_stage_acquire_offscreen (ClutterStage    *stage,
+                                  gint             width,
+                                  gint             height,
+                                  CoglPixelFormat  format)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  ClutterStageOffscreen *offscreen;
+  gint bucket_width, bucket_height;
+  GSList *l, *stale;
+
+  bucket_width = offscreen_pool_bucket (width);
+  bucket_height = offscreen_pool_bucket (height);
+
+  stale = NULL;
+
+  for (l = priv->offscreen_pool; l != NULL; l = l->next)
+    {
+      offscreen = l->data;
+
+      if (offscreen->width != bucket_width ||
+          offscreen->height != bucket_height ||
+          offscreen->format != format)
+        continue;
+
+      if (offscreen->owner == NULL)
+        break;
+
+      if (stale == NULL &&
+          priv->update_serial - offscreen->release_serial > 1)
+        stale = l;
+    }
+
+  if (l == NULL)
+    l = stale;
+
+  if (l != NULL)
+    {
+      offscreen = l->data;
+      offscreen->owner = NULL;
+
+      priv->offscreen_pool = g_slist_delete_link (priv->offscreen_pool, l);
+
+          /* the previous user of the texture might still have queued
+           * geometry painting it; we need to flush it, otherwise it
+           * would be painted with the contents of the next user
+           */
+      cogl_flush ();
+
+      return offscreen;
+    }
+
+  offscreen = g_slice_new0 (ClutterStageOffscreen);
+  offscreen->width = bucket_width;
+  offscreen->height = bucket_height;
+  offscreen->format = format;
+
+  offscreen->texture = cogl_texture_new_with_size (bucket_width, bucket_height,
+                                                   COGL_TEXTURE_NO_SLICING,
+                                                   format);
+  if (offscreen->texture != COGL_INVALID_HANDLE)
+    offscreen->framebuffer = cogl_offscreen_new_to_texture (offscreen->texture);
+
+  if (offscreen->framebuffer == COGL_INVALID_HANDLE)
+    {
+      _clutter_stage_offscreen_free (offscreen);
+      return NULL;
+    }
+
+  CLUTTER_NOTE (PAINT, "Created a pooled offscreen target of %dx%d pixels",
+                bucket_width,
+                bucket_height);
+
+  return offscreen;
+}
+
+/*< private >
+ * _clutter_stage_release_offscreen:
+ * @stage: a #ClutterStage
+ * @offscreen: a target returned by _clutter_stage_acquire_offscreen()
+ * @owner: (allow-none): the user whose image is in @offscreen, or %NULL
+ *
+ * Gives @offscreen back to the pool of @stage, so that it can be reused
+ * by the next effect needing a target of the same size.
+ *
+ * If @owner is not %NULL, the contents of the target are worth keeping
+ * and @owner can get them back using _clutter_stage_reclaim_offscreen(),
+ * unless somebody else needed the target in the meantime. The owner
+ * must reclaim the target, or release it again with a %NULL owner,
+ * before going away.
+ */
+void
+_clutter_stage_release_offscreen (ClutterStage          *stage,
+                                  ClutterStageOffscreen *offscreen,
+                                  gpointer               owner)
+{
+  ClutterStagePrivate *priv = stage->priv;
+
+  offscreen->release_serial = priv->update_serial;
+  offscreen->owner = owner;
+
+  priv->offscreen_pool = g_slist_prepend (priv->offscreen_pool, offscreen);
+}
+
+/*< private >
+ * _clutter_stage_reclaim_offscreen:
+ * @stage: a #ClutterStage
+ * @owner: the owner passed to _clutter_stage_release_offscreen()
+ * @width: the minimum width of the target
+ * @height: the minimum height of the target
+ * @format: the pixel format of the target
+ *
+ * Takes back the target that @owner released last, with its contents
+ * untouched, if it is still in the pool of @stage and it can hold an
+ * image of the given size and format.
+ *
+ * Return value: an offscreen target, or %NULL
+ */
+ClutterStageOffscreen *
+_clutter_stage_reclaim_offscreen (ClutterStage    *stage,
+                                  gpointer         owner,
+                                  gint             width,
+                                  gint             height,
+                                  CoglPixelFormat  format)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  GSList *l;
+
+  for (l = priv->offscreen_pool; l != NULL; l = l->next)
+    {
+      ClutterStageOffscreen *offscreen = l->data;
+
+      if (offscreen->owner != owner)
+        continue;
+
+      /* the image is of no use anymore if the size changed */
+      if (offscreen->width != offscreen_pool_bucket (width) ||
+          offscreen->height != offscreen_pool_bucket (height) ||
+          offscreen->format != format)
+        {
+          offscreen->owner = NULL;
+          return NULL;
+        }
+
+      priv->offscreen_pool = g_slist_delete_link (priv->offscreen_pool, l);
+
+      /* unlike _clutter_stage_acquire_offscreen() we do not need to
+       * flush, since the last user of the target was @owner itself
+       */
+      return offscreen;
+    }
+
+  return NULL;
+}
+
+/*< private >
+ * _clutter_stage_offscreen_free:
+ * @offscreen: an offscreen target
+ *
+ * Frees the resources of a target that is not going back to a pool
+ */
+void
+_clutter_stage_offscreen_free (ClutterStageOffscreen *offscreen)
+{
+  if (offscreen->framebuffer != COGL_INVALID_HANDLE)
+    cogl_handle_unref (offscreen->framebuffer);
+
+  if (offscreen->texture != COGL_INVALID_HANDLE)
+    cogl_handle_unref (offscreen->texture);
+
+  g_slice_free (ClutterStageOffscreen, offscreen);
+}
+
+/*< private >
+ * _clutter_stage_release_offscreen_pool:
+ * @stage: a #ClutterStage
+ *
+ * Frees all the targets in the pool of @stage, including the ones
+ * whose contents were kept for their owner; the backends call this
+ * when the system is running out of memory.
+ */
+void
+_clutter_stage_release_offscreen_pool (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+
+  g_slist_foreach (priv->offscreen_pool,
+                   (GFunc) _clutter_stage_offscreen_free,
+                   NULL);
+  g_slist_free (priv->offscreen_pool);
+  priv->offscreen_pool = NULL;
+}
+
+/* frees the pooled targets that nobody borrowed in a while */
+static void
+clutter_stage_trim_offscreen_pool (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  GSList *l, *next;
+
+  for (l = priv->offscreen_pool; l != NULL; l = next)
+    {
+      ClutterStageOffscreen *offscreen = l->data;
+
+      next = l->next;
+
+      if (priv->update_serial - offscreen->release_serial <=
+          STAGE_OFFSCREEN_MAX_AGE)
+        continue;
+
+      priv->offscreen_pool = g_slist_delete_link (priv->offscreen_pool, l);
+      _clutter_stage_offscreen_free (offscreen);
+    }
+}
+
+/* Spatial index
+ *
+ * The stage keeps a uniform grid of the screen-space boxes covered by
+ * the actors when they were last painted, so that operations that only
+ * care about a small area of the stage, like picking, can discard most
+ * of the actors without looking at their geometry.
+ */
+#define STAGE_INDEX_CELL_SIZE   64
+
+static void
+clutter_stage_index_clear (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  gint i, n_cells;
+
+  if (priv->index_cells == NULL)
+    return;
+
+  n_cells = priv->index_n_columns * priv->index_n_rows;
+
+  for (i = 0; i < n_cells; i++)
+    {
+      GPtrArray *cell = priv->index_cells[i];
+      guint j;
+
+      if (cell == NULL)
+        continue;
+
+      for (j = 0; j < cell->len; j++)
+        {
+          ClutterStageIndexNode *node = g_ptr_array_index (cell, j);
+
+          node->stage = NULL;
+        }
+
+      g_ptr_array_free (cell, TRUE);
+    }
+
+  g_free (priv->index_cells);
+  priv->index_cells = NULL;
+  priv->index_n_columns = 0;
+  priv->index_n_rows = 0;
+}
+
+static void
+clutter_stage_index_ensure_cells (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  gint n_columns, n_rows;
+
+  n_columns = ceilf (priv->viewport[2] / STAGE_INDEX_CELL_SIZE);
+  n_rows = ceilf (priv->viewport[3] / STAGE_INDEX_CELL_SIZE);
+
+  if (priv->index_cells != NULL &&
+      priv->index_n_columns == n_columns &&
+      priv->index_n_rows == n_rows)
+    return;
+
+  /* the size of the stage changed, so we need to start over; the
+   * nodes will be added back the next time their actor is painted */
+  clutter_stage_index_clear (stage);
+
+  if (n_columns <= 0 || n_rows <= 0)
+    return;
+
+  priv->index_n_columns = n_columns;
+  priv->index_n_rows = n_rows;
+  priv->index_cells = g_new0 (GPtrArray *, n_columns * n_rows);
+}
+
+/*< private >
+ * _clutter_stage_index_node_remove:
+ * @node: a #ClutterStageIndexNode
+ *
+ * Removes @node from the index of the stage it was added to, if any
+ */
+void
+_clutter_stage_index_node_remove (ClutterStageIndexNode *node)
+{
+  ClutterStagePrivate *priv;
+  gint x, y;
+
+  if (node->stage == NULL)
+    return;
+
+  priv = node->stage->priv;
+
+  for (y = node->y1; y <= node->y2; y++)
+    for (x = node->x1; x <= node->x2; x++)
+      {
+        GPtrArray *cell = priv->index_cells[y * priv->index_n_columns + x];
+
+        g_ptr_array_remove_fast (cell, node);
+      }
+
+  node->stage = NULL;
+}
+
+/*< private >
+ * _clutter_stage_index_update:
+ * @stage: a #ClutterStage
+ * @node: a #ClutterStageIndexNode
+ * @box: the screen-space box covered by @node
+ *
+ * Adds @node to the spatial index of @stage, or updates its position
+ * in the index if it was already added
+ */
+void
+_clutter_stage_index_update (ClutterStage          *stage,
+                             ClutterStageIndexNode *node,
+                             const ClutterActorBox *box)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  gint x1, y1, x2, y2;
+  gint x, y;
+
+  if (node->stage == stage &&
+      clutter_actor_box_equal (&node->box, box))
+    return;
+
+  _clutter_stage_index_node_remove (node);
+
+  clutter_stage_index_ensure_cells (stage);
+
+  if (priv->index_cells == NULL)
+    return;
+
+  x1 = floorf (box->x1 / STAGE_INDEX_CELL_SIZE);
+  y1 = floorf (box->y1 / STAGE_INDEX_CELL_SIZE);
+  x2 = floorf (box->x2 / STAGE_INDEX_CELL_SIZE);
+  y2 = floorf (box->y2 / STAGE_INDEX_CELL_SIZE);
+
+  /* a box that lies outside of the stage is still indexed, but it
+   * does not cover any cell */
+  node->x1 = MAX (x1, 0);
+  node->y1 = MAX (y1, 0);
+  node->x2 = MIN (x2, priv->index_n_columns - 1);
+  node->y2 = MIN (y2, priv->index_n_rows - 1);
+
+  for (y = node->y1; y <= node->y2; y++)
+    for (x = node->x1; x <= node->x2; x++)
+      {
+        GPtrArray **cell = &priv->index_cells[y * priv->index_n_columns + x];
+
+        if (*cell == NULL)
+          *cell = g_ptr_array_new ();
+
+        g_ptr_array_add (*cell, node);
+      }
+
+  node->stage = stage;
+  node->box = *box;
+}
+
+/*< private >
+ * _clutter_stage_index_query_point:
+ * @stage: a #ClutterStage
+ * @x: X coordinate, in window coordinates
+ * @y: Y coordinate, in window coordinates
+ *
+ * Marks all the nodes in the spatial index of @stage whose box contains
+ * the given point; use _clutter_stage_index_node_may_match() with the
+ * returned stamp to check whether a node could contain the point.
+ *
+ * Return value: the stamp of the query, or 0 if the index cannot be
+ *   used for the point
+ */
+guint
+_clutter_stage_index_query_point (ClutterStage *stage,
+                                  gfloat        x,
+                                  gfloat        y)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  GPtrArray *cell;
+  gint column, row;
+  guint i;
+
+  if (priv->index_cells == NULL)
+    return 0;
+
+  /* if we are not updating the last paint volumes of the actors
+   * then the index is not going to be updated either */
+  if (G_UNLIKELY ((clutter_paint_debug_flags &
+                   (CLUTTER_DEBUG_DISABLE_CULLING |
+                    CLUTTER_DEBUG_DISABLE_CLIPPED_REDRAWS)) ==
+                  (CLUTTER_DEBUG_DISABLE_CULLING |
+                   CLUTTER_DEBUG_DISABLE_CLIPPED_REDRAWS)))
+    return 0;
+
+  if (x < 0 || y < 0)
+    return 0;
+
+  column = x / STAGE_INDEX_CELL_SIZE;
+  row = y / STAGE_INDEX_CELL_SIZE;
+  if (column >= priv->index_n_columns || row >= priv->index_n_rows)
+    return 0;
+
+  /* 0 is reserved for "no query" */
+  if (G_UNLIKELY (++priv->index_query_stamp == 0))
+    priv->index_query_stamp = 1;
+
+  cell = priv->index_cells[row * priv->index_n_columns + column];
+  if (cell == NULL)
+    return priv->index_query_stamp;
+
+  for (i = 0; i < cell->len; i++)
+    {
+      ClutterStageIndexNode *node = g_ptr_array_index (cell, i);
+
+      if (clutter_actor_box_contains (&node->box, x, y))
+        node->query_stamp = priv->index_query_stamp;
+    }
+
+  return priv->index_query_stamp;
+}
@@ -89,6 +89,9 @@ typedef enum {
 
 typedef struct _ClutterPerspective  ClutterPerspective;
 typedef struct _ClutterFog          ClutterFog;
+typedef struct _ClutterStageFrameTimings ClutterStageFrameTimings;
+typedef struct _ClutterStageStatistics ClutterStageStatistics;
+typedef struct _ClutterStageRedrawCause ClutterStageRedrawCause;
 
 typedef struct _ClutterStageClass   ClutterStageClass;
 typedef struct _ClutterStagePrivate ClutterStagePrivate;
@@ -183,6 +186,177 @@ struct _ClutterFog
   gfloat z_far;
 };
 
+/**
+ * ClutterStageFrameTimings:
+ * @frame_time: the time at which the frame was completed, in microseconds,
+ *   using the same clock as g_get_monotonic_time()
+ * @event_time: the time spent processing the events queued for the
+ *   frame, in microseconds
+ * @timeline_time: the time spent advancing the timelines, in microseconds
+ * @layout_time: the time spent allocating the actors, in microseconds
+ * @paint_time: the time spent painting the stage, in microseconds
+ * @swap_time: the time spent presenting the frame, in microseconds
+ * @n_picks: the number of picks done since the previous frame
+ * @n_pick_renders: the number of picks done since the previous frame
+ *   that had to paint the scene, instead of reusing the pick buffer or
+ *   hit-testing the actors
+ * @n_painted_actors: the number of actors painted, including the
+ *   actors painted by clones and effects
+ * @n_allocated_actors: the number of actors allocated
+ * @n_size_requests: the number of preferred size requests made while
+ *   allocating the actors
+ * @n_cached_size_requests: the number of size requests that were
+ *   answered by the size request cache of the actors
+ *
+ * The time spent by a #ClutterStage on each of the phases of a frame,
+ * as returned by clutter_stage_get_frame_timings().
+ *
+ * Since: 1.8
+ */
+struct _ClutterStageFrameTimings
+{
+  gint64 frame_time;
+
+  gint64 event_time;
+  gint64 timeline_time;
+  gint64 layout_time;
+  gint64 paint_time;
+  gint64 swap_time;
+
+  guint n_picks;
+  guint n_pick_renders;
+  guint n_painted_actors;
+  guint n_allocated_actors;
+  guint n_size_requests;
+  guint n_cached_size_requests;
+};
+
+/**
+ * ClutterStageStatistics:
+ * @n_actors: the number of actors inside the stage, including the stage
+ * @n_mapped_actors: the number of mapped actors
+ * @n_visible_actors: the number of actors with the
+ *   #ClutterActor:visible property set
+ * @n_painted_actors: the number of actors painted in the last frame
+ * @n_culled_actors: the number of actors that were not painted in the
+ *   last frame because they were outside the redrawn area or occluded
+ * @n_queued_redraws: the number of redraws queued for the last frame
+ * @clipped_redraw: whether the last frame only redrew the parts of the
+ *   stage that changed, instead of the whole stage
+ * @n_offscreen_effects: the number of effects holding an offscreen
+ *   buffer
+ * @offscreen_memory: the size of the offscreen buffers held by the
+ *   effects and by the pool of the stage, in bytes
+ * @n_textures: the number of distinct textures of the #ClutterTexture
+ *   actors
+ * @texture_memory: the size of the textures of the #ClutterTexture
+ *   actors, in bytes
+ * @n_text_layouts: the number of layouts cached by the #ClutterText
+ *   actors
+ * @overdraw_factor: the number of pixels written in the last frame
+ *   divided by the number of pixels of the stage, if the
+ *   <literal>overdraw</literal> value of the
+ *   <envar>CLUTTER_PAINT</envar> environment variable is set; 0
+ *   otherwise
+ *
+ * A snapshot of the resources used by a #ClutterStage and of the work
+ * done in its last frame, as returned by clutter_stage_get_statistics().
+ *
+ * The sizes are estimates, which assume that each pixel takes 4 bytes.
+ *
+ * Since: 1.8
+ */
+struct _ClutterStageStatistics
+{
+  guint n_actors;
+  guint n_mapped_actors;
+  guint n_visible_actors;
+
+  guint n_painted_actors;
+  guint n_culled_actors;
+  guint n_queued_redraws;
+  gboolean clipped_redraw;
+
+  guint n_offscreen_effects;
+  gsize offscreen_memory;
+
+  guint n_textures;
+  gsize texture_memory;
+
+  guint n_text_layouts;
+
+  gdouble overdraw_factor;
+};
+
+/**
+ * ClutterStageRedrawCause:
+ * @actor_type: the name of the type of the actor
+ * @actor_name: the name of the actor, or %NULL
+ * @cause: the name of the function that queued the redraw or the
+ *   relayout, or its address if the name is not known
+ * @n_redraws: the number of redraws queued
+ * @n_relayouts: the number of relayouts queued
+ *
+ * The redraws and the relayouts queued by a function on an actor
+ * before a frame, as returned by clutter_stage_get_redraw_causes().
+ *
+ * The function is usually the setter of the property that changed,
+ * like clutter_actor_set_opacity(), or the application code calling
+ * clutter_actor_queue_redraw() directly.
+ *
+ * All the strings are interned.
+ *
+ * Since: 1.8
+ */
+struct _ClutterStageRedrawCause
+{
+  const gchar *actor_type;
+  const gchar *actor_name;
+  const gchar *cause;
+
+  guint n_redraws;
+  guint n_relayouts;
+};
+
+/**
+ * ClutterStagePickFunc:
+ * @stage: the #ClutterStage that was picked
+ * @actor: (transfer none): the actor at the requested coordinates, or
+ *   %NULL if it was destroyed before the result became available
+ * @user_data: data passed to clutter_stage_get_actor_at_pos_async()
+ *
+ * A function called when the result of an asynchronous pick, started
+ * using clutter_stage_get_actor_at_pos_async(), is available.
+ *
+ * Since: 1.8
+ */
+typedef void (* ClutterStagePickFunc) (ClutterStage *stage,
+                                       ClutterActor *actor,
+                                       gpointer      user_data);
+
+/**
+ * ClutterStageCaptureFunc:
+ * @stage: the #ClutterStage that was captured
+ * @area: the captured area, in window coordinates
+ * @data: the first pixel of the top row of @area, in RGBA 8bit format
+ * @rowstride: the distance in bytes between the start of a row and the
+ *   start of the row below it; it can be negative
+ * @user_data: data passed to clutter_stage_read_pixels_async()
+ *
+ * A function called when the pixels captured by
+ * clutter_stage_read_pixels_async() are available.
+ *
+ * The pixels are only valid until the function returns, and should
+ * be copied if they are needed afterwards.
+ *
+ * Since: 1.8
+ */
+typedef void (* ClutterStageCaptureFunc) (ClutterStage          *stage,
+                                          const ClutterGeometry *area,
+                                          const guchar          *data,
+                                          gint                   rowstride,
+                                          gpointer               user_data);
+
 GType         clutter_perspective_get_type    (void) G_GNUC_CONST;
 GType         clutter_fog_get_type            (void) G_GNUC_CONST;
 GType         clutter_stage_get_type          (void) G_GNUC_CONST;
@@ -262,6 +436,46 @@ void                  clutter_stage_set_accept_focus  (ClutterStage *stage,
                                                        gboolean      accept_focus);
 gboolean              clutter_stage_get_accept_focus  (ClutterStage *stage);
 
+void                  clutter_stage_set_geometric_picking (ClutterStage *stage,
+                                                           gboolean      enabled);
+gboolean              clutter_stage_get_geometric_picking (ClutterStage *stage);
+
+void                  clutter_stage_set_depth_sorting (ClutterStage *stage,
+                                                       gboolean      enabled);
+gboolean              clutter_stage_get_depth_sorting (ClutterStage *stage);
+
+void                  clutter_stage_get_actor_at_pos_async (ClutterStage         *stage,
+                                                            ClutterPickMode       pick_mode,
+                                                            gint                  x,
+                                                            gint                  y,
+                                                            ClutterStagePickFunc  func,
+                                                            gpointer              user_data,
+                                                            GDestroyNotify        notify);
+void                  clutter_stage_read_pixels_async      (ClutterStage            *stage,
+                                                            gint                     x,
+                                                            gint                     y,
+                                                            gint                     width,
+                                                            gint                     height,
+                                                            gboolean                 damage_only,
+                                                            ClutterStageCaptureFunc  func,
+                                                            gpointer                 user_data,
+                                                            GDestroyNotify           notify);
+
+gint64                clutter_stage_get_presentation_time (ClutterStage *stage);
+
+guint                 clutter_stage_get_frame_timings (ClutterStage             *stage,
+                                                       ClutterStageFrameTimings *timings,
+                                                       guint                     n_timings);
+void                  clutter_stage_get_statistics    (ClutterStage             *stage,
+                                                       ClutterStageStatistics   *stats);
+
+void                  clutter_stage_set_track_redraw_causes (ClutterStage *stage,
+                                                             gboolean      track);
+gboolean              clutter_stage_get_track_redraw_causes (ClutterStage *stage);
+G_CONST_RETURN ClutterStageRedrawCause *
+                      clutter_stage_get_redraw_causes       (ClutterStage *stage,
+                                                             guint        *n_causes);
+
 /* Commodity macro, for mallum only */
 #define clutter_stage_add(stage,actor)                  G_STMT_START {  \
   if (CLUTTER_IS_STAGE ((stage)) && CLUTTER_IS_ACTOR ((actor)))         \
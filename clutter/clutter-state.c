@@ -184,7 +184,9 @@
 #include <gobject/gvaluecollector.h>
 #include <string.h>
 
+#include "clutter-actor-private.h"
 #include "clutter-alpha.h"
+#include "clutter-animatable-private.h"
 #include "clutter-animator.h"
 #include "clutter-enum-types.h"
 #include "clutter-interval.h"
@@ -225,6 +227,10 @@ struct _ClutterStatePrivate
   State           *target_state;      /* target state name */
   ClutterAnimator *current_animator;  /* !NULL if the current transition is
                                          overriden by an animator */
+  GArray          *transition;        /* the keys of the current transition,
+                                         compiled into TransitionKey
+                                         records */
+  guint            transition_valid : 1;
 };
 
 #define SLAVE_TIMELINE_LENGTH 10000
@@ -260,6 +266,16 @@ typedef struct _ClutterStateKey
   gint             ref_count;    /* reference count for boxed life time */
 } _ClutterStateKey;
 
+/* a key of the current transition, with its delays resolved */
+typedef struct _TransitionKey
+{
+  ClutterStateKey *key;
+  gdouble          start;        /* fraction of duration before starting */
+  gdouble          length;       /* fraction of duration to be done in */
+  GParamSpec      *pspec;        /* the property, if the object is
+                                    animatable */
+} TransitionKey;
+
 enum
 {
   PROP_0,
@@ -442,6 +458,7 @@ again_for_target_state:
                 {
                   /* Remove matching key */
                   target_state->keys = g_list_remove (target_state->keys, key);
+                  this->priv->transition_valid = FALSE;
                   key->is_inert = is_inert;
                   clutter_state_key_free (key);
 
@@ -518,6 +535,8 @@ clutter_state_finalize (GObject *object)
   g_object_unref (priv->timeline);
   g_object_unref (priv->slave_timeline);
 
+  g_array_free (priv->transition, TRUE);
+
   G_OBJECT_CLASS (clutter_state_parent_class)->finalize (object);
 }
 
@@ -536,27 +555,24 @@ clutter_state_completed (ClutterTimeline *timeline,
   g_signal_emit (state, state_signals[COMPLETED], 0);
 }
 
+/* resolves the keys that apply to the transition between the current
+ * source and target states, so that they do not have to be looked up
+ * on every frame
+ */
 static void
-clutter_state_new_frame (ClutterTimeline *timeline,
-                         gint             msecs,
-                         ClutterState    *state)
+clutter_state_compile_transition (ClutterState *state)
 {
   ClutterStatePrivate *priv = state->priv;
   GList *k;
-  gdouble progress;
   const gchar *curprop = NULL;
   GObject *curobj = NULL;
   gboolean found_specific = FALSE;
 
-  if (priv->current_animator)
-    return;
-
-  progress = clutter_timeline_get_progress (timeline);
+  g_array_set_size (priv->transition, 0);
 
   for (k = priv->target_state->keys; k; k = k->next)
     {
       ClutterStateKey *key = k->data;
-      gdouble sub_progress;
 
       if ((curprop && !(curprop == key->property_name)) ||
           key->object != curobj)
@@ -576,34 +592,121 @@ clutter_state_new_frame (ClutterTimeline *timeline,
               found_specific = TRUE;
             }
 
+          /* XXX: should the target value of the default destination be
+           * used even when found a specific source_state key?
+           */
           if (found_specific || key->source_state == NULL)
             {
-              const GValue *value;
-              gdouble pre_delay = key->pre_delay + key->pre_pre_delay;
+              TransitionKey tkey;
 
-              sub_progress = (progress - pre_delay) /
-                             (1.0 - (pre_delay + key->post_delay));
+              tkey.key = key;
+              tkey.start = key->pre_delay + key->pre_pre_delay;
+              tkey.length = 1.0 - (tkey.start + key->post_delay);
 
-              if (sub_progress >= 0.0)
-                {
-                  if (sub_progress >= 1.0)
-                    sub_progress = 1.0;
+              if (CLUTTER_IS_ANIMATABLE (key->object))
+                tkey.pspec =
+                  clutter_animatable_find_property (CLUTTER_ANIMATABLE (key->object),
+                                                    key->property_name);
+              else
+                tkey.pspec = NULL;
 
-                  clutter_timeline_advance (priv->slave_timeline,
-                                            sub_progress * SLAVE_TIMELINE_LENGTH);
-                  sub_progress = clutter_alpha_get_alpha (key->alpha);
+              g_array_append_val (priv->transition, tkey);
+            }
+        }
+    }
 
-                  value = clutter_interval_compute (key->interval, sub_progress);
-                  if (value != NULL)
-                    g_object_set_property (key->object, key->property_name, value);
-                }
+  priv->transition_valid = TRUE;
+}
 
-              /* XXX: should the target value of the default destination be
-               * used even when found a specific source_state key?
-               */
-            }
+static void
+clutter_state_new_frame (ClutterTimeline *timeline,
+                         gint             msecs,
+                         ClutterState    *state)
+{
+  ClutterStatePrivate *priv = state->priv;
+  ClutterActor *curactor = NULL;
+  GObject *curobj = NULL;
+  gdouble progress;
+  guint i;
+
+  if (priv->current_animator)
+    return;
+
+  if (!priv->transition_valid)
+    clutter_state_compile_transition (state);
+
+  progress = clutter_timeline_get_progress (timeline);
+
+  for (i = 0; i < priv->transition->len; i++)
+    {
+      const TransitionKey *tkey;
+      ClutterStateKey *key;
+      const GValue *value;
+      gdouble sub_progress;
+
+      /* setting a property might have changed the keys, in which
+       * case the transition will be compiled again on the next frame
+       */
+      if (!priv->transition_valid)
+        break;
+
+      tkey = &g_array_index (priv->transition, TransitionKey, i);
+      key = tkey->key;
+
+      /* the keys of an object are contiguous, so all the properties
+       * of an actor can be updated at once
+       */
+      if (key->object != curobj)
+        {
+          if (curactor != NULL)
+            _clutter_actor_end_update (curactor);
+
+          curobj = key->object;
+          curactor = CLUTTER_IS_ACTOR (curobj) ? CLUTTER_ACTOR (curobj) : NULL;
+
+          if (curactor != NULL)
+            _clutter_actor_begin_update (curactor);
+        }
+
+      sub_progress = (progress - tkey->start) / tkey->length;
+      if (sub_progress < 0.0)
+        continue;
+
+      if (sub_progress >= 1.0)
+        sub_progress = 1.0;
+
+      /* the built-in modes do not need to go through the slave
+       * timeline to compute the alpha value
+       */
+      if (key->mode > CLUTTER_CUSTOM_MODE &&
+          key->mode < CLUTTER_ANIMATION_LAST)
+        clutter_alpha_compute_mode_values (key->mode,
+                                           &sub_progress, &sub_progress,
+                                           1);
+      else
+        {
+          clutter_timeline_advance (priv->slave_timeline,
+                                    sub_progress * SLAVE_TIMELINE_LENGTH);
+          sub_progress = clutter_alpha_get_alpha (key->alpha);
         }
+
+      /* numeric properties of animatable objects are set without
+       * boxing the value inside a GValue
+       */
+      if (tkey->pspec != NULL &&
+          _clutter_animatable_animate_unboxed (CLUTTER_ANIMATABLE (curobj),
+                                               tkey->pspec,
+                                               key->interval,
+                                               sub_progress))
+        continue;
+
+      value = clutter_interval_compute (key->interval, sub_progress);
+      if (value != NULL)
+        g_object_set_property (key->object, key->property_name, value);
     }
+
+  if (curactor != NULL)
+    _clutter_actor_end_update (curactor);
 }
 
 
@@ -666,6 +769,7 @@ clutter_state_change (ClutterState *state,
 
   priv->source_state_name = priv->target_state_name;
   priv->target_state_name = target_state_name;
+  priv->transition_valid = FALSE;
 
   g_object_notify_by_pspec (G_OBJECT (state), obj_props[PROP_STATE]);
 
@@ -1017,6 +1121,7 @@ clutter_state_set_key_internal (ClutterState    *state,
   target_state->keys = g_list_insert_sorted (target_state->keys,
                                              key,
                                              sort_props_func);
+  priv->transition_valid = FALSE;
 
   /* If the current target state is modified, we have some work to do.
    *
@@ -1452,6 +1557,8 @@ clutter_state_init (ClutterState *self)
                     self);
 
   priv->slave_timeline = clutter_timeline_new (SLAVE_TIMELINE_LENGTH);
+
+  priv->transition = g_array_new (FALSE, FALSE, sizeof (TransitionKey));
 }
 
 
@@ -2061,8 +2168,8 @@ parse_state_transition (JsonArray *array,
         }
 
       property = json_array_get_string_element (key, 1);
-      pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (gobject),
-                                            property);
+      pspec = _clutter_script_find_property (G_OBJECT_TYPE (gobject),
+                                             property);
       if (pspec == NULL)
         {
           g_warning ("The object of type '%s' and name '%s' has no "
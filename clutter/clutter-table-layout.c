@@ -78,6 +78,7 @@
 
 #include "clutter-table-layout.h"
 
+#include "clutter-actor-private.h"
 #include "clutter-debug.h"
 #include "clutter-enum-types.h"
 #include "clutter-layout-meta.h"
@@ -120,11 +121,31 @@ struct _ClutterTableLayoutPrivate
   GArray *columns;
   GArray *rows;
 
+  /* the sizes the columns and rows were last distributed for */
+  gfloat columns_for_width;
+  gfloat rows_for_height;
+
   gulong easing_mode;
   guint easing_duration;
 
+  /* the timeline of the current animation */
+  ClutterTimeline *animation_timeline;
+
   guint is_animating   : 1;
   guint use_animations : 1;
+
+  /* the cached solution of the table; the requisition of the columns
+   * does not depend on the allocation, whereas the requisition of the
+   * rows depends on the final width of the columns. both are thrown
+   * away by table_layout_invalidate()
+   */
+  guint table_size_valid    : 1;
+  guint columns_valid       : 1;
+  guint columns_distributed : 1;
+  guint columns_uniform     : 1;
+  guint rows_valid          : 1;
+  guint rows_distributed    : 1;
+  guint rows_uniform        : 1;
 };
 
 struct _ClutterTableChild
@@ -137,6 +158,11 @@ struct _ClutterTableChild
    */
   ClutterActorBox last_allocation;
 
+  /* the distance from the final position of the child to the one
+   * it had when the animation started */
+  gfloat animation_offset_x;
+  gfloat animation_offset_y;
+
   gint col;
   gint row;
 
@@ -188,6 +214,16 @@ G_DEFINE_TYPE (ClutterTableLayout,
                clutter_table_layout,
                CLUTTER_TYPE_LAYOUT_MANAGER);
 
+static void
+table_layout_invalidate (ClutterTableLayout *self)
+{
+  ClutterTableLayoutPrivate *priv = self->priv;
+
+  priv->table_size_valid = FALSE;
+  priv->columns_valid = FALSE;
+  priv->rows_valid = FALSE;
+}
+
 /*
  * ClutterBoxChild
  */
@@ -221,6 +257,8 @@ table_child_set_position (ClutterTableChild *self,
       layout = clutter_layout_meta_get_manager (CLUTTER_LAYOUT_META (self));
       priv = CLUTTER_TABLE_LAYOUT (layout)->priv;
 
+      table_layout_invalidate (CLUTTER_TABLE_LAYOUT (layout));
+
       g_object_freeze_notify (G_OBJECT (self));
 
       if (priv->use_animations)
@@ -271,6 +309,8 @@ table_child_set_span (ClutterTableChild  *self,
       layout = clutter_layout_meta_get_manager (CLUTTER_LAYOUT_META (self));
       table = CLUTTER_TABLE_LAYOUT (layout);
 
+      table_layout_invalidate (table);
+
       if (table->priv->use_animations)
         {
           clutter_layout_manager_begin_animation (layout,
@@ -419,6 +459,8 @@ table_child_set_expand (ClutterTableChild *self,
       layout = clutter_layout_meta_get_manager (CLUTTER_LAYOUT_META (self));
       priv = CLUTTER_TABLE_LAYOUT (layout)->priv;
 
+      table_layout_invalidate (CLUTTER_TABLE_LAYOUT (layout));
+
       g_object_freeze_notify (G_OBJECT (self));
 
       if (priv->use_animations)
@@ -696,13 +738,108 @@ clutter_table_layout_get_child_meta_type (ClutterLayoutManager *manager)
   return CLUTTER_TYPE_TABLE_CHILD;
 }
 
+/* the requisition of the children is cached, so we need to know
+ * when any of them changes; children queue a relayout on themselves
+ * when their preferred size changes, but they queue it on the parent
+ * when shown or hidden
+ */
+static void
+table_layout_child_changed (ClutterActor       *child,
+                            ClutterTableLayout *self)
+{
+  table_layout_invalidate (self);
+}
+
+static void
+table_layout_child_visible_notify (ClutterActor       *child,
+                                   GParamSpec         *pspec,
+                                   ClutterTableLayout *self)
+{
+  table_layout_invalidate (self);
+}
+
+static void
+table_layout_track_child (ClutterTableLayout *self,
+                          ClutterActor       *child)
+{
+  g_signal_connect (child, "queue-relayout",
+                    G_CALLBACK (table_layout_child_changed),
+                    self);
+  g_signal_connect (child, "notify::visible",
+                    G_CALLBACK (table_layout_child_visible_notify),
+                    self);
+}
+
+static void
+table_layout_untrack_child (ClutterTableLayout *self,
+                            ClutterActor       *child)
+{
+  g_signal_handlers_disconnect_by_func (child,
+                                        table_layout_child_changed,
+                                        self);
+  g_signal_handlers_disconnect_by_func (child,
+                                        table_layout_child_visible_notify,
+                                        self);
+}
+
+static void
+table_layout_actor_added (ClutterContainer   *container,
+                          ClutterActor       *child,
+                          ClutterTableLayout *self)
+{
+  table_layout_track_child (self, child);
+  table_layout_invalidate (self);
+}
+
+static void
+table_layout_actor_removed (ClutterContainer   *container,
+                            ClutterActor       *child,
+                            ClutterTableLayout *self)
+{
+  table_layout_untrack_child (self, child);
+  table_layout_invalidate (self);
+}
+
 static void
 clutter_table_layout_set_container (ClutterLayoutManager *layout,
                                     ClutterContainer     *container)
 {
-  ClutterTableLayoutPrivate *priv = CLUTTER_TABLE_LAYOUT (layout)->priv;
+  ClutterTableLayout *self = CLUTTER_TABLE_LAYOUT (layout);
+  ClutterTableLayoutPrivate *priv = self->priv;
+  ClutterContainerIter iter;
+  ClutterActor *child;
+
+  if (priv->container != NULL)
+    {
+      clutter_container_iter_init (&iter, priv->container);
+      while (clutter_container_iter_next (&iter, &child))
+        table_layout_untrack_child (self, child);
+
+      g_signal_handlers_disconnect_by_func (priv->container,
+                                            table_layout_actor_added,
+                                            self);
+      g_signal_handlers_disconnect_by_func (priv->container,
+                                            table_layout_actor_removed,
+                                            self);
+    }
 
   priv->container = container;
+
+  if (priv->container != NULL)
+    {
+      clutter_container_iter_init (&iter, priv->container);
+      while (clutter_container_iter_next (&iter, &child))
+        table_layout_track_child (self, child);
+
+      g_signal_connect (priv->container, "actor-added",
+                        G_CALLBACK (table_layout_actor_added),
+                        self);
+      g_signal_connect (priv->container, "actor-removed",
+                        G_CALLBACK (table_layout_actor_removed),
+                        self);
+    }
+
+  table_layout_invalidate (self);
 }
 
 
@@ -712,40 +849,262 @@ update_row_col (ClutterTableLayout *layout,
 {
   ClutterTableLayoutPrivate *priv = layout->priv;
   ClutterLayoutManager *manager = CLUTTER_LAYOUT_MANAGER (layout);
-  GList *children, *l;
+  ClutterContainerIter iter;
+  ClutterActor *child;
   gint n_cols, n_rows;
 
+  if (priv->table_size_valid)
+    return;
+
   n_cols = n_rows = 0;
-  children = container ? clutter_container_get_children (container) : NULL;
 
-  for (l = children; l; l = g_list_next (l))
+  if (container != NULL)
     {
-      ClutterActor *child = l->data;
-      ClutterTableChild *meta;
+      clutter_container_iter_init (&iter, container);
+      while (clutter_container_iter_next (&iter, &child))
+        {
+          ClutterTableChild *meta;
 
-      meta = CLUTTER_TABLE_CHILD (clutter_layout_manager_get_child_meta (manager, container, child));
+          meta = CLUTTER_TABLE_CHILD (clutter_layout_manager_get_child_meta (manager, container, child));
 
-      n_cols = MAX (n_cols, meta->col + meta->col_span);
-      n_rows = MAX (n_rows, meta->row + meta->row_span);
+          n_cols = MAX (n_cols, meta->col + meta->col_span);
+          n_rows = MAX (n_rows, meta->row + meta->row_span);
+        }
     }
 
-  g_list_free (children);
-
   priv->n_cols = n_cols;
   priv->n_rows = n_rows;
 
+  /* there is nothing to cache without a container */
+  priv->table_size_valid = container != NULL;
+}
+
+/* the number of one pixel steps a dimension can be shrunk by before
+ * reaching its minimum size
+ */
+static inline gint
+dimension_get_slack (const DimensionData *dim)
+{
+  gfloat slack = dim->pref_size - dim->min_size;
+
+  return slack > 0 ? (gint) ceilf (slack) : 0;
+}
+
+static gfloat
+count_shrink_steps (const DimensionData *dims,
+                    gint                 start,
+                    gint                 end,
+                    gint                 n_passes)
+{
+  gfloat steps = 0;
+  gint i;
+
+  for (i = start; i <= end; i++)
+    steps += MIN (n_passes, dimension_get_slack (&dims[i]));
+
+  return steps;
 }
 
+/*
+ * shrink_dimensions:
+ * @dims: the dimensions to shrink
+ * @start: the first dimension to shrink
+ * @end: the last dimension to shrink
+ * @excess: the amount of pixels to take off
+ * @uniform: whether all the dimensions have the same size
+ *
+ * Sets the final size of the dimensions between @start and @end to
+ * their preferred size, shrunk by at least @excess pixels overall.
+ *
+ * The result is the same as taking one pixel off each dimension still
+ * larger than its minimum size, in turn, until enough pixels have been
+ * taken off; instead of looping a pixel at a time we look for the number
+ * of passes such a loop would need, which for uniform dimensions is a
+ * simple division.
+ */
 static void
-calculate_col_widths (ClutterTableLayout *self,
-                      ClutterContainer   *container,
-                      gint                for_width)
+shrink_dimensions (DimensionData *dims,
+                   gint           start,
+                   gint           end,
+                   gfloat         excess,
+                   gboolean       uniform)
+{
+  gint i, n_passes, max_passes;
+
+  max_passes = 0;
+  for (i = start; i <= end; i++)
+    {
+      dims[i].final_size = dims[i].pref_size;
+      max_passes = MAX (max_passes, dimension_get_slack (&dims[i]));
+    }
+
+  if (max_passes == 0)
+    return;
+
+  if (uniform)
+    n_passes = MIN (max_passes, (gint) ceilf (excess / (end - start + 1)));
+  else
+    {
+      gint low = 1;
+
+      /* the amount of pixels taken off grows with the number of passes,
+       * so we can look for the smallest number that takes off enough
+       */
+      n_passes = max_passes;
+      while (low < n_passes)
+        {
+          gint mid = low + (n_passes - low) / 2;
+
+          if (count_shrink_steps (dims, start, end, mid) >= excess)
+            n_passes = mid;
+          else
+            low = mid + 1;
+        }
+    }
+
+  for (i = start; i <= end; i++)
+    dims[i].final_size -= MIN (n_passes, dimension_get_slack (&dims[i]));
+}
+
+static gboolean
+dimensions_are_uniform (const DimensionData *dims,
+                        gint                 n_dims)
+{
+  gint i;
+
+  for (i = 1; i < n_dims; i++)
+    {
+      if (dims[i].min_size != dims[0].min_size ||
+          dims[i].pref_size != dims[0].pref_size ||
+          dims[i].expand != dims[0].expand)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/*
+ * distribute_dimensions:
+ * @dims: the columns or rows of the table
+ * @n_dims: the number of columns or rows
+ * @spacing: the spacing between columns or rows
+ * @for_size: the available size, or a negative value
+ * @uniform: whether all the dimensions have the same size
+ *
+ * Computes the final size of each dimension from its requisition
+ */
+static void
+distribute_dimensions (DimensionData *dims,
+                       gint           n_dims,
+                       guint          spacing,
+                       gfloat         for_size,
+                       gboolean       uniform)
+{
+  gfloat min_size, pref_size;
+  gint n_expand;
+  gint i;
+
+  /* without a size to fit in, just use the preferred size */
+  if (for_size < 0)
+    {
+      for (i = 0; i < n_dims; i++)
+        dims[i].final_size = dims[i].pref_size;
+
+      return;
+    }
+
+  min_size = 0;
+  pref_size = 0;
+  n_expand = 0;
+  for (i = 0; i < n_dims; i++)
+    {
+      pref_size += dims[i].pref_size;
+      min_size += dims[i].min_size;
+      if (dims[i].expand)
+        n_expand++;
+    }
+  pref_size += spacing * (n_dims - 1);
+  min_size += spacing * (n_dims - 1);
+
+  if (for_size <= min_size)
+    {
+      /* erk, we can't shrink this! */
+      for (i = 0; i < n_dims; i++)
+        dims[i].final_size = dims[i].min_size;
+
+      return;
+    }
+
+  if (for_size == pref_size)
+    {
+      /* perfect! */
+      for (i = 0; i < n_dims; i++)
+        dims[i].final_size = dims[i].pref_size;
+
+      return;
+    }
+
+  /* for_size is between min_size and pref_size */
+  if (for_size < pref_size && for_size > min_size)
+    {
+      /* shrink the dimensions from their preferred size until they
+       * fit, or until they reach their minimum size
+       */
+      shrink_dimensions (dims, 0, n_dims - 1, pref_size - for_size, uniform);
+
+      return;
+    }
+
+  /* expand dimensions */
+  if (for_size > pref_size)
+    {
+      gfloat extra_size = for_size - pref_size;
+      gint remaining;
+
+      if (n_expand)
+        remaining = (gint) extra_size % n_expand;
+      else
+        remaining = (gint) extra_size % n_dims;
+
+      for (i = 0; i < n_dims; i++)
+        {
+          if (dims[i].expand)
+            {
+              if (n_expand)
+                dims[i].final_size = dims[i].pref_size
+                                   + (extra_size / n_expand);
+              else
+                dims[i].final_size = dims[i].pref_size
+                                   + (extra_size / n_dims);
+            }
+          else
+            dims[i].final_size = dims[i].pref_size;
+        }
+
+      /* distribute the remainder among children */
+      i = 0;
+      while (remaining)
+        {
+          dims[i].final_size++;
+          i++;
+          remaining--;
+        }
+    }
+}
+
+static void
+ensure_col_requisition (ClutterTableLayout *self,
+                        ClutterContainer   *container)
 {
   ClutterTableLayoutPrivate *priv = self->priv;
   ClutterLayoutManager *manager = CLUTTER_LAYOUT_MANAGER (self);
   gint i;
   DimensionData *columns;
-  GList *l, *children;
+  ClutterContainerIter iter;
+  ClutterActor *child;
+
+  if (priv->columns_valid)
+    return;
 
   update_row_col (self, container);
   g_array_set_size (priv->columns, 0);
@@ -757,12 +1116,10 @@ calculate_col_widths (ClutterTableLayout *self,
   for (i = 0; i < priv->n_cols; i++)
     columns[i].visible = FALSE;
 
-  children = clutter_container_get_children (container);
-
   /* STAGE ONE: calculate column widths for non-spanned children */
-  for (l = children; l; l = g_list_next (l))
+  clutter_container_iter_init (&iter, container);
+  while (clutter_container_iter_next (&iter, &child))
     {
-      ClutterActor *child = l->data;
       ClutterTableChild *meta;
       DimensionData *col;
       gfloat c_min, c_pref;
@@ -792,9 +1149,9 @@ calculate_col_widths (ClutterTableLayout *self,
     }
 
   /* STAGE TWO: take spanning children into account */
-  for (l = children; l; l = g_list_next (l))
+  clutter_container_iter_init (&iter, container);
+  while (clutter_container_iter_next (&iter, &child))
     {
-      ClutterActor *child = l->data;
       ClutterTableChild *meta;
       DimensionData *col;
       gfloat c_min, c_pref;
@@ -838,7 +1195,7 @@ calculate_col_widths (ClutterTableLayout *self,
       min_width += priv->col_spacing * (meta->col_span - 1);
       pref_width += priv->col_spacing * (meta->col_span - 1);
 
-      /* see calculate_row_heights() for comments */
+      /* see ensure_row_requisition() for comments */
       /* (1) */
       if (c_min > min_width)
         {
@@ -847,20 +1204,9 @@ calculate_col_widths (ClutterTableLayout *self,
           /* we can start from preferred width and decrease */
           if (pref_width > c_min)
             {
-              for (i = start_col; i <= end_col; i++)
-                columns[i].final_size = columns[i].pref_size;
-
-              while (pref_width > c_min)
-                {
-                  for (i = start_col; i <= end_col; i++)
-                    {
-                      if (columns[i].final_size > columns[i].min_size)
-                        {
-                          columns[i].final_size--;
-                          pref_width--;
-                        }
-                    }
-                }
+              shrink_dimensions (columns, start_col, end_col,
+                                 pref_width - c_min,
+                                 FALSE);
 
               for (i = start_col; i <= end_col; i++)
                 columns[i].min_size = columns[i].final_size;
@@ -890,123 +1236,52 @@ calculate_col_widths (ClutterTableLayout *self,
 
 
     }
-  g_list_free (children);
-
-  /* calculate final widths */
-  if (for_width >= 0)
-    {
-      gfloat min_width, pref_width;
-      gint n_expand;
-
-      min_width = 0;
-      pref_width = 0;
-      n_expand = 0;
-      for (i = 0; i < self->priv->n_cols; i++)
-        {
-          pref_width += columns[i].pref_size;
-          min_width += columns[i].min_size;
-          if (columns[i].expand)
-            n_expand++;
-        }
-      pref_width += priv->col_spacing * (priv->n_cols - 1);
-      min_width += priv->col_spacing * (priv->n_cols - 1);
 
-      if (for_width <= min_width)
-        {
-          /* erk, we can't shrink this! */
-          for (i = 0; i < priv->n_cols; i++)
-            columns[i].final_size = columns[i].min_size;
-
-          return;
-        }
-
-      if (for_width == pref_width)
-        {
-          /* perfect! */
-          for (i = 0; i < self->priv->n_cols; i++)
-            columns[i].final_size = columns[i].pref_size;
-
-          return;
-        }
-
-      /* for_width is between min_width and pref_width */
-      if (for_width < pref_width && for_width > min_width)
-        {
-          gfloat width;
-
-          /* shrink columns until they reach min_width */
-
-          /* start with all columns at preferred size */
-          for (i = 0; i < self->priv->n_cols; i++)
-            columns[i].final_size = columns[i].pref_size;
-
-          width = pref_width;
-
-          while (width > for_width)
-            {
-              for (i = 0; i < self->priv->n_cols; i++)
-                {
-                  if (columns[i].final_size > columns[i].min_size)
-                    {
-                      columns[i].final_size--;
-                      width--;
-                    }
-                }
-            }
+  priv->columns_uniform = dimensions_are_uniform (columns, priv->n_cols);
+  priv->columns_valid = TRUE;
+  priv->columns_distributed = FALSE;
+}
 
-          return;
-        }
+static void
+calculate_col_widths (ClutterTableLayout *self,
+                      ClutterContainer   *container,
+                      gint                for_width)
+{
+  ClutterTableLayoutPrivate *priv = self->priv;
 
-      /* expand columns */
-      if (for_width > pref_width)
-        {
-          gfloat extra_width = for_width - pref_width;
-          gint remaining;
+  ensure_col_requisition (self, container);
 
-          if (n_expand)
-            remaining = (gint) extra_width % n_expand;
-          else
-            remaining = (gint) extra_width % priv->n_cols;
+  /* the requisition did not change, and neither did the width */
+  if (priv->columns_distributed && priv->columns_for_width == for_width)
+    return;
 
-          for (i = 0; i < self->priv->n_cols; i++)
-            {
-              if (columns[i].expand)
-                {
-                  if (n_expand)
-                    columns[i].final_size = columns[i].pref_size
-                                          + (extra_width / n_expand);
-                  else
-                    columns[i].final_size = columns[i].pref_size
-                                          + (extra_width / priv->n_cols);
-                }
-              else
-                columns[i].final_size = columns[i].pref_size;
-            }
+  distribute_dimensions ((DimensionData *) priv->columns->data,
+                         priv->n_cols,
+                         priv->col_spacing,
+                         for_width,
+                         priv->columns_uniform);
 
-          /* distribute the remainder among children */
-          i = 0;
-          while (remaining)
-            {
-              columns[i].final_size++;
-              i++;
-              remaining--;
-            }
-        }
-    }
+  priv->columns_for_width = for_width;
+  priv->columns_distributed = TRUE;
 
+  /* the rows were measured using the previous column widths */
+  priv->rows_valid = FALSE;
 }
 
 static void
-calculate_row_heights (ClutterTableLayout *self,
-                       ClutterContainer   *container,
-                       gint                for_height)
+ensure_row_requisition (ClutterTableLayout *self,
+                        ClutterContainer   *container)
 {
   ClutterTableLayoutPrivate *priv = self->priv;
   ClutterLayoutManager *manager = CLUTTER_LAYOUT_MANAGER (self);
-  GList *l, *children;
+  ClutterContainerIter iter;
+  ClutterActor *child;
   gint i;
   DimensionData *rows, *columns;
 
+  if (priv->rows_valid)
+    return;
+
   update_row_col (self, container);
   g_array_set_size (priv->rows, 0);
   g_array_set_size (priv->rows, self->priv->n_rows);
@@ -1019,11 +1294,10 @@ calculate_row_heights (ClutterTableLayout *self,
   for (i = 0; i < priv->n_rows; i++)
     rows[i].visible = FALSE;
 
-  children = clutter_container_get_children (container);
   /* STAGE ONE: calculate row heights for non-spanned children */
-  for (l = children; l; l = g_list_next (l))
+  clutter_container_iter_init (&iter, container);
+  while (clutter_container_iter_next (&iter, &child))
     {
-      ClutterActor *child = l->data;
       ClutterTableChild *meta;
       DimensionData *row;
       gfloat c_min, c_pref;
@@ -1056,9 +1330,9 @@ calculate_row_heights (ClutterTableLayout *self,
 
 
   /* STAGE TWO: take spanning children into account */
-  for (l = children; l; l = g_list_next (l))
+  clutter_container_iter_init (&iter, container);
+  while (clutter_container_iter_next (&iter, &child))
     {
-      ClutterActor *child = l->data;
       ClutterTableChild *meta;
       gfloat c_min, c_pref;
       gfloat min_height, pref_height;
@@ -1124,20 +1398,9 @@ calculate_row_heights (ClutterTableLayout *self,
           /* we can start from preferred height and decrease */
           if (pref_height > c_min)
             {
-              for (i = start_row; i <= end_row; i++)
-                rows[i].final_size = rows[i].pref_size;
-
-              while (pref_height > c_min)
-                {
-                  for (i = start_row; i <= end_row; i++)
-                    {
-                      if (rows[i].final_size > rows[i].min_size)
-                        {
-                          rows[i].final_size--;
-                          pref_height--;
-                        }
-                    }
-                }
+              shrink_dimensions (rows, start_row, end_row,
+                                 pref_height - c_min,
+                                 FALSE);
 
               for (i = start_row; i <= end_row; i++)
                 rows[i].min_size = rows[i].final_size;
@@ -1165,110 +1428,31 @@ calculate_row_heights (ClutterTableLayout *self,
 
     }
 
-  g_list_free (children);
-
-  /* calculate final heights */
-  if (for_height >= 0)
-    {
-      gfloat min_height, pref_height;
-      gint n_expand;
-
-      min_height = 0;
-      pref_height = 0;
-      n_expand = 0;
-      for (i = 0; i < self->priv->n_rows; i++)
-        {
-          pref_height += rows[i].pref_size;
-          min_height += rows[i].min_size;
-          if (rows[i].expand)
-            n_expand++;
-        }
-      pref_height += priv->row_spacing * (priv->n_rows - 1);
-      min_height += priv->row_spacing * (priv->n_rows - 1);
-
-      if (for_height <= min_height)
-        {
-          /* erk, we can't shrink this! */
-          for (i = 0; i < self->priv->n_rows; i++)
-            rows[i].final_size = rows[i].min_size;
-
-          return;
-        }
-
-      if (for_height == pref_height)
-        {
-          /* perfect! */
-          for (i = 0; i < self->priv->n_rows; i++)
-            rows[i].final_size = rows[i].pref_size;
-
-          return;
-        }
-
-      /* for_height is between min_height and pref_height */
-      if (for_height < pref_height && for_height > min_height)
-        {
-          gfloat height;
-
-          /* shrink rows until they reach min_height */
-
-          /* start with all rows at preferred size */
-          for (i = 0; i < self->priv->n_rows; i++)
-            rows[i].final_size = rows[i].pref_size;
-
-          height = pref_height;
-
-          while (height > for_height)
-            {
-              for (i = 0; i < priv->n_rows; i++)
-                {
-                  if (rows[i].final_size > rows[i].min_size)
-                    {
-                      rows[i].final_size--;
-                      height--;
-                    }
-                }
-            }
-
-          return;
-        }
+  priv->rows_uniform = dimensions_are_uniform (rows, priv->n_rows);
+  priv->rows_valid = TRUE;
+  priv->rows_distributed = FALSE;
+}
 
-      /* expand rows */
-      if (for_height > pref_height)
-        {
-          gfloat extra_height = for_height - pref_height;
-          gint remaining;
+static void
+calculate_row_heights (ClutterTableLayout *self,
+                       ClutterContainer   *container,
+                       gint                for_height)
+{
+  ClutterTableLayoutPrivate *priv = self->priv;
 
-          if (n_expand)
-            remaining = (gint) extra_height % n_expand;
-          else
-            remaining = (gint) extra_height % self->priv->n_rows;
+  ensure_row_requisition (self, container);
 
-          for (i = 0; i < self->priv->n_rows; i++)
-            {
-              if (rows[i].expand)
-                {
-                  if (n_expand)
-                    rows[i].final_size = rows[i].pref_size
-                                       + (extra_height / n_expand);
-                  else
-                    rows[i].final_size = rows[i].pref_size
-                                       + (extra_height / priv->n_rows);
-                }
-              else
-                rows[i].final_size = rows[i].pref_size;
-            }
+  if (priv->rows_distributed && priv->rows_for_height == for_height)
+    return;
 
-          /* distribute the remainder among children */
-          i = 0;
-          while (remaining)
-            {
-              rows[i].final_size++;
-              i++;
-              remaining--;
-            }
-        }
-    }
+  distribute_dimensions ((DimensionData *) priv->rows->data,
+                         priv->n_rows,
+                         priv->row_spacing,
+                         for_height,
+                         priv->rows_uniform);
 
+  priv->rows_for_height = for_height;
+  priv->rows_distributed = TRUE;
 }
 
 static void
@@ -1302,7 +1486,8 @@ clutter_table_layout_get_preferred_width (ClutterLayoutManager *layout,
       return;
     }
 
-  calculate_table_dimensions (self, container, -1, for_height);
+  /* the requisition of the columns does not depend on the height */
+  ensure_col_requisition (self, container);
   columns = (DimensionData *) priv->columns->data;
 
   total_min_width = (priv->visible_cols - 1) * (float) priv->col_spacing;
@@ -1342,7 +1527,8 @@ clutter_table_layout_get_preferred_height (ClutterLayoutManager *layout,
       return;
     }
 
-  calculate_table_dimensions (self, container, for_width, -1);
+  calculate_col_widths (self, container, for_width);
+  ensure_row_requisition (self, container);
   rows = (DimensionData *) priv->rows->data;
 
   total_min_height = (priv->visible_rows - 1) * (float) priv->row_spacing;
@@ -1387,19 +1573,18 @@ clutter_table_layout_allocate (ClutterLayoutManager   *layout,
 {
   ClutterTableLayout *self = CLUTTER_TABLE_LAYOUT (layout);
   ClutterTableLayoutPrivate *priv = self->priv;
-  GList *list, *children;
+  ClutterContainerIter iter;
+  ClutterActor *child;
   gint row_spacing, col_spacing;
   gint i;
   DimensionData *rows, *columns;
+  gint *col_offsets, *row_offsets;
+  gint offset;
 
   update_row_col (self, container);
   if (priv->n_cols < 1 || priv->n_rows < 1)
     return;
 
-  children = clutter_container_get_children (container);
-  if (children == NULL)
-    return;
-
   col_spacing = (priv->col_spacing);
   row_spacing = (priv->row_spacing);
 
@@ -1408,9 +1593,34 @@ clutter_table_layout_allocate (ClutterLayoutManager   *layout,
   rows = (DimensionData *) priv->rows->data;
   columns = (DimensionData *) priv->columns->data;
 
-  for (list = children; list; list = g_list_next (list))
+  /* the origin of each column and row, skipping the invisible ones */
+  col_offsets = g_new (gint, priv->n_cols);
+  for (i = 0, offset = 0; i < priv->n_cols; i++)
+    {
+      col_offsets[i] = offset;
+
+      if (columns[i].visible)
+        {
+          offset += columns[i].final_size;
+          offset += col_spacing;
+        }
+    }
+
+  row_offsets = g_new (gint, priv->n_rows);
+  for (i = 0, offset = 0; i < priv->n_rows; i++)
+    {
+      row_offsets[i] = offset;
+
+      if (rows[i].visible)
+        {
+          offset += rows[i].final_size;
+          offset += row_spacing;
+        }
+    }
+
+  clutter_container_iter_init (&iter, container);
+  while (clutter_container_iter_next (&iter, &child))
     {
-      ClutterActor *child = list->data;
       gint row, col, row_span, col_span;
       gint col_width, row_height;
       ClutterTableChild *meta;
@@ -1471,27 +1681,8 @@ clutter_table_layout_allocate (ClutterLayoutManager   *layout,
             }
         }
 
-      /* calculate child x */
-      child_x = 0.0f;
-      for (i = 0; i < col; i++)
-        {
-          if (columns[i].visible)
-            {
-              child_x += columns[i].final_size;
-              child_x += col_spacing;
-            }
-        }
-
-      /* calculate child y */
-      child_y = 0.0f;
-      for (i = 0; i < row; i++)
-        {
-          if (rows[i].visible)
-            {
-              child_y += rows[i].final_size;
-              child_y += row_spacing;
-            }
-        }
+      child_x = col_offsets[col];
+      child_y = row_offsets[row];
 
       /* set up childbox */
       childbox.x1 = (float) child_x;
@@ -1512,8 +1703,7 @@ clutter_table_layout_allocate (ClutterLayoutManager   *layout,
 
       if (priv->use_animations && priv->is_animating)
         {
-          ClutterActorBox *start = NULL;
-          ClutterActorBox end = { 0, };
+          const ClutterActorBox *start;
           gdouble p;
 
           p = clutter_layout_manager_get_animation_progress (layout);
@@ -1526,40 +1716,72 @@ clutter_table_layout_allocate (ClutterLayoutManager   *layout,
                */
               meta->last_allocation = childbox;
               meta->has_last_allocation = TRUE;
-
-              goto do_allocate;
             }
 
+          /* the child keeps its final allocation for the whole
+           * animation, and it is moved from its initial position by
+           * an offset that table_layout_animation_new_frame() updates
+           * on every frame
+           */
           start = &meta->last_allocation;
-          end = childbox;
+          meta->animation_offset_x = start->x1 - childbox.x1;
+          meta->animation_offset_y = start->y1 - childbox.y1;
 
-          /* interpolate between the initial and final values */
-          clutter_actor_box_interpolate (start, &end, p, &childbox);
+          _clutter_actor_set_layout_offset (child,
+                                            meta->animation_offset_x * (1.0 - p),
+                                            meta->animation_offset_y * (1.0 - p));
 
           CLUTTER_NOTE (ANIMATION,
-                        "Animate { %.1f, %.1f, %.1f, %.1f }\t"
-                        "%.3f * { %.1f, %.1f, %.1f, %.1f }\t"
-                        "-> { %.1f, %.1f, %.1f, %.1f }",
+                        "Animate { %.1f, %.1f } -> { %.1f, %.1f }",
                         start->x1, start->y1,
-                        start->x2, start->y2,
-                        p,
-                        childbox.x1, childbox.y1,
-                        childbox.x2, childbox.y2,
-                        end.x1, end.y1,
-                        end.x2, end.y2);
+                        childbox.x1, childbox.y1);
         }
       else
         {
           /* store the allocation for later animations */
           meta->last_allocation = childbox;
           meta->has_last_allocation = TRUE;
-        }
 
-    do_allocate:
-      clutter_actor_allocate (child, &childbox, flags);
+          meta->animation_offset_x = 0;
+          meta->animation_offset_y = 0;
+
+          _clutter_actor_set_layout_offset (child, 0, 0);
+        }
     }
 
-  g_list_free (children);
+  g_free (col_offsets);
+  g_free (row_offsets);
+}
+
+static void
+table_layout_animation_new_frame (ClutterTimeline    *timeline,
+                                  gint                msecs,
+                                  ClutterTableLayout *self)
+{
+  ClutterLayoutManager *manager = CLUTTER_LAYOUT_MANAGER (self);
+  ClutterTableLayoutPrivate *priv = self->priv;
+  ClutterContainerIter iter;
+  ClutterActor *child;
+  gdouble p;
+
+  if (priv->container == NULL)
+    return;
+
+  p = clutter_layout_manager_get_animation_progress (manager);
+
+  clutter_container_iter_init (&iter, priv->container);
+  while (clutter_container_iter_next (&iter, &child))
+    {
+      ClutterTableChild *meta;
+
+      meta = CLUTTER_TABLE_CHILD (clutter_layout_manager_get_child_meta (manager,
+                                                                         priv->container,
+                                                                         child));
+
+      _clutter_actor_set_layout_offset (child,
+                                        meta->animation_offset_x * (1.0 - p),
+                                        meta->animation_offset_y * (1.0 - p));
+    }
 }
 
 static ClutterAlpha *
@@ -1569,13 +1791,33 @@ clutter_table_layout_begin_animation (ClutterLayoutManager *manager,
 {
   ClutterTableLayoutPrivate *priv = CLUTTER_TABLE_LAYOUT (manager)->priv;
   ClutterLayoutManagerClass *parent_class;
+  ClutterTimeline *timeline;
+  ClutterAlpha *alpha;
 
   priv->is_animating = TRUE;
 
   /* we want the default implementation */
   parent_class = CLUTTER_LAYOUT_MANAGER_CLASS (clutter_table_layout_parent_class);
 
-  return parent_class->begin_animation (manager, duration, easing);
+  alpha = parent_class->begin_animation (manager, duration, easing);
+
+  /* see clutter_box_layout_begin_animation() */
+  timeline = clutter_alpha_get_timeline (alpha);
+  if (timeline != priv->animation_timeline)
+    {
+      g_signal_handlers_block_by_func (timeline,
+                                       clutter_layout_manager_layout_changed,
+                                       manager);
+      g_signal_connect (timeline, "new-frame",
+                        G_CALLBACK (table_layout_animation_new_frame),
+                        manager);
+
+      priv->animation_timeline = timeline;
+    }
+
+  clutter_layout_manager_layout_changed (manager);
+
+  return alpha;
 }
 
 static void
@@ -1584,6 +1826,14 @@ clutter_table_layout_end_animation (ClutterLayoutManager *manager)
   ClutterTableLayoutPrivate *priv = CLUTTER_TABLE_LAYOUT (manager)->priv;
   ClutterLayoutManagerClass *parent_class;
 
+  if (priv->animation_timeline != NULL)
+    {
+      g_signal_handlers_disconnect_by_func (priv->animation_timeline,
+                                            table_layout_animation_new_frame,
+                                            manager);
+      priv->animation_timeline = NULL;
+    }
+
   priv->is_animating = FALSE;
 
   /* we want the default implementation */
@@ -1843,6 +2093,8 @@ clutter_table_layout_set_column_spacing (ClutterTableLayout *layout,
 
       priv->col_spacing = spacing;
 
+      table_layout_invalidate (layout);
+
       manager = CLUTTER_LAYOUT_MANAGER (layout);
 
       if (priv->use_animations)
@@ -1901,6 +2153,8 @@ clutter_table_layout_set_row_spacing (ClutterTableLayout *layout,
 
       priv->row_spacing = spacing;
 
+      table_layout_invalidate (layout);
+
       manager = CLUTTER_LAYOUT_MANAGER (layout);
 
       if (priv->use_animations)
@@ -1988,6 +2242,91 @@ clutter_table_layout_pack (ClutterTableLayout  *layout,
   table_child_set_position (CLUTTER_TABLE_CHILD (meta), column, row);
 }
 
+/**
+ * clutter_table_layout_pack_full:
+ * @layout: a #ClutterTableLayout
+ * @actor: a #ClutterActor
+ * @column: the column the @actor should be put, or -1 to append
+ * @row: the row the @actor should be put, or -1 to append
+ * @column_span: the number of columns spanned by @actor
+ * @row_span: the number of rows spanned by @actor
+ * @x_align: Horizontal alignment policy for @actor
+ * @y_align: Vertical alignment policy for @actor
+ *
+ * Packs @actor inside the #ClutterContainer associated to @layout
+ * at the given row and column, with the given span and alignment
+ * policies.
+ *
+ * This is equivalent to calling clutter_table_layout_pack() followed
+ * by clutter_table_layout_set_span() and
+ * clutter_table_layout_set_alignment(), but the layout is changed only
+ * once and it is never animated; it should be preferred when filling
+ * large tables.
+ *
+ * Since: 1.8
+ */
+void
+clutter_table_layout_pack_full (ClutterTableLayout    *layout,
+                                ClutterActor          *actor,
+                                gint                   column,
+                                gint                   row,
+                                gint                   column_span,
+                                gint                   row_span,
+                                ClutterTableAlignment  x_align,
+                                ClutterTableAlignment  y_align)
+{
+  ClutterTableLayoutPrivate *priv;
+  ClutterLayoutManager *manager;
+  ClutterTableChild *meta;
+
+  g_return_if_fail (CLUTTER_IS_TABLE_LAYOUT (layout));
+  g_return_if_fail (CLUTTER_IS_ACTOR (actor));
+
+  priv = layout->priv;
+
+  if (priv->container == NULL)
+    {
+      g_warning ("The layout of type '%s' must be associated to "
+                 "a ClutterContainer before adding children",
+                 G_OBJECT_TYPE_NAME (layout));
+      return;
+    }
+
+  update_row_col (layout, priv->container);
+
+  if (row < 0)
+    row = priv->n_rows + 1;
+
+  if (column < 0)
+    column = priv->n_cols + 1;
+
+  manager = CLUTTER_LAYOUT_MANAGER (layout);
+
+  _clutter_layout_manager_freeze_layout_change (manager);
+
+  clutter_container_add_actor (priv->container, actor);
+
+  meta = CLUTTER_TABLE_CHILD (clutter_layout_manager_get_child_meta (manager,
+                                                                     priv->container,
+                                                                     actor));
+
+  /* the layout meta has just been created for @actor, so we can
+   * set its fields directly instead of going through the setters,
+   * which would change the layout once for each property
+   */
+  meta->col = column;
+  meta->row = row;
+  meta->col_span = column_span;
+  meta->row_span = row_span;
+  meta->x_align = x_align;
+  meta->y_align = y_align;
+
+  _clutter_layout_manager_thaw_layout_change (manager);
+
+  table_layout_invalidate (layout);
+  clutter_layout_manager_layout_changed (manager);
+}
+
 /**
  * clutter_table_layout_set_span:
  * @layout: a #ClutterTableLayout
@@ -2449,6 +2788,10 @@ clutter_table_layout_get_expand (ClutterTableLayout *layout,
  * clutter_table_layout_set_easing_duration(); the easing mode to be used
  * by the animations is controlled by clutter_table_layout_set_easing_mode()
  *
+ * The children are allocated in their final size when the animation
+ * begins, and only their position is animated; the layout is not
+ * allocated again on every frame of the animation
+ *
  * Since: 1.4
  */
 void
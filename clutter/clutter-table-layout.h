@@ -104,6 +104,14 @@ void                  clutter_table_layout_pack                (ClutterTableLayo
                                                                 ClutterActor          *actor,
                                                                 gint                   column,
                                                                 gint                   row);
+void                  clutter_table_layout_pack_full           (ClutterTableLayout    *layout,
+                                                                ClutterActor          *actor,
+                                                                gint                   column,
+                                                                gint                   row,
+                                                                gint                   column_span,
+                                                                gint                   row_span,
+                                                                ClutterTableAlignment  x_align,
+                                                                ClutterTableAlignment  y_align);
 
 void                  clutter_table_layout_set_column_spacing  (ClutterTableLayout    *layout,
                                                                 guint                  spacing);
@@ -56,8 +56,12 @@
 #include "clutter-keysyms.h"
 #include "clutter-main.h"
 #include "clutter-marshal.h"
+#include "clutter-master-clock.h"
+#include "clutter-paint-volume-private.h"
 #include "clutter-private.h"    /* includes <cogl-pango/cogl-pango.h> */
 #include "clutter-profile.h"
+#include "clutter-sdf-glyphs.h"
+#include "clutter-stage-private.h"
 #include "clutter-units.h"
 
 /* cursor width in pixels */
@@ -75,9 +79,52 @@
  */
 #define N_CACHED_LAYOUTS        6
 
+/* The layouts of the non-editable text actors are also kept in a cache
+ * shared by all the instances, so that labels showing the same text
+ * with the same font and size do not shape it again. This is the
+ * estimated amount of memory the shared cache can use
+ */
+#define SHARED_LAYOUT_CACHE_SIZE        (2 * 1024 * 1024)
+
+/* With #ClutterText:layout-async set, only the texts longer than this
+ * are shaped by the worker thread; meanwhile, the layout of the first
+ * ASYNC_LAYOUT_PROVISIONAL_BYTES bytes is used
+ */
+#define ASYNC_LAYOUT_MIN_BYTES          4096
+#define ASYNC_LAYOUT_PROVISIONAL_BYTES  1024
+
+/* Only the visible lines of the layouts with more lines than this are
+ * painted, and their glyphs are cached while painting them, instead of
+ * caching the glyphs of the whole layout up front
+ */
+#define VISIBLE_LINES_MIN_LINES         128
+
+/* The extents of the editable texts longer than this are computed
+ * paragraph by paragraph, see clutter_text_get_paragraph_extents()
+ */
+#define PARAGRAPH_METRICS_MIN_BYTES     1024
+
+/* Only the texts longer than this are shaped by the worker threads
+ * in _clutter_text_prefetch_layouts(); the batch is shaped using at
+ * most PREFETCH_MAX_THREADS threads
+ */
+#define PREFETCH_MIN_BYTES              256
+#define PREFETCH_MAX_THREADS            4
+
+/* When the font settings change, the texts that are mapped but outside
+ * of the stage pick up the change at most this many at each frame; the
+ * texts on the stage pick it up right away, and the texts that are not
+ * mapped when they are mapped again
+ */
+#define FONT_CHANGE_TEXTS_PER_FRAME     16
+
 #define CLUTTER_TEXT_GET_PRIVATE(obj)   (G_TYPE_INSTANCE_GET_PRIVATE ((obj), CLUTTER_TYPE_TEXT, ClutterTextPrivate))
 
 typedef struct _LayoutCache     LayoutCache;
+typedef struct _SharedLayout    SharedLayout;
+typedef struct _AsyncLayout     AsyncLayout;
+typedef struct _PrefetchBatch   PrefetchBatch;
+typedef struct _ParagraphMetrics ParagraphMetrics;
 
 static const ClutterColor default_cursor_color    = {   0,   0,   0, 255 };
 static const ClutterColor default_selection_color = {   0,   0,   0, 255 };
@@ -100,6 +147,33 @@ struct _LayoutCache
   guint age;
 };
 
+struct _SharedLayout
+{
+  gchar *key;
+
+  PangoLayout *layout;
+
+  /* estimate of the memory used by the layout */
+  gsize size;
+
+  /* link inside the LRU queue */
+  GList *link;
+};
+
+struct _ParagraphMetrics
+{
+  /* the length of the paragraph, including its delimiter */
+  gint n_bytes;
+
+  /* the unconstrained extents, or -1 if not known */
+  gint width;
+  gint height;
+
+  /* the height when wrapped at wrap_width, if wrap_width is not -1 */
+  gint wrap_width;
+  gint wrapped_height;
+};
+
 struct _ClutterTextPrivate
 {
   PangoFontDescription *font_desc;
@@ -149,6 +223,9 @@ struct _ClutterTextPrivate
   guint is_default_font     : 1;
   guint has_focus           : 1;
   guint selected_text_color_set : 1;
+  guint layout_async        : 1;
+  guint use_distance_field  : 1;
+  guint font_change_pending : 1;
 
   /* current cursor position */
   gint position;
@@ -173,6 +250,13 @@ struct _ClutterTextPrivate
   /* the length of the text, in characters */
   gint n_chars;
 
+  /* the last character offset converted to a byte index by
+   * clutter_text_offset_to_index(), so that sequential queries
+   * do not walk the text from its beginning
+   */
+  gint last_offset;
+  gint last_index;
+
   /* Where to draw the cursor */
   ClutterGeometry cursor_pos;
   ClutterColor cursor_color;
@@ -189,11 +273,33 @@ struct _ClutterTextPrivate
 
   gunichar password_char;
 
+  /* the masked text displayed when :password-char is set; it is
+   * grown or shrunk as the text changes, instead of being built
+   * again character by character */
+  GString *password_text;
+
   /* Signal handler for when the backend changes its font settings */
   guint font_changed_id;
 
+  /* the link of the text in the queue of the texts waiting for the
+   * change of the font settings, see clutter_text_font_changed_cb() */
+  GList *font_change_link;
+
   /* Signal handler for when the :text-direction changes */
   guint direction_changed_id;
+
+  /* the layouts being created by the worker thread, or
+   * ready to be used, when :layout-async is set */
+  GList *async_layouts;
+  PangoLayout *provisional_layout;
+
+  /* the layouts of the text before something was appended to it,
+   * used while the new layouts are being created */
+  GSList *previous_layouts;
+
+  /* the ParagraphMetrics of the text, when editable */
+  GArray *paragraphs;
+  PangoLayout *paragraph_layout;
 };
 
 enum
@@ -227,6 +333,8 @@ enum
   PROP_SINGLE_LINE_MODE,
   PROP_SELECTED_TEXT_COLOR,
   PROP_SELECTED_TEXT_COLOR_SET,
+  PROP_LAYOUT_ASYNC,
+  PROP_USE_DISTANCE_FIELD,
 
   PROP_LAST
 };
@@ -246,7 +354,13 @@ enum
 
 static guint text_signals[LAST_SIGNAL] = { 0, };
 
+/* the key bindings of ClutterText, looked up on every key press */
+static ClutterBindingPool *text_binding_pool = NULL;
+
 static void clutter_text_font_changed_cb (ClutterText *text);
+static void clutter_text_queue_redraw_span (ClutterText *self,
+                                            gint         start,
+                                            gint         end);
 
 #define offset_real(t,p)        ((p) == -1 ? g_utf8_strlen ((t), -1) : (p))
 
@@ -268,6 +382,83 @@ offset_to_bytes (const gchar *text,
 
 #define bytes_to_offset(t,p)    (g_utf8_pointer_to_offset ((t), (t) + (p)))
 
+/* converts a character offset inside the contents of @self to a byte
+ * index, starting from the closest between the beginning of the text,
+ * its end, and the last converted offset; a negative offset is the end
+ * of the text, like in offset_to_bytes()
+ */
+static gint
+clutter_text_offset_to_index (ClutterText *self,
+                              gint         offset)
+{
+  ClutterTextPrivate *priv = self->priv;
+  gint base_offset, base_index;
+  gint index_;
+
+  if (offset < 0 || offset >= priv->n_chars)
+    return priv->n_bytes;
+
+  if (offset == priv->last_offset)
+    return priv->last_index;
+
+  base_offset = 0;
+  base_index = 0;
+
+  if (ABS (offset - priv->last_offset) < offset)
+    {
+      base_offset = priv->last_offset;
+      base_index = priv->last_index;
+    }
+
+  if (priv->n_chars - offset < ABS (offset - base_offset))
+    {
+      base_offset = priv->n_chars;
+      base_index = priv->n_bytes;
+    }
+
+  index_ = g_utf8_offset_to_pointer (priv->text + base_index,
+                                     offset - base_offset)
+         - priv->text;
+
+  priv->last_offset = offset;
+  priv->last_index = index_;
+
+  return index_;
+}
+
+/* the reverse of clutter_text_offset_to_index() */
+static gint
+clutter_text_index_to_offset (ClutterText *self,
+                              gint         index_)
+{
+  ClutterTextPrivate *priv = self->priv;
+  gint base_offset, base_index;
+
+  if (index_ < 0 || index_ >= priv->n_bytes)
+    return priv->n_chars;
+
+  if (index_ == priv->last_index)
+    return priv->last_offset;
+
+  base_offset = 0;
+  base_index = 0;
+
+  if (ABS (index_ - priv->last_index) < index_)
+    {
+      base_offset = priv->last_offset;
+      base_index = priv->last_index;
+    }
+
+  if (priv->n_bytes - index_ < ABS (index_ - base_index))
+    {
+      base_offset = priv->n_chars;
+      base_index = priv->n_bytes;
+    }
+
+  return base_offset + g_utf8_pointer_to_offset (priv->text + base_index,
+                                                 priv->text + index_);
+}
+
 static inline void
 clutter_text_clear_selection (ClutterText *self)
 {
@@ -275,9 +466,11 @@ clutter_text_clear_selection (ClutterText *self)
 
   if (priv->selection_bound != priv->position)
     {
+      gint old_bound = priv->selection_bound;
+
       priv->selection_bound = priv->position;
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_SELECTION_BOUND]);
-      clutter_actor_queue_redraw (CLUTTER_ACTOR (self));
+      clutter_text_queue_redraw_span (self, old_bound, priv->position);
     }
 }
 
@@ -293,24 +486,35 @@ clutter_text_get_display_text (ClutterText *self)
     return g_strndup (priv->text, priv->n_bytes);
   else
     {
-      GString *str = g_string_sized_new (priv->n_bytes);
-      gunichar invisible_char;
       gchar buf[7];
-      gint char_len, i;
-
-      invisible_char = priv->password_char;
+      gint char_len, len;
 
       /* we need to convert the string built of invisible
        * characters into UTF-8 for it to be fed to the Pango
        * layout
        */
       memset (buf, 0, sizeof (buf));
-      char_len = g_unichar_to_utf8 (invisible_char, buf);
+      char_len = g_unichar_to_utf8 (priv->password_char, buf);
+
+      if (priv->password_text == NULL)
+        priv->password_text = g_string_sized_new (priv->n_bytes);
+
+      /* the string only holds copies of the same character, so it
+       * can be resized by doubling it or truncating it */
+      len = priv->n_chars * char_len;
 
-      for (i = 0; i < priv->n_chars; i++)
-        g_string_append_len (str, buf, char_len);
+      if (priv->password_text->len == 0 && len > 0)
+        g_string_append_len (priv->password_text, buf, char_len);
 
-      return g_string_free (str, FALSE);
+      while (priv->password_text->len < len)
+        g_string_append_len (priv->password_text,
+                             priv->password_text->str,
+                             MIN (priv->password_text->len,
+                                  len - priv->password_text->len));
+
+      g_string_truncate (priv->password_text, len);
+
+      return g_strndup (priv->password_text->str, len);
     }
 }
 
@@ -362,6 +566,17 @@ clutter_text_ensure_effective_attributes (ClutterText *self)
     }
 }
 
+static void
+clutter_text_ensure_glyph_cache (PangoLayout *layout)
+{
+  /* the glyphs of long layouts are cached line by line when the
+   * lines are painted, see clutter_text_paint_visible_lines() */
+  if (pango_layout_get_line_count (layout) > VISIBLE_LINES_MIN_LINES)
+    return;
+
+  cogl_pango_ensure_glyph_cache_for_layout (layout);
+}
+
 static PangoLayout *
 clutter_text_create_layout_no_cache (ClutterText       *text,
 				     gint               width,
@@ -443,163 +658,1081 @@ clutter_text_create_layout_no_cache (ClutterText       *text,
   return layout;
 }
 
+/* Layouts created from a worker thread, for the non-editable text
+ * actors with #ClutterText:layout-async set. The worker shapes the
+ * text using its own font map and a new PangoContext for each job,
+ * so that it never touches the PangoContext of the actor, which is
+ * used by the main thread. Once the layout has been created it is
+ * only ever used by the main thread
+ */
+typedef enum {
+  ASYNC_LAYOUT_PENDING,
+  ASYNC_LAYOUT_DONE,
+  ASYNC_LAYOUT_CANCELLED
+} AsyncLayoutState;
+
+struct _AsyncLayout
+{
+  ClutterText *text;
+
+  /* only accessed from the main thread */
+  AsyncLayoutState state;
+
+  gint width;
+  gint height;
+  PangoEllipsizeMode ellipsize;
+
+  gchar *contents;
+  PangoFontDescription *font_desc;
+  PangoAttrList *attrs;
+  PangoAlignment alignment;
+  PangoWrapMode wrap_mode;
+  gboolean single_line_mode;
+  gboolean justify;
+
+  PangoDirection base_dir;
+  PangoLanguage *language;
+  cairo_font_options_t *font_options;
+  gdouble resolution;
+  gboolean use_mipmapping;
+
+  /* set by the worker thread */
+  PangoLayout *layout;
+
+  /* the batch of a prefetched layout */
+  PrefetchBatch *batch;
+};
+
+static GThreadPool *async_layout_pool = NULL;
+static guint        async_layout_repaint_func = 0;
+static GList       *async_layout_done_list = NULL;
+static GStaticMutex async_layout_mutex = G_STATIC_MUTEX_INIT;
+
 static void
-clutter_text_dirty_cache (ClutterText *text)
+async_layout_free (AsyncLayout *job)
 {
-  ClutterTextPrivate *priv = text->priv;
-  int i;
+  g_free (job->contents);
 
-  /* Delete the cached layouts so they will be recreated the next time
-     they are needed */
-  for (i = 0; i < N_CACHED_LAYOUTS; i++)
-    if (priv->cached_layouts[i].layout)
-      {
-	g_object_unref (priv->cached_layouts[i].layout);
-	priv->cached_layouts[i].layout = NULL;
-      }
+  if (job->font_desc != NULL)
+    pango_font_description_free (job->font_desc);
+
+  if (job->attrs != NULL)
+    pango_attr_list_unref (job->attrs);
+
+  if (job->font_options != NULL)
+    cairo_font_options_destroy (job->font_options);
+
+  if (job->layout != NULL)
+    g_object_unref (job->layout);
+
+  g_slice_free (AsyncLayout, job);
 }
 
-/*
- * clutter_text_set_font_description_internal:
- * @self: a #ClutterText
- * @desc: a #PangoFontDescription
- *
- * Sets @desc as the font description to be used by the #ClutterText
- * actor. The font description ownership is transferred to @self so
- * the #PangoFontDescription must not be freed after this function
- *
- * This function will also set the :font-name field as a side-effect
- *
- * This function will evict the layout cache, and queue a relayout if
- * the #ClutterText actor has contents.
- */
-static inline void
-clutter_text_set_font_description_internal (ClutterText          *self,
-                                            PangoFontDescription *desc)
+static gboolean
+clutter_text_async_layout_repaint_func (gpointer data)
 {
-  ClutterTextPrivate *priv = self->priv;
+  GList *jobs, *l;
 
-  if (priv->font_desc == desc)
-    return;
+  g_static_mutex_lock (&async_layout_mutex);
+  jobs = async_layout_done_list;
+  async_layout_done_list = NULL;
+  g_static_mutex_unlock (&async_layout_mutex);
 
-  if (priv->font_desc != NULL)
-    pango_font_description_free (priv->font_desc);
+  for (l = jobs; l != NULL; l = l->next)
+    {
+      AsyncLayout *job = l->data;
 
-  priv->font_desc = desc;
+      /* the actor dropped the job after it was queued */
+      if (job->state == ASYNC_LAYOUT_CANCELLED)
+        {
+          async_layout_free (job);
+          continue;
+        }
 
-  /* update the font name string we use */
-  g_free (priv->font_name);
-  priv->font_name = pango_font_description_to_string (priv->font_desc);
+      CLUTTER_NOTE (ACTOR, "ClutterText: %p: layout for size %dx%d ready",
+                    job->text,
+                    job->width,
+                    job->height);
 
-  clutter_text_dirty_cache (self);
+      job->state = ASYNC_LAYOUT_DONE;
 
-  if (priv->text && priv->text[0] != '\0')
-    clutter_actor_queue_relayout (CLUTTER_ACTOR (self));
+      /* the next size negotiation will pick up the new layout */
+      clutter_actor_queue_relayout (CLUTTER_ACTOR (job->text));
+    }
 
-  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_FONT_DESCRIPTION]);
+  g_list_free (jobs);
+
+  return TRUE;
 }
 
+/* creates the layout of @job using @font_map; this is called from
+ * the worker threads, and @font_map must not be used by any other
+ * thread at the same time */
 static void
-clutter_text_font_changed_cb (ClutterText *text)
+clutter_text_shape_layout_job (AsyncLayout      *job,
+                               CoglPangoFontMap *font_map)
 {
-  if (text->priv->is_default_font)
-    {
-      PangoFontDescription *font_desc;
-      ClutterSettings *settings;
-      gchar *font_name = NULL;
+  PangoContext *context;
+  PangoLayout *layout;
 
-      settings = clutter_settings_get_default ();
-      g_object_get (settings, "font-name", &font_name, NULL);
+  /* this is a no-op if the resolution did not change */
+  cogl_pango_font_map_set_resolution (font_map, job->resolution);
+  cogl_pango_font_map_set_use_mipmapping (font_map, job->use_mipmapping);
 
-      CLUTTER_NOTE (ACTOR, "Text[%p]: default font changed to '%s'",
-                    text,
-                    font_name);
+  context = cogl_pango_font_map_create_context (font_map);
+  pango_cairo_context_set_font_options (context, job->font_options);
+  pango_context_set_base_dir (context, job->base_dir);
+  pango_context_set_language (context, job->language);
 
-      font_desc = pango_font_description_from_string (font_name);
-      clutter_text_set_font_description_internal (text, font_desc);
+  layout = pango_layout_new (context);
+  g_object_unref (context);
 
-      g_free (font_name);
-    }
+  pango_layout_set_font_description (layout, job->font_desc);
+  pango_layout_set_text (layout, job->contents, -1);
 
-  clutter_text_dirty_cache (text);
-  clutter_actor_queue_relayout (CLUTTER_ACTOR (text));
+  if (job->attrs != NULL)
+    pango_layout_set_attributes (layout, job->attrs);
+
+  pango_layout_set_alignment (layout, job->alignment);
+  pango_layout_set_single_paragraph_mode (layout, job->single_line_mode);
+  pango_layout_set_justify (layout, job->justify);
+  pango_layout_set_wrap (layout, job->wrap_mode);
+
+  pango_layout_set_ellipsize (layout, job->ellipsize);
+  pango_layout_set_width (layout, job->width);
+  pango_layout_set_height (layout, job->height);
+
+  /* this does the actual shaping and line breaking */
+  pango_layout_get_extents (layout, NULL, NULL);
+
+  job->layout = layout;
 }
 
 static void
-clutter_text_direction_changed_cb (GObject    *gobject,
-                                   GParamSpec *pspec)
+clutter_text_async_layout_thread_func (gpointer data,
+                                       gpointer pool_data)
 {
-  clutter_text_dirty_cache (CLUTTER_TEXT (gobject));
+  static CoglPangoFontMap *font_map = NULL;
+  ClutterMasterClock *master_clock = _clutter_master_clock_get_default ();
+  AsyncLayout *job = data;
 
-  /* no need to queue a relayout: set_text_direction() will do that for us */
+  /* the pool uses a single thread, so the font map is never used by
+   * two jobs at the same time */
+  if (font_map == NULL)
+    font_map = COGL_PANGO_FONT_MAP (cogl_pango_font_map_new ());
+
+  clutter_text_shape_layout_job (job, font_map);
+
+  g_static_mutex_lock (&async_layout_mutex);
+  async_layout_done_list = g_list_append (async_layout_done_list, job);
+  g_static_mutex_unlock (&async_layout_mutex);
+
+  _clutter_master_clock_ensure_next_iteration (master_clock);
 }
 
-/*
- * clutter_text_create_layout:
- * @text: a #ClutterText
- * @allocation_width: the allocation width
- * @allocation_height: the allocation height
- *
- * Like clutter_text_create_layout_no_cache(), but will also ensure
- * the glyphs cache. If a previously cached layout generated using the
- * same width is available then that will be used instead of
- * generating a new one.
- */
-static PangoLayout *
-clutter_text_create_layout (ClutterText *text,
-                            gfloat       allocation_width,
-                            gfloat       allocation_height)
+static gboolean
+clutter_text_should_layout_async (ClutterText *text)
 {
   ClutterTextPrivate *priv = text->priv;
-  LayoutCache *oldest_cache = priv->cached_layouts;
-  gboolean found_free_cache = FALSE;
-  gint width = -1;
-  gint height = -1;
-  PangoEllipsizeMode ellipsize = PANGO_ELLIPSIZE_NONE;
-  int i;
 
-  CLUTTER_STATIC_COUNTER (text_cache_hit_counter,
-                          "Text layout cache hit counter",
-                          "Increments for each layout cache hit",
-                          0);
-  CLUTTER_STATIC_COUNTER (text_cache_miss_counter,
-                          "Text layout cache miss counter",
-                          "Increments for each layout cache miss",
-                          0);
+  /* short texts are shaped faster than a round trip to the worker */
+  return priv->layout_async &&
+         !priv->editable &&
+         priv->n_bytes >= ASYNC_LAYOUT_MIN_BYTES &&
+         g_thread_supported ();
+}
 
-  /* First determine the width, height, and ellipsize mode that
-   * we need for the layout. The ellipsize mode depends on
-   * allocation_width/allocation_size as follows:
-   *
-   * Cases, assuming ellipsize != NONE on actor:
-   *
-   * Width request: ellipsization can be set or not on layout,
-   * doesn't matter.
-   *
-   * Height request: ellipsization must never be set on layout
-   * if wrap=true, because we need to measure the wrapped
-   * height. It must always be set if wrap=false.
-   *
-   * Allocate: ellipsization must always be set.
-   *
-   * See http://bugzilla.gnome.org/show_bug.cgi?id=560931
-   */
+/* copies everything a worker thread needs to lay out @text */
+static AsyncLayout *
+clutter_text_new_layout_job (ClutterText        *text,
+                             gint                width,
+                             gint                height,
+                             PangoEllipsizeMode  ellipsize)
+{
+  ClutterTextPrivate *priv = text->priv;
+  ClutterBackend *backend = clutter_get_default_backend ();
+  PangoContext *context;
+  const cairo_font_options_t *font_options;
+  AsyncLayout *job;
 
-  if (priv->ellipsize != PANGO_ELLIPSIZE_NONE)
+  context = clutter_actor_get_pango_context (CLUTTER_ACTOR (text));
+
+  job = g_slice_new0 (AsyncLayout);
+  job->text = text;
+  job->state = ASYNC_LAYOUT_PENDING;
+  job->width = width;
+  job->height = height;
+  job->ellipsize = ellipsize;
+
+  job->contents = clutter_text_get_display_text (text);
+  job->font_desc = pango_font_description_copy (priv->font_desc);
+
+  clutter_text_ensure_effective_attributes (text);
+  if (priv->effective_attrs != NULL)
+    job->attrs = pango_attr_list_copy (priv->effective_attrs);
+
+  job->alignment = priv->alignment;
+  job->wrap_mode = priv->wrap_mode;
+  job->single_line_mode = priv->single_line_mode;
+  job->justify = priv->justify;
+
+  job->base_dir = pango_context_get_base_dir (context);
+  job->language = pango_context_get_language (context);
+
+  font_options = clutter_backend_get_font_options (backend);
+  if (font_options != NULL)
+    job->font_options = cairo_font_options_copy (font_options);
+
+  job->resolution = clutter_backend_get_resolution (backend);
+  if (job->resolution < 0)
+    job->resolution = 96.0;
+
+  job->use_mipmapping =
+    cogl_pango_font_map_get_use_mipmapping (COGL_PANGO_FONT_MAP (clutter_get_font_map ()));
+
+  return job;
+}
+
+static void
+clutter_text_queue_async_layout (ClutterText        *text,
+                                 gint                width,
+                                 gint                height,
+                                 PangoEllipsizeMode  ellipsize)
+{
+  ClutterTextPrivate *priv = text->priv;
+  AsyncLayout *job;
+
+  job = clutter_text_new_layout_job (text, width, height, ellipsize);
+
+  priv->async_layouts = g_list_prepend (priv->async_layouts, job);
+
+  /* drop the oldest layout that was never used, e.g. because the
+   * actor has been resized in the meantime */
+  if (g_list_length (priv->async_layouts) > N_CACHED_LAYOUTS)
     {
-      if (allocation_height < 0 && priv->wrap)
-        ; /* must not set ellipsization on wrap=true height request */
-      else
+      GList *l;
+
+      for (l = g_list_last (priv->async_layouts); l != NULL; l = l->prev)
         {
-          if (!priv->editable)
-            ellipsize = priv->ellipsize;
+          AsyncLayout *old_job = l->data;
+
+          if (old_job->state == ASYNC_LAYOUT_DONE)
+            {
+              priv->async_layouts =
+                g_list_delete_link (priv->async_layouts, l);
+              async_layout_free (old_job);
+              break;
+            }
         }
     }
 
-  /* When painting, we always need to set the width, since
-   * we might need to align to the right. When getting the
-   * height, however, there are some cases where we know that
-   * the width won't affect the width.
+  if (async_layout_repaint_func == 0)
+    async_layout_repaint_func =
+      clutter_threads_add_repaint_func (clutter_text_async_layout_repaint_func,
+                                        NULL, NULL);
+
+  if (async_layout_pool == NULL)
+    /* This apparently can't fail if exclusive == FALSE */
+    async_layout_pool =
+      g_thread_pool_new (clutter_text_async_layout_thread_func,
+                         NULL, 1, FALSE, NULL);
+
+  g_thread_pool_push (async_layout_pool, job, NULL);
+}
+
+/* returns a new reference on the layout created by the worker thread
+ * for the given parameters, if it is ready; otherwise, it queues a job
+ * for the worker thread, if there isn't one already, and returns %NULL */
+static PangoLayout *
+clutter_text_get_async_layout (ClutterText        *text,
+                               gint                width,
+                               gint                height,
+                               PangoEllipsizeMode  ellipsize)
+{
+  ClutterTextPrivate *priv = text->priv;
+  GList *l;
+
+  for (l = priv->async_layouts; l != NULL; l = l->next)
+    {
+      AsyncLayout *job = l->data;
+      PangoLayout *layout;
+
+      if (job->width != width ||
+          job->height != height ||
+          job->ellipsize != ellipsize)
+        continue;
+
+      if (job->state == ASYNC_LAYOUT_PENDING)
+        return NULL;
+
+      layout = job->layout;
+      job->layout = NULL;
+
+      priv->async_layouts = g_list_delete_link (priv->async_layouts, l);
+      async_layout_free (job);
+
+      return layout;
+    }
+
+  clutter_text_queue_async_layout (text, width, height, ellipsize);
+
+  return NULL;
+}
+
+/* the layout used while the worker thread shapes the whole text: it
+ * only contains the beginning of the text, so that the actor can show
+ * something and report a provisional size in the meantime */
+static PangoLayout *
+clutter_text_get_provisional_layout (ClutterText        *text,
+                                     gint                width,
+                                     gint                height,
+                                     PangoEllipsizeMode  ellipsize)
+{
+  ClutterTextPrivate *priv = text->priv;
+  GSList *l;
+
+  /* if some text was appended, keep showing the previous text until
+   * the worker is done */
+  for (l = priv->previous_layouts; l != NULL; l = l->next)
+    {
+      PangoLayout *layout = l->data;
+
+      if (pango_layout_get_width (layout) == width &&
+          pango_layout_get_height (layout) == height &&
+          pango_layout_get_ellipsize (layout) == ellipsize)
+        return layout;
+    }
+
+  if (priv->provisional_layout == NULL)
+    {
+      gchar *contents;
+      const gchar *end;
+
+      contents = clutter_text_get_display_text (text);
+
+      end = contents + MIN (strlen (contents), ASYNC_LAYOUT_PROVISIONAL_BYTES);
+      if (*end != '\0')
+        end = g_utf8_find_prev_char (contents, end + 1);
+
+      priv->provisional_layout =
+        clutter_actor_create_pango_layout (CLUTTER_ACTOR (text), NULL);
+
+      pango_layout_set_font_description (priv->provisional_layout,
+                                         priv->font_desc);
+      pango_layout_set_text (priv->provisional_layout,
+                             contents,
+                             end - contents);
+
+      clutter_text_ensure_effective_attributes (text);
+      if (priv->effective_attrs != NULL)
+        pango_layout_set_attributes (priv->provisional_layout,
+                                     priv->effective_attrs);
+
+      pango_layout_set_alignment (priv->provisional_layout, priv->alignment);
+      pango_layout_set_single_paragraph_mode (priv->provisional_layout,
+                                              priv->single_line_mode);
+      pango_layout_set_justify (priv->provisional_layout, priv->justify);
+      pango_layout_set_wrap (priv->provisional_layout, priv->wrap_mode);
+
+      g_free (contents);
+    }
+
+  /* the same layout is used for every size, so that the pointer
+   * returned by a previous call is still valid */
+  pango_layout_set_ellipsize (priv->provisional_layout, ellipsize);
+  pango_layout_set_width (priv->provisional_layout, width);
+  pango_layout_set_height (priv->provisional_layout, height);
+
+  clutter_text_ensure_glyph_cache (priv->provisional_layout);
+
+  return priv->provisional_layout;
+}
+
+static void
+clutter_text_clear_async_layouts (ClutterText *text)
+{
+  ClutterTextPrivate *priv = text->priv;
+  GList *l;
+
+  for (l = priv->async_layouts; l != NULL; l = l->next)
+    {
+      AsyncLayout *job = l->data;
+
+      /* the pending jobs are freed once the worker is done with them */
+      if (job->state == ASYNC_LAYOUT_PENDING)
+        job->state = ASYNC_LAYOUT_CANCELLED;
+      else
+        async_layout_free (job);
+    }
+
+  g_list_free (priv->async_layouts);
+  priv->async_layouts = NULL;
+}
+
+static void
+clutter_text_dirty_cache (ClutterText *text)
+{
+  ClutterTextPrivate *priv = text->priv;
+  int i;
+
+  /* Delete the cached layouts so they will be recreated the next time
+     they are needed */
+  for (i = 0; i < N_CACHED_LAYOUTS; i++)
+    if (priv->cached_layouts[i].layout)
+      {
+	g_object_unref (priv->cached_layouts[i].layout);
+	priv->cached_layouts[i].layout = NULL;
+      }
+
+  if (priv->provisional_layout != NULL)
+    {
+      g_object_unref (priv->provisional_layout);
+      priv->provisional_layout = NULL;
+    }
+
+  clutter_text_clear_async_layouts (text);
+
+  g_slist_foreach (priv->previous_layouts, (GFunc) g_object_unref, NULL);
+  g_slist_free (priv->previous_layouts);
+  priv->previous_layouts = NULL;
+
+  if (priv->paragraphs != NULL)
+    {
+      g_array_free (priv->paragraphs, TRUE);
+      priv->paragraphs = NULL;
+    }
+
+  if (priv->paragraph_layout != NULL)
+    {
+      g_object_unref (priv->paragraph_layout);
+      priv->paragraph_layout = NULL;
+    }
+}
+
+/* returns the cached layouts that contain the beginning of the
+ * current text, when the new text is going to be laid out by the
+ * worker thread */
+static GSList *
+clutter_text_get_previous_layouts (ClutterText *text)
+{
+  ClutterTextPrivate *priv = text->priv;
+  GSList *retval = NULL, *l;
+  int i;
+
+  if (!clutter_text_should_layout_async (text) || priv->password_char != 0)
+    return NULL;
+
+  for (i = 0; i < N_CACHED_LAYOUTS; i++)
+    {
+      PangoLayout *layout = priv->cached_layouts[i].layout;
+
+      if (layout != NULL &&
+          g_str_has_prefix (priv->text, pango_layout_get_text (layout)))
+        retval = g_slist_prepend (retval, g_object_ref (layout));
+    }
+
+  /* the text might have been appended to more than once before the
+   * worker was done */
+  for (l = priv->previous_layouts; l != NULL; l = l->next)
+    {
+      PangoLayout *layout = l->data;
+
+      if (g_str_has_prefix (priv->text, pango_layout_get_text (layout)))
+        retval = g_slist_prepend (retval, g_object_ref (layout));
+    }
+
+  return retval;
+}
+
+/* The size of the editable, multi-line text actors is computed from
+ * the extents of each paragraph, which are kept across edits: this
+ * way, an edit only requires shaping the paragraphs it touches for
+ * the size negotiation, and the whole text only once, for painting
+ */
+static gboolean
+clutter_text_use_paragraph_metrics (ClutterText *text)
+{
+  ClutterTextPrivate *priv = text->priv;
+
+  return priv->editable &&
+         !priv->single_line_mode &&
+         !priv->preedit_set &&
+         priv->password_char == 0 &&
+         priv->n_bytes >= PARAGRAPH_METRICS_MIN_BYTES;
+}
+
+/* appends the paragraphs of @str, up to @len bytes, to @paragraphs;
+ * if @at_end is %TRUE, @str is the end of the text, and the empty
+ * paragraph that Pango lays out after a trailing delimiter is added */
+static void
+paragraph_metrics_split (GArray      *paragraphs,
+                         const gchar *str,
+                         gint         len,
+                         gboolean     at_end)
+{
+  ParagraphMetrics metrics = { 0, -1, -1, -1, -1 };
+  gint delimiter, next_start;
+
+  while (len > 0)
+    {
+      pango_find_paragraph_boundary (str, len, &delimiter, &next_start);
+
+      metrics.n_bytes = next_start;
+      g_array_append_val (paragraphs, metrics);
+
+      if (at_end && delimiter == next_start)
+        return;
+
+      str += next_start;
+      len -= next_start;
+    }
+
+  if (at_end)
+    {
+      metrics.n_bytes = 0;
+      g_array_append_val (paragraphs, metrics);
+    }
+}
+
+/* updates the paragraphs of the text after the bytes between @prefix
+ * and @old_len - @suffix have been replaced with the bytes between
+ * @prefix and @new_len - @suffix of the current text; the metrics of
+ * the paragraphs outside of the edited range are preserved */
+static GArray *
+paragraph_metrics_edit (GArray      *old_paragraphs,
+                        const gchar *text,
+                        gint         old_len,
+                        gint         new_len,
+                        gint         prefix,
+                        gint         suffix)
+{
+  GArray *paragraphs;
+  gint old_end = old_len - suffix;
+  gint start, end, i, first_kept;
+
+  paragraphs = g_array_new (FALSE, FALSE, sizeof (ParagraphMetrics));
+
+  /* the paragraphs ending before the edit are unchanged */
+  start = 0;
+  for (i = 0; i < old_paragraphs->len; i++)
+    {
+      ParagraphMetrics *metrics;
+
+      metrics = &g_array_index (old_paragraphs, ParagraphMetrics, i);
+      if (start + metrics->n_bytes >= prefix)
+        break;
+
+      g_array_append_val (paragraphs, *metrics);
+      start += metrics->n_bytes;
+    }
+
+  /* and so are the paragraphs starting after it */
+  end = start;
+  first_kept = old_paragraphs->len;
+  for (; i < old_paragraphs->len; i++)
+    {
+      if (end > old_end)
+        {
+          first_kept = i;
+          break;
+        }
+
+      end += g_array_index (old_paragraphs, ParagraphMetrics, i).n_bytes;
+    }
+
+  if (first_kept < old_paragraphs->len)
+    {
+      end += new_len - old_len;
+
+      paragraph_metrics_split (paragraphs, text + start, end - start, FALSE);
+      g_array_append_vals (paragraphs,
+                           &g_array_index (old_paragraphs,
+                                           ParagraphMetrics,
+                                           first_kept),
+                           old_paragraphs->len - first_kept);
+    }
+  else
+    paragraph_metrics_split (paragraphs, text + start, new_len - start, TRUE);
+
+  return paragraphs;
+}
+
+/* measures the paragraph of @text starting at @offset; @width is in
+ * Pango units, or -1 for the unconstrained extents */
+static void
+clutter_text_measure_paragraph (ClutterText *text,
+                                gint         offset,
+                                gint         n_bytes,
+                                gint         width,
+                                gint        *width_p,
+                                gint        *height_p)
+{
+  ClutterTextPrivate *priv = text->priv;
+  PangoRectangle logical_rect = { 0, };
+  gint delimiter, next_start;
+
+  if (priv->paragraph_layout == NULL)
+    {
+      priv->paragraph_layout =
+        clutter_actor_create_pango_layout (CLUTTER_ACTOR (text), NULL);
+
+      pango_layout_set_font_description (priv->paragraph_layout,
+                                         priv->font_desc);
+      pango_layout_set_wrap (priv->paragraph_layout, priv->wrap_mode);
+    }
+
+  /* the delimiter does not take any space */
+  pango_find_paragraph_boundary (priv->text + offset, n_bytes,
+                                 &delimiter, &next_start);
+
+  pango_layout_set_text (priv->paragraph_layout,
+                         priv->text + offset,
+                         delimiter);
+  pango_layout_set_width (priv->paragraph_layout, width);
+
+  pango_layout_get_extents (priv->paragraph_layout, NULL, &logical_rect);
+
+  *width_p = logical_rect.x + logical_rect.width;
+  *height_p = logical_rect.y + logical_rect.height;
+}
+
+static void
+clutter_text_ensure_paragraphs (ClutterText *text)
+{
+  ClutterTextPrivate *priv = text->priv;
+
+  if (priv->paragraphs != NULL)
+    return;
+
+  priv->paragraphs = g_array_new (FALSE, FALSE, sizeof (ParagraphMetrics));
+  paragraph_metrics_split (priv->paragraphs, priv->text, priv->n_bytes, TRUE);
+}
+
+/* computes the extents of the whole text, in Pango units, from the
+ * extents of the paragraphs; @width is the width the paragraphs are
+ * wrapped at, in Pango units, or -1 */
+static void
+clutter_text_get_paragraph_extents (ClutterText *text,
+                                    gint         width,
+                                    gint        *width_p,
+                                    gint        *height_p)
+{
+  ClutterTextPrivate *priv = text->priv;
+  gint offset = 0, n_measured = 0;
+  gint total_width = 0, total_height = 0;
+  gint i;
+
+  clutter_text_ensure_paragraphs (text);
+
+  for (i = 0; i < priv->paragraphs->len; i++)
+    {
+      ParagraphMetrics *metrics;
+
+      metrics = &g_array_index (priv->paragraphs, ParagraphMetrics, i);
+
+      if (metrics->width < 0)
+        {
+          clutter_text_measure_paragraph (text, offset, metrics->n_bytes,
+                                          -1,
+                                          &metrics->width,
+                                          &metrics->height);
+          n_measured += 1;
+        }
+
+      total_width = MAX (total_width, metrics->width);
+
+      if (width < 0 || !priv->wrap || metrics->width <= width)
+        total_height += metrics->height;
+      else
+        {
+          if (metrics->wrap_width != width)
+            {
+              gint wrapped_width;
+
+              clutter_text_measure_paragraph (text, offset, metrics->n_bytes,
+                                              width,
+                                              &wrapped_width,
+                                              &metrics->wrapped_height);
+              metrics->wrap_width = width;
+              n_measured += 1;
+            }
+
+          total_height += metrics->wrapped_height;
+        }
+
+      offset += metrics->n_bytes;
+    }
+
+  CLUTTER_NOTE (ACTOR, "ClutterText: %p: measured %d paragraphs out of %d",
+                text,
+                n_measured,
+                priv->paragraphs->len);
+
+  if (width_p)
+    *width_p = total_width;
+
+  if (height_p)
+    *height_p = total_height;
+}
+
+static GHashTable *shared_layouts = NULL;
+static GQueue       shared_layouts_lru = G_QUEUE_INIT;
+static gsize        shared_layouts_size = 0;
+
+static void
+shared_layout_free (SharedLayout *shared)
+{
+  shared_layouts_size -= shared->size;
+  g_queue_delete_link (&shared_layouts_lru, shared->link);
+
+  g_object_unref (shared->layout);
+  g_free (shared->key);
+
+  g_slice_free (SharedLayout, shared);
+}
+
+static void
+clutter_text_clear_shared_layouts (void)
+{
+  if (shared_layouts != NULL)
+    g_hash_table_remove_all (shared_layouts);
+}
+
+/* the shared layouts are only used when the contents of the layout
+ * are completely determined by the key returned by this function */
+static gchar *
+clutter_text_get_shared_layout_key (ClutterText        *text,
+                                    gint                width,
+                                    gint                height,
+                                    PangoEllipsizeMode  ellipsize)
+{
+  ClutterTextPrivate *priv = text->priv;
+  gchar *font_name, *key;
+
+  if (priv->editable || priv->password_char != 0 || priv->text == NULL)
+    return NULL;
+
+  clutter_text_ensure_effective_attributes (text);
+  if (priv->effective_attrs != NULL)
+    return NULL;
+
+  if (priv->font_desc != NULL)
+    font_name = pango_font_description_to_string (priv->font_desc);
+  else
+    font_name = NULL;
+
+  key = g_strdup_printf ("%p:%s:%d:%d:%d:%d:%d:%d:%d\n%s",
+                         clutter_actor_get_pango_context (CLUTTER_ACTOR (text)),
+                         font_name != NULL ? font_name : "",
+                         width, height,
+                         ellipsize,
+                         priv->alignment,
+                         priv->single_line_mode,
+                         priv->justify,
+                         priv->wrap_mode,
+                         priv->text);
+
+  g_free (font_name);
+
+  return key;
+}
+
+/* returns a new reference on the shared layout for @key, if any */
+static PangoLayout *
+clutter_text_lookup_shared_layout (const gchar *key)
+{
+  SharedLayout *shared;
+
+  if (shared_layouts == NULL)
+    return NULL;
+
+  shared = g_hash_table_lookup (shared_layouts, key);
+  if (shared == NULL)
+    return NULL;
+
+  /* move the layout at the head of the LRU queue */
+  g_queue_unlink (&shared_layouts_lru, shared->link);
+  g_queue_push_head_link (&shared_layouts_lru, shared->link);
+
+  return g_object_ref (shared->layout);
+}
+
+/* takes ownership of @key */
+static void
+clutter_text_insert_shared_layout (gchar       *key,
+                                   PangoLayout *layout)
+{
+  SharedLayout *shared;
+
+  if (shared_layouts == NULL)
+    shared_layouts =
+      g_hash_table_new_full (g_str_hash, g_str_equal,
+                             NULL,
+                             (GDestroyNotify) shared_layout_free);
+
+  shared = g_slice_new (SharedLayout);
+  shared->key = key;
+  shared->layout = g_object_ref (layout);
+
+  /* a rough estimate of the glyph strings and lines of the layout */
+  shared->size = sizeof (SharedLayout) + 512
+               + strlen (pango_layout_get_text (layout)) * 24;
+
+  g_queue_push_head (&shared_layouts_lru, shared);
+  shared->link = shared_layouts_lru.head;
+  shared_layouts_size += shared->size;
+
+  g_hash_table_replace (shared_layouts, shared->key, shared);
+
+  while (shared_layouts_size > SHARED_LAYOUT_CACHE_SIZE &&
+         shared_layouts_lru.tail != shared->link)
+    {
+      SharedLayout *oldest = shared_layouts_lru.tail->data;
+
+      g_hash_table_remove (shared_layouts, oldest->key);
+    }
+}
+
+/*
+ * clutter_text_set_font_description_internal:
+ * @self: a #ClutterText
+ * @desc: a #PangoFontDescription
+ *
+ * Sets @desc as the font description to be used by the #ClutterText
+ * actor. The font description ownership is transferred to @self so
+ * the #PangoFontDescription must not be freed after this function
+ *
+ * This function will also set the :font-name field as a side-effect
+ *
+ * This function will evict the layout cache, and queue a relayout if
+ * the #ClutterText actor has contents.
+ */
+static inline void
+clutter_text_set_font_description_internal (ClutterText          *self,
+                                            PangoFontDescription *desc)
+{
+  ClutterTextPrivate *priv = self->priv;
+
+  if (priv->font_desc == desc)
+    return;
+
+  if (priv->font_desc != NULL)
+    pango_font_description_free (priv->font_desc);
+
+  priv->font_desc = desc;
+
+  /* update the font name string we use */
+  g_free (priv->font_name);
+  priv->font_name = pango_font_description_to_string (priv->font_desc);
+
+  clutter_text_dirty_cache (self);
+
+  if (priv->text && priv->text[0] != '\0')
+    clutter_actor_queue_relayout (CLUTTER_ACTOR (self));
+
+  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_FONT_DESCRIPTION]);
+}
+
+static GQueue font_change_queue = G_QUEUE_INIT;
+static guint  font_change_repaint_func = 0;
+
+/* applies the change of the font settings to @text */
+static void
+clutter_text_apply_font_change (ClutterText *text)
+{
+  ClutterTextPrivate *priv = text->priv;
+  ClutterActor *stage;
+
+  priv->font_change_pending = FALSE;
+
+  if (priv->font_change_link != NULL)
+    {
+      g_queue_delete_link (&font_change_queue, priv->font_change_link);
+      priv->font_change_link = NULL;
+    }
+
+  if (priv->is_default_font)
+    {
+      PangoFontDescription *font_desc;
+      ClutterSettings *settings;
+      gchar *font_name = NULL;
+
+      settings = clutter_settings_get_default ();
+      g_object_get (settings, "font-name", &font_name, NULL);
+
+      CLUTTER_NOTE (ACTOR, "Text[%p]: default font changed to '%s'",
+                    text,
+                    font_name);
+
+      font_desc = pango_font_description_from_string (font_name);
+      clutter_text_set_font_description_internal (text, font_desc);
+
+      g_free (font_name);
+    }
+
+  clutter_text_dirty_cache (text);
+  clutter_actor_queue_relayout (CLUTTER_ACTOR (text));
+
+  /* the texts picking up the change in the same frame are shaped
+   * together, like the texts that have just been mapped */
+  if (priv->editable || priv->n_bytes < PREFETCH_MIN_BYTES)
+    return;
+
+  stage = _clutter_actor_get_stage_internal (CLUTTER_ACTOR (text));
+  if (stage != NULL)
+    _clutter_stage_queue_text_prefetch (CLUTTER_STAGE (stage),
+                                        CLUTTER_ACTOR (text));
+}
+
+static gboolean
+clutter_text_font_change_repaint_func (gpointer data)
+{
+  ClutterText *text;
+  guint i;
+
+  for (i = 0; i < FONT_CHANGE_TEXTS_PER_FRAME; i++)
+    {
+      text = g_queue_peek_head (&font_change_queue);
+      if (text == NULL)
+        break;
+
+      /* the texts unmapped in the meantime wait until they are
+       * mapped again */
+      if (!CLUTTER_ACTOR_IS_MAPPED (text))
+        {
+          g_queue_delete_link (&font_change_queue,
+                               text->priv->font_change_link);
+          text->priv->font_change_link = NULL;
+          continue;
+        }
+
+      clutter_text_apply_font_change (text);
+    }
+
+  if (g_queue_is_empty (&font_change_queue))
+    {
+      font_change_repaint_func = 0;
+      return FALSE;
+    }
+
+  /* make sure that there is a next frame */
+  text = g_queue_peek_head (&font_change_queue);
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (text));
+
+  return TRUE;
+}
+
+/* checks whether the last known paint box of @text is on its stage */
+static gboolean
+clutter_text_is_on_stage (ClutterText *text)
+{
+  ClutterActor *stage;
+  ClutterActorBox box;
+  gfloat width, height;
+
+  stage = _clutter_actor_get_stage_internal (CLUTTER_ACTOR (text));
+  if (stage == NULL)
+    return FALSE;
+
+  if (!clutter_actor_get_paint_box (CLUTTER_ACTOR (text), &box))
+    return TRUE;
+
+  clutter_actor_get_size (stage, &width, &height);
+
+  return box.x2 > 0 && box.y2 > 0 && box.x1 < width && box.y1 < height;
+}
+
+/* Reshaping every text at once after a change of the font settings can
+ * stall the next frame in large user interfaces, so only the texts on
+ * the stage are updated right away; the texts that are mapped outside
+ * of the stage are updated a few at each frame, and the texts that are
+ * not mapped are updated when they are mapped again
+ */
+static void
+clutter_text_font_changed_cb (ClutterText *text)
+{
+  ClutterTextPrivate *priv = text->priv;
+
+  /* the font options might have changed as well */
+  clutter_text_clear_shared_layouts ();
+
+  if (CLUTTER_ACTOR_IS_MAPPED (text) && clutter_text_is_on_stage (text))
+    {
+      clutter_text_apply_font_change (text);
+      return;
+    }
+
+  priv->font_change_pending = TRUE;
+
+  if (!CLUTTER_ACTOR_IS_MAPPED (text) || priv->font_change_link != NULL)
+    return;
+
+  g_queue_push_tail (&font_change_queue, text);
+  priv->font_change_link = font_change_queue.tail;
+
+  if (font_change_repaint_func == 0)
+    font_change_repaint_func =
+      clutter_threads_add_repaint_func (clutter_text_font_change_repaint_func,
+                                        NULL, NULL);
+}
+
+static void
+clutter_text_direction_changed_cb (GObject    *gobject,
+                                   GParamSpec *pspec)
+{
+  clutter_text_dirty_cache (CLUTTER_TEXT (gobject));
+
+  /* no need to queue a relayout: set_text_direction() will do that for us */
+}
+
+/* determines the width, height and ellipsize mode of the layout
+ * used for the given allocation size */
+static void
+clutter_text_get_layout_params (ClutterText        *text,
+                                gfloat              allocation_width,
+                                gfloat              allocation_height,
+                                gint               *width_p,
+                                gint               *height_p,
+                                PangoEllipsizeMode *ellipsize_p)
+{
+  ClutterTextPrivate *priv = text->priv;
+  gint width = -1;
+  gint height = -1;
+  PangoEllipsizeMode ellipsize = PANGO_ELLIPSIZE_NONE;
+
+  /* First determine the width, height, and ellipsize mode that
+   * we need for the layout. The ellipsize mode depends on
+   * allocation_width/allocation_size as follows:
+   *
+   * Cases, assuming ellipsize != NONE on actor:
+   *
+   * Width request: ellipsization can be set or not on layout,
+   * doesn't matter.
+   *
+   * Height request: ellipsization must never be set on layout
+   * if wrap=true, because we need to measure the wrapped
+   * height. It must always be set if wrap=false.
+   *
+   * Allocate: ellipsization must always be set.
+   *
+   * See http://bugzilla.gnome.org/show_bug.cgi?id=560931
+   */
+
+  if (priv->ellipsize != PANGO_ELLIPSIZE_NONE)
+    {
+      if (allocation_height < 0 && priv->wrap)
+        ; /* must not set ellipsization on wrap=true height request */
+      else
+        {
+          if (!priv->editable)
+            ellipsize = priv->ellipsize;
+        }
+    }
+
+  /* When painting, we always need to set the width, since
+   * we might need to align to the right. When getting the
+   * height, however, there are some cases where we know that
+   * the width won't affect the width.
    *
    * - editable, single-line text actors, since those can
    *   scroll the layout.
@@ -630,9 +1763,64 @@ clutter_text_create_layout (ClutterText *text,
       height = allocation_height * 1024 + 0.5f;
     }
 
-  /* Search for a cached layout with the same width and keep
-   * track of the oldest one
-   */
+  *width_p = width;
+  *height_p = height;
+  *ellipsize_p = ellipsize;
+}
+
+/* checks whether @cached, a layout created without a width, can be
+ * painted in place of a layout created for @width: this is the case
+ * if the text fits inside @width, so that Pango neither wraps nor
+ * ellipsizes any line, and if every line is aligned to the left, so
+ * that the width does not move any of them
+ */
+static gboolean
+clutter_text_unconstrained_layout_fits (ClutterText *text,
+                                        PangoLayout *cached,
+                                        gint         width,
+                                        gint         height)
+{
+  PangoRectangle logical_rect;
+  GSList *l;
+
+  if (text->priv->editable ||
+      height != -1 ||
+      pango_layout_get_height (cached) != -1 ||
+      pango_layout_get_alignment (cached) != PANGO_ALIGN_LEFT)
+    return FALSE;
+
+  pango_layout_get_extents (cached, NULL, &logical_rect);
+  if (logical_rect.width > width)
+    return FALSE;
+
+  /* Pango swaps the alignment of the right-to-left lines */
+  for (l = pango_layout_get_lines_readonly (cached); l != NULL; l = l->next)
+    {
+      PangoLayoutLine *line = l->data;
+
+      if (line->resolved_dir != PANGO_DIRECTION_LTR)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* Searches for a cached layout that can be used for the given layout
+ * parameters; if there is none, @oldest_cache_p is set to the cache
+ * entry that should be replaced */
+static LayoutCache *
+clutter_text_lookup_cached_layout (ClutterText         *text,
+                                   gfloat               allocation_height,
+                                   gint                 width,
+                                   gint                 height,
+                                   PangoEllipsizeMode   ellipsize,
+                                   LayoutCache        **oldest_cache_p)
+{
+  ClutterTextPrivate *priv = text->priv;
+  LayoutCache *oldest_cache = priv->cached_layouts;
+  gboolean found_free_cache = FALSE;
+  int i;
+
   for (i = 0; i < N_CACHED_LAYOUTS; i++)
     {
       if (priv->cached_layouts[i].layout == NULL)
@@ -648,24 +1836,13 @@ clutter_text_create_layout (ClutterText *text,
 	  gint cached_height = pango_layout_get_height (cached);
 	  gint cached_ellipsize = pango_layout_get_ellipsize (cached);
 
+	  /* If this cached layout is using the same size then we can
+	   * just return that directly
+	   */
 	  if (cached_width == width &&
 	      cached_height == height &&
 	      cached_ellipsize == ellipsize)
-	    {
-              /* If this cached layout is using the same size then we can
-               * just return that directly
-               */
-              CLUTTER_NOTE (ACTOR,
-                            "ClutterText: %p: cache hit for size %.2fx%.2f",
-                            text,
-                            allocation_width,
-                            allocation_height);
-
-              CLUTTER_COUNTER_INC (_clutter_uprof_context,
-                                   text_cache_hit_counter);
-
-              return priv->cached_layouts[i].layout;
-	    }
+            return priv->cached_layouts + i;
 
 	  /* When getting the preferred height for a specific width,
 	   * we might be able to reuse the layout from getting the
@@ -679,29 +1856,39 @@ clutter_text_create_layout (ClutterText *text,
 	    {
 	      PangoRectangle logical_rect;
 
-	      pango_layout_get_extents (priv->cached_layouts[i].layout,
-                                        NULL,
-                                        &logical_rect);
+	      pango_layout_get_extents (cached, NULL, &logical_rect);
 
 	      if (logical_rect.width <= width)
-		{
-		  /* We've been asked for our height for the width we gave as a result
-		   * of a _get_preferred_width call
-		   */
-		  CLUTTER_NOTE (ACTOR,
-                                "ClutterText: %p: cache hit for size %.2fx%.2f "
-				"(unwrapped width narrower than given width)",
-				text,
-				allocation_width,
-				allocation_height);
-
-                  CLUTTER_COUNTER_INC (_clutter_uprof_context,
-                                       text_cache_hit_counter);
-
-		  return priv->cached_layouts[i].layout;
-		}
+                {
+                  CLUTTER_NOTE (ACTOR,
+                                "ClutterText: %p: unwrapped width narrower "
+                                "than the given width",
+                                text);
+
+                  return priv->cached_layouts + i;
+                }
 	    }
 
+          /* When allocating or painting, a width that the text does
+           * not reach only matters for the alignment; so, as long as
+           * the width does not drop below the natural width, the
+           * layouts of the labels inside containers animating their
+           * width, ellipsized or not, are not shaped again
+           */
+          if (allocation_height >= 0 &&
+              width != -1 &&
+              cached_width == -1 &&
+              clutter_text_unconstrained_layout_fits (text, cached,
+                                                      width, height))
+            {
+              CLUTTER_NOTE (ACTOR,
+                            "ClutterText: %p: unwrapped layout fits "
+                            "the given width",
+                            text);
+
+              return priv->cached_layouts + i;
+            }
+
 	  if (!found_free_cache &&
 	      (priv->cached_layouts[i].age < oldest_cache->age))
 	    {
@@ -710,26 +1897,506 @@ clutter_text_create_layout (ClutterText *text,
         }
     }
 
-  CLUTTER_NOTE (ACTOR, "ClutterText: %p: cache miss for size %.2fx%.2f",
-		text,
-                allocation_width,
-                allocation_height);
+  if (oldest_cache_p != NULL)
+    *oldest_cache_p = oldest_cache;
+
+  return NULL;
+}
+
+/*
+ * clutter_text_create_layout:
+ * @text: a #ClutterText
+ * @allocation_width: the allocation width
+ * @allocation_height: the allocation height
+ *
+ * Like clutter_text_create_layout_no_cache(), but will also ensure
+ * the glyphs cache. If a previously cached layout generated using the
+ * same width is available then that will be used instead of
+ * generating a new one.
+ */
+static PangoLayout *
+clutter_text_create_layout (ClutterText *text,
+                            gfloat       allocation_width,
+                            gfloat       allocation_height)
+{
+  ClutterTextPrivate *priv = text->priv;
+  LayoutCache *oldest_cache, *cached;
+  gint width, height;
+  PangoEllipsizeMode ellipsize;
+  gchar *shared_key;
+
+  CLUTTER_STATIC_COUNTER (text_cache_hit_counter,
+                          "Text layout cache hit counter",
+                          "Increments for each layout cache hit",
+                          0);
+  CLUTTER_STATIC_COUNTER (text_cache_miss_counter,
+                          "Text layout cache miss counter",
+                          "Increments for each layout cache miss",
+                          0);
+  CLUTTER_STATIC_COUNTER (text_shared_cache_hit_counter,
+                          "Text shared layout cache hit counter",
+                          "Increments for each shared layout cache hit",
+                          0);
+  CLUTTER_STATIC_COUNTER (text_shared_cache_miss_counter,
+                          "Text shared layout cache miss counter",
+                          "Increments for each shared layout cache miss",
+                          0);
+
+  clutter_text_get_layout_params (text,
+                                  allocation_width,
+                                  allocation_height,
+                                  &width, &height,
+                                  &ellipsize);
+
+  /* Search for a cached layout with the same width and keep
+   * track of the oldest one
+   */
+  cached = clutter_text_lookup_cached_layout (text, allocation_height,
+                                              width, height,
+                                              ellipsize,
+                                              &oldest_cache);
+  if (cached != NULL)
+    {
+      CLUTTER_NOTE (ACTOR,
+                    "ClutterText: %p: cache hit for size %.2fx%.2f",
+                    text,
+                    allocation_width,
+                    allocation_height);
+
+      CLUTTER_COUNTER_INC (_clutter_uprof_context, text_cache_hit_counter);
+
+      return cached->layout;
+    }
+
+  CLUTTER_NOTE (ACTOR, "ClutterText: %p: cache miss for size %.2fx%.2f",
+		text,
+                allocation_width,
+                allocation_height);
+
+  CLUTTER_COUNTER_INC (_clutter_uprof_context, text_cache_miss_counter);
+
+  if (clutter_text_should_layout_async (text))
+    {
+      PangoLayout *layout;
+
+      layout = clutter_text_get_async_layout (text, width, height, ellipsize);
+      if (layout == NULL)
+        return clutter_text_get_provisional_layout (text, width, height,
+                                                    ellipsize);
+
+      if (oldest_cache->layout)
+        g_object_unref (oldest_cache->layout);
+
+      oldest_cache->layout = layout;
+      clutter_text_ensure_glyph_cache (oldest_cache->layout);
+
+      oldest_cache->age = priv->cache_age++;
+      return oldest_cache->layout;
+    }
+
+  /* If we make it here then we didn't have a cached version so we
+     need to recreate the layout */
+  if (oldest_cache->layout)
+    g_object_unref (oldest_cache->layout);
+
+  shared_key = clutter_text_get_shared_layout_key (text, width, height,
+                                                   ellipsize);
+
+  if (shared_key != NULL)
+    oldest_cache->layout = clutter_text_lookup_shared_layout (shared_key);
+  else
+    oldest_cache->layout = NULL;
+
+  if (oldest_cache->layout != NULL)
+    {
+      CLUTTER_NOTE (ACTOR, "ClutterText: %p: shared cache hit", text);
+
+      CLUTTER_COUNTER_INC (_clutter_uprof_context,
+                           text_shared_cache_hit_counter);
+
+      g_free (shared_key);
+    }
+  else
+    {
+      oldest_cache->layout =
+        clutter_text_create_layout_no_cache (text, width, height, ellipsize);
+
+      clutter_text_ensure_glyph_cache (oldest_cache->layout);
+
+      if (shared_key != NULL)
+        {
+          CLUTTER_COUNTER_INC (_clutter_uprof_context,
+                               text_shared_cache_miss_counter);
+
+          clutter_text_insert_shared_layout (shared_key, oldest_cache->layout);
+        }
+    }
+
+  /* Mark the 'time' this cache was created and advance the time */
+  oldest_cache->age = priv->cache_age++;
+  return oldest_cache->layout;
+}
+
+/* A batch of layouts created by _clutter_text_prefetch_layouts(). The
+ * jobs of a batch are shaped concurrently by a pool of worker threads,
+ * each one using its own font map, while the main thread waits for the
+ * whole batch to be done
+ */
+struct _PrefetchBatch
+{
+  GMutex *mutex;
+  GCond *cond;
+
+  guint n_pending;
+};
+
+static GThreadPool   *prefetch_pool = NULL;
+static GStaticPrivate prefetch_font_map = G_STATIC_PRIVATE_INIT;
+
+static void
+clutter_text_prefetch_thread_func (gpointer data,
+                                   gpointer pool_data)
+{
+  AsyncLayout *job = data;
+  PrefetchBatch *batch = job->batch;
+  CoglPangoFontMap *font_map;
+
+  font_map = g_static_private_get (&prefetch_font_map);
+  if (font_map == NULL)
+    {
+      font_map = COGL_PANGO_FONT_MAP (cogl_pango_font_map_new ());
+      g_static_private_set (&prefetch_font_map, font_map, g_object_unref);
+    }
+
+  clutter_text_shape_layout_job (job, font_map);
+
+  g_mutex_lock (batch->mutex);
+
+  batch->n_pending -= 1;
+  if (batch->n_pending == 0)
+    g_cond_signal (batch->cond);
+
+  g_mutex_unlock (batch->mutex);
+}
+
+/*< private >
+ * _clutter_text_get_n_cached_layouts:
+ * @text: a #ClutterText
+ *
+ * Retrieves the number of layouts currently cached by @text.
+ *
+ * Return value: the number of cached layouts
+ */
+guint
+_clutter_text_get_n_cached_layouts (ClutterText *text)
+{
+  ClutterTextPrivate *priv = text->priv;
+  guint i, n_layouts = 0;
+
+  for (i = 0; i < N_CACHED_LAYOUTS; i++)
+    {
+      if (priv->cached_layouts[i].layout != NULL)
+        n_layouts += 1;
+    }
+
+  return n_layouts;
+}
+
+/*< private >
+ * _clutter_text_get_n_chars:
+ * @text: a #ClutterText
+ *
+ * Retrieves the length of the contents of @text, in characters,
+ * without walking them.
+ *
+ * Return value: the number of characters
+ */
+gint
+_clutter_text_get_n_chars (ClutterText *text)
+{
+  return text->priv->n_chars;
+}
+
+/*< private >
+ * _clutter_text_offset_to_index:
+ * @text: a #ClutterText
+ * @offset: a character offset, or -1 for the end of the text
+ *
+ * Converts @offset to a byte index inside the string returned by
+ * clutter_text_get_text(). Consecutive conversions of nearby offsets
+ * only walk the characters between them.
+ *
+ * Return value: the byte index
+ */
+gint
+_clutter_text_offset_to_index (ClutterText *text,
+                               gint         offset)
+{
+  return clutter_text_offset_to_index (text, offset);
+}
+
+/*< private >
+ * _clutter_text_index_to_offset:
+ * @text: a #ClutterText
+ * @index_: a byte index inside the text, or -1 for the end of the text
+ *
+ * Converts @index_ to a character offset; see
+ * _clutter_text_offset_to_index().
+ *
+ * Return value: the character offset
+ */
+gint
+_clutter_text_index_to_offset (ClutterText *text,
+                               gint         index_)
+{
+  return clutter_text_index_to_offset (text, index_);
+}
+
+/* creates the job shaping the layout that @text needs to answer a
+ * request for its preferred height for @for_width, or for its preferred
+ * width if @for_width is negative; returns %NULL if the layout is not
+ * worth prefetching, or if it has already been created
+ */
+static AsyncLayout *
+clutter_text_new_prefetch_job (ClutterText *text,
+                               gfloat       for_width)
+{
+  ClutterTextPrivate *priv = text->priv;
+  PangoEllipsizeMode ellipsize;
+  gint width, height;
+  gchar *shared_key;
+
+  /* the editable texts are measured using their paragraph metrics,
+   * and the asynchronous texts are shaped in the background anyway
+   */
+  if (priv->editable ||
+      priv->n_bytes < PREFETCH_MIN_BYTES ||
+      clutter_text_should_layout_async (text))
+    return NULL;
+
+  /* see clutter_text_get_preferred_height() */
+  clutter_text_get_layout_params (text,
+                                  priv->single_line_mode ? -1 : for_width,
+                                  -1,
+                                  &width, &height,
+                                  &ellipsize);
+
+  if (clutter_text_lookup_cached_layout (text, -1,
+                                         width, height,
+                                         ellipsize,
+                                         NULL) != NULL)
+    return NULL;
+
+  shared_key = clutter_text_get_shared_layout_key (text, width, height,
+                                                   ellipsize);
+  if (shared_key != NULL)
+    {
+      PangoLayout *shared = clutter_text_lookup_shared_layout (shared_key);
+
+      g_free (shared_key);
+
+      if (shared != NULL)
+        {
+          g_object_unref (shared);
+          return NULL;
+        }
+    }
+
+  return clutter_text_new_layout_job (text, width, height, ellipsize);
+}
+
+/* shapes the @n_jobs layouts of @jobs using the worker threads, waits
+ * for all of them and moves them inside the cache of their actor; the
+ * jobs are freed
+ */
+static void
+clutter_text_run_prefetch_jobs (GSList *jobs,
+                                guint   n_jobs)
+{
+  PrefetchBatch batch;
+  GSList *j;
+
+  /* a single layout is shaped faster by the main thread */
+  if (n_jobs < 2)
+    {
+      g_slist_foreach (jobs, (GFunc) async_layout_free, NULL);
+      g_slist_free (jobs);
+      return;
+    }
+
+  CLUTTER_NOTE (ACTOR, "Prefetching %u text layouts", n_jobs);
+
+  if (prefetch_pool == NULL)
+    /* This apparently can't fail if exclusive == FALSE */
+    prefetch_pool =
+      g_thread_pool_new (clutter_text_prefetch_thread_func,
+                         NULL, PREFETCH_MAX_THREADS, FALSE, NULL);
+
+  batch.mutex = g_mutex_new ();
+  batch.cond = g_cond_new ();
+  batch.n_pending = n_jobs;
+
+  for (j = jobs; j != NULL; j = j->next)
+    {
+      AsyncLayout *job = j->data;
+
+      job->batch = &batch;
+      g_thread_pool_push (prefetch_pool, job, NULL);
+    }
+
+  g_mutex_lock (batch.mutex);
+
+  while (batch.n_pending > 0)
+    g_cond_wait (batch.cond, batch.mutex);
+
+  g_mutex_unlock (batch.mutex);
+
+  g_cond_free (batch.cond);
+  g_mutex_free (batch.mutex);
+
+  /* move the layouts inside the cache of each actor */
+  for (j = jobs; j != NULL; j = j->next)
+    {
+      AsyncLayout *job = j->data;
+      ClutterTextPrivate *priv = job->text->priv;
+      LayoutCache *oldest_cache = NULL;
+      gchar *shared_key;
+
+      clutter_text_lookup_cached_layout (job->text, -1,
+                                         job->width, job->height,
+                                         job->ellipsize,
+                                         &oldest_cache);
+
+      if (oldest_cache->layout)
+        g_object_unref (oldest_cache->layout);
+
+      oldest_cache->layout = job->layout;
+      job->layout = NULL;
+
+      clutter_text_ensure_glyph_cache (oldest_cache->layout);
+      oldest_cache->age = priv->cache_age++;
+
+      shared_key = clutter_text_get_shared_layout_key (job->text,
+                                                       job->width,
+                                                       job->height,
+                                                       job->ellipsize);
+      if (shared_key != NULL)
+        {
+          PangoLayout *shared = clutter_text_lookup_shared_layout (shared_key);
+
+          /* another text of the batch might have the same key */
+          if (shared == NULL)
+            clutter_text_insert_shared_layout (shared_key,
+                                               oldest_cache->layout);
+          else
+            {
+              g_object_unref (shared);
+              g_free (shared_key);
+            }
+        }
+
+      async_layout_free (job);
+    }
+
+  g_slist_free (jobs);
+}
+
+/*< private >
+ * _clutter_text_prefetch_layouts:
+ * @container: a #ClutterContainer
+ * @for_width: the width the actors are going to be measured for,
+ *   or -1
+ *
+ * Creates the layouts that the #ClutterText children of @container
+ * need to answer a request for their preferred height for @for_width,
+ * or for their preferred width if @for_width is negative; the other
+ * actors are ignored.
+ *
+ * The layouts are shaped concurrently by a pool of worker threads, and
+ * this function blocks until all of them are ready, so that the size
+ * requests that follow are answered from the layout cache of each
+ * actor. Layout managers can call this function before measuring
+ * their children.
+ */
+void
+_clutter_text_prefetch_layouts (ClutterContainer *container,
+                                gfloat            for_width)
+{
+  ClutterContainerIter iter;
+  ClutterActor *child;
+  GSList *jobs;
+  guint n_jobs;
+
+  /* a text measured for a zero width does not create a layout */
+  if (for_width == 0 || !g_thread_supported ())
+    return;
+
+  jobs = NULL;
+  n_jobs = 0;
+
+  clutter_container_iter_init (&iter, container);
+  while (clutter_container_iter_next (&iter, &child))
+    {
+      AsyncLayout *job;
+
+      if (!CLUTTER_IS_TEXT (child) || !CLUTTER_ACTOR_IS_VISIBLE (child))
+        continue;
+
+      job = clutter_text_new_prefetch_job (CLUTTER_TEXT (child), for_width);
+      if (job == NULL)
+        continue;
+
+      jobs = g_slist_prepend (jobs, job);
+      n_jobs += 1;
+    }
+
+  clutter_text_run_prefetch_jobs (jobs, n_jobs);
+}
+
+/*< private >
+ * _clutter_text_prefetch_mapped_layouts:
+ * @texts: (element-type ClutterText): a list of #ClutterText
+ *
+ * Creates the layouts that the #ClutterText actors in @texts that are
+ * still mapped need to answer a request for their preferred width,
+ * which is the first request a text receives when it is laid out for
+ * the first time, and that the texts which do not wrap also use to
+ * paint themselves.
+ *
+ * Like _clutter_text_prefetch_layouts(), the layouts are shaped
+ * concurrently by a pool of worker threads, and this function blocks
+ * until all of them are ready. The stage calls this function before
+ * allocating the actors that have been mapped since the last relayout.
+ */
+void
+_clutter_text_prefetch_mapped_layouts (GSList *texts)
+{
+  GSList *l, *jobs;
+  guint n_jobs;
+
+  if (!g_thread_supported ())
+    return;
 
-  CLUTTER_COUNTER_INC (_clutter_uprof_context, text_cache_miss_counter);
+  jobs = NULL;
+  n_jobs = 0;
 
-  /* If we make it here then we didn't have a cached version so we
-     need to recreate the layout */
-  if (oldest_cache->layout)
-    g_object_unref (oldest_cache->layout);
+  for (l = texts; l != NULL; l = l->next)
+    {
+      ClutterText *text = l->data;
+      AsyncLayout *job;
 
-  oldest_cache->layout =
-    clutter_text_create_layout_no_cache (text, width, height, ellipsize);
+      if (!CLUTTER_ACTOR_IS_MAPPED (text))
+        continue;
 
-  cogl_pango_ensure_glyph_cache_for_layout (oldest_cache->layout);
+      job = clutter_text_new_prefetch_job (text, -1);
+      if (job == NULL)
+        continue;
 
-  /* Mark the 'time' this cache was created and advance the time */
-  oldest_cache->age = priv->cache_age++;
-  return oldest_cache->layout;
+      jobs = g_slist_prepend (jobs, job);
+      n_jobs += 1;
+    }
+
+  clutter_text_run_prefetch_jobs (jobs, n_jobs);
 }
 
 static gint
@@ -814,6 +2481,11 @@ clutter_text_position_to_coords (ClutterText *self,
     {
       index_ = 0;
     }
+  else if (priv->password_char != 0)
+    {
+      /* every character of the masked text has the same length */
+      index_ = position * password_char_bytes;
+    }
   else
     {
       gchar *text = clutter_text_get_display_text (self);
@@ -825,10 +2497,7 @@ clutter_text_position_to_coords (ClutterText *self,
       if (priv->preedit_str != NULL)
         g_string_insert (tmp, cursor_index, priv->preedit_str);
 
-      if (priv->password_char == 0)
-        index_ = offset_to_bytes (tmp->str, position);
-      else
-        index_ = position * password_char_bytes;
+      index_ = offset_to_bytes (tmp->str, position);
 
       g_free (text);
       g_string_free (tmp, TRUE);
@@ -982,6 +2651,10 @@ clutter_text_set_text_internal (ClutterText *self,
                                 const gchar *text)
 {
   ClutterTextPrivate *priv = self->priv;
+  gchar *old_text = priv->text;
+  gint old_len = priv->n_bytes;
+  GArray *paragraphs = NULL;
+  GSList *previous_layouts;
 
   g_object_freeze_notify (G_OBJECT (self));
 
@@ -991,8 +2664,6 @@ clutter_text_set_text_internal (ClutterText *self,
 
       if (len < priv->max_length)
         {
-           g_free (priv->text);
-
            priv->text = g_strdup (text);
            priv->n_bytes = strlen (text);
            priv->n_chars = len;
@@ -1002,8 +2673,6 @@ clutter_text_set_text_internal (ClutterText *self,
           gchar *p = g_utf8_offset_to_pointer (text, priv->max_length);
           gchar *n = g_malloc0 ((p - text) + 1);
 
-          g_free (priv->text);
-
           g_utf8_strncpy (n, text, priv->max_length);
 
           priv->text = n;
@@ -1013,18 +2682,51 @@ clutter_text_set_text_internal (ClutterText *self,
     }
   else
     {
-      g_free (priv->text);
-
       priv->text = g_strdup (text);
       priv->n_bytes = strlen (text);
       priv->n_chars = g_utf8_strlen (text, -1);
     }
 
+  priv->last_offset = 0;
+  priv->last_index = 0;
+
   if (priv->n_bytes == 0)
     clutter_text_set_positions (self, -1, -1);
 
+  if (priv->paragraphs != NULL && old_text != NULL)
+    {
+      gint prefix = 0, suffix = 0;
+
+      /* find the bytes that were changed */
+      while (prefix < old_len && prefix < priv->n_bytes &&
+             old_text[prefix] == priv->text[prefix])
+        prefix += 1;
+
+      while (suffix < old_len - prefix && suffix < priv->n_bytes - prefix &&
+             old_text[old_len - suffix - 1] == priv->text[priv->n_bytes - suffix - 1])
+        suffix += 1;
+
+      /* the unchanged bytes after the edit must start a character */
+      while (suffix > 0 && (old_text[old_len - suffix] & 0xc0) == 0x80)
+        suffix -= 1;
+
+      paragraphs = paragraph_metrics_edit (priv->paragraphs,
+                                           priv->text,
+                                           old_len,
+                                           priv->n_bytes,
+                                           prefix,
+                                           suffix);
+    }
+
+  previous_layouts = clutter_text_get_previous_layouts (self);
+
   clutter_text_dirty_cache (self);
 
+  priv->previous_layouts = previous_layouts;
+  priv->paragraphs = paragraphs;
+
+  g_free (old_text);
+
   clutter_actor_queue_relayout (CLUTTER_ACTOR (self));
 
   g_signal_emit (self, text_signals[TEXT_CHANGED], 0);
@@ -1199,6 +2901,14 @@ clutter_text_set_property (GObject      *gobject,
       clutter_text_set_selected_text_color (self, clutter_value_get_color (value));
       break;
 
+    case PROP_LAYOUT_ASYNC:
+      clutter_text_set_layout_async (self, g_value_get_boolean (value));
+      break;
+
+    case PROP_USE_DISTANCE_FIELD:
+      clutter_text_set_use_distance_field (self, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
     }
@@ -1322,6 +3032,14 @@ clutter_text_get_property (GObject    *gobject,
       g_value_set_boolean (value, priv->selected_text_color_set);
       break;
 
+    case PROP_LAYOUT_ASYNC:
+      g_value_set_boolean (value, priv->layout_async);
+      break;
+
+    case PROP_USE_DISTANCE_FIELD:
+      g_value_set_boolean (value, priv->use_distance_field);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
     }
@@ -1349,6 +3067,12 @@ clutter_text_dispose (GObject *gobject)
       priv->font_changed_id = 0;
     }
 
+  if (priv->font_change_link != NULL)
+    {
+      g_queue_delete_link (&font_change_queue, priv->font_change_link);
+      priv->font_change_link = NULL;
+    }
+
   G_OBJECT_CLASS (clutter_text_parent_class)->dispose (gobject);
 }
 
@@ -1373,6 +3097,9 @@ clutter_text_finalize (GObject *gobject)
   g_free (priv->text);
   g_free (priv->font_name);
 
+  if (priv->password_text != NULL)
+    g_string_free (priv->password_text, TRUE);
+
   G_OBJECT_CLASS (clutter_text_parent_class)->finalize (gobject);
 }
 
@@ -1819,7 +3546,7 @@ clutter_text_key_press (ClutterActor    *actor,
    * key bindings; subclasses will override or chain up this
    * event handler, so they can do whatever they want there
    */
-  pool = clutter_binding_pool_find (g_type_name (CLUTTER_TYPE_TEXT));
+  pool = text_binding_pool;
   g_assert (pool != NULL);
 
   /* we allow passing synthetic events that only contain
@@ -1869,6 +3596,197 @@ clutter_text_key_press (ClutterActor    *actor,
 
 #define TEXT_PADDING    2
 
+/* queues a redraw of the area of @self between the cursor positions
+ * @start and @end: the selection between them, and the cursor at
+ * either of them. Moving the cursor or the selection bound, and
+ * blinking the cursor, only change that area */
+static void
+clutter_text_queue_redraw_span (ClutterText *self,
+                                gint         start,
+                                gint         end)
+{
+  ClutterTextPrivate *priv = self->priv;
+  ClutterActor *actor = CLUTTER_ACTOR (self);
+  ClutterActorBox alloc = { 0, };
+  ClutterPaintVolume volume;
+  ClutterVertex origin;
+  gfloat x_1, y_1, height_1;
+  gfloat x_2, y_2, height_2;
+  gfloat x1, x2;
+
+  /* the pre-edit string moves the text after the cursor, and the
+   * layout might not match the allocation yet */
+  if (priv->preedit_set || !clutter_actor_has_allocation (actor))
+    goto full_redraw;
+
+  clutter_actor_get_allocation_box (actor, &alloc);
+
+  /* moving the cursor scrolls a single line that does not fit */
+  if (priv->editable && priv->single_line_mode)
+    {
+      PangoRectangle logical_rect = { 0, };
+
+      pango_layout_get_extents (clutter_text_get_layout (self),
+                                NULL,
+                                &logical_rect);
+
+      if (logical_rect.width / PANGO_SCALE >
+          (alloc.x2 - alloc.x1) - 2 * TEXT_PADDING)
+        goto full_redraw;
+    }
+
+  if (!clutter_text_position_to_coords (self, start, &x_1, &y_1, &height_1) ||
+      !clutter_text_position_to_coords (self, end, &x_2, &y_2, &height_2))
+    goto full_redraw;
+
+  /* a span over more than one line covers the whole width of the
+   * lines in between; the cursor can be painted on either side of
+   * its position */
+  if (y_1 == y_2)
+    {
+      x1 = MIN (x_1, x_2) - priv->cursor_size;
+      x2 = MAX (x_1, x_2) + 2 * priv->cursor_size;
+    }
+  else
+    {
+      x1 = 0;
+      x2 = alloc.x2 - alloc.x1;
+    }
+
+  _clutter_paint_volume_init_static (&volume, actor);
+
+  origin.x = floorf (x1);
+  origin.y = floorf (MIN (y_1, y_2));
+  origin.z = 0;
+  clutter_paint_volume_set_origin (&volume, &origin);
+  clutter_paint_volume_set_width (&volume, ceilf (x2) - origin.x);
+  clutter_paint_volume_set_height (&volume,
+                                   ceilf (MAX (y_1 + height_1,
+                                               y_2 + height_2))
+                                   - origin.y);
+
+  _clutter_actor_queue_redraw_with_clip (actor, 0, &volume);
+
+  clutter_paint_volume_free (&volume);
+
+  return;
+
+full_redraw:
+  clutter_actor_queue_redraw (actor);
+}
+
+/* computes the range of the vertical coordinates of @self that can
+ * end up on the stage, given its clip, the clips of its ancestors and
+ * the area of the stage being redrawn. Returns %FALSE if the whole
+ * actor has to be painted */
+static gboolean
+clutter_text_get_visible_range (ClutterText *self,
+                                gfloat      *y_1,
+                                gfloat      *y_2)
+{
+  ClutterActor *actor = CLUTTER_ACTOR (self);
+  ClutterActor *stage;
+  ClutterActorBox visible;
+  ClutterGeometry clip;
+  gfloat clip_y_1 = 0, clip_y_2 = 0;
+  gint i;
+
+  stage = clutter_actor_get_stage (actor);
+  if (stage == NULL)
+    return FALSE;
+
+  /* clones and offscreen redirections paint the actor somewhere else */
+  if (clutter_actor_is_in_clone_paint (actor) ||
+      cogl_get_draw_framebuffer () !=
+        _clutter_stage_get_active_framebuffer (CLUTTER_STAGE (stage)))
+    return FALSE;
+
+  if (!_clutter_actor_get_visible_box (actor, &visible))
+    return FALSE;
+
+  /* a clipped redraw, like the one queued by a blinking cursor, only
+   * needs the lines inside the redrawn area */
+  _clutter_stage_get_clip_geometry (CLUTTER_STAGE (stage), &clip);
+
+  for (i = 0; i < 4; i++)
+    {
+      gfloat x, y;
+
+      if (!clutter_actor_transform_stage_point (actor,
+                                                clip.x + (i % 2) * clip.width,
+                                                clip.y + (i / 2) * clip.height,
+                                                &x, &y))
+        return FALSE;
+
+      if (i == 0 || y < clip_y_1) clip_y_1 = y;
+      if (i == 0 || y > clip_y_2) clip_y_2 = y;
+    }
+
+  visible.y1 = MAX (visible.y1, clip_y_1);
+  visible.y2 = MIN (visible.y2, clip_y_2);
+
+  *y_1 = visible.y1;
+  *y_2 = visible.y2;
+
+  return TRUE;
+}
+
+/* paints only the lines of @layout that intersect the visible range
+ * of @self; returns %FALSE if the whole layout should be painted */
+static gboolean
+clutter_text_paint_visible_lines (ClutterText     *self,
+                                  PangoLayout     *layout,
+                                  gint             text_x,
+                                  const CoglColor *color)
+{
+  PangoLayoutIter *iter;
+  gfloat y_1, y_2;
+  gint top, bottom;
+  gint n_painted = 0;
+
+  if (pango_layout_get_line_count (layout) <= VISIBLE_LINES_MIN_LINES)
+    return FALSE;
+
+  if (!clutter_text_get_visible_range (self, &y_1, &y_2))
+    return FALSE;
+
+  top = floorf (y_1) * PANGO_SCALE;
+  bottom = ceilf (y_2) * PANGO_SCALE;
+
+  iter = pango_layout_get_iter (layout);
+
+  do
+    {
+      PangoRectangle logical_rect;
+      gint line_y1, line_y2;
+
+      pango_layout_iter_get_line_yrange (iter, &line_y1, &line_y2);
+
+      if (line_y2 < top)
+        continue;
+
+      if (line_y1 > bottom)
+        break;
+
+      pango_layout_iter_get_line_extents (iter, NULL, &logical_rect);
+
+      cogl_pango_render_layout_line (pango_layout_iter_get_line_readonly (iter),
+                                     text_x * PANGO_SCALE + logical_rect.x,
+                                     pango_layout_iter_get_baseline (iter),
+                                     color);
+      n_painted += 1;
+    }
+  while (pango_layout_iter_next_line (iter));
+
+  pango_layout_iter_free (iter);
+
+  CLUTTER_NOTE (PAINT, "painted %d lines out of %d",
+                n_painted,
+                pango_layout_get_line_count (layout));
+
+  return TRUE;
+}
+
 static void
 clutter_text_paint (ClutterActor *self)
 {
@@ -1966,7 +3884,24 @@ clutter_text_paint (ClutterActor *self)
                             priv->text_color.green,
                             priv->text_color.blue,
                             real_opacity);
-  cogl_pango_render_layout (layout, text_x, 0, &color, 0);
+  if (priv->use_distance_field && _clutter_sdf_glyphs_supported ())
+    {
+      gfloat transformed_width, transformed_height;
+      gfloat scale = 1.f;
+
+      /* the outlines are kept sharp for the size on the screen */
+      clutter_actor_get_transformed_size (self,
+                                          &transformed_width,
+                                          &transformed_height);
+
+      if (alloc.x2 > alloc.x1 && alloc.y2 > alloc.y1)
+        scale = sqrtf ((transformed_width * transformed_height)
+                       / ((alloc.x2 - alloc.x1) * (alloc.y2 - alloc.y1)));
+
+      _clutter_sdf_glyphs_render_layout (layout, text_x, 0, &color, scale);
+    }
+  else if (!clutter_text_paint_visible_lines (text, layout, text_x, &color))
+    cogl_pango_render_layout (layout, text_x, 0, &color, 0);
 
   selection_paint (text);
 
@@ -1997,15 +3932,20 @@ clutter_text_get_preferred_width (ClutterActor *self,
   gint logical_width;
   gfloat layout_width;
 
-  layout = clutter_text_create_layout (text, -1, -1);
+  if (clutter_text_use_paragraph_metrics (text))
+    clutter_text_get_paragraph_extents (text, -1, &logical_width, NULL);
+  else
+    {
+      layout = clutter_text_create_layout (text, -1, -1);
 
-  pango_layout_get_extents (layout, NULL, &logical_rect);
+      pango_layout_get_extents (layout, NULL, &logical_rect);
 
-  /* the X coordinate of the logical rectangle might be non-zero
-   * according to the Pango documentation; hence, we need to offset
-   * the width accordingly
-   */
-  logical_width = logical_rect.x + logical_rect.width;
+      /* the X coordinate of the logical rectangle might be non-zero
+       * according to the Pango documentation; hence, we need to offset
+       * the width accordingly
+       */
+      logical_width = logical_rect.x + logical_rect.width;
+    }
 
   layout_width = logical_width > 0
     ? ceilf (logical_width / 1024.0f)
@@ -2054,6 +3994,25 @@ clutter_text_get_preferred_height (ClutterActor *self,
       if (priv->single_line_mode)
         for_width = -1;
 
+      if (clutter_text_use_paragraph_metrics (CLUTTER_TEXT (self)) &&
+          !(priv->ellipsize && priv->wrap))
+        {
+          gint width = for_width >= 0 ? for_width * 1024 + 0.5f : -1;
+
+          clutter_text_get_paragraph_extents (CLUTTER_TEXT (self), width,
+                                              NULL,
+                                              &logical_height);
+          layout_height = ceilf (logical_height / 1024.0f);
+
+          if (min_height_p)
+            *min_height_p = layout_height;
+
+          if (natural_height_p)
+            *natural_height_p = layout_height;
+
+          return;
+        }
+
       layout = clutter_text_create_layout (CLUTTER_TEXT (self),
                                            for_width, -1);
 
@@ -2129,6 +4088,32 @@ clutter_text_has_overlaps (ClutterActor *self)
          priv->cursor_visible;
 }
 
+static void
+clutter_text_map (ClutterActor *self)
+{
+  ClutterTextPrivate *priv = CLUTTER_TEXT (self)->priv;
+  ClutterActor *stage;
+
+  CLUTTER_ACTOR_CLASS (clutter_text_parent_class)->map (self);
+
+  /* the change of the font settings queues the prefetch itself */
+  if (priv->font_change_pending)
+    {
+      clutter_text_apply_font_change (CLUTTER_TEXT (self));
+      return;
+    }
+
+  /* the layouts of the texts mapped before the next relayout of the
+   * stage are shaped together, see _clutter_stage_maybe_relayout()
+   */
+  if (priv->editable || priv->n_bytes < PREFETCH_MIN_BYTES)
+    return;
+
+  stage = _clutter_actor_get_stage_internal (self);
+  if (stage != NULL)
+    _clutter_stage_queue_text_prefetch (CLUTTER_STAGE (stage), self);
+}
+
 static void
 clutter_text_key_focus_in (ClutterActor *actor)
 {
@@ -2136,7 +4121,10 @@ clutter_text_key_focus_in (ClutterActor *actor)
 
   priv->has_focus = TRUE;
 
-  clutter_actor_queue_redraw (actor);
+  /* only the cursor and the selection depend on the focus */
+  clutter_text_queue_redraw_span (CLUTTER_TEXT (actor),
+                                  priv->position,
+                                  priv->selection_bound);
 }
 
 static void
@@ -2146,7 +4134,9 @@ clutter_text_key_focus_out (ClutterActor *actor)
 
   priv->has_focus = FALSE;
 
-  clutter_actor_queue_redraw (actor);
+  clutter_text_queue_redraw_span (CLUTTER_TEXT (actor),
+                                  priv->position,
+                                  priv->selection_bound);
 }
 
 static gboolean
@@ -2600,6 +4590,7 @@ clutter_text_class_init (ClutterTextClass *klass)
   actor_class->key_focus_in = clutter_text_key_focus_in;
   actor_class->key_focus_out = clutter_text_key_focus_out;
   actor_class->has_overlaps = clutter_text_has_overlaps;
+  actor_class->map = clutter_text_map;
 
   /**
    * ClutterText:font-name:
@@ -3047,6 +5038,42 @@ clutter_text_class_init (ClutterTextClass *klass)
   obj_props[PROP_SELECTED_TEXT_COLOR_SET] = pspec;
   g_object_class_install_property (gobject_class, PROP_SELECTED_TEXT_COLOR_SET, pspec);
 
+  /**
+   * ClutterText:layout-async:
+   *
+   * Whether the layout of long texts should be created from a worker
+   * thread, instead of blocking the main loop.
+   *
+   * See clutter_text_set_layout_async().
+   *
+   * Since: 1.8
+   */
+  pspec = g_param_spec_boolean ("layout-async",
+                                P_("Layout Async"),
+                                P_("Whether long texts should be laid out in a separate thread"),
+                                FALSE,
+                                CLUTTER_PARAM_READWRITE);
+  obj_props[PROP_LAYOUT_ASYNC] = pspec;
+  g_object_class_install_property (gobject_class, PROP_LAYOUT_ASYNC, pspec);
+
+  /**
+   * ClutterText:use-distance-field:
+   *
+   * Whether the glyphs should be drawn using signed distance fields,
+   * which keep them sharp at any scale.
+   *
+   * See clutter_text_set_use_distance_field().
+   *
+   * Since: 1.8
+   */
+  pspec = g_param_spec_boolean ("use-distance-field",
+                                P_("Use Distance Field"),
+                                P_("Whether the glyphs should be drawn using distance fields"),
+                                FALSE,
+                                CLUTTER_PARAM_READWRITE);
+  obj_props[PROP_USE_DISTANCE_FIELD] = pspec;
+  g_object_class_install_property (gobject_class, PROP_USE_DISTANCE_FIELD, pspec);
+
   /**
    * ClutterText::text-changed:
    * @self: the #ClutterText that emitted the signal
@@ -3156,6 +5183,7 @@ clutter_text_class_init (ClutterTextClass *klass)
                   G_TYPE_NONE, 0);
 
   binding_pool = clutter_binding_pool_get_for_class (klass);
+  text_binding_pool = binding_pool;
 
   clutter_text_add_move_binding (binding_pool, "move-left",
                                  CLUTTER_KEY_Left, CLUTTER_CONTROL_MASK,
@@ -3419,7 +5447,12 @@ clutter_text_set_editable (ClutterText *self,
     {
       priv->editable = editable;
 
-      clutter_actor_queue_redraw (CLUTTER_ACTOR (self));
+      /* editable actors ignore the attributes and the ellipsization,
+       * and they don't use the shared layouts */
+      clutter_text_dirty_cache (self);
+
+      /* editable actors might overlap the cursor with the text */
+      clutter_actor_notify_overlaps_changed (CLUTTER_ACTOR (self));
 
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_EDITABLE]);
     }
@@ -3469,7 +5502,7 @@ clutter_text_set_selectable (ClutterText *self,
     {
       priv->selectable = selectable;
 
-      clutter_actor_queue_redraw (CLUTTER_ACTOR (self));
+      clutter_actor_notify_overlaps_changed (CLUTTER_ACTOR (self));
 
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_SELECTABLE]);
     }
@@ -3614,7 +5647,14 @@ clutter_text_set_cursor_visible (ClutterText *self,
     {
       priv->cursor_visible = cursor_visible;
 
-      clutter_actor_queue_redraw (CLUTTER_ACTOR (self));
+      /* the cursor is only painted on editable texts, which have
+       * overlaps regardless of its visibility */
+      if (priv->editable)
+        clutter_text_queue_redraw_span (self,
+                                        priv->position,
+                                        priv->position);
+      else
+        clutter_actor_notify_overlaps_changed (CLUTTER_ACTOR (self));
 
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_CURSOR_VISIBLE]);
     }
@@ -3803,6 +5843,7 @@ clutter_text_set_selection_bound (ClutterText *self,
 
   if (priv->selection_bound != selection_bound)
     {
+      gint old_bound = priv->selection_bound;
       gint len = priv->n_chars;
 
       if (selection_bound < 0 || selection_bound >= len)
@@ -3810,7 +5851,10 @@ clutter_text_set_selection_bound (ClutterText *self,
       else
         priv->selection_bound = selection_bound;
 
-      clutter_actor_queue_redraw (CLUTTER_ACTOR (self));
+      /* only the selection between the old and the new bound changed */
+      clutter_text_queue_redraw_span (self,
+                                      old_bound,
+                                      priv->selection_bound);
 
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_SELECTION_BOUND]);
     }
@@ -4724,6 +6768,7 @@ clutter_text_set_cursor_position (ClutterText *self,
                                   gint         position)
 {
   ClutterTextPrivate *priv;
+  gint old_position;
   gint len;
 
   g_return_if_fail (CLUTTER_IS_TEXT (self));
@@ -4733,6 +6778,7 @@ clutter_text_set_cursor_position (ClutterText *self,
   if (priv->position == position)
     return;
 
+  old_position = priv->position;
   len = priv->n_chars;
 
   if (position < 0 || position >= len)
@@ -4744,7 +6790,9 @@ clutter_text_set_cursor_position (ClutterText *self,
      time the cursor is moved up or down */
   priv->x_pos = -1;
 
-  clutter_actor_queue_redraw (CLUTTER_ACTOR (self));
+  /* the cursor, and the selection between the old and the new
+   * position, are the only things that moved */
+  clutter_text_queue_redraw_span (self, old_position, priv->position);
 
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_POSITION]);
 }
@@ -4829,6 +6877,9 @@ clutter_text_set_password_char (ClutterText *self,
     {
       priv->password_char = wc;
 
+      if (priv->password_text != NULL)
+        g_string_truncate (priv->password_text, 0);
+
       clutter_text_dirty_cache (self);
       clutter_actor_queue_relayout (CLUTTER_ACTOR (self));
 
@@ -5153,10 +7204,8 @@ clutter_text_get_chars (ClutterText *self,
   start_pos = MIN (priv->n_chars, start_pos);
   end_pos = MIN (priv->n_chars, end_pos);
 
-  start_index = g_utf8_offset_to_pointer (priv->text, start_pos)
-              - priv->text;
-  end_index   = g_utf8_offset_to_pointer (priv->text, end_pos)
-              - priv->text;
+  start_index = clutter_text_offset_to_index (self, start_pos);
+  end_index   = clutter_text_offset_to_index (self, end_pos);
 
   return g_strndup (priv->text + start_index, end_index - start_index);
 }
@@ -5232,6 +7281,134 @@ clutter_text_get_single_line_mode (ClutterText *self)
   return self->priv->single_line_mode;
 }
 
+/**
+ * clutter_text_set_layout_async:
+ * @self: a #ClutterText
+ * @layout_async: %TRUE to lay out long texts in a separate thread
+ *
+ * Sets whether the #PangoLayout of @self should be created from a
+ * worker thread.
+ *
+ * Shaping a long text, like a log or a chat history, can take a
+ * noticeable amount of time, which would otherwise be spent inside
+ * the size negotiation of the main thread. When @layout_async is
+ * %TRUE, the text is shaped by a worker thread instead; meanwhile,
+ * @self shows only the beginning of the text and reports the size
+ * of that as its preferred size. A relayout is queued as soon as the
+ * full layout is ready.
+ *
+ * Short texts, and the text of editable actors, are always laid out
+ * synchronously.
+ *
+ * If threads have not been initialized, this function has no effect.
+ *
+ * Since: 1.8
+ */
+void
+clutter_text_set_layout_async (ClutterText *self,
+                               gboolean     layout_async)
+{
+  ClutterTextPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_TEXT (self));
+
+  priv = self->priv;
+
+  layout_async = !!layout_async;
+
+  if (priv->layout_async != layout_async)
+    {
+      priv->layout_async = layout_async;
+
+      clutter_text_dirty_cache (self);
+      clutter_actor_queue_relayout (CLUTTER_ACTOR (self));
+
+      g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_LAYOUT_ASYNC]);
+    }
+}
+
+/**
+ * clutter_text_get_layout_async:
+ * @self: a #ClutterText
+ *
+ * Retrieves whether the layout of @self is created from a worker
+ * thread. See clutter_text_set_layout_async().
+ *
+ * Return value: %TRUE if long texts are laid out in a separate thread
+ *
+ * Since: 1.8
+ */
+gboolean
+clutter_text_get_layout_async (ClutterText *self)
+{
+  g_return_val_if_fail (CLUTTER_IS_TEXT (self), FALSE);
+
+  return self->priv->layout_async;
+}
+
+/**
+ * clutter_text_set_use_distance_field:
+ * @self: a #ClutterText
+ * @use_distance_field: %TRUE to draw the glyphs using distance fields
+ *
+ * Sets whether the glyphs of @self should be drawn using signed
+ * distance fields.
+ *
+ * By default, the glyphs are rasterized at the size of the font, so
+ * they become blurry when @self is scaled up, for instance while it
+ * is being animated. When @use_distance_field is %TRUE, each glyph
+ * is rasterized only once into a distance field, regardless of the
+ * font size, and a shader draws it sharp at any scale; on the other
+ * hand, the glyphs are not hinted, and underlines and strikethroughs
+ * are not drawn.
+ *
+ * This requires support for GLSL shaders; if it is not available,
+ * the glyphs are drawn as usual.
+ *
+ * Since: 1.8
+ */
+void
+clutter_text_set_use_distance_field (ClutterText *self,
+                                     gboolean     use_distance_field)
+{
+  ClutterTextPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_TEXT (self));
+
+  priv = self->priv;
+
+  use_distance_field = !!use_distance_field;
+
+  if (priv->use_distance_field != use_distance_field)
+    {
+      priv->use_distance_field = use_distance_field;
+
+      clutter_actor_queue_redraw (CLUTTER_ACTOR (self));
+
+      g_object_notify_by_pspec (G_OBJECT (self),
+                                obj_props[PROP_USE_DISTANCE_FIELD]);
+    }
+}
+
+/**
+ * clutter_text_get_use_distance_field:
+ * @self: a #ClutterText
+ *
+ * Retrieves whether the glyphs of @self are drawn using distance
+ * fields. See clutter_text_set_use_distance_field().
+ *
+ * Return value: %TRUE if the glyphs are drawn using distance fields
+ *
+ * Since: 1.8
+ */
+gboolean
+clutter_text_get_use_distance_field (ClutterText *self)
+{
+  g_return_val_if_fail (CLUTTER_IS_TEXT (self), FALSE);
+
+  return self->priv->use_distance_field;
+}
+
 /**
  * clutter_text_set_preedit_string:
  * @self: a #ClutterText
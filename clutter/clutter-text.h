@@ -199,6 +199,12 @@ gint                  clutter_text_get_max_length       (ClutterText          *s
 void                  clutter_text_set_single_line_mode (ClutterText          *self,
                                                          gboolean              single_line);
 gboolean              clutter_text_get_single_line_mode (ClutterText          *self);
+void                  clutter_text_set_layout_async     (ClutterText          *self,
+                                                         gboolean              layout_async);
+gboolean              clutter_text_get_layout_async     (ClutterText          *self);
+void                  clutter_text_set_use_distance_field (ClutterText        *self,
+                                                           gboolean            use_distance_field);
+gboolean              clutter_text_get_use_distance_field (ClutterText        *self);
 
 void                  clutter_text_set_selected_text_color  (ClutterText          *self,
                                                              const ClutterColor   *color);
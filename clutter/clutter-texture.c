@@ -44,14 +44,25 @@
 #include "config.h"
 #endif
 
+#include <math.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <glib/gstdio.h>
+
 #include "clutter-texture.h"
 
 #include "clutter-actor-private.h"
 #include "clutter-debug.h"
+#include "clutter-display-list.h"
 #include "clutter-enum-types.h"
 #include "clutter-feature.h"
+#include "clutter-job.h"
+#include "clutter-ktx.h"
 #include "clutter-main.h"
 #include "clutter-marshal.h"
+#include "clutter-paint-volume-private.h"
 #include "clutter-private.h"
 #include "clutter-scriptable.h"
 #include "clutter-shader.h"
@@ -70,22 +81,80 @@ G_DEFINE_TYPE_WITH_CODE (ClutterTexture,
 
 typedef struct _ClutterTextureAsyncData ClutterTextureAsyncData;
 
+/* the maximum number of textures a streaming texture uploads into */
+#define MAX_STREAM_BUFFERS      3
+
+/* the coarsest level of detail loaded by auto-lod, as a power of two */
+#define MAX_LOD_LEVEL           6
+
 struct _ClutterTexturePrivate
 {
   gint image_width;
   gint image_height;
 
+  /* the maximum size of the images loaded asynchronously, or -1 */
+  gint load_width_hint;
+  gint load_height_hint;
+
   CoglHandle material;
 
   ClutterActor *fbo_source;
   CoglHandle fbo_handle;
 
+  /* the transformation and the opacity the source was last rendered
+     with, valid if fbo_valid is set */
+  CoglMatrix fbo_modelview;
+  CoglMatrix fbo_projection;
+  float fbo_viewport[4];
+  guint8 fbo_opacity;
+
+  /* the part of the source that queued a redraw since it was last
+     rendered, in stage coordinates, valid if fbo_damaged is set */
+  ClutterActorBox fbo_damage;
+
   CoglHandle pick_material;
 
+  /* the textures of the planes set with set_from_yuv_planes(), and
+     the program converting them to RGB */
+  CoglHandle yuv_planes[3];
+  CoglHandle yuv_program;
+  ClutterTextureYUVFormat yuv_format;
+
+  /* the textures the frames are uploaded into in turn when there is
+     more than one stream buffer, and the format of their data; the
+     current one is the texture being shown */
+  CoglHandle stream_buffers[MAX_STREAM_BUFFERS];
+  CoglPixelFormat stream_formats[MAX_STREAM_BUFFERS];
+  guint n_stream_buffers;
+  guint stream_current;
+
   gchar *filename;
 
   ClutterTextureAsyncData *async_data;
 
+  /* the estimated size of the texture loaded from filename, counted
+     in the texture memory budget, and the link of the texture in the
+     queue of the unmapped textures that can be evicted */
+  gsize memory_size;
+  GList *evict_link;
+
+  /* the level of detail of the texture loaded from filename, the level
+     being loaded and the level wanted by the last paint, as powers of
+     two of the size of the image */
+  guint lod_level;
+  guint lod_load_level;
+  guint lod_wanted_level;
+  guint lod_idle;
+
+  /* the 1-bit alpha mask used to pick with alpha without painting,
+     with one bit for each cell of 2^alpha_mask_shift texels, set if
+     any texel of the cell is opaque; the size is the size of the
+     Cogl texture the mask was generated from, in texels */
+  guint8 *alpha_mask;
+  guint alpha_mask_width;
+  guint alpha_mask_height;
+  guint alpha_mask_shift;
+
   guint no_slice : 1;
   guint sync_actor_size : 1;
   guint repeat_x : 1;
@@ -97,6 +166,21 @@ struct _ClutterTexturePrivate
   guint pick_with_alpha : 1;
   guint pick_with_alpha_supported : 1;
   guint seen_create_pick_material_warning : 1;
+  guint fbo_valid : 1;
+  guint fbo_damaged : 1;
+  guint alpha_mask_failed : 1;
+
+  /* set if the texture was evicted to stay in the memory budget, and
+     while it is being loaded again */
+  guint evicted : 1;
+  guint reloading : 1;
+
+  guint auto_lod : 1;
+  guint lod_loading : 1;
+
+  /* set if the Cogl texture comes from the texture cache, and it
+     might be used by other actors as well */
+  guint shared_texture : 1;
 };
 
 struct _ClutterTextureAsyncData
@@ -126,7 +210,18 @@ struct _ClutterTextureAsyncData
 
   gchar          *load_filename;
   CoglHandle      load_bitmap;
+
+  /* Set instead of load_bitmap if the file is a KTX container */
+  ClutterKtxImage *load_ktx;
+
+  /* Estimated number of bytes that will be uploaded to the GPU,
+     used to spread the uploads over multiple frames */
+  gsize           load_size;
   GError         *load_error;
+
+  /* Set if the texture was found in the texture cache, in which
+     case there is nothing to load */
+  CoglHandle      load_texture;
 };
 
 enum
@@ -146,6 +241,8 @@ enum
   PROP_LOAD_ASYNC,
   PROP_LOAD_DATA_ASYNC,
   PROP_PICK_WITH_ALPHA,
+  PROP_STREAM_BUFFERS,
+  PROP_AUTO_LOD,
 
   PROP_LAST
 };
@@ -163,7 +260,15 @@ enum
 
 static int texture_signals[LAST_SIGNAL] = { 0 };
 
-static GThreadPool *async_thread_pool = NULL;
+/* The maximum number of bytes that should be uploaded to the GPU
+ * in a single frame; a single image bigger than this will still be
+ * uploaded, but it will be the only one uploaded in that frame. The
+ * limit on the time spent uploading is applied as well, to account
+ * for the drivers that convert the pixel data on the CPU
+ */
+#define TEXTURE_UPLOAD_BUDGET           (4 * 1024 * 1024)
+#define TEXTURE_UPLOAD_TIME_BUDGET      (5 * 1000)
+
 static guint        repaint_upload_func = 0;
 static GList       *upload_list = NULL;
 static GStaticMutex upload_list_mutex = G_STATIC_MUTEX_INIT;
@@ -173,6 +278,14 @@ static CoglMaterial *texture_template_material = NULL;
 static void
 texture_fbo_free_resources (ClutterTexture *texture);
 
+static gboolean
+clutter_texture_async_load (ClutterTexture *self,
+                            const gchar    *filename,
+                            GError        **error);
+
+static void
+clutter_texture_update_lod (ClutterTexture *texture);
+
 GQuark
 clutter_texture_error_quark (void)
 {
@@ -210,6 +323,16 @@ clutter_texture_quality_to_filters (ClutterTextureQuality  quality,
     *mag_filter_p = clutter_texture_quality_filters[quality].mag_filter;
 }
 
+static void
+texture_free_alpha_mask (ClutterTexture *texture)
+{
+  ClutterTexturePrivate *priv = texture->priv;
+
+  g_free (priv->alpha_mask);
+  priv->alpha_mask = NULL;
+  priv->alpha_mask_failed = FALSE;
+}
+
 static void
 texture_free_gl_resources (ClutterTexture *texture)
 {
@@ -217,6 +340,8 @@ texture_free_gl_resources (ClutterTexture *texture)
 
   CLUTTER_MARK();
 
+  texture_free_alpha_mask (texture);
+
   if (priv->material != COGL_INVALID_HANDLE)
     {
       /* We want to keep the layer so that the filter settings will
@@ -224,6 +349,49 @@ texture_free_gl_resources (ClutterTexture *texture)
          texture handle */
       cogl_material_set_layer (priv->material, 0, COGL_INVALID_HANDLE);
     }
+
+  if (priv->yuv_program != COGL_INVALID_HANDLE)
+    {
+      guint i;
+
+      if (priv->material != COGL_INVALID_HANDLE)
+        {
+          cogl_material_remove_layer (priv->material, 1);
+          cogl_material_remove_layer (priv->material, 2);
+          cogl_material_set_user_program (priv->material,
+                                          COGL_INVALID_HANDLE);
+        }
+
+      for (i = 0; i < G_N_ELEMENTS (priv->yuv_planes); i++)
+        {
+          if (priv->yuv_planes[i] != COGL_INVALID_HANDLE)
+            {
+              cogl_handle_unref (priv->yuv_planes[i]);
+              priv->yuv_planes[i] = COGL_INVALID_HANDLE;
+            }
+        }
+
+      cogl_handle_unref (priv->yuv_program);
+      priv->yuv_program = COGL_INVALID_HANDLE;
+    }
+}
+
+static void
+texture_free_stream_buffers (ClutterTexture *texture)
+{
+  ClutterTexturePrivate *priv = texture->priv;
+  guint i;
+
+  for (i = 0; i < MAX_STREAM_BUFFERS; i++)
+    {
+      if (priv->stream_buffers[i] != COGL_INVALID_HANDLE)
+        {
+          cogl_handle_unref (priv->stream_buffers[i]);
+          priv->stream_buffers[i] = COGL_INVALID_HANDLE;
+        }
+    }
+
+  priv->stream_current = 0;
 }
 
 static void
@@ -245,6 +413,7 @@ clutter_texture_unrealize (ClutterActor *actor)
       /* Free up our fbo handle and texture resources, realize will recreate */
       cogl_handle_unref (priv->fbo_handle);
       priv->fbo_handle = COGL_INVALID_HANDLE;
+      priv->fbo_valid = FALSE;
       texture_free_gl_resources (texture);
       return;
     }
@@ -281,6 +450,7 @@ clutter_texture_realize (ClutterActor *actor)
       cogl_material_set_layer (priv->material, 0, tex);
 
       priv->fbo_handle = cogl_offscreen_new_to_texture (tex);
+      priv->fbo_valid = FALSE;
 
       /* The material now has a reference to the texture so it will
          stick around */
@@ -417,6 +587,28 @@ clutter_texture_has_overlaps (ClutterActor *self)
   return FALSE;
 }
 
+static gboolean
+clutter_texture_is_opaque (ClutterActor *self)
+{
+  ClutterTexturePrivate *priv = CLUTTER_TEXTURE (self)->priv;
+  CoglHandle cogl_texture;
+
+  if (priv->material == COGL_INVALID_HANDLE)
+    return FALSE;
+
+  /* a custom material might blend in other layers */
+  if (cogl_material_get_n_layers (priv->material) != 1)
+    return FALSE;
+
+  cogl_texture = clutter_texture_get_cogl_texture (CLUTTER_TEXTURE (self));
+  if (cogl_texture == COGL_INVALID_HANDLE)
+    return FALSE;
+
+  /* we always paint the texture over the whole allocation, so we are
+     opaque unless the texture has an alpha channel */
+  return (cogl_texture_get_format (cogl_texture) & COGL_A_BIT) == 0;
+}
+
 static void
 set_viewport_with_buffer_under_fbo_source (ClutterActor *fbo_source,
                                            int viewport_width,
@@ -481,6 +673,7 @@ update_fbo (ClutterActor *self)
   ClutterActor          *stage = NULL;
   CoglMatrix             projection;
   CoglColor              transparent_col;
+  gboolean               clipped = FALSE;
 
   head = _clutter_context_peek_shader_stack ();
   if (head != NULL)
@@ -546,8 +739,62 @@ update_fbo (ClutterActor *self)
         }
     }
 
+  if (stage != NULL)
+    {
+      CoglMatrix modelview;
+      float viewport[4];
+      guint8 opacity;
+
+      cogl_get_modelview_matrix (&modelview);
+      cogl_get_viewport (viewport);
+      opacity = clutter_actor_get_paint_opacity (priv->fbo_source);
+
+      /* if the source is rendered exactly as the last time, only the
+       * parts of it that queued a redraw since then need to be
+       * rendered again */
+      if (priv->fbo_valid &&
+          priv->fbo_opacity == opacity &&
+          memcmp (viewport, priv->fbo_viewport, sizeof (viewport)) == 0 &&
+          cogl_matrix_equal (&modelview, &priv->fbo_modelview) &&
+          cogl_matrix_equal (&projection, &priv->fbo_projection))
+        {
+          gint x1 = 0, y1 = 0, x2 = 0, y2 = 0;
+
+          /* the viewport is offset so that the origin of the fbo is
+           * at -viewport[0],-viewport[1] in stage coordinates */
+          if (priv->fbo_damaged)
+            {
+              x1 = MAX (floorf (priv->fbo_damage.x1 + viewport[0]), 0);
+              y1 = MAX (floorf (priv->fbo_damage.y1 + viewport[1]), 0);
+              x2 = MIN (ceilf (priv->fbo_damage.x2 + viewport[0]),
+                        priv->image_width);
+              y2 = MIN (ceilf (priv->fbo_damage.y2 + viewport[1]),
+                        priv->image_height);
+            }
+
+          priv->fbo_damaged = FALSE;
 
-  /* cogl_clear is called to clear the buffers */
+          if (x2 <= x1 || y2 <= y1)
+            goto out;
+
+          cogl_clip_push_window_rectangle (x1, y1, x2 - x1, y2 - y1);
+          clipped = TRUE;
+        }
+      else
+        {
+          priv->fbo_modelview = modelview;
+          priv->fbo_projection = projection;
+          memcpy (priv->fbo_viewport, viewport, sizeof (viewport));
+          priv->fbo_opacity = opacity;
+          priv->fbo_valid = TRUE;
+          priv->fbo_damaged = FALSE;
+        }
+    }
+  else
+    priv->fbo_valid = FALSE;
+
+  /* cogl_clear is called to clear the buffers; it is limited to the
+   * damaged area by the clip */
   cogl_color_init_from_4ub (&transparent_col, 0, 0, 0, 0);
   cogl_clear (&transparent_col,
               COGL_BUFFER_BIT_COLOR |
@@ -557,6 +804,10 @@ update_fbo (ClutterActor *self)
   /* Render the actor to the fbo */
   clutter_actor_paint (priv->fbo_source);
 
+  if (clipped)
+    cogl_clip_pop ();
+
+out:
   /* Restore drawing to the previous framebuffer */
   cogl_pop_framebuffer ();
 
@@ -565,8 +816,11 @@ update_fbo (ClutterActor *self)
     clutter_shader_set_is_enabled (shader, TRUE);
 }
 
+/* draws the texture over the allocation, and returns the coordinates
+ * and texture coordinates of the rectangle in @coords */
 static void
-gen_texcoords_and_draw_cogl_rectangle (ClutterActor *self)
+gen_texcoords_and_draw_cogl_rectangle (ClutterActor *self,
+                                       gfloat        coords[8])
 {
   ClutterTexture *texture = CLUTTER_TEXTURE (self);
   ClutterTexturePrivate *priv = texture->priv;
@@ -585,10 +839,16 @@ gen_texcoords_and_draw_cogl_rectangle (ClutterActor *self)
   else
     t_h = 1.0;
 
-  cogl_rectangle_with_texture_coords (0, 0,
-			              box.x2 - box.x1,
-                                      box.y2 - box.y1,
-			              0, 0, t_w, t_h);
+  coords[0] = 0;
+  coords[1] = 0;
+  coords[2] = box.x2 - box.x1;
+  coords[3] = box.y2 - box.y1;
+  coords[4] = 0;
+  coords[5] = 0;
+  coords[6] = t_w;
+  coords[7] = t_h;
+
+  cogl_rectangles_with_texture_coords (coords, 1);
 }
 
 static CoglHandle
@@ -634,9 +894,12 @@ clutter_texture_pick (ClutterActor       *self,
   if (!clutter_actor_should_pick_paint (self))
     return;
 
-  if (G_LIKELY (priv->pick_with_alpha_supported) && priv->pick_with_alpha)
+  if (G_LIKELY (priv->pick_with_alpha_supported) &&
+      priv->pick_with_alpha &&
+      !priv->evicted)
     {
       CoglColor pick_color;
+      gfloat coords[8];
 
       if (priv->pick_material == COGL_INVALID_HANDLE)
         priv->pick_material = create_pick_material (self);
@@ -662,24 +925,249 @@ clutter_texture_pick (ClutterActor       *self,
       cogl_material_set_layer (priv->pick_material, 0,
                                clutter_texture_get_cogl_texture (texture));
       cogl_set_source (priv->pick_material);
-      gen_texcoords_and_draw_cogl_rectangle (self);
+      gen_texcoords_and_draw_cogl_rectangle (self, coords);
     }
   else
     CLUTTER_ACTOR_CLASS (clutter_texture_parent_class)->pick (self, color);
 }
 
+/* the largest size of the alpha mask, in cells; bigger textures use
+ * cells of more than one texel */
+#define ALPHA_MASK_MAX_SIZE     256
+
+/* generates the alpha mask of @texture from image data of the size of
+ * its Cogl texture; only the formats with an 8 bit alpha component,
+ * or without alpha, are handled */
+static gboolean
+clutter_texture_build_alpha_mask (ClutterTexture  *texture,
+                                  const guchar    *data,
+                                  CoglPixelFormat  format,
+                                  gint             width,
+                                  gint             height,
+                                  gint             rowstride)
+{
+  ClutterTexturePrivate *priv = texture->priv;
+  guint shift, stride, bpp, alpha_offset;
+  gint x, y;
+
+  if (width <= 0 || height <= 0)
+    return FALSE;
+
+  switch (format & ~COGL_PREMULT_BIT)
+    {
+    case COGL_PIXEL_FORMAT_A_8:
+      bpp = 1;
+      alpha_offset = 0;
+      break;
+
+    case COGL_PIXEL_FORMAT_RGBA_8888:
+    case COGL_PIXEL_FORMAT_BGRA_8888:
+      bpp = 4;
+      alpha_offset = 3;
+      break;
+
+    case COGL_PIXEL_FORMAT_ARGB_8888:
+    case COGL_PIXEL_FORMAT_ABGR_8888:
+      bpp = 4;
+      alpha_offset = 0;
+      break;
+
+    default:
+      if ((format & COGL_A_BIT) != 0)
+        return FALSE;
+
+      /* every texel is opaque */
+      bpp = 0;
+      alpha_offset = 0;
+      break;
+    }
+
+  shift = 0;
+  while ((width >> shift) > ALPHA_MASK_MAX_SIZE ||
+         (height >> shift) > ALPHA_MASK_MAX_SIZE)
+    shift += 1;
+
+  stride = ((width - 1) >> shift) + 1;
+
+  g_free (priv->alpha_mask);
+  priv->alpha_mask = g_malloc0 ((stride * (((height - 1) >> shift) + 1)
+                                 + 7) / 8);
+  priv->alpha_mask_width = width;
+  priv->alpha_mask_height = height;
+  priv->alpha_mask_shift = shift;
+  priv->alpha_mask_failed = FALSE;
+
+  for (y = 0; y < height; y++)
+    {
+      const guchar *p = data + y * rowstride + alpha_offset;
+
+      for (x = 0; x < width; x++, p += bpp)
+        {
+          /* the pick material only keeps the fully opaque texels */
+          if (bpp == 0 || *p == 0xff)
+            {
+              guint cell = (y >> shift) * stride + (x >> shift);
+
+              priv->alpha_mask[cell / 8] |= 1 << (cell % 8);
+            }
+        }
+    }
+
+  return TRUE;
+}
+
+/* makes sure that the alpha mask of @texture is available, reading
+ * the Cogl texture back if it was not generated when uploading the
+ * image data; textures drawn by an FBO or made of YUV planes change
+ * or sample their contents on the GPU, so they never have a mask */
+static gboolean
+clutter_texture_ensure_alpha_mask (ClutterTexture *texture)
+{
+  ClutterTexturePrivate *priv = texture->priv;
+  CoglHandle cogl_texture;
+  guchar *data;
+  gint width, height, size;
+
+  if (priv->alpha_mask != NULL)
+    return TRUE;
+
+  if (priv->alpha_mask_failed ||
+      priv->fbo_source != NULL ||
+      priv->yuv_program != COGL_INVALID_HANDLE)
+    return FALSE;
+
+  cogl_texture = clutter_texture_get_cogl_texture (texture);
+  if (cogl_texture == COGL_INVALID_HANDLE)
+    return FALSE;
+
+  CLUTTER_NOTE (PICK, "Reading back the alpha mask of '%s'",
+                _clutter_actor_get_debug_name (CLUTTER_ACTOR (texture)));
+
+  width = cogl_texture_get_width (cogl_texture);
+  height = cogl_texture_get_height (cogl_texture);
+
+  size = cogl_texture_get_data (cogl_texture,
+                                COGL_PIXEL_FORMAT_RGBA_8888,
+                                width * 4,
+                                NULL);
+  if (size > 0)
+    {
+      data = g_malloc (size);
+
+      if (cogl_texture_get_data (cogl_texture,
+                                 COGL_PIXEL_FORMAT_RGBA_8888,
+                                 width * 4,
+                                 data) > 0)
+        clutter_texture_build_alpha_mask (texture, data,
+                                          COGL_PIXEL_FORMAT_RGBA_8888,
+                                          width, height,
+                                          width * 4);
+
+      g_free (data);
+    }
+
+  if (priv->alpha_mask == NULL)
+    {
+      priv->alpha_mask_failed = TRUE;
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+clutter_texture_can_pick_geometrically (ClutterActor *self)
+{
+  ClutterTexture *texture = CLUTTER_TEXTURE (self);
+  ClutterTexturePrivate *priv = texture->priv;
+
+  /* without pick-with-alpha we just paint our allocation */
+  if (!(priv->pick_with_alpha_supported && priv->pick_with_alpha))
+    return TRUE;
+
+  /* an evicted texture picks its allocation until it is reloaded */
+  if (priv->evicted)
+    return TRUE;
+
+  return clutter_texture_ensure_alpha_mask (texture);
+}
+
+static gboolean
+clutter_texture_hit_test (ClutterActor *self,
+                          gfloat        x,
+                          gfloat        y)
+{
+  ClutterTexturePrivate *priv = CLUTTER_TEXTURE (self)->priv;
+  ClutterActorBox box;
+  gfloat width, height, s, t;
+  guint mask_x, mask_y, stride, cell;
+
+  if (!(priv->pick_with_alpha_supported && priv->pick_with_alpha) ||
+      priv->evicted ||
+      priv->alpha_mask == NULL)
+    return TRUE;
+
+  clutter_actor_get_allocation_box (self, &box);
+
+  width = box.x2 - box.x1;
+  height = box.y2 - box.y1;
+  if (width <= 0 || height <= 0)
+    return FALSE;
+
+  /* the texture coordinates used by gen_texcoords_and_draw_cogl_rectangle() */
+  if (priv->repeat_x && priv->image_width > 0)
+    s = x / (gfloat) priv->image_width;
+  else
+    s = x / width;
+
+  if (priv->repeat_y && priv->image_height > 0)
+    t = y / (gfloat) priv->image_height;
+  else
+    t = y / height;
+
+  s -= floorf (s);
+  t -= floorf (t);
+
+  mask_x = MIN ((guint) (s * priv->alpha_mask_width),
+                priv->alpha_mask_width - 1);
+  mask_y = MIN ((guint) (t * priv->alpha_mask_height),
+                priv->alpha_mask_height - 1);
+
+  stride = ((priv->alpha_mask_width - 1) >> priv->alpha_mask_shift) + 1;
+  cell = (mask_y >> priv->alpha_mask_shift) * stride
+       + (mask_x >> priv->alpha_mask_shift);
+
+  return (priv->alpha_mask[cell / 8] & (1 << (cell % 8))) != 0;
+}
+
 static void
 clutter_texture_paint (ClutterActor *self)
 {
   ClutterTexture *texture = CLUTTER_TEXTURE (self);
   ClutterTexturePrivate *priv = texture->priv;
   guint8 paint_opacity = clutter_actor_get_paint_opacity (self);
+  gfloat coords[8];
 
   CLUTTER_NOTE (PAINT,
                 "painting texture '%s'",
 		clutter_actor_get_name (self) ? clutter_actor_get_name (self)
                                               : "unknown");
 
+  /* nothing to paint until an evicted texture is loaded again */
+  if (priv->evicted)
+    {
+      _clutter_display_list_abort_recording ();
+      return;
+    }
+
+  /* the level of detail and the contents of an offscreen texture
+   * are updated at each paint, so they cannot be replayed */
+  if (priv->auto_lod || priv->fbo_handle != COGL_INVALID_HANDLE)
+    _clutter_display_list_abort_recording ();
+
+  if (priv->auto_lod)
+    clutter_texture_update_lod (texture);
+
   if (priv->fbo_handle != COGL_INVALID_HANDLE)
     update_fbo (self);
 
@@ -690,7 +1178,9 @@ clutter_texture_paint (ClutterActor *self)
                               paint_opacity);
   cogl_set_source (priv->material);
 
-  gen_texcoords_and_draw_cogl_rectangle (self);
+  gen_texcoords_and_draw_cogl_rectangle (self, coords);
+
+  _clutter_display_list_record_material (priv->material, coords, 1);
 }
 
 static gboolean
@@ -712,6 +1202,346 @@ clutter_texture_get_paint_volume (ClutterActor       *self,
                                                   volume);
 }
 
+/* Shared texture cache
+ *
+ * The textures loaded from image files are kept in a process-wide
+ * cache, keyed by the file name and by the flags used to create the
+ * Cogl texture, so that loading the same image in many actors only
+ * decodes and uploads it once. The filter quality is a property of
+ * the material of each actor, so it is not part of the key.
+ *
+ * The cache holds a reference on each texture; when the estimated
+ * size of the textures in the cache goes over the budget we drop the
+ * least recently used ones. Textures still used by an actor are not
+ * freed, but they will not be shared with newly loaded actors.
+ */
+#define TEXTURE_CACHE_DEFAULT_SIZE      (16 * 1024 * 1024)
+
+typedef struct _TextureCacheEntry
+{
+  gchar *key;
+
+  CoglHandle texture;
+  gsize size;
+
+  /* the modification time of the file, so we notice if it changes */
+  time_t mtime;
+
+  /* the link of the entry inside the LRU queue */
+  GList *link;
+} TextureCacheEntry;
+
+static GHashTable *texture_cache = NULL;
+static GQueue texture_cache_lru = G_QUEUE_INIT;
+static gsize texture_cache_size = 0;
+static gsize texture_cache_max_size = TEXTURE_CACHE_DEFAULT_SIZE;
+static guint texture_cache_hits = 0;
+static guint texture_cache_misses = 0;
+
+static gchar *
+texture_cache_make_key (const gchar      *filename,
+                        CoglTextureFlags  flags)
+{
+  return g_strdup_printf ("%x:%s", (guint) flags, filename);
+}
+
+static time_t
+texture_cache_get_mtime (const gchar *filename)
+{
+  struct stat buf;
+
+  if (g_stat (filename, &buf) != 0)
+    return 0;
+
+  return buf.st_mtime;
+}
+
+static void
+texture_cache_remove_entry (TextureCacheEntry *entry)
+{
+  g_hash_table_remove (texture_cache, entry->key);
+  g_queue_delete_link (&texture_cache_lru, entry->link);
+
+  texture_cache_size -= entry->size;
+
+  cogl_handle_unref (entry->texture);
+  g_free (entry->key);
+  g_slice_free (TextureCacheEntry, entry);
+}
+
+static void
+texture_cache_trim (gsize max_size)
+{
+  while (texture_cache_size > max_size && texture_cache_lru.tail != NULL)
+    {
+      TextureCacheEntry *entry = texture_cache_lru.tail->data;
+
+      CLUTTER_NOTE (TEXTURE, "Dropping '%s' from the texture cache",
+                    entry->key);
+
+      texture_cache_remove_entry (entry);
+    }
+}
+
+/* Returns a new reference on the cached texture for @filename and
+ * @flags, or COGL_INVALID_HANDLE */
+static CoglHandle
+texture_cache_lookup (const gchar      *filename,
+                      CoglTextureFlags  flags)
+{
+  TextureCacheEntry *entry = NULL;
+
+  if (texture_cache_max_size == 0)
+    return COGL_INVALID_HANDLE;
+
+  if (texture_cache != NULL)
+    {
+      gchar *key = texture_cache_make_key (filename, flags);
+
+      entry = g_hash_table_lookup (texture_cache, key);
+      g_free (key);
+    }
+
+  if (entry != NULL && entry->mtime != texture_cache_get_mtime (filename))
+    {
+      CLUTTER_NOTE (TEXTURE, "File '%s' changed since it was cached",
+                    filename);
+
+      texture_cache_remove_entry (entry);
+      entry = NULL;
+    }
+
+  if (entry == NULL)
+    {
+      texture_cache_misses += 1;
+      return COGL_INVALID_HANDLE;
+    }
+
+  texture_cache_hits += 1;
+
+  /* move the entry to the front of the LRU queue */
+  g_queue_unlink (&texture_cache_lru, entry->link);
+  g_queue_push_head_link (&texture_cache_lru, entry->link);
+
+  return cogl_handle_ref (entry->texture);
+}
+
+static void
+texture_cache_insert (const gchar      *filename,
+                      CoglTextureFlags  flags,
+                      CoglHandle        texture)
+{
+  TextureCacheEntry *entry;
+  gchar *key;
+  gsize size;
+  time_t mtime;
+
+  if (texture_cache_max_size == 0 || texture == COGL_INVALID_HANDLE)
+    return;
+
+  mtime = texture_cache_get_mtime (filename);
+  if (mtime == 0)
+    return;
+
+  /* we don't know the internal format used by the driver, so we
+   * assume that every pixel takes 4 bytes */
+  size = (gsize) cogl_texture_get_width (texture)
+       * cogl_texture_get_height (texture)
+       * 4;
+
+  if (size > texture_cache_max_size)
+    return;
+
+  if (G_UNLIKELY (texture_cache == NULL))
+    texture_cache = g_hash_table_new (g_str_hash, g_str_equal);
+
+  key = texture_cache_make_key (filename, flags);
+
+  entry = g_hash_table_lookup (texture_cache, key);
+  if (entry != NULL)
+    texture_cache_remove_entry (entry);
+
+  entry = g_slice_new (TextureCacheEntry);
+  entry->key = key;
+  entry->texture = cogl_handle_ref (texture);
+  entry->size = size;
+  entry->mtime = mtime;
+
+  g_queue_push_head (&texture_cache_lru, entry);
+  entry->link = texture_cache_lru.head;
+
+  g_hash_table_insert (texture_cache, entry->key, entry);
+  texture_cache_size += size;
+
+  texture_cache_trim (texture_cache_max_size);
+}
+
+/* Texture memory budget
+ *
+ * The textures loaded from image files are counted against a
+ * process-wide budget; when their estimated size goes over it, the
+ * textures of the unmapped actors are evicted, least recently unmapped
+ * first, and loaded again asynchronously when the actors are mapped.
+ * An evicted texture keeps its size, so that the layout of the actor
+ * does not change while it is not loaded.
+ *
+ * A texture is only freed once no other actor and the texture cache
+ * hold it anymore.
+ */
+static GQueue texture_evict_queue = G_QUEUE_INIT;
+static gsize texture_memory_budget = 0;
+static gsize texture_memory_used = 0;
+static guint texture_n_evictions = 0;
+static guint texture_n_reloads = 0;
+
+static void
+texture_memory_untrack (ClutterTexture *texture)
+{
+  ClutterTexturePrivate *priv = texture->priv;
+
+  if (priv->evict_link != NULL)
+    {
+      g_queue_delete_link (&texture_evict_queue, priv->evict_link);
+      priv->evict_link = NULL;
+    }
+
+  texture_memory_used -= priv->memory_size;
+  priv->memory_size = 0;
+}
+
+static void
+texture_memory_evict (ClutterTexture *texture)
+{
+  ClutterTexturePrivate *priv = texture->priv;
+
+  CLUTTER_NOTE (TEXTURE, "Evicting '%s' (%" G_GSIZE_FORMAT " bytes)",
+                priv->filename,
+                priv->memory_size);
+
+  texture_memory_untrack (texture);
+
+  if (priv->lod_loading)
+    {
+      clutter_texture_async_load_cancel (texture);
+      priv->lod_loading = FALSE;
+      priv->lod_load_level = 0;
+    }
+
+  /* the pick material holds a reference on the texture as well */
+  if (priv->pick_material != COGL_INVALID_HANDLE)
+    {
+      cogl_handle_unref (priv->pick_material);
+      priv->pick_material = COGL_INVALID_HANDLE;
+    }
+
+  texture_free_gl_resources (texture);
+
+  priv->shared_texture = FALSE;
+  priv->evicted = TRUE;
+
+  texture_n_evictions += 1;
+}
+
+static void
+texture_memory_trim (void)
+{
+  if (texture_memory_budget == 0)
+    return;
+
+  while (texture_memory_used > texture_memory_budget &&
+         texture_evict_queue.tail != NULL)
+    texture_memory_evict (texture_evict_queue.tail->data);
+}
+
+static void
+texture_memory_make_evictable (ClutterTexture *texture)
+{
+  ClutterTexturePrivate *priv = texture->priv;
+
+  if (priv->memory_size == 0 || priv->evict_link != NULL)
+    return;
+
+  g_queue_push_head (&texture_evict_queue, texture);
+  priv->evict_link = texture_evict_queue.head;
+
+  texture_memory_trim ();
+}
+
+/* counts @handle, just loaded from priv->filename, in the budget */
+static void
+texture_memory_track (ClutterTexture *texture,
+                      CoglHandle      handle)
+{
+  ClutterTexturePrivate *priv = texture->priv;
+
+  texture_memory_untrack (texture);
+
+  /* we don't know the internal format used by the driver, so we
+   * assume that every pixel takes 4 bytes */
+  priv->memory_size = (gsize) cogl_texture_get_width (handle)
+                    * cogl_texture_get_height (handle)
+                    * 4;
+  texture_memory_used += priv->memory_size;
+
+  if (!CLUTTER_ACTOR_IS_MAPPED (texture))
+    texture_memory_make_evictable (texture);
+  else
+    texture_memory_trim ();
+}
+
+static void
+texture_memory_reload (ClutterTexture *texture)
+{
+  ClutterTexturePrivate *priv = texture->priv;
+  gint width, height;
+
+  CLUTTER_NOTE (TEXTURE, "Reloading '%s'", priv->filename);
+
+  /* the image keeps the size it had before being evicted until it
+   * is loaded again */
+  width = priv->image_width;
+  height = priv->image_height;
+
+  priv->reloading = TRUE;
+
+  if (!clutter_texture_async_load (texture, priv->filename, NULL))
+    {
+      CLUTTER_NOTE (TEXTURE, "Failed to reload '%s'", priv->filename);
+      priv->reloading = FALSE;
+    }
+
+  priv->image_width = width;
+  priv->image_height = height;
+
+  texture_n_reloads += 1;
+}
+
+static void
+clutter_texture_map (ClutterActor *actor)
+{
+  ClutterTexture *texture = CLUTTER_TEXTURE (actor);
+  ClutterTexturePrivate *priv = texture->priv;
+
+  if (priv->evict_link != NULL)
+    {
+      g_queue_delete_link (&texture_evict_queue, priv->evict_link);
+      priv->evict_link = NULL;
+    }
+
+  if (priv->evicted && !priv->reloading && priv->filename != NULL)
+    texture_memory_reload (texture);
+
+  CLUTTER_ACTOR_CLASS (clutter_texture_parent_class)->map (actor);
+}
+
+static void
+clutter_texture_unmap (ClutterActor *actor)
+{
+  CLUTTER_ACTOR_CLASS (clutter_texture_parent_class)->unmap (actor);
+
+  texture_memory_make_evictable (CLUTTER_TEXTURE (actor));
+}
+
 static void
 clutter_texture_async_data_free (ClutterTextureAsyncData *data)
 {
@@ -726,6 +1556,12 @@ clutter_texture_async_data_free (ClutterTextureAsyncData *data)
   if (data->load_bitmap)
     cogl_handle_unref (data->load_bitmap);
 
+  if (data->load_ktx)
+    _clutter_ktx_image_free (data->load_ktx);
+
+  if (data->load_texture)
+    cogl_handle_unref (data->load_texture);
+
   if (data->load_error)
     g_error_free (data->load_error);
 
@@ -792,8 +1628,16 @@ clutter_texture_dispose (GObject *object)
 
   texture_free_gl_resources (texture);
   texture_fbo_free_resources (texture);
+  texture_free_stream_buffers (texture);
 
   clutter_texture_async_load_cancel (texture);
+  texture_memory_untrack (texture);
+
+  if (priv->lod_idle != 0)
+    {
+      g_source_remove (priv->lod_idle);
+      priv->lod_idle = 0;
+    }
 
   if (priv->material != COGL_INVALID_HANDLE)
     {
@@ -900,6 +1744,14 @@ clutter_texture_set_property (GObject      *object,
                                            g_value_get_boolean (value));
       break;
 
+    case PROP_STREAM_BUFFERS:
+      clutter_texture_set_stream_buffers (texture, g_value_get_uint (value));
+      break;
+
+    case PROP_AUTO_LOD:
+      clutter_texture_set_auto_lod (texture, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -964,6 +1816,14 @@ clutter_texture_get_property (GObject    *object,
       g_value_set_boolean (value, priv->pick_with_alpha);
       break;
 
+    case PROP_STREAM_BUFFERS:
+      g_value_set_uint (value, priv->n_stream_buffers);
+      break;
+
+    case PROP_AUTO_LOD:
+      g_value_set_boolean (value, priv->auto_lod);
+      break;
+
     case PROP_FILENAME:
       g_value_set_string (value, priv->filename);
       break;
@@ -988,17 +1848,26 @@ clutter_texture_class_init (ClutterTextureClass *klass)
   actor_class->get_paint_volume = clutter_texture_get_paint_volume;
   actor_class->realize          = clutter_texture_realize;
   actor_class->unrealize        = clutter_texture_unrealize;
+  actor_class->map              = clutter_texture_map;
+  actor_class->unmap            = clutter_texture_unmap;
   actor_class->has_overlaps     = clutter_texture_has_overlaps;
+  actor_class->is_opaque        = clutter_texture_is_opaque;
 
   actor_class->get_preferred_width  = clutter_texture_get_preferred_width;
   actor_class->get_preferred_height = clutter_texture_get_preferred_height;
   actor_class->allocate             = clutter_texture_allocate;
 
+  _clutter_actor_class_register_geometric_pick (actor_class, FALSE,
+                                                clutter_texture_can_pick_geometrically,
+                                                clutter_texture_hit_test);
+
   gobject_class->dispose      = clutter_texture_dispose;
   gobject_class->finalize     = clutter_texture_finalize;
   gobject_class->set_property = clutter_texture_set_property;
   gobject_class->get_property = clutter_texture_get_property;
 
+  _clutter_display_list_add_recordable_type (CLUTTER_TYPE_TEXTURE);
+
   pspec = g_param_spec_boolean ("sync-size",
                                 P_("Sync size of actor"),
                                 P_("Auto sync size of actor to underlying pixbuf dimensions"),
@@ -1116,7 +1985,9 @@ clutter_texture_class_init (ClutterTextureClass *klass)
    *
    * The upload of the texture data on the GL pipeline is not asynchronous, as
    * it must be performed from within the same thread that called
-   * clutter_main().
+   * clutter_main(). In order to avoid blocking the frame, the uploads of
+   * multiple textures are spread across successive frames, so that only
+   * a limited amount of pixel data is handed to GL in each frame.
    *
    * Since: 1.0
    */
@@ -1170,6 +2041,45 @@ clutter_texture_class_init (ClutterTextureClass *klass)
   obj_props[PROP_PICK_WITH_ALPHA] = pspec;
   g_object_class_install_property (gobject_class, PROP_PICK_WITH_ALPHA, pspec);
 
+  /**
+   * ClutterTexture:stream-buffers:
+   *
+   * The number of textures the frames set with
+   * clutter_texture_set_from_rgb_data() are uploaded into in turn.
+   *
+   * With more than one buffer a new frame is never uploaded into the
+   * texture being shown, which the GPU might still be sampling; this
+   * avoids stalling the pipeline when updating the texture at the
+   * frame rate, for instance with the frames of a video.
+   *
+   * Since: 1.8
+   */
+  pspec = g_param_spec_uint ("stream-buffers",
+                             P_("Stream Buffers"),
+                             P_("The number of textures the frames are uploaded into in turn"),
+                             1, MAX_STREAM_BUFFERS,
+                             1,
+                             CLUTTER_PARAM_READWRITE);
+  obj_props[PROP_STREAM_BUFFERS] = pspec;
+  g_object_class_install_property (gobject_class, PROP_STREAM_BUFFERS, pspec);
+
+  /**
+   * ClutterTexture:auto-lod:
+   *
+   * Whether the resolution of the image loaded from
+   * #ClutterTexture:filename should follow the size of the texture
+   * on the screen.
+   *
+   * Since: 1.8
+   */
+  pspec = g_param_spec_boolean ("auto-lod",
+                                P_("Automatic Level of Detail"),
+                                P_("Whether the resolution of the image should follow its size on the screen"),
+                                FALSE,
+                                CLUTTER_PARAM_READWRITE);
+  obj_props[PROP_AUTO_LOD] = pspec;
+  g_object_class_install_property (gobject_class, PROP_AUTO_LOD, pspec);
+
   /**
    * ClutterTexture::size-change:
    * @texture: the texture which received the signal
@@ -1302,6 +2212,9 @@ clutter_texture_init (ClutterTexture *self)
   priv->pick_with_alpha   = FALSE;
   priv->pick_with_alpha_supported = TRUE;
   priv->seen_create_pick_material_warning = FALSE;
+  priv->load_width_hint   = -1;
+  priv->load_height_hint  = -1;
+  priv->n_stream_buffers  = 1;
 
   if (G_UNLIKELY (texture_template_material == NULL))
     {
@@ -1461,6 +2374,26 @@ clutter_texture_set_cogl_texture (ClutterTexture  *texture,
      already using */
   cogl_handle_ref (cogl_tex);
 
+  /* The caller owns the new texture, unless we are setting it from
+     the texture cache */
+  priv->shared_texture = FALSE;
+
+  /* The new texture is not counted in the memory budget, unless we
+     are setting it from a file; a pending reload of an evicted
+     texture would replace it */
+  texture_memory_untrack (texture);
+  priv->evicted = FALSE;
+
+  if (priv->reloading || priv->lod_loading)
+    {
+      clutter_texture_async_load_cancel (texture);
+      priv->reloading = FALSE;
+      priv->lod_loading = FALSE;
+    }
+
+  priv->lod_level = 0;
+  priv->lod_load_level = 0;
+
   /* Remove FBO if exisiting */
   if (priv->fbo_source)
     texture_fbo_free_resources (texture);
@@ -1529,6 +2462,67 @@ clutter_texture_set_cogl_texture (ClutterTexture  *texture,
   g_object_notify_by_pspec (G_OBJECT (texture), obj_props[PROP_COGL_TEXTURE]);
 }
 
+/* uploads a whole frame into the stream buffer following the current
+ * one, creating it if it does not have the size or the format of the
+ * frame, and makes it the current one; returns a new reference on the
+ * stream buffer, or COGL_INVALID_HANDLE on failure */
+static CoglHandle
+clutter_texture_upload_stream_buffer (ClutterTexture  *texture,
+                                      const guchar    *data,
+                                      CoglPixelFormat  source_format,
+                                      gint             width,
+                                      gint             height,
+                                      gint             rowstride)
+{
+  ClutterTexturePrivate *priv = texture->priv;
+  CoglHandle buffer;
+  guint next;
+
+  next = (priv->stream_current + 1) % priv->n_stream_buffers;
+  buffer = priv->stream_buffers[next];
+
+  if (buffer != COGL_INVALID_HANDLE &&
+      (cogl_texture_get_width (buffer) != width ||
+       cogl_texture_get_height (buffer) != height ||
+       priv->stream_formats[next] != source_format ||
+       !cogl_texture_set_region (buffer,
+                                 0, 0,
+                                 0, 0, width, height,
+                                 width, height,
+                                 source_format,
+                                 rowstride,
+                                 data)))
+    {
+      cogl_handle_unref (buffer);
+      buffer = COGL_INVALID_HANDLE;
+    }
+
+  if (buffer == COGL_INVALID_HANDLE)
+    {
+      CoglTextureFlags flags = COGL_TEXTURE_NONE;
+
+      if (priv->no_slice)
+        flags |= COGL_TEXTURE_NO_SLICING;
+
+      buffer = cogl_texture_new_from_data (width, height,
+                                           flags,
+                                           source_format,
+                                           COGL_PIXEL_FORMAT_ANY,
+                                           rowstride,
+                                           data);
+
+      priv->stream_buffers[next] = buffer;
+      priv->stream_formats[next] = source_format;
+
+      if (buffer == COGL_INVALID_HANDLE)
+        return COGL_INVALID_HANDLE;
+    }
+
+  priv->stream_current = next;
+
+  return cogl_handle_ref (buffer);
+}
+
 static gboolean
 clutter_texture_set_from_data (ClutterTexture     *texture,
 			       const guchar       *data,
@@ -1549,12 +2543,18 @@ clutter_texture_set_from_data (ClutterTexture     *texture,
   /* FIXME if we are not realized, we should store the data
    * for future use, instead of creating the texture.
    */
-  new_texture = cogl_texture_new_from_data (width, height,
-                                            flags,
-                                            source_format,
-                                            COGL_PIXEL_FORMAT_ANY,
-                                            rowstride,
-                                            data);
+  if (priv->n_stream_buffers > 1)
+    new_texture = clutter_texture_upload_stream_buffer (texture, data,
+                                                        source_format,
+                                                        width, height,
+                                                        rowstride);
+  else
+    new_texture = cogl_texture_new_from_data (width, height,
+                                              flags,
+                                              source_format,
+                                              COGL_PIXEL_FORMAT_ANY,
+                                              rowstride,
+                                              data);
 
   if (G_UNLIKELY (new_texture == COGL_INVALID_HANDLE))
     {
@@ -1581,6 +2581,13 @@ clutter_texture_set_from_data (ClutterTexture     *texture,
 
   cogl_handle_unref (new_texture);
 
+  /* we still have the image data, so we can generate the alpha mask
+     now instead of reading the texture back when picking */
+  if (priv->pick_with_alpha)
+    clutter_texture_build_alpha_mask (texture, data, source_format,
+                                      width, height,
+                                      rowstride);
+
   g_signal_emit (texture, texture_signals[LOAD_FINISHED], 0, NULL);
 
   return TRUE;
@@ -1714,38 +2721,585 @@ clutter_texture_set_from_yuv_data (ClutterTexture     *texture,
 					error);
 }
 
+/* BT.601 conversion from limited range YUV; each plane is stored in
+ * the alpha channel of its texture */
+#define YUV_TO_RGB_GLSL                                                 \
+"vec4 yuv_to_rgb (float y, float u, float v)\n"                         \
+"{\n"                                                                   \
+"  y = 1.1643 * (y - 0.0625);\n"                                        \
+"  u = u - 0.5;\n"                                                      \
+"  v = v - 0.5;\n"                                                      \
+"  return vec4 (y + 1.5958 * v,\n"                                      \
+"               y - 0.39173 * u - 0.81290 * v,\n"                       \
+"               y + 2.017 * u,\n"                                       \
+"               1.0);\n"                                                \
+"}\n"
+
+static const gchar i420_glsl_shader[] =
+"uniform sampler2D y_plane;\n"
+"uniform sampler2D u_plane;\n"
+"uniform sampler2D v_plane;\n"
+"\n"
+YUV_TO_RGB_GLSL
+"\n"
+"void main ()\n"
+"{\n"
+"  vec2 coord = cogl_tex_coord_in[0].st;\n"
+"  cogl_color_out = yuv_to_rgb (texture2D (y_plane, coord).a,\n"
+"                               texture2D (u_plane, coord).a,\n"
+"                               texture2D (v_plane, coord).a)\n"
+"                 * cogl_color_in;\n"
+"}\n";
+
+/* the chroma plane of NV12 contains interleaved U and V values, so it
+ * is sampled without filtering, at the centre of each texel */
+static const gchar nv12_glsl_shader[] =
+"uniform sampler2D y_plane;\n"
+"uniform sampler2D uv_plane;\n"
+"uniform float chroma_width;\n"
+"\n"
+YUV_TO_RGB_GLSL
+"\n"
+"void main ()\n"
+"{\n"
+"  vec2 coord = cogl_tex_coord_in[0].st;\n"
+"  float texel = 0.5 / chroma_width;\n"
+"  float u_x = (floor (coord.s * chroma_width) + 0.25) / chroma_width;\n"
+"  cogl_color_out = yuv_to_rgb (texture2D (y_plane, coord).a,\n"
+"                               texture2D (uv_plane, vec2 (u_x, coord.t)).a,\n"
+"                               texture2D (uv_plane, vec2 (u_x + texel, coord.t)).a)\n"
+"                 * cogl_color_in;\n"
+"}\n";
+
+static CoglHandle
+clutter_texture_create_yuv_program (ClutterTextureYUVFormat   format,
+                                    gint                      chroma_width,
+                                    GError                  **error)
+{
+  CoglHandle shader, program;
+  gint location;
+
+  shader = cogl_create_shader (COGL_SHADER_TYPE_FRAGMENT);
+  cogl_shader_source (shader,
+                      format == CLUTTER_TEXTURE_YUV_FORMAT_NV12
+                        ? nv12_glsl_shader
+                        : i420_glsl_shader);
+  cogl_shader_compile (shader);
+
+  if (!cogl_shader_is_compiled (shader))
+    {
+      gchar *log_buf = cogl_shader_get_info_log (shader);
+
+      g_set_error (error, CLUTTER_TEXTURE_ERROR,
+                   CLUTTER_TEXTURE_ERROR_NO_YUV,
+                   "Unable to compile the YUV conversion shader: %s",
+                   log_buf);
+      g_free (log_buf);
+
+      cogl_handle_unref (shader);
+
+      return COGL_INVALID_HANDLE;
+    }
+
+  program = cogl_create_program ();
+  cogl_program_attach_shader (program, shader);
+  cogl_program_link (program);
+  cogl_handle_unref (shader);
+
+  /* the planes use the texture units of the layers of the material */
+  location = cogl_program_get_uniform_location (program, "y_plane");
+  if (location > -1)
+    cogl_program_set_uniform_1i (program, location, 0);
+
+  if (format == CLUTTER_TEXTURE_YUV_FORMAT_NV12)
+    {
+      location = cogl_program_get_uniform_location (program, "uv_plane");
+      if (location > -1)
+        cogl_program_set_uniform_1i (program, location, 1);
+
+      location = cogl_program_get_uniform_location (program, "chroma_width");
+      if (location > -1)
+        cogl_program_set_uniform_1f (program, location, chroma_width);
+    }
+  else
+    {
+      location = cogl_program_get_uniform_location (program, "u_plane");
+      if (location > -1)
+        cogl_program_set_uniform_1i (program, location, 1);
+
+      location = cogl_program_get_uniform_location (program, "v_plane");
+      if (location > -1)
+        cogl_program_set_uniform_1i (program, location, 2);
+    }
+
+  return program;
+}
+
+/**
+ * clutter_texture_set_from_yuv_planes:
+ * @texture: a #ClutterTexture
+ * @format: the layout of the planes
+ * @width: width of the image, in pixels
+ * @height: height of the image, in pixels
+ * @planes: (array): the pixel data of each plane; three planes (Y, U
+ *   and V) are needed for %CLUTTER_TEXTURE_YUV_FORMAT_I420, and two
+ *   planes (Y and interleaved UV) for %CLUTTER_TEXTURE_YUV_FORMAT_NV12
+ * @rowstrides: (array): the distance in bytes between the rows of
+ *   each plane
+ * @error: return location for a #GError, or %NULL
+ *
+ * Sets the contents of @texture from a YUV image stored in separate
+ * planes, like the frames decoded by most video codecs.
+ *
+ * Each plane is uploaded as it is into its own texture, and the
+ * conversion to RGB is performed by a fragment shader when @texture
+ * is painted, so the CPU never converts the pixels. If the size and
+ * format of the image do not change, the textures are reused by the
+ * following calls.
+ *
+ * This function requires support for GLSL shaders; if it is not
+ * available, %FALSE is returned and @error is set to
+ * %CLUTTER_TEXTURE_ERROR_NO_YUV. Since @texture uses a user program
+ * while showing YUV data, it should not have a #ClutterShader set.
+ *
+ * Return value: %TRUE if the texture was successfully updated
+ *
+ * Since: 1.8
+ */
+gboolean
+clutter_texture_set_from_yuv_planes (ClutterTexture           *texture,
+                                     ClutterTextureYUVFormat   format,
+                                     gint                      width,
+                                     gint                      height,
+                                     const guint8 * const     *planes,
+                                     const gint               *rowstrides,
+                                     GError                  **error)
+{
+  ClutterTexturePrivate *priv;
+  gint plane_width[3], plane_height[3];
+  gint n_planes, chroma_width, chroma_height, i;
+  gboolean reuse_planes;
+
+  g_return_val_if_fail (CLUTTER_IS_TEXTURE (texture), FALSE);
+  g_return_val_if_fail (width > 0 && height > 0, FALSE);
+  g_return_val_if_fail (planes != NULL && rowstrides != NULL, FALSE);
+
+  priv = texture->priv;
+
+  if (!cogl_features_available (COGL_FEATURE_SHADERS_GLSL))
+    {
+      g_set_error (error, CLUTTER_TEXTURE_ERROR,
+                   CLUTTER_TEXTURE_ERROR_NO_YUV,
+                   "YUV planes require support for GLSL shaders");
+      return FALSE;
+    }
+
+  chroma_width = (width + 1) / 2;
+  chroma_height = (height + 1) / 2;
+
+  plane_width[0] = width;
+  plane_height[0] = height;
+
+  if (format == CLUTTER_TEXTURE_YUV_FORMAT_NV12)
+    {
+      n_planes = 2;
+      plane_width[1] = chroma_width * 2;
+      plane_height[1] = chroma_height;
+    }
+  else
+    {
+      n_planes = 3;
+      plane_width[1] = plane_width[2] = chroma_width;
+      plane_height[1] = plane_height[2] = chroma_height;
+    }
+
+  reuse_planes = priv->yuv_program != COGL_INVALID_HANDLE &&
+                 priv->yuv_format == format &&
+                 cogl_texture_get_width (priv->yuv_planes[0]) == width &&
+                 cogl_texture_get_height (priv->yuv_planes[0]) == height;
+
+  if (reuse_planes)
+    {
+      for (i = 0; i < n_planes; i++)
+        cogl_texture_set_region (priv->yuv_planes[i],
+                                 0, 0,
+                                 0, 0,
+                                 plane_width[i], plane_height[i],
+                                 plane_width[i], plane_height[i],
+                                 COGL_PIXEL_FORMAT_A_8,
+                                 rowstrides[i],
+                                 planes[i]);
+
+      clutter_actor_queue_redraw (CLUTTER_ACTOR (texture));
+
+      return TRUE;
+    }
+  else
+    {
+      CoglHandle textures[3] = { COGL_INVALID_HANDLE, };
+      CoglHandle program;
+
+      program = clutter_texture_create_yuv_program (format, chroma_width,
+                                                    error);
+      if (program == COGL_INVALID_HANDLE)
+        return FALSE;
+
+      for (i = 0; i < n_planes; i++)
+        {
+          textures[i] = cogl_texture_new_from_data (plane_width[i],
+                                                    plane_height[i],
+                                                    COGL_TEXTURE_NO_SLICING |
+                                                    COGL_TEXTURE_NO_ATLAS,
+                                                    COGL_PIXEL_FORMAT_A_8,
+                                                    COGL_PIXEL_FORMAT_A_8,
+                                                    rowstrides[i],
+                                                    planes[i]);
+
+          if (textures[i] == COGL_INVALID_HANDLE)
+            {
+              g_set_error (error, CLUTTER_TEXTURE_ERROR,
+                           CLUTTER_TEXTURE_ERROR_BAD_FORMAT,
+                           "Failed to create the texture of a YUV plane");
+
+              while (i-- > 0)
+                cogl_handle_unref (textures[i]);
+
+              cogl_handle_unref (program);
+
+              return FALSE;
+            }
+        }
+
+      /* this releases any previous plane */
+      clutter_texture_set_cogl_texture (texture, textures[0]);
+
+      for (i = 1; i < n_planes; i++)
+        cogl_material_set_layer (priv->material, i, textures[i]);
+
+      if (format == CLUTTER_TEXTURE_YUV_FORMAT_NV12)
+        cogl_material_set_layer_filters (priv->material, 1,
+                                         COGL_MATERIAL_FILTER_NEAREST,
+                                         COGL_MATERIAL_FILTER_NEAREST);
+
+      cogl_material_set_user_program (priv->material, program);
+
+      for (i = 0; i < 3; i++)
+        priv->yuv_planes[i] = textures[i];
+
+      priv->yuv_program = program;
+      priv->yuv_format = format;
+    }
+
+  return TRUE;
+}
+
 /*
  * clutter_texture_async_load_complete:
  * @self: a #ClutterTexture
- * @bitmap: a handle to a CoglBitmap
+ * @data: the #ClutterTextureAsyncData of the load
  * @error: load error
  *
- * If @error is %NULL, loads @bitmap into a #CoglTexture.
+ * If @error is %NULL, loads the bitmap of @data into a #CoglTexture,
+ * unless the texture was found in the texture cache.
  *
  * This function emits the ::load-finished signal on @self.
  */
+/* computes the size of the image scaled down to fit inside the load
+ * size hint, preserving its aspect ratio; returns FALSE if the image
+ * does not need to be scaled */
+static gboolean
+clutter_texture_get_scaled_load_size (ClutterTexture *self,
+                                      gint            image_width,
+                                      gint            image_height,
+                                      gint           *width,
+                                      gint           *height)
+{
+  ClutterTexturePrivate *priv = self->priv;
+  gdouble scale = 1.0;
+
+  if (image_width <= 0 || image_height <= 0)
+    return FALSE;
+
+  if (priv->load_width_hint > 0 && image_width > priv->load_width_hint)
+    scale = (gdouble) priv->load_width_hint / image_width;
+
+  if (priv->load_height_hint > 0 &&
+      image_height * scale > priv->load_height_hint)
+    scale = (gdouble) priv->load_height_hint / image_height;
+
+  scale /= 1 << priv->lod_load_level;
+
+  if (scale >= 1.0)
+    return FALSE;
+
+  *width = MAX (1, (gint) (image_width * scale + 0.5));
+  *height = MAX (1, (gint) (image_height * scale + 0.5));
+
+  return TRUE;
+}
+
+/* draws @texture into a new texture of the given size, using the mipmaps
+ * of @texture to avoid aliasing; returns a new reference on @texture if
+ * the scaled copy cannot be created */
+static CoglHandle
+clutter_texture_scale_cogl_texture (CoglHandle       texture,
+                                    CoglTextureFlags flags,
+                                    gint             width,
+                                    gint             height)
+{
+  CoglHandle scaled, offscreen;
+  CoglMaterial *material;
+  CoglMatrix identity, projection;
+  CoglColor transparent;
+
+  scaled = cogl_texture_new_with_size (width, height,
+                                       flags,
+                                       COGL_PIXEL_FORMAT_RGBA_8888_PRE);
+  if (scaled == COGL_INVALID_HANDLE)
+    return cogl_handle_ref (texture);
+
+  offscreen = cogl_offscreen_new_to_texture (scaled);
+  if (offscreen == COGL_INVALID_HANDLE)
+    {
+      cogl_handle_unref (scaled);
+      return cogl_handle_ref (texture);
+    }
+
+  material = cogl_material_new ();
+  cogl_material_set_layer (material, 0, texture);
+  cogl_material_set_layer_filters (material, 0,
+                                   COGL_MATERIAL_FILTER_LINEAR_MIPMAP_LINEAR,
+                                   COGL_MATERIAL_FILTER_LINEAR);
+
+  cogl_push_framebuffer (offscreen);
+
+  cogl_get_projection_matrix (&projection);
+  cogl_push_matrix ();
+
+  cogl_matrix_init_identity (&identity);
+  cogl_set_projection_matrix (&identity);
+  cogl_set_modelview_matrix (&identity);
+
+  cogl_color_init_from_4ub (&transparent, 0, 0, 0, 0);
+  cogl_clear (&transparent, COGL_BUFFER_BIT_COLOR);
+
+  cogl_set_source (material);
+  cogl_rectangle (-1.0f, 1.0f, 1.0f, -1.0f);
+
+  cogl_pop_matrix ();
+  cogl_set_projection_matrix (&projection);
+
+  cogl_pop_framebuffer ();
+
+  cogl_object_unref (material);
+  cogl_handle_unref (offscreen);
+
+  CLUTTER_NOTE (TEXTURE, "Scaled the loaded image from %dx%d to %dx%d",
+                cogl_texture_get_width (texture),
+                cogl_texture_get_height (texture),
+                width, height);
+
+  return scaled;
+}
+
+/* replaces the texture with another level of detail of the same
+ * image, without changing the size of the actor */
+static void
+clutter_texture_set_lod_texture (ClutterTexture *texture,
+                                 CoglHandle      handle)
+{
+  ClutterTexturePrivate *priv = texture->priv;
+
+  if (handle == COGL_INVALID_HANDLE)
+    return;
+
+  CLUTTER_NOTE (TEXTURE, "Loaded level %u of '%s' (%dx%d)",
+                priv->lod_load_level,
+                priv->filename,
+                cogl_texture_get_width (handle),
+                cogl_texture_get_height (handle));
+
+  cogl_material_set_layer (priv->material, 0, handle);
+  priv->lod_level = priv->lod_load_level;
+
+  texture_free_alpha_mask (texture);
+
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (texture));
+}
+
+static void
+clutter_texture_load_lod (ClutterTexture *texture,
+                          guint           level)
+{
+  ClutterTexturePrivate *priv = texture->priv;
+  gint width, height;
+
+  CLUTTER_NOTE (TEXTURE, "Loading level %u of '%s'", level, priv->filename);
+
+  /* the image keeps its size whatever the level of detail */
+  width = priv->image_width;
+  height = priv->image_height;
+
+  priv->lod_load_level = level;
+  priv->lod_loading = TRUE;
+
+  if (!clutter_texture_async_load (texture, priv->filename, NULL))
+    {
+      priv->lod_loading = FALSE;
+      priv->lod_load_level = 0;
+    }
+
+  priv->image_width = width;
+  priv->image_height = height;
+}
+
+static gboolean
+clutter_texture_lod_idle (gpointer user_data)
+{
+  ClutterTexture *texture = user_data;
+  ClutterTexturePrivate *priv = texture->priv;
+
+  priv->lod_idle = 0;
+
+  if (priv->lod_loading
+      ? priv->lod_wanted_level < priv->lod_load_level
+      : priv->lod_wanted_level != priv->lod_level)
+    clutter_texture_load_lod (texture, priv->lod_wanted_level);
+
+  return FALSE;
+}
+
+/* picks the coarsest level of detail that is still at least as big as
+ * the texture on the screen; the level is loaded outside of the paint
+ * sequence, since it needs to read the header of the image file */
+static void
+clutter_texture_update_lod (ClutterTexture *texture)
+{
+  ClutterTexturePrivate *priv = texture->priv;
+  ClutterActorBox box;
+  gfloat width, height;
+  guint level;
+
+  if (priv->filename == NULL || priv->fbo_source != NULL)
+    return;
+
+  /* an image being loaded by the application replaces the texture */
+  if (priv->async_data != NULL && !priv->lod_loading)
+    return;
+
+  if (!clutter_actor_get_paint_box (CLUTTER_ACTOR (texture), &box))
+    return;
+
+  clutter_actor_box_get_size (&box, &width, &height);
+  width = MAX (width, 1);
+  height = MAX (height, 1);
+
+  level = 0;
+  while (level < MAX_LOD_LEVEL &&
+         (priv->image_width >> (level + 1)) >= width &&
+         (priv->image_height >> (level + 1)) >= height)
+    level += 1;
+
+  priv->lod_wanted_level = level;
+
+  /* a finer level replaces the one being loaded, while a coarser one
+   * waits for it */
+  if (priv->lod_loading
+      ? level >= priv->lod_load_level
+      : level == priv->lod_level)
+    return;
+
+  if (priv->lod_idle == 0)
+    priv->lod_idle = clutter_threads_add_idle (clutter_texture_lod_idle,
+                                               texture);
+}
+
 static void
-clutter_texture_async_load_complete (ClutterTexture *self,
-                                     CoglHandle      bitmap,
-                                     const GError   *error)
+clutter_texture_async_load_complete (ClutterTexture          *self,
+                                     ClutterTextureAsyncData *data,
+                                     const GError            *error)
 {
   ClutterTexturePrivate *priv = self->priv;
   CoglHandle handle;
   CoglTextureFlags flags = COGL_TEXTURE_NONE;
+  gint width, height;
+  gboolean reload, lod;
+
+  priv->async_data = NULL;
+
+  /* the reload of an evicted texture and the load of a level of
+   * detail are not new images */
+  reload = priv->reloading;
+  priv->reloading = FALSE;
+  lod = priv->lod_loading;
+  priv->lod_loading = FALSE;
+
+  if (error == NULL)
+    {
+      if (priv->no_slice)
+        flags |= COGL_TEXTURE_NO_SLICING;
+
+      if (data->load_texture != COGL_INVALID_HANDLE)
+        handle = cogl_handle_ref (data->load_texture);
+      else if (data->load_ktx != NULL)
+        handle = _clutter_ktx_image_upload (data->load_ktx, flags);
+      else
+        {
+          handle = cogl_texture_new_from_bitmap (data->load_bitmap,
+                                                 flags,
+                                                 COGL_PIXEL_FORMAT_ANY);
+        }
+
+      if (handle != COGL_INVALID_HANDLE &&
+          clutter_texture_get_scaled_load_size (self,
+                                                cogl_texture_get_width (handle),
+                                                cogl_texture_get_height (handle),
+                                                &width, &height))
+        {
+          CoglHandle scaled;
+
+          /* the scaled copy is private to this actor, so the full
+           * resolution image is not kept around in the cache either */
+          scaled = clutter_texture_scale_cogl_texture (handle, flags,
+                                                       width, height);
+          cogl_handle_unref (handle);
+          handle = scaled;
+
+          if (lod)
+            clutter_texture_set_lod_texture (self, handle);
+          else
+            clutter_texture_set_cogl_texture (self, handle);
+
+          priv->shared_texture = FALSE;
+        }
+      else
+        {
+          if (data->load_texture == COGL_INVALID_HANDLE)
+            texture_cache_insert (data->load_filename, flags, handle);
+
+          if (lod)
+            clutter_texture_set_lod_texture (self, handle);
+          else
+            clutter_texture_set_cogl_texture (self, handle);
+
+          priv->shared_texture = handle != COGL_INVALID_HANDLE;
+        }
 
-  priv->async_data = NULL;
+      if (handle != COGL_INVALID_HANDLE)
+        {
+          if (g_strcmp0 (priv->filename, data->load_filename) != 0)
+            {
+              g_free (priv->filename);
+              priv->filename = g_strdup (data->load_filename);
 
-  if (error == NULL)
-    {
-      if (priv->no_slice)
-        flags |= COGL_TEXTURE_NO_SLICING;
+              g_object_notify_by_pspec (G_OBJECT (self),
+                                        obj_props[PROP_FILENAME]);
+            }
 
-      handle = cogl_texture_new_from_bitmap (bitmap,
-                                             flags,
-                                             COGL_PIXEL_FORMAT_ANY);
-      clutter_texture_set_cogl_texture (self, handle);
+          texture_memory_track (self, handle);
+        }
 
-      if (priv->load_size_async)
+      if (priv->load_size_async && !reload && !lod)
         {
           g_signal_emit (self, texture_signals[SIZE_CHANGE], 0,
                          cogl_texture_get_width (handle),
@@ -1755,6 +3309,18 @@ clutter_texture_async_load_complete (ClutterTexture *self,
       cogl_handle_unref (handle);
     }
 
+  priv->lod_load_level = 0;
+
+  if (reload || lod)
+    {
+      if (error != NULL)
+        CLUTTER_NOTE (TEXTURE, "Failed to reload '%s': %s",
+                      data->load_filename,
+                      error->message);
+
+      return;
+    }
+
   g_signal_emit (self, texture_signals[LOAD_FINISHED], 0, error);
 
   clutter_actor_queue_relayout (CLUTTER_ACTOR (self));
@@ -1776,7 +3342,7 @@ clutter_texture_thread_idle_func (gpointer user_data)
     }
   g_mutex_unlock (data->mutex);
 
-  clutter_texture_async_load_complete (data->texture, data->load_bitmap,
+  clutter_texture_async_load_complete (data->texture, data,
                                        data->load_error);
 
   clutter_texture_async_data_free (data);
@@ -1788,25 +3354,41 @@ static gboolean
 texture_repaint_upload_func (gpointer user_data)
 {
   gulong start_time;
+  gsize uploaded;
 
   g_static_mutex_lock (&upload_list_mutex);
 
   if (upload_list)
     {
       start_time = clutter_get_timestamp ();
+      uploaded = 0;
 
-      /* continue uploading textures as long as we havent spent more
-       * then 5ms doing so this stage redraw cycle.
+      /* continue uploading textures as long as the next texture fits
+       * in the byte budget and we haven't spent more than 5ms doing so
+       * this stage redraw cycle; the first texture in the list is always
+       * uploaded, otherwise an image bigger than the budget would never
+       * be loaded
        */
       do
         {
           ClutterTextureAsyncData *data = upload_list->data;
 
+          uploaded += data->load_size;
+
           clutter_texture_thread_idle_func (data);
 
           upload_list = g_list_remove (upload_list, data);
         }
-      while (upload_list && clutter_get_timestamp () < start_time + 5 * 1000);
+      while (upload_list != NULL &&
+             uploaded + ((ClutterTextureAsyncData *) upload_list->data)->load_size
+               <= TEXTURE_UPLOAD_BUDGET &&
+             clutter_get_timestamp () < start_time + TEXTURE_UPLOAD_TIME_BUDGET);
+
+      CLUTTER_NOTE (TEXTURE, "Uploaded %" G_GSIZE_FORMAT " bytes in %lu us, "
+                    "%d textures left",
+                    uploaded,
+                    clutter_get_timestamp () - start_time,
+                    g_list_length (upload_list));
     }
 
   if (upload_list)
@@ -1823,7 +3405,8 @@ texture_repaint_upload_func (gpointer user_data)
 }
 
 static void
-clutter_texture_thread_func (gpointer user_data, gpointer pool_data)
+clutter_texture_thread_func (ClutterJob *job,
+                             gpointer    user_data)
 {
   ClutterTextureAsyncData *data = user_data;
   gboolean should_abort;
@@ -1842,8 +3425,25 @@ clutter_texture_thread_func (gpointer user_data, gpointer pool_data)
       return;
     }
 
-  data->load_bitmap = cogl_bitmap_new_from_file (data->load_filename,
-                                                 &data->load_error);
+  data->load_ktx = _clutter_ktx_image_new_from_file (data->load_filename,
+                                                     &data->load_error);
+  if (data->load_ktx != NULL)
+    data->load_size = _clutter_ktx_image_get_data_size (data->load_ktx);
+  else if (data->load_error == NULL)
+    data->load_bitmap = cogl_bitmap_new_from_file (data->load_filename,
+                                                   &data->load_error);
+
+  /* if the size was loaded asynchronously we don't know how big the
+   * image is; reading the header again is cheap compared to decoding
+   * the whole image */
+  if (data->load_bitmap != NULL && data->load_size == 0)
+    {
+      gint width, height;
+
+      if (cogl_bitmap_get_size_from_file (data->load_filename,
+                                          &width, &height))
+        data->load_size = (gsize) width * height * 4;
+    }
 
   /* Check again if we've been told to abort */
   g_mutex_lock (data->mutex);
@@ -1890,10 +3490,16 @@ clutter_texture_idle_func (gpointer user_data)
   ClutterTextureAsyncData *data = user_data;
   GError *internal_error = NULL;
 
-  data->load_bitmap = cogl_bitmap_new_from_file (data->load_filename,
-                                                 &internal_error);
+  if (data->load_texture == COGL_INVALID_HANDLE)
+    {
+      data->load_ktx = _clutter_ktx_image_new_from_file (data->load_filename,
+                                                         &internal_error);
+      if (data->load_ktx == NULL && internal_error == NULL)
+        data->load_bitmap = cogl_bitmap_new_from_file (data->load_filename,
+                                                       &internal_error);
+    }
 
-  clutter_texture_async_load_complete (data->texture, data->load_bitmap,
+  clutter_texture_async_load_complete (data->texture, data,
                                        internal_error);
 
   if (internal_error)
@@ -1935,15 +3541,31 @@ clutter_texture_async_load (ClutterTexture *self,
 {
   ClutterTexturePrivate *priv = self->priv;
   ClutterTextureAsyncData *data;
+  CoglTextureFlags flags = COGL_TEXTURE_NONE;
+  CoglHandle cached_texture;
   gint width, height;
   gboolean res;
 
+  if (priv->no_slice)
+    flags |= COGL_TEXTURE_NO_SLICING;
+
+  /* if the image is in the cache we already know its size, and we
+   * only need to defer setting the texture, so that the signals are
+   * still emitted asynchronously */
+  cached_texture = texture_cache_lookup (filename, flags);
+
   /* ask the file for a size; if we cannot get the size then
    * there's no point in even continuing the asynchronous
    * loading, so we just stop there
    */
 
-  if (priv->load_size_async)
+  if (cached_texture != COGL_INVALID_HANDLE)
+    {
+      res = TRUE;
+      width = cogl_texture_get_width (cached_texture);
+      height = cogl_texture_get_height (cached_texture);
+    }
+  else if (priv->load_size_async)
     {
       res = TRUE;
       width = 0;
@@ -1951,7 +3573,8 @@ clutter_texture_async_load (ClutterTexture *self,
     }
   else
     {
-      res = cogl_bitmap_get_size_from_file (filename, &width, &height);
+      res = _clutter_ktx_get_size_from_file (filename, &width, &height) ||
+            cogl_bitmap_get_size_from_file (filename, &width, &height);
     }
 
   if (!res)
@@ -1963,8 +3586,20 @@ clutter_texture_async_load (ClutterTexture *self,
     }
   else
     {
-      priv->image_width = width;
-      priv->image_height = height;
+      gint scaled_width, scaled_height;
+
+      if (clutter_texture_get_scaled_load_size (self, width, height,
+                                                &scaled_width,
+                                                &scaled_height))
+        {
+          priv->image_width = scaled_width;
+          priv->image_height = scaled_height;
+        }
+      else
+        {
+          priv->image_width = width;
+          priv->image_height = height;
+        }
     }
 
   clutter_texture_async_load_cancel (self);
@@ -1976,21 +3611,20 @@ clutter_texture_async_load (ClutterTexture *self,
   data->load_idle = 0;
   data->load_filename = g_strdup (filename);
   data->load_bitmap = NULL;
+  data->load_ktx = NULL;
   data->load_error = NULL;
+  data->load_texture = cached_texture;
+  data->load_size = (gsize) width * height * 4;
 
   priv->async_data = data;
 
-  if (g_thread_supported ())
+  if (cached_texture == COGL_INVALID_HANDLE && g_thread_supported ())
     {
       data->mutex = g_mutex_new ();
 
-      if (async_thread_pool == NULL)
-        /* This apparently can't fail if exclusive == FALSE */
-        async_thread_pool
-          = g_thread_pool_new (clutter_texture_thread_func,
-                               NULL, 1, FALSE, NULL);
-
-      g_thread_pool_push (async_thread_pool, data, NULL);
+      /* the decoded image is handed back through the upload list, so
+       * that the uploads can be spread over several frames */
+      clutter_job_add (clutter_texture_thread_func, NULL, data);
     }
   else
     {
@@ -2019,6 +3653,19 @@ clutter_texture_async_load (ClutterTexture *self,
  * #ClutterTexture::load-finished will be emitted when the image has been
  * loaded or if an error occurred.
  *
+ * Small images are packed by Cogl inside shared atlas textures, so
+ * that many #ClutterTexture<!-- -->s can be painted with a single
+ * draw call as long as they use the same filter quality; using
+ * %CLUTTER_TEXTURE_QUALITY_HIGH moves the image out of the atlas,
+ * since mipmaps cannot be generated for a part of a texture.
+ *
+ * Besides the image formats supported by Cogl, @filename can also be a
+ * KTX container holding an ETC1 or S3TC (DXT1, DXT3 or DXT5) compressed
+ * image; the compressed data, including all the mipmap levels stored in
+ * the file, is handed as it is to the GPU if the driver supports the
+ * format, and decoded in software otherwise. The colors of the formats
+ * with an alpha channel are expected to be premultiplied.
+ *
  * Return value: %TRUE if the image was successfully loaded and set
  *
  * Since: 0.8
@@ -2037,16 +3684,36 @@ clutter_texture_set_from_file (ClutterTexture *texture,
 
   g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
+  /* the new image replaces any reload in progress */
+  priv->reloading = FALSE;
+  priv->lod_loading = FALSE;
+  priv->lod_load_level = 0;
+
   if (priv->load_data_async)
     return clutter_texture_async_load (texture, filename, error);
 
   if (priv->no_slice)
     flags |= COGL_TEXTURE_NO_SLICING;
 
-  new_texture = cogl_texture_new_from_file (filename,
-                                            flags,
-                                            COGL_PIXEL_FORMAT_ANY,
-                                            &internal_error);
+  new_texture = texture_cache_lookup (filename, flags);
+  if (new_texture == COGL_INVALID_HANDLE)
+    {
+      ClutterKtxImage *ktx;
+
+      ktx = _clutter_ktx_image_new_from_file (filename, &internal_error);
+      if (ktx != NULL)
+        {
+          new_texture = _clutter_ktx_image_upload (ktx, flags);
+          _clutter_ktx_image_free (ktx);
+        }
+      else if (internal_error == NULL)
+        new_texture = cogl_texture_new_from_file (filename,
+                                                  flags,
+                                                  COGL_PIXEL_FORMAT_ANY,
+                                                  &internal_error);
+
+      texture_cache_insert (filename, flags, new_texture);
+    }
 
   /* If COGL didn't give an error then make one up */
   if (internal_error == NULL && new_texture == COGL_INVALID_HANDLE)
@@ -2069,7 +3736,17 @@ clutter_texture_set_from_file (ClutterTexture *texture,
   g_free (priv->filename);
   priv->filename = g_strdup (filename);
 
+  CLUTTER_NOTE (TEXTURE, "Loaded '%s' (%dx%d, %s)",
+                filename,
+                cogl_texture_get_width (new_texture),
+                cogl_texture_get_height (new_texture),
+                cogl_texture_is_sliced (new_texture) ? "sliced"
+                                                     : "not sliced");
+
   clutter_texture_set_cogl_texture (texture, new_texture);
+  priv->shared_texture = TRUE;
+
+  texture_memory_track (texture, new_texture);
 
   cogl_handle_unref (new_texture);
 
@@ -2262,6 +3939,51 @@ clutter_texture_get_base_size (ClutterTexture *texture,
     *height = texture->priv->image_height;
 }
 
+/* Replaces the Cogl texture of @texture, shared through the texture
+ * cache, with a copy that can be modified; returns the new texture */
+static CoglHandle
+clutter_texture_unshare_cogl_texture (ClutterTexture *texture)
+{
+  ClutterTexturePrivate *priv = texture->priv;
+  CoglTextureFlags flags = COGL_TEXTURE_NONE;
+  CoglHandle cogl_texture, copy;
+  CoglPixelFormat format;
+  guint width, height;
+  guchar *data;
+  gint size;
+
+  cogl_texture = clutter_texture_get_cogl_texture (texture);
+
+  width = cogl_texture_get_width (cogl_texture);
+  height = cogl_texture_get_height (cogl_texture);
+  format = cogl_texture_get_format (cogl_texture);
+
+  size = cogl_texture_get_data (cogl_texture, format, 0, NULL);
+  if (size <= 0)
+    return COGL_INVALID_HANDLE;
+
+  data = g_malloc (size);
+  cogl_texture_get_data (cogl_texture, format, 0, data);
+
+  if (priv->no_slice)
+    flags |= COGL_TEXTURE_NO_SLICING;
+
+  copy = cogl_texture_new_from_data (width, height,
+                                     flags,
+                                     format, format,
+                                     size / height,
+                                     data);
+  g_free (data);
+
+  if (copy == COGL_INVALID_HANDLE)
+    return COGL_INVALID_HANDLE;
+
+  clutter_texture_set_cogl_texture (texture, copy);
+  cogl_handle_unref (copy);
+
+  return copy;
+}
+
 /**
  * clutter_texture_set_area_from_rgb_data:
  * @texture: A #ClutterTexture
@@ -2330,6 +4052,37 @@ clutter_texture_set_area_from_rgb_data (ClutterTexture     *texture,
   if ((flags & CLUTTER_TEXTURE_RGB_FLAG_PREMULT))
     source_format |= COGL_PREMULT_BIT;
 
+  /* a whole frame goes into the next stream buffer, so that it does
+   * not touch the texture being shown; an update of a part of the
+   * frame has to modify the current texture, but the other stream
+   * buffers are overwritten entirely before being shown again */
+  if (texture->priv->n_stream_buffers > 1 &&
+      x == 0 && y == 0 &&
+      width == texture->priv->image_width &&
+      height == texture->priv->image_height)
+    {
+      cogl_texture = clutter_texture_upload_stream_buffer (texture, data,
+                                                           source_format,
+                                                           width, height,
+                                                           rowstride);
+      if (cogl_texture == COGL_INVALID_HANDLE)
+        {
+          g_set_error (error, CLUTTER_TEXTURE_ERROR,
+                       CLUTTER_TEXTURE_ERROR_BAD_FORMAT,
+                       "Failed to upload Cogl texture data");
+          return FALSE;
+        }
+
+      g_free (texture->priv->filename);
+      texture->priv->filename = NULL;
+
+      /* this emits ::pixbuf-change and queues a redraw */
+      clutter_texture_set_cogl_texture (texture, cogl_texture);
+      cogl_handle_unref (cogl_texture);
+
+      return TRUE;
+    }
+
   /* attempt to realize ... */
   if (!CLUTTER_ACTOR_IS_REALIZED (texture) &&
       clutter_actor_get_stage (CLUTTER_ACTOR (texture)) != NULL)
@@ -2350,6 +4103,20 @@ clutter_texture_set_area_from_rgb_data (ClutterTexture     *texture,
       return FALSE;
     }
 
+  /* the texture might be used by other actors loading the same
+   * file, so we need to modify a copy */
+  if (texture->priv->shared_texture)
+    {
+      cogl_texture = clutter_texture_unshare_cogl_texture (texture);
+      if (cogl_texture == COGL_INVALID_HANDLE)
+        {
+          g_set_error (error, CLUTTER_TEXTURE_ERROR,
+                       CLUTTER_TEXTURE_ERROR_BAD_FORMAT,
+                       "Failed to copy Cogl texture");
+          return FALSE;
+        }
+    }
+
   if (!cogl_texture_set_region (cogl_texture,
 				0, 0,
 				x, y, width, height,
@@ -2364,6 +4131,8 @@ clutter_texture_set_area_from_rgb_data (ClutterTexture     *texture,
       return FALSE;
     }
 
+  texture_free_alpha_mask (texture);
+
   g_free (texture->priv->filename);
   texture->priv->filename = NULL;
 
@@ -2428,6 +4197,7 @@ on_fbo_source_size_change (GObject          *object,
       cogl_material_set_layer (priv->material, 0, tex);
 
       priv->fbo_handle = cogl_offscreen_new_to_texture (tex);
+      priv->fbo_valid = FALSE;
 
       /* The material now has a reference to the texture so it will
          stick around */
@@ -2459,11 +4229,52 @@ on_fbo_parent_change (ClutterActor        *actor,
       }
 }
 
+/* adds the stage paint box of @pv to the damaged area of the fbo */
+static void
+add_fbo_damage (ClutterTexture     *texture,
+                ClutterStage       *stage,
+                ClutterPaintVolume *pv)
+{
+  ClutterTexturePrivate *priv = texture->priv;
+  ClutterActorBox box;
+
+  _clutter_paint_volume_get_stage_paint_box (pv, stage, &box);
+
+  if (priv->fbo_damaged)
+    clutter_actor_box_union (&priv->fbo_damage, &box, &priv->fbo_damage);
+  else
+    {
+      priv->fbo_damage = box;
+      priv->fbo_damaged = TRUE;
+    }
+}
+
 static void
 fbo_source_queue_redraw_cb (ClutterActor *source,
 			    ClutterActor *origin,
 			    ClutterTexture *texture)
 {
+  ClutterTexturePrivate *priv = texture->priv;
+
+  if (priv->fbo_valid)
+    {
+      ClutterActor *stage = clutter_actor_get_stage (source);
+      ClutterPaintVolume *clip, *last_pv;
+
+      /* the clip is the area the origin is going to cover; the area
+       * it covered until now has to be cleared as well */
+      clip = _clutter_actor_get_queue_redraw_clip (origin);
+      last_pv = _clutter_actor_get_last_paint_volume (origin);
+
+      if (stage == NULL || clip == NULL || last_pv == NULL)
+        priv->fbo_valid = FALSE;
+      else
+        {
+          add_fbo_damage (texture, CLUTTER_STAGE (stage), clip);
+          add_fbo_damage (texture, CLUTTER_STAGE (stage), last_pv);
+        }
+    }
+
   clutter_actor_queue_redraw (CLUTTER_ACTOR (texture));
 }
 
@@ -2705,6 +4516,9 @@ texture_fbo_free_resources (ClutterTexture *texture)
       cogl_handle_unref (priv->fbo_handle);
       priv->fbo_handle = COGL_INVALID_HANDLE;
     }
+
+  priv->fbo_valid = FALSE;
+  priv->fbo_damaged = FALSE;
 }
 
 /**
@@ -3027,6 +4841,64 @@ clutter_texture_get_load_data_async (ClutterTexture *texture)
          texture->priv->load_data_async;
 }
 
+/**
+ * clutter_texture_set_load_size_hint:
+ * @texture: a #ClutterTexture
+ * @width: the maximum width of the loaded image, or -1
+ * @height: the maximum height of the loaded image, or -1
+ *
+ * Sets the maximum size of the images loaded asynchronously by
+ * @texture; see the #ClutterTexture:load-async property.
+ *
+ * Images bigger than the given size are scaled down, preserving
+ * their aspect ratio, once they have been loaded, so that only the
+ * scaled copy is kept in texture memory. This is useful when the
+ * texture is going to be displayed at a size much smaller than the
+ * size of the image, like a thumbnail.
+ *
+ * Passing -1 for either @width or @height does not constrain that
+ * dimension. The hint only applies to the images loaded after this
+ * function has been called.
+ *
+ * Since: 1.8
+ */
+void
+clutter_texture_set_load_size_hint (ClutterTexture *texture,
+                                    gint            width,
+                                    gint            height)
+{
+  g_return_if_fail (CLUTTER_IS_TEXTURE (texture));
+
+  texture->priv->load_width_hint = width > 0 ? width : -1;
+  texture->priv->load_height_hint = height > 0 ? height : -1;
+}
+
+/**
+ * clutter_texture_get_load_size_hint:
+ * @texture: a #ClutterTexture
+ * @width: (out) (allow-none): return location for the maximum width,
+ *   or %NULL
+ * @height: (out) (allow-none): return location for the maximum height,
+ *   or %NULL
+ *
+ * Retrieves the size set using clutter_texture_set_load_size_hint()
+ *
+ * Since: 1.8
+ */
+void
+clutter_texture_get_load_size_hint (ClutterTexture *texture,
+                                    gint           *width,
+                                    gint           *height)
+{
+  g_return_if_fail (CLUTTER_IS_TEXTURE (texture));
+
+  if (width)
+    *width = texture->priv->load_width_hint;
+
+  if (height)
+    *height = texture->priv->load_height_hint;
+}
+
 /**
  * clutter_texture_set_pick_with_alpha:
  * @texture: a #ClutterTexture
@@ -3066,6 +4938,9 @@ clutter_texture_set_pick_with_alpha (ClutterTexture *texture,
       priv->pick_material = COGL_INVALID_HANDLE;
     }
 
+  if (!pick_with_alpha)
+    texture_free_alpha_mask (texture);
+
   /* NB: the pick material is created lazily when we first pick */
   priv->pick_with_alpha = pick_with_alpha;
 
@@ -3094,3 +4969,275 @@ clutter_texture_get_pick_with_alpha (ClutterTexture *texture)
   return texture->priv->pick_with_alpha ? TRUE : FALSE;
 }
 
+/**
+ * clutter_texture_set_stream_buffers:
+ * @texture: a #ClutterTexture
+ * @n_buffers: the number of stream buffers, between 1 and 3
+ *
+ * Sets the number of textures the frames set with
+ * clutter_texture_set_from_rgb_data(), or with
+ * clutter_texture_set_area_from_rgb_data() covering the whole
+ * texture, are uploaded into in turn.
+ *
+ * With a single buffer, the default, each frame replaces the texture.
+ * With two or three buffers, each frame is uploaded into a texture
+ * that is not being shown, which is then shown in place of the
+ * previous one; the textures are reused as long as the frames keep
+ * the same size and format. Three buffers make sure that the texture
+ * being updated was not used in the last two frames, for drivers that
+ * queue more than one frame.
+ *
+ * Since: 1.8
+ */
+void
+clutter_texture_set_stream_buffers (ClutterTexture *texture,
+                                    guint           n_buffers)
+{
+  ClutterTexturePrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_TEXTURE (texture));
+  g_return_if_fail (n_buffers >= 1 && n_buffers <= MAX_STREAM_BUFFERS);
+
+  priv = texture->priv;
+
+  if (priv->n_stream_buffers == n_buffers)
+    return;
+
+  /* the texture being shown is kept by the material */
+  texture_free_stream_buffers (texture);
+
+  priv->n_stream_buffers = n_buffers;
+
+  g_object_notify_by_pspec (G_OBJECT (texture),
+                            obj_props[PROP_STREAM_BUFFERS]);
+}
+
+/**
+ * clutter_texture_get_stream_buffers:
+ * @texture: a #ClutterTexture
+ *
+ * Retrieves the value set with clutter_texture_set_stream_buffers().
+ *
+ * Return value: the number of stream buffers of @texture
+ *
+ * Since: 1.8
+ */
+guint
+clutter_texture_get_stream_buffers (ClutterTexture *texture)
+{
+  g_return_val_if_fail (CLUTTER_IS_TEXTURE (texture), 1);
+
+  return texture->priv->n_stream_buffers;
+}
+
+
+/**
+ * clutter_texture_set_cache_size:
+ * @max_size: the maximum size of the texture cache, in bytes
+ *
+ * Sets the maximum amount of memory used by the textures kept in
+ * the shared texture cache. When loading an image file with
+ * clutter_texture_set_from_file(), #ClutterTexture will reuse the
+ * texture of any other actor that loaded the same file with the same
+ * #ClutterTexture:disable-slicing setting, instead of decoding and
+ * uploading the image again.
+ *
+ * The least recently used textures are dropped from the cache when
+ * its size goes over @max_size. Setting @max_size to 0 disables the
+ * cache. The default size is 16 megabytes.
+ *
+ * Since: 1.8
+ */
+void
+clutter_texture_set_cache_size (gsize max_size)
+{
+  texture_cache_max_size = max_size;
+
+  texture_cache_trim (max_size);
+}
+
+/**
+ * clutter_texture_get_cache_size:
+ *
+ * Retrieves the size set using clutter_texture_set_cache_size()
+ *
+ * Return value: the maximum size of the texture cache, in bytes
+ *
+ * Since: 1.8
+ */
+gsize
+clutter_texture_get_cache_size (void)
+{
+  return texture_cache_max_size;
+}
+
+/**
+ * clutter_texture_get_cache_statistics:
+ * @n_hits: (out) (allow-none): return location for the number of
+ *   image files loaded from the texture cache, or %NULL
+ * @n_misses: (out) (allow-none): return location for the number of
+ *   image files that were not found in the texture cache, or %NULL
+ * @used_size: (out) (allow-none): return location for the estimated
+ *   size of the textures in the cache, in bytes, or %NULL
+ *
+ * Retrieves statistics about the shared texture cache; the hit rate
+ * of the cache is @n_hits / (@n_hits + @n_misses).
+ *
+ * See also clutter_texture_set_cache_size().
+ *
+ * Since: 1.8
+ */
+void
+clutter_texture_get_cache_statistics (guint *n_hits,
+                                      guint *n_misses,
+                                      gsize *used_size)
+{
+  if (n_hits)
+    *n_hits = texture_cache_hits;
+
+  if (n_misses)
+    *n_misses = texture_cache_misses;
+
+  if (used_size)
+    *used_size = texture_cache_size;
+}
+
+/**
+ * clutter_texture_set_memory_budget:
+ * @max_size: the maximum size of the textures loaded from image
+ *   files, in bytes, or 0
+ *
+ * Sets the amount of memory the textures loaded from image files with
+ * clutter_texture_set_from_file() can use. When the estimated size of
+ * the textures goes over @max_size, the textures of the unmapped
+ * #ClutterTexture<!-- -->s are released, starting from the ones that
+ * were unmapped first; a #ClutterTexture keeps the size of its image
+ * while its texture is released, and loads the image again
+ * asynchronously when it is mapped.
+ *
+ * Setting @max_size to 0, the default, disables the budget.
+ *
+ * A texture used by other actors, or kept in the shared texture cache
+ * (see clutter_texture_set_cache_size()), is only freed when they
+ * release it as well.
+ *
+ * Since: 1.8
+ */
+void
+clutter_texture_set_memory_budget (gsize max_size)
+{
+  texture_memory_budget = max_size;
+
+  texture_memory_trim ();
+}
+
+/**
+ * clutter_texture_get_memory_budget:
+ *
+ * Retrieves the size set using clutter_texture_set_memory_budget()
+ *
+ * Return value: the maximum size of the textures loaded from image
+ *   files, in bytes, or 0 if there is no budget
+ *
+ * Since: 1.8
+ */
+gsize
+clutter_texture_get_memory_budget (void)
+{
+  return texture_memory_budget;
+}
+
+/**
+ * clutter_texture_get_memory_statistics:
+ * @n_evictions: (out) (allow-none): return location for the number
+ *   of textures released to stay within the memory budget, or %NULL
+ * @n_reloads: (out) (allow-none): return location for the number of
+ *   released textures that were loaded again, or %NULL
+ * @used_size: (out) (allow-none): return location for the estimated
+ *   size of the textures loaded from image files, in bytes, or %NULL
+ *
+ * Retrieves statistics about the texture memory budget.
+ *
+ * See also clutter_texture_set_memory_budget().
+ *
+ * Since: 1.8
+ */
+void
+clutter_texture_get_memory_statistics (guint *n_evictions,
+                                       guint *n_reloads,
+                                       gsize *used_size)
+{
+  if (n_evictions)
+    *n_evictions = texture_n_evictions;
+
+  if (n_reloads)
+    *n_reloads = texture_n_reloads;
+
+  if (used_size)
+    *used_size = texture_memory_used;
+}
+
+/**
+ * clutter_texture_set_auto_lod:
+ * @texture: a #ClutterTexture
+ * @auto_lod: %TRUE if the resolution of the image should follow the
+ *   size of @texture on the screen
+ *
+ * Sets whether the resolution of the image loaded with
+ * clutter_texture_set_from_file() should follow the size of @texture
+ * on the screen.
+ *
+ * When @auto_lod is %TRUE, an image painted smaller than its size is
+ * loaded again, asynchronously, at the smallest power of two fraction
+ * of its size that is still bigger than the area it covers on the
+ * screen, and the full resolution texture is released; when @texture
+ * gets bigger again, the levels of detail it needs are loaded back.
+ * The size of the image, and so the layout of @texture, does not
+ * change.
+ *
+ * Since: 1.8
+ */
+void
+clutter_texture_set_auto_lod (ClutterTexture *texture,
+                              gboolean        auto_lod)
+{
+  ClutterTexturePrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_TEXTURE (texture));
+
+  priv = texture->priv;
+
+  auto_lod = !!auto_lod;
+  if (priv->auto_lod == auto_lod)
+    return;
+
+  priv->auto_lod = auto_lod;
+
+  /* load the full resolution image back */
+  if (!auto_lod && priv->filename != NULL &&
+      (priv->lod_level != 0 || priv->lod_loading))
+    clutter_texture_load_lod (texture, 0);
+
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (texture));
+
+  g_object_notify_by_pspec (G_OBJECT (texture), obj_props[PROP_AUTO_LOD]);
+}
+
+/**
+ * clutter_texture_get_auto_lod:
+ * @texture: a #ClutterTexture
+ *
+ * Retrieves the value set with clutter_texture_set_auto_lod().
+ *
+ * Return value: %TRUE if the resolution of the image follows the size
+ *   of @texture on the screen
+ *
+ * Since: 1.8
+ */
+gboolean
+clutter_texture_get_auto_lod (ClutterTexture *texture)
+{
+  g_return_val_if_fail (CLUTTER_IS_TEXTURE (texture), FALSE);
+
+  return texture->priv->auto_lod;
+}
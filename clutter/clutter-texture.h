@@ -142,6 +142,23 @@ typedef enum { /*< prefix=CLUTTER_TEXTURE >*/
   /* FIXME: add compressed types ? */
 } ClutterTextureFlags;
 
+/**
+ * ClutterTextureYUVFormat:
+ * @CLUTTER_TEXTURE_YUV_FORMAT_I420: three planes: Y at full resolution,
+ *   followed by U and V at half resolution in both directions
+ * @CLUTTER_TEXTURE_YUV_FORMAT_NV12: two planes: Y at full resolution,
+ *   followed by interleaved U and V samples at half resolution in both
+ *   directions
+ *
+ * The layouts of the planes for clutter_texture_set_from_yuv_planes().
+ *
+ * Since: 1.8
+ */
+typedef enum { /*< prefix=CLUTTER_TEXTURE_YUV_FORMAT >*/
+  CLUTTER_TEXTURE_YUV_FORMAT_I420,
+  CLUTTER_TEXTURE_YUV_FORMAT_NV12
+} ClutterTextureYUVFormat;
+
 /**
  * ClutterTextureQuality:
  * @CLUTTER_TEXTURE_QUALITY_LOW: fastest rendering will use nearest neighbour
@@ -185,6 +202,13 @@ gboolean              clutter_texture_set_from_yuv_data     (ClutterTexture
                                                              gint                    height,
                                                              ClutterTextureFlags     flags,
                                                              GError                **error);
+gboolean              clutter_texture_set_from_yuv_planes   (ClutterTexture          *texture,
+                                                             ClutterTextureYUVFormat  format,
+                                                             gint                     width,
+                                                             gint                     height,
+                                                             const guint8 * const    *planes,
+                                                             const gint              *rowstrides,
+                                                             GError                 **error);
 gboolean             clutter_texture_set_area_from_rgb_data (ClutterTexture         *texture,
                                                              const guchar           *data,
                                                              gboolean                has_alpha,
@@ -228,11 +252,37 @@ gboolean              clutter_texture_get_load_async        (ClutterTexture
 void                  clutter_texture_set_load_data_async   (ClutterTexture         *texture,
                                                              gboolean                load_async);
 gboolean              clutter_texture_get_load_data_async   (ClutterTexture         *texture);
+void                  clutter_texture_set_load_size_hint    (ClutterTexture         *texture,
+                                                             gint                    width,
+                                                             gint                    height);
+void                  clutter_texture_get_load_size_hint    (ClutterTexture         *texture,
+                                                             gint                   *width,
+                                                             gint                   *height);
 
 void                  clutter_texture_set_pick_with_alpha   (ClutterTexture         *texture,
                                                              gboolean                pick_with_alpha);
 gboolean              clutter_texture_get_pick_with_alpha   (ClutterTexture         *texture);
 
+void                  clutter_texture_set_stream_buffers    (ClutterTexture         *texture,
+                                                             guint                   n_buffers);
+guint                 clutter_texture_get_stream_buffers    (ClutterTexture         *texture);
+
+void                  clutter_texture_set_auto_lod          (ClutterTexture         *texture,
+                                                             gboolean                auto_lod);
+gboolean              clutter_texture_get_auto_lod          (ClutterTexture         *texture);
+
+void                  clutter_texture_set_cache_size        (gsize                   max_size);
+gsize                 clutter_texture_get_cache_size        (void);
+void                  clutter_texture_get_cache_statistics  (guint                  *n_hits,
+                                                             guint                  *n_misses,
+                                                             gsize                  *used_size);
+
+void                  clutter_texture_set_memory_budget     (gsize                   max_size);
+gsize                 clutter_texture_get_memory_budget     (void);
+void                  clutter_texture_get_memory_statistics (guint                  *n_evictions,
+                                                             guint                  *n_reloads,
+                                                             gsize                  *used_size);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_TEXTURE_H__ */
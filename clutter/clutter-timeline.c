@@ -41,6 +41,7 @@
 #include "clutter-marshal.h"
 #include "clutter-master-clock.h"
 #include "clutter-private.h"
+#include "clutter-stage.h"
 #include "clutter-timeline.h"
 
 G_DEFINE_TYPE (ClutterTimeline, clutter_timeline, G_TYPE_OBJECT);
@@ -63,9 +64,15 @@ struct _ClutterTimelinePrivate
 
   GHashTable *markers_by_name;
 
+  /* the same markers, sorted by time */
+  GArray *markers_by_time;
+
   /* Time we last advanced the elapsed time and showed a frame */
   gint64 last_frame_time;
 
+  /* the stage whose frame clock advances the timeline, or NULL */
+  ClutterStage *stage;
+
   guint loop               : 1;
   guint is_playing         : 1;
 
@@ -91,6 +98,7 @@ enum
   PROP_DURATION,
   PROP_DIRECTION,
   PROP_AUTO_REVERSE,
+  PROP_STAGE,
 
   PROP_LAST
 };
@@ -167,6 +175,10 @@ clutter_timeline_set_property (GObject      *object,
       clutter_timeline_set_auto_reverse (timeline, g_value_get_boolean (value));
       break;
 
+    case PROP_STAGE:
+      clutter_timeline_set_stage (timeline, g_value_get_object (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -204,6 +216,10 @@ clutter_timeline_get_property (GObject    *object,
       g_value_set_boolean (value, priv->auto_reverse);
       break;
 
+    case PROP_STAGE:
+      g_value_set_object (value, priv->stage);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -220,6 +236,9 @@ clutter_timeline_finalize (GObject *object)
   if (priv->markers_by_name)
     g_hash_table_destroy (priv->markers_by_name);
 
+  if (priv->markers_by_time)
+    g_array_free (priv->markers_by_time, TRUE);
+
   if (priv->is_playing)
     {
       master_clock = _clutter_master_clock_get_default ();
@@ -243,6 +262,13 @@ clutter_timeline_dispose (GObject *object)
       priv->delay_id = 0;
     }
 
+  if (priv->stage != NULL)
+    {
+      g_object_remove_weak_pointer (G_OBJECT (priv->stage),
+                                    (gpointer *) &priv->stage);
+      priv->stage = NULL;
+    }
+
   G_OBJECT_CLASS (clutter_timeline_parent_class)->dispose (object);
 }
 
@@ -328,6 +354,23 @@ clutter_timeline_class_init (ClutterTimelineClass *klass)
                           FALSE,
                           CLUTTER_PARAM_READWRITE);
 
+  /**
+   * ClutterTimeline:stage:
+   *
+   * The #ClutterStage whose frame clock advances the timeline, or
+   * %NULL if the timeline is advanced by the master clock.
+   *
+   * See clutter_timeline_set_stage().
+   *
+   * Since: 1.8
+   */
+  obj_props[PROP_STAGE] =
+    g_param_spec_object ("stage",
+                         P_("Stage"),
+                         P_("The stage whose frame clock advances the timeline"),
+                         CLUTTER_TYPE_STAGE,
+                         CLUTTER_PARAM_READWRITE);
+
   object_class->dispose      = clutter_timeline_dispose;
   object_class->finalize     = clutter_timeline_finalize;
   object_class->set_property = clutter_timeline_set_property;
@@ -506,30 +549,52 @@ have_passed_time (const struct CheckIfMarkerHitClosure *data,
 }
 
 static void
-check_if_marker_hit (const gchar *name,
-                     TimelineMarker *marker,
+check_if_marker_hit (TimelineMarker                 *marker,
                      struct CheckIfMarkerHitClosure *data)
 {
   if (have_passed_time (data, marker->msecs))
     {
-      CLUTTER_NOTE (SCHEDULER, "Marker '%s' reached", name);
+      CLUTTER_NOTE (SCHEDULER, "Marker '%s' reached", marker->name);
 
       g_signal_emit (data->timeline, timeline_signals[MARKER_REACHED],
                      marker->quark,
-                     name,
+                     marker->name,
                      marker->msecs);
     }
 }
 
+/* returns the index of the first marker at or after @msecs */
+static guint
+timeline_find_marker_index (GArray *markers,
+                            gint64  msecs)
+{
+  guint lo = 0, hi = markers->len;
+
+  while (lo < hi)
+    {
+      guint mid = (lo + hi) / 2;
+
+      if (g_array_index (markers, TimelineMarker *, mid)->msecs < msecs)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  return lo;
+}
+
 static void
 check_markers (ClutterTimeline *timeline,
                gint delta)
 {
   ClutterTimelinePrivate *priv = timeline->priv;
   struct CheckIfMarkerHitClosure data;
+  GArray *markers;
+  gint64 lower, upper;
+  guint i;
 
   /* shortcircuit here if we don't have any marker installed */
-  if (priv->markers_by_name == NULL)
+  if (priv->markers_by_time == NULL || priv->markers_by_time->len == 0)
     return;
 
   /* store the details of the timeline so that changing them in a
@@ -540,9 +605,37 @@ check_markers (ClutterTimeline *timeline,
   data.duration = priv->duration;
   data.delta = delta;
 
-  g_hash_table_foreach (priv->markers_by_name,
-                        (GHFunc) check_if_marker_hit,
-                        &data);
+  /* only the markers between the previous and the new time can be
+   * hit; we find the first one with a binary search, and let
+   * have_passed_time() deal with the bounds of the range
+   */
+  if (data.direction == CLUTTER_TIMELINE_FORWARD)
+    {
+      lower = (gint64) data.new_time - data.delta;
+      upper = data.new_time;
+    }
+  else
+    {
+      lower = data.new_time;
+      upper = (gint64) data.new_time + data.delta;
+    }
+
+  markers = priv->markers_by_time;
+
+  /* the signal handlers might add or remove markers, so we need to
+   * check the size of the array at each iteration
+   */
+  for (i = timeline_find_marker_index (markers, MAX (lower, 0));
+       i < markers->len;
+       i++)
+    {
+      TimelineMarker *marker = g_array_index (markers, TimelineMarker *, i);
+
+      if (marker->msecs > upper)
+        break;
+
+      check_if_marker_hit (marker, &data);
+    }
 }
 
 static void
@@ -1320,6 +1413,84 @@ clutter_timeline_add_marker_internal (ClutterTimeline *timeline,
 
   marker = timeline_marker_new (marker_name, msecs);
   g_hash_table_insert (priv->markers_by_name, marker->name, marker);
+
+  if (G_UNLIKELY (priv->markers_by_time == NULL))
+    priv->markers_by_time = g_array_new (FALSE, FALSE,
+                                         sizeof (TimelineMarker *));
+
+  /* markers at the same time are kept in the order they were added */
+  g_array_insert_val (priv->markers_by_time,
+                      timeline_find_marker_index (priv->markers_by_time,
+                                                  (gint64) msecs + 1),
+                      marker);
+}
+
+/*< private >
+ * _clutter_timeline_get_next_deadline:
+ * @timeline: a #ClutterTimeline
+ *
+ * Computes how long the master clock can wait before advancing
+ * @timeline without skipping anything observable: a timeline with
+ * handlers of the #ClutterTimeline::new-frame signal needs to be
+ * advanced at each frame, while a timeline used only for its markers
+ * or for the #ClutterTimeline::completed signal can wait until the
+ * next marker or until its end.
+ *
+ * Return value: the number of milliseconds until @timeline needs to
+ *   be advanced, 0 if it should be advanced at each frame, or
+ *   %G_MAXUINT if it is not playing
+ */
+guint
+_clutter_timeline_get_next_deadline (ClutterTimeline *timeline)
+{
+  ClutterTimelinePrivate *priv = timeline->priv;
+  gint64 deadline;
+
+  if (!priv->is_playing)
+    return G_MAXUINT;
+
+  if (priv->waiting_first_tick)
+    return 0;
+
+  /* this includes the handler installed by ClutterAlpha */
+  if (CLUTTER_TIMELINE_GET_CLASS (timeline)->new_frame != NULL ||
+      g_signal_has_handler_pending (timeline,
+                                    timeline_signals[NEW_FRAME],
+                                    0, FALSE))
+    return 0;
+
+  if (priv->direction == CLUTTER_TIMELINE_FORWARD)
+    deadline = (gint64) priv->duration - priv->elapsed_time;
+  else
+    deadline = priv->elapsed_time;
+
+  if (priv->markers_by_time != NULL && priv->markers_by_time->len > 0)
+    {
+      GArray *markers = priv->markers_by_time;
+      TimelineMarker *marker;
+      guint i;
+
+      if (priv->direction == CLUTTER_TIMELINE_FORWARD)
+        {
+          i = timeline_find_marker_index (markers, priv->elapsed_time + 1);
+          if (i < markers->len)
+            {
+              marker = g_array_index (markers, TimelineMarker *, i);
+              deadline = MIN (deadline, marker->msecs - priv->elapsed_time);
+            }
+        }
+      else
+        {
+          i = timeline_find_marker_index (markers, priv->elapsed_time);
+          if (i > 0)
+            {
+              marker = g_array_index (markers, TimelineMarker *, i - 1);
+              deadline = MIN (deadline, priv->elapsed_time - marker->msecs);
+            }
+        }
+    }
+
+  return CLAMP (deadline, 0, G_MAXINT);
 }
 
 /**
@@ -1497,6 +1668,7 @@ clutter_timeline_remove_marker (ClutterTimeline *timeline,
 {
   ClutterTimelinePrivate *priv;
   TimelineMarker *marker;
+  guint i;
 
   g_return_if_fail (CLUTTER_IS_TIMELINE (timeline));
   g_return_if_fail (marker_name != NULL);
@@ -1516,6 +1688,17 @@ clutter_timeline_remove_marker (ClutterTimeline *timeline,
       return;
     }
 
+  for (i = timeline_find_marker_index (priv->markers_by_time, marker->msecs);
+       i < priv->markers_by_time->len;
+       i++)
+    {
+      if (g_array_index (priv->markers_by_time, TimelineMarker *, i) == marker)
+        {
+          g_array_remove_index (priv->markers_by_time, i);
+          break;
+        }
+    }
+
   /* this will take care of freeing the marker as well */
   g_hash_table_remove (priv->markers_by_name, marker_name);
 }
@@ -1628,3 +1811,68 @@ clutter_timeline_get_auto_reverse (ClutterTimeline *timeline)
 
   return timeline->priv->auto_reverse;
 }
+
+/**
+ * clutter_timeline_set_stage:
+ * @timeline: a #ClutterTimeline
+ * @stage: (allow-none): a #ClutterStage, or %NULL
+ *
+ * Binds @timeline to the frame clock of @stage.
+ *
+ * By default every timeline is advanced once per iteration of the
+ * master clock, before any stage is updated. When the stages are shown
+ * on outputs with different refresh rates, each stage is drawn in time
+ * for the vblank of its own output; a timeline bound to a stage is
+ * advanced right before that stage is updated, using the time at which
+ * the new frame is going to be presented, so that the animations it
+ * drives move by the same amount at each refresh of that output.
+ *
+ * The timeline is unbound if @stage is destroyed.
+ *
+ * Since: 1.8
+ */
+void
+clutter_timeline_set_stage (ClutterTimeline *timeline,
+                            ClutterStage    *stage)
+{
+  ClutterTimelinePrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_TIMELINE (timeline));
+  g_return_if_fail (stage == NULL || CLUTTER_IS_STAGE (stage));
+
+  priv = timeline->priv;
+
+  if (priv->stage == stage)
+    return;
+
+  if (priv->stage != NULL)
+    g_object_remove_weak_pointer (G_OBJECT (priv->stage),
+                                  (gpointer *) &priv->stage);
+
+  priv->stage = stage;
+
+  if (priv->stage != NULL)
+    g_object_add_weak_pointer (G_OBJECT (priv->stage),
+                               (gpointer *) &priv->stage);
+
+  g_object_notify_by_pspec (G_OBJECT (timeline), obj_props[PROP_STAGE]);
+}
+
+/**
+ * clutter_timeline_get_stage:
+ * @timeline: a #ClutterTimeline
+ *
+ * Retrieves the stage set by clutter_timeline_set_stage().
+ *
+ * Return value: (transfer none): the #ClutterStage whose frame clock
+ *   advances @timeline, or %NULL
+ *
+ * Since: 1.8
+ */
+ClutterStage *
+clutter_timeline_get_stage (ClutterTimeline *timeline)
+{
+  g_return_val_if_fail (CLUTTER_IS_TIMELINE (timeline), NULL);
+
+  return timeline->priv->stage;
+}
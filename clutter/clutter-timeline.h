@@ -30,6 +30,7 @@
 
 #include <glib-object.h>
 #include <clutter/clutter-fixed.h>
+#include <clutter/clutter-types.h>
 
 G_BEGIN_DECLS
 
@@ -130,6 +131,9 @@ gboolean         clutter_timeline_get_loop              (ClutterTimeline *timeli
 void             clutter_timeline_set_auto_reverse      (ClutterTimeline *timeline,
                                                          gboolean         reverse);
 gboolean         clutter_timeline_get_auto_reverse      (ClutterTimeline *timeline);
+void             clutter_timeline_set_stage             (ClutterTimeline *timeline,
+                                                         ClutterStage    *stage);
+ClutterStage *   clutter_timeline_get_stage             (ClutterTimeline *timeline);
 void             clutter_timeline_rewind                (ClutterTimeline *timeline);
 void             clutter_timeline_skip                  (ClutterTimeline *timeline,
                                                          guint            msecs);
@@ -159,6 +163,7 @@ void             clutter_timeline_advance_to_marker     (ClutterTimeline *timeli
 /*< private >*/
 void             _clutter_timeline_do_tick              (ClutterTimeline *timeline,
                                                          gint64           tick_time);
+guint            _clutter_timeline_get_next_deadline    (ClutterTimeline *timeline);
 
 G_END_DECLS
 
@@ -51,6 +51,10 @@ struct _ClutterTimeout
   ClutterTimeoutFlags flags;
   gint refcount;
 
+  /* the position of the timeout inside the heap of the pool, or -1
+   * if the timeout has been removed from the pool */
+  gint heap_index;
+
   ClutterTimeoutInterval interval;
 
   GSourceFunc func;
@@ -64,15 +68,21 @@ struct _ClutterTimeoutPool
 
   guint next_id;
 
-  GList *timeouts;
-  GList *dispatched_timeouts;
+  /* a binary heap of ClutterTimeout, ordered by expiration, so that
+   * the next timeout to expire is always the first element */
+  GPtrArray *timeouts;
+
+  /* maps the ids to the timeouts, for clutter_timeout_pool_remove() */
+  GHashTable *timeouts_by_id;
 
-  gint ready;
+  /* the timeouts being dispatched, reused on every dispatch */
+  GPtrArray *dispatched_timeouts;
 
   guint id;
 };
 
-#define TIMEOUT_READY(timeout)   (timeout->flags & CLUTTER_TIMEOUT_READY)
+#define HEAP_PARENT(i)           (((i) - 1) / 2)
+#define HEAP_LEFT_CHILD(i)       ((i) * 2 + 1)
 
 static gboolean clutter_timeout_pool_prepare  (GSource     *source,
                                                gint        *next_timeout);
@@ -94,29 +104,13 @@ static gint
 clutter_timeout_sort (gconstpointer a,
                       gconstpointer b)
 {
-  const ClutterTimeout *t_a = a;
-  const ClutterTimeout *t_b = b;
-
-  /* Keep 'ready' timeouts at the front */
-  if (TIMEOUT_READY (t_a))
-    return -1;
-
-  if (TIMEOUT_READY (t_b))
-    return 1;
+  const ClutterTimeout *t_a = *((const ClutterTimeout **) a);
+  const ClutterTimeout *t_b = *((const ClutterTimeout **) b);
 
   return _clutter_timeout_interval_compare_expiration (&t_a->interval,
                                                        &t_b->interval);
 }
 
-static gint
-clutter_timeout_find_by_id (gconstpointer a,
-                            gconstpointer b)
-{
-  const ClutterTimeout *t_a = a;
-
-  return t_a->id == GPOINTER_TO_UINT (b) ? 0 : 1;
-}
-
 static ClutterTimeout *
 clutter_timeout_new (guint fps)
 {
@@ -126,6 +120,7 @@ clutter_timeout_new (guint fps)
   _clutter_timeout_interval_init (&timeout->interval, fps);
   timeout->flags = CLUTTER_TIMEOUT_NONE;
   timeout->refcount = 1;
+  timeout->heap_index = -1;
 
   return timeout;
 }
@@ -197,55 +192,223 @@ clutter_timeout_free (ClutterTimeout *timeout)
     }
 }
 
+static inline ClutterTimeout *
+heap_get (ClutterTimeoutPool *pool,
+          gint                index_)
+{
+  return g_ptr_array_index (pool->timeouts, index_);
+}
+
+static inline void
+heap_set (ClutterTimeoutPool *pool,
+          gint                index_,
+          ClutterTimeout     *timeout)
+{
+  g_ptr_array_index (pool->timeouts, index_) = timeout;
+  timeout->heap_index = index_;
+}
+
+/* moves the timeout at @index_ towards the root, until it does not
+ * expire before its parent */
+static void
+heap_sift_up (ClutterTimeoutPool *pool,
+              gint                index_)
+{
+  ClutterTimeout *timeout = heap_get (pool, index_);
+
+  while (index_ > 0)
+    {
+      ClutterTimeout *parent = heap_get (pool, HEAP_PARENT (index_));
+
+      if (_clutter_timeout_interval_compare_expiration (&timeout->interval,
+                                                        &parent->interval) >= 0)
+        break;
+
+      heap_set (pool, index_, parent);
+      index_ = HEAP_PARENT (index_);
+    }
+
+  heap_set (pool, index_, timeout);
+}
+
+/* moves the timeout at @index_ towards the leaves, until none of its
+ * children expires before it */
+static void
+heap_sift_down (ClutterTimeoutPool *pool,
+                gint                index_)
+{
+  ClutterTimeout *timeout = heap_get (pool, index_);
+  gint len = pool->timeouts->len;
+
+  while (HEAP_LEFT_CHILD (index_) < len)
+    {
+      gint child = HEAP_LEFT_CHILD (index_);
+      ClutterTimeout *first = heap_get (pool, child);
+
+      if (child + 1 < len)
+        {
+          ClutterTimeout *right = heap_get (pool, child + 1);
+
+          if (_clutter_timeout_interval_compare_expiration (&right->interval,
+                                                            &first->interval) < 0)
+            {
+              child += 1;
+              first = right;
+            }
+        }
+
+      if (_clutter_timeout_interval_compare_expiration (&first->interval,
+                                                        &timeout->interval) >= 0)
+        break;
+
+      heap_set (pool, index_, first);
+      index_ = child;
+    }
+
+  heap_set (pool, index_, timeout);
+}
+
+/* restores the heap after the expiration of @timeout changed */
+static void
+heap_update (ClutterTimeoutPool *pool,
+             ClutterTimeout     *timeout)
+{
+  gint index_ = timeout->heap_index;
+
+  heap_sift_up (pool, index_);
+
+  if (timeout->heap_index == index_)
+    heap_sift_down (pool, index_);
+}
+
+static void
+heap_insert (ClutterTimeoutPool *pool,
+             ClutterTimeout     *timeout)
+{
+  g_ptr_array_add (pool->timeouts, timeout);
+  heap_sift_up (pool, pool->timeouts->len - 1);
+}
+
+static void
+heap_remove (ClutterTimeoutPool *pool,
+             ClutterTimeout     *timeout)
+{
+  gint index_ = timeout->heap_index;
+  gint last = pool->timeouts->len - 1;
+
+  timeout->heap_index = -1;
+
+  if (index_ != last)
+    {
+      ClutterTimeout *moved = heap_get (pool, last);
+
+      heap_set (pool, index_, moved);
+      g_ptr_array_set_size (pool->timeouts, last);
+      heap_update (pool, moved);
+    }
+  else
+    g_ptr_array_set_size (pool->timeouts, last);
+}
+
+/* removes @timeout from @pool and drops the reference held by it */
+static void
+clutter_timeout_pool_remove_timeout (ClutterTimeoutPool *pool,
+                                     ClutterTimeout     *timeout)
+{
+  heap_remove (pool, timeout);
+  g_hash_table_remove (pool->timeouts_by_id, GUINT_TO_POINTER (timeout->id));
+
+  clutter_timeout_unref (timeout);
+}
+
+/* collects the expired timeouts in pool->dispatched_timeouts; as no
+ * timeout in the heap expires before its parent, only the children of
+ * the expired timeouts need to be checked */
+static void
+clutter_timeout_pool_collect_ready (ClutterTimeoutPool *pool)
+{
+  GPtrArray *ready = pool->dispatched_timeouts;
+  guint i;
+
+  if (pool->timeouts->len == 0)
+    return;
+
+  if (!clutter_timeout_prepare (pool, heap_get (pool, 0), NULL))
+    return;
+
+  g_ptr_array_add (ready, heap_get (pool, 0));
+
+  for (i = 0; i < ready->len; i++)
+    {
+      ClutterTimeout *timeout = g_ptr_array_index (ready, i);
+      gint child = HEAP_LEFT_CHILD (timeout->heap_index);
+      gint last = MIN (child + 1, (gint) pool->timeouts->len - 1);
+
+      timeout->flags |= CLUTTER_TIMEOUT_READY;
+
+      for (; child <= last; child++)
+        {
+          ClutterTimeout *candidate = heap_get (pool, child);
+
+          if (clutter_timeout_prepare (pool, candidate, NULL))
+            g_ptr_array_add (ready, candidate);
+        }
+    }
+
+  /* preparing a timeout that is late by more than two frames resets
+   * its expiration, so the heap has to be fixed for them */
+  for (i = 0; i < ready->len; i++)
+    heap_update (pool, g_ptr_array_index (ready, i));
+}
+
 static gboolean
 clutter_timeout_pool_prepare (GSource *source,
                               gint    *next_timeout)
 {
   ClutterTimeoutPool *pool = (ClutterTimeoutPool *) source;
-  GList *l = pool->timeouts;
+  ClutterTimeout *timeout;
+  gboolean retval;
 
   /* the pool is ready if the first timeout is ready */
-  if (l && l->data)
-    {
-      ClutterTimeout *timeout = l->data;
-      return clutter_timeout_prepare (pool, timeout, next_timeout);
-    }
-  else
+  if (pool->timeouts->len == 0)
     {
       *next_timeout = -1;
       return FALSE;
     }
+
+  timeout = heap_get (pool, 0);
+  retval = clutter_timeout_prepare (pool, timeout, next_timeout);
+
+  /* the expiration might have been reset */
+  if (retval)
+    heap_update (pool, timeout);
+
+  return retval;
 }
 
 static gboolean
 clutter_timeout_pool_check (GSource *source)
 {
   ClutterTimeoutPool *pool = (ClutterTimeoutPool *) source;
-  GList *l;
+  ClutterTimeout *timeout;
+  gboolean retval;
 
   clutter_threads_enter ();
 
-  for (l = pool->timeouts; l; l = l->next)
+  if (pool->timeouts->len > 0)
     {
-      ClutterTimeout *timeout = l->data;
-
-      /* since the timeouts are sorted by expiration, as soon
-       * as we get a check returning FALSE we know that the
-       * following timeouts are not expiring, so we break as
-       * soon as possible
-       */
-      if (clutter_timeout_prepare (pool, timeout, NULL))
-        {
-          timeout->flags |= CLUTTER_TIMEOUT_READY;
-          pool->ready += 1;
-        }
-      else
-        break;
+      timeout = heap_get (pool, 0);
+      retval = clutter_timeout_prepare (pool, timeout, NULL);
+
+      if (retval)
+        heap_update (pool, timeout);
     }
+  else
+    retval = FALSE;
 
   clutter_threads_leave ();
 
-  return (pool->ready > 0);
+  return retval;
 }
 
 static gboolean
@@ -254,94 +417,45 @@ clutter_timeout_pool_dispatch (GSource     *source,
                                gpointer     data)
 {
   ClutterTimeoutPool *pool = (ClutterTimeoutPool *) source;
-  GList *dispatched_timeouts;
-
-  /* the main loop might have predicted this, so we repeat the
-   * check for ready timeouts.
-   */
-  if (!pool->ready)
-    clutter_timeout_pool_check (source);
+  GPtrArray *ready = pool->dispatched_timeouts;
+  guint i;
 
   clutter_threads_enter ();
 
-  /* Iterate by moving the actual start of the list along so that it
-   * can cope with adds and removes while a timeout is being dispatched
+  clutter_timeout_pool_collect_ready (pool);
+
+  /* dispatch the ready timeouts in order of expiration; each one is
+   * referenced so that it can't disappear if one of the functions
+   * removes it
    */
-  while (pool->timeouts && pool->timeouts->data && pool->ready-- > 0)
+  g_ptr_array_sort (ready, clutter_timeout_sort);
+  g_ptr_array_foreach (ready, (GFunc) clutter_timeout_ref, NULL);
+
+  for (i = 0; i < ready->len; i++)
     {
-      ClutterTimeout *timeout = pool->timeouts->data;
-      GList *l;
-
-      /* One of the ready timeouts may have been removed during dispatch,
-       * in which case pool->ready will be wrong, but the ready timeouts
-       * are always kept at the start of the list so we can stop once
-       * we've reached the first non-ready timeout
-       */
-      if (!(TIMEOUT_READY (timeout)))
-	break;
-
-      /* Add a reference to the timeout so it can't disappear
-       * while it's being dispatched
-       */
-      clutter_timeout_ref (timeout);
+      ClutterTimeout *timeout = g_ptr_array_index (ready, i);
 
       timeout->flags &= ~CLUTTER_TIMEOUT_READY;
 
-      /* Move the list node to a list of dispatched timeouts */
-      l = pool->timeouts;
-      if (l->next)
-	l->next->prev = NULL;
-
-      pool->timeouts = l->next;
-
-      if (pool->dispatched_timeouts)
-	pool->dispatched_timeouts->prev = l;
-
-      l->prev = NULL;
-      l->next = pool->dispatched_timeouts;
-      pool->dispatched_timeouts = l;
-
-      if (!_clutter_timeout_interval_dispatch (&timeout->interval,
-                                               timeout->func, timeout->data))
-	{
-	  /* The timeout may have already been removed, but nothing
-           * can be added to the dispatched_timeout list except in this
-           * function so it will always either be at the head of the
-           * dispatched list or have been removed
-           */
-          if (pool->dispatched_timeouts &&
-              pool->dispatched_timeouts->data == timeout)
-	    {
-	      pool->dispatched_timeouts =
-                g_list_delete_link (pool->dispatched_timeouts,
-                                    pool->dispatched_timeouts);
-
-	      /* Remove the reference that was held by it being in the list */
-	      clutter_timeout_unref (timeout);
-	    }
-	}
-
-      clutter_timeout_unref (timeout);
-    }
-
-  /* Re-insert the dispatched timeouts in sorted order */
-  dispatched_timeouts = pool->dispatched_timeouts;
-  while (dispatched_timeouts)
-    {
-      ClutterTimeout *timeout = dispatched_timeouts->data;
-      GList *next = dispatched_timeouts->next;
+      /* the timeout was removed by one of the previous functions */
+      if (timeout->heap_index < 0)
+        continue;
 
-      if (timeout)
-        pool->timeouts = g_list_insert_sorted (pool->timeouts, timeout,
-                                               clutter_timeout_sort);
-
-      dispatched_timeouts = next;
+      if (_clutter_timeout_interval_dispatch (&timeout->interval,
+                                              timeout->func, timeout->data))
+        {
+          /* the function might have removed the timeout as well */
+          if (timeout->heap_index >= 0)
+            heap_update (pool, timeout);
+        }
+      else if (timeout->heap_index >= 0)
+        clutter_timeout_pool_remove_timeout (pool, timeout);
     }
 
-  g_list_free (pool->dispatched_timeouts);
-  pool->dispatched_timeouts = NULL;
+  for (i = 0; i < ready->len; i++)
+    clutter_timeout_unref (g_ptr_array_index (ready, i));
 
-  pool->ready = 0;
+  g_ptr_array_set_size (ready, 0);
 
   clutter_threads_leave ();
 
@@ -354,8 +468,11 @@ clutter_timeout_pool_finalize (GSource *source)
   ClutterTimeoutPool *pool = (ClutterTimeoutPool *) source;
 
   /* force destruction */
-  g_list_foreach (pool->timeouts, (GFunc) clutter_timeout_free, NULL);
-  g_list_free (pool->timeouts);
+  g_ptr_array_foreach (pool->timeouts, (GFunc) clutter_timeout_free, NULL);
+  g_ptr_array_free (pool->timeouts, TRUE);
+
+  g_hash_table_destroy (pool->timeouts_by_id);
+  g_ptr_array_free (pool->dispatched_timeouts, TRUE);
 }
 
 /**
@@ -368,8 +485,9 @@ clutter_timeout_pool_finalize (GSource *source)
  * the g_timeout_add() API might lead to starvation of the time slice of
  * the main loop. A timeout pool allocates a single time slice of the main
  * loop and runs every timeout function inside it. The timeout pool is
- * always sorted, so that the extraction of the next timeout function is
- * a constant time operation.
+ * kept ordered by expiration, so that finding the next timeout function
+ * is a constant time operation, and adding or removing a timeout function
+ * takes logarithmic time.
  *
  * Return value: the newly created #ClutterTimeoutPool. The created pool
  *   is owned by the GLib default context and will be automatically
@@ -398,6 +516,9 @@ clutter_timeout_pool_new (gint priority)
 
   pool = (ClutterTimeoutPool *) source;
   pool->next_id = 1;
+  pool->timeouts = g_ptr_array_new ();
+  pool->timeouts_by_id = g_hash_table_new (NULL, NULL);
+  pool->dispatched_timeouts = g_ptr_array_new ();
   pool->id = g_source_attach (source, NULL);
 
   /* let the default GLib context manage the pool */
@@ -454,8 +575,10 @@ clutter_timeout_pool_add (ClutterTimeoutPool *pool,
   timeout->data = data;
   timeout->notify = notify;
 
-  pool->timeouts = g_list_insert_sorted (pool->timeouts, timeout,
-                                         clutter_timeout_sort);
+  heap_insert (pool, timeout);
+  g_hash_table_insert (pool->timeouts_by_id,
+                       GUINT_TO_POINTER (timeout->id),
+                       timeout);
 
   return retval;
 }
@@ -477,21 +600,10 @@ void
 clutter_timeout_pool_remove (ClutterTimeoutPool *pool,
                              guint               id_)
 {
-  GList *l;
-
-  if ((l = g_list_find_custom (pool->timeouts, GUINT_TO_POINTER (id_),
-			       clutter_timeout_find_by_id)))
-    {
-      clutter_timeout_unref (l->data);
-      pool->timeouts = g_list_delete_link (pool->timeouts, l);
-    }
-  else if ((l = g_list_find_custom (pool->dispatched_timeouts,
-				    GUINT_TO_POINTER (id_),
-				    clutter_timeout_find_by_id)))
-    {
-      clutter_timeout_unref (l->data);
+  ClutterTimeout *timeout;
 
-      pool->dispatched_timeouts =
-        g_list_delete_link (pool->dispatched_timeouts, l);
-    }
+  timeout = g_hash_table_lookup (pool->timeouts_by_id,
+                                 GUINT_TO_POINTER (id_));
+  if (timeout != NULL)
+    clutter_timeout_pool_remove_timeout (pool, timeout);
 }
@@ -124,20 +124,14 @@ units_em_to_pixels (const gchar *font_name,
     return em * _clutter_backend_get_units_per_em (backend, NULL);
   else
     {
-      PangoFontDescription *font_desc;
-      gfloat res;
+      gfloat units_per_em;
 
-      font_desc = pango_font_description_from_string (font_name);
-      if (font_desc == NULL)
-        res = -1.0;
-      else
-        {
-          res = em * _clutter_backend_get_units_per_em (backend, font_desc);
-
-          pango_font_description_free (font_desc);
-        }
+      units_per_em = _clutter_backend_get_units_per_em_for_font (backend,
+                                                                 font_name);
+      if (units_per_em < 0)
+        return -1.0;
 
-      return res;
+      return em * units_per_em;
     }
 }
 
@@ -34,10 +34,13 @@
 #include "config.h"
 #endif
 
+#include <string.h>
+
 #include <glib/gi18n-lib.h>
 
 #include "clutter-util.h"
 #include "clutter-main.h"
+#include "clutter-private.h"
 
 /**
  * clutter_util_next_p2:
@@ -74,21 +77,103 @@ _clutter_gettext (const gchar *str)
   return g_dgettext (GETTEXT_PACKAGE, str);
 }
 
-/* Help macros to scale from OpenGL <-1,1> coordinates system to
- * window coordinates ranging [0,window-size]
- */
-#define MTX_GL_SCALE_X(x,w,v1,v2) ((((((x) / (w)) + 1.0f) / 2.0f) * (v1)) + (v2))
-#define MTX_GL_SCALE_Y(y,w,v1,v2) ((v1) - (((((y) / (w)) + 1.0f) / 2.0f) * (v1)) + (v2))
-#define MTX_GL_SCALE_Z(z,w,v1,v2) (MTX_GL_SCALE_X ((z), (w), (v1), (v2)))
+/* the number of vertices transformed together by
+ * clutter_util_project_vertices(); the paint volumes and the
+ * allocation boxes have 4 or 8 vertices */
+#define PROJECT_BATCH_SIZE      4
+
+/* Maps a vertex in clip coordinates to window coordinates; @half_width
+ * and @half_height are half the size of the viewport */
+#define CLIP_TO_WINDOW(out,cx,cy,cw,viewport,half_width,half_height) \
+  G_STMT_START {                                                      \
+    float __inv_w = 1.0f / (cw);                                      \
+    (out)->x = ((cx) * __inv_w + 1.0f) * (half_width) + (viewport)[0]; \
+    (out)->y = (1.0f - (cy) * __inv_w) * (half_height) + (viewport)[1]; \
+  } G_STMT_END
 
-typedef struct _ClutterVertex4
+/* Transforms @n_vertices vertices by @mvp, the combined modelview and
+ * projection matrix, and maps them to window coordinates.
+ *
+ * The vertices are loaded in batches of PROJECT_BATCH_SIZE, one array
+ * per component, so that the lanes of each batch are independent and
+ * the compiler can keep them in vector registers; this is also why
+ * the division by w is replaced by a single reciprocal per vertex.
+ *
+ * @vertices_in and @vertices_out can point to the same array; the Z
+ * coordinate of @vertices_out is left untouched.
+ */
+static void
+clutter_util_project_vertices (const CoglMatrix    *mvp,
+                               const float         *viewport,
+                               const ClutterVertex *vertices_in,
+                               ClutterVertex       *vertices_out,
+                               int                  n_vertices)
 {
-  float x;
-  float y;
-  float z;
-  float w;
-} ClutterVertex4;
+  const float half_width = viewport[2] * 0.5f;
+  const float half_height = viewport[3] * 0.5f;
+  int i, j;
+
+  for (i = 0; i + PROJECT_BATCH_SIZE <= n_vertices; i += PROJECT_BATCH_SIZE)
+    {
+      float x[PROJECT_BATCH_SIZE], y[PROJECT_BATCH_SIZE];
+      float z[PROJECT_BATCH_SIZE], w[PROJECT_BATCH_SIZE];
+      float cx[PROJECT_BATCH_SIZE], cy[PROJECT_BATCH_SIZE];
+
+      for (j = 0; j < PROJECT_BATCH_SIZE; j++)
+        {
+          x[j] = vertices_in[i + j].x;
+          y[j] = vertices_in[i + j].y;
+          z[j] = vertices_in[i + j].z;
+        }
+
+      for (j = 0; j < PROJECT_BATCH_SIZE; j++)
+        {
+          cx[j] = mvp->xx * x[j] + mvp->xy * y[j] + mvp->xz * z[j] + mvp->xw;
+          cy[j] = mvp->yx * x[j] + mvp->yy * y[j] + mvp->yz * z[j] + mvp->yw;
+          w[j]  = mvp->wx * x[j] + mvp->wy * y[j] + mvp->wz * z[j] + mvp->ww;
+        }
 
+      for (j = 0; j < PROJECT_BATCH_SIZE; j++)
+        w[j] = 1.0f / w[j];
+
+      for (j = 0; j < PROJECT_BATCH_SIZE; j++)
+        {
+          vertices_out[i + j].x =
+            (cx[j] * w[j] + 1.0f) * half_width + viewport[0];
+          vertices_out[i + j].y =
+            (1.0f - cy[j] * w[j]) * half_height + viewport[1];
+        }
+    }
+
+  for (; i < n_vertices; i++)
+    {
+      const ClutterVertex *v = &vertices_in[i];
+      float cx, cy, cw;
+
+      cx = mvp->xx * v->x + mvp->xy * v->y + mvp->xz * v->z + mvp->xw;
+      cy = mvp->yx * v->x + mvp->yy * v->y + mvp->yz * v->z + mvp->yw;
+      cw = mvp->wx * v->x + mvp->wy * v->y + mvp->wz * v->z + mvp->ww;
+
+      CLIP_TO_WINDOW (&vertices_out[i], cx, cy, cw,
+                      viewport,
+                      half_width,
+                      half_height);
+    }
+}
+
+/*< private >
+ * _clutter_util_fully_transform_vertices:
+ * @modelview: the modelview matrix
+ * @projection: the projection matrix
+ * @viewport: the viewport, as x, y, width and height
+ * @vertices_in: the vertices to transform
+ * @vertices_out: return location for the transformed vertices; it can
+ *   be the same array as @vertices_in
+ * @n_vertices: the number of vertices
+ *
+ * Transforms @vertices_in from model coordinates to window coordinates.
+ * Only the X and Y coordinates of @vertices_out are set.
+ */
 void
 _clutter_util_fully_transform_vertices (const CoglMatrix *modelview,
                                         const CoglMatrix *projection,
@@ -98,53 +183,82 @@ _clutter_util_fully_transform_vertices (const CoglMatrix *modelview,
                                         int n_vertices)
 {
   CoglMatrix modelview_projection;
-  ClutterVertex4 *vertices_tmp;
   int i;
 
-  vertices_tmp = g_alloca (sizeof (ClutterVertex4) * n_vertices);
-
   if (n_vertices >= 4)
     {
       /* XXX: we should find a way to cache this per actor */
       cogl_matrix_multiply (&modelview_projection,
                             projection,
                             modelview);
-      cogl_matrix_project_points (&modelview_projection,
-                                  3,
-                                  sizeof (ClutterVertex),
-                                  vertices_in,
-                                  sizeof (ClutterVertex4),
-                                  vertices_tmp,
-                                  n_vertices);
+      clutter_util_project_vertices (&modelview_projection,
+                                     viewport,
+                                     vertices_in,
+                                     vertices_out,
+                                     n_vertices);
+      return;
     }
-  else
+
+  /* for a few vertices it is cheaper to go through both matrices
+   * than to multiply them */
+  for (i = 0; i < n_vertices; i++)
     {
-      cogl_matrix_transform_points (modelview,
-                                    3,
-                                    sizeof (ClutterVertex),
-                                    vertices_in,
-                                    sizeof (ClutterVertex4),
-                                    vertices_tmp,
-                                    n_vertices);
-
-      cogl_matrix_project_points (projection,
-                                  3,
-                                  sizeof (ClutterVertex4),
-                                  vertices_tmp,
-                                  sizeof (ClutterVertex4),
-                                  vertices_tmp,
-                                  n_vertices);
+      const CoglMatrix *m = modelview;
+      const CoglMatrix *p = projection;
+      const ClutterVertex *v = &vertices_in[i];
+      float ex, ey, ez, ew;
+      float cx, cy, cw;
+
+      ex = m->xx * v->x + m->xy * v->y + m->xz * v->z + m->xw;
+      ey = m->yx * v->x + m->yy * v->y + m->yz * v->z + m->yw;
+      ez = m->zx * v->x + m->zy * v->y + m->zz * v->z + m->zw;
+      ew = m->wx * v->x + m->wy * v->y + m->wz * v->z + m->ww;
+
+      cx = p->xx * ex + p->xy * ey + p->xz * ez + p->xw * ew;
+      cy = p->yx * ex + p->yy * ey + p->yz * ez + p->yw * ew;
+      cw = p->wx * ex + p->wy * ey + p->wz * ez + p->ww * ew;
+
+      CLIP_TO_WINDOW (&vertices_out[i], cx, cy, cw,
+                      viewport,
+                      viewport[2] * 0.5f,
+                      viewport[3] * 0.5f);
     }
+}
 
-  for (i = 0; i < n_vertices; i++)
+/* Checks whether @name appears as a whole word in the space separated
+ * list of @extensions, as returned by the window system */
+gboolean
+_clutter_util_has_extension (const gchar *extensions,
+                             const gchar *name)
+{
+  gsize name_len = strlen (name);
+  const gchar *p = extensions;
+
+  while (p != NULL && (p = strstr (p, name)) != NULL)
     {
-      ClutterVertex4 vertex_tmp = vertices_tmp[i];
-      ClutterVertex *vertex_out = &vertices_out[i];
-      /* Finally translate from OpenGL coords to window coords */
-      vertex_out->x = MTX_GL_SCALE_X (vertex_tmp.x, vertex_tmp.w,
-                                      viewport[2], viewport[0]);
-      vertex_out->y = MTX_GL_SCALE_Y (vertex_tmp.y, vertex_tmp.w,
-                                      viewport[3], viewport[1]);
+      if ((p == extensions || p[-1] == ' ') &&
+          (p[name_len] == ' ' || p[name_len] == '\0'))
+        return TRUE;
+
+      p += name_len;
     }
+
+  return FALSE;
 }
 
+/* Retrieves the current time, in microseconds, from the same clock used
+ * by the main loop sources; this is the time base of the frame timings
+ * reported by the master clock and the stage */
+gint64
+_clutter_util_get_monotonic_time (void)
+{
+#if GLIB_CHECK_VERSION (2, 27, 3)
+  return g_get_monotonic_time ();
+#else
+  GTimeVal current_time;
+
+  g_get_current_time (&current_time);
+
+  return current_time.tv_sec * G_USEC_PER_SEC + current_time.tv_usec;
+#endif
+}
@@ -40,6 +40,7 @@
 #include "clutter-animatable.h"
 #include "clutter-animation.h"
 #include "clutter-animator.h"
+#include "clutter-backdrop-effect.h"
 #include "clutter-backend.h"
 #include "clutter-behaviour-depth.h"
 #include "clutter-behaviour-ellipse.h"
@@ -61,6 +62,7 @@
 #include "clutter-color.h"
 #include "clutter-color-static.h"
 #include "clutter-colorize-effect.h"
+#include "clutter-column-model.h"
 #include "clutter-constraint.h"
 #include "clutter-container.h"
 #include "clutter-deform-effect.h"
@@ -76,10 +78,12 @@
 #include "clutter-group.h"
 #include "clutter-input-device.h"
 #include "clutter-interval.h"
+#include "clutter-job.h"
 #include "clutter-keysyms.h" 
 #include "clutter-layout-manager.h"
 #include "clutter-layout-meta.h"
 #include "clutter-list-model.h"
+#include "clutter-list-view.h"
 #include "clutter-main.h"
 #include "clutter-media.h"
 #include "clutter-model.h"
@@ -91,6 +95,7 @@
 #include "clutter-score.h"
 #include "clutter-scriptable.h"
 #include "clutter-script.h"
+#include "clutter-scroll-view.h"
 #include "clutter-settings.h"
 #include "clutter-shader.h"
 #include "clutter-shader-effect.h"
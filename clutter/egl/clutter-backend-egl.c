@@ -255,6 +255,7 @@ clutter_backend_egl_get_features (ClutterBackend *backend)
   ClutterBackendClass *parent_class;
 #endif
   ClutterFeatureFlags flags = 0;
+  const char *egl_extensions;
 
 #ifdef COGL_HAS_XLIB_SUPPORT
   parent_class = CLUTTER_BACKEND_CLASS (_clutter_backend_egl_parent_class);
@@ -293,6 +294,14 @@ clutter_backend_egl_get_features (ClutterBackend *backend)
       backend_egl->can_blit_sub_buffer = TRUE;
     }
 
+  egl_extensions = eglQueryString (clutter_egl_get_egl_display (),
+                                   EGL_EXTENSIONS);
+  if (_clutter_util_has_extension (egl_extensions, "EGL_EXT_buffer_age"))
+    {
+      CLUTTER_NOTE (BACKEND, "EGL supports querying the back buffer age");
+      backend_egl->can_query_buffer_age = TRUE;
+    }
+
   return flags;
 }
 
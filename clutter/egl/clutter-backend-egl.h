@@ -82,6 +82,9 @@ struct _ClutterBackendEGL
   CoglContext *cogl_context;
 
   gboolean can_blit_sub_buffer;
+
+  /* whether EGL_EXT_buffer_age is available */
+  gboolean can_query_buffer_age;
 };
 
 struct _ClutterBackendEGLClass
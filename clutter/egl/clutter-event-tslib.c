@@ -33,6 +33,7 @@
 #include "clutter-debug.h"
 #include "clutter-main.h"
 
+#include <stdlib.h>
 #include <string.h>
 
 #include <glib.h>
@@ -52,11 +53,32 @@ struct _ClutterEventSource
 
 #ifdef HAVE_TSLIB
   struct tsdev   *ts_device;
+
+  /* the buffer the samples are read into */
+  struct ts_sample *samples;
+  gint n_samples;
+
+  /* the state of the touch screen after the last sample */
+  gint last_x;
+  gint last_y;
+  guint clicked : 1;
 #endif
 };
 
 #ifdef HAVE_TSLIB
 
+/* the default number of samples read from the touch screen at once; it
+ * can be changed using the CLUTTER_TSLIB_SAMPLES environment variable
+ */
+#define DEFAULT_SAMPLES_PER_READ        32
+#define MAX_SAMPLES_PER_READ            256
+
+/* the maximum number of reads in a single dispatch */
+#define MAX_READS_PER_DISPATCH          8
+
+/* the maximum number of motion samples folded into the next one */
+#define MAX_COMPRESSED_MOTIONS          64
+
 static gboolean clutter_event_prepare  (GSource     *source,
                                         gint        *timeout);
 static gboolean clutter_event_check    (GSource     *source);
@@ -101,6 +123,7 @@ _clutter_events_egl_init (ClutterBackendEGL *backend_egl)
 #ifdef HAVE_TSLIB
   ClutterEventSource *event_source;
   const char *device_name;
+  const char *n_samples;
   GSource *source;
 
   CLUTTER_NOTE (EVENT, "Starting timer");
@@ -120,7 +143,8 @@ _clutter_events_egl_init (ClutterBackendEGL *backend_egl)
       return;
     }
 
-  event_source->ts_device = ts_open (device_name, 0);
+  /* the device is read in batches, until there are no samples left */
+  event_source->ts_device = ts_open (device_name, 1);
   if (event_source->ts_device)
     {
       CLUTTER_NOTE (EVENT, "Opened '%s'", device_name);
@@ -133,6 +157,20 @@ _clutter_events_egl_init (ClutterBackendEGL *backend_egl)
 	  return;
 	}
 
+      event_source->n_samples = DEFAULT_SAMPLES_PER_READ;
+
+      n_samples = g_getenv ("CLUTTER_TSLIB_SAMPLES");
+      if (n_samples != NULL && n_samples[0] != '\0')
+        event_source->n_samples = CLAMP (atoi (n_samples),
+                                         1,
+                                         MAX_SAMPLES_PER_READ);
+
+      CLUTTER_NOTE (EVENT, "Reading up to %d samples at once",
+                    event_source->n_samples);
+
+      event_source->samples = g_new0 (struct ts_sample,
+                                      event_source->n_samples);
+
       g_source_set_priority (source, CLUTTER_PRIORITY_EVENTS);
       event_source->event_poll_fd.fd = ts_fd (event_source->ts_device);
       event_source->event_poll_fd.events = G_IO_IN;
@@ -169,6 +207,7 @@ _clutter_events_egl_uninit (ClutterBackendEGL *backend_egl)
                 (ClutterEventSource *) backend_egl->event_source;
 
       ts_close (event_source->ts_device);
+      g_free (event_source->samples);
       event_sources = g_list_remove (event_sources, backend_egl->event_source);
 
       g_source_destroy (backend_egl->event_source);
@@ -212,80 +251,160 @@ clutter_event_check (GSource *source)
   return retval;
 }
 
-static gboolean
-clutter_event_dispatch (GSource     *source,
-                        GSourceFunc  callback,
-                        gpointer     user_data)
+/* translates @sample, updating the state of the touch screen; returns
+ * %NULL if the sample does not need an event
+ */
+static ClutterEvent *
+translate_sample (ClutterEventSource     *event_source,
+                  const struct ts_sample *sample)
 {
-  ClutterEventSource *event_source = (ClutterEventSource *) source;
-  struct ts_sample tsevent;
   ClutterEvent *event;
 
-  clutter_threads_enter ();
+  /* Avoid sending too many events which are just pressure changes.
+   *
+   * FIXME - We don't current handle pressure in events and thus
+   * event_button_generate gets confused generating lots of double
+   * and triple clicks.
+   */
+  if (sample->pressure &&
+      event_source->last_x == sample->x &&
+      event_source->last_y == sample->y)
+    return NULL;
+
+  event = clutter_event_new (CLUTTER_NOTHING);
 
-  /* FIXME while would be better here but need to deal with lockups */
-  if ((!clutter_events_pending()) &&
-      (ts_read(event_source->ts_device, &tsevent, 1) == 1))
+  event->any.stage = clutter_stage_get_default ();
+
+  event_source->last_x = event->button.x = sample->x;
+  event_source->last_y = event->button.y = sample->y;
+
+  if (sample->pressure && !event_source->clicked)
     {
-      static gint     last_x = 0, last_y = 0;
-      static gboolean clicked = FALSE;
+      event->button.type = event->type = CLUTTER_BUTTON_PRESS;
+      event->button.time = get_backend_time ();
+      event->button.modifier_state = 0;
+      event->button.button = 1;
 
-      /* Avoid sending too many events which are just pressure changes.
-       *
-       * FIXME - We don't current handle pressure in events and thus
-       * event_button_generate gets confused generating lots of double
-       * and triple clicks.
-      */
-      if (tsevent.pressure && last_x == tsevent.x && last_y == tsevent.y)
-        goto out;
+      event_source->clicked = TRUE;
+    }
+  else if (sample->pressure && event_source->clicked)
+    {
+      event->motion.type = event->type = CLUTTER_MOTION;
+      event->motion.time = get_backend_time ();
+      event->motion.modifier_state = 0;
+    }
+  else
+    {
+      event->button.type = event->type = CLUTTER_BUTTON_RELEASE;
+      event->button.time = get_backend_time ();
+      event->button.modifier_state = 0;
+      event->button.button = 1;
 
-      event = clutter_event_new (CLUTTER_NOTHING);
+      event_source->clicked = FALSE;
+    }
 
-      event->any.stage = clutter_stage_get_default ();
+  return event;
+}
 
-      last_x = event->button.x = tsevent.x;
-      last_y = event->button.y = tsevent.y;
+static void
+events_queue (ClutterEventSource *event_source)
+{
+  ClutterEvent motions[MAX_COMPRESSED_MOTIONS];
+  ClutterStage *stage;
+  gboolean compress;
+  gint n_reads;
+
+  /* motion samples followed by another motion sample would be
+   * compressed by the stage anyway; we only keep their position
+   * for the motion history of the event that is delivered
+   */
+  stage = CLUTTER_STAGE (clutter_stage_get_default ());
+  compress = clutter_stage_get_throttle_motion_events (stage);
+
+  for (n_reads = 0; n_reads < MAX_READS_PER_DISPATCH; n_reads++)
+    {
+      struct ts_sample *samples = event_source->samples;
+      guint n_motions = 0;
+      gint n_read, i;
 
-      if (tsevent.pressure && !clicked)
-        {
-	  event->button.type = event->type = CLUTTER_BUTTON_PRESS;
-          event->button.time = get_backend_time ();
-          event->button.modifier_state = 0;
-          event->button.button = 1;
+      n_read = ts_read (event_source->ts_device,
+                        samples,
+                        event_source->n_samples);
+      if (n_read <= 0)
+        break;
 
-          clicked = TRUE;
-        }
-      else if (tsevent.pressure && clicked)
-        {
-          event->motion.type = event->type = CLUTTER_MOTION;
-          event->motion.time = get_backend_time ();
-          event->motion.modifier_state = 0;
-        }
-      else
-        {
-	  event->button.type = event->type = CLUTTER_BUTTON_RELEASE;
-          event->button.time = get_backend_time ();
-          event->button.modifier_state = 0;
-          event->button.button = 1;
+      CLUTTER_NOTE (EVENT, "Read %d samples", n_read);
 
-          clicked = FALSE;
+      for (i = 0; i < n_read; i++)
+        {
+          const struct ts_sample *sample = &samples[i];
+          ClutterEvent *event;
+
+          if (compress &&
+              n_motions < MAX_COMPRESSED_MOTIONS &&
+              i + 1 < n_read &&
+              event_source->clicked &&
+              sample->pressure && samples[i + 1].pressure &&
+              (sample->x != event_source->last_x ||
+               sample->y != event_source->last_y))
+            {
+              ClutterEvent *motion = &motions[n_motions++];
+
+              motion->type = CLUTTER_MOTION;
+              motion->motion.time = get_backend_time ();
+              motion->motion.x = sample->x;
+              motion->motion.y = sample->y;
+
+              event_source->last_x = sample->x;
+              event_source->last_y = sample->y;
+
+              continue;
+            }
+
+          event = translate_sample (event_source, sample);
+          if (event == NULL)
+            continue;
+
+          if (event->type == CLUTTER_MOTION)
+            {
+              while (n_motions > 0)
+                _clutter_event_fold_motion (event, &motions[--n_motions]);
+            }
+
+          _clutter_event_push (event, FALSE);
+
+          n_motions = 0;
         }
 
-      _clutter_event_push (event, FALSE);
+      /* the device has no more samples for now */
+      if (n_read < event_source->n_samples)
+        break;
     }
+}
 
-  /* Pop an event off the queue if any */
-  event = clutter_event_get ();
+static gboolean
+clutter_event_dispatch (GSource     *source,
+                        GSourceFunc  callback,
+                        gpointer     user_data)
+{
+  ClutterEventSource *event_source = (ClutterEventSource *) source;
+  ClutterEvent *event;
+
+  clutter_threads_enter ();
 
-  if (event)
+  /* read all the available samples in batches, instead of a single
+   * sample per dispatch
+   */
+  if (event_source->event_poll_fd.revents & G_IO_IN)
+    events_queue (event_source);
+
+  /* forward all the translated events into clutter for emission etc. */
+  while ((event = clutter_event_get ()) != NULL)
     {
-      /* forward the event into clutter for emission etc. */
       clutter_do_event (event);
       clutter_event_free (event);
     }
 
-out:
-
   clutter_threads_leave ();
 
   return TRUE;
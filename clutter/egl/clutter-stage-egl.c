@@ -46,6 +46,9 @@ clutter_stage_egl_unrealize (ClutterStageWindow *stage_window)
 
   cogl_object_unref (stage_egl->onscreen);
   stage_egl->onscreen = NULL;
+
+  stage_egl->last_surface = EGL_NO_SURFACE;
+  _clutter_stage_damage_history_reset (&stage_egl->damage_history);
 }
 
 static gboolean
@@ -196,6 +199,37 @@ clutter_stage_egl_resize (ClutterStageWindow *stage_window,
 
 #endif /* COGL_HAS_XLIB_SUPPORT */
 
+#ifndef EGL_BUFFER_AGE_EXT
+#define EGL_BUFFER_AGE_EXT 0x313D
+#endif
+
+static int
+clutter_stage_egl_get_buffer_age (ClutterStageWindow *stage_window)
+{
+  ClutterStageEGL *stage_egl = CLUTTER_STAGE_EGL (stage_window);
+  ClutterBackendEGL *backend_egl;
+  EGLint age = 0;
+
+  backend_egl = CLUTTER_BACKEND_EGL (clutter_get_default_backend ());
+  if (!backend_egl->can_query_buffer_age)
+    return 0;
+
+  /* the age can only be queried for the current draw surface; if
+   * something else is bound, e.g. another stage, we have no way to
+   * tell which surface is ours and we play safe */
+  if (stage_egl->last_surface == EGL_NO_SURFACE ||
+      eglGetCurrentSurface (EGL_DRAW) != stage_egl->last_surface)
+    return 0;
+
+  if (!eglQuerySurface (clutter_egl_get_egl_display (),
+                        stage_egl->last_surface,
+                        EGL_BUFFER_AGE_EXT,
+                        &age))
+    return 0;
+
+  return age;
+}
+
 static gboolean
 clutter_stage_egl_has_redraw_clips (ClutterStageWindow *stage_window)
 {
@@ -238,10 +272,14 @@ clutter_stage_egl_ignoring_redraw_clips (ClutterStageWindow *stage_window)
  * A NULL stage_clip means the whole stage needs to be redrawn.
  *
  * What we do with this information:
- * - we keep track of the bounding box for all redraw clips
- * - when we come to redraw; we scissor the redraw to that box and use
- *   glBlitFramebuffer to present the redraw to the front
- *   buffer.
+ * - we keep track of the bounding box for all redraw clips, and of a
+ *   short list of disjoint rectangles inside it
+ * - when we come to redraw; we paint the stage once for each
+ *   rectangle, scissored to it, and use glBlitFramebuffer to present
+ *   the rectangles to the front buffer.
+ * - if EGL_EXT_buffer_age is available we instead add the damage of
+ *   the frames the back buffer has missed since it was last shown,
+ *   and swap the whole buffer.
  */
 static void
 clutter_stage_egl_add_redraw_clip (ClutterStageWindow *stage_window,
@@ -273,11 +311,16 @@ clutter_stage_egl_add_redraw_clip (ClutterStageWindow *stage_window,
       stage_egl->bounding_redraw_clip.y = stage_clip->y;
       stage_egl->bounding_redraw_clip.width = stage_clip->width;
       stage_egl->bounding_redraw_clip.height = stage_clip->height;
+
+      stage_egl->redraw_clips.n_rects = 0;
+      _clutter_stage_redraw_clips_add (&stage_egl->redraw_clips, stage_clip);
     }
   else if (stage_egl->bounding_redraw_clip.width > 0)
     {
       clutter_geometry_union (&stage_egl->bounding_redraw_clip, stage_clip,
 			      &stage_egl->bounding_redraw_clip);
+
+      _clutter_stage_redraw_clips_add (&stage_egl->redraw_clips, stage_clip);
     }
 
   stage_egl->initialized_redraw_clip = TRUE;
@@ -293,6 +336,10 @@ clutter_stage_egl_redraw (ClutterStageWindow *stage_window)
   ClutterBackendEGL *backend_egl;
   gboolean may_use_clipped_redraw;
   gboolean use_clipped_redraw;
+  gboolean use_buffer_age;
+  gboolean damage_is_full;
+  ClutterStageRedrawClips frame_damage;
+  gint64 swap_start;
 
   CLUTTER_STATIC_TIMER (painting_timer,
                         "Redrawing", /* parent */
@@ -309,6 +356,11 @@ clutter_stage_egl_redraw (ClutterStageWindow *stage_window)
                         "egl_blit_sub_buffer",
                         "The time spent in _egl_blit_sub_buffer",
                         0 /* no application private data */);
+  CLUTTER_STATIC_COUNTER (scanout_counter,
+                          "Scanout candidate frames",
+                          "Increments each time a single opaque actor "
+                          "covers the whole stage",
+                          0 /* no application private data */);
 
 #ifdef COGL_HAS_X11_SUPPORT
   ClutterStageX11 *stage_x11 = CLUTTER_STAGE_X11 (stage_egl);
@@ -326,7 +378,8 @@ clutter_stage_egl_redraw (ClutterStageWindow *stage_window)
 
   CLUTTER_TIMER_START (_clutter_uprof_context, painting_timer);
 
-  if (G_LIKELY (backend_egl->can_blit_sub_buffer) &&
+  if ((G_LIKELY (backend_egl->can_blit_sub_buffer) ||
+       backend_egl->can_query_buffer_age) &&
       /* NB: a zero width redraw clip == full stage redraw */
       stage_egl->bounding_redraw_clip.width != 0 &&
       /* some drivers struggle to get going and produce some junk
@@ -345,6 +398,30 @@ clutter_stage_egl_redraw (ClutterStageWindow *stage_window)
   else
     may_use_clipped_redraw = FALSE;
 
+  /* keep track of what changed in this frame, before adding what the
+   * back buffer is missing, so that the next frames can bring their
+   * own back buffers up to date */
+  damage_is_full = !stage_egl->initialized_redraw_clip ||
+                   stage_egl->bounding_redraw_clip.width == 0;
+  if (!damage_is_full)
+    frame_damage = stage_egl->redraw_clips;
+
+  use_buffer_age = FALSE;
+  if (may_use_clipped_redraw && backend_egl->can_query_buffer_age)
+    {
+      int age = clutter_stage_egl_get_buffer_age (stage_window);
+
+      CLUTTER_NOTE (BACKEND, "Back buffer age: %d", age);
+
+      if (_clutter_stage_damage_history_accumulate (&stage_egl->damage_history,
+                                                    age,
+                                                    &stage_egl->redraw_clips,
+                                                    &stage_egl->bounding_redraw_clip))
+        use_buffer_age = TRUE;
+      else if (!backend_egl->can_blit_sub_buffer)
+        may_use_clipped_redraw = FALSE;
+    }
+
   if (may_use_clipped_redraw &&
       G_LIKELY (!(clutter_paint_debug_flags &
                   CLUTTER_DEBUG_DISABLE_CLIPPED_REDRAWS)))
@@ -352,37 +429,41 @@ clutter_stage_egl_redraw (ClutterStageWindow *stage_window)
   else
     use_clipped_redraw = FALSE;
 
+  if (may_use_clipped_redraw)
+    _clutter_stage_redraw_clips_simplify (&stage_egl->redraw_clips,
+                                          &stage_egl->bounding_redraw_clip);
+
   if (use_clipped_redraw)
     {
-      cogl_clip_push_window_rectangle (stage_egl->bounding_redraw_clip.x,
-                                       stage_egl->bounding_redraw_clip.y,
-                                       stage_egl->bounding_redraw_clip.width,
-                                       stage_egl->bounding_redraw_clip.height);
-      _clutter_stage_do_paint (CLUTTER_STAGE (wrapper),
-                               &stage_egl->bounding_redraw_clip);
-      cogl_clip_pop ();
+      _clutter_stage_paint_redraw_clips (CLUTTER_STAGE (wrapper),
+                                         &stage_egl->redraw_clips);
     }
   else
-    _clutter_stage_do_paint (CLUTTER_STAGE (wrapper), NULL);
+    {
+      ClutterActor *scanout_actor;
+
+      _clutter_stage_do_paint (CLUTTER_STAGE (wrapper), NULL);
+
+      /* Cogl cannot hand the buffer of an actor over to a display
+       * plane, so the frame is composited anyway; the stage skips
+       * clearing the color buffer in this case, and we keep track of
+       * how often the frame could have been scanned out directly */
+      scanout_actor = _clutter_stage_get_scanout_actor (CLUTTER_STAGE (wrapper));
+      if (scanout_actor != NULL)
+        {
+          CLUTTER_COUNTER_INC (_clutter_uprof_context, scanout_counter);
+          CLUTTER_NOTE (BACKEND, "Frame could be scanned out from '%s'",
+                        _clutter_actor_get_debug_name (scanout_actor));
+        }
+    }
 
   if (may_use_clipped_redraw &&
       G_UNLIKELY ((clutter_paint_debug_flags & CLUTTER_DEBUG_REDRAWS)))
     {
       static CoglMaterial *outline = NULL;
-      ClutterGeometry *clip = &stage_egl->bounding_redraw_clip;
       ClutterActor *actor = CLUTTER_ACTOR (wrapper);
-      CoglHandle vbo;
-      float x_1 = clip->x;
-      float x_2 = clip->x + clip->width;
-      float y_1 = clip->y;
-      float y_2 = clip->y + clip->height;
-      float quad[8] = {
-        x_1, y_1,
-        x_2, y_1,
-        x_2, y_2,
-        x_1, y_2
-      };
       CoglMatrix modelview;
+      guint i;
 
       if (outline == NULL)
         {
@@ -390,35 +471,61 @@ clutter_stage_egl_redraw (ClutterStageWindow *stage_window)
           cogl_material_set_color4ub (outline, 0xff, 0x00, 0x00, 0xff);
         }
 
-      vbo = cogl_vertex_buffer_new (4);
-      cogl_vertex_buffer_add (vbo,
-                              "gl_Vertex",
-                              2, /* n_components */
-                              COGL_ATTRIBUTE_TYPE_FLOAT,
-                              FALSE, /* normalized */
-                              0, /* stride */
-                              quad);
-      cogl_vertex_buffer_submit (vbo);
-
       cogl_push_matrix ();
       cogl_matrix_init_identity (&modelview);
       _clutter_actor_apply_modelview_transform (actor, &modelview);
       cogl_set_modelview_matrix (&modelview);
       cogl_set_source (outline);
-      cogl_vertex_buffer_draw (vbo, COGL_VERTICES_MODE_LINE_LOOP,
-                               0 , 4);
+
+      for (i = 0; i < stage_egl->redraw_clips.n_rects; i++)
+        {
+          ClutterGeometry *clip = &stage_egl->redraw_clips.rects[i];
+          CoglHandle vbo;
+          float x_1 = clip->x;
+          float x_2 = clip->x + clip->width;
+          float y_1 = clip->y;
+          float y_2 = clip->y + clip->height;
+          float quad[8] = {
+            x_1, y_1,
+            x_2, y_1,
+            x_2, y_2,
+            x_1, y_2
+          };
+
+          vbo = cogl_vertex_buffer_new (4);
+          cogl_vertex_buffer_add (vbo,
+                                  "gl_Vertex",
+                                  2, /* n_components */
+                                  COGL_ATTRIBUTE_TYPE_FLOAT,
+                                  FALSE, /* normalized */
+                                  0, /* stride */
+                                  quad);
+          cogl_vertex_buffer_submit (vbo);
+
+          cogl_vertex_buffer_draw (vbo, COGL_VERTICES_MODE_LINE_LOOP,
+                                   0 , 4);
+          cogl_object_unref (vbo);
+        }
+
       cogl_pop_matrix ();
-      cogl_object_unref (vbo);
     }
 
   CLUTTER_TIMER_STOP (_clutter_uprof_context, painting_timer);
 
+  if (backend_egl->can_query_buffer_age)
+    _clutter_stage_damage_history_record (&stage_egl->damage_history,
+                                          damage_is_full ? NULL
+                                                         : &frame_damage);
+
+  swap_start = _clutter_util_get_monotonic_time ();
+
   /* push on the screen */
-  if (use_clipped_redraw)
+  if (use_clipped_redraw && !use_buffer_age)
     {
-      ClutterGeometry *clip = &stage_egl->bounding_redraw_clip;
-      int copy_area[4];
+      int copy_area[CLUTTER_STAGE_MAX_REDRAW_CLIPS * 4];
       ClutterActor *actor;
+      gfloat stage_height;
+      guint i;
 
       /* XXX: It seems there will be a race here in that the stage
        * window may be resized before the cogl_framebuffer_swap_region
@@ -430,23 +537,31 @@ clutter_stage_egl_redraw (ClutterStageWindow *stage_window)
        */
 
       actor = CLUTTER_ACTOR (wrapper);
-      copy_area[0] = clip->x;
-      copy_area[1] = clutter_actor_get_height (actor) - clip->y - clip->height;
-      copy_area[2] = clip->width;
-      copy_area[3] = clip->height;
-
-      CLUTTER_NOTE (BACKEND,
-                    "cogl_framebuffer_swap_region (onscreen: %p, "
-                                                  "x: %d, y: %d, "
-                                                  "width: %d, height: %d)",
-                    stage_egl->onscreen,
-                    copy_area[0], copy_area[1], copy_area[2], copy_area[3]);
+      stage_height = clutter_actor_get_height (actor);
 
+      for (i = 0; i < stage_egl->redraw_clips.n_rects; i++)
+        {
+          ClutterGeometry *clip = &stage_egl->redraw_clips.rects[i];
+          int *area = copy_area + i * 4;
+
+          area[0] = clip->x;
+          area[1] = stage_height - clip->y - clip->height;
+          area[2] = clip->width;
+          area[3] = clip->height;
+
+          CLUTTER_NOTE (BACKEND,
+                        "cogl_framebuffer_swap_region (onscreen: %p, "
+                                                      "x: %d, y: %d, "
+                                                      "width: %d, height: %d)",
+                        stage_egl->onscreen,
+                        area[0], area[1], area[2], area[3]);
+        }
 
       CLUTTER_TIMER_START (_clutter_uprof_context, blit_sub_buffer_timer);
 
       cogl_framebuffer_swap_region (COGL_FRAMEBUFFER (stage_egl->onscreen),
-                                    copy_area, 1);
+                                    copy_area,
+                                    stage_egl->redraw_clips.n_rects);
 
       CLUTTER_TIMER_STOP (_clutter_uprof_context, blit_sub_buffer_timer);
     }
@@ -460,6 +575,12 @@ clutter_stage_egl_redraw (ClutterStageWindow *stage_window)
       CLUTTER_TIMER_STOP (_clutter_uprof_context, swapbuffers_timer);
     }
 
+  _clutter_stage_add_swap_time (CLUTTER_STAGE (wrapper),
+                                _clutter_util_get_monotonic_time () - swap_start);
+
+  if (backend_egl->can_query_buffer_age)
+    stage_egl->last_surface = eglGetCurrentSurface (EGL_DRAW);
+
   /* reset the redraw clipping for the next paint... */
   stage_egl->initialized_redraw_clip = FALSE;
 
@@ -496,6 +617,7 @@ clutter_stage_window_iface_init (ClutterStageWindowIface *iface)
   iface->has_redraw_clips = clutter_stage_egl_has_redraw_clips;
   iface->ignoring_redraw_clips = clutter_stage_egl_ignoring_redraw_clips;
   iface->redraw = clutter_stage_egl_redraw;
+  iface->get_buffer_age = clutter_stage_egl_get_buffer_age;
 }
 
 #ifdef COGL_HAS_X11_SUPPORT
@@ -17,6 +17,7 @@
 #endif
 
 #include "clutter-backend-egl.h"
+#include "clutter-stage-private.h"
 
 G_BEGIN_DECLS
 
@@ -57,6 +58,18 @@ struct _ClutterStageEGL
 
   gboolean initialized_redraw_clip;
   ClutterGeometry bounding_redraw_clip;
+
+  /* the disjoint areas inside bounding_redraw_clip that need to be
+   * redrawn */
+  ClutterStageRedrawClips redraw_clips;
+
+  /* the damage of the last frames, used to repaint recycled back
+   * buffers when EGL_EXT_buffer_age is available */
+  ClutterStageDamageHistory damage_history;
+
+  /* the EGL surface that was current when the last frame was
+   * presented; Cogl does not expose the surface of the onscreen */
+  EGLSurface last_surface;
 };
 
 struct _ClutterStageEGLClass
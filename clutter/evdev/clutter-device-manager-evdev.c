@@ -30,6 +30,7 @@
 #include <sys/types.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <string.h>
 #include <unistd.h>
 
@@ -62,6 +63,7 @@ struct _ClutterDeviceManagerEvdevPrivate
   GUdevClient *udev_client;
 
   GSList *devices;          /* list of ClutterInputDeviceEvdevs */
+  GHashTable *devices_by_id;
   GSList *event_sources;    /* list of the event sources */
 
   ClutterInputDevice *core_pointer;
@@ -89,8 +91,20 @@ const char *option_xkb_options = "";
 
 /*
  * ClutterEventSource for reading input devices
+ *
+ * By default the devices are read from the main loop when their file
+ * descriptor becomes readable. If the CLUTTER_EVDEV_INPUT_THREAD
+ * environment variable is set, each source instead starts a thread
+ * reading the device as soon as events arrive, regardless of what the
+ * main loop is doing, and storing them into a ring buffer; the events
+ * are then translated by the main loop. Each ring buffer has a single
+ * producer, the input thread, and a single consumer, the main loop,
+ * so it only needs atomic operations on its head and tail.
  */
 
+/* must be a power of two */
+#define EVENT_RING_SIZE         512
+
 typedef struct _ClutterEventSource  ClutterEventSource;
 
 struct _ClutterEventSource
@@ -102,12 +116,35 @@ struct _ClutterEventSource
   struct xkb_desc *xkb;               /* compiled xkb keymap */
   uint32_t modifier_state;            /* remember the modifier state */
   gint x, y;                          /* last x, y position for pointers */
+
+  /* input thread, if any */
+  GThread *thread;
+  gint quit_pipe[2];                  /* wakes up the thread to quit it */
+  volatile gint failed;               /* set by the thread on errors */
+
+  /* events read by the input thread; ring_head is only written by
+   * the thread, ring_tail only by the main loop */
+  volatile gint ring_head;
+  volatile gint ring_tail;
+  struct input_event ring[EVENT_RING_SIZE];
 };
 
+static inline gboolean
+clutter_event_source_has_input (ClutterEventSource *source)
+{
+  if (source->thread == NULL)
+    return (source->event_poll_fd.revents & G_IO_IN) != 0;
+
+  return g_atomic_int_get (&source->ring_head) !=
+         g_atomic_int_get (&source->ring_tail) ||
+         g_atomic_int_get (&source->failed);
+}
+
 static gboolean
 clutter_event_prepare (GSource *source,
                        gint    *timeout)
 {
+  ClutterEventSource *event_source = (ClutterEventSource *) source;
   gboolean retval;
 
   clutter_threads_enter ();
@@ -115,6 +152,11 @@ clutter_event_prepare (GSource *source,
   *timeout = -1;
   retval = clutter_events_pending ();
 
+  /* the input thread does not wake up the poll() of the main loop
+   * using a file descriptor, so check the ring buffer here */
+  if (event_source->thread != NULL)
+    retval = retval || clutter_event_source_has_input (event_source);
+
   clutter_threads_leave ();
 
   return retval;
@@ -128,7 +170,7 @@ clutter_event_check (GSource *source)
 
   clutter_threads_enter ();
 
-  retval = ((event_source->event_poll_fd.revents & G_IO_IN) ||
+  retval = (clutter_event_source_has_input (event_source) ||
             clutter_events_pending ());
 
   clutter_threads_leave ();
@@ -258,6 +300,150 @@ notify_button (ClutterEventSource *source,
   queue_event (event);
 }
 
+static void
+process_events (ClutterEventSource       *source,
+                const struct input_event *ev,
+                guint                     n_events)
+{
+  ClutterEvent *event;
+  gint dx = 0, dy = 0;
+  uint32_t _time = 0;
+  guint i;
+
+  for (i = 0; i < n_events; i++)
+    {
+      const struct input_event *e = &ev[i];
+
+      _time = e->time.tv_sec * 1000 + e->time.tv_usec / 1000;
+      event = NULL;
+
+      switch (e->type)
+        {
+        case EV_KEY:
+
+          /* don't repeat mouse buttons */
+          if (e->code >= BTN_MOUSE && e->code < KEY_OK)
+            if (e->value == 2)
+              continue;
+
+          switch (e->code)
+            {
+            case BTN_TOUCH:
+            case BTN_TOOL_PEN:
+            case BTN_TOOL_RUBBER:
+            case BTN_TOOL_BRUSH:
+            case BTN_TOOL_PENCIL:
+            case BTN_TOOL_AIRBRUSH:
+            case BTN_TOOL_FINGER:
+            case BTN_TOOL_MOUSE:
+            case BTN_TOOL_LENS:
+              break;
+
+            case BTN_LEFT:
+            case BTN_RIGHT:
+            case BTN_MIDDLE:
+            case BTN_SIDE:
+            case BTN_EXTRA:
+            case BTN_FORWARD:
+            case BTN_BACK:
+            case BTN_TASK:
+              notify_button(source, _time, e->code, e->value);
+              break;
+
+            default:
+              notify_key (source, _time, e->code, e->value);
+            break;
+            }
+          break;
+
+        case EV_SYN:
+          /* Nothing to do here? */
+          break;
+
+        case EV_MSC:
+          /* Nothing to do here? */
+          break;
+
+        case EV_REL:
+          /* compress the EV_REL events in dx/dy */
+          switch (e->code)
+            {
+            case REL_X:
+              dx += e->value;
+              break;
+            case REL_Y:
+              dy += e->value;
+              break;
+            }
+          break;
+
+        case EV_ABS:
+        default:
+          g_warning ("Unhandled event of type %d", e->type);
+          break;
+        }
+
+      queue_event (event);
+    }
+
+  if (dx != 0 || dy != 0)
+    notify_motion (source, _time, source->x + dx, source->y + dy);
+}
+
+static void
+remove_faulty_device (ClutterEventSource *source)
+{
+  ClutterDeviceManager *manager;
+  ClutterInputDevice *device;
+  const gchar *device_path;
+
+  device = CLUTTER_INPUT_DEVICE (source->device);
+
+  if (CLUTTER_HAS_DEBUG (EVENT))
+    {
+      device_path =
+        _clutter_input_device_evdev_get_device_path (source->device);
+
+      CLUTTER_NOTE (EVENT, "Could not read device (%s), removing.",
+                    device_path);
+    }
+
+  /* remove the faulty device */
+  manager = clutter_device_manager_get_default ();
+  _clutter_device_manager_remove_device (manager, device);
+}
+
+/* translates the events stored in the ring buffer by the input thread */
+static gboolean
+process_ring (ClutterEventSource *source)
+{
+  guint head, tail;
+
+  if (g_atomic_int_get (&source->failed))
+    {
+      remove_faulty_device (source);
+      return FALSE;
+    }
+
+  head = (guint) g_atomic_int_get (&source->ring_head);
+  tail = (guint) source->ring_tail;
+
+  while (tail != head)
+    {
+      guint offset = tail & (EVENT_RING_SIZE - 1);
+      guint n_events = MIN (head - tail, EVENT_RING_SIZE - offset);
+
+      process_events (source, &source->ring[offset], n_events);
+
+      tail += n_events;
+    }
+
+  /* release the slots to the input thread */
+  g_atomic_int_set (&source->ring_tail, (gint) tail);
+
+  return TRUE;
+}
+
 static gboolean
 clutter_event_dispatch (GSource     *g_source,
                         GSourceFunc  callback,
@@ -266,8 +452,7 @@ clutter_event_dispatch (GSource     *g_source,
   ClutterEventSource *source = (ClutterEventSource *) g_source;
   struct input_event ev[8];
   ClutterEvent *event;
-  gint len, i, dx = 0, dy = 0;
-  uint32_t _time;
+  gint len;
 
   clutter_threads_enter ();
 
@@ -275,112 +460,24 @@ clutter_event_dispatch (GSource     *g_source,
    */
   if (!clutter_events_pending ())
     {
-       len = read (source->event_poll_fd.fd, &ev, sizeof (ev));
-       if (len < 0 || len % sizeof (ev[0]) != 0)
-       {
-         if (errno != EAGAIN)
-           {
-             ClutterDeviceManager *manager;
-             ClutterInputDevice *device;
-             const gchar *device_path;
-
-             device = CLUTTER_INPUT_DEVICE (source->device);
-
-             if (CLUTTER_HAS_DEBUG (EVENT))
-               {
-                 device_path =
-                   _clutter_input_device_evdev_get_device_path (source->device);
-
-                 CLUTTER_NOTE (EVENT, "Could not read device (%s), removing.",
-                               device_path);
-               }
-
-             /* remove the faulty device */
-             manager = clutter_device_manager_get_default ();
-             _clutter_device_manager_remove_device (manager, device);
-
-           }
-         goto out;
-       }
-
-       for (i = 0; i < len / sizeof (ev[0]); i++)
-         {
-           struct input_event *e = &ev[i];
-
-           _time = e->time.tv_sec * 1000 + e->time.tv_usec / 1000;
-           event = NULL;
-
-           switch (e->type)
-             {
-             case EV_KEY:
-
-               /* don't repeat mouse buttons */
-               if (e->code >= BTN_MOUSE && e->code < KEY_OK)
-                 if (e->value == 2)
-                   continue;
-
-               switch (e->code)
-                 {
-                 case BTN_TOUCH:
-                 case BTN_TOOL_PEN:
-                 case BTN_TOOL_RUBBER:
-                 case BTN_TOOL_BRUSH:
-                 case BTN_TOOL_PENCIL:
-                 case BTN_TOOL_AIRBRUSH:
-                 case BTN_TOOL_FINGER:
-                 case BTN_TOOL_MOUSE:
-                 case BTN_TOOL_LENS:
-                   break;
-
-                 case BTN_LEFT:
-                 case BTN_RIGHT:
-                 case BTN_MIDDLE:
-                 case BTN_SIDE:
-                 case BTN_EXTRA:
-                 case BTN_FORWARD:
-                 case BTN_BACK:
-                 case BTN_TASK:
-                   notify_button(source, _time, e->code, e->value);
-                   break;
-
-                 default:
-                   notify_key (source, _time, e->code, e->value);
-                 break;
-                 }
-               break;
-
-             case EV_SYN:
-               /* Nothing to do here? */
-               break;
-
-             case EV_MSC:
-               /* Nothing to do here? */
-               break;
-
-             case EV_REL:
-               /* compress the EV_REL events in dx/dy */
-               switch (e->code)
-                 {
-                 case REL_X:
-                   dx += e->value;
-                   break;
-                 case REL_Y:
-                   dy += e->value;
-                   break;
-                 }
-               break;
-
-             case EV_ABS:
-             default:
-               g_warning ("Unhandled event of type %d", e->type);
-               break;
-             }
-
-           queue_event (event);
-         }
-
-       if (dx != 0 || dy != 0)
-         notify_motion (source, _time, source->x + dx, source->y + dy);
+      if (source->thread != NULL)
+        {
+          if (!process_ring (source))
+            goto out;
+        }
+      else
+        {
+          len = read (source->event_poll_fd.fd, &ev, sizeof (ev));
+          if (len < 0 || len % sizeof (ev[0]) != 0)
+            {
+              if (errno != EAGAIN)
+                remove_faulty_device (source);
+
+              goto out;
+            }
+
+          process_events (source, ev, len / sizeof (ev[0]));
+        }
     }
 
   /* Pop an event off the queue if any */
@@ -398,6 +495,115 @@ out:
 
   return TRUE;
 }
+
+/* the input thread: reads the device into the ring buffer as soon as
+ * events are available, until it is asked to quit */
+static gpointer
+clutter_event_source_thread (gpointer data)
+{
+  ClutterEventSource *source = data;
+  struct pollfd fds[2];
+
+  fds[0].fd = source->event_poll_fd.fd;
+  fds[1].fd = source->quit_pipe[0];
+  fds[1].events = POLLIN;
+
+  while (TRUE)
+    {
+      guint head, tail, n_free, offset, n_events;
+      gssize len;
+
+      head = (guint) source->ring_head;
+      tail = (guint) g_atomic_int_get (&source->ring_tail);
+      n_free = EVENT_RING_SIZE - (head - tail);
+
+      /* if the ring buffer is full, let the kernel buffer the events
+       * and check again shortly */
+      fds[0].events = n_free > 0 ? POLLIN : 0;
+      fds[0].revents = fds[1].revents = 0;
+
+      if (poll (fds, 2, n_free > 0 ? -1 : 2) < 0)
+        {
+          if (errno == EINTR)
+            continue;
+
+          break;
+        }
+
+      if (fds[1].revents != 0)
+        break;
+
+      if (n_free == 0 || fds[0].revents == 0)
+        continue;
+
+      offset = head & (EVENT_RING_SIZE - 1);
+      n_events = MIN (n_free, EVENT_RING_SIZE - offset);
+
+      len = read (source->event_poll_fd.fd,
+                  &source->ring[offset],
+                  n_events * sizeof (struct input_event));
+      if (len < 0 && (errno == EAGAIN || errno == EINTR))
+        continue;
+
+      if (len < 0 || len % sizeof (struct input_event) != 0)
+        {
+          /* the device will be removed by the main loop */
+          g_atomic_int_set (&source->failed, TRUE);
+          g_main_context_wakeup (NULL);
+          break;
+        }
+
+      g_atomic_int_set (&source->ring_head,
+                        (gint) (head + len / sizeof (struct input_event)));
+
+      g_main_context_wakeup (NULL);
+    }
+
+  return NULL;
+}
+
+static gboolean
+clutter_event_source_use_thread (void)
+{
+  static gint use_thread = -1;
+
+  if (G_UNLIKELY (use_thread == -1))
+    use_thread = g_thread_supported () &&
+                 g_getenv ("CLUTTER_EVDEV_INPUT_THREAD") != NULL;
+
+  return use_thread;
+}
+
+static gboolean
+clutter_event_source_start_thread (ClutterEventSource *source)
+{
+  GError *error = NULL;
+
+  if (pipe (source->quit_pipe) < 0)
+    {
+      g_warning ("Could not create the input thread pipe: %s",
+                 strerror (errno));
+      return FALSE;
+    }
+
+  source->thread = g_thread_create (clutter_event_source_thread,
+                                    source,
+                                    TRUE,
+                                    &error);
+  if (source->thread == NULL)
+    {
+      g_warning ("Could not create the input thread: %s", error->message);
+      g_error_free (error);
+
+      close (source->quit_pipe[0]);
+      close (source->quit_pipe[1]);
+
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
 static GSourceFuncs event_funcs = {
   clutter_event_prepare,
   clutter_event_check,
@@ -465,9 +671,12 @@ clutter_event_source_new (ClutterInputDeviceEvdev *input_device)
       event_source->y = (gint) stage_height / 2;
     }
 
-  /* and finally configure and attach the GSource */
+  /* and finally configure and attach the GSource; when using an input
+   * thread, the thread is the only one polling the device */
   g_source_set_priority (source, CLUTTER_PRIORITY_EVENTS);
-  g_source_add_poll (source, &event_source->event_poll_fd);
+  if (!clutter_event_source_use_thread () ||
+      !clutter_event_source_start_thread (event_source))
+    g_source_add_poll (source, &event_source->event_poll_fd);
   g_source_set_can_recurse (source, TRUE);
   g_source_attach (source, NULL);
 
@@ -484,6 +693,19 @@ clutter_event_source_free (ClutterEventSource *source)
 
   CLUTTER_NOTE (EVENT, "Removing GSource for device %s", node_path);
 
+  if (source->thread != NULL)
+    {
+      /* the thread only needs to be woken up to see the request to
+       * quit, so we don't care about partial writes */
+      if (write (source->quit_pipe[1], "q", 1) < 0)
+        g_warning ("Could not stop the input thread: %s", strerror (errno));
+
+      g_thread_join (source->thread);
+
+      close (source->quit_pipe[0]);
+      close (source->quit_pipe[1]);
+    }
+
   /* ignore the return value of close, it's not like we can do something
    * about it */
   close (source->event_poll_fd.fd);
@@ -667,6 +889,9 @@ clutter_device_manager_evdev_add_device (ClutterDeviceManager *manager,
   is_keyboard = device_type == CLUTTER_KEYBOARD_DEVICE;
 
   priv->devices = g_slist_prepend (priv->devices, device);
+  g_hash_table_replace (priv->devices_by_id,
+                        GINT_TO_POINTER (clutter_input_device_get_device_id (device)),
+                        device);
 
   if (is_pointer && priv->core_pointer == NULL)
     priv->core_pointer = device;
@@ -693,6 +918,8 @@ clutter_device_manager_evdev_remove_device (ClutterDeviceManager *manager,
 
   /* Remove the device */
   priv->devices = g_slist_remove (priv->devices, device);
+  g_hash_table_remove (priv->devices_by_id,
+                       GINT_TO_POINTER (clutter_input_device_get_device_id (device)));
 
   /* Remove the source */
   source = find_source_by_device (manager_evdev, device);
@@ -743,21 +970,11 @@ clutter_device_manager_evdev_get_device (ClutterDeviceManager *manager,
                                          gint                  id)
 {
   ClutterDeviceManagerEvdev *manager_evdev;
-  ClutterDeviceManagerEvdevPrivate *priv;
-  GSList *l;
 
   manager_evdev = CLUTTER_DEVICE_MANAGER_EVDEV (manager);
-  priv = manager_evdev->priv;
 
-  for (l = priv->devices; l; l = l->next)
-    {
-      ClutterInputDevice *device = l->data;
-
-      if (clutter_input_device_get_device_id (device) == id)
-        return device;
-    }
-
-  return NULL;
+  return g_hash_table_lookup (manager_evdev->priv->devices_by_id,
+                              GINT_TO_POINTER (id));
 }
 
 /*
@@ -810,6 +1027,7 @@ clutter_device_manager_evdev_finalize (GObject *object)
       g_object_unref (device);
     }
   g_slist_free (priv->devices);
+  g_hash_table_destroy (priv->devices_by_id);
 
   for (l = priv->event_sources; l; l = g_slist_next (l))
     {
@@ -845,6 +1063,8 @@ static void
 clutter_device_manager_evdev_init (ClutterDeviceManagerEvdev *self)
 {
   self->priv = CLUTTER_DEVICE_MANAGER_EVDEV_GET_PRIVATE (self);
+
+  self->priv->devices_by_id = g_hash_table_new (NULL, NULL);
 }
 
 /*
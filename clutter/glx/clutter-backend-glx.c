@@ -182,8 +182,10 @@ static ClutterFeatureFlags
 clutter_backend_glx_get_features (ClutterBackend *backend)
 {
   ClutterBackendGLX *backend_glx = CLUTTER_BACKEND_GLX (backend);
+  ClutterBackendX11 *backend_x11 = CLUTTER_BACKEND_X11 (backend);
   ClutterBackendClass *parent_class;
   ClutterFeatureFlags flags;
+  const gchar *glx_extensions;
 
   parent_class = CLUTTER_BACKEND_CLASS (clutter_backend_glx_parent_class);
 
@@ -220,6 +222,23 @@ clutter_backend_glx_get_features (ClutterBackend *backend)
       backend_glx->can_blit_sub_buffer = TRUE;
     }
 
+  glx_extensions = glXQueryExtensionsString (backend_x11->xdpy,
+                                             backend_x11->xscreen_num);
+  if (_clutter_util_has_extension (glx_extensions, "GLX_EXT_buffer_age"))
+    {
+      CLUTTER_NOTE (BACKEND, "GLX supports querying the back buffer age");
+      backend_glx->can_query_buffer_age = TRUE;
+    }
+
+  if (_clutter_util_has_extension (glx_extensions, "GLX_OML_sync_control"))
+    {
+      backend_glx->get_sync_values = (ClutterGLXGetSyncValuesProc)
+        cogl_get_proc_address ("glXGetSyncValuesOML");
+
+      if (backend_glx->get_sync_values != NULL)
+        CLUTTER_NOTE (BACKEND, "GLX supports querying the vblank time");
+    }
+
   CLUTTER_NOTE (BACKEND, "backend features checked");
 
   return flags;
@@ -45,6 +45,12 @@ G_BEGIN_DECLS
 typedef struct _ClutterBackendGLX       ClutterBackendGLX;
 typedef struct _ClutterBackendGLXClass  ClutterBackendGLXClass;
 
+typedef Bool (* ClutterGLXGetSyncValuesProc) (Display     *dpy,
+                                              GLXDrawable  drawable,
+                                              gint64      *ust,
+                                              gint64      *msc,
+                                              gint64      *sbc);
+
 typedef enum ClutterGLXVBlankType {
   CLUTTER_VBLANK_NONE = 0,
   CLUTTER_VBLANK_AUTOMATIC_THROTTLE,
@@ -60,6 +66,12 @@ struct _ClutterBackendGLX
 
   gboolean can_blit_sub_buffer;
 
+  /* whether GLX_EXT_buffer_age is available */
+  gboolean can_query_buffer_age;
+
+  /* glXGetSyncValuesOML, if GLX_OML_sync_control is available */
+  ClutterGLXGetSyncValuesProc get_sync_values;
+
   /* props */
   Atom atom_WM_STATE;
   Atom atom_WM_STATE_FULLSCREEN;
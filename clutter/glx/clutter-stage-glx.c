@@ -77,6 +77,35 @@ clutter_stage_glx_unrealize (ClutterStageWindow *stage_window)
 
   cogl_object_unref (stage_glx->onscreen);
   stage_glx->onscreen = NULL;
+
+  stage_glx->last_drawable = None;
+  stage_glx->max_buffer_age = 0;
+  _clutter_stage_damage_history_reset (&stage_glx->damage_history);
+}
+
+static gint64
+clutter_stage_glx_get_presentation_time (ClutterStageGLX *stage_glx)
+{
+  ClutterStageX11 *stage_x11 = CLUTTER_STAGE_X11 (stage_glx);
+  ClutterBackendX11 *backend_x11 = CLUTTER_BACKEND_X11 (stage_x11->backend);
+  ClutterBackendGLX *backend_glx = CLUTTER_BACKEND_GLX (stage_x11->backend);
+  gint64 now = _clutter_util_get_monotonic_time ();
+  gint64 ust, msc, sbc;
+
+  /* the swap complete event is delivered right after the swap, but
+   * OML_sync_control can tell us exactly when the last vblank happened.
+   * The UST clock is only guaranteed to be the monotonic clock on Linux
+   * so we sanity check it */
+  if (backend_glx->get_sync_values != NULL &&
+      stage_glx->last_drawable != None &&
+      backend_glx->get_sync_values (backend_x11->xdpy,
+                                    stage_glx->last_drawable,
+                                    &ust, &msc, &sbc) &&
+      ust <= now &&
+      ust > now - G_USEC_PER_SEC)
+    return ust;
+
+  return now;
 }
 
 static void
@@ -84,6 +113,7 @@ handle_swap_complete_cb (CoglFramebuffer *framebuffer,
                          void *user_data)
 {
   ClutterStageGLX *stage_glx = user_data;
+  ClutterStageX11 *stage_x11 = CLUTTER_STAGE_X11 (stage_glx);
 
   /* Early versions of the swap_event implementation in Mesa
    * deliver BufferSwapComplete event when not selected for,
@@ -95,7 +125,15 @@ handle_swap_complete_cb (CoglFramebuffer *framebuffer,
    * need to care about this bug here.
    */
   if (stage_glx->pending_swaps > 0)
-    stage_glx->pending_swaps--;
+    {
+      gint64 presentation_time;
+
+      stage_glx->pending_swaps--;
+
+      presentation_time = clutter_stage_glx_get_presentation_time (stage_glx);
+      if (stage_x11->wrapper != NULL)
+        _clutter_stage_presented (stage_x11->wrapper, presentation_time);
+    }
 }
 
 static gboolean
@@ -166,6 +204,53 @@ clutter_stage_glx_get_pending_swaps (ClutterStageWindow *stage_window)
   return stage_glx->pending_swaps;
 }
 
+#ifndef GLX_BACK_BUFFER_AGE_EXT
+#define GLX_BACK_BUFFER_AGE_EXT 0x20F4
+#endif
+
+static int
+clutter_stage_glx_get_buffer_age (ClutterStageWindow *stage_window)
+{
+  ClutterStageX11 *stage_x11 = CLUTTER_STAGE_X11 (stage_window);
+  ClutterStageGLX *stage_glx = CLUTTER_STAGE_GLX (stage_window);
+  ClutterBackendX11 *backend_x11 = CLUTTER_BACKEND_X11 (stage_x11->backend);
+  ClutterBackendGLX *backend_glx = CLUTTER_BACKEND_GLX (stage_x11->backend);
+  unsigned int age = 0;
+
+  if (!backend_glx->can_query_buffer_age)
+    return 0;
+
+  /* the age can only be queried for the drawable bound to the current
+   * context; if something else is bound, e.g. another stage, we have
+   * no way to tell which drawable is ours and we play safe */
+  if (stage_glx->last_drawable == None ||
+      glXGetCurrentDrawable () != stage_glx->last_drawable)
+    return 0;
+
+  glXQueryDrawable (backend_x11->xdpy, stage_glx->last_drawable,
+                    GLX_BACK_BUFFER_AGE_EXT,
+                    &age);
+
+  if (age > stage_glx->max_buffer_age)
+    stage_glx->max_buffer_age = age;
+
+  return age;
+}
+
+static int
+clutter_stage_glx_get_swap_chain_depth (ClutterStageWindow *stage_window)
+{
+  ClutterStageGLX *stage_glx = CLUTTER_STAGE_GLX (stage_window);
+
+  /* GLX has no way to query the length of the swap chain, but the
+   * oldest back buffer the driver handed us tells us how many buffers
+   * it is cycling through; one of them is always the front buffer */
+  if (stage_glx->max_buffer_age > 2)
+    return stage_glx->max_buffer_age - 1;
+
+  return 1;
+}
+
 static void
 clutter_stage_glx_class_init (ClutterStageGLXClass *klass)
 {
@@ -218,11 +303,18 @@ clutter_stage_glx_ignoring_redraw_clips (ClutterStageWindow *stage_window)
  * A NULL stage_clip means the whole stage needs to be redrawn.
  *
  * What we do with this information:
- * - we keep track of the bounding box for all redraw clips
+ * - we keep track of the bounding box for all redraw clips, and of a
+ *   short list of disjoint rectangles inside it, so that two small
+ *   areas far apart from each other do not cause most of the stage
+ *   to be redrawn
  * - when we come to redraw; if the bounding box is smaller than the
- *   stage we scissor the redraw to that box and use
- *   GLX_MESA_copy_sub_buffer to present the redraw to the front
- *   buffer.
+ *   stage we paint the stage once for each rectangle, scissored to
+ *   it, and use GLX_MESA_copy_sub_buffer to present the rectangles to
+ *   the front buffer.
+ * - if GLX_EXT_buffer_age is available we instead add the damage of
+ *   the frames the back buffer has missed since it was last shown,
+ *   and swap the whole buffer. This lets us use clipped redraws when
+ *   the back buffers get flipped instead of copied.
  *
  * XXX - In theory, we should have some sort of heuristics to promote
  * a clipped redraw to a full screen redraw; in reality, it turns out
@@ -282,12 +374,17 @@ clutter_stage_glx_add_redraw_clip (ClutterStageWindow *stage_window,
       stage_glx->bounding_redraw_clip.y = stage_clip->y;
       stage_glx->bounding_redraw_clip.width = stage_clip->width;
       stage_glx->bounding_redraw_clip.height = stage_clip->height;
+
+      stage_glx->redraw_clips.n_rects = 0;
+      _clutter_stage_redraw_clips_add (&stage_glx->redraw_clips, stage_clip);
     }
   else if (stage_glx->bounding_redraw_clip.width > 0)
     {
       clutter_geometry_union (&stage_glx->bounding_redraw_clip,
                               stage_clip,
 			      &stage_glx->bounding_redraw_clip);
+
+      _clutter_stage_redraw_clips_add (&stage_glx->redraw_clips, stage_clip);
     }
 
 #if 0
@@ -324,6 +421,10 @@ clutter_stage_glx_redraw (ClutterStageWindow *stage_window)
   ClutterStageGLX *stage_glx;
   gboolean may_use_clipped_redraw;
   gboolean use_clipped_redraw;
+  gboolean use_buffer_age;
+  gboolean damage_is_full;
+  ClutterStageRedrawClips frame_damage;
+  gint64 swap_start;
 
   CLUTTER_STATIC_TIMER (painting_timer,
                         "Redrawing", /* parent */
@@ -351,7 +452,8 @@ clutter_stage_glx_redraw (ClutterStageWindow *stage_window)
 
   CLUTTER_TIMER_START (_clutter_uprof_context, painting_timer);
 
-  if (G_LIKELY (backend_glx->can_blit_sub_buffer) &&
+  if ((G_LIKELY (backend_glx->can_blit_sub_buffer) ||
+       backend_glx->can_query_buffer_age) &&
       /* NB: a zero width redraw clip == full stage redraw */
       stage_glx->bounding_redraw_clip.width != 0 &&
       /* some drivers struggle to get going and produce some junk
@@ -367,6 +469,36 @@ clutter_stage_glx_redraw (ClutterStageWindow *stage_window)
   else
     may_use_clipped_redraw = FALSE;
 
+  /* keep track of what changed in this frame, before adding what the
+   * back buffer is missing, so that the next frames can bring their
+   * own back buffers up to date */
+  damage_is_full = !stage_glx->initialized_redraw_clip ||
+                   stage_glx->bounding_redraw_clip.width == 0;
+  if (!damage_is_full)
+    frame_damage = stage_glx->redraw_clips;
+
+  use_buffer_age = FALSE;
+  if (backend_glx->can_query_buffer_age)
+    {
+      /* we always query the age, even for full redraws, since it also
+       * tells us the length of the swap chain */
+      int age = clutter_stage_glx_get_buffer_age (stage_window);
+
+      CLUTTER_NOTE (BACKEND, "Back buffer age: %d", age);
+
+      if (may_use_clipped_redraw)
+        {
+          ClutterStageDamageHistory *history = &stage_glx->damage_history;
+
+          if (_clutter_stage_damage_history_accumulate (history, age,
+                                                        &stage_glx->redraw_clips,
+                                                        &stage_glx->bounding_redraw_clip))
+            use_buffer_age = TRUE;
+          else if (!backend_glx->can_blit_sub_buffer)
+            may_use_clipped_redraw = FALSE;
+        }
+    }
+
   if (may_use_clipped_redraw &&
       G_LIKELY (!(clutter_paint_debug_flags &
                   CLUTTER_DEBUG_DISABLE_CLIPPED_REDRAWS)))
@@ -374,21 +506,14 @@ clutter_stage_glx_redraw (ClutterStageWindow *stage_window)
   else
     use_clipped_redraw = FALSE;
 
+  if (may_use_clipped_redraw)
+    _clutter_stage_redraw_clips_simplify (&stage_glx->redraw_clips,
+                                          &stage_glx->bounding_redraw_clip);
+
   if (use_clipped_redraw)
     {
-      CLUTTER_NOTE (CLIPPING,
-                    "Stage clip pushed: x=%d, y=%d, width=%d, height=%d\n",
-                    stage_glx->bounding_redraw_clip.x,
-                    stage_glx->bounding_redraw_clip.y,
-                    stage_glx->bounding_redraw_clip.width,
-                    stage_glx->bounding_redraw_clip.height);
-      cogl_clip_push_window_rectangle (stage_glx->bounding_redraw_clip.x,
-                                       stage_glx->bounding_redraw_clip.y,
-                                       stage_glx->bounding_redraw_clip.width,
-                                       stage_glx->bounding_redraw_clip.height);
-      _clutter_stage_do_paint (stage_x11->wrapper,
-                               &stage_glx->bounding_redraw_clip);
-      cogl_clip_pop ();
+      _clutter_stage_paint_redraw_clips (stage_x11->wrapper,
+                                         &stage_glx->redraw_clips);
     }
   else
     {
@@ -411,20 +536,9 @@ clutter_stage_glx_redraw (ClutterStageWindow *stage_window)
       G_UNLIKELY ((clutter_paint_debug_flags & CLUTTER_DEBUG_REDRAWS)))
     {
       static CoglMaterial *outline = NULL;
-      ClutterGeometry *clip = &stage_glx->bounding_redraw_clip;
       ClutterActor *actor = CLUTTER_ACTOR (stage_x11->wrapper);
-      CoglHandle vbo;
-      float x_1 = clip->x;
-      float x_2 = clip->x + clip->width;
-      float y_1 = clip->y;
-      float y_2 = clip->y + clip->height;
-      float quad[8] = {
-        x_1, y_1,
-        x_2, y_1,
-        x_2, y_2,
-        x_1, y_2
-      };
       CoglMatrix modelview;
+      guint i;
 
       if (outline == NULL)
         {
@@ -432,35 +546,61 @@ clutter_stage_glx_redraw (ClutterStageWindow *stage_window)
           cogl_material_set_color4ub (outline, 0xff, 0x00, 0x00, 0xff);
         }
 
-      vbo = cogl_vertex_buffer_new (4);
-      cogl_vertex_buffer_add (vbo,
-                              "gl_Vertex",
-                              2, /* n_components */
-                              COGL_ATTRIBUTE_TYPE_FLOAT,
-                              FALSE, /* normalized */
-                              0, /* stride */
-                              quad);
-      cogl_vertex_buffer_submit (vbo);
-
       cogl_push_matrix ();
       cogl_matrix_init_identity (&modelview);
       _clutter_actor_apply_modelview_transform (actor, &modelview);
       cogl_set_modelview_matrix (&modelview);
       cogl_set_source (outline);
-      cogl_vertex_buffer_draw (vbo, COGL_VERTICES_MODE_LINE_LOOP,
-                               0 , 4);
+
+      for (i = 0; i < stage_glx->redraw_clips.n_rects; i++)
+        {
+          ClutterGeometry *clip = &stage_glx->redraw_clips.rects[i];
+          CoglHandle vbo;
+          float x_1 = clip->x;
+          float x_2 = clip->x + clip->width;
+          float y_1 = clip->y;
+          float y_2 = clip->y + clip->height;
+          float quad[8] = {
+            x_1, y_1,
+            x_2, y_1,
+            x_2, y_2,
+            x_1, y_2
+          };
+
+          vbo = cogl_vertex_buffer_new (4);
+          cogl_vertex_buffer_add (vbo,
+                                  "gl_Vertex",
+                                  2, /* n_components */
+                                  COGL_ATTRIBUTE_TYPE_FLOAT,
+                                  FALSE, /* normalized */
+                                  0, /* stride */
+                                  quad);
+          cogl_vertex_buffer_submit (vbo);
+
+          cogl_vertex_buffer_draw (vbo, COGL_VERTICES_MODE_LINE_LOOP,
+                                   0 , 4);
+          cogl_object_unref (vbo);
+        }
+
       cogl_pop_matrix ();
-      cogl_object_unref (vbo);
     }
 
   CLUTTER_TIMER_STOP (_clutter_uprof_context, painting_timer);
 
+  if (backend_glx->can_query_buffer_age)
+    _clutter_stage_damage_history_record (&stage_glx->damage_history,
+                                          damage_is_full ? NULL
+                                                         : &frame_damage);
+
+  swap_start = _clutter_util_get_monotonic_time ();
+
   /* push on the screen */
-  if (use_clipped_redraw)
+  if (use_clipped_redraw && !use_buffer_age)
     {
-      ClutterGeometry *clip = &stage_glx->bounding_redraw_clip;
-      int copy_area[4];
+      int copy_area[CLUTTER_STAGE_MAX_REDRAW_CLIPS * 4];
       ClutterActor *actor;
+      gfloat stage_height;
+      guint i;
 
       /* XXX: It seems there will be a race here in that the stage
        * window may be resized before the cogl_framebuffer_swap_region
@@ -472,23 +612,31 @@ clutter_stage_glx_redraw (ClutterStageWindow *stage_window)
        */
 
       actor = CLUTTER_ACTOR (stage_x11->wrapper);
+      stage_height = clutter_actor_get_height (actor);
 
-      copy_area[0] = clip->x;
-      copy_area[1] = clutter_actor_get_height (actor) - clip->y - clip->height;
-      copy_area[2] = clip->width;
-      copy_area[3] = clip->height;
-
-      CLUTTER_NOTE (BACKEND,
-                    "cogl_framebuffer_swap_region (onscreen: %p, "
-                                                  "x: %d, y: %d, "
-                                                  "width: %d, height: %d)",
-                    stage_glx->onscreen,
-                    copy_area[0], copy_area[1], copy_area[2], copy_area[3]);
+      for (i = 0; i < stage_glx->redraw_clips.n_rects; i++)
+        {
+          ClutterGeometry *clip = &stage_glx->redraw_clips.rects[i];
+          int *area = copy_area + i * 4;
+
+          area[0] = clip->x;
+          area[1] = stage_height - clip->y - clip->height;
+          area[2] = clip->width;
+          area[3] = clip->height;
+
+          CLUTTER_NOTE (BACKEND,
+                        "cogl_framebuffer_swap_region (onscreen: %p, "
+                                                      "x: %d, y: %d, "
+                                                      "width: %d, height: %d)",
+                        stage_glx->onscreen,
+                        area[0], area[1], area[2], area[3]);
+        }
 
       CLUTTER_TIMER_START (_clutter_uprof_context, blit_sub_buffer_timer);
 
       cogl_framebuffer_swap_region (COGL_FRAMEBUFFER (stage_glx->onscreen),
-                                    copy_area, 1);
+                                    copy_area,
+                                    stage_glx->redraw_clips.n_rects);
 
       CLUTTER_TIMER_STOP (_clutter_uprof_context, blit_sub_buffer_timer);
     }
@@ -508,6 +656,11 @@ clutter_stage_glx_redraw (ClutterStageWindow *stage_window)
       CLUTTER_TIMER_STOP (_clutter_uprof_context, swapbuffers_timer);
     }
 
+  _clutter_stage_add_swap_time (stage_x11->wrapper,
+                                _clutter_util_get_monotonic_time () - swap_start);
+
+  stage_glx->last_drawable = glXGetCurrentDrawable ();
+
   /* reset the redraw clipping for the next paint... */
   stage_glx->initialized_redraw_clip = FALSE;
 
@@ -536,6 +689,8 @@ clutter_stage_window_iface_init (ClutterStageWindowIface *iface)
   iface->ignoring_redraw_clips = clutter_stage_glx_ignoring_redraw_clips;
   iface->redraw = clutter_stage_glx_redraw;
   iface->get_active_framebuffer = clutter_stage_glx_get_active_framebuffer;
+  iface->get_buffer_age = clutter_stage_glx_get_buffer_age;
+  iface->get_swap_chain_depth = clutter_stage_glx_get_swap_chain_depth;
 
   /* the rest is inherited from ClutterStageX11 */
 }
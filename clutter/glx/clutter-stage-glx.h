@@ -30,6 +30,7 @@
 #include <GL/gl.h>
 
 #include "clutter-backend-glx.h"
+#include "clutter-stage-private.h"
 #include "../x11/clutter-stage-x11.h"
 
 G_BEGIN_DECLS
@@ -62,6 +63,21 @@ struct _ClutterStageGLX
 
   ClutterGeometry bounding_redraw_clip;
 
+  /* the disjoint areas inside bounding_redraw_clip that need to be
+   * redrawn */
+  ClutterStageRedrawClips redraw_clips;
+
+  /* the damage of the last frames, used to repaint recycled back
+   * buffers when GLX_EXT_buffer_age is available */
+  ClutterStageDamageHistory damage_history;
+
+  /* the GLX drawable that was current when the last frame was
+   * swapped; Cogl does not expose the drawable of the onscreen */
+  GLXDrawable last_drawable;
+
+  /* the oldest back buffer we have been given so far */
+  unsigned int max_buffer_age;
+
   guint initialized_redraw_clip : 1;
 };
 
@@ -28,9 +28,9 @@
 
 #import <AppKit/AppKit.h>
 #include <glib.h>
-#include <pthread.h>
 #include <sys/types.h>
-#include <sys/uio.h>
+#include <sys/event.h>
+#include <sys/time.h>
 #include <unistd.h>
 #include <clutter/clutter-debug.h>
 
@@ -60,8 +60,10 @@
  * Both cases share a single problem: the OS X API's don't allow us to
  * wait simultaneously for file descriptors and for events. So when we
  * need to do a blocking wait that includes file descriptor activity, we
- * push the actual work of calling select() to a helper thread (the
- * "select thread") and wait for native events in the main thread.
+ * register the file descriptors with a kqueue, and we add the kqueue
+ * to the run loop of the main thread as a CFFileDescriptor source: the
+ * run loop wakes up as soon as one of the file descriptors is ready,
+ * without handing the wait over to another thread.
  *
  * The main known limitation of this code is that if a callback is triggered
  * via the OS X run loop while we are "polling" (in either case described
@@ -84,7 +86,7 @@ static int current_loop_level = 0;
 static int acquired_loop_level = -1;
 
 /* Between run_loop_before_waiting() and run_loop_after_waiting();
- * whether we we need to call select_thread_collect_poll()
+ * whether we need to call fd_watch_collect_poll()
  */
 static gboolean run_loop_polling_async = FALSE;
 
@@ -153,56 +155,20 @@ static NSAutoreleasePool *autorelease_pool;
 static gboolean getting_events;
 
 /************************************************************
- *********              Select Thread               *********
+ *********         File Descriptor Watching         *********
  ************************************************************/
 
-/* The states in our state machine, see comments in select_thread_func()
- * for descriptiions of each state
+/* The kqueue watching the file descriptors GLib is interested in,
+ * and the source that adds it to the run loop of the main thread
  */
-typedef enum {
-  BEFORE_START,
-  WAITING,
-  POLLING_QUEUED,
-  POLLING_RESTART,
-  POLLING_DESCRIPTORS,
-} SelectThreadState;
-
-static const char *const state_names[]  = {
-  "BEFORE_START",
-  "WAITING",
-  "POLLING_QUEUED",
-  "POLLING_RESTART",
-  "POLLING_DESCRIPTORS"
-};
-
-static SelectThreadState select_thread_state = BEFORE_START;
-
-static pthread_t select_thread;
-static pthread_mutex_t select_thread_mutex = PTHREAD_MUTEX_INITIALIZER;
-static pthread_cond_t select_thread_cond = PTHREAD_COND_INITIALIZER;
-
-#define SELECT_THREAD_LOCK() pthread_mutex_lock (&select_thread_mutex)
-#define SELECT_THREAD_UNLOCK() pthread_mutex_unlock (&select_thread_mutex)
-#define SELECT_THREAD_SIGNAL() pthread_cond_signal (&select_thread_cond)
-#define SELECT_THREAD_WAIT() pthread_cond_wait (&select_thread_cond, &select_thread_mutex)
-
-/* These are the file descriptors that the select thread is currently
- * polling.
- */
-static GPollFD *current_pollfds;
-static guint current_n_pollfds;
+static gint fd_watch_kqueue = -1;
+static CFFileDescriptorRef fd_watch_cf_fd = NULL;
 
-/* These are the file descriptors that the select thread should pick
- * up and start polling when it has a chance.
+/* The file descriptors currently registered with the kqueue; they are
+ * only registered again when GLib asks for a different set
  */
-static GPollFD *next_pollfds;
-static guint next_n_pollfds;
-
-/* Pipe used to wake up the select thread */
-static gint select_thread_wakeup_pipe[2];
-
-/* Run loop source used to wake up the main thread */
-static CFRunLoopSourceRef select_main_thread_source;
+static GPollFD *fd_watch_pollfds = NULL;
+static guint fd_watch_n_pollfds = 0;
 
 /* Events */
 typedef enum {
@@ -210,120 +176,21 @@ typedef enum {
 } ClutterOSXEventSubType;
 
 static void
-select_thread_set_state (SelectThreadState new_state)
+fd_watch_activity (CFFileDescriptorRef cf_fd,
+                   CFOptionFlags       callback_types,
+                   void               *info)
 {
-  gboolean old_state;
-
-  if (select_thread_state == new_state)
-    return;
-
-  CLUTTER_NOTE (EVENTLOOP, "EventLoop: Select thread state: %s => %s\n", state_names[select_thread_state], state_names[new_state]);
-
-  old_state = select_thread_state;
-  select_thread_state = new_state;
-  if (old_state == WAITING && new_state != WAITING)
-    SELECT_THREAD_SIGNAL ();
-}
+  NSEvent *event;
 
-static void
-signal_main_thread (void)
-{
-  CLUTTER_NOTE (EVENTLOOP, "EventLoop: Waking up main thread\n");
+  CLUTTER_NOTE (EVENTLOOP, "EventLoop: File descriptor activity\n");
 
-  /* If we are in nextEventMatchingMask, then we need to make sure an
-   * event gets queued, otherwise it's enough to simply wake up the
-   * main thread run loop
+  /* If CFRunLoop is in control, waking up its run loop is enough; if
+   * we are in nextEventMatchingMask, then we need to make sure an
+   * event gets queued so that it returns
    */
-  if (!run_loop_polling_async)
-    CFRunLoopSourceSignal (select_main_thread_source);
-  
-  if (CFRunLoopIsWaiting (main_thread_run_loop))
-    CFRunLoopWakeUp (main_thread_run_loop);
-}
-
-static void *
-select_thread_func (void *arg)
-{
-  char c;
-  
-  SELECT_THREAD_LOCK ();
-
-  while (TRUE)
-    {
-      switch (select_thread_state)
-	{
-	case BEFORE_START:
-	  /* The select thread has not been started yet
-	   */
-	  g_assert_not_reached ();
-	  
-	case WAITING:
-	  /* Waiting for a set of file descriptors to be submitted by the main thread
-	   *
-	   *  => POLLING_QUEUED: main thread thread submits a set of file descriptors
-	   */ 
-	  SELECT_THREAD_WAIT ();
-	  break;
-	  
-	case POLLING_QUEUED:
-	  /* Waiting for a set of file descriptors to be submitted by the main thread
-	   *
-	   *  => POLLING_DESCRIPTORS: select thread picks up the file descriptors to begin polling
-	   */ 
-	  if (current_pollfds)
-	    g_free (current_pollfds);
-	  
-	  current_pollfds = next_pollfds;
-	  current_n_pollfds = next_n_pollfds;
-
-	  next_pollfds = NULL;
-	  next_n_pollfds = 0;
-
-	  select_thread_set_state (POLLING_DESCRIPTORS);
-	  break;
-	  
-	case POLLING_RESTART:
-	  /* Select thread is currently polling a set of file descriptors, main thread has
-	   * began a new iteration with the same set of file descriptors. We don't want to
-	   * wake the select thread up and wait for it to restart immediately, but to avoid
-	   * a race (described below in select_thread_start_polling()) we need to recheck after
-	   * polling completes.
-	   *
-	   * => POLLING_DESCRIPTORS: select completes, main thread rechecks by polling again
-	   * => POLLING_QUEUED: main thread submits a new set of file descriptors to be polled
-	   */
-	  select_thread_set_state (POLLING_DESCRIPTORS);
-	  break;
-
-	case POLLING_DESCRIPTORS:
-	  /* In the process of polling the file descriptors
-	   *
-	   *  => WAITING: polling completes when a file descriptor becomes active
-	   *  => POLLING_QUEUED: main thread submits a new set of file descriptors to be polled
-	   *  => POLLING_RESTART: main thread begins a new iteration with the same set file descriptors
-	   */ 
-	  SELECT_THREAD_UNLOCK ();
-	  old_poll_func (current_pollfds, current_n_pollfds, -1);
-	  SELECT_THREAD_LOCK ();
-
-	  read (select_thread_wakeup_pipe[0], &c, 1);
-
-	  if (select_thread_state == POLLING_DESCRIPTORS)
-	    {
-	      signal_main_thread ();
-	      select_thread_set_state (WAITING);
-	    }
-	  break;
-	}
-    }
-}
-
-static void 
-got_fd_activity (void *info)
-{
-  NSEvent *event;
+  if (run_loop_polling_async)
+    return;
 
-  /* Post a message so we'll break out of the message loop */
   event = [NSEvent otherEventWithType: NSApplicationDefined
 	                     location: NSZeroPoint
 	                modifierFlags: 0
@@ -337,30 +204,62 @@ got_fd_activity (void *info)
   [NSApp postEvent:event atStart:YES];
 }
 
-static void
-select_thread_start (void)
+static gboolean
+fd_watch_start (void)
 {
-  CFRunLoopSourceContext source_context = {0, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, got_fd_activity };
+  CFRunLoopSourceRef source;
 
-  g_return_if_fail (select_thread_state == BEFORE_START);
-  
-  pipe (select_thread_wakeup_pipe);
-  fcntl (select_thread_wakeup_pipe[0], F_SETFL, O_NONBLOCK);
+  fd_watch_kqueue = kqueue ();
+  if (fd_watch_kqueue < 0)
+    {
+      g_warning ("Failed to create a kqueue, file descriptors will only "
+                 "be checked when the main loop is woken up");
+      return FALSE;
+    }
 
-  select_main_thread_source = CFRunLoopSourceCreate (NULL, 0, &source_context);
-  
-  CFRunLoopAddSource (main_thread_run_loop, select_main_thread_source, kCFRunLoopCommonModes);
+  fd_watch_cf_fd = CFFileDescriptorCreate (NULL, /* default allocator */
+                                           fd_watch_kqueue,
+                                           false, /* we close it */
+                                           fd_watch_activity,
+                                           NULL);
 
-  select_thread_state = WAITING;
-  
-  while (TRUE)
+  source = CFFileDescriptorCreateRunLoopSource (NULL, fd_watch_cf_fd, 0);
+  CFRunLoopAddSource (main_thread_run_loop, source, kCFRunLoopCommonModes);
+  CFRelease (source);
+
+  return TRUE;
+}
+
+/* Adds or removes the kqueue filters matching the events of @pollfd;
+ * errors are ignored, since the file descriptors closed after being
+ * registered are already gone from the kqueue
+ */
+static void
+fd_watch_change (const GPollFD *pollfd,
+                 gushort        flags)
+{
+  struct kevent changes[2];
+  gint n_changes = 0, i;
+
+  if (pollfd->fd < 0)
+    return;
+
+  if ((pollfd->events & (G_IO_IN | G_IO_PRI)) != 0 ||
+      (pollfd->events & G_IO_OUT) == 0)
     {
-      if (pthread_create (&select_thread, NULL, select_thread_func, NULL) == 0)
-	  break;
+      EV_SET (&changes[n_changes], pollfd->fd, EVFILT_READ, flags, 0, 0, NULL);
+      n_changes++;
+    }
 
-      g_warning ("Failed to create select thread, sleeping and trying again");
-      sleep (1);
+  if ((pollfd->events & G_IO_OUT) != 0)
+    {
+      EV_SET (&changes[n_changes], pollfd->fd, EVFILT_WRITE, flags, 0, 0, NULL);
+      n_changes++;
     }
+
+  /* one change at a time, so that an error does not stop the others */
+  for (i = 0; i < n_changes; i++)
+    kevent (fd_watch_kqueue, &changes[i], 1, NULL, 0, NULL);
 }
 
 #ifdef G_ENABLE_DEBUG
@@ -387,7 +286,7 @@ dump_poll_result (GPollFD *ufds,
 }
 #endif
 
-gboolean
+static gboolean
 pollfds_equal (GPollFD *old_pollfds,
 	       guint    old_n_pollfds,
 	       GPollFD *new_pollfds,
@@ -418,11 +317,11 @@ pollfds_equal (GPollFD *old_pollfds,
  * > 0: Number of file descriptors ready
  */
 static gint
-select_thread_start_poll (GPollFD *ufds,
-			  guint    nfds,			  gint     timeout)
+fd_watch_start_poll (GPollFD *ufds,
+                     guint    nfds,
+                     gint     timeout)
 {
   gint n_ready;
-  gboolean have_new_pollfds = FALSE;
   gint poll_fd_index = -1;
   gint i;
 
@@ -462,150 +361,66 @@ select_thread_start_poll (GPollFD *ufds,
   
       return n_ready;
     }
-  
-  SELECT_THREAD_LOCK ();
 
-  if (select_thread_state == BEFORE_START)
-    {
-      select_thread_start ();
-    }
-  
-  if (select_thread_state == POLLING_QUEUED)
-    {
-      /* If the select thread hasn't picked up the set of file descriptors yet
-       * then we can simply replace an old stale set with a new set.
-       */
-      if (!pollfds_equal (ufds, nfds, next_pollfds, next_n_pollfds - 1))
-	{
-	  g_free (next_pollfds);
-	  next_pollfds = NULL;
-	  next_n_pollfds = 0;
-	  
-	  have_new_pollfds = TRUE;
-	}
-    }
-  else if (select_thread_state == POLLING_RESTART || select_thread_state == POLLING_DESCRIPTORS)
-    {
-      /* If we are already in the process of polling the right set of file descriptors,
-       * there's no need for us to immediately force the select thread to stop polling
-       * and then restart again. And avoiding doing so increases the efficiency considerably
-       * in the common case where we have a set of basically inactive file descriptors that
-       * stay unchanged present as we process many events.
-       *
-       * However, we have to be careful that we don't hit the following race condition
-       *  Select Thread              Main Thread
-       *  -----------------          ---------------
-       *  Polling Completes
-       *                             Reads data or otherwise changes file descriptor state
-       *                             Checks if polling is current
-       *                             Does nothing (*)
-       *                             Releases lock
-       *  Acquires lock
-       *  Marks polling as complete
-       *  Wakes main thread
-       *                             Receives old stale file descriptor state
-       * 
-       * To avoid this, when the new set of poll descriptors is the same as the current
-       * one, we transition to the POLLING_RESTART stage at the point marked (*). When
-       * the select thread wakes up from the poll because a file descriptor is active, if
-       * the state is POLLING_RESTART it immediately begins polling same the file descriptor
-       * set again. This normally will just return the same set of active file descriptors
-       * as the first time, but in sequence described above will properly update the
-       * file descriptor state.
-       *
-       * Special case: this RESTART logic is not needed if the only FD is the internal GLib
-       * "wakeup pipe" that is presented when threads are initialized.
-       *
-       * P.S.: The harm in the above sequence is mostly that sources can be signalled
-       *   as ready when they are no longer ready. This may prompt a blocking read
-       *   from a file descriptor that hangs.
-       */
-      if (!pollfds_equal (ufds, nfds, current_pollfds, current_n_pollfds - 1))
-	have_new_pollfds = TRUE;
-      else
-	{
-	  if (!((nfds == 1 && poll_fd_index < 0 && g_thread_supported ()) ||
-		(nfds == 2 && poll_fd_index >= 0 && g_thread_supported ())))
-	    select_thread_set_state (POLLING_RESTART);
-	}
-    }
-  else
-    have_new_pollfds = TRUE;
+  if (fd_watch_kqueue < 0 && !fd_watch_start ())
+    return 0;
 
-  if (have_new_pollfds)
+  /* The filters are level-triggered, so the kqueue stays readable for
+   * as long as one of the file descriptors is ready, and enabling the
+   * callback below cannot miss activity that happened since the check
+   * above; the set of file descriptors rarely changes between two
+   * iterations, so we only register it again when it does
+   */
+  if (!pollfds_equal (ufds, nfds, fd_watch_pollfds, fd_watch_n_pollfds))
     {
-      CLUTTER_NOTE (EVENTLOOP, "EventLoop: Submitting a new set of file descriptor to the select thread\n");
-      
-      g_assert (next_pollfds == NULL);
-      
-      next_n_pollfds = nfds + 1;
-      next_pollfds = g_new (GPollFD, nfds + 1);
-      memcpy (next_pollfds, ufds, nfds * sizeof (GPollFD));
-  
-      next_pollfds[nfds].fd = select_thread_wakeup_pipe[0];
-      next_pollfds[nfds].events = G_IO_IN;
-  
-      if (select_thread_state != POLLING_QUEUED && select_thread_state != WAITING)
-	{
-	  if (select_thread_wakeup_pipe[1])
-	    {
-	      char c = 'A';
-	      write (select_thread_wakeup_pipe[1], &c, 1);
-	    }
-	}
-      
-      select_thread_set_state (POLLING_QUEUED);
+      CLUTTER_NOTE (EVENTLOOP, "EventLoop: Watching a new set of file descriptors\n");
+
+      for (i = 0; i < fd_watch_n_pollfds; i++)
+        fd_watch_change (&fd_watch_pollfds[i], EV_DELETE);
+
+      g_free (fd_watch_pollfds);
+      fd_watch_pollfds = g_memdup (ufds, nfds * sizeof (GPollFD));
+      fd_watch_n_pollfds = nfds;
+
+      for (i = 0; i < fd_watch_n_pollfds; i++)
+        fd_watch_change (&fd_watch_pollfds[i], EV_ADD | EV_ENABLE);
     }
-  
-  SELECT_THREAD_UNLOCK ();
+
+  /* the callback is disabled each time it is called */
+  CFFileDescriptorEnableCallBacks (fd_watch_cf_fd,
+                                   kCFFileDescriptorReadCallBack);
 
   return -1;
 }
 
 /* End an asynchronous polling operation started with
- * select_thread_collect_poll(). This must be called if and only if
- * select_thread_start_poll() return -1. The GPollFD array passed
- * in must be identical to the one passed to select_thread_start_poll().
+ * fd_watch_start_poll(). This must be called if and only if
+ * fd_watch_start_poll() return -1. The GPollFD array passed
+ * in must be identical to the one passed to fd_watch_start_poll().
  *
- * The results of the poll are written into the GPollFD array passed in.
+ * The results of the poll are written into the GPollFD array passed in;
+ * since the file descriptors are checked again on the main thread, the
+ * results are never stale.
  *
  * Return Value: number of file descriptors ready
  */
 static int
-select_thread_collect_poll (GPollFD *ufds, guint nfds)
+fd_watch_collect_poll (GPollFD *ufds, guint nfds)
 {
-  gint i;
-  gint n_ready = 0;
-  
-  SELECT_THREAD_LOCK ();
+  gint n_ready;
+
+  CFFileDescriptorDisableCallBacks (fd_watch_cf_fd,
+                                    kCFFileDescriptorReadCallBack);
+
+  n_ready = old_poll_func (ufds, nfds, 0);
 
-  if (select_thread_state == WAITING) /* The poll completed */
-    {
-      for (i = 0; i < nfds; i++)
-	{
-	  if (ufds[i].fd == -1)
-	    continue;
-	  
-	  g_assert (ufds[i].fd == current_pollfds[i].fd);
-	  g_assert (ufds[i].events == current_pollfds[i].events);
-
-	  if (current_pollfds[i].revents)
-	    {
-	      ufds[i].revents = current_pollfds[i].revents;
-	      n_ready++;
-	    }
-	}
-      
 #ifdef G_ENABLE_DEBUG
-      if (_gdk_debug_flags & GDK_DEBUG_EVENTLOOP)
-	{
-	  g_print ("EventLoop: Found ready file descriptors after waiting\n");
-	  dump_poll_result (ufds, nfds);
-	}
-#endif
+  if (CLUTTER_HAS_DEBUG (EVENTLOOP) && n_ready > 0)
+    {
+      g_print ("EventLoop: Found ready file descriptors after waiting\n");
+      dump_poll_result (ufds, nfds);
     }
-
-  SELECT_THREAD_UNLOCK ();
+#endif
 
   return n_ready;
 }
@@ -736,7 +551,7 @@ poll_func (GPollFD *ufds,
   NSDate *limit_date;
   gint n_ready;
 
-  n_ready = select_thread_start_poll (ufds, nfds, timeout_);
+  n_ready = fd_watch_start_poll (ufds, nfds, timeout_);
   if (n_ready > 0)
     timeout_ = 0;
 
@@ -755,7 +570,7 @@ poll_func (GPollFD *ufds,
   getting_events = FALSE;
 
   if (n_ready < 0)
-    n_ready = select_thread_collect_poll (ufds, nfds);
+    n_ready = fd_watch_collect_poll (ufds, nfds);
       
   if (event &&
       [event type] == NSApplicationDefined &&
@@ -902,7 +717,7 @@ run_loop_before_waiting (void)
   
   run_loop_n_pollfds = query_main_context (context, run_loop_max_priority, &timeout);
 
-  n_ready = select_thread_start_poll (run_loop_pollfds, run_loop_n_pollfds, timeout);
+  n_ready = fd_watch_start_poll (run_loop_pollfds, run_loop_n_pollfds, timeout);
 
   if (n_ready > 0 || timeout == 0)
     {
@@ -949,7 +764,7 @@ run_loop_after_waiting (void)
   
   if (run_loop_polling_async)
     {
-      select_thread_collect_poll (run_loop_pollfds, run_loop_n_pollfds);
+      fd_watch_collect_poll (run_loop_pollfds, run_loop_n_pollfds);
       run_loop_polling_async = FALSE;
     }
   
@@ -32,6 +32,7 @@
 #include <glib.h>
 #include <glib/gstdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/mman.h>
 #include <unistd.h>
 #include <wayland-util.h>
@@ -54,7 +55,9 @@
 #include "cogl/cogl-framebuffer-private.h"
 
 static void
-wayland_swap_buffers (ClutterStageWayland *stage_wayland);
+wayland_swap_buffers (ClutterStageWayland *stage_wayland,
+                      cairo_region_t      *changed,
+                      cairo_region_t      *damage);
 
 static void clutter_stage_window_iface_init (ClutterStageWindowIface *iface);
 
@@ -89,57 +92,54 @@ get_visual (struct wl_display *display, CoglPixelFormat format)
       return NULL;
     }
 }
-static ClutterStageWaylandWaylandBuffer *
-wayland_create_shm_buffer (ClutterBackendWayland *backend_wayland,
-                           ClutterGeometry *geom)
+/* The buffers are allocated with a capacity that can be larger than
+ * the stage, and the stage is drawn in their top left corner; when
+ * the stage is resized we only create a new wl_buffer with the new
+ * size on top of the same storage, unless the stage outgrows it, in
+ * which case the capacity grows geometrically so that an interactive
+ * resize or an animation of the size of the stage only reallocates
+ * the buffers a handful of times.
+ */
+#define BUFFER_GROWTH(size)     ((size) + (size) / 2)
+
+static void
+wayland_create_shm_storage (ClutterStageWaylandWaylandBufferSHM *buffer,
+                            gint                                 width,
+                            gint                                 height)
 {
-  ClutterStageWaylandWaylandBufferSHM *buffer;
-  struct wl_visual *visual;
   CoglHandle tex;
   CoglTextureFlags flags = COGL_TEXTURE_NONE; /* XXX: tweak flags? */
   CoglPixelFormat format = VISUAL_ARGB_PRE;
-  int fd;
   gchar tmp[] = "/tmp/clutter-wayland-shm-XXXXXX";
 
-  buffer = g_slice_new (ClutterStageWaylandWaylandBufferSHM);
-
   buffer->buffer.type = BUFFER_TYPE_SHM;
 
-  tex = cogl_texture_new_with_size ((unsigned int)geom->width,
-			       (unsigned int)geom->height,
+  tex = cogl_texture_new_with_size ((unsigned int)width,
+			       (unsigned int)height,
 			       flags, format);
   buffer->format = format;
   buffer->stride = cogl_texture_get_rowstride(tex);
   buffer->size = cogl_texture_get_data(tex, format, buffer->stride, NULL);
   buffer->buffer.tex = tex;
+  buffer->data_valid = FALSE;
 
-  fd = g_mkstemp_full(tmp, O_RDWR, 0600);
-  ftruncate(fd, buffer->size);
+  /* the file is kept open, so that wl_buffers of a different size
+   * can be created on top of it */
+  buffer->fd = g_mkstemp_full(tmp, O_RDWR, 0600);
+  ftruncate(buffer->fd, buffer->size);
   buffer->data = mmap(NULL, buffer->size, PROT_READ | PROT_WRITE,
-	              MAP_SHARED, fd, 0);
+	              MAP_SHARED, buffer->fd, 0);
 
   g_unlink(tmp);
-
-  visual = get_visual (backend_wayland->wayland_display, format);
-
-  buffer->buffer.wayland_buffer =
-    wl_shm_create_buffer (backend_wayland->wayland_shm,
-                          fd,
-                          geom->width,
-                          geom->height,
-                          buffer->stride, visual);
-  close(fd);
-  return &buffer->buffer;
 }
 
-static ClutterStageWaylandWaylandBuffer *
-wayland_create_drm_buffer (ClutterBackendWayland *backend_wayland,
-                           ClutterGeometry *geom)
+static void
+wayland_create_drm_storage (ClutterBackendWayland               *backend_wayland,
+                            ClutterStageWaylandWaylandBufferDRM *buffer,
+                            gint                                 width,
+                            gint                                 height)
 {
   EGLDisplay edpy = clutter_wayland_get_egl_display ();
-  struct wl_visual *visual;
-  EGLint name, stride;
-  ClutterStageWaylandWaylandBufferDRM *buffer;
   EGLint image_attribs[] = {
       EGL_WIDTH, 0,
       EGL_HEIGHT, 0,
@@ -148,12 +148,10 @@ wayland_create_drm_buffer (ClutterBackendWayland *backend_wayland,
       EGL_NONE
   };
 
-  buffer = g_slice_new (ClutterStageWaylandWaylandBufferDRM);
-
   buffer->buffer.type = BUFFER_TYPE_DRM;
 
-  image_attribs[1] = geom->width;
-  image_attribs[3] = geom->height;
+  image_attribs[1] = width;
+  image_attribs[3] = height;
   buffer->drm_image = backend_wayland->create_drm_image (edpy, image_attribs);
   glGenTextures (1, &buffer->texture);
   glBindTexture (GL_TEXTURE_2D, buffer->texture);
@@ -161,48 +159,113 @@ wayland_create_drm_buffer (ClutterBackendWayland *backend_wayland,
 
   buffer->buffer.tex = cogl_texture_new_from_foreign (buffer->texture,
 					       GL_TEXTURE_2D,
-					       geom->width,
-					       geom->height,
+					       width,
+					       height,
 					       0,
 					       0,
 					       VISUAL_ARGB_PRE);
 
   backend_wayland->export_drm_image (edpy, buffer->drm_image,
-				     &name, NULL, &stride);
+				     &buffer->name, NULL, &buffer->stride);
+}
+
+/* creates the wl_buffer showing the top left @width x @height pixels
+ * of the storage of @buffer */
+static void
+wayland_buffer_set_size (ClutterBackendWayland            *backend_wayland,
+                         ClutterStageWaylandWaylandBuffer *buffer,
+                         gint                              width,
+                         gint                              height)
+{
+  struct wl_visual *visual;
+  cairo_rectangle_int_t rect;
+
+  if (buffer->wayland_buffer != NULL)
+    wl_buffer_destroy (buffer->wayland_buffer);
+
   visual = get_visual (backend_wayland->wayland_display, VISUAL_ARGB_PRE);
-  buffer->buffer.wayland_buffer =
-    wl_drm_create_buffer (backend_wayland->wayland_drm,
-                          name,
-                          geom->width,
-                          geom->height,
-                          stride, visual);
 
-  return &buffer->buffer;
+  if (buffer->type == BUFFER_TYPE_DRM)
+    {
+      ClutterStageWaylandWaylandBufferDRM *drm_buffer =
+        (ClutterStageWaylandWaylandBufferDRM *) buffer;
+
+      buffer->wayland_buffer =
+        wl_drm_create_buffer (backend_wayland->wayland_drm,
+                              drm_buffer->name,
+                              width,
+                              height,
+                              drm_buffer->stride, visual);
+    }
+  else
+    {
+      ClutterStageWaylandWaylandBufferSHM *shm_buffer =
+        (ClutterStageWaylandWaylandBufferSHM *) buffer;
+
+      buffer->wayland_buffer =
+        wl_shm_create_buffer (backend_wayland->wayland_shm,
+                              shm_buffer->fd,
+                              width,
+                              height,
+                              shm_buffer->stride, visual);
+    }
+
+  buffer->width = width;
+  buffer->height = height;
+
+  /* the contents do not match the new size, so everything has to be
+   * painted again */
+  if (buffer->dirty_region != NULL)
+    cairo_region_destroy (buffer->dirty_region);
+
+  rect.x = 0;
+  rect.y = 0;
+  rect.width = width;
+  rect.height = height;
+  buffer->dirty_region = cairo_region_create_rectangle (&rect);
 }
 
 static ClutterStageWaylandWaylandBuffer *
-wayland_create_buffer (ClutterGeometry *geom)
+wayland_create_buffer (ClutterGeometry *geom,
+                       gint             capacity_width,
+                       gint             capacity_height)
 {
   ClutterBackend *backend = clutter_get_default_backend ();
   ClutterBackendWayland *backend_wayland = CLUTTER_BACKEND_WAYLAND (backend);
   ClutterStageWaylandWaylandBuffer *buffer;
-  cairo_rectangle_int_t rect;
+
+  capacity_width = MAX (capacity_width, geom->width);
+  capacity_height = MAX (capacity_height, geom->height);
 
   if (backend_wayland->drm_enabled &&
       backend_wayland->wayland_drm != NULL)
-    buffer = wayland_create_drm_buffer (backend_wayland, geom);
+    {
+      ClutterStageWaylandWaylandBufferDRM *drm_buffer;
+
+      drm_buffer = g_slice_new0 (ClutterStageWaylandWaylandBufferDRM);
+      wayland_create_drm_storage (backend_wayland, drm_buffer,
+                                  capacity_width, capacity_height);
+      buffer = &drm_buffer->buffer;
+    }
   else if (backend_wayland->wayland_shm != NULL)
-    buffer = wayland_create_shm_buffer (backend_wayland, geom);
+    {
+      ClutterStageWaylandWaylandBufferSHM *shm_buffer;
+
+      shm_buffer = g_slice_new0 (ClutterStageWaylandWaylandBufferSHM);
+      wayland_create_shm_storage (shm_buffer,
+                                  capacity_width, capacity_height);
+      buffer = &shm_buffer->buffer;
+    }
   else
     return NULL;
 
+  buffer->capacity_width = capacity_width;
+  buffer->capacity_height = capacity_height;
+
   buffer->offscreen = cogl_offscreen_new_to_texture (buffer->tex);
 
-  rect.x = geom->x;
-  rect.y = geom->y;
-  rect.width = geom->width;
-  rect.height = geom->height;
-  buffer->dirty_region = cairo_region_create_rectangle (&rect);
+  wayland_buffer_set_size (backend_wayland, buffer,
+                           geom->width, geom->height);
 
   return buffer;
 }
@@ -215,6 +278,7 @@ wayland_free_shm_buffer (ClutterStageWaylandWaylandBuffer *generic_buffer)
   buffer = (ClutterStageWaylandWaylandBufferSHM *)generic_buffer;
 
   munmap(buffer->data, buffer->size);
+  close(buffer->fd);
   g_slice_free (ClutterStageWaylandWaylandBufferSHM, buffer);
 }
 
@@ -240,12 +304,61 @@ wayland_free_buffer (ClutterStageWaylandWaylandBuffer *buffer)
   wl_buffer_destroy (buffer->wayland_buffer);
   cogl_handle_unref (buffer->offscreen);
 
+  if (buffer->dirty_region != NULL)
+    cairo_region_destroy (buffer->dirty_region);
+
   if (buffer->type == BUFFER_TYPE_DRM)
     wayland_free_drm_buffer(buffer);
   else if (buffer->type == BUFFER_TYPE_SHM)
     wayland_free_shm_buffer(buffer);
 }
 
+/* makes sure that *@buffer_p is a buffer of the size of @geom, reusing
+ * its storage if possible */
+static void
+wayland_ensure_buffer (ClutterStageWaylandWaylandBuffer **buffer_p,
+                       ClutterGeometry                   *geom)
+{
+  ClutterBackend *backend = clutter_get_default_backend ();
+  ClutterBackendWayland *backend_wayland = CLUTTER_BACKEND_WAYLAND (backend);
+  ClutterStageWaylandWaylandBuffer *buffer = *buffer_p;
+  gint capacity_width, capacity_height;
+
+  if (buffer == NULL)
+    {
+      *buffer_p = wayland_create_buffer (geom, geom->width, geom->height);
+      return;
+    }
+
+  if (buffer->width == geom->width && buffer->height == geom->height)
+    return;
+
+  /* the storage is reused as long as the stage fits, and it is not
+   * wasting more than three quarters of it */
+  if (geom->width <= buffer->capacity_width &&
+      geom->height <= buffer->capacity_height &&
+      (gint64) geom->width * geom->height * 4 >=
+      (gint64) buffer->capacity_width * buffer->capacity_height)
+    {
+      wayland_buffer_set_size (backend_wayland, buffer,
+                               geom->width, geom->height);
+      return;
+    }
+
+  capacity_width = geom->width;
+  if (geom->width > buffer->capacity_width)
+    capacity_width = MAX (capacity_width,
+                          BUFFER_GROWTH (buffer->capacity_width));
+
+  capacity_height = geom->height;
+  if (geom->height > buffer->capacity_height)
+    capacity_height = MAX (capacity_height,
+                           BUFFER_GROWTH (buffer->capacity_height));
+
+  wayland_free_buffer (buffer);
+  *buffer_p = wayland_create_buffer (geom, capacity_width, capacity_height);
+}
+
 static void
 clutter_stage_wayland_unrealize (ClutterStageWindow *stage_window)
 {
@@ -284,8 +397,8 @@ clutter_stage_wayland_realize (ClutterStageWindow *stage_window)
     wl_compositor_create_surface (backend_wayland->wayland_compositor);
   wl_surface_set_user_data (stage_wayland->wayland_surface, stage_wayland);
 
-  stage_wayland->pick_buffer =
-    wayland_create_buffer (&stage_wayland->allocation);
+  wayland_ensure_buffer (&stage_wayland->pick_buffer,
+                         &stage_wayland->allocation);
 
   return TRUE;
 }
@@ -375,7 +488,10 @@ clutter_stage_wayland_resize (ClutterStageWindow *stage_window,
   rect.y = stage_wayland->pending_allocation.y;
   rect.width = stage_wayland->pending_allocation.width;
   rect.height = stage_wayland->pending_allocation.height;
-  cairo_region_union_rectangle (stage_wayland->repaint_region, &rect);
+  if (stage_wayland->repaint_region == NULL)
+    stage_wayland->repaint_region = cairo_region_create_rectangle (&rect);
+  else
+    cairo_region_union_rectangle (stage_wayland->repaint_region, &rect);
 }
 
 #define CAIRO_REGION_FULL ((cairo_region_t *) 1)
@@ -418,6 +534,17 @@ clutter_stage_wayland_add_redraw_clip (ClutterStageWindow *stage_window,
     stage_wayland->repaint_region = cairo_region_create_rectangle (&rect);
   else
     cairo_region_union_rectangle (stage_wayland->repaint_region, &rect);
+
+  /* every rectangle of the region costs a full traversal of the scene
+   * when repainting, so once there are too many of them we fall back
+   * to their bounding box */
+  if (cairo_region_num_rectangles (stage_wayland->repaint_region) >
+      CLUTTER_STAGE_MAX_REDRAW_CLIPS)
+    {
+      cairo_region_get_extents (stage_wayland->repaint_region, &rect);
+      cairo_region_destroy (stage_wayland->repaint_region);
+      stage_wayland->repaint_region = cairo_region_create_rectangle (&rect);
+    }
 }
 
 static void
@@ -455,46 +582,128 @@ _clutter_stage_wayland_init (ClutterStageWayland *stage_wayland)
   stage_wayland->save_allocation = stage_wayland->allocation;
 }
 
+/* The time of the frame callbacks is expressed in milliseconds, using
+ * the clock of the compositor. The callbacks are delivered some time
+ * after the frame was presented, so the smallest difference between
+ * our clock and the time of a callback is the closest estimate of the
+ * difference between the two clocks; we start over if the time of the
+ * compositor jumps, e.g. because it wrapped around.
+ */
+static gint64
+wayland_frame_time_to_monotonic (ClutterStageWayland *stage_wayland,
+                                 uint32_t             time)
+{
+  gint64 frame_time = (gint64) time * 1000;
+  gint64 offset = _clutter_util_get_monotonic_time () - frame_time;
+
+  if (!stage_wayland->frame_time_offset_valid ||
+      offset < stage_wayland->frame_time_offset ||
+      offset - stage_wayland->frame_time_offset > G_USEC_PER_SEC)
+    {
+      stage_wayland->frame_time_offset = offset;
+      stage_wayland->frame_time_offset_valid = TRUE;
+    }
+
+  return frame_time + stage_wayland->frame_time_offset;
+}
+
 static void
 wayland_frame_callback (void *data, uint32_t _time)
 {
   ClutterStageWayland *stage_wayland = data;
 
   stage_wayland->pending_swaps--;
+
+  _clutter_stage_presented (stage_wayland->wrapper,
+                            wayland_frame_time_to_monotonic (stage_wayland,
+                                                             _time));
 }
 
+/* copies the contents of the texture of a shm buffer to the memory
+ * shared with the compositor; only @changed is copied once the memory
+ * was filled the first time */
 static void
-wayland_damage_buffer(ClutterStageWaylandWaylandBuffer *generic_buffer)
+wayland_damage_buffer(ClutterStageWaylandWaylandBuffer *generic_buffer,
+                      cairo_region_t                   *changed)
 {
   ClutterStageWaylandWaylandBufferSHM *buffer;
-  int size;
+  cairo_rectangle_int_t rect;
+  guint8 *pixels;
+  int size, i, j, count;
 
   if (generic_buffer->type != BUFFER_TYPE_SHM)
     return;
 
   buffer = (ClutterStageWaylandWaylandBufferSHM *)generic_buffer;
 
-  size = cogl_texture_get_data(buffer->buffer.tex, buffer->format,
-                               buffer->stride, NULL);
-  g_assert(size == (int)buffer->size);
+  if (!buffer->data_valid || changed == NULL)
+    {
+      size = cogl_texture_get_data(buffer->buffer.tex, buffer->format,
+                                   buffer->stride, NULL);
+      g_assert(size == (int)buffer->size);
 
-  (void) cogl_texture_get_data(buffer->buffer.tex, buffer->format,
-                               buffer->stride, buffer->data);
+      (void) cogl_texture_get_data(buffer->buffer.tex, buffer->format,
+                                   buffer->stride, buffer->data);
 
+      buffer->data_valid = TRUE;
+      return;
+    }
+
+  /* the buffer is the current framebuffer, so we can read the changed
+   * rectangles back from it without fetching the whole texture */
+  count = cairo_region_num_rectangles (changed);
+  for (i = 0; i < count; i++)
+    {
+      cairo_region_get_rectangle (changed, i, &rect);
+      if (rect.width <= 0 || rect.height <= 0)
+        continue;
+
+      pixels = g_malloc (rect.width * rect.height * 4);
+
+      cogl_read_pixels (rect.x, rect.y, rect.width, rect.height,
+                        COGL_READ_PIXELS_COLOR_BUFFER,
+                        buffer->format,
+                        pixels);
+
+      for (j = 0; j < rect.height; j++)
+        memcpy (buffer->data + (rect.y + j) * buffer->stride + rect.x * 4,
+                pixels + j * rect.width * 4,
+                rect.width * 4);
+
+      g_free (pixels);
+    }
 }
 
 static void
-wayland_swap_buffers (ClutterStageWayland *stage_wayland)
+wayland_swap_buffers (ClutterStageWayland *stage_wayland,
+                      cairo_region_t      *changed,
+                      cairo_region_t      *damage)
 {
   ClutterBackend *backend = clutter_get_default_backend ();
   ClutterBackendWayland *backend_wayland = CLUTTER_BACKEND_WAYLAND (backend);
   ClutterStageWaylandWaylandBuffer *buffer;
+  cairo_rectangle_int_t rect;
+  int i, count;
 
   buffer = stage_wayland->front_buffer;
   stage_wayland->front_buffer = stage_wayland->back_buffer;
   stage_wayland->back_buffer = buffer;
 
-  wayland_damage_buffer(stage_wayland->front_buffer);
+  wayland_damage_buffer(stage_wayland->front_buffer, changed);
+
+  /* only report the areas that were repainted in this frame, instead
+   * of letting the compositor update the whole surface */
+  if (damage != NULL)
+    {
+      count = cairo_region_num_rectangles (damage);
+      for (i = 0; i < count; i++)
+        {
+          cairo_region_get_rectangle (damage, i, &rect);
+          wl_buffer_damage (stage_wayland->front_buffer->wayland_buffer,
+                            rect.x, rect.y,
+                            rect.width, rect.height);
+        }
+    }
 
   wl_surface_attach (stage_wayland->wayland_surface,
                      stage_wayland->front_buffer->wayland_buffer,
@@ -502,13 +711,18 @@ wayland_swap_buffers (ClutterStageWayland *stage_wayland)
                      0, 0);
   wl_surface_map_toplevel (stage_wayland->wayland_surface);
 
+  /* the frame callback throttles the redraws: the master clock does
+   * not redraw the stage while a swap is pending, so we only ask for
+   * a callback when a frame was actually drawn */
   stage_wayland->pending_swaps++;
   wl_display_frame_callback (backend_wayland->wayland_display,
 			     wayland_frame_callback,
 			     stage_wayland);
 }
 
-static void
+/* copies the areas that changed in the front buffer since the back
+ * buffer was last drawn; returns them, or %NULL */
+static cairo_region_t *
 _clutter_stage_wayland_repair_dirty(ClutterStageWayland *stage_wayland,
 				       ClutterStage     *stage)
 {
@@ -523,9 +737,10 @@ _clutter_stage_wayland_repair_dirty(ClutterStageWayland *stage_wayland,
 
   dirty = stage_wayland->back_buffer->dirty_region;
   stage_wayland->back_buffer->dirty_region = NULL;
+  if (dirty == NULL)
+    return NULL;
+
   cairo_region_subtract (dirty, stage_wayland->repaint_region);
-  width = stage_wayland->allocation.width;
-  height = stage_wayland->allocation.height;
   
   /* If this is the first time we render, there is no front buffer to
    * copy back from, but then the dirty region not covered by the
@@ -540,7 +755,11 @@ _clutter_stage_wayland_repair_dirty(ClutterStageWayland *stage_wayland,
    */
 
   if (!stage_wayland->front_buffer)
-    return;
+    return dirty;
+
+  /* the contents are in the top left corner of the texture */
+  width = stage_wayland->front_buffer->capacity_width;
+  height = stage_wayland->front_buffer->capacity_height;
 
   outline = cogl_material_new ();
   cogl_material_set_layer (outline, 0, stage_wayland->front_buffer->tex);
@@ -599,7 +818,7 @@ _clutter_stage_wayland_repair_dirty(ClutterStageWayland *stage_wayland,
       cogl_object_unref (vbo);
     }
 
-  cairo_region_destroy (dirty);
+  return dirty;
 }
 
 void
@@ -634,23 +853,37 @@ void
 _clutter_stage_wayland_redraw (ClutterStageWayland *stage_wayland,
 			       ClutterStage    *stage)
 {
+  cairo_region_t *changed;
+
   stage_wayland->allocation = stage_wayland->pending_allocation;
 
-  if (!stage_wayland->back_buffer)
-      stage_wayland->back_buffer =
-	wayland_create_buffer (&stage_wayland->allocation);
+  wayland_ensure_buffer (&stage_wayland->back_buffer,
+                         &stage_wayland->allocation);
+  wayland_ensure_buffer (&stage_wayland->pick_buffer,
+                         &stage_wayland->allocation);
 
   cogl_set_framebuffer (stage_wayland->back_buffer->offscreen);
   _clutter_stage_maybe_setup_viewport (stage_wayland->wrapper);
 
-  _clutter_stage_wayland_repair_dirty (stage_wayland, stage);
+  changed = _clutter_stage_wayland_repair_dirty (stage_wayland, stage);
 
   _clutter_stage_wayland_repaint_region (stage_wayland, stage);
 
   cogl_flush ();
   glFlush ();
 
-  wayland_swap_buffers (stage_wayland);
+  /* the contents of the buffer changed both where it was repaired and
+   * where it was repainted, but the compositor already shows the
+   * repaired areas */
+  if (changed != NULL)
+    cairo_region_union (changed, stage_wayland->repaint_region);
+
+  wayland_swap_buffers (stage_wayland,
+                        changed,
+                        stage_wayland->repaint_region);
+
+  if (changed != NULL)
+    cairo_region_destroy (changed);
 
   if (stage_wayland->back_buffer)
     stage_wayland->back_buffer->dirty_region = stage_wayland->repaint_region;
@@ -61,6 +61,11 @@ typedef struct _ClutterStageWaylandWaylandBuffer
   cairo_region_t *dirty_region;
   CoglHandle tex;
   guint type;
+
+  /* the size of wayland_buffer, and the size of tex, which can be
+   * larger; the contents are in the top left corner of tex */
+  gint width, height;
+  gint capacity_width, capacity_height;
 } ClutterStageWaylandWaylandBuffer;
 
 typedef struct _ClutterStageWaylandWaylandBufferDRM
@@ -68,15 +73,21 @@ typedef struct _ClutterStageWaylandWaylandBufferDRM
   ClutterStageWaylandWaylandBuffer buffer;
   EGLImageKHR drm_image;
   GLuint texture;
+  EGLint name;
+  EGLint stride;
 } ClutterStageWaylandWaylandBufferDRM;
 
 typedef struct _ClutterStageWaylandWaylandBufferSHM
 {
   ClutterStageWaylandWaylandBuffer buffer;
   CoglPixelFormat format;
+  int fd;
   guint8 *data;
   size_t size;
   unsigned int stride;
+
+  /* whether data was ever read back from tex */
+  gboolean data_valid;
 } ClutterStageWaylandWaylandBufferSHM;
 
 struct _ClutterStageWayland
@@ -95,6 +106,11 @@ struct _ClutterStageWayland
   struct wl_surface *wayland_surface;
   int pending_swaps;
 
+  /* the difference between our clock and the one of the compositor,
+   * used to convert the time of the frame callbacks */
+  gint64 frame_time_offset;
+  gboolean frame_time_offset_valid;
+
   ClutterStageWaylandWaylandBuffer *front_buffer;
   ClutterStageWaylandWaylandBuffer *back_buffer;
   ClutterStageWaylandWaylandBuffer *pick_buffer;
@@ -226,24 +226,97 @@ _clutter_backend_x11_events_uninit (ClutterBackend *backend)
     }
 }
 
+/* the maximum number of X events translated in a single dispatch */
+#define MAX_EVENTS_PER_DISPATCH         256
+
+/* the maximum number of core motion events folded into the next one */
+#define MAX_COMPRESSED_MOTIONS          64
+
+/* checks whether @xevent is a core motion event immediately followed
+ * by another motion event on the same stage window, and that event
+ * will be compressed by the stage anyway
+ */
+static gboolean
+is_redundant_motion (ClutterBackendX11 *backend_x11,
+                     XEvent            *xevent)
+{
+  ClutterStage *stage;
+  XEvent next;
+
+  if (xevent->type != MotionNotify)
+    return FALSE;
+
+  /* filters have to see every event */
+  if (backend_x11->event_filters != NULL)
+    return FALSE;
+
+  if (XEventsQueued (backend_x11->xdpy, QueuedAlready) == 0)
+    return FALSE;
+
+  XPeekEvent (backend_x11->xdpy, &next);
+
+  if (next.type != MotionNotify ||
+      next.xmotion.window != xevent->xmotion.window ||
+      next.xmotion.state != xevent->xmotion.state)
+    return FALSE;
+
+  stage = clutter_x11_get_stage_from_window (xevent->xmotion.window);
+
+  return stage != NULL && clutter_stage_get_throttle_motion_events (stage);
+}
+
 static void
 events_queue (ClutterBackend *backend)
 {
   ClutterBackendX11 *backend_x11 = CLUTTER_BACKEND_X11 (backend);
   Display *xdisplay = backend_x11->xdpy;
+  ClutterEvent motions[MAX_COMPRESSED_MOTIONS];
+  guint n_motions = 0, n_events = 0;
   ClutterEvent *event;
   XEvent xevent;
 
-  while (!clutter_events_pending () && XPending (xdisplay))
+  /* translate all the pending events at once, instead of one event
+   * per dispatch; the translated events are queued on their stage
+   * and handled together before the next frame anyway
+   */
+  while (n_events < MAX_EVENTS_PER_DISPATCH && XPending (xdisplay))
     {
       XNextEvent (xdisplay, &xevent);
+      n_events += 1;
+
+      /* compress the core motion events before translating them,
+       * keeping their position for the motion history of the
+       * event that is going to be delivered
+       */
+      if (n_motions < MAX_COMPRESSED_MOTIONS &&
+          is_redundant_motion (backend_x11, &xevent))
+        {
+          ClutterEvent *motion = &motions[n_motions++];
+
+          motion->type = CLUTTER_MOTION;
+          motion->motion.time = xevent.xmotion.time;
+          motion->motion.x = xevent.xmotion.x;
+          motion->motion.y = xevent.xmotion.y;
+
+          continue;
+        }
 
       event = clutter_event_new (CLUTTER_NOTHING);
 
       if (_clutter_backend_translate_event (backend, &xevent, event))
-        _clutter_event_push (event, FALSE);
+        {
+          if (event->type == CLUTTER_MOTION)
+            {
+              while (n_motions > 0)
+                _clutter_event_fold_motion (event, &motions[--n_motions]);
+            }
+
+          _clutter_event_push (event, FALSE);
+        }
       else
         clutter_event_free (event);
+
+      n_motions = 0;
     }
 }
 
@@ -379,11 +452,9 @@ clutter_event_dispatch (GSource     *source,
   */
   events_queue (backend);
 
-  /* Pop an event off the queue if any */
-  event = clutter_event_get ();
-  if (event != NULL)
+  /* forward all the translated events into clutter for emission etc. */
+  while ((event = clutter_event_get ()) != NULL)
     {
-      /* forward the event into clutter for emission etc. */
       clutter_do_event (event);
       clutter_event_free (event);
     }
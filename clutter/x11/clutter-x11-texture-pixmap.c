@@ -57,6 +57,10 @@
 
 #include <X11/extensions/Xdamage.h>
 
+#ifdef HAVE_XFIXES
+#include <X11/extensions/Xfixes.h>
+#endif
+
 #if HAVE_XCOMPOSITE
 #include <X11/extensions/Xcomposite.h>
 #endif
@@ -118,6 +122,12 @@ struct _ClutterX11TexturePixmapPrivate
 
   Damage        damage;
 
+#ifndef HAVE_XFIXES
+  /* bounding box of the damage received since the last frame */
+  gint          damage_x1, damage_y1;
+  gint          damage_x2, damage_y2;
+#endif
+
   gint          window_x, window_y;
   gint          window_width, window_height;
 
@@ -129,6 +139,7 @@ struct _ClutterX11TexturePixmapPrivate
   guint owns_pixmap               : 1;
   guint override_redirect         : 1;
   guint automatic_updates         : 1;
+  guint damage_pending            : 1;
 };
 
 static int _damage_event_base = 0;
@@ -157,18 +168,143 @@ check_extensions (ClutterX11TexturePixmap *texture)
   return TRUE;
 }
 
+#ifdef HAVE_XFIXES
+/* Beyond this number of rectangles updating the bounding box of the
+ * damaged region is cheaper than updating each rectangle on its own
+ */
+#define MAX_DAMAGE_RECTANGLES   16
+#endif
+
+/* Called once per frame, before the stages are updated, for each
+ * texture that received a DamageNotify event since the last frame
+ */
+static void
+flush_damage_region (gpointer data)
+{
+  ClutterX11TexturePixmap *texture = data;
+  ClutterX11TexturePixmapPrivate *priv = texture->priv;
+#ifdef HAVE_XFIXES
+  CoglHandle cogl_texture;
+  XRectangle *rects, bounds;
+  XserverRegion parts;
+  Display *dpy;
+  int i, n_rects = 0;
+#endif
+
+  priv->damage_pending = FALSE;
+
+  if (priv->damage == None)
+    return;
+
+#ifdef HAVE_XFIXES
+  dpy = clutter_x11_get_default_display ();
+
+  /* Fetch the region accumulated by the server and reset it with a
+   * single request, so that the next damage to the pixmap sends a new
+   * DamageNotify */
+  clutter_x11_trap_x_errors ();
+
+  parts = XFixesCreateRegion (dpy, NULL, 0);
+  XDamageSubtract (dpy, priv->damage, None, parts);
+  rects = XFixesFetchRegionAndBounds (dpy, parts, &n_rects, &bounds);
+  XFixesDestroyRegion (dpy, parts);
+
+  clutter_x11_untrap_x_errors ();
+
+  if (rects == NULL)
+    return;
+
+  if (n_rects == 0)
+    {
+      XFree (rects);
+      return;
+    }
+
+  cogl_texture = clutter_texture_get_cogl_texture (CLUTTER_TEXTURE (texture));
+
+  /* With texture-from-pixmap the whole pixmap is bound again
+     whatever the size of the update, so there is no point in
+     updating each rectangle on its own */
+  if (n_rects > MAX_DAMAGE_RECTANGLES ||
+      (cogl_texture != COGL_INVALID_HANDLE &&
+       cogl_is_texture_pixmap_x11 (cogl_texture) &&
+       cogl_texture_pixmap_x11_is_using_tfp (cogl_texture)))
+    {
+      g_signal_emit (texture, signals[UPDATE_AREA], 0,
+                     bounds.x, bounds.y,
+                     bounds.width, bounds.height);
+    }
+  else
+    {
+      for (i = 0; i < n_rects; i++)
+        g_signal_emit (texture, signals[UPDATE_AREA], 0,
+                       rects[i].x, rects[i].y,
+                       rects[i].width, rects[i].height);
+    }
+
+  XFree (rects);
+
+  /* The clips of the redraws queued on an actor during a frame are
+     merged into their bounding box anyway, so a single redraw is
+     queued for the whole damaged region */
+  g_signal_emit (texture, signals[QUEUE_DAMAGE_REDRAW], 0,
+                 bounds.x, bounds.y,
+                 bounds.width, bounds.height);
+#else
+  /* Cogl deals with updating the texture and subtracting from the
+     damage region, so we only need to queue a redraw for the damage
+     received since the last frame */
+  g_signal_emit (texture, signals[QUEUE_DAMAGE_REDRAW], 0,
+                 priv->damage_x1,
+                 priv->damage_y1,
+                 priv->damage_x2 - priv->damage_x1,
+                 priv->damage_y2 - priv->damage_y1);
+#endif /* HAVE_XFIXES */
+}
+
 static void
 process_damage_event (ClutterX11TexturePixmap *texture,
                       XDamageNotifyEvent *damage_event)
 {
-  /* Cogl will deal with updating the texture and subtracting from the
-     damage region so we only need to queue a redraw */
-  g_signal_emit (texture, signals[QUEUE_DAMAGE_REDRAW],
-                 0,
-                 damage_event->area.x,
-                 damage_event->area.y,
-                 damage_event->area.width,
-                 damage_event->area.height);
+  ClutterX11TexturePixmapPrivate *priv = texture->priv;
+
+#ifndef HAVE_XFIXES
+  {
+    gint x1 = damage_event->area.x;
+    gint y1 = damage_event->area.y;
+    gint x2 = x1 + damage_event->area.width;
+    gint y2 = y1 + damage_event->area.height;
+
+    if (priv->damage_pending)
+      {
+        priv->damage_x1 = MIN (priv->damage_x1, x1);
+        priv->damage_y1 = MIN (priv->damage_y1, y1);
+        priv->damage_x2 = MAX (priv->damage_x2, x2);
+        priv->damage_y2 = MAX (priv->damage_y2, y2);
+      }
+    else
+      {
+        priv->damage_x1 = x1;
+        priv->damage_y1 = y1;
+        priv->damage_x2 = x2;
+        priv->damage_y2 = y2;
+      }
+  }
+#endif
+
+  /* The damage is accumulated until the next frame, so that all the
+     damage received in between is handled at once; with XFixes the
+     damage object only reports the transitions of the damaged region
+     from empty to non-empty, and the server accumulates the region
+     for us */
+  if (priv->damage_pending)
+    return;
+
+  priv->damage_pending = TRUE;
+
+  clutter_threads_post_update (flush_damage_region,
+                               g_object_ref (texture),
+                               g_object_unref);
 }
 
 static ClutterX11FilterReturn
@@ -256,6 +392,11 @@ update_pixmap_damage_object (ClutterX11TexturePixmap *texture)
 
   if (cogl_texture && cogl_is_texture_pixmap_x11 (cogl_texture))
     {
+#ifdef HAVE_XFIXES
+      /* The damage region is collected once per frame, and only the
+         damaged rectangles are updated, in flush_damage_region() */
+      cogl_texture_pixmap_x11_set_damage_object (cogl_texture, 0, 0);
+#else
       if (priv->damage)
         {
           const CoglTexturePixmapX11ReportLevel report_level =
@@ -266,6 +407,7 @@ update_pixmap_damage_object (ClutterX11TexturePixmap *texture)
         }
       else
         cogl_texture_pixmap_x11_set_damage_object (cogl_texture, 0, 0);
+#endif
     }
 }
 
@@ -283,9 +425,15 @@ create_damage_resources (ClutterX11TexturePixmap *texture)
 
   clutter_x11_trap_x_errors ();
 
+#ifdef HAVE_XFIXES
+  priv->damage = XDamageCreate (dpy,
+                                priv->pixmap,
+                                XDamageReportNonEmpty);
+#else
   priv->damage = XDamageCreate (dpy,
                                 priv->pixmap,
                                 XDamageReportBoundingBox);
+#endif
 
   /* Errors here might occur if the window is already destroyed, we
    * simply skip processing damage and assume that the texture pixmap
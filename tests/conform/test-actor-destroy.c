@@ -180,3 +180,72 @@ actor_destruction (void)
   clutter_actor_destroy (test);
   g_assert (destroy_called);
 }
+
+#define N_CHILDREN      10
+
+static void
+on_deferred_child_destroy (ClutterActor *actor,
+                           gpointer      data)
+{
+  guint *n_destroyed = data;
+
+  *n_destroyed += 1;
+}
+
+static void
+on_deferred_root_destroy (ClutterActor *actor,
+                          gpointer      data)
+{
+  guint *n_destroyed = data;
+
+  /* the root is destroyed after all its descendants */
+  g_assert_cmpint (*n_destroyed, ==, N_CHILDREN + N_CHILDREN * N_CHILDREN);
+
+  clutter_main_quit ();
+}
+
+void
+actor_destruction_deferred (void)
+{
+  ClutterActor *stage = clutter_stage_get_default ();
+  ClutterActor *root = clutter_group_new ();
+  guint n_destroyed = 0;
+  gint i, j;
+
+  for (i = 0; i < N_CHILDREN; i++)
+    {
+      ClutterActor *group = clutter_group_new ();
+
+      for (j = 0; j < N_CHILDREN; j++)
+        {
+          ClutterActor *rect = clutter_rectangle_new ();
+
+          g_signal_connect (rect, "destroy",
+                            G_CALLBACK (on_deferred_child_destroy),
+                            &n_destroyed);
+          clutter_container_add_actor (CLUTTER_CONTAINER (group), rect);
+        }
+
+      g_signal_connect (group, "destroy",
+                        G_CALLBACK (on_deferred_child_destroy),
+                        &n_destroyed);
+      clutter_container_add_actor (CLUTTER_CONTAINER (root), group);
+    }
+
+  clutter_container_add_actor (CLUTTER_CONTAINER (stage), root);
+  g_signal_connect (root, "destroy",
+                    G_CALLBACK (on_deferred_root_destroy),
+                    &n_destroyed);
+
+  clutter_actor_destroy_deferred (root);
+
+  /* the root leaves the stage immediately... */
+  g_assert (clutter_actor_get_parent (root) == NULL);
+  g_assert_cmpint (n_destroyed, ==, 0);
+
+  /* ...and the tree is destroyed when idle */
+  clutter_main ();
+
+  if (g_test_verbose ())
+    g_print ("Destroyed %u descendants\n", n_destroyed);
+}
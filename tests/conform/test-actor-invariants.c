@@ -1,5 +1,6 @@
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 
 #include <clutter/clutter.h>
 
@@ -331,3 +332,157 @@ test_contains (TestConformSimpleFixture *fixture,
                        ==,
                        expected_results[x * 10 + y]);
 }
+
+void
+test_transform_cache (TestConformSimpleFixture *fixture,
+                      gconstpointer             data)
+{
+  ClutterActor *stage, *group, *rect;
+  ClutterVertex verts[4];
+
+  stage = clutter_stage_get_default ();
+
+  group = clutter_group_new ();
+  clutter_container_add_actor (CLUTTER_CONTAINER (stage), group);
+  clutter_actor_set_position (group, 10, 20);
+
+  rect = clutter_rectangle_new ();
+  clutter_container_add_actor (CLUTTER_CONTAINER (group), rect);
+  clutter_actor_set_position (rect, 5, 5);
+  clutter_actor_set_size (rect, 50, 50);
+
+  clutter_actor_get_allocation_vertices (rect, NULL, verts);
+  g_assert_cmpfloat (verts[0].x, ==, 15);
+  g_assert_cmpfloat (verts[0].y, ==, 25);
+
+  /* changing the transformation of the parent must be reflected
+   * by the children */
+  clutter_actor_set_position (group, 100, 200);
+  clutter_actor_get_allocation_vertices (rect, NULL, verts);
+  g_assert_cmpfloat (verts[0].x, ==, 105);
+  g_assert_cmpfloat (verts[0].y, ==, 205);
+
+  clutter_actor_set_scale (group, 2.0, 2.0);
+  clutter_actor_get_allocation_vertices (rect, NULL, verts);
+  g_assert_cmpfloat (verts[3].x, ==, 210);
+  g_assert_cmpfloat (verts[3].y, ==, 310);
+
+  /* and so must reparenting */
+  clutter_actor_reparent (rect, stage);
+  clutter_actor_get_allocation_vertices (rect, NULL, verts);
+  g_assert_cmpfloat (verts[0].x, ==, 5);
+  g_assert_cmpfloat (verts[0].y, ==, 5);
+
+  clutter_actor_destroy (rect);
+  clutter_actor_destroy (group);
+}
+
+static void
+assert_stage_point (ClutterActor *actor,
+                    gfloat        x,
+                    gfloat        y,
+                    gfloat        expected_x,
+                    gfloat        expected_y)
+{
+  gfloat actor_x, actor_y;
+
+  g_assert (clutter_actor_transform_stage_point (actor, x, y,
+                                                 &actor_x,
+                                                 &actor_y));
+
+  g_assert_cmpfloat (fabsf (actor_x - expected_x), <, 0.5);
+  g_assert_cmpfloat (fabsf (actor_y - expected_y), <, 0.5);
+}
+
+void
+test_transform_stage_point (TestConformSimpleFixture *fixture,
+                            gconstpointer             data)
+{
+  ClutterActor *stage, *group, *rect;
+
+  stage = clutter_stage_get_default ();
+
+  group = clutter_group_new ();
+  clutter_container_add_actor (CLUTTER_CONTAINER (stage), group);
+
+  rect = clutter_rectangle_new ();
+  clutter_container_add_actor (CLUTTER_CONTAINER (group), rect);
+  clutter_actor_set_position (rect, 10, 20);
+  clutter_actor_set_size (rect, 50, 50);
+
+  assert_stage_point (rect, 30, 40, 20, 20);
+  assert_stage_point (rect, 40, 60, 30, 40);
+
+  /* the cached mapping follows the changes of the ancestors */
+  clutter_actor_set_position (group, 100, 0);
+  assert_stage_point (rect, 130, 40, 20, 20);
+  assert_stage_point (rect, 30, 40, -80, 20);
+
+  clutter_actor_set_scale (group, 2.0, 2.0);
+  assert_stage_point (rect, 160, 80, 20, 20);
+
+  /* and the ones of the allocation */
+  clutter_actor_set_size (rect, 100, 100);
+  assert_stage_point (rect, 160, 80, 20, 20);
+
+  clutter_actor_set_position (rect, 0, 0);
+  assert_stage_point (rect, 160, 80, 30, 40);
+
+  clutter_actor_destroy (rect);
+  clutter_actor_destroy (group);
+}
+
+static void
+on_queue_relayout (ClutterActor *actor,
+                   gint         *n_relayouts)
+{
+  *n_relayouts += 1;
+}
+
+void
+test_translation (TestConformSimpleFixture *fixture,
+                  gconstpointer             data)
+{
+  ClutterActor *stage, *rect;
+  ClutterVertex verts[4];
+  ClutterActorBox box;
+  gint n_relayouts = 0;
+  gfloat tx, ty;
+
+  stage = clutter_stage_get_default ();
+
+  rect = clutter_rectangle_new ();
+  clutter_container_add_actor (CLUTTER_CONTAINER (stage), rect);
+  clutter_actor_set_position (rect, 10, 20);
+  clutter_actor_set_size (rect, 50, 50);
+
+  /* make sure the allocation is valid before counting relayouts */
+  clutter_actor_get_allocation_box (rect, &box);
+
+  g_signal_connect (rect, "queue-relayout",
+                    G_CALLBACK (on_queue_relayout),
+                    &n_relayouts);
+
+  clutter_actor_set_translation (rect, 30, 40);
+  clutter_actor_get_translation (rect, &tx, &ty);
+  g_assert_cmpfloat (tx, ==, 30);
+  g_assert_cmpfloat (ty, ==, 40);
+
+  /* the translation is applied on top of the allocation */
+  clutter_actor_get_allocation_vertices (rect, NULL, verts);
+  g_assert_cmpfloat (verts[0].x, ==, 40);
+  g_assert_cmpfloat (verts[0].y, ==, 60);
+
+  /* without changing the allocation or queueing a relayout */
+  g_assert_cmpfloat (clutter_actor_get_x (rect), ==, 10);
+  g_assert_cmpfloat (clutter_actor_get_y (rect), ==, 20);
+  g_assert_cmpint (n_relayouts, ==, 0);
+
+  g_object_set (rect, "translation-x", 0.0f, NULL);
+  clutter_actor_get_allocation_vertices (rect, NULL, verts);
+  g_assert_cmpfloat (verts[0].x, ==, 10);
+  g_assert_cmpfloat (verts[0].y, ==, 60);
+  g_assert_cmpint (n_relayouts, ==, 0);
+
+  clutter_actor_destroy (rect);
+}
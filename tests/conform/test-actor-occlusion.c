@@ -0,0 +1,229 @@
+#include <clutter/clutter.h>
+
+#include "test-conform-common.h"
+
+static const ClutterColor red   = { 0xff, 0x00, 0x00, 0xff };
+static const ClutterColor green = { 0x00, 0xff, 0x00, 0xff };
+
+typedef struct
+{
+  ClutterActor *stage;
+  ClutterActor *group;
+  ClutterActor *back;
+  ClutterActor *front;
+  int back_paint_count;
+} Data;
+
+static void
+on_back_paint (ClutterActor *actor,
+               Data         *data)
+{
+  data->back_paint_count++;
+}
+
+static void
+verify_redraw (Data *data, int expected_paint_count)
+{
+  GMainLoop *main_loop = g_main_loop_new (NULL, TRUE);
+  guint paint_handler;
+
+  paint_handler = g_signal_connect_data (data->stage,
+                                         "paint",
+                                         G_CALLBACK (g_main_loop_quit),
+                                         main_loop,
+                                         NULL,
+                                         G_CONNECT_SWAPPED | G_CONNECT_AFTER);
+
+  /* Queue a redraw on the whole stage */
+  clutter_actor_queue_redraw (data->stage);
+
+  data->back_paint_count = 0;
+
+  g_main_loop_run (main_loop);
+
+  g_signal_handler_disconnect (data->stage, paint_handler);
+  g_main_loop_unref (main_loop);
+
+  g_assert_cmpint (data->back_paint_count, ==, expected_paint_count);
+}
+
+static gboolean
+timeout_cb (gpointer user_data)
+{
+  Data *data = user_data;
+  ClutterColor color;
+
+  /* The back actor is completely covered by an opaque rectangle */
+  if (g_test_verbose ())
+    g_print ("opaque front actor\n");
+  verify_redraw (data, 0);
+
+  /* A semi-transparent rectangle does not hide anything */
+  if (g_test_verbose ())
+    g_print ("semi-transparent front actor\n");
+  clutter_actor_set_opacity (data->front, 128);
+  verify_redraw (data, 1);
+  clutter_actor_set_opacity (data->front, 255);
+
+  color = green;
+  color.alpha = 128;
+  clutter_rectangle_set_color (CLUTTER_RECTANGLE (data->front), &color);
+  verify_redraw (data, 1);
+  clutter_rectangle_set_color (CLUTTER_RECTANGLE (data->front), &green);
+
+  /* A rotated rectangle is not used as an occluder */
+  if (g_test_verbose ())
+    g_print ("rotated front actor\n");
+  clutter_actor_set_rotation (data->front, CLUTTER_Z_AXIS, 10, 100, 100, 0);
+  verify_redraw (data, 1);
+  clutter_actor_set_rotation (data->front, CLUTTER_Z_AXIS, 0, 0, 0, 0);
+
+  /* The back actor is only partially covered */
+  if (g_test_verbose ())
+    g_print ("partially covered back actor\n");
+  clutter_actor_set_position (data->back, 150, 150);
+  verify_redraw (data, 1);
+  clutter_actor_set_position (data->back, 50, 50);
+
+  /* The whole group is hidden, together with the back actor */
+  if (g_test_verbose ())
+    g_print ("covered group\n");
+  clutter_actor_reparent (data->back, data->group);
+  clutter_actor_lower_bottom (data->group);
+  verify_redraw (data, 0);
+
+  clutter_main_quit ();
+
+  return FALSE;
+}
+
+void
+actor_occlusion (TestConformSimpleFixture *fixture,
+                 gconstpointer             test_data)
+{
+  Data data;
+
+  data.stage = clutter_stage_get_default ();
+
+  data.back = clutter_rectangle_new_with_color (&red);
+  clutter_actor_set_position (data.back, 50, 50);
+  clutter_actor_set_size (data.back, 100, 100);
+  g_signal_connect (data.back, "paint", G_CALLBACK (on_back_paint), &data);
+  clutter_container_add_actor (CLUTTER_CONTAINER (data.stage), data.back);
+
+  data.front = clutter_rectangle_new_with_color (&green);
+  clutter_actor_set_size (data.front, 200, 200);
+  clutter_container_add_actor (CLUTTER_CONTAINER (data.stage), data.front);
+
+  data.group = clutter_group_new ();
+  clutter_container_add_actor (CLUTTER_CONTAINER (data.stage), data.group);
+
+  clutter_actor_show (data.stage);
+
+  /* Start the test after a short delay to allow the stage to
+     render its initial frames without affecting the results */
+  g_timeout_add_full (G_PRIORITY_LOW, 250, timeout_cb, &data, NULL);
+
+  clutter_main ();
+
+  clutter_actor_destroy (data.group);
+  clutter_actor_destroy (data.front);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
+
+static void
+verify_pixel (ClutterActor       *stage,
+              int                 x,
+              int                 y,
+              const ClutterColor *expected)
+{
+  guchar *pixel;
+
+  pixel = clutter_stage_read_pixels (CLUTTER_STAGE (stage), x, y, 1, 1);
+
+  if (g_test_verbose ())
+    g_print ("%d,%d: got [ %d, %d, %d ], expected [ %d, %d, %d ]\n",
+             x, y,
+             pixel[0], pixel[1], pixel[2],
+             expected->red, expected->green, expected->blue);
+
+  g_assert_cmpint (pixel[0], ==, expected->red);
+  g_assert_cmpint (pixel[1], ==, expected->green);
+  g_assert_cmpint (pixel[2], ==, expected->blue);
+
+  g_free (pixel);
+}
+
+static gboolean
+clear_timeout_cb (gpointer user_data)
+{
+  Data *data = user_data;
+  static const ClutterColor blue = { 0x00, 0x00, 0xff, 0xff };
+  gfloat height;
+
+  height = clutter_actor_get_height (data->stage);
+
+  /* The front actor covers the top of the stage, so only the bottom
+     is cleared; hiding the back actor uncovers the stage color */
+  verify_pixel (data->stage, 25, 25, &green);
+  verify_pixel (data->stage, 25, height - 25, &red);
+
+  clutter_actor_hide (data->back);
+
+  verify_pixel (data->stage, 25, 25, &green);
+  verify_pixel (data->stage, 25, height - 25, &blue);
+
+  /* Two actors covering the stage together skip the clear */
+  clutter_actor_set_position (data->back, 0, height / 2);
+  clutter_actor_set_size (data->back, clutter_actor_get_width (data->stage),
+                          height - height / 2);
+  clutter_actor_show (data->back);
+
+  verify_pixel (data->stage, 25, 25, &green);
+  verify_pixel (data->stage, 25, height - 25, &red);
+
+  clutter_main_quit ();
+
+  return FALSE;
+}
+
+void
+actor_occlusion_clear (TestConformSimpleFixture *fixture,
+                       gconstpointer             test_data)
+{
+  static const ClutterColor blue = { 0x00, 0x00, 0xff, 0xff };
+  ClutterColor stage_color;
+  Data data;
+
+  data.stage = clutter_stage_get_default ();
+  clutter_stage_get_color (CLUTTER_STAGE (data.stage), &stage_color);
+  clutter_stage_set_color (CLUTTER_STAGE (data.stage), &blue);
+
+  data.front = clutter_rectangle_new_with_color (&green);
+  clutter_actor_set_size (data.front,
+                          clutter_actor_get_width (data.stage),
+                          clutter_actor_get_height (data.stage) / 2);
+  clutter_container_add_actor (CLUTTER_CONTAINER (data.stage), data.front);
+
+  data.back = clutter_rectangle_new_with_color (&red);
+  clutter_actor_set_position (data.back,
+                              0, clutter_actor_get_height (data.stage) - 50);
+  clutter_actor_set_size (data.back, 50, 50);
+  clutter_container_add_actor (CLUTTER_CONTAINER (data.stage), data.back);
+
+  clutter_actor_show (data.stage);
+
+  g_timeout_add_full (G_PRIORITY_LOW, 250, clear_timeout_cb, &data, NULL);
+
+  clutter_main ();
+
+  clutter_actor_destroy (data.back);
+  clutter_actor_destroy (data.front);
+
+  clutter_stage_set_color (CLUTTER_STAGE (data.stage), &stage_color);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
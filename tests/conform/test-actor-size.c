@@ -16,6 +16,8 @@ struct _TestActor
 
   guint preferred_width_called  : 1;
   guint preferred_height_called : 1;
+
+  guint n_height_requests;
 };
 
 G_DEFINE_TYPE (TestActor, test_actor, CLUTTER_TYPE_ACTOR);
@@ -51,6 +53,7 @@ test_actor_get_preferred_height (ClutterActor *self,
   TestActor *test = (TestActor *) self;
 
   test->preferred_height_called = TRUE;
+  test->n_height_requests += 1;
 
   if (for_width == 10)
     {
@@ -78,6 +81,141 @@ test_actor_init (TestActor *self)
 {
 }
 
+#define TEST_TYPE_LAYOUT        (test_layout_get_type ())
+
+typedef struct _TestLayout              TestLayout;
+typedef struct _ClutterFixedLayoutClass TestLayoutClass;
+
+struct _TestLayout
+{
+  ClutterFixedLayout parent_instance;
+
+  guint allocate_count;
+};
+
+G_DEFINE_TYPE (TestLayout, test_layout, CLUTTER_TYPE_FIXED_LAYOUT);
+
+static void
+test_layout_allocate (ClutterLayoutManager   *manager,
+                      ClutterContainer       *container,
+                      const ClutterActorBox  *allocation,
+                      ClutterAllocationFlags  flags)
+{
+  TestLayout *test = (TestLayout *) manager;
+
+  test->allocate_count += 1;
+
+  CLUTTER_LAYOUT_MANAGER_CLASS (test_layout_parent_class)->allocate (manager,
+                                                                     container,
+                                                                     allocation,
+                                                                     flags);
+}
+
+static void
+test_layout_class_init (TestLayoutClass *klass)
+{
+  ClutterLayoutManagerClass *manager_class = CLUTTER_LAYOUT_MANAGER_CLASS (klass);
+
+  manager_class->allocate = test_layout_allocate;
+}
+
+static void
+test_layout_init (TestLayout *self)
+{
+}
+
+void
+actor_relayout_boundary (void)
+{
+  ClutterActor *stage, *outer, *inner, *rect;
+  TestLayout *layout;
+  ClutterActorBox box;
+
+  stage = clutter_stage_get_default ();
+
+  layout = g_object_new (TEST_TYPE_LAYOUT, NULL);
+  outer = clutter_box_new (CLUTTER_LAYOUT_MANAGER (layout));
+  clutter_container_add_actor (CLUTTER_CONTAINER (stage), outer);
+
+  /* an actor with a fixed size is a relayout boundary */
+  inner = clutter_box_new (clutter_fixed_layout_new ());
+  clutter_actor_set_size (inner, 100, 100);
+  clutter_container_add_actor (CLUTTER_CONTAINER (outer), inner);
+
+  rect = clutter_rectangle_new ();
+  clutter_actor_set_size (rect, 10, 10);
+  clutter_container_add_actor (CLUTTER_CONTAINER (inner), rect);
+
+  clutter_actor_show (stage);
+
+  clutter_actor_get_allocation_box (rect, &box);
+  g_assert_cmpfloat (clutter_actor_box_get_width (&box), ==, 10);
+
+  if (g_test_verbose ())
+    g_print ("Relayout inside the boundary\n");
+
+  layout->allocate_count = 0;
+  clutter_actor_set_size (rect, 50, 50);
+
+  clutter_actor_get_allocation_box (rect, &box);
+  g_assert_cmpfloat (clutter_actor_box_get_width (&box), ==, 50);
+  g_assert_cmpint (layout->allocate_count, ==, 0);
+
+  if (g_test_verbose ())
+    g_print ("Relayout of the boundary\n");
+
+  clutter_actor_set_size (inner, 200, 200);
+
+  clutter_actor_get_allocation_box (inner, &box);
+  g_assert_cmpfloat (clutter_actor_box_get_width (&box), ==, 200);
+  g_assert_cmpint (layout->allocate_count, ==, 1);
+
+  clutter_actor_destroy (outer);
+}
+
+void
+actor_size_cache (void)
+{
+  ClutterActor *test;
+  TestActor *self;
+  gfloat for_width;
+  gint i;
+
+  test = g_object_new (TEST_TYPE_ACTOR, NULL);
+  self = (TestActor *) test;
+
+  /* a height-for-width layout probes many different widths; once each
+   * width has been measured, no request should reach the class */
+  for (i = 0; i < 2; i++)
+    {
+      for (for_width = 10; for_width <= 80; for_width += 10)
+        {
+          gfloat min_height, nat_height;
+
+          clutter_actor_get_preferred_height (test, for_width,
+                                              &min_height,
+                                              &nat_height);
+
+          g_assert_cmpfloat (min_height, ==, for_width == 10 ? 50 : 100);
+          g_assert_cmpfloat (nat_height, ==, 100);
+        }
+
+      if (g_test_verbose ())
+        g_print ("Round %d: %u height requests\n",
+                 i + 1,
+                 self->n_height_requests);
+
+      g_assert_cmpint (self->n_height_requests, ==, 8);
+    }
+
+  /* a relayout invalidates the whole cache */
+  clutter_actor_queue_relayout (test);
+  clutter_actor_get_preferred_height (test, 10, NULL, NULL);
+  g_assert_cmpint (self->n_height_requests, ==, 9);
+
+  clutter_actor_destroy (test);
+}
+
 void
 actor_preferred_size (void)
 {
@@ -207,3 +345,81 @@ actor_fixed_size (void)
 
   clutter_actor_destroy (rect);
 }
+
+typedef struct
+{
+  guint n_changes;
+  ClutterActorBox old_box;
+  ClutterActorBox new_box;
+} GeometryChanges;
+
+static void
+on_geometry_changed (ClutterActor          *actor,
+                     const ClutterActorBox *old_box,
+                     const ClutterActorBox *new_box,
+                     GeometryChanges       *changes)
+{
+  changes->n_changes += 1;
+  changes->old_box = *old_box;
+  changes->new_box = *new_box;
+}
+
+static void
+on_notify_x (GObject    *gobject,
+             GParamSpec *pspec,
+             guint      *n_notifies)
+{
+  *n_notifies += 1;
+}
+
+void
+actor_geometry_changed (void)
+{
+  GeometryChanges changes = { 0, };
+  ClutterActor *stage, *rect;
+  ClutterActorBox box;
+  guint n_notifies = 0;
+
+  stage = clutter_stage_get_default ();
+
+  rect = clutter_rectangle_new ();
+  clutter_actor_set_size (rect, 10, 10);
+  clutter_container_add_actor (CLUTTER_CONTAINER (stage), rect);
+
+  clutter_actor_get_allocation_box (rect, &box);
+
+  g_signal_connect (rect, "geometry-changed",
+                    G_CALLBACK (on_geometry_changed),
+                    &changes);
+  g_signal_connect (rect, "notify::x",
+                    G_CALLBACK (on_notify_x),
+                    &n_notifies);
+
+  /* the allocations done within a frame are reported as one change */
+  clutter_actor_set_position (rect, 20, 20);
+  clutter_actor_allocate_preferred_size (rect, CLUTTER_ALLOCATION_NONE);
+  clutter_actor_set_position (rect, 30, 40);
+  clutter_actor_get_allocation_box (rect, &box);
+
+  if (g_test_verbose ())
+    g_print ("changes: %u, notifies: %u\n", changes.n_changes, n_notifies);
+
+  g_assert_cmpint (changes.n_changes, ==, 1);
+  g_assert_cmpfloat (changes.old_box.x1, ==, 0);
+  g_assert_cmpfloat (changes.new_box.x1, ==, 30);
+  g_assert_cmpfloat (changes.new_box.y1, ==, 40);
+
+  /* the notifications are still emitted when somebody listens */
+  g_assert_cmpint (n_notifies, >, 0);
+
+  /* moving back and forth within a frame is not a change */
+  changes.n_changes = 0;
+  clutter_actor_set_position (rect, 50, 50);
+  clutter_actor_allocate_preferred_size (rect, CLUTTER_ALLOCATION_NONE);
+  clutter_actor_set_position (rect, 30, 40);
+  clutter_actor_get_allocation_box (rect, &box);
+
+  g_assert_cmpint (changes.n_changes, ==, 0);
+
+  clutter_actor_destroy (rect);
+}
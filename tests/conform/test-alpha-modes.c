@@ -0,0 +1,68 @@
+#include <math.h>
+
+#include <clutter/clutter.h>
+
+#include "test-conform-common.h"
+
+#define DURATION        1000
+#define N_STEPS         40
+
+/* the tabulated modes are interpolated, so we allow a small error */
+#define EPSILON         0.002
+
+void
+alpha_modes (TestConformSimpleFixture *fixture,
+             gconstpointer             test_data)
+{
+  ClutterTimeline *timeline;
+  ClutterAlpha *alpha;
+  gdouble progress[N_STEPS + 1];
+  gdouble values[N_STEPS + 1];
+  gulong mode;
+  guint i;
+
+  timeline = clutter_timeline_new (DURATION);
+  alpha = clutter_alpha_new_full (timeline, CLUTTER_LINEAR);
+  g_object_ref_sink (alpha);
+
+  for (i = 0; i <= N_STEPS; i++)
+    progress[i] = (gdouble) i / N_STEPS;
+
+  for (mode = CLUTTER_LINEAR; mode < CLUTTER_ANIMATION_LAST; mode++)
+    {
+      clutter_alpha_set_mode (alpha, mode);
+      clutter_alpha_compute_mode_values (mode, progress, values, N_STEPS + 1);
+
+      if (g_test_verbose ())
+        g_print ("mode %lu: start %.4f, end %.4f\n",
+                 mode,
+                 values[0],
+                 values[N_STEPS]);
+
+      /* every mode starts at 0 and ends at 1 */
+      g_assert_cmpfloat (fabs (values[0]), <, EPSILON);
+      g_assert_cmpfloat (fabs (values[N_STEPS] - 1.0), <, EPSILON);
+
+      /* the batch API computes the same values as the alpha */
+      for (i = 0; i <= N_STEPS; i++)
+        {
+          clutter_timeline_advance (timeline, progress[i] * DURATION);
+
+          g_assert_cmpfloat (fabs (clutter_alpha_get_alpha (alpha) - values[i]),
+                             <,
+                             EPSILON);
+        }
+    }
+
+  /* the linear mode is not interpolated */
+  clutter_alpha_compute_mode_values (CLUTTER_LINEAR, progress, values,
+                                     N_STEPS + 1);
+  for (i = 0; i <= N_STEPS; i++)
+    g_assert_cmpfloat (values[i], ==, progress[i]);
+
+  g_object_unref (alpha);
+  g_object_unref (timeline);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
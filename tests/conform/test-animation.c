@@ -0,0 +1,159 @@
+#include <clutter/clutter.h>
+
+#include "test-conform-common.h"
+
+static void
+on_completed (ClutterAnimation *animation,
+              gpointer          user_data)
+{
+  clutter_main_quit ();
+}
+
+void
+animation_reuse (TestConformSimpleFixture *fixture,
+                 gconstpointer             test_data)
+{
+  ClutterAnimation *animation, *recycled;
+  ClutterTimeline *timeline;
+  ClutterInterval *interval;
+  ClutterActor *actor;
+
+  actor = clutter_rectangle_new ();
+  g_object_ref_sink (actor);
+
+  animation = clutter_actor_animate (actor, CLUTTER_LINEAR, 50,
+                                     "x", 100.0,
+                                     "y", 100.0,
+                                     "signal::completed", on_completed, NULL,
+                                     NULL);
+  timeline = clutter_animation_get_timeline (animation);
+  interval = clutter_animation_get_interval (animation, "x");
+
+  clutter_main ();
+
+  g_assert_cmpfloat (clutter_actor_get_x (actor), ==, 100.0);
+  g_assert (clutter_actor_get_animation (actor) == NULL);
+
+  /* the completed animation is reused, with its timeline and the
+   * interval of the property animated again
+   */
+  recycled = clutter_actor_animate (actor, CLUTTER_EASE_IN_CUBIC, 50,
+                                    "x", 200.0,
+                                    "signal::completed", on_completed, NULL,
+                                    NULL);
+
+  if (g_test_verbose ())
+    g_print ("animation: %p, recycled: %p\n", animation, recycled);
+
+  g_assert (recycled == animation);
+  g_assert (clutter_animation_get_timeline (recycled) == timeline);
+  g_assert (clutter_animation_get_interval (recycled, "x") == interval);
+  g_assert (!clutter_animation_has_property (recycled, "y"));
+  g_assert_cmpint (clutter_animation_get_mode (recycled), ==,
+                   CLUTTER_EASE_IN_CUBIC);
+
+  clutter_main ();
+
+  g_assert_cmpfloat (clutter_actor_get_x (actor), ==, 200.0);
+  g_assert_cmpfloat (clutter_actor_get_y (actor), ==, 100.0);
+
+  clutter_actor_destroy (actor);
+  g_object_unref (actor);
+}
+
+void
+animation_retarget (TestConformSimpleFixture *fixture,
+                    gconstpointer             test_data)
+{
+  ClutterAnimation *animation;
+  ClutterInterval *interval;
+  ClutterActor *actor;
+  GValue value = { 0, };
+
+  actor = clutter_rectangle_new ();
+  g_object_ref_sink (actor);
+
+  animation = clutter_actor_animate (actor, CLUTTER_LINEAR, 1000,
+                                     "x", 100.0,
+                                     NULL);
+  interval = clutter_animation_get_interval (animation, "x");
+
+  /* animating the same property again updates the interval in place */
+  g_assert (clutter_actor_animate (actor, CLUTTER_LINEAR, 1000,
+                                   "x", 300.0,
+                                   NULL) == animation);
+  g_assert (clutter_animation_get_interval (animation, "x") == interval);
+
+  g_value_init (&value, G_TYPE_FLOAT);
+  clutter_interval_get_final_value (interval, &value);
+  g_assert_cmpfloat (g_value_get_float (&value), ==, 300.0);
+  g_value_unset (&value);
+
+  clutter_actor_detach_animation (actor);
+
+  clutter_actor_destroy (actor);
+  g_object_unref (actor);
+}
+
+static void
+on_notify (GObject    *gobject,
+           GParamSpec *pspec,
+           gpointer    user_data)
+{
+  guint *n_notify = user_data;
+
+  *n_notify += 1;
+}
+
+void
+animation_transform (TestConformSimpleFixture *fixture,
+                     gconstpointer             test_data)
+{
+  ClutterActor *actor;
+  gdouble scale_x, scale_y;
+  gfloat translate_x, translate_y;
+  guint n_notify = 0;
+
+  actor = clutter_rectangle_new ();
+  g_object_ref_sink (actor);
+
+  g_signal_connect (actor, "notify::scale-x",
+                    G_CALLBACK (on_notify),
+                    &n_notify);
+
+  /* the transformation properties of an actor are set directly by
+   * the animation, without going through a GValue
+   */
+  clutter_actor_animate (actor, CLUTTER_LINEAR, 50,
+                         "scale-x", 2.0,
+                         "rotation-angle-z", 90.0,
+                         "translation-x", 10.0,
+                         "opacity", 128,
+                         "signal::completed", on_completed, NULL,
+                         NULL);
+
+  clutter_main ();
+
+  clutter_actor_get_scale (actor, &scale_x, &scale_y);
+  clutter_actor_get_translation (actor, &translate_x, &translate_y);
+
+  if (g_test_verbose ())
+    g_print ("scale: %.2f, %.2f, translation: %.2f, %.2f, notify: %u\n",
+             scale_x, scale_y,
+             translate_x, translate_y,
+             n_notify);
+
+  g_assert_cmpfloat (scale_x, ==, 2.0);
+  g_assert_cmpfloat (scale_y, ==, 1.0);
+  g_assert_cmpfloat (translate_x, ==, 10.0);
+  g_assert_cmpfloat (translate_y, ==, 0.0);
+  g_assert_cmpfloat (clutter_actor_get_rotation (actor, CLUTTER_Z_AXIS,
+                                                 NULL, NULL, NULL),
+                     ==,
+                     90.0);
+  g_assert_cmpint (clutter_actor_get_opacity (actor), ==, 128);
+  g_assert_cmpuint (n_notify, >, 0);
+
+  clutter_actor_destroy (actor);
+  g_object_unref (actor);
+}
@@ -55,12 +55,72 @@ opacity_behaviour (BehaviourFixture *fixture)
   g_object_unref (behaviour);
 }
 
+static void
+remove_on_notify (ClutterActor     *actor,
+                  GParamSpec       *pspec,
+                  ClutterBehaviour *behaviour)
+{
+  ClutterActor *other = g_object_get_data (G_OBJECT (actor), "other");
+
+  if (clutter_behaviour_is_applied (behaviour, other))
+    clutter_behaviour_remove (behaviour, other);
+}
+
+static void
+batch_behaviour (BehaviourFixture *fixture)
+{
+  ClutterBehaviour *behaviour;
+  ClutterActor *rects[3];
+  gint i;
+
+  behaviour = clutter_behaviour_opacity_new (fixture->alpha, 0, 255);
+
+  for (i = 0; i < G_N_ELEMENTS (rects); i++)
+    {
+      rects[i] = clutter_rectangle_new ();
+      g_object_ref_sink (rects[i]);
+      clutter_behaviour_apply (behaviour, rects[i]);
+    }
+
+  /* the notifications are emitted at the end of the batch, so the
+   * handler removing an actor from the behaviour does not prevent it
+   * from being updated in the same batch */
+  g_object_set_data (G_OBJECT (rects[0]), "other", rects[2]);
+  g_signal_connect (rects[0], "notify::opacity",
+                    G_CALLBACK (remove_on_notify),
+                    behaviour);
+
+  clutter_timeline_advance (fixture->timeline, 500);
+  g_object_notify (G_OBJECT (fixture->alpha), "alpha");
+
+  for (i = 0; i < G_N_ELEMENTS (rects); i++)
+    {
+      if (g_test_verbose ())
+        g_print ("rect[%d]:opacity = %d (expected: 127)\n",
+                 i,
+                 clutter_actor_get_opacity (rects[i]));
+
+      g_assert_cmpint (clutter_actor_get_opacity (rects[i]), ==, 127);
+    }
+
+  g_assert_cmpint (clutter_behaviour_get_n_actors (behaviour), ==, 2);
+
+  g_object_unref (behaviour);
+
+  for (i = 0; i < G_N_ELEMENTS (rects); i++)
+    {
+      clutter_actor_destroy (rects[i]);
+      g_object_unref (rects[i]);
+    }
+}
+
 static const struct
 {
   const gchar *desc;
   BehaviourTestFunc func;
 } behaviour_tests[] = {
-  { "BehaviourOpacity", opacity_behaviour }
+  { "BehaviourOpacity", opacity_behaviour },
+  { "BehaviourBatch", batch_behaviour }
 };
 
 static const gint n_behaviour_tests = G_N_ELEMENTS (behaviour_tests);
@@ -0,0 +1,217 @@
+#include <math.h>
+
+#include <clutter/clutter.h>
+
+#include "test-conform-common.h"
+
+#define N_CHILDREN      100
+#define CHILD_HEIGHT    20
+
+static void
+on_allocation_changed (ClutterActor           *actor,
+                       const ClutterActorBox  *box,
+                       ClutterAllocationFlags  flags,
+                       gint                   *n_allocated)
+{
+  *n_allocated += 1;
+}
+
+void
+box_layout_virtualized (TestConformSimpleFixture *fixture,
+                        gconstpointer             data)
+{
+  ClutterActor *stage, *viewport, *box;
+  ClutterLayoutManager *layout;
+  ClutterActorBox allocation;
+  gint n_allocated = 0;
+  gint i;
+
+  stage = clutter_stage_get_default ();
+
+  viewport = clutter_group_new ();
+  clutter_actor_set_size (viewport, 100, 100);
+  clutter_actor_set_clip_to_allocation (viewport, TRUE);
+  clutter_container_add_actor (CLUTTER_CONTAINER (stage), viewport);
+
+  layout = clutter_box_layout_new ();
+  clutter_box_layout_set_vertical (CLUTTER_BOX_LAYOUT (layout), TRUE);
+  clutter_box_layout_set_virtualized (CLUTTER_BOX_LAYOUT (layout), TRUE);
+  g_assert (clutter_box_layout_get_virtualized (CLUTTER_BOX_LAYOUT (layout)));
+
+  box = clutter_box_new (layout);
+  clutter_container_add_actor (CLUTTER_CONTAINER (viewport), box);
+
+  for (i = 0; i < N_CHILDREN; i++)
+    {
+      ClutterActor *rect = clutter_rectangle_new ();
+
+      clutter_actor_set_size (rect, 100, CHILD_HEIGHT);
+      g_signal_connect (rect, "allocation-changed",
+                        G_CALLBACK (on_allocation_changed),
+                        &n_allocated);
+      clutter_container_add_actor (CLUTTER_CONTAINER (box), rect);
+    }
+
+  clutter_actor_show (stage);
+
+  /* only the children inside the viewport get allocated */
+  clutter_actor_get_allocation_box (box, &allocation);
+  g_assert_cmpfloat (clutter_actor_box_get_height (&allocation),
+                     ==,
+                     N_CHILDREN * CHILD_HEIGHT);
+
+  if (g_test_verbose ())
+    g_print ("Initial allocation: %d children allocated\n", n_allocated);
+
+  g_assert_cmpint (n_allocated, ==, 100 / CHILD_HEIGHT);
+
+  /* scrolling allocates the newly visible children only */
+  n_allocated = 0;
+  clutter_actor_set_y (box, -500);
+  clutter_actor_get_allocation_box (box, &allocation);
+
+  if (g_test_verbose ())
+    g_print ("Scrolled allocation: %d children allocated\n", n_allocated);
+
+  g_assert_cmpint (n_allocated, ==, 100 / CHILD_HEIGHT);
+
+  clutter_actor_destroy (viewport);
+}
+
+static ClutterActor *
+create_text_box (gboolean     parallel_measure,
+                 const gchar *contents)
+{
+  ClutterLayoutManager *layout;
+  ClutterActor *box;
+  gint i;
+
+  layout = clutter_box_layout_new ();
+  clutter_box_layout_set_vertical (CLUTTER_BOX_LAYOUT (layout), TRUE);
+  clutter_box_layout_set_parallel_measure (CLUTTER_BOX_LAYOUT (layout),
+                                           parallel_measure);
+
+  box = clutter_box_new (layout);
+
+  for (i = 0; i < 8; i++)
+    {
+      ClutterActor *text = clutter_text_new_with_text ("Sans 12px", contents);
+
+      clutter_text_set_line_wrap (CLUTTER_TEXT (text), TRUE);
+      clutter_container_add_actor (CLUTTER_CONTAINER (box), text);
+    }
+
+  return box;
+}
+
+void
+box_layout_parallel_measure (TestConformSimpleFixture *fixture,
+                             gconstpointer             data)
+{
+  ClutterActor *serial, *parallel;
+  ClutterLayoutManager *layout;
+  gfloat serial_min, serial_nat;
+  gfloat parallel_min, parallel_nat;
+  GString *contents;
+  gint i;
+
+  contents = g_string_new (NULL);
+  for (i = 0; i < 40; i++)
+    g_string_append (contents, "The quick brown fox jumps over the lazy dog. ");
+
+  serial = create_text_box (FALSE, contents->str);
+  parallel = create_text_box (TRUE, contents->str);
+
+  layout = clutter_box_get_layout_manager (CLUTTER_BOX (parallel));
+  g_assert (clutter_box_layout_get_parallel_measure (CLUTTER_BOX_LAYOUT (layout)));
+
+  /* the results do not depend on the way the texts were shaped */
+  clutter_actor_get_preferred_width (serial, -1, &serial_min, &serial_nat);
+  clutter_actor_get_preferred_width (parallel, -1, &parallel_min, &parallel_nat);
+
+  if (g_test_verbose ())
+    g_print ("width: serial %.2f/%.2f, parallel %.2f/%.2f\n",
+             serial_min, serial_nat,
+             parallel_min, parallel_nat);
+
+  g_assert_cmpfloat (serial_min, ==, parallel_min);
+  g_assert_cmpfloat (serial_nat, ==, parallel_nat);
+
+  clutter_actor_get_preferred_height (serial, 200, &serial_min, &serial_nat);
+  clutter_actor_get_preferred_height (parallel, 200, &parallel_min, &parallel_nat);
+
+  if (g_test_verbose ())
+    g_print ("height: serial %.2f/%.2f, parallel %.2f/%.2f\n",
+             serial_min, serial_nat,
+             parallel_min, parallel_nat);
+
+  g_assert_cmpfloat (serial_min, ==, parallel_min);
+  g_assert_cmpfloat (serial_nat, ==, parallel_nat);
+
+  clutter_actor_destroy (serial);
+  clutter_actor_destroy (parallel);
+
+  g_string_free (contents, TRUE);
+}
+
+void
+box_layout_animated_offset (TestConformSimpleFixture *fixture,
+                            gconstpointer             data)
+{
+  ClutterActor *stage, *box, *first, *second;
+  ClutterLayoutManager *layout;
+  ClutterActorBox allocation;
+  gint n_allocated = 0;
+  gfloat x, y;
+
+  stage = clutter_stage_get_default ();
+
+  layout = clutter_box_layout_new ();
+  clutter_box_layout_set_use_animations (CLUTTER_BOX_LAYOUT (layout), TRUE);
+
+  box = clutter_box_new (layout);
+  clutter_container_add_actor (CLUTTER_CONTAINER (stage), box);
+
+  first = clutter_rectangle_new ();
+  clutter_actor_set_size (first, 50, 50);
+  clutter_container_add_actor (CLUTTER_CONTAINER (box), first);
+
+  second = clutter_rectangle_new ();
+  clutter_actor_set_size (second, 50, 50);
+  g_signal_connect (second, "allocation-changed",
+                    G_CALLBACK (on_allocation_changed),
+                    &n_allocated);
+  clutter_container_add_actor (CLUTTER_CONTAINER (box), second);
+
+  clutter_actor_show (stage);
+
+  clutter_actor_get_allocation_box (second, &allocation);
+  g_assert_cmpfloat (allocation.x1, ==, 50);
+
+  /* the child is allocated in its final position when the animation
+   * begins, but it is still painted in its initial one
+   */
+  n_allocated = 0;
+  clutter_box_layout_set_spacing (CLUTTER_BOX_LAYOUT (layout), 10);
+  clutter_actor_get_allocation_box (second, &allocation);
+  g_assert_cmpfloat (allocation.x1, ==, 60);
+  g_assert_cmpint (n_allocated, ==, 1);
+
+  clutter_actor_get_transformed_position (second, &x, &y);
+
+  if (g_test_verbose ())
+    g_print ("Animating: allocated at %.1f, painted at %.1f\n",
+             allocation.x1, x);
+
+  g_assert_cmpfloat (fabsf (x - 50), <, 0.5);
+
+  /* the offset is cleared when the animation ends */
+  clutter_layout_manager_end_animation (layout);
+  clutter_actor_get_allocation_box (second, &allocation);
+  g_assert_cmpfloat (allocation.x1, ==, 60);
+
+  clutter_actor_get_transformed_position (second, &x, &y);
+  g_assert_cmpfloat (fabsf (x - 60), <, 0.5);
+
+  clutter_actor_destroy (box);
+}
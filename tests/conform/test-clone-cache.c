@@ -0,0 +1,191 @@
+#include <clutter/clutter.h>
+
+#include "test-conform-common.h"
+
+#define N_CLONES        3
+#define SOURCE_SIZE     50
+
+typedef struct _FooActor      FooActor;
+typedef struct _FooActorClass FooActorClass;
+
+struct _FooActorClass
+{
+  ClutterActorClass parent_class;
+};
+
+struct _FooActor
+{
+  ClutterActor parent;
+
+  int paint_count;
+};
+
+typedef struct
+{
+  ClutterActor *stage;
+  FooActor *source;
+  ClutterActor *clones[N_CLONES];
+} Data;
+
+GType foo_actor_get_type (void) G_GNUC_CONST;
+
+G_DEFINE_TYPE (FooActor, foo_actor, CLUTTER_TYPE_ACTOR);
+
+static void
+foo_actor_paint (ClutterActor *actor)
+{
+  FooActor *foo_actor = (FooActor *) actor;
+  ClutterActorBox allocation;
+  guint8 paint_opacity;
+
+  foo_actor->paint_count++;
+
+  clutter_actor_get_allocation_box (actor, &allocation);
+
+  /* Paint a red rectangle filling the allocation */
+  paint_opacity = clutter_actor_get_paint_opacity (actor);
+  cogl_set_source_color4ub (255, 0, 0, paint_opacity);
+  cogl_rectangle (0, 0,
+                  allocation.x2 - allocation.x1,
+                  allocation.y2 - allocation.y1);
+}
+
+static void
+foo_actor_class_init (FooActorClass *klass)
+{
+  ClutterActorClass *actor_class = (ClutterActorClass *) klass;
+
+  actor_class->paint = foo_actor_paint;
+}
+
+static void
+foo_actor_init (FooActor *self)
+{
+}
+
+static void
+verify_results (Data *data,
+                int   expected_paint_count)
+{
+  int i;
+
+  data->source->paint_count = 0;
+
+  for (i = 0; i < N_CLONES; i++)
+    {
+      guchar *pixel;
+
+      /* Read a pixel at the center of each clone; the first read
+         causes a redraw */
+      pixel = clutter_stage_read_pixels (CLUTTER_STAGE (data->stage),
+                                         i * SOURCE_SIZE * 2 + SOURCE_SIZE,
+                                         SOURCE_SIZE,
+                                         1, 1);
+
+      if (g_test_verbose ())
+        g_print ("clone %d: %d, %d, %d\n", i, pixel[0], pixel[1], pixel[2]);
+
+      g_assert_cmpint (ABS (255 - (int) pixel[0]), <=, 2);
+      g_assert_cmpint (pixel[1], <=, 2);
+      g_assert_cmpint (pixel[2], <=, 2);
+
+      g_free (pixel);
+
+      if (i == 0)
+        g_assert_cmpint (data->source->paint_count,
+                         ==,
+                         expected_paint_count);
+    }
+}
+
+static gboolean
+timeout_cb (gpointer user_data)
+{
+  Data *data = user_data;
+  int i;
+
+  /* The source is painted once by the stage in each frame, plus
+     once for each clone without the cache */
+  verify_results (data, 1 + N_CLONES);
+
+  /* The first paint with the cache fills it, once for all the
+     clones */
+  for (i = 0; i < N_CLONES; i++)
+    clutter_clone_set_cache_source (CLUTTER_CLONE (data->clones[i]), TRUE);
+
+  verify_results (data, 1 + 1);
+
+  /* The source did not change, so the cached image is used */
+  verify_results (data, 1);
+
+  /* Queueing a redraw on the source updates the cache */
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (data->source));
+  verify_results (data, 1 + 1);
+
+  /* A clone that does not use the cache still paints the source */
+  clutter_clone_set_cache_source (CLUTTER_CLONE (data->clones[0]), FALSE);
+  g_assert (!clutter_clone_get_cache_source (CLUTTER_CLONE (data->clones[0])));
+  verify_results (data, 1 + 1);
+
+  clutter_main_quit ();
+
+  return FALSE;
+}
+
+void
+actor_clone_cache (TestConformSimpleFixture *fixture,
+                   gconstpointer             test_data)
+{
+  if (cogl_features_available (COGL_FEATURE_OFFSCREEN))
+    {
+      ClutterColor stage_color = { 0x00, 0x00, 0x00, 0xff };
+      Data data;
+      int i;
+
+      data.stage = clutter_stage_get_default ();
+      clutter_stage_set_color (CLUTTER_STAGE (data.stage), &stage_color);
+
+      /* the source is on the stage, below the clones, so that it
+         gets redraws queued on it */
+      data.source = g_object_new (foo_actor_get_type (), NULL);
+      clutter_actor_set_size (CLUTTER_ACTOR (data.source),
+                              SOURCE_SIZE,
+                              SOURCE_SIZE);
+      clutter_actor_set_position (CLUTTER_ACTOR (data.source),
+                                  0,
+                                  SOURCE_SIZE * 3);
+      clutter_container_add_actor (CLUTTER_CONTAINER (data.stage),
+                                   CLUTTER_ACTOR (data.source));
+
+      for (i = 0; i < N_CLONES; i++)
+        {
+          data.clones[i] = clutter_clone_new (CLUTTER_ACTOR (data.source));
+          clutter_actor_set_size (data.clones[i],
+                                  SOURCE_SIZE * 2,
+                                  SOURCE_SIZE * 2);
+          clutter_actor_set_position (data.clones[i],
+                                      i * SOURCE_SIZE * 2,
+                                      0);
+          clutter_container_add_actor (CLUTTER_CONTAINER (data.stage),
+                                       data.clones[i]);
+        }
+
+      clutter_actor_show (data.stage);
+
+      /* Start the test after a short delay to allow the stage to
+         render its initial frames without affecting the results */
+      g_timeout_add_full (G_PRIORITY_LOW, 250, timeout_cb, &data, NULL);
+
+      clutter_main ();
+
+      for (i = 0; i < N_CLONES; i++)
+        clutter_actor_destroy (data.clones[i]);
+
+      clutter_actor_destroy (CLUTTER_ACTOR (data.source));
+
+      if (g_test_verbose ())
+        g_print ("OK\n");
+    }
+  else if (g_test_verbose ())
+    g_print ("Skipping\n");
+}
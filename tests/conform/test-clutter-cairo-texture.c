@@ -14,13 +14,17 @@ typedef enum
 {
   /* The first frame is drawn using clutter_cairo_texture_create. The
      second frame is an update of the first frame using
-     clutter_cairo_texture_create_region. The states are stored like
+     clutter_cairo_texture_create_region. The third frame updates both
+     rectangles using two separate regions, which are uploaded together
+     before the next paint. The states are stored like
      this because the cairo drawing is done on idle and the validation
      is done during paint and we need to synchronize the two */
   TEST_BEFORE_DRAW_FIRST_FRAME,
   TEST_BEFORE_VALIDATE_FIRST_FRAME,
   TEST_BEFORE_DRAW_SECOND_FRAME,
   TEST_BEFORE_VALIDATE_SECOND_FRAME,
+  TEST_BEFORE_DRAW_THIRD_FRAME,
+  TEST_BEFORE_VALIDATE_THIRD_FRAME,
   TEST_DONE
 } TestProgress;
 
@@ -71,6 +75,7 @@ paint_cb (ClutterActor *actor, TestState *state)
     {
     case TEST_BEFORE_DRAW_FIRST_FRAME:
     case TEST_BEFORE_DRAW_SECOND_FRAME:
+    case TEST_BEFORE_DRAW_THIRD_FRAME:
     case TEST_DONE:
       /* Handled by the idle callback */
       break;
@@ -90,6 +95,14 @@ paint_cb (ClutterActor *actor, TestState *state)
       validate_part (0, 0, &red);
       validate_part (1, 0, &blue);
 
+      state->progress = TEST_BEFORE_DRAW_THIRD_FRAME;
+      break;
+
+    case TEST_BEFORE_VALIDATE_THIRD_FRAME:
+      /* The third frame swaps the colours of the second one */
+      validate_part (0, 0, &blue);
+      validate_part (1, 0, &red);
+
       state->progress = TEST_DONE;
       break;
     }
@@ -147,8 +160,31 @@ idle_cb (gpointer data)
 
         break;
 
+      case TEST_BEFORE_DRAW_THIRD_FRAME:
+        /* Replace both rectangles, each one through its own region */
+        cr = clutter_cairo_texture_create_region (CLUTTER_CAIRO_TEXTURE (state->ct),
+                                                  0, 0,
+                                                  BLOCK_SIZE, BLOCK_SIZE);
+        cairo_rectangle (cr, 0, 0, BLOCK_SIZE, BLOCK_SIZE);
+        cairo_set_source_rgb (cr, 0.0, 0.0, 1.0);
+        cairo_fill (cr);
+        cairo_destroy (cr);
+
+        cr = clutter_cairo_texture_create_region (CLUTTER_CAIRO_TEXTURE (state->ct),
+                                                  BLOCK_SIZE, 0,
+                                                  BLOCK_SIZE, BLOCK_SIZE);
+        cairo_rectangle (cr, BLOCK_SIZE, 0, BLOCK_SIZE, BLOCK_SIZE);
+        cairo_set_source_rgb (cr, 1.0, 0.0, 0.0);
+        cairo_fill (cr);
+        cairo_destroy (cr);
+
+        state->progress = TEST_BEFORE_VALIDATE_THIRD_FRAME;
+
+        break;
+
       case TEST_BEFORE_VALIDATE_FIRST_FRAME:
       case TEST_BEFORE_VALIDATE_SECOND_FRAME:
+      case TEST_BEFORE_VALIDATE_THIRD_FRAME:
         /* Handled by the paint callback */
         break;
 
@@ -249,6 +249,34 @@ text_get_chars (void)
   g_assert_cmpstr (chars, ==, "11");
   g_free (chars);
 
+  /* offsets are converted starting from the previous conversion, in
+   * both directions, and from the end of the text */
+  clutter_text_set_text (text, "a\xc3\xa4b\xe2\x99\xa5c\xc3\xa4d\xe2\x99\xa5");
+  g_assert_cmpint (get_nchars (text), ==, 8);
+
+  chars = clutter_text_get_chars (text, 5, 6);
+  g_assert_cmpstr (chars, ==, "\xc3\xa4");
+  g_free (chars);
+
+  chars = clutter_text_get_chars (text, 3, 4);
+  g_assert_cmpstr (chars, ==, "\xe2\x99\xa5");
+  g_free (chars);
+
+  chars = clutter_text_get_chars (text, 1, 7);
+  g_assert_cmpstr (chars, ==, "\xc3\xa4b\xe2\x99\xa5c\xc3\xa4d");
+  g_free (chars);
+
+  chars = clutter_text_get_chars (text, 7, -1);
+  g_assert_cmpstr (chars, ==, "\xe2\x99\xa5");
+  g_free (chars);
+
+  /* changing the text resets the conversions */
+  clutter_text_set_text (text, "\xe2\x99\xa5\xe2\x99\xa5");
+
+  chars = clutter_text_get_chars (text, 1, 2);
+  g_assert_cmpstr (chars, ==, "\xe2\x99\xa5");
+  g_free (chars);
+
   clutter_actor_destroy (CLUTTER_ACTOR (text));
 }
 
@@ -296,6 +324,236 @@ text_password_char (void)
   g_assert_cmpint (clutter_text_get_password_char (text), ==, '*');
 
   g_assert_cmpstr (clutter_text_get_text (text), ==, "hello");
+  g_assert_cmpstr (pango_layout_get_text (clutter_text_get_layout (text)),
+                   ==,
+                   "*****");
+
+  /* the masked text follows the length of the text */
+  clutter_text_set_text (text, "hello, world");
+  g_assert_cmpstr (pango_layout_get_text (clutter_text_get_layout (text)),
+                   ==,
+                   "************");
+
+  clutter_text_set_text (text, "hi");
+  g_assert_cmpstr (pango_layout_get_text (clutter_text_get_layout (text)),
+                   ==,
+                   "**");
+
+  clutter_text_set_password_char (text, '#');
+  g_assert_cmpstr (pango_layout_get_text (clutter_text_get_layout (text)),
+                   ==,
+                   "##");
+
+  clutter_actor_destroy (CLUTTER_ACTOR (text));
+}
+
+void
+text_ellipsize_width (void)
+{
+  ClutterText *text;
+  PangoLayout *layout;
+  gfloat natural_width, height;
+
+  text = CLUTTER_TEXT (clutter_text_new_with_text ("Sans 12",
+                                                   "An ellipsized label"));
+  clutter_text_set_ellipsize (text, PANGO_ELLIPSIZE_END);
+
+  clutter_actor_get_preferred_width (CLUTTER_ACTOR (text), -1,
+                                     NULL,
+                                     &natural_width);
+  clutter_actor_get_preferred_height (CLUTTER_ACTOR (text), natural_width,
+                                      NULL,
+                                      &height);
+
+  /* the widths wider than the text use the same layout */
+  clutter_actor_set_size (CLUTTER_ACTOR (text), natural_width + 10, height);
+  layout = clutter_text_get_layout (text);
+  g_assert (!pango_layout_is_ellipsized (layout));
+
+  clutter_actor_set_size (CLUTTER_ACTOR (text), natural_width + 50, height);
+  g_assert (clutter_text_get_layout (text) == layout);
+
+  /* a narrower width ellipsizes the text */
+  clutter_actor_set_size (CLUTTER_ACTOR (text), natural_width / 2, height);
+  layout = clutter_text_get_layout (text);
+  g_assert (pango_layout_is_ellipsized (layout));
+
+  clutter_actor_destroy (CLUTTER_ACTOR (text));
+}
+
+void
+text_shared_layout (void)
+{
+  ClutterText *a = CLUTTER_TEXT (clutter_text_new_with_text ("Sans 12", "foo"));
+  ClutterText *b = CLUTTER_TEXT (clutter_text_new_with_text ("Sans 12", "foo"));
+
+  /* identical labels share the same layout */
+  g_assert (clutter_text_get_layout (a) == clutter_text_get_layout (b));
+
+  clutter_text_set_text (b, "bar");
+  g_assert (clutter_text_get_layout (a) != clutter_text_get_layout (b));
+
+  clutter_text_set_text (b, "foo");
+  clutter_text_set_font_name (b, "Sans 20");
+  g_assert (clutter_text_get_layout (a) != clutter_text_get_layout (b));
+
+  /* editable actors always use their own layouts */
+  clutter_text_set_font_name (b, "Sans 12");
+  clutter_text_set_editable (b, TRUE);
+  g_assert (clutter_text_get_layout (a) != clutter_text_get_layout (b));
+
+  clutter_actor_destroy (CLUTTER_ACTOR (a));
+  clutter_actor_destroy (CLUTTER_ACTOR (b));
+}
+
+void
+text_font_change (void)
+{
+  ClutterSettings *settings = clutter_settings_get_default ();
+  ClutterActor *stage = clutter_stage_get_default ();
+  ClutterActor *shown, *hidden;
+  gchar *font_name = NULL;
+
+  g_object_get (settings, "font-name", &font_name, NULL);
+
+  shown = clutter_text_new_with_text (NULL, "foo");
+  clutter_container_add_actor (CLUTTER_CONTAINER (stage), shown);
+
+  hidden = clutter_text_new_with_text (NULL, "foo");
+  clutter_container_add_actor (CLUTTER_CONTAINER (stage), hidden);
+  clutter_actor_hide (hidden);
+
+  clutter_actor_show (stage);
+
+  g_object_set (settings, "font-name", "Sans 40", NULL);
+
+  /* the texts on the stage pick up the new font right away */
+  g_assert_cmpstr (clutter_text_get_font_name (CLUTTER_TEXT (shown)),
+                   ==, "Sans 40");
+
+  /* the texts that are not mapped pick it up when they are mapped */
+  g_assert_cmpstr (clutter_text_get_font_name (CLUTTER_TEXT (hidden)),
+                   !=, "Sans 40");
+
+  clutter_actor_show (hidden);
+  g_assert_cmpstr (clutter_text_get_font_name (CLUTTER_TEXT (hidden)),
+                   ==, "Sans 40");
+
+  g_object_set (settings, "font-name", font_name, NULL);
+  g_free (font_name);
+
+  clutter_actor_destroy (shown);
+  clutter_actor_destroy (hidden);
+}
+
+void
+text_layout_async (void)
+{
+  ClutterActor *stage = clutter_stage_get_default ();
+  ClutterText *text = CLUTTER_TEXT (clutter_text_new ());
+  GString *contents = g_string_new (NULL);
+  PangoLayout *layout;
+  GTimer *timer;
+
+  while (contents->len < 16 * 1024)
+    g_string_append (contents, "The quick brown fox jumps over the lazy dog\n");
+
+  clutter_text_set_layout_async (text, TRUE);
+  g_assert (clutter_text_get_layout_async (text));
+
+  clutter_text_set_text (text, contents->str);
+  clutter_container_add_actor (CLUTTER_CONTAINER (stage), CLUTTER_ACTOR (text));
+  clutter_actor_show (stage);
+
+  /* until the worker is done, only the beginning of the text is laid out */
+  timer = g_timer_new ();
+
+  do
+    {
+      g_main_context_iteration (NULL, FALSE);
+      layout = clutter_text_get_layout (text);
+    }
+  while (strlen (pango_layout_get_text (layout)) < contents->len &&
+         g_timer_elapsed (timer, NULL) < 10.0);
+
+  g_assert_cmpint (strlen (pango_layout_get_text (layout)), ==, contents->len);
+
+  /* the previous text is shown while the appended text is laid out */
+  clutter_text_insert_text (text, "The end\n", -1);
+  layout = clutter_text_get_layout (text);
+  if (g_thread_supported ())
+    g_assert_cmpint (strlen (pango_layout_get_text (layout)), ==, contents->len);
+
+  /* short texts are always laid out synchronously */
+  clutter_text_set_text (text, "foo");
+  g_assert_cmpstr (pango_layout_get_text (clutter_text_get_layout (text)), ==, "foo");
+
+  g_timer_destroy (timer);
+  g_string_free (contents, TRUE);
+
+  clutter_actor_destroy (CLUTTER_ACTOR (text));
+}
+
+static void
+check_paragraph_sizes (ClutterText *text)
+{
+  ClutterActor *reference;
+  gfloat width, height, ref_width, ref_height;
+
+  /* non-editable actors always measure the whole layout */
+  reference = clutter_text_new_with_text ("Sans 12",
+                                          clutter_text_get_text (text));
+  clutter_text_set_line_wrap (CLUTTER_TEXT (reference), TRUE);
+
+  clutter_actor_get_preferred_width (CLUTTER_ACTOR (text), -1, NULL, &width);
+  clutter_actor_get_preferred_width (reference, -1, NULL, &ref_width);
+  g_assert_cmpfloat (width, ==, ref_width);
+
+  clutter_actor_get_preferred_height (CLUTTER_ACTOR (text), 100, NULL, &height);
+  clutter_actor_get_preferred_height (reference, 100, NULL, &ref_height);
+  g_assert_cmpfloat (height, ==, ref_height);
+
+  clutter_actor_destroy (reference);
+}
+
+void
+text_paragraph_metrics (void)
+{
+  ClutterText *text = CLUTTER_TEXT (clutter_text_new ());
+  GString *contents = g_string_new (NULL);
+  gint i;
+
+  for (i = 0; i < 100; i++)
+    g_string_append_printf (contents, "Paragraph number %d\n", i);
+
+  clutter_text_set_font_name (text, "Sans 12");
+  clutter_text_set_editable (text, TRUE);
+  clutter_text_set_line_wrap (text, TRUE);
+  clutter_text_set_text (text, contents->str);
+  check_paragraph_sizes (text);
+
+  /* a long paragraph in the middle of the text */
+  clutter_text_insert_text (text, "wraps around many times, wraps around", 500);
+  check_paragraph_sizes (text);
+
+  /* splitting and merging paragraphs */
+  clutter_text_insert_text (text, "\n\n", 10);
+  check_paragraph_sizes (text);
+
+  clutter_text_delete_text (text, 9, 14);
+  check_paragraph_sizes (text);
+
+  /* editing at the end of the text */
+  clutter_text_set_cursor_position (text, -1);
+  clutter_text_insert_unichar (text, 'x');
+  check_paragraph_sizes (text);
+
+  clutter_text_delete_text (text,
+                            g_utf8_strlen (clutter_text_get_text (text), -1) - 3,
+                            -1);
+  check_paragraph_sizes (text);
+
+  g_string_free (contents, TRUE);
 
   clutter_actor_destroy (CLUTTER_ACTOR (text));
 }
@@ -87,3 +87,269 @@ test_texture_pick_with_alpha (TestConformSimpleFixture *fixture,
     g_print ("OK\n");
 }
 
+
+void
+test_texture_cache (TestConformSimpleFixture *fixture,
+                    gconstpointer             data)
+{
+  ClutterActor *tex1, *tex2;
+  guint n_hits, n_misses;
+  guint old_n_hits;
+  gchar *filename;
+  GError *error = NULL;
+
+  filename = clutter_test_get_data_file ("redhand.png");
+
+  /* empty the cache, in case other tests loaded the same file */
+  clutter_texture_set_cache_size (0);
+  clutter_texture_set_cache_size (16 * 1024 * 1024);
+
+  clutter_texture_get_cache_statistics (&old_n_hits, NULL, NULL);
+
+  tex1 = clutter_texture_new_from_file (filename, &error);
+  g_assert_no_error (error);
+
+  /* the second texture should share the image of the first one */
+  tex2 = clutter_texture_new_from_file (filename, &error);
+  g_assert_no_error (error);
+
+  clutter_texture_get_cache_statistics (&n_hits, &n_misses, NULL);
+  if (g_test_verbose ())
+    g_print ("cache hits: %u, misses: %u\n", n_hits, n_misses);
+
+  g_assert_cmpint (n_hits, ==, old_n_hits + 1);
+  g_assert (clutter_texture_get_cogl_texture (CLUTTER_TEXTURE (tex1)) ==
+            clutter_texture_get_cogl_texture (CLUTTER_TEXTURE (tex2)));
+
+  /* modifying the image of one texture must not affect the other */
+  clutter_texture_set_area_from_rgb_data (CLUTTER_TEXTURE (tex2),
+                                          (const guchar *) "\xff\xff\xff",
+                                          FALSE,
+                                          0, 0, 1, 1,
+                                          3, 3,
+                                          CLUTTER_TEXTURE_NONE,
+                                          &error);
+  g_assert_no_error (error);
+
+  g_assert (clutter_texture_get_cogl_texture (CLUTTER_TEXTURE (tex1)) !=
+            clutter_texture_get_cogl_texture (CLUTTER_TEXTURE (tex2)));
+
+  clutter_actor_destroy (tex1);
+  clutter_actor_destroy (tex2);
+
+  /* a disabled cache doesn't share anything */
+  clutter_texture_set_cache_size (0);
+
+  tex1 = clutter_texture_new_from_file (filename, &error);
+  g_assert_no_error (error);
+
+  tex2 = clutter_texture_new_from_file (filename, &error);
+  g_assert_no_error (error);
+
+  g_assert (clutter_texture_get_cogl_texture (CLUTTER_TEXTURE (tex1)) !=
+            clutter_texture_get_cogl_texture (CLUTTER_TEXTURE (tex2)));
+
+  clutter_actor_destroy (tex1);
+  clutter_actor_destroy (tex2);
+
+  clutter_texture_set_cache_size (16 * 1024 * 1024);
+
+  g_free (filename);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
+
+void
+test_texture_stream_buffers (TestConformSimpleFixture *fixture,
+                             gconstpointer data)
+{
+  ClutterActor *tex = clutter_texture_new ();
+  guchar pixels[4 * 4 * 4];
+  CoglHandle first, second;
+  GError *error = NULL;
+
+  memset (pixels, 0xff, sizeof (pixels));
+
+  clutter_texture_set_stream_buffers (CLUTTER_TEXTURE (tex), 2);
+  g_assert_cmpint (clutter_texture_get_stream_buffers (CLUTTER_TEXTURE (tex)),
+                   ==,
+                   2);
+
+  clutter_texture_set_from_rgb_data (CLUTTER_TEXTURE (tex), pixels, TRUE,
+                                     4, 4, 16, 4, 0,
+                                     &error);
+  g_assert_no_error (error);
+  first = clutter_texture_get_cogl_texture (CLUTTER_TEXTURE (tex));
+
+  /* a new frame never goes into the texture being shown */
+  clutter_texture_set_from_rgb_data (CLUTTER_TEXTURE (tex), pixels, TRUE,
+                                     4, 4, 16, 4, 0,
+                                     &error);
+  g_assert_no_error (error);
+  second = clutter_texture_get_cogl_texture (CLUTTER_TEXTURE (tex));
+  g_assert (second != first);
+
+  /* the buffers are used in turn */
+  clutter_texture_set_area_from_rgb_data (CLUTTER_TEXTURE (tex), pixels, TRUE,
+                                          0, 0, 4, 4, 16, 4, 0,
+                                          &error);
+  g_assert_no_error (error);
+  g_assert (clutter_texture_get_cogl_texture (CLUTTER_TEXTURE (tex)) == first);
+
+  /* a part of the frame updates the texture being shown */
+  clutter_texture_set_area_from_rgb_data (CLUTTER_TEXTURE (tex), pixels, TRUE,
+                                          1, 1, 2, 2, 16, 4, 0,
+                                          &error);
+  g_assert_no_error (error);
+  g_assert (clutter_texture_get_cogl_texture (CLUTTER_TEXTURE (tex)) == first);
+
+  /* a frame of a different size replaces the buffer */
+  clutter_texture_set_from_rgb_data (CLUTTER_TEXTURE (tex), pixels, TRUE,
+                                     2, 2, 16, 4, 0,
+                                     &error);
+  g_assert_no_error (error);
+  second = clutter_texture_get_cogl_texture (CLUTTER_TEXTURE (tex));
+  g_assert_cmpint (cogl_texture_get_width (second), ==, 2);
+
+  clutter_actor_destroy (tex);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
+
+void
+test_texture_memory_budget (TestConformSimpleFixture *fixture,
+                            gconstpointer             data)
+{
+  ClutterActor *stage = clutter_stage_get_default ();
+  ClutterActor *tex;
+  guint n_evictions, n_reloads, old_n_evictions, old_n_reloads;
+  gfloat width, height, old_width, old_height;
+  gchar *filename;
+  GError *error = NULL;
+
+  filename = clutter_test_get_data_file ("redhand.png");
+
+  clutter_texture_get_memory_statistics (&old_n_evictions,
+                                         &old_n_reloads,
+                                         NULL);
+
+  tex = clutter_texture_new_from_file (filename, &error);
+  g_assert_no_error (error);
+  g_assert (clutter_texture_get_cogl_texture (CLUTTER_TEXTURE (tex)) !=
+            COGL_INVALID_HANDLE);
+
+  clutter_actor_get_preferred_size (tex, NULL, NULL, &old_width, &old_height);
+
+  /* the texture of an unmapped actor is evicted when over budget, but
+   * the actor keeps its size */
+  clutter_texture_set_memory_budget (1);
+
+  clutter_texture_get_memory_statistics (&n_evictions, NULL, NULL);
+  g_assert_cmpint (n_evictions, ==, old_n_evictions + 1);
+  g_assert (clutter_texture_get_cogl_texture (CLUTTER_TEXTURE (tex)) ==
+            COGL_INVALID_HANDLE);
+
+  clutter_actor_get_preferred_size (tex, NULL, NULL, &width, &height);
+  g_assert_cmpfloat (width, ==, old_width);
+  g_assert_cmpfloat (height, ==, old_height);
+
+  /* mapping the actor loads the texture again */
+  clutter_container_add_actor (CLUTTER_CONTAINER (stage), tex);
+  clutter_actor_show (stage);
+
+  clutter_texture_get_memory_statistics (NULL, &n_reloads, NULL);
+  g_assert_cmpint (n_reloads, ==, old_n_reloads + 1);
+
+  while (clutter_texture_get_cogl_texture (CLUTTER_TEXTURE (tex)) ==
+         COGL_INVALID_HANDLE)
+    g_main_context_iteration (NULL, TRUE);
+
+  /* a mapped texture is never evicted */
+  clutter_texture_get_memory_statistics (&n_evictions, NULL, NULL);
+  g_assert_cmpint (n_evictions, ==, old_n_evictions + 1);
+
+  clutter_texture_set_memory_budget (0);
+
+  clutter_actor_destroy (tex);
+
+  g_free (filename);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
+
+static gint
+get_resident_width (ClutterActor *tex)
+{
+  CoglHandle handle;
+
+  handle = clutter_texture_get_cogl_texture (CLUTTER_TEXTURE (tex));
+  if (handle == COGL_INVALID_HANDLE)
+    return 0;
+
+  return cogl_texture_get_width (handle);
+}
+
+void
+test_texture_auto_lod (TestConformSimpleFixture *fixture,
+                       gconstpointer             data)
+{
+  ClutterActor *stage = clutter_stage_get_default ();
+  ClutterActor *tex;
+  gint base_width, base_height, width, height;
+  gchar *filename;
+  GError *error = NULL;
+
+  /* the levels of detail are scaled with an offscreen framebuffer */
+  if (!cogl_features_available (COGL_FEATURE_OFFSCREEN))
+    {
+      if (g_test_verbose ())
+        g_print ("Skipping\n");
+
+      return;
+    }
+
+  filename = clutter_test_get_data_file ("redhand.png");
+
+  tex = clutter_texture_new_from_file (filename, &error);
+  g_assert_no_error (error);
+
+  clutter_texture_get_base_size (CLUTTER_TEXTURE (tex),
+                                 &base_width,
+                                 &base_height);
+  g_assert_cmpint (get_resident_width (tex), ==, base_width);
+
+  clutter_texture_set_auto_lod (CLUTTER_TEXTURE (tex), TRUE);
+  g_assert (clutter_texture_get_auto_lod (CLUTTER_TEXTURE (tex)));
+
+  /* a texture painted at a tenth of its size loads a smaller level */
+  clutter_actor_set_size (tex, base_width / 10, base_height / 10);
+  clutter_container_add_actor (CLUTTER_CONTAINER (stage), tex);
+  clutter_actor_show (stage);
+
+  while (get_resident_width (tex) == base_width)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_cmpint (get_resident_width (tex), <, base_width);
+  g_assert_cmpint (get_resident_width (tex), >=, base_width / 10);
+
+  /* the size of the image does not change */
+  clutter_texture_get_base_size (CLUTTER_TEXTURE (tex), &width, &height);
+  g_assert_cmpint (width, ==, base_width);
+  g_assert_cmpint (height, ==, base_height);
+
+  /* the full resolution comes back when the texture grows */
+  clutter_actor_set_size (tex, base_width, base_height);
+
+  while (get_resident_width (tex) != base_width)
+    g_main_context_iteration (NULL, TRUE);
+
+  clutter_actor_destroy (tex);
+
+  g_free (filename);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
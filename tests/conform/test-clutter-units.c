@@ -25,6 +25,17 @@ test_units_cache (TestConformSimpleFixture *fixture,
   g_object_set (settings, "font-dpi", (96 * 1024), NULL);
   g_assert_cmpfloat (clutter_units_to_pixels (&units), ==, pixels);
 
+  /* the sizes of the fonts are cached until the resolution changes */
+  clutter_units_from_em_for_font (&units, "Sans 10", 1.0);
+  pixels = clutter_units_to_pixels (&units);
+
+  clutter_units_from_em_for_font (&units, "Sans 10", 2.0);
+  g_assert_cmpfloat (clutter_units_to_pixels (&units), ==, 2 * pixels);
+
+  g_object_set (settings, "font-dpi", ((96 * 2) * 1024), NULL);
+  clutter_units_from_em_for_font (&units, "Sans 10", 1.0);
+  g_assert_cmpfloat (clutter_units_to_pixels (&units), >, pixels);
+
   g_object_set (settings, "font-dpi", old_dpi, NULL);
 }
 
@@ -281,3 +281,49 @@ test_color_operators (TestConformSimpleFixture *fixture,
   clutter_color_subtract (&op1, &op2, &res);
   g_assert_cmpint (clutter_color_to_pixel (&res), ==, 0x00ff00cc);
 }
+
+void
+test_color_arrays (TestConformSimpleFixture *fixture,
+                   gconstpointer data)
+{
+  ClutterColor initial[3], final[3], res[3];
+  ClutterColor expected;
+  gint i;
+
+  clutter_color_from_pixel (&initial[0], 0xff0000ff);
+  clutter_color_from_pixel (&initial[1], 0x204060ff);
+  clutter_color_from_pixel (&initial[2], 0x204060ff);
+
+  clutter_color_from_pixel (&final[0], 0x00ff0000);
+  clutter_color_from_pixel (&final[1], 0x806040cc);
+  clutter_color_from_pixel (&final[2], 0x10101010);
+
+  clutter_color_interpolate_array (initial, final, 3, 0.3, res);
+
+  for (i = 0; i < 3; i++)
+    {
+      clutter_color_interpolate (&initial[i], &final[i], 0.3, &expected);
+      g_assert_cmpint (clutter_color_to_pixel (&res[i]),
+                       ==,
+                       clutter_color_to_pixel (&expected));
+    }
+
+  /* the runs of equal colors share their shade */
+  clutter_color_shade_array (initial, 3, 1.5, res);
+
+  for (i = 0; i < 3; i++)
+    {
+      clutter_color_shade (&initial[i], 1.5, &expected);
+      g_assert_cmpint (clutter_color_to_pixel (&res[i]),
+                       ==,
+                       clutter_color_to_pixel (&expected));
+    }
+
+  /* the results can replace the colors */
+  clutter_color_shade_array (initial, 3, 1.5, initial);
+
+  for (i = 0; i < 3; i++)
+    g_assert_cmpint (clutter_color_to_pixel (&initial[i]),
+                     ==,
+                     clutter_color_to_pixel (&res[i]));
+}
@@ -129,11 +129,36 @@ main (int argc, char **argv)
   TEST_CONFORM_TODO ("/suite", verify_failure);
 
   TEST_CONFORM_SIMPLE ("/actor", actor_destruction);
+  TEST_CONFORM_SIMPLE ("/actor", actor_destruction_deferred);
   TEST_CONFORM_SIMPLE ("/actor", actor_anchors);
   TEST_CONFORM_SIMPLE ("/actor", actor_picking);
+  TEST_CONFORM_SIMPLE ("/actor", actor_picking_async);
+  TEST_CONFORM_SIMPLE ("/actor", actor_picking_reactive);
+  TEST_CONFORM_SIMPLE ("/actor", actor_picking_retained);
+  TEST_CONFORM_SIMPLE ("/actor", actor_picking_alpha);
   TEST_CONFORM_SIMPLE ("/actor", actor_fixed_size);
   TEST_CONFORM_SIMPLE ("/actor", actor_preferred_size);
+  TEST_CONFORM_SIMPLE ("/actor", actor_relayout_boundary);
+  TEST_CONFORM_SIMPLE ("/actor", actor_size_cache);
+  TEST_CONFORM_SIMPLE ("/actor", actor_geometry_changed);
   TEST_CONFORM_SIMPLE ("/actor", test_offscreen_redirect);
+  TEST_CONFORM_SIMPLE ("/actor", actor_occlusion);
+  TEST_CONFORM_SIMPLE ("/actor", actor_occlusion_clear);
+  TEST_CONFORM_SIMPLE ("/actor", actor_clone_cache);
+  TEST_CONFORM_SIMPLE ("/actor", actor_subtree_cache);
+  TEST_CONFORM_SIMPLE ("/actor", actor_display_list);
+  TEST_CONFORM_SIMPLE ("/actor", actor_effect_fusion);
+  TEST_CONFORM_SIMPLE ("/actor", actor_shader_sharing);
+  TEST_CONFORM_SIMPLE ("/actor", stage_statistics);
+  TEST_CONFORM_SIMPLE ("/actor", stage_redraw_causes);
+  TEST_CONFORM_SIMPLE ("/actor", stage_depth_sorting);
+
+  TEST_CONFORM_SIMPLE ("/perf", perf_budget_move_actor);
+  TEST_CONFORM_SIMPLE ("/perf", perf_budget_text_cursor);
+  TEST_CONFORM_SIMPLE ("/perf", perf_budget_constraint_chain);
+  TEST_CONFORM_SIMPLE ("/perf", perf_budget_static_pick);
+  TEST_CONFORM_SIMPLE ("/perf", perf_budget_virtualized_list);
+  TEST_CONFORM_SIMPLE ("/perf", perf_budget_cloned_redraws);
 
   TEST_CONFORM_SIMPLE ("/invariants", test_initial_state);
   TEST_CONFORM_SIMPLE ("/invariants", test_shown_not_parented);
@@ -144,6 +169,9 @@ main (int argc, char **argv)
   TEST_CONFORM_SIMPLE ("/invariants", test_show_on_set_parent);
   TEST_CONFORM_SIMPLE ("/invariants", test_clone_no_map);
   TEST_CONFORM_SIMPLE ("/invariants", test_contains);
+  TEST_CONFORM_SIMPLE ("/invariants", test_transform_cache);
+  TEST_CONFORM_SIMPLE ("/invariants", test_transform_stage_point);
+  TEST_CONFORM_SIMPLE ("/invariants", test_translation);
 
   TEST_CONFORM_SIMPLE ("/opacity", test_label_opacity);
   TEST_CONFORM_SIMPLE ("/opacity", test_rectangle_opacity);
@@ -162,12 +190,22 @@ main (int argc, char **argv)
   TEST_CONFORM_SIMPLE ("/text", text_get_chars);
   TEST_CONFORM_SIMPLE ("/text", text_cache);
   TEST_CONFORM_SIMPLE ("/text", text_password_char);
+  TEST_CONFORM_SIMPLE ("/text", text_ellipsize_width);
+  TEST_CONFORM_SIMPLE ("/text", text_shared_layout);
+  TEST_CONFORM_SIMPLE ("/text", text_font_change);
+  TEST_CONFORM_SIMPLE ("/text", text_layout_async);
+  TEST_CONFORM_SIMPLE ("/text", text_paragraph_metrics);
 
   TEST_CONFORM_SIMPLE ("/rectangle", test_rect_set_size);
   TEST_CONFORM_SIMPLE ("/rectangle", test_rect_set_color);
 
   TEST_CONFORM_SIMPLE ("/texture", test_texture_pick_with_alpha);
   TEST_CONFORM_SIMPLE ("/texture", test_texture_fbo);
+  TEST_CONFORM_SIMPLE ("/texture", test_texture_fbo_update);
+  TEST_CONFORM_SIMPLE ("/texture", test_texture_cache);
+  TEST_CONFORM_SIMPLE ("/texture", test_texture_stream_buffers);
+  TEST_CONFORM_SIMPLE ("/texture", test_texture_memory_budget);
+  TEST_CONFORM_SIMPLE ("/texture", test_texture_auto_lod);
   TEST_CONFORM_SIMPLE ("/texture/cairo", test_clutter_cairo_texture);
 
   TEST_CONFORM_SIMPLE ("/path", test_path);
@@ -178,17 +216,39 @@ main (int argc, char **argv)
   TEST_CONFORM_SIMPLE ("/model", test_list_model_iterate);
   TEST_CONFORM_SIMPLE ("/model", test_list_model_filter);
   TEST_CONFORM_SIMPLE ("/model", test_list_model_from_script);
+  TEST_CONFORM_SIMPLE ("/model", test_column_model_filter);
+  TEST_CONFORM_SIMPLE ("/model", test_list_model_append_rows);
+  TEST_CONFORM_SIMPLE ("/model", test_list_model_cursor);
+  TEST_CONFORM_SIMPLE ("/model", test_list_model_async);
+  TEST_CONFORM_SIMPLE ("/model", list_view_recycling);
+
+  TEST_CONFORM_SIMPLE ("/scroll-view", scroll_view_translate);
 
   TEST_CONFORM_SIMPLE ("/color", test_color_from_string);
   TEST_CONFORM_SIMPLE ("/color", test_color_to_string);
   TEST_CONFORM_SIMPLE ("/color", test_color_hls_roundtrip);
   TEST_CONFORM_SIMPLE ("/color", test_color_operators);
+  TEST_CONFORM_SIMPLE ("/color", test_color_arrays);
+
+  TEST_CONFORM_SIMPLE ("/keysyms", keysym_to_unicode);
+  TEST_CONFORM_SIMPLE ("/keysyms", unicode_to_keysym);
 
   TEST_CONFORM_SIMPLE ("/units", test_units_constructors);
   TEST_CONFORM_SIMPLE ("/units", test_units_string);
   TEST_CONFORM_SIMPLE ("/units", test_units_cache);
 
   TEST_CONFORM_SIMPLE ("/group", test_group_depth_sorting);
+  TEST_CONFORM_SIMPLE ("/group", test_group_add_actors);
+  TEST_CONFORM_SIMPLE ("/group", test_group_iter);
+
+  TEST_CONFORM_SIMPLE ("/box-layout", box_layout_virtualized);
+  TEST_CONFORM_SIMPLE ("/box-layout", box_layout_parallel_measure);
+  TEST_CONFORM_SIMPLE ("/box-layout", box_layout_animated_offset);
+
+  TEST_CONFORM_SIMPLE ("/table-layout", table_layout_cached_solution);
+  TEST_CONFORM_SIMPLE ("/table-layout", table_layout_pack_full);
+
+  TEST_CONFORM_SIMPLE ("/flow-layout", flow_layout_cached_items);
 
   TEST_CONFORM_SIMPLE ("/script", test_script_single);
   TEST_CONFORM_SIMPLE ("/script", test_script_child);
@@ -201,10 +261,23 @@ main (int argc, char **argv)
   TEST_CONFORM_SIMPLE ("/script", test_animator_multi_properties);
   TEST_CONFORM_SIMPLE ("/script", test_state_base);
   TEST_CONFORM_SIMPLE ("/script", test_script_layout_property);
+  TEST_CONFORM_SIMPLE ("/script", test_script_compiled);
+  TEST_CONFORM_SIMPLE ("/script", test_script_lazy);
+  TEST_CONFORM_SIMPLE ("/script", test_script_stream);
+  TEST_CONFORM_SIMPLE ("/script", test_script_callbacks);
+
+  TEST_CONFORM_SIMPLE ("/alpha", alpha_modes);
+
+  TEST_CONFORM_SIMPLE ("/animation", animation_reuse);
+  TEST_CONFORM_SIMPLE ("/animation", animation_retarget);
+  TEST_CONFORM_SIMPLE ("/animation", animation_transform);
 
   TEST_CONFORM_SIMPLE ("/timeline", test_timeline);
   TEST_CONFORM_SKIP (!g_test_slow (), "/timeline", timeline_interpolation);
   TEST_CONFORM_SKIP (!g_test_slow (), "/timeline", timeline_rewind);
+  TEST_CONFORM_SIMPLE ("/timeline", timeline_stage);
+  TEST_CONFORM_SIMPLE ("/timeline", threads_post_update);
+  TEST_CONFORM_SIMPLE ("/timeline", threads_job);
 
   TEST_CONFORM_SIMPLE ("/score", test_score);
 
@@ -0,0 +1,175 @@
+#include <clutter/clutter.h>
+
+#include "test-conform-common.h"
+
+#define RECT_SIZE       50
+
+/* more than the number of frames the group has to stay unchanged
+   before its paint is recorded */
+#define STATIC_FRAMES   4
+
+typedef struct _FooActor      FooActor;
+typedef struct _FooActorClass FooActorClass;
+
+struct _FooActorClass
+{
+  ClutterActorClass parent_class;
+};
+
+struct _FooActor
+{
+  ClutterActor parent;
+
+  int paint_count;
+};
+
+typedef struct
+{
+  ClutterActor *stage;
+  ClutterActor *parent;
+  ClutterActor *group;
+  ClutterActor *rect;
+  FooActor *foo;
+} Data;
+
+GType foo_actor_get_type (void) G_GNUC_CONST;
+
+G_DEFINE_TYPE (FooActor, foo_actor, CLUTTER_TYPE_ACTOR);
+
+static void
+foo_actor_paint (ClutterActor *actor)
+{
+  FooActor *foo_actor = (FooActor *) actor;
+  ClutterActorBox allocation;
+
+  foo_actor->paint_count++;
+
+  clutter_actor_get_allocation_box (actor, &allocation);
+
+  /* Paint a green rectangle filling the allocation */
+  cogl_set_source_color4ub (0, 255, 0, clutter_actor_get_paint_opacity (actor));
+  cogl_rectangle (0, 0,
+                  allocation.x2 - allocation.x1,
+                  allocation.y2 - allocation.y1);
+}
+
+static void
+foo_actor_class_init (FooActorClass *klass)
+{
+  ClutterActorClass *actor_class = (ClutterActorClass *) klass;
+
+  actor_class->paint = foo_actor_paint;
+}
+
+static void
+foo_actor_init (FooActor *self)
+{
+}
+
+/* redraws the stage and checks the color at the center of the
+   rectangle */
+static void
+verify_rect (Data  *data,
+             guint8 r,
+             guint8 g,
+             guint8 b)
+{
+  guchar *pixel;
+
+  pixel = clutter_stage_read_pixels (CLUTTER_STAGE (data->stage),
+                                     RECT_SIZE / 2,
+                                     RECT_SIZE / 2,
+                                     1, 1);
+
+  if (g_test_verbose ())
+    g_print ("Got [ %d, %d, %d ], expected [ %d, %d, %d ]\n",
+             pixel[0], pixel[1], pixel[2],
+             r, g, b);
+
+  g_assert_cmpint (ABS ((int) pixel[0] - r), <=, 2);
+  g_assert_cmpint (ABS ((int) pixel[1] - g), <=, 2);
+  g_assert_cmpint (ABS ((int) pixel[2] - b), <=, 2);
+
+  g_free (pixel);
+}
+
+static gboolean
+timeout_cb (gpointer user_data)
+{
+  Data *data = user_data;
+  ClutterColor blue = { 0x00, 0x00, 0xff, 0xff };
+  int i;
+
+  /* The group does not change, so its paint is recorded after a
+     few frames and replayed after that */
+  for (i = 0; i < STATIC_FRAMES * 2; i++)
+    verify_rect (data, 255, 0, 0);
+
+  /* Changing a child drops the recorded paint */
+  clutter_rectangle_set_color (CLUTTER_RECTANGLE (data->rect), &blue);
+
+  for (i = 0; i < STATIC_FRAMES * 2; i++)
+    verify_rect (data, 0, 0, 255);
+
+  /* Changing the opacity of an ancestor does not queue a redraw on
+     the group, but it changes its paint opacity */
+  clutter_actor_set_opacity (data->parent, 128);
+
+  for (i = 0; i < STATIC_FRAMES * 2; i++)
+    verify_rect (data, 0, 0, 128);
+
+  clutter_actor_set_opacity (data->parent, 255);
+
+  /* A child that cannot be recorded is painted at each frame */
+  data->foo = g_object_new (foo_actor_get_type (), NULL);
+  clutter_actor_set_size (CLUTTER_ACTOR (data->foo), RECT_SIZE, RECT_SIZE);
+  clutter_actor_set_x (CLUTTER_ACTOR (data->foo), RECT_SIZE);
+  clutter_container_add_actor (CLUTTER_CONTAINER (data->group),
+                               CLUTTER_ACTOR (data->foo));
+
+  for (i = 0; i < STATIC_FRAMES * 2; i++)
+    {
+      data->foo->paint_count = 0;
+      verify_rect (data, 0, 0, 255);
+      g_assert_cmpint (data->foo->paint_count, ==, 1);
+    }
+
+  clutter_main_quit ();
+
+  return FALSE;
+}
+
+void
+actor_display_list (TestConformSimpleFixture *fixture,
+                    gconstpointer             test_data)
+{
+  ClutterColor stage_color = { 0x00, 0x00, 0x00, 0xff };
+  ClutterColor red = { 0xff, 0x00, 0x00, 0xff };
+  Data data;
+
+  data.stage = clutter_stage_get_default ();
+  clutter_stage_set_color (CLUTTER_STAGE (data.stage), &stage_color);
+
+  data.parent = clutter_group_new ();
+  clutter_container_add_actor (CLUTTER_CONTAINER (data.stage), data.parent);
+
+  data.group = clutter_group_new ();
+  clutter_container_add_actor (CLUTTER_CONTAINER (data.parent), data.group);
+
+  data.rect = clutter_rectangle_new_with_color (&red);
+  clutter_actor_set_size (data.rect, RECT_SIZE, RECT_SIZE);
+  clutter_container_add_actor (CLUTTER_CONTAINER (data.group), data.rect);
+
+  clutter_actor_show (data.stage);
+
+  /* Start the test after a short delay to allow the stage to
+     render its initial frames without affecting the results */
+  g_timeout_add_full (G_PRIORITY_LOW, 250, timeout_cb, &data, NULL);
+
+  clutter_main ();
+
+  clutter_actor_destroy (data.parent);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
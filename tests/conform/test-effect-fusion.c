@@ -0,0 +1,116 @@
+#include <clutter/clutter.h>
+
+#include "test-conform-common.h"
+
+#define RECT_SIZE       50
+
+typedef struct
+{
+  ClutterActor *stage;
+  ClutterActor *rect;
+  ClutterEffect *desaturate;
+  ClutterEffect *colorize;
+} Data;
+
+/* redraws the stage and checks the color at the center of the
+   rectangle */
+static void
+verify_rect (Data  *data,
+             guint8 r,
+             guint8 g,
+             guint8 b)
+{
+  guchar *pixel;
+
+  pixel = clutter_stage_read_pixels (CLUTTER_STAGE (data->stage),
+                                     RECT_SIZE / 2,
+                                     RECT_SIZE / 2,
+                                     1, 1);
+
+  if (g_test_verbose ())
+    g_print ("Got [ %d, %d, %d ], expected [ %d, %d, %d ]\n",
+             pixel[0], pixel[1], pixel[2],
+             r, g, b);
+
+  g_assert_cmpint (ABS ((int) pixel[0] - r), <=, 2);
+  g_assert_cmpint (ABS ((int) pixel[1] - g), <=, 2);
+  g_assert_cmpint (ABS ((int) pixel[2] - b), <=, 2);
+
+  g_free (pixel);
+}
+
+static gboolean
+timeout_cb (gpointer user_data)
+{
+  Data *data = user_data;
+  ClutterColor green = { 0x00, 0xff, 0x00, 0xff };
+
+  /* The colorize effect is the last one added, so it is applied
+     first: the red rectangle becomes a dark red, which is then
+     desaturated to a dark gray */
+  verify_rect (data, 23, 23, 23);
+
+  /* A disabled effect is not applied */
+  clutter_actor_meta_set_enabled (CLUTTER_ACTOR_META (data->colorize), FALSE);
+  verify_rect (data, 76, 76, 76);
+
+  clutter_actor_meta_set_enabled (CLUTTER_ACTOR_META (data->colorize), TRUE);
+  verify_rect (data, 23, 23, 23);
+
+  /* The colorize effect is painted by the desaturate effect, but
+     changing it still updates the actor */
+  clutter_colorize_effect_set_tint (CLUTTER_COLORIZE_EFFECT (data->colorize),
+                                    &green);
+  verify_rect (data, 45, 45, 45);
+
+  clutter_desaturate_effect_set_factor (CLUTTER_DESATURATE_EFFECT (data->desaturate),
+                                        0.0);
+  verify_rect (data, 0, 76, 0);
+
+  clutter_main_quit ();
+
+  return FALSE;
+}
+
+void
+actor_effect_fusion (TestConformSimpleFixture *fixture,
+                     gconstpointer             test_data)
+{
+  ClutterColor stage_color = { 0x00, 0x00, 0x00, 0xff };
+  ClutterColor red = { 0xff, 0x00, 0x00, 0xff };
+  Data data;
+
+  if (!clutter_feature_available (CLUTTER_FEATURE_SHADERS_GLSL))
+    {
+      if (g_test_verbose ())
+        g_print ("Skipping: GLSL is not supported\n");
+
+      return;
+    }
+
+  data.stage = clutter_stage_get_default ();
+  clutter_stage_set_color (CLUTTER_STAGE (data.stage), &stage_color);
+
+  data.rect = clutter_rectangle_new_with_color (&red);
+  clutter_actor_set_size (data.rect, RECT_SIZE, RECT_SIZE);
+  clutter_container_add_actor (CLUTTER_CONTAINER (data.stage), data.rect);
+
+  data.desaturate = clutter_desaturate_effect_new (1.0);
+  clutter_actor_add_effect (data.rect, data.desaturate);
+
+  data.colorize = clutter_colorize_effect_new (&red);
+  clutter_actor_add_effect (data.rect, data.colorize);
+
+  clutter_actor_show (data.stage);
+
+  /* Start the test after a short delay to allow the stage to
+     render its initial frames without affecting the results */
+  g_timeout_add_full (G_PRIORITY_LOW, 250, timeout_cb, &data, NULL);
+
+  clutter_main ();
+
+  clutter_actor_destroy (data.rect);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
@@ -0,0 +1,81 @@
+#include <clutter/clutter.h>
+
+#include "test-conform-common.h"
+
+#define N_ITEMS         6
+#define ITEM_SIZE       10
+
+static void
+assert_height_for_width (ClutterLayoutManager *layout,
+                         ClutterActor         *box,
+                         gfloat                for_width,
+                         gfloat                height)
+{
+  gfloat min_height, nat_height;
+
+  /* the width request computes the size of the columns */
+  clutter_layout_manager_get_preferred_width (layout,
+                                              CLUTTER_CONTAINER (box),
+                                              -1,
+                                              NULL, NULL);
+  clutter_layout_manager_get_preferred_height (layout,
+                                               CLUTTER_CONTAINER (box),
+                                               for_width,
+                                               &min_height,
+                                               &nat_height);
+
+  if (g_test_verbose ())
+    g_print ("Flow height for width %.2f: %.2f (expected %.2f)\n",
+             for_width, nat_height, height);
+
+  g_assert_cmpfloat (nat_height, ==, height);
+}
+
+void
+flow_layout_cached_items (TestConformSimpleFixture *fixture,
+                          gconstpointer             data)
+{
+  ClutterActor *stage, *box;
+  ClutterActor *items[N_ITEMS];
+  ClutterLayoutManager *layout;
+  gint i;
+
+  stage = clutter_stage_get_default ();
+
+  layout = clutter_flow_layout_new (CLUTTER_FLOW_HORIZONTAL);
+  box = clutter_box_new (layout);
+  clutter_container_add_actor (CLUTTER_CONTAINER (stage), box);
+
+  for (i = 0; i < N_ITEMS; i++)
+    {
+      items[i] = clutter_rectangle_new ();
+      clutter_actor_set_size (items[i], ITEM_SIZE, ITEM_SIZE);
+      clutter_container_add_actor (CLUTTER_CONTAINER (box), items[i]);
+    }
+
+  /* two lines of three items */
+  assert_height_for_width (layout, box, 3 * ITEM_SIZE, 2 * ITEM_SIZE);
+
+  /* the cached size of a child is updated when it changes... */
+  clutter_actor_set_height (items[4], 3 * ITEM_SIZE);
+  assert_height_for_width (layout, box, 3 * ITEM_SIZE, 4 * ITEM_SIZE);
+
+  /* ...and the items following a hidden child are flowed again */
+  clutter_actor_hide (items[1]);
+  assert_height_for_width (layout, box, 3 * ITEM_SIZE, 4 * ITEM_SIZE);
+
+  clutter_actor_hide (items[4]);
+  assert_height_for_width (layout, box, 3 * ITEM_SIZE, 2 * ITEM_SIZE);
+
+  clutter_actor_show (items[1]);
+  clutter_actor_show (items[4]);
+  assert_height_for_width (layout, box, 3 * ITEM_SIZE, 4 * ITEM_SIZE);
+
+  /* a different width changes the number of items on each line */
+  assert_height_for_width (layout, box, 2 * ITEM_SIZE, 5 * ITEM_SIZE);
+
+  clutter_container_remove_actor (CLUTTER_CONTAINER (box), items[4]);
+  assert_height_for_width (layout, box, 2 * ITEM_SIZE, 3 * ITEM_SIZE);
+
+  clutter_actor_destroy (box);
+}
@@ -53,5 +53,184 @@ test_group_depth_sorting (TestConformSimpleFixture *fixture,
   test = clutter_group_get_nth_child (g, 2);
   g_assert_cmpstr (clutter_actor_get_name (test), ==, "plus-ten");
 
+  g_assert (clutter_group_get_nth_child (g, 3) == NULL);
+  g_assert (clutter_group_get_nth_child (g, -1) == NULL);
+
+  /* children at the same depth keep the order in which they were added */
+  child = clutter_rectangle_new ();
+  clutter_actor_set_size (child, 20, 20);
+  clutter_actor_set_depth (child, 0);
+  clutter_actor_set_name (child, "zero-bis");
+  clutter_container_add_actor (CLUTTER_CONTAINER (group), child);
+
+  test = clutter_group_get_nth_child (g, 1);
+  g_assert_cmpstr (clutter_actor_get_name (test), ==, "zero");
+
+  test = clutter_group_get_nth_child (g, 2);
+  g_assert_cmpstr (clutter_actor_get_name (test), ==, "zero-bis");
+
+  /* changing the depth of a child moves it */
+  clutter_actor_set_depth (child, 20);
+
+  test = clutter_group_get_nth_child (g, 3);
+  g_assert_cmpstr (clutter_actor_get_name (test), ==, "zero-bis");
+
+  test = clutter_group_get_nth_child (g, 2);
+  g_assert_cmpstr (clutter_actor_get_name (test), ==, "plus-ten");
+
+  /* moving a child below all the others */
+  clutter_actor_set_depth (child, -20);
+
+  test = clutter_group_get_nth_child (g, 0);
+  g_assert_cmpstr (clutter_actor_get_name (test), ==, "zero-bis");
+
+  test = clutter_group_get_nth_child (g, 1);
+  g_assert_cmpstr (clutter_actor_get_name (test), ==, "minus-ten");
+
+  /* a child reaching the depth of its neighbours does not move */
+  test = clutter_group_get_nth_child (g, 1);
+  clutter_actor_set_depth (test, 0);
+
+  test = clutter_group_get_nth_child (g, 3);
+  clutter_actor_set_depth (test, 0);
+
+  test = clutter_group_get_nth_child (g, 1);
+  g_assert_cmpstr (clutter_actor_get_name (test), ==, "minus-ten");
+
+  test = clutter_group_get_nth_child (g, 2);
+  g_assert_cmpstr (clutter_actor_get_name (test), ==, "zero");
+
+  test = clutter_group_get_nth_child (g, 3);
+  g_assert_cmpstr (clutter_actor_get_name (test), ==, "plus-ten");
+
+  clutter_actor_destroy (group);
+}
+
+static void
+on_actor_added (ClutterContainer *container,
+                ClutterActor     *actor,
+                gpointer          data)
+{
+  gint *n_added = data;
+
+  /* all the actors of the batch are already children */
+  g_assert_cmpint (clutter_group_get_n_children (CLUTTER_GROUP (container)),
+                   ==,
+                   3);
+  g_assert (clutter_actor_get_parent (actor) == CLUTTER_ACTOR (container));
+
+  *n_added += 1;
+}
+
+void
+test_group_add_actors (TestConformSimpleFixture *fixture,
+                       gconstpointer             data)
+{
+  ClutterActor *group;
+  ClutterActor *actors[4];
+  ClutterGroup *g;
+  gint n_added = 0;
+
+  group = clutter_group_new ();
+  g = CLUTTER_GROUP (group);
+
+  g_signal_connect (group, "actor-added",
+                    G_CALLBACK (on_actor_added),
+                    &n_added);
+
+  actors[0] = clutter_rectangle_new ();
+  clutter_actor_set_name (actors[0], "zero");
+
+  actors[1] = clutter_rectangle_new ();
+  clutter_actor_set_depth (actors[1], -10);
+  clutter_actor_set_name (actors[1], "minus-ten");
+
+  actors[2] = clutter_rectangle_new ();
+  clutter_actor_set_name (actors[2], "zero-bis");
+
+  /* duplicates are ignored */
+  actors[3] = actors[0];
+
+  clutter_container_add_actors (CLUTTER_CONTAINER (group), actors, 4);
+
+  g_assert_cmpint (n_added, ==, 3);
+  g_assert_cmpint (clutter_group_get_n_children (g), ==, 3);
+
+  g_assert_cmpstr (clutter_actor_get_name (clutter_group_get_nth_child (g, 0)),
+                   ==,
+                   "minus-ten");
+  g_assert_cmpstr (clutter_actor_get_name (clutter_group_get_nth_child (g, 1)),
+                   ==,
+                   "zero");
+  g_assert_cmpstr (clutter_actor_get_name (clutter_group_get_nth_child (g, 2)),
+                   ==,
+                   "zero-bis");
+
+  clutter_actor_destroy (group);
+}
+
+void
+test_group_iter (TestConformSimpleFixture *fixture,
+                 gconstpointer             data)
+{
+  const gchar *names[] = { "minus-ten", "zero", "plus-ten" };
+  const gfloat depths[] = { -10, 0, 10 };
+  ClutterContainerIter iter;
+  ClutterActor *group, *child;
+  gint i;
+
+  group = clutter_group_new ();
+
+  /* an empty container has no children in either direction */
+  clutter_container_iter_init (&iter, CLUTTER_CONTAINER (group));
+  g_assert (!clutter_container_iter_next (&iter, &child));
+
+  clutter_container_iter_init (&iter, CLUTTER_CONTAINER (group));
+  g_assert (!clutter_container_iter_prev (&iter, &child));
+
+  for (i = G_N_ELEMENTS (names) - 1; i >= 0; i--)
+    {
+      child = clutter_rectangle_new ();
+      clutter_actor_set_depth (child, depths[i]);
+      clutter_actor_set_name (child, names[i]);
+      clutter_container_add_actor (CLUTTER_CONTAINER (group), child);
+    }
+
+  /* the children are walked in the order of clutter_container_foreach() */
+  i = 0;
+  clutter_container_iter_init (&iter, CLUTTER_CONTAINER (group));
+  while (clutter_container_iter_next (&iter, &child))
+    {
+      g_assert_cmpstr (clutter_actor_get_name (child), ==, names[i]);
+      i += 1;
+    }
+
+  g_assert_cmpint (i, ==, G_N_ELEMENTS (names));
+
+  /* an exhausted iterator stays exhausted */
+  g_assert (!clutter_container_iter_next (&iter, &child));
+  g_assert (!clutter_container_iter_prev (&iter, &child));
+
+  i = G_N_ELEMENTS (names);
+  clutter_container_iter_init (&iter, CLUTTER_CONTAINER (group));
+  while (clutter_container_iter_prev (&iter, &child))
+    {
+      i -= 1;
+      g_assert_cmpstr (clutter_actor_get_name (child), ==, names[i]);
+    }
+
+  g_assert_cmpint (i, ==, 0);
+
+  /* the iterator can change direction */
+  clutter_container_iter_init (&iter, CLUTTER_CONTAINER (group));
+  g_assert (clutter_container_iter_next (&iter, &child));
+  g_assert (clutter_container_iter_next (&iter, &child));
+  g_assert_cmpstr (clutter_actor_get_name (child), ==, "zero");
+  g_assert (clutter_container_iter_prev (&iter, &child));
+  g_assert_cmpstr (clutter_actor_get_name (child), ==, "minus-ten");
+
+  g_assert (clutter_container_find_child_by_name (CLUTTER_CONTAINER (group),
+                                                  "plus-ten") != NULL);
+
   clutter_actor_destroy (group);
 }
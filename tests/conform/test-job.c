@@ -0,0 +1,94 @@
+#include <clutter/clutter.h>
+
+#include "test-conform-common.h"
+
+#define N_JOBS  8
+
+typedef struct
+{
+  GThread *main_thread;
+
+  volatile gint n_run;
+  gint n_done;
+  gint n_released;
+
+  guint cancelled_id;
+} TestState;
+
+static void
+job_func (ClutterJob *job,
+          gpointer    data)
+{
+  TestState *state = data;
+
+  g_atomic_int_inc (&state->n_run);
+}
+
+static void
+job_done (ClutterJob *job,
+          gpointer    data)
+{
+  TestState *state = data;
+
+  /* completion functions are called from the main loop */
+  g_assert (g_thread_self () == state->main_thread);
+
+  /* the completion function of a cancelled job is never called */
+  g_assert_cmpuint (clutter_job_get_id (job), !=, state->cancelled_id);
+  g_assert (!clutter_job_is_cancelled (job));
+
+  state->n_done += 1;
+}
+
+static void
+job_release (gpointer data)
+{
+  TestState *state = data;
+
+  g_assert (g_thread_self () == state->main_thread);
+
+  state->n_released += 1;
+}
+
+void
+threads_job (TestConformSimpleFixture *fixture,
+             gconstpointer             data)
+{
+  TestState state = { 0, };
+  gint i;
+
+  state.main_thread = g_thread_self ();
+
+  if (g_test_verbose ())
+    g_print ("%u worker threads\n", clutter_job_get_n_workers ());
+
+  for (i = 0; i < N_JOBS; i++)
+    {
+      guint id;
+
+      id = clutter_job_add_full (G_PRIORITY_DEFAULT + i,
+                                 job_func,
+                                 job_done,
+                                 &state,
+                                 job_release);
+      g_assert_cmpuint (id, !=, 0);
+
+      if (i == N_JOBS - 1)
+        state.cancelled_id = id;
+    }
+
+  g_assert (clutter_job_cancel (state.cancelled_id));
+
+  /* every job is released, cancelled or not */
+  while (state.n_released < N_JOBS)
+    g_main_context_iteration (NULL, TRUE);
+
+  if (g_test_verbose ())
+    g_print ("run: %d, done: %d\n", state.n_run, state.n_done);
+
+  g_assert_cmpint (state.n_done, ==, N_JOBS - 1);
+  g_assert_cmpint (g_atomic_int_get (&state.n_run), >=, N_JOBS - 1);
+
+  /* a job that completed cannot be cancelled anymore */
+  g_assert (!clutter_job_cancel (state.cancelled_id));
+}
@@ -0,0 +1,34 @@
+#include <clutter/clutter.h>
+
+#include "test-conform-common.h"
+
+void
+keysym_to_unicode (void)
+{
+  /* Latin-1 key symbols map to themselves */
+  g_assert_cmpuint (clutter_keysym_to_unicode (CLUTTER_KEY_a), ==, 'a');
+
+  /* the other key symbols are looked up in the table */
+  g_assert_cmpuint (clutter_keysym_to_unicode (CLUTTER_KEY_Lstroke), ==, 0x0141);
+  g_assert_cmpuint (clutter_keysym_to_unicode (CLUTTER_KEY_EuroSign), ==, 0x20ac);
+  g_assert_cmpuint (clutter_keysym_to_unicode (CLUTTER_KEY_KP_7), ==, '7');
+
+  /* directly encoded Unicode characters */
+  g_assert_cmpuint (clutter_keysym_to_unicode (0x01002603), ==, 0x2603);
+
+  /* key symbols without a character */
+  g_assert_cmpuint (clutter_keysym_to_unicode (CLUTTER_KEY_Shift_L), ==, 0);
+  g_assert_cmpuint (clutter_keysym_to_unicode (0x1234), ==, 0);
+}
+
+void
+unicode_to_keysym (void)
+{
+  g_assert_cmpuint (clutter_unicode_to_keysym ('a'), ==, CLUTTER_KEY_a);
+  g_assert_cmpuint (clutter_unicode_to_keysym (0x0141), ==, CLUTTER_KEY_Lstroke);
+  g_assert_cmpuint (clutter_unicode_to_keysym (0x20ac), ==, CLUTTER_KEY_EuroSign);
+
+  /* characters without a key symbol use the direct encoding */
+  g_assert_cmpuint (clutter_unicode_to_keysym (0x2603), ==, 0x01002603);
+  g_assert_cmpuint (clutter_unicode_to_keysym (0x1f600), ==, 0x0101f600);
+}
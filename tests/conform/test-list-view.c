@@ -0,0 +1,145 @@
+#include <clutter/clutter.h>
+
+#include "test-conform-common.h"
+
+#define N_ROWS          1000
+#define ITEM_HEIGHT     10
+
+typedef struct
+{
+  ClutterActor *stage;
+
+  guint n_binds;
+  gint last_value;
+} ListViewData;
+
+static ClutterActor *
+create_item (ClutterListView *view,
+             gpointer         user_data)
+{
+  return clutter_rectangle_new ();
+}
+
+static void
+bind_item (ClutterListView  *view,
+           ClutterActor     *item,
+           ClutterModelIter *iter,
+           gpointer          user_data)
+{
+  ListViewData *data = user_data;
+  gint value;
+
+  clutter_model_iter_get (iter, 0, &value, -1);
+
+  data->n_binds += 1;
+  data->last_value = value;
+}
+
+static void
+run_frames (ListViewData *data,
+            gint          n_frames)
+{
+  GMainLoop *main_loop = g_main_loop_new (NULL, TRUE);
+  guint paint_handler;
+  gint i;
+
+  paint_handler = g_signal_connect_data (data->stage,
+                                         "paint",
+                                         G_CALLBACK (g_main_loop_quit),
+                                         main_loop,
+                                         NULL,
+                                         G_CONNECT_SWAPPED | G_CONNECT_AFTER);
+
+  for (i = 0; i < n_frames; i++)
+    {
+      clutter_actor_queue_redraw (data->stage);
+      g_main_loop_run (main_loop);
+    }
+
+  g_signal_handler_disconnect (data->stage, paint_handler);
+  g_main_loop_unref (main_loop);
+}
+
+void
+list_view_recycling (TestConformSimpleFixture *fixture,
+                     gconstpointer             test_data)
+{
+  ClutterModel *model;
+  ClutterModelIter *iter;
+  ClutterActor *view;
+  ListViewData data = { NULL, };
+  gint i;
+
+  data.stage = clutter_stage_get_default ();
+
+  model = clutter_list_model_new (1, G_TYPE_INT, "value");
+  for (i = 0; i < N_ROWS; i++)
+    clutter_model_append (model, 0, i, -1);
+
+  view = clutter_list_view_new ();
+  clutter_actor_set_size (view, 100, 10 * ITEM_HEIGHT);
+  clutter_list_view_set_item_height (CLUTTER_LIST_VIEW (view), ITEM_HEIGHT);
+  clutter_list_view_set_item_funcs (CLUTTER_LIST_VIEW (view),
+                                    create_item,
+                                    bind_item,
+                                    &data, NULL);
+  clutter_list_view_set_model (CLUTTER_LIST_VIEW (view), model);
+  clutter_container_add_actor (CLUTTER_CONTAINER (data.stage), view);
+
+  clutter_actor_show (data.stage);
+  run_frames (&data, 3);
+
+  /* only the visible rows have an item */
+  if (g_test_verbose ())
+    g_print ("Initial: %u items, %u binds\n",
+             clutter_list_view_get_n_items (CLUTTER_LIST_VIEW (view)),
+             data.n_binds);
+
+  g_assert_cmpint (clutter_list_view_get_n_items (CLUTTER_LIST_VIEW (view)),
+                   ==,
+                   10);
+  g_assert_cmpint (data.n_binds, ==, 10);
+
+  /* scrolling by half an item shows one more row */
+  data.n_binds = 0;
+  clutter_list_view_set_scroll_offset (CLUTTER_LIST_VIEW (view),
+                                       ITEM_HEIGHT / 2);
+  run_frames (&data, 2);
+
+  g_assert_cmpint (clutter_list_view_get_n_items (CLUTTER_LIST_VIEW (view)),
+                   ==,
+                   11);
+  g_assert_cmpint (data.n_binds, ==, 1);
+  g_assert_cmpint (data.last_value, ==, 10);
+
+  /* jumping far away recycles all the items */
+  data.n_binds = 0;
+  clutter_list_view_set_scroll_offset (CLUTTER_LIST_VIEW (view),
+                                       500 * ITEM_HEIGHT + ITEM_HEIGHT / 2);
+  run_frames (&data, 2);
+
+  g_assert_cmpint (clutter_list_view_get_n_items (CLUTTER_LIST_VIEW (view)),
+                   ==,
+                   11);
+  g_assert_cmpint (data.n_binds, ==, 11);
+  g_assert_cmpint (data.last_value, ==, 510);
+
+  /* changing a visible row binds only its item */
+  data.n_binds = 0;
+  iter = clutter_model_get_iter_at_row (model, 505);
+  clutter_model_iter_set (iter, 0, -1, -1);
+  g_object_unref (iter);
+
+  g_assert_cmpint (data.n_binds, ==, 1);
+  g_assert_cmpint (data.last_value, ==, -1);
+
+  /* changing a row outside of the view binds nothing */
+  iter = clutter_model_get_iter_at_row (model, 10);
+  clutter_model_iter_set (iter, 0, -1, -1);
+  g_object_unref (iter);
+
+  g_assert_cmpint (data.n_binds, ==, 1);
+
+  clutter_actor_destroy (view);
+  g_object_unref (model);
+}
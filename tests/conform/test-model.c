@@ -244,6 +244,25 @@ test_list_model_filter (TestConformSimpleFixture *fixture,
   iter = clutter_model_get_iter_at_row (test_data.model, 5);
   g_assert (iter == NULL);
 
+  if (g_test_verbose ())
+    g_print ("get_iter_at_row after a change...\n");
+
+  /* "String 1" does not pass the filter any more */
+  iter = clutter_model_get_iter_at_row (test_data.model, 0);
+  clutter_model_iter_set (iter, COLUMN_BAR, 2, -1);
+  g_object_unref (iter);
+
+  g_assert_cmpint (clutter_model_get_n_rows (test_data.model), ==, 4);
+
+  for (i = 0; i < 4; i++)
+    {
+      iter = clutter_model_get_iter_at_row (test_data.model, i);
+      compare_iter (iter, i,
+                    filter_odd[i + 1].expected_foo,
+                    filter_odd[i + 1].expected_bar);
+      g_object_unref (iter);
+    }
+
   g_object_unref (test_data.model);
 }
 
@@ -433,3 +452,474 @@ test_list_model_from_script (TestConformSimpleFixture *fixture,
   g_value_unset (&value);
   g_object_unref (iter);
 }
+
+static gboolean
+filter_odd_rows_typed (ClutterModel     *model,
+                       ClutterModelIter *iter,
+                       gpointer          dummy G_GNUC_UNUSED)
+{
+  return clutter_column_model_iter_get_int (iter, COLUMN_BAR) % 2 != 0;
+}
+
+static gint
+sort_bar_descending (ClutterModel *model,
+                     const GValue *a,
+                     const GValue *b,
+                     gpointer      dummy G_GNUC_UNUSED)
+{
+  return g_value_get_int (b) - g_value_get_int (a);
+}
+
+void
+test_column_model_filter (TestConformSimpleFixture *fixture,
+                          gconstpointer             data)
+{
+  ModelData test_data = { NULL, 0 };
+  ClutterModelIter *iter;
+  gint i;
+
+  test_data.model = clutter_column_model_new (N_COLUMNS,
+                                              G_TYPE_STRING, "Foo",
+                                              G_TYPE_INT,    "Bar");
+  test_data.n_row = 0;
+
+  g_signal_connect (test_data.model, "row-added",
+                    G_CALLBACK (on_row_added),
+                    &test_data);
+
+  for (i = 1; i < 10; i++)
+    {
+      gchar *foo = g_strdup_printf ("String %d", i);
+
+      clutter_model_append (test_data.model,
+                            COLUMN_FOO, foo,
+                            COLUMN_BAR, i,
+                            -1);
+
+      g_free (foo);
+    }
+
+  g_assert_cmpint (clutter_model_get_n_rows (test_data.model), ==, 9);
+
+  if (g_test_verbose ())
+    g_print ("Typed accessors...\n");
+
+  iter = clutter_model_get_first_iter (test_data.model);
+  g_assert (iter != NULL);
+
+  i = 0;
+  while (!clutter_model_iter_is_last (iter))
+    {
+      g_assert_cmpstr (clutter_column_model_iter_get_string (iter, COLUMN_FOO),
+                       ==,
+                       forward_base[i].expected_foo);
+      g_assert_cmpint (clutter_column_model_iter_get_int (iter, COLUMN_BAR),
+                       ==,
+                       forward_base[i].expected_bar);
+
+      iter = clutter_model_iter_next (iter);
+      i += 1;
+    }
+
+  g_assert_cmpint (i, ==, G_N_ELEMENTS (forward_base));
+  g_object_unref (iter);
+
+  if (g_test_verbose ())
+    g_print ("Forward iteration (filter odd)...\n");
+
+  clutter_model_set_filter (test_data.model, filter_odd_rows_typed, NULL, NULL);
+
+  iter = clutter_model_get_first_iter (test_data.model);
+  g_assert (iter != NULL);
+
+  i = 0;
+  while (!clutter_model_iter_is_last (iter))
+    {
+      compare_iter (iter, i,
+                    filter_odd[i].expected_foo,
+                    filter_odd[i].expected_bar);
+
+      iter = clutter_model_iter_next (iter);
+      i += 1;
+    }
+
+  g_object_unref (iter);
+
+  if (g_test_verbose ())
+    g_print ("Backward iteration (filter even)...\n");
+
+  clutter_model_set_filter (test_data.model, filter_even_rows, NULL, NULL);
+
+  iter = clutter_model_get_last_iter (test_data.model);
+  g_assert (iter != NULL);
+
+  i = 0;
+  do
+    {
+      compare_iter (iter, G_N_ELEMENTS (filter_even) - i - 1,
+                    filter_even[i].expected_foo,
+                    filter_even[i].expected_bar);
+
+      iter = clutter_model_iter_prev (iter);
+      i += 1;
+    }
+  while (!clutter_model_iter_is_first (iter));
+
+  g_object_unref (iter);
+
+  if (g_test_verbose ())
+    g_print ("Remove and sort...\n");
+
+  clutter_model_set_filter (test_data.model, NULL, NULL, NULL);
+
+  /* removes "String 1" */
+  clutter_model_remove (test_data.model, 0);
+  g_assert_cmpint (clutter_model_get_n_rows (test_data.model), ==, 8);
+
+  clutter_model_set_sort (test_data.model, COLUMN_BAR,
+                          sort_bar_descending,
+                          NULL, NULL);
+
+  for (i = 0; i < 8; i++)
+    {
+      iter = clutter_model_get_iter_at_row (test_data.model, i);
+      compare_iter (iter, i,
+                    backward_base[i].expected_foo,
+                    backward_base[i].expected_bar);
+      g_object_unref (iter);
+    }
+
+  if (g_test_verbose ())
+    g_print ("Incremental sort...\n");
+
+  /* the new row is moved to its sorted position */
+  clutter_model_append (test_data.model,
+                        COLUMN_FOO, "String 1",
+                        COLUMN_BAR, 1,
+                        -1);
+
+  /* "String 9" is moved after "String 2" */
+  iter = clutter_model_get_first_iter (test_data.model);
+  clutter_model_iter_set (iter, COLUMN_BAR, 1, -1);
+  g_object_unref (iter);
+
+  for (i = 0; i < 7; i++)
+    {
+      iter = clutter_model_get_iter_at_row (test_data.model, i);
+      compare_iter (iter, i,
+                    backward_base[i + 1].expected_foo,
+                    backward_base[i + 1].expected_bar);
+      g_object_unref (iter);
+    }
+
+  iter = clutter_model_get_iter_at_row (test_data.model, 7);
+  g_assert_cmpstr (clutter_column_model_iter_get_string (iter, COLUMN_FOO),
+                   ==,
+                   "String 1");
+  g_object_unref (iter);
+
+  iter = clutter_model_get_iter_at_row (test_data.model, 8);
+  g_assert_cmpstr (clutter_column_model_iter_get_string (iter, COLUMN_FOO),
+                   ==,
+                   "String 9");
+  g_assert_cmpint (clutter_column_model_iter_get_int (iter, COLUMN_BAR), ==, 1);
+  g_object_unref (iter);
+
+  g_object_unref (test_data.model);
+}
+
+static void
+on_rows_added (ClutterModel *model,
+               guint         first_row,
+               guint         n_rows,
+               ModelData    *data)
+{
+  g_assert_cmpint (first_row, ==, 0);
+
+  data->n_row += n_rows;
+}
+
+static void
+on_row_added_count (ClutterModel     *model,
+                    ClutterModelIter *iter,
+                    gint             *n_row_added)
+{
+  *n_row_added += 1;
+}
+
+void
+test_list_model_append_rows (TestConformSimpleFixture *fixture,
+                             gconstpointer             data)
+{
+  ModelData test_data = { NULL, 0 };
+  guint columns[N_COLUMNS] = { COLUMN_FOO, COLUMN_BAR };
+  GValue values[9 * N_COLUMNS] = { { 0, }, };
+  gint n_row_added = 0;
+  gint i;
+
+  test_data.model = clutter_list_model_new (N_COLUMNS,
+                                            G_TYPE_STRING, "Foo",
+                                            G_TYPE_INT,    "Bar");
+  test_data.n_row = 0;
+
+  clutter_model_set_sort (test_data.model, COLUMN_BAR,
+                          sort_bar_descending,
+                          NULL, NULL);
+
+  g_signal_connect (test_data.model, "rows-added",
+                    G_CALLBACK (on_rows_added),
+                    &test_data);
+  g_signal_connect (test_data.model, "row-added",
+                    G_CALLBACK (on_row_added_count),
+                    &n_row_added);
+
+  for (i = 0; i < 9; i++)
+    {
+      GValue *foo = &values[i * N_COLUMNS + COLUMN_FOO];
+      GValue *bar = &values[i * N_COLUMNS + COLUMN_BAR];
+
+      g_value_init (foo, G_TYPE_STRING);
+      g_value_take_string (foo, g_strdup_printf ("String %d", i + 1));
+
+      g_value_init (bar, G_TYPE_INT);
+      g_value_set_int (bar, i + 1);
+    }
+
+  clutter_model_append_rows (test_data.model, 9, N_COLUMNS, columns, values);
+
+  for (i = 0; i < 9 * N_COLUMNS; i++)
+    g_value_unset (&values[i]);
+
+  g_assert_cmpint (test_data.n_row, ==, 9);
+  g_assert_cmpint (n_row_added, ==, 0);
+  g_assert_cmpint (clutter_model_get_n_rows (test_data.model), ==, 9);
+
+  for (i = 0; i < 9; i++)
+    {
+      ClutterModelIter *iter;
+
+      iter = clutter_model_get_iter_at_row (test_data.model, i);
+      compare_iter (iter, i,
+                    backward_base[i].expected_foo,
+                    backward_base[i].expected_bar);
+      g_object_unref (iter);
+    }
+
+  g_object_unref (test_data.model);
+}
+
+static inline void
+compare_cursor (ClutterModelCursor *cursor,
+                const gint          expected_row,
+                const gchar        *expected_foo,
+                const gint          expected_bar)
+{
+  gchar *foo = NULL;
+  gint bar = 0;
+
+  clutter_model_cursor_get (cursor,
+                            COLUMN_FOO, &foo,
+                            COLUMN_BAR, &bar,
+                            -1);
+
+  g_assert_cmpint (clutter_model_cursor_get_row (cursor), ==, expected_row);
+  g_assert_cmpstr (foo, ==, expected_foo);
+  g_assert_cmpint (bar, ==, expected_bar);
+
+  g_free (foo);
+}
+
+void
+test_list_model_cursor (TestConformSimpleFixture *fixture,
+                        gconstpointer             data)
+{
+  ClutterModelCursor cursor;
+  ClutterModel *model;
+  GValue value = { 0, };
+  gint i;
+
+  model = clutter_list_model_new (N_COLUMNS,
+                                  G_TYPE_STRING, "Foo",
+                                  G_TYPE_INT,    "Bar");
+
+  g_assert (!clutter_model_get_cursor_at_row (model, 0, &cursor));
+
+  for (i = 1; i < 10; i++)
+    {
+      gchar *foo = g_strdup_printf ("String %d", i);
+
+      clutter_model_append (model,
+                            COLUMN_FOO, foo,
+                            COLUMN_BAR, i,
+                            -1);
+
+      g_free (foo);
+    }
+
+  if (g_test_verbose ())
+    g_print ("Forward iteration...\n");
+
+  g_assert (clutter_model_get_cursor_at_row (model, 0, &cursor));
+
+  i = 0;
+  do
+    {
+      compare_cursor (&cursor, i,
+                      base_model[i].expected_foo,
+                      base_model[i].expected_bar);
+      i += 1;
+    }
+  while (clutter_model_cursor_next (&cursor));
+
+  g_assert_cmpint (i, ==, G_N_ELEMENTS (base_model));
+  g_assert_cmpint (clutter_model_cursor_get_row (&cursor), ==, i - 1);
+
+  clutter_model_cursor_get_value (&cursor, COLUMN_BAR, &value);
+  g_assert (G_VALUE_HOLDS_INT (&value));
+  g_assert_cmpint (g_value_get_int (&value), ==, 9);
+  g_value_unset (&value);
+
+  if (g_test_verbose ())
+    g_print ("Backward iteration with a filter...\n");
+
+  clutter_model_set_filter (model, filter_even_rows, NULL, NULL);
+
+  g_assert (!clutter_model_get_cursor_at_row (model, 4, &cursor));
+  g_assert (clutter_model_get_cursor_at_row (model, 3, &cursor));
+
+  i = 0;
+  do
+    {
+      compare_cursor (&cursor, G_N_ELEMENTS (filter_even) - i - 1,
+                      filter_even[i].expected_foo,
+                      filter_even[i].expected_bar);
+      i += 1;
+    }
+  while (clutter_model_cursor_prev (&cursor));
+
+  g_assert_cmpint (i, ==, G_N_ELEMENTS (filter_even));
+  g_assert_cmpint (clutter_model_cursor_get_row (&cursor), ==, 0);
+
+  if (g_test_verbose ())
+    g_print ("Removing rows under a cursor...\n");
+
+  clutter_model_set_filter (model, NULL, NULL, NULL);
+
+  /* the cursor keeps its index when the rows change */
+  g_assert (clutter_model_get_cursor_at_row (model, 2, &cursor));
+  compare_cursor (&cursor, 2, "String 3", 3);
+
+  clutter_model_remove (model, 0);
+  compare_cursor (&cursor, 2, "String 4", 4);
+
+  g_assert (clutter_model_cursor_next (&cursor));
+  compare_cursor (&cursor, 3, "String 5", 5);
+
+  g_object_unref (model);
+}
+
+static gboolean
+filter_even_values (const GValue *value,
+                    gpointer      dummy G_GNUC_UNUSED)
+{
+  return g_value_get_int (value) % 2 == 0;
+}
+
+static void
+on_model_changed (ClutterModel *model,
+                  gpointer      data)
+{
+  gint *n_changed = data;
+
+  *n_changed += 1;
+}
+
+void
+test_list_model_async (TestConformSimpleFixture *fixture,
+                       gconstpointer             data)
+{
+  ClutterModelIter *iter;
+  ClutterModel *model;
+  gint n_sort_changed = 0, n_filter_changed = 0;
+  gint i;
+
+  model = clutter_list_model_new (N_COLUMNS,
+                                  G_TYPE_STRING, "Foo",
+                                  G_TYPE_INT,    "Bar");
+
+  for (i = 1; i < 10; i++)
+    {
+      gchar *foo = g_strdup_printf ("String %d", i);
+
+      clutter_model_append (model,
+                            COLUMN_FOO, foo,
+                            COLUMN_BAR, i,
+                            -1);
+
+      g_free (foo);
+    }
+
+  g_signal_connect (model, "sort-changed",
+                    G_CALLBACK (on_model_changed),
+                    &n_sort_changed);
+  g_signal_connect (model, "filter-changed",
+                    G_CALLBACK (on_model_changed),
+                    &n_filter_changed);
+
+  clutter_model_set_sort_async (model, COLUMN_BAR,
+                                sort_bar_descending,
+                                NULL, NULL);
+  clutter_model_set_filter_async (model, COLUMN_BAR,
+                                  filter_even_values,
+                                  NULL, NULL);
+
+  /* nothing changes until the worker thread is done */
+  g_assert (!clutter_model_get_filter_set (model));
+  g_assert_cmpint (clutter_model_get_sorting_column (model), ==, -1);
+  g_assert_cmpint (clutter_model_get_n_rows (model), ==, 9);
+
+  while (n_filter_changed == 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  /* both changes are applied at once */
+  g_assert_cmpint (n_sort_changed, ==, 1);
+  g_assert_cmpint (n_filter_changed, ==, 1);
+
+  g_assert (clutter_model_get_filter_set (model));
+  g_assert_cmpint (clutter_model_get_sorting_column (model), ==, COLUMN_BAR);
+  g_assert_cmpint (clutter_model_get_n_rows (model), ==,
+                   G_N_ELEMENTS (filter_even));
+
+  iter = clutter_model_get_first_iter (model);
+  for (i = 0; i < G_N_ELEMENTS (filter_even); i++)
+    {
+      compare_iter (iter, i,
+                    filter_even[i].expected_foo,
+                    filter_even[i].expected_bar);
+      iter = clutter_model_iter_next (iter);
+    }
+  g_assert (clutter_model_iter_is_last (iter));
+  g_object_unref (iter);
+
+  if (g_test_verbose ())
+    g_print ("Appending to the sorted and filtered model...\n");
+
+  /* the rows added afterwards are sorted and filtered right away */
+  clutter_model_append (model,
+                        COLUMN_FOO, "String 10",
+                        COLUMN_BAR, 10,
+                        -1);
+  clutter_model_append (model,
+                        COLUMN_FOO, "String 11",
+                        COLUMN_BAR, 11,
+                        -1);
+
+  g_assert_cmpint (clutter_model_get_n_rows (model), ==,
+                   G_N_ELEMENTS (filter_even) + 1);
+
+  iter = clutter_model_get_first_iter (model);
+  compare_iter (iter, 0, "String 10", 10);
+  g_object_unref (iter);
+
+  g_object_unref (model);
+}
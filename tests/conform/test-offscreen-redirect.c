@@ -93,6 +93,9 @@ struct _FooGroupClass
 struct _FooGroup
 {
   ClutterGroup parent;
+
+  gboolean has_overlaps;
+  int has_overlaps_count;
 };
 
 G_DEFINE_TYPE (FooGroup, foo_group, CLUTTER_TYPE_GROUP);
@@ -100,7 +103,11 @@ G_DEFINE_TYPE (FooGroup, foo_group, CLUTTER_TYPE_GROUP);
 static gboolean
 foo_group_has_overlaps (ClutterActor *actor)
 {
-  return FALSE;
+  FooGroup *foo_group = (FooGroup *) actor;
+
+  foo_group->has_overlaps_count++;
+
+  return foo_group->has_overlaps;
 }
 
 static void
@@ -176,6 +183,7 @@ static gboolean
 timeout_cb (gpointer user_data)
 {
   Data *data = user_data;
+  FooGroup *foo_group = (FooGroup *) data->container;
 
   /* By default the actor shouldn't be redirected so the redraw should
      cause the actor to be painted */
@@ -266,6 +274,35 @@ timeout_cb (gpointer user_data)
   clutter_actor_set_position (data->unrelated_actor, 0, 1);
   verify_redraw (data, 0);
 
+  /* Going back to the default redirect with a semi-transparent
+     container should paint the actor directly because the container
+     does not have overlaps */
+  clutter_actor_set_offscreen_redirect
+    (data->container, CLUTTER_OFFSCREEN_REDIRECT_AUTOMATIC_FOR_OPACITY);
+  clutter_actor_set_opacity (data->container, 127);
+  verify_results (data,
+                  255, 127, 127,
+                  1,
+                  127);
+
+  /* The overlaps shouldn't be checked again while nothing changes */
+  foo_group->has_overlaps_count = 0;
+  verify_results (data,
+                  255, 127, 127,
+                  1,
+                  127);
+  g_assert_cmpint (foo_group->has_overlaps_count, ==, 0);
+
+  /* Notifying that the container now has overlaps should redirect
+     it through the FBO, so the actor is painted with full opacity */
+  foo_group->has_overlaps = TRUE;
+  clutter_actor_notify_overlaps_changed (data->container);
+  verify_results (data,
+                  255, 127, 127,
+                  1,
+                  255);
+  g_assert_cmpint (foo_group->has_overlaps_count, ==, 1);
+
   clutter_main_quit ();
 
   return FALSE;
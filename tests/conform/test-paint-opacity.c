@@ -138,6 +138,20 @@ test_paint_opacity (TestConformSimpleFixture *fixture,
     g_print ("rect 100%%.get_paint_opacity()\n");
   g_assert (clutter_actor_get_paint_opacity (rect) == 128);
 
+  /* the paint opacity follows the changes of the ancestors */
+  if (g_test_verbose ())
+    g_print ("rect 100%% + group 100%% + group 25%%.get_paint_opacity()\n");
+  clutter_actor_set_opacity (group1, 64);
+  g_assert (clutter_actor_get_paint_opacity (rect) == 64);
+
+  clutter_actor_set_opacity (group2, 128);
+  g_assert (clutter_actor_get_paint_opacity (rect) == 32);
+
+  if (g_test_verbose ())
+    g_print ("rect 100%% reparented.get_paint_opacity()\n");
+  clutter_actor_reparent (rect, stage);
+  g_assert (clutter_actor_get_paint_opacity (rect) == 255);
+
   clutter_actor_destroy (rect);
   clutter_actor_destroy (group2);
   clutter_actor_destroy (group1);
@@ -0,0 +1,436 @@
+#include <clutter/clutter.h>
+
+#include "test-conform-common.h"
+
+/* These tests check that the amount of work done by the optimized
+ * paths stays within a budget. The budgets are expressed as numbers
+ * of actors or passes instead of times, so that they do not depend on
+ * the speed of the machine running the tests.
+ */
+
+#define GRID_COLUMNS            40
+#define GRID_ROWS               25
+#define GRID_CELL_SIZE          16
+#define GRID_ACTOR_SIZE         14
+
+/* the stage, the grid and the actor that moved, plus some slack for
+ * the rounding of the redraw clip */
+#define MOVE_PAINT_BUDGET       8
+
+/* the moved actor, and possibly its parent */
+#define MOVE_REDRAW_BUDGET      2
+
+/* the stage, the grid and the actor that moved */
+#define MOVE_ALLOCATE_BUDGET    3
+
+/* the stage and the text, plus some slack; the grid is culled */
+#define CURSOR_PAINT_BUDGET     3
+
+/* the number of actors bound to each other in a chain */
+#define CHAIN_LENGTH            8
+
+#define N_PICKS                 10
+
+/* the first pick after a frame is clipped to the picked pixel; the
+ * second one paints the whole pick buffer, and the following ones
+ * read from it while the scene does not change */
+#define STATIC_PICK_BUDGET      2
+
+#define LIST_CHILDREN           1000
+#define LIST_CHILD_HEIGHT       20
+#define LIST_VIEWPORT_SIZE      100
+
+/* the stage, the viewport, the list, the visible children and one
+ * more child that is partially visible */
+#define LIST_ALLOCATE_BUDGET    (LIST_VIEWPORT_SIZE / LIST_CHILD_HEIGHT + 4)
+
+#define CLONE_SOURCE_CHILDREN   8
+#define N_CLONES                3
+
+/* each changed child of the source, and each clone once */
+#define CLONE_REDRAW_BUDGET     (CLONE_SOURCE_CHILDREN + N_CLONES)
+
+static void
+on_paint (ClutterActor *stage,
+          gboolean     *painted)
+{
+  *painted = TRUE;
+}
+
+/* runs the main loop until @stage has drawn a frame */
+static void
+wait_for_frame (ClutterActor *stage)
+{
+  gboolean painted = FALSE;
+  GTimer *timer;
+  gulong paint_id;
+
+  paint_id = g_signal_connect_after (stage, "paint",
+                                     G_CALLBACK (on_paint),
+                                     &painted);
+
+  timer = g_timer_new ();
+
+  while (!painted && g_timer_elapsed (timer, NULL) < 10.0)
+    g_main_context_iteration (NULL, FALSE);
+
+  g_assert (painted);
+
+  g_timer_destroy (timer);
+  g_signal_handler_disconnect (stage, paint_id);
+}
+
+/* adds a grid of rectangles to @stage, and returns the one in the
+ * center of the grid in @center */
+static ClutterActor *
+add_grid (ClutterActor  *stage,
+          ClutterActor **center)
+{
+  ClutterActor *grid;
+  gint row, column;
+
+  grid = clutter_group_new ();
+  clutter_container_add_actor (CLUTTER_CONTAINER (stage), grid);
+
+  for (row = 0; row < GRID_ROWS; row++)
+    for (column = 0; column < GRID_COLUMNS; column++)
+      {
+        ClutterActor *rect = clutter_rectangle_new ();
+
+        clutter_actor_set_size (rect, GRID_ACTOR_SIZE, GRID_ACTOR_SIZE);
+        clutter_actor_set_position (rect,
+                                    column * GRID_CELL_SIZE,
+                                    row * GRID_CELL_SIZE);
+        clutter_container_add_actor (CLUTTER_CONTAINER (grid), rect);
+
+        if (row == GRID_ROWS / 2 && column == GRID_COLUMNS / 2)
+          *center = rect;
+      }
+
+  return grid;
+}
+
+static void
+get_last_frame_timings (ClutterActor             *stage,
+                        ClutterStageFrameTimings *timings)
+{
+  guint n_frames;
+
+  n_frames = clutter_stage_get_frame_timings (CLUTTER_STAGE (stage),
+                                              timings,
+                                              1);
+  g_assert_cmpuint (n_frames, ==, 1);
+}
+
+void
+perf_budget_move_actor (TestConformSimpleFixture *fixture,
+                        gconstpointer             data)
+{
+  ClutterActor *stage, *grid, *moved = NULL;
+  ClutterStageFrameTimings timings;
+  ClutterStageStatistics stats;
+
+  stage = clutter_stage_get_default ();
+
+  grid = add_grid (stage, &moved);
+
+  clutter_actor_show (stage);
+  wait_for_frame (stage);
+
+  clutter_actor_move_by (moved, 1, 0);
+  wait_for_frame (stage);
+
+  clutter_stage_get_statistics (CLUTTER_STAGE (stage), &stats);
+  get_last_frame_timings (stage, &timings);
+
+  if (g_test_verbose ())
+    g_print ("moving one actor: %u painted, %u culled, %u redraws queued, "
+             "%u allocated, %s redraw\n",
+             stats.n_painted_actors,
+             stats.n_culled_actors,
+             stats.n_queued_redraws,
+             timings.n_allocated_actors,
+             stats.clipped_redraw ? "clipped" : "full");
+
+  g_assert_cmpuint (stats.n_queued_redraws, <=, MOVE_REDRAW_BUDGET);
+  g_assert_cmpuint (timings.n_allocated_actors, <=, MOVE_ALLOCATE_BUDGET);
+
+  /* without clipped redraws every actor on the stage is painted; the
+   * backend might not support them, or they might have been disabled
+   * using CLUTTER_PAINT */
+  if (stats.clipped_redraw)
+    g_assert_cmpuint (stats.n_painted_actors, <=, MOVE_PAINT_BUDGET);
+  else if (g_test_verbose ())
+    g_print ("Clipped redraws unavailable, skipping the paint budget\n");
+
+  clutter_actor_destroy (grid);
+}
+
+void
+perf_budget_text_cursor (TestConformSimpleFixture *fixture,
+                         gconstpointer             data)
+{
+  ClutterActor *stage, *grid, *center, *text;
+  ClutterStageStatistics stats;
+
+  stage = clutter_stage_get_default ();
+
+  grid = add_grid (stage, &center);
+
+  /* an editor below the grid */
+  text = clutter_text_new_with_text ("Sans 12px",
+                                     "The first line\n"
+                                     "The second line\n"
+                                     "The third line");
+  clutter_text_set_editable (CLUTTER_TEXT (text), TRUE);
+  clutter_actor_set_position (text, 0, GRID_ROWS * GRID_CELL_SIZE + 4);
+  clutter_container_add_actor (CLUTTER_CONTAINER (stage), text);
+
+  clutter_stage_set_key_focus (CLUTTER_STAGE (stage), text);
+  clutter_text_set_cursor_position (CLUTTER_TEXT (text), 0);
+
+  clutter_actor_show (stage);
+  wait_for_frame (stage);
+
+  /* moving the cursor along a line only repaints the cursor */
+  clutter_text_set_cursor_position (CLUTTER_TEXT (text), 4);
+  wait_for_frame (stage);
+
+  clutter_stage_get_statistics (CLUTTER_STAGE (stage), &stats);
+
+  if (g_test_verbose ())
+    g_print ("moving the cursor: %u painted, %u culled, "
+             "%u redraws queued, %s redraw\n",
+             stats.n_painted_actors,
+             stats.n_culled_actors,
+             stats.n_queued_redraws,
+             stats.clipped_redraw ? "clipped" : "full");
+
+  g_assert_cmpuint (stats.n_queued_redraws, <=, MOVE_REDRAW_BUDGET);
+
+  if (stats.clipped_redraw)
+    g_assert_cmpuint (stats.n_painted_actors, <=, CURSOR_PAINT_BUDGET);
+  else if (g_test_verbose ())
+    g_print ("Clipped redraws unavailable, skipping the paint budget\n");
+
+  clutter_actor_destroy (text);
+  clutter_actor_destroy (grid);
+}
+
+void
+perf_budget_constraint_chain (TestConformSimpleFixture *fixture,
+                              gconstpointer             data)
+{
+  ClutterActor *stage, *links[CHAIN_LENGTH];
+  gint i;
+
+  stage = clutter_stage_get_default ();
+
+  for (i = 0; i < CHAIN_LENGTH; i++)
+    {
+      links[i] = clutter_rectangle_new ();
+      clutter_actor_set_size (links[i], GRID_ACTOR_SIZE, GRID_ACTOR_SIZE);
+
+      if (i > 0)
+        {
+          ClutterConstraint *bind;
+
+          bind = clutter_bind_constraint_new (links[i - 1],
+                                              CLUTTER_BIND_X,
+                                              GRID_CELL_SIZE);
+          clutter_actor_add_constraint (links[i], bind);
+        }
+    }
+
+  /* each link is allocated before the one it is bound to */
+  for (i = CHAIN_LENGTH - 1; i >= 0; i--)
+    clutter_container_add_actor (CLUTTER_CONTAINER (stage), links[i]);
+
+  clutter_actor_show (stage);
+  wait_for_frame (stage);
+
+  clutter_actor_set_x (links[0], GRID_CELL_SIZE);
+  wait_for_frame (stage);
+
+  if (g_test_verbose ())
+    g_print ("moving the head of a chain of %d bound actors: "
+             "tail at %.1f, expected at %d\n",
+             CHAIN_LENGTH,
+             clutter_actor_get_x (links[CHAIN_LENGTH - 1]),
+             CHAIN_LENGTH * GRID_CELL_SIZE);
+
+  /* the whole chain follows the head in the same frame */
+  for (i = 0; i < CHAIN_LENGTH; i++)
+    g_assert_cmpfloat (clutter_actor_get_x (links[i]),
+                       ==,
+                       (i + 1) * GRID_CELL_SIZE);
+
+  for (i = 0; i < CHAIN_LENGTH; i++)
+    clutter_actor_destroy (links[i]);
+}
+
+void
+perf_budget_static_pick (TestConformSimpleFixture *fixture,
+                         gconstpointer             data)
+{
+  ClutterActor *stage, *grid;
+  ClutterStageFrameTimings timings;
+  gboolean geometric_picking;
+  gint i;
+
+  stage = clutter_stage_get_default ();
+
+  /* geometric picking would not render the scene at all */
+  geometric_picking =
+    clutter_stage_get_geometric_picking (CLUTTER_STAGE (stage));
+  clutter_stage_set_geometric_picking (CLUTTER_STAGE (stage), FALSE);
+
+  grid = clutter_group_new ();
+  clutter_container_add_actor (CLUTTER_CONTAINER (stage), grid);
+
+  for (i = 0; i < GRID_COLUMNS; i++)
+    {
+      ClutterActor *rect = clutter_rectangle_new ();
+
+      clutter_actor_set_size (rect, GRID_ACTOR_SIZE, GRID_ACTOR_SIZE);
+      clutter_actor_set_position (rect, i * GRID_CELL_SIZE, 0);
+      clutter_actor_set_reactive (rect, TRUE);
+      clutter_container_add_actor (CLUTTER_CONTAINER (grid), rect);
+    }
+
+  clutter_actor_show (stage);
+  wait_for_frame (stage);
+
+  /* the scene does not change between the picks */
+  for (i = 0; i < N_PICKS; i++)
+    clutter_stage_get_actor_at_pos (CLUTTER_STAGE (stage),
+                                    CLUTTER_PICK_REACTIVE,
+                                    i * GRID_CELL_SIZE + 1,
+                                    1);
+
+  /* the picks are accounted to the next frame */
+  clutter_actor_queue_redraw (stage);
+  wait_for_frame (stage);
+
+  get_last_frame_timings (stage, &timings);
+
+  if (g_test_verbose ())
+    g_print ("static scene: %u picks, %u pick renders\n",
+             timings.n_picks,
+             timings.n_pick_renders);
+
+  g_assert_cmpuint (timings.n_picks, >, 0);
+  g_assert_cmpuint (timings.n_pick_renders, <=, STATIC_PICK_BUDGET);
+
+  clutter_stage_set_geometric_picking (CLUTTER_STAGE (stage),
+                                       geometric_picking);
+
+  clutter_actor_destroy (grid);
+}
+
+void
+perf_budget_virtualized_list (TestConformSimpleFixture *fixture,
+                              gconstpointer             data)
+{
+  ClutterActor *stage, *viewport, *list;
+  ClutterLayoutManager *layout;
+  ClutterStageFrameTimings timings;
+  gint i;
+
+  stage = clutter_stage_get_default ();
+
+  viewport = clutter_group_new ();
+  clutter_actor_set_size (viewport, LIST_VIEWPORT_SIZE, LIST_VIEWPORT_SIZE);
+  clutter_actor_set_clip_to_allocation (viewport, TRUE);
+  clutter_container_add_actor (CLUTTER_CONTAINER (stage), viewport);
+
+  layout = clutter_box_layout_new ();
+  clutter_box_layout_set_vertical (CLUTTER_BOX_LAYOUT (layout), TRUE);
+  clutter_box_layout_set_virtualized (CLUTTER_BOX_LAYOUT (layout), TRUE);
+
+  list = clutter_box_new (layout);
+  clutter_container_add_actor (CLUTTER_CONTAINER (viewport), list);
+
+  for (i = 0; i < LIST_CHILDREN; i++)
+    {
+      ClutterActor *rect = clutter_rectangle_new ();
+
+      clutter_actor_set_size (rect, LIST_VIEWPORT_SIZE, LIST_CHILD_HEIGHT);
+      clutter_container_add_actor (CLUTTER_CONTAINER (list), rect);
+    }
+
+  clutter_actor_show (stage);
+  wait_for_frame (stage);
+
+  /* scroll to the middle of the list */
+  clutter_actor_set_y (list, -(LIST_CHILDREN / 2) * LIST_CHILD_HEIGHT);
+  wait_for_frame (stage);
+
+  get_last_frame_timings (stage, &timings);
+
+  if (g_test_verbose ())
+    g_print ("scrolling a list of %d children: %u allocated\n",
+             LIST_CHILDREN,
+             timings.n_allocated_actors);
+
+  g_assert_cmpuint (timings.n_allocated_actors, <=, LIST_ALLOCATE_BUDGET);
+
+  clutter_actor_destroy (viewport);
+}
+
+void
+perf_budget_cloned_redraws (TestConformSimpleFixture *fixture,
+                            gconstpointer             data)
+{
+  ClutterColor color = { 0xff, 0x00, 0x00, 0xff };
+  ClutterActor *stage, *source, *children[CLONE_SOURCE_CHILDREN];
+  ClutterActor *clones[N_CLONES];
+  ClutterStageStatistics stats;
+  gint i;
+
+  stage = clutter_stage_get_default ();
+
+  source = clutter_group_new ();
+  clutter_container_add_actor (CLUTTER_CONTAINER (stage), source);
+
+  for (i = 0; i < CLONE_SOURCE_CHILDREN; i++)
+    {
+      children[i] = clutter_rectangle_new ();
+      clutter_actor_set_size (children[i], GRID_ACTOR_SIZE, GRID_ACTOR_SIZE);
+      clutter_actor_set_position (children[i], i * GRID_CELL_SIZE, 0);
+      clutter_container_add_actor (CLUTTER_CONTAINER (source), children[i]);
+    }
+
+  for (i = 0; i < N_CLONES; i++)
+    {
+      clones[i] = clutter_clone_new (source);
+      clutter_actor_set_y (clones[i], (i + 1) * GRID_CELL_SIZE);
+      clutter_container_add_actor (CLUTTER_CONTAINER (stage), clones[i]);
+    }
+
+  clutter_actor_show (stage);
+  wait_for_frame (stage);
+
+  /* every child of the source queues a redraw, which each clone
+   * receives from the source */
+  for (i = 0; i < CLONE_SOURCE_CHILDREN; i++)
+    clutter_rectangle_set_color (CLUTTER_RECTANGLE (children[i]), &color);
+
+  wait_for_frame (stage);
+
+  clutter_stage_get_statistics (CLUTTER_STAGE (stage), &stats);
+
+  if (g_test_verbose ())
+    g_print ("changing %d children of a source with %d clones: "
+             "%u redraws queued\n",
+             CLONE_SOURCE_CHILDREN,
+             N_CLONES,
+             stats.n_queued_redraws);
+
+  g_assert_cmpuint (stats.n_queued_redraws, <=, CLONE_REDRAW_BUDGET);
+
+  for (i = 0; i < N_CLONES; i++)
+    clutter_actor_destroy (clones[i]);
+
+  clutter_actor_destroy (source);
+}
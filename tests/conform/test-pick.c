@@ -22,6 +22,7 @@ static gboolean
 on_timeout (State *state)
 {
   int test_num = 0;
+  int geometric;
   int y, x;
   ClutterActor *over_actor = NULL;
 
@@ -34,90 +35,154 @@ on_timeout (State *state)
   clutter_stage_get_actor_at_pos (CLUTTER_STAGE (state->stage),
                                   CLUTTER_PICK_REACTIVE, 10, 10);
 
-  for (test_num = 0; test_num < 3; test_num++)
+  for (geometric = 0; geometric < 2; geometric++)
     {
-      if (test_num == 0)
-        {
-          if (g_test_verbose ())
-            g_print ("No covering actor:\n");
-        }
-      if (test_num == 1)
-        {
-          static const ClutterColor red = { 0xff, 0x00, 0x00, 0xff };
-          /* Create an actor that covers the whole stage but that
-             isn't visible so it shouldn't affect the picking */
-          over_actor = clutter_rectangle_new_with_color (&red);
-          clutter_actor_set_size (over_actor, STAGE_WIDTH, STAGE_HEIGHT);
-          clutter_container_add (CLUTTER_CONTAINER (state->stage),
-                                 over_actor, NULL);
-          clutter_actor_hide (over_actor);
-
-          if (g_test_verbose ())
-            g_print ("Invisible covering actor:\n");
-        }
-      else if (test_num == 2)
+      /* run the same tests with a pick render and with the
+       * geometric pick, which should give the same results */
+      clutter_stage_set_geometric_picking (CLUTTER_STAGE (state->stage),
+                                           geometric);
+
+      if (g_test_verbose ())
+        g_print ("%s picking:\n", geometric ? "Geometric" : "Pick buffer");
+
+      for (test_num = 0; test_num < 3; test_num++)
         {
-          /* Make the actor visible but set a clip so that only some
-             of the actors are accessible */
-          clutter_actor_show (over_actor);
-          clutter_actor_set_clip (over_actor,
-                                  state->actor_width * 2,
-                                  state->actor_height * 2,
-                                  state->actor_width * (ACTORS_X - 4),
-                                  state->actor_height * (ACTORS_Y - 4));
-
-          if (g_test_verbose ())
-            g_print ("Clipped covering actor:\n");
-        }
+          if (test_num == 0)
+            {
+              if (g_test_verbose ())
+                g_print ("No covering actor:\n");
+            }
+          if (test_num == 1)
+            {
+              static const ClutterColor red = { 0xff, 0x00, 0x00, 0xff };
+              /* Create an actor that covers the whole stage but that
+                 isn't visible so it shouldn't affect the picking */
+              over_actor = clutter_rectangle_new_with_color (&red);
+              clutter_actor_set_size (over_actor, STAGE_WIDTH, STAGE_HEIGHT);
+              clutter_container_add (CLUTTER_CONTAINER (state->stage),
+                                     over_actor, NULL);
+              clutter_actor_hide (over_actor);
 
-      for (y = 0; y < ACTORS_Y; y++)
-        for (x = 0; x < ACTORS_X; x++)
-          {
-            gboolean pass = FALSE;
-            ClutterActor *actor
-              = clutter_stage_get_actor_at_pos (CLUTTER_STAGE (state->stage),
-                                                CLUTTER_PICK_ALL,
-                                                x * state->actor_width
-                                                + state->actor_width / 2,
-                                                y * state->actor_height
-                                                + state->actor_height / 2);
-
-            if (g_test_verbose ())
-              g_print ("% 3i,% 3i / %p -> ",
-                       x, y, state->actors[y * ACTORS_X + x]);
-
-            if (actor == NULL)
-              {
-                if (g_test_verbose ())
-                  g_print ("NULL:       FAIL\n");
-              }
-            else if (actor == over_actor)
-              {
-                if (test_num == 2
-                    && x >= 2 && x < ACTORS_X - 2
-                    && y >= 2 && y < ACTORS_Y - 2)
-                  pass = TRUE;
+              if (g_test_verbose ())
+                g_print ("Invisible covering actor:\n");
+            }
+          else if (test_num == 2)
+            {
+              /* Make the actor visible but set a clip so that only some
+                 of the actors are accessible */
+              clutter_actor_show (over_actor);
+              clutter_actor_set_clip (over_actor,
+                                      state->actor_width * 2,
+                                      state->actor_height * 2,
+                                      state->actor_width * (ACTORS_X - 4),
+                                      state->actor_height * (ACTORS_Y - 4));
 
-                if (g_test_verbose ())
-                  g_print ("over_actor: %s\n", pass ? "pass" : "FAIL");
-              }
-            else
+              if (g_test_verbose ())
+                g_print ("Clipped covering actor:\n");
+            }
+
+          for (y = 0; y < ACTORS_Y; y++)
+            for (x = 0; x < ACTORS_X; x++)
               {
-                if (actor == state->actors[y * ACTORS_X + x]
-                    && (test_num != 2
-                        || x < 2 || x >= ACTORS_X - 2
-                        || y < 2 || y >= ACTORS_Y - 2))
-                  pass = TRUE;
+                gboolean pass = FALSE;
+                ClutterActor *actor
+                  = clutter_stage_get_actor_at_pos (CLUTTER_STAGE (state->stage),
+                                                    CLUTTER_PICK_ALL,
+                                                    x * state->actor_width
+                                                    + state->actor_width / 2,
+                                                    y * state->actor_height
+                                                    + state->actor_height / 2);
 
                 if (g_test_verbose ())
-                  g_print ("%p: %s\n", actor, pass ? "pass" : "FAIL");
+                  g_print ("% 3i,% 3i / %p -> ",
+                           x, y, state->actors[y * ACTORS_X + x]);
+
+                if (actor == NULL)
+                  {
+                    if (g_test_verbose ())
+                      g_print ("NULL:       FAIL\n");
+                  }
+                else if (actor == over_actor)
+                  {
+                    if (test_num == 2
+                        && x >= 2 && x < ACTORS_X - 2
+                        && y >= 2 && y < ACTORS_Y - 2)
+                      pass = TRUE;
+
+                    if (g_test_verbose ())
+                      g_print ("over_actor: %s\n", pass ? "pass" : "FAIL");
+                  }
+                else
+                  {
+                    if (actor == state->actors[y * ACTORS_X + x]
+                        && (test_num != 2
+                            || x < 2 || x >= ACTORS_X - 2
+                            || y < 2 || y >= ACTORS_Y - 2))
+                      pass = TRUE;
+
+                    if (g_test_verbose ())
+                      g_print ("%p: %s\n", actor, pass ? "pass" : "FAIL");
+                  }
+
+                if (!pass)
+                  state->pass = FALSE;
               }
+        }
+
+      clutter_actor_destroy (over_actor);
+      over_actor = NULL;
+    }
+
+  /* Move an actor on top of another one without letting the stage
+     repaint, so that the stage only knows where the actor was the last
+     time it was painted */
+  for (geometric = 0; geometric < 2; geometric++)
+    {
+      ClutterActor *moved = state->actors[geometric];
+      int target = ACTORS_X * ACTORS_Y - 1 - geometric;
+      ClutterActor *actor;
+
+      clutter_stage_set_geometric_picking (CLUTTER_STAGE (state->stage),
+                                           geometric);
+
+      x = target % ACTORS_X;
+      y = target / ACTORS_X;
+
+      clutter_actor_set_position (moved,
+                                  x * state->actor_width,
+                                  y * state->actor_height);
+      clutter_actor_raise_top (moved);
+
+      actor = clutter_stage_get_actor_at_pos (CLUTTER_STAGE (state->stage),
+                                              CLUTTER_PICK_ALL,
+                                              x * state->actor_width
+                                              + state->actor_width / 2,
+                                              y * state->actor_height
+                                              + state->actor_height / 2);
 
-            if (!pass)
-              state->pass = FALSE;
-          }
+      if (g_test_verbose ())
+        g_print ("Moved actor %p -> %p: %s\n",
+                 moved, actor, actor == moved ? "pass" : "FAIL");
+
+      if (actor != moved)
+        state->pass = FALSE;
+
+      actor = clutter_stage_get_actor_at_pos (CLUTTER_STAGE (state->stage),
+                                              CLUTTER_PICK_ALL,
+                                              geometric * state->actor_width
+                                              + state->actor_width / 2,
+                                              state->actor_height / 2);
+
+      if (g_test_verbose ())
+        g_print ("Old position of moved actor -> %p: %s\n",
+                 actor, actor == state->stage ? "pass" : "FAIL");
+
+      if (actor != state->stage)
+        state->pass = FALSE;
     }
 
+  clutter_stage_set_geometric_picking (CLUTTER_STAGE (state->stage), FALSE);
+
   clutter_main_quit ();
 
   return FALSE;
@@ -165,3 +230,324 @@ actor_picking (void)
 
   g_assert (state.pass);
 }
+
+typedef struct _AsyncState
+{
+  ClutterActor *stage;
+  ClutterActor *actor;
+  ClutterActor *picked;
+  gboolean destroyed;
+} AsyncState;
+
+static void
+on_async_pick (ClutterStage *stage,
+               ClutterActor *actor,
+               gpointer      data)
+{
+  AsyncState *state = data;
+
+  state->picked = actor;
+
+  clutter_main_quit ();
+}
+
+static void
+on_async_pick_destroy (gpointer data)
+{
+  AsyncState *state = data;
+
+  state->destroyed = TRUE;
+}
+
+static gboolean
+on_async_timeout (AsyncState *state)
+{
+  clutter_stage_get_actor_at_pos_async (CLUTTER_STAGE (state->stage),
+                                        CLUTTER_PICK_ALL,
+                                        75, 75,
+                                        on_async_pick,
+                                        state,
+                                        on_async_pick_destroy);
+
+  /* the result is not delivered before the next update */
+  g_assert (state->picked == NULL);
+
+  return FALSE;
+}
+
+void
+actor_picking_async (void)
+{
+  static const ClutterColor red = { 0xff, 0x00, 0x00, 0xff };
+  AsyncState state = { NULL, };
+  ClutterActor *actor;
+
+  state.stage = clutter_stage_get_default ();
+
+  state.actor = clutter_rectangle_new_with_color (&red);
+  clutter_actor_set_position (state.actor, 50, 50);
+  clutter_actor_set_size (state.actor, 50, 50);
+  clutter_container_add_actor (CLUTTER_CONTAINER (state.stage), state.actor);
+
+  clutter_actor_show (state.stage);
+
+  g_idle_add ((GSourceFunc) on_async_timeout, &state);
+
+  clutter_main ();
+
+  g_assert (state.picked == state.actor);
+  g_assert (state.destroyed);
+
+  /* the scene did not change, so the result should be the same */
+  actor = clutter_stage_get_actor_at_pos (CLUTTER_STAGE (state.stage),
+                                          CLUTTER_PICK_ALL,
+                                          75, 75);
+  g_assert (actor == state.actor);
+
+  actor = clutter_stage_get_actor_at_pos (CLUTTER_STAGE (state.stage),
+                                          CLUTTER_PICK_ALL,
+                                          10, 10);
+  g_assert (actor == state.stage);
+
+  clutter_actor_destroy (state.actor);
+}
+
+void
+actor_picking_reactive (void)
+{
+  static const ClutterColor red = { 0xff, 0x00, 0x00, 0xff };
+  ClutterActor *stage, *outer, *inner, *rect, *actor;
+
+  stage = clutter_stage_get_default ();
+
+  outer = clutter_group_new ();
+  clutter_container_add_actor (CLUTTER_CONTAINER (stage), outer);
+
+  inner = clutter_group_new ();
+  clutter_container_add_actor (CLUTTER_CONTAINER (outer), inner);
+
+  rect = clutter_rectangle_new_with_color (&red);
+  clutter_actor_set_position (rect, 50, 50);
+  clutter_actor_set_size (rect, 50, 50);
+  clutter_container_add_actor (CLUTTER_CONTAINER (inner), rect);
+
+  clutter_actor_show (stage);
+
+  /* nothing inside the groups is reactive */
+  actor = clutter_stage_get_actor_at_pos (CLUTTER_STAGE (stage),
+                                          CLUTTER_PICK_REACTIVE,
+                                          75, 75);
+  g_assert (actor == stage);
+
+  actor = clutter_stage_get_actor_at_pos (CLUTTER_STAGE (stage),
+                                          CLUTTER_PICK_ALL,
+                                          75, 75);
+  g_assert (actor == rect);
+
+  /* a reactive descendant makes the whole sub-tree pickable */
+  clutter_actor_set_reactive (rect, TRUE);
+
+  actor = clutter_stage_get_actor_at_pos (CLUTTER_STAGE (stage),
+                                          CLUTTER_PICK_REACTIVE,
+                                          75, 75);
+  g_assert (actor == rect);
+
+  /* the reactive descendants move along with their parent */
+  clutter_actor_reparent (inner, stage);
+
+  actor = clutter_stage_get_actor_at_pos (CLUTTER_STAGE (stage),
+                                          CLUTTER_PICK_REACTIVE,
+                                          75, 75);
+  g_assert (actor == rect);
+
+  clutter_actor_reparent (inner, outer);
+  clutter_actor_set_reactive (rect, FALSE);
+
+  actor = clutter_stage_get_actor_at_pos (CLUTTER_STAGE (stage),
+                                          CLUTTER_PICK_REACTIVE,
+                                          75, 75);
+  g_assert (actor == stage);
+
+  clutter_actor_destroy (outer);
+}
+
+typedef struct _RetainedState
+{
+  ClutterActor *stage;
+  ClutterActor *still;
+  ClutterActor *moving;
+  int step;
+} RetainedState;
+
+static void
+check_pick (RetainedState *state,
+            int            x,
+            int            y,
+            ClutterActor  *expected)
+{
+  ClutterActor *actor;
+
+  actor = clutter_stage_get_actor_at_pos (CLUTTER_STAGE (state->stage),
+                                          CLUTTER_PICK_ALL,
+                                          x, y);
+
+  if (g_test_verbose ())
+    g_print ("Step %d, %d,%d: %s\n",
+             state->step, x, y,
+             actor == expected ? "pass" : "FAIL");
+
+  g_assert (actor == expected);
+}
+
+static gboolean
+on_retained_timeout (RetainedState *state)
+{
+  switch (state->step)
+    {
+    case 0:
+      /* more than one pick in a frame keeps the pick buffer around */
+      check_pick (state, 25, 25, state->still);
+      check_pick (state, 125, 125, state->moving);
+      check_pick (state, 300, 300, state->stage);
+
+      clutter_actor_set_position (state->moving, 200, 200);
+      break;
+
+    case 1:
+      /* the picks outside of the area damaged by the moving actor
+       * reuse the buffer, the others paint the damaged area again */
+      check_pick (state, 25, 25, state->still);
+      check_pick (state, 125, 125, state->stage);
+      check_pick (state, 225, 225, state->moving);
+      check_pick (state, 25, 25, state->still);
+
+      clutter_actor_hide (state->moving);
+      break;
+
+    case 2:
+      check_pick (state, 25, 25, state->still);
+      check_pick (state, 225, 225, state->stage);
+      check_pick (state, 125, 125, state->stage);
+
+      clutter_main_quit ();
+      return FALSE;
+    }
+
+  state->step += 1;
+
+  return TRUE;
+}
+
+void
+actor_picking_retained (void)
+{
+  static const ClutterColor red = { 0xff, 0x00, 0x00, 0xff };
+  RetainedState state = { NULL, };
+  gboolean geometric;
+
+  state.stage = clutter_stage_get_default ();
+
+  /* the geometric pick would not render anything */
+  geometric = clutter_stage_get_geometric_picking (CLUTTER_STAGE (state.stage));
+  clutter_stage_set_geometric_picking (CLUTTER_STAGE (state.stage), FALSE);
+
+  state.still = clutter_rectangle_new_with_color (&red);
+  clutter_actor_set_size (state.still, 50, 50);
+  clutter_container_add_actor (CLUTTER_CONTAINER (state.stage), state.still);
+
+  state.moving = clutter_rectangle_new_with_color (&red);
+  clutter_actor_set_position (state.moving, 100, 100);
+  clutter_actor_set_size (state.moving, 50, 50);
+  clutter_container_add_actor (CLUTTER_CONTAINER (state.stage), state.moving);
+
+  clutter_actor_show (state.stage);
+
+  /* each step runs after the stage painted the changes of the
+   * previous one */
+  g_timeout_add (100, (GSourceFunc) on_retained_timeout, &state);
+
+  clutter_main ();
+
+  clutter_stage_set_geometric_picking (CLUTTER_STAGE (state.stage),
+                                       geometric);
+
+  clutter_actor_destroy (state.still);
+  clutter_actor_destroy (state.moving);
+}
+
+void
+actor_picking_alpha (void)
+{
+  /* the left column is opaque, the right one is transparent */
+  static const guchar data[] = {
+    0xff, 0x00, 0x00, 0xff,   0xff, 0x00, 0x00, 0x00,
+    0xff, 0x00, 0x00, 0xff,   0xff, 0x00, 0x00, 0x00
+  };
+  static const guchar opaque[] = {
+    0x00, 0xff, 0x00, 0xff,
+    0x00, 0xff, 0x00, 0xff
+  };
+  ClutterActor *stage, *texture, *actor;
+  gboolean geometric;
+  int i;
+
+  stage = clutter_stage_get_default ();
+  geometric = clutter_stage_get_geometric_picking (CLUTTER_STAGE (stage));
+
+  texture = clutter_texture_new ();
+  clutter_texture_set_pick_with_alpha (CLUTTER_TEXTURE (texture), TRUE);
+  clutter_texture_set_from_rgb_data (CLUTTER_TEXTURE (texture),
+                                     data, TRUE,
+                                     2, 2, 8, 4,
+                                     CLUTTER_TEXTURE_NONE,
+                                     NULL);
+  clutter_actor_set_size (texture, 100, 100);
+  clutter_container_add_actor (CLUTTER_CONTAINER (stage), texture);
+
+  clutter_actor_show (stage);
+
+  for (i = 0; i < 2; i++)
+    {
+      /* the pick render and the alpha mask agree */
+      clutter_stage_set_geometric_picking (CLUTTER_STAGE (stage), i);
+
+      actor = clutter_stage_get_actor_at_pos (CLUTTER_STAGE (stage),
+                                              CLUTTER_PICK_ALL,
+                                              25, 50);
+      g_assert (actor == texture);
+
+      actor = clutter_stage_get_actor_at_pos (CLUTTER_STAGE (stage),
+                                              CLUTTER_PICK_ALL,
+                                              75, 50);
+      g_assert (actor == stage);
+    }
+
+  /* updating the texture updates the mask */
+  clutter_texture_set_area_from_rgb_data (CLUTTER_TEXTURE (texture),
+                                          opaque, TRUE,
+                                          1, 0, 1, 2, 4, 4,
+                                          CLUTTER_TEXTURE_NONE,
+                                          NULL);
+
+  actor = clutter_stage_get_actor_at_pos (CLUTTER_STAGE (stage),
+                                          CLUTTER_PICK_ALL,
+                                          75, 50);
+  g_assert (actor == texture);
+
+  /* without pick-with-alpha the whole allocation is picked */
+  clutter_texture_set_area_from_rgb_data (CLUTTER_TEXTURE (texture),
+                                          data + 4, TRUE,
+                                          1, 0, 1, 2, 8, 4,
+                                          CLUTTER_TEXTURE_NONE,
+                                          NULL);
+  clutter_texture_set_pick_with_alpha (CLUTTER_TEXTURE (texture), FALSE);
+
+  actor = clutter_stage_get_actor_at_pos (CLUTTER_STAGE (stage),
+                                          CLUTTER_PICK_ALL,
+                                          75, 50);
+  g_assert (actor == texture);
+
+  clutter_stage_set_geometric_picking (CLUTTER_STAGE (stage), geometric);
+
+  clutter_actor_destroy (texture);
+}
@@ -53,6 +53,7 @@ test_score (TestConformSimpleFixture *fixture,
   ClutterTimeline *timeline_4;
   ClutterTimeline *timeline_5;
   GSList *timelines;
+  gulong id_3, id_4;
 
   /* this is necessary to make the master clock spin */
   (void) clutter_stage_get_default ();
@@ -99,8 +100,8 @@ test_score (TestConformSimpleFixture *fixture,
 
   clutter_score_append (score, NULL,       timeline_1);
   clutter_score_append (score, timeline_1, timeline_2);
-  clutter_score_append (score, timeline_1, timeline_3);
-  clutter_score_append (score, timeline_3, timeline_4);
+  id_3 = clutter_score_append (score, timeline_1, timeline_3);
+  id_4 = clutter_score_append (score, timeline_3, timeline_4);
 
   clutter_score_append_at_marker (score, timeline_2, "foo", timeline_5);
 
@@ -108,6 +109,21 @@ test_score (TestConformSimpleFixture *fixture,
   g_assert (5 == g_slist_length (timelines));
   g_slist_free (timelines);
 
+  g_assert (clutter_score_get_timeline (score, id_3) == timeline_3);
+  g_assert (clutter_score_get_timeline (score, id_4) == timeline_4);
+
+  /* removing a timeline removes the timelines appended to it */
+  clutter_score_remove (score, id_3);
+  g_assert (clutter_score_get_timeline (score, id_3) == NULL);
+  g_assert (clutter_score_get_timeline (score, id_4) == NULL);
+
+  timelines = clutter_score_list_timelines (score);
+  g_assert (3 == g_slist_length (timelines));
+  g_slist_free (timelines);
+
+  clutter_score_append (score, timeline_1, timeline_3);
+  clutter_score_append (score, timeline_3, timeline_4);
+
   clutter_score_start (score);
 
   g_object_unref (timeline_1);
@@ -1,5 +1,8 @@
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+
+#include <glib/gstdio.h>
 
 #undef CLUTTER_DISABLE_DEPRECATED
 #include <clutter/clutter.h>
@@ -400,3 +403,230 @@ test_script_layout_property (TestConformSimpleFixture *fixture,
 
   g_object_unref (script);
 }
+
+void
+test_script_compiled (TestConformSimpleFixture *fixture,
+                      gconstpointer dummy)
+{
+  ClutterScript *script = clutter_script_new ();
+  GObject *container, *actor, *behaviour;
+  GError *error = NULL;
+  ClutterAlpha *alpha;
+  gboolean focus_ret;
+  gchar *test_file, *compiled_file;
+  gint fd;
+
+  fd = g_file_open_tmp ("test-script-XXXXXX.cscript", &compiled_file, &error);
+  g_assert_no_error (error);
+  close (fd);
+
+  test_file = clutter_test_get_data_file ("test-script-child.json");
+  clutter_script_compile_file (test_file, compiled_file, &error);
+  g_assert_no_error (error);
+
+  g_assert_cmpint (clutter_script_load_from_compiled_file (script,
+                                                           compiled_file,
+                                                           &error), >, 0);
+  g_assert_no_error (error);
+
+  container = actor = NULL;
+  clutter_script_get_objects (script,
+                              "test-group", &container,
+                              "test-rect-1", &actor,
+                              NULL);
+  g_assert (TEST_IS_GROUP (container));
+  g_assert (CLUTTER_IS_RECTANGLE (actor));
+  g_assert (clutter_actor_get_parent (CLUTTER_ACTOR (actor)) ==
+            CLUTTER_ACTOR (container));
+  g_assert_cmpfloat (clutter_actor_get_width (CLUTTER_ACTOR (actor)), ==, 100.0);
+
+  focus_ret = FALSE;
+  clutter_container_child_get (CLUTTER_CONTAINER (container),
+                               CLUTTER_ACTOR (actor),
+                               "focus", &focus_ret,
+                               NULL);
+  g_assert (focus_ret);
+
+  g_free (test_file);
+
+  /* implicit objects get a fake id at load time */
+  test_file = clutter_test_get_data_file ("test-script-implicit-alpha.json");
+  clutter_script_compile_file (test_file, compiled_file, &error);
+  g_assert_no_error (error);
+
+  clutter_script_load_from_compiled_file (script, compiled_file, &error);
+  g_assert_no_error (error);
+
+  behaviour = clutter_script_get_object (script, "test");
+  g_assert (CLUTTER_IS_BEHAVIOUR (behaviour));
+
+  alpha = clutter_behaviour_get_alpha (CLUTTER_BEHAVIOUR (behaviour));
+  g_assert (CLUTTER_IS_ALPHA (alpha));
+  g_assert_cmpint (clutter_alpha_get_mode (alpha), ==, CLUTTER_EASE_OUT_CIRC);
+  g_assert_cmpint (clutter_timeline_get_duration (clutter_alpha_get_timeline (alpha)),
+                   ==,
+                   500);
+
+  /* truncated data must be rejected */
+  g_file_set_contents (compiled_file, "CLTRSCPT", 8, NULL);
+  g_assert_cmpint (clutter_script_load_from_compiled_file (script,
+                                                           compiled_file,
+                                                           &error), ==, 0);
+  g_assert_error (error, CLUTTER_SCRIPT_ERROR,
+                  CLUTTER_SCRIPT_ERROR_INVALID_COMPILED_DATA);
+  g_clear_error (&error);
+
+  g_unlink (compiled_file);
+
+  g_object_unref (script);
+  g_free (compiled_file);
+  g_free (test_file);
+}
+
+void
+test_script_lazy (TestConformSimpleFixture *fixture,
+                  gconstpointer dummy)
+{
+  ClutterScript *script = clutter_script_new ();
+  GObject *container, *actor;
+  GError *error = NULL;
+  gboolean focus_ret;
+  gchar *test_file;
+
+  clutter_script_set_lazy_construction (script, TRUE);
+  g_assert (clutter_script_get_lazy_construction (script));
+
+  test_file = clutter_test_get_data_file ("test-script-child.json");
+  clutter_script_load_from_file (script, test_file, &error);
+  g_assert_no_error (error);
+
+  /* retrieving a child first does not construct its container */
+  actor = clutter_script_get_object (script, "test-rect-2");
+  g_assert (CLUTTER_IS_RECTANGLE (actor));
+  g_assert (clutter_actor_get_parent (CLUTTER_ACTOR (actor)) == NULL);
+
+  /* retrieving the container realizes and packs its children */
+  container = clutter_script_get_object (script, "test-group");
+  g_assert (TEST_IS_GROUP (container));
+  g_assert (clutter_actor_get_parent (CLUTTER_ACTOR (actor)) ==
+            CLUTTER_ACTOR (container));
+
+  actor = clutter_script_get_object (script, "test-rect-1");
+  g_assert (CLUTTER_IS_RECTANGLE (actor));
+  g_assert (clutter_actor_get_parent (CLUTTER_ACTOR (actor)) ==
+            CLUTTER_ACTOR (container));
+  g_assert_cmpfloat (clutter_actor_get_width (CLUTTER_ACTOR (actor)), ==, 100.0);
+
+  focus_ret = FALSE;
+  clutter_container_child_get (CLUTTER_CONTAINER (container),
+                               CLUTTER_ACTOR (actor),
+                               "focus", &focus_ret,
+                               NULL);
+  g_assert (focus_ret);
+
+  g_object_unref (script);
+  g_free (test_file);
+}
+
+void
+test_script_stream (TestConformSimpleFixture *fixture,
+                    gconstpointer dummy)
+{
+  ClutterScript *script = clutter_script_new ();
+  GObject *group, *rect_1, *rect_2;
+  GError *error = NULL;
+  gchar *test_file;
+  gint fd;
+
+  test_file = clutter_test_get_data_file ("test-script-stream.json");
+  clutter_script_load_from_file (script, test_file, &error);
+  g_assert_no_error (error);
+  g_free (test_file);
+
+  group = rect_1 = rect_2 = NULL;
+  clutter_script_get_objects (script,
+                              "stream-group", &group,
+                              "stream-rect-1", &rect_1,
+                              "stream-rect-2", &rect_2,
+                              NULL);
+  g_assert (CLUTTER_IS_GROUP (group));
+  g_assert (CLUTTER_IS_RECTANGLE (rect_1));
+  g_assert (CLUTTER_IS_RECTANGLE (rect_2));
+
+  g_assert (clutter_actor_get_parent (CLUTTER_ACTOR (rect_1)) ==
+            CLUTTER_ACTOR (group));
+  g_assert (clutter_actor_get_parent (CLUTTER_ACTOR (rect_2)) ==
+            CLUTTER_ACTOR (group));
+  g_assert_cmpstr (clutter_actor_get_name (CLUTTER_ACTOR (rect_1)),
+                   ==,
+                   "a ] \"tricky\" , { name");
+  g_assert_cmpfloat (clutter_actor_get_width (CLUTTER_ACTOR (rect_2)), ==, 100.0);
+
+  /* a missing separator is still an error */
+  fd = g_file_open_tmp ("test-script-XXXXXX.json", &test_file, &error);
+  g_assert_no_error (error);
+  close (fd);
+
+  g_file_set_contents (test_file,
+                       "[ { \"id\" : \"a\", \"type\" : \"ClutterRectangle\" }"
+                       "  { \"id\" : \"b\", \"type\" : \"ClutterRectangle\" } ]",
+                       -1,
+                       NULL);
+  g_assert_cmpint (clutter_script_load_from_file (script, test_file, &error),
+                   ==,
+                   0);
+  g_assert_error (error, JSON_PARSER_ERROR, JSON_PARSER_ERROR_PARSE);
+  g_clear_error (&error);
+
+  g_unlink (test_file);
+  g_free (test_file);
+
+  g_object_unref (script);
+}
+
+static void
+on_name_changed (GObject    *gobject,
+                 GParamSpec *pspec,
+                 gpointer    user_data)
+{
+  gint *n_calls = user_data;
+
+  *n_calls += 1;
+}
+
+void
+test_script_callbacks (TestConformSimpleFixture *fixture,
+                       gconstpointer dummy)
+{
+  static const ClutterScriptCallback callbacks[] = {
+    /* not a valid symbol name, so it cannot come from the symbol table */
+    { "on-name-changed", G_CALLBACK (on_name_changed) },
+    { NULL, NULL }
+  };
+  static const gchar *test_ui =
+    "{"
+    "  \"id\" : \"callback-rect\","
+    "  \"type\" : \"ClutterRectangle\","
+    "  \"signals\" : ["
+    "    { \"name\" : \"notify::name\", \"handler\" : \"on-name-changed\" }"
+    "  ]"
+    "}";
+  ClutterScript *script = clutter_script_new ();
+  GObject *actor;
+  GError *error = NULL;
+  gint n_calls = 0;
+
+  clutter_script_load_from_data (script, test_ui, -1, &error);
+  g_assert_no_error (error);
+
+  clutter_script_add_callbacks (script, callbacks, -1);
+  clutter_script_connect_signals (script, &n_calls);
+
+  actor = clutter_script_get_object (script, "callback-rect");
+  g_assert (CLUTTER_IS_RECTANGLE (actor));
+
+  clutter_actor_set_name (CLUTTER_ACTOR (actor), "callback");
+  g_assert_cmpint (n_calls, ==, 1);
+
+  g_object_unref (script);
+}
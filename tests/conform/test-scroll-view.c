@@ -0,0 +1,101 @@
+#include <clutter/clutter.h>
+
+#include "test-conform-common.h"
+
+typedef struct
+{
+  ClutterActor *stage;
+
+  guint n_allocations;
+} ScrollViewData;
+
+static void
+on_allocation_changed (ClutterActor           *actor,
+                       const ClutterActorBox  *box,
+                       ClutterAllocationFlags  flags,
+                       ScrollViewData         *data)
+{
+  data->n_allocations += 1;
+}
+
+static void
+run_frames (ScrollViewData *data,
+            gint            n_frames)
+{
+  GMainLoop *main_loop = g_main_loop_new (NULL, TRUE);
+  guint paint_handler;
+  gint i;
+
+  paint_handler = g_signal_connect_data (data->stage,
+                                         "paint",
+                                         G_CALLBACK (g_main_loop_quit),
+                                         main_loop,
+                                         NULL,
+                                         G_CONNECT_SWAPPED | G_CONNECT_AFTER);
+
+  for (i = 0; i < n_frames; i++)
+    {
+      clutter_actor_queue_redraw (data->stage);
+      g_main_loop_run (main_loop);
+    }
+
+  g_signal_handler_disconnect (data->stage, paint_handler);
+  g_main_loop_unref (main_loop);
+}
+
+void
+scroll_view_translate (TestConformSimpleFixture *fixture,
+                       gconstpointer             test_data)
+{
+  ScrollViewData data = { NULL, };
+  ClutterActor *view, *child;
+  ClutterActorBox box;
+  gfloat x, y;
+
+  data.stage = clutter_stage_get_default ();
+
+  child = clutter_rectangle_new ();
+  clutter_actor_set_size (child, 1000, 2000);
+  g_signal_connect (child, "allocation-changed",
+                    G_CALLBACK (on_allocation_changed),
+                    &data);
+
+  view = clutter_scroll_view_new ();
+  clutter_actor_set_size (view, 100, 200);
+  clutter_scroll_view_set_child (CLUTTER_SCROLL_VIEW (view), child);
+  clutter_container_add_actor (CLUTTER_CONTAINER (data.stage), view);
+
+  clutter_actor_show (data.stage);
+  run_frames (&data, 2);
+
+  g_assert_cmpint (data.n_allocations, >, 0);
+  g_assert (clutter_actor_get_clip_to_allocation (view));
+
+  /* scrolling translates the child without allocating it again */
+  data.n_allocations = 0;
+  clutter_scroll_view_scroll_to_point (CLUTTER_SCROLL_VIEW (view), 50, 300);
+  run_frames (&data, 2);
+
+  g_assert_cmpint (data.n_allocations, ==, 0);
+
+  clutter_actor_get_translation (child, &x, &y);
+  g_assert_cmpfloat (x, ==, -50);
+  g_assert_cmpfloat (y, ==, -300);
+
+  clutter_scroll_view_get_visible_area (CLUTTER_SCROLL_VIEW (view), &box);
+  g_assert_cmpfloat (box.x1, ==, 50);
+  g_assert_cmpfloat (box.y1, ==, 300);
+  g_assert_cmpfloat (box.x2, ==, 150);
+  g_assert_cmpfloat (box.y2, ==, 500);
+
+  /* the scroll point is clamped to the size of the child */
+  clutter_scroll_view_scroll_to_point (CLUTTER_SCROLL_VIEW (view), -10, 5000);
+  clutter_scroll_view_get_scroll_point (CLUTTER_SCROLL_VIEW (view), &x, &y);
+  g_assert_cmpfloat (x, ==, 0);
+  g_assert_cmpfloat (y, ==, 1800);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+
+  clutter_actor_destroy (view);
+}
@@ -0,0 +1,149 @@
+#include <clutter/clutter.h>
+
+#include "test-conform-common.h"
+
+#define RECT_SIZE       50
+
+static const gchar *red_source =
+  "uniform float red;\n"
+  "void main ()\n"
+  "{\n"
+  "  gl_FragColor = vec4 (red, 0.0, 0.0, 1.0);\n"
+  "}\n";
+
+static const gchar *green_source =
+  "uniform float green;\n"
+  "void main ()\n"
+  "{\n"
+  "  gl_FragColor = vec4 (0.0, green, 0.0, 1.0);\n"
+  "}\n";
+
+typedef struct
+{
+  ClutterActor *stage;
+  ClutterActor *rect_a;
+  ClutterActor *rect_b;
+} Data;
+
+static void
+verify_pixel (Data  *data,
+              gint   x,
+              gint   y,
+              guint8 r,
+              guint8 g,
+              guint8 b)
+{
+  guchar *pixel;
+
+  pixel = clutter_stage_read_pixels (CLUTTER_STAGE (data->stage),
+                                     x, y,
+                                     1, 1);
+
+  if (g_test_verbose ())
+    g_print ("At (%d, %d): got [ %d, %d, %d ], expected [ %d, %d, %d ]\n",
+             x, y,
+             pixel[0], pixel[1], pixel[2],
+             r, g, b);
+
+  g_assert_cmpint (ABS ((int) pixel[0] - r), <=, 2);
+  g_assert_cmpint (ABS ((int) pixel[1] - g), <=, 2);
+  g_assert_cmpint (ABS ((int) pixel[2] - b), <=, 2);
+
+  g_free (pixel);
+}
+
+static gboolean
+timeout_cb (gpointer user_data)
+{
+  Data *data = user_data;
+
+  /* the actors sharing the shader keep their own parameters */
+  verify_pixel (data, RECT_SIZE / 2, RECT_SIZE / 2, 0xff, 0x00, 0x00);
+  verify_pixel (data, RECT_SIZE * 3 / 2, RECT_SIZE / 2, 0x80, 0x00, 0x00);
+
+  /* changing a parameter of one actor does not affect the other */
+  clutter_actor_set_shader_param_float (data->rect_b, "red", 0.25);
+  verify_pixel (data, RECT_SIZE / 2, RECT_SIZE / 2, 0xff, 0x00, 0x00);
+  verify_pixel (data, RECT_SIZE * 3 / 2, RECT_SIZE / 2, 0x40, 0x00, 0x00);
+
+  clutter_main_quit ();
+
+  return FALSE;
+}
+
+void
+actor_shader_sharing (TestConformSimpleFixture *fixture,
+                      gconstpointer             test_data)
+{
+  ClutterColor stage_color = { 0x00, 0x00, 0x00, 0xff };
+  ClutterColor white = { 0xff, 0xff, 0xff, 0xff };
+  ClutterShader *shader_a, *shader_b, *shader_c;
+  Data data;
+
+  if (!clutter_feature_available (CLUTTER_FEATURE_SHADERS_GLSL))
+    {
+      if (g_test_verbose ())
+        g_print ("Skipping: GLSL is not supported\n");
+
+      return;
+    }
+
+  /* shaders using the same source share the same program */
+  shader_a = clutter_shader_new ();
+  clutter_shader_set_fragment_source (shader_a, red_source, -1);
+  g_assert (clutter_shader_compile (shader_a, NULL));
+
+  shader_b = clutter_shader_new ();
+  clutter_shader_set_fragment_source (shader_b, red_source, -1);
+  g_assert (clutter_shader_compile (shader_b, NULL));
+
+  shader_c = clutter_shader_new ();
+  clutter_shader_set_fragment_source (shader_c, green_source, -1);
+  g_assert (clutter_shader_compile (shader_c, NULL));
+
+  g_assert (clutter_shader_get_cogl_program (shader_a) ==
+            clutter_shader_get_cogl_program (shader_b));
+  g_assert (clutter_shader_get_cogl_program (shader_a) !=
+            clutter_shader_get_cogl_program (shader_c));
+
+  /* the program outlives the shaders it was compiled for */
+  clutter_shader_release (shader_a);
+  g_assert (!clutter_shader_is_compiled (shader_a));
+  g_assert (clutter_shader_is_compiled (shader_b));
+  g_assert (clutter_shader_get_cogl_program (shader_b) != COGL_INVALID_HANDLE);
+
+  g_object_unref (shader_a);
+  g_object_unref (shader_c);
+
+  data.stage = clutter_stage_get_default ();
+  clutter_stage_set_color (CLUTTER_STAGE (data.stage), &stage_color);
+
+  data.rect_a = clutter_rectangle_new_with_color (&white);
+  clutter_actor_set_size (data.rect_a, RECT_SIZE, RECT_SIZE);
+  clutter_actor_set_shader (data.rect_a, shader_b);
+  clutter_actor_set_shader_param_float (data.rect_a, "red", 1.0);
+  clutter_container_add_actor (CLUTTER_CONTAINER (data.stage), data.rect_a);
+
+  data.rect_b = clutter_rectangle_new_with_color (&white);
+  clutter_actor_set_size (data.rect_b, RECT_SIZE, RECT_SIZE);
+  clutter_actor_set_x (data.rect_b, RECT_SIZE);
+  clutter_actor_set_shader (data.rect_b, shader_b);
+  clutter_actor_set_shader_param_float (data.rect_b, "red", 0.5);
+  clutter_container_add_actor (CLUTTER_CONTAINER (data.stage), data.rect_b);
+
+  g_object_unref (shader_b);
+
+  clutter_actor_show (data.stage);
+
+  /* Start the test after a short delay to allow the stage to
+     render its initial frames without affecting the results */
+  g_timeout_add_full (G_PRIORITY_LOW, 250, timeout_cb, &data, NULL);
+
+  clutter_main ();
+
+  clutter_actor_destroy (data.rect_a);
+  clutter_actor_destroy (data.rect_b);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
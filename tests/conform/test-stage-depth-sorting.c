@@ -0,0 +1,134 @@
+#include <clutter/clutter.h>
+
+#include "test-conform-common.h"
+
+#define RECT_SIZE       100
+
+typedef struct
+{
+  ClutterActor *stage;
+  ClutterActor *group;
+} Data;
+
+/* redraws the stage and checks the color of the pixel at x, y */
+static void
+verify_pixel (Data  *data,
+              gint   x,
+              gint   y,
+              guint8 r,
+              guint8 g,
+              guint8 b)
+{
+  guchar *pixel;
+
+  pixel = clutter_stage_read_pixels (CLUTTER_STAGE (data->stage),
+                                     x, y,
+                                     1, 1);
+
+  if (g_test_verbose ())
+    g_print ("At (%d, %d): got [ %d, %d, %d ], expected [ %d, %d, %d ]\n",
+             x, y,
+             pixel[0], pixel[1], pixel[2],
+             r, g, b);
+
+  g_assert_cmpint (ABS ((int) pixel[0] - r), <=, 2);
+  g_assert_cmpint (ABS ((int) pixel[1] - g), <=, 2);
+  g_assert_cmpint (ABS ((int) pixel[2] - b), <=, 2);
+
+  g_free (pixel);
+}
+
+static void
+verify_scene (Data *data)
+{
+  /* the red rectangle, uncovered */
+  verify_pixel (data, 25, 25, 0xff, 0x00, 0x00);
+
+  /* the green rectangle, painted after the red one, is in front of
+   * it even where it is farther from the eye */
+  verify_pixel (data, 75, 75, 0x00, 0xff, 0x00);
+
+  /* the translucent blue rectangle is blended with the green one */
+  verify_pixel (data, 125, 125, 0x00, 0x7f, 0x80);
+
+  /* and with the stage */
+  verify_pixel (data, 175, 175, 0x00, 0x00, 0x80);
+}
+
+static gboolean
+timeout_cb (gpointer user_data)
+{
+  Data *data = user_data;
+
+  verify_scene (data);
+
+  clutter_stage_set_depth_sorting (CLUTTER_STAGE (data->stage), TRUE);
+  g_assert (clutter_stage_get_depth_sorting (CLUTTER_STAGE (data->stage)));
+
+  /* painting with the depth test gives the same result */
+  verify_scene (data);
+
+  /* moving the group towards the eye does not change the order */
+  clutter_actor_set_depth (data->group, 50);
+  verify_scene (data);
+
+  clutter_stage_set_depth_sorting (CLUTTER_STAGE (data->stage), FALSE);
+  verify_scene (data);
+
+  clutter_main_quit ();
+
+  return FALSE;
+}
+
+void
+stage_depth_sorting (TestConformSimpleFixture *fixture,
+                     gconstpointer             test_data)
+{
+  ClutterColor stage_color = { 0x00, 0x00, 0x00, 0xff };
+  ClutterColor red = { 0xff, 0x00, 0x00, 0xff };
+  ClutterColor green = { 0x00, 0xff, 0x00, 0xff };
+  ClutterColor blue = { 0x00, 0x00, 0xff, 0x80 };
+  ClutterActor *actor;
+  Data data;
+
+  data.stage = clutter_stage_get_default ();
+  clutter_stage_set_color (CLUTTER_STAGE (data.stage), &stage_color);
+
+  g_assert (!clutter_stage_get_depth_sorting (CLUTTER_STAGE (data.stage)));
+
+  data.group = clutter_group_new ();
+  clutter_container_add_actor (CLUTTER_CONTAINER (data.stage), data.group);
+
+  actor = clutter_rectangle_new_with_color (&red);
+  clutter_actor_set_size (actor, RECT_SIZE, RECT_SIZE);
+  clutter_container_add_actor (CLUTTER_CONTAINER (data.group), actor);
+
+  actor = clutter_rectangle_new_with_color (&green);
+  clutter_actor_set_size (actor, RECT_SIZE, RECT_SIZE);
+  clutter_actor_set_position (actor, RECT_SIZE / 2, RECT_SIZE / 2);
+  clutter_container_add_actor (CLUTTER_CONTAINER (data.group), actor);
+
+  /* the half of the green rectangle covering the red one is rotated
+   * away from the eye, behind the plane of the red rectangle */
+  clutter_actor_set_rotation (actor, CLUTTER_Y_AXIS, -30.0,
+                              RECT_SIZE / 2, 0, 0);
+
+  actor = clutter_rectangle_new_with_color (&blue);
+  clutter_actor_set_size (actor, RECT_SIZE, RECT_SIZE);
+  clutter_actor_set_position (actor, RECT_SIZE, RECT_SIZE);
+  clutter_container_add_actor (CLUTTER_CONTAINER (data.stage), actor);
+
+  clutter_actor_show (data.stage);
+
+  /* Start the test after a short delay to allow the stage to
+     render its initial frames without affecting the results */
+  g_timeout_add_full (G_PRIORITY_LOW, 250, timeout_cb, &data, NULL);
+
+  clutter_main ();
+
+  clutter_actor_destroy (data.group);
+  clutter_actor_destroy (actor);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
@@ -0,0 +1,109 @@
+#include <string.h>
+#include <clutter/clutter.h>
+
+#include "test-conform-common.h"
+
+typedef struct
+{
+  ClutterActor *stage;
+  ClutterActor *rect;
+
+  gboolean changed;
+  gboolean found;
+} Data;
+
+static gboolean
+check_causes_cb (gpointer user_data)
+{
+  Data *data = user_data;
+  const ClutterStageRedrawCause *causes;
+  guint n_causes, i;
+
+  causes = clutter_stage_get_redraw_causes (CLUTTER_STAGE (data->stage),
+                                            &n_causes);
+
+  for (i = 0; i < n_causes; i++)
+    {
+      if (g_test_verbose ())
+        g_print ("%s '%s': %u redraws, %u relayouts by %s\n",
+                 causes[i].actor_type,
+                 causes[i].actor_name != NULL ? causes[i].actor_name : "",
+                 causes[i].n_redraws,
+                 causes[i].n_relayouts,
+                 causes[i].cause);
+
+      if (causes[i].actor_name != NULL &&
+          strcmp (causes[i].actor_name, "redraw-cause") == 0)
+        {
+          g_assert_cmpstr (causes[i].actor_type, ==, "ClutterRectangle");
+          g_assert_cmpuint (causes[i].n_redraws, >, 0);
+          g_assert (causes[i].cause != NULL);
+
+          data->found = TRUE;
+        }
+    }
+
+  clutter_main_quit ();
+
+  return FALSE;
+}
+
+static void
+on_paint (ClutterActor *stage,
+          Data         *data)
+{
+  /* the causes are available once the frame is complete */
+  if (data->changed)
+    g_idle_add (check_causes_cb, data);
+}
+
+static gboolean
+change_cb (gpointer user_data)
+{
+  Data *data = user_data;
+
+  clutter_actor_set_opacity (data->rect, 128);
+  data->changed = TRUE;
+
+  return FALSE;
+}
+
+void
+stage_redraw_causes (TestConformSimpleFixture *fixture,
+                     gconstpointer             test_data)
+{
+  Data data = { NULL, };
+  guint paint_id;
+
+  data.stage = clutter_stage_get_default ();
+
+  g_assert (!clutter_stage_get_track_redraw_causes (CLUTTER_STAGE (data.stage)));
+  clutter_stage_set_track_redraw_causes (CLUTTER_STAGE (data.stage), TRUE);
+  g_assert (clutter_stage_get_track_redraw_causes (CLUTTER_STAGE (data.stage)));
+
+  data.rect = clutter_rectangle_new ();
+  clutter_actor_set_name (data.rect, "redraw-cause");
+  clutter_actor_set_size (data.rect, 50, 50);
+  clutter_container_add_actor (CLUTTER_CONTAINER (data.stage), data.rect);
+
+  paint_id = g_signal_connect_after (data.stage, "paint",
+                                     G_CALLBACK (on_paint),
+                                     &data);
+
+  clutter_actor_show (data.stage);
+
+  /* let the stage draw its first frames before changing the scene */
+  g_timeout_add_full (G_PRIORITY_LOW, 250, change_cb, &data, NULL);
+
+  clutter_main ();
+
+  g_assert (data.found);
+
+  g_signal_handler_disconnect (data.stage, paint_id);
+  clutter_actor_destroy (data.rect);
+
+  clutter_stage_set_track_redraw_causes (CLUTTER_STAGE (data.stage), FALSE);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
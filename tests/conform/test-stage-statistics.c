@@ -0,0 +1,95 @@
+#include <clutter/clutter.h>
+
+#include "test-conform-common.h"
+
+typedef struct
+{
+  ClutterActor *stage;
+
+  /* the statistics before the test actors were added, since other
+   * tests might leave actors on the default stage */
+  ClutterStageStatistics before;
+} Data;
+
+static gboolean
+timeout_cb (gpointer user_data)
+{
+  Data *data = user_data;
+  ClutterActor *stage = data->stage;
+  ClutterStageStatistics stats;
+  guchar *pixel;
+
+  /* reading back the stage draws a frame */
+  pixel = clutter_stage_read_pixels (CLUTTER_STAGE (stage), 0, 0, 1, 1);
+  g_free (pixel);
+
+  clutter_stage_get_statistics (CLUTTER_STAGE (stage), &stats);
+
+  if (g_test_verbose ())
+    g_print ("actors: %u, mapped: %u, visible: %u, painted: %u, "
+             "culled: %u, text layouts: %u\n",
+             stats.n_actors,
+             stats.n_mapped_actors,
+             stats.n_visible_actors,
+             stats.n_painted_actors,
+             stats.n_culled_actors,
+             stats.n_text_layouts);
+
+  /* the group, three rectangles and the text */
+  g_assert_cmpuint (stats.n_actors - data->before.n_actors, ==, 5);
+
+  /* one of the rectangles is hidden */
+  g_assert_cmpuint (stats.n_visible_actors - data->before.n_visible_actors,
+                    ==,
+                    4);
+  g_assert_cmpuint (stats.n_mapped_actors, >=, 5);
+  g_assert_cmpuint (stats.n_painted_actors, >, 0);
+
+  /* the text was laid out to be painted */
+  g_assert_cmpuint (stats.n_text_layouts, >, data->before.n_text_layouts);
+
+  clutter_main_quit ();
+
+  return FALSE;
+}
+
+void
+stage_statistics (TestConformSimpleFixture *fixture,
+                  gconstpointer             test_data)
+{
+  ClutterActor *stage, *group, *rect, *text;
+  Data data;
+  gint i;
+
+  stage = clutter_stage_get_default ();
+  clutter_actor_show (stage);
+
+  data.stage = stage;
+  clutter_stage_get_statistics (CLUTTER_STAGE (stage), &data.before);
+
+  group = clutter_group_new ();
+  clutter_container_add_actor (CLUTTER_CONTAINER (stage), group);
+
+  for (i = 0; i < 3; i++)
+    {
+      rect = clutter_rectangle_new ();
+      clutter_actor_set_size (rect, 50, 50);
+      clutter_actor_set_position (rect, i * 60, 0);
+      clutter_container_add_actor (CLUTTER_CONTAINER (group), rect);
+    }
+
+  clutter_actor_hide (rect);
+
+  text = clutter_text_new_with_text ("Sans 12", "Statistics");
+  clutter_actor_set_position (text, 0, 60);
+  clutter_container_add_actor (CLUTTER_CONTAINER (group), text);
+
+  g_timeout_add_full (G_PRIORITY_LOW, 250, timeout_cb, &data, NULL);
+
+  clutter_main ();
+
+  clutter_actor_destroy (group);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
@@ -0,0 +1,194 @@
+#include <clutter/clutter.h>
+
+#include "test-conform-common.h"
+
+#define CHILD_SIZE      50
+#define STEP            10
+
+/* the number of frames the group has to stay unchanged before being
+   cached; this matches the value used by ClutterActor */
+#define STATIC_FRAMES   4
+
+typedef struct _FooActor      FooActor;
+typedef struct _FooActorClass FooActorClass;
+
+struct _FooActorClass
+{
+  ClutterActorClass parent_class;
+};
+
+struct _FooActor
+{
+  ClutterActor parent;
+
+  int paint_count;
+};
+
+typedef struct
+{
+  ClutterActor *stage;
+  ClutterActor *parent;
+  ClutterActor *group;
+  FooActor *child;
+} Data;
+
+GType foo_actor_get_type (void) G_GNUC_CONST;
+
+G_DEFINE_TYPE (FooActor, foo_actor, CLUTTER_TYPE_ACTOR);
+
+static void
+foo_actor_paint (ClutterActor *actor)
+{
+  FooActor *foo_actor = (FooActor *) actor;
+  ClutterActorBox allocation;
+  guint8 paint_opacity;
+
+  foo_actor->paint_count++;
+
+  clutter_actor_get_allocation_box (actor, &allocation);
+
+  /* Paint a red rectangle filling the allocation */
+  paint_opacity = clutter_actor_get_paint_opacity (actor);
+  cogl_set_source_color4ub (255, 0, 0, paint_opacity);
+  cogl_rectangle (0, 0,
+                  allocation.x2 - allocation.x1,
+                  allocation.y2 - allocation.y1);
+}
+
+static void
+foo_actor_class_init (FooActorClass *klass)
+{
+  ClutterActorClass *actor_class = (ClutterActorClass *) klass;
+
+  actor_class->paint = foo_actor_paint;
+}
+
+static void
+foo_actor_init (FooActor *self)
+{
+}
+
+/* returns the number of times the child was painted */
+static int
+move_and_verify (Data *data)
+{
+  gfloat x;
+  guchar *pixel;
+  int paint_count;
+
+  /* Move the parent of the group; the group itself does not change */
+  x = clutter_actor_get_x (data->parent) + STEP;
+  clutter_actor_set_x (data->parent, x);
+
+  data->child->paint_count = 0;
+
+  /* Read a pixel at the center of the child; this causes a redraw */
+  pixel = clutter_stage_read_pixels (CLUTTER_STAGE (data->stage),
+                                     x + CHILD_SIZE / 2,
+                                     CHILD_SIZE / 2,
+                                     1, 1);
+
+  if (g_test_verbose ())
+    g_print ("x: %.0f, paint count: %d, pixel: %d, %d, %d\n",
+             x, data->child->paint_count,
+             pixel[0], pixel[1], pixel[2]);
+
+  g_assert_cmpint (ABS (255 - (int) pixel[0]), <=, 2);
+  g_assert_cmpint (pixel[1], <=, 2);
+  g_assert_cmpint (pixel[2], <=, 2);
+
+  g_free (pixel);
+
+  paint_count = data->child->paint_count;
+
+  /* The area the child moved away from must have been cleared */
+  pixel = clutter_stage_read_pixels (CLUTTER_STAGE (data->stage),
+                                     x - STEP / 2,
+                                     CHILD_SIZE / 2,
+                                     1, 1);
+
+  g_assert_cmpint (pixel[0], <=, 2);
+
+  g_free (pixel);
+
+  return paint_count;
+}
+
+static gboolean
+timeout_cb (gpointer user_data)
+{
+  Data *data = user_data;
+  int i;
+
+  /* The group does not change, so its image is cached after its
+     parent moved it for a few frames */
+  for (i = 0; i <= STATIC_FRAMES; i++)
+    {
+      if (move_and_verify (data) == 0)
+        break;
+    }
+
+  g_assert_cmpint (i, <=, STATIC_FRAMES);
+
+  /* From now on the image follows the parent */
+  g_assert_cmpint (move_and_verify (data), ==, 0);
+  g_assert_cmpint (move_and_verify (data), ==, 0);
+
+  /* Queueing a redraw on the child drops the cached image, and the
+     group is painted until it stays unchanged for a few frames; the
+     last of them fills the cache again */
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (data->child));
+
+  for (i = 0; i <= STATIC_FRAMES; i++)
+    g_assert_cmpint (move_and_verify (data), ==, 1);
+
+  g_assert_cmpint (move_and_verify (data), ==, 0);
+
+  clutter_main_quit ();
+
+  return FALSE;
+}
+
+void
+actor_subtree_cache (TestConformSimpleFixture *fixture,
+                     gconstpointer             test_data)
+{
+  if (cogl_features_available (COGL_FEATURE_OFFSCREEN))
+    {
+      ClutterColor stage_color = { 0x00, 0x00, 0x00, 0xff };
+      Data data;
+
+      data.stage = clutter_stage_get_default ();
+      clutter_stage_set_color (CLUTTER_STAGE (data.stage), &stage_color);
+
+      data.parent = clutter_group_new ();
+      clutter_container_add_actor (CLUTTER_CONTAINER (data.stage),
+                                   data.parent);
+
+      data.group = clutter_group_new ();
+      clutter_container_add_actor (CLUTTER_CONTAINER (data.parent),
+                                   data.group);
+
+      data.child = g_object_new (foo_actor_get_type (), NULL);
+      clutter_actor_set_size (CLUTTER_ACTOR (data.child),
+                              CHILD_SIZE,
+                              CHILD_SIZE);
+      clutter_container_add_actor (CLUTTER_CONTAINER (data.group),
+                                   CLUTTER_ACTOR (data.child));
+
+      clutter_actor_show (data.stage);
+
+      /* Start the test after a short delay to allow the stage to
+         render its initial frames without affecting the results */
+      g_timeout_add_full (G_PRIORITY_LOW, 250, timeout_cb, &data, NULL);
+
+      clutter_main ();
+
+      clutter_actor_destroy (data.parent);
+
+      if (g_test_verbose ())
+        g_print ("OK\n");
+    }
+  else if (g_test_verbose ())
+    g_print ("Skipping\n");
+}
@@ -0,0 +1,170 @@
+#include <clutter/clutter.h>
+
+#include "test-conform-common.h"
+
+#define GRID_SIZE       4
+#define CELL_SIZE       10
+
+static void
+assert_cell_x (ClutterActor *actor,
+               gfloat        x,
+               gfloat        width)
+{
+  ClutterActorBox allocation;
+
+  clutter_actor_get_allocation_box (actor, &allocation);
+
+  if (g_test_verbose ())
+    g_print ("Cell allocation: x:%.2f width:%.2f (expected x:%.2f width:%.2f)\n",
+             allocation.x1,
+             clutter_actor_box_get_width (&allocation),
+             x, width);
+
+  g_assert_cmpfloat (allocation.x1, ==, x);
+  g_assert_cmpfloat (clutter_actor_box_get_width (&allocation), ==, width);
+}
+
+void
+table_layout_cached_solution (TestConformSimpleFixture *fixture,
+                              gconstpointer             data)
+{
+  ClutterActor *stage, *box;
+  ClutterActor *grid[GRID_SIZE][GRID_SIZE];
+  ClutterLayoutManager *layout;
+  gint row, col;
+
+  stage = clutter_stage_get_default ();
+
+  layout = clutter_table_layout_new ();
+  box = clutter_box_new (layout);
+  clutter_container_add_actor (CLUTTER_CONTAINER (stage), box);
+
+  for (row = 0; row < GRID_SIZE; row++)
+    for (col = 0; col < GRID_SIZE; col++)
+      {
+        ClutterActor *rect = clutter_rectangle_new ();
+
+        clutter_actor_set_size (rect, CELL_SIZE, CELL_SIZE);
+        clutter_table_layout_pack (CLUTTER_TABLE_LAYOUT (layout),
+                                   rect,
+                                   col, row);
+
+        grid[row][col] = rect;
+      }
+
+  clutter_actor_show (stage);
+
+  /* the uniform grid expands to fill the box... */
+  clutter_actor_set_size (box, GRID_SIZE * CELL_SIZE * 2, 100);
+  assert_cell_x (grid[1][2], 2 * CELL_SIZE * 2, CELL_SIZE * 2);
+
+  /* ...and is scaled back when the box is resized */
+  clutter_actor_set_size (box, GRID_SIZE * CELL_SIZE, 100);
+  assert_cell_x (grid[1][2], 2 * CELL_SIZE, CELL_SIZE);
+
+  /* changing the preferred size of a child invalidates the solution */
+  clutter_actor_set_width (grid[0][0], CELL_SIZE * 2);
+  assert_cell_x (grid[1][2], 3 * CELL_SIZE, CELL_SIZE);
+
+  /* and so does changing its visibility */
+  clutter_actor_hide (grid[0][0]);
+  assert_cell_x (grid[1][2], 2 * CELL_SIZE, CELL_SIZE);
+
+  /* and changing the layout properties */
+  clutter_layout_manager_child_set (layout, CLUTTER_CONTAINER (box),
+                                    grid[1][1],
+                                    "column-span", 2,
+                                    NULL);
+  clutter_container_remove_actor (CLUTTER_CONTAINER (box), grid[1][2]);
+  assert_cell_x (grid[1][1], CELL_SIZE, CELL_SIZE * 2);
+
+  clutter_table_layout_set_column_spacing (CLUTTER_TABLE_LAYOUT (layout), 5);
+  clutter_actor_set_size (box, GRID_SIZE * CELL_SIZE + 3 * 5, 100);
+  assert_cell_x (grid[1][3], 3 * (CELL_SIZE + 5), CELL_SIZE);
+
+  clutter_actor_destroy (box);
+}
+
+static void
+on_layout_changed (ClutterLayoutManager *layout,
+                   gint                 *n_changes)
+{
+  *n_changes += 1;
+}
+
+void
+table_layout_pack_full (TestConformSimpleFixture *fixture,
+                        gconstpointer             data)
+{
+  ClutterActor *stage, *box, *wide, *rect;
+  ClutterLayoutManager *layout;
+  ClutterTableAlignment x_align, y_align;
+  GParamSpec *pspec;
+  GValue value = { 0, };
+  gint n_changes = 0;
+  gint col_span, row_span;
+
+  stage = clutter_stage_get_default ();
+
+  layout = clutter_table_layout_new ();
+  box = clutter_box_new (layout);
+  clutter_container_add_actor (CLUTTER_CONTAINER (stage), box);
+
+  g_signal_connect (layout, "layout-changed",
+                    G_CALLBACK (on_layout_changed),
+                    &n_changes);
+
+  wide = clutter_rectangle_new ();
+  clutter_actor_set_size (wide, CELL_SIZE * 2, CELL_SIZE);
+  clutter_table_layout_pack_full (CLUTTER_TABLE_LAYOUT (layout), wide,
+                                  0, 0,
+                                  2, 1,
+                                  CLUTTER_TABLE_ALIGNMENT_START,
+                                  CLUTTER_TABLE_ALIGNMENT_END);
+
+  /* all the layout properties are set with a single change */
+  g_assert_cmpint (n_changes, ==, 1);
+
+  clutter_table_layout_get_span (CLUTTER_TABLE_LAYOUT (layout), wide,
+                                 &col_span, &row_span);
+  g_assert_cmpint (col_span, ==, 2);
+  g_assert_cmpint (row_span, ==, 1);
+
+  clutter_table_layout_get_alignment (CLUTTER_TABLE_LAYOUT (layout), wide,
+                                      &x_align, &y_align);
+  g_assert_cmpint (x_align, ==, CLUTTER_TABLE_ALIGNMENT_START);
+  g_assert_cmpint (y_align, ==, CLUTTER_TABLE_ALIGNMENT_END);
+
+  rect = clutter_rectangle_new ();
+  clutter_actor_set_size (rect, CELL_SIZE, CELL_SIZE);
+  clutter_table_layout_pack_full (CLUTTER_TABLE_LAYOUT (layout), rect,
+                                  2, 1,
+                                  1, 1,
+                                  CLUTTER_TABLE_ALIGNMENT_CENTER,
+                                  CLUTTER_TABLE_ALIGNMENT_CENTER);
+
+  clutter_actor_show (stage);
+
+  assert_cell_x (rect, 2 * CELL_SIZE, CELL_SIZE);
+
+  /* the properties can be set and retrieved through their pspec */
+  pspec = clutter_layout_manager_find_child_property (layout, "column");
+  g_assert (pspec != NULL);
+
+  g_value_init (&value, G_TYPE_INT);
+  g_value_set_int (&value, 1);
+  clutter_layout_manager_child_set_pspec (layout, CLUTTER_CONTAINER (box),
+                                          rect,
+                                          pspec,
+                                          &value);
+
+  g_value_set_int (&value, 0);
+  clutter_layout_manager_child_get_pspec (layout, CLUTTER_CONTAINER (box),
+                                          rect,
+                                          pspec,
+                                          &value);
+  g_assert_cmpint (g_value_get_int (&value), ==, 1);
+  g_value_unset (&value);
+
+  clutter_actor_destroy (box);
+}
@@ -39,6 +39,12 @@ create_source (void)
     for (x = 0; x < SOURCE_DIVISIONS_X; x++)
       {
         ClutterActor *rect = clutter_rectangle_new ();
+        gchar *name;
+
+        name = g_strdup_printf ("division-%d", y * SOURCE_DIVISIONS_X + x);
+        clutter_actor_set_name (rect, name);
+        g_free (name);
+
         clutter_actor_set_size (rect, DIVISION_WIDTH, DIVISION_HEIGHT);
         clutter_actor_set_position (rect,
                                     DIVISION_WIDTH * x,
@@ -252,3 +258,83 @@ test_texture_fbo (TestConformSimpleFixture *fixture,
     g_print ("OK\n");
 }
 
+
+typedef struct _UpdateState
+{
+  ClutterActor *stage;
+  ClutterActor *changed;
+  guint frame;
+  gboolean was_updated;
+} UpdateState;
+
+static void
+on_update_paint (ClutterActor *stage, UpdateState *state)
+{
+  int frame_num = state->frame++;
+
+  if (frame_num == 1)
+    {
+      /* change a single division of the source after the texture was
+       * rendered once; only that division queues a redraw */
+      clutter_rectangle_set_color (CLUTTER_RECTANGLE (state->changed),
+                                   &stage_color);
+    }
+  else if (frame_num == 3)
+    {
+      TestState test_state = { state->stage, 0 };
+
+      /* the changed division is rendered again, and the others are
+       * preserved */
+      state->was_updated = validate_part (&test_state, SOURCE_SIZE, 0, 1);
+
+      clutter_main_quit ();
+    }
+}
+
+void
+test_texture_fbo_update (TestConformSimpleFixture *fixture,
+                         gconstpointer data)
+{
+  UpdateState state = { NULL, };
+  guint idle_source;
+  gulong paint_handler;
+  ClutterActor *source, *actor;
+
+  state.stage = clutter_stage_get_default ();
+
+  clutter_stage_set_color (CLUTTER_STAGE (state.stage), &stage_color);
+
+  source = create_source ();
+  clutter_container_add (CLUTTER_CONTAINER (state.stage), source, NULL);
+  actor = clutter_texture_new_from_actor (source);
+  clutter_actor_set_position (actor, SOURCE_SIZE, 0);
+  clutter_container_add (CLUTTER_CONTAINER (state.stage), actor, NULL);
+
+  /* the top left division */
+  state.changed =
+    clutter_container_find_child_by_name (CLUTTER_CONTAINER (source),
+                                          "division-0");
+
+  idle_source = g_idle_add (queue_redraw, state.stage);
+
+  paint_handler = g_signal_connect_after (state.stage, "paint",
+                                          G_CALLBACK (on_update_paint),
+                                          &state);
+
+  clutter_actor_show_all (state.stage);
+
+  clutter_main ();
+
+  g_signal_handler_disconnect (state.stage, paint_handler);
+
+  g_source_remove (idle_source);
+
+  g_assert (state.was_updated);
+
+  clutter_container_foreach (CLUTTER_CONTAINER (state.stage),
+                             (ClutterCallback) clutter_actor_destroy,
+                             NULL);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
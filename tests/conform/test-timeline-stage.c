@@ -0,0 +1,103 @@
+#include <stdlib.h>
+#include <glib.h>
+#include <clutter/clutter.h>
+
+#include "test-conform-common.h"
+
+#define TEST_TIMELINE_DURATION 100
+#define TEST_WATCHDOG_KICK_IN_SECONDS 10
+
+typedef struct _TestState
+{
+  ClutterActor *stage;
+  ClutterTimeline *timeline;
+  gint n_frames;
+  gboolean stage_painted;
+  gboolean completed;
+} TestState;
+
+static gboolean
+watchdog_timeout (TestState *state)
+{
+  g_test_message ("Failed (the bound timeline was never advanced)");
+  exit (EXIT_FAILURE);
+
+  return FALSE;
+}
+
+static void
+paint_cb (ClutterActor *stage,
+          TestState    *state)
+{
+  state->stage_painted = TRUE;
+}
+
+static void
+new_frame_cb (ClutterTimeline *timeline,
+              gint             elapsed_time,
+              TestState       *state)
+{
+  state->n_frames++;
+
+  /* the stage is redrawn so that its frame clock keeps running */
+  clutter_actor_queue_redraw (state->stage);
+}
+
+static void
+completed_cb (ClutterTimeline *timeline,
+              TestState       *state)
+{
+  state->completed = TRUE;
+
+  clutter_main_quit ();
+}
+
+void
+timeline_stage (TestConformSimpleFixture *fixture,
+                gconstpointer             data)
+{
+  TestState state = { NULL, };
+  guint watchdog_id;
+
+  state.stage = clutter_stage_get_default ();
+  clutter_actor_show (state.stage);
+
+  state.timeline = clutter_timeline_new (TEST_TIMELINE_DURATION);
+  g_assert (clutter_timeline_get_stage (state.timeline) == NULL);
+
+  clutter_timeline_set_stage (state.timeline, CLUTTER_STAGE (state.stage));
+  g_assert (clutter_timeline_get_stage (state.timeline) ==
+            CLUTTER_STAGE (state.stage));
+
+  g_signal_connect (state.stage, "paint", G_CALLBACK (paint_cb), &state);
+  g_signal_connect (state.timeline, "new-frame",
+                    G_CALLBACK (new_frame_cb),
+                    &state);
+  g_signal_connect (state.timeline, "completed",
+                    G_CALLBACK (completed_cb),
+                    &state);
+
+  watchdog_id = g_timeout_add (TEST_WATCHDOG_KICK_IN_SECONDS * 1000,
+                               (GSourceFunc) watchdog_timeout,
+                               &state);
+
+  clutter_timeline_start (state.timeline);
+
+  clutter_main ();
+
+  g_source_remove (watchdog_id);
+
+  g_assert (state.completed);
+  g_assert_cmpint (state.n_frames, >, 0);
+  g_assert (state.stage_painted);
+
+  g_signal_handlers_disconnect_by_func (state.stage, paint_cb, &state);
+
+  clutter_timeline_set_stage (state.timeline, NULL);
+  g_assert (clutter_timeline_get_stage (state.timeline) == NULL);
+
+  g_object_unref (state.timeline);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
@@ -0,0 +1,122 @@
+#include <clutter/clutter.h>
+
+#include "test-conform-common.h"
+
+typedef struct
+{
+  ClutterActor *stage;
+  ClutterActor *rect;
+  GString *log;
+
+  gboolean applied;
+  gboolean posted_late;
+} TestState;
+
+typedef struct
+{
+  TestState *state;
+  gchar name;
+} Update;
+
+static void
+apply_update (gpointer data)
+{
+  Update *update = data;
+
+  g_string_append_c (update->state->log, update->name);
+
+  update->state->applied = TRUE;
+}
+
+static void
+apply_last_update (gpointer data)
+{
+  Update *update = data;
+
+  apply_update (data);
+
+  /* an update posted while applying the updates of a frame is
+     applied in the next frame */
+  if (!update->state->posted_late)
+    {
+      Update *late = g_new0 (Update, 1);
+
+      late->state = update->state;
+      late->name = 'd';
+
+      update->state->posted_late = TRUE;
+
+      clutter_threads_post_update (apply_update, late, g_free);
+    }
+}
+
+static void
+post_update (TestState         *state,
+             gchar              name,
+             ClutterUpdateFunc  func)
+{
+  Update *update = g_new0 (Update, 1);
+
+  update->state = state;
+  update->name = name;
+
+  clutter_threads_post_update (func, update, g_free);
+}
+
+static void
+wait_for_updates (TestState *state)
+{
+  state->applied = FALSE;
+
+  while (!state->applied)
+    g_main_context_iteration (NULL, TRUE);
+}
+
+void
+threads_post_update (TestConformSimpleFixture *fixture,
+                     gconstpointer             data)
+{
+  TestState state;
+  GValue value = { 0, };
+
+  state.stage = clutter_stage_get_default ();
+  state.rect = clutter_rectangle_new ();
+  clutter_container_add_actor (CLUTTER_CONTAINER (state.stage), state.rect);
+  clutter_actor_show (state.stage);
+
+  state.log = g_string_new (NULL);
+  state.posted_late = FALSE;
+
+  /* the updates are applied in the order they were posted */
+  post_update (&state, 'a', apply_update);
+
+  g_value_init (&value, G_TYPE_FLOAT);
+  g_value_set_float (&value, 42.0f);
+  clutter_threads_post_set_property (G_OBJECT (state.rect), "x", &value);
+  g_value_unset (&value);
+
+  post_update (&state, 'b', apply_update);
+  post_update (&state, 'c', apply_last_update);
+
+  /* nothing is applied before the master clock runs */
+  g_assert_cmpstr (state.log->str, ==, "");
+  g_assert_cmpfloat (clutter_actor_get_x (state.rect), ==, 0.0f);
+
+  wait_for_updates (&state);
+
+  if (g_test_verbose ())
+    g_print ("first frame: '%s'\n", state.log->str);
+
+  g_assert_cmpstr (state.log->str, ==, "abc");
+  g_assert_cmpfloat (clutter_actor_get_x (state.rect), ==, 42.0f);
+
+  wait_for_updates (&state);
+
+  if (g_test_verbose ())
+    g_print ("second frame: '%s'\n", state.log->str);
+
+  g_assert_cmpstr (state.log->str, ==, "abcd");
+
+  g_string_free (state.log, TRUE);
+  clutter_actor_destroy (state.rect);
+}
@@ -0,0 +1,295 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <clutter/clutter.h>
+
+#define STAGE_WIDTH  800
+#define STAGE_HEIGHT 600
+
+#define N_FRAMES                200
+#define N_WARMUP_FRAMES         10
+#define N_EVENTS_PER_FRAME      4
+
+/* the interval between two frames of the master clock without
+ * sync-to-vblank, in milliseconds */
+#define FRAME_INTERVAL          16
+
+static gint n_frames = N_FRAMES;
+static gint n_events_per_frame = N_EVENTS_PER_FRAME;
+
+static GOptionEntry entries[] = {
+  {
+    "num-frames", 'f',
+    0,
+    G_OPTION_ARG_INT, &n_frames,
+    "Number of frames measured for each mode", "FRAMES"
+  },
+  {
+    "events-per-frame", 'e',
+    0,
+    G_OPTION_ARG_INT, &n_events_per_frame,
+    "Number of motion events injected in each frame", "EVENTS"
+  },
+  { NULL }
+};
+
+typedef struct
+{
+  ClutterActor *stage;
+  ClutterActor *marker;
+  ClutterInputDevice *pointer;
+
+  gint frame;
+  gint64 last_frame_time;
+
+  /* the time at which each event was injected, indexed by the
+   * sequence number of the event */
+  GArray *inject_times;
+
+  /* the sequence number of the next event to inject, the number of
+   * events up to the last one delivered to the stage and up to the
+   * last one reflected by a painted frame, and the sequence number of
+   * the first event without a latency yet */
+  guint next_event;
+  guint n_delivered_upto;
+  guint n_painted_upto;
+  guint first_pending;
+
+  guint n_delivered;
+
+  /* the latencies of the measured events, in microseconds */
+  guint n_latencies;
+  gint64 total_latency;
+  gint64 min_latency;
+  gint64 max_latency;
+} Run;
+
+static gint64
+get_time (void)
+{
+#if GLIB_CHECK_VERSION (2, 27, 3)
+  return g_get_monotonic_time ();
+#else
+  GTimeVal current_time;
+
+  g_get_current_time (&current_time);
+
+  return current_time.tv_sec * G_USEC_PER_SEC + current_time.tv_usec;
+#endif
+}
+
+/* queues a motion event on the stage, the way a backend would; the
+ * time of the event is its sequence number, so that the events that
+ * get compressed away can be told apart */
+static void
+inject_event (Run *run)
+{
+  ClutterEvent *event;
+  gint64 now = get_time ();
+  guint seq = run->next_event++;
+
+  g_array_append_val (run->inject_times, now);
+
+  event = clutter_event_new (CLUTTER_MOTION);
+  clutter_event_set_stage (event, CLUTTER_STAGE (run->stage));
+  clutter_event_set_device (event, run->pointer);
+  clutter_event_set_time (event, seq);
+  clutter_event_set_coords (event,
+                            (seq * 7) % STAGE_WIDTH,
+                            (seq * 3) % STAGE_HEIGHT);
+
+  clutter_do_event (event);
+
+  clutter_event_free (event);
+}
+
+static gboolean
+inject_timeout (gpointer user_data)
+{
+  inject_event (user_data);
+
+  return FALSE;
+}
+
+static gboolean
+on_motion (ClutterActor *stage,
+           ClutterEvent *event,
+           Run          *run)
+{
+  gfloat x, y;
+
+  /* the frame reflects the event by moving the marker */
+  clutter_event_get_coords (event, &x, &y);
+  clutter_actor_set_position (run->marker, x, y);
+
+  run->n_delivered_upto = clutter_event_get_time (event) + 1;
+  run->n_delivered += 1;
+
+  return TRUE;
+}
+
+static void
+on_paint (ClutterActor *stage,
+          Run          *run)
+{
+  run->n_painted_upto = run->n_delivered_upto;
+}
+
+/* every event injected before the last one delivered is reflected by
+ * the frame that painted it, even if it was compressed away */
+static void
+account_frame (Run    *run,
+               gint64  frame_time)
+{
+  while (run->first_pending < run->n_painted_upto &&
+         run->first_pending < run->inject_times->len)
+    {
+      gint64 latency = frame_time
+                     - g_array_index (run->inject_times,
+                                      gint64,
+                                      run->first_pending);
+
+      if (run->frame >= N_WARMUP_FRAMES)
+        {
+          run->total_latency += latency;
+          run->min_latency = run->n_latencies == 0
+                           ? latency
+                           : MIN (run->min_latency, latency);
+          run->max_latency = MAX (run->max_latency, latency);
+          run->n_latencies += 1;
+        }
+
+      run->first_pending += 1;
+    }
+}
+
+/* runs at the start of each iteration of the master clock, before the
+ * stage processes its queued events */
+static gboolean
+on_repaint (gpointer user_data)
+{
+  Run *run = user_data;
+  ClutterStageFrameTimings timings;
+  gint i;
+
+  if (clutter_stage_get_frame_timings (CLUTTER_STAGE (run->stage),
+                                       &timings, 1) == 1 &&
+      timings.frame_time != run->last_frame_time)
+    {
+      run->last_frame_time = timings.frame_time;
+
+      account_frame (run, timings.frame_time);
+
+      run->frame += 1;
+    }
+
+  if (run->frame >= N_WARMUP_FRAMES + n_frames)
+    {
+      clutter_main_quit ();
+      return FALSE;
+    }
+
+  /* spread the events over the frame, starting in sync with the
+   * master clock */
+  inject_event (run);
+
+  for (i = 1; i < n_events_per_frame; i++)
+    g_timeout_add (i * FRAME_INTERVAL / n_events_per_frame,
+                   inject_timeout,
+                   run);
+
+  return TRUE;
+}
+
+static void
+run_mode (ClutterActor *stage,
+          gboolean      throttle)
+{
+  ClutterDeviceManager *manager;
+  guint motion_id, paint_id;
+  Run run;
+
+  memset (&run, 0, sizeof (Run));
+  run.stage = stage;
+  run.inject_times = g_array_new (FALSE, FALSE, sizeof (gint64));
+
+  manager = clutter_device_manager_get_default ();
+  run.pointer =
+    clutter_device_manager_get_core_device (manager,
+                                            CLUTTER_POINTER_DEVICE);
+
+  run.marker = clutter_rectangle_new ();
+  clutter_actor_set_size (run.marker, 8, 8);
+  clutter_container_add_actor (CLUTTER_CONTAINER (stage), run.marker);
+
+  clutter_stage_set_throttle_motion_events (CLUTTER_STAGE (stage), throttle);
+
+  motion_id = g_signal_connect (stage, "motion-event",
+                                G_CALLBACK (on_motion),
+                                &run);
+  paint_id = g_signal_connect_after (stage, "paint",
+                                     G_CALLBACK (on_paint),
+                                     &run);
+
+  clutter_threads_add_repaint_func (on_repaint, &run, NULL);
+  clutter_actor_queue_redraw (stage);
+
+  clutter_main ();
+
+  g_signal_handler_disconnect (stage, motion_id);
+  g_signal_handler_disconnect (stage, paint_id);
+
+  /* the events still waiting for their timeouts are not measured */
+  while (g_source_remove_by_user_data (&run))
+    ;
+
+  clutter_actor_destroy (run.marker);
+
+  printf ("%-12s %6u events %6u delivered "
+          "%8.1f us avg %8.1f us min %8.1f us max latency\n",
+          throttle ? "throttled" : "unthrottled",
+          run.next_event,
+          run.n_delivered,
+          run.n_latencies > 0
+            ? (gdouble) run.total_latency / run.n_latencies
+            : 0.0,
+          (gdouble) run.min_latency,
+          (gdouble) run.max_latency);
+  fflush (stdout);
+
+  g_array_free (run.inject_times, TRUE);
+}
+
+int
+main (int argc, char **argv)
+{
+  ClutterActor *stage;
+  GError *error = NULL;
+
+  g_setenv ("CLUTTER_VBLANK", "none", FALSE);
+
+  if (clutter_init_with_args (&argc, &argv,
+                              NULL,
+                              entries,
+                              NULL,
+                              &error) != CLUTTER_INIT_SUCCESS)
+    return 1;
+
+  if (n_frames < 1 || n_events_per_frame < 1)
+    {
+      g_printerr ("Invalid number of frames or events\n");
+      return EXIT_FAILURE;
+    }
+
+  stage = clutter_stage_get_default ();
+  clutter_actor_set_size (stage, STAGE_WIDTH, STAGE_HEIGHT);
+  clutter_actor_show (stage);
+
+  printf ("Event to frame latency (%d motion events per frame)\n",
+          n_events_per_frame);
+
+  run_mode (stage, TRUE);
+  run_mode (stage, FALSE);
+
+  return EXIT_SUCCESS;
+}
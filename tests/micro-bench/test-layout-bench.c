@@ -0,0 +1,359 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <clutter/clutter.h>
+
+#define STAGE_WIDTH  800
+#define STAGE_HEIGHT 600
+
+#define MAX_CHILDREN    100000
+#define N_CHANGES       10
+
+static gint max_children = MAX_CHILDREN;
+static gchar *layout_name = NULL;
+
+static GOptionEntry entries[] = {
+  {
+    "max-children", 'n',
+    0,
+    G_OPTION_ARG_INT, &max_children,
+    "Largest number of children of each container", "CHILDREN"
+  },
+  {
+    "layout", 'l',
+    0,
+    G_OPTION_ARG_STRING, &layout_name,
+    "Run only the given layout manager", "LAYOUT"
+  },
+  { NULL }
+};
+
+typedef struct _Layout  Layout;
+
+struct _Layout
+{
+  const gchar *name;
+
+  ClutterLayoutManager *(* create) (gint n_children);
+
+  /* places @child, the @index-th child of @box, if the layout manager
+   * needs it */
+  void (* place) (ClutterLayoutManager *layout,
+                  ClutterActor         *box,
+                  ClutterActor         *child,
+                  gint                  index,
+                  gint                  n_children);
+};
+
+typedef struct
+{
+  gint64 measure_time;
+  gint64 layout_time;
+  guint n_allocated_actors;
+  guint n_size_requests;
+  guint n_cached_size_requests;
+} Sample;
+
+static ClutterLayoutManager *
+box_create (gint n_children)
+{
+  ClutterLayoutManager *layout = clutter_box_layout_new ();
+
+  clutter_box_layout_set_vertical (CLUTTER_BOX_LAYOUT (layout), TRUE);
+
+  return layout;
+}
+
+static ClutterLayoutManager *
+flow_create (gint n_children)
+{
+  return clutter_flow_layout_new (CLUTTER_FLOW_HORIZONTAL);
+}
+
+static ClutterLayoutManager *
+table_create (gint n_children)
+{
+  return clutter_table_layout_new ();
+}
+
+/* packing each child with clutter_table_layout_pack() would count the
+ * rows and the columns again each time */
+static void
+table_place (ClutterLayoutManager *layout,
+             ClutterActor         *box,
+             ClutterActor         *child,
+             gint                  index,
+             gint                  n_children)
+{
+  gint n_columns = 1;
+
+  /* a square table */
+  while (n_columns * n_columns < n_children)
+    n_columns += 1;
+
+  clutter_layout_manager_child_set (layout,
+                                    CLUTTER_CONTAINER (box),
+                                    child,
+                                    "column", index % n_columns,
+                                    "row", index / n_columns,
+                                    NULL);
+}
+
+static ClutterLayoutManager *
+bin_create (gint n_children)
+{
+  return clutter_bin_layout_new (CLUTTER_BIN_ALIGNMENT_CENTER,
+                                 CLUTTER_BIN_ALIGNMENT_CENTER);
+}
+
+static Layout layouts[] = {
+  { "box", box_create, NULL },
+  { "flow", flow_create, NULL },
+  { "table", table_create, table_place },
+  { "bin", bin_create, NULL },
+};
+
+/* the children mix the request modes: one in ten is a wrapping text,
+ * which is height-for-width, one in ten is a text that is measured
+ * width-for-height, and the others are rectangles with a fixed size */
+static ClutterActor *
+create_child (gint index)
+{
+  ClutterActor *child;
+
+  switch (index % 10)
+    {
+    case 0:
+      child = clutter_text_new_with_text ("Sans 12px",
+                                          "The quick brown fox jumps over "
+                                          "the lazy dog");
+      clutter_text_set_line_wrap (CLUTTER_TEXT (child), TRUE);
+      break;
+
+    case 1:
+      child = clutter_text_new_with_text ("Sans 12px", "Label");
+      clutter_actor_set_request_mode (child,
+                                      CLUTTER_REQUEST_WIDTH_FOR_HEIGHT);
+      break;
+
+    default:
+      child = clutter_rectangle_new ();
+      clutter_actor_set_size (child, 10 + index % 40, 10 + index % 20);
+      break;
+    }
+
+  return child;
+}
+
+/* changes the size request of a single child */
+static void
+change_child (ClutterActor *child,
+              gint          change)
+{
+  if (CLUTTER_IS_TEXT (child))
+    clutter_text_set_text (CLUTTER_TEXT (child),
+                           (change % 2) ? "A longer label than before"
+                                        : "Label");
+  else
+    clutter_actor_set_size (child,
+                            10 + change % 40,
+                            10 + change % 20);
+}
+
+static void
+on_paint (ClutterActor *stage,
+          gboolean     *painted)
+{
+  *painted = TRUE;
+}
+
+/* runs the main loop until @stage has drawn a frame, and adds the
+ * layout work done in it to @sample */
+static void
+run_frame (ClutterActor *stage,
+           Sample       *sample)
+{
+  ClutterStageFrameTimings timings;
+  gboolean painted = FALSE;
+  gulong paint_id;
+
+  paint_id = g_signal_connect_after (stage, "paint",
+                                     G_CALLBACK (on_paint),
+                                     &painted);
+
+  while (!painted)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_signal_handler_disconnect (stage, paint_id);
+
+  if (clutter_stage_get_frame_timings (CLUTTER_STAGE (stage),
+                                       &timings, 1) == 1)
+    {
+      sample->layout_time += timings.layout_time;
+      sample->n_allocated_actors += timings.n_allocated_actors;
+      sample->n_size_requests += timings.n_size_requests;
+      sample->n_cached_size_requests += timings.n_cached_size_requests;
+    }
+}
+
+/* measures the preferred size of @box, the way its parent would */
+static void
+measure (ClutterActor *box,
+         GTimer       *timer,
+         Sample       *sample)
+{
+  gfloat min_width, natural_width;
+  gfloat min_height, natural_height;
+
+  g_timer_start (timer);
+  clutter_actor_get_preferred_width (box, -1,
+                                     &min_width,
+                                     &natural_width);
+  clutter_actor_get_preferred_height (box, STAGE_WIDTH,
+                                      &min_height,
+                                      &natural_height);
+  g_timer_stop (timer);
+
+  sample->measure_time += g_timer_elapsed (timer, NULL) * 1000000;
+}
+
+static void
+report (const gchar  *layout,
+        gint          n_children,
+        const gchar  *phase,
+        const Sample *sample,
+        gint          n_samples)
+{
+  gdouble cached;
+
+  cached = sample->n_size_requests > 0
+         ? 100.0 * sample->n_cached_size_requests / sample->n_size_requests
+         : 0.0;
+
+  printf ("%-6s %7d %-8s %10.1f us measure %10.1f us layout "
+          "%8.1f allocated %10.1f requests %5.1f%% cached\n",
+          layout,
+          n_children,
+          phase,
+          (gdouble) sample->measure_time / n_samples,
+          (gdouble) sample->layout_time / n_samples,
+          (gdouble) sample->n_allocated_actors / n_samples,
+          (gdouble) sample->n_size_requests / n_samples,
+          cached);
+  fflush (stdout);
+}
+
+static void
+run_layout (ClutterActor *stage,
+            Layout       *layout,
+            gint          n_children)
+{
+  ClutterLayoutManager *manager;
+  ClutterActor *box, **children;
+  Sample initial, changes;
+  GTimer *timer;
+  gint i;
+
+  memset (&initial, 0, sizeof (Sample));
+  memset (&changes, 0, sizeof (Sample));
+
+  manager = layout->create (n_children);
+  box = clutter_box_new (manager);
+  clutter_actor_set_width (box, STAGE_WIDTH);
+
+  /* the children are laid out but not painted */
+  clutter_actor_set_opacity (box, 0);
+
+  children = g_new (ClutterActor *, n_children);
+  for (i = 0; i < n_children; i++)
+    children[i] = create_child (i);
+
+  clutter_container_add_actors (CLUTTER_CONTAINER (box),
+                                children,
+                                n_children);
+
+  if (layout->place != NULL)
+    {
+      for (i = 0; i < n_children; i++)
+        layout->place (manager, box, children[i], i, n_children);
+    }
+
+  clutter_container_add_actor (CLUTTER_CONTAINER (stage), box);
+
+  timer = g_timer_new ();
+
+  /* the initial layout, with every size request still to compute */
+  measure (box, timer, &initial);
+  run_frame (stage, &initial);
+
+  report (layout->name, n_children, "initial", &initial, 1);
+
+  /* changing a single child invalidates the requests of its ancestors
+   * but not the ones of its siblings */
+  for (i = 0; i < N_CHANGES; i++)
+    {
+      change_child (children[(i * 7919) % n_children], i + 1);
+
+      measure (box, timer, &changes);
+      run_frame (stage, &changes);
+    }
+
+  report (layout->name, n_children, "change", &changes, N_CHANGES);
+
+  g_timer_destroy (timer);
+  g_free (children);
+
+  clutter_actor_destroy (box);
+}
+
+int
+main (int argc, char **argv)
+{
+  ClutterActor *stage;
+  GError *error = NULL;
+  gboolean found = FALSE;
+  guint i;
+
+  g_setenv ("CLUTTER_VBLANK", "none", FALSE);
+
+  if (clutter_init_with_args (&argc, &argv,
+                              NULL,
+                              entries,
+                              NULL,
+                              &error) != CLUTTER_INIT_SUCCESS)
+    return 1;
+
+  if (max_children < 10)
+    {
+      g_printerr ("Invalid number of children\n");
+      return EXIT_FAILURE;
+    }
+
+  stage = clutter_stage_get_default ();
+  clutter_actor_set_size (stage, STAGE_WIDTH, STAGE_HEIGHT);
+  clutter_actor_show (stage);
+
+  printf ("Layout manager scaling (%d changes of a single child)\n",
+          N_CHANGES);
+
+  for (i = 0; i < G_N_ELEMENTS (layouts); i++)
+    {
+      gint n_children;
+
+      if (layout_name != NULL && strcmp (layout_name, layouts[i].name) != 0)
+        continue;
+
+      for (n_children = 10; n_children <= max_children; n_children *= 10)
+        run_layout (stage, &layouts[i], n_children);
+
+      found = TRUE;
+    }
+
+  if (!found)
+    {
+      g_printerr ("Unknown layout '%s'\n", layout_name);
+      return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
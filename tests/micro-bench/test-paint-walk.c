@@ -0,0 +1,190 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <clutter/clutter.h>
+
+#define STAGE_WIDTH  800
+#define STAGE_HEIGHT 600
+
+#define N_ACTORS 10000
+#define N_FRAMES 200
+#define FANOUT   10
+
+static gint n_actors = N_ACTORS;
+static gint n_frames = N_FRAMES;
+static gint fanout = FANOUT;
+
+static GTimer *paint_timer = NULL;
+static gint frame_count = 0;
+static gint n_painted = 0;
+
+static GOptionEntry entries[] = {
+  {
+    "num-actors", 'a',
+    0,
+    G_OPTION_ARG_INT, &n_actors,
+    "Number of leaf actors", "ACTORS"
+  },
+  {
+    "num-frames", 'f',
+    0,
+    G_OPTION_ARG_INT, &n_frames,
+    "Number of frames between reports", "FRAMES"
+  },
+  {
+    "fanout", 'o',
+    0,
+    G_OPTION_ARG_INT, &fanout,
+    "Number of children of each group", "CHILDREN"
+  },
+  { NULL }
+};
+
+static void
+on_paint_begin (ClutterActor *stage)
+{
+  g_timer_continue (paint_timer);
+}
+
+static void
+on_paint_end (ClutterActor *stage)
+{
+  g_timer_stop (paint_timer);
+
+  if (++frame_count < n_frames)
+    return;
+
+  printf ("%d actors: %.3f ms per frame, %.1f ns per actor\n",
+          n_painted,
+          g_timer_elapsed (paint_timer, NULL) * 1000.0
+          / (gdouble) frame_count,
+          g_timer_elapsed (paint_timer, NULL) * 1000000000.0
+          / (gdouble) (frame_count * n_painted));
+
+  g_timer_start (paint_timer);
+  g_timer_stop (paint_timer);
+  frame_count = 0;
+}
+
+static gboolean
+queue_redraw (gpointer stage)
+{
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
+
+  return TRUE;
+}
+
+/* builds a tree of groups, each one with up to @fanout children, and
+ * @n_leaves rectangles as the leaves; the rectangles are laid out in
+ * a grid covering the stage, so that none of them is culled
+ */
+static ClutterActor *
+build_tree (gint  first_leaf,
+            gint  n_leaves,
+            gint  columns,
+            gint  size)
+{
+  ClutterActor *group;
+  gint i, step;
+
+  group = clutter_group_new ();
+  n_painted += 1;
+
+  if (n_leaves <= fanout)
+    {
+      for (i = 0; i < n_leaves; i++)
+        {
+          ClutterColor color = { 0x00, 0x00, 0x00, 0xff };
+          ClutterActor *rect;
+          gint leaf = first_leaf + i;
+
+          color.red = (leaf * 7) & 0xff;
+          color.green = (leaf * 13) & 0xff;
+          color.blue = (leaf * 17) & 0xff;
+
+          rect = clutter_rectangle_new_with_color (&color);
+          clutter_actor_set_size (rect, size, size);
+          clutter_actor_set_position (rect,
+                                      (leaf % columns) * size,
+                                      (leaf / columns) * size);
+          clutter_container_add_actor (CLUTTER_CONTAINER (group), rect);
+          n_painted += 1;
+        }
+
+      return group;
+    }
+
+  /* split the leaves evenly between the children */
+  step = (n_leaves + fanout - 1) / fanout;
+  for (i = first_leaf; i < first_leaf + n_leaves; i += step)
+    {
+      ClutterActor *child;
+
+      child = build_tree (i, MIN (step, first_leaf + n_leaves - i),
+                          columns,
+                          size);
+      clutter_container_add_actor (CLUTTER_CONTAINER (group), child);
+    }
+
+  return group;
+}
+
+int
+main (int argc, char **argv)
+{
+  const ClutterColor black = { 0x00, 0x00, 0x00, 0xff };
+  ClutterActor *stage, *tree;
+  GError *error = NULL;
+  gint columns, size;
+
+  g_setenv ("CLUTTER_VBLANK", "none", FALSE);
+  g_setenv ("CLUTTER_DEFAULT_FPS", "1000", FALSE);
+
+  if (clutter_init_with_args (&argc, &argv,
+                              NULL,
+                              entries,
+                              NULL,
+                              &error) != CLUTTER_INIT_SUCCESS)
+    return 1;
+
+  if (n_actors < 1 || fanout < 2)
+    {
+      g_printerr ("Invalid number of actors or fanout\n");
+      return EXIT_FAILURE;
+    }
+
+  stage = clutter_stage_get_default ();
+  clutter_actor_set_size (stage, STAGE_WIDTH, STAGE_HEIGHT);
+  clutter_stage_set_color (CLUTTER_STAGE (stage), &black);
+
+  /* use the biggest square that fits all the leaves on the stage */
+  size = 1;
+  while ((STAGE_WIDTH / (size + 1)) * (STAGE_HEIGHT / (size + 1)) >= n_actors)
+    size += 1;
+  columns = STAGE_WIDTH / size;
+
+  tree = build_tree (0, n_actors, columns, size);
+  clutter_container_add_actor (CLUTTER_CONTAINER (stage), tree);
+
+  printf ("Paint walk performance test with %d actors "
+          "(%d leaves, %d children per group)\n",
+          n_painted,
+          n_actors,
+          fanout);
+
+  clutter_actor_show (stage);
+
+  paint_timer = g_timer_new ();
+  g_timer_stop (paint_timer);
+
+  g_idle_add (queue_redraw, stage);
+
+  /* the default handler of the paint signal walks the scene graph */
+  g_signal_connect (stage, "paint", G_CALLBACK (on_paint_begin), NULL);
+  g_signal_connect_after (stage, "paint", G_CALLBACK (on_paint_end), NULL);
+
+  clutter_main ();
+
+  g_timer_destroy (paint_timer);
+
+  return EXIT_SUCCESS;
+}
@@ -5,9 +5,14 @@
 
 #define N_ACTORS 100
 #define N_EVENTS 5
+#define N_FRAMES 100
 
 static gint n_actors = N_ACTORS;
 static gint n_events = N_EVENTS;
+static gint n_frames = N_FRAMES;
+
+static GTimer *pick_timer = NULL;
+static gint frame_count = 0;
 
 static GOptionEntry entries[] = {
   {
@@ -22,6 +27,12 @@ static GOptionEntry entries[] = {
     G_OPTION_ARG_INT, &n_events,
     "Number of events", "EVENTS"
   },
+  {
+    "num-frames", 'f',
+    0,
+    G_OPTION_ARG_INT, &n_frames,
+    "Number of frames before switching picking mode", "FRAMES"
+  },
   { NULL }
 };
 
@@ -56,7 +67,30 @@ do_events (ClutterActor *stage)
 static void
 on_paint (ClutterActor *stage, gconstpointer *data)
 {
+  ClutterStage *stage_ = CLUTTER_STAGE (stage);
+  gboolean geometric;
+
+  g_timer_continue (pick_timer);
   do_events (stage);
+  g_timer_stop (pick_timer);
+
+  if (++frame_count < n_frames)
+    return;
+
+  /* report the time spent picking with the current mode, and then
+   * switch to the other one */
+  geometric = clutter_stage_get_geometric_picking (stage_);
+
+  printf ("%s picking: %.3f ms per pick\n",
+          geometric ? "Geometric" : "Pick buffer",
+          g_timer_elapsed (pick_timer, NULL) * 1000.0
+          / (gdouble) (frame_count * n_events));
+
+  clutter_stage_set_geometric_picking (stage_, !geometric);
+
+  g_timer_start (pick_timer);
+  g_timer_stop (pick_timer);
+  frame_count = 0;
 }
 
 static gboolean
@@ -126,12 +160,17 @@ main (int argc, char **argv)
 
   clutter_actor_show (stage);
 
+  pick_timer = g_timer_new ();
+  g_timer_stop (pick_timer);
+
   g_idle_add (queue_redraw, stage);
 
   g_signal_connect (stage, "paint", G_CALLBACK (on_paint), NULL);
 
   clutter_main ();
 
+  g_timer_destroy (pick_timer);
+
   return 0;
 }
 
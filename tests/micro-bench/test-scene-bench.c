@@ -0,0 +1,580 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <clutter/clutter.h>
+
+#define STAGE_WIDTH  800
+#define STAGE_HEIGHT 600
+
+#define N_FRAMES        200
+#define N_WARMUP_FRAMES 10
+#define FRAME_TIME      16
+
+#define N_GRID_ACTORS      10000
+#define N_NESTING_LEVELS   200
+#define N_TEXT_ACTORS      500
+#define N_EFFECT_ACTORS    64
+#define N_ANIMATED_ACTORS  1000
+#define N_LIST_ROWS        100000
+#define N_LIST_VISIBLE     30
+
+static gint n_frames = N_FRAMES;
+static gchar *scene_name = NULL;
+
+static GOptionEntry entries[] = {
+  {
+    "num-frames", 'f',
+    0,
+    G_OPTION_ARG_INT, &n_frames,
+    "Number of frames measured for each scene", "FRAMES"
+  },
+  {
+    "scene", 's',
+    0,
+    G_OPTION_ARG_STRING, &scene_name,
+    "Run only the given scene", "SCENE"
+  },
+  { NULL }
+};
+
+typedef struct _Scene   Scene;
+
+struct _Scene
+{
+  const gchar *name;
+
+  /* builds the scene inside @group and returns the number of actors */
+  gint (* setup) (Scene *scene, ClutterActor *group);
+
+  /* changes the scene before the frame number @frame */
+  void (* update) (Scene *scene, gint frame);
+
+  void (* teardown) (Scene *scene);
+
+  gpointer data;
+};
+
+typedef struct
+{
+  ClutterActor *stage;
+  Scene *scene;
+
+  gint frame;
+  gint64 last_frame_time;
+
+  /* sums over the measured frames */
+  ClutterStageFrameTimings total;
+  gint64 max_frame_time;
+} Run;
+
+/* the scenes are built from a fixed sequence of colors and sizes, so
+ * that every run draws exactly the same frames */
+static void
+leaf_color (gint          leaf,
+            ClutterColor *color)
+{
+  color->red = (leaf * 7) & 0xff;
+  color->green = (leaf * 13) & 0xff;
+  color->blue = (leaf * 17) & 0xff;
+  color->alpha = 0xff;
+}
+
+/* grid: a flat group with many small rectangles covering the stage */
+
+static gint
+grid_setup (Scene        *scene,
+            ClutterActor *group)
+{
+  gint i, size, columns;
+
+  size = 1;
+  while ((STAGE_WIDTH / (size + 1)) * (STAGE_HEIGHT / (size + 1))
+         >= N_GRID_ACTORS)
+    size += 1;
+  columns = STAGE_WIDTH / size;
+
+  for (i = 0; i < N_GRID_ACTORS; i++)
+    {
+      ClutterColor color;
+      ClutterActor *rect;
+
+      leaf_color (i, &color);
+
+      rect = clutter_rectangle_new_with_color (&color);
+      clutter_actor_set_size (rect, size, size);
+      clutter_actor_set_position (rect,
+                                  (i % columns) * size,
+                                  (i / columns) * size);
+      clutter_container_add_actor (CLUTTER_CONTAINER (group), rect);
+    }
+
+  return N_GRID_ACTORS;
+}
+
+/* nesting: a deep chain of groups; the innermost rectangle moves on
+ * each frame, which invalidates the layout of the whole chain */
+
+static gint
+nesting_setup (Scene        *scene,
+               ClutterActor *group)
+{
+  ClutterActor *parent = group;
+  gint i;
+
+  for (i = 0; i < N_NESTING_LEVELS; i++)
+    {
+      ClutterColor color;
+      ClutterActor *child, *rect;
+
+      leaf_color (i, &color);
+
+      rect = clutter_rectangle_new_with_color (&color);
+      clutter_actor_set_size (rect, 20, 20);
+      clutter_container_add_actor (CLUTTER_CONTAINER (parent), rect);
+
+      child = clutter_group_new ();
+      clutter_actor_set_position (child, 2, 2);
+      clutter_container_add_actor (CLUTTER_CONTAINER (parent), child);
+
+      parent = child;
+    }
+
+  scene->data = clutter_rectangle_new ();
+  clutter_actor_set_size (scene->data, 20, 20);
+  clutter_container_add_actor (CLUTTER_CONTAINER (parent), scene->data);
+
+  return N_NESTING_LEVELS * 2 + 1;
+}
+
+static void
+nesting_update (Scene *scene,
+                gint   frame)
+{
+  clutter_actor_set_position (scene->data, frame % 100, (frame / 2) % 100);
+}
+
+/* text: many paragraphs of text; one of them changes on each frame */
+
+static const gchar *text_words[] = {
+  "lorem", "ipsum", "dolor", "sit", "amet", "consectetur",
+  "adipiscing", "elit", "sed", "do", "eiusmod", "tempor"
+};
+
+static gchar *
+text_paragraph (gint seed)
+{
+  GString *str = g_string_new (NULL);
+  gint i;
+
+  for (i = 0; i < 24; i++)
+    {
+      if (i > 0)
+        g_string_append_c (str, ' ');
+
+      g_string_append (str,
+                       text_words[(seed + i * 5) % G_N_ELEMENTS (text_words)]);
+    }
+
+  return g_string_free (str, FALSE);
+}
+
+static gint
+text_setup (Scene        *scene,
+            ClutterActor *group)
+{
+  const ClutterColor white = { 0xff, 0xff, 0xff, 0xff };
+  GPtrArray *texts = g_ptr_array_new ();
+  gint i;
+
+  for (i = 0; i < N_TEXT_ACTORS; i++)
+    {
+      ClutterActor *text;
+      gchar *paragraph;
+
+      paragraph = text_paragraph (i);
+      text = clutter_text_new_full ("Sans 8", paragraph, &white);
+      clutter_text_set_line_wrap (CLUTTER_TEXT (text), TRUE);
+      clutter_actor_set_width (text, 150);
+      clutter_actor_set_position (text,
+                                  (i % 5) * 160,
+                                  ((i / 5) * 6) % STAGE_HEIGHT);
+      clutter_container_add_actor (CLUTTER_CONTAINER (group), text);
+      g_ptr_array_add (texts, text);
+      g_free (paragraph);
+    }
+
+  scene->data = texts;
+
+  return N_TEXT_ACTORS;
+}
+
+static void
+text_update (Scene *scene,
+             gint   frame)
+{
+  GPtrArray *texts = scene->data;
+  gchar *paragraph;
+
+  paragraph = text_paragraph (frame);
+  clutter_text_set_text (g_ptr_array_index (texts, frame % texts->len),
+                         paragraph);
+  g_free (paragraph);
+}
+
+static void
+text_teardown (Scene *scene)
+{
+  g_ptr_array_free (scene->data, TRUE);
+}
+
+/* effects: actors painted through offscreen effects */
+
+static gint
+effects_setup (Scene        *scene,
+               ClutterActor *group)
+{
+  const ClutterColor tint = { 0xff, 0xcc, 0x99, 0xff };
+  gint i;
+
+  for (i = 0; i < N_EFFECT_ACTORS; i++)
+    {
+      ClutterColor color;
+      ClutterActor *rect;
+
+      leaf_color (i, &color);
+
+      rect = clutter_rectangle_new_with_color (&color);
+      clutter_actor_set_size (rect, 90, 70);
+      clutter_actor_set_position (rect, (i % 8) * 100, (i / 8) * 75);
+
+      if (i % 2)
+        clutter_actor_add_effect (rect, clutter_colorize_effect_new (&tint));
+      else
+        clutter_actor_add_effect (rect, clutter_desaturate_effect_new (0.5));
+
+      clutter_container_add_actor (CLUTTER_CONTAINER (group), rect);
+    }
+
+  return N_EFFECT_ACTORS;
+}
+
+/* animations: many implicit animations sharing a looping timeline */
+
+static gint
+animations_setup (Scene        *scene,
+                  ClutterActor *group)
+{
+  ClutterTimeline *timeline;
+  gint i;
+
+  timeline = clutter_timeline_new (1000);
+  clutter_timeline_set_loop (timeline, TRUE);
+
+  for (i = 0; i < N_ANIMATED_ACTORS; i++)
+    {
+      ClutterColor color;
+      ClutterActor *rect;
+
+      leaf_color (i, &color);
+
+      rect = clutter_rectangle_new_with_color (&color);
+      clutter_actor_set_size (rect, 10, 10);
+      clutter_actor_set_position (rect,
+                                  (i * 37) % STAGE_WIDTH,
+                                  (i * 53) % STAGE_HEIGHT);
+      clutter_container_add_actor (CLUTTER_CONTAINER (group), rect);
+
+      clutter_actor_animate_with_timeline (rect, CLUTTER_EASE_IN_OUT_QUAD,
+                                           timeline,
+                                           "x", (gfloat) ((i * 71) % STAGE_WIDTH),
+                                           "rotation-angle-z", 360.0,
+                                           "opacity", 128,
+                                           NULL);
+    }
+
+  clutter_timeline_start (timeline);
+  scene->data = timeline;
+
+  return N_ANIMATED_ACTORS;
+}
+
+static void
+animations_teardown (Scene *scene)
+{
+  clutter_timeline_stop (scene->data);
+  g_object_unref (scene->data);
+}
+
+/* list: a window of rows over a large model, scrolled by one row on
+ * each frame */
+
+typedef struct
+{
+  ClutterModel *model;
+  ClutterActor *rows[N_LIST_VISIBLE];
+} ListData;
+
+static gint
+list_setup (Scene        *scene,
+            ClutterActor *group)
+{
+  const ClutterColor white = { 0xff, 0xff, 0xff, 0xff };
+  ListData *data = g_new0 (ListData, 1);
+  gint i;
+
+  data->model = clutter_list_model_new (2,
+                                        G_TYPE_INT, "index",
+                                        G_TYPE_STRING, "label");
+
+  for (i = 0; i < N_LIST_ROWS; i++)
+    {
+      gchar *label = g_strdup_printf ("Row %d: %s", i,
+                                      text_words[i % G_N_ELEMENTS (text_words)]);
+
+      clutter_model_append (data->model, 0, i, 1, label, -1);
+      g_free (label);
+    }
+
+  for (i = 0; i < N_LIST_VISIBLE; i++)
+    {
+      data->rows[i] = clutter_text_new_full ("Sans 12", "", &white);
+      clutter_actor_set_position (data->rows[i], 10, i * 20);
+      clutter_container_add_actor (CLUTTER_CONTAINER (group), data->rows[i]);
+    }
+
+  scene->data = data;
+
+  return N_LIST_VISIBLE;
+}
+
+static void
+list_update (Scene *scene,
+             gint   frame)
+{
+  ListData *data = scene->data;
+  ClutterModelIter *iter;
+  gint i;
+
+  iter = clutter_model_get_iter_at_row (data->model,
+                                        (frame * 7) % (N_LIST_ROWS - N_LIST_VISIBLE));
+
+  for (i = 0; i < N_LIST_VISIBLE && !clutter_model_iter_is_last (iter); i++)
+    {
+      gchar *label = NULL;
+
+      clutter_model_iter_get (iter, 1, &label, -1);
+      clutter_text_set_text (CLUTTER_TEXT (data->rows[i]), label);
+      g_free (label);
+
+      clutter_model_iter_next (iter);
+    }
+
+  g_object_unref (iter);
+}
+
+static void
+list_teardown (Scene *scene)
+{
+  ListData *data = scene->data;
+
+  g_object_unref (data->model);
+  g_free (data);
+}
+
+static Scene scenes[] = {
+  { "grid", grid_setup, NULL, NULL },
+  { "nesting", nesting_setup, nesting_update, NULL },
+  { "text", text_setup, text_update, text_teardown },
+  { "effects", effects_setup, NULL, NULL },
+  { "animations", animations_setup, NULL, animations_teardown },
+  { "list", list_setup, list_update, list_teardown },
+};
+
+static void
+accumulate_timings (Run                            *run,
+                    const ClutterStageFrameTimings *timings)
+{
+  gint64 frame_time;
+
+  run->total.event_time += timings->event_time;
+  run->total.timeline_time += timings->timeline_time;
+  run->total.layout_time += timings->layout_time;
+  run->total.paint_time += timings->paint_time;
+  run->total.swap_time += timings->swap_time;
+  run->total.n_picks += timings->n_picks;
+  run->total.n_pick_renders += timings->n_pick_renders;
+  run->total.n_painted_actors += timings->n_painted_actors;
+  run->total.n_allocated_actors += timings->n_allocated_actors;
+
+  frame_time = timings->event_time
+             + timings->timeline_time
+             + timings->layout_time
+             + timings->paint_time
+             + timings->swap_time;
+
+  run->max_frame_time = MAX (run->max_frame_time, frame_time);
+}
+
+/* runs at the start of each iteration of the master clock, after the
+ * timelines advanced and before the stage is updated */
+static gboolean
+on_repaint (gpointer user_data)
+{
+  Run *run = user_data;
+  ClutterStageFrameTimings timings;
+
+  /* account the frame drawn by the previous iteration, if any */
+  if (clutter_stage_get_frame_timings (CLUTTER_STAGE (run->stage),
+                                       &timings, 1) == 1 &&
+      timings.frame_time != run->last_frame_time)
+    {
+      run->last_frame_time = timings.frame_time;
+
+      if (run->frame >= N_WARMUP_FRAMES)
+        accumulate_timings (run, &timings);
+
+      run->frame += 1;
+    }
+
+  if (run->frame >= N_WARMUP_FRAMES + n_frames)
+    {
+      clutter_main_quit ();
+      return FALSE;
+    }
+
+  if (run->scene->update != NULL)
+    run->scene->update (run->scene, run->frame);
+
+  clutter_actor_queue_redraw (run->stage);
+
+  return TRUE;
+}
+
+static void
+run_scene (ClutterActor *stage,
+           Scene        *scene,
+           gboolean      first)
+{
+  ClutterActor *group;
+  Run run;
+  gint n_actors;
+
+  memset (&run, 0, sizeof (Run));
+  run.stage = stage;
+  run.scene = scene;
+
+  group = clutter_group_new ();
+  clutter_container_add_actor (CLUTTER_CONTAINER (stage), group);
+
+  n_actors = scene->setup (scene, group);
+
+  clutter_threads_add_repaint_func (on_repaint, &run, NULL);
+  clutter_actor_queue_redraw (stage);
+
+  clutter_main ();
+
+  if (scene->teardown != NULL)
+    scene->teardown (scene);
+
+  clutter_actor_destroy (group);
+
+  /* the times are the averages over the measured frames, in
+   * microseconds; the counters are per frame as well */
+#define AVERAGE(x)      ((gdouble) (x) / (gdouble) n_frames)
+
+  printf ("%s    {\n"
+          "      \"name\": \"%s\",\n"
+          "      \"actors\": %d,\n"
+          "      \"frames\": %d,\n"
+          "      \"event-time\": %.1f,\n"
+          "      \"timeline-time\": %.1f,\n"
+          "      \"layout-time\": %.1f,\n"
+          "      \"paint-time\": %.1f,\n"
+          "      \"swap-time\": %.1f,\n"
+          "      \"max-frame-time\": %" G_GINT64_FORMAT ",\n"
+          "      \"painted-actors\": %.1f,\n"
+          "      \"allocated-actors\": %.1f,\n"
+          "      \"picks\": %.1f,\n"
+          "      \"pick-renders\": %.1f\n"
+          "    }",
+          first ? "" : ",\n",
+          scene->name,
+          n_actors,
+          n_frames,
+          AVERAGE (run.total.event_time),
+          AVERAGE (run.total.timeline_time),
+          AVERAGE (run.total.layout_time),
+          AVERAGE (run.total.paint_time),
+          AVERAGE (run.total.swap_time),
+          run.max_frame_time,
+          AVERAGE (run.total.n_painted_actors),
+          AVERAGE (run.total.n_allocated_actors),
+          AVERAGE (run.total.n_picks),
+          AVERAGE (run.total.n_pick_renders));
+
+#undef AVERAGE
+
+  fflush (stdout);
+}
+
+int
+main (int argc, char **argv)
+{
+  const ClutterColor black = { 0x00, 0x00, 0x00, 0xff };
+  ClutterActor *stage;
+  GError *error = NULL;
+  gboolean first = TRUE;
+  gchar *frame_time;
+  guint i;
+
+  /* the master clock advances by exactly one frame time on each
+   * iteration and never waits, so every run draws the same frames
+   * as fast as possible */
+  frame_time = g_strdup_printf ("%d", FRAME_TIME);
+  g_setenv ("CLUTTER_VBLANK", "none", FALSE);
+  g_setenv ("CLUTTER_FIXED_FRAME_TIME", frame_time, FALSE);
+  g_free (frame_time);
+
+  if (clutter_init_with_args (&argc, &argv,
+                              NULL,
+                              entries,
+                              NULL,
+                              &error) != CLUTTER_INIT_SUCCESS)
+    return 1;
+
+  if (n_frames < 1)
+    {
+      g_printerr ("Invalid number of frames\n");
+      return EXIT_FAILURE;
+    }
+
+  stage = clutter_stage_get_default ();
+  clutter_actor_set_size (stage, STAGE_WIDTH, STAGE_HEIGHT);
+  clutter_stage_set_color (CLUTTER_STAGE (stage), &black);
+  clutter_actor_show (stage);
+
+  printf ("{\n"
+          "  \"frame-time\": %s,\n"
+          "  \"scenes\": [\n",
+          g_getenv ("CLUTTER_FIXED_FRAME_TIME"));
+
+  for (i = 0; i < G_N_ELEMENTS (scenes); i++)
+    {
+      if (scene_name != NULL && strcmp (scene_name, scenes[i].name) != 0)
+        continue;
+
+      run_scene (stage, &scenes[i], first);
+      first = FALSE;
+    }
+
+  printf ("\n  ]\n"
+          "}\n");
+
+  if (first)
+    {
+      g_printerr ("Unknown scene '%s'\n", scene_name);
+      return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
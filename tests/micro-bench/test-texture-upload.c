@@ -0,0 +1,483 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <clutter/clutter.h>
+
+#define STAGE_WIDTH  800
+#define STAGE_HEIGHT 600
+
+#define N_IMAGES                20
+#define N_STREAM_FRAMES         100
+
+/* the size of the streamed texture, and the number of rows updated
+ * in each frame */
+#define STREAM_SIZE             512
+#define STREAM_BAND             64
+
+/* the interval between two frames of the master clock without
+ * sync-to-vblank, in microseconds */
+#define FRAME_INTERVAL          16667
+
+static gint n_images = N_IMAGES;
+static gint n_stream_frames = N_STREAM_FRAMES;
+static gchar *image_file = NULL;
+
+static GOptionEntry entries[] = {
+  {
+    "num-images", 'n',
+    0,
+    G_OPTION_ARG_INT, &n_images,
+    "Number of images loaded in each scenario", "IMAGES"
+  },
+  {
+    "num-frames", 'f',
+    0,
+    G_OPTION_ARG_INT, &n_stream_frames,
+    "Number of frames of streaming updates", "FRAMES"
+  },
+  {
+    "file", 'i',
+    0,
+    G_OPTION_ARG_FILENAME, &image_file,
+    "Image to load (default: redhand.png)", "FILE"
+  },
+  { NULL }
+};
+
+typedef enum
+{
+  SCENARIO_BITMAP,
+  SCENARIO_SYNC,
+  SCENARIO_ASYNC,
+  SCENARIO_DATA_ASYNC,
+  SCENARIO_STREAM
+} ScenarioType;
+
+typedef struct
+{
+  const gchar *name;
+  ScenarioType type;
+} Scenario;
+
+static const Scenario scenarios[] = {
+  { "bitmap", SCENARIO_BITMAP },
+  { "sync", SCENARIO_SYNC },
+  { "async", SCENARIO_ASYNC },
+  { "data-async", SCENARIO_DATA_ASYNC },
+  { "stream", SCENARIO_STREAM },
+};
+
+typedef struct _Run     Run;
+
+typedef struct
+{
+  Run *run;
+  ClutterActor *texture;
+  gint64 start_time;
+} Load;
+
+struct _Run
+{
+  const Scenario *scenario;
+
+  ClutterActor *stage;
+  ClutterActor *spinner;
+
+  Load *loads;
+  gint n_started;
+  gint n_finished;
+
+  /* the streamed texture, and the pixels written to it */
+  ClutterActor *stream;
+  guchar *stream_data;
+  gint n_updates;
+
+  gint n_frames;
+  gint64 last_frame_time;
+
+  /* the times of the measured operations, in microseconds; the decode
+   * and upload times are only known when they happen separately */
+  gint64 decode_time;
+  gint64 upload_time;
+  gint64 latency;
+
+  /* the time by which the frames were late, and the number of frames
+   * that were skipped because of it */
+  gint64 blocked_time;
+  guint n_dropped;
+};
+
+static gint64
+get_time (void)
+{
+#if GLIB_CHECK_VERSION (2, 27, 3)
+  return g_get_monotonic_time ();
+#else
+  GTimeVal current_time;
+
+  g_get_current_time (&current_time);
+
+  return current_time.tv_sec * G_USEC_PER_SEC + current_time.tv_usec;
+#endif
+}
+
+static ClutterActor *
+create_texture (void)
+{
+  ClutterActor *texture = clutter_texture_new ();
+
+  /* the textures are only kept until the end of the scenario */
+  g_object_ref_sink (texture);
+
+  return texture;
+}
+
+static void
+on_load_finished (ClutterTexture *texture,
+                  const GError   *error,
+                  Load           *load)
+{
+  if (error != NULL)
+    g_printerr ("Unable to load '%s': %s\n", image_file, error->message);
+
+  load->run->latency += get_time () - load->start_time;
+  load->run->n_finished += 1;
+}
+
+/* decodes and uploads the image as two separate steps, the way the
+ * synchronous path of ClutterTexture does */
+static void
+load_bitmap (Run  *run,
+             Load *load)
+{
+  CoglHandle bitmap, texture;
+  GError *error = NULL;
+  gint64 decoded;
+
+  bitmap = cogl_bitmap_new_from_file (image_file, &error);
+  decoded = get_time ();
+
+  if (bitmap == COGL_INVALID_HANDLE)
+    {
+      g_printerr ("Unable to load '%s': %s\n", image_file, error->message);
+      g_error_free (error);
+      return;
+    }
+
+  texture = cogl_texture_new_from_bitmap (bitmap,
+                                          COGL_TEXTURE_NONE,
+                                          COGL_PIXEL_FORMAT_ANY);
+  clutter_texture_set_cogl_texture (CLUTTER_TEXTURE (load->texture),
+                                    texture);
+
+  run->decode_time += decoded - load->start_time;
+  run->upload_time += get_time () - decoded;
+
+  cogl_handle_unref (texture);
+  cogl_handle_unref (bitmap);
+}
+
+static void
+start_load (Run *run)
+{
+  Load *load = &run->loads[run->n_started++];
+  GError *error = NULL;
+
+  load->run = run;
+  load->texture = create_texture ();
+  load->start_time = get_time ();
+
+  switch (run->scenario->type)
+    {
+    case SCENARIO_BITMAP:
+      load_bitmap (run, load);
+      run->latency += get_time () - load->start_time;
+      run->n_finished += 1;
+      break;
+
+    case SCENARIO_SYNC:
+      if (!clutter_texture_set_from_file (CLUTTER_TEXTURE (load->texture),
+                                          image_file,
+                                          &error))
+        {
+          g_printerr ("Unable to load '%s': %s\n",
+                      image_file,
+                      error->message);
+          g_error_free (error);
+        }
+
+      run->latency += get_time () - load->start_time;
+      run->n_finished += 1;
+      break;
+
+    case SCENARIO_ASYNC:
+    case SCENARIO_DATA_ASYNC:
+      g_object_set (load->texture,
+                    run->scenario->type == SCENARIO_ASYNC
+                      ? "load-async"
+                      : "load-data-async",
+                    TRUE,
+                    NULL);
+      g_signal_connect (load->texture, "load-finished",
+                        G_CALLBACK (on_load_finished),
+                        load);
+
+      clutter_texture_set_from_file (CLUTTER_TEXTURE (load->texture),
+                                     image_file,
+                                     NULL);
+      break;
+
+    case SCENARIO_STREAM:
+      g_assert_not_reached ();
+    }
+}
+
+/* updates a band of the streamed texture, the way a video sink
+ * would */
+static void
+update_stream (Run *run)
+{
+  gint band = run->n_updates % (STREAM_SIZE / STREAM_BAND);
+  gint64 start;
+
+  memset (run->stream_data,
+          run->n_updates * 16,
+          STREAM_SIZE * STREAM_BAND * 4);
+
+  start = get_time ();
+  clutter_texture_set_area_from_rgb_data (CLUTTER_TEXTURE (run->stream),
+                                          run->stream_data,
+                                          TRUE,
+                                          0, band * STREAM_BAND,
+                                          STREAM_SIZE, STREAM_BAND,
+                                          STREAM_SIZE * 4,
+                                          4,
+                                          CLUTTER_TEXTURE_NONE,
+                                          NULL);
+  run->upload_time += get_time () - start;
+
+  run->n_updates += 1;
+}
+
+/* a frame is dropped each time the master clock misses its interval */
+static void
+account_frame (Run    *run,
+               gint64  frame_time)
+{
+  gint64 interval;
+
+  /* the interval before the first frame of the scenario includes the
+   * time spent setting it up */
+  if (run->n_frames > 0)
+    {
+      interval = frame_time - run->last_frame_time;
+
+      if (interval > FRAME_INTERVAL + FRAME_INTERVAL / 2)
+        {
+          run->blocked_time += interval - FRAME_INTERVAL;
+          run->n_dropped +=
+            (interval + FRAME_INTERVAL / 2) / FRAME_INTERVAL - 1;
+        }
+    }
+
+  run->last_frame_time = frame_time;
+  run->n_frames += 1;
+}
+
+/* runs at the start of each iteration of the master clock */
+static gboolean
+on_repaint (gpointer user_data)
+{
+  Run *run = user_data;
+  ClutterStageFrameTimings timings;
+
+  if (clutter_stage_get_frame_timings (CLUTTER_STAGE (run->stage),
+                                       &timings, 1) == 1 &&
+      timings.frame_time != run->last_frame_time)
+    account_frame (run, timings.frame_time);
+
+  if (run->scenario->type == SCENARIO_STREAM)
+    {
+      if (run->n_updates >= n_stream_frames)
+        {
+          clutter_main_quit ();
+          return FALSE;
+        }
+
+      update_stream (run);
+    }
+  else
+    {
+      if (run->n_finished >= n_images)
+        {
+          clutter_main_quit ();
+          return FALSE;
+        }
+
+      /* an application loads the images it needs all at once, relying
+       * on the asynchronous loading to keep the frames coming; the
+       * synchronous loads are spread over the frames instead, so that
+       * each of them blocks a single frame */
+      if (run->scenario->type == SCENARIO_ASYNC ||
+          run->scenario->type == SCENARIO_DATA_ASYNC)
+        {
+          while (run->n_started < n_images)
+            start_load (run);
+        }
+      else if (run->n_started < n_images)
+        start_load (run);
+    }
+
+  /* keep the stage drawing frames, so that the dropped ones show */
+  clutter_actor_set_rotation (run->spinner, CLUTTER_Z_AXIS,
+                              (run->last_frame_time / 10000) % 360,
+                              25, 25, 0);
+
+  return TRUE;
+}
+
+static void
+print_time (gint64 time,
+            gint   n_samples)
+{
+  if (time > 0)
+    printf (" %10.1f us", (gdouble) time / n_samples);
+  else
+    printf (" %13s", "-");
+}
+
+static void
+run_scenario (ClutterActor   *stage,
+              const Scenario *scenario)
+{
+  ClutterStageFrameTimings timings;
+  gint n_samples;
+  Run run;
+  gint i;
+
+  memset (&run, 0, sizeof (Run));
+  run.scenario = scenario;
+  run.stage = stage;
+
+  run.spinner = clutter_rectangle_new ();
+  clutter_actor_set_size (run.spinner, 50, 50);
+  clutter_actor_set_position (run.spinner, 50, 50);
+  clutter_container_add_actor (CLUTTER_CONTAINER (stage), run.spinner);
+
+  if (scenario->type == SCENARIO_STREAM)
+    {
+      guchar *pixels = g_malloc0 (STREAM_SIZE * STREAM_SIZE * 4);
+
+      run.stream = clutter_texture_new ();
+      clutter_texture_set_from_rgb_data (CLUTTER_TEXTURE (run.stream),
+                                         pixels,
+                                         TRUE,
+                                         STREAM_SIZE, STREAM_SIZE,
+                                         STREAM_SIZE * 4,
+                                         4,
+                                         CLUTTER_TEXTURE_NONE,
+                                         NULL);
+      clutter_container_add_actor (CLUTTER_CONTAINER (stage), run.stream);
+
+      run.stream_data = g_malloc (STREAM_SIZE * STREAM_BAND * 4);
+
+      g_free (pixels);
+    }
+  else
+    run.loads = g_new0 (Load, n_images);
+
+  /* the last frame of the previous scenario is not accounted */
+  if (clutter_stage_get_frame_timings (CLUTTER_STAGE (stage),
+                                       &timings, 1) == 1)
+    run.last_frame_time = timings.frame_time;
+
+  clutter_threads_add_repaint_func (on_repaint, &run, NULL);
+  clutter_actor_queue_redraw (stage);
+
+  clutter_main ();
+
+  if (scenario->type == SCENARIO_STREAM)
+    {
+      n_samples = run.n_updates;
+      run.latency = run.upload_time;
+
+      clutter_actor_destroy (run.stream);
+      g_free (run.stream_data);
+    }
+  else
+    {
+      n_samples = run.n_finished;
+
+      for (i = 0; i < run.n_started; i++)
+        {
+          g_signal_handlers_disconnect_by_func (run.loads[i].texture,
+                                                on_load_finished,
+                                                &run.loads[i]);
+          clutter_actor_destroy (run.loads[i].texture);
+          g_object_unref (run.loads[i].texture);
+        }
+
+      g_free (run.loads);
+    }
+
+  clutter_actor_destroy (run.spinner);
+
+  n_samples = MAX (n_samples, 1);
+
+  printf ("%-10s %6d", scenario->name, n_samples);
+  print_time (run.decode_time, n_samples);
+  print_time (run.upload_time, n_samples);
+  print_time (run.latency, n_samples);
+  printf (" %10.1f us %6u\n",
+          (gdouble) run.blocked_time / n_samples,
+          run.n_dropped);
+  fflush (stdout);
+}
+
+int
+main (int argc, char **argv)
+{
+  ClutterActor *stage;
+  GError *error = NULL;
+  guint i;
+
+  g_setenv ("CLUTTER_VBLANK", "none", FALSE);
+
+  if (clutter_init_with_args (&argc, &argv,
+                              NULL,
+                              entries,
+                              NULL,
+                              &error) != CLUTTER_INIT_SUCCESS)
+    return 1;
+
+  if (n_images < 1 || n_stream_frames < 1)
+    {
+      g_printerr ("Invalid number of images or frames\n");
+      return EXIT_FAILURE;
+    }
+
+  if (image_file == NULL)
+    image_file = g_strdup (TESTS_DATA_DIR "redhand.png");
+
+  /* every load has to decode and upload the image again */
+  clutter_texture_set_cache_size (0);
+
+  stage = clutter_stage_get_default ();
+  clutter_actor_set_size (stage, STAGE_WIDTH, STAGE_HEIGHT);
+  clutter_actor_show (stage);
+
+  printf ("Texture upload (%d images, %d streamed frames of %dx%d)\n",
+          n_images,
+          n_stream_frames,
+          STREAM_SIZE, STREAM_BAND);
+  printf ("%-10s %6s %13s %13s %13s %13s %6s\n",
+          "scenario", "loads",
+          "decode", "upload", "latency", "blocked", "drops");
+
+  for (i = 0; i < G_N_ELEMENTS (scenarios); i++)
+    run_scenario (stage, &scenarios[i]);
+
+  g_free (image_file);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <clutter/clutter.h>
+
+#define STAGE_WIDTH  800
+#define STAGE_HEIGHT 600
+
+#define N_ITERATIONS 1000000
+
+static gint n_iterations = N_ITERATIONS;
+
+static GOptionEntry entries[] = {
+  {
+    "num-iterations", 'n',
+    0,
+    G_OPTION_ARG_INT, &n_iterations,
+    "Number of iterations of each test", "ITERATIONS"
+  },
+  { NULL }
+};
+
+typedef struct
+{
+  float x;
+  float y;
+  float z;
+  float w;
+} Vertex4;
+
+static void
+report (const gchar *name,
+        GTimer      *timer,
+        gint         n_vertices)
+{
+  gdouble elapsed = g_timer_elapsed (timer, NULL);
+
+  printf ("%-32s %8.1f ns per call, %6.1f ns per vertex\n",
+          name,
+          elapsed * 1000000000.0 / (gdouble) n_iterations,
+          elapsed * 1000000000.0 / (gdouble) (n_iterations * n_vertices));
+}
+
+/* the generic path: project the points with Cogl, then divide each
+ * component by w and map it to window coordinates one vertex at a
+ * time */
+static void
+generic_transform_vertices (const CoglMatrix    *modelview_projection,
+                            const float         *viewport,
+                            const ClutterVertex *vertices_in,
+                            ClutterVertex       *vertices_out,
+                            gint                 n_vertices)
+{
+  Vertex4 *tmp = g_alloca (sizeof (Vertex4) * n_vertices);
+  gint i;
+
+  cogl_matrix_project_points (modelview_projection,
+                              3,
+                              sizeof (ClutterVertex),
+                              vertices_in,
+                              sizeof (Vertex4),
+                              tmp,
+                              n_vertices);
+
+  for (i = 0; i < n_vertices; i++)
+    {
+      vertices_out[i].x =
+        (((tmp[i].x / tmp[i].w) + 1.0f) / 2.0f) * viewport[2] + viewport[0];
+      vertices_out[i].y =
+        viewport[3] - (((tmp[i].y / tmp[i].w) + 1.0f) / 2.0f) * viewport[3]
+        + viewport[1];
+    }
+}
+
+static void
+test_generic (const CoglMatrix *modelview_projection,
+              const float      *viewport,
+              gint              n_vertices)
+{
+  ClutterVertex in[8], out[8];
+  GTimer *timer;
+  gchar *name;
+  gint i;
+
+  for (i = 0; i < n_vertices; i++)
+    {
+      in[i].x = (i & 1) ? 100.0f : 0.0f;
+      in[i].y = (i & 2) ? 100.0f : 0.0f;
+      in[i].z = (i & 4) ? 100.0f : 0.0f;
+    }
+
+  timer = g_timer_new ();
+
+  for (i = 0; i < n_iterations; i++)
+    generic_transform_vertices (modelview_projection, viewport,
+                                in, out,
+                                n_vertices);
+
+  g_timer_stop (timer);
+
+  name = g_strdup_printf ("generic, %d vertices", n_vertices);
+  report (name, timer, n_vertices);
+  g_free (name);
+
+  g_timer_destroy (timer);
+}
+
+int
+main (int argc, char **argv)
+{
+  ClutterActor *stage, *group, *rect;
+  CoglMatrix projection, modelview, modelview_projection;
+  ClutterPerspective perspective;
+  float viewport[4] = { 0, 0, STAGE_WIDTH, STAGE_HEIGHT };
+  ClutterVertex verts[4];
+  GError *error = NULL;
+  GTimer *timer;
+  gint i;
+
+  if (clutter_init_with_args (&argc, &argv,
+                              NULL,
+                              entries,
+                              NULL,
+                              &error) != CLUTTER_INIT_SUCCESS)
+    return 1;
+
+  stage = clutter_stage_get_default ();
+  clutter_actor_set_size (stage, STAGE_WIDTH, STAGE_HEIGHT);
+
+  /* a rotated actor inside a scaled group, so that none of the
+   * matrices involved is trivial */
+  group = clutter_group_new ();
+  clutter_actor_set_position (group, 100, 100);
+  clutter_actor_set_scale (group, 1.5, 0.75);
+  clutter_container_add_actor (CLUTTER_CONTAINER (stage), group);
+
+  rect = clutter_rectangle_new ();
+  clutter_actor_set_size (rect, 100, 100);
+  clutter_actor_set_position (rect, 50, 50);
+  clutter_actor_set_rotation (rect, CLUTTER_Y_AXIS, 30, 50, 0, 0);
+  clutter_container_add_actor (CLUTTER_CONTAINER (group), rect);
+
+  clutter_actor_show_all (stage);
+
+  printf ("Vertex transformation performance test (%d iterations)\n",
+          n_iterations);
+
+  /* clutter_actor_get_abs_allocation_vertices() projects the 4
+   * vertices of the allocation in a single batch */
+  timer = g_timer_new ();
+  for (i = 0; i < n_iterations; i++)
+    clutter_actor_get_abs_allocation_vertices (rect, verts);
+  g_timer_stop (timer);
+  report ("abs allocation vertices", timer, 4);
+
+  /* clutter_actor_apply_transform_to_point() projects a single
+   * vertex, without multiplying the matrices */
+  g_timer_start (timer);
+  for (i = 0; i < n_iterations; i++)
+    {
+      ClutterVertex point = { 10, 10, 0 };
+
+      clutter_actor_apply_transform_to_point (rect, &point, &verts[0]);
+    }
+  g_timer_stop (timer);
+  report ("apply transform to point", timer, 1);
+
+  g_timer_destroy (timer);
+
+  /* the generic path with a projection and a modelview matrix that
+   * are similar to the ones of the stage, for comparison */
+  clutter_stage_get_perspective (CLUTTER_STAGE (stage), &perspective);
+
+  cogl_matrix_init_identity (&projection);
+  cogl_matrix_perspective (&projection,
+                           perspective.fovy,
+                           perspective.aspect,
+                           perspective.z_near,
+                           perspective.z_far);
+
+  cogl_matrix_init_identity (&modelview);
+  cogl_matrix_translate (&modelview, -0.5f, 0.5f, -1.0f);
+  cogl_matrix_scale (&modelview,
+                     1.0f / STAGE_WIDTH,
+                     -1.0f / STAGE_HEIGHT,
+                     1.0f / STAGE_WIDTH);
+  cogl_matrix_rotate (&modelview, 30, 0, 1, 0);
+
+  cogl_matrix_multiply (&modelview_projection, &projection, &modelview);
+
+  test_generic (&modelview_projection, viewport, 4);
+  test_generic (&modelview_projection, viewport, 8);
+
+  return EXIT_SUCCESS;
+}